@@ -43,10 +43,99 @@ Config_Parse(
 			(IConfigSettings_Parse) NULL);
 }
 
+/**
+ *	@brief		Read the configuration file and pass its key value pairs to the parsing function
+ *	@details	UTF-8 files are tokenized directly from the raw bytes, UTF-16 files are widened and parsed line by line. A
+ *				missing or empty file has no key value pairs.
+ *
+ *	@param		PwszConfigFileName		Pointer to a wide character configuration file name
+ *	@param		PpfParse				Function pointer to a Parsing function
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+Config_ParseFile(
+	_In_z_		const wchar_t*			PwszConfigFileName,
+	_In_opt_	IConfigSettings_Parse	PpfParse)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	wchar_t* wszConfigFileContent = NULL;
+	BYTE* rgbConfigFileContent = NULL;
+	unsigned int unConfigFileContentSize = 0;
+	unsigned int unContentOffset = 0;
+	unsigned long long ullFileSize = 0, ullModificationTime = 0;
+	BOOL fPrivate = FALSE;
+
+	do
+	{
+		// Skip parsing if the file does not exist or is empty
+		unReturnValue = FileIO_GetFileStatus(PwszConfigFileName, &ullFileSize, &ullModificationTime, &fPrivate);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			if (RC_E_FILE_NOT_FOUND == unReturnValue)
+				unReturnValue = RC_SUCCESS;
+			else
+				ERROR_STORE_FMT(unReturnValue, L"FileIO_GetFileStatus failed for the config file (%ls)", PwszConfigFileName);
+			break;
+		}
+		if (0 == ullFileSize)
+			break;
+
+		// Read whole file
+		unReturnValue = FileIO_ReadFileToBuffer(PwszConfigFileName, &rgbConfigFileContent, &unConfigFileContentSize);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"FileIO_ReadFileToBuffer failed to read the config file (%ls)", PwszConfigFileName);
+			break;
+		}
+
+		// UTF-16 and UTF-32 encoded files are still widened and parsed line by line
+		if (unConfigFileContentSize >= 2 &&
+				((0xFF == rgbConfigFileContent[0] && 0xFE == rgbConfigFileContent[1]) ||
+				 (0xFE == rgbConfigFileContent[0] && 0xFF == rgbConfigFileContent[1]) ||
+				 (unConfigFileContentSize >= 4 && 0x00 == rgbConfigFileContent[0] && 0x00 == rgbConfigFileContent[1] &&
+				  0xFE == rgbConfigFileContent[2] && 0xFF == rgbConfigFileContent[3])))
+		{
+			unReturnValue = FileIO_ReadFileToStringBuffer(PwszConfigFileName, &wszConfigFileContent, &unConfigFileContentSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(unReturnValue, L"FileIO_ReadFileToStringBuffer failed to read the config file (%ls)", PwszConfigFileName);
+				break;
+			}
+			if (PLATFORM_STRING_IS_NULL_OR_EMPTY(wszConfigFileContent) ||
+					0 == unConfigFileContentSize)
+				break;
+
+			// Increase content size by one due to null-termination
+			unConfigFileContentSize++;
+
+			unReturnValue = Config_ParseContent(wszConfigFileContent, unConfigFileContentSize, PpfParse);
+			break;
+		}
+
+		// Skip the UTF-8 BOM if present
+		if (unConfigFileContentSize >= 3 && 0xEF == rgbConfigFileContent[0] && 0xBB == rgbConfigFileContent[1] && 0xBF == rgbConfigFileContent[2])
+			unContentOffset = 3;
+
+		// Now tokenize the raw file content
+		unReturnValue = Config_ParseContentUtf8(&rgbConfigFileContent[unContentOffset], unConfigFileContentSize - unContentOffset, PpfParse);
+	}
+	WHILE_FALSE_END;
+
+	// Free allocated memory
+	Platform_MemoryFree((void**)&wszConfigFileContent);
+	Platform_MemoryFree((void**)&rgbConfigFileContent);
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Parse the configuration file
  *	@details	This function reads the config file, parses the key value pairs and
- *				stores these pairs in the PropertyStorage.
+ *				stores these pairs in the PropertyStorage. UTF-8 files are tokenized directly from the raw bytes,
+ *				UTF-16 files are widened and parsed line by line.
  *
  *	@param		PwszConfigFileName		Pointer to a wide character configuration file name
  *	@param		PpfInitializeParsing	Function pointer to a Initialize parsing function
@@ -67,8 +156,6 @@ Config_ParseCustom(
 	_In_opt_	IConfigSettings_Parse				PpfParse)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	wchar_t* wszConfigFileContent = NULL;
-	unsigned int unConfigFileContentSize = 0;
 
 	do
 	{
@@ -89,38 +176,573 @@ Config_ParseCustom(
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Read whole file
-		unReturnValue = FileIO_ReadFileToStringBuffer(PwszConfigFileName, &wszConfigFileContent, &unConfigFileContentSize);
+		unReturnValue = Config_ParseFile(PwszConfigFileName, PpfParse);
+	}
+	WHILE_FALSE_END;
+
+	// Finalize parsing
+	if (NULL == PpfFinalizeParsing)
+		unReturnValue = ConfigSettings_FinalizeParsing(unReturnValue);
+	else
+		unReturnValue = PpfFinalizeParsing(unReturnValue);
+
+	return unReturnValue;
+}
+
+/// Section digests taken or compared by the running Config_Reload
+static IfxConfigDigest* s_psReloadDigest = NULL;
+/// Parsing function re-ingesting the changed sections of the running Config_Reload
+static IConfigSettings_Parse s_pfReloadParse = NULL;
+
+/**
+ *	@brief		Finds a section in the section digests
+ *	@details
+ *
+ *	@param		PpsDigest			Section digests
+ *	@param		PwszSection			Section name
+ *	@param		PunSectionSize		Size of the section buffer in elements including the zero termination
+ *
+ *	@returns	The digest of the section, NULL if the section is not contained
+ */
+static IfxConfigSectionDigest*
+Config_FindSection(
+	_In_							IfxConfigDigest*	PpsDigest,
+	_In_z_count_(PunSectionSize)	const wchar_t*		PwszSection,
+	_In_							unsigned int		PunSectionSize)
+{
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < PpsDigest->unCount; unIndex++)
+	{
+		if (0 == Platform_StringCompare(PpsDigest->rgsSections[unIndex].wszSection, PwszSection, PunSectionSize < MAX_NAME ? PunSectionSize : MAX_NAME, FALSE))
+			return &PpsDigest->rgsSections[unIndex];
+	}
+
+	return NULL;
+}
+
+/**
+ *	@brief		Adds a key value pair to the digest of its section
+ *	@details	Parsing function of the first Config_Reload pass. The digest is a FNV-1a hash over the keys and values of the
+ *				section in file order.
+ *
+ *	@param		PwszSection			Pointer to a wide character array containing the current section
+ *	@param		PunSectionSize		Size of the section buffer in elements including the zero termination
+ *	@param		PwszKey				Pointer to a wide character array containing the current key
+ *	@param		PunKeySize			Size of the key buffer in elements including the zero termination
+ *	@param		PwszValue			Pointer to a wide character array containing the current value
+ *	@param		PunValueSize		Size of the value buffer in elements including the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The file has more than CONFIG_MAX_SECTIONS sections or a section name is too long.
+ */
+_Check_return_
+static unsigned int
+Config_DigestEntry(
+	_In_z_count_(PunSectionSize)	const wchar_t*	PwszSection,
+	_In_							unsigned int	PunSectionSize,
+	_In_z_count_(PunKeySize)		const wchar_t*	PwszKey,
+	_In_							unsigned int	PunKeySize,
+	_In_z_count_(PunValueSize)		const wchar_t*	PwszValue,
+	_In_							unsigned int	PunValueSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxConfigSectionDigest* psSection = Config_FindSection(s_psReloadDigest, PwszSection, PunSectionSize);
+		unsigned int unIndex = 0;
+
+		if (NULL == psSection)
+		{
+			unsigned int unSectionSize = MAX_NAME;
+
+			if (CONFIG_MAX_SECTIONS == s_psReloadDigest->unCount)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				ERROR_STORE_FMT(unReturnValue, L"The config file has more than %u sections.", CONFIG_MAX_SECTIONS);
+				break;
+			}
+			psSection = &s_psReloadDigest->rgsSections[s_psReloadDigest->unCount];
+			unReturnValue = Platform_StringCopy(psSection->wszSection, &unSectionSize, PwszSection);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Section name is too long.");
+				break;
+			}
+			psSection->ullDigest = 14695981039346656037ULL;
+			s_psReloadDigest->unCount++;
+		}
+
+		for (unIndex = 0; unIndex < PunKeySize && L'\0' != PwszKey[unIndex]; unIndex++)
+			psSection->ullDigest = (psSection->ullDigest ^ (unsigned long long)PwszKey[unIndex]) * 1099511628211ULL;
+		psSection->ullDigest = (psSection->ullDigest ^ L'=') * 1099511628211ULL;
+		for (unIndex = 0; unIndex < PunValueSize && L'\0' != PwszValue[unIndex]; unIndex++)
+			psSection->ullDigest = (psSection->ullDigest ^ (unsigned long long)PwszValue[unIndex]) * 1099511628211ULL;
+		psSection->ullDigest = (psSection->ullDigest ^ L'\n') * 1099511628211ULL;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Passes a key value pair of a changed section to the parsing function
+ *	@details	Parsing function of the second Config_Reload pass, the key value pairs of the other sections are skipped.
+ *
+ *	@param		PwszSection			Pointer to a wide character array containing the current section
+ *	@param		PunSectionSize		Size of the section buffer in elements including the zero termination
+ *	@param		PwszKey				Pointer to a wide character array containing the current key
+ *	@param		PunKeySize			Size of the key buffer in elements including the zero termination
+ *	@param		PwszValue			Pointer to a wide character array containing the current value
+ *	@param		PunValueSize		Size of the value buffer in elements including the zero termination
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from the parsing function.
+ */
+_Check_return_
+static unsigned int
+Config_ReloadEntry(
+	_In_z_count_(PunSectionSize)	const wchar_t*	PwszSection,
+	_In_							unsigned int	PunSectionSize,
+	_In_z_count_(PunKeySize)		const wchar_t*	PwszKey,
+	_In_							unsigned int	PunKeySize,
+	_In_z_count_(PunValueSize)		const wchar_t*	PwszValue,
+	_In_							unsigned int	PunValueSize)
+{
+	const IfxConfigSectionDigest* psSection = Config_FindSection(s_psReloadDigest, PwszSection, PunSectionSize);
+
+	if (NULL == psSection || !psSection->fApply)
+		return RC_SUCCESS;
+
+	return s_pfReloadParse(PwszSection, PunSectionSize, PwszKey, PunKeySize, PwszValue, PunValueSize);
+}
+
+/**
+ *	@brief		Reload the changed sections of the configuration file
+ *	@details	Compares the section digests of the file with the digests of the last call. For every changed, added or
+ *				removed section the reload function decides whether the section is re-ingested and drops the state derived
+ *				from it. Only the key value pairs of the re-ingested sections are passed to the parsing function, the other
+ *				settings and everything derived from them are left as they are. The first call on an invalid digest only
+ *				takes the digests of the file parsed before.
+ *
+ *	@param		PwszConfigFileName		Pointer to a wide character configuration file name
+ *	@param		PpsDigest				In: Section digests of the last call\n
+ *										Out: Section digests of the file, unchanged on error
+ *	@param		PpfReloadSection		Function pointer to a Reload section function
+ *	@param		PpfParse				Function pointer to a Parsing function
+ *	@param		PpunReloaded			Receives the number of re-ingested sections
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. E.g. NULL or empty file name
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The file has more than CONFIG_MAX_SECTIONS sections.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Config_Reload(
+	_In_z_		const wchar_t*					PwszConfigFileName,
+	_Inout_		IfxConfigDigest*				PpsDigest,
+	_In_opt_	IConfigSettings_ReloadSection	PpfReloadSection,
+	_In_opt_	IConfigSettings_Parse			PpfParse,
+	_Out_		unsigned int*					PpunReloaded)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxConfigDigest* psDigest = NULL;
+
+	do
+	{
+		unsigned int unIndex = 0;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszConfigFileName) || NULL == PpsDigest || NULL == PpunReloaded)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"One or more input parameters are NULL or empty.");
+			break;
+		}
+		*PpunReloaded = 0;
+
+		psDigest = (IfxConfigDigest*)Platform_MemoryAllocateZero(sizeof(IfxConfigDigest));
+		if (NULL == psDigest)
+		{
+			ERROR_STORE(unReturnValue, L"Memory allocation for the config section digests failed.");
+			break;
+		}
+		psDigest->fValid = TRUE;
+
+		// First pass: take the section digests
+		s_psReloadDigest = psDigest;
+		unReturnValue = Config_ParseFile(PwszConfigFileName, Config_DigestEntry);
+		if (RC_SUCCESS != unReturnValue || !PpsDigest->fValid)
+			break;
+
+		// Let the application decide on the changed and added sections ...
+		for (unIndex = 0; unIndex < psDigest->unCount; unIndex++)
+		{
+			IfxConfigSectionDigest* psSection = &psDigest->rgsSections[unIndex];
+			const IfxConfigSectionDigest* psPrevious = Config_FindSection(PpsDigest, psSection->wszSection, MAX_NAME);
+
+			if (NULL != psPrevious && psPrevious->ullDigest == psSection->ullDigest)
+				continue;
+			if (NULL == PpfReloadSection)
+				unReturnValue = ConfigSettings_ReloadSection(psSection->wszSection, MAX_NAME, FALSE, &psSection->fApply);
+			else
+				unReturnValue = PpfReloadSection(psSection->wszSection, MAX_NAME, FALSE, &psSection->fApply);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (psSection->fApply)
+				(*PpunReloaded)++;
+		}
 		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// ... and on the removed sections
+		for (unIndex = 0; unIndex < PpsDigest->unCount; unIndex++)
 		{
-			if (RC_E_FILE_NOT_FOUND == unReturnValue)
-				unReturnValue = RC_SUCCESS;
+			BOOL fApply = FALSE;
+
+			if (NULL != Config_FindSection(psDigest, PpsDigest->rgsSections[unIndex].wszSection, MAX_NAME))
+				continue;
+			if (NULL == PpfReloadSection)
+				unReturnValue = ConfigSettings_ReloadSection(PpsDigest->rgsSections[unIndex].wszSection, MAX_NAME, TRUE, &fApply);
 			else
+				unReturnValue = PpfReloadSection(PpsDigest->rgsSections[unIndex].wszSection, MAX_NAME, TRUE, &fApply);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (fApply)
+				(*PpunReloaded)++;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Second pass: re-ingest the key value pairs of the changed sections
+		for (unIndex = 0; unIndex < psDigest->unCount && !psDigest->rgsSections[unIndex].fApply; unIndex++);
+		if (unIndex < psDigest->unCount)
+		{
+			s_pfReloadParse = NULL == PpfParse ? ConfigSettings_Parse : PpfParse;
+			unReturnValue = Config_ParseFile(PwszConfigFileName, Config_ReloadEntry);
+			s_pfReloadParse = NULL;
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	s_psReloadDigest = NULL;
+	if (RC_SUCCESS == unReturnValue)
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(PpsDigest, sizeof(IfxConfigDigest), psDigest, sizeof(IfxConfigDigest)));
+	Platform_MemoryFree((void**)&psDigest);
+
+	return unReturnValue;
+}
+
+/// Maximum length of a config file line after comments and white characters have been removed
+#define CONFIG_MAX_LINE_LENGTH		(2 * MAX_STRING_1024)
+
+/**
+ *	@brief		Decodes one UTF-8 encoded character
+ *	@details
+ *
+ *	@param		PrgbContent			Pointer to the UTF-8 encoded content
+ *	@param		PunContentSize		Size of the content in bytes
+ *	@param		PpunIndex			In: Index of the first byte of the character\n
+ *									Out: Index of the byte following the character
+ *	@param		PpwchCharacter		Receives the decoded character
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_WRONG_ENCODING	The content is not valid UTF-8 or the character does not fit into a wchar_t.
+ */
+_Check_return_
+static unsigned int
+Config_DecodeUtf8Character(
+	_In_bytecount_(PunContentSize)	const BYTE*		PrgbContent,
+	_In_							unsigned int	PunContentSize,
+	_Inout_							unsigned int*	PpunIndex,
+	_Out_							wchar_t*		PpwchCharacter)
+{
+	unsigned int unReturnValue = RC_E_WRONG_ENCODING;
+
+	do
+	{
+		BYTE bLead = PrgbContent[*PpunIndex];
+		unsigned int unCodePoint = 0;
+		unsigned int unTrailCount = 0;
+		unsigned int unMinimum = 0;
+		unsigned int unTrail = 0;
+
+		if (bLead < 0x80)
+		{
+			unCodePoint = bLead;
+		}
+		else if (0xC0 == (bLead & 0xE0))
+		{
+			unCodePoint = bLead & 0x1F;
+			unTrailCount = 1;
+			unMinimum = 0x80;
+		}
+		else if (0xE0 == (bLead & 0xF0))
+		{
+			unCodePoint = bLead & 0x0F;
+			unTrailCount = 2;
+			unMinimum = 0x800;
+		}
+		else if (0xF0 == (bLead & 0xF8))
+		{
+			unCodePoint = bLead & 0x07;
+			unTrailCount = 3;
+			unMinimum = 0x10000;
+		}
+		else
+			break;
+
+		if (unTrailCount >= PunContentSize - *PpunIndex)
+			break;
+
+		for (unTrail = 1; unTrail <= unTrailCount; unTrail++)
+		{
+			BYTE bTrail = PrgbContent[*PpunIndex + unTrail];
+			if (0x80 != (bTrail & 0xC0))
+				break;
+			unCodePoint = (unCodePoint << 6) | (bTrail & 0x3F);
+		}
+		if (unTrail <= unTrailCount)
+			break;
+
+		// Reject overlong encodings, surrogates and characters a wchar_t cannot hold
+		if (unCodePoint < unMinimum || (unCodePoint >= 0xD800 && unCodePoint <= 0xDFFF) ||
+				unCodePoint > 0x10FFFF || unCodePoint > (unsigned int)WCHAR_MAX)
+			break;
+
+		*PpwchCharacter = (wchar_t)unCodePoint;
+		*PpunIndex += unTrailCount + 1;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Passes a tokenized config file line to the parsing function
+ *	@details	A line containing '[' followed by ']' sets the current section. Otherwise a line containing '=' is split into
+ *				key and value in place, both are passed as views into the line buffer.
+ *
+ *	@param		PwszLine				Line without comments and white characters (zero terminated, modified)
+ *	@param		PunLineLength			Length of the line in elements without zero termination
+ *	@param		PnOpenBracket			Index of the first '[' in the line or -1
+ *	@param		PnCloseBracket			Index of the first ']' in the line or -1
+ *	@param		PnEqualSign				Index of the first '=' in the line or -1
+ *	@param		PwszSectionName			In: Current section name, Out: New section name
+ *	@param		PpunSectionNameLength	In: Length of the current section name, Out: Length of the new section name
+ *	@param		PpfParse				Function pointer to a Parsing function
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The section name, the key or the value is too long.
+ *	@retval		...						Error codes from the parsing function.
+ */
+_Check_return_
+static unsigned int
+Config_ParseLine(
+	_Inout_z_cap_(CONFIG_MAX_LINE_LENGTH + 1)	wchar_t*				PwszLine,
+	_In_									unsigned int			PunLineLength,
+	_In_									int						PnOpenBracket,
+	_In_									int						PnCloseBracket,
+	_In_									int						PnEqualSign,
+	_Inout_z_cap_(MAX_STRING_1024)			wchar_t*				PwszSectionName,
+	_Inout_									unsigned int*			PpunSectionNameLength,
+	_In_opt_								IConfigSettings_Parse	PpfParse)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check if line contains a section
+		if (-1 != PnOpenBracket && -1 != PnCloseBracket && PnOpenBracket < PnCloseBracket)
+		{
+			unsigned int unCount = (unsigned int)(PnCloseBracket - PnOpenBracket - 1);
+			if (MAX_STRING_1024 <= unCount)
 			{
-				ERROR_STORE_FMT(unReturnValue, L"FileIO_ReadFileToStringBuffer failed to read the config file (%ls)", PwszConfigFileName);
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				ERROR_STORE(unReturnValue, L"Section name is too long.");
 				break;
 			}
-		}
-		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(wszConfigFileContent) ||
-				0 == unConfigFileContentSize)
+
+			unReturnValue = Platform_MemoryCopy(PwszSectionName, MAX_STRING_1024 * sizeof(wchar_t), &PwszLine[PnOpenBracket + 1], unCount * sizeof(wchar_t));
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Unexpected error during Platform_MemoryCopy.");
+				break;
+			}
+			PwszSectionName[unCount] = L'\0';
+			*PpunSectionNameLength = unCount;
 			break;
+		}
+
+		// Check if line contains a key value pair
+		if (-1 != PnEqualSign)
+		{
+			unsigned int unKeyLength = (unsigned int)PnEqualSign;
+			unsigned int unValueLength = PunLineLength - unKeyLength - 1;
+			// Sizes including the zero termination, the section buffer size if no section has been set yet
+			unsigned int unSectionNameSize = MAX_STRING_1024 > *PpunSectionNameLength ? *PpunSectionNameLength + 1 : MAX_STRING_1024;
+
+			if (MAX_STRING_1024 <= unKeyLength || MAX_STRING_1024 <= unValueLength)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				ERROR_STORE(unReturnValue, L"Key or value is too long.");
+				break;
+			}
 
-		// Increase content size by one due to null-termination
-		unConfigFileContentSize++;
+			// Terminate the key in place, the value is terminated by the line end
+			PwszLine[unKeyLength] = L'\0';
+
+			// Parse Key Value pair
+			if (NULL == PpfParse)
+				unReturnValue = ConfigSettings_Parse(PwszSectionName, unSectionNameSize, PwszLine, unKeyLength + 1, &PwszLine[unKeyLength + 1], unValueLength);
+			else
+				unReturnValue = PpfParse(PwszSectionName, unSectionNameSize, PwszLine, unKeyLength + 1, &PwszLine[unKeyLength + 1], unValueLength);
+			break;
+		}
 
-		// Now parse the file content
-		unReturnValue = Config_ParseContent(wszConfigFileContent, unConfigFileContentSize, PpfParse);
+		// Neither a section nor a key value pair, ignore the line
+		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
-	// Free allocated memory
-	Platform_MemoryFree((void**)&wszConfigFileContent);
+	return unReturnValue;
+}
 
-	// Finalize parsing
-	if (NULL == PpfFinalizeParsing)
-		unReturnValue = ConfigSettings_FinalizeParsing(unReturnValue);
-	else
-		unReturnValue = PpfFinalizeParsing(unReturnValue);
+/**
+ *	@brief		Parse UTF-8 config file content for settings
+ *	@details	Tokenizes the raw bytes in a single pass: comments ("//" except after ':', ";" and block comments) and white characters are
+ *				dropped, the remaining characters of a line are decoded into a line buffer and passed to the parsing function
+ *				as section, key and value views. The content ends at its size or at the first zero byte.
+ *
+ *	@param		PrgbContent		Pointer to the UTF-8 encoded configuration file content without BOM
+ *	@param		PunContentSize	Size of the content in bytes
+ *	@param		PpfParse		Function pointer to a Parsing function
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. E.g. NULL content
+ *	@retval		RC_E_WRONG_ENCODING		The content is not valid UTF-8.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	A line, section name, key or value is too long.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Config_ParseContentUtf8(
+	_In_bytecount_(PunContentSize)	const BYTE*				PrgbContent,
+	_In_							unsigned int			PunContentSize,
+	_In_opt_						IConfigSettings_Parse	PpfParse)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszSectionName[MAX_STRING_1024] = {0};
+		// The section buffer size is passed until the first section has been found
+		unsigned int unSectionNameLength = MAX_STRING_1024;
+		wchar_t wszLine[CONFIG_MAX_LINE_LENGTH + 1];
+		unsigned int unLineLength = 0;
+		int nOpenBracket = -1, nCloseBracket = -1, nEqualSign = -1;
+		BOOL fBlockComment = FALSE;
+		BOOL fLineComment = FALSE;
+		unsigned int unIndex = 0;
+
+		// Check parameters
+		if (NULL == PrgbContent)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Content is NULL");
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+		while (RC_SUCCESS == unReturnValue)
+		{
+			BYTE bCurrent = unIndex < PunContentSize ? PrgbContent[unIndex] : 0;
+			BYTE bNext = unIndex + 1 < PunContentSize ? PrgbContent[unIndex + 1] : 0;
+
+			// Line end or content end
+			if ('\n' == bCurrent || 0 == bCurrent)
+			{
+				if (0 < unLineLength)
+				{
+					wszLine[unLineLength] = L'\0';
+					unReturnValue = Config_ParseLine(wszLine, unLineLength, nOpenBracket, nCloseBracket, nEqualSign, wszSectionName, &unSectionNameLength, PpfParse);
+				}
+				unLineLength = 0;
+				nOpenBracket = nCloseBracket = nEqualSign = -1;
+				fLineComment = FALSE;
+				if (0 == bCurrent)
+					break;
+				unIndex++;
+				continue;
+			}
+
+			// Skip comments, a block comment may span several lines
+			if (fLineComment)
+			{
+				unIndex++;
+				continue;
+			}
+			if (fBlockComment)
+			{
+				if ('*' == bCurrent && '/' == bNext)
+				{
+					fBlockComment = FALSE;
+					unIndex++;
+				}
+				unIndex++;
+				continue;
+			}
+			// "//" after a colon is part of a URL (e.g. https://) and no comment
+			if (('/' == bCurrent && '/' == bNext && !(0 < unLineLength && L':' == wszLine[unLineLength - 1])) || ';' == bCurrent)
+			{
+				fLineComment = TRUE;
+				unIndex++;
+				continue;
+			}
+			if ('/' == bCurrent && '*' == bNext)
+			{
+				fBlockComment = TRUE;
+				unIndex += 2;
+				continue;
+			}
+
+			// Skip white characters
+			if (' ' == bCurrent || '\t' == bCurrent || '\r' == bCurrent)
+			{
+				unIndex++;
+				continue;
+			}
+
+			if (CONFIG_MAX_LINE_LENGTH <= unLineLength)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				ERROR_STORE(unReturnValue, L"Config file line is too long.");
+				break;
+			}
+
+			// Remember the first delimiters of the line
+			if ('[' == bCurrent && -1 == nOpenBracket)
+				nOpenBracket = (int)unLineLength;
+			else if (']' == bCurrent && -1 == nCloseBracket)
+				nCloseBracket = (int)unLineLength;
+			else if ('=' == bCurrent && -1 == nEqualSign)
+				nEqualSign = (int)unLineLength;
+
+			unReturnValue = Config_DecodeUtf8Character(PrgbContent, PunContentSize, &unIndex, &wszLine[unLineLength]);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(unReturnValue, L"Config file content is not UTF-8 encoded. (Offset: %u)", unIndex);
+				break;
+			}
+			unLineLength++;
+		}
+	}
+	WHILE_FALSE_END;
 
 	return unReturnValue;
 }
@@ -164,21 +786,28 @@ Config_ParseContent(
 			break;
 		}
 
+		// Allocate one line buffer for all lines, no line can be longer than the content
+		wszLine = (wchar_t*)Platform_MemoryAllocateZero((PunContentSize + 1) * sizeof(wchar_t));
+		if (NULL == wszLine)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Unexpected error occurred during memory allocation.");
+			break;
+		}
+
 		// Loop over the lines
 		do
 		{
+			const wchar_t* pwszLine = NULL;
 			unsigned int unLineSize = 0;
 			BOOL fFlag = FALSE;
 
-			// Free memory before read the next line
-			Platform_MemoryFree((void**)&wszLine);
-
 			// Get line from buffer
-			unReturnValue = Utility_StringGetLine(
+			unReturnValue = Utility_StringGetLineView(
 								PwszContent,
 								PunContentSize,
 								&unIndex,
-								&wszLine,
+								&pwszLine,
 								&unLineSize);
 			if (RC_SUCCESS != unReturnValue)
 			{
@@ -189,6 +818,19 @@ Config_ParseContent(
 				break;
 			}
 
+			// Copy the line to the line buffer since it is changed by the following functions
+			if (0 < unLineSize)
+			{
+				unReturnValue = Platform_MemoryCopy(wszLine, (PunContentSize + 1) * sizeof(wchar_t), pwszLine, unLineSize * sizeof(wchar_t));
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE(unReturnValue, L"Unexpected error occurred during memory copy.");
+					break;
+				}
+			}
+			wszLine[unLineSize] = L'\0';
+			unLineSize++;
+
 			// Remove comments
 			unReturnValue = Utility_StringRemoveComment(
 								wszLine,
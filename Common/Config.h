@@ -21,6 +21,31 @@
 extern "C" {
 #endif
 
+/// Maximum number of sections of a configuration file reloaded by Config_Reload
+#define CONFIG_MAX_SECTIONS		32
+
+/// Digest of a configuration file section
+typedef struct tdIfxConfigSectionDigest
+{
+	/// Section name
+	wchar_t wszSection[MAX_NAME];
+	/// FNV-1a hash over the keys and values of the section in file order
+	unsigned long long ullDigest;
+	/// TRUE if the section is re-ingested by the running Config_Reload
+	BOOL fApply;
+} IfxConfigSectionDigest;
+
+/// Section digests of a configuration file taken by Config_Reload
+typedef struct tdIfxConfigDigest
+{
+	/// TRUE if the digests have been taken
+	BOOL fValid;
+	/// Number of sections
+	unsigned int unCount;
+	/// Section digests
+	IfxConfigSectionDigest rgsSections[CONFIG_MAX_SECTIONS];
+} IfxConfigDigest;
+
 /**
  *	@brief		Parse the configuration file
  *	@details	This function reads the config file, parses the key value pairs and
@@ -81,6 +106,58 @@ Config_ParseContent(
 	_In_							unsigned int			PunContentSize,
 	_In_opt_						IConfigSettings_Parse	PpfParse);
 
+/**
+ *	@brief		Parse UTF-8 config file content for settings
+ *	@details	Tokenizes the raw bytes in a single pass: comments ("//", ";" and block comments) and white characters are
+ *				dropped, the remaining characters of a line are decoded into a line buffer and passed to the parsing function
+ *				as section, key and value views. The content ends at its size or at the first zero byte.
+ *
+ *	@param		PrgbContent		Pointer to the UTF-8 encoded configuration file content without BOM
+ *	@param		PunContentSize	Size of the content in bytes
+ *	@param		PpfParse		Function pointer to a Parsing function
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. E.g. NULL content
+ *	@retval		RC_E_WRONG_ENCODING		The content is not valid UTF-8.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	A line, section name, key or value is too long.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Config_ParseContentUtf8(
+	_In_bytecount_(PunContentSize)	const BYTE*				PrgbContent,
+	_In_							unsigned int			PunContentSize,
+	_In_opt_						IConfigSettings_Parse	PpfParse);
+
+/**
+ *	@brief		Reload the changed sections of the configuration file
+ *	@details	Compares the section digests of the file with the digests of the last call. For every changed, added or
+ *				removed section the reload function decides whether the section is re-ingested and drops the state derived
+ *				from it. Only the key value pairs of the re-ingested sections are passed to the parsing function, the other
+ *				settings and everything derived from them are left as they are. The first call on an invalid digest only
+ *				takes the digests of the file parsed before.
+ *
+ *	@param		PwszConfigFileName		Pointer to a wide character configuration file name
+ *	@param		PpsDigest				In: Section digests of the last call\n
+ *										Out: Section digests of the file, unchanged on error
+ *	@param		PpfReloadSection		Function pointer to a Reload section function
+ *	@param		PpfParse				Function pointer to a Parsing function
+ *	@param		PpunReloaded			Receives the number of re-ingested sections
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. E.g. NULL or empty file name
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The file has more than CONFIG_MAX_SECTIONS sections.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Config_Reload(
+	_In_z_		const wchar_t*					PwszConfigFileName,
+	_Inout_		IfxConfigDigest*				PpsDigest,
+	_In_opt_	IConfigSettings_ReloadSection	PpfReloadSection,
+	_In_opt_	IConfigSettings_Parse			PpfParse,
+	_Out_		unsigned int*					PpunReloaded);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -19,6 +19,115 @@
 
 #define MESSAGE_PAGE_BREAK	L"\n   *** Press Any Key ***"
 
+/// Output buffer filled between ConsoleIO_BeginOutput and ConsoleIO_FlushOutput (fits into one ConsoleIO_WritePlatform call)
+static wchar_t s_wszOutputBuffer[PRINT_BUFFER_SIZE] = {0};
+/// Count of characters in the output buffer
+static unsigned int s_unOutputLength = 0;
+/// Flag if the console output is collected in the output buffer
+static BOOL s_fOutputCollected = FALSE;
+
+/**
+ *	@brief		Writes the output buffer to the console
+ *	@details	The output buffer is emptied but the output is still collected.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from ConsoleIO_WritePlatform.
+ */
+_Check_return_
+static unsigned int
+ConsoleIO_WriteOutputBuffer()
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	if (0 != s_unOutputLength)
+	{
+		unReturnValue = ConsoleIO_WritePlatform(FALSE, L"%ls", s_wszOutputBuffer);
+		s_unOutputLength = 0;
+		s_wszOutputBuffer[0] = L'\0';
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Appends formatted output to the output buffer
+ *	@details
+ *
+ *	@param		PfNewLine				Append a new line if TRUE.
+ *	@param		PwszFormat				Format control.
+ *	@param		PargList				Optional argument list.
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The remaining output buffer is too small, nothing has been appended.
+ */
+_Check_return_
+static unsigned int
+ConsoleIO_AppendOutputBuffer(
+	_In_	BOOL			PfNewLine,
+	_In_z_	const wchar_t*	PwszFormat,
+	_In_	va_list			PargList)
+{
+	unsigned int unReturnValue = RC_E_BUFFER_TOO_SMALL;
+
+	do
+	{
+		int nWritten = 0;
+		unsigned int unRemaining = RG_LEN(s_wszOutputBuffer) - s_unOutputLength;
+
+		if (PwszFormat[0] != L'\0')
+		{
+			nWritten = vswprintf(&s_wszOutputBuffer[s_unOutputLength], unRemaining, PwszFormat, PargList);
+			if (nWritten < 0)
+				break;
+		}
+		if (PfNewLine)
+		{
+			// Keep space for the new line and the zero termination
+			if ((unsigned int)nWritten + 2 > unRemaining)
+				break;
+			s_wszOutputBuffer[s_unOutputLength + nWritten++] = L'\n';
+		}
+
+		s_unOutputLength += nWritten;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Drop a partially appended message
+	s_wszOutputBuffer[s_unOutputLength] = L'\0';
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Starts collecting the console output
+ *	@details	All following ConsoleIO_Write calls without page break are rendered into one output buffer
+ *				instead of being written to the console line by line. The collected output is written with
+ *				ConsoleIO_FlushOutput. If the buffer runs full it is written to the console and reused.
+ */
+void
+ConsoleIO_BeginOutput()
+{
+	s_unOutputLength = 0;
+	s_wszOutputBuffer[0] = L'\0';
+	s_fOutputCollected = TRUE;
+}
+
+/**
+ *	@brief		Writes the collected console output
+ *	@details	Writes the output collected since ConsoleIO_BeginOutput in a single call to the console
+ *				and stops collecting.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from ConsoleIO_WritePlatform.
+ */
+_Check_return_
+unsigned int
+ConsoleIO_FlushOutput()
+{
+	s_fOutputCollected = FALSE;
+	return ConsoleIO_WriteOutputBuffer();
+}
+
 /**
  *	@brief		Handles the page break functionality
  *	@details	Handles the page break functionality and prints one line to the console out.
@@ -38,7 +147,6 @@ ConsoleIO_HandlePageBreak(
 	_In_							unsigned int	PunMessagesize)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	wchar_t* wszLine = NULL;
 	do
 	{
 		unsigned int unIndex = 0;
@@ -53,26 +161,22 @@ ConsoleIO_HandlePageBreak(
 		// Loop over all Lines in the message
 		do
 		{
-			unsigned int unLineSize = 0;
-
-			// Free memory before read the next line
-			Platform_MemoryFree((void**)&wszLine);
+			const wchar_t* pwszLine = NULL;
+			unsigned int unLineLength = 0;
 
 			// Get line from buffer
-			unReturnValue = Utility_StringGetLine(
+			unReturnValue = Utility_StringGetLineView(
 								PwszMessage,
 								PunMessagesize,
 								&unIndex,
-								&wszLine,
-								&unLineSize);
+								&pwszLine,
+								&unLineLength);
 			if (RC_SUCCESS != unReturnValue)
 			{
 				if (RC_E_END_OF_STRING == unReturnValue)
 					unReturnValue = RC_SUCCESS;
 				break;
 			}
-			if (NULL == wszLine)
-				continue;
 
 			// Check if Page break reached
 			if (g_unPageBreakCount + 3 >= g_unPageBreakMax)
@@ -92,8 +196,8 @@ ConsoleIO_HandlePageBreak(
 				g_unPageBreakCount = 0;
 			}
 
-			// Print out the line
-			unReturnValue = ConsoleIO_WritePlatform(PfNewLine, wszLine);
+			// Print out the line, it is not zero terminated
+			unReturnValue = ConsoleIO_WritePlatform(PfNewLine, L"%.*ls", (int)unLineLength, pwszLine);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
@@ -103,9 +207,6 @@ ConsoleIO_HandlePageBreak(
 	}
 	WHILE_FALSE_END;
 
-	// Free allocated memory
-	Platform_MemoryFree((void**)&wszLine);
-
 	return unReturnValue;
 }
 
@@ -147,6 +248,35 @@ ConsoleIO_Write(
 		{
 			va_list vaArgPtr;
 
+			// Collect the output if requested, a full buffer is written and reused
+			if (FALSE == PfPageBreak && s_fOutputCollected)
+			{
+				va_start(vaArgPtr, PwszFormat);
+				unReturnValue = ConsoleIO_AppendOutputBuffer(PfNewLine, PwszFormat, vaArgPtr);
+				va_end(vaArgPtr);
+				if (RC_E_BUFFER_TOO_SMALL != unReturnValue)
+					break;
+
+				unReturnValue = ConsoleIO_WriteOutputBuffer();
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				va_start(vaArgPtr, PwszFormat);
+				unReturnValue = ConsoleIO_AppendOutputBuffer(PfNewLine, PwszFormat, vaArgPtr);
+				va_end(vaArgPtr);
+				if (RC_E_BUFFER_TOO_SMALL != unReturnValue)
+					break;
+
+				// The message does not fit into the empty buffer, write it directly
+			}
+			else if (s_fOutputCollected)
+			{
+				// Keep the order of the collected output and the page break output
+				unReturnValue = ConsoleIO_WriteOutputBuffer();
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+
 			// Check PageBreak functionality
 			if (FALSE == PfPageBreak)
 			{
@@ -196,6 +196,27 @@ ConsoleIO_HandlePageBreak(
 	_In_z_count_(PunMessagesize)	const wchar_t*	PwszMessage,
 	_In_							unsigned int	PunMessagesize);
 
+/**
+ *	@brief		Starts collecting the console output
+ *	@details	All following ConsoleIO_Write calls without page break are rendered into one output buffer
+ *				instead of being written to the console line by line. The collected output is written with
+ *				ConsoleIO_FlushOutput. If the buffer runs full it is written to the console and reused.
+ */
+void
+ConsoleIO_BeginOutput();
+
+/**
+ *	@brief		Writes the collected console output
+ *	@details	Writes the output collected since ConsoleIO_BeginOutput in a single call to the console
+ *				and stops collecting.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from ConsoleIO_WritePlatform.
+ */
+_Check_return_
+unsigned int
+ConsoleIO_FlushOutput();
+
 #ifdef __cplusplus
 }
 #endif
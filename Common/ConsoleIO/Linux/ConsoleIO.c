@@ -15,6 +15,7 @@
 #include <stdarg.h>
 #include <sys/ioctl.h>
 #include "ConsoleIO.h"
+#include "Platform.h"
 
 unsigned int g_unPageBreakCount = 0;
 unsigned int g_unPageBreakMax = 25;
@@ -101,7 +102,7 @@ ConsoleIO_ClearScreen()
 			break;
 	}
 	// Set cursor position to (0;0)
-	wprintf(L"\033[0;0H");
+	IGNORE_RETURN_VALUE(Platform_StringWriteStream(stdout, L"\033[0;0H", 6));
 	g_unPageBreakCount = 0;
 	return RC_SUCCESS;
 }
@@ -185,31 +186,21 @@ ConsoleIO_WritePlatformV(
 			break;
 		}
 
-		// Prepare string to write in buffer szBuf
-		nWritten = vswprintf(wszBuf, RG_LEN(wszBuf), PwszFormat, PargList);
+		// Prepare string to write in buffer szBuf, keep one element for the line break
+		nWritten = vswprintf(wszBuf, RG_LEN(wszBuf) - 1, PwszFormat, PargList);
 
-		switch (nWritten)
+		// If the buffer is too small write what fits to the buffer and return insufficient buffer error
+		unReturnValue = RC_SUCCESS;
+		if (-1 == nWritten)
 		{
-			case -1:
-				// Buffer is too small write what fits to the buffer and return
-				// insufficient buffer error
-				nWritten = wprintf(wszBuf);
-				if (PfNewLine)
-					nWritten = wprintf(L"\n");
-
-				unReturnValue = RC_E_BUFFER_TOO_SMALL;
-				break;
-
-			default:
-				// Message was formatted correctly
-				// print it to the stdout
-				nWritten = wprintf(wszBuf);
-				if (PfNewLine)
-					nWritten = wprintf(L"\n");
-
-				unReturnValue = RC_SUCCESS;
-				break;
+			nWritten = (int)wcsnlen(wszBuf, RG_LEN(wszBuf) - 1);
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
 		}
+
+		// Convert once and write the message and the line break in one go, stdout stays byte oriented
+		if (PfNewLine)
+			wszBuf[nWritten++] = L'\n';
+		IGNORE_RETURN_VALUE(Platform_StringWriteStream(stdout, wszBuf, (unsigned int)nWritten));
 		fflush(stdout);
 	}
 	WHILE_FALSE_END;
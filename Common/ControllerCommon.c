@@ -23,10 +23,229 @@
 #include "Config.h"
 #include "ConfigSettings.h"
 #include "TPM2_Shutdown.h"
+#include "Trace.h"
+#include "FlightRecorder.h"
+#include "Crypt.h"
+#include "FileIO.h"
+
+/// Duration of the phases run by Controller_Initialize
+static IfxPhaseTimings s_sInitializeTimings = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+static IfxPhaseTimings s_sInitializeCpuTimings = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+static IfxPhaseTimings s_sInitializeWaitTimings = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+/// Magic value identifying a settings snapshot file
+#define SETTINGS_SNAPSHOT_MAGIC		0x49465353
+/// Version of the settings snapshot file layout
+#define SETTINGS_SNAPSHOT_VERSION	1
+
+/// Header of the settings snapshot file, followed by the snapshot created by PropertyStorage_Serialize
+typedef struct tdIfxSettingsSnapshotHeader
+{
+	/// Magic value (SETTINGS_SNAPSHOT_MAGIC)
+	unsigned int			unMagic;
+	/// Layout version (SETTINGS_SNAPSHOT_VERSION)
+	unsigned int			unVersion;
+	/// Size of IfxPropertySnapshotElement, protects against a snapshot file written by another build
+	unsigned int			unElementSize;
+	/// Size of wchar_t, protects against a snapshot file written by another build
+	unsigned int			unCharSize;
+	/// SHA-256 over the sources of the settings: tool version, configuration file content and command line
+	BYTE					rgbSourcesDigest[SHA256_DIGEST_SIZE];
+	/// Size of the snapshot in bytes
+	unsigned int			unSnapshotSize;
+	/// CRC of the snapshot, detects a torn write of concurrent tool instances
+	unsigned int			unSnapshotCRC;
+} IfxSettingsSnapshotHeader;
+
+/**
+ *	@brief		Calculates the digest of the sources of the settings
+ *	@details	The digest covers the tool version, the content of the configuration file and all command line
+ *				arguments, so any change of them invalidates a settings snapshot.
+ *
+ *	@param		PnArgc				Parameter as provided in main()
+ *	@param		PrgwszArgv			Parameter as provided in main()
+ *	@param		PrgbDigest			Receives the SHA-256 digest
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+Controller_HashSettingsSources(
+	_In_							int						PnArgc,
+	_In_reads_z_(PnArgc)			const wchar_t* const	PrgwszArgv[],
+	_Out_bytecap_(SHA256_DIGEST_SIZE)	BYTE				PrgbDigest[SHA256_DIGEST_SIZE])
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvContext = NULL;
+	BYTE* rgbConfigFileContent = NULL;
+
+	do
+	{
+		unsigned int unConfigFileContentSize = 0;
+		int nArg = 0;
+
+		unReturnValue = Crypt_SHA256_Start(&pvContext);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Crypt_SHA256_Update(pvContext, (const BYTE*)APP_VERSION, sizeof(APP_VERSION));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Hash the size before the content, so a missing and an empty file differ from any content
+		if (TRUE == FileIO_Exists(CONFIG_FILE))
+		{
+			unReturnValue = FileIO_ReadFileToBuffer(CONFIG_FILE, &rgbConfigFileContent, &unConfigFileContentSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unConfigFileContentSize++;
+		}
+		unReturnValue = Crypt_SHA256_Update(pvContext, (const BYTE*)&unConfigFileContentSize, sizeof(unConfigFileContentSize));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (unConfigFileContentSize > 1)
+		{
+			unReturnValue = Crypt_SHA256_Update(pvContext, rgbConfigFileContent, unConfigFileContentSize - 1);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		// Hash the command line arguments including their zero termination
+		for (nArg = 1; nArg < PnArgc && RC_SUCCESS == unReturnValue; nArg++)
+		{
+			unsigned int unLength = 0;
+			unReturnValue = Platform_StringGetLength(PrgwszArgv[nArg], MAX_STRING_1024, &unLength);
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = Crypt_SHA256_Update(pvContext, (const BYTE*)PrgwszArgv[nArg], (unLength + 1) * sizeof(wchar_t));
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = Crypt_SHA256_Finish(&pvContext, PrgbDigest);
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvContext)
+		IGNORE_RETURN_VALUE(Crypt_SHA256_Finish(&pvContext, NULL));
+	Platform_MemoryFree((void**)&rgbConfigFileContent);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Restores the settings from the settings snapshot file
+ *	@details	The snapshot file is accepted if it has been written by this build from the same sources. A snapshot
+ *				which cannot be restored completely is discarded, so the caller can parse the sources instead.
+ *
+ *	@param		PrgbDigest			Digest of the sources calculated by Controller_HashSettingsSources
+ *
+ *	@retval		TRUE	The settings have been restored.
+ *	@retval		FALSE	The configuration file and the command line must be parsed.
+ */
+_Check_return_
+static BOOL
+Controller_LoadSettingsSnapshot(
+	_In_bytecount_(SHA256_DIGEST_SIZE)	const BYTE	PrgbDigest[SHA256_DIGEST_SIZE])
+{
+	BOOL fReturnValue = FALSE;
+	BYTE* rgbFile = NULL;
+
+	do
+	{
+		unsigned int unFileSize = 0;
+		unsigned int unCRC = 0;
+		IfxSettingsSnapshotHeader sHeader;
+
+		if (FALSE == FileIO_Exists(CONFIG_SNAPSHOT_FILE))
+			break;
+
+		// Load the whole snapshot file with one read
+		if (RC_SUCCESS != FileIO_ReadFileToBuffer(CONFIG_SNAPSHOT_FILE, &rgbFile, &unFileSize) ||
+				unFileSize < sizeof(sHeader) ||
+				RC_SUCCESS != Platform_MemoryCopy(&sHeader, sizeof(sHeader), rgbFile, sizeof(sHeader)))
+			break;
+
+		if (SETTINGS_SNAPSHOT_MAGIC != sHeader.unMagic ||
+				SETTINGS_SNAPSHOT_VERSION != sHeader.unVersion ||
+				sizeof(IfxPropertySnapshotElement) != sHeader.unElementSize ||
+				sizeof(wchar_t) != sHeader.unCharSize ||
+				0 != Platform_MemoryCompare(PrgbDigest, sHeader.rgbSourcesDigest, SHA256_DIGEST_SIZE) ||
+				unFileSize - sizeof(sHeader) != sHeader.unSnapshotSize ||
+				0 == sHeader.unSnapshotSize ||
+				RC_SUCCESS != Crypt_CRC(rgbFile + sizeof(sHeader), (int)sHeader.unSnapshotSize, &unCRC) ||
+				unCRC != sHeader.unSnapshotCRC)
+			break;
+
+		fReturnValue = PropertyStorage_Deserialize(rgbFile + sizeof(sHeader), sHeader.unSnapshotSize);
+		if (FALSE == fReturnValue)
+			PropertyStorage_ClearElements();
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&rgbFile);
+
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Stores the settings in the settings snapshot file
+ *	@details	Errors are logged only, because a missing snapshot file just causes the next call to parse the
+ *				configuration file and the command line again.
+ *
+ *	@param		PrgbDigest			Digest of the sources calculated by Controller_HashSettingsSources
+ */
+static void
+Controller_StoreSettingsSnapshot(
+	_In_bytecount_(SHA256_DIGEST_SIZE)	const BYTE	PrgbDigest[SHA256_DIGEST_SIZE])
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* rgbSnapshot = NULL;
+	void* pvFile = NULL;
+
+	do
+	{
+		IfxSettingsSnapshotHeader sHeader;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sHeader, 0, sizeof(sHeader)));
+		if (FALSE == PropertyStorage_Serialize(&rgbSnapshot, &sHeader.unSnapshotSize) ||
+				0 == sHeader.unSnapshotSize)
+			break;
+		unReturnValue = Crypt_CRC(rgbSnapshot, (int)sHeader.unSnapshotSize, &sHeader.unSnapshotCRC);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		sHeader.unMagic = SETTINGS_SNAPSHOT_MAGIC;
+		sHeader.unVersion = SETTINGS_SNAPSHOT_VERSION;
+		sHeader.unElementSize = sizeof(IfxPropertySnapshotElement);
+		sHeader.unCharSize = sizeof(wchar_t);
+		unReturnValue = Platform_MemoryCopy(sHeader.rgbSourcesDigest, sizeof(sHeader.rgbSourcesDigest), PrgbDigest, SHA256_DIGEST_SIZE);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_Open(CONFIG_SNAPSHOT_FILE, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sHeader, sizeof(sHeader));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, rgbSnapshot, sHeader.unSnapshotSize);
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+	Platform_MemoryFree((void**)&rgbSnapshot);
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL3_FMT(L"Could not write the settings snapshot file '%ls' (0x%.8X).", CONFIG_SNAPSHOT_FILE, unReturnValue);
+	}
+}
 
 /**
  *	@brief		This function initializes the applications's view and business layers.
  *	@details	This function utilizes the UI modules like CmdLineParser and initializes the DeviceManagement.
+ *				The settings of an unchanged configuration file and command line are restored from the settings
+ *				snapshot file instead of being parsed again.
  *
  *	@param		PnArgc			Parameter as provided in main()
  *	@param		PrgwszArgv		Parameter as provided in main()
@@ -43,35 +262,38 @@ Controller_Initialize(
 	unsigned int unReturnValue = RC_E_FAIL;
 	unsigned int unConsoleMode = CONSOLE_BUFFER_BIG;
 	BOOL fIsHelpSet = FALSE;
+	BOOL fSnapshotValid = FALSE;
+	BOOL fSnapshotLoaded = FALSE;
+	BYTE rgbSourcesDigest[SHA256_DIGEST_SIZE] = {0};
+	unsigned long long ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+	unsigned long long ullTime = ullStartTime;
+	IfxPhaseLoad sLoad;
 
 	// Logging not initialized yet
 
+	DeviceManagement_StartPhaseLoad(&sLoad);
 	do
 	{
-		BOOL fReturnValue = FALSE;
-
-		// Initialize the configuration module
-		unReturnValue = Config_Parse(CONFIG_FILE);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-
-		// Initialize and set file size check flag before first logging
-		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_CHECK_SIZE))
-			fReturnValue = PropertyStorage_ChangeBooleanValueByKey(PROPERTY_LOGGING_CHECK_SIZE, TRUE);
+		// Restore the settings from the snapshot if its sources are unchanged, otherwise initialize the configuration module
+		fSnapshotValid = RC_SUCCESS == Controller_HashSettingsSources(PnArgc, PrgwszArgv, rgbSourcesDigest);
+		if (TRUE == fSnapshotValid)
+			fSnapshotLoaded = Controller_LoadSettingsSnapshot(rgbSourcesDigest);
+		if (FALSE == fSnapshotLoaded)
+			unReturnValue = Config_Parse(CONFIG_FILE);
 		else
-			fReturnValue = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_LOGGING_CHECK_SIZE, TRUE);
-		if (FALSE == fReturnValue)
-		{
-			unReturnValue = RC_E_FAIL;
-			ERROR_STORE(unReturnValue, L"PropertyStorage error while changing/adding the file size check flag");
+			unReturnValue = RC_SUCCESS;
+		s_sInitializeTimings.ullConfigTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		s_sInitializeCpuTimings.ullConfigTime = sLoad.ullCpuTime;
+		s_sInitializeWaitTimings.ullConfigTime = sLoad.ullWaitTime;
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		}
 
 		// Now we can log
 		LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
 		// Get Console buffer mode
-		if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_CONSOLE_MODE, &unConsoleMode))
+		if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_CONSOLE_MODE, &unConsoleMode))
 		{
 			unReturnValue = RC_E_FAIL;
 			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetUIntegerValueByKey failed to get property '%ls'.", PROPERTY_CONSOLE_MODE);
@@ -81,22 +303,124 @@ Controller_Initialize(
 		ConsoleIO_InitConsole(unConsoleMode);
 
 		// Call command line parser
-		unReturnValue = CommandLine_Parse(PnArgc, PrgwszArgv);
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
+		if (FALSE == fSnapshotLoaded)
+			unReturnValue = CommandLine_Parse(PnArgc, PrgwszArgv);
+		s_sInitializeTimings.ullCommandLineTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		s_sInitializeCpuTimings.ullCommandLineTime = sLoad.ullCpuTime;
+		s_sInitializeWaitTimings.ullCommandLineTime = sLoad.ullWaitTime;
 		// Break if an error is occurred or help option is selected
 		if (RC_SUCCESS != unReturnValue ||
 			(TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_HELP, &fIsHelpSet) && TRUE == fIsHelpSet))
 			break;
 
+		// Keep the parsed settings for the next call with the same configuration file and command line
+		if (TRUE == fSnapshotLoaded)
+		{
+			LOGGING_WRITE_LEVEL3_FMT(L"Settings restored from the settings snapshot file '%ls'.", CONFIG_SNAPSHOT_FILE);
+		}
+		else if (TRUE == fSnapshotValid)
+			Controller_StoreSettingsSnapshot(rgbSourcesDigest);
+
+		// Open the trace file and add the phases run before
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_TRACE))
+		{
+			wchar_t wszTracePath[MAX_PATH] = {0};
+			unsigned int unTracePathSize = RG_LEN(wszTracePath);
+			IGNORE_RETURN_VALUE(PropertyStorage_GetValueByKey(PROPERTY_TRACE, wszTracePath, &unTracePathSize));
+			unReturnValue = Trace_Open(wszTracePath);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(unReturnValue, L"The trace file '%ls' cannot be written.", wszTracePath);
+				break;
+			}
+			Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"config", ullStartTime, s_sInitializeTimings.ullConfigTime, NULL);
+			Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"command line", ullTime, s_sInitializeTimings.ullCommandLineTime, NULL);
+		}
+
+		// Freeze the settings, so the asynchronous log writer and worker threads read them without a lock, later changes are copied on write
+		if (FALSE == PropertyStorage_Freeze())
+		{
+			LOGGING_WRITE_LEVEL1(L"The property storage could not be frozen.");
+		}
+
+		// Lower the scheduling before any thread is started, so the log writer and the worker threads inherit it
+		{
+			BOOL fBackground = FALSE;
+			if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_BACKGROUND, &fBackground) && TRUE == fBackground)
+			{
+				unsigned int unApplied = 0;
+				IGNORE_RETURN_VALUE(Platform_BackgroundBegin(&unApplied));
+				LOGGING_WRITE_LEVEL2_FMT(L"Background mode: idle CPU scheduling %ls, nice value %ls, idle I/O scheduling %ls, timer slack %ls",
+					0 != (unApplied & PLATFORM_BACKGROUND_IDLE) ? L"yes" : L"no",
+					0 != (unApplied & PLATFORM_BACKGROUND_NICE_VALUE) ? L"yes" : L"no",
+					0 != (unApplied & PLATFORM_BACKGROUND_IO_IDLE) ? L"yes" : L"no",
+					0 != (unApplied & PLATFORM_BACKGROUND_SLACK) ? L"yes" : L"no");
+			}
+		}
+
+		// Hand the log file over to the asynchronous log writer now that the log file path is final
+		Logging_StartAsync();
+
+		// Keep the recent TPM commands and errors for the post-mortem log
+		FlightRecorder_Open();
+
 		// Call the device management initialization
 		unReturnValue = DeviceManagement_Initialize();
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Connect to the TPM device
-		unReturnValue = DeviceManagement_Connect();
+		unReturnValue = Controller_Connect();
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Connects the TPM device and runs the product specific initialization tasks
+ *	@details	The TPM is not connected if the product can process the request without TPM access. Called by
+ *				Controller_Initialize and by a forked worker once its single TPM device path is set. The log file of
+ *				the TPM device is opened before (-device-log).
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_Connect()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxPhaseLoad sLoad;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Log the TPM device to a log file of its own if requested
+		unReturnValue = Controller_DevicesOpenLog();
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
+		// Connect to the TPM device unless the product can process the request without TPM access
+		if (TRUE == CommandFlow_Init_IsTpmAccessRequired())
+		{
+			unsigned long long ullTime = Platform_GetMonotonicTimeMicroSeconds();
+			DeviceManagement_StartPhaseLoad(&sLoad);
+			unReturnValue = DeviceManagement_Connect();
+			s_sInitializeTimings.ullConnectTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+			DeviceManagement_StopPhaseLoad(&sLoad);
+			s_sInitializeCpuTimings.ullConnectTime = sLoad.ullCpuTime;
+			s_sInitializeWaitTimings.ullConnectTime = sLoad.ullWaitTime;
+			Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"connect", ullTime, s_sInitializeTimings.ullConnectTime, NULL);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
 		// Execute product specific initialization tasks (for example the product may need to seed the RNG or initialize TPM I/O)
 		unReturnValue = CommandFlow_Init_Execute();
 	}
@@ -107,6 +431,36 @@ Controller_Initialize(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Disconnects the TPM device
+ *	@details	A TPM2.0 started up by this tool is shut down orderly before. Does nothing if the TPM is not connected.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_Disconnect()
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	if (TRUE == DeviceManagement_IsConnected())
+	{
+#if IFX_ENABLE_TPM20
+		if (PropertyStorage_ExistsElementById(PROPERTY_ID_CALL_SHUTDOWN_ON_EXIT))
+		{
+			// In case this tool started up the TPM successfully with TPM2_Startup, call TPM2_Shutdown to
+			// prevent unorderly shutdown of the TPM.
+			IGNORE_RETURN_VALUE(TSS_TPM2_Shutdown(TPM_SU_CLEAR));
+		}
+#endif
+
+		unReturnValue = DeviceManagement_Disconnect();
+	}
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		This function uninitializes the applications view and business layers.
  *	@details	This function uninitializes the DeviceManagement.
@@ -124,20 +478,9 @@ Controller_Uninitialize()
 		// Uninitialize
 		ConsoleIO_UnInitConsole();
 
-		// Check if Connected
-		if (TRUE == DeviceManagement_IsConnected())
-		{
-			if (PropertyStorage_ExistsElement(PROPERTY_CALL_SHUTDOWN_ON_EXIT))
-			{
-				// In case this tool started up the TPM successfully with TPM2_Startup, call TPM2_Shutdown to
-				// prevent unorderly shutdown of the TPM.
-				IGNORE_RETURN_VALUE(TSS_TPM2_Shutdown(TPM_SU_CLEAR));
-			}
-
-			unReturnValue = DeviceManagement_Disconnect();
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
+		unReturnValue = Controller_Disconnect();
+		if (RC_SUCCESS != unReturnValue)
+			break;
 
 		// Check if initialized
 		if (TRUE == DeviceManagement_IsInitialized())
@@ -150,5 +493,28 @@ Controller_Uninitialize()
 	}
 	WHILE_FALSE_END;
 
+	// The TPM commands of the disconnect are part of the trace
+	Trace_Close();
+	FlightRecorder_Close();
+
 	return unReturnValue;
+}
+
+/**
+ *	@brief		Returns the duration of the phases run by Controller_Initialize
+ *	@details	Sets the command line, configuration file and TPM connection times, the other members are set to zero.
+ *
+ *	@param		PpsTimings		Receives the phase timings
+ *	@param		PpsCpuTimings	Receives the host CPU time of the phases
+ *	@param		PpsWaitTimings	Receives the time of the phases spent waiting for the TPM
+ */
+void
+Controller_GetInitializeTimings(
+	_Out_	IfxPhaseTimings*	PpsTimings,
+	_Out_	IfxPhaseTimings*	PpsCpuTimings,
+	_Out_	IfxPhaseTimings*	PpsWaitTimings)
+{
+	*PpsTimings = s_sInitializeTimings;
+	*PpsCpuTimings = s_sInitializeCpuTimings;
+	*PpsWaitTimings = s_sInitializeWaitTimings;
 }
\ No newline at end of file
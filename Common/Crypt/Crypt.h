@@ -52,6 +52,26 @@ static const BYTE RSA_PUB_MODULUS_KEY_ID_0[]	= { 0xc9, 0x70, 0xa4, 0x12, 0x73, 0
 													0x7a, 0x1f, 0x03, 0xd4, 0x15, 0x10, 0xa8, 0xd6, 0xf9, 0x68, 0xc1, 0x75, 0x29, 0xa8, 0x85, 0xb1
 											   };
 
+/// Public modulus of the test key for firmware images updated on the TPM simulator (-access-mode 5 only).
+/// The private key is TPMFactoryUpd/perf/simulator-key.pem, it signs the images of the performance scenarios.
+static const BYTE RSA_PUB_MODULUS_SIMULATOR[]	= { 0x9a, 0xd4, 0xa2, 0xc2, 0x30, 0x23, 0x04, 0xea, 0x37, 0xf3, 0x6c, 0x42, 0x37, 0x1d, 0x31, 0xea,
+													0x15, 0x5d, 0x8c, 0x3d, 0x64, 0xa4, 0xcb, 0x1a, 0x81, 0xaf, 0x61, 0x3f, 0x56, 0xa7, 0xe7, 0x3b,
+													0x9e, 0x1b, 0x50, 0x4a, 0xe6, 0xc5, 0xa1, 0xcf, 0x03, 0xcb, 0x82, 0x59, 0xf2, 0xd0, 0x78, 0x1f,
+													0xe3, 0x5c, 0xa6, 0xa8, 0x3d, 0x8a, 0x94, 0x35, 0xcd, 0xa2, 0xff, 0xf4, 0xb0, 0x2e, 0x6c, 0xa5,
+													0xc5, 0xa2, 0xa2, 0x80, 0x63, 0xd1, 0x88, 0x8f, 0x26, 0x4e, 0xdc, 0x56, 0x54, 0x65, 0x79, 0x35,
+													0xb1, 0x29, 0x9a, 0x0c, 0x64, 0xc8, 0x47, 0xbd, 0x7e, 0x57, 0xf2, 0x8a, 0xf8, 0xad, 0x9e, 0x25,
+													0x05, 0x51, 0x16, 0xea, 0x8d, 0x50, 0x79, 0xe2, 0x08, 0xe0, 0x8b, 0xe5, 0xe2, 0xb7, 0x94, 0xbc,
+													0x50, 0x0e, 0xc6, 0x58, 0x63, 0xb1, 0xe8, 0x6d, 0x1b, 0xd1, 0x52, 0x73, 0x32, 0xa8, 0x9f, 0x4f,
+													0xde, 0xb0, 0x1e, 0x7f, 0xfc, 0xd9, 0xac, 0xb6, 0xfb, 0x88, 0x11, 0x3a, 0xa5, 0x2f, 0x67, 0xa2,
+													0x67, 0x21, 0xd1, 0x65, 0x91, 0x67, 0x04, 0x0b, 0x84, 0xee, 0x81, 0xe3, 0xf9, 0xc6, 0x45, 0xc0,
+													0x17, 0x1f, 0xac, 0xee, 0x7e, 0x2a, 0x7d, 0x27, 0x59, 0xe4, 0xb3, 0x64, 0xa7, 0xfb, 0x41, 0x16,
+													0x05, 0x2b, 0xb5, 0x21, 0x80, 0xa6, 0x15, 0x61, 0x02, 0x93, 0xb1, 0xa6, 0xe8, 0xe6, 0x79, 0x66,
+													0x8a, 0xcd, 0xff, 0x26, 0x14, 0xa5, 0xe5, 0xda, 0x80, 0xe6, 0xc4, 0xbc, 0x09, 0xb6, 0x60, 0xde,
+													0x8a, 0x17, 0x60, 0x18, 0xd8, 0x44, 0x2a, 0x98, 0xe3, 0x2f, 0x4d, 0xf8, 0xfc, 0xd4, 0xe5, 0x96,
+													0x59, 0xeb, 0xd5, 0xd9, 0x9a, 0xc7, 0x19, 0xb1, 0x4f, 0xc7, 0x43, 0x62, 0x71, 0x90, 0xfd, 0x8a,
+													0x77, 0x39, 0xba, 0xa1, 0x4d, 0x01, 0xbc, 0x21, 0xdd, 0xaf, 0x9b, 0x03, 0x3f, 0xd8, 0x11, 0x7d
+											   };
+
 /**
  *	@brief		Calculate HMAC-SHA-1 on the given message
  *	@details	This function calculates a HMAC-SHA-1 on the input message.
@@ -73,6 +93,71 @@ Crypt_HMAC(
 	_In_opt_bytecount_(SHA1_DIGEST_SIZE)	const BYTE		PrgbKey[SHA1_DIGEST_SIZE],
 	_Out_bytecap_(SHA1_DIGEST_SIZE)			BYTE			PrgbHMAC[SHA1_DIGEST_SIZE]);
 
+/**
+ *	@brief		Start an incremental HMAC-SHA-1 calculation
+ *	@details	Allocates a HMAC-SHA-1 context keyed with the given key. The context can be used for several messages
+ *				and must be released with Crypt_HMAC_Release.
+ *
+ *	@param		PrgbKey					Message authentication key
+ *	@param		PppvContext				Receives the HMAC-SHA-1 context
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext is NULL or *PppvContext is not NULL
+ */
+_Check_return_
+unsigned int
+Crypt_HMAC_Start(
+	_In_opt_bytecount_(SHA1_DIGEST_SIZE)	const BYTE		PrgbKey[SHA1_DIGEST_SIZE],
+	_Outptr_result_maybenull_				void**			PppvContext);
+
+/**
+ *	@brief		Add message data to an incremental HMAC-SHA-1 calculation
+ *	@details
+ *
+ *	@param		PpvContext				HMAC-SHA-1 context returned by Crypt_HMAC_Start
+ *	@param		PrgbInputMessage		Input message part
+ *	@param		PunInputMessageSize		Input message part size in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbInputMessage is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_HMAC_Update(
+	_Inout_								void*			PpvContext,
+	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
+	_In_								const UINT32	PunInputMessageSize);
+
+/**
+ *	@brief		Finish an incremental HMAC-SHA-1 calculation
+ *	@details	Returns the HMAC-SHA-1 of all message data added with Crypt_HMAC_Update since Crypt_HMAC_Start or the previous
+ *				call of this function. The context stays keyed for the next message.
+ *
+ *	@param		PpvContext				HMAC-SHA-1 context returned by Crypt_HMAC_Start
+ *	@param		PrgbHMAC				Receives the HMAC
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbHMAC is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_HMAC_Finish(
+	_Inout_							void*	PpvContext,
+	_Out_bytecap_(SHA1_DIGEST_SIZE)	BYTE	PrgbHMAC[SHA1_DIGEST_SIZE]);
+
+/**
+ *	@brief		Release a HMAC-SHA-1 context
+ *	@details
+ *
+ *	@param		PppvContext				HMAC-SHA-1 context returned by Crypt_HMAC_Start, set to NULL
+ */
+void
+Crypt_HMAC_Release(
+	_Inout_	void**	PppvContext);
+
 /**
  *	@brief		Calculate SHA-1 on the given data
  *	@details	This function calculates a SHA-1 hash on the given data stream.
@@ -92,6 +177,59 @@ Crypt_SHA1(
 	_In_								const UINT16	PusInputMessageSize,
 	_Out_bytecap_(SHA1_DIGEST_SIZE)		BYTE			PrgbSHA1[SHA1_DIGEST_SIZE]);
 
+/**
+ *	@brief		Start an incremental SHA-1 calculation
+ *	@details	Allocates and initializes a SHA-1 context. The context must be passed to Crypt_SHA1_Finish
+ *				to release it, also in case of an error.
+ *
+ *	@param		PppvContext				Receives the SHA-1 context
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext is NULL or *PppvContext is not NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA1_Start(
+	_Outptr_result_maybenull_	void**	PppvContext);
+
+/**
+ *	@brief		Add data to an incremental SHA-1 calculation
+ *	@details
+ *
+ *	@param		PpvContext				SHA-1 context returned by Crypt_SHA1_Start
+ *	@param		PrgbInputMessage		Input message part
+ *	@param		PunInputMessageSize		Input message part size in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbInputMessage is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA1_Update(
+	_Inout_								void*			PpvContext,
+	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
+	_In_								const UINT32	PunInputMessageSize);
+
+/**
+ *	@brief		Finish an incremental SHA-1 calculation
+ *	@details	Returns the SHA-1 of all data added with Crypt_SHA1_Update and releases the context. If
+ *				PrgbSHA1 is NULL the context is only released.
+ *
+ *	@param		PppvContext				SHA-1 context returned by Crypt_SHA1_Start, set to NULL
+ *	@param		PrgbSHA1				Receives the SHA-1 or NULL
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext or *PppvContext is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA1_Finish(
+	_Inout_								void**	PppvContext,
+	_Out_opt_bytecap_(SHA1_DIGEST_SIZE)	BYTE*	PrgbSHA1);
+
 /**
  *	@brief		Calculate SHA-256 on the given data
  *	@details	This function calculates a SHA-256 hash on the given data stream.
@@ -111,6 +249,59 @@ Crypt_SHA256(
 	_In_								const UINT32	PunInputMessageSize,
 	_Out_bytecap_(SHA256_DIGEST_SIZE)	BYTE			PrgbSHA256[SHA256_DIGEST_SIZE]);
 
+/**
+ *	@brief		Start an incremental SHA-256 calculation
+ *	@details	Allocates and initializes a SHA-256 context. The context must be passed to Crypt_SHA256_Finish
+ *				to release it, also in case of an error.
+ *
+ *	@param		PppvContext				Receives the SHA-256 context
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext is NULL or *PppvContext is not NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA256_Start(
+	_Outptr_result_maybenull_	void**	PppvContext);
+
+/**
+ *	@brief		Add data to an incremental SHA-256 calculation
+ *	@details
+ *
+ *	@param		PpvContext				SHA-256 context returned by Crypt_SHA256_Start
+ *	@param		PrgbInputMessage		Input message part
+ *	@param		PunInputMessageSize		Input message part size in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbInputMessage is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA256_Update(
+	_Inout_								void*			PpvContext,
+	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
+	_In_								const UINT32	PunInputMessageSize);
+
+/**
+ *	@brief		Finish an incremental SHA-256 calculation
+ *	@details	Returns the SHA-256 of all data added with Crypt_SHA256_Update and releases the context. If
+ *				PrgbSHA256 is NULL the context is only released.
+ *
+ *	@param		PppvContext				SHA-256 context returned by Crypt_SHA256_Start, set to NULL
+ *	@param		PrgbSHA256				Receives the SHA-256 or NULL
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext or *PppvContext is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA256_Finish(
+	_Inout_									void**	PppvContext,
+	_Out_opt_bytecap_(SHA256_DIGEST_SIZE)	BYTE*	PrgbSHA256);
+
 /**
  *	@brief		Seed the pseudo random number generator
  *	@details	This function seeds the pseudo random number generator.
@@ -130,7 +321,8 @@ Crypt_SeedRandom(
 
 /**
  *	@brief		Get random bytes from the pseudo random number generator
- *	@details	This function gets random bytes from the pseudo random number generator.
+ *	@details	This function gets random bytes from the pseudo random number generator. If Crypt_SeedRandom has not been
+ *				called yet, the generator is seeded with the default seed first.
  *
  *	@param		PusRandomSize			Number of bytes requested.
  *	@param		PrgbRandom				Receives pseudo random bytes.
@@ -207,7 +399,9 @@ Crypt_VerifySignature(
 
 /**
  *	@brief		Calculate the CRC value of the given data stream
- *	@details	The function calculates bitwise a CRC over a data stream
+ *	@details	The function calculates a CRC-32 over a data stream. Blocks of the data stream are processed with
+ *				carry-less multiplication folding (x86) or the CRC32 instructions (ARMv8) if the CPU supports them,
+ *				the rest is processed with slicing-by-8 lookup tables. All paths return bit-exact results.
  *
  *	@param		PpInputData			Data stream for CRC calculation
  *	@param		PnInputDataSize		Size if data to calculate the CRC
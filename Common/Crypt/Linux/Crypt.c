@@ -19,14 +19,209 @@
 #include "Crypt.h"
 
 #include <string.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <openssl/hmac.h>
 #include <openssl/rand.h>
 #include <openssl/rsa.h>
 #include <openssl/sha.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/// Shared object name of the libcrypto version the module was compiled against
+#if defined(OPENSSL_SHLIB_VERSION)
+#define CRYPT_LIBCRYPTO_NAME "libcrypto.so." CRYPT_STRINGIFY(OPENSSL_SHLIB_VERSION)
+#else
+#define CRYPT_LIBCRYPTO_NAME "libcrypto.so." SHLIB_VERSION_NUMBER
+#endif
+/// Helper macros to turn a numeric version into a string
+#define CRYPT_STRINGIFY(VALUE) CRYPT_STRINGIFY_VALUE(VALUE)
+#define CRYPT_STRINGIFY_VALUE(VALUE) #VALUE
+
+/// libcrypto functions used by this module, resolved on first use by Crypt_LoadLibCrypto
+#define CRYPT_LIBCRYPTO_FUNCTIONS(FUNCTION) \
+	FUNCTION(BN_bin2bn) \
+	FUNCTION(BN_free) \
+	FUNCTION(EVP_sha1) \
+	FUNCTION(EVP_sha256) \
+	FUNCTION(HMAC_CTX_free) \
+	FUNCTION(HMAC_CTX_new) \
+	FUNCTION(HMAC_Final) \
+	FUNCTION(HMAC_Init_ex) \
+	FUNCTION(HMAC_Update) \
+	FUNCTION(OPENSSL_cleanse) \
+	FUNCTION(RAND_bytes) \
+	FUNCTION(RAND_seed) \
+	FUNCTION(RAND_status) \
+	FUNCTION(RSA_free) \
+	FUNCTION(RSA_new) \
+	FUNCTION(RSA_padding_add_PKCS1_OAEP) \
+	FUNCTION(RSA_public_decrypt) \
+	FUNCTION(RSA_public_encrypt) \
+	FUNCTION(RSA_set0_key) \
+	FUNCTION(RSA_verify_PKCS1_PSS) \
+	FUNCTION(SHA1_Final) \
+	FUNCTION(SHA1_Init) \
+	FUNCTION(SHA1_Update) \
+	FUNCTION(SHA256_Final) \
+	FUNCTION(SHA256_Init) \
+	FUNCTION(SHA256_Update)
+
+/// Function pointer declaration with the prototype from the OpenSSL headers
+#define CRYPT_LIBCRYPTO_POINTER(NAME) __typeof__(&NAME) NAME;
+
+/// Resolved libcrypto functions
+static struct
+{
+	CRYPT_LIBCRYPTO_FUNCTIONS(CRYPT_LIBCRYPTO_POINTER)
+} s_sLibCrypto;
+
+/// State of the libcrypto loading
+typedef enum tdCRYPT_LIBCRYPTO_STATE
+{
+	/// Not yet loaded
+	CRYPT_LIBCRYPTO_STATE_UNLOADED = 0,
+	/// All functions resolved
+	CRYPT_LIBCRYPTO_STATE_LOADED,
+	/// Library or one of the functions not available, not retried
+	CRYPT_LIBCRYPTO_STATE_FAILED
+} CRYPT_LIBCRYPTO_STATE;
+
+/// libcrypto loading state
+static CRYPT_LIBCRYPTO_STATE s_unLibCryptoState = CRYPT_LIBCRYPTO_STATE_UNLOADED;
+/// Loads libcrypto exactly once, also if the first operations run concurrently on several threads
+static pthread_once_t s_sLibCryptoOnce = PTHREAD_ONCE_INIT;
+
+/// Whether the pseudo random number generator has been seeded
+static BOOL s_fRandomSeeded = FALSE;
+
+/// Size of the random pool, refilled by one generator call for about 50 TPM1.2 nonces
+#define CRYPT_RANDOM_POOL_SIZE 1024
+/// Largest request served from the random pool, larger requests call the generator directly
+#define CRYPT_RANDOM_POOL_MAX_REQUEST 64
+
+/// Random bytes generated in bulk and handed out by Crypt_GetRandom. Handed out bytes are wiped.
+static BYTE s_rgbRandomPool[CRYPT_RANDOM_POOL_SIZE];
+/// Offset of the next unused byte in s_rgbRandomPool, CRYPT_RANDOM_POOL_SIZE if the pool is empty
+static unsigned int s_unRandomPoolOffset = CRYPT_RANDOM_POOL_SIZE;
+/// Process which filled s_rgbRandomPool. A forked worker process must not hand out the same bytes as its parent.
+static pid_t s_nRandomPoolProcess = 0;
+/// Serializes the access to s_rgbRandomPool
+static pthread_mutex_t s_sRandomPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+
 /// OAEP Pad
 static const BYTE g_rgbOAEPPad[] = { 'T', 'C', 'P', 'A' };
 
+/// Lookup tables for the slicing-by-8 CRC calculation, built on first use
+static unsigned int s_rgunCrcTable[8][256];
+/// Builds s_rgunCrcTable and selects s_unCrcEngine exactly once
+static pthread_once_t s_sCrcOnce = PTHREAD_ONCE_INIT;
+
+/// CRC implementation selected on first use
+typedef enum tdCRYPT_CRC_ENGINE
+{
+	/// Not yet determined
+	CRYPT_CRC_ENGINE_UNKNOWN = 0,
+	/// Slicing-by-8 lookup tables
+	CRYPT_CRC_ENGINE_TABLE,
+	/// Carry-less multiplication folding (PCLMULQDQ) or ARMv8 CRC32 instructions
+	CRYPT_CRC_ENGINE_HARDWARE
+} CRYPT_CRC_ENGINE;
+
+/// CRC implementation used by Crypt_CRC
+static CRYPT_CRC_ENGINE s_unCrcEngine = CRYPT_CRC_ENGINE_UNKNOWN;
+
+/// HMAC context reused by Crypt_HMAC, allocated on first use
+static HMAC_CTX* s_psHmacContext = NULL;
+
+/// Key used for HMAC calculations without a key
+static const BYTE s_rgbZeroKey[SHA1_DIGEST_SIZE] = {0};
+
+/// Number of RSA public keys kept by Crypt_GetRSAPublicKey
+#define CRYPT_RSA_KEY_CACHE_SIZE 4
+
+/// RSA public key cache entry
+typedef struct tdCRYPT_RSA_KEY_CACHE_ENTRY
+{
+	/// SHA-256 over the public exponent and modulus
+	BYTE rgbKeyDigest[SHA256_DIGEST_SIZE];
+	/// RSA public key object or NULL if the entry is unused
+	RSA* pRSAPubKey;
+} CRYPT_RSA_KEY_CACHE_ENTRY;
+
+/// RSA public keys used by Crypt_EncryptRSA and Crypt_VerifySignature
+static CRYPT_RSA_KEY_CACHE_ENTRY s_rgsRsaKeyCache[CRYPT_RSA_KEY_CACHE_SIZE];
+/// Cache entry to be replaced next
+static unsigned int s_unRsaKeyCacheNext = 0;
+/// Serializes the lookup and replacement of s_rgsRsaKeyCache entries
+static pthread_mutex_t s_sRsaKeyCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *	@brief		Load libcrypto and resolve the used functions (run once through s_sLibCryptoOnce)
+ *	@details	Sets s_unLibCryptoState to CRYPT_LIBCRYPTO_STATE_LOADED or CRYPT_LIBCRYPTO_STATE_FAILED.
+ */
+static void
+Crypt_LoadLibCryptoOnce()
+{
+	s_unLibCryptoState = CRYPT_LIBCRYPTO_STATE_FAILED;
+
+	do
+	{
+		void* pvLibrary = NULL;
+		BOOL fResolved = TRUE;
+
+		pvLibrary = dlopen(CRYPT_LIBCRYPTO_NAME, RTLD_NOW | RTLD_LOCAL);
+		if (NULL == pvLibrary)
+			pvLibrary = dlopen("libcrypto.so", RTLD_NOW | RTLD_LOCAL);
+		if (NULL == pvLibrary)
+			break;
+
+		// Copy the symbol addresses into the typed function pointers
+#define CRYPT_LIBCRYPTO_RESOLVE(NAME) \
+		{ \
+			void* pvSymbol = dlsym(pvLibrary, #NAME); \
+			if (NULL == pvSymbol) \
+				fResolved = FALSE; \
+			memcpy(&s_sLibCrypto.NAME, &pvSymbol, sizeof(s_sLibCrypto.NAME)); \
+		}
+		CRYPT_LIBCRYPTO_FUNCTIONS(CRYPT_LIBCRYPTO_RESOLVE)
+#undef CRYPT_LIBCRYPTO_RESOLVE
+
+		if (!fResolved)
+		{
+			memset(&s_sLibCrypto, 0, sizeof(s_sLibCrypto));
+			dlclose(pvLibrary);
+			break;
+		}
+
+		s_unLibCryptoState = CRYPT_LIBCRYPTO_STATE_LOADED;
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Load libcrypto and resolve the used functions
+ *	@details	libcrypto is loaded on the first cryptographic operation, so that operations without cryptography
+ *				(e.g. -info) neither map nor initialize OpenSSL. A failed attempt is not repeated.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				libcrypto or one of the used functions is not available.
+ */
+_Check_return_
+static unsigned int
+Crypt_LoadLibCrypto()
+{
+	IGNORE_RETURN_VALUE(pthread_once(&s_sLibCryptoOnce, Crypt_LoadLibCryptoOnce));
+	return (CRYPT_LIBCRYPTO_STATE_LOADED == s_unLibCryptoState) ? RC_SUCCESS : RC_E_FAIL;
+}
+
 /**
  *	@brief		Calculate HMAC-SHA-1 on the given message
  *	@details	This function calculates a HMAC-SHA-1 on the input message.
@@ -50,7 +245,6 @@ Crypt_HMAC(
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
-	HMAC_CTX *sContext = HMAC_CTX_new();
 	do
 	{
 		unsigned int unHmacLength = SHA1_DIGEST_SIZE;
@@ -63,20 +257,197 @@ Crypt_HMAC(
 			break;
 		}
 
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// The context is kept for subsequent calls, passing the key resets it
+		if (NULL == s_psHmacContext)
+		{
+			s_psHmacContext = s_sLibCrypto.HMAC_CTX_new();
+			if (NULL == s_psHmacContext)
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+		}
+
 		// Calculate HMAC
-		HMAC_CTX_reset(sContext);
-		HMAC_Init_ex(sContext, PrgbKey, SHA1_DIGEST_SIZE, EVP_sha1(), NULL);
-		HMAC_Update(sContext, PrgbInputMessage, PusInputMessageSize);
-		HMAC_Final(sContext, PrgbHMAC, &unHmacLength);
+		if (1 != s_sLibCrypto.HMAC_Init_ex(s_psHmacContext, (NULL != PrgbKey) ? PrgbKey : s_rgbZeroKey, SHA1_DIGEST_SIZE, s_sLibCrypto.EVP_sha1(), NULL) ||
+				1 != s_sLibCrypto.HMAC_Update(s_psHmacContext, PrgbInputMessage, PusInputMessageSize) ||
+				1 != s_sLibCrypto.HMAC_Final(s_psHmacContext, PrgbHMAC, &unHmacLength))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Start an incremental HMAC-SHA-1 calculation
+ *	@details	Allocates a HMAC-SHA-1 context keyed with the given key. The context can be used for several messages
+ *				and must be released with Crypt_HMAC_Release.
+ *
+ *	@param		PrgbKey					Message authentication key
+ *	@param		PppvContext				Receives the HMAC-SHA-1 context
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext is NULL or *PppvContext is not NULL
+ */
+_Check_return_
+unsigned int
+Crypt_HMAC_Start(
+	_In_opt_bytecount_(SHA1_DIGEST_SIZE)	const BYTE		PrgbKey[SHA1_DIGEST_SIZE],
+	_Outptr_result_maybenull_				void**			PppvContext)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		HMAC_CTX* psContext = NULL;
+
+		// Check parameters
+		if (NULL == PppvContext || NULL != *PppvContext)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		psContext = s_sLibCrypto.HMAC_CTX_new();
+		if (NULL == psContext)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		*PppvContext = psContext;
+
+		if (1 != s_sLibCrypto.HMAC_Init_ex(psContext, (NULL != PrgbKey) ? PrgbKey : s_rgbZeroKey, SHA1_DIGEST_SIZE, s_sLibCrypto.EVP_sha1(), NULL))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
-	HMAC_CTX_free(sContext);
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Add message data to an incremental HMAC-SHA-1 calculation
+ *	@details
+ *
+ *	@param		PpvContext				HMAC-SHA-1 context returned by Crypt_HMAC_Start
+ *	@param		PrgbInputMessage		Input message part
+ *	@param		PunInputMessageSize		Input message part size in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbInputMessage is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_HMAC_Update(
+	_Inout_								void*			PpvContext,
+	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
+	_In_								const UINT32	PunInputMessageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpvContext || NULL == PrgbInputMessage)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		if (1 != s_sLibCrypto.HMAC_Update((HMAC_CTX*)PpvContext, PrgbInputMessage, PunInputMessageSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
 
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Finish an incremental HMAC-SHA-1 calculation
+ *	@details	Returns the HMAC-SHA-1 of all message data added with Crypt_HMAC_Update since Crypt_HMAC_Start or the previous
+ *				call of this function. The context stays keyed for the next message.
+ *
+ *	@param		PpvContext				HMAC-SHA-1 context returned by Crypt_HMAC_Start
+ *	@param		PrgbHMAC				Receives the HMAC
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbHMAC is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_HMAC_Finish(
+	_Inout_							void*	PpvContext,
+	_Out_bytecap_(SHA1_DIGEST_SIZE)	BYTE	PrgbHMAC[SHA1_DIGEST_SIZE])
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unHmacLength = SHA1_DIGEST_SIZE;
+
+		// Check parameters
+		if (NULL == PpvContext || NULL == PrgbHMAC)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Calculate HMAC and reinitialize the context with the same key
+		if (1 != s_sLibCrypto.HMAC_Final((HMAC_CTX*)PpvContext, PrgbHMAC, &unHmacLength) ||
+				1 != s_sLibCrypto.HMAC_Init_ex((HMAC_CTX*)PpvContext, NULL, 0, NULL, NULL))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Release a HMAC-SHA-1 context
+ *	@details
+ *
+ *	@param		PppvContext				HMAC-SHA-1 context returned by Crypt_HMAC_Start, set to NULL
+ */
+void
+Crypt_HMAC_Release(
+	_Inout_	void**	PppvContext)
+{
+	if (NULL != PppvContext && NULL != *PppvContext)
+	{
+		s_sLibCrypto.HMAC_CTX_free((HMAC_CTX*)*PppvContext);
+		*PppvContext = NULL;
+	}
+}
+
 /**
  *	@brief		Calculate SHA-1 on the given data
  *	@details	This function calculates a SHA-1 hash on the given data stream.
@@ -109,18 +480,275 @@ Crypt_SHA1(
 			break;
 		}
 
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
 		// Calculate SHA-1
-		if (1 != SHA1_Init(&sContext))
+		if (1 != s_sLibCrypto.SHA1_Init(&sContext))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (1 != s_sLibCrypto.SHA1_Update(&sContext, PrgbInputMessage, PusInputMessageSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (1 != s_sLibCrypto.SHA1_Final(PrgbSHA1, &sContext))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Start an incremental SHA-1 calculation
+ *	@details	Allocates and initializes a SHA-1 context. The context must be passed to Crypt_SHA1_Finish
+ *				to release it, also in case of an error.
+ *
+ *	@param		PppvContext				Receives the SHA-1 context
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext is NULL or *PppvContext is not NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA1_Start(
+	_Outptr_result_maybenull_	void**	PppvContext)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		SHA_CTX* psContext = NULL;
+
+		// Check parameters
+		if (NULL == PppvContext || NULL != *PppvContext)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		psContext = (SHA_CTX*)calloc(1, sizeof(SHA_CTX));
+		if (NULL == psContext)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		*PppvContext = psContext;
+
+		if (1 != s_sLibCrypto.SHA1_Init(psContext))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Add data to an incremental SHA-1 calculation
+ *	@details
+ *
+ *	@param		PpvContext				SHA-1 context returned by Crypt_SHA1_Start
+ *	@param		PrgbInputMessage		Input message part
+ *	@param		PunInputMessageSize		Input message part size in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbInputMessage is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA1_Update(
+	_Inout_								void*			PpvContext,
+	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
+	_In_								const UINT32	PunInputMessageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpvContext || NULL == PrgbInputMessage)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		if (1 != s_sLibCrypto.SHA1_Update((SHA_CTX*)PpvContext, PrgbInputMessage, PunInputMessageSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Finish an incremental SHA-1 calculation
+ *	@details	Returns the SHA-1 of all data added with Crypt_SHA1_Update and releases the context. If
+ *				PrgbSHA1 is NULL the context is only released.
+ *
+ *	@param		PppvContext				SHA-1 context returned by Crypt_SHA1_Start, set to NULL
+ *	@param		PrgbSHA1				Receives the SHA-1 or NULL
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext or *PppvContext is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA1_Finish(
+	_Inout_								void**	PppvContext,
+	_Out_opt_bytecap_(SHA1_DIGEST_SIZE)	BYTE*	PrgbSHA1)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PppvContext || NULL == *PppvContext)
 		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+		if (NULL != PrgbSHA1 && 1 != s_sLibCrypto.SHA1_Final(PrgbSHA1, (SHA_CTX*)*PppvContext))
 			unReturnValue = RC_E_FAIL;
+
+		free(*PppvContext);
+		*PppvContext = NULL;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Calculate SHA-256 on the given data
+ *	@details	This function calculates a SHA-256 hash on the given data stream.
+ *
+ *	@param		PrgbInputMessage		Input message
+ *	@param		PunInputMessageSize		Input message size in bytes
+ *	@param		PrgbSHA256				Receives the SHA-256
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PrgbInputMessage is NULL or PunInputMessageSize is 0
+ */
+_Check_return_
+unsigned int
+Crypt_SHA256(
+	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
+	_In_								const UINT32	PunInputMessageSize,
+	_Out_bytecap_(SHA256_DIGEST_SIZE)	BYTE			PrgbSHA256[SHA256_DIGEST_SIZE])
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		SHA256_CTX sContext = {{0}};
+		memset(PrgbSHA256, 0, SHA256_DIGEST_SIZE);
+
+		// Check parameters
+		if (NULL == PrgbInputMessage || 0 == PunInputMessageSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		if (1 != SHA1_Update(&sContext, PrgbInputMessage, PusInputMessageSize))
+
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Calculate SHA-256
+		if (1 != s_sLibCrypto.SHA256_Init(&sContext))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (1 != s_sLibCrypto.SHA256_Update(&sContext, PrgbInputMessage, PunInputMessageSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (1 != s_sLibCrypto.SHA256_Final(PrgbSHA256, &sContext))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Start an incremental SHA-256 calculation
+ *	@details	Allocates and initializes a SHA-256 context. The context must be passed to Crypt_SHA256_Finish
+ *				to release it, also in case of an error.
+ *
+ *	@param		PppvContext				Receives the SHA-256 context
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext is NULL or *PppvContext is not NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA256_Start(
+	_Outptr_result_maybenull_	void**	PppvContext)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		SHA256_CTX* psContext = NULL;
+
+		// Check parameters
+		if (NULL == PppvContext || NULL != *PppvContext)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		psContext = (SHA256_CTX*)calloc(1, sizeof(SHA256_CTX));
+		if (NULL == psContext)
 		{
 			unReturnValue = RC_E_FAIL;
 			break;
 		}
-		if (1 != SHA1_Final(PrgbSHA1, &sContext))
+		*PppvContext = psContext;
+
+		if (1 != s_sLibCrypto.SHA256_Init(psContext))
 		{
 			unReturnValue = RC_E_FAIL;
 			break;
@@ -133,55 +761,82 @@ Crypt_SHA1(
 }
 
 /**
- *	@brief		Calculate SHA-256 on the given data
- *	@details	This function calculates a SHA-256 hash on the given data stream.
+ *	@brief		Add data to an incremental SHA-256 calculation
+ *	@details
  *
- *	@param		PrgbInputMessage		Input message
- *	@param		PunInputMessageSize		Input message size in bytes
- *	@param		PrgbSHA256				Receives the SHA-256
+ *	@param		PpvContext				SHA-256 context returned by Crypt_SHA256_Start
+ *	@param		PrgbInputMessage		Input message part
+ *	@param		PunInputMessageSize		Input message part size in bytes
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_FAIL				An unexpected error occurred.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PrgbInputMessage is NULL or PunInputMessageSize is 0
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpvContext or PrgbInputMessage is NULL
  */
 _Check_return_
 unsigned int
-Crypt_SHA256(
+Crypt_SHA256_Update(
+	_Inout_								void*			PpvContext,
 	_In_bytecount_(PunInputMessageSize)	const BYTE*		PrgbInputMessage,
-	_In_								const UINT32	PunInputMessageSize,
-	_Out_bytecap_(SHA256_DIGEST_SIZE)	BYTE			PrgbSHA256[SHA256_DIGEST_SIZE])
+	_In_								const UINT32	PunInputMessageSize)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	do
 	{
-		SHA256_CTX sContext = {{0}};
-		memset(PrgbSHA256, 0, SHA256_DIGEST_SIZE);
-
 		// Check parameters
-		if (NULL == PrgbInputMessage || 0 == PunInputMessageSize)
+		if (NULL == PpvContext || NULL == PrgbInputMessage)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
-		// Calculate SHA-256
-		if (1 != SHA256_Init(&sContext))
-		{
-			unReturnValue = RC_E_FAIL;
-			break;
-		}
-		if (1 != SHA256_Update(&sContext, PrgbInputMessage, PunInputMessageSize))
+		if (1 != s_sLibCrypto.SHA256_Update((SHA256_CTX*)PpvContext, PrgbInputMessage, PunInputMessageSize))
 		{
 			unReturnValue = RC_E_FAIL;
 			break;
 		}
-		if (1 != SHA256_Final(PrgbSHA256, &sContext))
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Finish an incremental SHA-256 calculation
+ *	@details	Returns the SHA-256 of all data added with Crypt_SHA256_Update and releases the context. If
+ *				PrgbSHA256 is NULL the context is only released.
+ *
+ *	@param		PppvContext				SHA-256 context returned by Crypt_SHA256_Start, set to NULL
+ *	@param		PrgbSHA256				Receives the SHA-256 or NULL
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PppvContext or *PppvContext is NULL
+ */
+_Check_return_
+unsigned int
+Crypt_SHA256_Finish(
+	_Inout_									void**	PppvContext,
+	_Out_opt_bytecap_(SHA256_DIGEST_SIZE)	BYTE*	PrgbSHA256)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PppvContext || NULL == *PppvContext)
 		{
-			unReturnValue = RC_E_FAIL;
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
+
 		unReturnValue = RC_SUCCESS;
+		if (NULL != PrgbSHA256 && 1 != s_sLibCrypto.SHA256_Final(PrgbSHA256, (SHA256_CTX*)*PppvContext))
+			unReturnValue = RC_E_FAIL;
+
+		free(*PppvContext);
+		*PppvContext = NULL;
 	}
 	WHILE_FALSE_END;
 
@@ -214,22 +869,34 @@ Crypt_SeedRandom(
 			break;
 		}
 
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
 		if (PrgbSeed != NULL)
 		{
-			RAND_seed(PrgbSeed, (UINT32)PusSeedSize);
+			s_sLibCrypto.RAND_seed(PrgbSeed, (UINT32)PusSeedSize);
 		}
 		else
 		{
 			// Create default seed from current time
 			time_t tSeed = time(NULL);
-			RAND_seed(&	tSeed, sizeof(tSeed));
+			s_sLibCrypto.RAND_seed(&	tSeed, sizeof(tSeed));
 		}
 
-		if (1 != RAND_status())
+		if (1 != s_sLibCrypto.RAND_status())
 		{
 			unReturnValue = RC_E_FAIL;
 			break;
 		}
+		s_fRandomSeeded = TRUE;
+
+		// Random bytes generated before the seed must not be handed out anymore
+		pthread_mutex_lock(&s_sRandomPoolMutex);
+		s_sLibCrypto.OPENSSL_cleanse(s_rgbRandomPool, sizeof(s_rgbRandomPool));
+		s_unRandomPoolOffset = CRYPT_RANDOM_POOL_SIZE;
+		pthread_mutex_unlock(&s_sRandomPoolMutex);
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
@@ -238,7 +905,10 @@ Crypt_SeedRandom(
 
 /**
  *	@brief		Get random bytes from the pseudo random number generator
- *	@details	This function gets random bytes from the pseudo random number generator.
+ *	@details	This function gets random bytes from the pseudo random number generator. If Crypt_SeedRandom has not been
+ *				called yet, the generator is seeded with the default seed first. Small requests like the nonces of the TPM1.2
+ *				authorization sessions are served from a pool which is refilled in bulk, so the generator is not called for
+ *				each of them.
  *
  *	@param		PusRandomSize			Number of bytes requested.
  *	@param		PrgbRandom				Receives pseudo random bytes.
@@ -263,18 +933,202 @@ Crypt_GetRandom(
 			break;
 		}
 
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
 		// Initialize output data
 		memset(PrgbRandom, 0, PusRandomSize);
 
-		// Generate random data
-		if (1 != RAND_bytes(PrgbRandom, (UINT32)PusRandomSize))
+		// Seed with the default seed on the first request
+		if (!s_fRandomSeeded)
+		{
+			unReturnValue = Crypt_SeedRandom(NULL, 0);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		// Generate large requests directly
+		if (CRYPT_RANDOM_POOL_MAX_REQUEST < PusRandomSize)
+		{
+			if (1 != s_sLibCrypto.RAND_bytes(PrgbRandom, (UINT32)PusRandomSize))
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		// Hand out the next bytes of the pool and refill it when it runs short
+		pthread_mutex_lock(&s_sRandomPoolMutex);
+		unReturnValue = RC_SUCCESS;
+		if (CRYPT_RANDOM_POOL_SIZE - s_unRandomPoolOffset < PusRandomSize || getpid() != s_nRandomPoolProcess)
+		{
+			if (1 == s_sLibCrypto.RAND_bytes(s_rgbRandomPool, sizeof(s_rgbRandomPool)))
+			{
+				s_unRandomPoolOffset = 0;
+				s_nRandomPoolProcess = getpid();
+			}
+			else
+			{
+				s_unRandomPoolOffset = CRYPT_RANDOM_POOL_SIZE;
+				unReturnValue = RC_E_FAIL;
+			}
+		}
+		if (RC_SUCCESS == unReturnValue)
+		{
+			memcpy(PrgbRandom, &s_rgbRandomPool[s_unRandomPoolOffset], PusRandomSize);
+			s_sLibCrypto.OPENSSL_cleanse(&s_rgbRandomPool[s_unRandomPoolOffset], PusRandomSize);
+			s_unRandomPoolOffset += PusRandomSize;
+		}
+		pthread_mutex_unlock(&s_sRandomPoolMutex);
+	}
+	WHILE_FALSE_END;
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Get a RSA public key object for the given modulus and exponent
+ *	@details	The key objects are cached by a SHA-256 over exponent and modulus, so repeated operations with the same key
+ *				(e.g. the firmware image signing key or the TPM endorsement key) reuse the imported key and its precomputed
+ *				Montgomery context. The returned object is owned by the cache and must not be freed.
+ *
+ *	@param		PrgbPublicModulus		Public modulus buffer
+ *	@param		PunPublicModulusSize	Size of public modulus buffer
+ *	@param		PrgbPublicExponent		Public exponent buffer
+ *	@param		PunPublicExponentSize	Size of public exponent buffer
+ *	@param		PppRSAPubKey			Receives the RSA public key object
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Crypt_GetRSAPublicKey(
+	_In_bytecount_(PunPublicModulusSize)	const BYTE*		PrgbPublicModulus,
+	_In_									unsigned int	PunPublicModulusSize,
+	_In_bytecount_(PunPublicExponentSize)	const BYTE*		PrgbPublicExponent,
+	_In_									unsigned int	PunPublicExponentSize,
+	_Out_									RSA**			PppRSAPubKey)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	RSA* pRSAPubKey = NULL;
+	BIGNUM* pbnPublicModulus = NULL;
+	BIGNUM* pbnExponent = NULL;
+
+	do
+	{
+		BYTE rgbKeyDigest[SHA256_DIGEST_SIZE] = {0};
+		BYTE rgbExponentSize[4] = {0};
+		SHA256_CTX sContext = {{0}};
+		unsigned int unIndex = 0;
+
+		*PppRSAPubKey = NULL;
+
+		// Load libcrypto on first use
+		unReturnValue = Crypt_LoadLibCrypto();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Identify the key by exponent size, exponent and modulus
+		rgbExponentSize[0] = (BYTE)(PunPublicExponentSize >> 24);
+		rgbExponentSize[1] = (BYTE)(PunPublicExponentSize >> 16);
+		rgbExponentSize[2] = (BYTE)(PunPublicExponentSize >> 8);
+		rgbExponentSize[3] = (BYTE)PunPublicExponentSize;
+		if (1 != s_sLibCrypto.SHA256_Init(&sContext) ||
+				1 != s_sLibCrypto.SHA256_Update(&sContext, rgbExponentSize, sizeof(rgbExponentSize)) ||
+				1 != s_sLibCrypto.SHA256_Update(&sContext, PrgbPublicExponent, PunPublicExponentSize) ||
+				1 != s_sLibCrypto.SHA256_Update(&sContext, PrgbPublicModulus, PunPublicModulusSize) ||
+				1 != s_sLibCrypto.SHA256_Final(rgbKeyDigest, &sContext))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sRsaKeyCacheMutex));
+		for (unIndex = 0; unIndex < CRYPT_RSA_KEY_CACHE_SIZE; unIndex++)
+		{
+			if (NULL != s_rgsRsaKeyCache[unIndex].pRSAPubKey &&
+					0 == memcmp(s_rgsRsaKeyCache[unIndex].rgbKeyDigest, rgbKeyDigest, sizeof(rgbKeyDigest)))
+			{
+				*PppRSAPubKey = s_rgsRsaKeyCache[unIndex].pRSAPubKey;
+				break;
+			}
+		}
+		IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sRsaKeyCacheMutex));
+		if (NULL != *PppRSAPubKey)
+		{
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		// Initialize RSA Public Key object
+		pRSAPubKey = s_sLibCrypto.RSA_new();
+		if (NULL == pRSAPubKey)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		pbnPublicModulus = s_sLibCrypto.BN_bin2bn(PrgbPublicModulus, PunPublicModulusSize, NULL);
+		if (NULL == pbnPublicModulus)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		pbnExponent = s_sLibCrypto.BN_bin2bn(PrgbPublicExponent, PunPublicExponentSize, NULL);
+		if (NULL == pbnExponent)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (1 != s_sLibCrypto.RSA_set0_key(pRSAPubKey, pbnPublicModulus, pbnExponent, NULL))
 		{
 			unReturnValue = RC_E_FAIL;
 			break;
 		}
+		pbnPublicModulus = NULL;
+		pbnExponent = NULL;
+
+		// Use the entry another thread has added meanwhile, otherwise replace the oldest cache entry. Adding the same
+		// key twice could evict an entry which is still in use by a concurrent verification.
+		IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sRsaKeyCacheMutex));
+		for (unIndex = 0; unIndex < CRYPT_RSA_KEY_CACHE_SIZE; unIndex++)
+		{
+			if (NULL != s_rgsRsaKeyCache[unIndex].pRSAPubKey &&
+					0 == memcmp(s_rgsRsaKeyCache[unIndex].rgbKeyDigest, rgbKeyDigest, sizeof(rgbKeyDigest)))
+			{
+				*PppRSAPubKey = s_rgsRsaKeyCache[unIndex].pRSAPubKey;
+				break;
+			}
+		}
+		if (NULL == *PppRSAPubKey)
+		{
+			unIndex = s_unRsaKeyCacheNext;
+			s_unRsaKeyCacheNext = (s_unRsaKeyCacheNext + 1) % CRYPT_RSA_KEY_CACHE_SIZE;
+			if (NULL != s_rgsRsaKeyCache[unIndex].pRSAPubKey)
+				s_sLibCrypto.RSA_free(s_rgsRsaKeyCache[unIndex].pRSAPubKey);
+			memcpy(s_rgsRsaKeyCache[unIndex].rgbKeyDigest, rgbKeyDigest, sizeof(rgbKeyDigest));
+			s_rgsRsaKeyCache[unIndex].pRSAPubKey = pRSAPubKey;
+			*PppRSAPubKey = pRSAPubKey;
+			pRSAPubKey = NULL;
+		}
+		IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sRsaKeyCacheMutex));
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
+
+	// Free RSA object and components not owned by the cache
+	if (NULL != pRSAPubKey)
+		s_sLibCrypto.RSA_free(pRSAPubKey);
+	if (NULL != pbnPublicModulus)
+		s_sLibCrypto.BN_free(pbnPublicModulus);
+	if (NULL != pbnExponent)
+		s_sLibCrypto.BN_free(pbnExponent);
+
 	return unReturnValue;
 }
 
@@ -313,9 +1167,7 @@ Crypt_EncryptRSA(
 	_Inout_bytecap_(*PpunEncryptedDataSize)		BYTE*				PrgbEncryptedData)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	RSA *pRSAPubKey = NULL;
-	BIGNUM* pbnPublicModulus = NULL;
-	BIGNUM* pbnExponent = NULL;
+	RSA* pRSAPubKey = NULL;
 
 	do
 	{
@@ -338,35 +1190,17 @@ Crypt_EncryptRSA(
 			break;
 		}
 
-		// Initialize RSA Public Key object
-		pRSAPubKey = RSA_new();
-		if (NULL == pRSAPubKey)
-		{
-			unReturnValue = RC_E_FAIL;
-			break;
-		}
-
-		pbnPublicModulus = BN_bin2bn((const BYTE*)PrgbPublicModulus, PunPublicModulusSize, pbnPublicModulus);
-		if (NULL == pbnPublicModulus)
-		{
-			unReturnValue = RC_E_FAIL;
-			break;
-		}
-
-		pbnExponent = BN_bin2bn((const BYTE*)PrgbPublicExponent, PunPublicExponentSize, pbnExponent);
-		if (NULL == pbnExponent)
-		{
-			unReturnValue = RC_E_FAIL;
+		// Get RSA Public Key object
+		unReturnValue = Crypt_GetRSAPublicKey(PrgbPublicModulus, PunPublicModulusSize, PrgbPublicExponent, PunPublicExponentSize, &pRSAPubKey);
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		}
-		RSA_set0_key(pRSAPubKey, pbnPublicModulus, pbnExponent, NULL);
 
 		// Add padding to the decrypted data
 		if (CRYPT_ES_RSAESOAEP_SHA1_MGF1 == PusEncryptionScheme)
 		{
 			int nReturnValue = 0;
 
-			nReturnValue = RSA_padding_add_PKCS1_OAEP(
+			nReturnValue = s_sLibCrypto.RSA_padding_add_PKCS1_OAEP(
 							   (BYTE*)rgbPaddedBuffer,
 							   unPaddedBufferSize,
 							   (const BYTE*)PrgbInputData,
@@ -388,7 +1222,7 @@ Crypt_EncryptRSA(
 
 		// Encrypt data with public key.
 		{
-			int nReturnValue = RSA_public_encrypt(
+			int nReturnValue = s_sLibCrypto.RSA_public_encrypt(
 								   unPaddedBufferSize,
 								   rgbPaddedBuffer,
 								   PrgbEncryptedData,
@@ -405,10 +1239,6 @@ Crypt_EncryptRSA(
 	}
 	WHILE_FALSE_END;
 
-	// Free RSA object and its components (BIGNUM)
-	if (NULL != pRSAPubKey)
-		RSA_free(pRSAPubKey);
-
 	return unReturnValue;
 }
 
@@ -440,8 +1270,6 @@ Crypt_VerifySignature(
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 	RSA* pRSAPubKey = NULL;
-	BIGNUM* pbnModulus = NULL;
-	BIGNUM* pbnExponent = NULL;
 
 	do
 	{
@@ -454,33 +1282,15 @@ Crypt_VerifySignature(
 			break;
 		}
 
-		// Initialize RSA Public Key object
-		pRSAPubKey = RSA_new();
-		if (NULL == pRSAPubKey)
-		{
-			unReturnValue = RC_E_FAIL;
-			break;
-		}
-
-		pbnModulus = BN_bin2bn(PrgbModulus, PunModulusSize, pbnModulus);
-		if (NULL == pbnModulus)
-		{
-			unReturnValue = RC_E_FAIL;
-			break;
-		}
-
-		pbnExponent = BN_bin2bn(RSA_PUB_EXPONENT_KEY_ID_0, sizeof(RSA_PUB_EXPONENT_KEY_ID_0), pbnExponent);
-		if (NULL == pbnExponent)
-		{
-			unReturnValue = RC_E_FAIL;
+		// Get RSA Public Key object
+		unReturnValue = Crypt_GetRSAPublicKey(PrgbModulus, PunModulusSize, RSA_PUB_EXPONENT_KEY_ID_0, sizeof(RSA_PUB_EXPONENT_KEY_ID_0), &pRSAPubKey);
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		}
-		RSA_set0_key(pRSAPubKey, pbnModulus, pbnExponent, NULL);
 
 		{
 			BYTE prgbDecryptedDigest[sizeof(RSA_PUB_MODULUS_KEY_ID_0)] = {0};
 			int nReturnValue = -1;
-			nReturnValue = RSA_public_decrypt(PunSignatureSize, PrgbSignature, prgbDecryptedDigest, pRSAPubKey, RSA_NO_PADDING);
+			nReturnValue = s_sLibCrypto.RSA_public_decrypt(PunSignatureSize, PrgbSignature, prgbDecryptedDigest, pRSAPubKey, RSA_NO_PADDING);
 			if (-1 == nReturnValue)
 			{
 				unReturnValue = RC_E_FAIL;
@@ -488,7 +1298,7 @@ Crypt_VerifySignature(
 			}
 
 			// Verify the signature
-			if (1 != RSA_verify_PKCS1_PSS(pRSAPubKey, PrgbMessageHash, EVP_sha256(), prgbDecryptedDigest, CRYPT_PSS_PADDING_SALT_SIZE))
+			if (1 != s_sLibCrypto.RSA_verify_PKCS1_PSS(pRSAPubKey, PrgbMessageHash, s_sLibCrypto.EVP_sha256(), prgbDecryptedDigest, CRYPT_PSS_PADDING_SALT_SIZE))
 			{
 				unReturnValue = RC_E_VERIFY_SIGNATURE;
 				break;
@@ -499,16 +1309,228 @@ Crypt_VerifySignature(
 	}
 	WHILE_FALSE_END;
 
-	// Free RSA object and its components (BIGNUM)
-	if (NULL != pRSAPubKey)
-		RSA_free(pRSAPubKey);
-
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Build the slicing-by-8 CRC lookup tables
+ *	@details	Table 0 is the classic byte-wise table of the reflected polynomial, table n advances the CRC of
+ *				table n - 1 by one more zero byte.
+ */
+static void
+Crypt_CRCInitializeTable()
+{
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < 256; unIndex++)
+	{
+		unsigned int unCRC = unIndex;
+		int nBit = 0;
+		for (; nBit < 8; nBit++)
+			unCRC = (unCRC >> 1) ^ (-((int)(unCRC & 1)) & CRC32MASKREV);
+		s_rgunCrcTable[0][unIndex] = unCRC;
+	}
+
+	for (unIndex = 0; unIndex < 256; unIndex++)
+	{
+		unsigned int unSlice = 1;
+		for (; unSlice < 8; unSlice++)
+			s_rgunCrcTable[unSlice][unIndex] = (s_rgunCrcTable[unSlice - 1][unIndex] >> 8) ^ s_rgunCrcTable[0][s_rgunCrcTable[unSlice - 1][unIndex] & 0xFF];
+	}
+
+}
+
+/**
+ *	@brief		Update a CRC register value with slicing-by-8 table lookups
+ *	@details	Processes eight bytes per iteration. The register value is not inverted before or after.
+ *
+ *	@param		PunCRC				CRC register value
+ *	@param		PrgbInputData		Data stream for CRC calculation
+ *	@param		PunInputDataSize	Size of the data stream
+ *
+ *	@returns	The updated CRC register value
+ */
+static unsigned int
+Crypt_CRCTable(
+	_In_							unsigned int			PunCRC,
+	_In_bytecount_(PunInputDataSize)	const unsigned char*	PrgbInputData,
+	_In_							unsigned int			PunInputDataSize)
+{
+	// Assemble the words bytewise so that the result does not depend on byte order or alignment
+	for (; PunInputDataSize >= 8; PunInputDataSize -= 8, PrgbInputData += 8)
+	{
+		unsigned int unLow = PunCRC ^ ((unsigned int)PrgbInputData[0] | ((unsigned int)PrgbInputData[1] << 8) | ((unsigned int)PrgbInputData[2] << 16) | ((unsigned int)PrgbInputData[3] << 24));
+		unsigned int unHigh = (unsigned int)PrgbInputData[4] | ((unsigned int)PrgbInputData[5] << 8) | ((unsigned int)PrgbInputData[6] << 16) | ((unsigned int)PrgbInputData[7] << 24);
+		PunCRC =
+			s_rgunCrcTable[7][unLow & 0xFF] ^ s_rgunCrcTable[6][(unLow >> 8) & 0xFF] ^
+			s_rgunCrcTable[5][(unLow >> 16) & 0xFF] ^ s_rgunCrcTable[4][unLow >> 24] ^
+			s_rgunCrcTable[3][unHigh & 0xFF] ^ s_rgunCrcTable[2][(unHigh >> 8) & 0xFF] ^
+			s_rgunCrcTable[1][(unHigh >> 16) & 0xFF] ^ s_rgunCrcTable[0][unHigh >> 24];
+	}
+
+	for (; PunInputDataSize > 0; PunInputDataSize--)
+		PunCRC = (PunCRC >> 8) ^ s_rgunCrcTable[0][(PunCRC ^ *PrgbInputData++) & 0xFF];
+
+	return PunCRC;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/// Minimum data size for which the folding path is used
+#define CRYPT_CRC_HARDWARE_MIN_SIZE 64
+
+/**
+ *	@brief		Update a CRC register value by folding with carry-less multiplications
+ *	@details	Folds four 128-bit lanes over 64 bytes per iteration, then one lane over 16 bytes, and reduces the
+ *				result with a Barrett reduction. The constants are the ones of the reflected CRC-32 polynomial
+ *				from the Intel white paper "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ".
+ *				The register value is not inverted before or after.
+ *
+ *	@param		PunCRC				CRC register value
+ *	@param		PrgbInputData		Data stream for CRC calculation
+ *	@param		PunInputDataSize	Size of the data stream, at least 64 bytes and a multiple of 16 bytes
+ *
+ *	@returns	The updated CRC register value
+ */
+__attribute__((target("pclmul,sse2")))
+static unsigned int
+Crypt_CRCHardware(
+	_In_							unsigned int			PunCRC,
+	_In_bytecount_(PunInputDataSize)	const unsigned char*	PrgbInputData,
+	_In_							unsigned int			PunInputDataSize)
+{
+	const __m128i sR2R1 = _mm_set_epi64x(0x00000001C6E41596LL, 0x0000000154442BD4LL);
+	const __m128i sR4R3 = _mm_set_epi64x(0x00000000CCAA009ELL, 0x00000001751997D0LL);
+	const __m128i sR5 = _mm_set_epi64x(0, 0x0000000163CD6124LL);
+	const __m128i sPolyMu = _mm_set_epi64x(0x00000001F7011641LL, 0x00000001DB710641LL);
+	const __m128i sMask32 = _mm_set_epi32(0, 0, 0, -1);
+	__m128i sLane1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(const void*)PrgbInputData), _mm_cvtsi32_si128((int)PunCRC));
+	__m128i sLane2 = _mm_loadu_si128((const __m128i*)(const void*)(PrgbInputData + 16));
+	__m128i sLane3 = _mm_loadu_si128((const __m128i*)(const void*)(PrgbInputData + 32));
+	__m128i sLane4 = _mm_loadu_si128((const __m128i*)(const void*)(PrgbInputData + 48));
+	__m128i sTemp;
+
+	PrgbInputData += 64;
+	PunInputDataSize -= 64;
+
+	// Fold by four lanes
+	for (; PunInputDataSize >= 64; PunInputDataSize -= 64, PrgbInputData += 64)
+	{
+		sTemp = _mm_clmulepi64_si128(sLane1, sR2R1, 0x11);
+		sLane1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane1, sR2R1, 0x00), sTemp), _mm_loadu_si128((const __m128i*)(const void*)PrgbInputData));
+		sTemp = _mm_clmulepi64_si128(sLane2, sR2R1, 0x11);
+		sLane2 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane2, sR2R1, 0x00), sTemp), _mm_loadu_si128((const __m128i*)(const void*)(PrgbInputData + 16)));
+		sTemp = _mm_clmulepi64_si128(sLane3, sR2R1, 0x11);
+		sLane3 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane3, sR2R1, 0x00), sTemp), _mm_loadu_si128((const __m128i*)(const void*)(PrgbInputData + 32)));
+		sTemp = _mm_clmulepi64_si128(sLane4, sR2R1, 0x11);
+		sLane4 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane4, sR2R1, 0x00), sTemp), _mm_loadu_si128((const __m128i*)(const void*)(PrgbInputData + 48)));
+	}
+
+	// Fold the four lanes into one
+	sTemp = _mm_clmulepi64_si128(sLane1, sR4R3, 0x11);
+	sLane1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane1, sR4R3, 0x00), sTemp), sLane2);
+	sTemp = _mm_clmulepi64_si128(sLane1, sR4R3, 0x11);
+	sLane1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane1, sR4R3, 0x00), sTemp), sLane3);
+	sTemp = _mm_clmulepi64_si128(sLane1, sR4R3, 0x11);
+	sLane1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane1, sR4R3, 0x00), sTemp), sLane4);
+
+	// Fold the remaining 16 byte blocks
+	for (; PunInputDataSize >= 16; PunInputDataSize -= 16, PrgbInputData += 16)
+	{
+		sTemp = _mm_clmulepi64_si128(sLane1, sR4R3, 0x11);
+		sLane1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(sLane1, sR4R3, 0x00), sTemp), _mm_loadu_si128((const __m128i*)(const void*)PrgbInputData));
+	}
+
+	// Fold 128 bits to 64 bits
+	sTemp = _mm_clmulepi64_si128(sLane1, sR4R3, 0x10);
+	sLane1 = _mm_xor_si128(_mm_srli_si128(sLane1, 8), sTemp);
+
+	// Fold 64 bits to 32 bits
+	sTemp = _mm_clmulepi64_si128(_mm_and_si128(sLane1, sMask32), sR5, 0x00);
+	sLane1 = _mm_xor_si128(_mm_srli_si128(sLane1, 4), sTemp);
+
+	// Barrett reduction to the 32-bit CRC
+	sTemp = _mm_clmulepi64_si128(_mm_and_si128(sLane1, sMask32), sPolyMu, 0x10);
+	sTemp = _mm_clmulepi64_si128(_mm_and_si128(sTemp, sMask32), sPolyMu, 0x00);
+	sLane1 = _mm_xor_si128(sLane1, sTemp);
+
+	return (unsigned int)_mm_cvtsi128_si32(_mm_srli_si128(sLane1, 4));
+}
+
+/**
+ *	@brief		Determine whether the CPU supports the hardware CRC path
+ *
+ *	@returns	TRUE if carry-less multiplication is available, FALSE otherwise
+ */
+static BOOL
+Crypt_CRCHardwareAvailable()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("pclmul") ? TRUE : FALSE;
+}
+#elif defined(__aarch64__)
+/// Minimum data size for which the CRC32 instructions are used
+#define CRYPT_CRC_HARDWARE_MIN_SIZE 8
+
+/**
+ *	@brief		Update a CRC register value with the ARMv8 CRC32 instructions
+ *	@details	The CRC32 instructions implement the same reflected polynomial as the lookup tables.
+ *				The register value is not inverted before or after.
+ *
+ *	@param		PunCRC				CRC register value
+ *	@param		PrgbInputData		Data stream for CRC calculation
+ *	@param		PunInputDataSize	Size of the data stream, a multiple of 8 bytes
+ *
+ *	@returns	The updated CRC register value
+ */
+__attribute__((target("+crc")))
+static unsigned int
+Crypt_CRCHardware(
+	_In_							unsigned int			PunCRC,
+	_In_bytecount_(PunInputDataSize)	const unsigned char*	PrgbInputData,
+	_In_							unsigned int			PunInputDataSize)
+{
+	for (; PunInputDataSize >= 8; PunInputDataSize -= 8, PrgbInputData += 8)
+	{
+		uint64_t ullData = 0;
+		memcpy(&ullData, PrgbInputData, sizeof(ullData));
+		PunCRC = __crc32d(PunCRC, ullData);
+	}
+
+	return PunCRC;
+}
+
+/**
+ *	@brief		Determine whether the CPU supports the hardware CRC path
+ *
+ *	@returns	TRUE if the CRC32 instructions are available, FALSE otherwise
+ */
+static BOOL
+Crypt_CRCHardwareAvailable()
+{
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) ? TRUE : FALSE;
+}
+#endif
+
+/**
+ *	@brief		Build the CRC lookup tables and select the CRC implementation (run once through s_sCrcOnce)
+ */
+static void
+Crypt_CRCInitialize()
+{
+	Crypt_CRCInitializeTable();
+
+	s_unCrcEngine = CRYPT_CRC_ENGINE_TABLE;
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+	if (Crypt_CRCHardwareAvailable())
+		s_unCrcEngine = CRYPT_CRC_ENGINE_HARDWARE;
+#endif
+}
+
 /**
  *	@brief		Calculate the CRC value of the given data stream
- *	@details	The function calculates bitwise a CRC over a data stream
+ *	@details	The function calculates a CRC-32 over a data stream. Blocks of the data stream are processed with
+ *				carry-less multiplication folding (x86) or the CRC32 instructions (ARMv8) if the CPU supports them,
+ *				the rest is processed with slicing-by-8 lookup tables. All paths return bit-exact results.
  *
  *	@param		PpInputData			Data stream for CRC calculation
  *	@param		PnInputDataSize		Size if data to calculate the CRC
@@ -530,28 +1552,33 @@ Crypt_CRC(
 	do
 	{
 		unsigned int unCRC = 0;
+		unsigned int unInputDataSize = 0;
 		const unsigned char* pbInputData = (const unsigned char*)PpInputData;
 
 		// Check parameter
 		if (NULL == PpunCRC ||
 				NULL == PpInputData ||
-				0 == PnInputDataSize)
+				0 >= PnInputDataSize)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
+		IGNORE_RETURN_VALUE(pthread_once(&s_sCrcOnce, Crypt_CRCInitialize));
+
 		// Calculate CRC value
 		unCRC = ~(*PpunCRC);
-		while (PnInputDataSize-- != 0)
+		unInputDataSize = (unsigned int)PnInputDataSize;
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+		if (CRYPT_CRC_ENGINE_HARDWARE == s_unCrcEngine && unInputDataSize >= CRYPT_CRC_HARDWARE_MIN_SIZE)
 		{
-			int nIndex = 0;
-			unCRC ^= *pbInputData++;
-			for (; nIndex < 8; nIndex++)
-			{
-				unCRC = (unCRC >> 1) ^ (-((int)(unCRC & 1)) & CRC32MASKREV);
-			}
+			unsigned int unBlockSize = unInputDataSize & ~15U;
+			unCRC = Crypt_CRCHardware(unCRC, pbInputData, unBlockSize);
+			pbInputData += unBlockSize;
+			unInputDataSize -= unBlockSize;
 		}
+#endif
+		unCRC = Crypt_CRCTable(unCRC, pbInputData, unInputDataSize);
 
 		*PpunCRC = ~unCRC;
 		unReturnValue = RC_SUCCESS;
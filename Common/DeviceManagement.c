@@ -17,6 +17,13 @@
 #include "TpmIO.h"
 #include "Logging.h"
 #include "Platform.h"
+#include "FileIO.h"
+#include "TpmReplay.h"
+#include "TPM2_FieldUpgradeTypes.h"
+#include "Session.h"
+#include "Trace.h"
+#include "FlightRecorder.h"
+#include "Probes.h"
 /// Offset for locality 0
 #define LOCALITY0OFFSET 0xFED40000
 /// TPM Access register bit for active locality
@@ -33,12 +40,38 @@ PFN_TPMIO_Disconnect	s_fpTpmIoDisconnect = NULL;
 /// Function pointer to method for transmitting data to the TPM
 PFN_TPMIO_Transmit		s_fpTpmIoTransmit = NULL;
 
+/// Function pointer to method for transmitting a request given in several parts to the TPM (NULL if the transport
+/// only accepts contiguous requests)
+PFN_TPMIO_TransmitSegments	s_fpTpmIoTransmitSegments = NULL;
+
+/// Function pointer to method for transmitting several requests to the TPM in one round trip (NULL if the transport
+/// cannot do this)
+PFN_TPMIO_TransmitBatch	s_fpTpmIoTransmitBatch = NULL;
+
 /// Function pointer to read a byte from a register of the TPM
 PFN_TPMIO_ReadRegister	s_fpTpmIoReadRegister = NULL;
 
 /// Function pointer to write a byte to a register of the TPM
 PFN_TPMIO_WriteRegister	s_fpTpmIoWriteRegister = NULL;
 
+/// Function pointer to get the transport statistics of the TPM I/O layer
+PFN_TPMIO_GetStatistics	s_fpTpmIoGetStatistics = NULL;
+
+/// Function pointer to set the command pending callback of the TPM I/O layer
+PFN_TPMIO_SetCommandPendingCallback	s_fpTpmIoSetCommandPendingCallback = NULL;
+
+/// Callback function invoked while a TPM command is executed by the TPM (pipelined mode)
+static PFN_DEVICEMANAGEMENT_COMMANDPENDINGCALLBACK s_fpCommandPending = NULL;
+
+/// Flag indicating the request of the pending command has not been logged yet
+static BOOL				s_fRequestLogPending = FALSE;
+
+/// Work item run once while the next TPM command is executed by the TPM
+static PFN_DEVICEMANAGEMENT_PENDINGWORK s_fpPendingWork = NULL;
+
+/// Context passed to the pending work item
+static void*			s_pvPendingWorkContext = NULL;
+
 /// Flag indicating TPM connection established or not
 BOOL					s_fTpmConnected = FALSE;
 
@@ -48,17 +81,104 @@ BOOL					s_fInitialized = FALSE;
 /// Flag indicating locality is set or not
 BOOL					s_fIsLocalitySet = FALSE;
 
-/// Caches the last TPM command
-BYTE					g_rgbLastRequest[4096] = {0};
+/// Flag indicating transport statistics are collected or not
+static BOOL				s_fCollectStatistics = FALSE;
 
-/// Caches the size of the last TPM command
-unsigned int			g_unSizeLastRequest = 0;
+/// Handle of the capture file recording all TPM commands (NULL if no capture is recorded)
+static void*			s_pvCaptureFile = NULL;
 
-/// Caches the last TPM response
-BYTE					g_rgbLastResponse[4096] = {0};
+/// Monotonic time stamp of the start of the capture in microseconds
+static unsigned long long s_ullCaptureStartTime = 0;
+
+/// Maximum number of recent TPM commands kept for troubleshooting
+#define TROUBLESHOOTING_MAX_FRAMES 64
+/// Default number of recent TPM commands kept for troubleshooting (the last command only)
+#define TROUBLESHOOTING_DEFAULT_FRAMES 1
+
+/**
+ *	@brief		Describes a TPM command kept for troubleshooting
+ *	@details	Only the command properties and results are kept. Full copies of the last command and response are
+ *				made in troubleshooting mode or at logging level 3 and above.
+ */
+typedef struct tdIfxTroubleshootingFrame
+{
+	/// TPM command ordinal
+	unsigned int unCommandCode;
+	/// TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+	unsigned int unSubCommand;
+	/// Size of the request in bytes
+	unsigned int unRequestSize;
+	/// Size of the response in bytes (0 if the transmission failed)
+	unsigned int unResponseSize;
+	/// Return code of the transmission or TPM response code
+	unsigned int unResult;
+	/// Duration of the command in microseconds
+	unsigned long long ullDuration;
+} IfxTroubleshootingFrame;
+
+/// Ring of the recent TPM commands kept for troubleshooting
+static IfxTroubleshootingFrame s_rgsTroubleshootingFrames[TROUBLESHOOTING_MAX_FRAMES];
+
+/// Number of recent TPM commands kept for troubleshooting (0 if no commands are kept)
+static unsigned int s_unTroubleshootingFrames = TROUBLESHOOTING_DEFAULT_FRAMES;
+
+/// Number of TPM commands recorded in s_rgsTroubleshootingFrames since the initialization
+static unsigned int s_unTroubleshootingFramesRecorded = 0;
+
+/// Flag indicating full copies of the last TPM command and response are kept (troubleshooting mode)
+static BOOL s_fTroubleshooting = FALSE;
+
+/**
+ *	@brief		Represents the command statistics of the device management
+ */
+typedef struct tdIfxDeviceManagementStatistics
+{
+	/// Number of transmitted TPM commands
+	unsigned long long ullCommands;
+	/// Number of bytes sent to the TPM
+	unsigned long long ullBytesSent;
+	/// Number of bytes received from the TPM
+	unsigned long long ullBytesReceived;
+	/// Accumulated time of all TPM commands in microseconds
+	unsigned long long ullTransmitTime;
+	/// Longest time of a single TPM command in microseconds
+	unsigned long long ullMaxTransmitTime;
+} IfxDeviceManagementStatistics;
+
+/// Command statistics of the device management
+static IfxDeviceManagementStatistics s_sStatistics = {0, 0, 0, 0, 0};
+
+/// Number of latency histogram buckets. Bucket n counts the commands which took [2^n, 2^(n+1)) microseconds.
+#define LATENCY_HISTOGRAM_BUCKETS 28
+/// Maximum number of distinct command ordinals tracked in the latency histograms
+#define LATENCY_HISTOGRAM_MAX_ENTRIES 64
+/// Sub command value for commands without a sub command
+#define LATENCY_NO_SUB_COMMAND 0xFFFFFFFF
+/// Offset of the sub command byte in a TPM_FieldUpgrade request
+#define FIELDUPGRADE_SUB_COMMAND_OFFSET 10
 
-/// Caches the size of the last TPM response
-unsigned int			g_unSizeLastResponse = 0;
+/**
+ *	@brief		Represents the latency histogram of one command ordinal
+ */
+typedef struct tdIfxLatencyHistogram
+{
+	/// TPM command ordinal
+	unsigned int unCommandCode;
+	/// TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+	unsigned int unSubCommand;
+	/// Number of recorded commands
+	unsigned int unCount;
+	/// Longest time of a single command in microseconds
+	unsigned long long ullMaxTime;
+	/// Log-scale latency buckets
+	unsigned int rgunBuckets[LATENCY_HISTOGRAM_BUCKETS];
+} IfxLatencyHistogram;
+
+/// Per ordinal latency histograms of the device management
+static IfxLatencyHistogram s_rgsLatencyHistograms[LATENCY_HISTOGRAM_MAX_ENTRIES];
+
+/// Number of used entries in s_rgsLatencyHistograms
+static unsigned int s_unLatencyHistogramCount = 0;
 
 /// Maximum wait time in TIS protocol for commands of category SMALL_DURATION: 10 seconds
 #define SMALL_DURATION 10000000
@@ -66,65 +186,393 @@ unsigned int			g_unSizeLastResponse = 0;
 #define MEDIUM_DURATION 20000000
 /// Maximum wait time in TIS protocol for commands of category LONG_DURATION: 120 seconds
 #define LONG_DURATION 120000000
+/// Expected execution time for commands of category SHORT_EXPECTED_DURATION: 200 microseconds
+#define SHORT_EXPECTED_DURATION 200
+/// Expected execution time for commands of category DEFAULT_EXPECTED_DURATION: 5 milliseconds
+#define DEFAULT_EXPECTED_DURATION 5000
+
+// The command tables are searched binary and must be sorted by ascending command code.
+
+/// List of available TPM1.2 command names and their properties: command code, maximum and expected command duration
+static const IfxTpmCommand s_sTpm1Commands[] = {
+	{L"None", 0, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_OIAP", 0x0000000A, SMALL_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM_OSAP", 0x0000000B, SMALL_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_TakeOwnership", 0x0000000D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_ChangeAuthOwner", 0x00000010, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_SetCapability", 0x0000003F, SMALL_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_GetTestResult", 0x00000054, SMALL_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM_GetCapability", 0x00000065, SMALL_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM_OwnerReadInternalPub", 0x00000081, SMALL_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_Startup", 0x00000099, SMALL_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_FieldUpgrade", 0x000000AA, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_FlushSpecific", 0x000000BA, SMALL_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TSC_PhysicalPresence", 0x4000000A, SMALL_DURATION, SHORT_EXPECTED_DURATION}
+};
 
-/// List of available TPM1.2 command names and their properties: command code, maximum command duration
-IfxTpmCommand s_sTpm1Commands[] = {
-	{L"None", 0, LONG_DURATION},
-	{L"TPM_OIAP", 0x0000000A, SMALL_DURATION},
-	{L"TPM_OSAP", 0x0000000B, SMALL_DURATION},
-	{L"TPM_TakeOwnership", 0x0000000D, LONG_DURATION},
-	{L"TPM_ChangeAuthOwner", 0x00000010, MEDIUM_DURATION},
-	{L"TPM_SetCapability", 0x0000003F, SMALL_DURATION},
-	{L"TPM_GetTestResult", 0x00000054, SMALL_DURATION},
-	{L"TPM_GetCapability", 0x00000065, SMALL_DURATION},
-	{L"TPM_OwnerReadInternalPub", 0x00000081, SMALL_DURATION},
-	{L"TPM_Startup", 0x00000099, SMALL_DURATION},
-	{L"TPM_FieldUpgrade", 0x000000AA, MEDIUM_DURATION},
-	{L"TPM_FlushSpecific", 0x000000BA, SMALL_DURATION},
-	{L"TSC_PhysicalPresence", 0x4000000A, SMALL_DURATION}
+/// List of TPM_FieldUpgrade sub command names: sub command, maximum and expected command duration
+static const IfxTpmCommand s_sFieldUpgradeSubCommands[] = {
+	{L"TPM_FieldUpgradeInfoRequest", TPM_FieldUpgradeInfoRequest, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_FieldUpgradeInfoRequest2", TPM_FieldUpgradeInfoRequest2, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_FieldUpgradeUpdate", TPM_FieldUpgradeUpdate, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_FieldUpgradeComplete", TPM_FieldUpgradeComplete, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM_FieldUpgradeStart", TPM_FieldUpgradeStart, MEDIUM_DURATION, DEFAULT_EXPECTED_DURATION}
 };
 
-/// List of available TPM2.0 command names and their properties: command code, maximum command duration
-IfxTpmCommand s_sTpm2Commands[] = {
-	{L"None", 0, LONG_DURATION},										{L"TPM2_NV_UndefineSpaceSpecial", 0x0000011F, LONG_DURATION},	{L"TPM2_EvictControl", 0x00000120, LONG_DURATION},
-	{L"TPM2_HierarchyControl", 0x00000121, LONG_DURATION},				{L"TPM2_NV_UndefineSpace", 0x00000122, LONG_DURATION},			{L"TPM2_ChangeEPS", 0x00000124, LONG_DURATION},
-	{L"TPM2_ChangePPS", 0x00000125, LONG_DURATION},						{L"TPM2_Clear", 0x00000126, LONG_DURATION},						{L"TPM2_ClearControl", 0x00000127, LONG_DURATION},
-	{L"TPM2_ClockSet", 0x00000128, LONG_DURATION},						{L"TPM2_HierarchyChangeAuth", 0x00000129, LONG_DURATION},		{L"TPM2_NV_DefineSpace", 0x0000012A, LONG_DURATION},
-	{L"TPM2_PCR_Allocate", 0x0000012B, LONG_DURATION},					{L"TPM2_PCR_SetAuthPolicy", 0x0000012C, LONG_DURATION},			{L"TPM2_PP_Commands", 0x0000012D, LONG_DURATION},
-	{L"TPM2_SetPrimaryPolicy", 0x0000012E, LONG_DURATION},				{L"TPM2_FieldUpgradeStart", 0x0000012F, LONG_DURATION},			{L"TPM2_ClockRateAdjust", 0x00000130, LONG_DURATION},
-	{L"TPM2_CreatePrimary", 0x00000131, LONG_DURATION},					{L"TPM2_NV_GlobalWriteLock", 0x00000132, LONG_DURATION},		{L"TPM2_GetCommandAuditDigest", 0x00000133, LONG_DURATION},
-	{L"TPM2_NV_Increment", 0x00000134, LONG_DURATION},					{L"TPM2_NV_SetBits", 0x00000135, LONG_DURATION},				{L"TPM2_NV_Extend", 0x00000136, LONG_DURATION},
-	{L"TPM2_NV_Write", 0x00000137, LONG_DURATION},						{L"TPM2_NV_WriteLock", 0x00000138, LONG_DURATION},				{L"TPM2_DictionaryAttackLockReset", 0x00000139, LONG_DURATION},
-	{L"TPM2_DictionaryAttackParameters", 0x0000013A, LONG_DURATION},	{L"TPM2_NV_ChangeAuth", 0x0000013B, LONG_DURATION},				{L"TPM2_PCR_Event", 0x0000013C, LONG_DURATION},
-	{L"TPM2_PCR_Reset", 0x0000013D, LONG_DURATION},						{L"TPM2_SequenceComplete", 0x0000013E, LONG_DURATION},			{L"TPM2_SetAlgorithmSet", 0x0000013F, LONG_DURATION},
-	{L"TPM2_SetCommandCodeAuditStatus", 0x00000140, LONG_DURATION},		{L"TPM2_FieldUpgradeData", 0x00000141, LONG_DURATION},			{L"TPM2_IncrementalSelfTest", 0x00000142, LONG_DURATION},
-	{L"TPM2_SelfTest", 0x00000143, LONG_DURATION},						{L"TPM2_Startup", 0x00000144, LONG_DURATION},					{L"TPM2_Shutdown", 0x00000145, LONG_DURATION},
-	{L"TPM2_StirRandom", 0x00000146, LONG_DURATION},					{L"TPM2_ActivateCredential", 0x00000147, LONG_DURATION},		{L"TPM2_Certify", 0x00000148, LONG_DURATION},
-	{L"TPM2_PolicyNV", 0x00000149, LONG_DURATION},						{L"TPM2_CertifyCreation", 0x0000014A, LONG_DURATION},			{L"TPM2_Duplicate", 0x0000014B, LONG_DURATION},
-	{L"TPM2_GetTime", 0x0000014C, LONG_DURATION},						{L"TPM2_GetSessionAuditDigest", 0x0000014D, LONG_DURATION},		{L"TPM2_NV_Read", 0x0000014E, LONG_DURATION},
-	{L"TPM2_NV_ReadLock", 0x0000014F, LONG_DURATION},					{L"TPM2_ObjectChangeAuth", 0x00000150, LONG_DURATION},			{L"TPM2_PolicySecret", 0x00000151, LONG_DURATION},
-	{L"TPM2_Rewrap", 0x00000152, LONG_DURATION},						{L"TPM2_Create", 0x00000153, LONG_DURATION},					{L"TPM2_ECDH_ZGen", 0x00000154, LONG_DURATION},
-	{L"TPM2_HMAC", 0x00000155, LONG_DURATION},							{L"TPM2_Import", 0x00000156, LONG_DURATION},					{L"TPM2_Load", 0x00000157, LONG_DURATION},
-	{L"TPM2_Quote", 0x00000158, LONG_DURATION},							{L"TPM2_RSA_Decrypt", 0x00000159, LONG_DURATION},				{L"TPM2_HMAC_Start", 0x0000015B, LONG_DURATION},
-	{L"TPM2_SequenceUpdate", 0x0000015C, LONG_DURATION},				{L"TPM2_Sign", 0x0000015D, LONG_DURATION},						{L"TPM2_Unseal", 0x0000015E, LONG_DURATION},
-	{L"TPM2_PolicySigned", 0x00000160, LONG_DURATION},					{L"TPM2_ContextLoad", 0x00000161, LONG_DURATION},				{L"TPM2_ContextSave", 0x00000162, LONG_DURATION},
-	{L"TPM2_ECDH_KeyGen", 0x00000163, LONG_DURATION},					{L"TPM2_EncryptDecrypt", 0x00000164, LONG_DURATION},			{L"TPM2_FlushContext", 0x00000165, LONG_DURATION},
-	{L"TPM2_LoadExternal", 0x00000167, LONG_DURATION},					{L"TPM2_MakeCredential", 0x00000168, LONG_DURATION},			{L"TPM2_NV_ReadPublic", 0x00000169, LONG_DURATION},
-	{L"TPM2_PolicyAuthorize", 0x0000016A, LONG_DURATION},				{L"TPM2_PolicyAuthValue", 0x0000016B, LONG_DURATION},			{L"TPM2_PolicyCommandCode", 0x0000016C, LONG_DURATION},
-	{L"TPM2_PolicyCounterTimer", 0x0000016D, LONG_DURATION},			{L"TPM2_PolicyCpHash", 0x0000016E, LONG_DURATION},				{L"TPM2_PolicyLocality", 0x0000016F, LONG_DURATION},
-	{L"TPM2_PolicyNameHash", 0x00000170, LONG_DURATION},				{L"TPM2_PolicyOR", 0x00000171, LONG_DURATION},					{L"TPM2_PolicyTicket", 0x00000172, LONG_DURATION},
-	{L"TPM2_ReadPublic", 0x00000173, LONG_DURATION},					{L"TPM2_RSA_Encrypt", 0x00000174, LONG_DURATION},				{L"TPM2_StartAuthSession", 0x00000176, LONG_DURATION},
-	{L"TPM2_VerifySignature", 0x00000177, LONG_DURATION},				{L"TPM2_ECC_Parameters", 0x00000178, LONG_DURATION},			{L"TPM2_FirmwareRead", 0x00000179, LONG_DURATION},
-	{L"TPM2_GetCapability", 0x0000017A, LONG_DURATION},					{L"TPM2_GetRandom", 0x0000017B, LONG_DURATION},					{L"TPM2_GetTestResult", 0x0000017C, LONG_DURATION},
-	{L"TPM2_Hash", 0x0000017D, LONG_DURATION},							{L"TPM2_PCR_Read", 0x0000017E, LONG_DURATION},					{L"TPM2_PolicyPCR", 0x0000017F, LONG_DURATION},
-	{L"TPM2_PolicyRestart", 0x00000180, LONG_DURATION},					{L"TPM2_ReadClock", 0x00000181, LONG_DURATION},					{L"TPM2_PCR_Extend", 0x00000182, LONG_DURATION},
-	{L"TPM2_PCR_SetAuthValue", 0x00000183, LONG_DURATION},				{L"TPM2_NV_Certify", 0x00000184, LONG_DURATION},				{L"TPM2_EventSequenceComplete", 0x00000185, LONG_DURATION},
-	{L"TPM2_HashSequenceStart", 0x00000186, LONG_DURATION},				{L"TPM2_PolicyPhysicalPresence", 0x00000187, LONG_DURATION},	{L"TPM2_PolicyDuplicationSelect", 0x00000188, LONG_DURATION},
-	{L"TPM2_PolicyGetDigest", 0x00000189, LONG_DURATION},				{L"TPM2_TestParms", 0x0000018A, LONG_DURATION},					{L"TPM2_Commit", 0x0000018B, LONG_DURATION},
-	{L"TPM2_PolicyPassword", 0x0000018C, LONG_DURATION},				{L"TPM2_ZGen_2Phase", 0x0000018D, LONG_DURATION},				{L"TPM2_EC_Ephemeral", 0x0000018E, LONG_DURATION},
-	{L"TPM2_PolicyNvWritten", 0x0000018F, LONG_DURATION},				{L"TPM2_FieldUpgradeStartVendor", 0x2000012F, LONG_DURATION},	{L"TPM2_SetCapabilityVendor", 0x20000400, LONG_DURATION}
+/// List of available TPM2.0 command names and their properties: command code, maximum and expected command duration
+static const IfxTpmCommand s_sTpm2Commands[] = {
+	{L"None", 0, LONG_DURATION, DEFAULT_EXPECTED_DURATION},										{L"TPM2_NV_UndefineSpaceSpecial", 0x0000011F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},	{L"TPM2_EvictControl", 0x00000120, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_HierarchyControl", 0x00000121, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_NV_UndefineSpace", 0x00000122, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_ChangeEPS", 0x00000124, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_ChangePPS", 0x00000125, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_Clear", 0x00000126, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_ClearControl", 0x00000127, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_ClockSet", 0x00000128, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_HierarchyChangeAuth", 0x00000129, LONG_DURATION, DEFAULT_EXPECTED_DURATION},		{L"TPM2_NV_DefineSpace", 0x0000012A, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PCR_Allocate", 0x0000012B, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_PCR_SetAuthPolicy", 0x0000012C, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_PP_Commands", 0x0000012D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_SetPrimaryPolicy", 0x0000012E, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_FieldUpgradeStart", 0x0000012F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_ClockRateAdjust", 0x00000130, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_CreatePrimary", 0x00000131, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_NV_GlobalWriteLock", 0x00000132, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_GetCommandAuditDigest", 0x00000133, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_NV_Increment", 0x00000134, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_NV_SetBits", 0x00000135, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_NV_Extend", 0x00000136, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_NV_Write", 0x00000137, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_NV_WriteLock", 0x00000138, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_DictionaryAttackLockReset", 0x00000139, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_DictionaryAttackParameters", 0x0000013A, LONG_DURATION, DEFAULT_EXPECTED_DURATION},	{L"TPM2_NV_ChangeAuth", 0x0000013B, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_PCR_Event", 0x0000013C, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PCR_Reset", 0x0000013D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_SequenceComplete", 0x0000013E, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_SetAlgorithmSet", 0x0000013F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_SetCommandCodeAuditStatus", 0x00000140, LONG_DURATION, DEFAULT_EXPECTED_DURATION},	{L"TPM2_FieldUpgradeData", 0x00000141, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_IncrementalSelfTest", 0x00000142, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_SelfTest", 0x00000143, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_Startup", 0x00000144, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_Shutdown", 0x00000145, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_StirRandom", 0x00000146, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_ActivateCredential", 0x00000147, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_Certify", 0x00000148, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PolicyNV", 0x00000149, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_CertifyCreation", 0x0000014A, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_Duplicate", 0x0000014B, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_GetTime", 0x0000014C, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_GetSessionAuditDigest", 0x0000014D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},		{L"TPM2_NV_Read", 0x0000014E, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_NV_ReadLock", 0x0000014F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_ObjectChangeAuth", 0x00000150, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_PolicySecret", 0x00000151, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_Rewrap", 0x00000152, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_Create", 0x00000153, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_ECDH_ZGen", 0x00000154, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_HMAC", 0x00000155, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_Import", 0x00000156, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_Load", 0x00000157, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_Quote", 0x00000158, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_RSA_Decrypt", 0x00000159, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_HMAC_Start", 0x0000015B, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_SequenceUpdate", 0x0000015C, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_Sign", 0x0000015D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_Unseal", 0x0000015E, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PolicySigned", 0x00000160, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_ContextLoad", 0x00000161, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_ContextSave", 0x00000162, LONG_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM2_ECDH_KeyGen", 0x00000163, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_EncryptDecrypt", 0x00000164, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_FlushContext", 0x00000165, LONG_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM2_LoadExternal", 0x00000167, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_MakeCredential", 0x00000168, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_NV_ReadPublic", 0x00000169, LONG_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM2_PolicyAuthorize", 0x0000016A, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_PolicyAuthValue", 0x0000016B, LONG_DURATION, SHORT_EXPECTED_DURATION},				{L"TPM2_PolicyCommandCode", 0x0000016C, LONG_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM2_PolicyCounterTimer", 0x0000016D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_PolicyCpHash", 0x0000016E, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_PolicyLocality", 0x0000016F, LONG_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM2_PolicyNameHash", 0x00000170, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_PolicyOR", 0x00000171, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_PolicyTicket", 0x00000172, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_ReadPublic", 0x00000173, LONG_DURATION, SHORT_EXPECTED_DURATION},					{L"TPM2_RSA_Encrypt", 0x00000174, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_StartAuthSession", 0x00000176, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_VerifySignature", 0x00000177, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_ECC_Parameters", 0x00000178, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_FirmwareRead", 0x00000179, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_GetCapability", 0x0000017A, LONG_DURATION, SHORT_EXPECTED_DURATION},				{L"TPM2_GetRandom", 0x0000017B, LONG_DURATION, SHORT_EXPECTED_DURATION},					{L"TPM2_GetTestResult", 0x0000017C, LONG_DURATION, SHORT_EXPECTED_DURATION},
+	{L"TPM2_Hash", 0x0000017D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},						{L"TPM2_PCR_Read", 0x0000017E, LONG_DURATION, SHORT_EXPECTED_DURATION},						{L"TPM2_PolicyPCR", 0x0000017F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PolicyRestart", 0x00000180, LONG_DURATION, SHORT_EXPECTED_DURATION},				{L"TPM2_ReadClock", 0x00000181, LONG_DURATION, SHORT_EXPECTED_DURATION},					{L"TPM2_PCR_Extend", 0x00000182, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PCR_SetAuthValue", 0x00000183, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_NV_Certify", 0x00000184, LONG_DURATION, DEFAULT_EXPECTED_DURATION},					{L"TPM2_EventSequenceComplete", 0x00000185, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_HashSequenceStart", 0x00000186, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_PolicyPhysicalPresence", 0x00000187, LONG_DURATION, SHORT_EXPECTED_DURATION},		{L"TPM2_PolicyDuplicationSelect", 0x00000188, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PolicyGetDigest", 0x00000189, LONG_DURATION, SHORT_EXPECTED_DURATION},				{L"TPM2_TestParms", 0x0000018A, LONG_DURATION, SHORT_EXPECTED_DURATION},					{L"TPM2_Commit", 0x0000018B, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PolicyPassword", 0x0000018C, LONG_DURATION, SHORT_EXPECTED_DURATION},				{L"TPM2_ZGen_2Phase", 0x0000018D, LONG_DURATION, DEFAULT_EXPECTED_DURATION},				{L"TPM2_EC_Ephemeral", 0x0000018E, LONG_DURATION, DEFAULT_EXPECTED_DURATION},
+	{L"TPM2_PolicyNvWritten", 0x0000018F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},			{L"TPM2_FieldUpgradeStartVendor", 0x2000012F, LONG_DURATION, DEFAULT_EXPECTED_DURATION},	{L"TPM2_SetCapabilityVendor", 0x20000400, LONG_DURATION, DEFAULT_EXPECTED_DURATION}
 };
 
+/**
+ *	@brief		Opens the capture file configured in PROPERTY_TPM_CAPTURE_PATH
+ *	@details	The capture stays open until the module is uninitialized. A capture file which cannot be written disables
+ *				the recording but does not affect the TPM communication.
+ */
+static void
+DeviceManagement_OpenCapture()
+{
+	wchar_t wszCapturePath[MAX_PATH] = {0};
+	unsigned int unCapturePathSize = RG_LEN(wszCapturePath);
+	BYTE rgbHeader[TPM_CAPTURE_FILE_HEADER_SIZE] = {0};
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_CAPTURE_PATH, wszCapturePath, &unCapturePathSize) ||
+			PLATFORM_STRING_IS_NULL_OR_EMPTY(wszCapturePath))
+		return;
+
+	unReturnValue = FileIO_Open(wszCapturePath, &s_pvCaptureFile, FILE_WRITE_BINARY);
+	if (RC_SUCCESS == unReturnValue)
+	{
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(rgbHeader, sizeof(rgbHeader), TPM_CAPTURE_MAGIC, TPM_CAPTURE_MAGIC_SIZE));
+		rgbHeader[TPM_CAPTURE_MAGIC_SIZE + 3] = TPM_CAPTURE_VERSION;
+		unReturnValue = FileIO_WriteBuffer(s_pvCaptureFile, rgbHeader, sizeof(rgbHeader));
+		if (RC_SUCCESS != unReturnValue)
+			IGNORE_RETURN_VALUE(FileIO_Close(&s_pvCaptureFile));
+	}
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		s_pvCaptureFile = NULL;
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: The capture file '%ls' cannot be written (0x%.8X), no capture is recorded.", wszCapturePath, unReturnValue);
+		return;
+	}
+
+	s_ullCaptureStartTime = Platform_GetMonotonicTimeMicroSeconds();
+	LOGGING_WRITE_LEVEL2_FMT(L"Recording the TPM commands to the capture file '%ls'", wszCapturePath);
+}
+
+/**
+ *	@brief		Appends a TPM command to the capture file
+ *	@details	The response is only recorded if the command was transmitted successfully. A failed write stops the
+ *				recording.
+ *
+ *	@param		PrgbRequestBuffer		Request bytes
+ *	@param		PunRequestBufferSize	Size of the request in bytes
+ *	@param		PrgbResponseBuffer		Response bytes
+ *	@param		PunResponseBufferSize	Size of the response in bytes
+ *	@param		PunTransmitReturnValue	Return code of the transmission
+ *	@param		PullStartTime			Monotonic time stamp of the start of the command in microseconds
+ *	@param		PullTransmitTime		Duration of the command in microseconds
+ */
+static void
+DeviceManagement_RecordCommand(
+	_In_bytecount_(PunRequestBufferSize)	const BYTE*			PrgbRequestBuffer,
+	_In_									unsigned int		PunRequestBufferSize,
+	_In_bytecount_(PunResponseBufferSize)	const BYTE*			PrgbResponseBuffer,
+	_In_									unsigned int		PunResponseBufferSize,
+	_In_									unsigned int		PunTransmitReturnValue,
+	_In_									unsigned long long	PullStartTime,
+	_In_									unsigned long long	PullTransmitTime)
+{
+	BYTE rgbHeader[TPM_CAPTURE_RECORD_HEADER_SIZE] = {0};
+	unsigned long long ullTimeStamp = PullStartTime - s_ullCaptureStartTime;
+	UINT32 rgunFields[4] = {0};
+	unsigned int unIndex = 0;
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (RC_SUCCESS != PunTransmitReturnValue)
+		PunResponseBufferSize = 0;
+
+	rgunFields[0] = PullTransmitTime > 0xFFFFFFFF ? 0xFFFFFFFF : (UINT32)PullTransmitTime;
+	rgunFields[1] = PunTransmitReturnValue;
+	rgunFields[2] = PunRequestBufferSize;
+	rgunFields[3] = PunResponseBufferSize;
+	for (unIndex = 0; unIndex < 8; unIndex++)
+		rgbHeader[unIndex] = (BYTE)(ullTimeStamp >> (56 - 8 * unIndex));
+	for (unIndex = 0; unIndex < RG_LEN(rgunFields); unIndex++)
+	{
+		rgbHeader[8 + 4 * unIndex] = (BYTE)(rgunFields[unIndex] >> 24);
+		rgbHeader[9 + 4 * unIndex] = (BYTE)(rgunFields[unIndex] >> 16);
+		rgbHeader[10 + 4 * unIndex] = (BYTE)(rgunFields[unIndex] >> 8);
+		rgbHeader[11 + 4 * unIndex] = (BYTE)rgunFields[unIndex];
+	}
+
+	unReturnValue = FileIO_WriteBuffer(s_pvCaptureFile, rgbHeader, sizeof(rgbHeader));
+	if (RC_SUCCESS == unReturnValue)
+		unReturnValue = FileIO_WriteBuffer(s_pvCaptureFile, PrgbRequestBuffer, PunRequestBufferSize);
+	if (RC_SUCCESS == unReturnValue && 0 != PunResponseBufferSize)
+		unReturnValue = FileIO_WriteBuffer(s_pvCaptureFile, PrgbResponseBuffer, PunResponseBufferSize);
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: Writing to the capture file failed (0x%.8X), the recording is stopped.", unReturnValue);
+		IGNORE_RETURN_VALUE(FileIO_Close(&s_pvCaptureFile));
+		s_pvCaptureFile = NULL;
+	}
+}
+
+/// Minimum number of successful executions of a command before its learned timeout replaces the static one
+#define LEARNED_TIMEOUT_MIN_SAMPLES 16
+/// Factor between the longest observed duration of a command and its learned timeout
+#define LEARNED_TIMEOUT_FACTOR 4
+/// Lower bound of a learned timeout in microseconds: 1 second
+#define LEARNED_TIMEOUT_MINIMUM 1000000
+/// Magic value identifying a learned timeouts file
+#define LEARNED_TIMEOUTS_MAGIC 0x49465854
+/// Maximum length of the key of a learned timeouts file in wide characters including zero termination
+#define LEARNED_TIMEOUTS_KEY_SIZE 128
+
+/**
+ *	@brief		Represents the observed durations of one command ordinal
+ */
+typedef struct tdIfxLearnedTimeout
+{
+	/// TPM command ordinal
+	unsigned int unCommandCode;
+	/// TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+	unsigned int unSubCommand;
+	/// Number of successful executions (saturates)
+	unsigned int unCount;
+	/// Longest successful execution in microseconds
+	unsigned int unMaxTime;
+} IfxLearnedTimeout;
+
+/**
+ *	@brief		Layout of the learned timeouts file
+ *	@details	The observed durations are only valid for the device, chip and firmware version given by the key.
+ */
+typedef struct tdIfxLearnedTimeouts
+{
+	/// Magic value (LEARNED_TIMEOUTS_MAGIC)
+	unsigned int unMagic;
+	/// Number of used entries in rgsEntries
+	unsigned int unCount;
+	/// Key of the TPM the durations were observed on, e.g. its device and firmware version name
+	wchar_t wszKey[LEARNED_TIMEOUTS_KEY_SIZE];
+	/// Observed durations per command ordinal
+	IfxLearnedTimeout rgsEntries[LATENCY_HISTOGRAM_MAX_ENTRIES];
+} IfxLearnedTimeouts;
+
+/// Observed command durations of the connected TPM
+static IfxLearnedTimeouts s_sLearnedTimeouts;
+
+/// File the learned timeouts are stored in (empty if learned timeouts are not used)
+static wchar_t s_wszLearnedTimeoutsFile[MAX_PATH] = {0};
+
+/// Flag indicating s_sLearnedTimeouts has changed since it was loaded
+static BOOL s_fLearnedTimeoutsChanged = FALSE;
+
+/**
+ *	@brief		Returns the learned timeout entry of a command ordinal
+ *
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PfCreate			TRUE to create a missing entry
+ *
+ *	@returns	Entry or NULL if the ordinal has no entry (and the table is full if PfCreate is TRUE)
+ */
+static IfxLearnedTimeout*
+DeviceManagement_GetLearnedTimeout(
+	_In_	unsigned int	PunCommandCode,
+	_In_	unsigned int	PunSubCommand,
+	_In_	BOOL			PfCreate)
+{
+	IfxLearnedTimeout* psEntry = NULL;
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < s_sLearnedTimeouts.unCount; unIndex++)
+	{
+		if (s_sLearnedTimeouts.rgsEntries[unIndex].unCommandCode == PunCommandCode &&
+			s_sLearnedTimeouts.rgsEntries[unIndex].unSubCommand == PunSubCommand)
+			return &s_sLearnedTimeouts.rgsEntries[unIndex];
+	}
+
+	if (PfCreate && s_sLearnedTimeouts.unCount < LATENCY_HISTOGRAM_MAX_ENTRIES)
+	{
+		psEntry = &s_sLearnedTimeouts.rgsEntries[s_sLearnedTimeouts.unCount++];
+		psEntry->unCommandCode = PunCommandCode;
+		psEntry->unSubCommand = PunSubCommand;
+		psEntry->unCount = 0;
+		psEntry->unMaxTime = 0;
+	}
+
+	return psEntry;
+}
+
+/**
+ *	@brief		Replaces the static timeout of a command by the learned one
+ *	@details	The learned timeout is LEARNED_TIMEOUT_FACTOR times the longest observed duration, at least
+ *				LEARNED_TIMEOUT_MINIMUM and never more than the static timeout. It is only used once the command has been
+ *				observed LEARNED_TIMEOUT_MIN_SAMPLES times.
+ *
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PpunMaxDuration		In: Static timeout in microseconds, Out: Timeout to use
+ *
+ *	@retval		TRUE				The learned timeout is used.
+ *	@retval		FALSE				The static timeout is kept.
+ */
+static BOOL
+DeviceManagement_ApplyLearnedTimeout(
+	_In_	unsigned int	PunCommandCode,
+	_In_	unsigned int	PunSubCommand,
+	_Inout_	unsigned int*	PpunMaxDuration)
+{
+	const IfxLearnedTimeout* psEntry = NULL;
+	unsigned long long ullTimeout = 0;
+
+	if (0 == s_wszLearnedTimeoutsFile[0])
+		return FALSE;
+
+	psEntry = DeviceManagement_GetLearnedTimeout(PunCommandCode, PunSubCommand, FALSE);
+	if (NULL == psEntry || psEntry->unCount < LEARNED_TIMEOUT_MIN_SAMPLES)
+		return FALSE;
+
+	ullTimeout = (unsigned long long)psEntry->unMaxTime * LEARNED_TIMEOUT_FACTOR;
+	if (ullTimeout < LEARNED_TIMEOUT_MINIMUM)
+		ullTimeout = LEARNED_TIMEOUT_MINIMUM;
+	if (ullTimeout >= *PpunMaxDuration)
+		return FALSE;
+
+	*PpunMaxDuration = (unsigned int)ullTimeout;
+	return TRUE;
+}
+
+/**
+ *	@brief		Records the duration of a successful command for the learned timeouts
+ *
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PullTime			Command duration in microseconds
+ */
+static void
+DeviceManagement_LearnTimeout(
+	_In_	unsigned int		PunCommandCode,
+	_In_	unsigned int		PunSubCommand,
+	_In_	unsigned long long	PullTime)
+{
+	IfxLearnedTimeout* psEntry = NULL;
+
+	if (0 == s_wszLearnedTimeoutsFile[0])
+		return;
+
+	psEntry = DeviceManagement_GetLearnedTimeout(PunCommandCode, PunSubCommand, TRUE);
+	if (NULL == psEntry)
+		return;
+
+	if (psEntry->unCount < UINT_MAX)
+		psEntry->unCount++;
+	if (PullTime > psEntry->unMaxTime)
+		psEntry->unMaxTime = PullTime > UINT_MAX ? UINT_MAX : (unsigned int)PullTime;
+	s_fLearnedTimeoutsChanged = TRUE;
+}
+
+/**
+ *	@brief		Stores the learned timeouts in their file if they have changed
+ *	@details	The timeouts are written to a temporary file which is renamed to the learned timeouts file, so an
+ *				interrupted run never leaves a truncated file behind. Errors are logged only, the next run learns the
+ *				timeouts again.
+ */
+static void
+DeviceManagement_StoreLearnedTimeouts()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+	wchar_t wszTemporaryFile[MAX_PATH] = {0};
+
+	if (0 == s_wszLearnedTimeoutsFile[0] || FALSE == s_fLearnedTimeoutsChanged)
+		return;
+
+	do
+	{
+		IfxStringBuilder sTemporaryFile;
+
+		Platform_StringBuilderInitialize(&sTemporaryFile, wszTemporaryFile, RG_LEN(wszTemporaryFile));
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sTemporaryFile, L"%ls.tmp", s_wszLearnedTimeoutsFile));
+		unReturnValue = sTemporaryFile.unReturnValue;
+		if (RC_SUCCESS != unReturnValue)
+		{
+			wszTemporaryFile[0] = L'\0';
+			break;
+		}
+		unReturnValue = FileIO_Open(wszTemporaryFile, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			wszTemporaryFile[0] = L'\0';
+			break;
+		}
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&s_sLearnedTimeouts, sizeof(s_sLearnedTimeouts));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Close(&pvFile);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Rename(wszTemporaryFile, s_wszLearnedTimeoutsFile);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		wszTemporaryFile[0] = L'\0';
+	}
+	WHILE_FALSE_END;
+
+	// Do not leave a partially written temporary file behind
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+	if (L'\0' != wszTemporaryFile[0])
+		IGNORE_RETURN_VALUE(FileIO_Remove(wszTemporaryFile));
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not write the learned timeouts file '%ls' (0x%.8X).", s_wszLearnedTimeoutsFile, unReturnValue);
+	}
+	s_fLearnedTimeoutsChanged = FALSE;
+}
+
 /**
  *	@brief		Device management initialization function
  *	@details	This function initializes the device IO.
@@ -148,8 +596,21 @@ DeviceManagement_Initialize()
 			s_fpTpmIoConnect		= &TPMIO_Connect;
 			s_fpTpmIoDisconnect		= &TPMIO_Disconnect;
 			s_fpTpmIoTransmit		= &TPMIO_Transmit;
+			s_fpTpmIoTransmitSegments = &TPMIO_TransmitSegments;
+			s_fpTpmIoTransmitBatch	= &TPMIO_TransmitBatch;
 			s_fpTpmIoReadRegister	= &TPMIO_ReadRegister;
 			s_fpTpmIoWriteRegister	= &TPMIO_WriteRegister;
+			s_fpTpmIoGetStatistics	= &TPMIO_GetStatistics;
+			s_fpTpmIoSetCommandPendingCallback = &TPMIO_SetCommandPendingCallback;
+			if (FALSE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_STATISTICS, &s_fCollectStatistics))
+				s_fCollectStatistics = FALSE;
+			if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_TROUBLESHOOTING_FRAMES, &s_unTroubleshootingFrames))
+				s_unTroubleshootingFrames = TROUBLESHOOTING_DEFAULT_FRAMES;
+			if (s_unTroubleshootingFrames > TROUBLESHOOTING_MAX_FRAMES)
+				s_unTroubleshootingFrames = TROUBLESHOOTING_MAX_FRAMES;
+			if (FALSE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_TPM_TROUBLESHOOTING, &s_fTroubleshooting))
+				s_fTroubleshooting = FALSE;
+			s_unTroubleshootingFramesRecorded = 0;
 			s_fInitialized = TRUE;
 		}
 		unReturnValue = RC_SUCCESS;
@@ -177,12 +638,29 @@ DeviceManagement_Uninitialize()
 		// Check if initialized
 		if (TRUE == DeviceManagement_IsInitialized())
 		{
+			if (TRUE == s_fCollectStatistics)
+				DeviceManagement_LogStatistics();
+
+			DeviceManagement_StoreLearnedTimeouts();
+
+			if (NULL != s_pvCaptureFile)
+				IGNORE_RETURN_VALUE(FileIO_Close(&s_pvCaptureFile));
+
 			// Uninitialize the TPM IO Function pointers
 			s_fpTpmIoConnect		= NULL;
 			s_fpTpmIoDisconnect		= NULL;
 			s_fpTpmIoTransmit		= NULL;
+			s_fpTpmIoTransmitSegments = NULL;
+			s_fpTpmIoTransmitBatch	= NULL;
 			s_fpTpmIoReadRegister	= NULL;
 			s_fpTpmIoWriteRegister	= NULL;
+			s_fpTpmIoGetStatistics	= NULL;
+			if (NULL != s_fpTpmIoSetCommandPendingCallback)
+				s_fpTpmIoSetCommandPendingCallback(NULL);
+			s_fpTpmIoSetCommandPendingCallback = NULL;
+			s_fpCommandPending = NULL;
+			s_fpPendingWork = NULL;
+			s_pvPendingWorkContext = NULL;
 			s_fInitialized = FALSE;
 		}
 		unReturnValue = RC_SUCCESS;
@@ -220,6 +698,22 @@ DeviceManagement_IsConnected()
 	return s_fTpmConnected;
 }
 
+/**
+ *	@brief		Device management IsLocked function
+ *	@details	This function returns whether the connected TPM device is locked against other instances of the tool. Without
+ *				the lock (e.g. resource manager, simulator or socket access, or a lock file that cannot be created) other
+ *				processes may use the TPM between the commands of the tool.
+ *
+ *	@retval		TRUE	If the TPM is connected and its device is locked
+ *	@retval		FALSE	Otherwise
+ */
+_Check_return_
+BOOL
+DeviceManagement_IsLocked()
+{
+	return s_fTpmConnected && NULL != Session_GetCurrent()->pvDeviceLock;
+}
+
 /**
  *	@brief		Connect to TPM
  *	@details	This function opens a connection to the underlying TPM access module (TpmIO interface).
@@ -262,7 +756,7 @@ DeviceManagement_Connect()
 			}
 
 			// Check for locality setting only if the TPM device is accessed through memory based access
-			if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessMode))
+			if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessMode))
 				unTpmDeviceAccessMode = TPM_DEVICE_ACCESS_MEMORY_BASED;
 
 			if (TPM_DEVICE_ACCESS_MEMORY_BASED == unTpmDeviceAccessMode)
@@ -272,6 +766,10 @@ DeviceManagement_Connect()
 					s_fIsLocalitySet = TRUE;
 			}
 
+			// Start recording the TPM commands if a capture file is configured
+			if (NULL == s_pvCaptureFile)
+				DeviceManagement_OpenCapture();
+
 			s_fTpmConnected = TRUE;
 		}
 		unReturnValue = RC_SUCCESS;
@@ -315,7 +813,7 @@ DeviceManagement_Disconnect()
 		if (TRUE == DeviceManagement_IsConnected())
 		{
 			// Set locality to original value only if the TPM device is accessed through memory based access
-			if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessMode))
+			if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessMode))
 				unTpmDeviceAccessMode = TPM_DEVICE_ACCESS_MEMORY_BASED;
 
 			if (TPM_DEVICE_ACCESS_MEMORY_BASED == unTpmDeviceAccessMode && s_fIsLocalitySet)
@@ -341,195 +839,830 @@ DeviceManagement_Disconnect()
 }
 
 /**
- *	@brief		Device transmit function
- *	@details	This function submits the TPM command to the underlying TPM access module (TpmIO interface).
- *
- *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
- *	@param		PunRequestBufferSize	Size of command request in bytes
- *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
- *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@brief		Records the duration of a TPM command in the latency histogram of its ordinal
+ *	@details	Commands beyond LATENCY_HISTOGRAM_MAX_ENTRIES distinct ordinals are not recorded.
  *
- *	@retval		RC_SUCCESS				The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. Invalid buffer or buffer size
- *	@retval		RC_E_NOT_INITIALIZED	The module could not be initialized
- *	@retval		RC_E_NOT_CONNECTED		The connection to the TPM failed
- *	@retval		RC_E_FAIL				An unexpected error occurred.
- *	@retval	...							Error codes from s_fpTpmIoTransmit function
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PullTime			Command duration in microseconds
  */
-_Check_return_
-unsigned int
-DeviceManagement_Transmit(
-	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
-	_In_										unsigned int	PunRequestBufferSize,
-	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
-	_Inout_										unsigned int*	PpunResponseBufferSize)
+static void
+DeviceManagement_RecordLatency(
+	_In_	unsigned int		PunCommandCode,
+	_In_	unsigned int		PunSubCommand,
+	_In_	unsigned long long	PullTime)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-
-	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+	IfxLatencyHistogram* psHistogram = NULL;
+	unsigned int unIndex = 0;
+	unsigned int unBucket = 0;
+	unsigned long long ullTime = PullTime;
 
-	do
+	for (unIndex = 0; unIndex < s_unLatencyHistogramCount; unIndex++)
 	{
-		unsigned int unCommandCode = 0;
-		unsigned int unTisMaxDuration = LONG_DURATION;
-
-		// Check parameters
-		if (NULL == PrgbRequestBuffer || NULL == PrgbResponseBuffer)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpbRequestBuffer or PpunResponseBufferSize is NULL)");
-			break;
-		}
-		if (0 == PunRequestBufferSize || 0 == PpunResponseBufferSize)
+		if (s_rgsLatencyHistograms[unIndex].unCommandCode == PunCommandCode &&
+			s_rgsLatencyHistograms[unIndex].unSubCommand == PunSubCommand)
 		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter PunRequestBufferSize or PpunResponseBufferSize has invalid value 0");
+			psHistogram = &s_rgsLatencyHistograms[unIndex];
 			break;
 		}
+	}
 
-		// Check if module is initialized
-		if (FALSE == DeviceManagement_IsInitialized())
-		{
-			// Set error code and fill error object
-			unReturnValue = RC_E_NOT_INITIALIZED;
-			ERROR_STORE(unReturnValue, L"Module not initialized (DeviceManagement)");
-			break;
-		}
+	if (NULL == psHistogram)
+	{
+		if (s_unLatencyHistogramCount >= LATENCY_HISTOGRAM_MAX_ENTRIES)
+			return;
+		psHistogram = &s_rgsLatencyHistograms[s_unLatencyHistogramCount++];
+		IGNORE_RETURN_VALUE(Platform_MemorySet(psHistogram, 0, sizeof(IfxLatencyHistogram)));
+		psHistogram->unCommandCode = PunCommandCode;
+		psHistogram->unSubCommand = PunSubCommand;
+	}
 
-		// Check if TPMIO is connected
-		if (FALSE == DeviceManagement_IsConnected())
-		{
-			unReturnValue = RC_E_NOT_CONNECTED;
-			ERROR_STORE(unReturnValue, L"TPM not connected");
-			break;
-		}
+	// Determine the log2 bucket of the duration
+	while (ullTime > 1 && unBucket < LATENCY_HISTOGRAM_BUCKETS - 1)
+	{
+		ullTime >>= 1;
+		unBucket++;
+	}
 
-		// Check if the request buffer holds at least enough bytes for the command length and code
-		if (PunRequestBufferSize >= 10)
-		{
-			unsigned int unShiftedCommandCode = 0;
-			// Get TPM command code
-			unReturnValue = Platform_MemoryCopy(&unCommandCode, sizeof(unCommandCode), (const void*) &PrgbRequestBuffer[6], sizeof(unsigned int));
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Unexpected returnvalue from function call Platform_MemoryCopy");
-				break;
-			}
-			// Switch command code endianness
-			unShiftedCommandCode = Platform_SwapBytes32(unCommandCode);
-			// Output the corresponding command name
-			DeviceManagement_TpmCommandName(unShiftedCommandCode, &unTisMaxDuration);
-		}
-		else
-		{
-			LOGGING_WRITE_LEVEL3(L"Sending unknown or invalid TPM Command");
-		}
+	psHistogram->rgunBuckets[unBucket]++;
+	psHistogram->unCount++;
+	if (PullTime > psHistogram->ullMaxTime)
+		psHistogram->ullMaxTime = PullTime;
+}
 
-		LOGGING_WRITE_LEVEL3_FMT(L"DeviceManagement_Transmit: Sending:  TxLen = %4d", PunRequestBufferSize);
-		LOGGING_WRITEHEX_LEVEL3(PrgbRequestBuffer, PunRequestBufferSize);
+/**
+ *	@brief		Determines a percentile of a latency histogram
+ *	@details	The result is the upper bound of the bucket holding the percentile, limited to the maximum duration.
+ *
+ *	@param		PpsHistogram		Latency histogram
+ *	@param		PunPercent			Percentile (1 - 100)
+ *
+ *	@returns	Percentile duration in microseconds
+ */
+static unsigned long long
+DeviceManagement_LatencyPercentile(
+	_In_	const IfxLatencyHistogram*	PpsHistogram,
+	_In_	unsigned int				PunPercent)
+{
+	unsigned long long ullRank = ((unsigned long long)PpsHistogram->unCount * PunPercent + 99) / 100;
+	unsigned long long ullCumulated = 0;
+	unsigned long long ullUpperBound = PpsHistogram->ullMaxTime;
+	unsigned int unBucket = 0;
 
-		// Cache the request for troubleshooting and clear the last TPM response cache
-		unReturnValue = Platform_MemoryCopy(g_rgbLastRequest, sizeof(g_rgbLastRequest), PrgbRequestBuffer, PunRequestBufferSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		g_unSizeLastRequest = PunRequestBufferSize;
-		g_unSizeLastResponse = 0;
-
-		unReturnValue = s_fpTpmIoTransmit(
-							PrgbRequestBuffer,
-							PunRequestBufferSize,
-							PrgbResponseBuffer,
-							PpunResponseBufferSize,
-							unTisMaxDuration);
-		if (RC_SUCCESS != unReturnValue)
+	for (unBucket = 0; unBucket < LATENCY_HISTOGRAM_BUCKETS; unBucket++)
+	{
+		ullCumulated += PpsHistogram->rgunBuckets[unBucket];
+		if (ullCumulated >= ullRank)
 		{
-			ERROR_STORE(unReturnValue, L"Error during TpmIOTransmit");
-
-			// Log the last TPM command/response for troubleshooting
-			LOGGING_WRITE_LEVEL1(L"Last TPM command:");
-			LOGGING_WRITEHEX_LEVEL1(g_rgbLastRequest, g_unSizeLastRequest);
-			LOGGING_WRITE_LEVEL1(L"Last TPM response:");
-			LOGGING_WRITEHEX_LEVEL1(g_rgbLastResponse, g_unSizeLastResponse);
-
+			ullUpperBound = 2ULL << unBucket;
 			break;
 		}
-
-		LOGGING_WRITE_LEVEL3_FMT(L"DeviceManagement_Transmit: Received:  RxLen = %4d", *PpunResponseBufferSize);
-		LOGGING_WRITEHEX_LEVEL3(PrgbResponseBuffer, *PpunResponseBufferSize);
-
-		// Cache the response for troubleshooting
-		unReturnValue = Platform_MemoryCopy(g_rgbLastResponse, sizeof(g_rgbLastResponse), PrgbResponseBuffer, *PpunResponseBufferSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		g_unSizeLastResponse = *PpunResponseBufferSize;
 	}
-	WHILE_FALSE_END;
-
-	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
-	return unReturnValue;
+	return ullUpperBound < PpsHistogram->ullMaxTime ? ullUpperBound : PpsHistogram->ullMaxTime;
 }
 
 /**
- *	@brief		Function to output TPM command name and return the duration.
- *	@details	This function determines the TPM command name from the command ordinal and puts it to the log file.
+ *	@brief		Looks up a TPM command in the command tables
+ *	@details	The tables are sorted by command code, so the lookup is a binary search.
  *
- *	@param		PunCommandCode			TPM command ordinal
- *	@param		PpunMaxDuration			Maximum command duration in microseconds (relevant for memory based access / TIS protocol only)
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *
+ *	@returns	Table entry or NULL if the command is unknown
  */
-void
-DeviceManagement_TpmCommandName(
+static const IfxTpmCommand*
+DeviceManagement_FindTpmCommand(
 	_In_	unsigned int	PunCommandCode,
-	_Out_	unsigned int*	PpunMaxDuration)
+	_In_	unsigned int	PunSubCommand)
 {
-	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+	const IfxTpmCommand* prgTpmCommands = NULL;
+	unsigned int unLower = 0, unUpper = 0, unMaxCount = 0;
 
-	do
+	if (LATENCY_NO_SUB_COMMAND != PunSubCommand)
 	{
-		unsigned int unIndex = 0, unMaxCount = 0;
-		IfxTpmCommand* prgTpmCommands = NULL;
-
-		// Initialize output parameters
-		*PpunMaxDuration = LONG_DURATION;
+		prgTpmCommands = s_sFieldUpgradeSubCommands;
+		unMaxCount = sizeof(s_sFieldUpgradeSubCommands) / sizeof(IfxTpmCommand);
+		PunCommandCode = PunSubCommand;
+	}
+	else if (PunCommandCode & 0x00000100)
+	{
+		prgTpmCommands = s_sTpm2Commands;
+		unMaxCount = sizeof(s_sTpm2Commands) / sizeof(IfxTpmCommand);
+	}
+	else
+	{
+		prgTpmCommands = s_sTpm1Commands;
+		unMaxCount = sizeof(s_sTpm1Commands) / sizeof(IfxTpmCommand);
+	}
 
-		// Determine if it is a TPM1.2 or TPM2.0 command code
-		if (PunCommandCode & 0x00000100)
-		{
-			// TPM2.0 command code
-			prgTpmCommands = s_sTpm2Commands;
-			unMaxCount = sizeof(s_sTpm2Commands) / sizeof(IfxTpmCommand);
-		}
+	// Find the first entry not below the command code
+	unUpper = unMaxCount;
+	while (unLower < unUpper)
+	{
+		unsigned int unMiddle = unLower + (unUpper - unLower) / 2;
+		if (prgTpmCommands[unMiddle].unCommandCode < PunCommandCode)
+			unLower = unMiddle + 1;
 		else
-		{
-			// TPM1.2 command code
-			prgTpmCommands = s_sTpm1Commands;
-			unMaxCount = sizeof(s_sTpm1Commands) / sizeof(IfxTpmCommand);
-		}
+			unUpper = unMiddle;
+	}
 
-		// Check for a known command code and eventually print out the command name
-		do
-		{
-			if (prgTpmCommands[unIndex].unCommandCode == PunCommandCode)
-			{
-				*PpunMaxDuration = prgTpmCommands[unIndex].unMaxDuration;
-				LOGGING_WRITE_LEVEL3_FMT(L"Sending TPM Command: %ls", prgTpmCommands[unIndex].pwszCommandName);
-				break;
-			}
-			unIndex++;
-		}
-		while(unIndex < unMaxCount);
+	if (unLower < unMaxCount && prgTpmCommands[unLower].unCommandCode == PunCommandCode)
+		return &prgTpmCommands[unLower];
 
-		// Print a warning message in case command code was not found
-		if (unIndex == unMaxCount)
-		{
-			LOGGING_WRITE_LEVEL3(L"Sending unknown TPM Command");
+	return NULL;
+}
+
+/**
+ *	@brief		Determines the name of a TPM command
+ *
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *
+ *	@returns	Command name or NULL if the command is unknown
+ */
+static const wchar_t*
+DeviceManagement_GetTpmCommandName(
+	_In_	unsigned int	PunCommandCode,
+	_In_	unsigned int	PunSubCommand)
+{
+	const IfxTpmCommand* psTpmCommand = DeviceManagement_FindTpmCommand(PunCommandCode, PunSubCommand);
+
+	return NULL == psTpmCommand ? NULL : psTpmCommand->pwszCommandName;
+}
+
+/**
+ *	@brief		Returns the name of the TPM command of a request
+ *	@details	The name of a TPM_FieldUpgrade request is the name of its sub command.
+ *
+ *	@param		PrgbRequestBuffer		Request bytes
+ *	@param		PunRequestBufferSize	Size of the request in bytes
+ *
+ *	@returns	Command name or NULL if the request is too short or the command is unknown
+ */
+const wchar_t*
+DeviceManagement_GetRequestCommandName(
+	_In_bytecount_(PunRequestBufferSize)	const BYTE*		PrgbRequestBuffer,
+	_In_									unsigned int	PunRequestBufferSize)
+{
+	unsigned int unCommandCode = 0;
+	unsigned int unSubCommand = LATENCY_NO_SUB_COMMAND;
+
+	if (NULL == PrgbRequestBuffer || PunRequestBufferSize < 10)
+		return NULL;
+
+	unCommandCode = ((unsigned int)PrgbRequestBuffer[6] << 24) | ((unsigned int)PrgbRequestBuffer[7] << 16) |
+					((unsigned int)PrgbRequestBuffer[8] << 8) | PrgbRequestBuffer[9];
+	if (TPM_CC_FieldUpgradeCommand == unCommandCode && PunRequestBufferSize > FIELDUPGRADE_SUB_COMMAND_OFFSET)
+		unSubCommand = PrgbRequestBuffer[FIELDUPGRADE_SUB_COMMAND_OFFSET];
+
+	return DeviceManagement_GetTpmCommandName(unCommandCode, unSubCommand);
+}
+
+/**
+ *	@brief		Writes a span of a TPM command or a batch of TPM commands to the trace file
+ *	@details	Unknown commands are named by their ordinal only.
+ *
+ *	@param		PunCommandCode		TPM command ordinal
+ *	@param		PunSubCommand		TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PunCount			Number of requests transmitted in the round trip
+ *	@param		PunRequestSize		Size of the requests in bytes
+ *	@param		PunResponseSize		Size of the response in bytes (0 for a batch)
+ *	@param		PunReturnValue		Return value of the transmission
+ *	@param		PullStartTime		Start of the transmission
+ *	@param		PullTransmitTime	Duration of the transmission in microseconds
+ */
+static void
+DeviceManagement_TraceCommand(
+	_In_	unsigned int		PunCommandCode,
+	_In_	unsigned int		PunSubCommand,
+	_In_	unsigned int		PunCount,
+	_In_	unsigned int		PunRequestSize,
+	_In_	unsigned int		PunResponseSize,
+	_In_	unsigned int		PunReturnValue,
+	_In_	unsigned long long	PullStartTime,
+	_In_	unsigned long long	PullTransmitTime)
+{
+	const wchar_t* pwszCommandName = DeviceManagement_GetTpmCommandName(PunCommandCode, PunSubCommand);
+
+	Trace_WriteSpan(TRACE_CATEGORY_TPM, NULL != pwszCommandName ? pwszCommandName : L"TPM command", PullStartTime, PullTransmitTime,
+		L"\"ordinal\":\"0x%.8X\",\"sub_command\":%d,\"count\":%u,\"request_size\":%u,\"response_size\":%u,\"rc\":\"0x%.8X\"",
+		PunCommandCode, LATENCY_NO_SUB_COMMAND == PunSubCommand ? -1 : (int)PunSubCommand, PunCount, PunRequestSize, PunResponseSize, PunReturnValue);
+}
+
+/**
+ *	@brief		Writes the cached request of the current TPM command to the log file
+ */
+static void
+DeviceManagement_LogRequest()
+{
+	IfxSession* pSession = Session_GetCurrent();
+
+	LOGGING_WRITE_LEVEL3_FMT(L"DeviceManagement_Transmit: Sending:  TxLen = %4d", pSession->unLastRequestSize);
+	LOGGING_WRITEHEX_LEVEL3(pSession->rgbLastRequest, pSession->unLastRequestSize);
+}
+
+/**
+ *	@brief		Runs the work item set with DeviceManagement_SetPendingWork, if any
+ *	@details	The work item is removed before it runs, so it runs exactly once.
+ */
+static void
+DeviceManagement_RunPendingWork()
+{
+	PFN_DEVICEMANAGEMENT_PENDINGWORK fpPendingWork = s_fpPendingWork;
+	void* pvContext = s_pvPendingWorkContext;
+
+	s_fpPendingWork = NULL;
+	s_pvPendingWorkContext = NULL;
+	if (NULL != fpPendingWork)
+		fpPendingWork(pvContext);
+}
+
+/**
+ *	@brief		Command pending callback of the TPM I/O layer
+ *	@details	Logs the request of the pending command and invokes the callback and the work item of the caller.
+ */
+static void
+DeviceManagement_OnCommandPending()
+{
+	if (TRUE == s_fRequestLogPending)
+	{
+		s_fRequestLogPending = FALSE;
+		DeviceManagement_LogRequest();
+	}
+
+	if (NULL != s_fpCommandPending)
+		s_fpCommandPending();
+
+	DeviceManagement_RunPendingWork();
+}
+
+/**
+ *	@brief		Keeps a TPM command in the ring of recent TPM commands
+ *
+ *	@param		PunCommandCode			TPM command ordinal
+ *	@param		PunSubCommand			TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PunRequestSize			Size of the request in bytes
+ *	@param		PrgbResponseBuffer		Response bytes
+ *	@param		PunResponseBufferSize	Size of the response in bytes
+ *	@param		PunTransmitReturnValue	Return code of the transmission
+ *	@param		PullDuration			Duration of the command in microseconds
+ */
+static void
+DeviceManagement_RecordTroubleshootingFrame(
+	_In_									unsigned int		PunCommandCode,
+	_In_									unsigned int		PunSubCommand,
+	_In_									unsigned int		PunRequestSize,
+	_In_bytecount_(PunResponseBufferSize)	const BYTE*			PrgbResponseBuffer,
+	_In_									unsigned int		PunResponseBufferSize,
+	_In_									unsigned int		PunTransmitReturnValue,
+	_In_									unsigned long long	PullDuration)
+{
+	IfxTroubleshootingFrame* psFrame = &s_rgsTroubleshootingFrames[s_unTroubleshootingFramesRecorded % s_unTroubleshootingFrames];
+
+	psFrame->unCommandCode = PunCommandCode;
+	psFrame->unSubCommand = PunSubCommand;
+	psFrame->unRequestSize = PunRequestSize;
+	psFrame->unResponseSize = RC_SUCCESS == PunTransmitReturnValue ? PunResponseBufferSize : 0;
+	psFrame->unResult = PunTransmitReturnValue;
+	if (RC_SUCCESS == PunTransmitReturnValue && PunResponseBufferSize >= 10)
+		psFrame->unResult = ((unsigned int)PrgbResponseBuffer[6] << 24) | ((unsigned int)PrgbResponseBuffer[7] << 16) |
+							((unsigned int)PrgbResponseBuffer[8] << 8) | PrgbResponseBuffer[9];
+	psFrame->ullDuration = PullDuration;
+	s_unTroubleshootingFramesRecorded++;
+}
+
+/**
+ *	@brief		Writes the ring of recent TPM commands to the log file (oldest command first)
+ */
+static void
+DeviceManagement_LogTroubleshootingFrames()
+{
+	unsigned int unCount = s_unTroubleshootingFramesRecorded < s_unTroubleshootingFrames ? s_unTroubleshootingFramesRecorded : s_unTroubleshootingFrames;
+	unsigned int unIndex = 0;
+
+	LOGGING_WRITE_LEVEL1_FMT(L"Last %d TPM command(s):", unCount);
+	for (unIndex = s_unTroubleshootingFramesRecorded - unCount; unIndex < s_unTroubleshootingFramesRecorded; unIndex++)
+	{
+		const IfxTroubleshootingFrame* psFrame = &s_rgsTroubleshootingFrames[unIndex % s_unTroubleshootingFrames];
+		const wchar_t* wszName = DeviceManagement_GetTpmCommandName(psFrame->unCommandCode, psFrame->unSubCommand);
+
+		LOGGING_WRITE_LEVEL1_FMT(L"  %ls (0x%.8X): TxLen = %4d RxLen = %4d Result = 0x%.8X Duration = %llu us",
+			NULL == wszName ? L"Unknown" : wszName, psFrame->unCommandCode, psFrame->unRequestSize, psFrame->unResponseSize,
+			psFrame->unResult, psFrame->ullDuration);
+	}
+}
+
+/**
+ *	@brief		Copies the parts of a request to a buffer
+ *	@details	Copies at most PunBufferSize bytes, further bytes of the request are skipped.
+ *
+ *	@param		PrgsRequestSegments		Parts of the TPM command request
+ *	@param		PunSegmentCount			Number of parts
+ *	@param		PrgbBuffer				Buffer receiving the request bytes
+ *	@param		PunBufferSize			Size of the buffer in bytes
+ *
+ *	@retval		Number of bytes copied to the buffer
+ */
+static unsigned int
+DeviceManagement_GatherRequest(
+	_In_reads_(PunSegmentCount)		const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_							unsigned int			PunSegmentCount,
+	_Out_bytecap_(PunBufferSize)	BYTE*					PrgbBuffer,
+	_In_							unsigned int			PunBufferSize)
+{
+	unsigned int unSize = 0;
+	unsigned int unSegment = 0;
+
+	for (unSegment = 0; unSegment < PunSegmentCount && unSize < PunBufferSize; unSegment++)
+	{
+		unsigned int unPartSize = PrgsRequestSegments[unSegment].unSize;
+		if (0 == unPartSize)
+			continue;
+		if (unPartSize > PunBufferSize - unSize)
+			unPartSize = PunBufferSize - unSize;
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PrgbBuffer[unSize], PunBufferSize - unSize, PrgsRequestSegments[unSegment].pbData, unPartSize));
+		unSize += unPartSize;
+	}
+
+	return unSize;
+}
+
+/**
+ *	@brief		Device transmit function
+ *	@details	This function submits the TPM command to the underlying TPM access module (TpmIO interface).
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from DeviceManagement_TransmitSegments function
+ */
+_Check_return_
+unsigned int
+DeviceManagement_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize)
+{
+	IfxTpmIoSegment sSegment = { PrgbRequestBuffer, PunRequestBufferSize };
+
+	return DeviceManagement_TransmitSegments(&sSegment, 1, PrgbResponseBuffer, PpunResponseBufferSize);
+}
+
+/**
+ *	@brief		Device transmit function for a request given in several parts
+ *	@details	This function submits the TPM command to the underlying TPM access module (TpmIO interface). Large
+ *				parameters like firmware blocks can be passed by reference instead of being copied into a request buffer.
+ *
+ *	@param		PrgsRequestSegments		Parts of the TPM command request
+ *	@param		PunSegmentCount			Number of parts
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. Invalid buffer or buffer size
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The request exceeds the size of the request cache
+ *	@retval		RC_E_NOT_INITIALIZED	The module could not be initialized
+ *	@retval		RC_E_NOT_CONNECTED		The connection to the TPM failed
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval	...							Error codes from s_fpTpmIoTransmit or s_fpTpmIoTransmitSegments function
+ */
+_Check_return_
+unsigned int
+DeviceManagement_TransmitSegments(
+	_In_reads_(PunSegmentCount)					const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_										unsigned int			PunSegmentCount,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*					PrgbResponseBuffer,
+	_Inout_										unsigned int*			PpunResponseBufferSize)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		BYTE rgbHeader[FIELDUPGRADE_SUB_COMMAND_OFFSET + 1] = {0};
+		unsigned int unHeaderSize = 0;
+		unsigned int unRequestSize = 0;
+		unsigned int unSegment = 0;
+		unsigned int unTisMaxDuration = LONG_DURATION;
+		unsigned int unTisExpectedDuration = DEFAULT_EXPECTED_DURATION;
+		unsigned int unShiftedCommandCode = 0;
+		unsigned int unSubCommand = LATENCY_NO_SUB_COMMAND;
+		unsigned long long ullStartTime = 0;
+		unsigned long long ullTransmitTime = 0;
+		BOOL fFullCopies = FALSE;
+		BOOL fCacheRequest = FALSE;
+		BOOL fLearnedTimeout = FALSE;
+
+		// Check parameters
+		if (NULL == PrgsRequestSegments || NULL == PrgbResponseBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PrgsRequestSegments or PrgbResponseBuffer is NULL)");
+			break;
+		}
+		for (unSegment = 0; unSegment < PunSegmentCount; unSegment++)
+		{
+			if (NULL == PrgsRequestSegments[unSegment].pbData)
+				break;
+			unRequestSize += PrgsRequestSegments[unSegment].unSize;
+		}
+		if (unSegment < PunSegmentCount)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (a request part is NULL)");
+			break;
+		}
+		if (0 == unRequestSize || 0 == PpunResponseBufferSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter PrgsRequestSegments or PpunResponseBufferSize has invalid size 0");
+			break;
+		}
+		if (unRequestSize > sizeof(pSession->rgbLastRequest))
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			ERROR_STORE(unReturnValue, L"The request exceeds the size of the request cache");
+			break;
+		}
+
+		// Check if module is initialized
+		if (FALSE == DeviceManagement_IsInitialized())
+		{
+			// Set error code and fill error object
+			unReturnValue = RC_E_NOT_INITIALIZED;
+			ERROR_STORE(unReturnValue, L"Module not initialized (DeviceManagement)");
+			break;
+		}
+
+		// Check if TPMIO is connected
+		if (FALSE == DeviceManagement_IsConnected())
+		{
+			unReturnValue = RC_E_NOT_CONNECTED;
+			ERROR_STORE(unReturnValue, L"TPM not connected");
+			break;
+		}
+
+		// Check if the request holds at least enough bytes for the command length and code
+		unHeaderSize = DeviceManagement_GatherRequest(PrgsRequestSegments, PunSegmentCount, rgbHeader, sizeof(rgbHeader));
+		if (unHeaderSize >= 10)
+		{
+			// Get TPM command code
+			unShiftedCommandCode = ((unsigned int)rgbHeader[6] << 24) | ((unsigned int)rgbHeader[7] << 16) |
+								   ((unsigned int)rgbHeader[8] << 8) | rgbHeader[9];
+			// TPM_FieldUpgrade multiplexes several sub commands with very different durations
+			if (TPM_CC_FieldUpgradeCommand == unShiftedCommandCode && unHeaderSize > FIELDUPGRADE_SUB_COMMAND_OFFSET)
+				unSubCommand = rgbHeader[FIELDUPGRADE_SUB_COMMAND_OFFSET];
+			// Output the corresponding command name
+			DeviceManagement_TpmCommandName(unShiftedCommandCode, unSubCommand, &unTisMaxDuration, &unTisExpectedDuration);
+			// A stuck TPM is detected after a multiple of the usual command duration instead of the static worst case
+			fLearnedTimeout = DeviceManagement_ApplyLearnedTimeout(unShiftedCommandCode, unSubCommand, &unTisMaxDuration);
+		}
+		else
+		{
+			LOGGING_WRITE_LEVEL3(L"Sending unknown or invalid TPM Command");
+		}
+
+		// Cache the request for troubleshooting and clear the last TPM response cache. Full copies are only made in
+		// troubleshooting mode and at logging level 3 and above, or if the request is recorded or the transport needs a
+		// contiguous request.
+		fFullCopies = (TRUE == s_fTroubleshooting || LOGGING_IS_ENABLED(LOGGING_LEVEL_3));
+		fCacheRequest = (TRUE == fFullCopies || NULL == s_fpTpmIoTransmitSegments || NULL != s_pvCaptureFile);
+		if (TRUE == fCacheRequest)
+			DeviceManagement_GatherRequest(PrgsRequestSegments, PunSegmentCount, pSession->rgbLastRequest, sizeof(pSession->rgbLastRequest));
+		pSession->unLastRequestSize = unRequestSize;
+		pSession->unLastResponseSize = 0;
+
+		// In pipelined mode the request is logged while the TPM executes the command
+		if (NULL != s_fpCommandPending || NULL != s_fpPendingWork)
+			s_fRequestLogPending = TRUE;
+		else
+			DeviceManagement_LogRequest();
+
+		if (TRUE == s_fCollectStatistics || NULL != s_pvCaptureFile || 0 != s_unTroubleshootingFrames || LOGGING_IS_ENABLED(LOGGING_LEVEL_3) ||
+				0 != s_wszLearnedTimeoutsFile[0] || TRACE_IS_ENABLED() || FLIGHTRECORDER_IS_ENABLED())
+			ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+
+		if (FLIGHTRECORDER_IS_ENABLED())
+		{
+			BYTE rgbRecord[FLIGHTRECORDER_DATA_SIZE] = {0};
+			unsigned int unRecordSize = DeviceManagement_GatherRequest(PrgsRequestSegments, PunSegmentCount, rgbRecord, sizeof(rgbRecord));
+			FlightRecorder_Record(FLIGHTRECORDER_RECORD_REQUEST, unShiftedCommandCode, unSubCommand, unRequestSize, 0, rgbRecord, unRecordSize);
+		}
+
+		PROBE2(transmit__entry, unShiftedCommandCode, unRequestSize);
+		if (NULL != s_fpTpmIoTransmitSegments)
+			unReturnValue = s_fpTpmIoTransmitSegments(
+								PrgsRequestSegments,
+								PunSegmentCount,
+								PrgbResponseBuffer,
+								PpunResponseBufferSize,
+								unTisMaxDuration,
+								unTisExpectedDuration);
+		else
+			unReturnValue = s_fpTpmIoTransmit(
+								pSession->rgbLastRequest,
+								unRequestSize,
+								PrgbResponseBuffer,
+								PpunResponseBufferSize,
+								unTisMaxDuration,
+								unTisExpectedDuration);
+		PROBE3(transmit__return, unShiftedCommandCode, unReturnValue, RC_SUCCESS == unReturnValue ? *PpunResponseBufferSize : 0);
+
+		// Log the request now in case the command could not be handed over to the TPM
+		if (TRUE == s_fRequestLogPending)
+		{
+			s_fRequestLogPending = FALSE;
+			DeviceManagement_LogRequest();
+		}
+
+		if (0 != ullStartTime)
+			ullTransmitTime = Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+		if (TRACE_IS_ENABLED())
+			DeviceManagement_TraceCommand(unShiftedCommandCode, unSubCommand, 1, unRequestSize, RC_SUCCESS == unReturnValue ? *PpunResponseBufferSize : 0,
+				unReturnValue, ullStartTime, ullTransmitTime);
+		if (0 != s_unTroubleshootingFrames)
+			DeviceManagement_RecordTroubleshootingFrame(unShiftedCommandCode, unSubCommand, unRequestSize, PrgbResponseBuffer,
+				*PpunResponseBufferSize, unReturnValue, ullTransmitTime);
+		if (FLIGHTRECORDER_IS_ENABLED())
+		{
+			unsigned int unResult = unReturnValue;
+			unsigned int unResponseSize = RC_SUCCESS == unReturnValue ? *PpunResponseBufferSize : 0;
+			if (unResponseSize >= 10)
+				unResult = ((unsigned int)PrgbResponseBuffer[6] << 24) | ((unsigned int)PrgbResponseBuffer[7] << 16) |
+						   ((unsigned int)PrgbResponseBuffer[8] << 8) | PrgbResponseBuffer[9];
+			FlightRecorder_Record(FLIGHTRECORDER_RECORD_RESPONSE, unShiftedCommandCode, unResponseSize, unResult,
+				ullTransmitTime > UINT_MAX ? UINT_MAX : (unsigned int)ullTransmitTime, PrgbResponseBuffer, unResponseSize);
+		}
+
+		if (TRUE == s_fCollectStatistics)
+		{
+			s_sStatistics.ullCommands++;
+			s_sStatistics.ullBytesSent += unRequestSize;
+			if (RC_SUCCESS == unReturnValue)
+				s_sStatistics.ullBytesReceived += *PpunResponseBufferSize;
+			s_sStatistics.ullTransmitTime += ullTransmitTime;
+			if (ullTransmitTime > s_sStatistics.ullMaxTransmitTime)
+				s_sStatistics.ullMaxTransmitTime = ullTransmitTime;
+			DeviceManagement_RecordLatency(unShiftedCommandCode, unSubCommand, ullTransmitTime);
+		}
+		if (NULL != s_pvCaptureFile)
+			DeviceManagement_RecordCommand(pSession->rgbLastRequest, unRequestSize, PrgbResponseBuffer, *PpunResponseBufferSize,
+				unReturnValue, ullStartTime, ullTransmitTime);
+		if (RC_SUCCESS == unReturnValue && 0 != ullStartTime)
+			DeviceManagement_LearnTimeout(unShiftedCommandCode, unSubCommand, ullTransmitTime);
+
+		// Log ordinal, duration and TPM response code (or the transmission error) of the command
+		if (LOGGING_IS_ENABLED(LOGGING_LEVEL_3))
+		{
+			unsigned int unResponseCode = unReturnValue;
+			if (RC_SUCCESS == unReturnValue && *PpunResponseBufferSize >= 10)
+				unResponseCode = ((unsigned int)PrgbResponseBuffer[6] << 24) | ((unsigned int)PrgbResponseBuffer[7] << 16) |
+								 ((unsigned int)PrgbResponseBuffer[8] << 8) | PrgbResponseBuffer[9];
+			LOGGING_WRITECOMMAND_LEVEL3(unShiftedCommandCode, ullTransmitTime, unResponseCode);
+		}
+
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Error during TpmIOTransmit");
+			if (fLearnedTimeout)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"The command used the learned timeout of %u us after %llu us (see '%ls').", unTisMaxDuration, ullTransmitTime, s_wszLearnedTimeoutsFile);
+			}
+
+			// Log the recent TPM commands and the full last TPM command/response for troubleshooting
+			if (0 != s_unTroubleshootingFrames)
+				DeviceManagement_LogTroubleshootingFrames();
+			FlightRecorder_Render(L"Flight recorder: The TPM command failed. The last records:");
+			if (TRUE == fFullCopies)
+			{
+				LOGGING_WRITE_LEVEL1(L"Last TPM command:");
+				LOGGING_WRITEHEX_LEVEL1(pSession->rgbLastRequest, pSession->unLastRequestSize);
+				LOGGING_WRITE_LEVEL1(L"Last TPM response:");
+				LOGGING_WRITEHEX_LEVEL1(pSession->rgbLastResponse, pSession->unLastResponseSize);
+			}
+
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL3_FMT(L"DeviceManagement_Transmit: Received:  RxLen = %4d", *PpunResponseBufferSize);
+		LOGGING_WRITEHEX_LEVEL3(PrgbResponseBuffer, *PpunResponseBufferSize);
+
+		// Cache the response for troubleshooting
+		if (TRUE == fFullCopies)
+		{
+			unReturnValue = Platform_MemoryCopy(pSession->rgbLastResponse, sizeof(pSession->rgbLastResponse), PrgbResponseBuffer, *PpunResponseBufferSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			pSession->unLastResponseSize = *PpunResponseBufferSize;
 		}
 	}
 	WHILE_FALSE_END;
 
-	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+	// Run a work item the command was not handed over to the TPM for now and leave the pipelined mode it switched on
+	if (NULL != s_fpPendingWork)
+		DeviceManagement_RunPendingWork();
+	if (NULL == s_fpCommandPending && NULL != s_fpTpmIoSetCommandPendingCallback)
+		s_fpTpmIoSetCommandPendingCallback(NULL);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Device transmit function for several requests in one round trip
+ *	@details	Hands the requests over to the TpmIO interface at once if the transport forwards the TPM commands over a
+ *				network (see TPM_DEVICE_ACCESS_REMOTE). The requests are executed back to back until the first one which
+ *				does not succeed. All requests must be of the same TPM command, the first one determines the timeout.
+ *
+ *	@param		PrgsRequestSegments		Parts of the requests, PunSegmentsPerRequest consecutive parts per request
+ *	@param		PunSegmentsPerRequest	Number of parts per request
+ *	@param		PunRequestCount			Number of requests
+ *	@param		PrgunResponseCodes		Receives the TPM response code of each executed request
+ *	@param		PpunExecuted			Receives the number of executed requests
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully, see PrgunResponseCodes for the result of each request.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_INITIALIZED		The module could not be initialized
+ *	@retval		RC_E_NOT_CONNECTED			The connection to the TPM failed
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The transport cannot transmit several requests in one round trip.
+ *	@retval	...								Error codes from s_fpTpmIoTransmitBatch function
+ */
+_Check_return_
+unsigned int
+DeviceManagement_TransmitBatch(
+	_In_reads_(PunSegmentsPerRequest * PunRequestCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_												unsigned int			PunSegmentsPerRequest,
+	_In_												unsigned int			PunRequestCount,
+	_Out_cap_(PunRequestCount)							unsigned int*			PrgunResponseCodes,
+	_Out_												unsigned int*			PpunExecuted)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		BYTE rgbHeader[FIELDUPGRADE_SUB_COMMAND_OFFSET + 1] = {0};
+		unsigned int unHeaderSize = 0;
+		unsigned int unTisMaxDuration = LONG_DURATION;
+		unsigned int unTisExpectedDuration = DEFAULT_EXPECTED_DURATION;
+		unsigned int unShiftedCommandCode = 0;
+		unsigned int unSubCommand = LATENCY_NO_SUB_COMMAND;
+		unsigned int unRequest = 0;
+		unsigned int unSegment = 0;
+		unsigned long long ullStartTime = 0;
+		unsigned long long ullTransmitTime = 0;
+
+		// Check parameters
+		if (NULL == PrgsRequestSegments || 0 == PunSegmentsPerRequest || 0 == PunRequestCount || NULL == PrgunResponseCodes || NULL == PpunExecuted)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PrgsRequestSegments, PrgunResponseCodes or PpunExecuted is NULL or a count is 0)");
+			break;
+		}
+		*PpunExecuted = 0;
+
+		// Check if module is initialized
+		if (FALSE == DeviceManagement_IsInitialized())
+		{
+			unReturnValue = RC_E_NOT_INITIALIZED;
+			ERROR_STORE(unReturnValue, L"Module not initialized (DeviceManagement)");
+			break;
+		}
+
+		// Check if TPMIO is connected
+		if (FALSE == DeviceManagement_IsConnected())
+		{
+			unReturnValue = RC_E_NOT_CONNECTED;
+			ERROR_STORE(unReturnValue, L"TPM not connected");
+			break;
+		}
+
+		// The caller falls back to single requests
+		if (NULL == s_fpTpmIoTransmitBatch)
+		{
+			unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+			break;
+		}
+
+		// All requests are of the same command, the first one determines the maximum duration of each
+		unHeaderSize = DeviceManagement_GatherRequest(PrgsRequestSegments, PunSegmentsPerRequest, rgbHeader, sizeof(rgbHeader));
+		if (unHeaderSize >= 10)
+		{
+			unShiftedCommandCode = ((unsigned int)rgbHeader[6] << 24) | ((unsigned int)rgbHeader[7] << 16) |
+								   ((unsigned int)rgbHeader[8] << 8) | rgbHeader[9];
+			if (TPM_CC_FieldUpgradeCommand == unShiftedCommandCode && unHeaderSize > FIELDUPGRADE_SUB_COMMAND_OFFSET)
+				unSubCommand = rgbHeader[FIELDUPGRADE_SUB_COMMAND_OFFSET];
+			DeviceManagement_TpmCommandName(unShiftedCommandCode, unSubCommand, &unTisMaxDuration, &unTisExpectedDuration);
+		}
+		LOGGING_WRITE_LEVEL3_FMT(L"DeviceManagement_TransmitBatch: Sending %d requests in one round trip", PunRequestCount);
+
+		if (TRUE == s_fCollectStatistics || LOGGING_IS_ENABLED(LOGGING_LEVEL_3) || TRACE_IS_ENABLED())
+			ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+
+		PROBE2(batch__entry, unShiftedCommandCode, PunRequestCount);
+		unReturnValue = s_fpTpmIoTransmitBatch(
+							PrgsRequestSegments,
+							PunSegmentsPerRequest,
+							PunRequestCount,
+							PrgunResponseCodes,
+							PpunExecuted,
+							unTisMaxDuration);
+		PROBE3(batch__return, unShiftedCommandCode, unReturnValue, *PpunExecuted);
+
+		if (0 != ullStartTime)
+			ullTransmitTime = Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+		if (TRACE_IS_ENABLED())
+		{
+			unsigned int unRequestSize = 0;
+			for (unSegment = 0; unSegment < PunSegmentsPerRequest * PunRequestCount; unSegment++)
+				unRequestSize += PrgsRequestSegments[unSegment].unSize;
+			DeviceManagement_TraceCommand(unShiftedCommandCode, unSubCommand, PunRequestCount, unRequestSize, 0, unReturnValue, ullStartTime, ullTransmitTime);
+		}
+
+		// The round trip is shared by the executed requests, each one is accounted with its share
+		if (TRUE == s_fCollectStatistics && 0 != *PpunExecuted)
+		{
+			s_sStatistics.ullCommands += *PpunExecuted;
+			for (unRequest = 0; unRequest < *PpunExecuted; unRequest++)
+			{
+				for (unSegment = 0; unSegment < PunSegmentsPerRequest; unSegment++)
+					s_sStatistics.ullBytesSent += PrgsRequestSegments[unRequest * PunSegmentsPerRequest + unSegment].unSize;
+				DeviceManagement_RecordLatency(unShiftedCommandCode, unSubCommand, ullTransmitTime / *PpunExecuted);
+			}
+			s_sStatistics.ullTransmitTime += ullTransmitTime;
+			if (ullTransmitTime / *PpunExecuted > s_sStatistics.ullMaxTransmitTime)
+				s_sStatistics.ullMaxTransmitTime = ullTransmitTime / *PpunExecuted;
+		}
+
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Error during TpmIOTransmitBatch");
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL3_FMT(L"DeviceManagement_TransmitBatch: %d of %d requests executed in %llu us (last response code 0x%.8X)",
+			*PpunExecuted, PunRequestCount, ullTransmitTime, 0 != *PpunExecuted ? PrgunResponseCodes[*PpunExecuted - 1] : 0);
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Function to output TPM command name and return the duration.
+ *	@details	This function determines the TPM command name from the command ordinal and puts it to the log file.
+ *				A known TPM_FieldUpgrade sub command takes precedence over the TPM_FieldUpgrade entry.
+ *
+ *	@param		PunCommandCode			TPM command ordinal
+ *	@param		PunSubCommand			TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PpunMaxDuration			Maximum command duration in microseconds
+ *	@param		PpunExpectedDuration	Expected command duration in microseconds (relevant for memory based access / TIS protocol only)
+ */
+void
+DeviceManagement_TpmCommandName(
+	_In_	unsigned int	PunCommandCode,
+	_In_	unsigned int	PunSubCommand,
+	_Out_	unsigned int*	PpunMaxDuration,
+	_Out_	unsigned int*	PpunExpectedDuration)
+{
+	const IfxTpmCommand* psTpmCommand = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	// Initialize output parameters
+	*PpunMaxDuration = LONG_DURATION;
+	*PpunExpectedDuration = DEFAULT_EXPECTED_DURATION;
+
+	if (LATENCY_NO_SUB_COMMAND != PunSubCommand)
+		psTpmCommand = DeviceManagement_FindTpmCommand(PunCommandCode, PunSubCommand);
+	if (NULL == psTpmCommand)
+		psTpmCommand = DeviceManagement_FindTpmCommand(PunCommandCode, LATENCY_NO_SUB_COMMAND);
+
+	// Check for a known command code and eventually print out the command name
+	if (NULL != psTpmCommand)
+	{
+		*PpunMaxDuration = psTpmCommand->unMaxDuration;
+		*PpunExpectedDuration = psTpmCommand->unExpectedDuration;
+		LOGGING_WRITE_LEVEL3_FMT(L"Sending TPM Command: %ls", psTpmCommand->pwszCommandName);
+	}
+	else
+	{
+		// Print a warning message in case command code was not found
+		LOGGING_WRITE_LEVEL3(L"Sending unknown TPM Command");
+	}
 
-	return;
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
 }
 
 /**
@@ -656,3 +1789,338 @@ DeviceManagement_WriteRegister(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Returns the time slept or blocked waiting for the TPM since the start of the application
+ *
+ *	@returns	Wait time in microseconds, 0 if the transport does not provide statistics
+ */
+static unsigned long long
+DeviceManagement_GetWaitTime()
+{
+	IfxTpmIoStatistics sTpmIoStatistics = {0, 0, 0, 0, 0, 0};
+
+	if (NULL != s_fpTpmIoGetStatistics)
+		s_fpTpmIoGetStatistics(&sTpmIoStatistics);
+
+	return sTpmIoStatistics.ullWaitTimeMicroSeconds;
+}
+
+/**
+ *	@brief		Starts to measure the host CPU time and the TPM wait time of a phase
+ *
+ *	@param		PpsLoad		Receives the current counters
+ */
+void
+DeviceManagement_StartPhaseLoad(
+	_Out_	IfxPhaseLoad*	PpsLoad)
+{
+	PpsLoad->ullCpuTime = Platform_GetThreadCpuTimeMicroSeconds();
+	PpsLoad->ullWaitTime = DeviceManagement_GetWaitTime();
+}
+
+/**
+ *	@brief		Stops to measure the host CPU time and the TPM wait time of a phase
+ *	@details	The wait time is only known for transports of the TPM I/O layer, it is zero for the other transports.
+ *				A counter which is not available or was reset in between (e.g. by a reconnect) yields zero.
+ *
+ *	@param		PpsLoad		Counters stored by DeviceManagement_StartPhaseLoad, receive the load of the phase
+ */
+void
+DeviceManagement_StopPhaseLoad(
+	_Inout_	IfxPhaseLoad*	PpsLoad)
+{
+	unsigned long long ullCpuTime = Platform_GetThreadCpuTimeMicroSeconds();
+	unsigned long long ullWaitTime = DeviceManagement_GetWaitTime();
+
+	PpsLoad->ullCpuTime = ullCpuTime > PpsLoad->ullCpuTime ? ullCpuTime - PpsLoad->ullCpuTime : 0;
+	PpsLoad->ullWaitTime = ullWaitTime > PpsLoad->ullWaitTime ? ullWaitTime - PpsLoad->ullWaitTime : 0;
+}
+
+/**
+ *	@brief		Writes the transport statistics to the log file
+ *	@details	This function logs the command statistics of the device management and the transport statistics
+ *				of the TPM I/O layer. The output allows to tell whether the run time is spent on register accesses,
+ *				in wait loops or in the TPM.
+ */
+void
+DeviceManagement_LogStatistics()
+{
+	IfxTpmIoStatistics sTpmIoStatistics = {0, 0, 0, 0, 0, 0};
+	unsigned long long ullCommands = s_sStatistics.ullCommands;
+
+	if (NULL != s_fpTpmIoGetStatistics)
+		s_fpTpmIoGetStatistics(&sTpmIoStatistics);
+
+	LOGGING_WRITE_LEVEL1(L"Transport statistics:");
+	LOGGING_WRITE_LEVEL1_FMT(L"  TPM commands            : %llu", ullCommands);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Bytes sent / received   : %llu / %llu", s_sStatistics.ullBytesSent, s_sStatistics.ullBytesReceived);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Command time total      : %llu us", s_sStatistics.ullTransmitTime);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Command time average    : %llu us", 0 == ullCommands ? 0 : s_sStatistics.ullTransmitTime / ullCommands);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Command time maximum    : %llu us", s_sStatistics.ullMaxTransmitTime);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Register reads/writes   : %llu / %llu", sTpmIoStatistics.ullRegisterReads, sTpmIoStatistics.ullRegisterWrites);
+	LOGGING_WRITE_LEVEL1_FMT(L"  FIFO bytes read/written : %llu / %llu", sTpmIoStatistics.ullFifoBytesRead, sTpmIoStatistics.ullFifoBytesWritten);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Wait loop iterations    : %llu", sTpmIoStatistics.ullWaitIterations);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Wait time               : %llu us", sTpmIoStatistics.ullWaitTimeMicroSeconds);
+
+	if (0 != s_unLatencyHistogramCount)
+	{
+		unsigned int unIndex = 0;
+
+		LOGGING_WRITE_LEVEL1(L"Command latency (p50 and p99 are log2 bucket upper bounds):");
+		for (unIndex = 0; unIndex < s_unLatencyHistogramCount; unIndex++)
+		{
+			const IfxLatencyHistogram* psHistogram = &s_rgsLatencyHistograms[unIndex];
+			const wchar_t* wszCommandName = DeviceManagement_GetTpmCommandName(psHistogram->unCommandCode, psHistogram->unSubCommand);
+
+			if (NULL != wszCommandName)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"  %-30ls: count %u, p50 %llu us, p99 %llu us, max %llu us", wszCommandName, psHistogram->unCount,
+					DeviceManagement_LatencyPercentile(psHistogram, 50), DeviceManagement_LatencyPercentile(psHistogram, 99), psHistogram->ullMaxTime);
+			}
+			else
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"  Ordinal 0x%.8X / 0x%.8X : count %u, p50 %llu us, p99 %llu us, max %llu us", psHistogram->unCommandCode, psHistogram->unSubCommand, psHistogram->unCount,
+					DeviceManagement_LatencyPercentile(psHistogram, 50), DeviceManagement_LatencyPercentile(psHistogram, 99), psHistogram->ullMaxTime);
+			}
+		}
+	}
+}
+
+/**
+ *	@brief		Sets the command pending callback
+ *	@details	While a callback is set, DeviceManagement_Transmit runs in pipelined mode: the request hex dump and the
+ *				callback are executed after the command has been handed over to the TPM, so that host-side work
+ *				overlaps the command execution. The callback must not transmit TPM commands itself.
+ *
+ *	@param		PfnCommandPending		Callback function or NULL to return to serial mode
+ */
+void
+DeviceManagement_SetCommandPendingCallback(
+	_In_opt_	PFN_DEVICEMANAGEMENT_COMMANDPENDINGCALLBACK	PfnCommandPending)
+{
+	s_fpCommandPending = PfnCommandPending;
+	if (NULL != s_fpTpmIoSetCommandPendingCallback)
+		s_fpTpmIoSetCommandPendingCallback(NULL != PfnCommandPending || NULL != s_fpPendingWork ? &DeviceManagement_OnCommandPending : NULL);
+}
+
+/**
+ *	@brief		Sets a work item for the next TPM command
+ *	@details	The next DeviceManagement_Transmit or DeviceManagement_TransmitSegments call, e.g. from a MicroTss command
+ *				function, runs PfnWork once after the command has been handed over to the TPM, so that host-side work
+ *				overlaps the execution of this single command. If the command cannot be handed over, PfnWork runs before
+ *				the call returns. PfnWork must not transmit TPM commands itself.
+ *
+ *	@param		PfnWork			Work item or NULL to remove a work item which has not run yet
+ *	@param		PpvContext		Context passed to PfnWork
+ */
+void
+DeviceManagement_SetPendingWork(
+	_In_opt_	PFN_DEVICEMANAGEMENT_PENDINGWORK	PfnWork,
+	_In_opt_	void*								PpvContext)
+{
+	s_fpPendingWork = PfnWork;
+	s_pvPendingWorkContext = PpvContext;
+	if (NULL != s_fpTpmIoSetCommandPendingCallback)
+		s_fpTpmIoSetCommandPendingCallback(NULL != s_fpCommandPending || NULL != PfnWork ? &DeviceManagement_OnCommandPending : NULL);
+}
+
+/// Transmit function of the in-process transport set with DeviceManagement_SetTransmitFunction
+static PFN_DEVICEMANAGEMENT_TRANSMIT s_fpInProcessTransmit = NULL;
+/// Command pending callback handed over to the in-process transport
+static PFN_TPMIO_CommandPendingCallback s_fpInProcessCommandPending = NULL;
+
+/**
+ *	@brief		Transmit function wrapping an in-process transport
+ *	@details	Runs the command pending callback before the in-process transport answers the command, like the TPM I/O
+ *				layer does while the TPM executes a command.
+ *
+ *	@param		PrgbRequestBuffer		Request buffer
+ *	@param		PunRequestBufferSize	Request buffer size
+ *	@param		PrgbResponseBuffer		Response buffer
+ *	@param		PpunResponseBufferSize	IN: Response buffer size
+ *										OUT: Response size
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds
+ *	@retval		...						Return values of the in-process transport
+ */
+_Check_return_
+static unsigned int
+DeviceManagement_TransmitInProcess(
+	_In_bytecount_(PunRequestBufferSize)	const BYTE*		PrgbRequestBuffer,
+	_In_									unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)	BYTE*			PrgbResponseBuffer,
+	_Inout_									unsigned int*	PpunResponseBufferSize,
+	_In_									unsigned int	PunMaxDuration,
+	_In_									unsigned int	PunExpectedDuration)
+{
+	if (NULL != s_fpInProcessCommandPending)
+		s_fpInProcessCommandPending();
+
+	return s_fpInProcessTransmit(PrgbRequestBuffer, PunRequestBufferSize, PrgbResponseBuffer, PpunResponseBufferSize, PunMaxDuration, PunExpectedDuration);
+}
+
+/**
+ *	@brief		Sets the command pending callback of an in-process transport
+ *
+ *	@param		PfnCommandPending		Callback function or NULL to remove the callback
+ */
+static void
+DeviceManagement_SetCommandPendingCallbackInProcess(
+	_In_opt_	PFN_TPMIO_CommandPendingCallback	PfnCommandPending)
+{
+	s_fpInProcessCommandPending = PfnCommandPending;
+}
+
+/**
+ *	@brief		Connect function of an in-process transport
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ */
+_Check_return_
+static unsigned int
+DeviceManagement_ConnectInProcess()
+{
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Register access function of an in-process transport
+ *
+ *	@param		PunRegisterAddress			Register address
+ *	@param		PpbRegisterValue			Receives 0
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	Register access is not supported.
+ */
+_Check_return_
+static unsigned int
+DeviceManagement_ReadRegisterInProcess(
+	_In_	unsigned int	PunRegisterAddress,
+	_Out_	BYTE*			PpbRegisterValue)
+{
+	UNREFERENCED_PARAMETER(PunRegisterAddress);
+	*PpbRegisterValue = 0;
+	return RC_E_NOT_SUPPORTED_FEATURE;
+}
+
+/**
+ *	@brief		Register access function of an in-process transport
+ *
+ *	@param		PunRegisterAddress			Register address
+ *	@param		PbRegisterValue				Ignored
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	Register access is not supported.
+ */
+_Check_return_
+static unsigned int
+DeviceManagement_WriteRegisterInProcess(
+	_In_	unsigned int	PunRegisterAddress,
+	_In_	BYTE			PbRegisterValue)
+{
+	UNREFERENCED_PARAMETER(PunRegisterAddress);
+	UNREFERENCED_PARAMETER(PbRegisterValue);
+	return RC_E_NOT_SUPPORTED_FEATURE;
+}
+
+/**
+ *	@brief		Replaces the TPM I/O layer by an in-process transport
+ *	@details	Must be called after DeviceManagement_Initialize and before DeviceManagement_Connect. Afterwards all TPM
+ *				commands are handed over to PfnTransmit, connect and disconnect do not access a TPM device and register
+ *				accesses are not supported. The next DeviceManagement_Initialize call restores the TPM I/O layer.
+ *				Used to measure the host side of the command flows without TPM hardware.
+ *
+ *	@param		PfnTransmit		Transmit function of the in-process transport
+ */
+void
+DeviceManagement_SetTransmitFunction(
+	_In_	PFN_DEVICEMANAGEMENT_TRANSMIT	PfnTransmit)
+{
+	if (NULL != s_fpTpmIoSetCommandPendingCallback)
+		s_fpTpmIoSetCommandPendingCallback(NULL);
+
+	s_fpInProcessTransmit	= PfnTransmit;
+	s_fpInProcessCommandPending = NULL;
+	s_fpTpmIoConnect		= &DeviceManagement_ConnectInProcess;
+	s_fpTpmIoDisconnect		= &DeviceManagement_ConnectInProcess;
+	s_fpTpmIoTransmit		= &DeviceManagement_TransmitInProcess;
+	s_fpTpmIoTransmitSegments = NULL;
+	s_fpTpmIoTransmitBatch	= NULL;
+	s_fpTpmIoReadRegister	= &DeviceManagement_ReadRegisterInProcess;
+	s_fpTpmIoWriteRegister	= &DeviceManagement_WriteRegisterInProcess;
+	s_fpTpmIoGetStatistics	= NULL;
+	s_fpTpmIoSetCommandPendingCallback = &DeviceManagement_SetCommandPendingCallbackInProcess;
+}
+
+/**
+ *	@brief		Loads the learned command timeouts of the connected TPM
+ *	@details	From now on the duration of each successful command is recorded, and a command observed often enough times
+ *				out after a multiple of its longest duration instead of the static timeout of its category, so a stuck
+ *				TPM is detected early. The durations are stored in PwszFileName by DeviceManagement_Uninitialize. If the
+ *				file belongs to another key (e.g. another device or firmware version) or is not private to the
+ *				effective user, learning starts over. Simulated, replayed and in-process TPMs are not learned from. Only
+ *				the first call per process has an effect.
+ *
+ *	@param		PwszFileName		File the learned timeouts are stored in
+ *	@param		PwszKey				Key of the connected TPM, e.g. its device and firmware version name
+ */
+void
+DeviceManagement_LoadLearnedTimeouts(
+	_In_z_	const wchar_t*	PwszFileName,
+	_In_z_	const wchar_t*	PwszKey)
+{
+	BYTE* prgbFile = NULL;
+	unsigned int unFileSize = 0;
+	unsigned int unAccessMode = 0;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		unsigned int unSize = RG_LEN(s_wszLearnedTimeoutsFile);
+		const IfxLearnedTimeouts* psFile = NULL;
+		unsigned long long ullFileSize = 0;
+		unsigned long long ullModificationTime = 0;
+		BOOL fPrivate = FALSE;
+
+		if (0 != s_wszLearnedTimeoutsFile[0] || PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszKey))
+			break;
+		if (&TPMIO_Transmit != s_fpTpmIoTransmit ||
+				(PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_MODE, &unAccessMode) &&
+				 (TPM_DEVICE_ACCESS_SIMULATED == unAccessMode || TPM_DEVICE_ACCESS_REPLAY == unAccessMode)))
+			break;
+
+		// Timeouts which could have been shortened by another user would let a working TPM time out
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sLearnedTimeouts, 0, sizeof(s_sLearnedTimeouts)));
+		if (RC_SUCCESS == FileIO_GetFileStatus(PwszFileName, &ullFileSize, &ullModificationTime, &fPrivate) && FALSE == fPrivate)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the learned timeouts file '%ls' because it is not private to the current user.", PwszFileName);
+		}
+		else if (sizeof(IfxLearnedTimeouts) == ullFileSize &&
+				RC_SUCCESS == FileIO_ReadFileToBuffer(PwszFileName, &prgbFile, &unFileSize) && sizeof(IfxLearnedTimeouts) == unFileSize)
+		{
+			psFile = (const IfxLearnedTimeouts*)prgbFile;
+			if (LEARNED_TIMEOUTS_MAGIC == psFile->unMagic && psFile->unCount <= LATENCY_HISTOGRAM_MAX_ENTRIES &&
+					0 == Platform_StringCompare(psFile->wszKey, PwszKey, LEARNED_TIMEOUTS_KEY_SIZE, FALSE))
+				IGNORE_RETURN_VALUE(Platform_MemoryCopy(&s_sLearnedTimeouts, sizeof(s_sLearnedTimeouts), psFile, sizeof(IfxLearnedTimeouts)));
+		}
+
+		s_sLearnedTimeouts.unMagic = LEARNED_TIMEOUTS_MAGIC;
+		s_sLearnedTimeouts.wszKey[LEARNED_TIMEOUTS_KEY_SIZE - 1] = L'\0';
+		if (0 == s_sLearnedTimeouts.wszKey[0])
+		{
+			unsigned int unKeySize = RG_LEN(s_sLearnedTimeouts.wszKey);
+			IGNORE_RETURN_VALUE(Platform_StringCopy(s_sLearnedTimeouts.wszKey, &unKeySize, PwszKey));
+			s_fLearnedTimeoutsChanged = TRUE;
+		}
+		if (RC_SUCCESS != Platform_StringCopy(s_wszLearnedTimeoutsFile, &unSize, PwszFileName))
+		{
+			s_wszLearnedTimeoutsFile[0] = 0;
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL3_FMT(L"Using learned timeouts of %u commands for '%ls'.", s_sLearnedTimeouts.unCount, s_sLearnedTimeouts.wszKey);
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbFile);
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
@@ -15,19 +15,26 @@
 #pragma once
 
 #include "StdInclude.h"
+#include "TpmIO.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/// Caches the last TPM command
-extern BYTE g_rgbLastRequest[4096];
-/// Caches the last TPM command
-extern unsigned int g_unSizeLastRequest;
-/// Caches the last TPM command
-extern BYTE g_rgbLastResponse[4096];
-/// Caches the last TPM response
-extern unsigned int g_unSizeLastResponse;
+/// Callback function invoked while a TPM command is executed by the TPM
+typedef void (*PFN_DEVICEMANAGEMENT_COMMANDPENDINGCALLBACK)();
+
+/// Work item run once while the next TPM command is executed by the TPM
+typedef void (*PFN_DEVICEMANAGEMENT_PENDINGWORK)(void* PpvContext);
+
+/// Transmit function of an in-process transport (same signature as the TPM I/O transmit function)
+typedef unsigned int (*PFN_DEVICEMANAGEMENT_TRANSMIT)(
+	const BYTE*		PrgbRequestBuffer,
+	unsigned int	PunRequestBufferSize,
+	BYTE*			PrgbResponseBuffer,
+	unsigned int*	PpunResponseBufferSize,
+	unsigned int	PunMaxDuration,
+	unsigned int	PunExpectedDuration);
 
 /**
  *	@brief		Represents a TPM command
@@ -38,8 +45,22 @@ typedef struct tdIfxTpmCommand
 	const wchar_t* pwszCommandName;
 	unsigned int unCommandCode;
 	unsigned int unMaxDuration;
+	unsigned int unExpectedDuration;
 } IfxTpmCommand;
 
+/**
+ *	@brief		Host CPU time and TPM wait time of a command phase
+ *	@details	DeviceManagement_StartPhaseLoad stores the current counters, DeviceManagement_StopPhaseLoad replaces them
+ *				with the time elapsed since then. All times are given in microseconds.
+ */
+typedef struct tdIfxPhaseLoad
+{
+	/// CPU time of the calling thread
+	unsigned long long ullCpuTime;
+	/// Time slept in the TIS and CRB wait loops or blocked in the TPM driver
+	unsigned long long ullWaitTime;
+} IfxPhaseLoad;
+
 /**
  *	@brief		Device management initialization function
  *	@details	This function initializes the device IO.
@@ -82,6 +103,19 @@ _Check_return_
 BOOL
 DeviceManagement_IsConnected();
 
+/**
+ *	@brief		Device management IsLocked function
+ *	@details	This function returns whether the connected TPM device is locked against other instances of the tool. Without
+ *				the lock (e.g. resource manager, simulator or socket access, or a lock file that cannot be created) other
+ *				processes may use the TPM between the commands of the tool.
+ *
+ *	@retval		TRUE	If the TPM is connected and its device is locked
+ *	@retval		FALSE	Otherwise
+ */
+_Check_return_
+BOOL
+DeviceManagement_IsLocked();
+
 /**
  *	@brief		Connect to TPM
  *	@details	This function opens a connection to the underlying TPM access module (TpmIO interface).
@@ -116,11 +150,7 @@ DeviceManagement_Disconnect();
  *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. Invalid buffer or buffer size
- *	@retval		RC_E_NOT_INITIALIZED	The module could not be initialized
- *	@retval		RC_E_NOT_CONNECTED		The connection to the TPM failed
- *	@retval		RC_E_FAIL				An unexpected error occurred.
- *	@retval	...							Error codes from s_fpTpmIoTransmit function
+ *	@retval		...						Error codes from DeviceManagement_TransmitSegments function
  */
 _Check_return_
 unsigned int
@@ -130,17 +160,90 @@ DeviceManagement_Transmit(
 	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
 	_Inout_										unsigned int*	PpunResponseBufferSize);
 
+/**
+ *	@brief		Device transmit function for a request given in several parts
+ *	@details	This function submits the TPM command to the underlying TPM access module (TpmIO interface). Large
+ *				parameters like firmware blocks can be passed by reference instead of being copied into a request buffer.
+ *
+ *	@param		PrgsRequestSegments		Parts of the TPM command request
+ *	@param		PunSegmentCount			Number of parts
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. Invalid buffer or buffer size
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The request exceeds the size of the request cache
+ *	@retval		RC_E_NOT_INITIALIZED	The module could not be initialized
+ *	@retval		RC_E_NOT_CONNECTED		The connection to the TPM failed
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval	...							Error codes from s_fpTpmIoTransmit or s_fpTpmIoTransmitSegments function
+ */
+_Check_return_
+unsigned int
+DeviceManagement_TransmitSegments(
+	_In_reads_(PunSegmentCount)					const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_										unsigned int			PunSegmentCount,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*					PrgbResponseBuffer,
+	_Inout_										unsigned int*			PpunResponseBufferSize);
+
+/**
+ *	@brief		Device transmit function for several requests in one round trip
+ *	@details	Hands the requests over to the TpmIO interface at once if the transport forwards the TPM commands over a
+ *				network (see TPM_DEVICE_ACCESS_REMOTE). The requests are executed back to back until the first one which
+ *				does not succeed. All requests must be of the same TPM command, the first one determines the timeout.
+ *
+ *	@param		PrgsRequestSegments		Parts of the requests, PunSegmentsPerRequest consecutive parts per request
+ *	@param		PunSegmentsPerRequest	Number of parts per request
+ *	@param		PunRequestCount			Number of requests
+ *	@param		PrgunResponseCodes		Receives the TPM response code of each executed request
+ *	@param		PpunExecuted			Receives the number of executed requests
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully, see PrgunResponseCodes for the result of each request.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_INITIALIZED		The module could not be initialized
+ *	@retval		RC_E_NOT_CONNECTED			The connection to the TPM failed
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The transport cannot transmit several requests in one round trip.
+ *	@retval	...								Error codes from s_fpTpmIoTransmitBatch function
+ */
+_Check_return_
+unsigned int
+DeviceManagement_TransmitBatch(
+	_In_reads_(PunSegmentsPerRequest * PunRequestCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_												unsigned int			PunSegmentsPerRequest,
+	_In_												unsigned int			PunRequestCount,
+	_Out_cap_(PunRequestCount)							unsigned int*			PrgunResponseCodes,
+	_Out_												unsigned int*			PpunExecuted);
+
 /**
  *	@brief		Function to output TPM command name and return the duration.
  *	@details	This function determines the TPM command name from the command ordinal and puts it to the log file.
+ *				A known TPM_FieldUpgrade sub command takes precedence over the TPM_FieldUpgrade entry.
  *
  *	@param		PunCommandCode			TPM command ordinal
- *	@param		PpunMaxDuration			Maximum command duration in microseconds (relevant for memory based access / TIS protocol only)
+ *	@param		PunSubCommand			TPM_FieldUpgrade sub command or LATENCY_NO_SUB_COMMAND
+ *	@param		PpunMaxDuration			Maximum command duration in microseconds
+ *	@param		PpunExpectedDuration	Expected command duration in microseconds (relevant for memory based access / TIS protocol only)
  */
 void
 DeviceManagement_TpmCommandName(
 	_In_	unsigned int	PunCommandCode,
-	_Out_	unsigned int*	PpunMaxDuration);
+	_In_	unsigned int	PunSubCommand,
+	_Out_	unsigned int*	PpunMaxDuration,
+	_Out_	unsigned int*	PpunExpectedDuration);
+
+/**
+ *	@brief		Returns the name of the TPM command of a request
+ *	@details	The name of a TPM_FieldUpgrade request is the name of its sub command.
+ *
+ *	@param		PrgbRequestBuffer		Request bytes
+ *	@param		PunRequestBufferSize	Size of the request in bytes
+ *
+ *	@returns	Command name or NULL if the request is too short or the command is unknown
+ */
+const wchar_t*
+DeviceManagement_GetRequestCommandName(
+	_In_bytecount_(PunRequestBufferSize)	const BYTE*		PrgbRequestBuffer,
+	_In_									unsigned int	PunRequestBufferSize);
 
 /**
  *	@brief		Register read function
@@ -182,6 +285,91 @@ DeviceManagement_WriteRegister(
 	_In_	unsigned int	PunRegisterAddress,
 	_In_	BYTE			PbRegisterValue);
 
+/**
+ *	@brief		Writes the transport statistics to the log file
+ *	@details	This function logs the command statistics of the device management and the transport statistics
+ *				of the TPM I/O layer. The output allows to tell whether the run time is spent on register accesses,
+ *				in wait loops or in the TPM.
+ */
+void
+DeviceManagement_LogStatistics();
+
+/**
+ *	@brief		Starts to measure the host CPU time and the TPM wait time of a phase
+ *
+ *	@param		PpsLoad		Receives the current counters
+ */
+void
+DeviceManagement_StartPhaseLoad(
+	_Out_	IfxPhaseLoad*	PpsLoad);
+
+/**
+ *	@brief		Stops to measure the host CPU time and the TPM wait time of a phase
+ *	@details	The wait time is only known for transports of the TPM I/O layer, it is zero for the other transports.
+ *
+ *	@param		PpsLoad		Counters stored by DeviceManagement_StartPhaseLoad, receive the load of the phase
+ */
+void
+DeviceManagement_StopPhaseLoad(
+	_Inout_	IfxPhaseLoad*	PpsLoad);
+
+/**
+ *	@brief		Sets the command pending callback
+ *	@details	While a callback is set, DeviceManagement_Transmit runs in pipelined mode: the request hex dump and the
+ *				callback are executed after the command has been handed over to the TPM, so that host-side work
+ *				overlaps the command execution. The callback must not transmit TPM commands itself.
+ *
+ *	@param		PfnCommandPending		Callback function or NULL to return to serial mode
+ */
+void
+DeviceManagement_SetCommandPendingCallback(
+	_In_opt_	PFN_DEVICEMANAGEMENT_COMMANDPENDINGCALLBACK	PfnCommandPending);
+
+/**
+ *	@brief		Sets a work item for the next TPM command
+ *	@details	The next DeviceManagement_Transmit or DeviceManagement_TransmitSegments call, e.g. from a MicroTss command
+ *				function, runs PfnWork once after the command has been handed over to the TPM, so that host-side work
+ *				overlaps the execution of this single command. If the command cannot be handed over, PfnWork runs before
+ *				the call returns. PfnWork must not transmit TPM commands itself.
+ *
+ *	@param		PfnWork			Work item or NULL to remove a work item which has not run yet
+ *	@param		PpvContext		Context passed to PfnWork
+ */
+void
+DeviceManagement_SetPendingWork(
+	_In_opt_	PFN_DEVICEMANAGEMENT_PENDINGWORK	PfnWork,
+	_In_opt_	void*								PpvContext);
+
+/**
+ *	@brief		Replaces the TPM I/O layer by an in-process transport
+ *	@details	Must be called after DeviceManagement_Initialize and before DeviceManagement_Connect. Afterwards all TPM
+ *				commands are handed over to PfnTransmit, connect and disconnect do not access a TPM device and register
+ *				accesses are not supported. The next DeviceManagement_Initialize call restores the TPM I/O layer.
+ *				Used to measure the host side of the command flows without TPM hardware.
+ *
+ *	@param		PfnTransmit		Transmit function of the in-process transport
+ */
+void
+DeviceManagement_SetTransmitFunction(
+	_In_	PFN_DEVICEMANAGEMENT_TRANSMIT	PfnTransmit);
+
+/**
+ *	@brief		Loads the learned command timeouts of the connected TPM
+ *	@details	From now on the duration of each successful command is recorded, and a command observed often enough times
+ *				out after a multiple of its longest duration instead of the static timeout of its category, so a stuck
+ *				TPM is detected early. The durations are stored in PwszFileName by DeviceManagement_Uninitialize. If the
+ *				file belongs to another key (e.g. another device or firmware version) or is not private to the
+ *				effective user, learning starts over. Simulated, replayed and in-process TPMs are not learned from. Only
+ *				the first call per process has an effect.
+ *
+ *	@param		PwszFileName		File the learned timeouts are stored in
+ *	@param		PwszKey				Key of the connected TPM, e.g. its device and firmware version name
+ */
+void
+DeviceManagement_LoadLearnedTimeouts(
+	_In_z_	const wchar_t*	PwszFileName,
+	_In_z_	const wchar_t*	PwszKey);
+
 #ifdef __cplusplus
 }
 #endif
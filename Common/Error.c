@@ -18,13 +18,78 @@
 #include "Logging.h"
 #include "Platform.h"
 #include "TpmResponse.h"
+#include "Session.h"
+#include "FlightRecorder.h"
+#include "MessageCatalog.h"
 
-/// Pointer to a IfxErrorData structure to store error parameters
-IfxErrorData* s_pErrorData = NULL;
+/**
+ *	@brief		Enum for the argument types of a conversion specification in an internal error message format
+ *	@details
+ */
+typedef enum td_ENUM_ERROR_ARGUMENT_TYPES
+{
+	/// No argument ('%%')
+	ERROR_ARGUMENT_NONE,
+	/// int (also for char and short)
+	ERROR_ARGUMENT_INT,
+	/// long
+	ERROR_ARGUMENT_LONG,
+	/// long long
+	ERROR_ARGUMENT_LONGLONG,
+	/// size_t
+	ERROR_ARGUMENT_SIZE,
+	/// intmax_t
+	ERROR_ARGUMENT_INTMAX,
+	/// ptrdiff_t
+	ERROR_ARGUMENT_PTRDIFF,
+	/// double
+	ERROR_ARGUMENT_DOUBLE,
+	/// void*
+	ERROR_ARGUMENT_POINTER,
+	/// wchar_t* string
+	ERROR_ARGUMENT_WIDE_STRING,
+	/// char* string
+	ERROR_ARGUMENT_ANSI_STRING
+} ENUM_ERROR_ARGUMENT_TYPES;
+
+/**
+ *	@brief		Parsed conversion specification of an internal error message format
+ *	@details
+ */
+typedef struct tdIfxErrorConversion
+{
+	/// Length of the conversion specification including the '%'
+	unsigned int				unLength;
+	/// Number of '*' width and precision arguments preceding the value argument
+	unsigned int				unStarCount;
+	/// Type of the value argument
+	ENUM_ERROR_ARGUMENT_TYPES	unType;
+} IfxErrorConversion;
 
 //>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 // Private functions
 
+/**
+ *	@brief		Releases an IfxErrorData structure
+ *	@details	Pooled structures are returned to the pool, others are freed.
+ *
+ *	@param		PpErrorData		Pointer to the structure to release
+ */
+void
+Error_ReleaseErrorData(
+	_In_ IfxErrorData* PpErrorData)
+{
+	if (PpErrorData->fPooled)
+	{
+		PpErrorData->pPreviousError = NULL;
+		PpErrorData->fInUse = FALSE;
+	}
+	else
+	{
+		Platform_MemoryFree((void**)&PpErrorData);
+	}
+}
+
 /**
  *	@brief		Function to clear the error stack
  *	@details	This function clears all elements on the error stack.
@@ -35,134 +100,389 @@ Error_ClearStackInternal(
 {
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
-	// Check if parameter is not null
-	if (NULL != PpErrorData)
+	// Release the structure and all child structures
+	while (NULL != PpErrorData)
 	{
-		// Check if a child structure is stored
-		if (NULL != PpErrorData->pPreviousError)
+		IfxErrorData* pPreviousError = (IfxErrorData*)PpErrorData->pPreviousError;
+		Error_ReleaseErrorData(PpErrorData);
+		PpErrorData = pPreviousError;
+	}
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
+
+/**
+ *	@brief		Parses a conversion specification of an internal error message format
+ *	@details	Supports the flags, width, precision and length modifiers of the printf family. The conversions
+ *				'n' and 'L' qualified ones are not supported.
+ *
+ *	@param		PwszSpecification	Pointer to the '%' starting the conversion specification
+ *	@param		PpConversion		Pointer to the parsed conversion specification
+ *
+ *	@retval		TRUE		If the conversion specification is complete and supported
+ *	@retval		FALSE		Otherwise
+ */
+_Check_return_
+BOOL
+Error_ParseConversion(
+	_In_z_	const wchar_t*		PwszSpecification,
+	_Out_	IfxErrorConversion*	PpConversion)
+{
+	BOOL fReturnValue = FALSE;
+	unsigned int unIndex = 1;
+	unsigned int unLongCount = 0;
+	wchar_t wcModifier = L'\0';
+
+	PpConversion->unLength = 0;
+	PpConversion->unStarCount = 0;
+	PpConversion->unType = ERROR_ARGUMENT_NONE;
+
+	do
+	{
+		// Flags
+		while (L'-' == PwszSpecification[unIndex] || L'+' == PwszSpecification[unIndex] || L' ' == PwszSpecification[unIndex] ||
+				L'#' == PwszSpecification[unIndex] || L'0' == PwszSpecification[unIndex])
+			unIndex++;
+
+		// Width and precision
+		if (L'*' == PwszSpecification[unIndex])
 		{
-			// Call recursive to clear child structures first
-			Error_ClearStackInternal((IfxErrorData*)PpErrorData->pPreviousError);
-			PpErrorData->pPreviousError = NULL;
+			PpConversion->unStarCount++;
+			unIndex++;
+		}
+		while (L'0' <= PwszSpecification[unIndex] && L'9' >= PwszSpecification[unIndex])
+			unIndex++;
+		if (L'.' == PwszSpecification[unIndex])
+		{
+			unIndex++;
+			if (L'*' == PwszSpecification[unIndex])
+			{
+				PpConversion->unStarCount++;
+				unIndex++;
+			}
+			while (L'0' <= PwszSpecification[unIndex] && L'9' >= PwszSpecification[unIndex])
+				unIndex++;
 		}
 
-		// Now clear the structure
-		Platform_MemoryFree((void**)&PpErrorData);
+		// Length modifier
+		for (; L'l' == PwszSpecification[unIndex]; unIndex++)
+			unLongCount++;
+		if (0 == unLongCount && (L'h' == PwszSpecification[unIndex] || L'z' == PwszSpecification[unIndex] ||
+								 L'j' == PwszSpecification[unIndex] || L't' == PwszSpecification[unIndex]))
+		{
+			wcModifier = PwszSpecification[unIndex++];
+			if (L'h' == wcModifier && L'h' == PwszSpecification[unIndex])
+				unIndex++;
+		}
+		if (unLongCount > 2)
+			break;
+
+		// Conversion
+		switch (PwszSpecification[unIndex])
+		{
+			case L'%':
+				if (1 != unIndex)
+					break;
+				fReturnValue = TRUE;
+				break;
+			case L'd':
+			case L'i':
+			case L'o':
+			case L'u':
+			case L'x':
+			case L'X':
+			case L'c':
+				if (L'z' == wcModifier)
+					PpConversion->unType = ERROR_ARGUMENT_SIZE;
+				else if (L'j' == wcModifier)
+					PpConversion->unType = ERROR_ARGUMENT_INTMAX;
+				else if (L't' == wcModifier)
+					PpConversion->unType = ERROR_ARGUMENT_PTRDIFF;
+				else if (2 == unLongCount)
+					PpConversion->unType = ERROR_ARGUMENT_LONGLONG;
+				else if (1 == unLongCount && L'c' != PwszSpecification[unIndex])
+					PpConversion->unType = ERROR_ARGUMENT_LONG;
+				else
+					PpConversion->unType = ERROR_ARGUMENT_INT;
+				fReturnValue = TRUE;
+				break;
+			case L's':
+				PpConversion->unType = 0 != unLongCount ? ERROR_ARGUMENT_WIDE_STRING : ERROR_ARGUMENT_ANSI_STRING;
+				fReturnValue = 2 > unLongCount && L'\0' == wcModifier;
+				break;
+			case L'p':
+				PpConversion->unType = ERROR_ARGUMENT_POINTER;
+				fReturnValue = TRUE;
+				break;
+			case L'f':
+			case L'F':
+			case L'e':
+			case L'E':
+			case L'g':
+			case L'G':
+			case L'a':
+			case L'A':
+				PpConversion->unType = ERROR_ARGUMENT_DOUBLE;
+				fReturnValue = TRUE;
+				break;
+			default:
+				break;
+		}
+
+		PpConversion->unLength = unIndex + 1;
 	}
+	WHILE_FALSE_END;
 
-	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+	return fReturnValue;
 }
 
 /**
- *	@brief		Maps the ErrorCode to the final one
- *	@details	This function maps the internal error code to the final one displayed to the end user.
+ *	@brief		Appends a string to the text buffer of an IfxErrorData structure
+ *	@details	The string is truncated if it does not fit. Exactly one of the string parameters must be set,
+ *				ANSI strings are widened character by character.
  *
- *	@returns	The mapped final error code
+ *	@param		PpErrorData		Pointer to the structure
+ *	@param		PwszString		Wide string to append or NULL
+ *	@param		PszString		ANSI string to append or NULL
+ *
+ *	@returns	The offset of the appended zero terminated string in the text buffer
  */
 _Check_return_
 unsigned int
-Error_MapToFinalCode(
-	_In_ unsigned int PunErrorCode)
+Error_AppendText(
+	_Inout_		IfxErrorData*	PpErrorData,
+	_In_opt_	const wchar_t*	PwszString,
+	_In_opt_	const char*		PszString)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unOffset = PpErrorData->unTextUsed;
+	unsigned int unIndex = 0;
 
-	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+	// The last element of a full buffer is a zero termination
+	if (unOffset >= ERROR_TEXT_SIZE)
+		return ERROR_TEXT_SIZE - 1;
 
-	switch (PunErrorCode)
+	for (unIndex = 0; PpErrorData->unTextUsed < ERROR_TEXT_SIZE - 1; unIndex++)
 	{
-		// Error codes as they are
-		case RC_E_FAIL:
-		case RC_E_BAD_COMMANDLINE:
-		case RC_E_TPM_GENERAL:
-		case RC_E_INTERNAL:
-		case RC_E_NO_TPM:
-		case RC_E_NO_IFXTPM20:
-		case RC_E_FLAGCHECK:
-		case RC_E_EKCHECK:
-		case RC_E_HASHCHECK:
-		case RC_E_REGISTERTEST:
-		case RC_E_WRONG_ENCODING:
-		case RC_E_INTERRUPTED_FU:
-		case RC_E_TPM_FIRMWARE_UPDATE:
-		case RC_E_INVALID_FW_OPTION:
-		case RC_E_WRONG_FW_IMAGE:
-		case RC_E_INVALID_LOG_OPTION:
-		case RC_E_NO_IFX_TPM:
-		case RC_E_PLATFORM_AUTH_NOT_EMPTY:
-		case RC_E_PLATFORM_HIERARCHY_DISABLED:
-		case RC_E_FW_UPDATE_BLOCKED:
-		case RC_E_FIRMWARE_UPDATE_FAILED:
-		case RC_E_TPM12_OWNED:
-		case RC_E_TPM12_PP_LOCKED:
-		case RC_E_TPM12_NO_OWNER:
-		case RC_E_TPM12_INVALID_OWNERAUTH:
-		case RC_E_INVALID_UPDATE_OPTION:
-		case RC_E_RESTART_REQUIRED:
-		case RC_E_TPM12_DEFERREDPP_REQUIRED:
-		case RC_E_TPM12_DISABLED_DEACTIVATED:
-		case RC_E_TPM12_DA_ACTIVE:
-		case RC_E_NEWER_TOOL_REQUIRED:
-		case RC_E_UNSUPPORTED_CHIP:
-		case RC_E_CORRUPT_FW_IMAGE:
-		case RC_E_WRONG_DECRYPT_KEYS:
-		case RC_E_NOT_SUPPORTED_FEATURE:
-		case RC_E_DEVICE_ALREADY_IN_USE:
-		case RC_E_TPM_ACCESS_DENIED:
-		case RC_E_INVALID_ACCESS_MODE:
-		case RC_E_INVALID_SETTING:
-		case RC_E_TPM_NOT_SUPPORTED_FEATURE:
-		case RC_E_TPM20_FAILURE_MODE:
-		case RC_E_INVALID_CONFIG_OPTION:
-		case RC_E_FIRMWARE_UPDATE_NOT_FOUND:
-		case RC_E_RESUME_RUNDATA_NOT_FOUND:
-		case RC_E_TPM12_FAILED_SELFTEST:
-			unReturnValue = PunErrorCode;
+		wchar_t wcCharacter = NULL != PwszString ? PwszString[unIndex] : (wchar_t)(unsigned char)PszString[unIndex];
+		if (L'\0' == wcCharacter)
 			break;
+		PpErrorData->wszText[PpErrorData->unTextUsed++] = wcCharacter;
+	}
+	PpErrorData->wszText[PpErrorData->unTextUsed++] = L'\0';
 
-		// Error codes mapped to RC_E_INTERNAL
-		case RC_E_NOT_INITIALIZED:
-		case RC_E_NOT_CONNECTED:
-		case RC_E_ALREADY_CONNECTED:
-		case RC_E_BAD_PARAMETER:
-		case RC_E_BUFFER_TOO_SMALL:
-		case RC_E_END_OF_FILE:
-		case RC_E_FILE_NOT_FOUND:
-		case RC_E_ACCESS_DENIED:
-		case RC_E_FILE_EXISTS:
-		case RC_E_END_OF_STRING:
-			unReturnValue = RC_E_INTERNAL;
-			break;
+	return unOffset;
+}
 
-		// Error codes mapped to RC_E_NO_TPM
-		case RC_E_COMPONENT_NOT_FOUND:
-		case RC_E_LOCALITY_NOT_ACTIVE:
-		case RC_E_LOCALITY_NOT_SUPPORTED:
-		case RC_E_TPM_NO_DATA_AVAILABLE:
-		case RC_E_INSUFFICIENT_BUFFER:
-		case RC_E_TPM_RECEIVE_DATA:
-		case RC_E_TPM_TRANSMIT_DATA:
-		case RC_E_NOT_READY:
-			unReturnValue = RC_E_NO_TPM;
-			break;
+/**
+ *	@brief		Captures all parameters of an error to an IfxErrorData structure
+ *	@details	The format string and string arguments are copied, all other arguments are stored by value.
+ *				Arguments following an unsupported conversion specification or exceeding ERROR_MAX_ARGUMENTS
+ *				are not captured; Error_FormatMessage takes such conversion specifications literally.
+ *
+ *	@param		PpErrorData					Pointer to the structure
+ *	@param		PszOccurredInModule			Pointer to a char array holding the module name where the error occurred
+ *	@param		PszOccurredInFunction		Pointer to a char array holding the function name where the error occurred
+ *	@param		PnOccurredInLine			The line where the error occurred
+ *	@param		PunInternalErrorCode		Internal error code
+ *	@param		PwszInternalErrorMessage	Format string used to format the internal error message
+ *	@param		PvaArgumentList				Parameters needed to format the error message
+ */
+void
+Error_CaptureErrorData(
+	_Inout_		IfxErrorData*	PpErrorData,
+	_In_z_		const char*		PszOccurredInModule,
+	_In_z_		const char*		PszOccurredInFunction,
+	_In_		int				PnOccurredInLine,
+	_In_		unsigned int	PunInternalErrorCode,
+	_In_opt_	const wchar_t*	PwszInternalErrorMessage,
+	_In_		va_list			PvaArgumentList)
+{
+	unsigned int unIndex = 0;
 
-		// Error codes mapped to RC_E_TPM_FIRMWARE_UPDATE
-		case RC_E_TPM20_INVALID_POLICY_SESSION:
-		case RC_E_TPM20_POLICY_HANDLE_OUT_OF_RANGE:
-		case RC_E_TPM20_POLICY_SESSION_NOT_LOADED:
-		case RC_E_TPM12_MISSING_OWNERAUTH:
-		case RC_E_TPM_NO_BOOT_LOADER_MODE:
-			unReturnValue = RC_E_TPM_FIRMWARE_UPDATE;
-			break;
+	PpErrorData->unInternalErrorCode = PunInternalErrorCode;
+	PpErrorData->szOccurredInModule = PszOccurredInModule;
+	PpErrorData->szOccurredInFunction = PszOccurredInFunction;
+	PpErrorData->nOccurredInLine = PnOccurredInLine;
+	PpErrorData->unArgumentCount = 0;
+	PpErrorData->unTextUsed = 0;
+	PpErrorData->pPreviousError = NULL;
+
+	// Store the format of the internal error message at offset zero
+	IGNORE_RETURN_VALUE(Error_AppendText(PpErrorData, NULL != PwszInternalErrorMessage ? PwszInternalErrorMessage : L"", NULL));
 
-		// All not handled codes are mapped to RC_E_FAIL
-		default:
-			// Check if it is a TPM error code
-			if ((PunErrorCode & 0xFFFF0000) == RC_TPM_MASK)
-				unReturnValue = RC_E_TPM_GENERAL;
-			else
-				unReturnValue = RC_E_FAIL;
+	// Store the arguments of the conversion specifications of the (possibly truncated) format copy
+	for (unIndex = 0; L'\0' != PpErrorData->wszText[unIndex]; unIndex++)
+	{
+		IfxErrorConversion sConversion;
+		IfxErrorArgument* pArgument = NULL;
+		unsigned int unStar = 0;
+
+		if (L'%' != PpErrorData->wszText[unIndex])
+			continue;
+		if (!Error_ParseConversion(&PpErrorData->wszText[unIndex], &sConversion))
 			break;
+		unIndex += sConversion.unLength - 1;
+		if (ERROR_ARGUMENT_NONE == sConversion.unType)
+			continue;
+		if (PpErrorData->unArgumentCount + sConversion.unStarCount + 1 > ERROR_MAX_ARGUMENTS)
+			break;
+
+		for (unStar = 0; unStar < sConversion.unStarCount; unStar++)
+			PpErrorData->rgArguments[PpErrorData->unArgumentCount++].ullValue = (unsigned long long)(long long)va_arg(PvaArgumentList, int);
+
+		pArgument = &PpErrorData->rgArguments[PpErrorData->unArgumentCount++];
+		switch (sConversion.unType)
+		{
+			case ERROR_ARGUMENT_INT:
+				pArgument->ullValue = (unsigned long long)va_arg(PvaArgumentList, unsigned int);
+				break;
+			case ERROR_ARGUMENT_LONG:
+				pArgument->ullValue = (unsigned long long)va_arg(PvaArgumentList, unsigned long);
+				break;
+			case ERROR_ARGUMENT_LONGLONG:
+				pArgument->ullValue = va_arg(PvaArgumentList, unsigned long long);
+				break;
+			case ERROR_ARGUMENT_SIZE:
+				pArgument->ullValue = (unsigned long long)va_arg(PvaArgumentList, size_t);
+				break;
+			case ERROR_ARGUMENT_INTMAX:
+				pArgument->ullValue = (unsigned long long)va_arg(PvaArgumentList, uintmax_t);
+				break;
+			case ERROR_ARGUMENT_PTRDIFF:
+				pArgument->ullValue = (unsigned long long)va_arg(PvaArgumentList, ptrdiff_t);
+				break;
+			case ERROR_ARGUMENT_DOUBLE:
+				pArgument->dValue = va_arg(PvaArgumentList, double);
+				break;
+			case ERROR_ARGUMENT_POINTER:
+				pArgument->ullValue = (unsigned long long)(uintptr_t)va_arg(PvaArgumentList, void*);
+				break;
+			case ERROR_ARGUMENT_WIDE_STRING:
+			{
+				const wchar_t* pwszString = va_arg(PvaArgumentList, const wchar_t*);
+				pArgument->ullValue = Error_AppendText(PpErrorData, NULL != pwszString ? pwszString : L"(null)", NULL);
+				break;
+			}
+			case ERROR_ARGUMENT_ANSI_STRING:
+			{
+				const char* pszString = va_arg(PvaArgumentList, const char*);
+				pArgument->ullValue = Error_AppendText(PpErrorData, NULL, NULL != pszString ? pszString : "(null)");
+				break;
+			}
+			default:
+				break;
+		}
 	}
+}
+
+/// Maps an error code to its final error code in s_rgusFinalCodes
+#define ERROR_FINAL_CODE(CODE, FINAL_CODE)	[MESSAGECATALOG_APP_CODE_INDEX(CODE)] = (unsigned short)((FINAL_CODE) - RC_APP_MASK)
+
+/// Final error codes (offset to RC_APP_MASK) with MESSAGECATALOG_APP_CODE_INDEX() of the error code as index, 0 for not handled codes
+static const unsigned short s_rgusFinalCodes[MESSAGECATALOG_APP_CODE_COUNT] =
+{
+	// Error codes as they are
+	ERROR_FINAL_CODE(RC_E_FAIL, RC_E_FAIL),
+	ERROR_FINAL_CODE(RC_E_BAD_COMMANDLINE, RC_E_BAD_COMMANDLINE),
+	ERROR_FINAL_CODE(RC_E_TPM_GENERAL, RC_E_TPM_GENERAL),
+	ERROR_FINAL_CODE(RC_E_INTERNAL, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_NO_TPM, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_NO_IFXTPM20, RC_E_NO_IFXTPM20),
+	ERROR_FINAL_CODE(RC_E_FLAGCHECK, RC_E_FLAGCHECK),
+	ERROR_FINAL_CODE(RC_E_EKCHECK, RC_E_EKCHECK),
+	ERROR_FINAL_CODE(RC_E_HASHCHECK, RC_E_HASHCHECK),
+	ERROR_FINAL_CODE(RC_E_REGISTERTEST, RC_E_REGISTERTEST),
+	ERROR_FINAL_CODE(RC_E_WRONG_ENCODING, RC_E_WRONG_ENCODING),
+	ERROR_FINAL_CODE(RC_E_INTERRUPTED_FU, RC_E_INTERRUPTED_FU),
+	ERROR_FINAL_CODE(RC_E_TPM_FIRMWARE_UPDATE, RC_E_TPM_FIRMWARE_UPDATE),
+	ERROR_FINAL_CODE(RC_E_INVALID_FW_OPTION, RC_E_INVALID_FW_OPTION),
+	ERROR_FINAL_CODE(RC_E_WRONG_FW_IMAGE, RC_E_WRONG_FW_IMAGE),
+	ERROR_FINAL_CODE(RC_E_INVALID_LOG_OPTION, RC_E_INVALID_LOG_OPTION),
+	ERROR_FINAL_CODE(RC_E_NO_IFX_TPM, RC_E_NO_IFX_TPM),
+	ERROR_FINAL_CODE(RC_E_PLATFORM_AUTH_NOT_EMPTY, RC_E_PLATFORM_AUTH_NOT_EMPTY),
+	ERROR_FINAL_CODE(RC_E_PLATFORM_HIERARCHY_DISABLED, RC_E_PLATFORM_HIERARCHY_DISABLED),
+	ERROR_FINAL_CODE(RC_E_FW_UPDATE_BLOCKED, RC_E_FW_UPDATE_BLOCKED),
+	ERROR_FINAL_CODE(RC_E_FIRMWARE_UPDATE_FAILED, RC_E_FIRMWARE_UPDATE_FAILED),
+	ERROR_FINAL_CODE(RC_E_TPM12_OWNED, RC_E_TPM12_OWNED),
+	ERROR_FINAL_CODE(RC_E_TPM12_PP_LOCKED, RC_E_TPM12_PP_LOCKED),
+	ERROR_FINAL_CODE(RC_E_TPM12_NO_OWNER, RC_E_TPM12_NO_OWNER),
+	ERROR_FINAL_CODE(RC_E_TPM12_INVALID_OWNERAUTH, RC_E_TPM12_INVALID_OWNERAUTH),
+	ERROR_FINAL_CODE(RC_E_INVALID_UPDATE_OPTION, RC_E_INVALID_UPDATE_OPTION),
+	ERROR_FINAL_CODE(RC_E_RESTART_REQUIRED, RC_E_RESTART_REQUIRED),
+	ERROR_FINAL_CODE(RC_E_TPM12_DEFERREDPP_REQUIRED, RC_E_TPM12_DEFERREDPP_REQUIRED),
+	ERROR_FINAL_CODE(RC_E_TPM12_DISABLED_DEACTIVATED, RC_E_TPM12_DISABLED_DEACTIVATED),
+	ERROR_FINAL_CODE(RC_E_TPM12_DA_ACTIVE, RC_E_TPM12_DA_ACTIVE),
+	ERROR_FINAL_CODE(RC_E_NEWER_TOOL_REQUIRED, RC_E_NEWER_TOOL_REQUIRED),
+	ERROR_FINAL_CODE(RC_E_UNSUPPORTED_CHIP, RC_E_UNSUPPORTED_CHIP),
+	ERROR_FINAL_CODE(RC_E_CORRUPT_FW_IMAGE, RC_E_CORRUPT_FW_IMAGE),
+	ERROR_FINAL_CODE(RC_E_WRONG_DECRYPT_KEYS, RC_E_WRONG_DECRYPT_KEYS),
+	ERROR_FINAL_CODE(RC_E_NOT_SUPPORTED_FEATURE, RC_E_NOT_SUPPORTED_FEATURE),
+	ERROR_FINAL_CODE(RC_E_DEVICE_ALREADY_IN_USE, RC_E_DEVICE_ALREADY_IN_USE),
+	ERROR_FINAL_CODE(RC_E_TPM_ACCESS_DENIED, RC_E_TPM_ACCESS_DENIED),
+	ERROR_FINAL_CODE(RC_E_INVALID_ACCESS_MODE, RC_E_INVALID_ACCESS_MODE),
+	ERROR_FINAL_CODE(RC_E_INVALID_SETTING, RC_E_INVALID_SETTING),
+	ERROR_FINAL_CODE(RC_E_TPM_NOT_SUPPORTED_FEATURE, RC_E_TPM_NOT_SUPPORTED_FEATURE),
+	ERROR_FINAL_CODE(RC_E_TPM20_FAILURE_MODE, RC_E_TPM20_FAILURE_MODE),
+	ERROR_FINAL_CODE(RC_E_INVALID_CONFIG_OPTION, RC_E_INVALID_CONFIG_OPTION),
+	ERROR_FINAL_CODE(RC_E_FIRMWARE_UPDATE_NOT_FOUND, RC_E_FIRMWARE_UPDATE_NOT_FOUND),
+	ERROR_FINAL_CODE(RC_E_RESUME_RUNDATA_NOT_FOUND, RC_E_RESUME_RUNDATA_NOT_FOUND),
+	ERROR_FINAL_CODE(RC_E_TPM12_FAILED_SELFTEST, RC_E_TPM12_FAILED_SELFTEST),
+	ERROR_FINAL_CODE(RC_E_DEVICE_FAILED, RC_E_DEVICE_FAILED),
+	ERROR_FINAL_CODE(RC_E_UPDATE_PLAN_MISMATCH, RC_E_UPDATE_PLAN_MISMATCH),
+	ERROR_FINAL_CODE(RC_E_UPDATE_DEADLINE, RC_E_UPDATE_DEADLINE),
+	ERROR_FINAL_CODE(RC_E_SERVICE_BUSY, RC_E_SERVICE_BUSY),
+	ERROR_FINAL_CODE(RC_E_INVALID_FRAME_FILE, RC_E_INVALID_FRAME_FILE),
+	// Error codes mapped to RC_E_INTERNAL
+	ERROR_FINAL_CODE(RC_E_NOT_INITIALIZED, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_NOT_CONNECTED, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_ALREADY_CONNECTED, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_BAD_PARAMETER, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_BUFFER_TOO_SMALL, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_END_OF_FILE, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_FILE_NOT_FOUND, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_ACCESS_DENIED, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_FILE_EXISTS, RC_E_INTERNAL),
+	ERROR_FINAL_CODE(RC_E_END_OF_STRING, RC_E_INTERNAL),
+	// Error codes mapped to RC_E_NO_TPM
+	ERROR_FINAL_CODE(RC_E_COMPONENT_NOT_FOUND, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_LOCALITY_NOT_ACTIVE, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_LOCALITY_NOT_SUPPORTED, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_TPM_NO_DATA_AVAILABLE, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_INSUFFICIENT_BUFFER, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_TPM_RECEIVE_DATA, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_TPM_TRANSMIT_DATA, RC_E_NO_TPM),
+	ERROR_FINAL_CODE(RC_E_NOT_READY, RC_E_NO_TPM),
+	// Error codes mapped to RC_E_TPM_FIRMWARE_UPDATE
+	ERROR_FINAL_CODE(RC_E_TPM20_INVALID_POLICY_SESSION, RC_E_TPM_FIRMWARE_UPDATE),
+	ERROR_FINAL_CODE(RC_E_TPM20_POLICY_HANDLE_OUT_OF_RANGE, RC_E_TPM_FIRMWARE_UPDATE),
+	ERROR_FINAL_CODE(RC_E_TPM20_POLICY_SESSION_NOT_LOADED, RC_E_TPM_FIRMWARE_UPDATE),
+	ERROR_FINAL_CODE(RC_E_TPM12_MISSING_OWNERAUTH, RC_E_TPM_FIRMWARE_UPDATE),
+	ERROR_FINAL_CODE(RC_E_TPM_NO_BOOT_LOADER_MODE, RC_E_TPM_FIRMWARE_UPDATE)
+};
+
+/**
+ *	@brief		Maps the ErrorCode to the final one
+ *	@details	This function maps the internal error code to the final one displayed to the end user.
+ *
+ *	@returns	The mapped final error code
+ */
+_Check_return_
+unsigned int
+Error_MapToFinalCode(
+	_In_ unsigned int PunErrorCode)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	// Direct lookup of the final error code
+	if (MESSAGECATALOG_IS_APP_CODE(PunErrorCode) && 0 != s_rgusFinalCodes[MESSAGECATALOG_APP_CODE_INDEX(PunErrorCode)])
+		unReturnValue = RC_APP_MASK + s_rgusFinalCodes[MESSAGECATALOG_APP_CODE_INDEX(PunErrorCode)];
+	// All not handled codes are mapped to RC_E_FAIL, check if it is a TPM error code
+	else if ((PunErrorCode & 0xFFFF0000) == RC_TPM_MASK)
+		unReturnValue = RC_E_TPM_GENERAL;
+	else
+		unReturnValue = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
@@ -191,6 +511,8 @@ Error_MapFinalCodeToMessage(
 
 	do
 	{
+		unsigned int unBufferSize = 0;
+
 		// Check out parameter
 		if (NULL == PwszErrorMessage)
 		{
@@ -209,143 +531,15 @@ Error_MapFinalCodeToMessage(
 			break;
 		}
 
-		switch (PunErrorCode)
+		// Direct lookup of the message, all not handled codes get the RC_E_FAIL message
+		unBufferSize = *PpunBufferSize;
+		unReturnValue = RC_E_NOT_FOUND;
+		if (MESSAGECATALOG_IS_APP_CODE(PunErrorCode))
+			unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_APP_ERRORS, MESSAGECATALOG_APP_CODE_INDEX(PunErrorCode), PwszErrorMessage, PpunBufferSize);
+		if (RC_E_NOT_FOUND == unReturnValue)
 		{
-			case RC_E_BAD_COMMANDLINE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_BAD_COMMANDLINE);
-				break;
-			case RC_E_TPM_GENERAL:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM_GENERAL);
-				break;
-			case RC_E_INTERNAL:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INTERNAL);
-				break;
-			case RC_E_NO_TPM:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_NO_TPM);
-				break;
-			case RC_E_NO_IFXTPM20:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_NO_IFXTPM20);
-				break;
-			case RC_E_FLAGCHECK:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_FLAGCHECK);
-				break;
-			case RC_E_EKCHECK:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_EKCHECK);
-				break;
-			case RC_E_HASHCHECK:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_HASHCHECK);
-				break;
-			case RC_E_REGISTERTEST:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_REGISTERTEST);
-				break;
-			case RC_E_WRONG_ENCODING:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_WRONG_ENCODING);
-				break;
-			case RC_E_INTERRUPTED_FU:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INTERRUPTED_FU);
-				break;
-			case RC_E_TPM_FIRMWARE_UPDATE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM_FIRMWARE_UPDATE);
-				break;
-			case RC_E_INVALID_FW_OPTION:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INVALID_FW_OPTION);
-				break;
-			case RC_E_WRONG_FW_IMAGE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_WRONG_FW_IMAGE);
-				break;
-			case RC_E_INVALID_LOG_OPTION:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INVALID_LOG_OPTION);
-				break;
-			case RC_E_NO_IFX_TPM:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_NO_IFX_TPM);
-				break;
-			case RC_E_PLATFORM_AUTH_NOT_EMPTY:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_PLATFORM_AUTH_NOT_EMPTY);
-				break;
-			case RC_E_PLATFORM_HIERARCHY_DISABLED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_PLATFORM_HIERARCHY_DISABLED);
-				break;
-			case RC_E_FW_UPDATE_BLOCKED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_FW_UPDATE_BLOCKED);
-				break;
-			case RC_E_FIRMWARE_UPDATE_FAILED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_FIRMWARE_UPDATE_FAILED);
-				break;
-			case RC_E_TPM12_OWNED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_OWNED);
-				break;
-			case RC_E_TPM12_NO_OWNER:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_NO_OWNER);
-				break;
-			case RC_E_TPM12_INVALID_OWNERAUTH:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_INVALID_OWNERAUTH);
-				break;
-			case RC_E_TPM12_PP_LOCKED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_PP_LOCKED);
-				break;
-			case RC_E_INVALID_UPDATE_OPTION:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INVALID_UPDATE_OPTION);
-				break;
-			case RC_E_RESTART_REQUIRED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_RESTART_REQUIRED);
-				break;
-			case RC_E_TPM12_DEFERREDPP_REQUIRED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_DEFERREDPP_REQUIRED);
-				break;
-			case RC_E_TPM12_DISABLED_DEACTIVATED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_DISABLED_DEACTIVATED);
-				break;
-			case RC_E_TPM12_DA_ACTIVE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_DA_ACTIVE);
-				break;
-			case RC_E_NEWER_TOOL_REQUIRED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_NEWER_TOOL_REQUIRED);
-				break;
-			case RC_E_UNSUPPORTED_CHIP:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_UNSUPPORTED_CHIP);
-				break;
-			case RC_E_CORRUPT_FW_IMAGE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_CORRUPT_FW_IMAGE);
-				break;
-			case RC_E_WRONG_DECRYPT_KEYS:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_WRONG_DECRYPT_KEYS);
-				break;
-			case RC_E_NOT_SUPPORTED_FEATURE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_NOT_SUPPORTED_FEATURE);
-				break;
-			case RC_E_DEVICE_ALREADY_IN_USE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_DEVICE_ALREADY_IN_USE);
-				break;
-			case RC_E_TPM_ACCESS_DENIED:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM_ACCESS_DENIED);
-				break;
-			case RC_E_INVALID_ACCESS_MODE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INVALID_ACCESS_MODE);
-				break;
-			case RC_E_INVALID_SETTING:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INVALID_SETTING);
-				break;
-			case RC_E_TPM_NOT_SUPPORTED_FEATURE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM_NOT_SUPPORTED_FEATURE);
-				break;
-			case RC_E_TPM20_FAILURE_MODE:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM20_FAILURE_MODE);
-				break;
-			case RC_E_INVALID_CONFIG_OPTION:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_INVALID_CONFIG_OPTION);
-				break;
-			case RC_E_FIRMWARE_UPDATE_NOT_FOUND:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_FIRMWARE_UPDATE_NOT_FOUND);
-				break;
-			case RC_E_RESUME_RUNDATA_NOT_FOUND:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_RESUME_RUNDATA_NOT_FOUND);
-				break;
-			case RC_E_TPM12_FAILED_SELFTEST:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_TPM12_FAILED_SELFTEST);
-				break;
-			default:
-				unReturnValue = Platform_StringCopy(PwszErrorMessage, PpunBufferSize, MSG_RC_E_FAIL);
-				break;
+			*PpunBufferSize = unBufferSize;
+			unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_APP_ERRORS, MESSAGECATALOG_APP_CODE_INDEX(RC_E_FAIL), PwszErrorMessage, PpunBufferSize);
 		}
 	}
 	WHILE_FALSE_END;
@@ -370,7 +564,9 @@ _Check_return_
 IfxErrorData*
 Error_GetStack()
 {
-	return s_pErrorData;
+	IfxSession* pSession = Session_GetCurrent();
+
+	return pSession->pErrorData;
 }
 
 /**
@@ -380,10 +576,12 @@ Error_GetStack()
 void
 Error_ClearStack()
 {
+	IfxSession* pSession = Session_GetCurrent();
+
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
-	Error_ClearStackInternal(s_pErrorData);
-	s_pErrorData = NULL;
+	Error_ClearStackInternal(pSession->pErrorData);
+	pSession->pErrorData = NULL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
 }
@@ -395,6 +593,7 @@ Error_ClearStack()
 void
 Error_ClearFirstItem()
 {
+	IfxSession* pSession = Session_GetCurrent();
 	IfxErrorData* pErrorData = NULL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
@@ -406,10 +605,10 @@ Error_ClearFirstItem()
 	if (NULL != pErrorData)
 	{
 		// Remove first item from the list
-		s_pErrorData = (IfxErrorData*)pErrorData->pPreviousError;
+		pSession->pErrorData = (IfxErrorData*)pErrorData->pPreviousError;
 
-		// Free memory of the first removed item
-		Platform_MemoryFree((void**)&pErrorData);
+		// Release the first removed item
+		Error_ReleaseErrorData(pErrorData);
 	}
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
@@ -425,6 +624,9 @@ Error_ClearFirstItem()
  *	@param		PunInternalErrorCode		Internal error code
  *	@param		PwszInternalErrorMessage	Format string used to format the internal error message
  *	@param		PvaArgumentList				Parameters needed to format the error message
+ *
+ *	@returns	Pointer to a structure taken from the error record pool (or allocated if the pool is exhausted),
+ *				NULL in case of a memory allocation failure
  */
 _Check_return_
 IfxErrorData*
@@ -436,80 +638,33 @@ Error_GetErrorData(
 	_In_z_	const wchar_t*	PwszInternalErrorMessage,
 	_In_	va_list			PvaArgumentList)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	IfxErrorData* pErrorData = NULL;
-	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unIndex = 0;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
-	do
+	// Take a free structure from the pool
+	for (unIndex = 0; unIndex < ERROR_POOL_SIZE; unIndex++)
 	{
-		unsigned int unSize = 0;
-
-		// Allocate new error structure
-		pErrorData = (IfxErrorData*)Platform_MemoryAllocateZero(sizeof(IfxErrorData));
-		if (NULL == pErrorData)
+		if (!pSession->rgErrorPool[unIndex].fInUse)
 		{
-			unReturnValue = RC_E_FAIL;
+			pErrorData = &pSession->rgErrorPool[unIndex];
+			pErrorData->fPooled = TRUE;
 			break;
 		}
-
-		// Store Internal error code
-		pErrorData->unInternalErrorCode = PunInternalErrorCode;
-
-		// Store Line number
-		pErrorData->nOccurredInLine = PnOccurredInLine;
-
-		// Store Internal error message
-		if (!PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszInternalErrorMessage))
-		{
-			unSize = RG_LEN(pErrorData->wszInternalErrorMessage);
-			unReturnValue = Platform_StringFormatV(pErrorData->wszInternalErrorMessage, &unSize, PwszInternalErrorMessage, PvaArgumentList);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
-
-		{
-			wchar_t wszOccurredInModule[256] = {0};
-			wchar_t wszOccurredInFunction[256] = {0};
-			if (RC_E_BUFFER_TOO_SMALL == Platform_AnsiString2UnicodeString(wszOccurredInModule, RG_LEN(wszOccurredInModule), PszOccurredInModule))
-			{
-				unReturnValue = RC_E_BUFFER_TOO_SMALL;
-				break;
-			}
-
-			// Store Internal error message
-			if (!PLATFORM_STRING_IS_NULL_OR_EMPTY(wszOccurredInModule))
-			{
-				// Store Module name
-				unSize = RG_LEN(pErrorData->wszOccurredInModule);
-				unReturnValue = Platform_StringCopy(pErrorData->wszOccurredInModule, &unSize, wszOccurredInModule);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-
-			if (RC_E_BUFFER_TOO_SMALL == Platform_AnsiString2UnicodeString(wszOccurredInFunction, RG_LEN(wszOccurredInFunction), PszOccurredInFunction))
-			{
-				unReturnValue = RC_E_BUFFER_TOO_SMALL;
-				break;
-			}
-
-			// Store Function name
-			if (!PLATFORM_STRING_IS_NULL_OR_EMPTY(wszOccurredInFunction))
-			{
-				unSize = RG_LEN(pErrorData->wszOccurredInFunction);
-				unReturnValue = Platform_StringCopy(pErrorData->wszOccurredInFunction, &unSize, wszOccurredInFunction);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
 	}
-	WHILE_FALSE_END;
 
-	if (RC_SUCCESS != unReturnValue)
+	// Allocate new error structure if the pool is exhausted
+	if (NULL == pErrorData)
+		pErrorData = (IfxErrorData*)Platform_MemoryAllocateZero(sizeof(IfxErrorData));
+
+	if (NULL != pErrorData)
 	{
-		ERROR_STORE_FMT(unReturnValue, L"Unexpected error while storing an error. (0x%.8X)", PunInternalErrorCode);
-		// Free allocated memory
-		Platform_MemoryFree((void**)&pErrorData);
+		pErrorData->fInUse = TRUE;
+		Error_CaptureErrorData(
+			pErrorData, PszOccurredInModule, PszOccurredInFunction, PnOccurredInLine,
+			PunInternalErrorCode, PwszInternalErrorMessage, PvaArgumentList);
 	}
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
@@ -538,11 +693,16 @@ Error_Store(
 	_In_z_	const wchar_t*	PwszInternalErrorMessage,
 	...)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	IfxErrorData* pErrorData = NULL;
 	va_list vaArgumentList;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
+	if (FLIGHTRECORDER_IS_ENABLED())
+		FlightRecorder_Record(FLIGHTRECORDER_RECORD_ERROR, PunInternalErrorCode, (unsigned int)PnOccurredInLine, 0, 0,
+			PszOccurredInFunction, (unsigned int)strlen(PszOccurredInFunction));
+
 	va_start(vaArgumentList, PwszInternalErrorMessage);
 	pErrorData = Error_GetErrorData(
 					 PszOccurredInModule, PszOccurredInFunction, PnOccurredInLine,
@@ -552,9 +712,9 @@ Error_Store(
 	// Put the error in front of the list
 	if (pErrorData != NULL)
 	{
-		if (NULL != s_pErrorData)
-			pErrorData->pPreviousError = s_pErrorData;
-		s_pErrorData = pErrorData;
+		if (NULL != pSession->pErrorData)
+			pErrorData->pPreviousError = pSession->pErrorData;
+		pSession->pErrorData = pErrorData;
 	}
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
@@ -592,14 +752,15 @@ _Check_return_
 unsigned int
 Error_GetFinalCode()
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unFinalErrorCode = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
-	if (NULL == s_pErrorData)
+	if (NULL == pSession->pErrorData)
 		unFinalErrorCode = RC_SUCCESS;
 	else
-		unFinalErrorCode = Error_GetFinalCodeFromError(s_pErrorData->unInternalErrorCode);
+		unFinalErrorCode = Error_GetFinalCodeFromError(pSession->pErrorData->unInternalErrorCode);
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
 
@@ -687,6 +848,7 @@ Error_GetFinalMessage(
 	_Out_z_cap_(*PpunBufferSize)	wchar_t*		PwszErrorMessage,
 	_Inout_							unsigned int*	PpunBufferSize)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
@@ -712,7 +874,7 @@ Error_GetFinalMessage(
 		}
 
 		// Check if an error is stored
-		if (NULL == s_pErrorData)
+		if (NULL == pSession->pErrorData)
 		{
 			*PpunBufferSize = 0;
 			PwszErrorMessage[0] = L'\0';
@@ -721,7 +883,7 @@ Error_GetFinalMessage(
 		}
 
 		// Get final error message to final error code
-		unReturnValue = Error_GetFinalMessageFromErrorCode(s_pErrorData->unInternalErrorCode, PwszErrorMessage, PpunBufferSize);
+		unReturnValue = Error_GetFinalMessageFromErrorCode(pSession->pErrorData->unInternalErrorCode, PwszErrorMessage, PpunBufferSize);
 		if (RC_SUCCESS != unReturnValue)
 		{
 			*PpunBufferSize = 0;
@@ -748,14 +910,15 @@ _Check_return_
 unsigned int
 Error_GetInternalCode()
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unInternalErrorCode = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
-	if (NULL == s_pErrorData)
+	if (NULL == pSession->pErrorData)
 		unInternalErrorCode = RC_SUCCESS;
 	else
-		unInternalErrorCode = s_pErrorData->unInternalErrorCode;
+		unInternalErrorCode = pSession->pErrorData->unInternalErrorCode;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
 
@@ -769,9 +932,11 @@ Error_GetInternalCode()
 void
 Error_LogStack()
 {
+	IfxSession* pSession = Session_GetCurrent();
+
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
-	Error_LogErrorData(s_pErrorData);
+	Error_LogErrorData(pSession->pErrorData);
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
 }
@@ -796,35 +961,199 @@ Error_LogCodeAndMessage(
 	_In_z_	const wchar_t*	PwszInternalErrorMessage,
 	...)
 {
+	IfxErrorData sErrorData;
 	va_list vaArgumentList;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
+	// The error is only logged, so it is captured on the stack
 	va_start(vaArgumentList, PwszInternalErrorMessage);
-	Error_LogErrorData(Error_GetErrorData(
-						   PszOccurredInModule, PszOccurredInFunction, PnOccurredInLine,
-						   PunInternalErrorCode, PwszInternalErrorMessage, vaArgumentList));
+	Error_CaptureErrorData(
+		&sErrorData, PszOccurredInModule, PszOccurredInFunction, PnOccurredInLine,
+		PunInternalErrorCode, PwszInternalErrorMessage, vaArgumentList);
 	va_end(vaArgumentList);
+	Error_LogErrorData(&sErrorData);
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
 }
 
+/**
+ *	@brief		Format the internal error message of an IfxErrorData
+ *	@details	This function formats the captured format string and arguments of an error. A message which does
+ *				not fit into the buffer is truncated.
+ *
+ *	@param		PpErrorData			Pointer to the error
+ *	@param		PwszMessage			Pointer to a char buffer to format the message to
+ *	@param		PpunMessageSize		In: Size of the message buffer in elements\n
+ *									Out: Length of the message without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The message has been truncated.
+ */
+_Check_return_
+unsigned int
+Error_FormatMessage(
+	_In_							const IfxErrorData*	PpErrorData,
+	_Out_z_cap_(*PpunMessageSize)	wchar_t*			PwszMessage,
+	_Inout_							unsigned int*		PpunMessageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		const wchar_t* pwszFormat = NULL;
+		unsigned int unCapacity = 0;
+		unsigned int unUsed = 0;
+		unsigned int unArgument = 0;
+		unsigned int unIndex = 0;
+
+		// Check parameters
+		if (NULL == PpErrorData || NULL == PwszMessage || NULL == PpunMessageSize || 0 == *PpunMessageSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		pwszFormat = PpErrorData->wszText;
+		unCapacity = *PpunMessageSize;
+		unReturnValue = RC_SUCCESS;
+
+		while (L'\0' != pwszFormat[unIndex] && RC_SUCCESS == unReturnValue)
+		{
+			IfxErrorConversion sConversion;
+			wchar_t wszSpecification[64] = {0};
+			unsigned int unSpecificationLength = 0;
+			unsigned int unSize = 0;
+			unsigned int unPosition = 0;
+			const IfxErrorArgument* pArgument = NULL;
+
+			// Copy characters outside of conversion specifications and those which have not been captured
+			if (L'%' != pwszFormat[unIndex] ||
+					!Error_ParseConversion(&pwszFormat[unIndex], &sConversion) ||
+					sConversion.unLength > 24 ||
+					(ERROR_ARGUMENT_NONE != sConversion.unType && unArgument + sConversion.unStarCount + 1 > PpErrorData->unArgumentCount))
+			{
+				if (unUsed + 1 >= unCapacity)
+				{
+					unReturnValue = RC_E_BUFFER_TOO_SMALL;
+					break;
+				}
+				PwszMessage[unUsed++] = pwszFormat[unIndex++];
+				continue;
+			}
+
+			// Write '%%' as is
+			if (ERROR_ARGUMENT_NONE == sConversion.unType)
+			{
+				if (unUsed + 1 >= unCapacity)
+				{
+					unReturnValue = RC_E_BUFFER_TOO_SMALL;
+					break;
+				}
+				PwszMessage[unUsed++] = L'%';
+				unIndex += sConversion.unLength;
+				continue;
+			}
+
+			// Build the conversion specification with the captured '*' arguments inserted
+			for (unPosition = 0; unPosition < sConversion.unLength; unPosition++)
+			{
+				if (L'*' == pwszFormat[unIndex + unPosition])
+				{
+					int nValue = (int)(long long)PpErrorData->rgArguments[unArgument++].ullValue;
+
+					// A negative precision is taken as if the precision were omitted
+					if (nValue < 0 && L'.' == wszSpecification[unSpecificationLength - 1])
+					{
+						unSpecificationLength--;
+						continue;
+					}
+					unSize = RG_LEN(wszSpecification) - unSpecificationLength;
+					if (RC_SUCCESS != Platform_StringFormat(&wszSpecification[unSpecificationLength], &unSize, L"%d", nValue))
+						unSize = 0;
+					unSpecificationLength += unSize;
+					continue;
+				}
+				wszSpecification[unSpecificationLength++] = pwszFormat[unIndex + unPosition];
+			}
+
+			// String arguments have been stored as wide strings
+			if (ERROR_ARGUMENT_ANSI_STRING == sConversion.unType)
+			{
+				wszSpecification[unSpecificationLength - 1] = L'l';
+				wszSpecification[unSpecificationLength++] = L's';
+			}
+			wszSpecification[unSpecificationLength] = L'\0';
+
+			pArgument = &PpErrorData->rgArguments[unArgument++];
+			unSize = unCapacity - unUsed;
+			switch (sConversion.unType)
+			{
+				case ERROR_ARGUMENT_INT:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, (unsigned int)pArgument->ullValue);
+					break;
+				case ERROR_ARGUMENT_LONG:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, (unsigned long)pArgument->ullValue);
+					break;
+				case ERROR_ARGUMENT_LONGLONG:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, pArgument->ullValue);
+					break;
+				case ERROR_ARGUMENT_SIZE:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, (size_t)pArgument->ullValue);
+					break;
+				case ERROR_ARGUMENT_INTMAX:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, (uintmax_t)pArgument->ullValue);
+					break;
+				case ERROR_ARGUMENT_PTRDIFF:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, (ptrdiff_t)pArgument->ullValue);
+					break;
+				case ERROR_ARGUMENT_DOUBLE:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, pArgument->dValue);
+					break;
+				case ERROR_ARGUMENT_POINTER:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, (void*)(uintptr_t)pArgument->ullValue);
+					break;
+				default:
+					unReturnValue = Platform_StringFormat(&PwszMessage[unUsed], &unSize, wszSpecification, &PpErrorData->wszText[pArgument->ullValue]);
+					break;
+			}
+
+			// Platform_StringFormat reports an empty result (e.g. of an empty string argument) as internal error
+			if (RC_E_INTERNAL == unReturnValue)
+				unReturnValue = RC_SUCCESS;
+			else if (RC_SUCCESS == unReturnValue)
+				unUsed += unSize;
+			unIndex += sConversion.unLength;
+		}
+
+		PwszMessage[unUsed] = L'\0';
+		*PpunMessageSize = unUsed;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Log IfxErrorData and linked IfxErrorData
- *	@details	This function logs an IfxErrorData object and all linked IfxErrorData objects.
+ *	@details	This function logs an IfxErrorData object and all linked IfxErrorData objects. The messages are
+ *				formatted in the scratch area of the session.
  */
 void
 Error_LogErrorData(
 	_In_	const IfxErrorData*	PpErrorData)
 {
 	unsigned int	unReturnValue = RC_E_FAIL;
-	wchar_t			wszMessage[MAX_MESSAGE_SIZE] = {0};
-	unsigned int	unMessageSize = RG_LEN(wszMessage);
+	wchar_t*		wszMessage = Session_GetScratch()->wszErrorMessage;
+	unsigned int	unMessageSize = MAX_MESSAGE_SIZE;
+	wchar_t			wszOccurredInModule[MAX_NAME] = {0};
+	wchar_t			wszOccurredInFunction[MAX_NAME] = {0};
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
 	if (PpErrorData != NULL)
 	{
+		wszMessage[0] = L'\0';
 		unReturnValue = Error_GetFinalMessageFromErrorCode(PpErrorData->unInternalErrorCode, wszMessage, &unMessageSize);
 		if (RC_SUCCESS != unReturnValue)
 			LOGGING_WRITE_LEVEL1_FMT(L"Error occurred during Error_GetFinalMessageFromErrorCode. (0x%.8X)", unReturnValue);
@@ -833,9 +1162,16 @@ Error_LogErrorData(
 		LOGGING_WRITE_LEVEL1_FMT(L"Final message: %ls", wszMessage);
 		do
 		{
-			LOGGING_WRITE_LEVEL1_FMT(L"    Module: %ls; Function: %ls; Line: %d", PpErrorData->wszOccurredInModule, PpErrorData->wszOccurredInFunction, PpErrorData->nOccurredInLine);
+			// Names which cannot be converted are logged empty
+			if (RC_SUCCESS != Platform_AnsiString2UnicodeString(wszOccurredInModule, RG_LEN(wszOccurredInModule), PpErrorData->szOccurredInModule))
+				wszOccurredInModule[0] = L'\0';
+			if (RC_SUCCESS != Platform_AnsiString2UnicodeString(wszOccurredInFunction, RG_LEN(wszOccurredInFunction), PpErrorData->szOccurredInFunction))
+				wszOccurredInFunction[0] = L'\0';
+			LOGGING_WRITE_LEVEL1_FMT(L"    Module: %ls; Function: %ls; Line: %d", wszOccurredInModule, wszOccurredInFunction, PpErrorData->nOccurredInLine);
 			LOGGING_WRITE_LEVEL1_FMT(L"    Code: 0x%.8X", PpErrorData->unInternalErrorCode);
-			LOGGING_WRITE_LEVEL1_FMT(L"    Message: %ls", PpErrorData->wszInternalErrorMessage);
+			unMessageSize = MAX_MESSAGE_SIZE;
+			IGNORE_RETURN_VALUE(Error_FormatMessage(PpErrorData, wszMessage, &unMessageSize));
+			LOGGING_WRITE_LEVEL1_FMT(L"    Message: %ls", wszMessage);
 			if ((PpErrorData->unInternalErrorCode & 0xFFFF0000) == RC_TPM_MASK)
 			{
 				unReturnValue = Platform_StringSetZero(wszMessage, MAX_MESSAGE_SIZE);
@@ -21,24 +21,55 @@
 extern "C" {
 #endif
 
+/// Number of pre-allocated error records (further records are allocated from the heap)
+#define ERROR_POOL_SIZE			32
+/// Maximum number of captured arguments of an internal error message including '*' widths and precisions
+#define ERROR_MAX_ARGUMENTS		8
+/// Size of the text buffer of an error record holding the message format and the copied string arguments
+#define ERROR_TEXT_SIZE			1024
+
+/**
+ *	@brief		Captured argument of an internal error message
+ *	@details
+ */
+typedef union tdIfxErrorArgument
+{
+	/// Integer or pointer value, offset in IfxErrorData.wszText for a string argument
+	unsigned long long	ullValue;
+	/// Floating point value
+	double				dValue;
+} IfxErrorArgument;
+
 /**
  *	@brief		Error data structure
- *	@details	Structure holding all parameters needed to describe an error occurrence
+ *	@details	Structure holding all parameters needed to describe an error occurrence. The internal error
+ *				message is kept as format string and captured arguments and is only formatted on request
+ *				by Error_FormatMessage, so storing an error which is handled later costs no formatting.
  */
 typedef struct tdIfxErrorData
 {
 	/// The internal error code
-	unsigned int	unInternalErrorCode;
-	/// The internal error message
-	wchar_t			wszInternalErrorMessage[MAX_MESSAGE_SIZE];
-	/// The module where the error occurred
-	wchar_t			wszOccurredInModule[MAX_NAME];
-	/// The function in the module where the error occurred
-	wchar_t			wszOccurredInFunction[MAX_NAME];
+	unsigned int		unInternalErrorCode;
+	/// The module where the error occurred (__FILE__ of the caller)
+	const char*			szOccurredInModule;
+	/// The function in the module where the error occurred (__func__ of the caller)
+	const char*			szOccurredInFunction;
 	/// The code line in the module where the error occurred
-	int				nOccurredInLine;
+	int					nOccurredInLine;
+	/// Arguments of the internal error message
+	IfxErrorArgument	rgArguments[ERROR_MAX_ARGUMENTS];
+	/// Number of captured arguments
+	unsigned int		unArgumentCount;
+	/// Format string of the internal error message followed by the copied string arguments
+	wchar_t				wszText[ERROR_TEXT_SIZE];
+	/// Used elements of wszText
+	unsigned int		unTextUsed;
+	/// Flag if the structure is part of the error record pool
+	BOOL				fPooled;
+	/// Flag if the pooled structure is in use
+	BOOL				fInUse;
 	/// Pointer to the previous error code structure
-	void*			pPreviousError;
+	void*				pPreviousError;
 } IfxErrorData;
 
 /// Macro for storing error code information
@@ -83,6 +114,9 @@ Error_ClearFirstItem();
  *	@param		PunInternalErrorCode		Internal error code
  *	@param		PwszInternalErrorMessage	Format string used to format the internal error message
  *	@param		PvaArgumentList				Parameters needed to format the error message
+ *
+ *	@returns	Pointer to a structure taken from the error record pool (or allocated if the pool is exhausted),
+ *				NULL in case of a memory allocation failure
  */
 _Check_return_
 IfxErrorData*
@@ -207,9 +241,30 @@ Error_LogCodeAndMessage(
 	_In_z_	const wchar_t*	PwszInternalErrorMessage,
 	...);
 
+/**
+ *	@brief		Format the internal error message of an IfxErrorData
+ *	@details	This function formats the captured format string and arguments of an error. A message which does
+ *				not fit into the buffer is truncated.
+ *
+ *	@param		PpErrorData			Pointer to the error
+ *	@param		PwszMessage			Pointer to a char buffer to format the message to
+ *	@param		PpunMessageSize		In: Size of the message buffer in elements\n
+ *									Out: Length of the message without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The message has been truncated.
+ */
+_Check_return_
+unsigned int
+Error_FormatMessage(
+	_In_							const IfxErrorData*	PpErrorData,
+	_Out_z_cap_(*PpunMessageSize)	wchar_t*			PwszMessage,
+	_Inout_							unsigned int*		PpunMessageSize);
+
 /**
  *	@brief		Log IfxErrorData and linked IfxErrorData
- *	@details	This function logs an IfxErrorData object and all linked IfxErrorData objects.
+ *	@details	This function logs an IfxErrorData object and all linked IfxErrorData objects. The messages are
+ *				formatted in the scratch area of the session.
  */
 void
 Error_LogErrorData(
@@ -20,6 +20,30 @@ extern "C" {
 
 #include "StdInclude.h"
 
+/// Maximum size of a buffer decompressed by FileIO_DecompressFileBuffer (64 MiB)
+#define FILEIO_MAX_DECOMPRESSED_SIZE	0x4000000
+
+/// Maximum number of threads inflating the frames of a buffer in FileIO_DecompressFileBuffer
+#define FILEIO_DECOMPRESS_THREADS_MAX	8
+
+/// ID of the gzip extra subfield ('I', 'F') marking a frame of independently compressed gzip members
+#define FILEIO_FRAME_SUBFIELD_ID		0x4946
+
+/// Size of the gzip member header of a frame up to the end of the FILEIO_FRAME_SUBFIELD_ID subfield
+#define FILEIO_FRAME_HEADER_SIZE		20
+
+/// Size of the chunks a file is compressed in by FileIO_CompressFile (64 KiB)
+#define FILEIO_COMPRESS_CHUNK_SIZE		0x10000
+
+/// Maximum length of a string formatted by FileIO_WriteStringvf in characters (4 MiB)
+#define FILEIO_MAX_STRING_SIZE			0x400000
+
+/// Size of the read-ahead buffer of a file stream opened by FileIO_OpenStream (16 KiB)
+#define FILEIO_STREAM_READ_AHEAD_SIZE	0x4000
+
+/// Interval in which FileIO_WaitSharedMemory checks whether the creator has released a shared memory object (ms)
+#define FILEIO_SHARED_MEMORY_POLL_INTERVAL	20
+
 /**
  *	@brief		Open a file
  *	@details	Opens a file with the given name and access rights and returns the handle to it in *PppvFileHandle.
@@ -54,9 +78,25 @@ _Check_return_
 unsigned int
 FileIO_Close(
 	_Inout_ void** PppvFileHandle);
+
+/**
+ *	@brief		Flush a file
+ *	@details	Writes any data buffered in user space for the given file handle to the file.
+ *
+ *	@param		PpvFileHandle		Handle to an opened file
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpvFileHandle is NULL
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_Flush(
+	_In_ void* PpvFileHandle);
+
 /**
  *	@brief		Reads a line from a text file
- *	@details
+ *	@details	The byte order mark is detected again on every call. Use FileIO_OpenLineReader to read a whole file line
+ *				by line.
  *	@param		PpvFileHandle		Handle to an open file
  *	@param		PwszBuffer			Buffer to the read data
  *	@param		PpunSize			In:	Capacity of the destination buffer in wchar_t elements (include additional space for terminating 0)\n
@@ -112,7 +152,7 @@ FileIO_GetPosition(
  *	@retval		RC_SUCCESS			The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PwszString is NULL
  *	@retval		RC_E_FAIL			An unexpected error occurred.
- *	@retval		...					Error codes from FileIO_WriteStringf
+ *	@retval		...					Error codes from Platform_StringWriteStream
  */
 _Check_return_
 unsigned int
@@ -137,12 +177,15 @@ FileIO_WriteStringf(
 
 /**
  *	@brief		Writes a formatted string using a va_list
- *	@details	Writes a formatted string to the current position in a file, using a va_list
+ *	@details	Writes a formatted string to the current position in a file, using a va_list. The string is formatted
+ *				into a buffer and written in the multibyte encoding of the locale with Platform_StringWriteStream, the
+ *				file stays byte oriented.
  *	@param		PpvFileHandle		Handle to an open file
  *	@param		PwszFormat			Format string to write
  *	@param		PpArguments			One or more values to write
  *	@retval		RC_SUCCESS			The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpvFileHandle or PwszFormat is NULL
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The formatted string exceeds FILEIO_MAX_STRING_SIZE characters.
  *	@retval		RC_E_FAIL			An unexpected error occurred.
  */
 _Check_return_
@@ -169,7 +212,7 @@ FileIO_EOF(
 
 /**
  *	@brief		Checks if file exists
- *	@details
+ *	@details	For an https:// URL the server is asked with a HEAD request.
  *
  *	@param		PwszFileName	File name
  *	@retval		TRUE			If file exists
@@ -180,6 +223,82 @@ BOOL
 FileIO_Exists(
 	_In_z_ const wchar_t* PwszFileName);
 
+/**
+ *	@brief		Checks if a path is a directory
+ *	@details
+ *
+ *	@param		PwszPath		Path
+ *	@retval		TRUE			If the path is an existing directory
+ *	@retval		FALSE			Otherwise
+ */
+_Check_return_
+BOOL
+FileIO_IsDirectory(
+	_In_z_ const wchar_t* PwszPath);
+
+/**
+ *	@brief		Checks if a file can be written without creating or opening it
+ *	@details	Checks the access rights of an existing file or, for a file which does not exist yet, of its directory.
+ *
+ *	@param		PwszFileName			File name
+ *	@retval		RC_SUCCESS				The file can be written or created.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND		The directory of the file does not exist.
+ *	@retval		RC_E_ACCESS_DENIED		The file or its directory is not writable or the file is a directory.
+ */
+_Check_return_
+unsigned int
+FileIO_CheckWritable(
+	_In_z_ const wchar_t* PwszFileName);
+
+/**
+ *	@brief		Lists the files of a directory
+ *	@details	Returns the names of the regular files in the directory sorted in ascending order. Each name is zero
+ *				terminated and directly followed by the next one. Subdirectories and hidden files are skipped.
+ *
+ *	@param		PwszDirectoryName		Directory name
+ *	@param		PwszFileNames			Buffer receiving the file names
+ *	@param		PpunFileNamesSize		IN: Capacity of PwszFileNames in wide characters
+ *										OUT: Number of wide characters written to PwszFileNames
+ *	@param		PpunFileCount			Receives the number of file names
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FILE_NOT_FOUND		The directory does not exist.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszFileNames is too small to hold all file names.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ListDirectory(
+	_In_z_							const wchar_t*	PwszDirectoryName,
+	_Out_z_cap_(*PpunFileNamesSize)	wchar_t*		PwszFileNames,
+	_Inout_							unsigned int*	PpunFileNamesSize,
+	_Out_							unsigned int*	PpunFileCount);
+
+/**
+ *	@brief		Lists the paths matching a wildcard pattern
+ *	@details	Expands the wildcards *, ? and [...] of the pattern like a shell and returns the matching paths sorted in
+ *				ascending order. Each path is zero terminated and directly followed by the next one.
+ *
+ *	@param		PwszPattern				Path pattern
+ *	@param		PwszPaths				Buffer receiving the paths
+ *	@param		PpunPathsSize			IN: Capacity of PwszPaths in wide characters
+ *										OUT: Number of wide characters written to PwszPaths
+ *	@param		PpunPathCount			Receives the number of paths
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FILE_NOT_FOUND		No path matches the pattern.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszPaths is too small to hold all paths.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ListMatchingPaths(
+	_In_z_						const wchar_t*	PwszPattern,
+	_Out_z_cap_(*PpunPathsSize)	wchar_t*		PwszPaths,
+	_Inout_						unsigned int*	PpunPathsSize,
+	_Out_						unsigned int*	PpunPathCount);
+
 /**
  *	@brief		Get the file size
  *	@details	Returns the size in bytes of a given file
@@ -195,6 +314,27 @@ FileIO_GetFileSize(
 	_In_	const void*			PpvFileHandle,
 	_Out_	unsigned long long*	PpullFileSize);
 
+/**
+ *	@brief		Get the status of a file
+ *	@details	Returns size and modification time of a given file and whether it is private to the effective user,
+ *				i.e. owned by the effective user and neither writable by the group nor by others.
+ *	@param		PwszFileName			File name
+ *	@param		PpullFileSize			The size of the file in bytes
+ *	@param		PpullModificationTime	The modification time of the file in nanoseconds since the epoch
+ *	@param		PpfPrivate				TRUE if the file is private to the effective user, FALSE otherwise
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FILE_NOT_FOUND		The file does not exist.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_GetFileStatus(
+	_In_z_	const wchar_t*			PwszFileName,
+	_Out_	unsigned long long*		PpullFileSize,
+	_Out_	unsigned long long*		PpullModificationTime,
+	_Out_	BOOL*					PpfPrivate);
+
 /**
  *	@brief		Read the whole content of a file into a byte array
  *	@details	The function opens, reads and closes the file.
@@ -216,6 +356,365 @@ FileIO_ReadFileToBuffer(
 	_Outptr_result_maybenull_	BYTE**			PprgbBuffer,
 	_Out_						unsigned int*	PpunBufferSize);
 
+/**
+ *	@brief		Load the whole content of a file into private memory
+ *	@details	The file is read with read() into an anonymous mapping, which is made read-only afterwards. The buffer is a
+ *				private copy: a later write to or truncation of the file changes neither the checked content nor raises
+ *				SIGBUS on access, unlike a mapping of the file itself. A file which shrinks while it is read fails. The
+ *				caller must not modify the buffer. If no anonymous mapping can be created (e.g. for an empty file) the
+ *				function falls back to FileIO_ReadFileToBuffer. An https:// URL is downloaded into an allocated buffer,
+ *				see FileIO_StartDownload. The buffer must be released with FileIO_ReleaseFileBuffer.
+ *
+ *	@param		PwszFileName		String containing the file to be loaded
+ *	@param		PprgbBuffer			Pointer to a byte array which receives the mapped or allocated buffer.
+ *	@param		PpunBufferSize		Number of bytes in the buffer.
+ *	@param		PpfMapped			Receives TRUE if the buffer is an anonymous mapping holding the file, FALSE if it was allocated.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly. Or the file was too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_MapFileToBuffer(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer,
+	_Out_						unsigned int*	PpunBufferSize,
+	_Out_						BOOL*			PpfMapped);
+
+/**
+ *	@brief		Release a buffer returned by FileIO_MapFileToBuffer
+ *	@details	Unmaps a file mapping or frees an allocated buffer and sets the buffer pointer to NULL.
+ *
+ *	@param		PprgbBuffer			Pointer to the buffer to release
+ *	@param		PunBufferSize		Number of bytes in the buffer
+ *	@param		PfMapped			TRUE if the buffer is a mapping, FALSE if it was allocated
+ */
+void
+FileIO_ReleaseFileBuffer(
+	_Inout_	BYTE**			PprgbBuffer,
+	_In_	unsigned int	PunBufferSize,
+	_In_	BOOL			PfMapped);
+
+/**
+ *	@brief		Drop the resident pages of a buffer returned by FileIO_MapFileToBuffer
+ *	@details	The pages of a loaded file are paged out where the kernel supports it (MADV_PAGEOUT), the buffer stays valid
+ *				and is paged in again when it is accessed. Nothing is done for an allocated buffer.
+ *
+ *	@param		PrgbBuffer			Buffer returned by FileIO_MapFileToBuffer
+ *	@param		PunBufferSize		Number of bytes in the buffer
+ *	@param		PfMapped			TRUE if the buffer is a mapping, FALSE if it was allocated
+ */
+void
+FileIO_DiscardFileBuffer(
+	_In_	const BYTE*		PrgbBuffer,
+	_In_	unsigned int	PunBufferSize,
+	_In_	BOOL			PfMapped);
+
+/**
+ *	@brief		Checks if a location is a URL which is downloaded instead of read from the file system
+ *	@details	Only https:// URLs are accepted. FileIO_Exists and FileIO_MapFileToBuffer accept such URLs.
+ *
+ *	@param		PwszFileName	File name or URL
+ *	@retval		TRUE			If the location is a URL
+ *	@retval		FALSE			Otherwise
+ */
+_Check_return_
+BOOL
+FileIO_IsUrl(
+	_In_opt_ const wchar_t* PwszFileName);
+
+/**
+ *	@brief		Start downloading a URL in the background
+ *	@details	The content is received into memory while the caller continues, e.g. with probing the TPM. A later
+ *				FileIO_MapFileToBuffer call for the same URL waits for the download and takes the content, other
+ *				URLs are downloaded by FileIO_MapFileToBuffer itself. Only one background download is kept.
+ *
+ *	@param		PwszUrl				https:// URL
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	PwszUrl is not a URL or a background download has already been started.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_StartDownload(
+	_In_z_	const wchar_t*	PwszUrl);
+
+/**
+ *	@brief		Abort a download started by FileIO_StartDownload and release its content
+ *	@details	Nothing is done if no background download is pending.
+ */
+void
+FileIO_CancelDownload();
+
+/**
+ *	@brief		Map a file of a fixed size writable into memory
+ *	@details	The file is created if it does not exist and resized to PunBufferSize bytes. The mapping is shared, so stores
+ *				to the buffer are visible to other processes mapping the same file without any further system call. The
+ *				buffer must be released with FileIO_ReleaseFileBuffer (PfMapped TRUE), the file content is kept.
+ *
+ *	@param		PwszFileName		String containing the file to be mapped
+ *	@param		PunBufferSize		Size of the file and the buffer in bytes
+ *	@param		PprgbBuffer			Pointer to a byte array which receives the mapped buffer.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			An unexpected error occurred, e.g. the file could not be created or mapped.
+ */
+_Check_return_
+unsigned int
+FileIO_MapSharedFile(
+	_In_z_						const wchar_t*	PwszFileName,
+	_In_						unsigned int	PunBufferSize,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer);
+
+/**
+ *	@brief		Create or open a POSIX shared memory object
+ *	@details	A created object is private to the effective user and must not exist yet. The creating handle holds an
+ *				exclusive lock on the object until it is closed, so processes opening the object can wait with
+ *				FileIO_WaitSharedMemory until the creator has filled it. An object is only opened (read-only) if it is
+ *				private to the effective user, so nobody else can plant its content. The handle must be closed with
+ *				FileIO_CloseSharedMemory, the object stays until it is removed with FileIO_RemoveSharedMemory.
+ *
+ *	@param		PwszName			Name of the shared memory object, must start with a slash
+ *	@param		PfCreate			TRUE to create the object, FALSE to open an existing object read-only
+ *	@param		PppvSharedMemory	Receives the shared memory handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_EXISTS	The object to be created exists already.
+ *	@retval		RC_E_FILE_NOT_FOUND	The object to be opened does not exist.
+ *	@retval		RC_E_ACCESS_DENIED	The object is not private to the effective user.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_OpenSharedMemory(
+	_In_z_						const wchar_t*	PwszName,
+	_In_						BOOL			PfCreate,
+	_Outptr_result_maybenull_	void**			PppvSharedMemory);
+
+/**
+ *	@brief		Wait until the creator of a shared memory object has closed its handle
+ *	@details	Returns immediately for an object whose creator has already closed its handle or has exited.
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory
+ *	@param		PunTimeoutMs		Maximum time to wait in milliseconds
+ *	@retval		RC_SUCCESS					The creator has closed its handle.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND			The object has been removed in the meantime.
+ *	@retval		RC_E_DEVICE_ALREADY_IN_USE	The creator still holds the object when the timeout expired.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_WaitSharedMemory(
+	_In_	void*			PpvSharedMemory,
+	_In_	unsigned int	PunTimeoutMs);
+
+/**
+ *	@brief		Read from a shared memory object
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory
+ *	@param		PunOffset			Offset in the object
+ *	@param		PrgbBuffer			Receives the data
+ *	@param		PunSize				Number of bytes to read
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	The object ends before the requested range.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadSharedMemory(
+	_In_						void*			PpvSharedMemory,
+	_In_						unsigned int	PunOffset,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbBuffer,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Write to a shared memory object created by FileIO_OpenSharedMemory
+ *	@details	The object grows as needed, a gap in front of the written range reads as zeros.
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory with PfCreate TRUE
+ *	@param		PunOffset			Offset in the object
+ *	@param		PrgbBuffer			Data to write
+ *	@param		PunSize				Number of bytes to write
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			An unexpected error occurred, e.g. the shared memory file system is full.
+ */
+_Check_return_
+unsigned int
+FileIO_WriteSharedMemory(
+	_In_						void*			PpvSharedMemory,
+	_In_						unsigned int	PunOffset,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbBuffer,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Map a range of a shared memory object read-only into memory
+ *	@details	All processes mapping the object share its pages. The buffer must be released with FileIO_ReleaseFileBuffer
+ *				(PfMapped TRUE) and stays valid after the handle has been closed and the object has been removed.
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory
+ *	@param		PunOffset			Offset in the object, must be a multiple of the page size
+ *	@param		PunSize				Number of bytes to map
+ *	@param		PprgbBuffer			Receives the mapped buffer
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	The object ends before the requested range.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_MapSharedMemory(
+	_In_						void*			PpvSharedMemory,
+	_In_						unsigned int	PunOffset,
+	_In_						unsigned int	PunSize,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer);
+
+/**
+ *	@brief		Remove a POSIX shared memory object
+ *	@details	Processes which opened or mapped the object keep their handles and mappings.
+ *
+ *	@param		PwszName			Name of the shared memory object, must start with a slash
+ */
+void
+FileIO_RemoveSharedMemory(
+	_In_z_	const wchar_t*	PwszName);
+
+/**
+ *	@brief		Close a shared memory handle opened by FileIO_OpenSharedMemory
+ *	@details	Releases the lock of a creating handle, the object itself is kept.
+ *
+ *	@param		PppvSharedMemory	Pointer to the shared memory handle. Set to NULL on return.
+ */
+void
+FileIO_CloseSharedMemory(
+	_Inout_ void** PppvSharedMemory);
+
+/**
+ *	@brief		Open a file for streamed reading
+ *	@details	The file is read sequentially through a read-ahead buffer of FILEIO_STREAM_READ_AHEAD_SIZE bytes, so only
+ *				that buffer is resident regardless of the file size. The stream must be closed with FileIO_CloseStream.
+ *
+ *	@param		PwszFileName		String containing the file to be read
+ *	@param		PppvStream			Receives the stream handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_OpenStream(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	void**			PppvStream);
+
+/**
+ *	@brief		Read from a file stream
+ *	@details	Copies the requested range from the read-ahead buffer. The buffer is refilled from the requested offset if
+ *				the range is not buffered, sequential reads therefore access the file once per buffer size.
+ *
+ *	@param		PpvStream			Stream handle returned by FileIO_OpenStream
+ *	@param		PunOffset			Offset in the file
+ *	@param		PrgbBuffer			Receives the data
+ *	@param		PunSize				Number of bytes to read
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	The file ends before the requested range.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadStream(
+	_In_						void*			PpvStream,
+	_In_						unsigned int	PunOffset,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbBuffer,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Close a file stream opened by FileIO_OpenStream
+ *
+ *	@param		PppvStream			Pointer to the stream handle. Set to NULL on return.
+ */
+void
+FileIO_CloseStream(
+	_Inout_ void** PppvStream);
+
+/**
+ *	@brief		Open a text file for reading line by line
+ *	@details	Unlike FileIO_ReadLine the byte order mark is detected once, and lines are decoded incrementally from a
+ *				read-ahead buffer of FILEIO_STREAM_READ_AHEAD_SIZE bytes, so the file is only accessed once per buffer
+ *				instead of several times per line. The reader must be closed with FileIO_CloseLineReader.
+ *
+ *	@param		PwszFileName		String containing the file to be read
+ *	@param		PppvReader			Receives the reader handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_WRONG_ENCODING	The file is neither UTF-8 nor has it a byte order mark.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_OpenLineReader(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	void**			PppvReader);
+
+/**
+ *	@brief		Reads the next line from a line reader
+ *	@details	Behaves like FileIO_ReadLine: the line feed is part of the line, and a line longer than the buffer is
+ *				returned in several parts.
+ *
+ *	@param		PpvReader			Reader handle returned by FileIO_OpenLineReader
+ *	@param		PwszBuffer			Buffer to the read data
+ *	@param		PpunSize			In:	Capacity of the destination buffer in wchar_t elements (include additional space for terminating 0)\n
+ *									Out: Number of elements copied to the destination buffer (without terminating 0)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	In case method has reached the end of file
+ *	@retval		RC_E_FAIL			An unexpected error occurred. E.g. the file contains an invalid multibyte sequence.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadLineFromReader(
+	_In_					void*			PpvReader,
+	_Out_z_cap_(*PpunSize)	wchar_t*		PwszBuffer,
+	_Inout_					unsigned int*	PpunSize);
+
+/**
+ *	@brief		Close a line reader opened by FileIO_OpenLineReader
+ *
+ *	@param		PppvReader			Pointer to the reader handle. Set to NULL on return.
+ */
+void
+FileIO_CloseLineReader(
+	_Inout_ void** PppvReader);
+
+/**
+ *	@brief		Decompress a gzip compressed buffer returned by FileIO_MapFileToBuffer
+ *	@details	If the buffer starts with the gzip magic bytes it is inflated into an allocated buffer, and the
+ *				compressed buffer is released. Otherwise the buffer is left untouched. The decompressed size is taken
+ *				from the gzip trailer and limited to FILEIO_MAX_DECOMPRESSED_SIZE. The buffer must still be released
+ *				with FileIO_ReleaseFileBuffer.
+ *				A buffer of independently compressed frames (see FILEIO_FRAME_SUBFIELD_ID) is inflated frame by frame by
+ *				up to FILEIO_DECOMPRESS_THREADS_MAX threads.
+ *
+ *	@param		PprgbBuffer			Pointer to the buffer, receives the decompressed buffer.
+ *	@param		PpunBufferSize		Number of bytes in the buffer, receives the decompressed size.
+ *	@param		PpfMapped			TRUE if the buffer is a file mapping, receives FALSE if the buffer was decompressed.
+ *	@param		PpfDecompressed		Receives TRUE if the buffer was decompressed, FALSE otherwise.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. Or the compressed data is corrupt or too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_DecompressFileBuffer(
+	_Inout_	BYTE**			PprgbBuffer,
+	_Inout_	unsigned int*	PpunBufferSize,
+	_Inout_	BOOL*			PpfMapped,
+	_Out_	BOOL*			PpfDecompressed);
+
 /**
  *	@brief		Read the whole content of a file into a wide char array
  *	@details	The function opens, reads and closes the file.
@@ -274,6 +773,134 @@ unsigned int
 FileIO_Remove(
 	_In_z_ const wchar_t* PwszFileName);
 
+/**
+ *	@brief		Create a directory which is private to the effective user
+ *	@details	An existing directory is accepted as is.
+ *
+ *	@param		PwszPath			Directory path
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_ACCESS_DENIED	The directory cannot be created in the parent directory.
+ *	@retval		RC_E_FILE_NOT_FOUND	The parent directory does not exist.
+ *	@retval		RC_E_INTERNAL		In all other cases where the directory could not be created
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_CreateDirectory(
+	_In_z_ const wchar_t* PwszPath);
+
+/**
+ *	@brief		Rename a file
+ *	@details	An existing file with the new name is replaced.
+ *
+ *	@param		PwszFileName		File name
+ *	@param		PwszNewFileName		New file name
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_ACCESS_DENIED	The file or the target directory cannot be written.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_INTERNAL		In all other cases where the file could not be renamed
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_Rename(
+	_In_z_	const wchar_t*	PwszFileName,
+	_In_z_	const wchar_t*	PwszNewFileName);
+
+/**
+ *	@brief		Compress a file to a gzip file
+ *	@details	An existing destination file is replaced. The source file is left untouched. In case of an error an
+ *				incomplete destination file is removed.
+ *
+ *	@param		PwszFileName		File name of the file to compress
+ *	@param		PwszGzipFileName	File name of the gzip file to create
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_INTERNAL		The file could not be read or the gzip file could not be written.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_CompressFile(
+	_In_z_	const wchar_t*	PwszFileName,
+	_In_z_	const wchar_t*	PwszGzipFileName);
+
+/**
+ *	@brief		Acquires an exclusive advisory lock on a lock file
+ *	@details	The lock file is created if it does not exist. A caller finding the lock held waits blocked in the kernel
+ *				until the lock is released or the timeout expires, there is no polling. The lock is released by
+ *				FileIO_UnlockFile or when the process exits.
+ *
+ *	@param		PwszFileName					Lock file name
+ *	@param		PunTimeoutSeconds				Maximum time to wait for the lock in seconds (0: do not wait)
+ *	@param		PppvLock						Receives the lock handle
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_ACCESS_DENIED				The lock file cannot be created or opened.
+ *	@retval		RC_E_FILE_NOT_FOUND				The directory of the lock file does not exist.
+ *	@retval		RC_E_DEVICE_ALREADY_IN_USE		The lock is still held by another process when the timeout expired.
+ *	@retval		RC_E_FAIL						An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_LockFile(
+	_In_z_						const wchar_t*	PwszFileName,
+	_In_						unsigned int	PunTimeoutSeconds,
+	_Outptr_result_maybenull_	void**			PppvLock);
+
+/**
+ *	@brief		Releases a lock acquired by FileIO_LockFile
+ *	@details	The lock file is kept, so that waiting processes keep waiting on the same file.
+ *
+ *	@param		PppvLock		Pointer to the lock handle. Set to NULL on return.
+ */
+void
+FileIO_UnlockFile(
+	_Inout_ void** PppvLock);
+
+/**
+ *	@brief		Start watching a file for changes
+ *	@details	The directory of the file is watched with inotify, so a file replaced by a rename (as most editors and
+ *				configuration management tools save) is still seen. Without inotify the file status is compared on each
+ *				FileIO_WatchChanged call instead. The file does not need to exist. The watch must be closed with
+ *				FileIO_WatchClose.
+ *
+ *	@param		PwszFileName		File to watch
+ *	@param		PppvWatch			Receives the watch handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_WatchOpen(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	void**			PppvWatch);
+
+/**
+ *	@brief		Check a watched file for changes
+ *	@details	Does not block. Only completed writes are reported (the file is closed after writing, renamed to the watched
+ *				name, created or removed), so a file still being written is not seen half written.
+ *
+ *	@param		PpvWatch			Watch handle returned by FileIO_WatchOpen
+ *	@retval		TRUE				The file has changed since the watch was opened or last checked.
+ *	@retval		FALSE				The file has not changed or PpvWatch is NULL.
+ */
+BOOL
+FileIO_WatchChanged(
+	_In_opt_ void* PpvWatch);
+
+/**
+ *	@brief		Stop watching a file opened by FileIO_WatchOpen
+ *
+ *	@param		PppvWatch			Pointer to the watch handle. Set to NULL on return.
+ */
+void
+FileIO_WatchClose(
+	_Inout_ void** PppvWatch);
+
 #ifdef __cplusplus
 }
 #endif
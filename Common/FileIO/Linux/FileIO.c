@@ -15,7 +15,26 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wchar.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <glob.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <zlib.h>
+/// The function pointers of s_sLibCurl are declared with the plain prototypes
+#define CURL_DISABLE_TYPECHECK
+#include <curl/curl.h>
 #include "FileIO.h"
 #include "Platform.h"
 
@@ -39,6 +58,494 @@ typedef enum td_ENUM_BOM_TYPES
 	BOM_TYPES_UTF32BE
 } ENUM_BOM_TYPES;
 
+/// Prefix of the locations which are downloaded instead of read from the file system
+#define FILEIO_URL_PREFIX L"https://"
+/// Shared object name of the libcurl version the module was compiled against
+#define FILEIO_LIBCURL_NAME "libcurl.so.4"
+/// Time in seconds to establish the connection of a download
+#define FILEIO_DOWNLOAD_CONNECT_TIMEOUT 30L
+/// A download is aborted if it transfers less than one byte per second for this time in seconds
+#define FILEIO_DOWNLOAD_STALL_TIMEOUT 60L
+/// Initial buffer size of a download without a Content-Length
+#define FILEIO_DOWNLOAD_INITIAL_SIZE (256 * 1024)
+
+/// libcurl functions used by this module, resolved on the first download by FileIO_LoadLibCurl
+#define FILEIO_LIBCURL_FUNCTIONS(FUNCTION) \
+	FUNCTION(curl_easy_cleanup) \
+	FUNCTION(curl_easy_getinfo) \
+	FUNCTION(curl_easy_init) \
+	FUNCTION(curl_easy_perform) \
+	FUNCTION(curl_easy_setopt) \
+	FUNCTION(curl_global_init)
+
+/// Function pointer declaration with the prototype from the libcurl headers
+#define FILEIO_LIBCURL_POINTER(NAME) __typeof__(&NAME) NAME;
+
+/// Resolved libcurl functions
+static struct
+{
+	FILEIO_LIBCURL_FUNCTIONS(FILEIO_LIBCURL_POINTER)
+} s_sLibCurl;
+
+/// Whether libcurl has been loaded and initialized
+static BOOL s_fLibCurlLoaded = FALSE;
+/// Loads libcurl exactly once, also if the first download runs on the prefetch thread
+static pthread_once_t s_sLibCurlOnce = PTHREAD_ONCE_INIT;
+
+/**
+ *	@brief		Download of a URL into memory
+ *	@details
+ */
+typedef struct tdIfxFileDownload
+{
+	/// URL as multibyte string
+	char* szUrl;
+	/// libcurl handle of the running transfer
+	CURL* pCurl;
+	/// Received content
+	BYTE* prgbBuffer;
+	/// Number of received bytes
+	unsigned int unSize;
+	/// Number of allocated bytes in prgbBuffer
+	unsigned int unCapacity;
+	/// Result of the download
+	unsigned int unReturnValue;
+} IfxFileDownload;
+
+/// Download started by FileIO_StartDownload
+static IfxFileDownload s_sPrefetch;
+/// Thread running the download started by FileIO_StartDownload
+static pthread_t s_hPrefetchThread;
+/// Whether s_hPrefetchThread has been started and not yet joined
+static BOOL s_fPrefetchStarted = FALSE;
+/// Set by FileIO_CancelDownload, aborts running downloads
+static volatile BOOL s_fDownloadCancelled = FALSE;
+
+/**
+ *	@brief		Load libcurl and resolve the used functions (run once through s_sLibCurlOnce)
+ *	@details	Sets s_fLibCurlLoaded if all functions are available and libcurl is initialized.
+ */
+static void
+FileIO_LoadLibCurlOnce()
+{
+	do
+	{
+		void* pvLibrary = NULL;
+		BOOL fResolved = TRUE;
+
+		pvLibrary = dlopen(FILEIO_LIBCURL_NAME, RTLD_NOW | RTLD_LOCAL);
+		if (NULL == pvLibrary)
+			pvLibrary = dlopen("libcurl.so", RTLD_NOW | RTLD_LOCAL);
+		if (NULL == pvLibrary)
+			break;
+
+		// Copy the symbol addresses into the typed function pointers
+#define FILEIO_LIBCURL_RESOLVE(NAME) \
+		{ \
+			void* pvSymbol = dlsym(pvLibrary, #NAME); \
+			if (NULL == pvSymbol) \
+				fResolved = FALSE; \
+			memcpy(&s_sLibCurl.NAME, &pvSymbol, sizeof(s_sLibCurl.NAME)); \
+		}
+		FILEIO_LIBCURL_FUNCTIONS(FILEIO_LIBCURL_RESOLVE)
+#undef FILEIO_LIBCURL_RESOLVE
+
+		if (!fResolved || CURLE_OK != s_sLibCurl.curl_global_init(CURL_GLOBAL_DEFAULT))
+		{
+			memset(&s_sLibCurl, 0, sizeof(s_sLibCurl));
+			dlclose(pvLibrary);
+			break;
+		}
+
+		s_fLibCurlLoaded = TRUE;
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Checks if a location is a URL which is downloaded instead of read from the file system
+ *	@details	Only https:// URLs are accepted.
+ *
+ *	@param		PwszFileName	File name or URL
+ *	@retval		TRUE			If the location is a URL
+ *	@retval		FALSE			Otherwise
+ */
+_Check_return_
+BOOL
+FileIO_IsUrl(
+	_In_opt_ const wchar_t* PwszFileName)
+{
+	return NULL != PwszFileName && 0 == wcsncmp(PwszFileName, FILEIO_URL_PREFIX, wcslen(FILEIO_URL_PREFIX));
+}
+
+/**
+ *	@brief		libcurl write callback appending the received bytes to the download buffer
+ *	@details	The buffer is allocated with the Content-Length of the response once the first bytes arrive, so that
+ *				the content is not copied again. Without a Content-Length the buffer grows by doubling.
+ *
+ *	@param		PrgbData		Received bytes
+ *	@param		PsizeItem		Size of an item (always 1)
+ *	@param		PsizeCount		Number of items
+ *	@param		PpvContext		IfxFileDownload of the transfer
+ *	@retval		Number of bytes taken, a different value aborts the transfer
+ */
+static size_t
+FileIO_DownloadWrite(
+	_In_reads_bytes_(PsizeItem * PsizeCount)	char*	PrgbData,
+	_In_										size_t	PsizeItem,
+	_In_										size_t	PsizeCount,
+	_Inout_										void*	PpvContext)
+{
+	IfxFileDownload* pDownload = (IfxFileDownload*)PpvContext;
+	size_t sizeData = PsizeItem * PsizeCount;
+
+	do
+	{
+		if (s_fDownloadCancelled || (unsigned long long)sizeData > (unsigned long long)(UINT_MAX - pDownload->unSize))
+		{
+			sizeData = 0;
+			break;
+		}
+
+		if (pDownload->unSize + sizeData > pDownload->unCapacity)
+		{
+			unsigned long long ullCapacity = pDownload->unCapacity;
+			BYTE* prgbBuffer = NULL;
+
+			if (0 == ullCapacity)
+			{
+				curl_off_t llContentLength = -1;
+				if (CURLE_OK != s_sLibCurl.curl_easy_getinfo(pDownload->pCurl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &llContentLength) || 0 > llContentLength)
+					llContentLength = FILEIO_DOWNLOAD_INITIAL_SIZE;
+				ullCapacity = (unsigned long long)llContentLength;
+			}
+			while (ullCapacity < pDownload->unSize + sizeData)
+				ullCapacity *= 2;
+			if (UINT_MAX < ullCapacity)
+				ullCapacity = UINT_MAX;
+
+			prgbBuffer = (BYTE*)Platform_MemoryAllocateZero((unsigned int)ullCapacity);
+			if (NULL == prgbBuffer)
+			{
+				sizeData = 0;
+				break;
+			}
+			if (0 != pDownload->unSize)
+				memcpy(prgbBuffer, pDownload->prgbBuffer, pDownload->unSize);
+			Platform_MemoryFree((void**)&pDownload->prgbBuffer);
+			pDownload->prgbBuffer = prgbBuffer;
+			pDownload->unCapacity = (unsigned int)ullCapacity;
+		}
+
+		memcpy(pDownload->prgbBuffer + pDownload->unSize, PrgbData, sizeData);
+		pDownload->unSize += (unsigned int)sizeData;
+	}
+	WHILE_FALSE_END;
+
+	return sizeData;
+}
+
+/**
+ *	@brief		libcurl progress callback aborting the transfer after FileIO_CancelDownload
+ *	@details	libcurl also calls the function while no data arrives.
+ *
+ *	@param		PpvContext		IfxFileDownload of the transfer (unused)
+ *	@param		PllDownloadTotal	Expected number of bytes to download (unused)
+ *	@param		PllDownloadNow		Number of bytes downloaded (unused)
+ *	@param		PllUploadTotal		Expected number of bytes to upload (unused)
+ *	@param		PllUploadNow		Number of bytes uploaded (unused)
+ *	@retval		0				Continue the transfer
+ *	@retval		1				Abort the transfer
+ */
+static int
+FileIO_DownloadProgress(
+	_In_	void*		PpvContext,
+	_In_	curl_off_t	PllDownloadTotal,
+	_In_	curl_off_t	PllDownloadNow,
+	_In_	curl_off_t	PllUploadTotal,
+	_In_	curl_off_t	PllUploadNow)
+{
+	UNREFERENCED_PARAMETER(PpvContext);
+	UNREFERENCED_PARAMETER(PllDownloadTotal);
+	UNREFERENCED_PARAMETER(PllDownloadNow);
+	UNREFERENCED_PARAMETER(PllUploadTotal);
+	UNREFERENCED_PARAMETER(PllUploadNow);
+
+	return s_fDownloadCancelled ? 1 : 0;
+}
+
+/**
+ *	@brief		Initialize a download of a URL
+ *	@details	Converts the URL to a multibyte string. Release the download with FileIO_DownloadRelease.
+ *
+ *	@param		PwszUrl				https:// URL
+ *	@param		PpDownload			Receives the initialized download
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	PwszUrl is not a URL.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+static unsigned int
+FileIO_DownloadInitialize(
+	_In_z_	const wchar_t*		PwszUrl,
+	_Out_	IfxFileDownload*	PpDownload)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		size_t sizeUrl = 0;
+
+		memset(PpDownload, 0, sizeof(IfxFileDownload));
+		PpDownload->unReturnValue = RC_E_FAIL;
+
+		if (!FileIO_IsUrl(PwszUrl))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		sizeUrl = wcstombs(NULL, PwszUrl, 0);
+		if ((size_t) - 1 == sizeUrl)
+			break;
+		PpDownload->szUrl = (char*)Platform_MemoryAllocateZero((unsigned int)sizeUrl + 1);
+		if (NULL == PpDownload->szUrl)
+			break;
+		if ((size_t) - 1 == wcstombs(PpDownload->szUrl, PwszUrl, sizeUrl + 1))
+		{
+			Platform_MemoryFree((void**)&PpDownload->szUrl);
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Release the URL and the received content of a download
+ *	@details
+ *
+ *	@param		PpDownload			Download to release
+ */
+static void
+FileIO_DownloadRelease(
+	_Inout_	IfxFileDownload*	PpDownload)
+{
+	Platform_MemoryFree((void**)&PpDownload->szUrl);
+	Platform_MemoryFree((void**)&PpDownload->prgbBuffer);
+	PpDownload->unSize = 0;
+	PpDownload->unCapacity = 0;
+}
+
+/**
+ *	@brief		Run a download
+ *	@details	Only https is allowed, also for redirections. The server certificate is verified against the system
+ *				trust store. A HTTP error status fails the download.
+ *
+ *	@param		PpDownload			Initialized download, receives the content and the result
+ *	@param		PfHeadOnly			TRUE to only check that the URL exists without transferring the content
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_FAIL			libcurl is not available, the transfer failed or no content was received.
+ */
+_Check_return_
+static unsigned int
+FileIO_DownloadPerform(
+	_Inout_	IfxFileDownload*	PpDownload,
+	_In_	BOOL				PfHeadOnly)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		CURLcode unCurlCode = CURLE_OK;
+
+		IGNORE_RETURN_VALUE(pthread_once(&s_sLibCurlOnce, FileIO_LoadLibCurlOnce));
+		if (!s_fLibCurlLoaded)
+			break;
+
+		PpDownload->pCurl = s_sLibCurl.curl_easy_init();
+		if (NULL == PpDownload->pCurl)
+			break;
+
+		// Settings are checked after all of them have been applied, a failing one is sticky in unCurlCode
+#define FILEIO_CURL_SETOPT(OPTION, VALUE) \
+		if (CURLE_OK == unCurlCode) \
+			unCurlCode = s_sLibCurl.curl_easy_setopt(PpDownload->pCurl, OPTION, VALUE);
+		FILEIO_CURL_SETOPT(CURLOPT_URL, PpDownload->szUrl)
+#if LIBCURL_VERSION_NUM >= 0x075500
+		FILEIO_CURL_SETOPT(CURLOPT_PROTOCOLS_STR, "https")
+		FILEIO_CURL_SETOPT(CURLOPT_REDIR_PROTOCOLS_STR, "https")
+#else
+		FILEIO_CURL_SETOPT(CURLOPT_PROTOCOLS, (long)CURLPROTO_HTTPS)
+		FILEIO_CURL_SETOPT(CURLOPT_REDIR_PROTOCOLS, (long)CURLPROTO_HTTPS)
+#endif
+		FILEIO_CURL_SETOPT(CURLOPT_FOLLOWLOCATION, 1L)
+		FILEIO_CURL_SETOPT(CURLOPT_FAILONERROR, 1L)
+		FILEIO_CURL_SETOPT(CURLOPT_NOSIGNAL, 1L)
+		FILEIO_CURL_SETOPT(CURLOPT_CONNECTTIMEOUT, FILEIO_DOWNLOAD_CONNECT_TIMEOUT)
+		FILEIO_CURL_SETOPT(CURLOPT_LOW_SPEED_LIMIT, 1L)
+		FILEIO_CURL_SETOPT(CURLOPT_LOW_SPEED_TIME, FILEIO_DOWNLOAD_STALL_TIMEOUT)
+		FILEIO_CURL_SETOPT(CURLOPT_NOBODY, PfHeadOnly ? 1L : 0L)
+		FILEIO_CURL_SETOPT(CURLOPT_WRITEFUNCTION, &FileIO_DownloadWrite)
+		FILEIO_CURL_SETOPT(CURLOPT_WRITEDATA, PpDownload)
+		FILEIO_CURL_SETOPT(CURLOPT_XFERINFOFUNCTION, &FileIO_DownloadProgress)
+		FILEIO_CURL_SETOPT(CURLOPT_XFERINFODATA, PpDownload)
+		FILEIO_CURL_SETOPT(CURLOPT_NOPROGRESS, 0L)
+#undef FILEIO_CURL_SETOPT
+		if (CURLE_OK != unCurlCode)
+			break;
+
+		if (CURLE_OK != s_sLibCurl.curl_easy_perform(PpDownload->pCurl))
+			break;
+		if (!PfHeadOnly && 0 == PpDownload->unSize)
+			break;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != PpDownload->pCurl)
+	{
+		s_sLibCurl.curl_easy_cleanup(PpDownload->pCurl);
+		PpDownload->pCurl = NULL;
+	}
+
+	PpDownload->unReturnValue = unReturnValue;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Thread function running the download started by FileIO_StartDownload
+ *	@details
+ *
+ *	@param		PpvContext		IfxFileDownload to run
+ *	@retval		NULL
+ */
+static void*
+FileIO_DownloadThread(
+	_Inout_	void*	PpvContext)
+{
+	IGNORE_RETURN_VALUE(FileIO_DownloadPerform((IfxFileDownload*)PpvContext, FALSE));
+	return NULL;
+}
+
+/**
+ *	@brief		Start downloading a URL in the background
+ *	@details	The content is received into memory while the caller continues, e.g. with probing the TPM. A later
+ *				FileIO_MapFileToBuffer call for the same URL waits for the download and takes the content, other
+ *				URLs are downloaded by FileIO_MapFileToBuffer itself. Only one background download is kept.
+ *
+ *	@param		PwszUrl				https:// URL
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	PwszUrl is not a URL or a background download has already been started.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_StartDownload(
+	_In_z_	const wchar_t*	PwszUrl)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		if (s_fPrefetchStarted)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = FileIO_DownloadInitialize(PwszUrl, &s_sPrefetch);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (0 != pthread_create(&s_hPrefetchThread, NULL, &FileIO_DownloadThread, &s_sPrefetch))
+		{
+			FileIO_DownloadRelease(&s_sPrefetch);
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		s_fPrefetchStarted = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Abort a download started by FileIO_StartDownload and release its content
+ *	@details	Nothing is done if no background download is pending.
+ */
+void
+FileIO_CancelDownload()
+{
+	if (s_fPrefetchStarted)
+	{
+		s_fDownloadCancelled = TRUE;
+		IGNORE_RETURN_VALUE(pthread_join(s_hPrefetchThread, NULL));
+		s_fPrefetchStarted = FALSE;
+		s_fDownloadCancelled = FALSE;
+		FileIO_DownloadRelease(&s_sPrefetch);
+	}
+}
+
+/**
+ *	@brief		Download the content of a URL into an allocated buffer
+ *	@details	Takes the content of the background download if it was started for the same URL.
+ *
+ *	@param		PwszUrl				https:// URL
+ *	@param		PprgbBuffer			Receives the allocated buffer.
+ *	@param		PpunBufferSize		Number of bytes in the buffer.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_FAIL			The download failed.
+ *	@retval		...					Error codes from FileIO_DownloadInitialize.
+ */
+_Check_return_
+static unsigned int
+FileIO_DownloadToBuffer(
+	_In_z_						const wchar_t*	PwszUrl,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer,
+	_Out_						unsigned int*	PpunBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxFileDownload sDownload;
+
+	do
+	{
+		unReturnValue = FileIO_DownloadInitialize(PwszUrl, &sDownload);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (s_fPrefetchStarted && 0 == strcmp(s_sPrefetch.szUrl, sDownload.szUrl))
+		{
+			// Wait for the background download and take its content
+			IGNORE_RETURN_VALUE(pthread_join(s_hPrefetchThread, NULL));
+			s_fPrefetchStarted = FALSE;
+			FileIO_DownloadRelease(&sDownload);
+			sDownload = s_sPrefetch;
+			memset(&s_sPrefetch, 0, sizeof(s_sPrefetch));
+			unReturnValue = sDownload.unReturnValue;
+		}
+		else
+			unReturnValue = FileIO_DownloadPerform(&sDownload, FALSE);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		*PprgbBuffer = sDownload.prgbBuffer;
+		*PpunBufferSize = sDownload.unSize;
+		sDownload.prgbBuffer = NULL;
+	}
+	WHILE_FALSE_END;
+
+	FileIO_DownloadRelease(&sDownload);
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Get the BOM type of the current file handle.
  *	@details	The function stores the current file position, jumps to the beginning of the file, reads out the BOM information
@@ -193,7 +700,7 @@ FileIO_Open(
 		}
 
 		// Allocate memory for the multibyte string
-		szFileName = (char*)calloc(sizeFileName + 1, sizeof(char));
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
 		if (NULL == szFileName)
 		{
 			unReturnValue = RC_E_FAIL;
@@ -262,7 +769,7 @@ FileIO_Open(
 	// Cleanup memory
 	if (szFileName != NULL)
 	{
-		free(szFileName);
+		Platform_MemoryFree((void**)&szFileName);
 		szFileName = NULL;
 	}
 
@@ -308,9 +815,46 @@ FileIO_Close(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Flush a file
+ *	@details	Writes any data buffered in user space for the given file handle to the file.
+ *
+ *	@param		PpvFileHandle		Handle to an opened file
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpvFileHandle is NULL
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_Flush(
+	_In_ void* PpvFileHandle)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check file handle
+		if (NULL == PpvFileHandle)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Flush stdio buffer
+		if (0 != fflush((FILE*)PpvFileHandle))
+			break;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Reads a line from a text file
- *	@details
+ *	@details	The byte order mark is detected again on every call. Use FileIO_OpenLineReader to read a whole file line
+ *				by line.
  *	@param		PpvFileHandle		Handle to an open file
  *	@param		PwszBuffer			Buffer to the read data
  *	@param		PpunSize			In:	Capacity of the destination buffer in wchar_t elements (include additional space for terminating 0)\n
@@ -371,10 +915,11 @@ FileIO_ReadLine(
 			{
 				char szBuffer[MAX_MESSAGE_SIZE] = {0};
 				unsigned int unBufferSize = MAX_MESSAGE_SIZE;
-				size_t sizeCoverted = 0;
+				unsigned int unLength = *PpunSize;
 				pBuffer = (void*) fgets(szBuffer, unBufferSize, hFile);
-				sizeCoverted = mbstowcs(PwszBuffer, szBuffer, *PpunSize);
-				if ((size_t) - 1 == sizeCoverted)
+				// A line longer than the buffer is cut
+				unReturnValue = Platform_StringFromMultiByte(szBuffer, (unsigned int)strlen(szBuffer), PwszBuffer, &unLength);
+				if (RC_SUCCESS != unReturnValue && RC_E_BUFFER_TOO_SMALL != unReturnValue)
 				{
 					unReturnValue = RC_E_FAIL;
 					break;
@@ -496,7 +1041,7 @@ FileIO_GetPosition(
  *	@retval		RC_SUCCESS			The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PwszString is NULL
  *	@retval		RC_E_FAIL			An unexpected error occurred.
- *	@retval		...					Error codes from FileIO_WriteStringf
+ *	@retval		...					Error codes from Platform_StringWriteStream
  */
 _Check_return_
 unsigned int
@@ -505,11 +1050,13 @@ FileIO_WriteString(
 	_In_z_	const wchar_t*	PwszString)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	size_t sizeLength = 0;
 
-	if (NULL == PwszString)
+	if (NULL == PpvFileHandle || NULL == PwszString)
 		unReturnValue = RC_E_BAD_PARAMETER;
-	else
-		unReturnValue = FileIO_WriteStringf(PpvFileHandle, L"%ls", PwszString);
+	// The string needs no formatting, write it directly. An empty string has always been reported as failure.
+	else if (0 != (sizeLength = wcslen(PwszString)) && UINT_MAX >= sizeLength)
+		unReturnValue = Platform_StringWriteStream((void*)PpvFileHandle, PwszString, (unsigned int)sizeLength);
 
 	return unReturnValue;
 }
@@ -546,12 +1093,15 @@ FileIO_WriteStringf(
 
 /**
  *	@brief		Writes a formatted string using a va_list
- *	@details	Writes a formatted string to the current position in a file, using a va_list
+ *	@details	Writes a formatted string to the current position in a file, using a va_list. The string is formatted
+ *				into a buffer and written in the multibyte encoding of the locale with Platform_StringWriteStream, the
+ *				file stays byte oriented.
  *	@param		PpvFileHandle		Handle to an open file
  *	@param		PwszFormat			Format string to write
  *	@param		PpArguments			One or more values to write
  *	@retval		RC_SUCCESS			The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpvFileHandle or PwszFormat is NULL
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The formatted string exceeds FILEIO_MAX_STRING_SIZE characters.
  *	@retval		RC_E_FAIL			An unexpected error occurred.
  */
 _Check_return_
@@ -562,24 +1112,65 @@ FileIO_WriteStringvf(
 	_In_	va_list			PpArguments)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	int nResult = 0;
-
-	// Check parameters
-	if (NULL == PpvFileHandle || PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFormat))
-		unReturnValue = RC_E_BAD_PARAMETER;
+	wchar_t wszStackBuffer[MAX_MESSAGE_SIZE];
+	wchar_t* pwszBuffer = wszStackBuffer;
+	unsigned int unCapacity = RG_LEN(wszStackBuffer);
 
-	else
+	do
 	{
-		// Write data
-		nResult = vfwprintf((FILE*)PpvFileHandle, PwszFormat, PpArguments);
+		int nResult = 0;
 
-		// Check if operation was successful
-		if (0 < nResult)
-			unReturnValue = RC_SUCCESS;
-	}
+		// Check parameters
+		if (NULL == PpvFileHandle || PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFormat))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
 
-	return unReturnValue;
-}
+		// Format into the stack buffer, only exceptionally long strings need a larger buffer
+		for (;;)
+		{
+			va_list argptr;
+			va_copy(argptr, PpArguments);
+			nResult = vswprintf(pwszBuffer, unCapacity, PwszFormat, argptr);
+			va_end(argptr);
+			if (0 <= nResult || unCapacity >= FILEIO_MAX_STRING_SIZE)
+				break;
+
+			if (wszStackBuffer != pwszBuffer)
+				Platform_MemoryFree((void**)&pwszBuffer);
+			unCapacity *= 4;
+			pwszBuffer = (wchar_t*)Platform_MemoryAllocateZero(unCapacity * sizeof(wchar_t));
+			if (NULL == pwszBuffer)
+				break;
+		}
+
+		if (NULL == pwszBuffer)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (0 > nResult)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+		// An empty result has always been reported as failure
+		if (0 == nResult)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		unReturnValue = Platform_StringWriteStream((void*)PpvFileHandle, pwszBuffer, (unsigned int)nResult);
+	}
+	WHILE_FALSE_END;
+
+	if (wszStackBuffer != pwszBuffer)
+		Platform_MemoryFree((void**)&pwszBuffer);
+
+	return unReturnValue;
+}
 
 /**
  *	@brief		Checks if the current position in a file points to the end of the file
@@ -621,7 +1212,7 @@ FileIO_EOF(
 
 /**
  *	@brief		Checks if file exists
- *	@details
+ *	@details	For an https:// URL the server is asked with a HEAD request.
  *
  *	@param		PwszFileName	File name
  *	@retval		TRUE			If file exists
@@ -642,6 +1233,18 @@ FileIO_Exists(
 		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName))
 			break;
 
+		// A URL exists if the server answers a HEAD request without an error status
+		if (FileIO_IsUrl(PwszFileName))
+		{
+			IfxFileDownload sDownload;
+			if (RC_SUCCESS == FileIO_DownloadInitialize(PwszFileName, &sDownload))
+			{
+				fReturn = (RC_SUCCESS == FileIO_DownloadPerform(&sDownload, TRUE)) ? TRUE : FALSE;
+				FileIO_DownloadRelease(&sDownload);
+			}
+			break;
+		}
+
 		// For fopen operation the file name (wide character string) needs to be converted to multibyte string
 		// Get the required size for the multibyte string.
 		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
@@ -649,7 +1252,7 @@ FileIO_Exists(
 			break;
 
 		// Allocate memory for the multibyte string
-		szFileName = (char*)calloc(sizeFileName + 1, sizeof(char));
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
 		if (NULL == szFileName)
 			break;
 
@@ -670,7 +1273,7 @@ FileIO_Exists(
 	// Cleanup memory
 	if (szFileName != NULL)
 	{
-		free(szFileName);
+		Platform_MemoryFree((void**)&szFileName);
 		szFileName = NULL;
 	}
 
@@ -678,241 +1281,2023 @@ FileIO_Exists(
 }
 
 /**
- *	@brief		Get the file size
- *	@details	Returns the size in bytes of a given file
- *	@param		PpvFileHandle		Handle to an open file
- *	@param		PpullFileSize		The size of the file in bytes
- *	@retval		RC_SUCCESS			The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpvFileHandle or PpullFileSize is NULL
- *	@retval		RC_E_FAIL			An unexpected error occurred.
+ *	@brief		Checks if a path is a directory
+ *	@details
+ *
+ *	@param		PwszPath		Path
+ *	@retval		TRUE			If the path is an existing directory
+ *	@retval		FALSE			Otherwise
  */
 _Check_return_
-unsigned int
-FileIO_GetFileSize(
-	_In_	const void*			PpvFileHandle,
-	_Out_	unsigned long long*	PpullFileSize)
+BOOL
+FileIO_IsDirectory(
+	_In_z_ const wchar_t* PwszPath)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
+	BOOL fReturn = FALSE;
+	char* szPath = NULL;
+	size_t sizePath = 0;
 
 	do
 	{
-		unsigned long long ullFileSize = 0;
-		unsigned long long ullFilePosition = 0;
+		struct stat sStat;
 
-		// Initialize output parameter
-		if (NULL != PpullFileSize)
-			*PpullFileSize = 0;
-
-		// Check parameters
-		if (NULL == PpvFileHandle || NULL == PpullFileSize)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
+		// Check input parameter
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszPath))
 			break;
-		}
 
-		// Get current file pointer position
-		unReturnValue = FileIO_GetPosition(PpvFileHandle, &ullFilePosition);
-		if (RC_SUCCESS != unReturnValue)
+		// For stat operation the path (wide character string) needs to be converted to multibyte string
+		sizePath = wcsrtombs(NULL, &PwszPath, 0, NULL);
+		if ((size_t) - 1 == sizePath)
 			break;
-
-		// Seek to the end of the file
-		if (0 != fseek((FILE*)PpvFileHandle, 0LL, SEEK_END))
-		{
-			unReturnValue = RC_E_FAIL;
+		szPath = (char*)Platform_MemoryAllocateScratch(sizePath + 1);
+		if (NULL == szPath)
 			break;
-		}
-
-		// Get the new file pointer position. This is the size.
-		unReturnValue = FileIO_GetPosition(PpvFileHandle, &ullFileSize);
-		if (RC_SUCCESS != unReturnValue)
+		sizePath = wcsrtombs(szPath, &PwszPath, sizePath, NULL);
+		if ((size_t) - 1 == sizePath)
 			break;
 
-		// Restore original file pointer position
-		rewind((FILE*)PpvFileHandle);
-
-		// Assign out parameter
-		*PpullFileSize = ullFileSize;
+		if (0 == stat(szPath, &sStat) && S_ISDIR(sStat.st_mode))
+			fReturn = TRUE;
 	}
 	WHILE_FALSE_END;
 
-	return unReturnValue;
+	// Cleanup memory
+	if (szPath != NULL)
+	{
+		Platform_MemoryFree((void**)&szPath);
+		szPath = NULL;
+	}
+
+	return fReturn;
 }
 
 /**
- *	@brief		Read the whole content of a file into a byte array
- *	@details	The function opens, reads and closes the file.
- *				Allocates a buffer with the required size.
- *				and returns the pointer to that buffer.
+ *	@brief		Checks if a file can be written without creating or opening it
+ *	@details	Checks the access rights of an existing file or, for a file which does not exist yet, of its directory.
  *
- *	@param		PwszFileName		String containing the file to be read
- *	@param		PprgbBuffer			Pointer to a byte array which receives
- *									the allocated memory for the buffer.
- *	@param		PpunBufferSize		Number of bytes read to the buffer.
- *	@retval		RC_SUCCESS			The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly. Or the file was too large.
- *	@retval		RC_E_FAIL			An unexpected error occurred.
+ *	@param		PwszFileName			File name
+ *	@retval		RC_SUCCESS				The file can be written or created.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND		The directory of the file does not exist.
+ *	@retval		RC_E_ACCESS_DENIED		The file or its directory is not writable or the file is a directory.
  */
 _Check_return_
 unsigned int
-FileIO_ReadFileToBuffer(
-	_In_z_						const wchar_t*	PwszFileName,
-	_Outptr_result_maybenull_	BYTE**			PprgbBuffer,
-	_Out_						unsigned int*	PpunBufferSize)
+FileIO_CheckWritable(
+	_In_z_ const wchar_t* PwszFileName)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	FILE* pFile = NULL;
+	unsigned int unReturnValue = RC_E_BAD_PARAMETER;
+	char* szFileName = NULL;
+	size_t sizeFileName = 0;
 
 	do
 	{
-		unsigned long long ullFileSize = 0;
+		struct stat sStat;
+		char* szSeparator = NULL;
 
-		// Check parameters
-		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PpunBufferSize || NULL == PprgbBuffer || NULL != *PprgbBuffer)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
+		// Check input parameter
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName))
 			break;
-		}
 
-		// First open the file
-		unReturnValue = FileIO_Open(PwszFileName, (void**)(&pFile), FILE_READ_BINARY);
-		if (RC_SUCCESS != unReturnValue)
+		// For the access check the file name (wide character string) needs to be converted to multibyte string
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName)
 			break;
-		if (NULL == pFile)
+		// Leave space for the directory "." of a file name without path
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 2);
+		if (NULL == szFileName)
 		{
 			unReturnValue = RC_E_FAIL;
 			break;
 		}
+		sizeFileName = wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+		szFileName[sizeFileName] = '\0';
 
-		// Second get the file size
-		unReturnValue = FileIO_GetFileSize(pFile, &ullFileSize);
-		if (RC_SUCCESS != unReturnValue)
+		// An existing file must be writable by the effective user
+		if (0 == stat(szFileName, &sStat))
+		{
+			unReturnValue = (!S_ISDIR(sStat.st_mode) && 0 == faccessat(AT_FDCWD, szFileName, W_OK, AT_EACCESS)) ?
+							RC_SUCCESS : RC_E_ACCESS_DENIED;
 			break;
-		if (UINT_MAX < ullFileSize) // Memory allocation can only handle limited size
+		}
+		if (ENOENT != errno)
 		{
-			unReturnValue = RC_E_BAD_PARAMETER;
+			unReturnValue = ENOTDIR == errno ? RC_E_FILE_NOT_FOUND : RC_E_ACCESS_DENIED;
 			break;
 		}
 
-		// Third allocate memory
-		*PprgbBuffer = (BYTE*)Platform_MemoryAllocateZero((unsigned int)ullFileSize);
-		if (NULL == *PprgbBuffer)
+		// A new file is created in its directory
+		szSeparator = strrchr(szFileName, '/');
+		if (NULL == szSeparator)
 		{
-			unReturnValue = RC_E_FAIL;
+			szFileName[0] = '.';
+			szFileName[1] = '\0';
+		}
+		else
+		{
+			szSeparator[szSeparator == szFileName ? 1 : 0] = '\0';
+		}
+		if (0 != stat(szFileName, &sStat) || !S_ISDIR(sStat.st_mode))
+		{
+			unReturnValue = RC_E_FILE_NOT_FOUND;
 			break;
 		}
+		unReturnValue = 0 == faccessat(AT_FDCWD, szFileName, W_OK | X_OK, AT_EACCESS) ? RC_SUCCESS : RC_E_ACCESS_DENIED;
+	}
+	WHILE_FALSE_END;
 
-		// Fourth read the whole file
-		*PpunBufferSize = (unsigned int)fread(*PprgbBuffer, (size_t)1, (size_t)ullFileSize, pFile);
-		if (0 == *PpunBufferSize && 0 != ferror(pFile))
+	// Cleanup memory
+	if (szFileName != NULL)
+	{
+		Platform_MemoryFree((void**)&szFileName);
+		szFileName = NULL;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Lists the files of a directory
+ *	@details	Returns the names of the regular files in the directory sorted in ascending order. Each name is zero
+ *				terminated and directly followed by the next one. Subdirectories and hidden files are skipped.
+ *
+ *	@param		PwszDirectoryName		Directory name
+ *	@param		PwszFileNames			Buffer receiving the file names
+ *	@param		PpunFileNamesSize		IN: Capacity of PwszFileNames in wide characters
+ *										OUT: Number of wide characters written to PwszFileNames
+ *	@param		PpunFileCount			Receives the number of file names
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FILE_NOT_FOUND		The directory does not exist.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszFileNames is too small to hold all file names.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ListDirectory(
+	_In_z_							const wchar_t*	PwszDirectoryName,
+	_Out_z_cap_(*PpunFileNamesSize)	wchar_t*		PwszFileNames,
+	_Inout_							unsigned int*	PpunFileNamesSize,
+	_Out_							unsigned int*	PpunFileCount)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szDirectoryName = NULL;
+	struct dirent** rgpsEntries = NULL;
+	int nEntryCount = 0;
+
+	do
+	{
+		size_t sizeDirectoryName = 0;
+		unsigned int unWritten = 0;
+		int nEntry = 0;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszDirectoryName) || NULL == PwszFileNames || NULL == PpunFileNamesSize || 0 == *PpunFileNamesSize || NULL == PpunFileCount)
 		{
-			unReturnValue = RC_E_FAIL;
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
-		// Check that the whole file was read.
-		if (*PpunBufferSize != ullFileSize)
+		// Initialize output parameters
+		PwszFileNames[0] = L'\0';
+		*PpunFileCount = 0;
+
+		// For scandir operation the directory name (wide character string) needs to be converted to multibyte string
+		sizeDirectoryName = wcsrtombs(NULL, &PwszDirectoryName, 0, NULL);
+		if ((size_t) - 1 == sizeDirectoryName)
+			break;
+		szDirectoryName = (char*)Platform_MemoryAllocateScratch(sizeDirectoryName + 1);
+		if (NULL == szDirectoryName)
+			break;
+		sizeDirectoryName = wcsrtombs(szDirectoryName, &PwszDirectoryName, sizeDirectoryName, NULL);
+		if ((size_t) - 1 == sizeDirectoryName)
+			break;
+
+		nEntryCount = scandir(szDirectoryName, &rgpsEntries, NULL, alphasort);
+		if (0 > nEntryCount)
 		{
-			unReturnValue = RC_E_FAIL;
+			nEntryCount = 0;
+			unReturnValue = (ENOENT == errno || ENOTDIR == errno) ? RC_E_FILE_NOT_FOUND : RC_E_FAIL;
 			break;
 		}
 
 		unReturnValue = RC_SUCCESS;
+		for (nEntry = 0; nEntry < nEntryCount; nEntry++)
+		{
+			const char* szFileName = rgpsEntries[nEntry]->d_name;
+			size_t sizeFileName = 0;
+			struct stat sStat;
+			BOOL fRegular = FALSE;
+
+			if ('.' == szFileName[0])
+				continue;
+
+			// Resolve the entry type with stat if the file system does not report it or the entry is a symbolic link
+			if (DT_UNKNOWN == rgpsEntries[nEntry]->d_type || DT_LNK == rgpsEntries[nEntry]->d_type)
+			{
+				size_t sizeFilePath = sizeDirectoryName + strlen(szFileName) + 2;
+				char* szFilePath = (char*)Platform_MemoryAllocateScratch(sizeFilePath);
+				if (NULL == szFilePath)
+				{
+					unReturnValue = RC_E_FAIL;
+					break;
+				}
+				IGNORE_RETURN_VALUE(snprintf(szFilePath, sizeFilePath, "%s/%s", szDirectoryName, szFileName));
+				fRegular = (0 == stat(szFilePath, &sStat) && S_ISREG(sStat.st_mode)) ? TRUE : FALSE;
+				Platform_MemoryFree((void**)&szFilePath);
+			}
+			else
+				fRegular = (DT_REG == rgpsEntries[nEntry]->d_type) ? TRUE : FALSE;
+			if (FALSE == fRegular)
+				continue;
+
+			// Convert the file name and append it including the terminating zero
+			sizeFileName = mbstowcs(NULL, szFileName, 0);
+			if ((size_t) - 1 == sizeFileName)
+				continue;
+			if (sizeFileName + 1 > *PpunFileNamesSize - unWritten)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				break;
+			}
+			IGNORE_RETURN_VALUE(mbstowcs(PwszFileNames + unWritten, szFileName, sizeFileName + 1));
+			unWritten += (unsigned int)sizeFileName + 1;
+			(*PpunFileCount)++;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		*PpunFileNamesSize = unWritten;
 	}
 	WHILE_FALSE_END;
 
-	// Check if the file pointer is not NULL and close the file, but do not overwrite previous error code if existing
-	if (NULL != pFile)
+	// Cleanup memory
+	if (NULL != rgpsEntries)
 	{
-		unsigned int unReturnValueClose = RC_E_FAIL;
-		unReturnValueClose = FileIO_Close((void**)&pFile);
-		if (RC_SUCCESS != unReturnValueClose)
-		{
-			if (RC_SUCCESS == unReturnValue)
-				unReturnValue = unReturnValueClose;
-		}
+		int nEntry = 0;
+		for (nEntry = 0; nEntry < nEntryCount; nEntry++)
+			free(rgpsEntries[nEntry]);
+		free(rgpsEntries);
 	}
-
-	// If an error occurs free the buffer if allocated before
-	if (RC_SUCCESS != unReturnValue)
+	if (szDirectoryName != NULL)
 	{
-		Platform_MemoryFree((void**)PprgbBuffer);
-
-		// Reset out parameter
-		if (NULL != PpunBufferSize)
-			*PpunBufferSize = 0;
+		Platform_MemoryFree((void**)&szDirectoryName);
+		szDirectoryName = NULL;
 	}
 
 	return unReturnValue;
 }
 
 /**
- *	@brief		Read the whole content of a file into a wide char array
- *	@details	The function opens, reads and closes the file.
- *				Allocates a buffer with the required size.
- *				and returns the pointer to that buffer.
+ *	@brief		Lists the paths matching a wildcard pattern
+ *	@details	Expands the wildcards *, ? and [...] of the pattern like a shell and returns the matching paths sorted in
+ *				ascending order. Each path is zero terminated and directly followed by the next one.
  *
- *	@param		PwszFileName		String containing the file to be read
- *	@param		PpwszBuffer			Pointer to a wide char array which receives
- *									the allocated memory for the buffer. The caller must free the allocated buffer!
- *									The value behind the pointer must be initialized to zero.
- *	@param		PpunBufferSize		Number of wide chars read to the buffer. Without zero termination.
- *									Value behind the pointer must be initialized to zero.
- *	@retval		RC_SUCCESS			The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly. Or the file was too large.
- *	@retval		RC_E_FAIL			An unexpected error occurred.
- *	@retval		RC_E_WRONG_ENCODING	In case file is not in UCS-2 LE encoding
+ *	@param		PwszPattern				Path pattern
+ *	@param		PwszPaths				Buffer receiving the paths
+ *	@param		PpunPathsSize			IN: Capacity of PwszPaths in wide characters
+ *										OUT: Number of wide characters written to PwszPaths
+ *	@param		PpunPathCount			Receives the number of paths
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FILE_NOT_FOUND		No path matches the pattern.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszPaths is too small to hold all paths.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
  */
 _Check_return_
 unsigned int
-FileIO_ReadFileToStringBuffer(
-	_In_z_						const wchar_t*	PwszFileName,
-	_Outptr_result_maybenull_z_	wchar_t**		PpwszBuffer,
-	_Out_						unsigned int*	PpunBufferSize)
+FileIO_ListMatchingPaths(
+	_In_z_						const wchar_t*	PwszPattern,
+	_Out_z_cap_(*PpunPathsSize)	wchar_t*		PwszPaths,
+	_Inout_						unsigned int*	PpunPathsSize,
+	_Out_						unsigned int*	PpunPathCount)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	FILE* pFile = NULL;
-	unsigned char* pbTemp = NULL;
+	char* szPattern = NULL;
+	glob_t sGlob;
+	BOOL fGlobAllocated = FALSE;
 
 	do
 	{
-		unsigned long long ullFileSize = 0;
-		unsigned int unSizeOfBOM = 0;
-		ENUM_BOM_TYPES eBOMType = BOM_TYPES_NO;
+		size_t sizePattern = 0;
+		unsigned int unWritten = 0;
+		size_t sizeIndex = 0;
+		int nResult = 0;
 
 		// Check parameters
-		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PpunBufferSize || NULL == PpwszBuffer || NULL != *PpwszBuffer)
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszPattern) || NULL == PwszPaths || NULL == PpunPathsSize || 0 == *PpunPathsSize || NULL == PpunPathCount)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
-		// First open the file
-		unReturnValue = FileIO_Open(PwszFileName, (void**)(&pFile), FILE_READ);
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		// Initialize output parameters
+		PwszPaths[0] = L'\0';
+		*PpunPathCount = 0;
 
-		if (NULL == pFile)
-		{
-			unReturnValue = RC_E_FAIL;
+		// For glob operation the pattern (wide character string) needs to be converted to multibyte string
+		sizePattern = wcsrtombs(NULL, &PwszPattern, 0, NULL);
+		if ((size_t) - 1 == sizePattern)
 			break;
-		}
-
-		// Second get the file size
-		unReturnValue = FileIO_GetFileSize(pFile, &ullFileSize);
-		if (RC_SUCCESS != unReturnValue)
+		szPattern = (char*)Platform_MemoryAllocateScratch(sizePattern + 1);
+		if (NULL == szPattern)
+			break;
+		sizePattern = wcsrtombs(szPattern, &PwszPattern, sizePattern, NULL);
+		if ((size_t) - 1 == sizePattern)
 			break;
 
-		if (UINT_MAX < ullFileSize + 2) // Memory allocation can only handle limited size (add 2 byte for final zero termination)
+		memset(&sGlob, 0, sizeof(sGlob));
+		nResult = glob(szPattern, 0, NULL, &sGlob);
+		fGlobAllocated = TRUE;
+		if (GLOB_NOMATCH == nResult)
 		{
-			unReturnValue = RC_E_BAD_PARAMETER;
+			unReturnValue = RC_E_FILE_NOT_FOUND;
 			break;
 		}
-
-		unReturnValue = FileIO_GetBOMType(pFile, &eBOMType, &unSizeOfBOM);
-		if (RC_SUCCESS != unReturnValue)
+		if (0 != nResult)
 			break;
 
-		unReturnValue = FileIO_SetPosition(pFile, (unsigned long long) unSizeOfBOM);
+		unReturnValue = RC_SUCCESS;
+		for (sizeIndex = 0; sizeIndex < sGlob.gl_pathc; sizeIndex++)
+		{
+			// Convert the path and append it including the terminating zero
+			size_t sizePath = mbstowcs(NULL, sGlob.gl_pathv[sizeIndex], 0);
+			if ((size_t) - 1 == sizePath)
+				continue;
+			if (sizePath + 1 > *PpunPathsSize - unWritten)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				break;
+			}
+			IGNORE_RETURN_VALUE(mbstowcs(PwszPaths + unWritten, sGlob.gl_pathv[sizeIndex], sizePath + 1));
+			unWritten += (unsigned int)sizePath + 1;
+			(*PpunPathCount)++;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		*PpunPathsSize = unWritten;
+	}
+	WHILE_FALSE_END;
+
+	// Cleanup memory
+	if (fGlobAllocated)
+		globfree(&sGlob);
+	if (szPattern != NULL)
+	{
+		Platform_MemoryFree((void**)&szPattern);
+		szPattern = NULL;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Get the file size
+ *	@details	Returns the size in bytes of a given file
+ *	@param		PpvFileHandle		Handle to an open file
+ *	@param		PpullFileSize		The size of the file in bytes
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpvFileHandle or PpullFileSize is NULL
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_GetFileSize(
+	_In_	const void*			PpvFileHandle,
+	_Out_	unsigned long long*	PpullFileSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned long long ullFileSize = 0;
+		unsigned long long ullFilePosition = 0;
+
+		// Initialize output parameter
+		if (NULL != PpullFileSize)
+			*PpullFileSize = 0;
+
+		// Check parameters
+		if (NULL == PpvFileHandle || NULL == PpullFileSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Get current file pointer position
+		unReturnValue = FileIO_GetPosition(PpvFileHandle, &ullFilePosition);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Seek to the end of the file
+		if (0 != fseek((FILE*)PpvFileHandle, 0LL, SEEK_END))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Get the new file pointer position. This is the size.
+		unReturnValue = FileIO_GetPosition(PpvFileHandle, &ullFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Restore original file pointer position
+		rewind((FILE*)PpvFileHandle);
+
+		// Assign out parameter
+		*PpullFileSize = ullFileSize;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Get the status of a file
+ *	@details	Returns size and modification time of a given file and whether it is private to the effective user,
+ *				i.e. owned by the effective user and neither writable by the group nor by others.
+ *	@param		PwszFileName			File name
+ *	@param		PpullFileSize			The size of the file in bytes
+ *	@param		PpullModificationTime	The modification time of the file in nanoseconds since the epoch
+ *	@param		PpfPrivate				TRUE if the file is private to the effective user, FALSE otherwise
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FILE_NOT_FOUND		The file does not exist.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_GetFileStatus(
+	_In_z_	const wchar_t*			PwszFileName,
+	_Out_	unsigned long long*		PpullFileSize,
+	_Out_	unsigned long long*		PpullModificationTime,
+	_Out_	BOOL*					PpfPrivate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+
+	do
+	{
+		size_t sizeFileName = 0;
+		struct stat sStat;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PpullFileSize || NULL == PpullModificationTime || NULL == PpfPrivate)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Initialize output parameters
+		*PpullFileSize = 0;
+		*PpullModificationTime = 0;
+		*PpfPrivate = FALSE;
+
+		// For stat operation the file name (wide character string) needs to be converted to multibyte string
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		if (NULL == szFileName)
+			break;
+		sizeFileName = wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+
+		if (0 != stat(szFileName, &sStat))
+		{
+			unReturnValue = (ENOENT == errno) ? RC_E_FILE_NOT_FOUND : RC_E_FAIL;
+			break;
+		}
+
+		*PpullFileSize = (unsigned long long)sStat.st_size;
+		*PpullModificationTime = (unsigned long long)sStat.st_mtim.tv_sec * 1000000000ULL + (unsigned long long)sStat.st_mtim.tv_nsec;
+		*PpfPrivate = (S_ISREG(sStat.st_mode) && geteuid() == sStat.st_uid && 0 == (sStat.st_mode & (S_IWGRP | S_IWOTH))) ? TRUE : FALSE;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Cleanup memory
+	if (szFileName != NULL)
+	{
+		Platform_MemoryFree((void**)&szFileName);
+		szFileName = NULL;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read the whole content of a file into a byte array
+ *	@details	The function opens, reads and closes the file.
+ *				Allocates a buffer with the required size.
+ *				and returns the pointer to that buffer.
+ *
+ *	@param		PwszFileName		String containing the file to be read
+ *	@param		PprgbBuffer			Pointer to a byte array which receives
+ *									the allocated memory for the buffer.
+ *	@param		PpunBufferSize		Number of bytes read to the buffer.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly. Or the file was too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadFileToBuffer(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer,
+	_Out_						unsigned int*	PpunBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	FILE* pFile = NULL;
+
+	do
+	{
+		unsigned long long ullFileSize = 0;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PpunBufferSize || NULL == PprgbBuffer || NULL != *PprgbBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// First open the file
+		unReturnValue = FileIO_Open(PwszFileName, (void**)(&pFile), FILE_READ_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (NULL == pFile)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Second get the file size
+		unReturnValue = FileIO_GetFileSize(pFile, &ullFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (UINT_MAX < ullFileSize) // Memory allocation can only handle limited size
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Third allocate memory
+		*PprgbBuffer = (BYTE*)Platform_MemoryAllocateZero((unsigned int)ullFileSize);
+		if (NULL == *PprgbBuffer)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Fourth read the whole file
+		*PpunBufferSize = (unsigned int)fread(*PprgbBuffer, (size_t)1, (size_t)ullFileSize, pFile);
+		if (0 == *PpunBufferSize && 0 != ferror(pFile))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Check that the whole file was read.
+		if (*PpunBufferSize != ullFileSize)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Check if the file pointer is not NULL and close the file, but do not overwrite previous error code if existing
+	if (NULL != pFile)
+	{
+		unsigned int unReturnValueClose = RC_E_FAIL;
+		unReturnValueClose = FileIO_Close((void**)&pFile);
+		if (RC_SUCCESS != unReturnValueClose)
+		{
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = unReturnValueClose;
+		}
+	}
+
+	// If an error occurs free the buffer if allocated before
+	if (RC_SUCCESS != unReturnValue)
+	{
+		Platform_MemoryFree((void**)PprgbBuffer);
+
+		// Reset out parameter
+		if (NULL != PpunBufferSize)
+			*PpunBufferSize = 0;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Load the whole content of a file into private memory
+ *	@details	The file is read with read() into an anonymous mapping, which is made read-only afterwards. The buffer is a
+ *				private copy: a later write to or truncation of the file changes neither the checked content nor raises
+ *				SIGBUS on access, unlike a mapping of the file itself. A file which shrinks while it is read fails. The
+ *				caller must not modify the buffer. If no anonymous mapping can be created (e.g. for an empty file) the
+ *				function falls back to FileIO_ReadFileToBuffer. An https:// URL is downloaded into an allocated buffer,
+ *				see FileIO_StartDownload. The buffer must be released with FileIO_ReleaseFileBuffer.
+ *
+ *	@param		PwszFileName		String containing the file to be loaded
+ *	@param		PprgbBuffer			Pointer to a byte array which receives the mapped or allocated buffer.
+ *	@param		PpunBufferSize		Number of bytes in the buffer.
+ *	@param		PpfMapped			Receives TRUE if the buffer is an anonymous mapping holding the file, FALSE if it was allocated.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly. Or the file was too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_MapFileToBuffer(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer,
+	_Out_						unsigned int*	PpunBufferSize,
+	_Out_						BOOL*			PpfMapped)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	FILE* pFile = NULL;
+
+	do
+	{
+		unsigned long long ullFileSize = 0;
+		unsigned int unRead = 0;
+		void* pvMapping = NULL;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PpunBufferSize || NULL == PprgbBuffer || NULL != *PprgbBuffer || NULL == PpfMapped)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		*PpfMapped = FALSE;
+
+		// A URL is downloaded into an allocated buffer
+		if (FileIO_IsUrl(PwszFileName))
+		{
+			unReturnValue = FileIO_DownloadToBuffer(PwszFileName, PprgbBuffer, PpunBufferSize);
+			break;
+		}
+
+		unReturnValue = FileIO_Open(PwszFileName, (void**)(&pFile), FILE_READ_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (NULL == pFile)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		unReturnValue = FileIO_GetFileSize(pFile, &ullFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (UINT_MAX < ullFileSize) // Buffer size can only handle limited size
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// The content is copied, a mapping of the file itself would follow later changes of the file after the checks
+		if (0 != ullFileSize)
+			pvMapping = mmap(NULL, (size_t)ullFileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (NULL == pvMapping || MAP_FAILED == pvMapping)
+		{
+			IGNORE_RETURN_VALUE(FileIO_Close((void**)&pFile));
+			unReturnValue = FileIO_ReadFileToBuffer(PwszFileName, PprgbBuffer, PpunBufferSize);
+			break;
+		}
+		*PprgbBuffer = (BYTE*)pvMapping;
+		*PpunBufferSize = (unsigned int)ullFileSize;
+		*PpfMapped = TRUE;
+
+		// The file is read front to back, let the kernel read ahead
+		IGNORE_RETURN_VALUE(posix_fadvise(fileno(pFile), 0, 0, POSIX_FADV_SEQUENTIAL));
+		while (unRead < *PpunBufferSize)
+		{
+			ssize_t nRead = pread(fileno(pFile), *PprgbBuffer + unRead, *PpunBufferSize - unRead, (off_t)unRead);
+			if (nRead == -1 && EINTR == errno)
+				continue;
+			if (nRead <= 0)
+				break;
+			unRead += (unsigned int)nRead;
+		}
+		if (unRead != *PpunBufferSize)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Protect the loaded content like the read-only file mapping the callers expect
+		IGNORE_RETURN_VALUE(mprotect(pvMapping, (size_t)ullFileSize, PROT_READ));
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Check if the file pointer is not NULL and close the file, but do not overwrite previous error code if existing
+	if (NULL != pFile)
+	{
+		unsigned int unReturnValueClose = RC_E_FAIL;
+		unReturnValueClose = FileIO_Close((void**)&pFile);
+		if (RC_SUCCESS != unReturnValueClose)
+		{
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = unReturnValueClose;
+		}
+	}
+
+	// If an error occurs release the buffer if mapped or allocated before
+	if (RC_SUCCESS != unReturnValue && NULL != PprgbBuffer && NULL != PpunBufferSize && NULL != PpfMapped)
+	{
+		FileIO_ReleaseFileBuffer(PprgbBuffer, *PpunBufferSize, *PpfMapped);
+
+		// Reset out parameters
+		*PpunBufferSize = 0;
+		*PpfMapped = FALSE;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Release a buffer returned by FileIO_MapFileToBuffer
+ *	@details	Unmaps a file mapping or frees an allocated buffer and sets the buffer pointer to NULL.
+ *
+ *	@param		PprgbBuffer			Pointer to the buffer to release
+ *	@param		PunBufferSize		Number of bytes in the buffer
+ *	@param		PfMapped			TRUE if the buffer is a mapping, FALSE if it was allocated
+ */
+void
+FileIO_ReleaseFileBuffer(
+	_Inout_	BYTE**			PprgbBuffer,
+	_In_	unsigned int	PunBufferSize,
+	_In_	BOOL			PfMapped)
+{
+	if (NULL != PprgbBuffer && NULL != *PprgbBuffer)
+	{
+		if (PfMapped)
+		{
+			IGNORE_RETURN_VALUE(munmap(*PprgbBuffer, (size_t)PunBufferSize));
+			*PprgbBuffer = NULL;
+		}
+		else
+			Platform_MemoryFree((void**)PprgbBuffer);
+	}
+}
+
+/**
+ *	@brief		Drop the resident pages of a buffer returned by FileIO_MapFileToBuffer
+ *	@details	The pages of a loaded file are paged out where the kernel supports it (MADV_PAGEOUT), the buffer stays valid
+ *				and is paged in again when it is accessed. Nothing is done for an allocated buffer.
+ *
+ *	@param		PrgbBuffer			Buffer returned by FileIO_MapFileToBuffer
+ *	@param		PunBufferSize		Number of bytes in the buffer
+ *	@param		PfMapped			TRUE if the buffer is a mapping, FALSE if it was allocated
+ */
+void
+FileIO_DiscardFileBuffer(
+	_In_	const BYTE*		PrgbBuffer,
+	_In_	unsigned int	PunBufferSize,
+	_In_	BOOL			PfMapped)
+{
+	// The buffer is anonymous memory, MADV_DONTNEED would zero it. MADV_PAGEOUT moves the pages to swap and keeps the content.
+#ifdef MADV_PAGEOUT
+	if (NULL != PrgbBuffer && 0 != PunBufferSize && PfMapped)
+		IGNORE_RETURN_VALUE(madvise((void*)PrgbBuffer, (size_t)PunBufferSize, MADV_PAGEOUT));
+#else
+	UNREFERENCED_PARAMETER(PrgbBuffer);
+	UNREFERENCED_PARAMETER(PunBufferSize);
+	UNREFERENCED_PARAMETER(PfMapped);
+#endif
+}
+
+/**
+ *	@brief		Map a file of a fixed size writable into memory
+ *	@details	The file is created if it does not exist and resized to PunBufferSize bytes. The mapping is shared, so stores
+ *				to the buffer are visible to other processes mapping the same file without any further system call. The
+ *				buffer must be released with FileIO_ReleaseFileBuffer (PfMapped TRUE), the file content is kept.
+ *
+ *	@param		PwszFileName		String containing the file to be mapped
+ *	@param		PunBufferSize		Size of the file and the buffer in bytes
+ *	@param		PprgbBuffer			Pointer to a byte array which receives the mapped buffer.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			An unexpected error occurred, e.g. the file could not be created or mapped.
+ */
+_Check_return_
+unsigned int
+FileIO_MapSharedFile(
+	_In_z_						const wchar_t*	PwszFileName,
+	_In_						unsigned int	PunBufferSize,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+	int nFile = -1;
+
+	do
+	{
+		size_t sizeFileName = 0;
+		void* pvMapping = NULL;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || 0 == PunBufferSize || NULL == PprgbBuffer || NULL != *PprgbBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// For open operation the file name (wide character string) needs to be converted to multibyte string
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		if (NULL == szFileName)
+			break;
+		sizeFileName = wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+
+		// Do not truncate an existing file first, a reader mapping it would fault on the vanished pages
+		nFile = open(szFileName, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (-1 == nFile)
+			break;
+		if (0 != ftruncate(nFile, (off_t)PunBufferSize))
+			break;
+
+		// The mapping stays valid after the file has been closed
+		pvMapping = mmap(NULL, (size_t)PunBufferSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFile, 0);
+		if (MAP_FAILED == pvMapping)
+			break;
+
+		*PprgbBuffer = (BYTE*)pvMapping;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nFile)
+		IGNORE_RETURN_VALUE(close(nFile));
+	Platform_MemoryFree((void**)&szFileName);
+
+	return unReturnValue;
+}
+
+/// Shared memory object opened by FileIO_OpenSharedMemory
+typedef struct tdIfxSharedMemory
+{
+	/// File descriptor of the POSIX shared memory object
+	int nFile;
+} IfxSharedMemory;
+
+/**
+ *	@brief		Convert the name of a POSIX shared memory object to a multibyte string
+ *
+ *	@param		PwszName			Name of the shared memory object, must start with a slash
+ *	@param		PszName				Receives the converted name
+ *	@param		PunNameSize			Capacity of PszName in bytes
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The name is empty, does not start with a slash or is too long.
+ */
+_Check_return_
+static unsigned int
+FileIO_GetSharedMemoryName(
+	_In_z_						const wchar_t*	PwszName,
+	_Out_cap_(PunNameSize)		char*			PszName,
+	_In_						unsigned int	PunNameSize)
+{
+	size_t sizeName = 0;
+
+	if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszName) || L'/' != PwszName[0] || NULL != wcschr(PwszName + 1, L'/'))
+		return RC_E_BAD_PARAMETER;
+
+	sizeName = wcstombs(PszName, PwszName, PunNameSize);
+	if ((size_t) - 1 == sizeName || sizeName >= PunNameSize)
+		return RC_E_BAD_PARAMETER;
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Create or open a POSIX shared memory object
+ *	@details	A created object is private to the effective user and must not exist yet. The creating handle holds an
+ *				exclusive lock on the object until it is closed, so processes opening the object can wait with
+ *				FileIO_WaitSharedMemory until the creator has filled it. An object is only opened (read-only) if it is
+ *				private to the effective user, so nobody else can plant its content. The handle must be closed with
+ *				FileIO_CloseSharedMemory, the object stays until it is removed with FileIO_RemoveSharedMemory.
+ *
+ *	@param		PwszName			Name of the shared memory object, must start with a slash
+ *	@param		PfCreate			TRUE to create the object, FALSE to open an existing object read-only
+ *	@param		PppvSharedMemory	Receives the shared memory handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_EXISTS	The object to be created exists already.
+ *	@retval		RC_E_FILE_NOT_FOUND	The object to be opened does not exist.
+ *	@retval		RC_E_ACCESS_DENIED	The object is not private to the effective user.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_OpenSharedMemory(
+	_In_z_						const wchar_t*	PwszName,
+	_In_						BOOL			PfCreate,
+	_Outptr_result_maybenull_	void**			PppvSharedMemory)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	int nFile = -1;
+
+	do
+	{
+		char szName[MAX_NAME] = {0};
+		struct stat sStat;
+		IfxSharedMemory* pSharedMemory = NULL;
+
+		// Check parameters
+		if (NULL == PppvSharedMemory)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvSharedMemory = NULL;
+
+		unReturnValue = FileIO_GetSharedMemoryName(PwszName, szName, sizeof(szName));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = RC_E_FAIL;
+
+		if (PfCreate)
+		{
+			nFile = shm_open(szName, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+			if (-1 == nFile)
+			{
+				unReturnValue = EEXIST == errno ? RC_E_FILE_EXISTS : RC_E_FAIL;
+				break;
+			}
+			// Nobody else holds the new object, so the lock is granted immediately
+			if (0 != flock(nFile, LOCK_EX))
+			{
+				IGNORE_RETURN_VALUE(shm_unlink(szName));
+				break;
+			}
+		}
+		else
+		{
+			nFile = shm_open(szName, O_RDONLY | O_CLOEXEC, 0);
+			if (-1 == nFile)
+			{
+				unReturnValue = ENOENT == errno ? RC_E_FILE_NOT_FOUND : RC_E_FAIL;
+				break;
+			}
+			if (0 != fstat(nFile, &sStat))
+				break;
+			if (geteuid() != sStat.st_uid || 0 != (sStat.st_mode & (S_IRWXG | S_IRWXO)))
+			{
+				unReturnValue = RC_E_ACCESS_DENIED;
+				break;
+			}
+		}
+
+		pSharedMemory = (IfxSharedMemory*)Platform_MemoryAllocateZero(sizeof(IfxSharedMemory));
+		if (NULL == pSharedMemory)
+			break;
+		pSharedMemory->nFile = nFile;
+		nFile = -1;
+		*PppvSharedMemory = pSharedMemory;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nFile)
+		IGNORE_RETURN_VALUE(close(nFile));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Wait until the creator of a shared memory object has closed its handle
+ *	@details	Returns immediately for an object whose creator has already closed its handle or has exited.
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory
+ *	@param		PunTimeoutMs		Maximum time to wait in milliseconds
+ *	@retval		RC_SUCCESS					The creator has closed its handle.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND			The object has been removed in the meantime.
+ *	@retval		RC_E_DEVICE_ALREADY_IN_USE	The creator still holds the object when the timeout expired.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_WaitSharedMemory(
+	_In_	void*			PpvSharedMemory,
+	_In_	unsigned int	PunTimeoutMs)
+{
+	IfxSharedMemory* pSharedMemory = (IfxSharedMemory*)PpvSharedMemory;
+	unsigned int unWaited = 0;
+	struct stat sStat;
+
+	if (NULL == pSharedMemory)
+		return RC_E_BAD_PARAMETER;
+
+	while (0 != flock(pSharedMemory->nFile, LOCK_SH | LOCK_NB))
+	{
+		if (EWOULDBLOCK != errno && EINTR != errno)
+			return RC_E_FAIL;
+		if (unWaited >= PunTimeoutMs)
+			return RC_E_DEVICE_ALREADY_IN_USE;
+		Platform_Sleep(FILEIO_SHARED_MEMORY_POLL_INTERVAL);
+		unWaited += FILEIO_SHARED_MEMORY_POLL_INTERVAL;
+	}
+	IGNORE_RETURN_VALUE(flock(pSharedMemory->nFile, LOCK_UN));
+
+	// A creator which gave up removes the object
+	if (0 != fstat(pSharedMemory->nFile, &sStat))
+		return RC_E_FAIL;
+
+	return 0 == sStat.st_nlink ? RC_E_FILE_NOT_FOUND : RC_SUCCESS;
+}
+
+/**
+ *	@brief		Read from a shared memory object
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory
+ *	@param		PunOffset			Offset in the object
+ *	@param		PrgbBuffer			Receives the data
+ *	@param		PunSize				Number of bytes to read
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	The object ends before the requested range.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadSharedMemory(
+	_In_						void*			PpvSharedMemory,
+	_In_						unsigned int	PunOffset,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbBuffer,
+	_In_						unsigned int	PunSize)
+{
+	IfxSharedMemory* pSharedMemory = (IfxSharedMemory*)PpvSharedMemory;
+	ssize_t nRead = 0;
+
+	if (NULL == pSharedMemory || NULL == PrgbBuffer)
+		return RC_E_BAD_PARAMETER;
+
+	while (0 != PunSize)
+	{
+		nRead = pread(pSharedMemory->nFile, PrgbBuffer, PunSize, (off_t)PunOffset);
+		if (-1 == nRead && EINTR == errno)
+			continue;
+		if (-1 == nRead)
+			return RC_E_FAIL;
+		if (0 == nRead)
+			return RC_E_END_OF_FILE;
+		PrgbBuffer += nRead;
+		PunOffset += (unsigned int)nRead;
+		PunSize -= (unsigned int)nRead;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Write to a shared memory object created by FileIO_OpenSharedMemory
+ *	@details	The object grows as needed, a gap in front of the written range reads as zeros.
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory with PfCreate TRUE
+ *	@param		PunOffset			Offset in the object
+ *	@param		PrgbBuffer			Data to write
+ *	@param		PunSize				Number of bytes to write
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			An unexpected error occurred, e.g. the shared memory file system is full.
+ */
+_Check_return_
+unsigned int
+FileIO_WriteSharedMemory(
+	_In_						void*			PpvSharedMemory,
+	_In_						unsigned int	PunOffset,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbBuffer,
+	_In_						unsigned int	PunSize)
+{
+	IfxSharedMemory* pSharedMemory = (IfxSharedMemory*)PpvSharedMemory;
+	ssize_t nWritten = 0;
+
+	if (NULL == pSharedMemory || NULL == PrgbBuffer)
+		return RC_E_BAD_PARAMETER;
+
+	while (0 != PunSize)
+	{
+		nWritten = pwrite(pSharedMemory->nFile, PrgbBuffer, PunSize, (off_t)PunOffset);
+		if (-1 == nWritten && EINTR == errno)
+			continue;
+		if (-1 == nWritten || 0 == nWritten)
+			return RC_E_FAIL;
+		PrgbBuffer += nWritten;
+		PunOffset += (unsigned int)nWritten;
+		PunSize -= (unsigned int)nWritten;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Map a range of a shared memory object read-only into memory
+ *	@details	All processes mapping the object share its pages. The buffer must be released with FileIO_ReleaseFileBuffer
+ *				(PfMapped TRUE) and stays valid after the handle has been closed and the object has been removed.
+ *
+ *	@param		PpvSharedMemory		Shared memory handle returned by FileIO_OpenSharedMemory
+ *	@param		PunOffset			Offset in the object, must be a multiple of the page size
+ *	@param		PunSize				Number of bytes to map
+ *	@param		PprgbBuffer			Receives the mapped buffer
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	The object ends before the requested range.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_MapSharedMemory(
+	_In_						void*			PpvSharedMemory,
+	_In_						unsigned int	PunOffset,
+	_In_						unsigned int	PunSize,
+	_Outptr_result_maybenull_	BYTE**			PprgbBuffer)
+{
+	IfxSharedMemory* pSharedMemory = (IfxSharedMemory*)PpvSharedMemory;
+	void* pvMapping = NULL;
+	struct stat sStat;
+
+	if (NULL == pSharedMemory || 0 == PunSize || NULL == PprgbBuffer || NULL != *PprgbBuffer)
+		return RC_E_BAD_PARAMETER;
+
+	// Pages behind the end of the object would fault on access
+	if (0 != fstat(pSharedMemory->nFile, &sStat))
+		return RC_E_FAIL;
+	if ((unsigned long long)sStat.st_size < (unsigned long long)PunOffset + PunSize)
+		return RC_E_END_OF_FILE;
+
+	pvMapping = mmap(NULL, (size_t)PunSize, PROT_READ, MAP_SHARED, pSharedMemory->nFile, (off_t)PunOffset);
+	if (MAP_FAILED == pvMapping)
+		return EINVAL == errno ? RC_E_BAD_PARAMETER : RC_E_FAIL;
+
+	*PprgbBuffer = (BYTE*)pvMapping;
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Remove a POSIX shared memory object
+ *	@details	Processes which opened or mapped the object keep their handles and mappings.
+ *
+ *	@param		PwszName			Name of the shared memory object, must start with a slash
+ */
+void
+FileIO_RemoveSharedMemory(
+	_In_z_	const wchar_t*	PwszName)
+{
+	char szName[MAX_NAME] = {0};
+
+	if (RC_SUCCESS == FileIO_GetSharedMemoryName(PwszName, szName, sizeof(szName)))
+		IGNORE_RETURN_VALUE(shm_unlink(szName));
+}
+
+/**
+ *	@brief		Close a shared memory handle opened by FileIO_OpenSharedMemory
+ *	@details	Releases the lock of a creating handle, the object itself is kept.
+ *
+ *	@param		PppvSharedMemory	Pointer to the shared memory handle. Set to NULL on return.
+ */
+void
+FileIO_CloseSharedMemory(
+	_Inout_ void** PppvSharedMemory)
+{
+	if (NULL == PppvSharedMemory || NULL == *PppvSharedMemory)
+		return;
+
+	IGNORE_RETURN_VALUE(close(((IfxSharedMemory*)*PppvSharedMemory)->nFile));
+	Platform_MemoryFree(PppvSharedMemory);
+}
+
+/// File stream opened by FileIO_OpenStream
+typedef struct tdIfxFileStream
+{
+	/// File descriptor
+	int nFile;
+	/// File offset of the data in rgbReadAhead
+	unsigned int unReadAheadOffset;
+	/// Number of valid bytes in rgbReadAhead
+	unsigned int unReadAheadSize;
+	/// Read-ahead buffer
+	BYTE rgbReadAhead[FILEIO_STREAM_READ_AHEAD_SIZE];
+} IfxFileStream;
+
+/**
+ *	@brief		Refill the read-ahead buffer of a file stream
+ *	@details	A pipe or terminal (e.g. /dev/stdin) cannot be read at an offset, it is read sequentially instead as long as
+ *				the buffer continues the previous one.
+ *
+ *	@param		PpStream			File stream
+ *	@param		PunOffset			Offset in the file the buffer shall start at
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_END_OF_FILE	The offset is at or behind the end of the file.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+static unsigned int
+FileIO_FillStream(
+	_Inout_	IfxFileStream*	PpStream,
+	_In_	unsigned int	PunOffset)
+{
+	ssize_t nRead = 0;
+
+	do
+	{
+		nRead = pread(PpStream->nFile, PpStream->rgbReadAhead, sizeof(PpStream->rgbReadAhead), (off_t)PunOffset);
+		if (-1 == nRead && ESPIPE == errno && PunOffset == PpStream->unReadAheadOffset + PpStream->unReadAheadSize)
+			nRead = read(PpStream->nFile, PpStream->rgbReadAhead, sizeof(PpStream->rgbReadAhead));
+	}
+	while (-1 == nRead && EINTR == errno);
+	if (-1 == nRead)
+		return RC_E_FAIL;
+
+	PpStream->unReadAheadOffset = PunOffset;
+	PpStream->unReadAheadSize = (unsigned int)nRead;
+
+	return 0 == nRead ? RC_E_END_OF_FILE : RC_SUCCESS;
+}
+
+/**
+ *	@brief		Open a file for streamed reading
+ *	@details	The file is read sequentially through a read-ahead buffer of FILEIO_STREAM_READ_AHEAD_SIZE bytes, so only
+ *				that buffer is resident regardless of the file size. The stream must be closed with FileIO_CloseStream.
+ *
+ *	@param		PwszFileName		String containing the file to be read
+ *	@param		PppvStream			Receives the stream handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_OpenStream(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	void**			PppvStream)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+	int nFile = -1;
+
+	do
+	{
+		size_t sizeFileName = 0;
+		IfxFileStream* pStream = NULL;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PppvStream)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvStream = NULL;
+
+		// For open operation the file name (wide character string) needs to be converted to multibyte string
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		if (NULL == szFileName)
+			break;
+		sizeFileName = wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+
+		nFile = open(szFileName, O_RDONLY | O_CLOEXEC);
+		if (-1 == nFile)
+		{
+			unReturnValue = ENOENT == errno ? RC_E_FILE_NOT_FOUND : RC_E_FAIL;
+			break;
+		}
+
+		// The file is read front to back, let the kernel read ahead and drop the pages behind
+		IGNORE_RETURN_VALUE(posix_fadvise(nFile, 0, 0, POSIX_FADV_SEQUENTIAL));
+
+		pStream = (IfxFileStream*)Platform_MemoryAllocateZero(sizeof(IfxFileStream));
+		if (NULL == pStream)
+			break;
+		pStream->nFile = nFile;
+		nFile = -1;
+		*PppvStream = pStream;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nFile)
+		IGNORE_RETURN_VALUE(close(nFile));
+	Platform_MemoryFree((void**)&szFileName);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read from a file stream
+ *	@details	Copies the requested range from the read-ahead buffer. The buffer is refilled from the requested offset if
+ *				the range is not buffered, sequential reads therefore access the file once per buffer size.
+ *
+ *	@param		PpvStream			Stream handle returned by FileIO_OpenStream
+ *	@param		PunOffset			Offset in the file
+ *	@param		PrgbBuffer			Receives the data
+ *	@param		PunSize				Number of bytes to read
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	The file ends before the requested range.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadStream(
+	_In_						void*			PpvStream,
+	_In_						unsigned int	PunOffset,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbBuffer,
+	_In_						unsigned int	PunSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	IfxFileStream* pStream = (IfxFileStream*)PpvStream;
+
+	if (NULL == pStream || NULL == PrgbBuffer)
+		return RC_E_BAD_PARAMETER;
+
+	while (0 != PunSize)
+	{
+		unsigned int unCopySize = 0;
+
+		// Refill the read-ahead buffer at the requested offset if it does not hold it
+		if (PunOffset < pStream->unReadAheadOffset || PunOffset >= pStream->unReadAheadOffset + pStream->unReadAheadSize)
+		{
+			unReturnValue = FileIO_FillStream(pStream, PunOffset);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unCopySize = pStream->unReadAheadOffset + pStream->unReadAheadSize - PunOffset;
+		if (unCopySize > PunSize)
+			unCopySize = PunSize;
+		unReturnValue = Platform_MemoryCopy(PrgbBuffer, PunSize, &pStream->rgbReadAhead[PunOffset - pStream->unReadAheadOffset], unCopySize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		PrgbBuffer += unCopySize;
+		PunOffset += unCopySize;
+		PunSize -= unCopySize;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Close a file stream opened by FileIO_OpenStream
+ *
+ *	@param		PppvStream			Pointer to the stream handle. Set to NULL on return.
+ */
+void
+FileIO_CloseStream(
+	_Inout_ void** PppvStream)
+{
+	if (NULL == PppvStream || NULL == *PppvStream)
+		return;
+
+	IGNORE_RETURN_VALUE(close(((IfxFileStream*)*PppvStream)->nFile));
+	Platform_MemoryFree(PppvStream);
+}
+
+/// Line reader opened by FileIO_OpenLineReader
+typedef struct tdIfxFileLineReader
+{
+	/// File stream providing the read-ahead buffer
+	IfxFileStream* pStream;
+	/// File offset of the next byte to decode
+	unsigned int unOffset;
+	/// Shift state of a multibyte character split across two read-ahead buffers
+	mbstate_t sState;
+} IfxFileLineReader;
+
+/**
+ *	@brief		Open a text file for reading line by line
+ *	@details	Unlike FileIO_ReadLine the byte order mark is detected once, and lines are decoded incrementally from a
+ *				read-ahead buffer of FILEIO_STREAM_READ_AHEAD_SIZE bytes, so the file is only accessed once per buffer
+ *				instead of several times per line. The reader must be closed with FileIO_CloseLineReader.
+ *
+ *	@param		PwszFileName		String containing the file to be read
+ *	@param		PppvReader			Receives the reader handle
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_WRONG_ENCODING	The file is neither UTF-8 nor has it a byte order mark.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_OpenLineReader(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	void**			PppvReader)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvStream = NULL;
+
+	do
+	{
+		IfxFileLineReader* pReader = NULL;
+		const BYTE* rgbStart = NULL;
+		unsigned int unSize = 0;
+
+		if (NULL == PppvReader)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvReader = NULL;
+
+		unReturnValue = FileIO_OpenStream(PwszFileName, &pvStream);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		pReader = (IfxFileLineReader*)Platform_MemoryAllocateZero(sizeof(IfxFileLineReader));
+		if (NULL == pReader)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		pReader->pStream = (IfxFileStream*)pvStream;
+		pvStream = NULL;
+		*PppvReader = pReader;
+
+		// Detect the byte order mark once, an empty file has none
+		unReturnValue = FileIO_FillStream(pReader->pStream, 0);
+		if (RC_E_END_OF_FILE == unReturnValue)
+		{
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		rgbStart = pReader->pStream->rgbReadAhead;
+		unSize = pReader->pStream->unReadAheadSize;
+		if (unSize >= 3 && 0xEF == rgbStart[0] && 0xBB == rgbStart[1] && 0xBF == rgbStart[2])
+			pReader->unOffset = 3;
+		else if ((unSize >= 2 && ((0xFF == rgbStart[0] && 0xFE == rgbStart[1]) || (0xFE == rgbStart[0] && 0xFF == rgbStart[1]))) ||
+				(unSize >= 4 && 0x00 == rgbStart[0] && 0x00 == rgbStart[1] && 0xFE == rgbStart[2] && 0xFF == rgbStart[3]))
+			unReturnValue = RC_E_WRONG_ENCODING;
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS != unReturnValue && NULL != PppvReader)
+		FileIO_CloseLineReader(PppvReader);
+	FileIO_CloseStream(&pvStream);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Reads the next line from a line reader
+ *	@details	Behaves like FileIO_ReadLine: the line feed is part of the line, and a line longer than the buffer is
+ *				returned in several parts.
+ *
+ *	@param		PpvReader			Reader handle returned by FileIO_OpenLineReader
+ *	@param		PwszBuffer			Buffer to the read data
+ *	@param		PpunSize			In:	Capacity of the destination buffer in wchar_t elements (include additional space for terminating 0)\n
+ *									Out: Number of elements copied to the destination buffer (without terminating 0)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_END_OF_FILE	In case method has reached the end of file
+ *	@retval		RC_E_FAIL			An unexpected error occurred. E.g. the file contains an invalid multibyte sequence.
+ */
+_Check_return_
+unsigned int
+FileIO_ReadLineFromReader(
+	_In_					void*			PpvReader,
+	_Out_z_cap_(*PpunSize)	wchar_t*		PwszBuffer,
+	_Inout_					unsigned int*	PpunSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	IfxFileLineReader* pReader = (IfxFileLineReader*)PpvReader;
+	unsigned int unLength = 0;
+
+	if (NULL == pReader || NULL == PwszBuffer || NULL == PpunSize || 0 == *PpunSize)
+		return RC_E_BAD_PARAMETER;
+
+	while (unLength + 1 < *PpunSize)
+	{
+		IfxFileStream* pStream = pReader->pStream;
+		const char* szNext = NULL;
+		size_t sizeAvailable = 0;
+		size_t sizeDecoded = 0;
+		wchar_t wcCharacter = 0;
+
+		if (pReader->unOffset < pStream->unReadAheadOffset || pReader->unOffset >= pStream->unReadAheadOffset + pStream->unReadAheadSize)
+		{
+			unReturnValue = FileIO_FillStream(pStream, pReader->unOffset);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		szNext = (const char*)&pStream->rgbReadAhead[pReader->unOffset - pStream->unReadAheadOffset];
+		sizeAvailable = pStream->unReadAheadOffset + pStream->unReadAheadSize - pReader->unOffset;
+
+		// ASCII needs no conversion, widen the run up to the line break in one go
+		if (mbsinit(&pReader->sState))
+		{
+			const char* szLineBreak = (const char*)memchr(szNext, '\n', sizeAvailable);
+			unsigned int unRun = (unsigned int)(NULL != szLineBreak ? (size_t)(szLineBreak - szNext) + 1 : sizeAvailable);
+			if (unRun > *PpunSize - 1 - unLength)
+				unRun = *PpunSize - 1 - unLength;
+			unRun = Platform_StringWidenAscii(szNext, unRun, &PwszBuffer[unLength]);
+			if (0 != unRun)
+			{
+				pReader->unOffset += unRun;
+				unLength += unRun;
+				if (L'\n' == PwszBuffer[unLength - 1])
+					break;
+				continue;
+			}
+		}
+
+		sizeDecoded = mbrtowc(&wcCharacter, szNext, sizeAvailable, &pReader->sState);
+		if ((size_t) - 2 == sizeDecoded)
+		{
+			// The character continues in the next buffer, the shift state keeps the decoded part
+			pReader->unOffset += (unsigned int)sizeAvailable;
+			continue;
+		}
+		if ((size_t) - 1 == sizeDecoded)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (0 == sizeDecoded)
+			sizeDecoded = 1;
+
+		pReader->unOffset += (unsigned int)sizeDecoded;
+		PwszBuffer[unLength++] = wcCharacter;
+		if (L'\n' == wcCharacter)
+			break;
+	}
+
+	// The end of the file terminates the last line
+	if (RC_E_END_OF_FILE == unReturnValue && 0 != unLength)
+		unReturnValue = RC_SUCCESS;
+
+	if (RC_SUCCESS != unReturnValue)
+		unLength = 0;
+	PwszBuffer[unLength] = L'\0';
+	*PpunSize = unLength;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Close a line reader opened by FileIO_OpenLineReader
+ *
+ *	@param		PppvReader			Pointer to the reader handle. Set to NULL on return.
+ */
+void
+FileIO_CloseLineReader(
+	_Inout_ void** PppvReader)
+{
+	if (NULL == PppvReader || NULL == *PppvReader)
+		return;
+
+	FileIO_CloseStream((void**)&((IfxFileLineReader*)*PppvReader)->pStream);
+	Platform_MemoryFree(PppvReader);
+}
+
+/// Frame of a buffer of independently compressed gzip members
+typedef struct tdIfxFileFrame
+{
+	/// Offset of the gzip member in the compressed buffer
+	unsigned int unOffset;
+	/// Size of the gzip member
+	unsigned int unSize;
+	/// Offset of the frame in the decompressed buffer
+	unsigned int unDecompressedOffset;
+	/// Size of the decompressed frame
+	unsigned int unDecompressedSize;
+} IfxFileFrame;
+
+/// Share of the frames inflated by one thread of FileIO_DecompressFileBuffer
+typedef struct tdIfxFileInflateWorker
+{
+	/// Compressed buffer
+	const BYTE* prgbBuffer;
+	/// Decompressed buffer
+	BYTE* prgbDecompressed;
+	/// Frame table
+	const IfxFileFrame* pFrames;
+	/// Number of frames in the frame table
+	unsigned int unFrameCount;
+	/// Index of the first frame inflated by the thread
+	unsigned int unFirstFrame;
+	/// Distance between the frames inflated by the thread
+	unsigned int unFrameStride;
+	/// Result of the thread
+	unsigned int unReturnValue;
+	/// Thread handle, NULL if the share is inflated by the calling thread
+	void* pvThread;
+} IfxFileInflateWorker;
+
+/**
+ *	@brief		Inflate a single gzip member
+ *
+ *	@param		PrgbBuffer			gzip member
+ *	@param		PunBufferSize		Size of the gzip member
+ *	@param		PrgbDecompressed	Buffer to receive the decompressed data
+ *	@param		PunDecompressedSize	Size of the decompressed data announced by the gzip trailer
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The compressed data is corrupt or does not match the announced size.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+static unsigned int
+FileIO_InflateMember(
+	_In_bytecount_(PunBufferSize)		const BYTE*		PrgbBuffer,
+	_In_								unsigned int	PunBufferSize,
+	_Out_bytecap_(PunDecompressedSize)	BYTE*			PrgbDecompressed,
+	_In_								unsigned int	PunDecompressedSize)
+{
+	z_stream sStream;
+	int nResult = Z_OK;
+
+	// Inflate the gzip stream (window bits + 16 selects the gzip format)
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&sStream, 0, sizeof(sStream)));
+	if (Z_OK != inflateInit2(&sStream, MAX_WBITS + 16))
+		return RC_E_FAIL;
+	sStream.next_in = (BYTE*)PrgbBuffer;
+	sStream.avail_in = PunBufferSize;
+	sStream.next_out = PrgbDecompressed;
+	sStream.avail_out = PunDecompressedSize;
+	nResult = inflate(&sStream, Z_FINISH);
+	IGNORE_RETURN_VALUE(inflateEnd(&sStream));
+
+	// The stream must end exactly at the end of the buffer and of the announced size
+	if (Z_STREAM_END != nResult || 0 != sStream.avail_in || 0 != sStream.avail_out)
+		return RC_E_BAD_PARAMETER;
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Thread function inflating a share of the frames of a compressed buffer
+ *	@details	The frames are independent and are written to disjoint parts of the decompressed buffer, so the threads
+ *				do not need any synchronization. The thread stops at the first failing frame.
+ *
+ *	@param		PpvWorker			Share of the frames (IfxFileInflateWorker), receives the result
+ */
+static void
+FileIO_InflateFrames(
+	_Inout_ void* PpvWorker)
+{
+	IfxFileInflateWorker* pWorker = (IfxFileInflateWorker*)PpvWorker;
+	unsigned int unFrame = 0;
+
+	pWorker->unReturnValue = RC_SUCCESS;
+	for (unFrame = pWorker->unFirstFrame; unFrame < pWorker->unFrameCount && RC_SUCCESS == pWorker->unReturnValue; unFrame += pWorker->unFrameStride)
+	{
+		const IfxFileFrame* pFrame = &pWorker->pFrames[unFrame];
+		pWorker->unReturnValue = FileIO_InflateMember(
+									 pWorker->prgbBuffer + pFrame->unOffset, pFrame->unSize,
+									 pWorker->prgbDecompressed + pFrame->unDecompressedOffset, pFrame->unDecompressedSize);
+	}
+}
+
+/**
+ *	@brief		Read the frame table of a buffer of independently compressed gzip members
+ *	@details	Each frame is a gzip member whose header carries the extra subfield FILEIO_FRAME_SUBFIELD_ID as first
+ *				subfield. Its four bytes hold the size of the whole gzip member (little-endian), so the frame table is
+ *				built by walking the member headers without inflating anything. A buffer whose first member has no such
+ *				subfield is no frame buffer and yields no frame table.
+ *
+ *	@param		PrgbBuffer			Compressed buffer
+ *	@param		PunBufferSize		Size of the compressed buffer
+ *	@param		PpFrames			Receives the allocated frame table (NULL if the buffer is not framed). Must be freed by the caller.
+ *	@param		PpunFrameCount		Receives the number of frames
+ *	@param		PpunDecompressedSize	Receives the size of all decompressed frames
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The frame table is corrupt or the decompressed size is too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+static unsigned int
+FileIO_ReadFrameTable(
+	_In_bytecount_(PunBufferSize)	const BYTE*		PrgbBuffer,
+	_In_							unsigned int	PunBufferSize,
+	_Outptr_result_maybenull_		IfxFileFrame**	PpFrames,
+	_Out_							unsigned int*	PpunFrameCount,
+	_Out_							unsigned int*	PpunDecompressedSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxFileFrame* pFrames = NULL;
+
+	do
+	{
+		unsigned int unPass = 0;
+		unsigned int unFrameCount = 0;
+		unsigned long long ullDecompressedSize = 0;
+
+		*PpFrames = NULL;
+		*PpunFrameCount = 0;
+		*PpunDecompressedSize = 0;
+
+		// The first pass counts the frames, the second pass fills the allocated frame table
+		for (unPass = 0; unPass < 2; unPass++)
+		{
+			unsigned int unOffset = 0;
+
+			unFrameCount = 0;
+			ullDecompressedSize = 0;
+			unReturnValue = RC_SUCCESS;
+			while (unOffset < PunBufferSize)
+			{
+				const BYTE* rgbMember = PrgbBuffer + unOffset;
+				unsigned int unExtraSize = 0;
+				unsigned int unMemberSize = 0;
+				unsigned int unDecompressedSize = 0;
+				BOOL fFramed = FALSE;
+
+				if (FILEIO_FRAME_HEADER_SIZE <= PunBufferSize - unOffset && 0x1F == rgbMember[0] && 0x8B == rgbMember[1] &&
+						Z_DEFLATED == rgbMember[2] && 0 != (rgbMember[3] & 0x04))
+				{
+					unExtraSize = (unsigned int)rgbMember[10] | (unsigned int)rgbMember[11] << 8;
+					fFramed = (FILEIO_FRAME_HEADER_SIZE - 12 <= unExtraSize &&
+							   (BYTE)(FILEIO_FRAME_SUBFIELD_ID >> 8) == rgbMember[12] && (BYTE)FILEIO_FRAME_SUBFIELD_ID == rgbMember[13] &&
+							   4 == rgbMember[14] && 0 == rgbMember[15]) ? TRUE : FALSE;
+				}
+				if (!fFramed)
+				{
+					// A plain gzip buffer is no frame buffer, but a frame buffer must be framed throughout
+					unReturnValue = (0 == unOffset) ? RC_SUCCESS : RC_E_BAD_PARAMETER;
+					break;
+				}
+
+				unMemberSize = (unsigned int)rgbMember[16] | (unsigned int)rgbMember[17] << 8 |
+							   (unsigned int)rgbMember[18] << 16 | (unsigned int)rgbMember[19] << 24;
+				if (unMemberSize < 12 + unExtraSize + 8 || unMemberSize > PunBufferSize - unOffset)
+				{
+					unReturnValue = RC_E_BAD_PARAMETER;
+					break;
+				}
+
+				// The gzip trailer of the member holds the decompressed size of the frame (little-endian)
+				unDecompressedSize = (unsigned int)rgbMember[unMemberSize - 4] |
+									 (unsigned int)rgbMember[unMemberSize - 3] << 8 |
+									 (unsigned int)rgbMember[unMemberSize - 2] << 16 |
+									 (unsigned int)rgbMember[unMemberSize - 1] << 24;
+				if (0 == unDecompressedSize || FILEIO_MAX_DECOMPRESSED_SIZE < ullDecompressedSize + unDecompressedSize)
+				{
+					unReturnValue = RC_E_BAD_PARAMETER;
+					break;
+				}
+
+				if (NULL != pFrames)
+				{
+					pFrames[unFrameCount].unOffset = unOffset;
+					pFrames[unFrameCount].unSize = unMemberSize;
+					pFrames[unFrameCount].unDecompressedOffset = (unsigned int)ullDecompressedSize;
+					pFrames[unFrameCount].unDecompressedSize = unDecompressedSize;
+				}
+				unFrameCount++;
+				ullDecompressedSize += unDecompressedSize;
+				unOffset += unMemberSize;
+			}
+			if (RC_SUCCESS != unReturnValue || 0 == unFrameCount || NULL != pFrames)
+				break;
+
+			pFrames = (IfxFileFrame*)Platform_MemoryAllocateZero(unFrameCount * sizeof(IfxFileFrame));
+			if (NULL == pFrames)
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+		}
+		if (RC_SUCCESS != unReturnValue || NULL == pFrames)
+			break;
+
+		*PpFrames = pFrames;
+		pFrames = NULL;
+		*PpunFrameCount = unFrameCount;
+		*PpunDecompressedSize = (unsigned int)ullDecompressedSize;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&pFrames);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Decompress a gzip compressed buffer returned by FileIO_MapFileToBuffer
+ *	@details	If the buffer starts with the gzip magic bytes it is inflated into an allocated buffer, and the
+ *				compressed buffer is released. Otherwise the buffer is left untouched. The decompressed size is taken
+ *				from the gzip trailer and limited to FILEIO_MAX_DECOMPRESSED_SIZE. The buffer must still be released
+ *				with FileIO_ReleaseFileBuffer.
+ *				A buffer of independently compressed frames (see FILEIO_FRAME_SUBFIELD_ID) is inflated frame by frame by
+ *				up to FILEIO_DECOMPRESS_THREADS_MAX threads.
+ *
+ *	@param		PprgbBuffer			Pointer to the buffer, receives the decompressed buffer.
+ *	@param		PpunBufferSize		Number of bytes in the buffer, receives the decompressed size.
+ *	@param		PpfMapped			TRUE if the buffer is a file mapping, receives FALSE if the buffer was decompressed.
+ *	@param		PpfDecompressed		Receives TRUE if the buffer was decompressed, FALSE otherwise.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. Or the compressed data is corrupt or too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_DecompressFileBuffer(
+	_Inout_	BYTE**			PprgbBuffer,
+	_Inout_	unsigned int*	PpunBufferSize,
+	_Inout_	BOOL*			PpfMapped,
+	_Out_	BOOL*			PpfDecompressed)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* prgbDecompressed = NULL;
+	IfxFileFrame* pFrames = NULL;
+
+	do
+	{
+		unsigned int unDecompressedSize = 0;
+		unsigned int unFrameCount = 0;
+
+		// Check parameters
+		if (NULL == PprgbBuffer || NULL == *PprgbBuffer || NULL == PpunBufferSize || NULL == PpfMapped || NULL == PpfDecompressed)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpfDecompressed = FALSE;
+
+		// Leave buffers without the gzip magic bytes untouched
+		if (18 > *PpunBufferSize || 0x1F != (*PprgbBuffer)[0] || 0x8B != (*PprgbBuffer)[1])
+		{
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		unReturnValue = FileIO_ReadFrameTable(*PprgbBuffer, *PpunBufferSize, &pFrames, &unFrameCount, &unDecompressedSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (0 == unFrameCount)
+		{
+			// The gzip trailer holds the decompressed size (little-endian)
+			unDecompressedSize = (unsigned int)(*PprgbBuffer)[*PpunBufferSize - 4] |
+								 (unsigned int)(*PprgbBuffer)[*PpunBufferSize - 3] << 8 |
+								 (unsigned int)(*PprgbBuffer)[*PpunBufferSize - 2] << 16 |
+								 (unsigned int)(*PprgbBuffer)[*PpunBufferSize - 1] << 24;
+			if (0 == unDecompressedSize || FILEIO_MAX_DECOMPRESSED_SIZE < unDecompressedSize)
+			{
+				unReturnValue = RC_E_BAD_PARAMETER;
+				break;
+			}
+		}
+
+		prgbDecompressed = (BYTE*)Platform_MemoryAllocateZero(unDecompressedSize);
+		if (NULL == prgbDecompressed)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		if (0 == unFrameCount)
+			unReturnValue = FileIO_InflateMember(*PprgbBuffer, *PpunBufferSize, prgbDecompressed, unDecompressedSize);
+		else
+		{
+			IfxFileInflateWorker rgsWorkers[FILEIO_DECOMPRESS_THREADS_MAX];
+			unsigned int unWorkerCount = (FILEIO_DECOMPRESS_THREADS_MAX < unFrameCount) ? FILEIO_DECOMPRESS_THREADS_MAX : unFrameCount;
+			unsigned int unWorker = 0;
+
+			// Each worker inflates every unWorkerCount-th frame. The first share is inflated by the calling thread, as
+			// is the share of a thread which cannot be started.
+			for (unWorker = 0; unWorker < unWorkerCount; unWorker++)
+			{
+				IfxFileInflateWorker* pWorker = &rgsWorkers[unWorker];
+				pWorker->prgbBuffer = *PprgbBuffer;
+				pWorker->prgbDecompressed = prgbDecompressed;
+				pWorker->pFrames = pFrames;
+				pWorker->unFrameCount = unFrameCount;
+				pWorker->unFirstFrame = unWorker;
+				pWorker->unFrameStride = unWorkerCount;
+				pWorker->unReturnValue = RC_E_FAIL;
+				pWorker->pvThread = NULL;
+				if (0 != unWorker && RC_SUCCESS != Platform_ThreadCreate(FileIO_InflateFrames, pWorker, &pWorker->pvThread))
+					pWorker->pvThread = NULL;
+			}
+			for (unWorker = 0; unWorker < unWorkerCount; unWorker++)
+			{
+				if (NULL == rgsWorkers[unWorker].pvThread)
+					FileIO_InflateFrames(&rgsWorkers[unWorker]);
+			}
+
+			unReturnValue = RC_SUCCESS;
+			for (unWorker = 0; unWorker < unWorkerCount; unWorker++)
+			{
+				if (NULL != rgsWorkers[unWorker].pvThread && RC_SUCCESS != Platform_ThreadJoin(&rgsWorkers[unWorker].pvThread))
+					rgsWorkers[unWorker].unReturnValue = RC_E_FAIL;
+				if (RC_SUCCESS == unReturnValue)
+					unReturnValue = rgsWorkers[unWorker].unReturnValue;
+			}
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Replace the compressed buffer
+		FileIO_ReleaseFileBuffer(PprgbBuffer, *PpunBufferSize, *PpfMapped);
+		*PprgbBuffer = prgbDecompressed;
+		prgbDecompressed = NULL;
+		*PpunBufferSize = unDecompressedSize;
+		*PpfMapped = FALSE;
+		*PpfDecompressed = TRUE;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbDecompressed);
+	Platform_MemoryFree((void**)&pFrames);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read the whole content of a file into a wide char array
+ *	@details	The function opens, reads and closes the file.
+ *				Allocates a buffer with the required size.
+ *				and returns the pointer to that buffer.
+ *
+ *	@param		PwszFileName		String containing the file to be read
+ *	@param		PpwszBuffer			Pointer to a wide char array which receives
+ *									the allocated memory for the buffer. The caller must free the allocated buffer!
+ *									The value behind the pointer must be initialized to zero.
+ *	@param		PpunBufferSize		Number of wide chars read to the buffer. Without zero termination.
+ *									Value behind the pointer must be initialized to zero.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly. Or the file was too large.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ *	@retval		RC_E_WRONG_ENCODING	In case file is not in UCS-2 LE encoding
+ */
+_Check_return_
+unsigned int
+FileIO_ReadFileToStringBuffer(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_z_	wchar_t**		PpwszBuffer,
+	_Out_						unsigned int*	PpunBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	FILE* pFile = NULL;
+	unsigned char* pbTemp = NULL;
+
+	do
+	{
+		unsigned long long ullFileSize = 0;
+		unsigned int unSizeOfBOM = 0;
+		ENUM_BOM_TYPES eBOMType = BOM_TYPES_NO;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PpunBufferSize || NULL == PpwszBuffer || NULL != *PpwszBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// First open the file
+		unReturnValue = FileIO_Open(PwszFileName, (void**)(&pFile), FILE_READ);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (NULL == pFile)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Second get the file size
+		unReturnValue = FileIO_GetFileSize(pFile, &ullFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (UINT_MAX < ullFileSize + 2) // Memory allocation can only handle limited size (add 2 byte for final zero termination)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = FileIO_GetBOMType(pFile, &eBOMType, &unSizeOfBOM);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_SetPosition(pFile, (unsigned long long) unSizeOfBOM);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -955,7 +3340,7 @@ FileIO_ReadFileToStringBuffer(
 
 					// Sixth unmarshal process memory to resulting wchar_t string. Do not add the termination zero size of 2
 					// to ullFileSize because the Platform_UnmarshalString function handles the buffer as byte array and not as
-					// wide string array. The +2 is only needed in case of UTF-8 where mbstowcs casts the byte array to a const char*.
+					// wide string array. The +2 is only needed in case of UTF-8 where the byte array is read as a zero terminated string.
 					unReturnValue = Platform_UnmarshalString(pbTemp, ullFileSize, *PpwszBuffer, &unNumWcharsInFile);
 					if (RC_SUCCESS != unReturnValue)
 						break;
@@ -967,8 +3352,10 @@ FileIO_ReadFileToStringBuffer(
 				case BOM_TYPES_UTF8:
 				case BOM_TYPES_NO:
 				{
-					size_t sizeNumOfReadBytes = 0;
-					unNumWcharsInFile = mbstowcs(NULL, (const char*) pbTemp, 0) + 1;
+					// The text ends at the first zero byte. A multibyte string never converts to more characters than it has
+					// bytes, so the buffer is allocated once and filled in a single conversion pass.
+					unsigned int unTextSize = (unsigned int)strnlen((const char*)pbTemp, (size_t)ullFileSize);
+					unNumWcharsInFile = unTextSize + 1;
 					*PpwszBuffer = (wchar_t*)Platform_MemoryAllocateZero(unNumWcharsInFile * sizeof(wchar_t));
 					if (NULL == *PpwszBuffer)
 					{
@@ -976,186 +3363,801 @@ FileIO_ReadFileToStringBuffer(
 						break;
 					}
 
-					sizeNumOfReadBytes = mbstowcs(*PpwszBuffer, (const char*)pbTemp, unNumWcharsInFile);
+					unReturnValue = Platform_StringFromMultiByte((const char*)pbTemp, unTextSize, *PpwszBuffer, &unNumWcharsInFile);
+					if (RC_SUCCESS != unReturnValue)
+					{
+						unReturnValue = RC_E_FAIL;
+						break;
+					}
+
+					*PpunBufferSize = unNumWcharsInFile + 1;
+					unReturnValue = RC_SUCCESS;
+					break;
+				}
+				default:
+				{
+					unReturnValue = RC_E_WRONG_ENCODING;
+					break;
+				}
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	// Check if pbTemp is allocated
+	if (NULL != pbTemp)
+		Platform_MemoryFree((void**)&pbTemp);
+
+	// Check if the file pointer is not NULL and close the file, but do not overwrite previous error code if existing
+	if (NULL != pFile)
+	{
+		unsigned int unReturnValueClose = RC_E_FAIL;
+		unReturnValueClose = FileIO_Close((void**)&pFile);
+		if (RC_SUCCESS != unReturnValueClose)
+		{
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = unReturnValueClose;
+		}
+	}
+
+	// If an error occurs free the buffer if allocated before
+	if (RC_SUCCESS != unReturnValue)
+	{
+		Platform_MemoryFree((void**)PpwszBuffer);
+
+		// Reset out parameter
+		if (NULL != PpunBufferSize)
+			*PpunBufferSize = 0;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Write a byte array to the a file
+ *	@details	The function writes the bytes from a buffer to the file.
+ *
+ *	@param		PpvFileHandle		Handle to a file
+ *	@param		PrgbBuffer			Pointer to a byte buffer
+ *	@param		PunBufferSize		Number of bytes to be written to the file
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_WriteBuffer(
+	_In_	const void*		PpvFileHandle,
+	_In_	const BYTE*		PrgbBuffer,
+	_In_	unsigned int	PunBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unWrittenBytes = 0;
+
+		// Check parameters
+		if ( NULL == PpvFileHandle || NULL == PrgbBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Write bytes to file
+		unWrittenBytes = (unsigned int)fwrite((void*)PrgbBuffer, sizeof(BYTE), PunBufferSize, (FILE*)PpvFileHandle);
+
+		// Check if the buffer size is identical to the written bytes count or an error has occurred
+		if (unWrittenBytes != PunBufferSize || 0 != ferror((FILE*)PpvFileHandle))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Remove a file
+ *	@details
+ *
+ *	@param		PwszFileName		File name
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_ACCESS_DENIED	In case of a read-only or opened file
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_INTERNAL		In all other cases where the file could not be removed
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_Remove(
+	_In_z_ const wchar_t* PwszFileName)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+
+	do
+	{
+		size_t sizeFileName = 0;
+
+		// Check parameter
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// For remove operation the file name (wide character string) needs to be converted to multibyte string
+		// Get the required size for the multibyte string.
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Allocate memory for the multibyte string
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		if (NULL == szFileName)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Convert the wide character string to a multibyte string.
+		sizeFileName = wcsrtombs(szFileName, &PwszFileName, wcslen(PwszFileName), NULL);
+		if ((size_t) - 1 == sizeFileName)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		if (0 != unlink(szFileName))
+		{
+			switch(errno)
+			{
+				case EACCES:
+					unReturnValue = RC_E_ACCESS_DENIED;
+					break;
+				case ENOENT:
+					unReturnValue = RC_E_FILE_NOT_FOUND;
+					break;
+				default:
+					unReturnValue = RC_E_INTERNAL;
+					break;
+			}
+		}
+		else
+			unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Cleanup memory
+	if (szFileName != NULL)
+	{
+		Platform_MemoryFree((void**)&szFileName);
+		szFileName = NULL;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Create a directory which is private to the effective user
+ *	@details	An existing directory is accepted as is.
+ *
+ *	@param		PwszPath			Directory path
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_ACCESS_DENIED	The directory cannot be created in the parent directory.
+ *	@retval		RC_E_FILE_NOT_FOUND	The parent directory does not exist.
+ *	@retval		RC_E_INTERNAL		In all other cases where the directory could not be created
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_CreateDirectory(
+	_In_z_ const wchar_t* PwszPath)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szPath = NULL;
+
+	do
+	{
+		size_t sizePath = 0;
+
+		// Check parameter
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszPath))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Convert the wide character string to a multibyte string
+		sizePath = wcsrtombs(NULL, &PwszPath, 0, NULL);
+		if ((size_t) - 1 == sizePath)
+			break;
+		szPath = (char*)Platform_MemoryAllocateScratch(sizePath + 1);
+		if (NULL == szPath)
+			break;
+		sizePath = wcsrtombs(szPath, &PwszPath, sizePath, NULL);
+		if ((size_t) - 1 == sizePath)
+			break;
+
+		if (0 != mkdir(szPath, S_IRWXU) && EEXIST != errno)
+		{
+			switch(errno)
+			{
+				case EACCES:
+					unReturnValue = RC_E_ACCESS_DENIED;
+					break;
+				case ENOENT:
+					unReturnValue = RC_E_FILE_NOT_FOUND;
+					break;
+				default:
+					unReturnValue = RC_E_INTERNAL;
+					break;
+			}
+		}
+		else
+			unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&szPath);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Rename a file
+ *	@details	An existing file with the new name is replaced.
+ *
+ *	@param		PwszFileName		File name
+ *	@param		PwszNewFileName		New file name
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_ACCESS_DENIED	The file or the target directory cannot be written.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_INTERNAL		In all other cases where the file could not be renamed
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_Rename(
+	_In_z_	const wchar_t*	PwszFileName,
+	_In_z_	const wchar_t*	PwszNewFileName)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+	char* szNewFileName = NULL;
+
+	do
+	{
+		size_t sizeFileName = 0;
+		size_t sizeNewFileName = 0;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszNewFileName))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// For rename operation the file names (wide character strings) need to be converted to multibyte strings
+		// Get the required sizes for the multibyte strings.
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		sizeNewFileName = wcsrtombs(NULL, &PwszNewFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName || (size_t) - 1 == sizeNewFileName)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Allocate memory for the multibyte strings
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		szNewFileName = (char*)Platform_MemoryAllocateScratch(sizeNewFileName + 1);
+		if (NULL == szFileName || NULL == szNewFileName)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
 
-					if (sizeNumOfReadBytes + 1 != unNumWcharsInFile)
-					{
-						unReturnValue = RC_E_FAIL;
-						break;
-					}
+		// Convert the wide character strings to multibyte strings.
+		if ((size_t) - 1 == wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL) ||
+				(size_t) - 1 == wcsrtombs(szNewFileName, &PwszNewFileName, sizeNewFileName, NULL))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
 
-					*PpunBufferSize = unNumWcharsInFile;
-					unReturnValue = RC_SUCCESS;
+		if (0 != rename(szFileName, szNewFileName))
+		{
+			switch(errno)
+			{
+				case EACCES:
+				case EPERM:
+					unReturnValue = RC_E_ACCESS_DENIED;
+					break;
+				case ENOENT:
+					unReturnValue = RC_E_FILE_NOT_FOUND;
 					break;
-				}
 				default:
-				{
-					unReturnValue = RC_E_WRONG_ENCODING;
+					unReturnValue = RC_E_INTERNAL;
 					break;
-				}
 			}
 		}
+		else
+			unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
-	// Check if pbTemp is allocated
-	if (NULL != pbTemp)
-		Platform_MemoryFree((void**)&pbTemp);
+	// Cleanup memory
+	Platform_MemoryFree((void**)&szFileName);
+	Platform_MemoryFree((void**)&szNewFileName);
 
-	// Check if the file pointer is not NULL and close the file, but do not overwrite previous error code if existing
-	if (NULL != pFile)
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Compress a file to a gzip file
+ *	@details	An existing destination file is replaced. The source file is left untouched. In case of an error an
+ *				incomplete destination file is removed.
+ *
+ *	@param		PwszFileName		File name of the file to compress
+ *	@param		PwszGzipFileName	File name of the gzip file to create
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
+ *	@retval		RC_E_INTERNAL		The file could not be read or the gzip file could not be written.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+FileIO_CompressFile(
+	_In_z_	const wchar_t*	PwszFileName,
+	_In_z_	const wchar_t*	PwszGzipFileName)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+	char* szGzipFileName = NULL;
+	BYTE* rgbBuffer = NULL;
+	FILE* pFile = NULL;
+	gzFile pGzipFile = NULL;
+
+	do
 	{
-		unsigned int unReturnValueClose = RC_E_FAIL;
-		unReturnValueClose = FileIO_Close((void**)&pFile);
-		if (RC_SUCCESS != unReturnValueClose)
+		size_t sizeFileName = 0;
+		size_t sizeGzipFileName = 0;
+		size_t sizeRead = 0;
+
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszGzipFileName))
 		{
-			if (RC_SUCCESS == unReturnValue)
-				unReturnValue = unReturnValueClose;
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Convert the file names (wide character strings) to multibyte strings
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		sizeGzipFileName = wcsrtombs(NULL, &PwszGzipFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName || (size_t) - 1 == sizeGzipFileName)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		szGzipFileName = (char*)Platform_MemoryAllocateScratch(sizeGzipFileName + 1);
+		rgbBuffer = (BYTE*)Platform_MemoryAllocateScratch(FILEIO_COMPRESS_CHUNK_SIZE);
+		if (NULL == szFileName || NULL == szGzipFileName || NULL == rgbBuffer)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if ((size_t) - 1 == wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL) ||
+				(size_t) - 1 == wcsrtombs(szGzipFileName, &PwszGzipFileName, sizeGzipFileName, NULL))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
 		}
+
+		pFile = fopen(szFileName, "rb");
+		if (NULL == pFile)
+		{
+			unReturnValue = (ENOENT == errno) ? RC_E_FILE_NOT_FOUND : RC_E_INTERNAL;
+			break;
+		}
+		pGzipFile = gzopen(szGzipFileName, "wb");
+		if (NULL == pGzipFile)
+		{
+			unReturnValue = RC_E_INTERNAL;
+			break;
+		}
+
+		// Copy the file through the compressor chunk by chunk
+		unReturnValue = RC_SUCCESS;
+		while (0 != (sizeRead = fread(rgbBuffer, 1, FILEIO_COMPRESS_CHUNK_SIZE, pFile)))
+		{
+			if ((int)sizeRead != gzwrite(pGzipFile, rgbBuffer, (unsigned int)sizeRead))
+			{
+				unReturnValue = RC_E_INTERNAL;
+				break;
+			}
+		}
+		if (RC_SUCCESS == unReturnValue && 0 != ferror(pFile))
+			unReturnValue = RC_E_INTERNAL;
+
+		// Closing the gzip file writes the trailer
+		if (Z_OK != gzclose(pGzipFile) && RC_SUCCESS == unReturnValue)
+			unReturnValue = RC_E_INTERNAL;
+		pGzipFile = NULL;
+
+		// Do not leave an incomplete gzip file behind
+		if (RC_SUCCESS != unReturnValue)
+			IGNORE_RETURN_VALUE(unlink(szGzipFileName));
 	}
+	WHILE_FALSE_END;
 
-	// If an error occurs free the buffer if allocated before
-	if (RC_SUCCESS != unReturnValue)
+	if (NULL != pGzipFile)
 	{
-		Platform_MemoryFree((void**)PpwszBuffer);
-
-		// Reset out parameter
-		if (NULL != PpunBufferSize)
-			*PpunBufferSize = 0;
+		IGNORE_RETURN_VALUE(gzclose(pGzipFile));
+		IGNORE_RETURN_VALUE(unlink(szGzipFileName));
 	}
+	if (NULL != pFile)
+		IGNORE_RETURN_VALUE(fclose(pFile));
+
+	// Cleanup memory
+	Platform_MemoryFree((void**)&szFileName);
+	Platform_MemoryFree((void**)&szGzipFileName);
+	Platform_MemoryFree((void**)&rgbBuffer);
 
 	return unReturnValue;
 }
 
+#ifndef sigev_notify_thread_id
+/// Thread receiving a SIGEV_THREAD_ID timer signal (not defined by older C libraries)
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
 /**
- *	@brief		Write a byte array to the a file
- *	@details	The function writes the bytes from a buffer to the file.
+ *	@brief		Signal handler interrupting a blocked lock wait when its timeout expired
+ *	@details
  *
- *	@param		PpvFileHandle		Handle to a file
- *	@param		PrgbBuffer			Pointer to a byte buffer
- *	@param		PunBufferSize		Number of bytes to be written to the file
- *	@retval		RC_SUCCESS			The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
- *	@retval		RC_E_FAIL			An unexpected error occurred.
+ *	@param		PnSignal		Signal number
+ */
+static void
+FileIO_LockTimeoutHandler(
+	_In_ int PnSignal)
+{
+	(void)PnSignal;
+}
+
+/**
+ *	@brief		Acquires an exclusive advisory lock on a lock file
+ *	@details	The lock file is created if it does not exist. A caller finding the lock held waits blocked in the kernel
+ *				until the lock is released or the timeout expires, there is no polling. The lock is released by
+ *				FileIO_UnlockFile or when the process exits.
+ *
+ *	@param		PwszFileName					Lock file name
+ *	@param		PunTimeoutSeconds				Maximum time to wait for the lock in seconds (0: do not wait)
+ *	@param		PppvLock						Receives the lock handle
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_ACCESS_DENIED				The lock file cannot be created or opened.
+ *	@retval		RC_E_FILE_NOT_FOUND				The directory of the lock file does not exist.
+ *	@retval		RC_E_DEVICE_ALREADY_IN_USE		The lock is still held by another process when the timeout expired.
+ *	@retval		RC_E_FAIL						An unexpected error occurred.
  */
 _Check_return_
 unsigned int
-FileIO_WriteBuffer(
-	_In_	const void*		PpvFileHandle,
-	_In_	const BYTE*		PrgbBuffer,
-	_In_	unsigned int	PunBufferSize)
+FileIO_LockFile(
+	_In_z_						const wchar_t*	PwszFileName,
+	_In_						unsigned int	PunTimeoutSeconds,
+	_Outptr_result_maybenull_	void**			PppvLock)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	char* szFileName = NULL;
+	int nFileHandle = -1;
 
 	do
 	{
-		unsigned int unWrittenBytes = 0;
+		size_t sizeFileName = 0;
 
 		// Check parameters
-		if ( NULL == PpvFileHandle || NULL == PrgbBuffer)
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PppvLock)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
+		*PppvLock = NULL;
 
-		// Write bytes to file
-		unWrittenBytes = (unsigned int)fwrite((void*)PrgbBuffer, sizeof(BYTE), PunBufferSize, (FILE*)PpvFileHandle);
+		// For open operation the file name (wide character string) needs to be converted to multibyte string
+		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
+		szFileName = (char*)Platform_MemoryAllocateScratch(sizeFileName + 1);
+		if (NULL == szFileName)
+			break;
+		sizeFileName = wcsrtombs(szFileName, &PwszFileName, sizeFileName, NULL);
+		if ((size_t) - 1 == sizeFileName)
+			break;
 
-		// Check if the buffer size is identical to the written bytes count or an error has occurred
-		if (unWrittenBytes != PunBufferSize || 0 != ferror((FILE*)PpvFileHandle))
+		nFileHandle = open(szFileName, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+		if (-1 == nFileHandle)
 		{
-			unReturnValue = RC_E_FAIL;
+			unReturnValue = ENOENT == errno ? RC_E_FILE_NOT_FOUND : (EACCES == errno || EROFS == errno) ? RC_E_ACCESS_DENIED : RC_E_FAIL;
 			break;
 		}
 
+		if (-1 == flock(nFileHandle, LOCK_EX | LOCK_NB))
+		{
+			struct sigaction sAction;
+			struct sigaction sPreviousAction;
+			struct sigevent sEvent;
+			struct itimerspec sTimeout;
+			timer_t sTimer;
+			int nResult = 0;
+
+			if (EWOULDBLOCK != errno)
+				break;
+			if (0 == PunTimeoutSeconds)
+			{
+				unReturnValue = RC_E_DEVICE_ALREADY_IN_USE;
+				break;
+			}
+
+			// Wait blocked until the lock is released, a timer signal to this thread interrupts the wait on timeout
+			memset(&sAction, 0, sizeof(sAction));
+			sAction.sa_handler = FileIO_LockTimeoutHandler;
+			IGNORE_RETURN_VALUE(sigemptyset(&sAction.sa_mask));
+			memset(&sEvent, 0, sizeof(sEvent));
+			sEvent.sigev_notify = SIGEV_THREAD_ID;
+			sEvent.sigev_signo = SIGALRM;
+			sEvent.sigev_notify_thread_id = (pid_t)syscall(SYS_gettid);
+			memset(&sTimeout, 0, sizeof(sTimeout));
+			sTimeout.it_value.tv_sec = (time_t)PunTimeoutSeconds;
+			if (0 != sigaction(SIGALRM, &sAction, &sPreviousAction))
+				break;
+			if (0 != timer_create(CLOCK_MONOTONIC, &sEvent, &sTimer))
+			{
+				IGNORE_RETURN_VALUE(sigaction(SIGALRM, &sPreviousAction, NULL));
+				break;
+			}
+			if (0 == timer_settime(sTimer, 0, &sTimeout, NULL))
+				nResult = flock(nFileHandle, LOCK_EX);
+			else
+				nResult = -1;
+			IGNORE_RETURN_VALUE(timer_delete(sTimer));
+			IGNORE_RETURN_VALUE(sigaction(SIGALRM, &sPreviousAction, NULL));
+
+			if (-1 == nResult)
+			{
+				unReturnValue = EINTR == errno ? RC_E_DEVICE_ALREADY_IN_USE : RC_E_FAIL;
+				break;
+			}
+		}
+
+		*PppvLock = Platform_MemoryAllocateZero(sizeof(int));
+		if (NULL == *PppvLock)
+			break;
+		*(int*)*PppvLock = nFileHandle;
+		nFileHandle = -1;
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
+	// Closing the file releases a lock acquired in an error case
+	if (-1 != nFileHandle)
+		IGNORE_RETURN_VALUE(close(nFileHandle));
+	Platform_MemoryFree((void**)&szFileName);
+
 	return unReturnValue;
 }
 
 /**
- *	@brief		Remove a file
+ *	@brief		Releases a lock acquired by FileIO_LockFile
+ *	@details	The lock file is kept, so that waiting processes keep waiting on the same file.
+ *
+ *	@param		PppvLock		Pointer to the lock handle. Set to NULL on return.
+ */
+void
+FileIO_UnlockFile(
+	_Inout_ void** PppvLock)
+{
+	if (NULL == PppvLock || NULL == *PppvLock)
+		return;
+
+	// Closing the file releases the lock
+	IGNORE_RETURN_VALUE(close(*(int*)*PppvLock));
+	Platform_MemoryFree(PppvLock);
+}
+
+/// File watched by FileIO_WatchOpen
+typedef struct tdIfxFileWatch
+{
+	/// inotify descriptor watching the directory of the file, -1 if the file status is compared instead
+	int nNotify;
+	/// Name of the file within its directory
+	char szName[MAX_PATH];
+	/// Path of the file
+	char szPath[MAX_PATH];
+	/// Status of the file at the last check, used without inotify
+	struct stat sStat;
+	/// TRUE if sStat is valid
+	BOOL fStat;
+} IfxFileWatch;
+
+/**
+ *	@brief		Compare the status of a watched file with the status at the last check
  *	@details
  *
- *	@param		PwszFileName		File name
+ *	@param		PpWatch				File watch
+ *	@retval		TRUE				The file has been written, replaced, created or removed since the last check.
+ *	@retval		FALSE				Otherwise.
+ */
+static BOOL
+FileIO_WatchCompareStatus(
+	_Inout_ IfxFileWatch* PpWatch)
+{
+	struct stat sStat;
+	BOOL fStat = 0 == stat(PpWatch->szPath, &sStat) ? TRUE : FALSE;
+	BOOL fChanged = fStat != PpWatch->fStat;
+
+	if (!fChanged && fStat)
+		fChanged = sStat.st_ino != PpWatch->sStat.st_ino || sStat.st_size != PpWatch->sStat.st_size ||
+			sStat.st_mtim.tv_sec != PpWatch->sStat.st_mtim.tv_sec || sStat.st_mtim.tv_nsec != PpWatch->sStat.st_mtim.tv_nsec;
+	PpWatch->sStat = sStat;
+	PpWatch->fStat = fStat;
+
+	return fChanged;
+}
+
+/**
+ *	@brief		Start watching a file for changes
+ *	@details	The directory of the file is watched with inotify, so a file replaced by a rename (as most editors and
+ *				configuration management tools save) is still seen. Without inotify the file status is compared on each
+ *				FileIO_WatchChanged call instead. The file does not need to exist. The watch must be closed with
+ *				FileIO_WatchClose.
+ *
+ *	@param		PwszFileName		File to watch
+ *	@param		PppvWatch			Receives the watch handle
  *	@retval		RC_SUCCESS			The operation completed successfully.
- *	@retval		RC_E_ACCESS_DENIED	In case of a read-only or opened file
- *	@retval		RC_E_FILE_NOT_FOUND	The file does not exist.
- *	@retval		RC_E_INTERNAL		In all other cases where the file could not be removed
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
  *	@retval		RC_E_FAIL			An unexpected error occurred.
  */
 _Check_return_
 unsigned int
-FileIO_Remove(
-	_In_z_ const wchar_t* PwszFileName)
+FileIO_WatchOpen(
+	_In_z_						const wchar_t*	PwszFileName,
+	_Outptr_result_maybenull_	void**			PppvWatch)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	char* szFileName = NULL;
+	IfxFileWatch* pWatch = NULL;
 
 	do
 	{
+		char szDirectory[MAX_PATH] = {0};
+		char* pszSeparator = NULL;
 		size_t sizeFileName = 0;
 
-		// Check parameter
-		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName))
+		// Check parameters
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFileName) || NULL == PppvWatch)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
+		*PppvWatch = NULL;
 
-		// For remove operation the file name (wide character string) needs to be converted to multibyte string
-		// Get the required size for the multibyte string.
-		sizeFileName = wcsrtombs(NULL, &PwszFileName, 0, NULL);
-		if ((size_t) - 1 == sizeFileName)
-		{
-			unReturnValue = RC_E_FAIL;
+		pWatch = (IfxFileWatch*)Platform_MemoryAllocateZero(sizeof(IfxFileWatch));
+		if (NULL == pWatch)
 			break;
-		}
+		pWatch->nNotify = -1;
 
-		// Allocate memory for the multibyte string
-		szFileName = (char*) Platform_MemoryAllocateZero(sizeFileName + 1);
-		if (NULL == szFileName)
+		// The file name (wide character string) needs to be converted to multibyte string
+		sizeFileName = wcstombs(pWatch->szPath, PwszFileName, sizeof(pWatch->szPath));
+		if ((size_t) - 1 == sizeFileName || sizeof(pWatch->szPath) == sizeFileName)
 		{
-			unReturnValue = RC_E_FAIL;
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
-		// Convert the wide character string to a multibyte string.
-		sizeFileName = wcsrtombs(szFileName, &PwszFileName, wcslen(PwszFileName), NULL);
-		if ((size_t) - 1 == sizeFileName)
+		// Split the path into the directory and the file name
+		pszSeparator = strrchr(pWatch->szPath, '/');
+		if (NULL == pszSeparator)
 		{
-			unReturnValue = RC_E_FAIL;
-			break;
+			memcpy(szDirectory, ".", 2);
+			memcpy(pWatch->szName, pWatch->szPath, sizeFileName + 1);
+		}
+		else
+		{
+			size_t sizeDirectory = pszSeparator == pWatch->szPath ? 1 : (size_t)(pszSeparator - pWatch->szPath);
+			memcpy(szDirectory, pWatch->szPath, sizeDirectory);
+			memcpy(pWatch->szName, pszSeparator + 1, strlen(pszSeparator + 1) + 1);
 		}
 
-		if (0 != unlink(szFileName))
+		// Fall back to the file status if inotify is not available, e.g. the limit of watches is reached
+		pWatch->nNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (-1 != pWatch->nNotify &&
+				-1 == inotify_add_watch(pWatch->nNotify, szDirectory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR))
 		{
-			switch(errno)
-			{
-				case EACCES:
-					unReturnValue = RC_E_ACCESS_DENIED;
-					break;
-				case ENOENT:
-					unReturnValue = RC_E_FILE_NOT_FOUND;
-					break;
-				default:
-					unReturnValue = RC_E_INTERNAL;
-					break;
-			}
+			IGNORE_RETURN_VALUE(close(pWatch->nNotify));
+			pWatch->nNotify = -1;
 		}
-		else
-			unReturnValue = RC_SUCCESS;
+		IGNORE_RETURN_VALUE(FileIO_WatchCompareStatus(pWatch));
+
+		*PppvWatch = pWatch;
+		pWatch = NULL;
+		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
-	// Cleanup memory
-	if (szFileName != NULL)
+	Platform_MemoryFree((void**)&pWatch);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Check a watched file for changes
+ *	@details	Does not block. Only completed writes are reported (the file is closed after writing, renamed to the watched
+ *				name, created or removed), so a file still being written is not seen half written.
+ *
+ *	@param		PpvWatch			Watch handle returned by FileIO_WatchOpen
+ *	@retval		TRUE				The file has changed since the watch was opened or last checked.
+ *	@retval		FALSE				The file has not changed or PpvWatch is NULL.
+ */
+BOOL
+FileIO_WatchChanged(
+	_In_opt_ void* PpvWatch)
+{
+	IfxFileWatch* pWatch = (IfxFileWatch*)PpvWatch;
+	BOOL fChanged = FALSE;
+
+	if (NULL == pWatch)
+		return FALSE;
+	if (-1 == pWatch->nNotify)
+		return FileIO_WatchCompareStatus(pWatch);
+
+	// Drain all pending events of the directory
+	for (;;)
 	{
-		Platform_MemoryFree((void**)&szFileName);
-		szFileName = NULL;
+		BYTE rgbEvents[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+		ssize_t nRead = read(pWatch->nNotify, rgbEvents, sizeof(rgbEvents));
+		ssize_t nOffset = 0;
+
+		if (-1 == nRead && EINTR == errno)
+			continue;
+		if (nRead <= 0)
+			break;
+		while (nOffset + (ssize_t)sizeof(struct inotify_event) <= nRead)
+		{
+			const struct inotify_event* pEvent = (const struct inotify_event*)&rgbEvents[nOffset];
+
+			// Events lost by a queue overflow may concern the file
+			if (0 != (pEvent->mask & IN_Q_OVERFLOW) || (0 != pEvent->len && 0 == strcmp(pEvent->name, pWatch->szName)))
+				fChanged = TRUE;
+			nOffset += (ssize_t)sizeof(struct inotify_event) + (ssize_t)pEvent->len;
+		}
 	}
 
-	return unReturnValue;
+	return fChanged;
+}
+
+/**
+ *	@brief		Stop watching a file opened by FileIO_WatchOpen
+ *
+ *	@param		PppvWatch			Pointer to the watch handle. Set to NULL on return.
+ */
+void
+FileIO_WatchClose(
+	_Inout_ void** PppvWatch)
+{
+	if (NULL == PppvWatch || NULL == *PppvWatch)
+		return;
+
+	if (-1 != ((IfxFileWatch*)*PppvWatch)->nNotify)
+		IGNORE_RETURN_VALUE(close(((IfxFileWatch*)*PppvWatch)->nNotify));
+	Platform_MemoryFree(PppvWatch);
 }
@@ -20,6 +20,22 @@
 #include "TPM2_Marshal.h"
 #include "TPM2_Types.h"
 
+/**
+ *	@brief		Checks if a character is allowed in a version string (alphanumeric characters and [._] character)
+ *
+ *	@param		PwchChar				Character
+ *	@retval		TRUE					The character is allowed.
+ *	@retval		FALSE					Otherwise
+ */
+_Check_return_
+BOOL
+FirmwareImage_IsVersionCharacter(
+	_In_	wchar_t		PwchChar)
+{
+	return ((PwchChar >= L'0' && PwchChar <= L'9') || (PwchChar >= L'A' && PwchChar <= L'Z') ||
+			(PwchChar >= L'a' && PwchChar <= L'z') || (PwchChar == L'.') || (PwchChar == L'_')) ? TRUE : FALSE;
+}
+
 /**
  *	@brief		Verifies that a given string consists of alphanumeric characters and [._] character only.
  *	@details	This function verifies that a given string consists of alphanumeric characters and [._] character only.
@@ -41,10 +57,7 @@ FirmwareImage_VerifyString(
 		unsigned int unPos = 0;
 		for (unPos = 0; unPos < PunBufferLength; unPos++)
 		{
-			const wchar_t wchChar = PwszBuffer[unPos];
-			if (!(
-						(wchChar >= L'0' && wchChar <= L'9') || (wchChar >= L'A' && wchChar <= L'Z') ||
-						(wchChar >= L'a' && wchChar <= L'z') || (wchChar == L'.') || (wchChar == L'_')))
+			if (FALSE == FirmwareImage_IsVersionCharacter(PwszBuffer[unPos]))
 			{
 				unReturnValue = RC_E_BAD_PARAMETER;
 				break;
@@ -58,9 +71,97 @@ FirmwareImage_VerifyString(
 }
 
 /**
- *	@brief		Function to unmarshal a IfxFirmwareImage from a byte stream
- *	@details	This function unmarshals the structures parameters. For all fields with variable
- *				size the output structure contains a pointer to the buffers address where the data can be found.
+ *	@brief		Determines the length of a Unicode string (16bit per character) in a byte stream
+ *	@details	The same limits apply as for Platform_UnmarshalString with a target buffer of 256 characters, but the string is not converted.
+ *
+ *	@param		PrgbBuffer				Binary buffer
+ *	@param		PunBufferLen			Length of binary buffer
+ *	@param		PpunLength				Receives the length of the string in characters without terminating NULL character
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The binary buffer holds more than 255 characters.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_ScanString(
+	_In_bytecount_(PunBufferLen)	const BYTE*		PrgbBuffer,
+	_In_							unsigned int	PunBufferLen,
+	_Out_							unsigned int*	PpunLength)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unPos = 0;
+
+		// Check parameters
+		if (NULL == PrgbBuffer || 0 == PunBufferLen || NULL == PpunLength)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpunLength = 0;
+
+		// Input buffer must have even length
+		if (PunBufferLen % 2 != 0)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		if (PunBufferLen / 2 >= 256)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		for (unPos = 0; unPos < PunBufferLen / 2; unPos++)
+		{
+			if (0x00 == PrgbBuffer[2 * unPos] && 0x00 == PrgbBuffer[2 * unPos + 1])
+				break;
+		}
+
+		*PpunLength = unPos;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Verifies that a Unicode string (16bit per character) in a byte stream consists of alphanumeric characters and [._] character only.
+ *
+ *	@param		PrgbBuffer				Binary buffer
+ *	@param		PunLength				Length of the string in characters
+ *	@retval		RC_SUCCESS				In case the string consists of alphanumeric characters and [._] character only.
+ *	@retval		RC_E_BAD_PARAMETER		Otherwise
+ */
+_Check_return_
+unsigned int
+FirmwareImage_VerifyMarshaledString(
+	_In_bytecount_(PunLength * 2)	const BYTE*		PrgbBuffer,
+	_In_							unsigned int	PunLength)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unPos = 0;
+
+	for (unPos = 0; unPos < PunLength; unPos++)
+	{
+		const wchar_t wchChar = (wchar_t)(PrgbBuffer[2 * unPos] | PrgbBuffer[2 * unPos + 1] << 8);
+		if (FALSE == FirmwareImage_IsVersionCharacter(wchChar))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Function to unmarshal a IfxFirmwareImageView from a byte stream
+ *	@details	This function unmarshals and checks the structures parameters like FirmwareImage_Unmarshal. The version strings
+ *				and all fields with variable size are not copied, the output structure contains pointers into the byte stream.
  *
  *	@param		PpTarget				Pointer to the target structure; must be allocated by the caller
  *	@param		PprgbBuffer				Pointer to a byte stream containing the firmware image data; will be increased during execution by the amount of unmarshalled bytes
@@ -71,10 +172,10 @@ FirmwareImage_VerifyString(
  */
 _Check_return_
 unsigned int
-FirmwareImage_Unmarshal(
-	_Out_	IfxFirmwareImage*	PpTarget,
-	_Inout_	BYTE**				PprgbBuffer,
-	_Inout_	INT32*				PpnBufferSize)
+FirmwareImage_UnmarshalView(
+	_Out_	IfxFirmwareImageView*	PpTarget,
+	_Inout_	BYTE**					PprgbBuffer,
+	_Inout_	INT32*					PpnBufferSize)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
@@ -88,7 +189,7 @@ FirmwareImage_Unmarshal(
 		}
 
 		// Initialize out parameter
-		unReturnValue = Platform_MemorySet(PpTarget, 0, sizeof(IfxFirmwareImage));
+		unReturnValue = Platform_MemorySet(PpTarget, 0, sizeof(IfxFirmwareImageView));
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -144,49 +245,47 @@ FirmwareImage_Unmarshal(
 			PpTarget->usSourceVersionsCount = 0;
 			do
 			{
-				wchar_t wszBuffer[256] = {0};
-				unsigned int unLength = RG_LEN(wszBuffer);
+				unsigned int unLength = 0;
 
-				// Unmarshal the binary source version blob to a string
-				unReturnValue = Platform_UnmarshalString(rgbBuffer, (unsigned int)nBufferSize, &wszBuffer[0], &unLength);
+				// Determine the length of the binary source version blob
+				unReturnValue = FirmwareImage_ScanString(rgbBuffer, (unsigned int)nBufferSize, &unLength);
 				if (RC_SUCCESS != unReturnValue)
 					break;
 
-				if (0 != unLength)
+				// The double null-termination ends the loop before an empty string, so only an empty first string gets here
+				if (0 == unLength)
 				{
-					// Maximum size for allowed source version is 64 characters
-					if (unLength > 64)
-					{
-						unReturnValue = RC_E_BAD_PARAMETER;
-						break;
-					}
+					unReturnValue = RC_E_BAD_PARAMETER;
+					break;
+				}
 
-					// Allowed source version value must consist of alphanumeric characters and [._] character only
-					unReturnValue = FirmwareImage_VerifyString(wszBuffer, unLength);
-					if (RC_SUCCESS != unReturnValue)
-						break;
+				// Maximum size for allowed source version is 64 characters
+				if (unLength > 64)
+				{
+					unReturnValue = RC_E_BAD_PARAMETER;
+					break;
+				}
 
-					// Copy the source version to the target structure array.
-					{
-						unsigned int unSourceVersionLen = RG_LEN(PpTarget->rgwszSourceVersions[PpTarget->usSourceVersionsCount]);
-						unReturnValue = Platform_StringCopy(
-											PpTarget->rgwszSourceVersions[PpTarget->usSourceVersionsCount],
-											&unSourceVersionLen,
-											wszBuffer);
-						if (RC_SUCCESS != unReturnValue)
-							break;
-					}
+				// Allowed source version value must consist of alphanumeric characters and [._] character only
+				unReturnValue = FirmwareImage_VerifyMarshaledString(rgbBuffer, unLength);
+				if (RC_SUCCESS != unReturnValue)
+					break;
 
-					PpTarget->usSourceVersionsCount++;
-					// Reduce the remaining buffer size by unmarshalled string length (each character in the firmware image spans across 2 bytes).
-					nBufferSize -= (unLength + 1) * sizeof(uint16_t);
-				}
+				// Remember the position of the source version in the byte stream.
+				PpTarget->rgpbSourceVersions[PpTarget->usSourceVersionsCount] = rgbBuffer;
+				PpTarget->rgusSourceVersionLengths[PpTarget->usSourceVersionsCount] = (UINT16)unLength;
+
+				PpTarget->usSourceVersionsCount++;
+				// Reduce the remaining buffer size by unmarshalled string length (each character in the firmware image spans across 2 bytes).
+				// A string without null-termination leaves a negative size.
+				nBufferSize -= (unLength + 1) * sizeof(uint16_t);
 
 				// Advance the pointer to the next source version string.
 				rgbBuffer = (BYTE*)(rgbBuffer + ((unLength + 1) * sizeof(uint16_t)));
 			}
-			while (((rgbBuffer)[0] != 0x00 || (rgbBuffer)[1] != 0x00) && // Check for terminating NULL (L"\0" as uint16_t)
-					nBufferSize > 0 &&
+			// Check the remaining size before the terminating NULL (L"\0" as uint16_t) is read, ScanString only accepts an even size
+			while (nBufferSize > 0 &&
+					((rgbBuffer)[0] != 0x00 || (rgbBuffer)[1] != 0x00) &&
 					PpTarget->usSourceVersionsCount < MAX_SOURCE_VERSIONS_COUNT);
 
 			if (RC_SUCCESS != unReturnValue)
@@ -237,26 +336,19 @@ FirmwareImage_Unmarshal(
 
 		// Target version value must consist of alphanumeric characters and [._] character only
 		{
-			wchar_t wszBuffer[256] = {0};
-			unsigned int unLength = RG_LEN(wszBuffer);
+			unsigned int unLength = 0;
 
-			// Unmarshal the target version blob to a string
-			unReturnValue = Platform_UnmarshalString(*PprgbBuffer, PpTarget->usTargetVersionSize, &wszBuffer[0], &unLength);
+			// Determine the length of the target version blob
+			unReturnValue = FirmwareImage_ScanString(*PprgbBuffer, PpTarget->usTargetVersionSize, &unLength);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
 			// Target version value must consist of alphanumeric characters and [._] character only
-			unReturnValue = FirmwareImage_VerifyString(wszBuffer, unLength);
+			unReturnValue = FirmwareImage_VerifyMarshaledString(*PprgbBuffer, unLength);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
-			// Copy the target version to the target structure.
-			{
-				unsigned int unTargetVersionLen = RG_LEN(PpTarget->wszTargetVersion);
-				unReturnValue = Platform_StringCopy(PpTarget->wszTargetVersion, &unTargetVersionLen, wszBuffer);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
+			PpTarget->rgbTargetVersion = *PprgbBuffer;
 		}
 
 		*PprgbBuffer = (BYTE*)(*PprgbBuffer + PpTarget->usTargetVersionSize);
@@ -280,26 +372,25 @@ FirmwareImage_Unmarshal(
 		{
 			// Get allowed versions from parameter block and store them in rgunIntSourceVersions
 			// For >= VERSION_3 images the data will be overwritten with section retrieved from metadata.
-			sSignedData_d sSignedData = {0};
+			sSignedDataView_d sSignedData = {0};
 			BYTE* rgbPolicyParameterBlock = PpTarget->rgbPolicyParameterBlock;
 			INT32 nPolicyParameterBlockSize = PpTarget->usPolicyParameterBlockSize;
 			// Unmarshal the block to sSignedData structure
-			unReturnValue = TSS_sSignedData_d_Unmarshal(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
+			unReturnValue = TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
 			if (RC_SUCCESS != unReturnValue)
 			{
-				ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_Unmarshal returned an unexpected value. (0x%.8x)", unReturnValue);
 				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
 				break;
 			}
 			// Get allowed versions from parameter block
 			{
 				unsigned int unIndex = 0;
-				PpTarget->usIntSourceVersionCount = sSignedData.sSignerInfo.sSignedAttributes.sVersions.wEntries;
+				PpTarget->usIntSourceVersionCount = sSignedData.sSignedAttributes.sVersions.wEntries;
 				for (unIndex = 0; unIndex < MAX_SOURCE_VERSIONS_COUNT; unIndex++)
 				{
 					if (unIndex < PpTarget->usIntSourceVersionCount)
 					{
-						PpTarget->rgunIntSourceVersions[unIndex] = sSignedData.sSignerInfo.sSignedAttributes.sVersions.Version[unIndex];
+						PpTarget->rgunIntSourceVersions[unIndex] = sSignedData.sSignedAttributes.sVersions.Version[unIndex];
 					}
 					else
 					{
@@ -383,7 +474,7 @@ FirmwareImage_Unmarshal(
 											  sizeof(PpTarget->usIntSourceVersionCount) +
 											  sizeof(PpTarget->rgunIntSourceVersions) +
 											  sizeof(PpTarget->usSignatureKeyId) +
-											  sizeof(PpTarget->rgbSignature));
+											  FIRMWARE_IMAGE_SIGNATURE_SIZE);
 							*PprgbBuffer += nOffset;
 							*PpnBufferSize -= nOffset;
 						}
@@ -393,10 +484,15 @@ FirmwareImage_Unmarshal(
 						if (RC_SUCCESS != unReturnValue)
 							break;
 
-						// Unmarshal signature
-						unReturnValue = TSS_BYTE_Array_Unmarshal((BYTE*)&PpTarget->rgbSignature, PprgbBuffer, PpnBufferSize, sizeof(PpTarget->rgbSignature));
-						if (RC_SUCCESS != unReturnValue)
+						// Set pointer to the signature
+						if (FIRMWARE_IMAGE_SIGNATURE_SIZE > *PpnBufferSize)
+						{
+							unReturnValue = RC_E_BUFFER_TOO_SMALL;
 							break;
+						}
+						PpTarget->rgbSignature = *PprgbBuffer;
+						*PprgbBuffer = (BYTE*)(*PprgbBuffer + FIRMWARE_IMAGE_SIGNATURE_SIZE);
+						*PpnBufferSize -= FIRMWARE_IMAGE_SIGNATURE_SIZE;
 					}
 				}
 			}
@@ -420,3 +516,604 @@ FirmwareImage_Unmarshal(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Function to unmarshal a IfxFirmwareImage from a byte stream
+ *	@details	This function unmarshals the structures parameters with FirmwareImage_UnmarshalView and converts the version strings.
+ *				For all other fields with variable size the output structure contains a pointer to the buffers address where the data can be found.
+ *
+ *	@param		PpTarget				Pointer to the target structure; must be allocated by the caller
+ *	@param		PprgbBuffer				Pointer to a byte stream containing the firmware image data; will be increased during execution by the amount of unmarshalled bytes
+ *	@param		PpnBufferSize			Size of elements readable from the byte stream; will be decreased during execution by the amount of unmarshalled bytes
+ *	@retval		RC_SUCCESS				In case the firmware is updatable with the given firmware
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function or an error occurred at unmarshal.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	In case an output buffer is too small for an input byte array
+ */
+_Check_return_
+unsigned int
+FirmwareImage_Unmarshal(
+	_Out_	IfxFirmwareImage*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxFirmwareImageView sView;
+		UINT16 usIndex = 0;
+
+		// Check out parameter
+		if (NULL == PpTarget)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Initialize out parameter
+		unReturnValue = Platform_MemorySet(PpTarget, 0, sizeof(IfxFirmwareImage));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FirmwareImage_UnmarshalView(&sView, PprgbBuffer, PpnBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		PpTarget->unique = sView.unique;
+		PpTarget->bSourceTpmFamily = sView.bSourceTpmFamily;
+		PpTarget->usSourceVersionsCount = sView.usSourceVersionsCount;
+		PpTarget->bTargetTpmFamily = sView.bTargetTpmFamily;
+		PpTarget->usTargetVersionSize = sView.usTargetVersionSize;
+		PpTarget->usPolicyParameterBlockSize = sView.usPolicyParameterBlockSize;
+		PpTarget->rgbPolicyParameterBlock = sView.rgbPolicyParameterBlock;
+		PpTarget->unFirmwareSize = sView.unFirmwareSize;
+		PpTarget->rgbFirmware = sView.rgbFirmware;
+		PpTarget->usImageStructureVersion = sView.usImageStructureVersion;
+		PpTarget->bfTargetState = sView.bfTargetState;
+		PpTarget->bfCapabilities = sView.bfCapabilities;
+		PpTarget->usIntSourceVersionCount = sView.usIntSourceVersionCount;
+		PpTarget->unChecksum = sView.unChecksum;
+		PpTarget->usSignatureKeyId = sView.usSignatureKeyId;
+		unReturnValue = Platform_MemoryCopy(PpTarget->rgunIntSourceVersions, sizeof(PpTarget->rgunIntSourceVersions), sView.rgunIntSourceVersions, sizeof(sView.rgunIntSourceVersions));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (NULL != sView.rgbSignature)
+		{
+			unReturnValue = Platform_MemoryCopy(PpTarget->rgbSignature, sizeof(PpTarget->rgbSignature), sView.rgbSignature, FIRMWARE_IMAGE_SIGNATURE_SIZE);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		// Convert the version strings
+		for (usIndex = 0; usIndex < sView.usSourceVersionsCount; usIndex++)
+		{
+			unsigned int unSourceVersionLen = RG_LEN(PpTarget->rgwszSourceVersions[usIndex]);
+			unReturnValue = FirmwareImage_GetSourceVersion(&sView, usIndex, PpTarget->rgwszSourceVersions[usIndex], &unSourceVersionLen);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		{
+			unsigned int unTargetVersionLen = RG_LEN(PpTarget->wszTargetVersion);
+			unReturnValue = FirmwareImage_GetTargetVersion(&sView, PpTarget->wszTargetVersion, &unTargetVersionLen);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Converts an allowed source version of a IfxFirmwareImageView to a string
+ *
+ *	@param		PpView					Pointer to the unmarshalled firmware image view
+ *	@param		PusIndex				Index of the source version, less than usSourceVersionsCount
+ *	@param		PwszVersion				Receives the source version including null-termination
+ *	@param		PpunVersionSize			On input the capacity of PwszVersion in elements, on output the length of the string without terminating NULL character
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszVersion is too small.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_GetSourceVersion(
+	_In_							const IfxFirmwareImageView*	PpView,
+	_In_							UINT16						PusIndex,
+	_Out_z_cap_(*PpunVersionSize)	wchar_t*					PwszVersion,
+	_Inout_							unsigned int*				PpunVersionSize)
+{
+	if (NULL == PpView || PusIndex >= PpView->usSourceVersionsCount)
+		return RC_E_BAD_PARAMETER;
+
+	return Platform_UnmarshalString(PpView->rgpbSourceVersions[PusIndex], PpView->rgusSourceVersionLengths[PusIndex] * 2U, PwszVersion, PpunVersionSize);
+}
+
+/**
+ *	@brief		Converts the target version of a IfxFirmwareImageView to a string
+ *
+ *	@param		PpView					Pointer to the unmarshalled firmware image view
+ *	@param		PwszVersion				Receives the target version including null-termination
+ *	@param		PpunVersionSize			On input the capacity of PwszVersion in elements, on output the length of the string without terminating NULL character
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszVersion is too small.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_GetTargetVersion(
+	_In_							const IfxFirmwareImageView*	PpView,
+	_Out_z_cap_(*PpunVersionSize)	wchar_t*					PwszVersion,
+	_Inout_							unsigned int*				PpunVersionSize)
+{
+	if (NULL == PpView || NULL == PpView->rgbTargetVersion)
+		return RC_E_BAD_PARAMETER;
+
+	return Platform_UnmarshalString(PpView->rgbTargetVersion, PpView->usTargetVersionSize, PwszVersion, PpunVersionSize);
+}
+
+/**
+ *	@brief		Checks if a byte stream is a firmware image bundle
+ *	@details	A firmware image bundle contains the firmware images of several update paths. It starts with a header
+ *				(magic FIRMWARE_BUNDLE_MAGIC, big-endian UINT16 format version, entry count, entry size and a reserved UINT16),
+ *				followed by the table of contents and the firmware images aligned to FIRMWARE_BUNDLE_PAYLOAD_ALIGNMENT.
+ *				A bundle of format FIRMWARE_BUNDLE_FORMAT_VERSION_CHUNKED stores each firmware image as a list of chunks
+ *				instead, the chunks are shared by the firmware images.
+ *
+ *	@param		PrgbBuffer				Byte stream
+ *	@param		PunBufferSize			Size of the byte stream
+ *	@retval		TRUE					The byte stream starts with the firmware image bundle magic value.
+ *	@retval		FALSE					Otherwise
+ */
+_Check_return_
+BOOL
+FirmwareImage_IsBundle(
+	_In_bytecount_(PunBufferSize)	const BYTE*		PrgbBuffer,
+	_In_							UINT32			PunBufferSize)
+{
+	return (NULL != PrgbBuffer && FIRMWARE_BUNDLE_HEADER_SIZE <= PunBufferSize &&
+			0 == Platform_MemoryCompare(PrgbBuffer, FIRMWARE_BUNDLE_MAGIC, sizeof(FIRMWARE_BUNDLE_MAGIC) - 1)) ? TRUE : FALSE;
+}
+
+/**
+ *	@brief		Compares a version field of a firmware image bundle table of contents entry to a version string
+ *
+ *	@param		PrgbVersion				Zero padded ASCII version field
+ *	@param		PwszVersion				Version string
+ *	@retval		TRUE					The versions are equal.
+ *	@retval		FALSE					Otherwise
+ */
+_Check_return_
+BOOL
+FirmwareImage_BundleVersionEquals(
+	_In_bytecount_(FIRMWARE_BUNDLE_VERSION_SIZE)	const BYTE*		PrgbVersion,
+	_In_z_											const wchar_t*	PwszVersion)
+{
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < FIRMWARE_BUNDLE_VERSION_SIZE; unIndex++)
+	{
+		if ((wchar_t)PrgbVersion[unIndex] != PwszVersion[unIndex])
+			return FALSE;
+		if (0 == PrgbVersion[unIndex])
+			return TRUE;
+	}
+
+	// The version field is not zero terminated, it matches only a version string of the same length
+	return (L'\0' == PwszVersion[unIndex]) ? TRUE : FALSE;
+}
+
+/**
+ *	@brief		Reads the header of a firmware image bundle
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PpusFormatVersion		Receives the format version
+ *	@param		PpusEntryCount			Receives the number of table of contents entries
+ *	@param		PpusEntrySize			Receives the size of a table of contents entry
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The firmware image bundle is corrupt.
+ *	@retval		RC_E_NEWER_TOOL_REQUIRED		The format version of the firmware image bundle is not supported.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_ReadBundleHeader(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_Out_							UINT16*			PpusFormatVersion,
+	_Out_							UINT16*			PpusEntryCount,
+	_Out_							UINT16*			PpusEntrySize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		BYTE* rgbBuffer = NULL;
+		INT32 nBufferSize = 0;
+
+		*PpusFormatVersion = 0;
+		*PpusEntryCount = 0;
+		*PpusEntrySize = 0;
+		if (FALSE == FirmwareImage_IsBundle(PrgbBundle, PunBundleSize) || INT32_MAX < PunBundleSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Unmarshal the header behind the magic value
+		rgbBuffer = PrgbBundle + sizeof(FIRMWARE_BUNDLE_MAGIC) - 1;
+		nBufferSize = (INT32)PunBundleSize - (INT32)(sizeof(FIRMWARE_BUNDLE_MAGIC) - 1);
+		unReturnValue = TSS_UINT16_Unmarshal(PpusFormatVersion, &rgbBuffer, &nBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT16_Unmarshal(PpusEntryCount, &rgbBuffer, &nBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT16_Unmarshal(PpusEntrySize, &rgbBuffer, &nBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (FIRMWARE_BUNDLE_FORMAT_VERSION != *PpusFormatVersion && FIRMWARE_BUNDLE_FORMAT_VERSION_CHUNKED != *PpusFormatVersion)
+		{
+			unReturnValue = RC_E_NEWER_TOOL_REQUIRED;
+			break;
+		}
+		// Entries may be larger than known by this version of the tool
+		if (FIRMWARE_BUNDLE_ENTRY_SIZE > *PpusEntrySize ||
+				(UINT64)FIRMWARE_BUNDLE_HEADER_SIZE + (UINT64)*PpusEntryCount * *PpusEntrySize > PunBundleSize)
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Reassembles a firmware image of a chunked firmware image bundle
+ *	@details	The chunk list holds big-endian UINT32 offset and size of each chunk in the order of the firmware image. The
+ *				chunks lie behind the table of contents and may be shared by several firmware images, so the firmware image
+ *				is copied chunk by chunk into allocated memory.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PunPayloadOffset		Offset of the first byte behind the table of contents
+ *	@param		PunChunkListOffset		Offset of the chunk list
+ *	@param		PunChunkCount			Number of chunks
+ *	@param		PunImageSize			Size of the firmware image
+ *	@param		PprgbImage				Receives the allocated firmware image
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The chunk list is corrupt or does not add up to the firmware image size.
+ *	@retval		RC_E_FAIL						The memory allocation failed.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_ReassembleBundleImage(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_In_							UINT32			PunPayloadOffset,
+	_In_							UINT32			PunChunkListOffset,
+	_In_							UINT32			PunChunkCount,
+	_In_							UINT32			PunImageSize,
+	_Out_							BYTE**			PprgbImage)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* rgbImage = NULL;
+
+	do
+	{
+		BYTE* rgbBuffer = PrgbBundle + PunChunkListOffset;
+		INT32 nBufferSize = 0;
+		UINT32 unChunk = 0;
+		UINT32 unImageOffset = 0;
+
+		*PprgbImage = NULL;
+
+		// The chunk list must be aligned and must not overlap the table of contents
+		if (0 != PunChunkListOffset % FIRMWARE_BUNDLE_CHUNK_LIST_ALIGNMENT || PunChunkListOffset < PunPayloadOffset || 0 == PunChunkCount ||
+				(UINT64)PunChunkListOffset + (UINT64)PunChunkCount * FIRMWARE_BUNDLE_CHUNK_ENTRY_SIZE > PunBundleSize)
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			break;
+		}
+		nBufferSize = (INT32)(PunChunkCount * FIRMWARE_BUNDLE_CHUNK_ENTRY_SIZE);
+
+		rgbImage = (BYTE*)Platform_MemoryAllocateZero(PunImageSize);
+		if (NULL == rgbImage)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		for (unChunk = 0; unChunk < PunChunkCount; unChunk++)
+		{
+			UINT32 unOffset = 0;
+			UINT32 unSize = 0;
+
+			unReturnValue = TSS_UINT32_Unmarshal(&unOffset, &rgbBuffer, &nBufferSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = TSS_UINT32_Unmarshal(&unSize, &rgbBuffer, &nBufferSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			if (unOffset < PunPayloadOffset || 0 == unSize || (UINT64)unOffset + unSize > PunBundleSize || unSize > PunImageSize - unImageOffset)
+			{
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+			unReturnValue = Platform_MemoryCopy(rgbImage + unImageOffset, PunImageSize - unImageOffset, PrgbBundle + unOffset, unSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unImageOffset += unSize;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (unImageOffset != PunImageSize)
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			break;
+		}
+
+		*PprgbImage = rgbImage;
+		rgbImage = NULL;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&rgbImage);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Returns the firmware image of a table of contents entry of a firmware image bundle
+ *	@details	In a chunked bundle the offset of the entry locates the chunk list of the firmware image and the reserved
+ *				UINT32 behind the size holds the number of chunks. The firmware image is reassembled then.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PusFormatVersion		Format version as returned by FirmwareImage_ReadBundleHeader
+ *	@param		PusEntryCount			Number of table of contents entries as returned by FirmwareImage_ReadBundleHeader
+ *	@param		PusEntrySize			Size of a table of contents entry as returned by FirmwareImage_ReadBundleHeader
+ *	@param		PusEntry				Index of the table of contents entry
+ *	@param		PprgbImage				Receives the pointer to the firmware image within PrgbBundle or to the reassembled firmware image
+ *	@param		PpunImageSize			Receives the size of the firmware image
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The table of contents entry is corrupt.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_ReadBundleEntry(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_In_							UINT16			PusFormatVersion,
+	_In_							UINT16			PusEntryCount,
+	_In_							UINT16			PusEntrySize,
+	_In_							UINT16			PusEntry,
+	_Out_							BYTE**			PprgbImage,
+	_Out_							UINT32*			PpunImageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		BYTE* rgbBuffer = PrgbBundle + FIRMWARE_BUNDLE_HEADER_SIZE + (UINT32)PusEntry * PusEntrySize + 4;
+		INT32 nEntrySize = FIRMWARE_BUNDLE_ENTRY_SIZE - 4;
+		UINT32 unOffset = 0;
+		UINT32 unSize = 0;
+		UINT32 unChunkCount = 0;
+
+		*PprgbImage = NULL;
+		*PpunImageSize = 0;
+
+		unReturnValue = TSS_UINT32_Unmarshal(&unOffset, &rgbBuffer, &nEntrySize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT32_Unmarshal(&unSize, &rgbBuffer, &nEntrySize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (FIRMWARE_BUNDLE_FORMAT_VERSION_CHUNKED == PusFormatVersion)
+		{
+			unReturnValue = TSS_UINT32_Unmarshal(&unChunkCount, &rgbBuffer, &nEntrySize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (0 == unSize)
+			{
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+			unReturnValue = FirmwareImage_ReassembleBundleImage(
+								PrgbBundle, PunBundleSize, FIRMWARE_BUNDLE_HEADER_SIZE + (UINT32)PusEntryCount * PusEntrySize,
+								unOffset, unChunkCount, unSize, PprgbImage);
+			if (RC_SUCCESS == unReturnValue)
+				*PpunImageSize = unSize;
+			break;
+		}
+
+		// The firmware image must be aligned and must not overlap the table of contents
+		if (0 != unOffset % FIRMWARE_BUNDLE_PAYLOAD_ALIGNMENT ||
+				(UINT64)unOffset < (UINT64)FIRMWARE_BUNDLE_HEADER_SIZE + (UINT64)PusEntryCount * PusEntrySize ||
+				0 == unSize || (UINT64)unOffset + unSize > PunBundleSize)
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			break;
+		}
+
+		*PprgbImage = PrgbBundle + unOffset;
+		*PpunImageSize = unSize;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Finds the firmware image for an update path in a firmware image bundle
+ *	@details	Only the header and the table of contents are read, the other firmware images are not accessed. Each table
+ *				of contents entry (FIRMWARE_BUNDLE_ENTRY_SIZE bytes) holds the source and target TPM family, reserved UINT16,
+ *				big-endian UINT32 offset and size of the firmware image, a reserved UINT32 and the source and target version
+ *				as zero padded ASCII strings of FIRMWARE_BUNDLE_VERSION_SIZE bytes. The returned firmware image is a byte
+ *				stream which can be passed to FirmwareImage_Unmarshal and must be released with
+ *				FirmwareImage_ReleaseBundleImage.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PbSourceTpmFamily		TPM family of the TPM to be updated (DEVICE_TYPE_TPM_12 or DEVICE_TYPE_TPM_20)
+ *	@param		PwszSourceVersion		Firmware version of the TPM to be updated
+ *	@param		PwszTargetVersion		Firmware version to update to or NULL for the first firmware image matching the source version
+ *	@param		PprgbImage				Receives the pointer to the firmware image within PrgbBundle
+ *	@param		PpunImageSize			Receives the size of the firmware image
+ *	@retval		RC_SUCCESS						The firmware image was found.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The firmware image bundle is corrupt.
+ *	@retval		RC_E_NEWER_TOOL_REQUIRED		The format version of the firmware image bundle is not supported.
+ *	@retval		RC_E_FIRMWARE_UPDATE_NOT_FOUND	The firmware image bundle does not contain a matching firmware image.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_FindInBundle(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_In_							BYTE			PbSourceTpmFamily,
+	_In_z_							const wchar_t*	PwszSourceVersion,
+	_In_opt_						const wchar_t*	PwszTargetVersion,
+	_Out_							BYTE**			PprgbImage,
+	_Out_							UINT32*			PpunImageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		UINT16 usFormatVersion = 0;
+		UINT16 usEntryCount = 0;
+		UINT16 usEntrySize = 0;
+		UINT16 usEntry = 0;
+
+		// Check parameters
+		if (NULL == PprgbImage || NULL == PpunImageSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PprgbImage = NULL;
+		*PpunImageSize = 0;
+		if (NULL == PwszSourceVersion)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = FirmwareImage_ReadBundleHeader(PrgbBundle, PunBundleSize, &usFormatVersion, &usEntryCount, &usEntrySize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Search the table of contents
+		unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+		for (usEntry = 0; usEntry < usEntryCount; usEntry++)
+		{
+			BYTE* rgbEntry = PrgbBundle + FIRMWARE_BUNDLE_HEADER_SIZE + (UINT32)usEntry * usEntrySize;
+
+			if (PbSourceTpmFamily != rgbEntry[0] ||
+					FALSE == FirmwareImage_BundleVersionEquals(rgbEntry + 16, PwszSourceVersion) ||
+					(NULL != PwszTargetVersion && FALSE == FirmwareImage_BundleVersionEquals(rgbEntry + 16 + FIRMWARE_BUNDLE_VERSION_SIZE, PwszTargetVersion)))
+				continue;
+
+			unReturnValue = FirmwareImage_ReadBundleEntry(PrgbBundle, PunBundleSize, usFormatVersion, usEntryCount, usEntrySize, usEntry, PprgbImage, PpunImageSize);
+			break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Returns a firmware image of a firmware image bundle by its index in the table of contents
+ *	@details	Only the header and the requested table of contents entry are read. The returned firmware image is a byte
+ *				stream which can be passed to FirmwareImage_Unmarshal and must be released with
+ *				FirmwareImage_ReleaseBundleImage.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PusIndex				Index of the table of contents entry
+ *	@param		PprgbImage				Receives the pointer to the firmware image within PrgbBundle
+ *	@param		PpunImageSize			Receives the size of the firmware image
+ *	@retval		RC_SUCCESS						The firmware image was found.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The firmware image bundle is corrupt.
+ *	@retval		RC_E_NEWER_TOOL_REQUIRED		The format version of the firmware image bundle is not supported.
+ *	@retval		RC_E_FIRMWARE_UPDATE_NOT_FOUND	PusIndex is beyond the last table of contents entry.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_GetBundleImage(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_In_							UINT16			PusIndex,
+	_Out_							BYTE**			PprgbImage,
+	_Out_							UINT32*			PpunImageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		UINT16 usFormatVersion = 0;
+		UINT16 usEntryCount = 0;
+		UINT16 usEntrySize = 0;
+
+		// Check parameters
+		if (NULL == PprgbImage || NULL == PpunImageSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PprgbImage = NULL;
+		*PpunImageSize = 0;
+
+		unReturnValue = FirmwareImage_ReadBundleHeader(PrgbBundle, PunBundleSize, &usFormatVersion, &usEntryCount, &usEntrySize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (PusIndex >= usEntryCount)
+		{
+			unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+			break;
+		}
+
+		unReturnValue = FirmwareImage_ReadBundleEntry(PrgbBundle, PunBundleSize, usFormatVersion, usEntryCount, usEntrySize, PusIndex, PprgbImage, PpunImageSize);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Releases a firmware image returned by FirmwareImage_FindInBundle or FirmwareImage_GetBundleImage
+ *	@details	A firmware image of a chunked bundle has been reassembled into allocated memory and is freed, any other
+ *				firmware image lies within PrgbBundle and is left alone. *PprgbImage is set to NULL.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream the firmware image has been taken from
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PprgbImage				Pointer to the firmware image, may point to NULL
+ */
+void
+FirmwareImage_ReleaseBundleImage(
+	_In_bytecount_(PunBundleSize)	const BYTE*		PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_Inout_							BYTE**			PprgbImage)
+{
+	if (NULL == PprgbImage || NULL == *PprgbImage)
+		return;
+
+	if (NULL == PrgbBundle || *PprgbImage < PrgbBundle || *PprgbImage >= PrgbBundle + PunBundleSize)
+		Platform_MemoryFree((void**)PprgbImage);
+	*PprgbImage = NULL;
+}
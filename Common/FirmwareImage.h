@@ -39,6 +39,28 @@ static const GUID EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID =
 /// The maximum supported number of source TPM firmware versions in an image file
 #define MAX_SOURCE_VERSIONS_COUNT 8
 
+/// Size of the firmware image signature in bytes
+#define FIRMWARE_IMAGE_SIGNATURE_SIZE 256
+
+/// Magic value at the beginning of a firmware image bundle file
+#define FIRMWARE_BUNDLE_MAGIC "IFXFWBDL"
+/// Supported firmware image bundle format version
+#define FIRMWARE_BUNDLE_FORMAT_VERSION 1
+/// Firmware image bundle format version storing the firmware images as lists of shared chunks
+#define FIRMWARE_BUNDLE_FORMAT_VERSION_CHUNKED 2
+/// Size of the firmware image bundle header in bytes
+#define FIRMWARE_BUNDLE_HEADER_SIZE 16
+/// Size of a firmware image bundle table of contents entry in bytes
+#define FIRMWARE_BUNDLE_ENTRY_SIZE 80
+/// Size of the version fields of a firmware image bundle table of contents entry in bytes
+#define FIRMWARE_BUNDLE_VERSION_SIZE 32
+/// Alignment of the firmware images in a firmware image bundle file
+#define FIRMWARE_BUNDLE_PAYLOAD_ALIGNMENT 0x1000
+/// Alignment of the chunk lists in a chunked firmware image bundle file
+#define FIRMWARE_BUNDLE_CHUNK_LIST_ALIGNMENT 4
+/// Size of a chunk list entry of a chunked firmware image bundle in bytes
+#define FIRMWARE_BUNDLE_CHUNK_ENTRY_SIZE 8
+
 /**
  *	@brief		TPM Target State bit field
  *	@details	This structure contains bit flags indicating the target state of the TPM after the firmware update.
@@ -116,9 +138,59 @@ typedef struct tdIfxFirmwareImage
 	/// Key identifier for signature
 	UINT16 usSignatureKeyId;
 	/// Byte array for signature
-	BYTE rgbSignature[256];
+	BYTE rgbSignature[FIRMWARE_IMAGE_SIGNATURE_SIZE];
 } IfxFirmwareImage;
 
+/**
+ *	@brief		Firmware image view
+ *	@details	Holds the same information as IfxFirmwareImage without copying data out of the firmware image byte stream.
+ *				The version strings can be converted with FirmwareImage_GetSourceVersion and FirmwareImage_GetTargetVersion.
+ *				The structure is only valid as long as the byte stream is.
+ */
+typedef struct tdIfxFirmwareImageView
+{
+	/// Unique identifier, see IfxFirmwareImage
+	GUID unique;
+	/// Allowed TPM family where the firmware image can be installed on. Either DEVICE_TYPE_TPM_12 or DEVICE_TYPE_TPM_20.
+	UINT8 bSourceTpmFamily;
+	/// Count of the allowed source versions
+	UINT16 usSourceVersionsCount;
+	/// Pointers to the allowed version names (16bit little-endian characters) in the byte stream
+	BYTE* rgpbSourceVersions[MAX_SOURCE_VERSIONS_COUNT];
+	/// Lengths of the allowed version names in characters without terminating NULL character
+	UINT16 rgusSourceVersionLengths[MAX_SOURCE_VERSIONS_COUNT];
+	/// Target TPM family. Either DEVICE_TYPE_TPM_12 or DEVICE_TYPE_TPM_20.
+	UINT8 bTargetTpmFamily;
+	/// Size in bytes of the target version name in rgbTargetVersion.
+	UINT16 usTargetVersionSize;
+	/// Pointer to the target version name (16bit little-endian characters) in the byte stream. Size is usTargetVersionSize.
+	BYTE* rgbTargetVersion;
+	/// Size in bytes of the policy parameter block in rgbPolicyParameterBlock.
+	UINT16 usPolicyParameterBlockSize;
+	/// Policy parameter block. Size is usPolicyParameterBlockSize.
+	UINT8* rgbPolicyParameterBlock;
+	/// Size in bytes of the firmware block in rgbFirmware.
+	UINT32 unFirmwareSize;
+	/// Firmware block. Size is unFirmwareSize.
+	UINT8* rgbFirmware;
+	/// Version number indicating the structure version of the firmware image.
+	UINT16 usImageStructureVersion;
+	/// Target state
+	BITFIELD_TPM_TARGET_STATE bfTargetState;
+	/// Firmware image capabilities
+	BITFIELD_FIRMWARE_IMAGE_CAPABILITIES bfCapabilities;
+	/// Count of the allowed source versions (unsigned integer representation)
+	UINT16 usIntSourceVersionCount;
+	/// Allowed source versions (unsigned integer representation)
+	UINT32 rgunIntSourceVersions[MAX_SOURCE_VERSIONS_COUNT];
+	/// Checksum over the IfxFirmwareImage structure excluding the unChecksum field.
+	UINT32 unChecksum;
+	/// Key identifier for signature
+	UINT16 usSignatureKeyId;
+	/// Pointer to the signature in the byte stream (FIRMWARE_IMAGE_SIGNATURE_SIZE bytes) or NULL if the image has no signature
+	BYTE* rgbSignature;
+} IfxFirmwareImageView;
+
 /**
  *	@brief		Function to unmarshal a IfxFirmwareImage from a byte stream
  *	@details	This function unmarshals the structures parameters. For all fields with variable
@@ -138,6 +210,154 @@ FirmwareImage_Unmarshal(
 	_Inout_	BYTE**				PprgbBuffer,
 	_Inout_	INT32*				PpnBufferSize);
 
+/**
+ *	@brief		Function to unmarshal a IfxFirmwareImageView from a byte stream
+ *	@details	This function unmarshals and checks the structures parameters like FirmwareImage_Unmarshal. The version strings
+ *				and all fields with variable size are not copied, the output structure contains pointers into the byte stream.
+ *
+ *	@param		PpTarget				Pointer to the target structure; must be allocated by the caller
+ *	@param		PprgbBuffer				Pointer to a byte stream containing the firmware image data; will be increased during execution by the amount of unmarshalled bytes
+ *	@param		PpnBufferSize			Size of elements readable from the byte stream; will be decreased during execution by the amount of unmarshalled bytes
+ *	@retval		RC_SUCCESS				In case the firmware is updatable with the given firmware
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function or an error occurred at unmarshal.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	In case an output buffer is too small for an input byte array
+ */
+_Check_return_
+unsigned int
+FirmwareImage_UnmarshalView(
+	_Out_	IfxFirmwareImageView*	PpTarget,
+	_Inout_	BYTE**					PprgbBuffer,
+	_Inout_	INT32*					PpnBufferSize);
+
+/**
+ *	@brief		Converts an allowed source version of a IfxFirmwareImageView to a string
+ *
+ *	@param		PpView					Pointer to the unmarshalled firmware image view
+ *	@param		PusIndex				Index of the source version, less than usSourceVersionsCount
+ *	@param		PwszVersion				Receives the source version including null-termination
+ *	@param		PpunVersionSize			On input the capacity of PwszVersion in elements, on output the length of the string without terminating NULL character
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszVersion is too small.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_GetSourceVersion(
+	_In_							const IfxFirmwareImageView*	PpView,
+	_In_							UINT16						PusIndex,
+	_Out_z_cap_(*PpunVersionSize)	wchar_t*					PwszVersion,
+	_Inout_							unsigned int*				PpunVersionSize);
+
+/**
+ *	@brief		Converts the target version of a IfxFirmwareImageView to a string
+ *
+ *	@param		PpView					Pointer to the unmarshalled firmware image view
+ *	@param		PwszVersion				Receives the target version including null-termination
+ *	@param		PpunVersionSize			On input the capacity of PwszVersion in elements, on output the length of the string without terminating NULL character
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	PwszVersion is too small.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_GetTargetVersion(
+	_In_							const IfxFirmwareImageView*	PpView,
+	_Out_z_cap_(*PpunVersionSize)	wchar_t*					PwszVersion,
+	_Inout_							unsigned int*				PpunVersionSize);
+
+/**
+ *	@brief		Checks if a byte stream is a firmware image bundle
+ *	@details	A firmware image bundle contains the firmware images of several update paths. It starts with a header
+ *				(magic FIRMWARE_BUNDLE_MAGIC, big-endian UINT16 format version, entry count, entry size and a reserved UINT16),
+ *				followed by the table of contents and the firmware images aligned to FIRMWARE_BUNDLE_PAYLOAD_ALIGNMENT.
+ *				A bundle of format FIRMWARE_BUNDLE_FORMAT_VERSION_CHUNKED stores each firmware image as a list of chunks
+ *				instead, the chunks are shared by the firmware images.
+ *
+ *	@param		PrgbBuffer				Byte stream
+ *	@param		PunBufferSize			Size of the byte stream
+ *	@retval		TRUE					The byte stream starts with the firmware image bundle magic value.
+ *	@retval		FALSE					Otherwise
+ */
+_Check_return_
+BOOL
+FirmwareImage_IsBundle(
+	_In_bytecount_(PunBufferSize)	const BYTE*		PrgbBuffer,
+	_In_							UINT32			PunBufferSize);
+
+/**
+ *	@brief		Finds the firmware image for an update path in a firmware image bundle
+ *	@details	Only the header and the table of contents are read, the other firmware images are not accessed. Each table
+ *				of contents entry (FIRMWARE_BUNDLE_ENTRY_SIZE bytes) holds the source and target TPM family, reserved UINT16,
+ *				big-endian UINT32 offset and size of the firmware image, a reserved UINT32 and the source and target version
+ *				as zero padded ASCII strings of FIRMWARE_BUNDLE_VERSION_SIZE bytes. The returned firmware image is a byte
+ *				stream which can be passed to FirmwareImage_Unmarshal and must be released with
+ *				FirmwareImage_ReleaseBundleImage.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PbSourceTpmFamily		TPM family of the TPM to be updated (DEVICE_TYPE_TPM_12 or DEVICE_TYPE_TPM_20)
+ *	@param		PwszSourceVersion		Firmware version of the TPM to be updated
+ *	@param		PwszTargetVersion		Firmware version to update to or NULL for the first firmware image matching the source version
+ *	@param		PprgbImage				Receives the pointer to the firmware image within PrgbBundle
+ *	@param		PpunImageSize			Receives the size of the firmware image
+ *	@retval		RC_SUCCESS						The firmware image was found.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The firmware image bundle is corrupt.
+ *	@retval		RC_E_NEWER_TOOL_REQUIRED		The format version of the firmware image bundle is not supported.
+ *	@retval		RC_E_FIRMWARE_UPDATE_NOT_FOUND	The firmware image bundle does not contain a matching firmware image.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_FindInBundle(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_In_							BYTE			PbSourceTpmFamily,
+	_In_z_							const wchar_t*	PwszSourceVersion,
+	_In_opt_						const wchar_t*	PwszTargetVersion,
+	_Out_							BYTE**			PprgbImage,
+	_Out_							UINT32*			PpunImageSize);
+
+/**
+ *	@brief		Returns a firmware image of a firmware image bundle by its index in the table of contents
+ *	@details	Only the header and the requested table of contents entry are read. The returned firmware image is a byte
+ *				stream which can be passed to FirmwareImage_Unmarshal and must be released with
+ *				FirmwareImage_ReleaseBundleImage.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PusIndex				Index of the table of contents entry
+ *	@param		PprgbImage				Receives the pointer to the firmware image within PrgbBundle
+ *	@param		PpunImageSize			Receives the size of the firmware image
+ *	@retval		RC_SUCCESS						The firmware image was found.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE			The firmware image bundle is corrupt.
+ *	@retval		RC_E_NEWER_TOOL_REQUIRED		The format version of the firmware image bundle is not supported.
+ *	@retval		RC_E_FIRMWARE_UPDATE_NOT_FOUND	PusIndex is beyond the last table of contents entry.
+ */
+_Check_return_
+unsigned int
+FirmwareImage_GetBundleImage(
+	_In_bytecount_(PunBundleSize)	BYTE*			PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_In_							UINT16			PusIndex,
+	_Out_							BYTE**			PprgbImage,
+	_Out_							UINT32*			PpunImageSize);
+
+/**
+ *	@brief		Releases a firmware image returned by FirmwareImage_FindInBundle or FirmwareImage_GetBundleImage
+ *	@details	A firmware image of a chunked bundle has been reassembled into allocated memory and is freed, any other
+ *				firmware image lies within PrgbBundle and is left alone. *PprgbImage is set to NULL.
+ *
+ *	@param		PrgbBundle				Firmware image bundle byte stream the firmware image has been taken from
+ *	@param		PunBundleSize			Size of the firmware image bundle byte stream
+ *	@param		PprgbImage				Pointer to the firmware image, may point to NULL
+ */
+void
+FirmwareImage_ReleaseBundleImage(
+	_In_bytecount_(PunBundleSize)	const BYTE*		PrgbBundle,
+	_In_							UINT32			PunBundleSize,
+	_Inout_							BYTE**			PprgbImage);
+
 #ifdef __cplusplus
 }
 #endif
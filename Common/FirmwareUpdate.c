@@ -16,6 +16,10 @@
 #include "FirmwareUpdate.h"
 #include "FirmwareImage.h"
 #include "Crypt.h"
+#include "Trace.h"
+#include "Probes.h"
+#include "Session.h"
+#include "TSS_Command.h"
 
 #include "TPM2_Marshal.h"
 #include "TPM2_FlushContext.h"
@@ -39,7 +43,6 @@
 #include "TPM_OwnerReadInternalPub.h"
 #include "TPM_FlushSpecific.h"
 #include "TPM_OIAP.h"
-#include "TPM_OSAP.h"
 
 #include "TPM_FieldUpgradeInfoRequest.h"
 #include "TPM_FieldUpgradeInfoRequest2.h"
@@ -47,16 +50,253 @@
 #include "TPM_FieldUpgradeUpdate.h"
 #include "TPM_FieldUpgradeComplete.h"
 
-/// Maximum amount of times to check if TPM switched to boot loader mode after TPM_FieldUpgrade_Start command.
-#define TPM_FU_START_MAX_RETRIES 16U
-/// Default wait time in milliseconds in between two of the above checks.
-#define TPM_FU_START_RETRY_WAIT_TIME 1000
+/// Maximum time in milliseconds to wait for the TPM to switch to boot loader mode after TPM_FieldUpgrade_Start command.
+#define TPM_FU_START_TIMEOUT 16000U
+/// Initial wait time in milliseconds in between two of the above checks, doubled after every check.
+#define TPM_FU_START_RETRY_WAIT_TIME_MIN 10U
+/// Maximum wait time in milliseconds in between two of the above checks.
+#define TPM_FU_START_RETRY_WAIT_TIME_MAX 1000U
+/// Maximum number of times a TPM_FieldUpgrade_Update block is resent after a transient transport error.
+#define TPM_FU_UPDATE_RETRY_COUNT 3U
+/// Initial wait time in milliseconds before a block is resent, doubled after every retry.
+#define TPM_FU_UPDATE_RETRY_WAIT_TIME_MIN 50U
+/// Maximum wait time in milliseconds before a block is resent.
+#define TPM_FU_UPDATE_RETRY_WAIT_TIME_MAX 400U
+/// Maximum number of prepared TPM_FieldUpgrade_Update blocks sent in one round trip if the transport supports it.
+#define TPM_FU_UPDATE_BATCH_WINDOW 16U
 /// Default wait time in milliseconds after sending TPM_FieldUpgrade_Complete before continuing to give TPM time to finish.
 #define TPM_FU_COMPLETE_WAIT_TIME 2000
 
+/// First property of the TPM2.0 property range read by FirmwareUpdate_Tpm20_GetProperty
+#define TPM20_PROPERTY_TABLE_FIRST TPM_PT_MANUFACTURER
+/// Number of properties in the range (TPM_PT_MANUFACTURER up to TPM_PT_FIRMWARE_VERSION_2)
+#define TPM20_PROPERTY_TABLE_COUNT (TPM_PT_FIRMWARE_VERSION_2 - TPM_PT_MANUFACTURER + 1)
+
+#if IFX_ENABLE_TPM20
+/// TPM2.0 property table filled by a single TSS_TPM2_GetTpmProperties call
+static TPML_TAGGED_TPM_PROPERTY s_sTpm20PropertyTable = {0};
+#endif
+/// Flag indicating s_sTpm20PropertyTable holds the properties of the TPM
+static BOOL s_fTpm20PropertyTableValid = FALSE;
+/// TPM1.2 version information (TPM_CAP_VERSION_VAL)
+static TPM_CAP_VERSION_INFO s_sTpm12VersionInfo = {0};
+/// Flag indicating s_sTpm12VersionInfo holds the version information of the TPM
+static BOOL s_fTpm12VersionInfoValid = FALSE;
+#if IFX_ENABLE_TPM20
+/// TPM2.0 Security Module Logic Info (TPM_PT_VENDOR_FIX_SMLI2)
+static sSecurityModuleLogicInfo2_d s_sTpm20SecurityModuleLogicInfo2 = {0};
+#endif
+/// Flag indicating s_sTpm20SecurityModuleLogicInfo2 holds the Security Module Logic Info of the TPM
+static BOOL s_fTpm20SecurityModuleLogicInfo2Valid = FALSE;
+/// TPM1.2 Security Module Logic Info (TPM_FieldUpgradeInfoRequest2)
+static sSecurityModuleLogicInfo_d s_sTpm12SecurityModuleLogicInfo = {0};
+/// Flag indicating s_sTpm12SecurityModuleLogicInfo holds the Security Module Logic Info of the TPM
+static BOOL s_fTpm12SecurityModuleLogicInfoValid = FALSE;
+/// Firmware image whose integrity checks are skipped by FirmwareUpdate_IsFirmwareUpdatable (see FirmwareUpdate_SetImageIntegrityVerified)
+static const BYTE* s_pbIntegrityVerifiedImage = NULL;
+/// Size of s_pbIntegrityVerifiedImage
+static UINT32 s_unIntegrityVerifiedImageSize = 0;
+
+/// Integrity verification of a firmware image running on a worker thread while the TPM is queried
+typedef struct tdIfxImageVerification
+{
+	/// Whether a verification has been started and not yet finished
+	BOOL						fPending;
+	/// Worker thread, NULL if the verification runs when it is finished
+	void*						pvThread;
+	/// Verified firmware image byte stream
+	const BYTE*					pbImage;
+	/// Size of pbImage
+	UINT32						unImageSize;
+	/// Unmarshalled pbImage
+	const IfxFirmwareImage*		psFirmwareImage;
+	/// Whether the signature may also be made with the test key of the TPM simulator (RSA_PUB_MODULUS_SIMULATOR)
+	BOOL						fSimulatorKey;
+	/// RC_SUCCESS or the error of a failed calculation
+	unsigned int				unReturnValue;
+	/// RC_SUCCESS or RC_E_CORRUPT_FW_IMAGE if a check failed
+	UINT32						unErrorDetails;
+	/// Error message of a failed calculation or check (the worker must not use the error stack)
+	const wchar_t*				wszError;
+} IfxImageVerification;
+
+/// Pending firmware image integrity verification (see FirmwareUpdate_StartImageVerification)
+static IfxImageVerification s_sImageVerification = {0};
+#if IFX_ENABLE_TPM12
+/// Handle of the TPM1.2 OIAP session kept open for the next TPM Owner authorized command
+static TPM_AUTHHANDLE s_unTpm12AuthHandle = 0;
+/// Last even nonce returned by the TPM for s_unTpm12AuthHandle
+static TPM_NONCE s_sTpm12AuthNonceEven = {{0}};
+/// Flag indicating s_unTpm12AuthHandle is an open OIAP session
+static BOOL s_fTpm12AuthSessionValid = FALSE;
+#endif
+
+#if IFX_ENABLE_TPM20
+/**
+ *	@brief		Returns a TPM2.0 property from the property table.
+ *	@details	The first call reads the properties TPM_PT_MANUFACTURER to TPM_PT_FIRMWARE_VERSION_2 with one
+ *				TPM2_GetCapability command. Later calls are answered from the table until FirmwareUpdate_InvalidateState is called.
+ *
+ *	@param		PunProperty					Property identifier (TPM_PT_MANUFACTURER to TPM_PT_FIRMWARE_VERSION_2)
+ *	@param		PpunValue					Receives the value of the property
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PpunValue is NULL
+ *	@retval		RC_E_FAIL					The TPM did not return the property.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+FirmwareUpdate_Tpm20_GetProperty(
+	_In_	TPM_PT	PunProperty,
+	_Out_	UINT32*	PpunValue)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		UINT32 unIndex = 0;
+
+		// Check parameter
+		if (NULL == PpunValue)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpunValue is NULL)");
+			break;
+		}
+		*PpunValue = 0;
+
+		if (FALSE == s_fTpm20PropertyTableValid)
+		{
+			unReturnValue = TSS_TPM2_GetTpmProperties(TPM20_PROPERTY_TABLE_FIRST, TPM20_PROPERTY_TABLE_COUNT, &s_sTpm20PropertyTable);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetTpmProperties returned an unexpected value.");
+				break;
+			}
+			s_fTpm20PropertyTableValid = TRUE;
+		}
+
+		unReturnValue = RC_E_FAIL;
+		for (unIndex = 0; unIndex < s_sTpm20PropertyTable.count; unIndex++)
+		{
+			if (PunProperty == s_sTpm20PropertyTable.tpmProperty[unIndex].property)
+			{
+				*PpunValue = s_sTpm20PropertyTable.tpmProperty[unIndex].value;
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+		}
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"TSS_TPM2_GetTpmProperties did not return the property 0x%.8X", PunProperty);
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+#endif // IFX_ENABLE_TPM20
+
+/**
+ *	@brief		Returns the TPM1.2 version information (TPM_CAP_VERSION_VAL).
+ *	@details	The first call reads the version information from the TPM. Later calls are answered from a copy
+ *				until FirmwareUpdate_InvalidateState is called.
+ *
+ *	@param		PpsVersionInfo				Receives the version information
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PpsVersionInfo is NULL
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+FirmwareUpdate_Tpm12_GetVersionInfo(
+	_Out_ TPM_CAP_VERSION_INFO* PpsVersionInfo)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameter
+		if (NULL == PpsVersionInfo)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpsVersionInfo is NULL)");
+			break;
+		}
+
+		if (FALSE == s_fTpm12VersionInfoValid)
+		{
+			UINT32 unVersionInfoSize = sizeof(s_sTpm12VersionInfo);
+			unReturnValue = TSS_TPM_GetCapability(TPM_CAP_VERSION_VAL, 0, NULL, &unVersionInfoSize, (BYTE*)&s_sTpm12VersionInfo);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			s_fTpm12VersionInfoValid = TRUE;
+		}
+
+		*PpsVersionInfo = s_sTpm12VersionInfo;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Returns the TPM1.2 Security Module Logic Info (TPM_FieldUpgradeInfoRequest2).
+ *	@details	The first call reads the Security Module Logic Info from the TPM and retries once on TPM_RESOURCES.
+ *				Later calls are answered from a copy until FirmwareUpdate_InvalidateState is called.
+ *
+ *	@param		PpSecurityModuleLogicInfo	Receives the Security Module Logic Info
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PpSecurityModuleLogicInfo is NULL
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+FirmwareUpdate_Tpm12_GetSecurityModuleLogicInfo(
+	_Out_ sSecurityModuleLogicInfo_d* PpSecurityModuleLogicInfo)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameter
+		if (NULL == PpSecurityModuleLogicInfo)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpSecurityModuleLogicInfo is NULL)");
+			break;
+		}
+
+		if (FALSE == s_fTpm12SecurityModuleLogicInfoValid)
+		{
+			unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&s_sTpm12SecurityModuleLogicInfo);
+			if (TPM_RESOURCES == (unReturnValue ^ RC_TPM_MASK))
+			{
+				// Retry once on TPM_RESOURCES
+				unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&s_sTpm12SecurityModuleLogicInfo);
+			}
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			s_fTpm12SecurityModuleLogicInfoValid = TRUE;
+		}
+
+		*PpSecurityModuleLogicInfo = s_sTpm12SecurityModuleLogicInfo;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+#if IFX_ENABLE_TPM20
 /**
  *	@brief		Function to read Security Module Logic Info from TPM2.0.
- *	@details	This function obtains the Security Module Logic Info from TPM2.0.
+ *	@details	This function obtains the Security Module Logic Info from TPM2.0. The first call reads the vendor
+ *				specific property from the TPM. Later calls are answered from a copy until FirmwareUpdate_InvalidateState is called.
  *
  *	@param		PpSecurityModuleLogicInfo2	Pointer to the Security Module Logic Info
  *
@@ -82,6 +322,13 @@ FirmwareUpdate_Tpm20_GetSecurityModuleLogicInfo2(
 			break;
 		}
 
+		if (TRUE == s_fTpm20SecurityModuleLogicInfo2Valid)
+		{
+			*PpSecurityModuleLogicInfo2 = s_sTpm20SecurityModuleLogicInfo2;
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
 		{
 			// Read out the vendor specific TPM_PT_VENDOR_FIX_SMLI2 property from the TPM.
 			TPMS_VENDOR_CAPABILITY_DATA vendorCapabilityData = {0};
@@ -113,12 +360,16 @@ FirmwareUpdate_Tpm20_GetSecurityModuleLogicInfo2(
 				ERROR_STORE(unReturnValue, L"TSS_sSecurityModuleLogicInfo2_d_Unmarshal returned an unexpected value.");
 				break;
 			}
+
+			s_sTpm20SecurityModuleLogicInfo2 = *PpSecurityModuleLogicInfo2;
+			s_fTpm20SecurityModuleLogicInfo2Valid = TRUE;
 		}
 	}
 	WHILE_FALSE_END;
 
 	return unReturnValue;
 }
+#endif // IFX_ENABLE_TPM20
 
 /**
  *	@brief		Function to read the field upgrade counter from the TPM
@@ -155,6 +406,7 @@ FirmwareUpdate_GetTpmFieldUpgradeCounter(
 		*PpunUpgradeCounter = 0;
 
 		// Read update counter from TPM
+#if IFX_ENABLE_TPM20
 		if (PbfTpmAttributes.tpm20)
 		{
 			// TPM2.0
@@ -171,16 +423,13 @@ FirmwareUpdate_GetTpmFieldUpgradeCounter(
 
 			*PpunUpgradeCounter = securityModuleLogicInfo2.wFieldUpgradeCounter;
 		}
-		else if ((PbfTpmAttributes.tpm12 && PbfTpmAttributes.infineon) || PbfTpmAttributes.bootLoader)
+		else
+#endif
+		if ((PbfTpmAttributes.tpm12 && PbfTpmAttributes.infineon) || PbfTpmAttributes.bootLoader)
 		{
 			// TPM1.2
 			sSecurityModuleLogicInfo_d securityModuleLogicInfo = {0};
-			unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
-			if (TPM_RESOURCES == (unReturnValue ^ RC_TPM_MASK))
-			{
-				// Retry once on TPM_RESOURCES
-				unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
-			}
+			unReturnValue = FirmwareUpdate_Tpm12_GetSecurityModuleLogicInfo(&securityModuleLogicInfo);
 			if (RC_SUCCESS != unReturnValue)
 			{
 				if (TPM_BAD_PARAM_SIZE == (unReturnValue ^ RC_TPM_MASK) ||
@@ -248,46 +497,27 @@ FirmwareUpdate_GetTpmFirmwareVersionString(
 			break;
 		}
 
+#if IFX_ENABLE_TPM20
 		if (PbfTpmAttributes.tpm20)
 		{
 			// Read version from TPM2.0
-			BYTE bMoreData = 0;
-			TPMS_CAPABILITY_DATA capabilityData = {0};
 			UINT32 unFirmwareVersion1 = 0;
 			UINT32 unFirmwareVersion2 = 0;
 
 			// Get actual firmware version
-			unReturnValue = TSS_TPM2_GetCapability(TPM_CAP_TPM_PROPERTIES, TPM_PT_FIRMWARE_VERSION_1, 1, &bMoreData, &capabilityData);
+			unReturnValue = FirmwareUpdate_Tpm20_GetProperty(TPM_PT_FIRMWARE_VERSION_1, &unFirmwareVersion1);
 			if (RC_SUCCESS != unReturnValue)
 			{
-				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetCapability returned an unexpected value.(TPM_CAP_TPM_PROPERTIES,TPM_PT_FIRMWARE_VERSION_1)");
-				break;
-			}
-
-			// Check count of capabilities returned
-			if (1 != capabilityData.data.tpmProperties.count)
-			{
-				unReturnValue = RC_E_FAIL;
-				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetCapability returned more than one capability");
+				ERROR_STORE(unReturnValue, L"FirmwareUpdate_Tpm20_GetProperty returned an unexpected value.(TPM_PT_FIRMWARE_VERSION_1)");
 				break;
 			}
-			unFirmwareVersion1 = capabilityData.data.tpmProperties.tpmProperty[0].value;
 
-			unReturnValue = TSS_TPM2_GetCapability(TPM_CAP_TPM_PROPERTIES, TPM_PT_FIRMWARE_VERSION_2, 1, &bMoreData, &capabilityData);
+			unReturnValue = FirmwareUpdate_Tpm20_GetProperty(TPM_PT_FIRMWARE_VERSION_2, &unFirmwareVersion2);
 			if (RC_SUCCESS != unReturnValue)
 			{
-				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetCapability returned an unexpected value.(TPM_CAP_TPM_PROPERTIES,TPM_PT_FIRMWARE_VERSION_2)");
-				break;
-			}
-
-			// Check count of capabilities returned
-			if (1 != capabilityData.data.tpmProperties.count)
-			{
-				unReturnValue = RC_E_FAIL;
-				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetCapability returned more than one capability");
+				ERROR_STORE(unReturnValue, L"FirmwareUpdate_Tpm20_GetProperty returned an unexpected value.(TPM_PT_FIRMWARE_VERSION_2)");
 				break;
 			}
-			unFirmwareVersion2 = capabilityData.data.tpmProperties.tpmProperty[0].value;
 
 			// Firmware version without subversion.minor for TPM2.0
 			unReturnValue = Platform_StringFormat(PwszFirmwareVersionShort, PpunFirmwareVersionShortSize, L"%d.%d.%d", unFirmwareVersion1 >> 16, unFirmwareVersion1 & 0xFFFF, unFirmwareVersion2 >> 8);
@@ -305,18 +535,19 @@ FirmwareUpdate_GetTpmFirmwareVersionString(
 				break;
 			}
 		}
-		else if (PbfTpmAttributes.tpm12 || PbfTpmAttributes.bootLoader)
+		else
+#endif
+		if (PbfTpmAttributes.tpm12 || PbfTpmAttributes.bootLoader)
 		{
 			// TPM1.2
 			UINT16 usBuildNumber = 0;
 			TPM_CAP_VERSION_INFO sTpmVersionInfo = {0};
-			UINT32 unTpmVersionInfoSize = sizeof(sTpmVersionInfo);
 			UINT8 bCertState = 0;
 
-			unReturnValue = TSS_TPM_GetCapability(TPM_CAP_VERSION_VAL, 0, NULL, &unTpmVersionInfoSize, (BYTE*)&sTpmVersionInfo);
+			unReturnValue = FirmwareUpdate_Tpm12_GetVersionInfo(&sTpmVersionInfo);
 			if (RC_SUCCESS != unReturnValue)
 			{
-				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetCapability returned an unexpected value.(TPM_CAP_VERSION_VAL,0)");
+				ERROR_STORE(unReturnValue, L"TSS_TPM_GetCapability returned an unexpected value.(TPM_CAP_VERSION_VAL,0)");
 				break;
 			}
 
@@ -355,166 +586,457 @@ FirmwareUpdate_GetTpmFirmwareVersionString(
 	return unReturnValue;
 }
 
+/// Number of bytes of the firmware image processed per step of FirmwareUpdate_CalculateImageDigests
+#define FIRMWARE_IMAGE_DIGEST_CHUNK_SIZE	0x10000
+
 /**
- *	@brief		Function to check if the TPM is updatable with the given firmware image
- *	@details	Some parameters like GUID, file content signature, TPM firmware major minor version or file content CRC
- *				are checked to get a decision if the firmware is updatable with the current image.
+ *	@brief		Calculates the CRC and the SHA-256 digests of a firmware image in a single pass
+ *	@details	The image is processed in chunks. Each chunk updates the CRC, the digest of the signed region
+ *				and the digest of the firmware region while it is still in the cache, so the image is read only once.
+ *				All regions start at the beginning of the image except the firmware region.
  *
- *	@param		PbfTpmAttributes			TPM state attributes
  *	@param		PrgbFirmwareImage			Pointer to the firmware image byte stream
- *	@param		PnFirmwareImageSize			Size of the firmware image byte stream
- *	@param		PpsFirmwareImage			Pointer to the unmarshalled firmware image structure (Unmarshalled PrgbFirmwareImage)
- *	@param		PpfValid					TRUE in case the image is valid, FALSE otherwise.
- *	@param		PpbfNewTpmFirmwareInfo		Pointer to a bit field to return info data for the new firmware image.
- *	@param		PpunErrorDetails			Pointer to an unsigned int to return error details. Possible values are:\n
- *												RC_E_FW_UPDATE_BLOCKED in case the field upgrade counter value has been exceeded.\n
- *												RC_E_WRONG_FW_IMAGE in case the TPM is not updatable with the given image.\n
- *												RC_E_CORRUPT_FW_IMAGE in case the firmware image is corrupt.\n
- *												RC_E_NEWER_TOOL_REQUIRED in case a newer version of the tool is required to parse the firmware image.\n
- *												RC_E_WRONG_DECRYPT_KEYS in case the TPM2.0 does not have decrypt keys matching to the firmware image.
+ *	@param		PunCrcSize					Number of bytes covered by the CRC, must be greater than 0
+ *	@param		PpunCRC						Receives the CRC
+ *	@param		PunSignedSize				Number of bytes covered by the signature, 0 to skip the digest
+ *	@param		PrgbSignedDigest			Receives the SHA-256 digest of the signed region
+ *	@param		PunFirmwareOffset			Offset of the firmware region within the image
+ *	@param		PunFirmwareSize				Number of bytes of the firmware region, 0 to skip the digest
+ *	@param		PrgbFirmwareDigest			Receives the SHA-256 digest of the firmware region
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_FAIL					An unexpected error occurred.
- *	@retval		RC_E_BAD_PARAMETER			In case of a NULL input parameter
- *	@retval		...							Error codes from called functions.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		...							Error codes from Crypt_CRC and Crypt_SHA256_* functions.
  */
 _Check_return_
-unsigned int
-FirmwareUpdate_IsFirmwareUpdatable(
-	_In_								BITFIELD_TPM_ATTRIBUTES			PbfTpmAttributes,
-	_In_bytecount_(PnFirmwareImageSize)	BYTE*							PrgbFirmwareImage,
-	_In_								int								PnFirmwareImageSize,
-	_In_								IfxFirmwareImage*				PpsFirmwareImage,
-	_Out_								BOOL*							PpfValid,
-	_Out_								BITFIELD_NEW_TPM_FIRMWARE_INFO*	PpbfNewTpmFirmwareInfo,
-	_Out_								UINT32*							PpunErrorDetails)
+static unsigned int
+FirmwareUpdate_CalculateImageDigests(
+	_In_								const BYTE*		PrgbFirmwareImage,
+	_In_								UINT32			PunCrcSize,
+	_Out_								unsigned int*	PpunCRC,
+	_In_								UINT32			PunSignedSize,
+	_Out_bytecap_(SHA256_DIGEST_SIZE)	BYTE			PrgbSignedDigest[SHA256_DIGEST_SIZE],
+	_In_								UINT32			PunFirmwareOffset,
+	_In_								UINT32			PunFirmwareSize,
+	_Out_bytecap_(SHA256_DIGEST_SIZE)	BYTE			PrgbFirmwareDigest[SHA256_DIGEST_SIZE])
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvSignedContext = NULL;
+	void* pvFirmwareContext = NULL;
 
 	do
 	{
-		// Check _Out_ parameters.
-		if (NULL == PpfValid || NULL == PpbfNewTpmFirmwareInfo || NULL == PpunErrorDetails)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpfValid or PpbfNewTpmFirmwareInfo or PpunErrorDetails is NULL)");
-			break;
-		}
-
-		// Set default value for _Out_ parameters.
-		*PpfValid = FALSE;
-		*PpunErrorDetails = RC_E_WRONG_FW_IMAGE;
-		unReturnValue = Platform_MemorySet(PpbfNewTpmFirmwareInfo, 0, sizeof(BITFIELD_NEW_TPM_FIRMWARE_INFO));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		UINT32 unEnd = PunCrcSize;
+		UINT32 unPosition = 0;
 
-		// Check _In_ parameters.
-		if (NULL == PrgbFirmwareImage ||
-				0 >= PnFirmwareImageSize ||
-				NULL == PpsFirmwareImage)
+		if (NULL == PrgbFirmwareImage || NULL == PpunCRC || 0 == PunCrcSize)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PrgbFirmwareImage or PpsFirmwareImage is NULL or PnFirmwareImageSize <= 0)");
 			break;
 		}
+		*PpunCRC = 0;
 
-		// Compare GUID to the expected one.
-		if (0 != Platform_MemoryCompare(&PpsFirmwareImage->unique, &EFI_IFXTPM_FIRMWARE_IMAGE_GUID, sizeof(EFI_IFXTPM_FIRMWARE_IMAGE_GUID)))
+		if (0 != PunSignedSize)
 		{
-			// The tool cannot process the image. Detect whether a newer version of the tool could parse the image.
-			// IMPORTANT: As soon as EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID is supported, update firmware image file format by introducing
-			// a schema version for all future breaking changes. Furthermore, leave GUID the same as long as possible! This enables
-			// all (i.e. older) application versions to return the correct return code RC_E_NEWER_TOOL_REQUIRED in case of an
-			// unsupported firmware image file format even for schema versions introduced after EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID.
-			if (0 == Platform_MemoryCompare(&PpsFirmwareImage->unique, &EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID, sizeof(EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID)))
-				// A newer version of the driver is required to process the firmware image
-				*PpunErrorDetails = RC_E_NEWER_TOOL_REQUIRED;
-			else
-			{
-				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The firmware image file is corrupt or not a firmware image file at all");
-				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
-			}
-
-			unReturnValue = RC_SUCCESS;
-			break;
+			unReturnValue = Crypt_SHA256_Start(&pvSignedContext);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (PunSignedSize > unEnd)
+				unEnd = PunSignedSize;
 		}
-
-		// Check the CRC at the end of the firmware image
+		if (0 != PunFirmwareSize)
 		{
-			unsigned int unCRC = 0;
-			unReturnValue = Crypt_CRC((void*)PrgbFirmwareImage, PnFirmwareImageSize - sizeof(unCRC), &unCRC);
+			unReturnValue = Crypt_SHA256_Start(&pvFirmwareContext);
 			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Crypt_CRC returned an unexpected value");
-				break;
-			}
-			if (PpsFirmwareImage->unChecksum != unCRC)
-			{
-				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The CRC value in the firmware image file is incorrect");
-				unReturnValue = RC_SUCCESS;
-				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
 				break;
-			}
+			if (PunFirmwareOffset + PunFirmwareSize > unEnd)
+				unEnd = PunFirmwareOffset + PunFirmwareSize;
 		}
 
-		// Check signature on the firmware image file with Infineon code signing public key
+		unReturnValue = RC_SUCCESS;
+		for (unPosition = 0; unPosition < unEnd && RC_SUCCESS == unReturnValue; unPosition += FIRMWARE_IMAGE_DIGEST_CHUNK_SIZE)
 		{
-			BYTE rgbHash[SHA256_DIGEST_SIZE] = {0};
-			// The signature is 256 bytes long and is located before the CRC
-			int nSizeOfDataForHash = PnFirmwareImageSize - sizeof(PpsFirmwareImage->unChecksum) - sizeof(RSA_PUB_MODULUS_KEY_ID_0);
+			UINT32 unChunkEnd = unEnd - unPosition > FIRMWARE_IMAGE_DIGEST_CHUNK_SIZE ? unPosition + FIRMWARE_IMAGE_DIGEST_CHUNK_SIZE : unEnd;
 
-			// Check structure version of the firmware image file
-			if (PpsFirmwareImage->usImageStructureVersion < 2)
+			if (unPosition < PunCrcSize)
 			{
-				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The structure of the firmware image file is too old and therefore does not meet the minimum requirements");
-				unReturnValue = RC_SUCCESS;
-				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
-				break;
+				UINT32 unSize = (unChunkEnd < PunCrcSize ? unChunkEnd : PunCrcSize) - unPosition;
+				unReturnValue = Crypt_CRC(PrgbFirmwareImage + unPosition, (int)unSize, PpunCRC);
+				if (RC_SUCCESS != unReturnValue)
+					break;
 			}
-
-			// Check if signature key ID is known
-			if (SIG_KEY_ID_1 != PpsFirmwareImage->usSignatureKeyId)
+			if (unPosition < PunSignedSize)
 			{
-				ERROR_STORE(RC_E_NEWER_TOOL_REQUIRED, L"The signature key ID of the firmware image file is not supported");
-				unReturnValue = RC_SUCCESS;
-				*PpunErrorDetails = RC_E_NEWER_TOOL_REQUIRED;
-				break;
+				UINT32 unSize = (unChunkEnd < PunSignedSize ? unChunkEnd : PunSignedSize) - unPosition;
+				unReturnValue = Crypt_SHA256_Update(pvSignedContext, PrgbFirmwareImage + unPosition, unSize);
+				if (RC_SUCCESS != unReturnValue)
+					break;
 			}
-
-			// Check that the firmware image file is large enough to contain a signature
-			if (nSizeOfDataForHash <= 0)
+			if (0 != PunFirmwareSize && unChunkEnd > PunFirmwareOffset && unPosition < PunFirmwareOffset + PunFirmwareSize)
 			{
-				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The size of the firmware image file signature is too small");
-				unReturnValue = RC_SUCCESS;
-				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
-				break;
+				UINT32 unStart = unPosition > PunFirmwareOffset ? unPosition : PunFirmwareOffset;
+				UINT32 unStop = unChunkEnd < PunFirmwareOffset + PunFirmwareSize ? unChunkEnd : PunFirmwareOffset + PunFirmwareSize;
+				unReturnValue = Crypt_SHA256_Update(pvFirmwareContext, PrgbFirmwareImage + unStart, unStop - unStart);
+				if (RC_SUCCESS != unReturnValue)
+					break;
 			}
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
 
-			// Recalculate the SHA-256 digest on which the signature is based
-			unReturnValue = Crypt_SHA256(PrgbFirmwareImage, nSizeOfDataForHash, rgbHash);
+		if (NULL != pvSignedContext)
+		{
+			unReturnValue = Crypt_SHA256_Finish(&pvSignedContext, PrgbSignedDigest);
 			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Crypt_SHA256 returned an unexpected value");
-				break;
-			}
-
-			// Verify the signature of the firmware image file
-			unReturnValue = Crypt_VerifySignature(rgbHash, sizeof(rgbHash), PpsFirmwareImage->rgbSignature, sizeof(PpsFirmwareImage->rgbSignature), RSA_PUB_MODULUS_KEY_ID_0, sizeof(RSA_PUB_MODULUS_KEY_ID_0));
-			if (RC_SUCCESS != unReturnValue && RC_E_VERIFY_SIGNATURE != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Crypt_VerifySignature returned an unexpected value");
 				break;
-			}
-			else if (RC_E_VERIFY_SIGNATURE == unReturnValue)
-			{
-				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The signature in the firmware image file is invalid");
-				unReturnValue = RC_SUCCESS;
-				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
+		}
+		if (NULL != pvFirmwareContext)
+		{
+			unReturnValue = Crypt_SHA256_Finish(&pvFirmwareContext, PrgbFirmwareDigest);
+			if (RC_SUCCESS != unReturnValue)
 				break;
-			}
 		}
+	}
+	WHILE_FALSE_END;
 
-		// Check consistency of firmware
+	// Release the contexts in case of an error, the original error is the relevant one
+	if (NULL != pvSignedContext)
+		IGNORE_RETURN_VALUE(Crypt_SHA256_Finish(&pvSignedContext, NULL));
+	if (NULL != pvFirmwareContext)
+		IGNORE_RETURN_VALUE(Crypt_SHA256_Finish(&pvFirmwareContext, NULL));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Checks whether the integrity of exactly this image has been verified already
+ *	@details	See FirmwareUpdate_SetImageIntegrityVerified.
+ *
+ *	@param		PrgbImage					Firmware image byte stream
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *
+ *	@retval		TRUE						The CRC, signature and digest checks can be skipped.
+ *	@retval		FALSE						The image must be verified.
+ */
+static BOOL
+FirmwareUpdate_IsImageIntegrityVerified(
+	_In_	const BYTE*		PrgbImage,
+	_In_	UINT32			PunImageSize)
+{
+	return NULL != s_pbIntegrityVerifiedImage && PrgbImage == s_pbIntegrityVerifiedImage && PunImageSize == s_unIntegrityVerifiedImageSize;
+}
+
+/**
+ *	@brief		Verifies the integrity of a firmware image
+ *	@details	Checks the CRC, the signature with the Infineon code signing public key (or the test key of the TPM simulator
+ *				if fSimulatorKey is set) and the firmware digest in the policy parameter block. Runs on a worker thread, so the
+ *				result and an error message are returned in PpsVerification instead of the error stack.
+ *
+ *	@param		PpsVerification				Image to verify, receives the result
+ */
+static void
+FirmwareUpdate_VerifyImageIntegrity(
+	_Inout_ IfxImageVerification* PpsVerification)
+{
+	const IfxFirmwareImage* psFirmwareImage = PpsVerification->psFirmwareImage;
+	const BYTE* pbImage = PpsVerification->pbImage;
+
+	do
+	{
+		unsigned int unCRC = 0;
+		BYTE rgbHash[SHA256_DIGEST_SIZE] = {0};
+		BYTE rgbMessageDigest[SHA256_DIGEST_SIZE] = {0};
+		BOOL fFirmwareDigestValid = FALSE;
+		int nSizeOfDataForCrc = (int)PpsVerification->unImageSize - (int)sizeof(unCRC);
+		int nSizeOfSignedData = nSizeOfDataForCrc - (int)sizeof(RSA_PUB_MODULUS_KEY_ID_0);
+		UINT32 unFirmwareOffset = 0;
+		BYTE* rgbPolicyParameterBlock = psFirmwareImage->rgbPolicyParameterBlock;
+		INT32 nPolicyParameterBlockSize = psFirmwareImage->usPolicyParameterBlockSize;
+		sSignedDataView_d sSignedData = {0};
+
+		PpsVerification->unReturnValue = RC_SUCCESS;
+		PpsVerification->unErrorDetails = RC_E_CORRUPT_FW_IMAGE;
+		if (nSizeOfSignedData <= 0)
+		{
+			PpsVerification->wszError = L"The size of the firmware image file signature is too small";
+			break;
+		}
+
+		// Calculate the CRC and the digests of the signed region and of the firmware in a single pass over the image.
+		// The firmware digest is calculated separately below if the firmware is not located within the image.
+		if (psFirmwareImage->rgbFirmware >= pbImage && 0 != psFirmwareImage->unFirmwareSize &&
+				(size_t)(psFirmwareImage->rgbFirmware - pbImage) <= (size_t)PpsVerification->unImageSize &&
+				psFirmwareImage->unFirmwareSize <= PpsVerification->unImageSize - (UINT32)(psFirmwareImage->rgbFirmware - pbImage))
+		{
+			unFirmwareOffset = (UINT32)(psFirmwareImage->rgbFirmware - pbImage);
+			fFirmwareDigestValid = TRUE;
+		}
+		PpsVerification->unReturnValue = FirmwareUpdate_CalculateImageDigests(
+											pbImage,
+											(UINT32)nSizeOfDataForCrc,
+											&unCRC,
+											(UINT32)nSizeOfSignedData,
+											rgbHash,
+											unFirmwareOffset,
+											fFirmwareDigestValid ? psFirmwareImage->unFirmwareSize : 0,
+											rgbMessageDigest);
+		if (RC_SUCCESS != PpsVerification->unReturnValue)
+		{
+			PpsVerification->wszError = L"FirmwareUpdate_CalculateImageDigests returned an unexpected value";
+			break;
+		}
+
+		// Check the CRC at the end of the firmware image
+		if (psFirmwareImage->unChecksum != unCRC)
+		{
+			PpsVerification->wszError = L"The CRC value in the firmware image file is incorrect";
+			break;
+		}
+
+		// Verify the signature of the firmware image file, an update on the TPM simulator also accepts its test key
+		PpsVerification->unReturnValue = Crypt_VerifySignature(rgbHash, sizeof(rgbHash), psFirmwareImage->rgbSignature, sizeof(psFirmwareImage->rgbSignature), RSA_PUB_MODULUS_KEY_ID_0, sizeof(RSA_PUB_MODULUS_KEY_ID_0));
+		if (RC_E_VERIFY_SIGNATURE == PpsVerification->unReturnValue && PpsVerification->fSimulatorKey)
+			PpsVerification->unReturnValue = Crypt_VerifySignature(rgbHash, sizeof(rgbHash), psFirmwareImage->rgbSignature, sizeof(psFirmwareImage->rgbSignature), RSA_PUB_MODULUS_SIMULATOR, sizeof(RSA_PUB_MODULUS_SIMULATOR));
+		if (RC_E_VERIFY_SIGNATURE == PpsVerification->unReturnValue)
+		{
+			PpsVerification->unReturnValue = RC_SUCCESS;
+			PpsVerification->wszError = L"The signature in the firmware image file is invalid";
+			break;
+		}
+		if (RC_SUCCESS != PpsVerification->unReturnValue)
+		{
+			PpsVerification->wszError = L"Crypt_VerifySignature returned an unexpected value";
+			break;
+		}
+
+		// Compare the messageDigest of the firmware block to the value stored in the policy parameter block
+		if (RC_SUCCESS != TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize))
+		{
+			PpsVerification->wszError = L"The content of the firmware image file is not parsable";
+			break;
+		}
+		if (FALSE == fFirmwareDigestValid)
+		{
+			PpsVerification->unReturnValue = Crypt_SHA256(psFirmwareImage->rgbFirmware, psFirmwareImage->unFirmwareSize, rgbMessageDigest);
+			if (RC_SUCCESS != PpsVerification->unReturnValue)
+			{
+				PpsVerification->wszError = L"Crypt_SHA256 returned an unexpected value";
+				break;
+			}
+		}
+		if (0 != Platform_MemoryCompare(sSignedData.sSignedAttributes.sMessageDigest.rgbMessageDigest, rgbMessageDigest, SHA256_DIGEST_SIZE))
+		{
+			PpsVerification->wszError = L"The firmware digest in the firmware image file is incorrect";
+			break;
+		}
+
+		PpsVerification->unErrorDetails = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Thread function of the firmware image integrity verification
+ *
+ *	@param		PpvContext					Pointer to s_sImageVerification
+ */
+static void
+FirmwareUpdate_ImageVerificationThread(
+	_In_ void* PpvContext)
+{
+	FirmwareUpdate_VerifyImageIntegrity((IfxImageVerification*)PpvContext);
+}
+
+/**
+ *	@brief		Finishes the pending firmware image integrity verification
+ *	@details	Waits for the worker thread. The result is only returned for the given image, a verification of another
+ *				image is discarded.
+ *
+ *	@param		PrgbImage					Firmware image byte stream or NULL to discard the pending verification
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *	@param		PpsResult					Receives the result (optional, can be NULL)
+ *
+ *	@retval		TRUE						PpsResult holds the result of the verification of the given image.
+ *	@retval		FALSE						No verification of the given image was pending.
+ */
+static BOOL
+FirmwareUpdate_FinishImageVerification(
+	_In_opt_	const BYTE*				PrgbImage,
+	_In_		UINT32					PunImageSize,
+	_Out_		IfxImageVerification*	PpsResult)
+{
+	BOOL fResult = FALSE;
+
+	if (s_sImageVerification.fPending)
+	{
+		fResult = (NULL != PrgbImage && NULL != PpsResult && PrgbImage == s_sImageVerification.pbImage && PunImageSize == s_sImageVerification.unImageSize);
+
+		if (NULL != s_sImageVerification.pvThread)
+			IGNORE_RETURN_VALUE(Platform_ThreadJoin(&s_sImageVerification.pvThread));
+		else if (fResult)
+			FirmwareUpdate_VerifyImageIntegrity(&s_sImageVerification);
+
+		if (fResult)
+			*PpsResult = s_sImageVerification;
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sImageVerification, 0, sizeof(s_sImageVerification)));
+	}
+
+	return fResult;
+}
+
+/**
+ *	@brief		Starts the integrity verification of a firmware image on a worker thread
+ *	@details	The CRC, signature and digest calculations only read the image, so they run while the TPM dependent checks
+ *				wait for the TPM. The result is collected by FirmwareUpdate_FinishImageVerification. If the thread cannot be
+ *				started, the verification runs when it is finished. Nothing is done if the image is already being verified.
+ *
+ *	@param		PrgbImage					Firmware image byte stream (must stay valid until the verification is finished)
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage			Unmarshalled PrgbImage (must stay valid until the verification is finished)
+ */
+static void
+FirmwareUpdate_StartImageVerification(
+	_In_bytecount_(PunImageSize)	const BYTE*				PrgbImage,
+	_In_							UINT32					PunImageSize,
+	_In_							const IfxFirmwareImage*	PpsFirmwareImage)
+{
+	if (s_sImageVerification.fPending && PrgbImage == s_sImageVerification.pbImage && PunImageSize == s_sImageVerification.unImageSize)
+		return;
+	IGNORE_RETURN_VALUE(FirmwareUpdate_FinishImageVerification(NULL, 0, NULL));
+
+	s_sImageVerification.fPending = TRUE;
+	s_sImageVerification.pbImage = PrgbImage;
+	s_sImageVerification.unImageSize = PunImageSize;
+	s_sImageVerification.psFirmwareImage = PpsFirmwareImage;
+	{
+		// The worker thread must not read the property storage, the access mode is taken here
+		unsigned int unTpmDeviceAccessMode = 0;
+		s_sImageVerification.fSimulatorKey = PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessMode) &&
+												TPM_DEVICE_ACCESS_SIMULATED == unTpmDeviceAccessMode;
+	}
+	if (RC_SUCCESS != Platform_ThreadCreate(FirmwareUpdate_ImageVerificationThread, &s_sImageVerification, &s_sImageVerification.pvThread))
+		s_sImageVerification.pvThread = NULL;
+}
+
+/**
+ *	@brief		Function to check if the TPM is updatable with the given firmware image
+ *	@details	Some parameters like GUID, file content signature, TPM firmware major minor version or file content CRC
+ *				are checked to get a decision if the firmware is updatable with the current image.
+ *
+ *	@param		PbfTpmAttributes			TPM state attributes
+ *	@param		PrgbFirmwareImage			Pointer to the firmware image byte stream
+ *	@param		PnFirmwareImageSize			Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage			Pointer to the unmarshalled firmware image structure (Unmarshalled PrgbFirmwareImage)
+ *	@param		PpfValid					TRUE in case the image is valid, FALSE otherwise.
+ *	@param		PpbfNewTpmFirmwareInfo		Pointer to a bit field to return info data for the new firmware image.
+ *	@param		PpunErrorDetails			Pointer to an unsigned int to return error details. Possible values are:\n
+ *												RC_E_FW_UPDATE_BLOCKED in case the field upgrade counter value has been exceeded.\n
+ *												RC_E_WRONG_FW_IMAGE in case the TPM is not updatable with the given image.\n
+ *												RC_E_CORRUPT_FW_IMAGE in case the firmware image is corrupt.\n
+ *												RC_E_NEWER_TOOL_REQUIRED in case a newer version of the tool is required to parse the firmware image.\n
+ *												RC_E_WRONG_DECRYPT_KEYS in case the TPM2.0 does not have decrypt keys matching to the firmware image.
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER			In case of a NULL input parameter
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_IsFirmwareUpdatable(
+	_In_								BITFIELD_TPM_ATTRIBUTES			PbfTpmAttributes,
+	_In_bytecount_(PnFirmwareImageSize)	BYTE*							PrgbFirmwareImage,
+	_In_								int								PnFirmwareImageSize,
+	_In_								const IfxFirmwareImage*			PpsFirmwareImage,
+	_Out_								BOOL*							PpfValid,
+	_Out_								BITFIELD_NEW_TPM_FIRMWARE_INFO*	PpbfNewTpmFirmwareInfo,
+	_Out_								UINT32*							PpunErrorDetails)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BOOL fVerificationStarted = FALSE;
+
+	do
+	{
+		// Check _Out_ parameters.
+		if (NULL == PpfValid || NULL == PpbfNewTpmFirmwareInfo || NULL == PpunErrorDetails)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpfValid or PpbfNewTpmFirmwareInfo or PpunErrorDetails is NULL)");
+			break;
+		}
+
+		// Set default value for _Out_ parameters.
+		*PpfValid = FALSE;
+		*PpunErrorDetails = RC_E_WRONG_FW_IMAGE;
+		unReturnValue = Platform_MemorySet(PpbfNewTpmFirmwareInfo, 0, sizeof(BITFIELD_NEW_TPM_FIRMWARE_INFO));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Check _In_ parameters.
+		if (NULL == PrgbFirmwareImage ||
+				0 >= PnFirmwareImageSize ||
+				NULL == PpsFirmwareImage)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PrgbFirmwareImage or PpsFirmwareImage is NULL or PnFirmwareImageSize <= 0)");
+			break;
+		}
+
+		// Compare GUID to the expected one.
+		if (0 != Platform_MemoryCompare(&PpsFirmwareImage->unique, &EFI_IFXTPM_FIRMWARE_IMAGE_GUID, sizeof(EFI_IFXTPM_FIRMWARE_IMAGE_GUID)))
+		{
+			// The tool cannot process the image. Detect whether a newer version of the tool could parse the image.
+			// IMPORTANT: As soon as EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID is supported, update firmware image file format by introducing
+			// a schema version for all future breaking changes. Furthermore, leave GUID the same as long as possible! This enables
+			// all (i.e. older) application versions to return the correct return code RC_E_NEWER_TOOL_REQUIRED in case of an
+			// unsupported firmware image file format even for schema versions introduced after EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID.
+			if (0 == Platform_MemoryCompare(&PpsFirmwareImage->unique, &EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID, sizeof(EFI_IFXTPM_FIRMWARE_IMAGE_2_GUID)))
+				// A newer version of the driver is required to process the firmware image
+				*PpunErrorDetails = RC_E_NEWER_TOOL_REQUIRED;
+			else
+			{
+				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The firmware image file is corrupt or not a firmware image file at all");
+				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
+			}
+
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		// Check signature parameters of the firmware image file
+		{
+			// The signature is 256 bytes long and is located before the CRC
+			int nSizeOfDataForHash = PnFirmwareImageSize - sizeof(PpsFirmwareImage->unChecksum) - sizeof(RSA_PUB_MODULUS_KEY_ID_0);
+
+			// Check structure version of the firmware image file
+			if (PpsFirmwareImage->usImageStructureVersion < 2)
+			{
+				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The structure of the firmware image file is too old and therefore does not meet the minimum requirements");
+				unReturnValue = RC_SUCCESS;
+				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+
+			// Check if signature key ID is known
+			if (SIG_KEY_ID_1 != PpsFirmwareImage->usSignatureKeyId)
+			{
+				ERROR_STORE(RC_E_NEWER_TOOL_REQUIRED, L"The signature key ID of the firmware image file is not supported");
+				unReturnValue = RC_SUCCESS;
+				*PpunErrorDetails = RC_E_NEWER_TOOL_REQUIRED;
+				break;
+			}
+
+			// Check that the firmware image file is large enough to contain a signature
+			if (nSizeOfDataForHash <= 0)
+			{
+				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The size of the firmware image file signature is too small");
+				unReturnValue = RC_SUCCESS;
+				*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+		}
+
+		// Check consistency of firmware
 		{
 			// Source and target TPM family flags in the firmware image must indicate either TPM1.2 or TPM2.0
 			if (PpsFirmwareImage->bSourceTpmFamily != DEVICE_TYPE_TPM_12 && PpsFirmwareImage->bSourceTpmFamily != DEVICE_TYPE_TPM_20)
@@ -537,12 +1059,12 @@ FirmwareUpdate_IsFirmwareUpdatable(
 		{
 			BYTE* rgbPolicyParameterBlock = NULL;
 			INT32 nPolicyParameterBlockSize = 0;
-			sSignedData_d sSignedData = {0};
+			sSignedDataView_d sSignedData = {0};
 
 			// Unmarshal the policy parameter block
 			rgbPolicyParameterBlock = PpsFirmwareImage->rgbPolicyParameterBlock;
 			nPolicyParameterBlockSize = PpsFirmwareImage->usPolicyParameterBlockSize;
-			unReturnValue = TSS_sSignedData_d_Unmarshal(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
+			unReturnValue = TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
 			if (RC_SUCCESS != unReturnValue)
 			{
 				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The content of the firmware image file is not parsable");
@@ -551,27 +1073,20 @@ FirmwareUpdate_IsFirmwareUpdatable(
 				break;
 			}
 
-			// Calculate the SHA256 digest of the firmware image and verify if it matches the digest given in the policy parameter block
+			// The caller may have verified the integrity of exactly this image already (see FirmwareUpdate_SetImageIntegrityVerified).
+			// Otherwise the CRC, the signature and the firmware digest are verified on a worker thread while the checks
+			// below query the TPM. The result is collected before the decision is returned.
+			if (FirmwareUpdate_IsImageIntegrityVerified(PrgbFirmwareImage, (UINT32)PnFirmwareImageSize))
 			{
-				// Recalculate the messageDigest of the firmware block
-				BYTE rgbMessageDigest[SHA256_DIGEST_SIZE] = {0};
-				unReturnValue = Crypt_SHA256(PpsFirmwareImage->rgbFirmware, PpsFirmwareImage->unFirmwareSize, rgbMessageDigest);
-				if (RC_SUCCESS != unReturnValue)
-				{
-					ERROR_STORE(unReturnValue, L"Crypt_SHA256 returned an unexpected value");
-					break;
-				}
-
-				// Compare the messageDigest to the value stored in the policy parameter block
-				if (0 != Platform_MemoryCompare(sSignedData.sSignerInfo.sSignedAttributes.sMessageDigest.rgbMessageDigest, rgbMessageDigest, SHA256_DIGEST_SIZE))
-				{
-					ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"The firmware digest in the firmware image file is incorrect");
-					unReturnValue = RC_SUCCESS;
-					*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
-					break;
-				}
+				LOGGING_WRITE_LEVEL3(L"Firmware image integrity already verified, skipping CRC, signature and digest checks.");
+			}
+			else
+			{
+				FirmwareUpdate_StartImageVerification(PrgbFirmwareImage, (UINT32)PnFirmwareImageSize, PpsFirmwareImage);
+				fVerificationStarted = TRUE;
 			}
 
+#if IFX_ENABLE_TPM20
 			// On TPM2.0 check that the TPM and the firmware image use the same key material
 			if (PbfTpmAttributes.tpm20)
 			{
@@ -600,7 +1115,7 @@ FirmwareUpdate_IsFirmwareUpdatable(
 				// There should be at least one match
 				for (unIndex = 0; unIndex < sSecurityModuleLogicInfo2.sKeyList.wEntries; unIndex++)
 				{
-					if (sSecurityModuleLogicInfo2.sKeyList.DecryptKeyId[unIndex] == sSignedData.sSignerInfo.sSignedAttributes.DecryptKeyId)
+					if (sSecurityModuleLogicInfo2.sKeyList.DecryptKeyId[unIndex] == sSignedData.sSignedAttributes.DecryptKeyId)
 					{
 						fDecryptKeyValid = TRUE;
 						break;
@@ -615,6 +1130,7 @@ FirmwareUpdate_IsFirmwareUpdatable(
 					break;
 				}
 			}
+#endif
 		}
 
 		// Check if the field upgrade counter allows an upgrade
@@ -685,12 +1201,7 @@ FirmwareUpdate_IsFirmwareUpdatable(
 			BOOL fActiveVersionVerified = FALSE;
 
 			// First get the current running build number from FieldUpgradeInfoRequest2
-			unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
-			if (TPM_RESOURCES == (unReturnValue ^ RC_TPM_MASK))
-			{
-				// Retry once on TPM_RESOURCES
-				unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
-			}
+			unReturnValue = FirmwareUpdate_Tpm12_GetSecurityModuleLogicInfo(&securityModuleLogicInfo);
 			if (RC_SUCCESS != unReturnValue)
 			{
 				ERROR_STORE(unReturnValue, L"TSS_TPM_FieldUpgradeInfoRequest2 returned an unexpected value.");
@@ -732,15 +1243,15 @@ FirmwareUpdate_IsFirmwareUpdatable(
 			{
 				BYTE* rgbPolicyParameterBlock = NULL;
 				INT32 nPolicyParameterBlockSize = 0;
-				sSignedData_d sSignedData = {0};
+				sSignedDataView_d sSignedData = {0};
 				// Copy pointer and size for unmarshalling
 				rgbPolicyParameterBlock = PpsFirmwareImage->rgbPolicyParameterBlock;
 				nPolicyParameterBlockSize = PpsFirmwareImage->usPolicyParameterBlockSize;
 				// Unmarshal the block to sSignedData structure
-				unReturnValue = TSS_sSignedData_d_Unmarshal(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
+				unReturnValue = TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
 				if (RC_SUCCESS != unReturnValue)
 				{
-					ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_Unmarshal returned an unexpected value. (0x%.8x)", unReturnValue);
+					ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_UnmarshalView returned an unexpected value. (0x%.8x)", unReturnValue);
 					unReturnValue = RC_E_CORRUPT_FW_IMAGE;
 					break;
 				}
@@ -748,7 +1259,7 @@ FirmwareUpdate_IsFirmwareUpdatable(
 				{
 					// Get the unique ID from policy parameter block.
 					unsigned int unUniqueTPM = 0;
-					unsigned int unUniqueFirmwareImage = sSignedData.sSignerInfo.sSignedAttributes.sFirmwarePackage.StaleVersion & 0x0000000f;
+					unsigned int unUniqueFirmwareImage = sSignedData.sSignedAttributes.sFirmwarePackage.StaleVersion & 0x0000000f;
 
 					// Get the unique ID from the TPM
 					unUniqueTPM = securityModuleLogicInfo.sProcessFirmwarePackage.StaleVersion & 0x0000000f;
@@ -782,56 +1293,106 @@ FirmwareUpdate_IsFirmwareUpdatable(
 	}
 	WHILE_FALSE_END;
 
+	// A corrupt image takes precedence over the results of the TPM dependent checks
+	if (fVerificationStarted)
+	{
+		IfxImageVerification sVerification;
+		if (FirmwareUpdate_FinishImageVerification(PrgbFirmwareImage, (UINT32)PnFirmwareImageSize, &sVerification) &&
+				(RC_SUCCESS != sVerification.unReturnValue || RC_SUCCESS != sVerification.unErrorDetails))
+		{
+			*PpfValid = FALSE;
+			IGNORE_RETURN_VALUE(Platform_MemorySet(PpbfNewTpmFirmwareInfo, 0, sizeof(BITFIELD_NEW_TPM_FIRMWARE_INFO)));
+			if (RC_SUCCESS != sVerification.unReturnValue)
+			{
+				unReturnValue = sVerification.unReturnValue;
+				ERROR_STORE(unReturnValue, sVerification.wszError);
+			}
+			else
+			{
+				unReturnValue = RC_SUCCESS;
+				*PpunErrorDetails = sVerification.unErrorDetails;
+				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, sVerification.wszError);
+			}
+		}
+	}
+
 	return unReturnValue;
 }
 
+/// Snapshot of the TPM state of the last successful FirmwareUpdate_CalculateState call
+static TPM_STATE s_sTpmStateSnapshot = {{0}};
+
+/// Flag indicating s_sTpmStateSnapshot reflects the current TPM state
+static BOOL s_fTpmStateSnapshotValid = FALSE;
+
+/// Flag indicating the TPM state detection starts with TPM_Startup (see FirmwareUpdate_SetTpm12Hint)
+static BOOL s_fTpm12Hint = FALSE;
+
 /**
- *	@brief		Returns the TPM state attributes
- *	@details
+ *	@brief		Probes the TPM state attributes
+ *	@details	Detects the TPM family, the vendor and the failure states. The TPM1.2 owner, enabled, activated and physical
+ *				presence flags and the TPM2.0 platform hierarchy state are only queried if PfDetailed is TRUE.
+ *				The family is detected with a single startup command: TPM2_Startup first, or TPM_Startup first if the TPM
+ *				was a TPM1.2 or in boot loader mode last time. The other startup command is only sent if the first one is
+ *				not answered like expected from that family.
  *
  *	@param		PpsTpmState					Pointer to a variable representing the TPM state
+ *	@param		PfDetailed					TRUE to query the complete TPM state, FALSE to skip the TPM commands for the attributes above
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PpsTpmState is NULL.
  *	@retval		RC_E_FAIL					An unexpected error occurred. E.g. more than one property returned from TPM2_GetCapability call
  *	@retval		...							Error codes from called functions.
  */
 _Check_return_
-unsigned int
-FirmwareUpdate_CalculateState(
-	_Out_ TPM_STATE* PpsTpmState)
+static unsigned int
+FirmwareUpdate_ProbeState(
+	_Out_	TPM_STATE*	PpsTpmState,
+	_In_	BOOL		PfDetailed)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	// Result of TPM_Startup if it has already been sent
+	unsigned int unTpm12StartupResult = RC_E_FAIL;
+	BOOL fTpm12Responded = FALSE;
 
 	do
 	{
-		// Check parameters
-		if (NULL == PpsTpmState)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpsTpmState is NULL)");
-			break;
-		}
-
 		unReturnValue = Platform_MemorySet(PpsTpmState, 0, sizeof(*PpsTpmState));
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Try to call a TPM2_Startup command
-		unReturnValue = TSS_TPM2_Startup(TPM_SU_CLEAR);
-		// Remember to orderly shutdown the TPM2.0 if TPM2_Startup completed successfully.
-		if (TPM_RC_SUCCESS == unReturnValue)
+#if IFX_ENABLE_TPM20
+		if (s_fTpm12Hint)
+		{
+			// Skip TPM2_Startup if the TPM still answers TPM_Startup like a TPM1.2 or a TPM in boot loader mode
+			unTpm12StartupResult = TSS_TPM_Startup(TPM_ST_CLEAR);
+			fTpm12Responded = RC_SUCCESS == unTpm12StartupResult ||
+							  TPM_INVALID_POSTINIT == (unTpm12StartupResult ^ RC_TPM_MASK) ||
+							  TPM_FAILEDSELFTEST == (unTpm12StartupResult ^ RC_TPM_MASK);
+			if (!fTpm12Responded)
+			{
+				LOGGING_WRITE_LEVEL3_FMT(L"TPM_Startup returned 0x%.8X, trying TPM2_Startup.", unTpm12StartupResult);
+			}
+		}
+
+		if (!fTpm12Responded)
 		{
-			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_CALL_SHUTDOWN_ON_EXIT, TRUE));
+			// Try to call a TPM2_Startup command
+			unReturnValue = TSS_TPM2_Startup(TPM_SU_CLEAR);
+			// Remember to orderly shutdown the TPM2.0 if TPM2_Startup completed successfully.
+			// An already started TPM2.0 answers TPM_RC_INITIALIZE and is left running without TPM2_Shutdown.
+			if (TPM_RC_SUCCESS == unReturnValue)
+			{
+				IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_CALL_SHUTDOWN_ON_EXIT, TRUE));
+			}
 		}
 
-		if (TPM_RC_SUCCESS == unReturnValue ||
-				TPM_RC_INITIALIZE == (unReturnValue ^ RC_TPM_MASK) ||
-				TPM_RC_FAILURE == (unReturnValue ^ RC_TPM_MASK))
+		if (!fTpm12Responded &&
+				(TPM_RC_SUCCESS == unReturnValue ||
+				 TPM_RC_INITIALIZE == (unReturnValue ^ RC_TPM_MASK) ||
+				 TPM_RC_FAILURE == (unReturnValue ^ RC_TPM_MASK)))
 		{
 			// The TPM is a TPM2.0
-			BYTE bMoreData = 0;
-			TPMS_CAPABILITY_DATA capabilityData = {0};
+			UINT32 unManufacturer = 0;
 			PpsTpmState->attribs.tpm20 = 1;
 
 			// Set the failure mode flag in case the TPM2.0 is in failure mode.
@@ -854,13 +1415,14 @@ FirmwareUpdate_CalculateState(
 				}
 			}
 
-			unReturnValue = TSS_TPM2_GetCapability(TPM_CAP_TPM_PROPERTIES, TPM_PT_MANUFACTURER, 1, &bMoreData, &capabilityData);
-			if (TPM_RC_SUCCESS == unReturnValue && 1 == capabilityData.data.tpmProperties.count)
+			// Reads TPM_PT_MANUFACTURER up to TPM_PT_FIRMWARE_VERSION_2 at once, the firmware version is taken from the same table later on
+			unReturnValue = FirmwareUpdate_Tpm20_GetProperty(TPM_PT_MANUFACTURER, &unManufacturer);
+			if (TPM_RC_SUCCESS == unReturnValue)
 			{
-				if (capabilityData.data.tpmProperties.tpmProperty[0].value == 0x49465800 /* IFX\0 */)
+				if (unManufacturer == 0x49465800 /* IFX\0 */)
 				{
 					PpsTpmState->attribs.infineon = 1;
-					if (!PpsTpmState->attribs.tpm20InFailureMode)
+					if (PfDetailed && !PpsTpmState->attribs.tpm20InFailureMode)
 					{
 						// Check whether platformAuth is the Empty Buffer and platform hierarchy is enabled.
 						// (-> Preconditions for TPMFactoryUpd to update a TPM2.0)
@@ -897,10 +1459,10 @@ FirmwareUpdate_CalculateState(
 			}
 			else
 			{
-				ERROR_STORE(unReturnValue, L"TSS_TPM2_GetCapability returned an unexpected value. (TPM_CAP_TPM_PROPERTIES,TPM_PT_MANUFACTURER)");
+				ERROR_STORE(unReturnValue, L"FirmwareUpdate_Tpm20_GetProperty returned an unexpected value. (TPM_PT_MANUFACTURER)");
 			}
 		}
-		else if ((unReturnValue ^ RC_TPM_MASK) == TPM_RC_REBOOT)
+		else if (!fTpm12Responded && (unReturnValue ^ RC_TPM_MASK) == TPM_RC_REBOOT)
 		{
 			// The TPM has been updated to TPM2.0 but has not yet been restarted
 			PpsTpmState->attribs.tpm20 = 1;
@@ -909,22 +1471,25 @@ FirmwareUpdate_CalculateState(
 			unReturnValue = RC_SUCCESS;
 		}
 		else
+#endif // IFX_ENABLE_TPM20
 		{
+			// A TPM1.2 or a TPM in boot loader mode (also used to detect an interrupted TPM2.0 firmware update)
 			TPM_CAP_VERSION_INFO tpmVersionInfo = {0};
-			UINT32 unTpmVersionSizeInfo = sizeof(TPM_CAP_VERSION_INFO);
 			BYTE rgbIFX[] = { 'I', 'F', 'X' , 0x00};
-			unReturnValue = TSS_TPM_Startup(TPM_ST_CLEAR);
+			unReturnValue = fTpm12Responded ? unTpm12StartupResult : TSS_TPM_Startup(TPM_ST_CLEAR);
 			if (RC_SUCCESS == unReturnValue || TPM_INVALID_POSTINIT == (unReturnValue ^ RC_TPM_MASK))
 			{
 				// The TPM is a TPM1.2
 				PpsTpmState->attribs.tpm12 = 1;
-				unReturnValue = TSS_TPM_GetCapability(TPM_CAP_VERSION_VAL, 0, NULL, &unTpmVersionSizeInfo, (BYTE*)&tpmVersionInfo);
+#if IFX_ENABLE_TPM12
+				unReturnValue = FirmwareUpdate_Tpm12_GetVersionInfo(&tpmVersionInfo);
 				if ((RC_SUCCESS == unReturnValue) && 0 == Platform_MemoryCompare(tpmVersionInfo.tpmVendorID, rgbIFX, sizeof(rgbIFX)))
+					PpsTpmState->attribs.infineon = 1;
+				if (PfDetailed && PpsTpmState->attribs.infineon)
 				{
 					UINT32 unSubCap = Platform_SwapBytes32(TPM_CAP_PROP_OWNER);
 					BYTE bOwner = 0x0;
 					UINT32 unResponseSize = sizeof(bOwner);
-					PpsTpmState->attribs.infineon = 1;
 					unReturnValue = TSS_TPM_GetCapability(TPM_CAP_PROPERTY, sizeof(unSubCap), (BYTE*)&unSubCap, &unResponseSize, (BYTE*)&bOwner);
 					if (RC_SUCCESS == unReturnValue)
 					{
@@ -950,6 +1515,7 @@ FirmwareUpdate_CalculateState(
 						}
 					}
 				}
+				if (PfDetailed)
 				{
 					// Get activated/enabled state.
 					// First get permanent flags.
@@ -981,12 +1547,13 @@ FirmwareUpdate_CalculateState(
 						PpsTpmState->attribs.tpm12PhysicalPresenceLock = sStclearFlags.physicalPresenceLock;
 					}
 				}
+#endif // IFX_ENABLE_TPM12
 				unReturnValue = RC_SUCCESS;
 			}
 			else if (TPM_FAILEDSELFTEST == (unReturnValue ^ RC_TPM_MASK))
 			{
 				// A TPM1.2 either failed the self test or the TPM is in boot loader mode
-				unReturnValue = TSS_TPM_GetCapability(TPM_CAP_VERSION_VAL, 0, NULL, &unTpmVersionSizeInfo, (BYTE*)&tpmVersionInfo);
+				unReturnValue = FirmwareUpdate_Tpm12_GetVersionInfo(&tpmVersionInfo);
 				if (RC_SUCCESS == unReturnValue)
 				{
 					if (0 == Platform_MemoryCompare(tpmVersionInfo.tpmVendorID, rgbIFX, sizeof(rgbIFX)))
@@ -1049,11 +1616,285 @@ FirmwareUpdate_CalculateState(
 	}
 	WHILE_FALSE_END;
 
+	// Start the next detection with the family found this time
+	if (RC_SUCCESS == unReturnValue)
+		s_fTpm12Hint = PpsTpmState->attribs.tpm12 || PpsTpmState->attribs.bootLoader;
+
 	return unReturnValue;
 }
 
 /**
- *	@brief		FirmwareUpdate start for TPM2.0.
+ *	@brief		Returns the TPM state attributes
+ *	@details	The TPM is probed once. Later calls return a snapshot of the state until FirmwareUpdate_InvalidateState
+ *				is called after an operation that changes the state of the TPM.
+ *
+ *	@param		PpsTpmState					Pointer to a variable representing the TPM state
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PpsTpmState is NULL.
+ *	@retval		RC_E_FAIL					An unexpected error occurred. E.g. more than one property returned from TPM2_GetCapability call
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_CalculateState(
+	_Out_ TPM_STATE* PpsTpmState)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpsTpmState)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PpsTpmState is NULL)");
+			break;
+		}
+
+		// Return the snapshot if the TPM state has not changed since the last probe
+		if (TRUE == s_fTpmStateSnapshotValid)
+		{
+			*PpsTpmState = s_sTpmStateSnapshot;
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		unReturnValue = FirmwareUpdate_ProbeState(PpsTpmState, TRUE);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		s_sTpmStateSnapshot = *PpsTpmState;
+		s_fTpmStateSnapshotValid = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Invalidates the TPM state snapshot
+ *	@details	Must be called after operations that change the TPM state, e.g. firmware update start and complete,
+ *				TPM1.2 ownership or physical presence changes. The next FirmwareUpdate_CalculateState call probes the TPM again.
+ */
+void
+FirmwareUpdate_InvalidateState()
+{
+	s_fTpmStateSnapshotValid = FALSE;
+	s_fTpm20PropertyTableValid = FALSE;
+	s_fTpm12VersionInfoValid = FALSE;
+	s_fTpm20SecurityModuleLogicInfo2Valid = FALSE;
+	s_fTpm12SecurityModuleLogicInfoValid = FALSE;
+}
+
+/**
+ *	@brief		Records Deferred Physical Presence set on a TPM1.2 in the TPM state snapshot
+ *	@details	Called instead of FirmwareUpdate_InvalidateState after Physical Presence has been asserted and the Deferred
+ *				Physical Presence bit set, so that the next FirmwareUpdate_CalculateState call does not probe the TPM again
+ *				for flags known already.
+ *
+ *	@param		PfCmdEnabled		TRUE if the physical presence command has been enabled as well
+ */
+void
+FirmwareUpdate_SetTpm12DeferredPhysicalPresence(
+	_In_	BOOL	PfCmdEnabled)
+{
+	if (PfCmdEnabled)
+		s_sTpmStateSnapshot.attribs.tpm12PhysicalPresenceCMDEnable = 1;
+	s_sTpmStateSnapshot.attribs.tpm12PhysicalPresence = 1;
+	s_sTpmStateSnapshot.attribs.tpm12DeferredPhysicalPresence = 1;
+}
+
+/**
+ *	@brief		Sets the TPM family expected by the next TPM state detection
+ *	@details	See FirmwareUpdate_ProbeState.
+ *
+ *	@param		PfTpm12						TRUE if the TPM was a TPM1.2 or in boot loader mode the last time, FALSE otherwise
+ */
+void
+FirmwareUpdate_SetTpm12Hint(
+	_In_	BOOL	PfTpm12)
+{
+	s_fTpm12Hint = PfTpm12;
+}
+
+/**
+ *	@brief		Marks a firmware image as already verified
+ *	@details	The integrity checks of FirmwareUpdate_CheckImage (CRC, signature and firmware digest) are skipped for the
+ *				given buffer. All other checks, in particular the TPM dependent ones, are still performed. The caller is
+ *				responsible for having verified the content of the buffer (e.g. by a verification cache keyed by the image
+ *				digest) and must reset the mark with NULL before the buffer is released.
+ *
+ *	@param		PrgbImage					Firmware image byte stream or NULL to reset the mark
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ */
+void
+FirmwareUpdate_SetImageIntegrityVerified(
+	_In_opt_	const BYTE*		PrgbImage,
+	_In_		UINT32			PunImageSize)
+{
+	s_pbIntegrityVerifiedImage = PrgbImage;
+	s_unIntegrityVerifiedImageSize = NULL != PrgbImage ? PunImageSize : 0;
+}
+
+/**
+ *	@brief		Verifies the integrity of a firmware image without accessing the TPM
+ *	@details	Runs the integrity checks of FirmwareUpdate_CheckImage (CRC, signature and firmware digest) on the calling
+ *				thread, e.g. once before the image is handed to several forked workers. Images in a format which is checked
+ *				differently by FirmwareUpdate_CheckImage are not verified and leave PpfValid FALSE. The error stack is not
+ *				used, so the function can run on a worker thread.
+ *
+ *	@param		PrgbImage					Firmware image byte stream
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage			Unmarshalled PrgbImage
+ *	@param		PpfValid					Receives TRUE if the image passed the integrity checks
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_CheckImageIntegrity(
+	_In_bytecount_(PunImageSize)	const BYTE*				PrgbImage,
+	_In_							UINT32					PunImageSize,
+	_In_							const IfxFirmwareImage*	PpsFirmwareImage,
+	_Out_							BOOL*					PpfValid)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxImageVerification sVerification = {0};
+
+		// Check parameters
+		if (NULL == PrgbImage || 0 == PunImageSize || NULL == PpsFirmwareImage || NULL == PpfValid)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpfValid = FALSE;
+
+		// Only the images FirmwareUpdate_CheckImage verifies by FirmwareUpdate_VerifyImageIntegrity are checked here
+		unReturnValue = RC_SUCCESS;
+		if (PunImageSize > 0x7FFFFFFF ||
+				0 != Platform_MemoryCompare(&PpsFirmwareImage->unique, &EFI_IFXTPM_FIRMWARE_IMAGE_GUID, sizeof(EFI_IFXTPM_FIRMWARE_IMAGE_GUID)) ||
+				2 > PpsFirmwareImage->usImageStructureVersion || SIG_KEY_ID_1 != PpsFirmwareImage->usSignatureKeyId)
+			break;
+
+		sVerification.pbImage = PrgbImage;
+		sVerification.unImageSize = PunImageSize;
+		sVerification.psFirmwareImage = PpsFirmwareImage;
+		FirmwareUpdate_VerifyImageIntegrity(&sVerification);
+		unReturnValue = sVerification.unReturnValue;
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		*PpfValid = (RC_SUCCESS == sVerification.unErrorDetails);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/// Share of the firmware images verified by one thread of FirmwareUpdate_CheckImagesIntegrity
+typedef struct tdIfxImageIntegrityWorker
+{
+	/// Images to verify
+	IfxImageIntegrityCheck*		psChecks;
+	/// Number of images in psChecks
+	unsigned int				unCheckCount;
+	/// Index of the first image verified by the thread
+	unsigned int				unFirstCheck;
+	/// Distance between the images verified by the thread
+	unsigned int				unCheckStride;
+	/// Thread handle, NULL if the share is verified by the calling thread
+	void*						pvThread;
+} IfxImageIntegrityWorker;
+
+/**
+ *	@brief		Thread function of FirmwareUpdate_CheckImagesIntegrity
+ *	@details	Each image belongs to exactly one share and receives its own result, so the threads do not need any
+ *				synchronization.
+ *
+ *	@param		PpvWorker					Share of the images (IfxImageIntegrityWorker)
+ */
+static void
+FirmwareUpdate_CheckImagesIntegrityThread(
+	_Inout_ void* PpvWorker)
+{
+	IfxImageIntegrityWorker* pWorker = (IfxImageIntegrityWorker*)PpvWorker;
+	unsigned int unCheck = 0;
+
+	for (unCheck = pWorker->unFirstCheck; unCheck < pWorker->unCheckCount; unCheck += pWorker->unCheckStride)
+	{
+		IfxImageIntegrityCheck* psCheck = &pWorker->psChecks[unCheck];
+		psCheck->fValid = FALSE;
+		psCheck->unReturnValue = FirmwareUpdate_CheckImageIntegrity(psCheck->pbImage, psCheck->unImageSize, psCheck->psFirmwareImage, &psCheck->fValid);
+	}
+}
+
+/**
+ *	@brief		Verifies the integrity of several firmware images concurrently without accessing the TPM
+ *	@details	Runs FirmwareUpdate_CheckImageIntegrity for each image on up to FIRMWARE_UPDATE_VERIFY_THREADS_MAX threads.
+ *				The calling thread verifies a share of the images itself, as well as the share of a thread which cannot
+ *				be started. Each result is returned in the entry of its image, so the results keep the order of the
+ *				input. The images must stay valid until the function returns.
+ *
+ *	@param		PrgsChecks					Images to verify, receive the results
+ *	@param		PunCheckCount				Number of entries in PrgsChecks
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_CheckImagesIntegrity(
+	_Inout_updates_(PunCheckCount)	IfxImageIntegrityCheck*	PrgsChecks,
+	_In_							unsigned int			PunCheckCount)
+{
+	IfxImageIntegrityWorker rgsWorkers[FIRMWARE_UPDATE_VERIFY_THREADS_MAX];
+	unsigned int unWorkerCount = (FIRMWARE_UPDATE_VERIFY_THREADS_MAX < PunCheckCount) ? FIRMWARE_UPDATE_VERIFY_THREADS_MAX : PunCheckCount;
+	unsigned int unWorker = 0;
+
+	if (NULL == PrgsChecks && 0 != PunCheckCount)
+		return RC_E_BAD_PARAMETER;
+
+	// Each worker verifies every unWorkerCount-th image. The first share is verified by the calling thread.
+	for (unWorker = 0; unWorker < unWorkerCount; unWorker++)
+	{
+		IfxImageIntegrityWorker* pWorker = &rgsWorkers[unWorker];
+		pWorker->psChecks = PrgsChecks;
+		pWorker->unCheckCount = PunCheckCount;
+		pWorker->unFirstCheck = unWorker;
+		pWorker->unCheckStride = unWorkerCount;
+		pWorker->pvThread = NULL;
+		if (0 != unWorker && RC_SUCCESS != Platform_ThreadCreate(FirmwareUpdate_CheckImagesIntegrityThread, pWorker, &pWorker->pvThread))
+			pWorker->pvThread = NULL;
+	}
+	for (unWorker = 0; unWorker < unWorkerCount; unWorker++)
+	{
+		if (NULL == rgsWorkers[unWorker].pvThread)
+			FirmwareUpdate_CheckImagesIntegrityThread(&rgsWorkers[unWorker]);
+	}
+	for (unWorker = 0; unWorker < unWorkerCount; unWorker++)
+	{
+		unsigned int unCheck = 0;
+
+		if (NULL == rgsWorkers[unWorker].pvThread || RC_SUCCESS == Platform_ThreadJoin(&rgsWorkers[unWorker].pvThread))
+			continue;
+
+		// The results of a share which cannot be collected are not trusted
+		for (unCheck = unWorker; unCheck < PunCheckCount; unCheck += unWorkerCount)
+		{
+			PrgsChecks[unCheck].fValid = FALSE;
+			PrgsChecks[unCheck].unReturnValue = RC_E_FAIL;
+		}
+	}
+
+	return RC_SUCCESS;
+}
+
+#if IFX_ENABLE_TPM20
+/**
+ *	@brief		FirmwareUpdate start for TPM2.0.
  *	@details	The function takes the firmware update policy parameter block and the stored policy session and starts the
  *				firmware update process.
  *
@@ -1088,7 +1929,7 @@ FirmwareUpdate_Start_Tpm20(
 		AcknowledgmentResponseData sAckAuthSessionData = {{0}};
 
 		// Policy parameter block data
-		sSignedData_d sSignedData = {0};
+		sSignedDataView_d sSignedData = {0};
 
 		BYTE* rgbPolicyParameterBlock = NULL;
 		INT32 nPolicyParameterBlockSize = 0;
@@ -1117,10 +1958,10 @@ FirmwareUpdate_Start_Tpm20(
 		nPolicyParameterBlockSize = PusPolicyParameterBlockSize;
 
 		// Unmarshal the block to sSignedData structure
-		unReturnValue = TSS_sSignedData_d_Unmarshal(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
+		unReturnValue = TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
 		if (RC_SUCCESS != unReturnValue)
 		{
-			ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_Unmarshal returned an unexpected value. (0x%.8x)", unReturnValue);
+			ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_UnmarshalView returned an unexpected value. (0x%.8x)", unReturnValue);
 			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
 			break;
 		}
@@ -1130,7 +1971,7 @@ FirmwareUpdate_Start_Tpm20(
 		sAuthSessionData.sessionAttributes.continueSession = 1;
 
 		// Call TPM2_FieldUpgradeStartVendor command
-		unReturnValue = TSS_TPM2_FieldUpgradeStartVendor(TPM_RH_PLATFORM, sAuthSessionData, sSignedData, &usStartSize, &sAckAuthSessionData);
+		unReturnValue = TSS_TPM2_FieldUpgradeStartVendor(TPM_RH_PLATFORM, sAuthSessionData, &sSignedData, &usStartSize, &sAckAuthSessionData);
 		if ((RC_TPM_MASK | TPM_RC_REFERENCE_S0) == unReturnValue)
 		{
 			// Policy session handle is not loaded to the TPM
@@ -1168,6 +2009,7 @@ FirmwareUpdate_Start_Tpm20(
 
 	return unReturnValue;
 }
+#endif // IFX_ENABLE_TPM20
 
 /**
  *	@brief		FirmwareUpdate start for TPM1.2.
@@ -1206,7 +2048,7 @@ _Check_return_ unsigned int FirmwareUpdate_Start_Tpm12(
 		INT32 nPolicyParameterBlockSize = 0;
 
 		// Policy parameter block data
-		sSignedData_d sSignedData = {0};
+		sSignedDataView_d sSignedData = {0};
 
 		// Check parameters
 		if (NULL == PrgbPolicyParameterBlock ||
@@ -1222,14 +2064,15 @@ _Check_return_ unsigned int FirmwareUpdate_Start_Tpm12(
 		nPolicyParameterBlockSize = PusPolicyParameterBlockSize;
 
 		// Unmarshal the block to sSignedData structure
-		unReturnValue = TSS_sSignedData_d_Unmarshal(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
+		unReturnValue = TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
 		if (RC_SUCCESS != unReturnValue)
 		{
-			ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_Unmarshal returned an unexpected value. (0x%.8x)", unReturnValue);
+			ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_UnmarshalView returned an unexpected value. (0x%.8x)", unReturnValue);
 			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
 			break;
 		}
 
+#if IFX_ENABLE_TPM12
 		if (PbfTpmAttributes.tpm12 && PbfTpmAttributes.tpm12owner)
 		{
 			// Get dictionary attack state for TPM_ET_OWNER and return RC_E_TPM12_DA_ACTIVE if TPM Owner is locked out.
@@ -1275,16 +2118,17 @@ _Check_return_ unsigned int FirmwareUpdate_Start_Tpm12(
 				}
 			}
 
-			// Start OIAP session for TPM Owner authorized firmware update.
-			unReturnValue = TSS_TPM_OIAP(&unAuthHandle, &sNonceEven);
+			// Get an OIAP session for TPM Owner authorized firmware update (reuses the session of the owner authorization check).
+			unReturnValue = FirmwareUpdate_Tpm12_AcquireAuthSession(&unAuthHandle, &sNonceEven);
 			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"TSS_TPM_OIAP returned an unexpected value.");
 				break;
-			}
 
 			pbOwnerAuth = (BYTE*)PrgbOwnerAuthHash;
 		}
+#else
+		UNREFERENCED_PARAMETER(PbfTpmAttributes);
+		UNREFERENCED_PARAMETER(PrgbOwnerAuthHash);
+#endif
 
 		unReturnValue = TSS_TPM_FieldUpgradeStart(PrgbPolicyParameterBlock, PusPolicyParameterBlockSize, pbOwnerAuth, unAuthHandle, &sNonceEven);
 		if (RC_SUCCESS != unReturnValue)
@@ -1305,10 +2149,12 @@ _Check_return_ unsigned int FirmwareUpdate_Start_Tpm12(
 				unReturnValue = RC_E_FIRMWARE_UPDATE_FAILED;
 			}
 
+#if IFX_ENABLE_TPM12
 			if (PbfTpmAttributes.tpm12owner)
 			{
 				IGNORE_RETURN_VALUE(TSS_TPM_FlushSpecific(unAuthHandle, TPM_RT_AUTH));
 			}
+#endif
 
 			break;
 		}
@@ -1323,14 +2169,294 @@ _Check_return_ unsigned int FirmwareUpdate_Start_Tpm12(
 	return unReturnValue;
 }
 
+/// Progress callback of the pipelined firmware block transfer
+static PFN_FIRMWAREUPDATE_PROGRESSCALLBACK s_fnPendingProgressCallback = NULL;
+
+/// Progress details callback of the pipelined firmware block transfer
+static PFN_FIRMWAREUPDATE_PROGRESSDETAILSCALLBACK s_fnPendingProgressDetailsCallback = NULL;
+
+/// Progress of the last completed firmware block which has not been reported yet (0 if none)
+static UINT32 s_unPendingProgress = 0;
+
+/// Transfer progress of the last completed firmware block
+static IfxFirmwareUpdateProgress s_sPendingProgressDetails = {0};
+
+/// Flag indicating s_sPendingProgressDetails has not been reported yet
+static BOOL s_fPendingProgressDetails = FALSE;
+
+/// Flag indicating the current firmware block has been handed over to the TPM
+static BOOL s_fBlockHandedOver = FALSE;
+
+/**
+ *	@brief		Reports the progress of the last completed firmware block
+ *	@details	Used as command pending callback while the next firmware block is executed by the TPM, so the
+ *				progress output of block N overlaps the transfer of block N+1.
+ */
+static void
+FirmwareUpdate_ReportPendingProgress()
+{
+	UINT32 unProgress = s_unPendingProgress;
+
+	s_fBlockHandedOver = TRUE;
+	s_unPendingProgress = 0;
+	if (NULL != s_fnPendingProgressDetailsCallback)
+	{
+		if (TRUE == s_fPendingProgressDetails)
+		{
+			s_fPendingProgressDetails = FALSE;
+			s_fnPendingProgressDetailsCallback(&s_sPendingProgressDetails);
+		}
+	}
+	else if (0 != unProgress && NULL != s_fnPendingProgressCallback)
+		s_fnPendingProgressCallback(unProgress);
+}
+
+/**
+ *	@brief		Updates the transfer progress after a firmware block has been sent
+ *	@details	The transfer rate is smoothed over the last blocks so single slow blocks do not make the estimated time jump.
+ *
+ *	@param		PunBlockSize			Size of the firmware block sent
+ *	@param		PullStartTime			Monotonic time stamp in microseconds when the transfer started (0 if no clock is available)
+ *	@param		PpullLastBlockTime		In: Monotonic time stamp in microseconds of the previous block, Out: of the current block
+ */
+static void
+FirmwareUpdate_UpdateProgressDetails(
+	_In_	UINT32				PunBlockSize,
+	_In_	unsigned long long	PullStartTime,
+	_Inout_	unsigned long long*	PpullLastBlockTime)
+{
+	IfxFirmwareUpdateProgress* psProgress = &s_sPendingProgressDetails;
+
+	psProgress->unBlocksSent++;
+	psProgress->unBytesSent += PunBlockSize;
+	psProgress->unCompletion = psProgress->unBytesSent * 98ULL / psProgress->unBytesTotal + 1;
+
+	if (0 != PullStartTime)
+	{
+		unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+		unsigned long long ullBlockTime = ullNow - *PpullLastBlockTime;
+
+		*PpullLastBlockTime = ullNow;
+		psProgress->ullElapsedTime = (ullNow - PullStartTime) / 1000;
+		if (0 != ullBlockTime)
+		{
+			unsigned int unBlockRate = (unsigned int)(PunBlockSize * 1000000ULL / ullBlockTime);
+			// Exponential moving average with a weight of 1/4 for the current block
+			psProgress->unBytesPerSecond = 0 == psProgress->unBytesPerSecond ? unBlockRate : (unsigned int)((3ULL * psProgress->unBytesPerSecond + unBlockRate) / 4);
+		}
+		if (0 != psProgress->unBytesPerSecond)
+			psProgress->ullEstimatedTimeRemaining = (psProgress->unBytesTotal - psProgress->unBytesSent) * 1000ULL / psProgress->unBytesPerSecond;
+	}
+
+	s_fPendingProgressDetails = TRUE;
+}
+
+/**
+ *	@brief		Checks whether a TPM_FieldUpgrade_Update block failed before it was handed over to the TPM
+ *	@details	Only a TPM that did not become ready or a failed transmission of the request qualify, and only if the
+ *				device access layer did not signal the command as pending (TPM_STS.Go written, CRB start set or the
+ *				frame sent to the remote agent). Any later error may come after the boot loader processed the block,
+ *				and resending it would hand over a duplicate block, so the transfer is aborted then.
+ *
+ *	@param		PunReturnValue			Return value of TSS_TPM_FieldUpgradeUpdate_TransmitRequest(s)
+ *
+ *	@retval		TRUE					The block may be resent.
+ *	@retval		FALSE					The error is not transient or the block may have reached the boot loader.
+ */
+static BOOL
+FirmwareUpdate_IsTransientTransportError(
+	_In_ unsigned int PunReturnValue)
+{
+	if (TRUE == s_fBlockHandedOver)
+		return FALSE;
+
+	switch (PunReturnValue)
+	{
+		case RC_E_TPM_TRANSMIT_DATA:
+		case RC_E_NOT_READY:
+			return TRUE;
+		default:
+			return FALSE;
+	}
+}
+
+/**
+ *	@brief		Checks a frame file against the firmware image
+ *	@details	The frame file must belong to the firmware image (SHA-256 digest of the image, source TPM family, policy
+ *				parameter block and firmware size) and hold the firmware in complete TPM_FieldUpgradeUpdate frames of the
+ *				maximum data size given in the header. The frame headers are compared with the headers prepared for the
+ *				first and the last firmware block, the LRC of every frame is recomputed and the firmware blocks must match
+ *				the signed firmware digest. The frames are checked once here, so the transfer only transmits them.
+ *
+ *	@param		PrgbFrameFile			Frame file created by FirmwareUpdate_BuildFrameFile
+ *	@param		PunFrameFileSize		Size of the frame file
+ *	@param		PrgbImage				Firmware image byte stream
+ *	@param		PunImageSize			Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage		Unmarshalled PrgbImage
+ *	@param		PrgbFirmwareDigest		Signed SHA-256 digest of the firmware block
+ *	@param		PpusMaxDataSize			Receives the maximum data size the frames were built for
+ *	@param		PppbFrames				Receives a pointer to the first frame in PrgbFrameFile
+ *
+ *	@retval		RC_SUCCESS				The frame file belongs to the firmware image.
+ *	@retval		RC_E_INVALID_FRAME_FILE	The frame file is corrupt or belongs to a different firmware image.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+FirmwareUpdate_CheckFrameFile(
+	_In_bytecount_(PunFrameFileSize)	const BYTE*				PrgbFrameFile,
+	_In_								UINT32					PunFrameFileSize,
+	_In_bytecount_(PunImageSize)		const BYTE*				PrgbImage,
+	_In_								UINT32					PunImageSize,
+	_In_								const IfxFirmwareImage*	PpsFirmwareImage,
+	_In_bytecount_(SHA256_DIGEST_SIZE)	const BYTE*				PrgbFirmwareDigest,
+	_Out_								UINT16*					PpusMaxDataSize,
+	_Out_								const BYTE**			PppbFrames)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvDigestContext = NULL;
+
+	do
+	{
+		BYTE* pbBuffer = (BYTE*)PrgbFrameFile + FIRMWARE_FRAME_FILE_MAGIC_SIZE;
+		INT32 nSize = (INT32)(FIRMWARE_FRAME_FILE_HEADER_SIZE - FIRMWARE_FRAME_FILE_MAGIC_SIZE);
+		UINT8 bSourceTpmFamily = 0;
+		UINT16 usMaxDataSize = 0;
+		UINT16 usPolicyParameterBlockSize = 0;
+		UINT32 unFirmwareSize = 0;
+		UINT32 unFrameCount = 0;
+		UINT32 unFrame = 0;
+		const BYTE* pbFrame = NULL;
+		const BYTE* pbFirmware = PpsFirmwareImage->rgbFirmware;
+		TSS_TPM_FIELDUPGRADEUPDATE_REQUEST sFullRequest;
+		TSS_TPM_FIELDUPGRADEUPDATE_REQUEST sLastRequest;
+		BYTE rgbDigest[SHA256_DIGEST_SIZE] = {0};
+
+		// Check the header
+		unReturnValue = RC_E_INVALID_FRAME_FILE;
+		if (PunFrameFileSize < FIRMWARE_FRAME_FILE_HEADER_SIZE ||
+				0 != Platform_MemoryCompare(PrgbFrameFile, FIRMWARE_FRAME_FILE_MAGIC, FIRMWARE_FRAME_FILE_MAGIC_SIZE) ||
+				RC_SUCCESS != TSS_UINT8_Unmarshal(&bSourceTpmFamily, &pbBuffer, &nSize) ||
+				RC_SUCCESS != TSS_UINT16_Unmarshal(&usMaxDataSize, &pbBuffer, &nSize) ||
+				RC_SUCCESS != TSS_UINT16_Unmarshal(&usPolicyParameterBlockSize, &pbBuffer, &nSize) ||
+				RC_SUCCESS != TSS_UINT32_Unmarshal(&unFirmwareSize, &pbBuffer, &nSize) ||
+				RC_SUCCESS != TSS_UINT32_Unmarshal(&unFrameCount, &pbBuffer, &nSize))
+		{
+			ERROR_STORE(unReturnValue, L"The file is not a frame file.");
+			break;
+		}
+		if (bSourceTpmFamily != PpsFirmwareImage->bSourceTpmFamily ||
+				usPolicyParameterBlockSize != PpsFirmwareImage->usPolicyParameterBlockSize ||
+				unFirmwareSize != PpsFirmwareImage->unFirmwareSize ||
+				0 == usMaxDataSize || usMaxDataSize > MAX_COMMAND_SIZE - TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD ||
+				0 == unFirmwareSize ||
+				unFrameCount != (unFirmwareSize + usMaxDataSize - 1) / usMaxDataSize ||
+				(unsigned long long)PunFrameFileSize != (unsigned long long)FIRMWARE_FRAME_FILE_HEADER_SIZE + usPolicyParameterBlockSize +
+					unFirmwareSize + (unsigned long long)unFrameCount * TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The frame file does not match the firmware image. (Family:%d, PolicyParameterBlockSize:%d, FirmwareSize:%d, MaxDataSize:%d, Frames:%d)",
+				bSourceTpmFamily, usPolicyParameterBlockSize, unFirmwareSize, usMaxDataSize, unFrameCount);
+			break;
+		}
+
+		// The frame file must have been built from this image
+		unReturnValue = Crypt_SHA256(PrgbImage, PunImageSize, rgbDigest);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Crypt_SHA256 returned an unexpected value.");
+			break;
+		}
+		unReturnValue = RC_E_INVALID_FRAME_FILE;
+		if (0 != Platform_MemoryCompare(pbBuffer, rgbDigest, SHA256_DIGEST_SIZE) ||
+				0 != Platform_MemoryCompare(PrgbFrameFile + FIRMWARE_FRAME_FILE_HEADER_SIZE, PpsFirmwareImage->rgbPolicyParameterBlock, usPolicyParameterBlockSize))
+		{
+			ERROR_STORE(unReturnValue, L"The frame file was built from a different firmware image.");
+			break;
+		}
+
+		// All frames but the last one have the same header
+		unReturnValue = TSS_TPM_FieldUpgradeUpdate_PrepareRequest(pbFirmware, usMaxDataSize < unFirmwareSize ? usMaxDataSize : (UINT16)unFirmwareSize, &sFullRequest);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = TSS_TPM_FieldUpgradeUpdate_PrepareRequest(pbFirmware, (UINT16)(unFirmwareSize - (unFrameCount - 1) * usMaxDataSize), &sLastRequest);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"TSS_TPM_FieldUpgradeUpdate_PrepareRequest returned an unexpected value.");
+			break;
+		}
+
+		unReturnValue = Crypt_SHA256_Start(&pvDigestContext);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Crypt_SHA256_Start returned an unexpected value.");
+			break;
+		}
+		pbFrame = PrgbFrameFile + FIRMWARE_FRAME_FILE_HEADER_SIZE + usPolicyParameterBlockSize;
+		for (unFrame = 0; unFrame < unFrameCount; unFrame++)
+		{
+			const TSS_TPM_FIELDUPGRADEUPDATE_REQUEST* psRequest = unFrame + 1 < unFrameCount ? &sFullRequest : &sLastRequest;
+			const BYTE* pbBlock = pbFrame + TPM_FIELDUPGRADEUPDATE_HEADER_SIZE;
+
+			unReturnValue = RC_E_INVALID_FRAME_FILE;
+			if (0 != Platform_MemoryCompare(pbFrame, psRequest->rgbHeader, TPM_FIELDUPGRADEUPDATE_HEADER_SIZE) ||
+					pbBlock[psRequest->usBlockSize] != (TSS_CalcLRC(&pbFrame[TSS_COMMAND_HEADER_SIZE], TPM_FIELDUPGRADEUPDATE_HEADER_SIZE - TSS_COMMAND_HEADER_SIZE) ^
+														TSS_CalcLRC(pbBlock, psRequest->usBlockSize)))
+			{
+				ERROR_STORE_FMT(unReturnValue, L"Frame %d of the frame file is corrupt.", unFrame + 1);
+				break;
+			}
+			unReturnValue = Crypt_SHA256_Update(pvDigestContext, pbBlock, psRequest->usBlockSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Crypt_SHA256_Update returned an unexpected value.");
+				break;
+			}
+			pbFrame = pbBlock + psRequest->usBlockSize + 1;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = Crypt_SHA256_Finish(&pvDigestContext, rgbDigest);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Crypt_SHA256_Finish returned an unexpected value.");
+			break;
+		}
+		if (0 != Platform_MemoryCompare(rgbDigest, PrgbFirmwareDigest, SHA256_DIGEST_SIZE))
+		{
+			unReturnValue = RC_E_INVALID_FRAME_FILE;
+			ERROR_STORE(unReturnValue, L"The firmware in the frame file does not match the verified firmware digest.");
+			break;
+		}
+
+		*PpusMaxDataSize = usMaxDataSize;
+		*PppbFrames = PrgbFrameFile + FIRMWARE_FRAME_FILE_HEADER_SIZE + usPolicyParameterBlockSize;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvDigestContext)
+		IGNORE_RETURN_VALUE(Crypt_SHA256_Finish(&pvDigestContext, NULL));
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		FirmwareUpdateProcess Update
  *	@details	The function determines the maximum data size for a firmware block and sends the firmware to the TPM
- *				in chunks of maximum data size.
+ *				in chunks of maximum data size. With a firmware block reader only one chunk is resident at a time: each
+ *				chunk is read right before it is sent, and the digest of all chunks must match the verified digest before
+ *				the update may be completed. Frames checked by FirmwareUpdate_CheckFrameFile are transmitted as they are if they
+ *				were built for the maximum data size of the TPM.
  *
  *	@param		PunFirmwareBlockSize	Size of the firmware block
- *	@param		PrgbFirmwareBlock		Pointer to the firmware block byte stream
+ *	@param		PrgbFirmwareBlock		Pointer to the firmware block byte stream (not accessed if PfnReadFirmware is set)
+ *	@param		PfnReadFirmware			Optional firmware block reader
+ *	@param		PpvReadFirmwareContext	Context handed over to PfnReadFirmware
+ *	@param		PrgbFirmwareDigest		Expected SHA-256 digest of the firmware block, required if PfnReadFirmware is set
+ *	@param		PrgbFrames				Optional TPM_FieldUpgradeUpdate frames of a frame file for the firmware block
+ *	@param		PusFramesMaxDataSize	Maximum data size PrgbFrames were built for
  *	@param		PfnProgress				Callback function to indicate the progress
+ *	@param		PfnProgressDetails		Optional callback function to indicate the transfer progress in detail, replaces PfnProgress during the transfer
+ *	@param		PpsTimings				Receives the number and the maximum size of the firmware blocks
  *
  *	@retval		RC_SUCCESS						The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function. The firmware image block is NULL
@@ -1341,81 +2467,312 @@ _Check_return_ unsigned int FirmwareUpdate_Start_Tpm12(
 _Check_return_ unsigned int FirmwareUpdate_Update(
 	_In_									UINT32								PunFirmwareBlockSize,
 	_In_bytecount_(PunFirmwareBlockSize)	BYTE*								PrgbFirmwareBlock,
-	_In_									PFN_FIRMWAREUPDATE_PROGRESSCALLBACK	PfnProgress)
+	_In_opt_								PFN_FIRMWAREUPDATE_READFIRMWARECALLBACK	PfnReadFirmware,
+	_In_opt_								void*								PpvReadFirmwareContext,
+	_In_opt_								const BYTE*							PrgbFirmwareDigest,
+	_In_opt_								const BYTE*							PrgbFrames,
+	_In_									UINT16								PusFramesMaxDataSize,
+	_In_									PFN_FIRMWAREUPDATE_PROGRESSCALLBACK	PfnProgress,
+	_In_opt_								PFN_FIRMWAREUPDATE_PROGRESSDETAILSCALLBACK	PfnProgressDetails,
+	_Inout_									IfxFirmwareUpdateTimings*			PpsTimings)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	TSS_TPM_FIELDUPGRADEUPDATE_REQUEST* rgsRequests = NULL;
+	BYTE* rgbStreamBlock = NULL;
+	void* pvStreamDigestContext = NULL;
+	BOOL fRealtime = FALSE;
+	void* pvRealtimeState = NULL;
+	UINT16 usMaxDataSize = 0;
+	UINT32 unBlockCount = 0;
+	BOOL fFrames = FALSE;
 
 	do
 	{
 		BYTE* rgbFirmwareBlock = NULL;
+		const BYTE* pbFrame = PrgbFrames;
 		UINT32 unRemainingBytes = 0;
 		UINT32 unBlockNumber = 0;
 		UINT32 unCurrentProgress = 1;
-		UINT16 usMaxDataSize = 0;
+		unsigned int unResentBlocks = 0;
+		BOOL fBatch = FALSE;
+		unsigned int unBatchAcked = 0;
+		unsigned long long ullTransferStartTime = 0;
+		unsigned long long ullLastBlockTime = 0;
+		unsigned int unBlockSample = 1;
+		IfxSession* pSession = Session_GetCurrent();
+
+		// Check parameters
+		if ((NULL == PfnReadFirmware && NULL == PrgbFirmwareBlock) || (NULL != PfnReadFirmware && NULL == PrgbFirmwareDigest) || NULL == PpsTimings)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PrgbFirmwareBlock or PrgbFirmwareDigest or PpsTimings is NULL)");
+			break;
+		}
+
+		rgbFirmwareBlock = PrgbFirmwareBlock;
+		unRemainingBytes = PunFirmwareBlockSize;
+
+		{
+			unsigned int unRetryCounter = 0;
+			unsigned int unWaitTime = TPM_FU_START_RETRY_WAIT_TIME_MIN;
+			unsigned int unElapsedTime = 0;
+			unsigned long long ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+
+			for (unRetryCounter = 0; ; unRetryCounter++)
+			{
+				// Get the max data size for a firmware update block.
+				sSecurityModuleLogicInfo_d securityModuleLogicInfo = {0};
+				unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
+				if (TPM_RESOURCES == (unReturnValue ^ RC_TPM_MASK))
+				{
+					// Retry once on TPM_RESOURCES
+					unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
+				}
+				if (RC_SUCCESS != unReturnValue)
+				{
+					if (TPM_BAD_PARAM_SIZE == (unReturnValue ^ RC_TPM_MASK) ||
+							TPM_BAD_PARAMETER == (unReturnValue ^ RC_TPM_MASK))
+					{
+						ERROR_STORE(unReturnValue, L"TSS_TPM_FieldUpgradeInfoRequest2 returned an unexpected value.");
+						unReturnValue = RC_E_UNSUPPORTED_CHIP;
+					}
+					ERROR_STORE(unReturnValue, L"TSS_TPM_FieldUpgradeInfoRequest2 returned an unexpected value.");
+					break;
+				}
+				usMaxDataSize = securityModuleLogicInfo.wMaxDataSize;
+
+				// Measure the time since the first check, fall back to the sum of the wait times if no clock is available
+				if (0 != ullStartTime)
+					unElapsedTime = (unsigned int)((Platform_GetMonotonicTimeMicroSeconds() - ullStartTime) / 1000);
+
+				// Verify that TPM switched to boot loader mode. Wait some time if it did not.
+				if (securityModuleLogicInfo.SecurityModuleStatus != SMS_BTLDR_ACTIVE)
+				{
+					unReturnValue = RC_E_TPM_NO_BOOT_LOADER_MODE;
+					if (unElapsedTime >= TPM_FU_START_TIMEOUT)
+					{
+						LOGGING_WRITE_LEVEL1_FMT(L"TPM did not switch to boot loader mode within %d ms (Count:%d)", unElapsedTime, unRetryCounter);
+						break;
+					}
+					// Do not wait past the timeout, the TPM is checked once more at the deadline
+					if (unWaitTime > TPM_FU_START_TIMEOUT - unElapsedTime)
+						unWaitTime = TPM_FU_START_TIMEOUT - unElapsedTime;
+					LOGGING_WRITE_LEVEL2_FMT(L"TPM is not in boot loader mode yet (Count:%d, waiting %d ms)", unRetryCounter, unWaitTime);
+					Platform_Sleep(unWaitTime);
+					if (0 == ullStartTime)
+						unElapsedTime += unWaitTime;
+					unWaitTime = unWaitTime * 2 > TPM_FU_START_RETRY_WAIT_TIME_MAX ? TPM_FU_START_RETRY_WAIT_TIME_MAX : unWaitTime * 2;
+					continue;
+				}
+				else
+				{
+					LOGGING_WRITE_LEVEL1_FMT(L"TPM switched to boot loader mode after %d ms (Count:%d)", unElapsedTime, unRetryCounter);
+					unReturnValue = RC_SUCCESS;
+					break;
+				}
+			}
+
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		if (0 == usMaxDataSize || usMaxDataSize > MAX_COMMAND_SIZE - TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD)
+		{
+			unReturnValue = RC_E_FIRMWARE_UPDATE_FAILED;
+			ERROR_STORE_FMT(unReturnValue, L"The TPM reported an invalid maximum data size for a firmware block. (%d)", usMaxDataSize);
+			break;
+		}
+
+		// Prepare all TPM_FieldUpgradeUpdate requests up front, so the transfer loop only transmits them. The requests
+		// reference the firmware blocks in the image, only headers and LRCs are stored. A streamed firmware block is
+		// read and prepared block by block in the transfer loop instead.
+		unBlockCount = (PunFirmwareBlockSize + usMaxDataSize - 1) / usMaxDataSize;
+		PpsTimings->unBlockCount = unBlockCount;
+		PpsTimings->unBlockSize = usMaxDataSize;
+		if (unBlockCount > 0)
+		{
+			rgsRequests = (TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*)Platform_MemoryAllocateZero((NULL != PfnReadFirmware ? 1 : unBlockCount) * sizeof(TSS_TPM_FIELDUPGRADEUPDATE_REQUEST));
+			if (NULL != PfnReadFirmware)
+				rgbStreamBlock = (BYTE*)Platform_MemoryAllocateZero(usMaxDataSize);
+			if (NULL == rgsRequests || (NULL != PfnReadFirmware && NULL == rgbStreamBlock))
+			{
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Memory allocation for the firmware update requests failed.");
+				break;
+			}
+		}
+		if (NULL != PfnReadFirmware)
+		{
+			unReturnValue = Crypt_SHA256_Start(&pvStreamDigestContext);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Crypt_SHA256_Start returned an unexpected value.");
+				break;
+			}
+		}
 
-		// Check parameters
-		if (NULL == PrgbFirmwareBlock)
+		// The requests of a frame file only reference the frames, if it was built for the maximum data size of the TPM
+		fFrames = NULL != PrgbFrames && PusFramesMaxDataSize == usMaxDataSize;
+		if (NULL != PrgbFrames && !fFrames)
 		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter not initialized correctly (PrgbFirmwareBlock is NULL)");
-			break;
+			LOGGING_WRITE_LEVEL1_FMT(L"The frame file was built for a maximum data size of %d bytes, but the TPM reports %d bytes. The requests are prepared from the firmware image.", PusFramesMaxDataSize, usMaxDataSize);
 		}
+		for (unBlockNumber = 0; fFrames && unBlockNumber < unBlockCount; unBlockNumber++)
+		{
+			UINT16 usBlockSize = unRemainingBytes < usMaxDataSize ? (UINT16)unRemainingBytes : usMaxDataSize;
+			TSS_TPM_FIELDUPGRADEUPDATE_REQUEST* psRequest = &rgsRequests[unBlockNumber];
 
-		rgbFirmwareBlock = PrgbFirmwareBlock;
-		unRemainingBytes = PunFirmwareBlockSize;
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(psRequest->rgbHeader, sizeof(psRequest->rgbHeader), pbFrame, TPM_FIELDUPGRADEUPDATE_HEADER_SIZE));
+			psRequest->pbBlock = pbFrame + TPM_FIELDUPGRADEUPDATE_HEADER_SIZE;
+			psRequest->usBlockSize = usBlockSize;
+			psRequest->bLRC = psRequest->pbBlock[usBlockSize];
+			pbFrame += TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD + usBlockSize;
+			unRemainingBytes -= usBlockSize;
+		}
+		for (unBlockNumber = 0; NULL == PfnReadFirmware && !fFrames && unBlockNumber < unBlockCount; unBlockNumber++)
+		{
+			UINT16 usBlockSize = unRemainingBytes < usMaxDataSize ? (UINT16)unRemainingBytes : usMaxDataSize;
+
+			unReturnValue = TSS_TPM_FieldUpgradeUpdate_PrepareRequest(rgbFirmwareBlock, usBlockSize, &rgsRequests[unBlockNumber]);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(unReturnValue, L"TSS_TPM_FieldUpgradeUpdate_PrepareRequest returned an unexpected value while preparing block %d.", unBlockNumber + 1);
+				break;
+			}
+			rgbFirmwareBlock += usBlockSize;
+			unRemainingBytes -= usBlockSize;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
 
+		// Optionally protect the transfer against latency spikes caused by other workloads: pin and prioritize the
+		// thread and keep the image and the transfer buffers resident. Every setting is best effort.
+		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_REALTIME_UPDATE, &fRealtime) && TRUE == fRealtime)
+		{
+			unsigned int unCpu = 0;
+			unsigned int unApplied = 0;
+			BOOL fLocked = TRUE;
+
+			if (RC_SUCCESS != Platform_RealtimeBegin(PropertyStorage_GetUIntegerValueByKey(PROPERTY_REALTIME_UPDATE_CPU, &unCpu) ? (int)unCpu : -1, &pvRealtimeState, &unApplied))
+				LOGGING_WRITE_LEVEL1(L"The scheduling settings of the firmware transfer could not be read.");
+			fLocked &= RC_SUCCESS == Platform_MemoryLock(PrgbFirmwareBlock, PunFirmwareBlockSize);
+			if (fFrames)
+				fLocked &= RC_SUCCESS == Platform_MemoryLock(PrgbFrames, PunFirmwareBlockSize + unBlockCount * TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD);
+			fLocked &= RC_SUCCESS == Platform_MemoryLock(rgsRequests, (NULL != PfnReadFirmware ? 1 : unBlockCount) * sizeof(TSS_TPM_FIELDUPGRADEUPDATE_REQUEST));
+			if (NULL != PfnReadFirmware)
+				fLocked &= RC_SUCCESS == Platform_MemoryLock(rgbStreamBlock, usMaxDataSize);
+			LOGGING_WRITE_LEVEL2_FMT(L"Real-time transfer: CPU pinned: %ls, SCHED_FIFO: %ls, nice: %ls, memory locked: %ls",
+				0 != (unApplied & PLATFORM_REALTIME_AFFINITY) ? L"yes" : L"no",
+				0 != (unApplied & PLATFORM_REALTIME_FIFO) ? L"yes" : L"no",
+				0 != (unApplied & PLATFORM_REALTIME_NICE_VALUE) ? L"yes" : L"no",
+				fLocked ? L"yes" : L"no");
+		}
+
+		// Send the firmware image to the TPM block-by-block. Progress output and request logging of the transfer
+		// overlap the execution of the next block in the TPM.
+		s_fnPendingProgressCallback = PfnProgress;
+		s_fnPendingProgressDetailsCallback = PfnProgressDetails;
+		s_unPendingProgress = 0;
+		s_fPendingProgressDetails = FALSE;
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sPendingProgressDetails, 0, sizeof(s_sPendingProgressDetails)));
+		s_sPendingProgressDetails.unBytesTotal = PunFirmwareBlockSize;
+		s_sPendingProgressDetails.unBlocksTotal = unBlockCount;
+		ullTransferStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		ullLastBlockTime = ullTransferStartTime;
+		DeviceManagement_SetCommandPendingCallback(&FirmwareUpdate_ReportPendingProgress);
+		unRemainingBytes = PunFirmwareBlockSize;
+		fBatch = NULL == PfnReadFirmware;
+		if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOGGING_BLOCK_SAMPLE, &unBlockSample) || 0 == unBlockSample)
+			unBlockSample = 1;
+		for (unBlockNumber = 1; unBlockNumber <= unBlockCount; unBlockNumber++)
 		{
-			unsigned int unRetryCounter = 0;
+			UINT16 usBlockSize = unRemainingBytes < usMaxDataSize ? (UINT16)unRemainingBytes : usMaxDataSize;
+			TSS_TPM_FIELDUPGRADEUPDATE_REQUEST* psRequest = &rgsRequests[unBlockNumber - 1];
+
+			PROBE3(update__block__start, unBlockNumber, unBlockCount, usBlockSize);
+
+			// Log the first, the last and every Nth block in full, the other blocks up to logging level 2
+			if (1 != unBlockNumber && unBlockCount != unBlockNumber && 0 != unBlockNumber % unBlockSample)
+				pSession->unLoggingLevelLimit = LOGGING_LEVEL_2;
+			else
+				pSession->unLoggingLevelLimit = LOGGING_DISABLED;
 
-			for (unRetryCounter = 0; unRetryCounter < TPM_FU_START_MAX_RETRIES; unRetryCounter++)
+			// Read and prepare a streamed data block
+			if (NULL != PfnReadFirmware)
 			{
-				// Get the max data size for a firmware update block.
-				sSecurityModuleLogicInfo_d securityModuleLogicInfo = {0};
-				unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
-				if (TPM_RESOURCES == (unReturnValue ^ RC_TPM_MASK))
+				psRequest = &rgsRequests[0];
+				unReturnValue = PfnReadFirmware(PpvReadFirmwareContext, PunFirmwareBlockSize - unRemainingBytes, rgbStreamBlock, usBlockSize);
+				if (RC_SUCCESS != unReturnValue)
 				{
-					// Retry once on TPM_RESOURCES
-					unReturnValue = TSS_TPM_FieldUpgradeInfoRequest2(&securityModuleLogicInfo);
+					ERROR_STORE_FMT(RC_E_FIRMWARE_UPDATE_FAILED, L"Reading firmware block %d from the firmware image failed. (0x%.8x)", unBlockNumber, unReturnValue);
+					unReturnValue = RC_E_FIRMWARE_UPDATE_FAILED;
+					break;
 				}
+				unReturnValue = Crypt_SHA256_Update(pvStreamDigestContext, rgbStreamBlock, usBlockSize);
 				if (RC_SUCCESS != unReturnValue)
 				{
-					if (TPM_BAD_PARAM_SIZE == (unReturnValue ^ RC_TPM_MASK) ||
-							TPM_BAD_PARAMETER == (unReturnValue ^ RC_TPM_MASK))
-					{
-						ERROR_STORE(unReturnValue, L"TSS_TPM_FieldUpgradeInfoRequest2 returned an unexpected value.");
-						unReturnValue = RC_E_UNSUPPORTED_CHIP;
-					}
-					ERROR_STORE(unReturnValue, L"TSS_TPM_FieldUpgradeInfoRequest2 returned an unexpected value.");
+					ERROR_STORE(unReturnValue, L"Crypt_SHA256_Update returned an unexpected value.");
 					break;
 				}
-				usMaxDataSize = securityModuleLogicInfo.wMaxDataSize;
+				unReturnValue = TSS_TPM_FieldUpgradeUpdate_PrepareRequest(rgbStreamBlock, usBlockSize, psRequest);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE_FMT(unReturnValue, L"TSS_TPM_FieldUpgradeUpdate_PrepareRequest returned an unexpected value while preparing block %d.", unBlockNumber);
+					break;
+				}
+			}
 
-				// Verify that TPM switched to boot loader mode. Wait some time if it did not.
-				if (securityModuleLogicInfo.SecurityModuleStatus != SMS_BTLDR_ACTIVE)
+			// Transmit a window of prepared data blocks in one round trip if the transport supports it (remote agent).
+			// A window which failed before it was handed over is resent block by block below.
+			if (fBatch && unBlockNumber > unBatchAcked)
+			{
+				unsigned int unWindow = unBlockCount - unBlockNumber + 1 < TPM_FU_UPDATE_BATCH_WINDOW ? unBlockCount - unBlockNumber + 1 : TPM_FU_UPDATE_BATCH_WINDOW;
+				unsigned int unCompleted = 0;
+
+				s_fBlockHandedOver = FALSE;
+				unReturnValue = TSS_TPM_FieldUpgradeUpdate_TransmitRequests(psRequest, unWindow, &unCompleted);
+				if (RC_E_NOT_SUPPORTED_FEATURE == unReturnValue)
 				{
-					unReturnValue = RC_E_TPM_NO_BOOT_LOADER_MODE;
-					LOGGING_WRITE_LEVEL1_FMT(L"TPM is not in boot loader mode as expected (Count:%d)", unRetryCounter);
-					Platform_Sleep(TPM_FU_START_RETRY_WAIT_TIME);
-					continue;
+					LOGGING_WRITE_LEVEL2(L"The transport does not support batched requests, sending one block at a time.");
+					fBatch = FALSE;
 				}
 				else
 				{
+					unBatchAcked = unBlockNumber - 1 + unCompleted;
+					if (RC_SUCCESS != unReturnValue && !FirmwareUpdate_IsTransientTransportError(unReturnValue))
+					{
+						ERROR_STORE_FMT(RC_E_FIRMWARE_UPDATE_FAILED, L"TSS_TPM_FieldUpgradeUpdate returned an unexpected value while processing block %d. (0x%.8x)", unBatchAcked + 1, unReturnValue);
+						unReturnValue = RC_E_FIRMWARE_UPDATE_FAILED;
+						break;
+					}
 					unReturnValue = RC_SUCCESS;
-					break;
 				}
 			}
 
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
+			// Transmit data block, the same block is resent if it failed before it was handed over to the TPM. The TIS
+			// interface aborts a failed command and waits for the ready state before the next one, so the retry starts on a
+			// synchronized interface.
+			if (unBlockNumber > unBatchAcked)
+			{
+				unsigned int unRetryCounter = 0;
+				unsigned int unWaitTime = TPM_FU_UPDATE_RETRY_WAIT_TIME_MIN;
 
-		// Send the firmware image to the TPM block-by-block.
-		for (unBlockNumber = 1; unRemainingBytes > 0; unBlockNumber++)
-		{
-			UINT16 usBlockSize = unRemainingBytes < usMaxDataSize ? (UINT16)unRemainingBytes : usMaxDataSize;
+				for (unRetryCounter = 0; ; unRetryCounter++)
+				{
+					s_fBlockHandedOver = FALSE;
+					unReturnValue = TSS_TPM_FieldUpgradeUpdate_TransmitRequest(psRequest);
+					if (RC_SUCCESS == unReturnValue || unRetryCounter >= TPM_FU_UPDATE_RETRY_COUNT || !FirmwareUpdate_IsTransientTransportError(unReturnValue))
+						break;
 
-			// Transmit data block
-			unReturnValue = TSS_TPM_FieldUpgradeUpdate(rgbFirmwareBlock, usBlockSize);
+					LOGGING_WRITE_LEVEL1_FMT(L"Transport error while processing block %d, resending it in %d ms (0x%.8x, Count:%d)", unBlockNumber, unWaitTime, unReturnValue, unRetryCounter + 1);
+					// Log a resent block in full
+					pSession->unLoggingLevelLimit = LOGGING_DISABLED;
+					Platform_Sleep(unWaitTime);
+					unWaitTime = unWaitTime * 2 > TPM_FU_UPDATE_RETRY_WAIT_TIME_MAX ? TPM_FU_UPDATE_RETRY_WAIT_TIME_MAX : unWaitTime * 2;
+					unResentBlocks++;
+				}
+			}
+			PROBE2(update__block__done, unBlockNumber, unReturnValue);
 			if (RC_SUCCESS != unReturnValue)
 			{
 				ERROR_STORE_FMT(RC_E_FIRMWARE_UPDATE_FAILED, L"TSS_TPM_FieldUpgradeUpdate returned an unexpected value while processing block %d. (0x%.8x)", unBlockNumber, unReturnValue);
@@ -1423,11 +2780,10 @@ _Check_return_ unsigned int FirmwareUpdate_Update(
 				break;
 			}
 
-			// Increase data pointer by block size
-			rgbFirmwareBlock += usBlockSize;
-
 			// Decrease size of remaining data by block size
 			unRemainingBytes -= usBlockSize;
+			if (NULL != PfnProgressDetails)
+				FirmwareUpdate_UpdateProgressDetails(usBlockSize, ullTransferStartTime, &ullLastBlockTime);
 
 			// Set Progress (1 and 100% are set for _Start and _Complete so 98 steps are left)
 			{
@@ -1435,13 +2791,57 @@ _Check_return_ unsigned int FirmwareUpdate_Update(
 				if (unCurrentProgress != unProgress)
 				{
 					unCurrentProgress = unProgress;
-					PfnProgress(unCurrentProgress);
+					s_unPendingProgress = unCurrentProgress;
 				}
 			}
 		}
+
+		// Return to serial mode and report the progress of the last block
+		DeviceManagement_SetCommandPendingCallback(NULL);
+		pSession->unLoggingLevelLimit = LOGGING_DISABLED;
+		PpsTimings->unResentBlockCount = unResentBlocks;
+		if (0 != unResentBlocks)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"%d firmware blocks were resent after transient transport errors.", unResentBlocks);
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		FirmwareUpdate_ReportPendingProgress();
+
+		// The streamed firmware must be the verified one, otherwise the image changed after the checks
+		if (NULL != PfnReadFirmware)
+		{
+			BYTE rgbStreamDigest[SHA256_DIGEST_SIZE] = {0};
+			unReturnValue = Crypt_SHA256_Finish(&pvStreamDigestContext, rgbStreamDigest);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Crypt_SHA256_Finish returned an unexpected value.");
+				break;
+			}
+			if (0 != Platform_MemoryCompare(rgbStreamDigest, PrgbFirmwareDigest, SHA256_DIGEST_SIZE))
+			{
+				unReturnValue = RC_E_FIRMWARE_UPDATE_FAILED;
+				ERROR_STORE(unReturnValue, L"The firmware streamed from the firmware image does not match the verified firmware digest.");
+				break;
+			}
+		}
 	}
 	WHILE_FALSE_END;
 
+	if (NULL != pvStreamDigestContext)
+		IGNORE_RETURN_VALUE(Crypt_SHA256_Finish(&pvStreamDigestContext, NULL));
+	if (TRUE == fRealtime)
+	{
+		Platform_MemoryUnlock(PrgbFirmwareBlock, PunFirmwareBlockSize);
+		if (fFrames)
+			Platform_MemoryUnlock(PrgbFrames, PunFirmwareBlockSize + unBlockCount * TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD);
+		Platform_MemoryUnlock(rgsRequests, (NULL != PfnReadFirmware ? 1 : unBlockCount) * sizeof(TSS_TPM_FIELDUPGRADEUPDATE_REQUEST));
+		Platform_MemoryUnlock(rgbStreamBlock, usMaxDataSize);
+		Platform_RealtimeEnd(&pvRealtimeState);
+	}
+	Platform_MemoryFree((void**)&rgbStreamBlock);
+	Platform_MemoryFree((void**)&rgsRequests);
+
 	return unReturnValue;
 }
 
@@ -1492,8 +2892,13 @@ _Check_return_ unsigned int FirmwareUpdate_Complete(
 			break;
 		}
 
-		// Wait for TPM to complete update sequence
-		Platform_Sleep(TPM_FU_COMPLETE_WAIT_TIME);
+		// Wait for TPM to complete update sequence (a simulated TPM has completed it with the response)
+		{
+			unsigned int unTpmDeviceAccessMode = 0;
+			if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessMode) ||
+					TPM_DEVICE_ACCESS_SIMULATED != unTpmDeviceAccessMode)
+				Platform_Sleep(TPM_FU_COMPLETE_WAIT_TIME);
+		}
 
 		// Set Progress to 100%
 		PfnProgress(100);
@@ -1507,13 +2912,16 @@ _Check_return_ unsigned int FirmwareUpdate_Complete(
 
 /**
  *	@brief		Returns information about the current state of TPM
- *	@details
+ *	@details	Only the TPM commands needed for the requested fields are sent. The TPM family and the failure states are
+ *				always detected. Without TPM_INFO_FIELD_STATE the TPM1.2 owner, enabled, activated and physical presence
+ *				flags and the TPM2.0 platform hierarchy state are left zero.
  *
  *	@param		PwszVersionName				A pointer to a null-terminated string representing the firmware image version name.
  *	@param		PpunVersionNameSize			IN: Capacity of the PwszVersionName parameter in wide characters including zero termination
  *											OUT: Length of written wide character string (excluding zero termination)
  *	@param		PpsTpmState					Receives TPM state.
  *	@param		PpunRemainingUpdates		Receives the number of remaining updates or -1 in case the value could not be detected.
+ *	@param		PunFields					Fields to query, a combination of TPM_INFO_FIELD_* values.
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
  *	@retval		RC_E_FAIL					An unexpected error occurred.
@@ -1527,7 +2935,8 @@ FirmwareUpdate_GetImageInfo(
 	_Inout_bytecap_(*PpunVersionNameSize)	wchar_t*					PwszVersionName,
 	_Inout_									unsigned int*				PpunVersionNameSize,
 	_Inout_									TPM_STATE*					PpsTpmState,
-	_Inout_									unsigned int*				PpunRemainingUpdates)
+	_Inout_									unsigned int*				PpunRemainingUpdates,
+	_In_									unsigned int				PunFields)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
@@ -1547,8 +2956,11 @@ FirmwareUpdate_GetImageInfo(
 			break;
 		}
 
-		// Get TPM operation mode
-		unReturnValue = FirmwareUpdate_CalculateState(PpsTpmState);
+		// Get TPM operation mode, the detailed state is probed only if requested or already known
+		if (0 != (PunFields & TPM_INFO_FIELD_STATE) || TRUE == s_fTpmStateSnapshotValid)
+			unReturnValue = FirmwareUpdate_CalculateState(PpsTpmState);
+		else
+			unReturnValue = FirmwareUpdate_ProbeState(PpsTpmState, FALSE);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -1561,6 +2973,7 @@ FirmwareUpdate_GetImageInfo(
 		}
 
 		// Get firmware version string
+		if (0 != (PunFields & TPM_INFO_FIELD_VERSION))
 		{
 			wchar_t wszDummy[MAX_NAME] = {0};
 			unsigned int unDummySize = RG_LEN(wszDummy);
@@ -1570,7 +2983,8 @@ FirmwareUpdate_GetImageInfo(
 		}
 
 		// Read update counter from TPM (cannot be done after firmware update to TPM 2.0 when reboot is required)
-		if (!(PpsTpmState->attribs.tpm20 && PpsTpmState->attribs.tpm20restartRequired) &&
+		if (0 != (PunFields & TPM_INFO_FIELD_COUNTER) &&
+			!(PpsTpmState->attribs.tpm20 && PpsTpmState->attribs.tpm20restartRequired) &&
 			!PpsTpmState->attribs.tpm20InFailureMode &&
 			!(PpsTpmState->attribs.tpm12 && PpsTpmState->attribs.tpm12FieldUpgradeInfo2Failed))
 		{
@@ -1595,6 +3009,7 @@ FirmwareUpdate_GetImageInfo(
  *
  *	@param		PrgbImage					Firmware image byte stream
  *	@param		PullImageSize				Size of firmware image byte stream
+ *	@param		PpsFirmwareImage			Firmware image already unmarshalled from PrgbImage by the caller or NULL to unmarshal it here
  *	@param		PpfValid					TRUE in case the image is valid, FALSE otherwise.
  *	@param		PpbfNewTpmFirmwareInfo		Pointer to a bit field to return info data for the new firmware image.
  *	@param		PpunErrorDetails			Pointer to an unsigned int to return error details. Possible values are:\n
@@ -1617,18 +3032,20 @@ unsigned int
 FirmwareUpdate_CheckImage(
 	_In_bytecount_(PullImageSize)	BYTE*							PrgbImage,
 	_In_							UINT64							PullImageSize,
+	_In_opt_						const IfxFirmwareImage*			PpsFirmwareImage,
 	_Out_							BOOL*							PpfValid,
 	_Out_							BITFIELD_NEW_TPM_FIRMWARE_INFO*	PpbfNewTpmFirmwareInfo,
 	_Out_							UINT32*							PpunErrorDetails)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	IfxFirmwareImage sIfxFirmwareImage = {{0}};
 
 	do
 	{
 		TPM_STATE sTpmState = {{0}};
-		IfxFirmwareImage sIfxFirmwareImage = {{0}};
 		INT32 nBufferSize = (INT32)PullImageSize;
 		BYTE* pbBuffer = PrgbImage;
+		BOOL fImageParsable = TRUE;
 
 		// Check parameters
 		if (NULL == PrgbImage ||
@@ -1650,6 +3067,20 @@ FirmwareUpdate_CheckImage(
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
+		// Unmarshal the firmware image structure unless the caller already did
+		if (NULL == PpsFirmwareImage)
+		{
+			fImageParsable = (RC_SUCCESS == FirmwareImage_Unmarshal(&sIfxFirmwareImage, &pbBuffer, &nBufferSize));
+			PpsFirmwareImage = &sIfxFirmwareImage;
+		}
+
+		// Verify the integrity of the image while the TPM is queried. Only images which pass the header checks in
+		// FirmwareUpdate_IsFirmwareUpdatable are worth the calculation, all others are rejected without it.
+		if (fImageParsable && PullImageSize <= 0x7FFFFFFF && !FirmwareUpdate_IsImageIntegrityVerified(PrgbImage, (UINT32)PullImageSize) &&
+				0 == Platform_MemoryCompare(&PpsFirmwareImage->unique, &EFI_IFXTPM_FIRMWARE_IMAGE_GUID, sizeof(EFI_IFXTPM_FIRMWARE_IMAGE_GUID)) &&
+				2 <= PpsFirmwareImage->usImageStructureVersion && SIG_KEY_ID_1 == PpsFirmwareImage->usSignatureKeyId)
+			FirmwareUpdate_StartImageVerification(PrgbImage, (UINT32)PullImageSize, PpsFirmwareImage);
+
 		// Get TPM operation mode
 		unReturnValue = FirmwareUpdate_CalculateState(&sTpmState);
 		if (RC_SUCCESS != unReturnValue)
@@ -1680,9 +3111,7 @@ FirmwareUpdate_CheckImage(
 			break;
 		}
 
-		// Unmarshal the firmware image structure
-		unReturnValue = FirmwareImage_Unmarshal(&sIfxFirmwareImage, &pbBuffer, &nBufferSize);
-		if (RC_SUCCESS != unReturnValue)
+		if (!fImageParsable)
 		{
 			unReturnValue = RC_SUCCESS;
 			*PpunErrorDetails = RC_E_CORRUPT_FW_IMAGE;
@@ -1691,7 +3120,7 @@ FirmwareUpdate_CheckImage(
 
 		// Check if update is possible
 		nBufferSize = (INT32)PullImageSize;
-		unReturnValue = FirmwareUpdate_IsFirmwareUpdatable(sTpmState.attribs, PrgbImage, nBufferSize, &sIfxFirmwareImage, PpfValid, PpbfNewTpmFirmwareInfo, PpunErrorDetails);
+		unReturnValue = FirmwareUpdate_IsFirmwareUpdatable(sTpmState.attribs, PrgbImage, nBufferSize, PpsFirmwareImage, PpfValid, PpbfNewTpmFirmwareInfo, PpunErrorDetails);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -1699,9 +3128,27 @@ FirmwareUpdate_CheckImage(
 	}
 	WHILE_FALSE_END;
 
+	// Discard a verification which has not been collected because an earlier check failed
+	IGNORE_RETURN_VALUE(FirmwareUpdate_FinishImageVerification(NULL, 0, NULL));
+
 	return unReturnValue;
 }
 
+#if IFX_ENABLE_TPM20
+/**
+ *	@brief		Policy digest for TPM2.0 firmware update.
+ *	@details	SHA-256 policy for TPM2_PolicySecret(authObject = TPM_RH_PLATFORM, policyRef = TPM_RH_PLATFORM) followed by
+ *				TPM2_PolicyCommandCode(TPM2_CC_FieldUpgradeStartVendor), starting from a zero digest. All values are big-endian
+ *				UINT32, the Name of a permanent handle is the handle itself:
+ *				d1 = SHA256(0x00 * 32 || TPM_CC_PolicySecret (0x00000151) || TPM_RH_PLATFORM (0x4000000C))
+ *				d2 = SHA256(d1 || TPM_RH_PLATFORM (0x4000000C))
+ *				d3 = SHA256(d2 || TPM_CC_PolicyCommandCode (0x0000016C) || TPM2_CC_FieldUpgradeStartVendor (0x2000012F))
+ */
+static const BYTE rgbTpm20FirmwareUpdatePolicyDigest[] = {0x6D, 0x9B, 0x4B, 0x75, 0x61, 0xCA, 0xC7, 0x7B,
+															0x26, 0x1B, 0x31, 0xE2, 0x42, 0x31, 0xBD, 0x87,
+															0x09, 0x7B, 0x47, 0x2E, 0x45, 0xF0, 0x7D, 0x4D,
+															0x8F, 0xED, 0xDD, 0xB0, 0x4B, 0x91, 0x89, 0xF4};
+
 /**
  *	@brief		Prepares a policy session for TPM firmware.
  *	@details	The function prepares a policy session for TPM Firmware Update.
@@ -1837,6 +3284,7 @@ FirmwareUpdate_PrepareTPM20Policy(
 
 	return unReturnValue;
 }
+#endif // IFX_ENABLE_TPM20
 
 /**
  *	@brief		Function to issue TPM_FieldUpgrade_Start
@@ -1860,9 +3308,9 @@ FirmwareUpdate_Start(
 	_In_	const IfxFirmwareUpdateData* const	PpsFirmwareUpdateData)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	BYTE rgbEmptySha1[SHA1_DIGEST_SIZE] = {0};
 	BOOL fUpdateStarted = FALSE;
 
+#if IFX_ENABLE_TPM20
 	if (PbfTpmAttributes.tpm20 && PbfTpmAttributes.infineon && !PbfTpmAttributes.tpm20restartRequired)
 	{
 		unReturnValue = FirmwareUpdate_Start_Tpm20(
@@ -1872,8 +3320,12 @@ FirmwareUpdate_Start(
 							PpsFirmwareUpdateData->fnProgressCallback);
 		fUpdateStarted = RC_SUCCESS == unReturnValue ? TRUE : FALSE;
 	}
-	else if (PbfTpmAttributes.tpm12 && PbfTpmAttributes.infineon && !PbfTpmAttributes.unsupportedChip)
+	else
+#endif
+#if IFX_ENABLE_TPM12
+	if (PbfTpmAttributes.tpm12 && PbfTpmAttributes.infineon && !PbfTpmAttributes.unsupportedChip)
 	{
+		BYTE rgbEmptySha1[SHA1_DIGEST_SIZE] = {0};
 		if (PbfTpmAttributes.tpm12owner)
 		{
 			if (0 == Platform_MemoryCompare(rgbEmptySha1, PpsFirmwareUpdateData->rgbOwnerAuthHash, SHA1_DIGEST_SIZE))
@@ -1911,7 +3363,9 @@ FirmwareUpdate_Start(
 			}
 		}
 	}
-	else if (PbfTpmAttributes.bootLoader)
+	else
+#endif
+	if (PbfTpmAttributes.bootLoader)
 	{
 		unReturnValue = RC_SUCCESS; // Continue interrupted firmware update
 		PpsFirmwareUpdateData->fnProgressCallback(1);
@@ -1957,11 +3411,25 @@ FirmwareUpdate_UpdateImage(
 	{
 		TPM_STATE sTpmState = {{0}};
 		IfxFirmwareImage sIfxFirmwareImage = {{0}};
+		const IfxFirmwareImage* psFirmwareImage = PpsFirmwareUpdateData->psFirmwareImage;
 		INT32 nBufferSize = (INT32)PpsFirmwareUpdateData->unFirmwareImageSize;
 		BYTE* pbBuffer = PpsFirmwareUpdateData->rgbFirmwareImage;
+		IfxFirmwareUpdateTimings sTimings = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+		IfxFirmwareUpdateTimings* psTimings = NULL != PpsFirmwareUpdateData->psTimings ? PpsFirmwareUpdateData->psTimings : &sTimings;
+		unsigned long long ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		sSignedDataView_d sSignedData = {0};
+		IfxPhaseLoad sLoad;
+		const BYTE* pbFrames = NULL;
+		UINT16 usFramesMaxDataSize = 0;
 
 		// Get TPM operation mode
+		DeviceManagement_StartPhaseLoad(&sLoad);
 		unReturnValue = FirmwareUpdate_CalculateState(&sTpmState);
+		psTimings->ullStateTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		psTimings->ullStateCpuTime = sLoad.ullCpuTime;
+		psTimings->ullStateWaitTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"update state", ullTime, psTimings->ullStateTime, NULL);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -1973,28 +3441,96 @@ FirmwareUpdate_UpdateImage(
 			break;
 		}
 
-		// Unmarshal the firmware image structure
-		unReturnValue = FirmwareImage_Unmarshal(&sIfxFirmwareImage, &pbBuffer, &nBufferSize);
-		if (RC_SUCCESS != unReturnValue)
+		// Unmarshal the firmware image structure unless the caller already did
+		if (NULL == psFirmwareImage)
 		{
-			ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"Firmware image cannot be parsed. (0x%.8x)");
-			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
-			break;
+			unReturnValue = FirmwareImage_Unmarshal(&sIfxFirmwareImage, &pbBuffer, &nBufferSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(RC_E_CORRUPT_FW_IMAGE, L"Firmware image cannot be parsed. (0x%.8x)");
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+			psFirmwareImage = &sIfxFirmwareImage;
+		}
+
+		// A streamed firmware block and the frames of a frame file are checked against the verified messageDigest of the
+		// policy parameter block
+		if (NULL != PpsFirmwareUpdateData->fnReadFirmwareCallback || NULL != PpsFirmwareUpdateData->rgbFrameFile)
+		{
+			BYTE* rgbPolicyParameterBlock = psFirmwareImage->rgbPolicyParameterBlock;
+			INT32 nPolicyParameterBlockSize = psFirmwareImage->usPolicyParameterBlockSize;
+			unReturnValue = TSS_sSignedData_d_UnmarshalView(&sSignedData, &rgbPolicyParameterBlock, &nPolicyParameterBlockSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"TSS_sSignedData_d_UnmarshalView returned an unexpected value. (0x%.8x)", unReturnValue);
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+		}
+
+		// Check the frame file before the TPM is switched to boot loader mode
+		if (NULL != PpsFirmwareUpdateData->rgbFrameFile)
+		{
+			unReturnValue = FirmwareUpdate_CheckFrameFile(
+								PpsFirmwareUpdateData->rgbFrameFile,
+								PpsFirmwareUpdateData->unFrameFileSize,
+								PpsFirmwareUpdateData->rgbFirmwareImage,
+								PpsFirmwareUpdateData->unFirmwareImageSize,
+								psFirmwareImage,
+								sSignedData.sSignedAttributes.sMessageDigest.rgbMessageDigest,
+								&usFramesMaxDataSize,
+								&pbFrames);
+			if (RC_SUCCESS != unReturnValue)
+				break;
 		}
 
 		// Perform the firmware update
 		// Start the firmware update in order to get TPM in Boot Loader Mode
-		unReturnValue = FirmwareUpdate_Start(sTpmState.attribs, &sIfxFirmwareImage, PpsFirmwareUpdateData);
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
+		unReturnValue = FirmwareUpdate_Start(sTpmState.attribs, psFirmwareImage, PpsFirmwareUpdateData);
+		FirmwareUpdate_InvalidateState();
+		psTimings->ullStartTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		psTimings->ullStartCpuTime = sLoad.ullCpuTime;
+		psTimings->ullStartWaitTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"update start", ullTime, psTimings->ullStartTime, NULL);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
 		// Transfer new firmware data to TPM
-		unReturnValue = FirmwareUpdate_Update(sIfxFirmwareImage.unFirmwareSize, sIfxFirmwareImage.rgbFirmware, PpsFirmwareUpdateData->fnProgressCallback);
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
+		unReturnValue = FirmwareUpdate_Update(
+							psFirmwareImage->unFirmwareSize,
+							psFirmwareImage->rgbFirmware,
+							NULL == pbFrames ? PpsFirmwareUpdateData->fnReadFirmwareCallback : NULL,
+							PpsFirmwareUpdateData->pvReadFirmwareContext,
+							sSignedData.sSignedAttributes.sMessageDigest.rgbMessageDigest,
+							pbFrames,
+							usFramesMaxDataSize,
+							PpsFirmwareUpdateData->fnProgressCallback,
+							PpsFirmwareUpdateData->fnProgressDetailsCallback,
+							psTimings);
+		psTimings->ullTransferTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		psTimings->ullTransferCpuTime = sLoad.ullCpuTime;
+		psTimings->ullTransferWaitTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"update transfer", ullTime, psTimings->ullTransferTime, NULL);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
 		// Finalize the firmware update
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
 		unReturnValue = FirmwareUpdate_Complete(PpsFirmwareUpdateData->fnProgressCallback);
+		FirmwareUpdate_InvalidateState();
+		psTimings->ullCompleteTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		psTimings->ullCompleteCpuTime = sLoad.ullCpuTime;
+		psTimings->ullCompleteWaitTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"update complete", ullTime, psTimings->ullCompleteTime, NULL);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -2005,9 +3541,219 @@ FirmwareUpdate_UpdateImage(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Builds a frame file for a firmware image
+ *	@details	A frame file holds the complete TPM_FieldUpgradeUpdate command frames (header, sub command, data size,
+ *				firmware block and LRC) for one maximum data size, preceded by the policy parameter block needed by the
+ *				start of the update. It is bound to the firmware image by the SHA-256 digest of the image, and the firmware
+ *				blocks are checked against the signed firmware digest when the frame file is used. All values are stored
+ *				in big-endian format. The image must have been verified by the caller.
+ *
+ *	@param		PrgbImage					Firmware image byte stream
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage			Unmarshalled PrgbImage
+ *	@param		PusMaxDataSize				Maximum data size of a firmware block (wMaxDataSize of the TPM in boot loader mode)
+ *	@param		PprgbFrameFile				Receives the frame file, must be freed with Platform_MemoryFree
+ *	@param		PpunFrameFileSize			Receives the size of the frame file
+ *	@param		PpunFrameCount				Receives the number of frames
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function or the maximum data size is invalid.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_BuildFrameFile(
+	_In_bytecount_(PunImageSize)	const BYTE*				PrgbImage,
+	_In_							UINT32					PunImageSize,
+	_In_							const IfxFirmwareImage*	PpsFirmwareImage,
+	_In_							UINT16					PusMaxDataSize,
+	_Outptr_result_maybenull_		BYTE**					PprgbFrameFile,
+	_Out_							UINT32*					PpunFrameFileSize,
+	_Out_							UINT32*					PpunFrameCount)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* rgbFrameFile = NULL;
+
+	do
+	{
+		unsigned long long ullFrameFileSize = 0;
+		UINT32 unFrameCount = 0;
+		UINT32 unFrame = 0;
+		UINT32 unRemainingBytes = 0;
+		const BYTE* pbFirmware = NULL;
+		BYTE* pbBuffer = NULL;
+
+		// Check parameters
+		if (NULL == PrgbImage || 0 == PunImageSize || NULL == PpsFirmwareImage || NULL == PpsFirmwareImage->rgbFirmware ||
+				0 == PpsFirmwareImage->unFirmwareSize || NULL == PprgbFrameFile || NULL == PpunFrameFileSize || NULL == PpunFrameCount)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected.");
+			break;
+		}
+		if (0 == PusMaxDataSize || PusMaxDataSize > MAX_COMMAND_SIZE - TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE_FMT(unReturnValue, L"Invalid maximum data size for a firmware block. (%d, maximum %d)", PusMaxDataSize, MAX_COMMAND_SIZE - TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD);
+			break;
+		}
+
+		unFrameCount = (PpsFirmwareImage->unFirmwareSize + PusMaxDataSize - 1) / PusMaxDataSize;
+		ullFrameFileSize = (unsigned long long)FIRMWARE_FRAME_FILE_HEADER_SIZE + PpsFirmwareImage->usPolicyParameterBlockSize +
+			PpsFirmwareImage->unFirmwareSize + (unsigned long long)unFrameCount * TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD;
+		if (ullFrameFileSize > 0x7FFFFFFF)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"The firmware image is too large for a frame file.");
+			break;
+		}
+		rgbFrameFile = (BYTE*)Platform_MemoryAllocateZero((size_t)ullFrameFileSize);
+		if (NULL == rgbFrameFile)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation for the frame file failed.");
+			break;
+		}
+
+		// Header and policy parameter block
+		pbBuffer = rgbFrameFile;
+		TSS_BYTE_Array_MarshalUnchecked((const BYTE*)FIRMWARE_FRAME_FILE_MAGIC, FIRMWARE_FRAME_FILE_MAGIC_SIZE, &pbBuffer);
+		TSS_UINT8_MarshalUnchecked(PpsFirmwareImage->bSourceTpmFamily, &pbBuffer);
+		TSS_UINT16_MarshalUnchecked(PusMaxDataSize, &pbBuffer);
+		TSS_UINT16_MarshalUnchecked(PpsFirmwareImage->usPolicyParameterBlockSize, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(PpsFirmwareImage->unFirmwareSize, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(unFrameCount, &pbBuffer);
+		unReturnValue = Crypt_SHA256(PrgbImage, PunImageSize, pbBuffer);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Crypt_SHA256 returned an unexpected value.");
+			break;
+		}
+		pbBuffer += SHA256_DIGEST_SIZE;
+		TSS_BYTE_Array_MarshalUnchecked(PpsFirmwareImage->rgbPolicyParameterBlock, PpsFirmwareImage->usPolicyParameterBlockSize, &pbBuffer);
+
+		// One complete TPM_FieldUpgradeUpdate command per firmware block
+		pbFirmware = PpsFirmwareImage->rgbFirmware;
+		unRemainingBytes = PpsFirmwareImage->unFirmwareSize;
+		for (unFrame = 0; unFrame < unFrameCount; unFrame++)
+		{
+			TSS_TPM_FIELDUPGRADEUPDATE_REQUEST sRequest;
+			UINT16 usBlockSize = unRemainingBytes < PusMaxDataSize ? (UINT16)unRemainingBytes : PusMaxDataSize;
+
+			unReturnValue = TSS_TPM_FieldUpgradeUpdate_PrepareRequest(pbFirmware, usBlockSize, &sRequest);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(unReturnValue, L"TSS_TPM_FieldUpgradeUpdate_PrepareRequest returned an unexpected value while preparing block %d.", unFrame + 1);
+				break;
+			}
+			TSS_BYTE_Array_MarshalUnchecked(sRequest.rgbHeader, sizeof(sRequest.rgbHeader), &pbBuffer);
+			TSS_BYTE_Array_MarshalUnchecked(pbFirmware, usBlockSize, &pbBuffer);
+			TSS_UINT8_MarshalUnchecked(sRequest.bLRC, &pbBuffer);
+			pbFirmware += usBlockSize;
+			unRemainingBytes -= usBlockSize;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		*PprgbFrameFile = rgbFrameFile;
+		*PpunFrameFileSize = (UINT32)ullFrameFileSize;
+		*PpunFrameCount = unFrameCount;
+		rgbFrameFile = NULL;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&rgbFrameFile);
+
+	return unReturnValue;
+}
+
+#if IFX_ENABLE_TPM12
+/**
+ *	@brief		Returns an OIAP session for a TPM Owner authorized TPM1.2 command.
+ *	@details	Hands out the session left open by the previous command with continueAuthSession set, or starts a new
+ *				OIAP session. The caller owns the session until it passes it back with FirmwareUpdate_Tpm12_ReleaseAuthSession
+ *				or flushes it.
+ *
+ *	@param		PpunAuthHandle					Receives the authorization session handle
+ *	@param		PpsNonceEven					Receives the last even nonce of the session
+ *
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_Tpm12_AcquireAuthSession(
+	_Out_	TPM_AUTHHANDLE*	PpunAuthHandle,
+	_Out_	TPM_NONCE*		PpsNonceEven)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpunAuthHandle || NULL == PpsNonceEven)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected.");
+			break;
+		}
+
+		if (s_fTpm12AuthSessionValid)
+		{
+			*PpunAuthHandle = s_unTpm12AuthHandle;
+			*PpsNonceEven = s_sTpm12AuthNonceEven;
+			s_fTpm12AuthSessionValid = FALSE;
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		unReturnValue = TSS_TPM_OIAP(PpunAuthHandle, PpsNonceEven);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"TSS_TPM_OIAP returned an unexpected value.");
+			break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Keeps an OIAP session open for the next TPM Owner authorized TPM1.2 command.
+ *	@details	Must only be called after a successful command sent with continueAuthSession set. A session which was
+ *				closed by the TPM (continueAuthSession not set or command failed) is simply not released.
+ *
+ *	@param		PunAuthHandle					Authorization session handle
+ *	@param		PpsNonceEven					Even nonce returned by the TPM with the last command of the session
+ */
+void
+FirmwareUpdate_Tpm12_ReleaseAuthSession(
+	_In_	TPM_AUTHHANDLE		PunAuthHandle,
+	_In_	const TPM_NONCE*	PpsNonceEven)
+{
+	if (NULL == PpsNonceEven)
+		return;
+
+	// Do not leak a session kept open before
+	if (s_fTpm12AuthSessionValid && s_unTpm12AuthHandle != PunAuthHandle)
+	{
+		IGNORE_RETURN_VALUE(TSS_TPM_FlushSpecific(s_unTpm12AuthHandle, TPM_RT_AUTH));
+	}
+
+	s_unTpm12AuthHandle = PunAuthHandle;
+	s_sTpm12AuthNonceEven = *PpsNonceEven;
+	s_fTpm12AuthSessionValid = TRUE;
+}
+
 /**
  *	@brief		Checks TPM Owner authorization on TPM1.2.
- *	@details	The function checks TPM Owner authorization on TPM1.2 by calling TPM_ChangeAuthOwner with old and new TPM Owner authorization value set to the same value.
+ *	@details	The function checks TPM Owner authorization on TPM1.2 by reading the public portion of the EK with
+ *				TPM_OwnerReadInternalPub over an OIAP session. On success the session stays open and is reused by the next
+ *				TPM Owner authorized command (see FirmwareUpdate_Tpm12_AcquireAuthSession).
  *
  *	@param		PrgbOwnerAuthHash				TPM Owner Authentication hash (sha1)
  *
@@ -2023,67 +3769,43 @@ FirmwareUpdate_CheckOwnerAuthorization(
 	unsigned int unReturnValue = RC_E_FAIL;
 	do
 	{
-		TPM_NONCE sNonceOddOSAP = {{0}};
+		TPM_NONCE sNonceOdd = {{0}};
 		TPM_AUTHHANDLE unAuthHandle = 0;
 		TPM_NONCE sNonceEven = {{0}};
-		TPM_NONCE sNonceEvenOSAP = {{0}};
-		TPM_AUTHDATA sOsapSharedSecret = {{0}};
-		TPM_ENTITY_TYPE usEntity = (TPM_ET_XOR << 8) | TPM_ET_OWNER;
-		TPM_PUBKEY sPubKey = {{0}};
+		TPM_AUTHDATA sOwnerAuth = {{0}};
+		TPM_AUTHDATA sResAuth = {{0}};
+		TPM_PUBKEY_VIEW sPubKey = {{0}};
 
-		unReturnValue = Crypt_GetRandom(sizeof(sNonceOddOSAP.nonce), sNonceOddOSAP.nonce);
+		unReturnValue = Platform_MemoryCopy(sOwnerAuth.authdata, sizeof(sOwnerAuth.authdata), PrgbOwnerAuthHash, SHA1_DIGEST_SIZE);
 		if (RC_SUCCESS != unReturnValue)
 		{
-			ERROR_STORE(unReturnValue, L"Crypt_GetRandom returned an unexpected value.");
+			ERROR_STORE(unReturnValue, L"Platform_MemoryCopy returned an unexpected value.");
 			break;
 		}
 
-		// Start an OSAP session
-		unReturnValue = TSS_TPM_OSAP(usEntity, TPM_KH_OWNER, sNonceOddOSAP, &unAuthHandle, &sNonceEven, &sNonceEvenOSAP);
+		unReturnValue = Crypt_GetRandom(sizeof(sNonceOdd.nonce), sNonceOdd.nonce);
 		if (RC_SUCCESS != unReturnValue)
 		{
-			ERROR_STORE(unReturnValue, L"TSS_TPM_OSAP returned an unexpected value.");
+			ERROR_STORE(unReturnValue, L"Crypt_GetRandom returned an unexpected value.");
 			break;
 		}
 
-		// Calculate the OSAP shared secret
-		{
-			BYTE rgbInput[2 * sizeof(TPM_NONCE)] = {0};
-			unReturnValue = Platform_MemoryCopy(rgbInput, sizeof(rgbInput), sNonceEvenOSAP.nonce, sizeof(TPM_NONCE));
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Platform_MemoryCopy returned an unexpected value.");
-				break;
-			}
-			unReturnValue = Platform_MemoryCopy(rgbInput + sizeof(TPM_NONCE), sizeof(rgbInput) - sizeof(TPM_NONCE), sNonceOddOSAP.nonce, sizeof(TPM_NONCE));
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Platform_MemoryCopy returned an unexpected value.");
-				break;
-			}
-			unReturnValue = Crypt_HMAC(rgbInput, sizeof(rgbInput), PrgbOwnerAuthHash, sOsapSharedSecret.authdata);
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Crypt_HMAC returned an unexpected value.");
-				break;
-			}
-		}
+		unReturnValue = FirmwareUpdate_Tpm12_AcquireAuthSession(&unAuthHandle, &sNonceEven);
+		if (RC_SUCCESS != unReturnValue)
+			break;
 
+		// Read public portion of EK over the OIAP session and keep the session open
+		unReturnValue = TSS_TPM_OwnerReadInternalPub(TPM_KH_EK, unAuthHandle, sNonceOdd, &sNonceEven, sOwnerAuth, &sPubKey, &sResAuth);
+		if (RC_SUCCESS != unReturnValue)
 		{
-			TPM_AUTHDATA sResAuth = {{0}};
-			// Read public portion of EK over OSAP session
-			unReturnValue = TSS_TPM_OwnerReadInternalPub(TPM_KH_EK, unAuthHandle, sNonceOddOSAP, &sNonceEven, sOsapSharedSecret, &sPubKey, &sResAuth);
-			{
-				IGNORE_RETURN_VALUE(TSS_TPM_FlushSpecific(unAuthHandle, TPM_RT_AUTH));
-			}
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"TSS_TPM_OwnerReadInternalPub returned an unexpected value.");
-				break;
-			}
+			IGNORE_RETURN_VALUE(TSS_TPM_FlushSpecific(unAuthHandle, TPM_RT_AUTH));
+			ERROR_STORE(unReturnValue, L"TSS_TPM_OwnerReadInternalPub returned an unexpected value.");
+			break;
 		}
+		FirmwareUpdate_Tpm12_ReleaseAuthSession(unAuthHandle, &sNonceEven);
 	}
 	WHILE_FALSE_END;
 
 	return unReturnValue;
 }
+#endif // IFX_ENABLE_TPM12
@@ -16,17 +16,13 @@
 
 #include "StdInclude.h"
 #include "TPM2_Types.h"
+#include "TPM_Types.h"
+#include "FirmwareImage.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/// This value is the policy for TPM20 firmware update
-static const BYTE rgbTpm20FirmwareUpdatePolicyDigest[] = {0x6D, 0x9B, 0x4B, 0x75, 0x61, 0xCA, 0xC7, 0x7B,
-															0x26, 0x1B, 0x31, 0xE2, 0x42, 0x31, 0xBD, 0x87,
-															0x09, 0x7B, 0x47, 0x2E, 0x45, 0xF0, 0x7D, 0x4D,
-															0x8F, 0xED, 0xDD, 0xB0, 0x4B, 0x91, 0x89, 0xF4};
-
 /**
  *	@brief		TPM state attributes used in FirmwareUpdate interface methods.
  *	@details	TPM state attributes used in FirmwareUpdate interface methods (Bits tpm12, tpm20, and bootLoader are mutually exclusive).
@@ -110,16 +106,82 @@ typedef struct tdBITFIELD_NEW_TPM_FIRMWARE_INFO
 typedef unsigned long long (*PFN_FIRMWAREUPDATE_PROGRESSCALLBACK)(
 	unsigned long long PullCompletion);
 
+/**
+ *	@brief		Firmware block transfer progress
+ *	@details	This structure is handed over to the progress details callback after each transferred firmware block.
+ */
+typedef struct tdIfxFirmwareUpdateProgress
+{
+	/// Progress completion value between 1 and 100
+	unsigned int unCompletion;
+	/// Number of firmware bytes sent to the TPM
+	UINT32 unBytesSent;
+	/// Total number of firmware bytes
+	UINT32 unBytesTotal;
+	/// Number of firmware blocks sent to the TPM
+	UINT32 unBlocksSent;
+	/// Total number of firmware blocks
+	UINT32 unBlocksTotal;
+	/// Time in milliseconds since the first firmware block was sent
+	unsigned long long ullElapsedTime;
+	/// Current (smoothed) transfer rate in bytes per second, 0 if unknown
+	unsigned int unBytesPerSecond;
+	/// Estimated time in milliseconds until all firmware blocks are sent, based on the current transfer rate
+	unsigned long long ullEstimatedTimeRemaining;
+} IfxFirmwareUpdateProgress;
+
+/// Function pointer type definition for Response_ProgressDetailsCallback
+typedef void (*PFN_FIRMWAREUPDATE_PROGRESSDETAILSCALLBACK)(
+	const IfxFirmwareUpdateProgress* PpsProgress);
+
 /// Function pointer type definition for UpdateStarted_Callback
 typedef void (*PFN_FIRMWAREUPDATE_UPDATESTARTEDCALLBACK)(
 	);
 
+/// Function pointer type definition for a firmware block reader, reads PunSize bytes at PunOffset of the firmware block
+typedef unsigned int (*PFN_FIRMWAREUPDATE_READFIRMWARECALLBACK)(
+	void*			PpvContext,
+	UINT32			PunOffset,
+	BYTE*			PrgbBuffer,
+	UINT32			PunSize);
+
 /// This value indicates that the number of remaining firmware updates is unknown
 #define REMAINING_UPDATES_UNAVAILABLE (unsigned int)(-1)
 
+/// Fields of the TPM information returned by FirmwareUpdate_GetImageInfo
+/// TPM family (always detected)
+#define TPM_INFO_FIELD_FAMILY		0x00000001
+/// Firmware version
+#define TPM_INFO_FIELD_VERSION		0x00000002
+/// Number of remaining updates
+#define TPM_INFO_FIELD_COUNTER		0x00000004
+/// TPM1.2 owner, enabled, activated and physical presence flags and TPM2.0 platform hierarchy state
+#define TPM_INFO_FIELD_STATE		0x00000008
+/// All fields
+#define TPM_INFO_FIELDS_ALL			(TPM_INFO_FIELD_FAMILY | TPM_INFO_FIELD_VERSION | TPM_INFO_FIELD_COUNTER | TPM_INFO_FIELD_STATE)
+
+/// Maximum number of threads verifying firmware images concurrently in FirmwareUpdate_CheckImagesIntegrity
+#define FIRMWARE_UPDATE_VERIFY_THREADS_MAX	8
+
+/// Firmware image verified by FirmwareUpdate_CheckImagesIntegrity
+typedef struct tdIfxImageIntegrityCheck
+{
+	/// Firmware image byte stream
+	const BYTE*					pbImage;
+	/// Size of pbImage
+	UINT32						unImageSize;
+	/// Unmarshalled pbImage
+	const IfxFirmwareImage*		psFirmwareImage;
+	/// Receives the return value of FirmwareUpdate_CheckImageIntegrity
+	unsigned int				unReturnValue;
+	/// Receives TRUE if the image passed the integrity checks
+	BOOL						fValid;
+} IfxImageIntegrityCheck;
+
 /**
  *	@brief		Returns the TPM state attributes
- *	@details
+ *	@details	The TPM is probed once. Later calls return a snapshot of the state until FirmwareUpdate_InvalidateState
+ *				is called after an operation that changes the state of the TPM.
  *
  *	@param		PpsTpmState					Pointer to a variable representing the TPM state
  *
@@ -133,15 +195,106 @@ unsigned int
 FirmwareUpdate_CalculateState(
 	_Out_ TPM_STATE* PpsTpmState);
 
+/**
+ *	@brief		Invalidates the TPM state snapshot
+ *	@details	Must be called after operations that change the TPM state, e.g. firmware update start and complete,
+ *				TPM1.2 ownership or physical presence changes. The next FirmwareUpdate_CalculateState call probes the TPM again.
+ */
+void
+FirmwareUpdate_InvalidateState();
+
+/**
+ *	@brief		Records Deferred Physical Presence set on a TPM1.2 in the TPM state snapshot
+ *	@details	Called instead of FirmwareUpdate_InvalidateState after Physical Presence has been asserted and the Deferred
+ *				Physical Presence bit set, so that the next FirmwareUpdate_CalculateState call does not probe the TPM again
+ *				for flags known already.
+ *
+ *	@param		PfCmdEnabled		TRUE if the physical presence command has been enabled as well
+ */
+void
+FirmwareUpdate_SetTpm12DeferredPhysicalPresence(
+	_In_	BOOL	PfCmdEnabled);
+
+/**
+ *	@brief		Marks a firmware image as already verified
+ *	@details	The integrity checks of FirmwareUpdate_CheckImage (CRC, signature and firmware digest) are skipped for the
+ *				given buffer. All other checks, in particular the TPM dependent ones, are still performed. The caller is
+ *				responsible for having verified the content of the buffer (e.g. by a verification cache keyed by the image
+ *				digest) and must reset the mark with NULL before the buffer is released.
+ *
+ *	@param		PrgbImage					Firmware image byte stream or NULL to reset the mark
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ */
+void
+FirmwareUpdate_SetImageIntegrityVerified(
+	_In_opt_	const BYTE*		PrgbImage,
+	_In_		UINT32			PunImageSize);
+
+/**
+ *	@brief		Verifies the integrity of a firmware image without accessing the TPM
+ *	@details	Runs the integrity checks of FirmwareUpdate_CheckImage (CRC, signature and firmware digest) on the calling
+ *				thread, e.g. once before the image is handed to several forked workers. Images in a format which is checked
+ *				differently by FirmwareUpdate_CheckImage are not verified and leave PpfValid FALSE. The error stack is not
+ *				used, so the function can run on a worker thread.
+ *
+ *	@param		PrgbImage					Firmware image byte stream
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage			Unmarshalled PrgbImage
+ *	@param		PpfValid					Receives TRUE if the image passed the integrity checks
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_CheckImageIntegrity(
+	_In_bytecount_(PunImageSize)	const BYTE*				PrgbImage,
+	_In_							UINT32					PunImageSize,
+	_In_							const IfxFirmwareImage*	PpsFirmwareImage,
+	_Out_							BOOL*					PpfValid);
+
+/**
+ *	@brief		Verifies the integrity of several firmware images concurrently without accessing the TPM
+ *	@details	Runs FirmwareUpdate_CheckImageIntegrity for each image on up to FIRMWARE_UPDATE_VERIFY_THREADS_MAX threads.
+ *				The calling thread verifies a share of the images itself, as well as the share of a thread which cannot
+ *				be started. Each result is returned in the entry of its image, so the results keep the order of the
+ *				input. The images must stay valid until the function returns.
+ *
+ *	@param		PrgsChecks					Images to verify, receive the results
+ *	@param		PunCheckCount				Number of entries in PrgsChecks
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_CheckImagesIntegrity(
+	_Inout_updates_(PunCheckCount)	IfxImageIntegrityCheck*	PrgsChecks,
+	_In_							unsigned int			PunCheckCount);
+
+/**
+ *	@brief		Sets the TPM family expected by the next TPM state detection
+ *	@details	By default the detection starts with TPM2_Startup, because most TPMs in the field are TPM2.0. With the hint set
+ *				TPM_Startup is tried first and TPM2_Startup is only sent if the TPM does not answer like a TPM1.2 or a TPM in
+ *				boot loader mode. The hint only changes the order of the commands, never the detected state.
+ *
+ *	@param		PfTpm12						TRUE if the TPM was a TPM1.2 or in boot loader mode the last time, FALSE otherwise
+ */
+void
+FirmwareUpdate_SetTpm12Hint(
+	_In_	BOOL	PfTpm12);
+
 /**
  *	@brief		Returns information about the current state of TPM
- *	@details
+ *	@details	Only the TPM commands needed for the requested fields are sent. The TPM family and the failure states are
+ *				always detected. Without TPM_INFO_FIELD_STATE the TPM1.2 owner, enabled, activated and physical presence
+ *				flags and the TPM2.0 platform hierarchy state are left zero.
  *
  *	@param		PwszVersionName				A pointer to a null-terminated string representing the firmware image version name.
  *	@param		PpunVersionNameSize			IN: Capacity of the PwszVersionName parameter in wide characters including zero termination
  *											OUT: Length of written wide character string (excluding zero termination)
  *	@param		PpsTpmState					Receives TPM state.
  *	@param		PpunRemainingUpdates		Receives the number of remaining updates or -1 in case the value could not be detected.
+ *	@param		PunFields					Fields to query, a combination of TPM_INFO_FIELD_* values.
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
  *	@retval		RC_E_FAIL					An unexpected error occurred.
@@ -155,7 +308,8 @@ FirmwareUpdate_GetImageInfo(
 	_Inout_bytecap_(*PpunVersionNameSize)	wchar_t*					PwszVersionName,
 	_Inout_									unsigned int*				PpunVersionNameSize,
 	_Inout_									TPM_STATE*					PpsTpmState,
-	_Inout_									unsigned int*				PpunRemainingUpdates);
+	_Inout_									unsigned int*				PpunRemainingUpdates,
+	_In_									unsigned int				PunFields);
 
 /**
  *	@brief		Checks if the firmware image is valid for the TPM
@@ -163,6 +317,7 @@ FirmwareUpdate_GetImageInfo(
  *
  *	@param		PrgbImage					Firmware image byte stream
  *	@param		PullImageSize				Size of firmware image byte stream
+ *	@param		PpsFirmwareImage			Firmware image already unmarshalled from PrgbImage by the caller or NULL to unmarshal it here
  *	@param		PpfValid					TRUE in case the image is valid, FALSE otherwise.
  *	@param		PpbfNewTpmFirmwareInfo		Pointer to a bit field to return info data for the new firmware image.
  *	@param		PpunErrorDetails			Pointer to an unsigned int to return error details. Possible values are:\n
@@ -185,10 +340,45 @@ unsigned int
 FirmwareUpdate_CheckImage(
 	_In_bytecount_(PullImageSize)	BYTE*							PrgbImage,
 	_In_							UINT64							PullImageSize,
+	_In_opt_						const IfxFirmwareImage*			PpsFirmwareImage,
 	_Out_							BOOL*							PpfValid,
 	_Out_							BITFIELD_NEW_TPM_FIRMWARE_INFO*	PpbfNewTpmFirmwareInfo,
 	_Out_							UINT32*							PpunErrorDetails);
 
+/**
+ *	@brief		Structure for the duration of the firmware update steps
+ *	@details	All times are given in microseconds and are measured with the monotonic clock. A step which was not
+ *				executed has the duration zero. The CPU and wait times split the duration of a step into host CPU
+ *				time and time spent waiting for the TPM. The block count and size describe the measured transfer.
+ */
+typedef struct tdIfxFirmwareUpdateTimings
+{
+	/// Time to probe the TPM state
+	unsigned long long ullStateTime;
+	/// Time of FieldUpgradeStart
+	unsigned long long ullStartTime;
+	/// Time to transfer the firmware blocks
+	unsigned long long ullTransferTime;
+	/// Time of FieldUpgradeComplete
+	unsigned long long ullCompleteTime;
+	/// Host CPU time of the four steps
+	unsigned long long ullStateCpuTime;
+	unsigned long long ullStartCpuTime;
+	unsigned long long ullTransferCpuTime;
+	unsigned long long ullCompleteCpuTime;
+	/// Time of the four steps spent sleeping or blocked while waiting for the TPM
+	unsigned long long ullStateWaitTime;
+	unsigned long long ullStartWaitTime;
+	unsigned long long ullTransferWaitTime;
+	unsigned long long ullCompleteWaitTime;
+	/// Number of firmware blocks sent to the TPM
+	UINT32 unBlockCount;
+	/// Maximum firmware block size reported by the TPM in boot loader mode
+	UINT32 unBlockSize;
+	/// Number of firmware blocks resent after a transient transport error
+	UINT32 unResentBlockCount;
+} IfxFirmwareUpdateTimings;
+
 /**
  *	@brief		Firmware Update Data structure
  *	@details	This structure is used to hand over the firmware update related data.
@@ -199,14 +389,30 @@ typedef struct tdIfxFirmwareUpdateData
 	UINT32 unFirmwareImageSize;
 	/// Pointer to a Firmware image
 	BYTE* rgbFirmwareImage;
+	/// Firmware image already unmarshalled from rgbFirmwareImage or NULL to unmarshal it during the update
+	const IfxFirmwareImage* psFirmwareImage;
 	/// Progress call back function pointer
 	PFN_FIRMWAREUPDATE_PROGRESSCALLBACK fnProgressCallback;
+	/// Optional progress details call back function pointer, replaces fnProgressCallback during the firmware block transfer
+	PFN_FIRMWAREUPDATE_PROGRESSDETAILSCALLBACK fnProgressDetailsCallback;
 	/// Update started call back function pointer
 	PFN_FIRMWAREUPDATE_UPDATESTARTEDCALLBACK fnUpdateStartedCallback;
+	/// Optional firmware block reader. If set the firmware block is streamed from the image source during the transfer
+	/// instead of being taken from the firmware image in memory, and is checked against the digest of the policy parameter block.
+	PFN_FIRMWAREUPDATE_READFIRMWARECALLBACK fnReadFirmwareCallback;
+	/// Context handed over to fnReadFirmwareCallback
+	void* pvReadFirmwareContext;
+	/// Optional frame file created by FirmwareUpdate_BuildFrameFile for the firmware image. If it was built for the maximum
+	/// data size reported by the TPM, the TPM_FieldUpgradeUpdate requests are sent from it instead of being prepared.
+	const BYTE* rgbFrameFile;
+	/// Size of the frame file in rgbFrameFile
+	UINT32 unFrameFileSize;
 	/// Session handle used for updating a TPM2.0
 	unsigned int unSessionHandle;
 	/// TPM Owner authentication hash value used for updating a TPM1.2 with TPM Owner authorization
 	BYTE rgbOwnerAuthHash[SHA1_DIGEST_SIZE];
+	/// Optional structure which receives the duration of the firmware update steps (can be NULL)
+	IfxFirmwareUpdateTimings* psTimings;
 } IfxFirmwareUpdateData;
 
 /**
@@ -230,9 +436,84 @@ unsigned int
 FirmwareUpdate_UpdateImage(
 	_In_	const IfxFirmwareUpdateData* const	PpsFirmwareUpdateData);
 
+/// Magic and format version at the start of a frame file
+#define FIRMWARE_FRAME_FILE_MAGIC			"IFXFRM01"
+/// Size of FIRMWARE_FRAME_FILE_MAGIC without the terminating zero
+#define FIRMWARE_FRAME_FILE_MAGIC_SIZE		8
+/// Size of the frame file header: magic, source TPM family, maximum data size, policy parameter block size, firmware
+/// size, frame count and SHA-256 digest of the firmware image. The policy parameter block and the frames follow.
+#define FIRMWARE_FRAME_FILE_HEADER_SIZE		(FIRMWARE_FRAME_FILE_MAGIC_SIZE + 1 + 2 + 2 + 4 + 4 + SHA256_DIGEST_SIZE)
+
+/**
+ *	@brief		Builds a frame file for a firmware image
+ *	@details	A frame file holds the complete TPM_FieldUpgradeUpdate command frames (header, sub command, data size,
+ *				firmware block and LRC) for one maximum data size, preceded by the policy parameter block needed by the
+ *				start of the update. It is bound to the firmware image by the SHA-256 digest of the image, and the firmware
+ *				blocks are checked against the signed firmware digest when the frame file is used. All values are stored
+ *				in big-endian format. The image must have been verified by the caller.
+ *
+ *	@param		PrgbImage					Firmware image byte stream
+ *	@param		PunImageSize				Size of the firmware image byte stream
+ *	@param		PpsFirmwareImage			Unmarshalled PrgbImage
+ *	@param		PusMaxDataSize				Maximum data size of a firmware block (wMaxDataSize of the TPM in boot loader mode)
+ *	@param		PprgbFrameFile				Receives the frame file, must be freed with Platform_MemoryFree
+ *	@param		PpunFrameFileSize			Receives the size of the frame file
+ *	@param		PpunFrameCount				Receives the number of frames
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function or the maximum data size is invalid.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_BuildFrameFile(
+	_In_bytecount_(PunImageSize)	const BYTE*				PrgbImage,
+	_In_							UINT32					PunImageSize,
+	_In_							const IfxFirmwareImage*	PpsFirmwareImage,
+	_In_							UINT16					PusMaxDataSize,
+	_Outptr_result_maybenull_		BYTE**					PprgbFrameFile,
+	_Out_							UINT32*					PpunFrameFileSize,
+	_Out_							UINT32*					PpunFrameCount);
+
+#if IFX_ENABLE_TPM12
+/**
+ *	@brief		Returns an OIAP session for a TPM Owner authorized TPM1.2 command.
+ *	@details	Hands out the session left open by the previous command with continueAuthSession set, or starts a new
+ *				OIAP session. The caller owns the session until it passes it back with FirmwareUpdate_Tpm12_ReleaseAuthSession
+ *				or flushes it.
+ *
+ *	@param		PpunAuthHandle					Receives the authorization session handle
+ *	@param		PpsNonceEven					Receives the last even nonce of the session
+ *
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+FirmwareUpdate_Tpm12_AcquireAuthSession(
+	_Out_	TPM_AUTHHANDLE*	PpunAuthHandle,
+	_Out_	TPM_NONCE*		PpsNonceEven);
+
+/**
+ *	@brief		Keeps an OIAP session open for the next TPM Owner authorized TPM1.2 command.
+ *	@details	Must only be called after a successful command sent with continueAuthSession set. A session which was
+ *				closed by the TPM (continueAuthSession not set or command failed) is simply not released.
+ *
+ *	@param		PunAuthHandle					Authorization session handle
+ *	@param		PpsNonceEven					Even nonce returned by the TPM with the last command of the session
+ */
+void
+FirmwareUpdate_Tpm12_ReleaseAuthSession(
+	_In_	TPM_AUTHHANDLE		PunAuthHandle,
+	_In_	const TPM_NONCE*	PpsNonceEven);
+
 /**
  *	@brief		Checks TPM Owner authorization on TPM1.2.
- *	@details	The function checks TPM Owner authorization on TPM1.2 by calling TPM_ChangeAuthOwner with old and new TPM Owner authorization value set to the same value.
+ *	@details	The function checks TPM Owner authorization on TPM1.2 by reading the public portion of the EK with
+ *				TPM_OwnerReadInternalPub over an OIAP session. On success the session stays open and is reused by the next
+ *				TPM Owner authorized command (see FirmwareUpdate_Tpm12_AcquireAuthSession).
  *
  *	@param		PrgbOwnerAuthHash				TPM Owner Authentication hash (sha1)
  *
@@ -244,7 +525,9 @@ _Check_return_
 unsigned int
 FirmwareUpdate_CheckOwnerAuthorization(
 	_In_bytecount_(SHA1_DIGEST_SIZE)	const BYTE	PrgbOwnerAuthHash[SHA1_DIGEST_SIZE]);
+#endif // IFX_ENABLE_TPM12
 
+#if IFX_ENABLE_TPM20
 /**
  *	@brief		Prepares a policy session for TPM firmware.
  *	@details	The function prepares a policy session for TPM Firmware Update.
@@ -262,6 +545,7 @@ _Check_return_
 unsigned int
 FirmwareUpdate_PrepareTPM20Policy(
 	_Out_ TPMI_SH_AUTH_SESSION* PphPolicySession);
+#endif // IFX_ENABLE_TPM20
 
 #ifdef __cplusplus
 }
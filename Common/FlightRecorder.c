@@ -0,0 +1,307 @@
+﻿/**
+ *	@brief		Implements the flight recorder
+ *	@details	This module keeps the recent TPM commands, TPM wait loops and stored errors as compact binary records in
+ *				a fixed-size ring. The ring is a memory-mapped file, so it survives a crash of the tool. The records
+ *				are only rendered to the log file when a TPM command fails or the tool exits with an error.
+ *	@file		FlightRecorder.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdatomic.h>
+#include "FlightRecorder.h"
+#include "FileIO.h"
+#include "Platform.h"
+#include "Logging.h"
+#include "DeviceManagement.h"
+#include "TpmResponse.h"
+
+/// Magic value of the flight recorder file ("IFRC")
+#define FLIGHTRECORDER_MAGIC			0x43524649
+/// Version of the flight recorder file layout
+#define FLIGHTRECORDER_VERSION			1
+/// State of a flight recorder which is in use
+#define FLIGHTRECORDER_STATE_RUNNING	1
+/// State of a flight recorder which has been closed
+#define FLIGHTRECORDER_STATE_CLOSED		2
+
+/**
+ *	@brief		Describes a record of the flight recorder (64 bytes)
+ *	@details	The meaning of the values and the data depends on the record type (FLIGHTRECORDER_RECORD_*).
+ */
+typedef struct tdIfxFlightRecord
+{
+	/// Monotonic time stamp of the record in microseconds
+	unsigned long long ullTime;
+	/// Record type (FLIGHTRECORDER_RECORD_*)
+	unsigned int unType;
+	/// Number of used bytes of rgbData
+	unsigned int unDataSize;
+	/// Values of the record
+	unsigned int rgunValues[4];
+	/// Data of the record
+	BYTE rgbData[FLIGHTRECORDER_DATA_SIZE];
+} IfxFlightRecord;
+
+/**
+ *	@brief		Describes the flight recorder file
+ *	@details	The header takes 64 bytes, followed by the ring of records.
+ */
+typedef struct tdIfxFlightRecorder
+{
+	/// FLIGHTRECORDER_MAGIC
+	unsigned int unMagic;
+	/// FLIGHTRECORDER_VERSION
+	unsigned int unVersion;
+	/// FLIGHTRECORDER_RECORD_COUNT
+	unsigned int unRecordCount;
+	/// FLIGHTRECORDER_STATE_RUNNING or FLIGHTRECORDER_STATE_CLOSED
+	unsigned int unState;
+	/// Number of records added since the flight recorder has been opened
+	atomic_ullong ullRecorded;
+	/// Reserved
+	BYTE rgbReserved[40];
+	/// Ring of records, a record is stored at the index of its number modulo FLIGHTRECORDER_RECORD_COUNT
+	IfxFlightRecord rgsRecords[FLIGHTRECORDER_RECORD_COUNT];
+} IfxFlightRecorder;
+
+BOOL g_fFlightRecorderEnabled = FALSE;
+
+/// Flight recorder opened by FlightRecorder_Open
+static IfxFlightRecorder* s_psRecorder = NULL;
+
+/// TRUE if s_psRecorder maps FLIGHTRECORDER_FILE, FALSE if it is allocated
+static BOOL s_fMapped = FALSE;
+
+/// Lock on FLIGHTRECORDER_FILE held while it is mapped
+static void* s_pvLock = NULL;
+
+/// Number of the first record not rendered yet
+static unsigned long long s_ullRendered = 0;
+
+/**
+ *	@brief		Writes a record to the log file
+ *
+ *	@param		PpsRecord		Record
+ *	@param		PullOffset		Time of the record relative to the first rendered record in microseconds
+ */
+static void
+FlightRecorder_RenderRecord(
+	_In_	const IfxFlightRecord*	PpsRecord,
+	_In_	unsigned long long		PullOffset)
+{
+	unsigned int unDataSize = PpsRecord->unDataSize > FLIGHTRECORDER_DATA_SIZE ? FLIGHTRECORDER_DATA_SIZE : PpsRecord->unDataSize;
+
+	switch (PpsRecord->unType)
+	{
+		case FLIGHTRECORDER_RECORD_REQUEST:
+		{
+			const wchar_t* wszName = DeviceManagement_GetRequestCommandName(PpsRecord->rgbData, unDataSize);
+			LOGGING_WRITE_LEVEL1_FMT(L"  +%llu us Request %ls (0x%.8X): TxLen = %u", PullOffset,
+				NULL == wszName ? L"Unknown" : wszName, PpsRecord->rgunValues[0], PpsRecord->rgunValues[2]);
+			LOGGING_WRITEHEX_LEVEL1(PpsRecord->rgbData, unDataSize);
+			break;
+		}
+		case FLIGHTRECORDER_RECORD_RESPONSE:
+		{
+			wchar_t wszMessage[MAX_MESSAGE_SIZE] = {0};
+			if (0 == PpsRecord->rgunValues[1])
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"  +%llu us Response (0x%.8X): Transmission failed (0x%.8X) after %u us", PullOffset,
+					PpsRecord->rgunValues[0], PpsRecord->rgunValues[2], PpsRecord->rgunValues[3]);
+				break;
+			}
+
+			// TPM1.2 response tags start with a zero byte, TPM2.0 ones do not
+			if (0 != PpsRecord->rgunValues[2])
+			{
+				if (unDataSize > 0 && 0x00 == PpsRecord->rgbData[0])
+					IGNORE_RETURN_VALUE(TpmResponse_TPM12GetMessage(PpsRecord->rgunValues[2], wszMessage, RG_LEN(wszMessage)));
+				else
+					IGNORE_RETURN_VALUE(TpmResponse_GetMessage(PpsRecord->rgunValues[2], wszMessage, RG_LEN(wszMessage)));
+			}
+			LOGGING_WRITE_LEVEL1_FMT(L"  +%llu us Response (0x%.8X): RxLen = %u Result = 0x%.8X%ls%ls Duration = %u us", PullOffset,
+				PpsRecord->rgunValues[0], PpsRecord->rgunValues[1], PpsRecord->rgunValues[2], 0 == wszMessage[0] ? L"" : L" ", wszMessage,
+				PpsRecord->rgunValues[3]);
+			LOGGING_WRITEHEX_LEVEL1(PpsRecord->rgbData, unDataSize);
+			break;
+		}
+		case FLIGHTRECORDER_RECORD_TIS_WAIT:
+			LOGGING_WRITE_LEVEL1_FMT(L"  +%llu us TIS wait: Result = 0x%.8X Iterations = %u Slept = %u us Timeout = %u us", PullOffset,
+				PpsRecord->rgunValues[1], PpsRecord->rgunValues[2], PpsRecord->rgunValues[3], PpsRecord->rgunValues[0]);
+			break;
+		case FLIGHTRECORDER_RECORD_ERROR:
+		{
+			char szFunction[FLIGHTRECORDER_DATA_SIZE + 1] = {0};
+			wchar_t wszFunction[FLIGHTRECORDER_DATA_SIZE + 1] = {0};
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(szFunction, sizeof(szFunction) - 1, PpsRecord->rgbData, unDataSize));
+			if (RC_SUCCESS != Platform_AnsiString2UnicodeString(wszFunction, RG_LEN(wszFunction), szFunction))
+				wszFunction[0] = L'\0';
+			LOGGING_WRITE_LEVEL1_FMT(L"  +%llu us Error 0x%.8X stored in %ls line %u", PullOffset,
+				PpsRecord->rgunValues[0], wszFunction, PpsRecord->rgunValues[1]);
+			break;
+		}
+		default:
+			LOGGING_WRITE_LEVEL1_FMT(L"  +%llu us Unknown record type %u", PullOffset, PpsRecord->unType);
+			break;
+	}
+}
+
+/**
+ *	@brief		Opens the flight recorder
+ *	@details	Maps FLIGHTRECORDER_FILE. Records left by a run which did not close the flight recorder (e.g. a crash) are
+ *				rendered to the log file first. In case the file cannot be mapped or is in use by another process, the
+ *				ring is kept in memory. Does nothing if the flight recorder is open already.
+ */
+void
+FlightRecorder_Open()
+{
+	BYTE* pbRecorder = NULL;
+
+	if (NULL != s_psRecorder)
+		return;
+
+	// Several processes must not write to the same file, the one holding the lock maps it
+	if (RC_SUCCESS == FileIO_LockFile(FLIGHTRECORDER_FILE, 0, &s_pvLock) &&
+		RC_SUCCESS == FileIO_MapSharedFile(FLIGHTRECORDER_FILE, sizeof(IfxFlightRecorder), &pbRecorder))
+	{
+		s_fMapped = TRUE;
+		s_psRecorder = (IfxFlightRecorder*)pbRecorder;
+	}
+	else
+	{
+		if (NULL != s_pvLock)
+			FileIO_UnlockFile(&s_pvLock);
+		s_fMapped = FALSE;
+		s_psRecorder = (IfxFlightRecorder*)Platform_MemoryAllocateZero(sizeof(IfxFlightRecorder));
+		if (NULL == s_psRecorder)
+			return;
+	}
+
+	// Show what the previous run recorded before it ended abnormally
+	s_ullRendered = 0;
+	if (FLIGHTRECORDER_MAGIC == s_psRecorder->unMagic && FLIGHTRECORDER_VERSION == s_psRecorder->unVersion &&
+		FLIGHTRECORDER_RECORD_COUNT == s_psRecorder->unRecordCount && FLIGHTRECORDER_STATE_RUNNING == s_psRecorder->unState)
+	{
+		FlightRecorder_Render(L"Flight recorder: The previous run ended abnormally. Its last records:");
+	}
+
+	s_psRecorder->unMagic = FLIGHTRECORDER_MAGIC;
+	s_psRecorder->unVersion = FLIGHTRECORDER_VERSION;
+	s_psRecorder->unRecordCount = FLIGHTRECORDER_RECORD_COUNT;
+	s_psRecorder->unState = FLIGHTRECORDER_STATE_RUNNING;
+	atomic_store(&s_psRecorder->ullRecorded, 0);
+	s_ullRendered = 0;
+	g_fFlightRecorderEnabled = TRUE;
+}
+
+/**
+ *	@brief		Adds a record to the flight recorder
+ *	@details	Does nothing if the flight recorder is not open. Data exceeding FLIGHTRECORDER_DATA_SIZE is cut off.
+ *
+ *	@param		PunType			Record type (FLIGHTRECORDER_RECORD_*)
+ *	@param		PunValue1		First value of the record
+ *	@param		PunValue2		Second value of the record
+ *	@param		PunValue3		Third value of the record
+ *	@param		PunValue4		Fourth value of the record
+ *	@param		PrgbData		Data of the record (optional, can be NULL)
+ *	@param		PunDataSize		Size of the data in bytes
+ */
+void
+FlightRecorder_Record(
+	_In_							unsigned int	PunType,
+	_In_							unsigned int	PunValue1,
+	_In_							unsigned int	PunValue2,
+	_In_							unsigned int	PunValue3,
+	_In_							unsigned int	PunValue4,
+	_In_bytecount_(PunDataSize)		const void*		PrgbData,
+	_In_							unsigned int	PunDataSize)
+{
+	IfxFlightRecord* psRecord = NULL;
+
+	if (NULL == s_psRecorder)
+		return;
+
+	// Claiming the slot atomically lets the log writer and TPM worker threads record concurrently
+	psRecord = &s_psRecorder->rgsRecords[atomic_fetch_add_explicit(&s_psRecorder->ullRecorded, 1, memory_order_relaxed) % FLIGHTRECORDER_RECORD_COUNT];
+	psRecord->ullTime = Platform_GetMonotonicTimeMicroSeconds();
+	psRecord->unType = PunType;
+	psRecord->rgunValues[0] = PunValue1;
+	psRecord->rgunValues[1] = PunValue2;
+	psRecord->rgunValues[2] = PunValue3;
+	psRecord->rgunValues[3] = PunValue4;
+	psRecord->unDataSize = 0;
+	if (NULL != PrgbData && 0 != PunDataSize)
+	{
+		psRecord->unDataSize = PunDataSize > FLIGHTRECORDER_DATA_SIZE ? FLIGHTRECORDER_DATA_SIZE : PunDataSize;
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(psRecord->rgbData, sizeof(psRecord->rgbData), PrgbData, psRecord->unDataSize));
+	}
+}
+
+/**
+ *	@brief		Renders the records to the log file
+ *	@details	Only the records added since the last call are rendered (oldest record first). The log file is flushed
+ *				afterwards. Does nothing if the flight recorder is not open.
+ *
+ *	@param		PwszReason		Reason written in front of the records
+ */
+void
+FlightRecorder_Render(
+	_In_z_	const wchar_t*	PwszReason)
+{
+	unsigned long long ullRecorded = 0;
+	unsigned long long ullFirst = 0;
+	unsigned long long ullIndex = 0;
+	unsigned long long ullStartTime = 0;
+
+	if (NULL == s_psRecorder)
+		return;
+
+	// Older records have been overwritten already
+	ullRecorded = atomic_load(&s_psRecorder->ullRecorded);
+	ullFirst = s_ullRendered;
+	if (ullRecorded - ullFirst > FLIGHTRECORDER_RECORD_COUNT)
+		ullFirst = ullRecorded - FLIGHTRECORDER_RECORD_COUNT;
+	if (ullFirst >= ullRecorded)
+		return;
+
+	LOGGING_WRITE_LEVEL1_FMT(L"%ls (%llu record(s))", PwszReason, ullRecorded - ullFirst);
+	ullStartTime = s_psRecorder->rgsRecords[ullFirst % FLIGHTRECORDER_RECORD_COUNT].ullTime;
+	for (ullIndex = ullFirst; ullIndex < ullRecorded; ullIndex++)
+	{
+		const IfxFlightRecord* psRecord = &s_psRecorder->rgsRecords[ullIndex % FLIGHTRECORDER_RECORD_COUNT];
+		FlightRecorder_RenderRecord(psRecord, psRecord->ullTime > ullStartTime ? psRecord->ullTime - ullStartTime : 0);
+	}
+	s_ullRendered = ullRecorded;
+
+	Logging_Flush();
+}
+
+/**
+ *	@brief		Closes the flight recorder
+ *	@details	The records stay in the file until the next run. Does nothing if the flight recorder is not open.
+ */
+void
+FlightRecorder_Close()
+{
+	if (NULL == s_psRecorder)
+		return;
+
+	g_fFlightRecorderEnabled = FALSE;
+	if (s_fMapped)
+	{
+		s_psRecorder->unState = FLIGHTRECORDER_STATE_CLOSED;
+		FileIO_ReleaseFileBuffer((BYTE**)&s_psRecorder, sizeof(IfxFlightRecorder), TRUE);
+		FileIO_UnlockFile(&s_pvLock);
+	}
+	else
+		Platform_MemoryFree((void**)&s_psRecorder);
+	s_psRecorder = NULL;
+}
@@ -0,0 +1,99 @@
+﻿/**
+ *	@brief		Declares the flight recorder
+ *	@details	This module keeps the recent TPM commands, TPM wait loops and stored errors as compact binary records in
+ *				a fixed-size ring. The ring is a memory-mapped file, so it survives a crash of the tool. The records
+ *				are only rendered to the log file when a TPM command fails or the tool exits with an error, which
+ *				gives the detail of a high logging level without its cost.
+ *	@file		FlightRecorder.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// TRUE while the flight recorder is open, checked by the callers before they collect the record data
+extern BOOL g_fFlightRecorderEnabled;
+
+/// Checks whether records are added to the flight recorder
+#define FLIGHTRECORDER_IS_ENABLED()	(TRUE == g_fFlightRecorderEnabled)
+
+/// Flight recorder file, only used by one process at a time (the others keep their ring in memory)
+#define FLIGHTRECORDER_FILE				L"/run/TPMFactoryUpd_FlightRecorder.bin"
+/// Number of records in the ring
+#define FLIGHTRECORDER_RECORD_COUNT		4096
+/// Number of data bytes of a record (e.g. the beginning of a TPM command or response)
+#define FLIGHTRECORDER_DATA_SIZE		32
+
+/// Record of a TPM request (values: command code, sub command, request size; data: beginning of the request)
+#define FLIGHTRECORDER_RECORD_REQUEST	1
+/// Record of a TPM response (values: command code, response size, result, duration; data: beginning of the response)
+#define FLIGHTRECORDER_RECORD_RESPONSE	2
+/// Record of a TPM interface wait loop (values: maximum duration, result, iterations, slept time)
+#define FLIGHTRECORDER_RECORD_TIS_WAIT	3
+/// Record of a stored error (values: error code, line; data: function name)
+#define FLIGHTRECORDER_RECORD_ERROR		4
+
+/**
+ *	@brief		Opens the flight recorder
+ *	@details	Maps FLIGHTRECORDER_FILE. Records left by a run which did not close the flight recorder (e.g. a crash) are
+ *				rendered to the log file first. In case the file cannot be mapped or is in use by another process, the
+ *				ring is kept in memory. Does nothing if the flight recorder is open already.
+ */
+void
+FlightRecorder_Open();
+
+/**
+ *	@brief		Adds a record to the flight recorder
+ *	@details	Does nothing if the flight recorder is not open. Data exceeding FLIGHTRECORDER_DATA_SIZE is cut off.
+ *
+ *	@param		PunType			Record type (FLIGHTRECORDER_RECORD_*)
+ *	@param		PunValue1		First value of the record
+ *	@param		PunValue2		Second value of the record
+ *	@param		PunValue3		Third value of the record
+ *	@param		PunValue4		Fourth value of the record
+ *	@param		PrgbData		Data of the record (optional, can be NULL)
+ *	@param		PunDataSize		Size of the data in bytes
+ */
+void
+FlightRecorder_Record(
+	_In_							unsigned int	PunType,
+	_In_							unsigned int	PunValue1,
+	_In_							unsigned int	PunValue2,
+	_In_							unsigned int	PunValue3,
+	_In_							unsigned int	PunValue4,
+	_In_bytecount_(PunDataSize)		const void*		PrgbData,
+	_In_							unsigned int	PunDataSize);
+
+/**
+ *	@brief		Renders the records to the log file
+ *	@details	Only the records added since the last call are rendered (oldest record first). The log file is flushed
+ *				afterwards. Does nothing if the flight recorder is not open.
+ *
+ *	@param		PwszReason		Reason written in front of the records
+ */
+void
+FlightRecorder_Render(
+	_In_z_	const wchar_t*	PwszReason);
+
+/**
+ *	@brief		Closes the flight recorder
+ *	@details	The records stay in the file until the next run. Does nothing if the flight recorder is not open.
+ */
+void
+FlightRecorder_Close();
+
+#ifdef __cplusplus
+}
+#endif
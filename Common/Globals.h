@@ -37,18 +37,106 @@
 #define BOM_UCS2LE				0xFEFF
 /// Size of TPM2.0 generated random number
 #define RANDOMSIZE				20
-/// TPM device access through Memory based access (only supported on x86 based systems with PCH TPM support)
+/// TPM device access through the fastest of memory based access, device driver and resource manager working on this host
+#define TPM_DEVICE_ACCESS_AUTO 0
+/// TPM device access through Memory based access (TIS or CRB registers mapped through /dev/mem)
 #define TPM_DEVICE_ACCESS_MEMORY_BASED 1
 /// TPM device access through device driver (for example /dev/tpm0, etc.)
 #define TPM_DEVICE_ACCESS_DRIVER 3
+/// TPM device access through the device driver's resource manager (for example /dev/tpmrm0, etc.)
+#define TPM_DEVICE_ACCESS_RESOURCE_MANAGER 4
+/// TPM device access to a simulated TPM (no TPM hardware is accessed, for tests of the command flows)
+#define TPM_DEVICE_ACCESS_SIMULATED 5
+/// TPM device access replaying a capture file recorded from a real TPM (no TPM hardware is accessed)
+#define TPM_DEVICE_ACCESS_REPLAY 6
+/// TPM device access to a software TPM through the MS TPM simulator / swtpm socket protocol
+#define TPM_DEVICE_ACCESS_SOCKET 7
+/// TPM DEVICE_ACCESS_PATH for the socket access mode (host and TPM command port)
+#define TPM_DEVICE_ACCESS_SOCKET_PATH L"localhost:2321"
+/// TPM device access to the TPM of another host through the TPMRemoteAgent socket (socket protocol plus batched commands)
+#define TPM_DEVICE_ACCESS_REMOTE 8
+/// TPM DEVICE_ACCESS_PATH for the remote access mode (host and port of the TPMRemoteAgent)
+#define TPM_DEVICE_ACCESS_REMOTE_PATH L"localhost:2331"
+/// TPM device access through the TPM SPI protocol on a spidev device (SPI controller or USB-SPI bridge with a Linux driver)
+#define TPM_DEVICE_ACCESS_SPI 9
+/// TPM DEVICE_ACCESS_PATH for the SPI access mode
+#define TPM_DEVICE_ACCESS_SPI_PATH L"/dev/spidev0.0"
 /// TPM DEVICE_ACCESS_PATH
 #define TPM_DEVICE_ACCESS_PATH L"/dev/tpm0"
+/// TPM DEVICE_ACCESS_PATH for the resource manager access mode
+#define TPM_DEVICE_ACCESS_RESOURCE_MANAGER_PATH L"/dev/tpmrm0"
 /// Define for TPM device access mode property string
 #define PROPERTY_TPM_DEVICE_ACCESS_MODE		L"TpmDeviceAccessMode"
+/// Define for the property allowing the automatic access mode to select the resource manager (read-only operations only)
+#define PROPERTY_TPM_DEVICE_ACCESS_AUTO_SHARED	L"TpmDeviceAccessAutoShared"
+/// Define for TPM locality property string
+#define PROPERTY_LOCALITY					L"Locality"
 /// Define for TPM device driver path property string
 #define PROPERTY_TPM_DEVICE_ACCESS_PATH		L"TpmDeviceAccessPath"
 /// Define for CallTpm2ShutdownOnExit property
 #define PROPERTY_CALL_SHUTDOWN_ON_EXIT		L"CallTpm2ShutdownOnExit"
+/// Define for the transport statistics property
+#define PROPERTY_STATISTICS					L"Statistics"
+/// Define for the simulated TPM profile property string (tpm12, tpm20 or bootloader)
+#define PROPERTY_TPM_SIMULATOR_PROFILE			L"TpmSimulatorProfile"
+/// Define for the simulated TPM firmware version property string (e.g. 7.63.3353.0)
+#define PROPERTY_TPM_SIMULATOR_FIRMWARE_VERSION	L"TpmSimulatorFirmwareVersion"
+/// Define for the simulated TPM decrypt key ID property string
+#define PROPERTY_TPM_SIMULATOR_DECRYPT_KEY_ID	L"TpmSimulatorDecryptKeyId"
+/// Define for the simulated TPM default command latency property string (microseconds)
+#define PROPERTY_TPM_SIMULATOR_LATENCY			L"TpmSimulatorLatency"
+/// Define for the simulated TPM firmware update start latency property string (microseconds)
+#define PROPERTY_TPM_SIMULATOR_LATENCY_START	L"TpmSimulatorLatencyStart"
+/// Define for the simulated TPM firmware block latency property string (microseconds)
+#define PROPERTY_TPM_SIMULATOR_LATENCY_UPDATE	L"TpmSimulatorLatencyUpdate"
+/// Define for the simulated TPM firmware update complete latency property string (microseconds)
+#define PROPERTY_TPM_SIMULATOR_LATENCY_COMPLETE	L"TpmSimulatorLatencyComplete"
+/// Define for the simulated TPM failure injection command code property string
+#define PROPERTY_TPM_SIMULATOR_FAIL_COMMAND		L"TpmSimulatorFailCommand"
+/// Define for the simulated TPM failure injection occurrence property string
+#define PROPERTY_TPM_SIMULATOR_FAIL_COUNT		L"TpmSimulatorFailCount"
+/// Define for the simulated TPM failure injection response code property string
+#define PROPERTY_TPM_SIMULATOR_FAIL_CODE		L"TpmSimulatorFailCode"
+/// Define for the simulated TPM interface property string (command or tis)
+#define PROPERTY_TPM_SIMULATOR_INTERFACE		L"TpmSimulatorInterface"
+/// Define for the simulated TIS register access cost property string (nanoseconds per register access)
+#define PROPERTY_TPM_SIMULATOR_REGISTER_COST	L"TpmSimulatorRegisterCost"
+/// Define for the simulated TIS burst count property string (maximum burst count reported by the TPM)
+#define PROPERTY_TPM_SIMULATOR_BURST_COUNT		L"TpmSimulatorBurstCount"
+/// Define for the simulated TIS ready delay property string (microseconds until commandReady and a locality are granted)
+#define PROPERTY_TPM_SIMULATOR_READY_DELAY		L"TpmSimulatorReadyDelay"
+/// Define for the simulated TIS data transfer size property string (DataTransferSizeSupport field of TPM_INTF_CAPABILITY, 0-3)
+#define PROPERTY_TPM_SIMULATOR_TRANSFER_SIZE	L"TpmSimulatorTransferSize"
+/// Define for the capture file property string (records all TPM commands and responses if set)
+#define PROPERTY_TPM_CAPTURE_PATH				L"TpmCapturePath"
+/// Define for the troubleshooting frames property string (0: off, 1: last TPM command, N: ring of the last N TPM commands)
+#define PROPERTY_TPM_TROUBLESHOOTING_FRAMES		L"TpmTroubleshootingFrames"
+/// Define for the troubleshooting mode property string (TRUE keeps full copies of the last TPM command and response)
+#define PROPERTY_TPM_TROUBLESHOOTING			L"TpmTroubleshooting"
+/// Define for the replay timing scale property string (percent of the recorded command durations)
+#define PROPERTY_TPM_REPLAY_TIMING_SCALE		L"TpmReplayTimingScale"
+/// Define for the socket power on property string (powers the software TPM on through its platform port if set)
+#define PROPERTY_TPM_SOCKET_POWER_ON			L"TpmSocketPowerOn"
+/// Define for the device lock timeout property string (seconds to wait for another instance using the TPM device)
+#define PROPERTY_TPM_DEVICE_LOCK_TIMEOUT		L"TpmDeviceLockTimeout"
+/// Define for the real-time transfer property string (TRUE raises the scheduling of the firmware transfer)
+#define PROPERTY_REALTIME_UPDATE				L"RealtimeUpdate"
+/// Define for the real-time transfer CPU property string (CPU the firmware transfer is pinned to)
+#define PROPERTY_REALTIME_UPDATE_CPU			L"RealtimeUpdateCpu"
+/// Define for the background property string (TRUE runs the process with idle CPU and I/O scheduling)
+#define PROPERTY_BACKGROUND						L"Background"
+/// Define for the TPM memory base property string (physical address of the TPM registers for memory based access)
+#define PROPERTY_TPM_MEMORY_BASE				L"TpmMemoryBase"
+/// Define for the TPM memory helper property string (Unix socket of TPMMemoryHelper for unprivileged memory based access)
+#define PROPERTY_TPM_MEMORY_HELPER				L"TpmMemoryHelper"
+/// Define for the SPI speed property string (SPI clock in Hz for the SPI access mode)
+#define PROPERTY_TPM_SPI_SPEED					L"TpmSpiSpeed"
+/// Define for the TPM interrupt property string (UIO device delivering the TPM interrupt for memory based access)
+#define PROPERTY_TPM_INTERRUPT					L"TpmInterrupt"
+/// Define for the TIS tuning property string (auto, calibrate or off)
+#define PROPERTY_TPM_TUNING						L"TpmTuning"
+/// File the calibrated TIS polling parameters are stored in per platform and TPM
+#define TPM_DEVICE_ACCESS_TUNING_FILE			L"/var/cache/TPMFactoryUpd_Tuning.bin"
 
 // ------------------ Global type definitions ------------------
 #ifndef BYTE
@@ -108,6 +196,19 @@ typedef unsigned long	DWORD;
 /// Size of a constant array in elements, e.g. length (not size!) of a null-terminated wide character string (incl. null-termination)
 #define RG_LEN(x) (sizeof(x) / sizeof(x[0]))
 
+// ------------ Defines for the supported TPM families ---------------
+/// TPM1.2 support compiled into the binary (1) or removed (0), e.g. by "make TPM_FAMILY=tpm20"
+#ifndef IFX_ENABLE_TPM12
+#define IFX_ENABLE_TPM12			1
+#endif
+/// TPM2.0 support compiled into the binary (1) or removed (0), e.g. by "make TPM_FAMILY=tpm12"
+#ifndef IFX_ENABLE_TPM20
+#define IFX_ENABLE_TPM20			1
+#endif
+#if !IFX_ENABLE_TPM12 && !IFX_ENABLE_TPM20
+#error At least one of IFX_ENABLE_TPM12 and IFX_ENABLE_TPM20 must be enabled.
+#endif
+
 // ------------ Defines for TIS communication ---------------
 /// Maximum number of retries in case of reading errors
 #define MAX_TPM_READ_RETRIES		3
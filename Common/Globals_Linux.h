@@ -28,6 +28,7 @@
 #define _In_z_
 #define _In_z_count_(x)
 #define _In_opt_z_count_(x)
+#define _In_reads_(x)
 #define _In_reads_z_(x)
 #define _In_reads_or_z_(x)
 #define _In_reads_bytes_(x)
@@ -36,6 +37,7 @@
 #define _Inout_
 #define _Inout_bytecap_(x)
 #define _Inout_opt_
+#define _Inout_updates_(x)
 #define _Inout_updates_z_(x)
 #define _Inout_z_
 #define _Inout_z_cap_(x)
@@ -43,6 +45,7 @@
 
 #define _Out_
 #define _Out_bytecap_(x)
+#define _Out_cap_(x)
 #define _Out_opt_bytecap_(x)
 #define _Out_opt_bytecapcount_(x)
 #define _Out_writes_bytes_all_(x)
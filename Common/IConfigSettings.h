@@ -37,6 +37,13 @@ typedef unsigned int
 	_In_							unsigned int	PunKeySize,
 	_In_z_count_(PunValueSize)		const wchar_t*	PwszValue,
 	_In_							unsigned int	PunValueSize);
+/// A type definition for function signature for reload section function
+typedef unsigned int
+(*IConfigSettings_ReloadSection) (
+	_In_z_count_(PunSectionSize)	const wchar_t*	PwszSection,
+	_In_							unsigned int	PunSectionSize,
+	_In_							BOOL			PfRemoved,
+	_Out_							BOOL*			PpfApply);
 
 /**
  *	@brief		Initialize config settings parsing
@@ -87,6 +94,27 @@ unsigned int
 ConfigSettings_FinalizeParsing(
 	_In_ unsigned int PunReturnValue);
 
+/**
+ *	@brief		Prepares the reload of a changed config section
+ *	@details	Called by Config_Reload for every section changed, added or removed since the last reload. Drops the state
+ *				derived from the section and decides whether the key value pairs of the section are passed to
+ *				ConfigSettings_Parse again.
+ *
+ *	@param		PwszSection			Pointer to a wide character array containing the section
+ *	@param		PunSectionSize		Size of the section buffer in elements including the zero termination
+ *	@param		PfRemoved			TRUE if the section has been removed from the file
+ *	@param		PpfApply			Receives TRUE if the section is re-ingested
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+ConfigSettings_ReloadSection(
+	_In_z_count_(PunSectionSize)	const wchar_t*	PwszSection,
+	_In_							unsigned int	PunSectionSize,
+	_In_							BOOL			PfRemoved,
+	_Out_							BOOL*			PpfApply);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,22 +13,170 @@
  *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdatomic.h>
+#include <stdlib.h>
 #include "Logging.h"
 #include "FileIO.h"
 #include "Config.h"
 #include "Platform.h"
 #include "Utility.h"
+#include "Session.h"
+#include "Trace.h"
+#include "Probes.h"
 
-/// Flag indicating whether to write a header into the log file or not
-BOOL g_fLogHeader = TRUE;
+/// Highest logging level of PROPERTY_LOGGING_LEVEL and PROPERTY_LOGGING_MODULE_LEVELS, kept up to date by the PropertyStorage.
+/// Messages passing this inline check are filtered by the level of their module afterwards.
+unsigned int g_unLoggingLevel = LOGGING_DISABLED;
 
-/// Flag indicating whether logging is already ongoing
-BOOL s_fInLogging = FALSE;
+/// Logging level of a module configured by PROPERTY_LOGGING_MODULE_LEVELS
+typedef struct tdIfxLoggingModuleLevel
+{
+	/// Module name in lower case (source file name without path and extension)
+	char szModule[LOGGING_MAX_MODULE_NAME];
+	/// Logging level of the module
+	unsigned int unLevel;
+} IfxLoggingModuleLevel;
+
+/// Cached value of PROPERTY_LOGGING_LEVEL, used for the modules without a module level
+static unsigned int s_unDefaultLoggingLevel = LOGGING_DISABLED;
+
+/// Parsed module levels of PROPERTY_LOGGING_MODULE_LEVELS
+static IfxLoggingModuleLevel s_rgModuleLevels[LOGGING_MAX_MODULE_LEVELS];
+
+/// Number of entries in s_rgModuleLevels
+static unsigned int s_unModuleLevelCount = 0;
+
+/// Data of a LOGGING_RECORD_COMMAND entry
+typedef struct tdIfxLoggingCommand
+{
+	/// TPM command ordinal
+	unsigned int unOrdinal;
+	/// TPM response code or error code of the transmission
+	unsigned int unResponseCode;
+	/// Duration of the command in microseconds
+	unsigned long long ullDuration;
+} IfxLoggingCommand;
+
+/// Record header of an entry in the ring buffer of the asynchronous log writer
+typedef struct tdIfxLoggingRecord
+{
+	/// Size of the record including header, data and alignment in bytes (must be the first field)
+	unsigned int unRecordSize;
+	/// Record type LOGGING_RECORD_MESSAGE, LOGGING_RECORD_HEX or LOGGING_RECORD_PADDING (must be the second field)
+	unsigned int unRecordType;
+	/// Configured logging level at the time the entry was logged
+	unsigned int unLoggingLevel;
+	/// Logging level of the entry
+	unsigned int unMessageLevel;
+	/// Size of the data following the header in bytes
+	unsigned int unDataSize;
+	/// Number of entries dropped before this one
+	unsigned int unDroppedCount;
+	/// Flag indicating whether to flush the log file after the entry
+	BOOL fFlush;
+	/// Module name (string literal)
+	const char* szModule;
+	/// Function name (string literal)
+	const char* szFunction;
+	/// Time stamp of the entry
+	wchar_t wszTimeStamp[TIMESTAMP_LENGTH];
+} IfxLoggingRecord;
+
+/**
+ *	@brief		Log sink
+ *	@details	A log file with a state of its own: the open file, its rotation, the line buffers and the ring buffer of the
+ *				asynchronous log writer. The default sink writes the log file of PROPERTY_LOGGING_PATH, a session sink (see
+ *				Logging_OpenSessionSink) the log file it has been opened for. A sink is written by the thread of its session
+ *				or, while it is registered with the asynchronous log writer, by the log writer only. Sinks do not share a
+ *				file or a buffer, so the threads logging to different sinks never wait for each other.
+ */
+struct tdIfxLoggingSink
+{
+	/// Handle of the log file, kept open between messages
+	void* pLogFile;
+	/// Path of the log file pLogFile has been opened for
+	wchar_t wszLogFilePath[MAX_STRING_1024];
+	/// Log file path of a session sink, empty for the default sink
+	wchar_t wszSinkPath[MAX_STRING_1024];
+	/// Flag indicating whether the header has been written to the log file
+	BOOL fHeaderWritten;
+	/// Interval in microseconds after which buffered messages are flushed to the log file
+	unsigned long long ullFlushInterval;
+	/// Monotonic time stamp of the last flush of the log file
+	unsigned long long ullLastFlushTime;
+	/// Flag indicating whether the log writer has written entries since the last flush
+	BOOL fUnflushed;
+	/// Number of bytes in the log file, tracked while writing (only maintained if ullLogFileMaxSize is not 0)
+	unsigned long long ullLogFileSize;
+	/// Maximum log file size in bytes before the log file is rotated, 0 for unlimited
+	unsigned long long ullLogFileMaxSize;
+	/// Number of rotated log files to keep, 0 to overwrite the log file instead
+	unsigned int unLogFileMaxFiles;
+	/// Flag indicating whether rotated log files are compressed to <log-file>.N.gz (PROPERTY_LOGGING_COMPRESS)
+	BOOL fLogCompress;
+	/// Handle of the thread compressing the latest rotated log file, NULL if no compression is running
+	void* pCompressThread;
+	/// Path of the rotated log file compressed by pCompressThread (<log-file>.1)
+	wchar_t wszCompressPath[MAX_STRING_1024];
+	/// Flag indicating whether log lines are written as JSON records (PROPERTY_LOGGING_JSON)
+	BOOL fLogJson;
+	/// Buffer composing a log line, so the buffers are not placed on the stack of every logging thread
+	wchar_t wszComposedLine[TIMESTAMP_LENGTH + 2 * MAX_NAME + MAX_MESSAGE_SIZE + 8];
+	/// Buffer holding the escaped line of a JSON record
+	wchar_t wszEscapedLine[MAX_MESSAGE_SIZE];
+	/// Ring buffer of the asynchronous log writer (LOGGING_ASYNC_BUFFER_SIZE bytes), NULL if the sink is written synchronously
+	BYTE* rgbAsyncBuffer;
+	/// Flag indicating whether the sink is registered with the asynchronous log writer
+	BOOL fAsync;
+	/// Ring buffer write position (only advanced by the logging thread)
+	atomic_ullong ullAsyncHead;
+	/// Ring buffer read position (only advanced by the log writer)
+	atomic_ullong ullAsyncTail;
+	/// Request to the log writer to flush the log file after writing all pending records
+	atomic_int nAsyncFlushRequest;
+	/// Request to the log writer to close the log file and to release the sink after writing all pending records (1),
+	/// set to 2 by the log writer once the sink has been released
+	atomic_int nAsyncRelease;
+	/// Number of entries dropped since the last stored record
+	unsigned int unAsyncDropped;
+};
+
+/// Default sink writing the log file of PROPERTY_LOGGING_PATH, used by the sessions without a sink of their own
+static IfxLoggingSink s_sDefaultSink;
+
+/// Sinks registered with the asynchronous log writer, NULL for a free slot
+static _Atomic(IfxLoggingSink*) s_rgpAsyncSinks[LOGGING_MAX_SINKS];
+
+/// Handle of the asynchronous log writer thread, NULL if all sinks are written synchronously
+static void* s_pAsyncThread = NULL;
+
+/// Request to the log writer to finish after writing all pending records
+static atomic_int s_nAsyncStop;
+
+/// Signal of the log writer that it has finished
+static atomic_int s_nAsyncFinished;
+
+/// Flag indicating whether the exit and termination handlers have been registered
+static BOOL s_fAsyncHandlersRegistered = FALSE;
+
+/**
+ *	@brief		Returns the log sink of the calling thread
+ *	@details	The sink of the session bound to the calling thread, the default sink for a session without a sink of its own.
+ *	@returns	The log sink, never NULL.
+ */
+static IfxLoggingSink*
+Logging_GetSink()
+{
+	IfxLoggingSink* pSink = Session_GetCurrent()->pLogSink;
+
+	return NULL != pSink ? pSink : &s_sDefaultSink;
+}
 
 /**
  *	@brief		This function writes the logging header to the log file, if it is the first call of the current instance.
- *	@details
+ *	@details	In case PROPERTY_LOGGING_JSON is set, the header is written as JSON record.
  *
+ *	@param		PpSink					Log sink the header is written for
  *	@param		PfFileExists			Flag if the log file exists
  *	@param		PpFileHandle			Log file handle
  *	@retval		RC_SUCCESS				The operation completed successfully.
@@ -39,8 +187,9 @@ BOOL s_fInLogging = FALSE;
 _Check_return_
 unsigned int
 Logging_WriteHeader(
-	_In_	BOOL	PfFileExists,
-	_In_	void*	PpFileHandle)
+	_Inout_	IfxLoggingSink*	PpSink,
+	_In_	BOOL			PfFileExists,
+	_In_	void*			PpFileHandle)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
@@ -50,14 +199,28 @@ Logging_WriteHeader(
 		unsigned int unTimeStampSize = RG_LEN(wszTimeStamp);
 
 		// Check parameter
-		if (NULL == PpFileHandle)
+		if (NULL == PpSink || NULL == PpFileHandle)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
 		// Write header in case this is the first log entry in the current application execution run
-		if (TRUE == g_fLogHeader)
+		if (FALSE == PpSink->fHeaderWritten && TRUE == PpSink->fLogJson)
+		{
+			// Write header as JSON record
+			unReturnValue = Utility_GetTimestamp(TRUE, wszTimeStamp, &unTimeStampSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			unReturnValue = FileIO_WriteStringf(PpFileHandle, L"{\"time\":\"%.*ls\",\"tool\":\"%ls\",\"version\":\"%ls\"}\n",
+								unTimeStampSize > 2 ? (int)unTimeStampSize - 2 : 0, &wszTimeStamp[1], TOOL_NAME, APP_VERSION);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			PpSink->fHeaderWritten = TRUE;
+		}
+		else if (FALSE == PpSink->fHeaderWritten)
 		{
 			if (TRUE == PfFileExists)
 			{
@@ -78,7 +241,7 @@ Logging_WriteHeader(
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
-			g_fLogHeader = FALSE;
+			PpSink->fHeaderWritten = TRUE;
 		}
 
 		unReturnValue = RC_SUCCESS;
@@ -88,12 +251,139 @@ Logging_WriteHeader(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Compresses the latest rotated log file
+ *	@details	Thread function started by Logging_RotateFile. Compresses the wszCompressPath of the sink to <log-file>.1.gz and
+ *				removes the uncompressed file afterwards. In case of an error the uncompressed file is kept.
+ *				Must not write log messages since it runs concurrently to the log writer.
+ *
+ *	@param		PpvContext				Log sink whose rotated log file is compressed
+ */
+static void
+Logging_CompressRotatedFile(
+	_In_opt_ void* PpvContext)
+{
+	wchar_t wszGzipPath[MAX_STRING_1024] = {0};
+	unsigned int unGzipPathSize = RG_LEN(wszGzipPath);
+
+	IfxLoggingSink* pSink = (IfxLoggingSink*)PpvContext;
+
+	if (NULL == pSink)
+		return;
+
+	if (RC_SUCCESS == Platform_StringFormat(wszGzipPath, &unGzipPathSize, L"%ls.gz", pSink->wszCompressPath) &&
+		RC_SUCCESS == FileIO_CompressFile(pSink->wszCompressPath, wszGzipPath))
+	{
+		IGNORE_RETURN_VALUE(FileIO_Remove(pSink->wszCompressPath));
+	}
+}
+
+/**
+ *	@brief		Waits for the compression of the latest rotated log file
+ *	@details	Nothing is done if no compression is running.
+ *
+ *	@param		PpSink					Log sink whose compression is awaited
+ */
+static void
+Logging_WaitForCompression(
+	_Inout_ IfxLoggingSink* PpSink)
+{
+	if (NULL != PpSink->pCompressThread)
+	{
+		IGNORE_RETURN_VALUE(Platform_ThreadJoin(&PpSink->pCompressThread));
+		PpSink->pCompressThread = NULL;
+	}
+}
+
+/**
+ *	@brief		This function rotates the logging file
+ *	@details	The rotated log files are renamed from <log-file>.N-1 to <log-file>.N down to <log-file> to <log-file>.1,
+ *				so the oldest one is overwritten. Afterwards the log file is recreated empty. In case no rotated log
+ *				files are kept, the log file is just overwritten. Renaming errors (e.g. missing files) are ignored.
+ *				In case PROPERTY_LOGGING_COMPRESS is set, <log-file>.1 is compressed to <log-file>.1.gz by a background
+ *				thread, so rotating does not stall logging. The active log file always stays uncompressed.
+ *
+ *	@param		PpSink					Log sink the log file is rotated for
+ *	@param		PwszLoggingFilePath		Path of the log file
+ *	@param		PppFileHandle			Pointer to store the file handle of the recreated log file to
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_RotateFile(
+	_Inout_	IfxLoggingSink*	PpSink,
+	_In_z_	const wchar_t*	PwszLoggingFilePath,
+	_Inout_	void**			PppFileHandle)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszOldPath[MAX_STRING_1024] = {0};
+		wchar_t wszNewPath[MAX_STRING_1024] = {0};
+		unsigned int unIndex = 0;
+
+		// The previous rotated log file must be compressed before it is shifted
+		Logging_WaitForCompression(PpSink);
+
+		// Shift <log-file>.N-1 ... <log-file>.1 to <log-file>.N ... <log-file>.2
+		// (compressed ones as well, uncompressed ones are left over in case their compression failed)
+		for (unIndex = PpSink->unLogFileMaxFiles; unIndex > 1; unIndex--)
+		{
+			unsigned int unOldPathSize = RG_LEN(wszOldPath);
+			unsigned int unNewPathSize = RG_LEN(wszNewPath);
+			if (RC_SUCCESS == Platform_StringFormat(wszOldPath, &unOldPathSize, L"%ls.%u", PwszLoggingFilePath, unIndex - 1) &&
+				RC_SUCCESS == Platform_StringFormat(wszNewPath, &unNewPathSize, L"%ls.%u", PwszLoggingFilePath, unIndex))
+				IGNORE_RETURN_VALUE(FileIO_Rename(wszOldPath, wszNewPath));
+
+			unOldPathSize = RG_LEN(wszOldPath);
+			unNewPathSize = RG_LEN(wszNewPath);
+			if (TRUE == PpSink->fLogCompress &&
+				RC_SUCCESS == Platform_StringFormat(wszOldPath, &unOldPathSize, L"%ls.%u.gz", PwszLoggingFilePath, unIndex - 1) &&
+				RC_SUCCESS == Platform_StringFormat(wszNewPath, &unNewPathSize, L"%ls.%u.gz", PwszLoggingFilePath, unIndex))
+				IGNORE_RETURN_VALUE(FileIO_Rename(wszOldPath, wszNewPath));
+		}
+
+		// Move the full log file to <log-file>.1
+		if (0 != PpSink->unLogFileMaxFiles)
+		{
+			unsigned int unNewPathSize = RG_LEN(wszNewPath);
+			if (RC_SUCCESS == Platform_StringFormat(wszNewPath, &unNewPathSize, L"%ls.1", PwszLoggingFilePath) &&
+				RC_SUCCESS == FileIO_Rename(PwszLoggingFilePath, wszNewPath) &&
+				TRUE == PpSink->fLogCompress)
+			{
+				// Compress it in the background, compress it directly if the thread cannot be started
+				unsigned int unCompressPathSize = RG_LEN(PpSink->wszCompressPath);
+				if (RC_SUCCESS == Platform_StringCopy(PpSink->wszCompressPath, &unCompressPathSize, wszNewPath) &&
+					RC_SUCCESS != Platform_ThreadCreate(Logging_CompressRotatedFile, PpSink, &PpSink->pCompressThread))
+				{
+					PpSink->pCompressThread = NULL;
+					Logging_CompressRotatedFile(PpSink);
+				}
+			}
+		}
+
+		// Recreate the log file (overwrites it in case it has not been moved)
+		PpSink->ullLogFileSize = 0;
+		unReturnValue = FileIO_Open(PwszLoggingFilePath, PppFileHandle, FILE_WRITE);
+		if (RC_SUCCESS == unReturnValue && NULL == *PppFileHandle)
+			unReturnValue = RC_E_FAIL;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		This function opens the logging file
  *	@details	This function opens the logging file, by append an existing or create a new one.
- *				It also checks the file size, if the property storage flag PROPERTY_LOGGING_CHECK_SIZE is set.
- *				In case of the maximum file size is reached the function reopens the file by using override flag.
+ *				In case a maximum file size is configured, the size of an existing file is queried once to initialize
+ *				the tracked log file size. If the maximum file size is already reached the log file is rotated.
  *
+ *	@param		PpSink					Log sink the log file is opened for
+ *	@param		PwszLoggingFilePath		Path of the log file
  *	@param		PppFileHandle			Pointer to store the file handle to. Must be closed by caller in any case.
  *	@param		PpfFileExists			Pointer to store the file exists flag
  *	@retval		RC_SUCCESS				The operation completed successfully.
@@ -104,16 +394,16 @@ Logging_WriteHeader(
 _Check_return_
 unsigned int
 Logging_OpenFile(
-	_Inout_	void**	PppFileHandle,
-	_Out_	BOOL*	PpfFileExists)
+	_Inout_	IfxLoggingSink*	PpSink,
+	_In_z_	const wchar_t*	PwszLoggingFilePath,
+	_Inout_	void**			PppFileHandle,
+	_Out_	BOOL*			PpfFileExists)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	do
 	{
-		wchar_t wszLoggingFilePath[MAX_STRING_1024] = {0};
-		unsigned int unLoggingFilePathBufferSize = RG_LEN(wszLoggingFilePath);
-		BOOL fFlag = FALSE;
+		unsigned int unMaxFileSize = 0;
 
 		// Check out parameter
 		if (NULL == PpfFileExists)
@@ -126,76 +416,58 @@ Logging_OpenFile(
 		*PpfFileExists = FALSE;
 
 		// Check in/out parameter
-		if (NULL == PppFileHandle || NULL != *PppFileHandle)
+		if (NULL == PpSink || NULL == PwszLoggingFilePath || NULL == PppFileHandle || NULL != *PppFileHandle)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
 
-		// Get logging file path
-		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_PATH, wszLoggingFilePath, &unLoggingFilePathBufferSize))
-		{
-			unReturnValue = RC_E_FAIL;
-			break;
-		}
-
 		// Check first if file exists and open it in the corresponding mode
-		if (FileIO_Exists(wszLoggingFilePath))
+		if (FileIO_Exists(PwszLoggingFilePath))
 		{
 			*PpfFileExists = TRUE;
-			unReturnValue = FileIO_Open(wszLoggingFilePath, PppFileHandle, FILE_APPEND);
+			unReturnValue = FileIO_Open(PwszLoggingFilePath, PppFileHandle, FILE_APPEND);
 		}
 		else
-			unReturnValue = FileIO_Open(wszLoggingFilePath, PppFileHandle, FILE_WRITE);
+			unReturnValue = FileIO_Open(PwszLoggingFilePath, PppFileHandle, FILE_WRITE);
 
 		if (RC_SUCCESS != unReturnValue || NULL == *PppFileHandle)
 			break;
 
-		// Check if PROPERTY_LOGGING_CHECK_SIZE flag is set in PropertyStorage
-		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_LOGGING_CHECK_SIZE, &fFlag) &&
-				TRUE == fFlag)
+		// Get maximum log file size (0 == unlimited) and number of rotated log files
+		if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_LOGGING_MAXSIZE, &unMaxFileSize))
 		{
-			unsigned int unMaxFileSize = 0;
-			unsigned long long ullFileSize = 0;
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_LOGGING_MAX_FILES, &PpSink->unLogFileMaxFiles))
+			PpSink->unLogFileMaxFiles = 0;
+		if (FALSE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_LOGGING_COMPRESS, &PpSink->fLogCompress))
+			PpSink->fLogCompress = FALSE;
+		PpSink->ullLogFileMaxSize = (unsigned long long)unMaxFileSize * DIV_KILOBYTE;
+		PpSink->ullLogFileSize = 0;
 
-			// Get maximum log file size
-			if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOGGING_MAXSIZE, &unMaxFileSize))
-			{
-				unReturnValue = RC_E_FAIL;
+		// Query the size of an existing log file only once, it is tracked while writing afterwards
+		if (0 != PpSink->ullLogFileMaxSize && TRUE == *PpfFileExists)
+		{
+			unReturnValue = FileIO_GetFileSize(*PppFileHandle, &PpSink->ullLogFileSize);
+			if (RC_SUCCESS != unReturnValue)
 				break;
-			}
 
-			// Do actual size check only in case max log file size is not 0 (== unlimited)
-			if (0 != unMaxFileSize)
+			// Rotate the log file if the maximum size is already reached
+			if (PpSink->ullLogFileSize >= PpSink->ullLogFileMaxSize)
 			{
-				// Get file size of actual logging file
-				unReturnValue = FileIO_GetFileSize(*PppFileHandle, &ullFileSize);
+				// Close log file (since it has been opened in append mode)
+				unReturnValue = FileIO_Close(PppFileHandle);
 				if (RC_SUCCESS != unReturnValue)
 					break;
 
-				// Check log file size limit and reopen file to overwrite it if necessary
-				if (unMaxFileSize <= (unsigned int)(ullFileSize / DIV_KILOBYTE))
-				{
-					// Close log file (since it has been opened in append mode)
-					unReturnValue = FileIO_Close(PppFileHandle);
-					if (RC_SUCCESS != unReturnValue)
-						break;
-
-					// Reopen it (now in write mode)
-					unReturnValue = FileIO_Open(wszLoggingFilePath, PppFileHandle, FILE_WRITE);
-					if (RC_SUCCESS != unReturnValue || NULL == *PppFileHandle)
-						break;
-
-					*PpfFileExists = FALSE;
-					g_fLogHeader = TRUE;
-				}
-			}
+				unReturnValue = Logging_RotateFile(PpSink, PwszLoggingFilePath, PppFileHandle);
+				if (RC_SUCCESS != unReturnValue || NULL == *PppFileHandle)
+					break;
 
-			// Reset property for enabling log file size check
-			if (FALSE == PropertyStorage_ChangeBooleanValueByKey(PROPERTY_LOGGING_CHECK_SIZE, FALSE))
-			{
-				unReturnValue = RC_E_FAIL;
-				break;
+				*PpfFileExists = FALSE;
+				PpSink->fHeaderWritten = FALSE;
 			}
 		}
 	}
@@ -205,17 +477,35 @@ Logging_OpenFile(
 }
 
 /**
- *	@brief		This writes a message to the log file
- *	@details	This function handles the logging work flow and writes a given message line by line to the
- *				logging file.
- *				It also checks the file size, if the property storage flag PROPERTY_LOGGING_CHECK_SIZE is set.
- *				In case of the maximum file size is reached the function reopens the file by using override flag.
+ *	@brief		This function closes the log file of a sink
+ *	@details	Waits for a running compression of the latest rotated log file. The header is written again
+ *				to the next log file opened for the sink.
  *
- *	@param		PszCurrentModule		Character string containing the current module name
- *	@param		PszCurrentFunction		Character string containing the current function name
- *	@param		PunLoggingLevel			Actual configured logging level
- *	@param		PwszMessage				Wide character string containing the message to log
- *	@param		PunMessageSize			Message size including the zero termination
+ *	@param		PpSink					Log sink whose log file is closed
+ */
+static void
+Logging_CloseSinkFile(
+	_Inout_ IfxLoggingSink* PpSink)
+{
+	if (NULL != PpSink->pLogFile)
+	{
+		IGNORE_RETURN_VALUE(FileIO_Close(&PpSink->pLogFile));
+		PpSink->pLogFile = NULL;
+	}
+	PpSink->wszLogFilePath[0] = L'\0';
+	PpSink->fHeaderWritten = FALSE;
+	PpSink->fUnflushed = FALSE;
+	Logging_WaitForCompression(PpSink);
+}
+
+/**
+ *	@brief		This function returns the handle of the log file of a sink
+ *	@details	The log file is opened, size checked and provided with the header only once and then kept open.
+ *				A session sink writes to its own log file path, the default sink to PROPERTY_LOGGING_PATH.
+ *				In case the configured log file path has changed since, the current log file is closed and the new one is opened.
+ *
+ *	@param		PpSink					Log sink to return the log file for
+ *	@param		PppFileHandle			Pointer to store the file handle to. Must not be closed by caller.
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_FAIL				An unexpected error occurred.
  *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. The parameter is NULL
@@ -223,227 +513,965 @@ Logging_OpenFile(
  */
 _Check_return_
 unsigned int
-Logging_WriteMessage(
-	_In_z_							const char*		PszCurrentModule,
-	_In_z_							const char*		PszCurrentFunction,
-	_In_							unsigned int	PunLoggingLevel,
-	_In_z_count_(PunMessageSize)	wchar_t*		PwszMessage,
-	_In_							unsigned int	PunMessageSize)
+Logging_GetFile(
+	_Inout_						IfxLoggingSink*	PpSink,
+	_Outptr_result_maybenull_	void**			PppFileHandle)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
-	// If logging is already ongoing avoid endless recursion
-	if (FALSE == s_fInLogging)
+	do
 	{
-		void* pFile = NULL;
-		wchar_t* wszLine = NULL;
-
-		// Signal that logging has been started
-		s_fInLogging = TRUE;
+		wchar_t wszLoggingFilePath[MAX_STRING_1024] = {0};
+		unsigned int unLoggingFilePathBufferSize = RG_LEN(wszLoggingFilePath);
+		unsigned int unFlushInterval = 0;
+		BOOL fFileExists = FALSE;
 
-		do
+		// Check parameters
+		if (NULL == PpSink || NULL == PppFileHandle)
 		{
-			BOOL fFileExists = FALSE;
-			wchar_t wszTimeStamp[TIMESTAMP_LENGTH] = {0};
-			unsigned int unTimeStampSize = RG_LEN(wszTimeStamp);
-			unsigned int unIndex = 0;
-
-			// Check main parameter
-			if (NULL == PwszMessage)
-			{
-				unReturnValue = RC_E_BAD_PARAMETER;
-				break;
-			}
-
-			// Retrieve current wszTimeStamp without date here
-			unReturnValue = Utility_GetTimestamp(FALSE, wszTimeStamp, &unTimeStampSize);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-
-			// Try to open the log file
-			unReturnValue = Logging_OpenFile(&pFile, &fFileExists);
-			if (RC_SUCCESS != unReturnValue || NULL == pFile)
-				break;
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppFileHandle = NULL;
 
-			// Write header if necessary
-			unReturnValue = Logging_WriteHeader(fFileExists, pFile);
+		// Get logging file path
+		if (L'\0' != PpSink->wszSinkPath[0])
+		{
+			unReturnValue = Platform_StringCopy(wszLoggingFilePath, &unLoggingFilePathBufferSize, PpSink->wszSinkPath);
 			if (RC_SUCCESS != unReturnValue)
 				break;
+		}
+		else if (FALSE == PropertyStorage_GetValueById(PROPERTY_ID_LOGGING_PATH, wszLoggingFilePath, &unLoggingFilePathBufferSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
 
-			// Log the message line by line
-			do
+		// Reuse the open log file as long as the path is unchanged
+		if (NULL != PpSink->pLogFile)
+		{
+			if (0 == Platform_StringCompare(wszLoggingFilePath, PpSink->wszLogFilePath, RG_LEN(PpSink->wszLogFilePath), FALSE))
 			{
-				unsigned int unLineSize = 0;
-
-				// Free allocated memory
-				Platform_MemoryFree((void**)&wszLine);
-
-				// Get the one line
-				unReturnValue = Utility_StringGetLine(PwszMessage, PunMessageSize, &unIndex, &wszLine, &unLineSize);
-				if (RC_SUCCESS != unReturnValue)
-				{
-					if (RC_E_END_OF_STRING != unReturnValue)
-						ERROR_STORE(unReturnValue, L"Utility_StringGetLine returned an unexpected value.");
-					else
-						unReturnValue = RC_SUCCESS;
-
-					break;
-				}
+				*PppFileHandle = PpSink->pLogFile;
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
 
-				// For logging level 3 and 4, also write time-stamp to log file
-				if (PunLoggingLevel >= LOGGING_LEVEL_3)
-				{
-					unReturnValue = FileIO_WriteStringf(pFile, L"%ls ", wszTimeStamp);
-					if (RC_SUCCESS != unReturnValue)
-						break;
-				}
+			Logging_CloseSinkFile(PpSink);
+		}
 
-				// For logging level 4, also write module and function name to log file
-				// If the module or function name is not set omit it
-				if (PunLoggingLevel >= LOGGING_LEVEL_4)
-				{
-					// Convert module and function name from ANSI to Unicode
-					wchar_t wszCurrentModule[MAX_NAME] = {0};
-					wchar_t wszCurrentModuleNormalized[MAX_NAME] = {0};
-					wchar_t wszCurrentFunction[MAX_NAME] = {0};
-
-					unReturnValue = Platform_AnsiString2UnicodeString(wszCurrentModule, RG_LEN(wszCurrentModule), PszCurrentModule);
-					if (RC_SUCCESS == unReturnValue)
-					{
-						unsigned int unCurrentModuleNormalizedLen = RG_LEN(wszCurrentModuleNormalized);
-						wchar_t* pwszStart = NULL;
-						// Find first occurence of L"TPMToolsUEFIPkg\\" and remove everything before ...
-						if (Platform_FindString(L"TPMToolsUEFIPkg\\", wszCurrentModule, &pwszStart) == RC_SUCCESS)
-						{
-							unReturnValue = Platform_StringCopy(wszCurrentModuleNormalized, &unCurrentModuleNormalizedLen, pwszStart);
-							if (RC_SUCCESS != unReturnValue)
-								break;
-						}
-						else
-						{
-							unReturnValue = Platform_StringCopy(wszCurrentModuleNormalized, &unCurrentModuleNormalizedLen, wszCurrentModule);
-							if (RC_SUCCESS != unReturnValue)
-								break;
-						}
-					}
-
-					if (RC_SUCCESS == unReturnValue)
-						unReturnValue = Platform_AnsiString2UnicodeString(wszCurrentFunction, RG_LEN(wszCurrentFunction), PszCurrentFunction);
-
-					if ((RC_SUCCESS == unReturnValue) && !PLATFORM_STRING_IS_NULL_OR_EMPTY(wszCurrentModuleNormalized) && !PLATFORM_STRING_IS_NULL_OR_EMPTY(wszCurrentFunction))
-					{
-						unReturnValue = FileIO_WriteStringf(pFile, L"%ls - %ls - ", wszCurrentModuleNormalized, wszCurrentFunction);
-						if (RC_SUCCESS != unReturnValue)
-							break;
-					}
-				}
+		// Try to open the log file
+		unReturnValue = Logging_OpenFile(PpSink, wszLoggingFilePath, &PpSink->pLogFile, &fFileExists);
+		if (RC_SUCCESS != unReturnValue || NULL == PpSink->pLogFile)
+		{
+			if (NULL != PpSink->pLogFile)
+				IGNORE_RETURN_VALUE(FileIO_Close(&PpSink->pLogFile));
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = RC_E_FAIL;
+			break;
+		}
 
-				// Skip empty lines
-				if (wszLine[0] != L'\0')
-				{
-					unReturnValue = FileIO_WriteString(pFile, wszLine);
-					if (RC_SUCCESS != unReturnValue)
-						break;
-				}
+		// Get log line format (text if it is not configured)
+		if (FALSE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_LOGGING_JSON, &PpSink->fLogJson))
+			PpSink->fLogJson = FALSE;
 
-				// Add new line before logging the next line.
-				// Needs \n as format string so it will be auto-converted to \r\n on UEFI.
-				unReturnValue = FileIO_WriteStringf(pFile, L"\n");
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-			WHILE_TRUE_END;
+		// Write header if necessary
+		unReturnValue = Logging_WriteHeader(PpSink, fFileExists, PpSink->pLogFile);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			IGNORE_RETURN_VALUE(FileIO_Close(&PpSink->pLogFile));
+			break;
 		}
-		WHILE_FALSE_END;
 
-		// Close file if it is open
-		if (NULL != pFile)
-			unReturnValue = FileIO_Close(&pFile);
+		unLoggingFilePathBufferSize = RG_LEN(PpSink->wszLogFilePath);
+		unReturnValue = Platform_StringCopy(PpSink->wszLogFilePath, &unLoggingFilePathBufferSize, wszLoggingFilePath);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			IGNORE_RETURN_VALUE(FileIO_Close(&PpSink->pLogFile));
+			break;
+		}
 
-		// Free allocated memory
-		Platform_MemoryFree((void**)&wszLine);
+		// Get flush interval (flush every message if it is not configured)
+		if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_LOGGING_FLUSH_INTERVAL, &unFlushInterval))
+			unFlushInterval = 0;
+		PpSink->ullFlushInterval = (unsigned long long)unFlushInterval * 1000;
+		PpSink->ullLastFlushTime = Platform_GetMonotonicTimeMicroSeconds();
 
-		// Signal that logging is finished
-		s_fInLogging = FALSE;
+		*PppFileHandle = PpSink->pLogFile;
 	}
+	WHILE_FALSE_END;
 
 	return unReturnValue;
 }
 
 /**
- *	@brief		Logging function
- *	@details	Writes the given text into the configured log
+ *	@brief		This function rotates the open log file of a sink if the maximum log file size has been reached
+ *	@details	Only compares the tracked log file size, the file itself is not queried. After rotating, the header is
+ *				written to the new log file. In case of an error the log file is dropped and reopened with the next message.
  *
- *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
- *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
- *	@param		PunLoggingLevel			Logging level
- *	@param		PwszLoggingMessage		Format string used to format the message
- *	@param		...						Parameters needed to format the message
+ *	@param		PpSink					Log sink whose log file is checked
  */
 void
-Logging_WriteLog(
-	_In_z_	const char*		PszCurrentModule,
-	_In_z_	const char*		PszCurrentFunction,
-	_In_	unsigned int	PunLoggingLevel,
-	_In_z_	const wchar_t*	PwszLoggingMessage,
-	...)
+Logging_RotateIfFull(
+	_Inout_ IfxLoggingSink* PpSink)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	unsigned int unConfiguredLoggingLevel = 0;
-
-	do
+	if (NULL != PpSink->pLogFile && 0 != PpSink->ullLogFileMaxSize && PpSink->ullLogFileSize >= PpSink->ullLogFileMaxSize)
 	{
-		// Get Logging level
-		if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOGGING_LEVEL, &unConfiguredLoggingLevel))
-			break;
+		// Close the file (this also flushes the buffer) and drop the handle in any case
+		IGNORE_RETURN_VALUE(FileIO_Close(&PpSink->pLogFile));
+		PpSink->pLogFile = NULL;
 
-		if (PunLoggingLevel <= unConfiguredLoggingLevel)
+		if (RC_SUCCESS != Logging_RotateFile(PpSink, PpSink->wszLogFilePath, &PpSink->pLogFile) || NULL == PpSink->pLogFile)
 		{
-			va_list argptr;
-
-			// Write log message with variable arguments to log file
-			// Get pointer to variable arguments
-			if (NULL != PwszLoggingMessage)
-			{
-				wchar_t wszMessage[MAX_MESSAGE_SIZE] = {0};
-				unsigned int unMessageSize = RG_LEN(wszMessage);
-
-				// Skip formating if a empty line should be written
-				if (PwszLoggingMessage[0] != L'\0')
-				{
-					// Format message
-					va_start(argptr, PwszLoggingMessage);
-					unReturnValue = Platform_StringFormatV(wszMessage, &unMessageSize, PwszLoggingMessage, argptr);
-					va_end(argptr);
-					if (RC_SUCCESS != unReturnValue)
-						break;
-				}
-				else
-					unMessageSize = 0;
-
-				// Write actual message line by line
-				unReturnValue = Logging_WriteMessage(
-									PszCurrentModule,
-									PszCurrentFunction,
-									unConfiguredLoggingLevel,
-									wszMessage, unMessageSize + 1);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
+			if (NULL != PpSink->pLogFile)
+				IGNORE_RETURN_VALUE(FileIO_Close(&PpSink->pLogFile));
+			PpSink->pLogFile = NULL;
+			PpSink->wszLogFilePath[0] = L'\0';
+			return;
 		}
+
+		PpSink->fHeaderWritten = FALSE;
+		IGNORE_RETURN_VALUE(Logging_WriteHeader(PpSink, FALSE, PpSink->pLogFile));
 	}
-	WHILE_FALSE_END;
 }
 
 /**
- *	@brief		Log hex dump function
- *	@details	Writes the given data as hex dump to the file
+ *	@brief		This function converts the module and function name for the log file
+ *	@details	Everything before the package directory is removed from the module name.
+ *				In case of an error the names are returned empty and are omitted in the log file.
  *
- *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
- *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
- *	@param		PunLoggingLevel			Logging level
- *	@param		PrgbHexData				Format string used to format the message
- *	@param		PunSize					Size of hex data buffer
+ *	@param		PszCurrentModule		Character string containing the current module name
+ *	@param		PszCurrentFunction		Character string containing the current function name
+ *	@param		PwszModule				Buffer with MAX_NAME elements to store the module name to
+ *	@param		PwszFunction			Buffer with MAX_NAME elements to store the function name to
+ */
+void
+Logging_ConvertNames(
+	_In_z_					const char*		PszCurrentModule,
+	_In_z_					const char*		PszCurrentFunction,
+	_Out_z_cap_(MAX_NAME)	wchar_t*		PwszModule,
+	_Out_z_cap_(MAX_NAME)	wchar_t*		PwszFunction)
+{
+	PwszModule[0] = L'\0';
+	PwszFunction[0] = L'\0';
+
+	do
+	{
+		wchar_t wszCurrentModule[MAX_NAME] = {0};
+		unsigned int unModuleSize = MAX_NAME;
+		wchar_t* pwszStart = NULL;
+
+		// Convert module and function name from ANSI to Unicode
+		if (RC_SUCCESS != Platform_AnsiString2UnicodeString(wszCurrentModule, RG_LEN(wszCurrentModule), PszCurrentModule))
+			break;
+
+		// Find first occurence of L"TPMToolsUEFIPkg\\" and remove everything before ...
+		if (RC_SUCCESS != Platform_FindString(L"TPMToolsUEFIPkg\\", wszCurrentModule, &pwszStart))
+			pwszStart = wszCurrentModule;
+
+		if (RC_SUCCESS != Platform_StringCopy(PwszModule, &unModuleSize, pwszStart))
+		{
+			PwszModule[0] = L'\0';
+			break;
+		}
+
+		if (RC_SUCCESS != Platform_AnsiString2UnicodeString(PwszFunction, MAX_NAME, PszCurrentFunction))
+			PwszFunction[0] = L'\0';
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		This function writes one line to the log file as JSON record
+ *	@details	The record is written on a line of its own and contains the time stamp (logging level 3 and 4), the logging
+ *				level of the entry, the module and function name (logging level 4), the line and the TPM command data.
+ *				Lines not fitting into the record after escaping are truncated.
+ *
+ *	@param		PpSink					Log sink the line or entry is written for
+ *	@param		PpFileHandle			Log file handle
+ *	@param		PunLoggingLevel			Actual configured logging level
+ *	@param		PunMessageLevel			Logging level of the entry
+ *	@param		PwszTimeStamp			Time stamp of the message
+ *	@param		PwszModule				Module name (omitted if empty)
+ *	@param		PwszFunction			Function name (omitted if empty)
+ *	@param		PwszLine				Line to write, does not need to be zero terminated
+ *	@param		PunLineLength			Length of the line in elements
+ *	@param		PpCommand				TPM command data of the entry (omitted if NULL)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_WriteJsonLine(
+	_Inout_							IfxLoggingSink*				PpSink,
+	_In_							void*						PpFileHandle,
+	_In_							unsigned int				PunLoggingLevel,
+	_In_							unsigned int				PunMessageLevel,
+	_In_z_							const wchar_t*				PwszTimeStamp,
+	_In_z_							const wchar_t*				PwszModule,
+	_In_z_							const wchar_t*				PwszFunction,
+	_In_reads_or_z_(PunLineLength)	const wchar_t*				PwszLine,
+	_In_							unsigned int				PunLineLength,
+	_In_opt_						const IfxLoggingCommand*	PpCommand)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t* wszRecord = PpSink->wszComposedLine;
+		wchar_t* wszLine = PpSink->wszEscapedLine;
+		wchar_t wszTimeStamp[TIMESTAMP_LENGTH] = {0};
+		wchar_t wszModule[MAX_NAME] = {0};
+		wchar_t wszFunction[MAX_NAME] = {0};
+		wchar_t wszCommand[MAX_NAME] = {0};
+		unsigned int unTimeStampSize = RG_LEN(wszTimeStamp);
+		unsigned int unRecordSize = RG_LEN(PpSink->wszComposedLine) - 1;
+		unsigned int unSize = RG_LEN(PpSink->wszEscapedLine);
+
+		wszLine[0] = L'\0';
+
+		// Escape the line, a truncated line is written as far as it has been escaped
+		if (0 != PunLineLength)
+		{
+			unReturnValue = Utility_StringEscapeJson(PwszLine, PunLineLength, wszLine, &unSize);
+			if (RC_SUCCESS != unReturnValue && RC_E_BUFFER_TOO_SMALL != unReturnValue)
+				break;
+		}
+
+		// For logging level 3 and 4, also write the time stamp without the brackets
+		if (PunLoggingLevel >= LOGGING_LEVEL_3 && L'[' == PwszTimeStamp[0])
+		{
+			unReturnValue = Platform_StringCopy(wszTimeStamp, &unTimeStampSize, &PwszTimeStamp[1]);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (0 != unTimeStampSize && L']' == wszTimeStamp[unTimeStampSize - 1])
+				wszTimeStamp[unTimeStampSize - 1] = L'\0';
+		}
+
+		// For logging level 4, also write module and function name. If the module or function name is not set omit it
+		if (PunLoggingLevel >= LOGGING_LEVEL_4 && !PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszModule) && !PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFunction))
+		{
+			unSize = RG_LEN(wszModule);
+			unReturnValue = Utility_StringEscapeJson(PwszModule, MAX_NAME, wszModule, &unSize);
+			if (RC_SUCCESS != unReturnValue && RC_E_BUFFER_TOO_SMALL != unReturnValue)
+				break;
+			unSize = RG_LEN(wszFunction);
+			unReturnValue = Utility_StringEscapeJson(PwszFunction, MAX_NAME, wszFunction, &unSize);
+			if (RC_SUCCESS != unReturnValue && RC_E_BUFFER_TOO_SMALL != unReturnValue)
+				break;
+		}
+
+		// Add the TPM command data
+		if (NULL != PpCommand)
+		{
+			unSize = RG_LEN(wszCommand);
+			unReturnValue = Platform_StringFormat(
+								wszCommand, &unSize, L",\"ordinal\":\"0x%.8X\",\"duration\":%llu,\"rc\":\"0x%.8X\"",
+								PpCommand->unOrdinal, PpCommand->ullDuration, PpCommand->unResponseCode);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unReturnValue = Platform_StringFormat(
+							wszRecord, &unRecordSize, L"{%ls%ls%ls\"level\":%u%ls%ls%ls%ls%ls,\"message\":\"%ls\"%ls}",
+							L'\0' != wszTimeStamp[0] ? L"\"time\":\"" : L"", wszTimeStamp, L'\0' != wszTimeStamp[0] ? L"\"," : L"",
+							PunMessageLevel,
+							L'\0' != wszModule[0] ? L",\"module\":\"" : L"", wszModule,
+							L'\0' != wszModule[0] ? L"\",\"function\":\"" : L"", wszFunction, L'\0' != wszModule[0] ? L"\"" : L"",
+							wszLine, wszCommand);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// The record buffer leaves space for the new line
+		wszRecord[unRecordSize] = L'\n';
+		wszRecord[unRecordSize + 1] = L'\0';
+		unReturnValue = FileIO_WriteString(PpFileHandle, wszRecord);
+		if (RC_SUCCESS == unReturnValue && 0 != PpSink->ullLogFileMaxSize)
+			PpSink->ullLogFileSize += (unsigned long long)unRecordSize + 1;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		This function writes one line to the log file
+ *	@details	Depending on the logging level the line is prefixed with the time stamp and the module and function name.
+ *				In case a maximum log file size is configured, the written characters are added to the tracked log file
+ *				size. Characters are counted instead of the encoded bytes, which is exact for ASCII text.
+ *				In case PROPERTY_LOGGING_JSON is set, the line is written as JSON record by Logging_WriteJsonLine.
+ *
+ *	@param		PpSink					Log sink the line or entry is written for
+ *	@param		PpFileHandle			Log file handle
+ *	@param		PunLoggingLevel			Actual configured logging level
+ *	@param		PunMessageLevel			Logging level of the entry
+ *	@param		PwszTimeStamp			Time stamp of the message
+ *	@param		PwszModule				Module name (omitted if empty)
+ *	@param		PwszFunction			Function name (omitted if empty)
+ *	@param		PwszLine				Line to write, does not need to be zero terminated
+ *	@param		PunLineLength			Length of the line in elements
+ *	@param		PpCommand				TPM command data of the entry (only written to JSON records, can be NULL)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_WriteLine(
+	_Inout_							IfxLoggingSink*				PpSink,
+	_In_							void*						PpFileHandle,
+	_In_							unsigned int				PunLoggingLevel,
+	_In_							unsigned int				PunMessageLevel,
+	_In_z_							const wchar_t*				PwszTimeStamp,
+	_In_z_							const wchar_t*				PwszModule,
+	_In_z_							const wchar_t*				PwszFunction,
+	_In_reads_or_z_(PunLineLength)	const wchar_t*				PwszLine,
+	_In_							unsigned int				PunLineLength,
+	_In_opt_						const IfxLoggingCommand*	PpCommand)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	wchar_t* wszLine = PpSink->wszComposedLine;
+	IfxStringBuilder sLine;
+
+	do
+	{
+		if (TRUE == PpSink->fLogJson)
+		{
+			unReturnValue = Logging_WriteJsonLine(PpSink, PpFileHandle, PunLoggingLevel, PunMessageLevel, PwszTimeStamp, PwszModule, PwszFunction, PwszLine, PunLineLength, PpCommand);
+			break;
+		}
+
+		// Compose the line and write it at once
+		Platform_StringBuilderInitialize(&sLine, wszLine, RG_LEN(PpSink->wszComposedLine));
+
+		// For logging level 3 and 4, also write time-stamp to log file
+		if (PunLoggingLevel >= LOGGING_LEVEL_3)
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sLine, L"%ls ", PwszTimeStamp));
+
+		// For logging level 4, also write module and function name to log file
+		// If the module or function name is not set omit it
+		if (PunLoggingLevel >= LOGGING_LEVEL_4 && !PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszModule) && !PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszFunction))
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sLine, L"%ls - %ls - ", PwszModule, PwszFunction));
+
+		// Skip empty lines
+		if (0 != PunLineLength)
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sLine, L"%.*ls", (int)PunLineLength, PwszLine));
+
+		// Add new line before logging the next line.
+		unReturnValue = Platform_StringBuilderAppend(&sLine, L"\n");
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_WriteString(PpFileHandle, wszLine);
+		if (RC_SUCCESS == unReturnValue && 0 != PpSink->ullLogFileMaxSize)
+			PpSink->ullLogFileSize += sLine.unLength;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		This function writes a log entry to the log file
+ *	@details	A message is written line by line, lines are separated by \n or \r\n. Hex data is written
+ *				as hex dump with LOGGING_HEX_CHARS_PER_LINE bytes per line. TPM command data is written as one line.
+ *
+ *	@param		PpSink					Log sink the line or entry is written for
+ *	@param		PpFileHandle			Log file handle
+ *	@param		PunRecordType			LOGGING_RECORD_MESSAGE, LOGGING_RECORD_HEX or LOGGING_RECORD_COMMAND
+ *	@param		PunLoggingLevel			Actual configured logging level
+ *	@param		PunMessageLevel			Logging level of the entry
+ *	@param		PwszTimeStamp			Time stamp of the entry
+ *	@param		PszCurrentModule		Character string containing the current module name
+ *	@param		PszCurrentFunction		Character string containing the current function name
+ *	@param		PpvData					Message including the zero termination, hex data or IfxLoggingCommand
+ *	@param		PunDataSize				Size of the data in bytes
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_WriteEntry(
+	_Inout_							IfxLoggingSink*	PpSink,
+	_In_							void*			PpFileHandle,
+	_In_							unsigned int	PunRecordType,
+	_In_							unsigned int	PunLoggingLevel,
+	_In_							unsigned int	PunMessageLevel,
+	_In_z_							const wchar_t*	PwszTimeStamp,
+	_In_z_							const char*		PszCurrentModule,
+	_In_z_							const char*		PszCurrentFunction,
+	_In_bytecount_(PunDataSize)		const void*		PpvData,
+	_In_							unsigned int	PunDataSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	wchar_t wszModule[MAX_NAME] = {0};
+	wchar_t wszFunction[MAX_NAME] = {0};
+	unsigned int unIndex = 0;
+
+	// Module and function name are only written for logging level 4
+	if (PunLoggingLevel >= LOGGING_LEVEL_4)
+		Logging_ConvertNames(PszCurrentModule, PszCurrentFunction, wszModule, wszFunction);
+
+	if (LOGGING_RECORD_HEX == PunRecordType)
+	{
+		// Write hex dump line by line in the format of Utility_StringWriteHex
+		for (unIndex = 0; unIndex < PunDataSize && RC_SUCCESS == unReturnValue; unIndex += LOGGING_HEX_CHARS_PER_LINE)
+		{
+			wchar_t wszLine[LOGGING_HEX_LINE_LENGTH];
+			unsigned int unLineLength = Utility_StringWriteHexLine((const BYTE*)PpvData, PunDataSize, unIndex, wszLine);
+
+			unReturnValue = Logging_WriteLine(PpSink, PpFileHandle, PunLoggingLevel, PunMessageLevel, PwszTimeStamp, wszModule, wszFunction, wszLine, unLineLength, NULL);
+		}
+	}
+	else if (LOGGING_RECORD_COMMAND == PunRecordType)
+	{
+		IfxLoggingCommand sCommand;
+		wchar_t wszLine[MAX_NAME] = {0};
+		unsigned int unLineSize = RG_LEN(wszLine);
+
+		// Copy the command data since it is not aligned in the ring buffer
+		unReturnValue = Platform_MemoryCopy(&sCommand, sizeof(sCommand), PpvData, PunDataSize);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = Platform_StringFormat(
+								wszLine, &unLineSize, L"TPM command 0x%.8X completed in %llu us (Response code: 0x%.8X)",
+								sCommand.unOrdinal, sCommand.ullDuration, sCommand.unResponseCode);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = Logging_WriteLine(PpSink, PpFileHandle, PunLoggingLevel, PunMessageLevel, PwszTimeStamp, wszModule, wszFunction, wszLine, unLineSize, &sCommand);
+	}
+	else
+	{
+		const wchar_t* wszMessage = (const wchar_t*)PpvData;
+		unsigned int unMessageSize = PunDataSize / sizeof(wchar_t);
+
+		const wchar_t* pwszLine = NULL;
+		unsigned int unLineLength = 0;
+
+		// Log the message line by line
+		while (RC_SUCCESS == unReturnValue &&
+				RC_SUCCESS == Utility_StringGetLineView(wszMessage, unMessageSize, &unIndex, &pwszLine, &unLineLength))
+		{
+			unReturnValue = Logging_WriteLine(PpSink, PpFileHandle, PunLoggingLevel, PunMessageLevel, PwszTimeStamp, wszModule, wszFunction, pwszLine, unLineLength, NULL);
+		}
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		This function stores a log entry in the ring buffer of the asynchronous log writer
+ *	@details	Only the raw data is copied, formatting and writing is done by the log writer thread.
+ *				Entries are dropped and counted in case the ring buffer is full. For error messages the
+ *				function waits up to LOGGING_ASYNC_MAX_WAIT for free space before dropping them.
+ *
+ *	@param		PpSink					Log sink whose ring buffer stores the entry
+ *	@param		PszCurrentModule		Character string containing the current module name
+ *	@param		PszCurrentFunction		Character string containing the current function name
+ *	@param		PunRecordType			LOGGING_RECORD_MESSAGE, LOGGING_RECORD_HEX or LOGGING_RECORD_COMMAND
+ *	@param		PunLoggingLevel			Actual configured logging level
+ *	@param		PunMessageLevel			Logging level of the entry
+ *	@param		PwszTimeStamp			Time stamp of the entry
+ *	@param		PpvData					Message including the zero termination, hex data or IfxLoggingCommand
+ *	@param		PunDataSize				Size of the data in bytes
+ *	@param		PfFlush					TRUE: Flush the log file after writing the entry (e.g. for error messages)
+ */
+void
+Logging_PushRecord(
+	_Inout_							IfxLoggingSink*	PpSink,
+	_In_z_							const char*		PszCurrentModule,
+	_In_z_							const char*		PszCurrentFunction,
+	_In_							unsigned int	PunRecordType,
+	_In_							unsigned int	PunLoggingLevel,
+	_In_							unsigned int	PunMessageLevel,
+	_In_z_							const wchar_t*	PwszTimeStamp,
+	_In_bytecount_(PunDataSize)		const void*		PpvData,
+	_In_							unsigned int	PunDataSize,
+	_In_							BOOL			PfFlush)
+{
+	do
+	{
+		IfxLoggingRecord sRecord;
+		unsigned long long ullHead = atomic_load_explicit(&PpSink->ullAsyncHead, memory_order_relaxed);
+		unsigned int unOffset = (unsigned int)(ullHead % LOGGING_ASYNC_BUFFER_SIZE);
+		unsigned int unRecordSize = LOGGING_ASYNC_ALIGN(sizeof(IfxLoggingRecord) + PunDataSize);
+		unsigned int unPaddingSize = 0;
+		unsigned int unWaitTime = 0;
+		unsigned int unTimeStampSize = RG_LEN(sRecord.wszTimeStamp);
+
+		// Entries not fitting into the ring buffer are dropped
+		if (PunDataSize > LOGGING_ASYNC_BUFFER_SIZE / 2)
+		{
+			PpSink->unAsyncDropped++;
+			break;
+		}
+
+		// Records are not wrapped around the end of the ring buffer
+		if (LOGGING_ASYNC_BUFFER_SIZE - unOffset < unRecordSize)
+			unPaddingSize = LOGGING_ASYNC_BUFFER_SIZE - unOffset;
+
+		// Wait for free space (error messages only) or drop the entry
+		while (LOGGING_ASYNC_BUFFER_SIZE - (ullHead - atomic_load_explicit(&PpSink->ullAsyncTail, memory_order_acquire)) < unPaddingSize + unRecordSize)
+		{
+			if (FALSE == PfFlush || unWaitTime >= LOGGING_ASYNC_MAX_WAIT)
+				break;
+			Platform_SleepMicroSeconds(LOGGING_ASYNC_IDLE_TIME);
+			unWaitTime += LOGGING_ASYNC_IDLE_TIME;
+		}
+		if (LOGGING_ASYNC_BUFFER_SIZE - (ullHead - atomic_load_explicit(&PpSink->ullAsyncTail, memory_order_acquire)) < unPaddingSize + unRecordSize)
+		{
+			PpSink->unAsyncDropped++;
+			break;
+		}
+
+		// Skip the rest of the ring buffer (alignment guarantees space for the record size and type)
+		if (0 != unPaddingSize)
+		{
+			unsigned int rgunPadding[2] = { unPaddingSize, LOGGING_RECORD_PADDING };
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PpSink->rgbAsyncBuffer[unOffset], unPaddingSize, rgunPadding, sizeof(rgunPadding)));
+			ullHead += unPaddingSize;
+			unOffset = 0;
+		}
+
+		// Copy record header and data
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sRecord, 0, sizeof(sRecord)));
+		sRecord.unRecordSize = unRecordSize;
+		sRecord.unRecordType = PunRecordType;
+		sRecord.unLoggingLevel = PunLoggingLevel;
+		sRecord.unMessageLevel = PunMessageLevel;
+		sRecord.unDataSize = PunDataSize;
+		sRecord.unDroppedCount = PpSink->unAsyncDropped;
+		sRecord.fFlush = PfFlush;
+		sRecord.szModule = PszCurrentModule;
+		sRecord.szFunction = PszCurrentFunction;
+		IGNORE_RETURN_VALUE(Platform_StringCopy(sRecord.wszTimeStamp, &unTimeStampSize, PwszTimeStamp));
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PpSink->rgbAsyncBuffer[unOffset], unRecordSize, &sRecord, sizeof(sRecord)));
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PpSink->rgbAsyncBuffer[unOffset + sizeof(sRecord)], unRecordSize - sizeof(sRecord), PpvData, PunDataSize));
+		PpSink->unAsyncDropped = 0;
+
+		// Publish the record to the log writer
+		atomic_store_explicit(&PpSink->ullAsyncHead, ullHead + unRecordSize, memory_order_release);
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Writes the next record of a sink registered with the asynchronous log writer
+ *	@details	Called by the log writer for every registered sink in turn, so one busy sink does not hold back the others.
+ *				The log file of the sink is flushed after error messages, on request, after the configured flush interval
+ *				and before the sink is finished.
+ *
+ *	@param		PpSink					Log sink to write the next record for
+ *	@param		PfFinish				TRUE: The sink is finished once its ring buffer is empty (stop or release request)
+ *	@returns	TRUE if the ring buffer of the sink is empty, FALSE otherwise.
+ */
+static BOOL
+Logging_AsyncWriteSink(
+	_Inout_	IfxLoggingSink*	PpSink,
+	_In_	BOOL			PfFinish)
+{
+	unsigned long long ullTail = atomic_load_explicit(&PpSink->ullAsyncTail, memory_order_relaxed);
+	unsigned long long ullHead = atomic_load_explicit(&PpSink->ullAsyncHead, memory_order_acquire);
+	unsigned long long ullNow = 0;
+	BOOL fFlush = FALSE;
+
+	if (ullTail != ullHead)
+	{
+		const BYTE* pbRecord = &PpSink->rgbAsyncBuffer[ullTail % LOGGING_ASYNC_BUFFER_SIZE];
+		IfxLoggingRecord sRecord;
+
+		// Read record size and type first, a padding record consists of these two fields only
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(&sRecord, sizeof(sRecord), pbRecord, 2 * sizeof(unsigned int)));
+		if (LOGGING_RECORD_PADDING != sRecord.unRecordType)
+		{
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(&sRecord, sizeof(sRecord), pbRecord, sizeof(sRecord)));
+
+			if (0 != sRecord.unDroppedCount)
+			{
+				wchar_t wszDropped[MAX_NAME] = {0};
+				unsigned int unDroppedSize = RG_LEN(wszDropped);
+				if (RC_SUCCESS == Platform_StringFormat(wszDropped, &unDroppedSize, L"%u log entries dropped (log buffer full)", sRecord.unDroppedCount))
+					IGNORE_RETURN_VALUE(Logging_WriteLine(PpSink, PpSink->pLogFile, sRecord.unLoggingLevel, LOGGING_LEVEL_1, sRecord.wszTimeStamp, L"", L"", wszDropped, unDroppedSize, NULL));
+			}
+
+			// Write errors cannot be reported from here, the entry is lost in that case
+			IGNORE_RETURN_VALUE(Logging_WriteEntry(
+									PpSink, PpSink->pLogFile, sRecord.unRecordType, sRecord.unLoggingLevel, sRecord.unMessageLevel, sRecord.wszTimeStamp,
+									sRecord.szModule, sRecord.szFunction, pbRecord + sizeof(sRecord), sRecord.unDataSize));
+			PpSink->fUnflushed = TRUE;
+
+			// Rotate the log file here so the logging threads are never delayed by it
+			Logging_RotateIfFull(PpSink);
+			if (TRUE == sRecord.fFlush)
+				fFlush = TRUE;
+		}
+
+		// Release the record to the producer
+		ullTail += sRecord.unRecordSize;
+		atomic_store_explicit(&PpSink->ullAsyncTail, ullTail, memory_order_release);
+	}
+
+	// Flush after error messages, after the flush interval, on request and before finishing
+	ullNow = Platform_GetMonotonicTimeMicroSeconds();
+	if (ullTail == ullHead && (TRUE == PfFinish || atomic_load_explicit(&PpSink->nAsyncFlushRequest, memory_order_acquire)))
+		fFlush = TRUE;
+	if (TRUE == PpSink->fUnflushed && NULL != PpSink->pLogFile &&
+		(TRUE == fFlush || 0 == ullNow || ullNow - PpSink->ullLastFlushTime >= PpSink->ullFlushInterval))
+	{
+		IGNORE_RETURN_VALUE(FileIO_Flush(PpSink->pLogFile));
+		PpSink->ullLastFlushTime = ullNow;
+		PpSink->fUnflushed = FALSE;
+	}
+
+	if (ullTail != ullHead)
+		return FALSE;
+
+	atomic_store_explicit(&PpSink->nAsyncFlushRequest, 0, memory_order_release);
+	return TRUE;
+}
+
+/**
+ *	@brief		Asynchronous log writer
+ *	@details	Thread function writing the records from the ring buffers of all registered sinks to their log files.
+ *				A sink with a release request is closed and unregistered once its ring buffer is empty. The thread
+ *				sleeps while all ring buffers are empty and finishes when they are empty and a stop has been requested.
+ *
+ *	@param		PpvContext				Not used
+ */
+void
+Logging_AsyncWriter(
+	_In_opt_	void*	PpvContext)
+{
+	UNREFERENCED_PARAMETER(PpvContext);
+
+	do
+	{
+		// Read the stop request before the heads so that all records pushed before the request are written
+		BOOL fStop = atomic_load_explicit(&s_nAsyncStop, memory_order_acquire) ? TRUE : FALSE;
+		BOOL fIdle = TRUE;
+		unsigned int unSlot = 0;
+
+		for (unSlot = 0; unSlot < LOGGING_MAX_SINKS; unSlot++)
+		{
+			IfxLoggingSink* pSink = atomic_load_explicit(&s_rgpAsyncSinks[unSlot], memory_order_acquire);
+			BOOL fRelease = FALSE;
+
+			if (NULL == pSink)
+				continue;
+
+			// Same for the release request, it is stored after the last record of the sink has been pushed
+			fRelease = 1 == atomic_load_explicit(&pSink->nAsyncRelease, memory_order_acquire) ? TRUE : FALSE;
+			if (FALSE == Logging_AsyncWriteSink(pSink, fStop || fRelease))
+			{
+				fIdle = FALSE;
+				continue;
+			}
+
+			if (TRUE == fRelease)
+			{
+				// Hand the sink back to its owner, which frees it
+				Logging_CloseSinkFile(pSink);
+				atomic_store_explicit(&s_rgpAsyncSinks[unSlot], NULL, memory_order_release);
+				atomic_store_explicit(&pSink->nAsyncRelease, 2, memory_order_release);
+			}
+		}
+
+		if (TRUE == fIdle)
+		{
+			if (TRUE == fStop)
+				break;
+			Platform_SleepMicroSeconds(LOGGING_ASYNC_IDLE_TIME);
+		}
+	}
+	WHILE_TRUE_END;
+
+	atomic_store_explicit(&s_nAsyncFinished, 1, memory_order_release);
+}
+
+/**
+ *	@brief		Termination handler of the asynchronous log writer
+ *	@details	Called on abnormal process termination. Requests the log writer to write all pending records and
+ *				waits up to LOGGING_ASYNC_MAX_WAIT for it to finish. Uses async-signal-safe operations only.
+ */
+void
+Logging_OnTermination()
+{
+	unsigned int unWaitTime = 0;
+
+	if (NULL != s_pAsyncThread)
+	{
+		atomic_store_explicit(&s_nAsyncStop, 1, memory_order_release);
+		while (0 == atomic_load_explicit(&s_nAsyncFinished, memory_order_acquire) && unWaitTime < LOGGING_ASYNC_MAX_WAIT)
+		{
+			Platform_SleepMicroSeconds(LOGGING_ASYNC_IDLE_TIME);
+			unWaitTime += LOGGING_ASYNC_IDLE_TIME;
+		}
+	}
+}
+
+/**
+ *	@brief		This writes a message to the log file
+ *	@details	This function handles the logging work flow and writes a given message line by line to the
+ *				logging file.
+ *				The log file is kept open and written through a buffer. The buffer is flushed if requested,
+ *				if the configured flush interval has elapsed and when the log file is closed.
+ *				The message is written to the log sink of the current session (Logging_OpenSessionSink) or to the
+ *				default log file. In case the sink is registered with the asynchronous log writer, the message is
+ *				handed over to it instead.
+ *
+ *	@param		PszCurrentModule		Character string containing the current module name
+ *	@param		PszCurrentFunction		Character string containing the current function name
+ *	@param		PunRecordType			LOGGING_RECORD_MESSAGE, LOGGING_RECORD_HEX or LOGGING_RECORD_COMMAND
+ *	@param		PunLoggingLevel			Actual configured logging level
+ *	@param		PunMessageLevel			Logging level of the message
+ *	@param		PpvData					Message including the zero termination, hex data or IfxLoggingCommand
+ *	@param		PunDataSize				Size of the data in bytes
+ *	@param		PfFlush					TRUE: Flush the log file after writing the message (e.g. for error messages)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. The parameter is NULL
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_WriteMessage(
+	_In_z_							const char*		PszCurrentModule,
+	_In_z_							const char*		PszCurrentFunction,
+	_In_							unsigned int	PunRecordType,
+	_In_							unsigned int	PunLoggingLevel,
+	_In_							unsigned int	PunMessageLevel,
+	_In_bytecount_(PunDataSize)		const void*		PpvData,
+	_In_							unsigned int	PunDataSize,
+	_In_							BOOL			PfFlush)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	IfxLoggingSink* pSink = Logging_GetSink();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	// If logging is already ongoing avoid endless recursion
+	if (FALSE == pSession->fInLogging)
+	{
+		void* pFile = NULL;
+		unsigned long long ullTraceTime = TRACE_IS_ENABLED() ? Platform_GetMonotonicTimeMicroSeconds() : 0;
+
+		// Signal that logging has been started
+		pSession->fInLogging = TRUE;
+		PROBE2(log__write__entry, PunMessageLevel, PunDataSize);
+
+		do
+		{
+			wchar_t wszTimeStamp[TIMESTAMP_LENGTH] = {0};
+			unsigned int unTimeStampSize = RG_LEN(wszTimeStamp);
+
+			// Check main parameter
+			if (NULL == PpvData)
+			{
+				unReturnValue = RC_E_BAD_PARAMETER;
+				break;
+			}
+
+			// Retrieve current wszTimeStamp without date here (only written for logging level 3 and 4)
+			if (PunLoggingLevel >= LOGGING_LEVEL_3)
+			{
+				unReturnValue = Utility_GetLogTimestamp(wszTimeStamp, &unTimeStampSize);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+
+			// Hand the message over to the asynchronous log writer if it is running
+			if (NULL != s_pAsyncThread && TRUE == pSink->fAsync)
+			{
+				Logging_PushRecord(pSink, PszCurrentModule, PszCurrentFunction, PunRecordType, PunLoggingLevel, PunMessageLevel, wszTimeStamp, PpvData, PunDataSize, PfFlush);
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Get the log file (opened on first use)
+			unReturnValue = Logging_GetFile(pSink, &pFile);
+			if (RC_SUCCESS != unReturnValue || NULL == pFile)
+				break;
+
+			unReturnValue = Logging_WriteEntry(pSink, pFile, PunRecordType, PunLoggingLevel, PunMessageLevel, wszTimeStamp, PszCurrentModule, PszCurrentFunction, PpvData, PunDataSize);
+		}
+		WHILE_FALSE_END;
+
+		if (NULL != pFile)
+		{
+			if (RC_SUCCESS != unReturnValue)
+			{
+				// Do not keep a log file open which could not be written
+				Logging_CloseSinkFile(pSink);
+			}
+			else
+			{
+				unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+
+				// Rotate the log file in case the maximum size has been reached
+				Logging_RotateIfFull(pSink);
+
+				// Flush on request, after the flush interval or if no clock is available
+				if (TRUE == PfFlush || 0 == ullNow || ullNow - pSink->ullLastFlushTime >= pSink->ullFlushInterval)
+					Logging_Flush();
+			}
+		}
+
+		// The span covers the time the caller spends in logging, also with the asynchronous log writer
+		if (0 != ullTraceTime)
+			Trace_WriteSpan(TRACE_CATEGORY_LOG, L"log", ullTraceTime, Platform_GetMonotonicTimeMicroSeconds() - ullTraceTime,
+				L"\"level\":%u,\"record_type\":%u,\"size\":%u", PunMessageLevel, PunRecordType, PunDataSize);
+
+		// Signal that logging is finished
+		PROBE1(log__write__return, unReturnValue);
+		pSession->fInLogging = FALSE;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Converts an ASCII character to lower case
+ *	@details	Local helper for the case-insensitive module name comparison.
+ *
+ *	@param		PcCharacter		Character to convert
+ *	@returns	The lower case character, other characters are returned unchanged.
+ */
+static char
+Logging_ToLower(
+	_In_	char	PcCharacter)
+{
+	return (PcCharacter >= 'A' && PcCharacter <= 'Z') ? (char)(PcCharacter - 'A' + 'a') : PcCharacter;
+}
+
+/**
+ *	@brief		Returns the logging level of a module
+ *	@details	Looks up the module in PROPERTY_LOGGING_MODULE_LEVELS and falls back to PROPERTY_LOGGING_LEVEL. The result
+ *				is limited by the logging level limit of the current session (e.g. for sampled firmware blocks).
+ *
+ *	@param		PszCurrentModule		Pointer to a char array holding the module name (source file path, can be NULL)
+ *	@returns	The logging level of the module.
+ */
+static unsigned int
+Logging_GetModuleLevel(
+	_In_opt_	const char*		PszCurrentModule)
+{
+	unsigned int unLevel = s_unDefaultLoggingLevel;
+	unsigned int unLimit = Session_GetCurrent()->unLoggingLevelLimit;
+
+	if (0 != s_unModuleLevelCount && NULL != PszCurrentModule)
+	{
+		const char* szName = PszCurrentModule;
+		const char* pcPos = NULL;
+		unsigned int unLength = 0;
+		unsigned int unIndex = 0;
+
+		// Strip path and extension of the source file name
+		for (pcPos = PszCurrentModule; '\0' != *pcPos; pcPos++)
+		{
+			if ('/' == *pcPos || '\\' == *pcPos)
+				szName = pcPos + 1;
+		}
+		while ('\0' != szName[unLength] && '.' != szName[unLength])
+			unLength++;
+
+		for (unIndex = 0; unIndex < s_unModuleLevelCount; unIndex++)
+		{
+			const char* szModule = s_rgModuleLevels[unIndex].szModule;
+			unsigned int unPos = 0;
+
+			while (unPos < unLength && szModule[unPos] == Logging_ToLower(szName[unPos]))
+				unPos++;
+			if (unPos == unLength && '\0' == szModule[unPos])
+			{
+				unLevel = s_rgModuleLevels[unIndex].unLevel;
+				break;
+			}
+		}
+	}
+
+	if (LOGGING_DISABLED != unLimit && unLevel > unLimit)
+		unLevel = unLimit;
+
+	return unLevel;
+}
+
+/**
+ *	@brief		Logging function
+ *	@details	Writes the given text into the configured log. The message is formatted in the scratch area of the session.
+ *
+ *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
+ *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
+ *	@param		PunLoggingLevel			Logging level
+ *	@param		PwszLoggingMessage		Format string used to format the message
+ *	@param		...						Parameters needed to format the message
+ */
+void
+Logging_WriteLog(
+	_In_z_	const char*		PszCurrentModule,
+	_In_z_	const char*		PszCurrentFunction,
+	_In_	unsigned int	PunLoggingLevel,
+	_In_z_	const wchar_t*	PwszLoggingMessage,
+	...)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unConfiguredLoggingLevel = g_unLoggingLevel;
+
+	do
+	{
+		if (PunLoggingLevel <= Logging_GetModuleLevel(PszCurrentModule))
+		{
+			va_list argptr;
+
+			// A message logged while logging is dropped by Logging_WriteMessage, the scratch buffer holds the message
+			// being logged then
+			if (TRUE == Session_GetCurrent()->fInLogging)
+				break;
+
+			// Write log message with variable arguments to log file
+			// Get pointer to variable arguments
+			if (NULL != PwszLoggingMessage)
+			{
+				wchar_t* wszMessage = Session_GetScratch()->wszLogMessage;
+				unsigned int unMessageSize = MAX_MESSAGE_SIZE;
+
+				// Skip formating if a empty line should be written
+				if (PwszLoggingMessage[0] != L'\0')
+				{
+					// Format message
+					va_start(argptr, PwszLoggingMessage);
+					unReturnValue = Platform_StringFormatV(wszMessage, &unMessageSize, PwszLoggingMessage, argptr);
+					va_end(argptr);
+					if (RC_SUCCESS != unReturnValue)
+						break;
+				}
+				else
+				{
+					wszMessage[0] = L'\0';
+					unMessageSize = 0;
+				}
+
+				// Write actual message line by line
+				unReturnValue = Logging_WriteMessage(
+									PszCurrentModule,
+									PszCurrentFunction,
+									LOGGING_RECORD_MESSAGE,
+									unConfiguredLoggingLevel,
+									PunLoggingLevel,
+									wszMessage, (unMessageSize + 1) * sizeof(wchar_t),
+									LOGGING_LEVEL_1 == PunLoggingLevel);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Log hex dump function
+ *	@details	Writes the given data as hex dump to the file
+ *
+ *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
+ *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
+ *	@param		PunLoggingLevel			Logging level
+ *	@param		PrgbHexData				Format string used to format the message
+ *	@param		PunSize					Size of hex data buffer
  */
 void
 Logging_WriteHex(
@@ -454,7 +1482,7 @@ Logging_WriteHex(
 	_In_					unsigned int	PunSize)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
-	unsigned int unConfiguredLoggingLevel = 0;
+	unsigned int unConfiguredLoggingLevel = g_unLoggingLevel;
 
 	do
 	{
@@ -462,30 +1490,421 @@ Logging_WriteHex(
 		if (NULL == PrgbHexData || 0 == PunSize)
 			break;
 
-		// Get Logging level
-		if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOGGING_LEVEL, &unConfiguredLoggingLevel))
-			break;
-
-		if (PunLoggingLevel <= unConfiguredLoggingLevel)
+		if (PunLoggingLevel <= Logging_GetModuleLevel(PszCurrentModule))
 		{
-			wchar_t wszFormatedHexData[MAX_MESSAGE_SIZE] = {0};
-			unsigned int unFormatedHexDataSize = RG_LEN(wszFormatedHexData);
-
-			unReturnValue = Utility_StringWriteHex(
+			// Write hex dump line by line (formatted when written to the log file)
+			unReturnValue = Logging_WriteMessage(
+								PszCurrentModule,
+								PszCurrentFunction,
+								LOGGING_RECORD_HEX,
+								unConfiguredLoggingLevel,
+								PunLoggingLevel,
 								PrgbHexData, PunSize,
-								wszFormatedHexData, &unFormatedHexDataSize);
+								LOGGING_LEVEL_1 == PunLoggingLevel);
 			if (RC_SUCCESS != unReturnValue)
 				break;
+		}
+	}
+	WHILE_FALSE_END;
+}
 
-			// Write actual message line by line
-			unReturnValue = Logging_WriteMessage(
+/**
+ *	@brief		Log TPM command function
+ *	@details	Writes the ordinal, duration and response code of a TPM command as one log entry. In JSON records
+ *				(PROPERTY_LOGGING_JSON) they are written as separate fields.
+ *
+ *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
+ *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
+ *	@param		PunLoggingLevel			Logging level
+ *	@param		PunOrdinal				TPM command ordinal
+ *	@param		PullDuration			Duration of the command in microseconds
+ *	@param		PunResponseCode			TPM response code or error code of the transmission
+ */
+void
+Logging_WriteCommand(
+	_In_z_	const char*			PszCurrentModule,
+	_In_z_	const char*			PszCurrentFunction,
+	_In_	unsigned int		PunLoggingLevel,
+	_In_	unsigned int		PunOrdinal,
+	_In_	unsigned long long	PullDuration,
+	_In_	unsigned int		PunResponseCode)
+{
+	if (PunLoggingLevel <= Logging_GetModuleLevel(PszCurrentModule))
+	{
+		IfxLoggingCommand sCommand;
+
+		sCommand.unOrdinal = PunOrdinal;
+		sCommand.unResponseCode = PunResponseCode;
+		sCommand.ullDuration = PullDuration;
+		IGNORE_RETURN_VALUE(Logging_WriteMessage(
 								PszCurrentModule,
 								PszCurrentFunction,
-								unConfiguredLoggingLevel,
-								wszFormatedHexData, unFormatedHexDataSize + 1);
-			if (RC_SUCCESS != unReturnValue)
+								LOGGING_RECORD_COMMAND,
+								g_unLoggingLevel,
+								PunLoggingLevel,
+								&sCommand, sizeof(sCommand),
+								LOGGING_LEVEL_1 == PunLoggingLevel));
+	}
+}
+
+/**
+ *	@brief		Flush the log file
+ *	@details	Writes all buffered log messages of the log sink of the current session to its log file.
+ *				Nothing is done if the log file is not open.
+ */
+void
+Logging_Flush()
+{
+	IfxLoggingSink* pSink = Logging_GetSink();
+
+	if (NULL != s_pAsyncThread && TRUE == pSink->fAsync)
+	{
+		unsigned int unWaitTime = 0;
+
+		// The log writer owns the log file, request the flush and wait until it is done
+		atomic_store_explicit(&pSink->nAsyncFlushRequest, 1, memory_order_release);
+		while (0 != atomic_load_explicit(&pSink->nAsyncFlushRequest, memory_order_acquire) && unWaitTime < LOGGING_ASYNC_MAX_WAIT)
+		{
+			Platform_SleepMicroSeconds(LOGGING_ASYNC_IDLE_TIME);
+			unWaitTime += LOGGING_ASYNC_IDLE_TIME;
+		}
+	}
+	else if (NULL != pSink->pLogFile)
+	{
+		if (RC_SUCCESS != FileIO_Flush(pSink->pLogFile))
+			Logging_CloseSinkFile(pSink);
+		else
+			pSink->ullLastFlushTime = Platform_GetMonotonicTimeMicroSeconds();
+	}
+}
+
+/**
+ *	@brief		Close the log file
+ *	@details	Stops the asynchronous log writer after it has written all pending records. Flushes all buffered log
+ *				messages and closes the default log file and the log files of the sinks registered with the log writer.
+ *				A later log message reopens the log file and is written synchronously.
+ */
+void
+Logging_Close()
+{
+	unsigned int unSlot = 0;
+
+	// Let the log writer write all pending records first
+	if (NULL != s_pAsyncThread)
+	{
+		atomic_store_explicit(&s_nAsyncStop, 1, memory_order_release);
+		IGNORE_RETURN_VALUE(Platform_ThreadJoin(&s_pAsyncThread));
+		s_pAsyncThread = NULL;
+	}
+
+	// The registered session sinks are written synchronously from now on, their owners free them
+	for (unSlot = 0; unSlot < LOGGING_MAX_SINKS; unSlot++)
+	{
+		IfxLoggingSink* pSink = atomic_exchange(&s_rgpAsyncSinks[unSlot], NULL);
+		if (NULL != pSink)
+		{
+			pSink->fAsync = FALSE;
+			Logging_CloseSinkFile(pSink);
+		}
+	}
+
+	// Close the file (this also flushes the buffer) and let a running compression of a rotated log file complete
+	s_sDefaultSink.fAsync = FALSE;
+	Logging_CloseSinkFile(&s_sDefaultSink);
+	Platform_MemoryFree((void**)&s_sDefaultSink.rgbAsyncBuffer);
+}
+
+/**
+ *	@brief		Registers a log sink with the asynchronous log writer
+ *	@details	Allocates the ring buffer of the sink, starts the log writer if it is not running yet and publishes the
+ *				sink to it. The log file of the sink must already be open. In case of an error the sink stays synchronous.
+ *
+ *	@param		PpSink					Log sink to register
+ *	@returns	TRUE if the sink is written by the log writer, FALSE otherwise.
+ */
+static BOOL
+Logging_RegisterAsyncSink(
+	_Inout_	IfxLoggingSink*	PpSink)
+{
+	BOOL fRegistered = FALSE;
+
+	do
+	{
+		unsigned int unSlot = 0;
+
+		if (NULL == PpSink->rgbAsyncBuffer)
+		{
+			PpSink->rgbAsyncBuffer = (BYTE*)Platform_MemoryAllocateZero(LOGGING_ASYNC_BUFFER_SIZE);
+			if (NULL == PpSink->rgbAsyncBuffer)
+				break;
+		}
+
+		atomic_store(&PpSink->ullAsyncHead, 0);
+		atomic_store(&PpSink->ullAsyncTail, 0);
+		atomic_store(&PpSink->nAsyncFlushRequest, 0);
+		atomic_store(&PpSink->nAsyncRelease, 0);
+		PpSink->unAsyncDropped = 0;
+
+		if (NULL == s_pAsyncThread)
+		{
+			atomic_store(&s_nAsyncStop, 0);
+			atomic_store(&s_nAsyncFinished, 0);
+
+			if (RC_SUCCESS != Platform_ThreadCreate(Logging_AsyncWriter, NULL, &s_pAsyncThread))
+			{
+				s_pAsyncThread = NULL;
 				break;
+			}
+
+			// Make sure pending entries are written on exit and abnormal termination
+			if (FALSE == s_fAsyncHandlersRegistered)
+			{
+				Platform_RegisterTerminationHandler(Logging_OnTermination);
+				IGNORE_RETURN_VALUE(atexit(Logging_Close));
+				s_fAsyncHandlersRegistered = TRUE;
+			}
+		}
+
+		// Publish the sink in a free slot
+		for (unSlot = 0; unSlot < LOGGING_MAX_SINKS && FALSE == fRegistered; unSlot++)
+		{
+			IfxLoggingSink* pFree = NULL;
+			fRegistered = atomic_compare_exchange_strong(&s_rgpAsyncSinks[unSlot], &pFree, PpSink) ? TRUE : FALSE;
+		}
+		PpSink->fAsync = fRegistered;
+	}
+	WHILE_FALSE_END;
+
+	return fRegistered;
+}
+
+/**
+ *	@brief		Start the asynchronous log writer
+ *	@details	Opens the default log file and starts a thread writing log entries from a ring buffer to it, so logging
+ *				does not slow down the caller. Must be called once the log file path is final since it is not checked for
+ *				changes anymore. Nothing is done if logging is disabled or PROPERTY_LOGGING_ASYNC is not set. In case of an
+ *				error logging stays synchronous. The log writer is stopped by Logging_Close (also registered with atexit())
+ *				and writes all pending entries on abnormal process termination.
+ */
+void
+Logging_StartAsync()
+{
+	IfxSession* pSession = Session_GetCurrent();
+
+	do
+	{
+		BOOL fAsync = FALSE;
+		void* pFile = NULL;
+		unsigned int unReturnValue = RC_E_FAIL;
+
+		if (TRUE == s_sDefaultSink.fAsync || TRUE == pSession->fInLogging)
+			break;
+
+		// Check configuration
+		if (LOGGING_DISABLED == g_unLoggingLevel)
+			break;
+		if (FALSE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_LOGGING_ASYNC, &fAsync) || FALSE == fAsync)
+			break;
+
+		// Open the log file before handing it over to the log writer
+		pSession->fInLogging = TRUE;
+		unReturnValue = Logging_GetFile(&s_sDefaultSink, &pFile);
+		pSession->fInLogging = FALSE;
+		if (RC_SUCCESS != unReturnValue || NULL == pFile)
+			break;
+
+		if (FALSE == Logging_RegisterAsyncSink(&s_sDefaultSink))
+			Platform_MemoryFree((void**)&s_sDefaultSink.rgbAsyncBuffer);
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Open a log sink for the current session
+ *	@details	Messages logged by the session are written to the given log file instead of the default log file
+ *				from now on, e.g. one log file per TPM device. The log file is opened with the header and written
+ *				by the asynchronous log writer in case PROPERTY_LOGGING_ASYNC is set, by the logging thread otherwise.
+ *				The other settings of the default log file (flush interval, rotation, JSON) apply to it as well.
+ *				The sink is closed by Logging_CloseSessionSink or when the session is released.
+ *
+ *	@param		PwszLogFilePath			Path of the log file of the session
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred, e.g. the session has a sink already.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. The parameter is NULL or empty
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_OpenSessionSink(
+	_In_z_	const wchar_t*	PwszLogFilePath)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxSession* pSession = Session_GetCurrent();
+	IfxLoggingSink* pSink = NULL;
+
+	do
+	{
+		unsigned int unPathSize = 0;
+		BOOL fAsync = FALSE;
+		void* pFile = NULL;
+
+		// Check parameter
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszLogFilePath))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		if (NULL != pSession->pLogSink || TRUE == pSession->fInLogging)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		pSink = (IfxLoggingSink*)Platform_MemoryAllocateZero(sizeof(IfxLoggingSink));
+		if (NULL == pSink)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		unPathSize = RG_LEN(pSink->wszSinkPath);
+		unReturnValue = Platform_StringCopy(pSink->wszSinkPath, &unPathSize, PwszLogFilePath);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Open the log file and write the header
+		pSession->fInLogging = TRUE;
+		unReturnValue = Logging_GetFile(pSink, &pFile);
+		pSession->fInLogging = FALSE;
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Hand the sink over to the log writer if configured, it stays synchronous if it cannot be registered
+		if (TRUE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_LOGGING_ASYNC, &fAsync) && TRUE == fAsync &&
+			FALSE == Logging_RegisterAsyncSink(pSink))
+		{
+			Platform_MemoryFree((void**)&pSink->rgbAsyncBuffer);
 		}
+
+		pSession->pLogSink = pSink;
+		pSink = NULL;
 	}
 	WHILE_FALSE_END;
+
+	if (NULL != pSink)
+	{
+		Logging_CloseSinkFile(pSink);
+		Platform_MemoryFree((void**)&pSink);
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Close the log sink of the current session
+ *	@details	Writes all pending messages, closes the log file of the sink and frees it. Messages logged by the session
+ *				are written to the default log file again afterwards. Nothing is done if the session has no sink.
+ *				In case the log writer does not release the sink within LOGGING_ASYNC_MAX_WAIT, it is not freed.
+ */
+void
+Logging_CloseSessionSink()
+{
+	IfxSession* pSession = Session_GetCurrent();
+	IfxLoggingSink* pSink = pSession->pLogSink;
+
+	if (NULL != pSink)
+	{
+		pSession->pLogSink = NULL;
+
+		if (NULL != s_pAsyncThread && TRUE == pSink->fAsync)
+		{
+			unsigned int unWaitTime = 0;
+
+			// The log writer owns the log file, let it write the pending records and close it
+			atomic_store_explicit(&pSink->nAsyncRelease, 1, memory_order_release);
+			while (2 != atomic_load_explicit(&pSink->nAsyncRelease, memory_order_acquire) && unWaitTime < LOGGING_ASYNC_MAX_WAIT)
+			{
+				Platform_SleepMicroSeconds(LOGGING_ASYNC_IDLE_TIME);
+				unWaitTime += LOGGING_ASYNC_IDLE_TIME;
+			}
+			if (2 != atomic_load_explicit(&pSink->nAsyncRelease, memory_order_acquire))
+				return;
+		}
+		else
+			Logging_CloseSinkFile(pSink);
+
+		Platform_MemoryFree((void**)&pSink->rgbAsyncBuffer);
+		Platform_MemoryFree((void**)&pSink);
+	}
+}
+
+/**
+ *	@brief		Update the cached logging level
+ *	@details	Reads PROPERTY_LOGGING_LEVEL into g_unLoggingLevel (LOGGING_DISABLED if it is not set).
+ *				Called by the PropertyStorage whenever the property is added, changed or removed.
+ */
+void
+Logging_UpdateLevel()
+{
+	unsigned int unLoggingLevel = LOGGING_DISABLED;
+	unsigned int unMaxLoggingLevel = LOGGING_DISABLED;
+	unsigned int unModuleLevelCount = 0;
+	wchar_t wszModuleLevels[MAX_STRING_1024] = {0};
+	unsigned int unSize = RG_LEN(wszModuleLevels);
+
+	if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_LOGGING_LEVEL, &unLoggingLevel))
+		unLoggingLevel = LOGGING_DISABLED;
+	unMaxLoggingLevel = unLoggingLevel;
+
+	// Parse the module levels "<module>:<level>[,<module>:<level>...]"
+	if (TRUE == PropertyStorage_GetValueById(PROPERTY_ID_LOGGING_MODULE_LEVELS, wszModuleLevels, &unSize))
+	{
+		const wchar_t* pwszPos = wszModuleLevels;
+
+		while (L'\0' != *pwszPos && unModuleLevelCount < LOGGING_MAX_MODULE_LEVELS)
+		{
+			IfxLoggingModuleLevel* psModuleLevel = &s_rgModuleLevels[unModuleLevelCount];
+			unsigned int unLength = 0;
+			unsigned int unLevel = 0;
+			BOOL fValid = FALSE;
+
+			while (L' ' == *pwszPos || L',' == *pwszPos)
+				pwszPos++;
+			for (; L'\0' != *pwszPos && L':' != *pwszPos && L',' != *pwszPos && L' ' != *pwszPos; pwszPos++)
+			{
+				if (unLength < LOGGING_MAX_MODULE_NAME - 1)
+					psModuleLevel->szModule[unLength] = Logging_ToLower((char)*pwszPos);
+				unLength++;
+			}
+			if (L':' == *pwszPos && 0 != unLength && unLength < LOGGING_MAX_MODULE_NAME)
+			{
+				for (pwszPos++; *pwszPos >= L'0' && *pwszPos <= L'9'; pwszPos++)
+				{
+					if (unLevel <= LOGGING_LEVEL_4)
+						unLevel = unLevel * 10 + (unsigned int)(*pwszPos - L'0');
+					fValid = TRUE;
+				}
+				if (unLevel > LOGGING_LEVEL_4 || (L'\0' != *pwszPos && L',' != *pwszPos && L' ' != *pwszPos))
+					fValid = FALSE;
+			}
+
+			// Skip the rest of an invalid entry
+			while (L'\0' != *pwszPos && L',' != *pwszPos)
+				pwszPos++;
+
+			if (fValid)
+			{
+				psModuleLevel->szModule[unLength] = '\0';
+				psModuleLevel->unLevel = unLevel;
+				unModuleLevelCount++;
+				if (unLevel > unMaxLoggingLevel)
+					unMaxLoggingLevel = unLevel;
+			}
+		}
+	}
+
+	s_unDefaultLoggingLevel = unLoggingLevel;
+	s_unModuleLevelCount = unModuleLevelCount;
+	g_unLoggingLevel = unMaxLoggingLevel;
 }
@@ -20,8 +20,9 @@
 extern "C" {
 #endif
 
-/// Flag indicating whether to write a header into the log file or not
-extern BOOL g_fLogHeader;
+/// Highest logging level of PROPERTY_LOGGING_LEVEL and PROPERTY_LOGGING_MODULE_LEVELS, kept up to date by the PropertyStorage.
+/// Messages passing this inline check are filtered by the level of their module afterwards.
+extern unsigned int g_unLoggingLevel;
 
 /**
  *	Value definitions for logging
@@ -57,37 +58,81 @@ extern BOOL g_fLogHeader;
 /// Divisor for megabyte
 #define DIV_KILOBYTE 1024
 
+/// Maximum length of a hex dump line including prefix and zero termination
+#define LOGGING_HEX_LINE_LENGTH 64
+
+/// Log record type: message
+#define LOGGING_RECORD_MESSAGE	1
+/// Log record type: hex dump
+#define LOGGING_RECORD_HEX		2
+/// Log record type: padding up to the end of the ring buffer
+#define LOGGING_RECORD_PADDING	3
+/// Log record type: TPM command ordinal, duration and response code
+#define LOGGING_RECORD_COMMAND	4
+
+/// Size of the ring buffer of the asynchronous log writer in bytes (must be a multiple of 8)
+#define LOGGING_ASYNC_BUFFER_SIZE	(1024 * 1024)
+/// Aligns the size of a record in the ring buffer of the asynchronous log writer
+#define LOGGING_ASYNC_ALIGN(SIZE)	(((SIZE) + 7) & ~7u)
+/// Time in microseconds the asynchronous log writer sleeps while there is nothing to write
+#define LOGGING_ASYNC_IDLE_TIME		1000
+/// Maximum time in microseconds to wait for the asynchronous log writer (e.g. for free space for an error message)
+#define LOGGING_ASYNC_MAX_WAIT		1000000
+/// Maximum number of log sinks registered with the asynchronous log writer at the same time
+#define LOGGING_MAX_SINKS			64
+
+/// Maximum number of module levels in PROPERTY_LOGGING_MODULE_LEVELS
+#define LOGGING_MAX_MODULE_LEVELS	16
+/// Maximum length of a module name in PROPERTY_LOGGING_MODULE_LEVELS including zero termination
+#define LOGGING_MAX_MODULE_NAME		32
+
+/// Log sink writing the messages of a session to a log file of its own (see Logging_OpenSessionSink)
+typedef struct tdIfxLoggingSink IfxLoggingSink;
+
 /**
  *	Macro definitions for logging
  */
 
+/// Highest logging level compiled into the binary. Logging statements of higher levels are removed
+/// including their string literals (set by the makefile variable of the same name).
+#ifndef LOGGING_MAX_COMPILED_LEVEL
+#define LOGGING_MAX_COMPILED_LEVEL					LOGGING_LEVEL_4
+#endif
+
+/// Macro checking inline whether messages of the given logging level are written to the log file
+/// The first condition is a constant for the LOGGING_LEVELn macros so the compiler drops statements above LOGGING_MAX_COMPILED_LEVEL.
+#define LOGGING_IS_ENABLED(LOGLEVEL)				((LOGLEVEL) <= LOGGING_MAX_COMPILED_LEVEL && (LOGLEVEL) <= g_unLoggingLevel)
+
 /// Macro for writing a message into the log file
-#define LOGGING_WRITE(LOGLEVEL, LOGMESSAGE, ...)	Logging_WriteLog(__FILE__, __func__, LOGLEVEL, LOGMESSAGE, ##__VA_ARGS__);
+#define LOGGING_WRITE(LOGLEVEL, LOGMESSAGE, ...)	{ if (LOGGING_IS_ENABLED(LOGLEVEL)) Logging_WriteLog(__FILE__, __func__, LOGLEVEL, LOGMESSAGE, ##__VA_ARGS__); }
 
 /// Macro for writing a message into the log file only in case current log level is level 1 or higher
-#define LOGGING_WRITE_LEVEL1_FMT(LOGMESSAGE, ...)	Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_1, LOGMESSAGE, ##__VA_ARGS__);
-#define LOGGING_WRITE_LEVEL1(LOGMESSAGE)			Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_1, LOGMESSAGE, NULL);
+#define LOGGING_WRITE_LEVEL1_FMT(LOGMESSAGE, ...)	{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_1)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_1, LOGMESSAGE, ##__VA_ARGS__); }
+#define LOGGING_WRITE_LEVEL1(LOGMESSAGE)			{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_1)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_1, LOGMESSAGE, NULL); }
 
 /// Macro for writing a message into the log file only in case current log level is level 2 or higher
-#define LOGGING_WRITE_LEVEL2_FMT(LOGMESSAGE, ...)	Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_2, LOGMESSAGE, ##__VA_ARGS__);
-#define LOGGING_WRITE_LEVEL2(LOGMESSAGE)			Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_2, LOGMESSAGE, NULL);
+#define LOGGING_WRITE_LEVEL2_FMT(LOGMESSAGE, ...)	{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_2)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_2, LOGMESSAGE, ##__VA_ARGS__); }
+#define LOGGING_WRITE_LEVEL2(LOGMESSAGE)			{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_2)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_2, LOGMESSAGE, NULL); }
 
 /// Macro for writing a message into the log file only in case current log level is level 3 or higher
-#define LOGGING_WRITE_LEVEL3_FMT(LOGMESSAGE, ...)	Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_3, LOGMESSAGE, ##__VA_ARGS__);
-#define LOGGING_WRITE_LEVEL3(LOGMESSAGE)			Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_3, LOGMESSAGE, NULL);
+#define LOGGING_WRITE_LEVEL3_FMT(LOGMESSAGE, ...)	{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_3)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_3, LOGMESSAGE, ##__VA_ARGS__); }
+#define LOGGING_WRITE_LEVEL3(LOGMESSAGE)			{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_3)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_3, LOGMESSAGE, NULL); }
 
 /// Macro for writing a message into the log file only in case current log level is level 4 or higher
-#define LOGGING_WRITE_LEVEL4_FMT(LOGMESSAGE, ...)	Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_4, LOGMESSAGE, ##__VA_ARGS__);
-#define LOGGING_WRITE_LEVEL4(LOGMESSAGE)			Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_4, LOGMESSAGE, NULL);
+#define LOGGING_WRITE_LEVEL4_FMT(LOGMESSAGE, ...)	{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_4)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_4, LOGMESSAGE, ##__VA_ARGS__); }
+#define LOGGING_WRITE_LEVEL4(LOGMESSAGE)			{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_4)) Logging_WriteLog(__FILE__, __func__, LOGGING_LEVEL_4, LOGMESSAGE, NULL); }
 
 /// Macro for writing a buffer's contents in hex bytes into the log file
-#define LOGGING_WRITEHEX(LOGLEVEL, BUFFER, SIZE)	Logging_WriteHex(__FILE__, __func__, LOGLEVEL, BUFFER, SIZE);
+#define LOGGING_WRITEHEX(LOGLEVEL, BUFFER, SIZE)	{ if (LOGGING_IS_ENABLED(LOGLEVEL)) Logging_WriteHex(__FILE__, __func__, LOGLEVEL, BUFFER, SIZE); }
 
 /// Macro for writing a buffer's contents in hex bytes into the log file only in case current log level is level 1 or higher
-#define LOGGING_WRITEHEX_LEVEL1(BUFFER, SIZE)		Logging_WriteHex(__FILE__, __func__, LOGGING_LEVEL_1, BUFFER, SIZE);
+#define LOGGING_WRITEHEX_LEVEL1(BUFFER, SIZE)		{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_1)) Logging_WriteHex(__FILE__, __func__, LOGGING_LEVEL_1, BUFFER, SIZE); }
 
 /// Macro for writing a buffer's contents in hex bytes into the log file only in case current log level is level 3 or higher
-#define LOGGING_WRITEHEX_LEVEL3(BUFFER, SIZE)		Logging_WriteHex(__FILE__, __func__, LOGGING_LEVEL_3, BUFFER, SIZE);
+#define LOGGING_WRITEHEX_LEVEL3(BUFFER, SIZE)		{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_3)) Logging_WriteHex(__FILE__, __func__, LOGGING_LEVEL_3, BUFFER, SIZE); }
+
+/// Macro for writing the ordinal, duration and response code of a TPM command into the log file only in case current log level is level 3 or higher
+#define LOGGING_WRITECOMMAND_LEVEL3(ORDINAL, DURATION, RESPONSECODE)	{ if (LOGGING_IS_ENABLED(LOGGING_LEVEL_3)) Logging_WriteCommand(__FILE__, __func__, LOGGING_LEVEL_3, ORDINAL, DURATION, RESPONSECODE); }
 
 /**
  *	Method declarations for logging
@@ -95,7 +140,7 @@ extern BOOL g_fLogHeader;
 
 /**
  *	@brief		Logging function
- *	@details	Writes the given text into the configured log
+ *	@details	Writes the given text into the configured log. The message is formatted in the scratch area of the session.
  *
  *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
  *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
@@ -129,6 +174,93 @@ Logging_WriteHex(
 	_In_bytecount_(PunSize)	const BYTE*		PrgbHexData,
 	_In_					unsigned int	PunSize);
 
+/**
+ *	@brief		Log TPM command function
+ *	@details	Writes the ordinal, duration and response code of a TPM command as one log entry. In JSON records
+ *				(PROPERTY_LOGGING_JSON) they are written as separate fields.
+ *
+ *	@param		PszCurrentModule		Pointer to a char array holding the module name (optional, can be NULL)
+ *	@param		PszCurrentFunction		Pointer to a char array holding the function name (optional, can be NULL)
+ *	@param		PunLoggingLevel			Logging level
+ *	@param		PunOrdinal				TPM command ordinal
+ *	@param		PullDuration			Duration of the command in microseconds
+ *	@param		PunResponseCode			TPM response code or error code of the transmission
+ */
+void
+Logging_WriteCommand(
+	_In_z_	const char*			PszCurrentModule,
+	_In_z_	const char*			PszCurrentFunction,
+	_In_	unsigned int		PunLoggingLevel,
+	_In_	unsigned int		PunOrdinal,
+	_In_	unsigned long long	PullDuration,
+	_In_	unsigned int		PunResponseCode);
+
+/**
+ *	@brief		Flush the log file
+ *	@details	Writes all buffered log messages of the log sink of the current session to its log file.
+ *				Nothing is done if the log file is not open.
+ */
+void
+Logging_Flush();
+
+/**
+ *	@brief		Close the log file
+ *	@details	Stops the asynchronous log writer after it has written all pending records. Flushes all buffered log
+ *				messages and closes the default log file and the log files of the sinks registered with the log writer.
+ *				A later log message reopens the log file and is written synchronously.
+ */
+void
+Logging_Close();
+
+/**
+ *	@brief		Start the asynchronous log writer
+ *	@details	Opens the default log file and starts a thread writing log entries from a ring buffer to it, so logging
+ *				does not slow down the caller. Must be called once the log file path is final since it is not checked for
+ *				changes anymore. Nothing is done if logging is disabled or PROPERTY_LOGGING_ASYNC is not set. In case of an
+ *				error logging stays synchronous. The log writer is stopped by Logging_Close (also registered with atexit())
+ *				and writes all pending entries on abnormal process termination.
+ */
+void
+Logging_StartAsync();
+
+/**
+ *	@brief		Open a log sink for the current session
+ *	@details	Messages logged by the session are written to the given log file instead of the default log file
+ *				from now on, e.g. one log file per TPM device. The log file is opened with the header and written
+ *				by the asynchronous log writer in case PROPERTY_LOGGING_ASYNC is set, by the logging thread otherwise.
+ *				The other settings of the default log file (flush interval, rotation, JSON) apply to it as well.
+ *				The sink is closed by Logging_CloseSessionSink or when the session is released.
+ *
+ *	@param		PwszLogFilePath			Path of the log file of the session
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An unexpected error occurred, e.g. the session has a sink already.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. The parameter is NULL or empty
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Logging_OpenSessionSink(
+	_In_z_	const wchar_t*	PwszLogFilePath);
+
+/**
+ *	@brief		Close the log sink of the current session
+ *	@details	Writes all pending messages, closes the log file of the sink and frees it. Messages logged by the session
+ *				are written to the default log file again afterwards. Nothing is done if the session has no sink.
+ *				In case the log writer does not release the sink within LOGGING_ASYNC_MAX_WAIT, it is not freed.
+ */
+void
+Logging_CloseSessionSink();
+
+/**
+ *	@brief		Update the cached logging levels
+ *	@details	Reads PROPERTY_LOGGING_LEVEL (LOGGING_DISABLED if it is not set) and PROPERTY_LOGGING_MODULE_LEVELS.
+ *				The module levels are a comma separated list of <module>:<level> entries, the module being the source
+ *				file name without path and extension (case-insensitive). Invalid entries are ignored. Called by the
+ *				PropertyStorage whenever one of the properties is added, changed or removed.
+ */
+void
+Logging_UpdateLevel();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,463 @@
+﻿/**
+ *	@brief		Implements the message catalog
+ *	@details	The catalog is generated at compile time from the message lists below: every list entry becomes a member
+ *				of the string pool structure and a slot in a dense offset table. Offset 0 marks a missing message.
+ *	@file		MessageCatalog.c
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MessageCatalog.h"
+#include "TpmResponseMessages.h"
+
+/// TPM2.0 success message
+#define MESSAGECATALOG_LIST_TPM20_SUCCESS(ENTRY) \
+	ENTRY(0x000, TPM_RC_SUCCESS_MESSAGE)
+
+/// TPM2.0 Format-Zero error messages with their response code offset as index (RC_VER1 (0x100) + offset)
+#define MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_ERRORS(ENTRY) \
+	ENTRY(0x000, TPM_RC_INITIALIZE_MESSAGE) \
+	ENTRY(0x001, TPM_RC_FAILURE_MESSAGE) \
+	ENTRY(0x003, TPM_RC_SEQUENCE_MESSAGE) \
+	ENTRY(0x00B, TPM_RC_PRIVATE_MESSAGE) \
+	ENTRY(0x019, TPM_RC_HMAC_MESSAGE) \
+	ENTRY(0x020, TPM_RC_DISABLED_MESSAGE) \
+	ENTRY(0x021, TPM_RC_EXCLUSIVE_MESSAGE) \
+	ENTRY(0x024, TPM_RC_AUTH_TYPE_MESSAGE) \
+	ENTRY(0x025, TPM_RC_AUTH_MISSING_MESSAGE) \
+	ENTRY(0x026, TPM_RC_POLICY_MESSAGE) \
+	ENTRY(0x027, TPM_RC_PCR_MESSAGE) \
+	ENTRY(0x028, TPM_RC_PCR_CHANGED_MESSAGE) \
+	ENTRY(0x02D, TPM_RC_UPGRADE_MESSAGE) \
+	ENTRY(0x02E, TPM_RC_TOO_MANY_CONTEXTS_MESSAGE) \
+	ENTRY(0x02F, TPM_RC_AUTH_UNAVAILABLE_MESSAGE) \
+	ENTRY(0x030, TPM_RC_REBOOT_MESSAGE) \
+	ENTRY(0x031, TPM_RC_UNBALANCED_MESSAGE) \
+	ENTRY(0x042, TPM_RC_COMMAND_SIZE_MESSAGE) \
+	ENTRY(0x043, TPM_RC_COMMAND_CODE_MESSAGE) \
+	ENTRY(0x044, TPM_RC_AUTHSIZE_MESSAGE) \
+	ENTRY(0x045, TPM_RC_AUTH_CONTEXT_MESSAGE) \
+	ENTRY(0x046, TPM_RC_NV_RANGE_MESSAGE) \
+	ENTRY(0x047, TPM_RC_NV_SIZE_MESSAGE) \
+	ENTRY(0x048, TPM_RC_NV_LOCKED_MESSAGE) \
+	ENTRY(0x049, TPM_RC_NV_AUTHORIZATION_MESSAGE) \
+	ENTRY(0x04A, TPM_RC_NV_UNINITIALIZED_MESSAGE) \
+	ENTRY(0x04B, TPM_RC_NV_SPACE_MESSAGE) \
+	ENTRY(0x04C, TPM_RC_NV_DEFINED_MESSAGE) \
+	ENTRY(0x050, TPM_RC_BAD_CONTEXT_MESSAGE) \
+	ENTRY(0x051, TPM_RC_CPHASH_MESSAGE) \
+	ENTRY(0x052, TPM_RC_PARENT_MESSAGE) \
+	ENTRY(0x053, TPM_RC_NEEDS_TEST_MESSAGE) \
+	ENTRY(0x054, TPM_RC_NO_RESULT_MESSAGE) \
+	ENTRY(0x055, TPM_RC_SENSITIVE_MESSAGE)
+
+/// TPM2.0 Format-One error messages with their response code offset as index (RC_FMT1 (0x80) + offset)
+#define MESSAGECATALOG_LIST_TPM20_FORMAT_ONE_ERRORS(ENTRY) \
+	ENTRY(0x001, TPM_RC_ASYMMETRIC_MESSAGE) \
+	ENTRY(0x002, TPM_RC_ATTRIBUTES_MESSAGE) \
+	ENTRY(0x003, TPM_RC_HASH_MESSAGE) \
+	ENTRY(0x004, TPM_RC_VALUE_MESSAGE) \
+	ENTRY(0x005, TPM_RC_HIERARCHY_MESSAGE) \
+	ENTRY(0x007, TPM_RC_KEY_SIZE_MESSAGE) \
+	ENTRY(0x008, TPM_RC_MGF_MESSAGE) \
+	ENTRY(0x009, TPM_RC_MODE_MESSAGE) \
+	ENTRY(0x00A, TPM_RC_TYPE_MESSAGE) \
+	ENTRY(0x00B, TPM_RC_HANDLE_MESSAGE) \
+	ENTRY(0x00C, TPM_RC_KDF_MESSAGE) \
+	ENTRY(0x00D, TPM_RC_RANGE_MESSAGE) \
+	ENTRY(0x00E, TPM_RC_AUTH_FAIL_MESSAGE) \
+	ENTRY(0x00F, TPM_RC_NONCE_MESSAGE) \
+	ENTRY(0x010, TPM_RC_PP_MESSAGE) \
+	ENTRY(0x012, TPM_RC_SCHEME_MESSAGE) \
+	ENTRY(0x015, TPM_RC_SIZE_MESSAGE) \
+	ENTRY(0x016, TPM_RC_SYMMETRIC_MESSAGE) \
+	ENTRY(0x017, TPM_RC_TAG_MESSAGE) \
+	ENTRY(0x018, TPM_RC_SELECTOR_MESSAGE) \
+	ENTRY(0x01A, TPM_RC_INSUFFICIENT_MESSAGE) \
+	ENTRY(0x01B, TPM_RC_SIGNATURE_MESSAGE) \
+	ENTRY(0x01C, TPM_RC_KEY_MESSAGE) \
+	ENTRY(0x01D, TPM_RC_POLICY_FAIL_MESSAGE) \
+	ENTRY(0x01F, TPM_RC_INTEGRITY_MESSAGE) \
+	ENTRY(0x020, TPM_RC_TICKET_MESSAGE) \
+	ENTRY(0x021, TPM_RC_RESERVED_BITS_MESSAGE) \
+	ENTRY(0x022, TPM_RC_BAD_AUTH_MESSAGE) \
+	ENTRY(0x023, TPM_RC_EXPIRED_MESSAGE) \
+	ENTRY(0x024, TPM_RC_POLICY_CC_MESSAGE) \
+	ENTRY(0x025, TPM_RC_BINDING_MESSAGE) \
+	ENTRY(0x026, TPM_RC_CURVE_MESSAGE) \
+	ENTRY(0x027, TPM_RC_ECC_POINT_MESSAGE)
+
+/// TPM2.0 Format-Zero warning messages with their response code offset as index (RC_WARN (0x900) + offset)
+#define MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_WARNINGS(ENTRY) \
+	ENTRY(0x001, TPM_RC_CONTEXT_GAP_MESSAGE) \
+	ENTRY(0x002, TPM_RC_OBJECT_MEMORY_MESSAGE) \
+	ENTRY(0x003, TPM_RC_SESSION_MEMORY_MESSAGE) \
+	ENTRY(0x004, TPM_RC_MEMORY_MESSAGE) \
+	ENTRY(0x005, TPM_RC_SESSION_HANDLES_MESSAGE) \
+	ENTRY(0x006, TPM_RC_OBJECT_HANDLES_MESSAGE) \
+	ENTRY(0x007, TPM_RC_LOCALITY_MESSAGE) \
+	ENTRY(0x008, TPM_RC_YIELDED_MESSAGE) \
+	ENTRY(0x009, TPM_RC_CANCELED_MESSAGE) \
+	ENTRY(0x00A, TPM_RC_TESTING_MESSAGE) \
+	ENTRY(0x010, TPM_RC_REFERENCE_H0_MESSAGE) \
+	ENTRY(0x011, TPM_RC_REFERENCE_H1_MESSAGE) \
+	ENTRY(0x012, TPM_RC_REFERENCE_H2_MESSAGE) \
+	ENTRY(0x013, TPM_RC_REFERENCE_H3_MESSAGE) \
+	ENTRY(0x014, TPM_RC_REFERENCE_H4_MESSAGE) \
+	ENTRY(0x015, TPM_RC_REFERENCE_H5_MESSAGE) \
+	ENTRY(0x016, TPM_RC_REFERENCE_H6_MESSAGE) \
+	ENTRY(0x018, TPM_RC_REFERENCE_S0_MESSAGE) \
+	ENTRY(0x019, TPM_RC_REFERENCE_S1_MESSAGE) \
+	ENTRY(0x01A, TPM_RC_REFERENCE_S2_MESSAGE) \
+	ENTRY(0x01B, TPM_RC_REFERENCE_S3_MESSAGE) \
+	ENTRY(0x01C, TPM_RC_REFERENCE_S4_MESSAGE) \
+	ENTRY(0x01D, TPM_RC_REFERENCE_S5_MESSAGE) \
+	ENTRY(0x01E, TPM_RC_REFERENCE_S6_MESSAGE) \
+	ENTRY(0x020, TPM_RC_NV_RATE_MESSAGE) \
+	ENTRY(0x021, TPM_RC_LOCKOUT_MESSAGE) \
+	ENTRY(0x022, TPM_RC_RETRY_MESSAGE) \
+	ENTRY(0x023, TPM_RC_NV_UNAVAILABLE_MESSAGE)
+
+/// TPM1.2 error messages with their response code offset as index (TPM_BASE (0x0) + offset)
+#define MESSAGECATALOG_LIST_TPM12_ERRORS(ENTRY) \
+	ENTRY(0x000, TPM_SUCCESS_MESSAGE) \
+	ENTRY(0x001, TPM_AUTHFAIL_MESSAGE) \
+	ENTRY(0x002, TPM_BADINDEX_MESSAGE) \
+	ENTRY(0x003, TPM_BAD_PARAMETER_MESSAGE) \
+	ENTRY(0x004, TPM_AUDITFAILURE_MESSAGE) \
+	ENTRY(0x005, TPM_CLEAR_DISABLED_MESSAGE) \
+	ENTRY(0x006, TPM_DEACTIVATED_MESSAGE) \
+	ENTRY(0x007, TPM_DISABLED_MESSAGE) \
+	ENTRY(0x008, TPM_DISABLED_CMD_MESSAGE) \
+	ENTRY(0x009, TPM_FAIL_MESSAGE) \
+	ENTRY(0x00A, TPM_BAD_ORDINAL_MESSAGE) \
+	ENTRY(0x00B, TPM_INSTALL_DISABLED_MESSAGE) \
+	ENTRY(0x00C, TPM_INVALID_KEYHANDLE_MESSAGE) \
+	ENTRY(0x00D, TPM_KEYNOTFOUND_MESSAGE) \
+	ENTRY(0x00E, TPM_INAPPROPRIATE_ENC_MESSAGE) \
+	ENTRY(0x00F, TPM_MIGRATEFAIL_MESSAGE) \
+	ENTRY(0x010, TPM_INVALID_PCR_INFO_MESSAGE) \
+	ENTRY(0x011, TPM_NOSPACE_MESSAGE) \
+	ENTRY(0x012, TPM_NOSRK_MESSAGE) \
+	ENTRY(0x013, TPM_NOTSEALED_BLOB_MESSAGE) \
+	ENTRY(0x014, TPM_OWNER_SET_MESSAGE) \
+	ENTRY(0x015, TPM_RESOURCES_MESSAGE) \
+	ENTRY(0x016, TPM_SHORTRANDOM_MESSAGE) \
+	ENTRY(0x017, TPM_SIZE_MESSAGE) \
+	ENTRY(0x018, TPM_WRONGPCRVAL_MESSAGE) \
+	ENTRY(0x019, TPM_BAD_PARAM_SIZE_MESSAGE) \
+	ENTRY(0x01A, TPM_SHA_THREAD_MESSAGE) \
+	ENTRY(0x01B, TPM_SHA_ERROR_MESSAGE) \
+	ENTRY(0x01C, TPM_FAILEDSELFTEST_MESSAGE) \
+	ENTRY(0x01D, TPM_AUTH2FAIL_MESSAGE) \
+	ENTRY(0x01E, TPM_BADTAG_MESSAGE) \
+	ENTRY(0x01F, TPM_IOERROR_MESSAGE) \
+	ENTRY(0x020, TPM_ENCRYPT_ERROR_MESSAGE) \
+	ENTRY(0x021, TPM_DECRYPT_ERROR_MESSAGE) \
+	ENTRY(0x022, TPM_INVALID_AUTHHANDLE_MESSAGE) \
+	ENTRY(0x023, TPM_NO_ENDORSEMENT_MESSAGE) \
+	ENTRY(0x024, TPM_INVALID_KEYUSAGE_MESSAGE) \
+	ENTRY(0x025, TPM_WRONG_ENTITYTYPE_MESSAGE) \
+	ENTRY(0x026, TPM_INVALID_POSTINIT_MESSAGE) \
+	ENTRY(0x027, TPM_INAPPROPRIATE_SIG_MESSAGE) \
+	ENTRY(0x028, TPM_BAD_KEY_PROPERTY_MESSAGE) \
+	ENTRY(0x029, TPM_BAD_MIGRATION_MESSAGE) \
+	ENTRY(0x02A, TPM_BAD_SCHEME_MESSAGE) \
+	ENTRY(0x02B, TPM_BAD_DATASIZE_MESSAGE) \
+	ENTRY(0x02C, TPM_BAD_MODE_MESSAGE) \
+	ENTRY(0x02D, TPM_BAD_PRESENCE_MESSAGE) \
+	ENTRY(0x02E, TPM_BAD_VERSION_MESSAGE) \
+	ENTRY(0x02F, TPM_NO_WRAP_TRANSPORT_MESSAGE) \
+	ENTRY(0x030, TPM_AUDITFAIL_UNSUCCESSFUL_MESSAGE) \
+	ENTRY(0x031, TPM_AUDITFAIL_SUCCESSFUL_MESSAGE) \
+	ENTRY(0x032, TPM_NOTRESETABLE_MESSAGE) \
+	ENTRY(0x033, TPM_NOTLOCAL_MESSAGE) \
+	ENTRY(0x034, TPM_BAD_TYPE_MESSAGE) \
+	ENTRY(0x035, TPM_INVALID_RESOURCE_MESSAGE) \
+	ENTRY(0x036, TPM_NOTFIPS_MESSAGE) \
+	ENTRY(0x037, TPM_INVALID_FAMILY_MESSAGE) \
+	ENTRY(0x038, TPM_NO_NV_PERMISSION_MESSAGE) \
+	ENTRY(0x039, TPM_REQUIRES_SIGN_MESSAGE) \
+	ENTRY(0x03A, TPM_KEY_NOTSUPPORTED_MESSAGE) \
+	ENTRY(0x03B, TPM_AUTH_CONFLICT_MESSAGE) \
+	ENTRY(0x03C, TPM_AREA_LOCKED_MESSAGE) \
+	ENTRY(0x03D, TPM_BAD_LOCALITY_MESSAGE) \
+	ENTRY(0x03E, TPM_READ_ONLY_MESSAGE) \
+	ENTRY(0x03F, TPM_PER_NOWRITE_MESSAGE) \
+	ENTRY(0x040, TPM_FAMILYCOUNT_MESSAGE) \
+	ENTRY(0x041, TPM_WRITE_LOCKED_MESSAGE) \
+	ENTRY(0x042, TPM_BAD_ATTRIBUTES_MESSAGE) \
+	ENTRY(0x043, TPM_INVALID_STRUCTURE_MESSAGE) \
+	ENTRY(0x044, TPM_KEY_OWNER_CONTROL_MESSAGE) \
+	ENTRY(0x045, TPM_BAD_COUNTER_MESSAGE) \
+	ENTRY(0x046, TPM_NOT_FULLWRITE_MESSAGE) \
+	ENTRY(0x047, TPM_CONTEXT_GAP_MESSAGE) \
+	ENTRY(0x048, TPM_MAXNVWRITES_MESSAGE) \
+	ENTRY(0x049, TPM_NOOPERATOR_MESSAGE) \
+	ENTRY(0x04A, TPM_RESOURCEMISSING_MESSAGE) \
+	ENTRY(0x04B, TPM_DELEGATE_LOCK_MESSAGE) \
+	ENTRY(0x04C, TPM_DELEGATE_FAMILY_MESSAGE) \
+	ENTRY(0x04D, TPM_DELEGATE_ADMIN_MESSAGE) \
+	ENTRY(0x04E, TPM_TRANSPORT_NOTEXCLUSIVE_MESSAGE) \
+	ENTRY(0x04F, TPM_OWNER_CONTROL_MESSAGE) \
+	ENTRY(0x050, TPM_DAA_RESOURCES_MESSAGE) \
+	ENTRY(0x051, TPM_DAA_INPUT_DATA0_MESSAGE) \
+	ENTRY(0x052, TPM_DAA_INPUT_DATA1_MESSAGE) \
+	ENTRY(0x053, TPM_DAA_ISSUER_SETTINGS_MESSAGE) \
+	ENTRY(0x054, TPM_DAA_TPM_SETTINGS_MESSAGE) \
+	ENTRY(0x055, TPM_DAA_STAGE_MESSAGE) \
+	ENTRY(0x056, TPM_DAA_ISSUER_VALIDITY_MESSAGE) \
+	ENTRY(0x057, TPM_DAA_WRONG_W_MESSAGE) \
+	ENTRY(0x058, TPM_BAD_HANDLE_MESSAGE) \
+	ENTRY(0x059, TPM_BAD_DELEGATE_MESSAGE) \
+	ENTRY(0x05A, TPM_BADCONTEXT_MESSAGE) \
+	ENTRY(0x05B, TPM_TOOMANYCONTEXTS_MESSAGE) \
+	ENTRY(0x05C, TPM_MA_TICKET_SIGNATURE_MESSAGE) \
+	ENTRY(0x05D, TPM_MA_DESTINATION_MESSAGE) \
+	ENTRY(0x05E, TPM_MA_SOURCE_MESSAGE) \
+	ENTRY(0x05F, TPM_MA_AUTHORITY_MESSAGE) \
+	ENTRY(0x061, TPM_PERMANENTEK_MESSAGE) \
+	ENTRY(0x062, TPM_BAD_SIGNATURE_MESSAGE) \
+	ENTRY(0x063, TPM_NOCONTEXTSPACE_MESSAGE)
+
+/// TPM1.2 warning messages with their response code offset as index (TPM_BASE (0x0) + TPM_NON_FATAL (0x800) + offset)
+#define MESSAGECATALOG_LIST_TPM12_WARNINGS(ENTRY) \
+	ENTRY(0x000, TPM_RETRY_MESSAGE) \
+	ENTRY(0x001, TPM_NEEDS_SELFTEST_MESSAGE) \
+	ENTRY(0x002, TPM_DOING_SELFTEST_MESSAGE) \
+	ENTRY(0x003, TPM_DEFEND_LOCK_RUNNING_MESSAGE)
+
+/// Final error code messages with MESSAGECATALOG_APP_CODE_INDEX() of the error code as index
+#define MESSAGECATALOG_LIST_APP_ERRORS(ENTRY) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_FAIL), MSG_RC_E_FAIL) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_BAD_COMMANDLINE), MSG_RC_E_BAD_COMMANDLINE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM_GENERAL), MSG_RC_E_TPM_GENERAL) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INTERNAL), MSG_RC_E_INTERNAL) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_NO_TPM), MSG_RC_E_NO_TPM) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_NO_IFXTPM20), MSG_RC_E_NO_IFXTPM20) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_FLAGCHECK), MSG_RC_E_FLAGCHECK) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_EKCHECK), MSG_RC_E_EKCHECK) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_HASHCHECK), MSG_RC_E_HASHCHECK) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_REGISTERTEST), MSG_RC_E_REGISTERTEST) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_WRONG_ENCODING), MSG_RC_E_WRONG_ENCODING) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INTERRUPTED_FU), MSG_RC_E_INTERRUPTED_FU) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM_FIRMWARE_UPDATE), MSG_RC_E_TPM_FIRMWARE_UPDATE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_FW_OPTION), MSG_RC_E_INVALID_FW_OPTION) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_WRONG_FW_IMAGE), MSG_RC_E_WRONG_FW_IMAGE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_LOG_OPTION), MSG_RC_E_INVALID_LOG_OPTION) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_NO_IFX_TPM), MSG_RC_E_NO_IFX_TPM) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_PLATFORM_AUTH_NOT_EMPTY), MSG_RC_E_PLATFORM_AUTH_NOT_EMPTY) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_PLATFORM_HIERARCHY_DISABLED), MSG_RC_E_PLATFORM_HIERARCHY_DISABLED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_FW_UPDATE_BLOCKED), MSG_RC_E_FW_UPDATE_BLOCKED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_FIRMWARE_UPDATE_FAILED), MSG_RC_E_FIRMWARE_UPDATE_FAILED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_OWNED), MSG_RC_E_TPM12_OWNED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_NO_OWNER), MSG_RC_E_TPM12_NO_OWNER) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_INVALID_OWNERAUTH), MSG_RC_E_TPM12_INVALID_OWNERAUTH) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_PP_LOCKED), MSG_RC_E_TPM12_PP_LOCKED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_UPDATE_OPTION), MSG_RC_E_INVALID_UPDATE_OPTION) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_RESTART_REQUIRED), MSG_RC_E_RESTART_REQUIRED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_DEFERREDPP_REQUIRED), MSG_RC_E_TPM12_DEFERREDPP_REQUIRED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_DISABLED_DEACTIVATED), MSG_RC_E_TPM12_DISABLED_DEACTIVATED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_DA_ACTIVE), MSG_RC_E_TPM12_DA_ACTIVE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_NEWER_TOOL_REQUIRED), MSG_RC_E_NEWER_TOOL_REQUIRED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_UNSUPPORTED_CHIP), MSG_RC_E_UNSUPPORTED_CHIP) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_CORRUPT_FW_IMAGE), MSG_RC_E_CORRUPT_FW_IMAGE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_WRONG_DECRYPT_KEYS), MSG_RC_E_WRONG_DECRYPT_KEYS) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_NOT_SUPPORTED_FEATURE), MSG_RC_E_NOT_SUPPORTED_FEATURE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_DEVICE_ALREADY_IN_USE), MSG_RC_E_DEVICE_ALREADY_IN_USE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM_ACCESS_DENIED), MSG_RC_E_TPM_ACCESS_DENIED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_ACCESS_MODE), MSG_RC_E_INVALID_ACCESS_MODE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_SETTING), MSG_RC_E_INVALID_SETTING) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM_NOT_SUPPORTED_FEATURE), MSG_RC_E_TPM_NOT_SUPPORTED_FEATURE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM20_FAILURE_MODE), MSG_RC_E_TPM20_FAILURE_MODE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_CONFIG_OPTION), MSG_RC_E_INVALID_CONFIG_OPTION) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_FIRMWARE_UPDATE_NOT_FOUND), MSG_RC_E_FIRMWARE_UPDATE_NOT_FOUND) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_RESUME_RUNDATA_NOT_FOUND), MSG_RC_E_RESUME_RUNDATA_NOT_FOUND) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_TPM12_FAILED_SELFTEST), MSG_RC_E_TPM12_FAILED_SELFTEST) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_DEVICE_FAILED), MSG_RC_E_DEVICE_FAILED) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_UPDATE_PLAN_MISMATCH), MSG_RC_E_UPDATE_PLAN_MISMATCH) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_UPDATE_DEADLINE), MSG_RC_E_UPDATE_DEADLINE) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_SERVICE_BUSY), MSG_RC_E_SERVICE_BUSY) \
+	ENTRY(MESSAGECATALOG_APP_CODE_INDEX(RC_E_INVALID_FRAME_FILE), MSG_RC_E_INVALID_FRAME_FILE)
+
+/// Declares the pool member of a message
+#define MESSAGECATALOG_POOL_MEMBER(INDEX, NAME)	char sz##NAME[sizeof(NAME)];
+/// Initializes the pool member of a message
+#define MESSAGECATALOG_POOL_TEXT(INDEX, NAME)	NAME,
+/// Initializes the offset table slot of a message
+#define MESSAGECATALOG_OFFSET(INDEX, NAME)		[INDEX] = (unsigned short)offsetof(IfxMessagePool, sz##NAME),
+
+/**
+ *	@brief		String pool holding all messages as consecutive null-terminated UTF-8 strings
+ */
+typedef struct tdIfxMessagePool
+{
+	/// Placeholder so that offset 0 marks a missing message
+	char szNone[1];
+	MESSAGECATALOG_LIST_TPM20_SUCCESS(MESSAGECATALOG_POOL_MEMBER)
+	MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_ERRORS(MESSAGECATALOG_POOL_MEMBER)
+	MESSAGECATALOG_LIST_TPM20_FORMAT_ONE_ERRORS(MESSAGECATALOG_POOL_MEMBER)
+	MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_WARNINGS(MESSAGECATALOG_POOL_MEMBER)
+	MESSAGECATALOG_LIST_TPM12_ERRORS(MESSAGECATALOG_POOL_MEMBER)
+	MESSAGECATALOG_LIST_TPM12_WARNINGS(MESSAGECATALOG_POOL_MEMBER)
+	MESSAGECATALOG_LIST_APP_ERRORS(MESSAGECATALOG_POOL_MEMBER)
+} IfxMessagePool;
+
+// The offset tables use 16 bit offsets
+_Static_assert(sizeof(IfxMessagePool) <= 0xFFFF, "Message pool exceeds 16 bit offsets");
+
+/**
+ *	@brief		Offset table of a catalog table
+ */
+typedef struct tdIfxMessageCatalogTable
+{
+	/// Pool offsets of the messages with the message index as index
+	const unsigned short* rgusOffsets;
+	/// Number of slots in rgusOffsets
+	unsigned int unCount;
+} IfxMessageCatalogTable;
+
+/// The string pool
+static const IfxMessagePool s_sMessagePool =
+{
+	"",
+	MESSAGECATALOG_LIST_TPM20_SUCCESS(MESSAGECATALOG_POOL_TEXT)
+	MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_ERRORS(MESSAGECATALOG_POOL_TEXT)
+	MESSAGECATALOG_LIST_TPM20_FORMAT_ONE_ERRORS(MESSAGECATALOG_POOL_TEXT)
+	MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_WARNINGS(MESSAGECATALOG_POOL_TEXT)
+	MESSAGECATALOG_LIST_TPM12_ERRORS(MESSAGECATALOG_POOL_TEXT)
+	MESSAGECATALOG_LIST_TPM12_WARNINGS(MESSAGECATALOG_POOL_TEXT)
+	MESSAGECATALOG_LIST_APP_ERRORS(MESSAGECATALOG_POOL_TEXT)
+};
+
+static const unsigned short s_rgusTpm20Success[] = { MESSAGECATALOG_LIST_TPM20_SUCCESS(MESSAGECATALOG_OFFSET) };
+static const unsigned short s_rgusTpm20FormatZeroErrors[] = { MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_ERRORS(MESSAGECATALOG_OFFSET) };
+static const unsigned short s_rgusTpm20FormatOneErrors[] = { MESSAGECATALOG_LIST_TPM20_FORMAT_ONE_ERRORS(MESSAGECATALOG_OFFSET) };
+static const unsigned short s_rgusTpm20FormatZeroWarnings[] = { MESSAGECATALOG_LIST_TPM20_FORMAT_ZERO_WARNINGS(MESSAGECATALOG_OFFSET) };
+static const unsigned short s_rgusTpm12Errors[] = { MESSAGECATALOG_LIST_TPM12_ERRORS(MESSAGECATALOG_OFFSET) };
+static const unsigned short s_rgusTpm12Warnings[] = { MESSAGECATALOG_LIST_TPM12_WARNINGS(MESSAGECATALOG_OFFSET) };
+static const unsigned short s_rgusAppErrors[MESSAGECATALOG_APP_CODE_COUNT] = { MESSAGECATALOG_LIST_APP_ERRORS(MESSAGECATALOG_OFFSET) };
+
+/// Offset tables with ENUM_MESSAGECATALOG_TABLES as index
+static const IfxMessageCatalogTable s_rgsTables[MESSAGECATALOG_TABLE_COUNT] =
+{
+	[MESSAGECATALOG_TPM20_SUCCESS] = { s_rgusTpm20Success, sizeof(s_rgusTpm20Success) / sizeof(unsigned short) },
+	[MESSAGECATALOG_TPM20_FORMAT_ZERO_ERRORS] = { s_rgusTpm20FormatZeroErrors, sizeof(s_rgusTpm20FormatZeroErrors) / sizeof(unsigned short) },
+	[MESSAGECATALOG_TPM20_FORMAT_ONE_ERRORS] = { s_rgusTpm20FormatOneErrors, sizeof(s_rgusTpm20FormatOneErrors) / sizeof(unsigned short) },
+	[MESSAGECATALOG_TPM20_FORMAT_ZERO_WARNINGS] = { s_rgusTpm20FormatZeroWarnings, sizeof(s_rgusTpm20FormatZeroWarnings) / sizeof(unsigned short) },
+	[MESSAGECATALOG_TPM12_ERRORS] = { s_rgusTpm12Errors, sizeof(s_rgusTpm12Errors) / sizeof(unsigned short) },
+	[MESSAGECATALOG_TPM12_WARNINGS] = { s_rgusTpm12Warnings, sizeof(s_rgusTpm12Warnings) / sizeof(unsigned short) },
+	[MESSAGECATALOG_APP_ERRORS] = { s_rgusAppErrors, sizeof(s_rgusAppErrors) / sizeof(unsigned short) }
+};
+
+/**
+ *	@brief		Gets a message from the catalog
+ *	@details	Looks up the message by direct indexing and converts it from UTF-8 to a wide character string.
+ *
+ *	@param		PeTable					Table to look up the message in
+ *	@param		PunIndex				Index of the message in the table
+ *	@param		PwszMessage				Pointer to the destination buffer
+ *	@param		PpunMessageSize			In:		Capacity of the destination buffer in elements\n
+ *										Out:	Count of written elements (without the null-termination)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_FOUND			The table has no message for the index.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The destination buffer is too small.
+ */
+_Check_return_
+unsigned int
+MessageCatalog_GetMessage(
+	_In_							ENUM_MESSAGECATALOG_TABLES	PeTable,
+	_In_							unsigned int				PunIndex,
+	_Out_z_cap_(*PpunMessageSize)	wchar_t*					PwszMessage,
+	_Inout_							unsigned int*				PpunMessageSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unLength = 0;
+
+	do
+	{
+		const unsigned char* pbText = NULL;
+		unsigned short usOffset = 0;
+
+		// Check parameters
+		if (NULL == PwszMessage || NULL == PpunMessageSize || (unsigned int)PeTable >= MESSAGECATALOG_TABLE_COUNT)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Direct lookup of the pool offset
+		if (PunIndex < s_rgsTables[PeTable].unCount)
+			usOffset = s_rgsTables[PeTable].rgusOffsets[PunIndex];
+		if (0 == usOffset)
+		{
+			unReturnValue = RC_E_NOT_FOUND;
+			break;
+		}
+
+		// Decode the UTF-8 text, the pool is built by the compiler so the sequences are well-formed
+		unReturnValue = RC_SUCCESS;
+		pbText = (const unsigned char*)&s_sMessagePool + usOffset;
+		while ('\0' != *pbText)
+		{
+			wchar_t wcCharacter = 0;
+			unsigned int unFollowing = 0;
+
+			if (*pbText < 0x80)
+				wcCharacter = *pbText;
+			else if (0xC0 == (*pbText & 0xE0))
+			{
+				wcCharacter = *pbText & 0x1F;
+				unFollowing = 1;
+			}
+			else if (0xE0 == (*pbText & 0xF0))
+			{
+				wcCharacter = *pbText & 0x0F;
+				unFollowing = 2;
+			}
+			else
+			{
+				wcCharacter = *pbText & 0x07;
+				unFollowing = 3;
+			}
+			pbText++;
+			for (; unFollowing > 0 && 0x80 == (*pbText & 0xC0); unFollowing--, pbText++)
+				wcCharacter = (wchar_t)((wcCharacter << 6) | (*pbText & 0x3F));
+
+			// Keep space for the null-termination
+			if (unLength + 1 >= *PpunMessageSize)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				break;
+			}
+			PwszMessage[unLength++] = wcCharacter;
+		}
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS == unReturnValue)
+	{
+		PwszMessage[unLength] = L'\0';
+		*PpunMessageSize = unLength;
+	}
+	else
+	{
+		// Reset out parameters
+		if (NULL != PwszMessage && NULL != PpunMessageSize && 0 != *PpunMessageSize)
+			PwszMessage[0] = L'\0';
+		if (NULL != PpunMessageSize)
+			*PpunMessageSize = 0;
+	}
+
+	return unReturnValue;
+}
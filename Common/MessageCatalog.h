@@ -0,0 +1,85 @@
+﻿/**
+ *	@brief		Declares the message catalog
+ *	@details	The message catalog holds the TPM response code messages and the final error code messages in a single
+ *				UTF-8 string pool. Dense offset tables map a code directly to its message.
+ *	@file		MessageCatalog.h
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Number of index slots per final error code group (RC_APP_MASK + 0x100 * group), must exceed the largest offset in a group
+#define MESSAGECATALOG_APP_CODE_GROUP_SIZE		0x40
+/// Number of final error code groups (RC_E_FAIL group up to RC_E_TPM_FIRMWARE_UPDATE group)
+#define MESSAGECATALOG_APP_CODE_GROUP_COUNT		6
+/// Number of index slots for the final error codes
+#define MESSAGECATALOG_APP_CODE_COUNT			(MESSAGECATALOG_APP_CODE_GROUP_SIZE * MESSAGECATALOG_APP_CODE_GROUP_COUNT)
+
+/// Checks whether an error code (RC_APP_MASK based) has a slot in MESSAGECATALOG_APP_CODE_INDEX()
+#define MESSAGECATALOG_IS_APP_CODE(CODE)		((((CODE) - RC_APP_MASK) < 0x100U * MESSAGECATALOG_APP_CODE_GROUP_COUNT) && (((CODE) & 0xFF) < MESSAGECATALOG_APP_CODE_GROUP_SIZE))
+/// Maps an error code (RC_APP_MASK based) to its dense index slot, usable in constant expressions
+#define MESSAGECATALOG_APP_CODE_INDEX(CODE)		(((((CODE) - RC_APP_MASK) >> 8) * MESSAGECATALOG_APP_CODE_GROUP_SIZE) + ((CODE) & 0xFF))
+
+/**
+ *	@brief		Message tables of the catalog
+ */
+typedef enum td_ENUM_MESSAGECATALOG_TABLES
+{
+	/// TPM2.0 success message (index 0)
+	MESSAGECATALOG_TPM20_SUCCESS,
+	/// TPM2.0 Format-Zero error messages (index: response code offset to RC_VER1)
+	MESSAGECATALOG_TPM20_FORMAT_ZERO_ERRORS,
+	/// TPM2.0 Format-One error messages (index: response code offset to RC_FMT1)
+	MESSAGECATALOG_TPM20_FORMAT_ONE_ERRORS,
+	/// TPM2.0 Format-Zero warning messages (index: response code offset to RC_WARN)
+	MESSAGECATALOG_TPM20_FORMAT_ZERO_WARNINGS,
+	/// TPM1.2 error messages (index: response code offset to TPM_BASE)
+	MESSAGECATALOG_TPM12_ERRORS,
+	/// TPM1.2 warning messages (index: response code offset to TPM_BASE + TPM_NON_FATAL)
+	MESSAGECATALOG_TPM12_WARNINGS,
+	/// Final error code messages (index: MESSAGECATALOG_APP_CODE_INDEX())
+	MESSAGECATALOG_APP_ERRORS,
+	/// Number of tables
+	MESSAGECATALOG_TABLE_COUNT
+} ENUM_MESSAGECATALOG_TABLES;
+
+/**
+ *	@brief		Gets a message from the catalog
+ *	@details	Looks up the message by direct indexing and converts it from UTF-8 to a wide character string.
+ *
+ *	@param		PeTable					Table to look up the message in
+ *	@param		PunIndex				Index of the message in the table
+ *	@param		PwszMessage				Pointer to the destination buffer
+ *	@param		PpunMessageSize			In:		Capacity of the destination buffer in elements\n
+ *										Out:	Count of written elements (without the null-termination)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_FOUND			The table has no message for the index.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The destination buffer is too small.
+ */
+_Check_return_
+unsigned int
+MessageCatalog_GetMessage(
+	_In_							ENUM_MESSAGECATALOG_TABLES	PeTable,
+	_In_							unsigned int				PunIndex,
+	_Out_z_cap_(*PpunMessageSize)	wchar_t*					PwszMessage,
+	_Inout_							unsigned int*				PpunMessageSize);
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,6 +32,7 @@
 
 // Windows
 #ifdef WINDOWS
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
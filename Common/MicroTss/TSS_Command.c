@@ -0,0 +1,240 @@
+﻿/**
+ *	@brief		Implements the shared command execution of the MicroTss wrappers
+ *	@details	All TPM command wrappers marshal their request into one request buffer, transmit it and unmarshal the
+ *				response from one response buffer. This module owns these buffers and implements the steps every
+ *				command has in common: the command header, the command size, the transmission and the response header.
+ *	@file		TSS_Command.c
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TSS_Command.h"
+#include "TPM2_Marshal.h"
+#include "DeviceManagement.h"
+#include "Platform.h"
+#include "Session.h"
+
+#if SESSION_COMMAND_BUFFER_SIZE < MAX_COMMAND_SIZE || SESSION_COMMAND_BUFFER_SIZE < MAX_RESPONSE_SIZE
+#error The command buffers of the session scratch area are too small.
+#endif
+
+/// Callbacks invoked around all TPM commands
+static TSS_COMMAND_CONTEXT s_sCommandContext;
+
+/**
+ *	@brief		Starts a TPM command
+ *	@details	Marshals the command header into the request buffer of the session. The command size is filled in by
+ *				TSS_Command_Execute. The buffers are not reentrant, a command must be executed before the next one of
+ *				the same session is started.
+ *
+ *	@param		PusTag				Command tag (TPM_TAG or TPM_ST)
+ *	@param		PunCommandCode		Command ordinal (TPM_COMMAND_CODE or TPM_CC)
+ *	@param		PppbBuffer			Receives the location in the request buffer where the command parameters are to be placed
+ *	@param		PpnSizeRemaining	Receives the number of octets remaining in the request buffer
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+TSS_Command_Begin(
+	_In_	UINT16		PusTag,
+	_In_	UINT32		PunCommandCode,
+	_Out_	BYTE**		PppbBuffer,
+	_Out_	INT32*		PpnSizeRemaining)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	do
+	{
+		BYTE* pbBuffer = Session_GetScratch()->rgbCommandRequest;
+
+		if (NULL == PppbBuffer || NULL == PpnSizeRemaining)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// The command size is unknown until all parameters are marshalled
+		TSS_UINT16_MarshalUnchecked(PusTag, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(0, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(PunCommandCode, &pbBuffer);
+
+		*PppbBuffer = pbBuffer;
+		*PpnSizeRemaining = MAX_COMMAND_SIZE - TSS_COMMAND_HEADER_SIZE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Executes the TPM command started with TSS_Command_Begin
+ *	@details	Fills in the command size, transmits the request and unmarshals the response header.
+ *
+ *	@param		PppbBuffer			In: end of the marshalled request. Out: location of the response parameters
+ *	@param		PpnSizeRemaining	Out: number of response octets following the response header
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions. or TPM masked error code
+ */
+_Check_return_
+unsigned int
+TSS_Command_Execute(
+	_Inout_	BYTE**		PppbBuffer,
+	_Inout_	INT32*		PpnSizeRemaining)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	do
+	{
+		BYTE* rgbRequest = Session_GetScratch()->rgbCommandRequest;
+		BYTE* pbSize = rgbRequest + sizeof(UINT16);
+		unsigned int unCommandSize = 0;
+
+		// The end of the request must lie within the request buffer
+		if (NULL == PppbBuffer || NULL == PpnSizeRemaining ||
+			*PppbBuffer < rgbRequest + TSS_COMMAND_HEADER_SIZE ||
+			*PppbBuffer > rgbRequest + MAX_COMMAND_SIZE)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Overwrite the command size
+		unCommandSize = (unsigned int)(*PppbBuffer - rgbRequest);
+		TSS_UINT32_MarshalUnchecked(unCommandSize, &pbSize);
+
+		unReturnValue = TSS_Command_Transmit(rgbRequest, unCommandSize, PppbBuffer, PpnSizeRemaining);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Transmits a completely marshalled TPM command
+ *	@details	Used for requests that were marshalled ahead of time. The response is received into the response
+ *				buffer of the session and its header is unmarshalled.
+ *
+ *	@param		PrgbRequest			Marshalled request
+ *	@param		PunRequestSize		Size of the marshalled request
+ *	@param		PppbBuffer			Receives the location of the response parameters
+ *	@param		PpnSizeRemaining	Receives the number of response octets following the response header
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions. or TPM masked error code
+ */
+_Check_return_
+unsigned int
+TSS_Command_Transmit(
+	_In_bytecount_(PunRequestSize)	const BYTE*		PrgbRequest,
+	_In_							unsigned int	PunRequestSize,
+	_Out_							BYTE**			PppbBuffer,
+	_Out_							INT32*			PpnSizeRemaining)
+{
+	IfxTpmIoSegment sSegment = { PrgbRequest, PunRequestSize };
+
+	return TSS_Command_TransmitSegments(&sSegment, 1, PppbBuffer, PpnSizeRemaining);
+}
+
+/**
+ *	@brief		Transmits a completely marshalled TPM command given in several parts
+ *	@details	Used for requests whose large parameters are sent from where they are stored. The first part must
+ *				hold at least the command header. The response is received into the response buffer of the session and
+ *				its header is unmarshalled.
+ *
+ *	@param		PrgsRequestSegments	Parts of the marshalled request
+ *	@param		PunSegmentCount		Number of parts
+ *	@param		PppbBuffer			Receives the location of the response parameters
+ *	@param		PpnSizeRemaining	Receives the number of response octets following the response header
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions. or TPM masked error code
+ */
+_Check_return_
+unsigned int
+TSS_Command_TransmitSegments(
+	_In_reads_(PunSegmentCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_						unsigned int			PunSegmentCount,
+	_Out_						BYTE**					PppbBuffer,
+	_Out_						INT32*					PpnSizeRemaining)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	do
+	{
+		BYTE* rgbResponse = Session_GetScratch()->rgbCommandResponse;
+		unsigned int unResponseBufferSize = MAX_RESPONSE_SIZE;
+		unsigned long long ullStartTime = 0;
+		unsigned int unRequestSize = 0;
+		unsigned int unSegment = 0;
+		const BYTE* pbHeader = NULL;
+		UINT32 unCommandCode = 0;
+		// Response header
+		UINT16 usTag = 0;
+		UINT32 unResponseSize = 0;
+		UINT32 unResponseCode = 0;
+
+		if (NULL == PrgsRequestSegments || 0 == PunSegmentCount || NULL == PrgsRequestSegments[0].pbData ||
+			TSS_COMMAND_HEADER_SIZE > PrgsRequestSegments[0].unSize || NULL == PppbBuffer || NULL == PpnSizeRemaining)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		for (unSegment = 0; unSegment < PunSegmentCount; unSegment++)
+			unRequestSize += PrgsRequestSegments[unSegment].unSize;
+		*PppbBuffer = rgbResponse;
+		*PpnSizeRemaining = 0;
+
+		pbHeader = PrgsRequestSegments[0].pbData;
+		unCommandCode = ((UINT32)pbHeader[6] << 24) | ((UINT32)pbHeader[7] << 16) | ((UINT32)pbHeader[8] << 8) | pbHeader[9];
+		if (NULL != s_sCommandContext.pfnBefore)
+			s_sCommandContext.pfnBefore(unCommandCode, unRequestSize);
+		if (NULL != s_sCommandContext.pfnAfter)
+			ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+
+		// Transmit the command over TDDL
+		unReturnValue = DeviceManagement_TransmitSegments(PrgsRequestSegments, PunSegmentCount, rgbResponse, &unResponseBufferSize);
+		if (RC_SUCCESS == unReturnValue)
+		{
+			// Unmarshal the response header
+			*PpnSizeRemaining = (INT32)unResponseBufferSize;
+			unReturnValue = TSS_UINT16_Unmarshal(&usTag, PppbBuffer, PpnSizeRemaining);
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, PppbBuffer, PpnSizeRemaining);
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = TSS_UINT32_Unmarshal(&unResponseCode, PppbBuffer, PpnSizeRemaining);
+			if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unResponseCode)
+				unReturnValue = RC_TPM_MASK | unResponseCode;
+		}
+
+		if (NULL != s_sCommandContext.pfnAfter)
+			s_sCommandContext.pfnAfter(unCommandCode, unReturnValue, Platform_GetMonotonicTimeMicroSeconds() - ullStartTime);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Sets the callbacks invoked around every TPM command (e.g. for timing measurements)
+ *
+ *	@param		PfnBefore		Callback invoked before a command is transmitted or NULL
+ *	@param		PfnAfter		Callback invoked after a command has been transmitted or NULL
+ */
+void
+TSS_Command_SetHooks(
+	_In_opt_	PFN_TSS_COMMAND_BEFORE	PfnBefore,
+	_In_opt_	PFN_TSS_COMMAND_AFTER	PfnAfter)
+{
+	s_sCommandContext.pfnBefore = PfnBefore;
+	s_sCommandContext.pfnAfter = PfnAfter;
+}
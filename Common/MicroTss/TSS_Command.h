@@ -0,0 +1,153 @@
+﻿/**
+ *	@brief		Declares the shared command execution of the MicroTss wrappers
+ *	@details	All TPM command wrappers marshal their request into one request buffer, transmit it and unmarshal the
+ *				response from one response buffer. The buffers are held by the scratch area of the session (see
+ *				IfxSessionScratch), so the wrappers need little stack and each session can run its commands on its own
+ *				thread. This module implements the steps every command has in common: the command header, the command
+ *				size, the transmission and the response header.
+ *	@file		TSS_Command.h
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "TPM2_Types.h"
+#include "TpmIO.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Size of the command and response header (tag, size and command or response code)
+#define TSS_COMMAND_HEADER_SIZE		10
+
+/// Callback function invoked before a TPM command is transmitted
+typedef void (*PFN_TSS_COMMAND_BEFORE)(
+	UINT32			PunCommandCode,
+	UINT32			PunRequestSize);
+
+/// Callback function invoked after a TPM command has been transmitted and its response header was checked
+typedef void (*PFN_TSS_COMMAND_AFTER)(
+	UINT32				PunCommandCode,
+	unsigned int		PunReturnValue,
+	unsigned long long	PullDurationMicroSeconds);
+
+/**
+ *	@brief		Command context
+ *	@details	Holds the callbacks invoked around every command. The request and response buffers of the session scratch
+ *				area are reused by all commands of a session. They are not cleared between commands because only the
+ *				marshalled part of the request and the received part of the response are read.
+ */
+typedef struct tdTSS_COMMAND_CONTEXT
+{
+	/// Callback invoked before a command is transmitted (may be NULL)
+	PFN_TSS_COMMAND_BEFORE pfnBefore;
+	/// Callback invoked after a command has been transmitted (may be NULL)
+	PFN_TSS_COMMAND_AFTER pfnAfter;
+} TSS_COMMAND_CONTEXT;
+
+/**
+ *	@brief		Starts a TPM command
+ *	@details	Marshals the command header into the request buffer of the session. The command size is filled in by
+ *				TSS_Command_Execute. The buffers are not reentrant, a command must be executed before the next one of
+ *				the same session is started.
+ *
+ *	@param		PusTag				Command tag (TPM_TAG or TPM_ST)
+ *	@param		PunCommandCode		Command ordinal (TPM_COMMAND_CODE or TPM_CC)
+ *	@param		PppbBuffer			Receives the location in the request buffer where the command parameters are to be placed
+ *	@param		PpnSizeRemaining	Receives the number of octets remaining in the request buffer
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+TSS_Command_Begin(
+	_In_	UINT16		PusTag,
+	_In_	UINT32		PunCommandCode,
+	_Out_	BYTE**		PppbBuffer,
+	_Out_	INT32*		PpnSizeRemaining);
+
+/**
+ *	@brief		Executes the TPM command started with TSS_Command_Begin
+ *	@details	Fills in the command size, transmits the request and unmarshals the response header.
+ *
+ *	@param		PppbBuffer			In: end of the marshalled request. Out: location of the response parameters
+ *	@param		PpnSizeRemaining	Out: number of response octets following the response header
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions. or TPM masked error code
+ */
+_Check_return_
+unsigned int
+TSS_Command_Execute(
+	_Inout_	BYTE**		PppbBuffer,
+	_Inout_	INT32*		PpnSizeRemaining);
+
+/**
+ *	@brief		Transmits a completely marshalled TPM command
+ *	@details	Used for requests that were marshalled ahead of time. The response is received into the shared
+ *				response buffer of the session and its header is unmarshalled.
+ *
+ *	@param		PrgbRequest			Marshalled request
+ *	@param		PunRequestSize		Size of the marshalled request
+ *	@param		PppbBuffer			Receives the location of the response parameters
+ *	@param		PpnSizeRemaining	Receives the number of response octets following the response header
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions. or TPM masked error code
+ */
+_Check_return_
+unsigned int
+TSS_Command_Transmit(
+	_In_bytecount_(PunRequestSize)	const BYTE*		PrgbRequest,
+	_In_							unsigned int	PunRequestSize,
+	_Out_							BYTE**			PppbBuffer,
+	_Out_							INT32*			PpnSizeRemaining);
+
+/**
+ *	@brief		Transmits a completely marshalled TPM command given in several parts
+ *	@details	Used for requests whose large parameters are sent from where they are stored. The first part must
+ *				hold at least the command header. The response is received into the response buffer of the session and
+ *				its header is unmarshalled.
+ *
+ *	@param		PrgsRequestSegments	Parts of the marshalled request
+ *	@param		PunSegmentCount		Number of parts
+ *	@param		PppbBuffer			Receives the location of the response parameters
+ *	@param		PpnSizeRemaining	Receives the number of response octets following the response header
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions. or TPM masked error code
+ */
+_Check_return_
+unsigned int
+TSS_Command_TransmitSegments(
+	_In_reads_(PunSegmentCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_						unsigned int			PunSegmentCount,
+	_Out_						BYTE**					PppbBuffer,
+	_Out_						INT32*					PpnSizeRemaining);
+
+/**
+ *	@brief		Sets the callbacks invoked around every TPM command (e.g. for timing measurements)
+ *
+ *	@param		PfnBefore		Callback invoked before a command is transmitted or NULL
+ *	@param		PfnAfter		Callback invoked after a command has been transmitted or NULL
+ */
+void
+TSS_Command_SetHooks(
+	_In_opt_	PFN_TSS_COMMAND_BEFORE	PfnBefore,
+	_In_opt_	PFN_TSS_COMMAND_AFTER	PfnAfter);
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,7 +18,7 @@
 #include "TPM_FieldUpgradeComplete.h"
 #include "TPM2_Marshal.h"
 #include "TPM2_FieldUpgradeMarshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 #include "TPM_Types.h"
 #include "Platform.h"
 
@@ -43,21 +43,14 @@ TSS_TPM_FieldUpgradeComplete(
 
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
-		BYTE* pbBuffer = rgbRequest;
-		INT32 nSizeRemaining = sizeof(rgbRequest), nSizeResponse = sizeof(rgbResponse);
+		BYTE* pbBuffer = NULL;
+		INT32 nSizeRemaining = 0;
 
 		// Request parameters
 		TPM_ST tag = TPM_TAG_RQU_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM_CC_FieldUpgradeCommand;
 		SubCmd_d subCommand = TPM_FieldUpgradeComplete;
 
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
-
 		// LRC
 		BYTE bLRC = 0;
 		BYTE* pbLRCBuffer = NULL;
@@ -68,13 +61,7 @@ TSS_TPM_FieldUpgradeComplete(
 			break;
 
 		// Marshal the request
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -101,36 +88,11 @@ TSS_TPM_FieldUpgradeComplete(
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
 		// Unmarshal out complete size
 		unReturnValue = TSS_UINT16_Unmarshal(PpusOutCompleteSize, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
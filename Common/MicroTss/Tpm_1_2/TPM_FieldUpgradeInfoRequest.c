@@ -18,7 +18,7 @@
 #include "TPM2_Marshal.h"
 #include "TPM2_FieldUpgradeTypes.h"
 #include "TPM2_FieldUpgradeMarshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 
 /**
  *	@brief		Calls TPM_FieldUpgradeInfoRequest.
@@ -38,31 +38,17 @@ TSS_TPM_FieldUpgradeInfoRequest(
 
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		UINT32 unSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		UINT16 usTemp = 0;
 		// Request parameters
 		TPM_ST tag = TPM_TAG_RQU_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM_CC_FieldUpgradeCommand;
 		SubCmd_d subCommandCode = TPM_FieldUpgradeInfoRequest;
 		UINT16 usInInfoRequestSize = 0;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
 
 		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 		unReturnValue = TSS_SubCmd_d_Marshal(&subCommandCode, &pbBuffer, &nSizeRemaining);
@@ -72,35 +58,12 @@ TSS_TPM_FieldUpgradeInfoRequest(
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Update command size
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + sizeof(tag);
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, &unSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
 		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = unSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK + responseCode;
-			break;
-		}
 		unReturnValue = TSS_UINT16_Unmarshal(&usTemp, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
 			break;
@@ -14,6 +14,7 @@
  */
 
 #include "TPM_FieldUpgradeInfoRequest2.h"
+#include "TSS_Command.h"
 #include "TPM_Types.h"
 #include "Platform.h"
 
@@ -35,21 +36,14 @@ TSS_TPM_FieldUpgradeInfoRequest2(
 
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		UINT32 unSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		UINT16 usTemp = 0;
 		// Request parameters
 		TPM_ST tag = TPM_TAG_RQU_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM_CC_FieldUpgradeCommand;
 		SubCmd_d subCommandCode = TPM_FieldUpgradeInfoRequest2;
 		UINT16 usInInfoRequestSize = 0;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
 
 		// Initialize _Out_ parameters
 		unReturnValue = Platform_MemorySet(PpSecurityModuleLogicInfo, 0x00, sizeof(sSecurityModuleLogicInfo_d));
@@ -57,14 +51,7 @@ TSS_TPM_FieldUpgradeInfoRequest2(
 			break;
 
 		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 		unReturnValue = TSS_SubCmd_d_Marshal(&subCommandCode, &pbBuffer, &nSizeRemaining);
@@ -74,35 +61,11 @@ TSS_TPM_FieldUpgradeInfoRequest2(
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Update command size
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + sizeof(tag);
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, &unSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = unSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
 		// Unmarshal buffer size
 		unReturnValue = TSS_UINT16_Unmarshal(&usTemp, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
@@ -14,6 +14,7 @@
  */
 
 #include "TPM_FieldUpgradeStart.h"
+#include "TSS_Command.h"
 
 /**
  *	@brief		Calls TPM_FieldUpgradeStart.
@@ -43,21 +44,14 @@ TSS_TPM_FieldUpgradeStart(
 
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		UINT32 unSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		// Request parameters
 		TPM_ST tag = TPM_TAG_RQU_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM_CC_FieldUpgradeCommand;
 		BYTE* pbLRCStart = NULL;
 		SubCmd_d subCommandCode = TPM_FieldUpgradeStart;
 		BYTE bLRC = 0;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
 		// Authorization session parameters
 		UINT16 usInParamDigestSize = 0;
 		BYTE *pbInParamDigest = NULL;
@@ -80,14 +74,7 @@ TSS_TPM_FieldUpgradeStart(
 		}
 
 		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
@@ -176,35 +163,12 @@ TSS_TPM_FieldUpgradeStart(
 				break;
 		}
 
-		// Update command size
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + sizeof(tag);
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, &unSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
 		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = unSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
 	}
 	WHILE_FALSE_END;
 
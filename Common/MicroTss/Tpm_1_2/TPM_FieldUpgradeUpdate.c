@@ -15,14 +15,18 @@
  */
 
 #include "TPM_FieldUpgradeUpdate.h"
+#include "TSS_Command.h"
 #include "TPM_Types.h"
 
 /**
- *	@brief		Calls TPM_Fieldupgrade.
- *	@details	Transmits the TPM1.2 command TPM_Fieldupgrade with the given data block.
+ *	@brief		Prepares a TPM_FieldUpgradeUpdate request.
+ *	@details	Marshals the header of the TPM1.2 command TPM_Fieldupgrade and computes the LRC for the given data
+ *				block, so that the request can be transmitted later with TSS_TPM_FieldUpgradeUpdate_TransmitRequest.
+ *				The data block is not copied and must stay valid until the request is transmitted.
  *
  *	@param		PpbFieldUpgradeBlock		Pointer on data block to be sent
  *	@param		PunFieldUpgradeBlockSize	Size of data block to be sent in bytes
+ *	@param		PpsRequest					Request to prepare
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
  *	@retval		RC_E_FAIL					An unexpected error occurred.
@@ -30,87 +34,191 @@
  */
 _Check_return_
 unsigned int
-TSS_TPM_FieldUpgradeUpdate(
-	_In_bytecount_(PunFieldUpgradeBlockSize)	const BYTE*		PpbFieldUpgradeBlock,
-	_In_										UINT16			PunFieldUpgradeBlockSize)
+TSS_TPM_FieldUpgradeUpdate_PrepareRequest(
+	_In_bytecount_(PunFieldUpgradeBlockSize)	const BYTE*								PpbFieldUpgradeBlock,
+	_In_										UINT16									PunFieldUpgradeBlockSize,
+	_Out_										TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*		PpsRequest)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		UINT32 unSizeResponse = sizeof(rgbResponse);
 		// Request parameters
 		TPM_ST tag = TPM_TAG_RQU_COMMAND;
 		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM_CC_FieldUpgradeCommand;
-		BYTE* pbLRCStart = NULL;
 		SubCmd_d subCommandCode = TPM_FieldUpgradeUpdate;
-		BYTE bLRC = 0;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
-
-		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		pbLRCStart = pbBuffer; // Store current position for later LRC calculation
-		unReturnValue = TSS_SubCmd_d_Marshal(&subCommandCode, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
+
+		if (NULL == PpsRequest || NULL == PpbFieldUpgradeBlock)
 			break;
-		unReturnValue = TSS_UINT16_Marshal(&PunFieldUpgradeBlockSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
+		unCommandSize = TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD + PunFieldUpgradeBlockSize;
+
+		// Marshal the header (the layout is fixed and matches the size of rgbHeader)
+		pbBuffer = PpsRequest->rgbHeader;
+		TSS_UINT16_MarshalUnchecked(tag, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(unCommandSize, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(commandCode, &pbBuffer);
+		TSS_UINT8_MarshalUnchecked(subCommandCode, &pbBuffer);
+		TSS_UINT16_MarshalUnchecked(PunFieldUpgradeBlockSize, &pbBuffer);
+
+		// The LRC covers everything behind the command code: sub command, data size and data block
+		PpsRequest->pbBlock = PpbFieldUpgradeBlock;
+		PpsRequest->usBlockSize = PunFieldUpgradeBlockSize;
+		PpsRequest->bLRC = TSS_CalcLRC(&PpsRequest->rgbHeader[TSS_COMMAND_HEADER_SIZE], TPM_FIELDUPGRADEUPDATE_HEADER_SIZE - TSS_COMMAND_HEADER_SIZE) ^
+							TSS_CalcLRC(PpbFieldUpgradeBlock, PunFieldUpgradeBlockSize);
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Transmits a prepared TPM_FieldUpgradeUpdate request.
+ *	@details	Sends the header, the data block and the LRC of a request prepared by
+ *				TSS_TPM_FieldUpgradeUpdate_PrepareRequest and checks the response code.
+ *
+ *	@param		PpsRequest					Prepared request
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from Micro TSS functions
+ */
+_Check_return_
+unsigned int
+TSS_TPM_FieldUpgradeUpdate_TransmitRequest(
+	_In_	const TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*	PpsRequest)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		BYTE* pbBuffer = NULL;
+		INT32 nSizeRemaining = 0;
+		IfxTpmIoSegment rgsSegments[3];
+
+		if (NULL == PpsRequest)
 			break;
-		unReturnValue = TSS_BYTE_Array_Marshal(PpbFieldUpgradeBlock, &pbBuffer, &nSizeRemaining, PunFieldUpgradeBlockSize);
+
+		// Send the data block from where it is stored
+		rgsSegments[0].pbData = PpsRequest->rgbHeader;
+		rgsSegments[0].unSize = sizeof(PpsRequest->rgbHeader);
+		rgsSegments[1].pbData = PpsRequest->pbBlock;
+		rgsSegments[1].unSize = PpsRequest->usBlockSize;
+		rgsSegments[2].pbData = &PpsRequest->bLRC;
+		rgsSegments[2].unSize = sizeof(PpsRequest->bLRC);
+
+		// Transmit the command and unmarshal the response header (the response has no parameters)
+		unReturnValue = TSS_Command_TransmitSegments(rgsSegments, RG_LEN(rgsSegments), &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
-		bLRC = TSS_CalcLRC(pbLRCStart, (UINT32)(pbBuffer - pbLRCStart)); // Calculate LRC beginning from stored location to current pointer position
-		unReturnValue = TSS_UINT8_Marshal(&bLRC, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Transmits several prepared TPM_FieldUpgradeUpdate requests in one round trip.
+ *	@details	Hands the requests prepared by TSS_TPM_FieldUpgradeUpdate_PrepareRequest over to
+ *				DeviceManagement_TransmitBatch. The TPM executes them back to back until the first one which fails.
+ *
+ *	@param		PrgsRequests				Prepared requests
+ *	@param		PunRequestCount				Number of requests (at most TPMIO_BATCH_MAX_REQUESTS)
+ *	@param		PpunCompleted				Receives the number of requests which completed successfully
+ *
+ *	@retval		RC_SUCCESS					All requests completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The transport cannot transmit several requests in one round trip.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The request following the completed ones could not be transmitted to the TPM.
+ *	@retval		...							The TPM response code of the failed request with RC_TPM_MASK or error codes from
+ *											DeviceManagement_TransmitBatch
+ */
+_Check_return_
+unsigned int
+TSS_TPM_FieldUpgradeUpdate_TransmitRequests(
+	_In_reads_(PunRequestCount)		const TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*	PrgsRequests,
+	_In_							unsigned int								PunRequestCount,
+	_Out_							unsigned int*								PpunCompleted)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxTpmIoSegment rgsSegments[TPMIO_BATCH_MAX_REQUESTS * 3];
+		unsigned int rgunResponseCodes[TPMIO_BATCH_MAX_REQUESTS] = {0};
+		unsigned int unExecuted = 0;
+		unsigned int unRequest = 0;
+
+		if (NULL == PrgsRequests || 0 == PunRequestCount || PunRequestCount > TPMIO_BATCH_MAX_REQUESTS || NULL == PpunCompleted)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
+		}
+		*PpunCompleted = 0;
+
+		// Send the data blocks from where they are stored
+		for (unRequest = 0; unRequest < PunRequestCount; unRequest++)
+		{
+			rgsSegments[unRequest * 3].pbData = PrgsRequests[unRequest].rgbHeader;
+			rgsSegments[unRequest * 3].unSize = sizeof(PrgsRequests[unRequest].rgbHeader);
+			rgsSegments[unRequest * 3 + 1].pbData = PrgsRequests[unRequest].pbBlock;
+			rgsSegments[unRequest * 3 + 1].unSize = PrgsRequests[unRequest].usBlockSize;
+			rgsSegments[unRequest * 3 + 2].pbData = &PrgsRequests[unRequest].bLRC;
+			rgsSegments[unRequest * 3 + 2].unSize = sizeof(PrgsRequests[unRequest].bLRC);
+		}
 
-		// Update command size
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + sizeof(tag);
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		unReturnValue = DeviceManagement_TransmitBatch(rgsSegments, 3, PunRequestCount, rgunResponseCodes, &unExecuted);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, &unSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
+		// Only the last executed request can have failed
+		while (*PpunCompleted < unExecuted && RC_SUCCESS == rgunResponseCodes[*PpunCompleted])
+			(*PpunCompleted)++;
+		if (*PpunCompleted == PunRequestCount)
+			unReturnValue = RC_SUCCESS;
+		else if (*PpunCompleted == unExecuted || TPMIO_BATCH_TRANSPORT_ERROR == rgunResponseCodes[*PpunCompleted])
+			unReturnValue = RC_E_TPM_TRANSMIT_DATA;
+		else
+			unReturnValue = RC_TPM_MASK | rgunResponseCodes[*PpunCompleted];
+	}
+	WHILE_FALSE_END;
 
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = unSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Calls TPM_Fieldupgrade.
+ *	@details	Transmits the TPM1.2 command TPM_Fieldupgrade with the given data block.
+ *
+ *	@param		PpbFieldUpgradeBlock		Pointer on data block to be sent
+ *	@param		PunFieldUpgradeBlockSize	Size of data block to be sent in bytes
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from Micro TSS functions
+ */
+_Check_return_
+unsigned int
+TSS_TPM_FieldUpgradeUpdate(
+	_In_bytecount_(PunFieldUpgradeBlockSize)	const BYTE*		PpbFieldUpgradeBlock,
+	_In_										UINT16			PunFieldUpgradeBlockSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		TSS_TPM_FIELDUPGRADEUPDATE_REQUEST sRequest;
+
+		unReturnValue = TSS_TPM_FieldUpgradeUpdate_PrepareRequest(PpbFieldUpgradeBlock, PunFieldUpgradeBlockSize, &sRequest);
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		}
+
+		unReturnValue = TSS_TPM_FieldUpgradeUpdate_TransmitRequest(&sRequest);
 	}
 	WHILE_FALSE_END;
 
 	return unReturnValue;
-}
\ No newline at end of file
+}
@@ -26,6 +26,87 @@
 extern "C" {
 #endif
 
+/// Size of a TPM_FieldUpgradeUpdate request without the data block: header, sub command, data size and LRC
+#define TPM_FIELDUPGRADEUPDATE_REQUEST_OVERHEAD	(10 + 1 + 2 + 1)
+/// Size of the TPM_FieldUpgradeUpdate request part in front of the data block: header, sub command and data size
+#define TPM_FIELDUPGRADEUPDATE_HEADER_SIZE		(10 + 1 + 2)
+
+/**
+ *	@brief		Prepared TPM_FieldUpgradeUpdate request
+ *	@details	Holds the marshalled parts of the request around the data block, which is referenced in place.
+ */
+typedef struct tdTSS_TPM_FIELDUPGRADEUPDATE_REQUEST
+{
+	/// Marshalled command header, sub command and data size
+	BYTE rgbHeader[TPM_FIELDUPGRADEUPDATE_HEADER_SIZE];
+	/// Data block to be sent
+	const BYTE* pbBlock;
+	/// Size of the data block in bytes
+	UINT16 usBlockSize;
+	/// LRC over sub command, data size and data block
+	BYTE bLRC;
+} TSS_TPM_FIELDUPGRADEUPDATE_REQUEST;
+
+/**
+ *	@brief		Prepares a TPM_FieldUpgradeUpdate request.
+ *	@details	Marshals the header of the TPM1.2 command TPM_Fieldupgrade and computes the LRC for the given data
+ *				block, so that the request can be transmitted later with TSS_TPM_FieldUpgradeUpdate_TransmitRequest.
+ *				The data block is not copied and must stay valid until the request is transmitted.
+ *
+ *	@param		PpbFieldUpgradeBlock		Pointer on data block to be sent
+ *	@param		PunFieldUpgradeBlockSize	Size of data block to be sent in bytes
+ *	@param		PpsRequest					Request to prepare
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from Micro TSS functions
+ */
+_Check_return_
+unsigned int
+TSS_TPM_FieldUpgradeUpdate_PrepareRequest(
+	_In_bytecount_(PunFieldUpgradeBlockSize)	const BYTE*								PpbFieldUpgradeBlock,
+	_In_										UINT16									PunFieldUpgradeBlockSize,
+	_Out_										TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*		PpsRequest);
+
+/**
+ *	@brief		Transmits a prepared TPM_FieldUpgradeUpdate request.
+ *	@details	Sends the header, the data block and the LRC of a request prepared by
+ *				TSS_TPM_FieldUpgradeUpdate_PrepareRequest and checks the response code.
+ *
+ *	@param		PpsRequest					Prepared request
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from Micro TSS functions
+ */
+_Check_return_
+unsigned int
+TSS_TPM_FieldUpgradeUpdate_TransmitRequest(
+	_In_	const TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*	PpsRequest);
+
+/**
+ *	@brief		Transmits several prepared TPM_FieldUpgradeUpdate requests in one round trip.
+ *	@details	Hands the requests prepared by TSS_TPM_FieldUpgradeUpdate_PrepareRequest over to
+ *				DeviceManagement_TransmitBatch. The TPM executes them back to back until the first one which fails.
+ *
+ *	@param		PrgsRequests				Prepared requests
+ *	@param		PunRequestCount				Number of requests (at most TPMIO_BATCH_MAX_REQUESTS)
+ *	@param		PpunCompleted				Receives the number of requests which completed successfully
+ *
+ *	@retval		RC_SUCCESS					All requests completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The transport cannot transmit several requests in one round trip.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The request following the completed ones could not be transmitted to the TPM.
+ *	@retval		...							The TPM response code of the failed request with RC_TPM_MASK or error codes from
+ *											DeviceManagement_TransmitBatch
+ */
+_Check_return_
+unsigned int
+TSS_TPM_FieldUpgradeUpdate_TransmitRequests(
+	_In_reads_(PunRequestCount)		const TSS_TPM_FIELDUPGRADEUPDATE_REQUEST*	PrgsRequests,
+	_In_							unsigned int								PunRequestCount,
+	_Out_							unsigned int*								PpunCompleted);
+
 /**
  *	@brief		Calls TPM_Fieldupgrade.
  *	@details	Transmits the TPM1.2 command TPM_Fieldupgrade with the given data block.
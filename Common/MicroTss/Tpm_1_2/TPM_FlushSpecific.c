@@ -18,7 +18,7 @@
 #include "TPM_FlushSpecific.h"
 #include "TPM_Marshal.h"
 #include "TPM2_Marshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 
 /**
  *	@brief		This function handles the TPM_FlushSpecific command.
@@ -41,67 +41,26 @@ TSS_TPM_FlushSpecific(
 	unsigned int unReturnValue = RC_SUCCESS;
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		INT32 nSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		// Request parameters
 		TPM_TAG tag = TPM_TAG_RQU_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_COMMAND_CODE commandCode = TPM_ORD_FlushSpecific;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RESULT responseCode = TPM_RC_SUCCESS;
 
-		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPM_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
+		// Marshal the request (the layout is fixed, so the buffer size is checked once up front)
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_COMMAND_CODE_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&PunHandle, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&PunResourceType, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Marshal_Reserve(&pbBuffer, &nSizeRemaining, (INT32)(sizeof(PunHandle) + sizeof(PunResourceType)));
 		if (RC_SUCCESS != unReturnValue)
 			break;
+		TSS_UINT32_MarshalUnchecked(PunHandle, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(PunResourceType, &pbBuffer);
 
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
-
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_TAG_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RESULT_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
 	}
 	WHILE_FALSE_END;
 
@@ -18,7 +18,7 @@
 #include "TPM_GetCapability.h"
 #include "TPM_Marshal.h"
 #include "TPM2_Marshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 #include "Platform.h"
 
 /**
@@ -52,18 +52,11 @@ TSS_TPM_GetCapability(
 	unsigned int unReturnValue = RC_SUCCESS;
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		INT32 nSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		// Request parameters
 		TPM_TAG tag = TPM_TAG_RQU_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_COMMAND_CODE commandCode = TPM_ORD_GetCapability;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RESULT responseCode = TPM_RC_SUCCESS;
 
 		// Check parameters
 		if ((PunSubCapSize != 0 && NULL == PrgbSubCapBuffer) ||
@@ -74,14 +67,7 @@ TSS_TPM_GetCapability(
 		}
 
 		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPM_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_COMMAND_CODE_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 		// Cap area
@@ -101,37 +87,11 @@ TSS_TPM_GetCapability(
 				break;
 		}
 
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_TAG_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RESULT_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
-
 		// Get response data
 		{
 			unsigned int unRespSize = 0;
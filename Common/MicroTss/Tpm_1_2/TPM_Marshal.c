@@ -15,6 +15,7 @@
 
 #include "TPM_Marshal.h"
 #include "TPM2_Marshal.h"
+#include "Platform.h"
 
 //********************************************************************************************************
 //
@@ -1193,6 +1194,88 @@ TSS_TPM_PUBKEY_Unmarshal(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Unmarshal TPM_PUBKEY structure as a view
+ *	@details	The key is checked against its keyLength field and referenced in the source buffer instead of copied.
+ *
+ *	@param		PpTarget		Pointer to the target view
+ *	@param		PprgbBuffer		Pointer to a buffer to read from
+ *	@param		PpnBufferSize	Size of the buffer
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_TPM_PUBKEY_UnmarshalView(
+	_Out_	TPM_PUBKEY_VIEW*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		UINT32 unKeyLength = 0;
+
+		// Unmarshal algorithmParms
+		unReturnValue = TSS_TPM_KEY_PARMS_Unmarshal(&PpTarget->algorithmParms, PprgbBuffer, PpnBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Reference pubKey
+		unReturnValue = TSS_UINT32_Unmarshal(&unKeyLength, PprgbBuffer, PpnBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_BUFFER_VIEW_Unmarshal(&PpTarget->pubKey, PprgbBuffer, PpnBufferSize, unKeyLength);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Deep copy a TPM_PUBKEY view to a TPM_PUBKEY structure
+ *	@details
+ *
+ *	@param		PpSource		Pointer to the source view
+ *	@param		PpTarget		Pointer to the target structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The key does not fit into TPM_STORE_PUBKEY.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_TPM_PUBKEY_VIEW_Copy(
+	_In_	const TPM_PUBKEY_VIEW*	PpSource,
+	_Out_	TPM_PUBKEY*				PpTarget)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if ((NULL == PpSource) || (NULL == PpTarget))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(TPM_PUBKEY));
+
+		PpTarget->algorithmParms = PpSource->algorithmParms;
+		unReturnValue = TSS_BUFFER_VIEW_Copy(&PpSource->pubKey, PpTarget->pubKey.key, sizeof(PpTarget->pubKey.key));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		PpTarget->pubKey.keyLength = PpSource->pubKey.unSize;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
 //--------------------------------------------------------------------------------------------------------
 // Marshal and unmarshal structure TPM_AUTHDATA
 //--------------------------------------------------------------------------------------------------------
@@ -756,6 +756,41 @@ TSS_TPM_PUBKEY_Unmarshal(
 	_Inout_	BYTE**			PprgbBuffer,
 	_Inout_	INT32*			PpnBufferSize);
 
+/**
+ *	@brief		Unmarshal TPM_PUBKEY structure as a view
+ *	@details	The key is checked against its keyLength field and referenced in the source buffer instead of copied.
+ *
+ *	@param		PpTarget		Pointer to the target view
+ *	@param		PprgbBuffer		Pointer to a buffer to read from
+ *	@param		PpnBufferSize	Size of the buffer
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_TPM_PUBKEY_UnmarshalView(
+	_Out_	TPM_PUBKEY_VIEW*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnBufferSize);
+
+/**
+ *	@brief		Deep copy a TPM_PUBKEY view to a TPM_PUBKEY structure
+ *	@details
+ *
+ *	@param		PpSource		Pointer to the source view
+ *	@param		PpTarget		Pointer to the target structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The key does not fit into TPM_STORE_PUBKEY.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_TPM_PUBKEY_VIEW_Copy(
+	_In_	const TPM_PUBKEY_VIEW*	PpSource,
+	_Out_	TPM_PUBKEY*				PpTarget);
+
 //--------------------------------------------------------------------------------------------------------
 // Marshal and unmarshal structure TPM_STRUCT_VER
 //--------------------------------------------------------------------------------------------------------
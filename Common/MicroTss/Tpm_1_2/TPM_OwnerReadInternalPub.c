@@ -18,7 +18,7 @@
 #include "TPM_OwnerReadInternalPub.h"
 #include "TPM_Marshal.h"
 #include "TPM2_Marshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 #include "Platform.h"
 #include "Crypt.h"
 
@@ -34,7 +34,8 @@
  *	@param		PpsNonceEven			In: Even nonce previously generated by TPM to cover inputs
  *										Out: Even nonce newly generated by TPM to cover outputs
  *	@param		PsOwnerAuth				The authorization session digest for inputs and owner authentication. HMAC key: ownerAuth.
- *	@param		PpsPublicPortion		The public portion of the requested key
+ *	@param		PpsPublicPortion		View of the public portion of the requested key. It references the response buffer
+ *										and is only valid until the next command is sent.
  *	@param		PpsResAuth				The authorization session digest for the returned parameters. HMAC key: ownerAuth.
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
@@ -51,33 +52,25 @@ TSS_TPM_OwnerReadInternalPub(
 	_In_	TPM_NONCE		PsNonceOdd,
 	_Inout_ TPM_NONCE*		PpsNonceEven,
 	_In_	TPM_AUTHDATA	PsOwnerAuth,
-	_Out_	TPM_PUBKEY*		PpsPublicPortion,
+	_Out_	TPM_PUBKEY_VIEW*	PpsPublicPortion,
 	_Out_	TPM_AUTHDATA*	PpsResAuth)
 {
 	unsigned int unReturnValue = RC_SUCCESS;
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
 		BYTE* pbDigestBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		INT32 nSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 
 		// Request parameters
 		TPM_TAG tag = TPM_TAG_RQU_AUTH1_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_COMMAND_CODE commandCode = TPM_ORD_OwnerReadInternalPub;
 		BOOL fContinueAuthSession = TRUE;
 		BYTE rgbInParamDigest[SHA1_DIGEST_SIZE] = {0};
 
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RESULT responseCode = TPM_RC_SUCCESS;
-
 		// Initialize out parameters
 		if (NULL != PpsPublicPortion)
-			unReturnValue = Platform_MemorySet(PpsPublicPortion, 0, sizeof(TPM_PUBKEY));
+			unReturnValue = Platform_MemorySet(PpsPublicPortion, 0, sizeof(TPM_PUBKEY_VIEW));
 		if (NULL != PpsPublicPortion)
 			unReturnValue |= Platform_MemorySet(PpsResAuth, 0, sizeof(TPM_AUTHDATA));
 		if (RC_SUCCESS != unReturnValue)
@@ -91,20 +84,12 @@ TSS_TPM_OwnerReadInternalPub(
 		}
 
 		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPM_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Store beginning for digest buffer
-		pbDigestBuffer = pbBuffer;
-
-		unReturnValue = TSS_TPM_COMMAND_CODE_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		// Store beginning for digest buffer (the digest starts with the command code)
+		pbDigestBuffer = pbBuffer - sizeof(commandCode);
 		unReturnValue = TSS_UINT32_Marshal(&PunKeyHandle, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
@@ -176,45 +161,19 @@ TSS_TPM_OwnerReadInternalPub(
 				break;
 		}
 
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_TAG_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RESULT_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
-
 		// Get response data
 		{
-			TPM_PUBKEY sTempPublicPortion = {{0}};
+			TPM_PUBKEY_VIEW sTempPublicPortion = {{0}};
 			TPM_NONCE sTempNonceEven = {{0}};
 			BOOL fTempContinueAuthSession = FALSE;
 			TPM_AUTHDATA sTempResAuth = {{0}};
 
-			unReturnValue = TSS_TPM_PUBKEY_Unmarshal(&sTempPublicPortion, &pbBuffer, &nSizeRemaining);
+			unReturnValue = TSS_TPM_PUBKEY_UnmarshalView(&sTempPublicPortion, &pbBuffer, &nSizeRemaining);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 			unReturnValue = TSS_TPM_NONCE_Unmarshal(&sTempNonceEven, &pbBuffer, &nSizeRemaining);
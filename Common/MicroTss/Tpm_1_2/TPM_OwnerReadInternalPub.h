@@ -34,7 +34,8 @@ extern "C" {
  *	@param		PpsNonceEven			In: Even nonce previously generated by TPM to cover inputs
  *										Out: Even nonce newly generated by TPM to cover outputs
  *	@param		PsOwnerAuth				The authorization session digest for inputs and owner authentication. HMAC key: ownerAuth.
- *	@param		PpsPublicPortion		The public portion of the requested key
+ *	@param		PpsPublicPortion		View of the public portion of the requested key. It references the response buffer
+ *										and is only valid until the next command is sent.
  *	@param		PpsResAuth				The authorization session digest for the returned parameters. HMAC key: ownerAuth.
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
@@ -51,7 +52,7 @@ TSS_TPM_OwnerReadInternalPub(
 	_In_	TPM_NONCE		PsNonceOdd,
 	_Inout_ TPM_NONCE*		PpsNonceEven,
 	_In_	TPM_AUTHDATA	PsOwnerAuth,
-	_Out_	TPM_PUBKEY*		PpsPublicPortion,
+	_Out_	TPM_PUBKEY_VIEW*	PpsPublicPortion,
 	_Out_	TPM_AUTHDATA*	PpsResAuth);
 
 #ifdef __cplusplus
@@ -18,7 +18,7 @@
 #include "TPM_TakeOwnership.h"
 #include "TPM_Marshal.h"
 #include "TPM2_Marshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 #include "Crypt.h"
 #include "Platform.h"
 
@@ -61,16 +61,12 @@ TSS_TPM_TakeOwnership(
 
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
 		BYTE* pbDigestBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		INT32 nSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 
 		// Request parameters
 		TPM_TAG tag = TPM_TAG_RQU_AUTH1_COMMAND;
-		UINT32 unCommandSize = 0;
 		TPM_COMMAND_CODE commandCode = TPM_ORD_TakeOwnership;
 		TPM_PROTOCOL_ID protocolId = TPM_PID_OWNER;
 		BYTE bContinueAuthSession = 0;
@@ -79,10 +75,6 @@ TSS_TPM_TakeOwnership(
 
 		BYTE rgbSha1Hash[SHA1_DIGEST_SIZE] = {0};
 
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RESULT responseCode = TPM_RC_SUCCESS;
-
 		// Check Parameters
 		if (NULL == PrgbEncryptedOwnerAuth ||
 				NULL == PrgbEncryptedSrkAuth ||
@@ -101,20 +93,12 @@ TSS_TPM_TakeOwnership(
 			break;
 
 		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPM_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Store beginning for digest buffer
-		pbDigestBuffer = pbBuffer;
-
-		unReturnValue = TSS_TPM_COMMAND_CODE_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		// Store beginning for digest buffer (the digest starts with the command code)
+		pbDigestBuffer = pbBuffer - sizeof(commandCode);
 		// Marshal command parameters
 		unReturnValue = TSS_TPM_PROTOCOL_ID_Marshal(&protocolId, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
@@ -216,37 +200,11 @@ TSS_TPM_TakeOwnership(
 				break;
 		}
 
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_TAG_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RESULT_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
-			break;
-		}
-
 		// Get SRK key size
 		unReturnValue = TSS_TPM_KEY_Unmarshal(PpSrkPub, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
@@ -370,6 +370,17 @@ typedef struct tdTPM_PUBKEY
 	TPM_STORE_PUBKEY pubKey;
 } TPM_PUBKEY;
 
+/**
+ *	@brief		TPM_PUBKEY view
+ *	@details	TPM_PUBKEY with the key referenced in the buffer it was unmarshaled from instead of copied
+ *
+ **/
+typedef struct tdTPM_PUBKEY_VIEW
+{
+	TPM_KEY_PARMS algorithmParms;
+	TSS_BUFFER_VIEW pubKey;
+} TPM_PUBKEY_VIEW;
+
 /**
  *	@brief		TPM_STRUCT_VER structure
  *	@details	TPM_STRUCT_VER structure definition
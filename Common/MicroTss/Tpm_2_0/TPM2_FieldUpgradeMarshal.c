@@ -26,26 +26,41 @@
 
 /**
  *	@brief		Marshal helper to calculate the LRC
- *	@details
+ *	@details	The LRC is the XOR of all bytes. It is accumulated eight bytes at a time and folded into one byte at
+ *				the end, which gives the same result as the byte-wise calculation.
  *
  *	@param		PrgbData		Pointer to a buffer to calculate the LRC from
  *	@param		PunDataSize		Size of the buffer
  *
- *	@retval		RC_SUCCESS	The operation completed successfully.
- *	@retval		...			Error codes from called functions.
+ *	@returns	LRC of the buffer (0 if PrgbData is NULL)
  */
 BYTE
 TSS_CalcLRC(
-	_In_bytecount_(PunDataSize) uint8_t*	PrgbData,
+	_In_bytecount_(PunDataSize) const uint8_t*	PrgbData,
 	_In_						uint32_t	PunDataSize)
 {
 	uint8_t bLRC = 0;
-	uint32_t unIndex;
+	uint32_t unIndex = 0;
 
 	if (NULL != PrgbData)
 	{
-		for (unIndex = 0; unIndex < PunDataSize; unIndex++)
-			bLRC ^= *(PrgbData++);
+		uint64_t ullLRC = 0;
+		uint64_t ullWord = 0;
+
+		// XOR the data word by word (the byte order within the words does not matter for the folded result)
+		for (; PunDataSize - unIndex >= sizeof(ullWord); unIndex += sizeof(ullWord))
+		{
+			memcpy(&ullWord, &PrgbData[unIndex], sizeof(ullWord));
+			ullLRC ^= ullWord;
+		}
+		ullLRC ^= ullLRC >> 32;
+		ullLRC ^= ullLRC >> 16;
+		ullLRC ^= ullLRC >> 8;
+		bLRC = (uint8_t)ullLRC;
+
+		// XOR the remaining bytes
+		for (; unIndex < PunDataSize; unIndex++)
+			bLRC ^= PrgbData[unIndex];
 	}
 
 	return bLRC;
@@ -131,9 +146,7 @@ TSS_sMessageDigest_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sMessageDigest_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sMessageDigest_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -231,9 +244,7 @@ TSS_sFirmwarePackage_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sFirmwarePackage_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sFirmwarePackage_d));
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
@@ -333,9 +344,7 @@ TSS_sVersions_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sVersions_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sVersions_d));
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
@@ -467,9 +476,7 @@ TSS_sSignedAttributes_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sSignedAttributes_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSignedAttributes_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -616,9 +623,7 @@ TSS_sSignerInfo_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sSignerInfo_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSignerInfo_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -736,9 +741,7 @@ TSS_sSignedData_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sSignedData_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSignedData_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -765,6 +768,101 @@ TSS_sSignedData_d_Unmarshal(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Unmarshal structure of type sSignedData_d as a view
+ *	@details	Validates the whole structure like TSS_sSignedData_d_Unmarshal but only copies the signed attributes.
+ *				The signature and the marshaled structure are referenced in the source buffer, which must outlive the view.
+ *
+ *	@param		PpTarget		Pointer to the target view
+ *	@param		PprgbBuffer		Pointer to a buffer to store the source
+ *	@param		PpnBufferSize	Size of the buffer
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_sSignedData_d_UnmarshalView(
+	_Out_	sSignedDataView_d*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	do
+	{
+		BYTE* pbStart = NULL;
+		TSS_BUFFER_VIEW sHeader = {0};
+		UINT16 usSignatureSize = 0;
+
+		// Check and initialize _Out_ parameters
+		if (NULL == PpTarget)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSignedDataView_d));
+		// Check _Inout_ parameters
+		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		pbStart = *PprgbBuffer;
+
+		// Skip sSignedData_d header (internal1, internal2, wSignerInfoSize) and sSignerInfo_d header (internal1 to internal5)
+		unReturnValue = TSS_BUFFER_VIEW_Unmarshal(&sHeader, PprgbBuffer, PpnBufferSize, 3 * sizeof(UINT16) + 4 * sizeof(UINT16) + sizeof(UINT32));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		// Unmarshal sSignedAttributes_d (sSignedAttributes)
+		unReturnValue = TSS_sSignedAttributes_d_Unmarshal(&PpTarget->sSignedAttributes, PprgbBuffer, PpnBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		// Reference the signature (sSignerInfo.internal7 and sSignerInfo.internal8)
+		unReturnValue = TSS_UINT16_Unmarshal(&usSignatureSize, PprgbBuffer, PpnBufferSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_BUFFER_VIEW_Unmarshal(&PpTarget->sSignature, PprgbBuffer, PpnBufferSize, sizeof(((sSignerInfo_d*)0)->internal8));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		PpTarget->sMarshaled.pbData = pbStart;
+		PpTarget->sMarshaled.unSize = (UINT32)(*PprgbBuffer - pbStart);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Deep copy a sSignedDataView_d view to a sSignedData_d structure
+ *	@details
+ *
+ *	@param		PpSource		Pointer to the source view
+ *	@param		PpTarget		Pointer to the target structure
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_sSignedDataView_d_Copy(
+	_In_	const sSignedDataView_d*	PpSource,
+	_Out_	sSignedData_d*				PpTarget)
+{
+	BYTE* pbBuffer = NULL;
+	INT32 nBufferSize = 0;
+
+	// Check parameters
+	if ((NULL == PpSource) || (NULL == PpSource->sMarshaled.pbData))
+		return RC_E_BAD_PARAMETER;
+
+	pbBuffer = (BYTE*)PpSource->sMarshaled.pbData;
+	nBufferSize = (INT32)PpSource->sMarshaled.unSize;
+	return TSS_sSignedData_d_Unmarshal(PpTarget, &pbBuffer, &nBufferSize);
+}
+
 /**
  *	@brief		Unmarshal structure of type sSecurityModuleLogicInfo_d
  *	@details
@@ -793,9 +891,7 @@ TSS_sSecurityModuleLogicInfo_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sSecurityModuleLogicInfo_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSecurityModuleLogicInfo_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -865,9 +961,7 @@ TSS_sSecurityModuleLogicInfo2_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sSecurityModuleLogicInfo2_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSecurityModuleLogicInfo2_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -941,9 +1035,7 @@ TSS_sKeyList_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sKeyList_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sKeyList_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -1013,9 +1105,7 @@ TSS_sSecurityModuleLogic_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sSecurityModuleLogic_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sSecurityModuleLogic_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -1073,9 +1163,7 @@ TSS_sFirmwarePackages_d_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(sFirmwarePackages_d));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(sFirmwarePackages_d));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
@@ -1113,6 +1201,7 @@ TSS_sFirmwarePackages_d_Unmarshal(
  *
  *	@retval		RC_SUCCESS			The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The count exceeds the capacity of the list.
  *	@retval		...					Error codes from called functions.
  */
 _Check_return_
@@ -1131,17 +1220,22 @@ TSS_TPML_MAX_BUFFER_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_MAX_BUFFER));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(TPML_MAX_BUFFER));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnBufferSize))
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
 		}
 		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnBufferSize);
 		if (RC_SUCCESS != unReturnValue)
 			break;
+		// Like the descriptor based lists, reject a count from the TPM response beyond the capacity of the list
+		if (PpTarget->count > RG_LEN(PpTarget->buffer))
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
 
 		unReturnValue = TSS_TPM2B_MAX_BUFFER_Array_Unmarshal((TPM2B_MAX_BUFFER*)&PpTarget->buffer, PprgbBuffer, PpnBufferSize, PpTarget->count);
 		if (RC_SUCCESS != unReturnValue)
@@ -29,17 +29,17 @@ extern "C" {
 
 /**
  *	@brief		Marshal helper to calculate the LRC
- *	@details
+ *	@details	The LRC is the XOR of all bytes. It is accumulated eight bytes at a time and folded into one byte at
+ *				the end, which gives the same result as the byte-wise calculation.
  *
  *	@param		PrgbData		Pointer to a buffer to calculate the LRC from
  *	@param		PunDataSize		Size of the buffer
  *
- *	@retval		RC_SUCCESS	The operation completed successfully.
- *	@retval		...			Error codes from called functions.
+ *	@returns	LRC of the buffer (0 if PrgbData is NULL)
  */
 BYTE
 TSS_CalcLRC(
-	_In_bytecount_(PunDataSize) uint8_t*	PrgbData,
+	_In_bytecount_(PunDataSize) const uint8_t*	PrgbData,
 	_In_						uint32_t	PunDataSize);
 
 //********************************************************************************************************
@@ -314,6 +314,43 @@ TSS_sSignedData_d_Unmarshal(
 	_Inout_	BYTE**			PprgbBuffer,
 	_Inout_	INT32*			PpnBufferSize);
 
+/**
+ *	@brief		Unmarshal structure of type sSignedData_d as a view
+ *	@details	Validates the whole structure like TSS_sSignedData_d_Unmarshal but only copies the signed attributes.
+ *				The signature and the marshaled structure are referenced in the source buffer, which must outlive the view.
+ *
+ *	@param		PpTarget		Pointer to the target view
+ *	@param		PprgbBuffer		Pointer to a buffer to store the source
+ *	@param		PpnBufferSize	Size of the buffer
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_sSignedData_d_UnmarshalView(
+	_Out_	sSignedDataView_d*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnBufferSize);
+
+/**
+ *	@brief		Deep copy a sSignedDataView_d view to a sSignedData_d structure
+ *	@details
+ *
+ *	@param		PpSource		Pointer to the source view
+ *	@param		PpTarget		Pointer to the target structure
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_sSignedDataView_d_Copy(
+	_In_	const sSignedDataView_d*	PpSource,
+	_Out_	sSignedData_d*				PpTarget);
+
 /**
  *	@brief		Unmarshal structure of type sSecurityModuleLogicInfo_d
  *	@details
@@ -419,6 +456,7 @@ TSS_sFirmwarePackages_d_Unmarshal(
  *
  *	@retval		RC_SUCCESS			The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The count exceeds the capacity of the list.
  *	@retval		...					Error codes from called functions.
  */
 _Check_return_
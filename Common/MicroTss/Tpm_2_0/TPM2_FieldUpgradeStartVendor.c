@@ -18,7 +18,7 @@
 #include "TPM2_FieldUpgradeStartVendor.h"
 #include "TPM2_Marshal.h"
 #include "TPM2_FieldUpgradeMarshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 #include "Platform.h"
 #include "StdInclude.h"
 
@@ -30,7 +30,7 @@
  *
  *	@param		PhAuthorization						The authorization handle (Platform Authorization)
  *	@param		PsAuthorizationSessionRequestData	The request authorization data
- *	@param		PsSignedData						The signed data structure (Policy parameter block)
+ *	@param		PpsSignedData						View of the signed data structure (Policy parameter block)
  *	@param		PpusStartSize						The out start size
  *	@param		PpsAuthorizationSessionResponseData	The response authorization data
  *
@@ -42,44 +42,37 @@ unsigned int
 TSS_TPM2_FieldUpgradeStartVendor(
 	_In_	TPMI_RH_PLATFORM				PhAuthorization,
 	_In_	AuthorizationCommandData		PsAuthorizationSessionRequestData,
-	_In_	sSignedData_d					PsSignedData,
+	_In_	const sSignedDataView_d*		PpsSignedData,
 	_Out_	UINT16*							PpusStartSize,
 	_Out_	AcknowledgmentResponseData*		PpsAuthorizationSessionResponseData)
 {
 	unsigned int unReturnValue = RC_SUCCESS;
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		INT32 nSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		UINT32 unParameterSize = 0;
+		UINT16 usSignedDataSize = 0;
 		// Request parameters
 		TPM_ST tag = TPM_ST_SESSIONS;
-		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM2_CC_FieldUpgradeStartVendor;
 		SubCmd_d subCommand = TPM_FieldUpgradeStart;
 
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
-
 		// Initialize _Out_ parameters
 		unReturnValue |= Platform_MemorySet(PpusStartSize, 0x00, sizeof(UINT16));
 		unReturnValue |= Platform_MemorySet(PpsAuthorizationSessionResponseData, 0x00, sizeof(AcknowledgmentResponseData));
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
+		// Check parameters
+		if ((NULL == PpsSignedData) || (NULL == PpsSignedData->sMarshaled.pbData) || (PpsSignedData->sMarshaled.unSize > 0xFFFF))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
+		}
+
+		// Marshal the request
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 		unReturnValue = TSS_TPMI_RH_PLATFORM_Marshal(&PhAuthorization, &pbBuffer, &nSizeRemaining);
@@ -107,57 +100,20 @@ TSS_TPM2_FieldUpgradeStartVendor(
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
-		{
-			BYTE* pbPositionSize = NULL;
-			UINT16 usSize = 0;
-			INT32 nSizeOfSize = 2;
-
-			pbPositionSize = pbBuffer;
-			// Marshal size of sSignedInfoData
-			unReturnValue = TSS_UINT16_Marshal(&usSize, &pbBuffer, &nSizeRemaining);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-			// Marshal sSignedData
-			unReturnValue = TSS_sSignedData_d_Marshal(&PsSignedData, &pbBuffer, &nSizeRemaining);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-			// Calculate correct size of marshaled structure
-			usSize = (UINT16)(pbBuffer - pbPositionSize - sizeof(uint16_t));
-			// Marshal size of sSignedInfoData
-			unReturnValue = TSS_UINT16_Marshal(&usSize, &pbPositionSize, &nSizeOfSize);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Marshal size of sSignedInfoData
+		usSignedDataSize = (UINT16)PpsSignedData->sMarshaled.unSize;
+		unReturnValue = TSS_UINT16_Marshal(&usSignedDataSize, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
-
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
+		// Copy sSignedData as it was read from the policy parameter block
+		unReturnValue = TSS_BYTE_Array_Marshal(PpsSignedData->sMarshaled.pbData, &pbBuffer, &nSizeRemaining, (INT32)usSignedDataSize);
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		if (responseCode != TPM_RC_SUCCESS)
-		{
-			unReturnValue = RC_TPM_MASK | responseCode;
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		}
+
 		// Unmarshal the parameter size
 		unReturnValue = TSS_UINT32_Unmarshal(&unParameterSize, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
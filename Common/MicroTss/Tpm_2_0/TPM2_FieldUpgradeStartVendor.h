@@ -31,7 +31,7 @@ extern "C" {
  *
  *	@param		PhAuthorization						The authorization handle (Platform Authorization)
  *	@param		PsAuthorizationSessionRequestData	The request authorization data
- *	@param		PsSignedData						The signed data structure (Policy parameter block)
+ *	@param		PpsSignedData						View of the signed data structure (Policy parameter block)
  *	@param		PpusStartSize						The out start size
  *	@param		PpsAuthorizationSessionResponseData	The response authorization data
  *
@@ -43,7 +43,7 @@ unsigned int
 TSS_TPM2_FieldUpgradeStartVendor(
 	_In_	TPMI_RH_PLATFORM				PhAuthorization,
 	_In_	AuthorizationCommandData		PsAuthorizationSessionRequestData,
-	_In_	sSignedData_d					PsSignedData,
+	_In_	const sSignedDataView_d*		PpsSignedData,
 	_Out_	UINT16*							PpusStartSize,
 	_Out_	AcknowledgmentResponseData*		PpsAuthorizationSessionResponseData);
 
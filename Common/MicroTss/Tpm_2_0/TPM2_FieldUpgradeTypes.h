@@ -137,6 +137,18 @@ typedef struct sSignedData_d
 	sSignerInfo_d			sSignerInfo;
 } sSignedData_d;
 
+/**
+ *	@brief		Signed Firmware Data Info view
+ *	@details	Holds the signed attributes and references the signature and the marshaled structure in the
+ *				buffer it was unmarshaled from. Use TSS_sSignedDataView_d_Copy to get a sSignedData_d.
+ */
+typedef struct sSignedDataView_d
+{
+	sSignedAttributes_d		sSignedAttributes;
+	TSS_BUFFER_VIEW			sSignature;
+	TSS_BUFFER_VIEW			sMarshaled;
+} sSignedDataView_d;
+
 /**
  *	@brief		Security Module Logic structure
  */
@@ -190,19 +202,6 @@ typedef struct sSecurityModuleLogicInfo2_d
 	sKeyList_d				sKeyList;
 } sSecurityModuleLogicInfo2_d;
 
-/**
- *	@brief		TPML_MAX_BUFFER structure
- *	@details	TPML_MAX_BUFFER structure definition
- */
-typedef struct _TPML_MAX_BUFFER
-{
-	/// Number of properties
-	/// A value of zero is allowed.
-	uint32_t count;
-	/// An array of bytes
-	TPM2B_MAX_BUFFER buffer[1];
-} TPML_MAX_BUFFER;
-
 /**
  *	@brief		TPMU_VENDOR_CAPABILITY union
  *	@details	TPMU_VENDOR_CAPABILITY union definition
@@ -5,7 +5,7 @@
  */
 #include "TPM2_GetCapability.h"
 #include "TPM2_Marshal.h"
-#include "DeviceManagement.h"
+#include "TSS_Command.h"
 #include "Platform.h"
 #include "StdInclude.h"
 
@@ -28,82 +28,106 @@ TSS_TPM2_GetCapability(
 	unsigned int unReturnValue = RC_SUCCESS;
 	do
 	{
-		BYTE rgbRequest[MAX_COMMAND_SIZE] = {0};
-		BYTE rgbResponse[MAX_RESPONSE_SIZE] = {0};
 		BYTE* pbBuffer = NULL;
-		INT32 nSizeRemaining = sizeof(rgbRequest);
-		INT32 nSizeResponse = sizeof(rgbResponse);
+		INT32 nSizeRemaining = 0;
 		// Request parameters
 		TPM_ST tag = TPM_ST_NO_SESSIONS;
-		UINT32 unCommandSize = 0;
 		TPM_CC commandCode = TPM_CC_GetCapability;
-		// Response parameters
-		UINT32 unResponseSize = 0;
-		TPM_RC responseCode = TPM_RC_SUCCESS;
 
 		// Initialize _Out_ parameters
 		unReturnValue |= Platform_MemorySet(pMoreData, 0x00, sizeof(TPMI_YES_NO));
 		unReturnValue |= Platform_MemorySet(pCapabilityData, 0x00, sizeof(TPMS_CAPABILITY_DATA));
 		if (RC_SUCCESS != unReturnValue)
 			break;
-		// Marshal the request
-		pbBuffer = rgbRequest;
-		unReturnValue = TSS_TPMI_ST_COMMAND_TAG_Marshal(&tag, &pbBuffer, &nSizeRemaining);
+		// Marshal the request (the layout is fixed, so the buffer size is checked once up front)
+		unReturnValue = TSS_Command_Begin(tag, commandCode, &pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Marshal(&commandCode, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CAP_Marshal(&capability, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&property, &pbBuffer, &nSizeRemaining);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Marshal(&propertyCount, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_Marshal_Reserve(&pbBuffer, &nSizeRemaining, (INT32)(sizeof(capability) + sizeof(property) + sizeof(propertyCount)));
 		if (RC_SUCCESS != unReturnValue)
 			break;
+		TSS_UINT32_MarshalUnchecked(capability, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(property, &pbBuffer);
+		TSS_UINT32_MarshalUnchecked(propertyCount, &pbBuffer);
 
-		// Overwrite unCommandSize
-		unCommandSize = sizeof(rgbRequest) - nSizeRemaining;
-		pbBuffer = rgbRequest + 2;
-		nSizeRemaining = 4;
-		unReturnValue = TSS_UINT32_Marshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		// Transmit the command and unmarshal the response header
+		unReturnValue = TSS_Command_Execute(&pbBuffer, &nSizeRemaining);
 		if (RC_SUCCESS != unReturnValue)
 			break;
-
-		// Transmit the command over TDDL
-		unReturnValue = DeviceManagement_Transmit(rgbRequest, unCommandSize, rgbResponse, (unsigned int*)&nSizeResponse);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-
-		// Unmarshal the response
-		pbBuffer = rgbResponse;
-		nSizeRemaining = nSizeResponse;
-		unReturnValue = TSS_TPM_ST_Unmarshal(&tag, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_TPMI_YES_NO_Unmarshal(pMoreData, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
 			break;
-		unReturnValue = TSS_UINT32_Unmarshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
+		unReturnValue = TSS_TPMS_CAPABILITY_DATA_Unmarshal(pCapabilityData, &pbBuffer, &nSizeRemaining);
 		if (TPM_RC_SUCCESS != unReturnValue)
 			break;
-		unReturnValue = TSS_TPM_RC_Unmarshal(&responseCode, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
+	}
+	WHILE_FALSE_END;
+	return unReturnValue;
+}
+
+/**
+ *	@brief	Reads a contiguous range of TPM properties (TPM_CAP_TPM_PROPERTIES).
+ *	@details	The range is requested with a single TPM2_GetCapability command. Further commands are only sent
+ *				if the TPM indicates more data and has not yet returned the whole range. Properties are stored
+ *				in ascending order of their identifiers. The TPM may omit unsupported properties.
+ *
+ *	@param	firstProperty		First property of the range
+ *	@param	propertyCount		Number of properties in the range, at most MAX_TPM_PROPERTIES
+ *	@param	pProperties			Receives the properties of the range returned by the TPM
+ *	@retval	RC_SUCCESS			The operation completed successfully.
+ *	@retval	RC_E_BAD_PARAMETER	propertyCount is zero or too large.
+ *	@retval	...					Error codes from TSS_TPM2_GetCapability.
+ */
+_Check_return_
+unsigned int
+TSS_TPM2_GetTpmProperties(
+	_In_	TPM_PT						firstProperty,
+	_In_	UINT32						propertyCount,
+	_Out_	TPML_TAGGED_TPM_PROPERTY*	pProperties
+)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	do
+	{
+		TPM_PT nextProperty = firstProperty;
+		TPM_PT lastProperty = firstProperty + propertyCount - 1;
+		TPMI_YES_NO moreData = YES;
+
+		unReturnValue = Platform_MemorySet(pProperties, 0x00, sizeof(TPML_TAGGED_TPM_PROPERTY));
+		if (RC_SUCCESS != unReturnValue)
 			break;
-		if (responseCode != TPM_RC_SUCCESS)
+		if (0 == propertyCount || MAX_TPM_PROPERTIES < propertyCount)
 		{
-			unReturnValue = RC_TPM_MASK | responseCode;
+			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = TSS_TPMI_YES_NO_Unmarshal(pMoreData, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMS_CAPABILITY_DATA_Unmarshal(pCapabilityData, &pbBuffer, &nSizeRemaining);
-		if (TPM_RC_SUCCESS != unReturnValue)
-			break;
+
+		while (YES == moreData && nextProperty <= lastProperty)
+		{
+			TPMS_CAPABILITY_DATA capabilityData;
+			TPM_PT requestedProperty = nextProperty;
+			UINT32 unIndex = 0;
+
+			unReturnValue = TSS_TPM2_GetCapability(TPM_CAP_TPM_PROPERTIES, nextProperty, lastProperty - nextProperty + 1, &moreData, &capabilityData);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (0 == capabilityData.data.tpmProperties.count)
+				break;
+
+			for (unIndex = 0; unIndex < capabilityData.data.tpmProperties.count && unIndex < MAX_TPM_PROPERTIES; unIndex++)
+			{
+				TPMS_TAGGED_PROPERTY* pProperty = &capabilityData.data.tpmProperties.tpmProperty[unIndex];
+				// The TPM returns properties in ascending order starting at the requested one, skip anything outside of the range
+				if (pProperty->property < nextProperty || pProperty->property > lastProperty)
+					continue;
+				pProperties->tpmProperty[pProperties->count++] = *pProperty;
+				nextProperty = pProperty->property + 1;
+			}
+			// Stop if the TPM did not return any property of the remaining range
+			if (requestedProperty == nextProperty)
+				break;
+		}
 	}
 	WHILE_FALSE_END;
 	return unReturnValue;
-}
\ No newline at end of file
+}
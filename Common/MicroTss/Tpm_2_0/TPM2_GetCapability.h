@@ -20,4 +20,25 @@ TSS_TPM2_GetCapability(
 	_In_	UINT32						propertyCount,
 	_Out_	TPMI_YES_NO*				pMoreData,
 	_Out_	TPMS_CAPABILITY_DATA*		pCapabilityData
-);
\ No newline at end of file
+);
+
+/**
+ *	@brief	Reads a contiguous range of TPM properties (TPM_CAP_TPM_PROPERTIES).
+ *	@details	The range is requested with a single TPM2_GetCapability command. Further commands are only sent
+ *				if the TPM indicates more data and has not yet returned the whole range. Properties are stored
+ *				in ascending order of their identifiers. The TPM may omit unsupported properties.
+ *
+ *	@param	firstProperty		First property of the range
+ *	@param	propertyCount		Number of properties in the range, at most MAX_TPM_PROPERTIES
+ *	@param	pProperties			Receives the properties of the range returned by the TPM
+ *	@retval	RC_SUCCESS			The operation completed successfully.
+ *	@retval	RC_E_BAD_PARAMETER	propertyCount is zero or too large.
+ *	@retval	...					Error codes from TSS_TPM2_GetCapability.
+ */
+_Check_return_
+unsigned int
+TSS_TPM2_GetTpmProperties(
+	_In_	TPM_PT						firstProperty,
+	_In_	UINT32						propertyCount,
+	_Out_	TPML_TAGGED_TPM_PROPERTY*	pProperties
+);
@@ -9,6 +9,774 @@
 #include "Platform.h"
 #include "../StdInclude.h"
 #include "TPM2_FieldUpgradeMarshal.h"
+
+//--------------------------------------------------------------------------------------------------------
+// Type descriptor interpreter
+//--------------------------------------------------------------------------------------------------------
+
+/**
+ *	@brief		Reads the element count of an array field from its count field
+ *
+ *	@param		PpField		Field descriptor of the array
+ *	@param		PpbBase		Start of the structure containing the field
+ *
+ *	@returns	Number of elements in the array
+ */
+UINT32
+TSS_Descriptor_GetCount(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpField,
+	_In_	const BYTE*					PpbBase)
+{
+	const BYTE* pbCount = PpbBase + PpField->usCountOffset;
+	switch (PpField->bCountKind)
+	{
+		case TSS_FIELD_UINT8:
+			return *pbCount;
+		case TSS_FIELD_UINT16:
+			return *(const UINT16*)pbCount;
+		case TSS_FIELD_UINT32:
+			return *(const UINT32*)pbCount;
+		default:
+			return 1;
+	}
+}
+
+/**
+ *	@brief		Checks whether the remaining buffer can hold the given number of integer elements
+ *
+ *	@param		PbKind		Wire format of one element
+ *	@param		PunCount	Number of elements
+ *	@param		PnSize		Number of octets remaining in the buffer
+ *
+ *	@retval		TRUE		The elements fit into the buffer.
+ *	@retval		FALSE		The buffer is too small.
+ */
+BOOL
+TSS_Descriptor_Fits(
+	_In_	BYTE	PbKind,
+	_In_	UINT32	PunCount,
+	_In_	INT32	PnSize)
+{
+	return (PnSize >= 0) && (PunCount <= (UINT32)PnSize / PbKind);
+}
+
+// Nested structures recurse through the fields and elements functions
+_Check_return_
+unsigned int
+TSS_Descriptor_MarshalElements(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpField,
+	_In_	const BYTE*					PpbSource,
+	_In_	UINT32						PunCount,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize);
+
+/**
+ *	@brief		Marshals all fields of a structure
+ *
+ *	@param		PpDescriptor	Type descriptor of the structure
+ *	@param		PpbSource		Start of the structure
+ *	@param		PprgbBuffer		Location in the output buffer where the first octet is to be placed
+ *	@param		PpnSize			Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small or an array count exceeds the capacity of its field.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_MarshalFields(
+	_In_	const TSS_TYPE_DESCRIPTOR*	PpDescriptor,
+	_In_	const BYTE*					PpbSource,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	UINT16 usField = 0;
+
+	for (usField = 0; usField < PpDescriptor->usFieldCount; usField++)
+	{
+		const TSS_FIELD_DESCRIPTOR* pField = &PpDescriptor->rgFields[usField];
+		UINT32 unCount = TSS_Descriptor_GetCount(pField, PpbSource);
+		if (unCount > pField->usMaxCount)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+		unReturnValue = TSS_Descriptor_MarshalElements(pField, PpbSource + pField->usOffset, unCount, PprgbBuffer, PpnSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Marshals a run of elements described by a field descriptor
+ *
+ *	@param		PpField		Field descriptor
+ *	@param		PpbSource	First element
+ *	@param		PunCount	Number of elements
+ *	@param		PprgbBuffer	Location in the output buffer where the first octet is to be placed
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_MarshalElements(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpField,
+	_In_	const BYTE*					PpbSource,
+	_In_	UINT32						PunCount,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	UINT32 unIndex = 0;
+
+	do
+	{
+		if (0 == PunCount)
+			break;
+
+		if (TSS_FIELD_STRUCT == PpField->bKind)
+		{
+			for (unIndex = 0; unIndex < PunCount; unIndex++)
+			{
+				unReturnValue = TSS_Descriptor_MarshalFields(PpField->pElementDescriptor, PpbSource + unIndex * PpField->usElementSize, PprgbBuffer, PpnSize);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+			break;
+		}
+
+		// Integer runs only need one size check
+		if (!TSS_Descriptor_Fits(PpField->bKind, PunCount, *PpnSize))
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+		switch (PpField->bKind)
+		{
+			case TSS_FIELD_UINT8:
+				if (1 == PpField->usElementSize)
+					Platform_MemoryCopyInline(*PprgbBuffer, PpbSource, PunCount);
+				else
+				{
+					for (unIndex = 0; unIndex < PunCount; unIndex++)
+						(*PprgbBuffer)[unIndex] = PpbSource[unIndex * PpField->usElementSize];
+				}
+				break;
+			case TSS_FIELD_UINT16:
+				for (unIndex = 0; unIndex < PunCount; unIndex++)
+					UINT16_TO_BYTE_ARRAY(*(const UINT16*)(PpbSource + unIndex * PpField->usElementSize), *PprgbBuffer + unIndex * 2);
+				break;
+			case TSS_FIELD_UINT32:
+				for (unIndex = 0; unIndex < PunCount; unIndex++)
+					UINT32_TO_BYTE_ARRAY(*(const UINT32*)(PpbSource + unIndex * PpField->usElementSize), *PprgbBuffer + unIndex * 4);
+				break;
+			default:
+				unReturnValue = RC_E_BAD_PARAMETER;
+				break;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		*PprgbBuffer += PunCount * PpField->bKind;
+		*PpnSize -= (INT32)(PunCount * PpField->bKind);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+// Nested structures recurse through the fields and elements functions
+_Check_return_
+unsigned int
+TSS_Descriptor_UnmarshalElements(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpField,
+	_Out_	BYTE*						PpbTarget,
+	_In_	UINT32						PunCount,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize);
+
+/**
+ *	@brief		Unmarshals all fields of a structure
+ *	@details	Count fields precede the arrays they describe on the wire, so they are always read before they are used.
+ *
+ *	@param		PpDescriptor	Type descriptor of the structure
+ *	@param		PpbTarget		Start of the structure
+ *	@param		PprgbBuffer		Location in the input buffer containing the first octet
+ *	@param		PpnSize			Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short or an array count exceeds the capacity of its field.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_UnmarshalFields(
+	_In_	const TSS_TYPE_DESCRIPTOR*	PpDescriptor,
+	_Inout_	BYTE*						PpbTarget,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	UINT16 usField = 0;
+
+	for (usField = 0; usField < PpDescriptor->usFieldCount; usField++)
+	{
+		const TSS_FIELD_DESCRIPTOR* pField = &PpDescriptor->rgFields[usField];
+		UINT32 unCount = TSS_Descriptor_GetCount(pField, PpbTarget);
+		if (unCount > pField->usMaxCount)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+		unReturnValue = TSS_Descriptor_UnmarshalElements(pField, PpbTarget + pField->usOffset, unCount, PprgbBuffer, PpnSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Unmarshals a run of elements described by a field descriptor
+ *
+ *	@param		PpField		Field descriptor
+ *	@param		PpbTarget	First element
+ *	@param		PunCount	Number of elements
+ *	@param		PprgbBuffer	Location in the input buffer containing the first octet
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_UnmarshalElements(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpField,
+	_Out_	BYTE*						PpbTarget,
+	_In_	UINT32						PunCount,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	UINT32 unIndex = 0;
+
+	do
+	{
+		if (0 == PunCount)
+			break;
+
+		if (TSS_FIELD_STRUCT == PpField->bKind)
+		{
+			for (unIndex = 0; unIndex < PunCount; unIndex++)
+			{
+				BYTE* pbElement = PpbTarget + unIndex * PpField->usElementSize;
+				Platform_MemorySetInline(pbElement, 0x00, PpField->usElementSize);
+				unReturnValue = TSS_Descriptor_UnmarshalFields(PpField->pElementDescriptor, pbElement, PprgbBuffer, PpnSize);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+			break;
+		}
+
+		// Integer runs only need one size check
+		if (!TSS_Descriptor_Fits(PpField->bKind, PunCount, *PpnSize))
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+		switch (PpField->bKind)
+		{
+			case TSS_FIELD_UINT8:
+				if (1 == PpField->usElementSize)
+					Platform_MemoryCopyInline(PpbTarget, *PprgbBuffer, PunCount);
+				else
+				{
+					for (unIndex = 0; unIndex < PunCount; unIndex++)
+						PpbTarget[unIndex * PpField->usElementSize] = (*PprgbBuffer)[unIndex];
+				}
+				break;
+			case TSS_FIELD_UINT16:
+				for (unIndex = 0; unIndex < PunCount; unIndex++)
+					*(UINT16*)(PpbTarget + unIndex * PpField->usElementSize) = BYTE_ARRAY_TO_UINT16(*PprgbBuffer + unIndex * 2);
+				break;
+			case TSS_FIELD_UINT32:
+				for (unIndex = 0; unIndex < PunCount; unIndex++)
+					*(UINT32*)(PpbTarget + unIndex * PpField->usElementSize) = BYTE_ARRAY_TO_UINT32(*PprgbBuffer + unIndex * 4);
+				break;
+			default:
+				unReturnValue = RC_E_BAD_PARAMETER;
+				break;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		*PprgbBuffer += PunCount * PpField->bKind;
+		*PpnSize -= (INT32)(PunCount * PpField->bKind);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Marshals a structure by interpreting its type descriptor
+ *	@details	Array fields are bounds checked against their capacity and written with a single size check.
+ *
+ *	@param		PpDescriptor	Type descriptor of the structure
+ *	@param		PpvSource		Location containing the structure that is to be marshaled in to the designated buffer
+ *	@param		PprgbBuffer		Location in the output buffer where the first octet of the TYPE is to be placed
+ *	@param		PpnSize			Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small or an array count exceeds the capacity of its field.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_Marshal(
+	_In_	const TSS_TYPE_DESCRIPTOR*	PpDescriptor,
+	_In_	const void*					PpvSource,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize)
+{
+	// Check parameters
+	if ((NULL == PpDescriptor) || (NULL == PpvSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
+		return RC_E_BAD_PARAMETER;
+
+	return TSS_Descriptor_MarshalFields(PpDescriptor, (const BYTE*)PpvSource, PprgbBuffer, PpnSize);
+}
+
+/**
+ *	@brief		Unmarshals a structure by interpreting its type descriptor
+ *	@details	Array fields are bounds checked against their capacity and read with a single size check.
+ *
+ *	@param		PpDescriptor	Type descriptor of the structure
+ *	@param		PpvTarget		Location into which the data from **PprgbBuffer is placed
+ *	@param		PprgbBuffer		Location in the output buffer containing the most significant octet (MSO) of *PpvTarget
+ *	@param		PpnSize			Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short or an array count exceeds the capacity of its field.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_Unmarshal(
+	_In_	const TSS_TYPE_DESCRIPTOR*	PpDescriptor,
+	_Out_	void*						PpvTarget,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	do
+	{
+		// Check and initialize _Out_ parameters
+		if ((NULL == PpDescriptor) || (NULL == PpvTarget))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		Platform_MemorySetInline(PpvTarget, 0x00, PpDescriptor->usSize);
+		// Check _Inout_ parameters
+		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		unReturnValue = TSS_Descriptor_UnmarshalFields(PpDescriptor, (BYTE*)PpvTarget, PprgbBuffer, PpnSize);
+	}
+	WHILE_FALSE_END;
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Marshals an array of elements described by an element descriptor
+ *
+ *	@param		PpElement	Element descriptor
+ *	@param		PpvSource	First element
+ *	@param		PprgbBuffer	Location in the output buffer where the first octet is to be placed
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PnCount		Number of elements
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_MarshalArray(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpElement,
+	_In_	const void*					PpvSource,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize,
+	_In_	INT32						PnCount)
+{
+	// Check parameters
+	if ((NULL == PpvSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
+		return RC_E_BAD_PARAMETER;
+	if (PnCount <= 0)
+		return RC_SUCCESS;
+
+	return TSS_Descriptor_MarshalElements(PpElement, (const BYTE*)PpvSource, (UINT32)PnCount, PprgbBuffer, PpnSize);
+}
+
+/**
+ *	@brief		Unmarshals an array of elements described by an element descriptor
+ *
+ *	@param		PpElement	Element descriptor
+ *	@param		PpvTarget	First element
+ *	@param		PprgbBuffer	Location in the input buffer containing the first octet
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PnCount		Number of elements
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_UnmarshalArray(
+	_In_	const TSS_FIELD_DESCRIPTOR*	PpElement,
+	_Out_	void*						PpvTarget,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize,
+	_In_	INT32						PnCount)
+{
+	// Check parameters
+	if ((NULL == PpvTarget) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
+		return RC_E_BAD_PARAMETER;
+	if (PnCount <= 0)
+		return RC_SUCCESS;
+
+	return TSS_Descriptor_UnmarshalElements(PpElement, (BYTE*)PpvTarget, (UINT32)PnCount, PprgbBuffer, PpnSize);
+}
+
+/**
+ *	@brief		Reserves room for a fixed-layout block in the marshal buffer
+ *	@details	Validates the buffer pointers and the remaining size once and deducts PnReserve from *PpnSize.
+ *				The block is then written with the TSS_*_MarshalUnchecked helpers, which only advance *PprgbBuffer.
+ *
+ *	@param		PprgbBuffer	Location in the output buffer where the block is to be placed
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PnReserve	Total size of the block in octets
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small for the block.
+ */
+_Check_return_
+unsigned int
+TSS_Marshal_Reserve(
+	_Inout_	BYTE**	PprgbBuffer,
+	_Inout_	INT32*	PpnSize,
+	_In_	INT32	PnReserve)
+{
+	// Check parameters
+	if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize) || (PnReserve < 0))
+		return RC_E_BAD_PARAMETER;
+	// Check size
+	if (*PpnSize < PnReserve)
+		return RC_E_BUFFER_TOO_SMALL;
+
+	*PpnSize -= PnReserve;
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Unmarshals a BYTE array of known size as a view
+ *	@details	Checks that PunCount octets remain in the buffer and references them instead of copying.
+ *
+ *	@param		PpTarget	View that references the octets in **PprgbBuffer
+ *	@param		PprgbBuffer	Location in the input buffer containing the first octet of the array
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PunCount	Number of octets
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short.
+ */
+_Check_return_
+unsigned int
+TSS_BUFFER_VIEW_Unmarshal(
+	_Out_	TSS_BUFFER_VIEW*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnSize,
+	_In_	UINT32				PunCount)
+{
+	// Check parameters
+	if ((NULL == PpTarget) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
+		return RC_E_BAD_PARAMETER;
+	PpTarget->pbData = NULL;
+	PpTarget->unSize = 0;
+	// Check size
+	if ((*PpnSize < 0) || ((UINT32)*PpnSize < PunCount))
+		return RC_E_BUFFER_TOO_SMALL;
+
+	PpTarget->pbData = *PprgbBuffer;
+	PpTarget->unSize = PunCount;
+	*PprgbBuffer += PunCount;
+	*PpnSize -= (INT32)PunCount;
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Unmarshals a TPM2B structure as a view
+ *	@details	Reads the UINT16 size field, checks it against PusMaxSize (the capacity of the buffer field of the
+ *				TPM2B type) and against the remaining input and references the buffer area instead of copying it.
+ *
+ *	@param		PpTarget	View that references the buffer area in **PprgbBuffer
+ *	@param		PprgbBuffer	Location in the input buffer containing the size field of the TPM2B
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PusMaxSize	Capacity of the buffer field of the TPM2B type
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short or the size field exceeds PusMaxSize.
+ */
+_Check_return_
+unsigned int
+TSS_TPM2B_VIEW_Unmarshal(
+	_Out_	TSS_BUFFER_VIEW*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnSize,
+	_In_	UINT16				PusMaxSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	do
+	{
+		UINT16 usSize = 0;
+
+		// Check and initialize _Out_ parameters
+		if (NULL == PpTarget)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		PpTarget->pbData = NULL;
+		PpTarget->unSize = 0;
+
+		unReturnValue = TSS_UINT16_Unmarshal(&usSize, PprgbBuffer, PpnSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (usSize > PusMaxSize)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+		unReturnValue = TSS_BUFFER_VIEW_Unmarshal(PpTarget, PprgbBuffer, PpnSize, usSize);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Copies the octets referenced by a view
+ *
+ *	@param		PpSource		View to copy
+ *	@param		PpTarget		Target buffer
+ *	@param		PunTargetSize	Size of the target buffer in octets
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The target buffer is too small for the view.
+ */
+_Check_return_
+unsigned int
+TSS_BUFFER_VIEW_Copy(
+	_In_						const TSS_BUFFER_VIEW*	PpSource,
+	_Out_bytecap_(PunTargetSize)	BYTE*					PpTarget,
+	_In_						UINT32					PunTargetSize)
+{
+	// Check parameters
+	if ((NULL == PpSource) || (NULL == PpTarget) || ((NULL == PpSource->pbData) && (0 != PpSource->unSize)))
+		return RC_E_BAD_PARAMETER;
+	if (PpSource->unSize > PunTargetSize)
+		return RC_E_BUFFER_TOO_SMALL;
+	if (0 == PpSource->unSize)
+		return RC_SUCCESS;
+
+	Platform_MemoryCopyInline(PpTarget, PpSource->pbData, PpSource->unSize);
+	return RC_SUCCESS;
+}
+
+//--------------------------------------------------------------------------------------------------------
+// Type descriptors
+//--------------------------------------------------------------------------------------------------------
+
+/// Element descriptors of the integer arrays
+const TSS_FIELD_DESCRIPTOR s_sElement_UINT8 = { 0, TSS_FIELD_UINT8, TSS_FIELD_NONE, 0, 1, sizeof(UINT8), NULL };
+const TSS_FIELD_DESCRIPTOR s_sElement_UINT16 = { 0, TSS_FIELD_UINT16, TSS_FIELD_NONE, 0, 1, sizeof(UINT16), NULL };
+const TSS_FIELD_DESCRIPTOR s_sElement_UINT32 = { 0, TSS_FIELD_UINT32, TSS_FIELD_NONE, 0, 1, sizeof(UINT32), NULL };
+
+/// Table 72 - Definition of TPM2B_DIGEST Structure (also TPM2B_NONCE and TPM2B_AUTH)
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPM2B_DIGEST[] =
+{
+	TSS_DESCRIBE_FIELD(TPM2B_DIGEST, size, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_ARRAY(TPM2B_DIGEST, buffer, TSS_FIELD_UINT8, size, TSS_FIELD_UINT16)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPM2B_DIGEST = { sizeof(TPM2B_DIGEST), TSS_FIELD_COUNT(s_rgFields_TPM2B_DIGEST), s_rgFields_TPM2B_DIGEST };
+
+/// Table 78 - Definition of TPM2B_MAX_BUFFER Structure
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPM2B_MAX_BUFFER[] =
+{
+	TSS_DESCRIBE_FIELD(TPM2B_MAX_BUFFER, size, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_ARRAY(TPM2B_MAX_BUFFER, buffer, TSS_FIELD_UINT8, size, TSS_FIELD_UINT16)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPM2B_MAX_BUFFER = { sizeof(TPM2B_MAX_BUFFER), TSS_FIELD_COUNT(s_rgFields_TPM2B_MAX_BUFFER), s_rgFields_TPM2B_MAX_BUFFER };
+const TSS_FIELD_DESCRIPTOR s_sElement_TPM2B_MAX_BUFFER = { 0, TSS_FIELD_STRUCT, TSS_FIELD_NONE, 0, 1, sizeof(TPM2B_MAX_BUFFER), &s_sDescriptor_TPM2B_MAX_BUFFER };
+
+/// Table 80 - Definition of TPM2B_TIMEOUT Structure [IN/OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPM2B_TIMEOUT[] =
+{
+	TSS_DESCRIBE_FIELD(TPM2B_TIMEOUT, size, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_ARRAY(TPM2B_TIMEOUT, buffer, TSS_FIELD_UINT8, size, TSS_FIELD_UINT16)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPM2B_TIMEOUT = { sizeof(TPM2B_TIMEOUT), TSS_FIELD_COUNT(s_rgFields_TPM2B_TIMEOUT), s_rgFields_TPM2B_TIMEOUT };
+
+/// Table 85 - Definition of TPMS_PCR_SELECTION Structure
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPMS_PCR_SELECTION[] =
+{
+	TSS_DESCRIBE_FIELD(TPMS_PCR_SELECTION, hash, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_FIELD(TPMS_PCR_SELECTION, sizeofSelect, TSS_FIELD_UINT8),
+	TSS_DESCRIBE_ARRAY(TPMS_PCR_SELECTION, pcrSelect, TSS_FIELD_UINT8, sizeofSelect, TSS_FIELD_UINT8)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPMS_PCR_SELECTION = { sizeof(TPMS_PCR_SELECTION), TSS_FIELD_COUNT(s_rgFields_TPMS_PCR_SELECTION), s_rgFields_TPMS_PCR_SELECTION };
+const TSS_FIELD_DESCRIPTOR s_sElement_TPMS_PCR_SELECTION = { 0, TSS_FIELD_STRUCT, TSS_FIELD_NONE, 0, 1, sizeof(TPMS_PCR_SELECTION), &s_sDescriptor_TPMS_PCR_SELECTION };
+
+/// Table 90 - Definition of TPMT_TK_AUTH Structure
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPMT_TK_AUTH[] =
+{
+	TSS_DESCRIBE_FIELD(TPMT_TK_AUTH, tag, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_FIELD(TPMT_TK_AUTH, hierarchy, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_STRUCT(TPMT_TK_AUTH, digest, s_sDescriptor_TPM2B_DIGEST)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPMT_TK_AUTH = { sizeof(TPMT_TK_AUTH), TSS_FIELD_COUNT(s_rgFields_TPMT_TK_AUTH), s_rgFields_TPMT_TK_AUTH };
+
+/// Table 92 - Definition of TPMS_ALG_PROPERTY Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPMS_ALG_PROPERTY[] =
+{
+	TSS_DESCRIBE_FIELD(TPMS_ALG_PROPERTY, alg, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_FIELD(TPMS_ALG_PROPERTY, algProperties, TSS_FIELD_UINT32)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPMS_ALG_PROPERTY = { sizeof(TPMS_ALG_PROPERTY), TSS_FIELD_COUNT(s_rgFields_TPMS_ALG_PROPERTY), s_rgFields_TPMS_ALG_PROPERTY };
+const TSS_FIELD_DESCRIPTOR s_sElement_TPMS_ALG_PROPERTY = { 0, TSS_FIELD_STRUCT, TSS_FIELD_NONE, 0, 1, sizeof(TPMS_ALG_PROPERTY), &s_sDescriptor_TPMS_ALG_PROPERTY };
+
+/// Table 93 - Definition of TPMS_TAGGED_PROPERTY Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPMS_TAGGED_PROPERTY[] =
+{
+	TSS_DESCRIBE_FIELD(TPMS_TAGGED_PROPERTY, property, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_FIELD(TPMS_TAGGED_PROPERTY, value, TSS_FIELD_UINT32)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPMS_TAGGED_PROPERTY = { sizeof(TPMS_TAGGED_PROPERTY), TSS_FIELD_COUNT(s_rgFields_TPMS_TAGGED_PROPERTY), s_rgFields_TPMS_TAGGED_PROPERTY };
+const TSS_FIELD_DESCRIPTOR s_sElement_TPMS_TAGGED_PROPERTY = { 0, TSS_FIELD_STRUCT, TSS_FIELD_NONE, 0, 1, sizeof(TPMS_TAGGED_PROPERTY), &s_sDescriptor_TPMS_TAGGED_PROPERTY };
+
+/// Table 94 - Definition of TPMS_TAGGED_PCR_SELECT Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPMS_TAGGED_PCR_SELECT[] =
+{
+	TSS_DESCRIBE_FIELD(TPMS_TAGGED_PCR_SELECT, tag, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_FIELD(TPMS_TAGGED_PCR_SELECT, sizeofSelect, TSS_FIELD_UINT8),
+	TSS_DESCRIBE_ARRAY(TPMS_TAGGED_PCR_SELECT, pcrSelect, TSS_FIELD_UINT8, sizeofSelect, TSS_FIELD_UINT8)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPMS_TAGGED_PCR_SELECT = { sizeof(TPMS_TAGGED_PCR_SELECT), TSS_FIELD_COUNT(s_rgFields_TPMS_TAGGED_PCR_SELECT), s_rgFields_TPMS_TAGGED_PCR_SELECT };
+const TSS_FIELD_DESCRIPTOR s_sElement_TPMS_TAGGED_PCR_SELECT = { 0, TSS_FIELD_STRUCT, TSS_FIELD_NONE, 0, 1, sizeof(TPMS_TAGGED_PCR_SELECT), &s_sDescriptor_TPMS_TAGGED_PCR_SELECT };
+
+/// Table 95 - Definition of TPML_CC Structure
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_CC[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_CC, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_ARRAY(TPML_CC, commandCodes, TSS_FIELD_UINT32, count, TSS_FIELD_UINT32)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_CC = { sizeof(TPML_CC), TSS_FIELD_COUNT(s_rgFields_TPML_CC), s_rgFields_TPML_CC };
+
+/// Table 96 - Definition of TPML_CCA Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_CCA[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_CCA, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_ARRAY(TPML_CCA, commandAttributes, TSS_FIELD_UINT32, count, TSS_FIELD_UINT32)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_CCA = { sizeof(TPML_CCA), TSS_FIELD_COUNT(s_rgFields_TPML_CCA), s_rgFields_TPML_CCA };
+
+/// Table 98 - Definition of TPML_HANDLE Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_HANDLE[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_HANDLE, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_ARRAY(TPML_HANDLE, handle, TSS_FIELD_UINT32, count, TSS_FIELD_UINT32)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_HANDLE = { sizeof(TPML_HANDLE), TSS_FIELD_COUNT(s_rgFields_TPML_HANDLE), s_rgFields_TPML_HANDLE };
+
+/// Table 102 - Definition of TPML_PCR_SELECTION Structure
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_PCR_SELECTION[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_PCR_SELECTION, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_STRUCT_ARRAY(TPML_PCR_SELECTION, pcrSelections, count, TSS_FIELD_UINT32, s_sDescriptor_TPMS_PCR_SELECTION)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_PCR_SELECTION = { sizeof(TPML_PCR_SELECTION), TSS_FIELD_COUNT(s_rgFields_TPML_PCR_SELECTION), s_rgFields_TPML_PCR_SELECTION };
+
+/// Table 103 - Definition of TPML_ALG_PROPERTY Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_ALG_PROPERTY[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_ALG_PROPERTY, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_STRUCT_ARRAY(TPML_ALG_PROPERTY, algProperties, count, TSS_FIELD_UINT32, s_sDescriptor_TPMS_ALG_PROPERTY)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_ALG_PROPERTY = { sizeof(TPML_ALG_PROPERTY), TSS_FIELD_COUNT(s_rgFields_TPML_ALG_PROPERTY), s_rgFields_TPML_ALG_PROPERTY };
+
+/// Table 104 - Definition of TPML_TAGGED_TPM_PROPERTY Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_TAGGED_TPM_PROPERTY[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_TAGGED_TPM_PROPERTY, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_STRUCT_ARRAY(TPML_TAGGED_TPM_PROPERTY, tpmProperty, count, TSS_FIELD_UINT32, s_sDescriptor_TPMS_TAGGED_PROPERTY)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_TAGGED_TPM_PROPERTY = { sizeof(TPML_TAGGED_TPM_PROPERTY), TSS_FIELD_COUNT(s_rgFields_TPML_TAGGED_TPM_PROPERTY), s_rgFields_TPML_TAGGED_TPM_PROPERTY };
+
+/// Table 105 - Definition of TPML_TAGGED_PCR_PROPERTY Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_TAGGED_PCR_PROPERTY[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_TAGGED_PCR_PROPERTY, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_STRUCT_ARRAY(TPML_TAGGED_PCR_PROPERTY, pcrProperty, count, TSS_FIELD_UINT32, s_sDescriptor_TPMS_TAGGED_PCR_SELECT)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_TAGGED_PCR_PROPERTY = { sizeof(TPML_TAGGED_PCR_PROPERTY), TSS_FIELD_COUNT(s_rgFields_TPML_TAGGED_PCR_PROPERTY), s_rgFields_TPML_TAGGED_PCR_PROPERTY };
+
+/// Table 106 - Definition of {ECC} TPML_ECC_CURVE Structure [OUT]
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPML_ECC_CURVE[] =
+{
+	TSS_DESCRIBE_FIELD(TPML_ECC_CURVE, count, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_ARRAY(TPML_ECC_CURVE, eccCurves, TSS_FIELD_UINT16, count, TSS_FIELD_UINT32)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPML_ECC_CURVE = { sizeof(TPML_ECC_CURVE), TSS_FIELD_COUNT(s_rgFields_TPML_ECC_CURVE), s_rgFields_TPML_ECC_CURVE };
+
+/// Table 175 - Definition of TPM2B_ENCRYPTED_SECRET Structure
+const TSS_FIELD_DESCRIPTOR s_rgFields_TPM2B_ENCRYPTED_SECRET[] =
+{
+	TSS_DESCRIBE_FIELD(TPM2B_ENCRYPTED_SECRET, size, TSS_FIELD_UINT16),
+	TSS_DESCRIBE_ARRAY(TPM2B_ENCRYPTED_SECRET, secret, TSS_FIELD_UINT8, size, TSS_FIELD_UINT16)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_TPM2B_ENCRYPTED_SECRET = { sizeof(TPM2B_ENCRYPTED_SECRET), TSS_FIELD_COUNT(s_rgFields_TPM2B_ENCRYPTED_SECRET), s_rgFields_TPM2B_ENCRYPTED_SECRET };
+
+/// Table 14 - Session-Based Authorization of Command
+const TSS_FIELD_DESCRIPTOR s_rgFields_AuthorizationCommandData[] =
+{
+	TSS_DESCRIBE_FIELD(AuthorizationCommandData, authHandle, TSS_FIELD_UINT32),
+	TSS_DESCRIBE_STRUCT(AuthorizationCommandData, nonceCaller, s_sDescriptor_TPM2B_DIGEST),
+	TSS_DESCRIBE_FIELD(AuthorizationCommandData, sessionAttributes, TSS_FIELD_UINT8),
+	TSS_DESCRIBE_STRUCT(AuthorizationCommandData, hmac, s_sDescriptor_TPM2B_DIGEST)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_AuthorizationCommandData = { sizeof(AuthorizationCommandData), TSS_FIELD_COUNT(s_rgFields_AuthorizationCommandData), s_rgFields_AuthorizationCommandData };
+
+/// Table 15 - Session-Based Acknowledgment in Response
+const TSS_FIELD_DESCRIPTOR s_rgFields_AcknowledgmentResponseData[] =
+{
+	TSS_DESCRIBE_STRUCT(AcknowledgmentResponseData, nonceTPM, s_sDescriptor_TPM2B_DIGEST),
+	TSS_DESCRIBE_FIELD(AcknowledgmentResponseData, sessionAttributes, TSS_FIELD_UINT8),
+	TSS_DESCRIBE_STRUCT(AcknowledgmentResponseData, hmac, s_sDescriptor_TPM2B_DIGEST)
+};
+const TSS_TYPE_DESCRIPTOR s_sDescriptor_AcknowledgmentResponseData = { sizeof(AcknowledgmentResponseData), TSS_FIELD_COUNT(s_rgFields_AcknowledgmentResponseData), s_rgFields_AcknowledgmentResponseData };
+
 /**
  *	@brief		Marshals a UINT8 type
  *	@details	Refer to: Table 3 - Definition of Base Types
@@ -76,9 +844,7 @@ TSS_UINT8_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(UINT8));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(UINT8));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
 		{
@@ -120,25 +886,7 @@ TSS_UINT8_Array_Marshal(
 	_Inout_	INT32*			PpnSize,
 	_In_	INT32			PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	// Check parameters
-	if ((NULL == PpSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-	{
-		unReturnValue = RC_E_BAD_PARAMETER;
-	}
-	else
-	{
-		INT32 nPos;
-		unReturnValue = RC_SUCCESS;
-		// Marshal byte by byte to the buffer
-		for (nPos = 0; nPos < PnCount; nPos++)
-		{
-			unReturnValue = TSS_UINT8_Marshal(&PpSource[nPos], PprgbBuffer, PpnSize);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
-	}
-	return unReturnValue;
+	return TSS_Descriptor_MarshalArray(&s_sElement_UINT8, PpSource, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -161,36 +909,7 @@ TSS_UINT8_Array_Unmarshal(
 	_Inout_	INT32*		PpnSize,
 	_In_	INT32		PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(UINT8));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_UINT8_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT8, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -255,25 +974,7 @@ TSS_BYTE_Array_Marshal(
 	_Inout_	INT32*			PpnSize,
 	_In_	INT32			PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	// Check parameters
-	if ((NULL == PpSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-	{
-		unReturnValue = RC_E_BAD_PARAMETER;
-	}
-	else
-	{
-		INT32 nPos;
-		unReturnValue = RC_SUCCESS;
-		// Marshal byte by byte to the buffer
-		for (nPos = 0; nPos < PnCount; nPos++)
-		{
-			unReturnValue = TSS_BYTE_Marshal(&PpSource[nPos], PprgbBuffer, PpnSize);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
-	}
-	return unReturnValue;
+	return TSS_Descriptor_MarshalArray(&s_sElement_UINT8, PpSource, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -296,36 +997,7 @@ TSS_BYTE_Array_Unmarshal(
 	_Inout_	INT32*		PpnSize,
 	_In_	INT32		PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(BYTE));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_BYTE_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT8, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -437,9 +1109,7 @@ TSS_UINT16_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(UINT16));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(UINT16));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
 		{
@@ -528,9 +1198,7 @@ TSS_UINT32_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(UINT32));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(UINT32));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
 		{
@@ -572,25 +1240,7 @@ TSS_UINT32_Array_Marshal(
 	_Inout_	INT32*				PpnSize,
 	_In_	INT32				PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	// Check parameters
-	if ((NULL == PpSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-	{
-		unReturnValue = RC_E_BAD_PARAMETER;
-	}
-	else
-	{
-		INT32 nPos;
-		unReturnValue = RC_SUCCESS;
-		// Marshal byte by byte to the buffer
-		for (nPos = 0; nPos < PnCount; nPos++)
-		{
-			unReturnValue = TSS_UINT32_Marshal(&PpSource[nPos], PprgbBuffer, PpnSize);
-			if (RC_SUCCESS != unReturnValue)
-				break;
-		}
-	}
-	return unReturnValue;
+	return TSS_Descriptor_MarshalArray(&s_sElement_UINT32, PpSource, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -613,36 +1263,7 @@ TSS_UINT32_Array_Unmarshal(
 	_Inout_	INT32*		PpnSize,
 	_In_	INT32		PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(UINT32));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_UINT32_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT32, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -812,36 +1433,7 @@ TSS_TPM_ECC_CURVE_Array_Unmarshal(
 	_Inout_	INT32*				PpnSize,
 	_In_	INT32				PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM_ECC_CURVE));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPM_ECC_CURVE_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT16, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -899,43 +1491,14 @@ TSS_TPM_CC_Unmarshal(
  *	@retval		...			Error codes from called functions.
  */
 _Check_return_
-unsigned int
-TSS_TPM_CC_Array_Unmarshal(
-	_Out_	TPM_CC*		PpTarget,
-	_Inout_	BYTE**		PprgbBuffer,
-	_Inout_	INT32*		PpnSize,
-	_In_	INT32		PnCount)
-{
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM_CC));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPM_CC_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+unsigned int
+TSS_TPM_CC_Array_Unmarshal(
+	_Out_	TPM_CC*		PpTarget,
+	_Inout_	BYTE**		PprgbBuffer,
+	_Inout_	INT32*		PpnSize,
+	_In_	INT32		PnCount)
+{
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT32, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -1168,36 +1731,7 @@ TSS_TPM_HANDLE_Array_Unmarshal(
 	_Inout_	INT32*			PpnSize,
 	_In_	INT32			PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM_HANDLE));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPM_HANDLE_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT32, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -1304,36 +1838,7 @@ TSS_TPMA_CC_Array_Unmarshal(
 	_Inout_	INT32*		PpnSize,
 	_In_	INT32		PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMA_CC));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPMA_CC_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_UINT32, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -1690,38 +2195,7 @@ TSS_TPM2B_DIGEST_Marshal(
 	_Inout_	BYTE**					PprgbBuffer,
 	_Inout_	INT32*					PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check parameters
-		if ((NULL == PpSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		// Check size for PpnSize parameter
-		if (*PpnSize < (INT32) sizeof(PpSource->size))
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal size
-		unReturnValue = TSS_UINT16_Marshal((UINT16 *) & (PpSource->size), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check size for array
-		if (*PpnSize < (INT32) PpSource->size)
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal array
-		unReturnValue = TSS_BYTE_Array_Marshal((BYTE *) & (PpSource->buffer), PprgbBuffer, PpnSize, PpSource->size);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Marshal(&s_sDescriptor_TPM2B_DIGEST, PpSource, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -1742,33 +2216,7 @@ TSS_TPM2B_DIGEST_Unmarshal(
 	_Inout_	BYTE**				PprgbBuffer,
 	_Inout_	INT32*				PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM2B_DIGEST));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT16_Unmarshal((UINT16 *) & (PpTarget->size), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_BYTE_Array_Unmarshal((BYTE *) & (PpTarget->buffer), PprgbBuffer, PpnSize, PpTarget->size);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPM2B_DIGEST, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -1873,33 +2321,7 @@ TSS_TPM2B_MAX_BUFFER_Unmarshal(
 	_Inout_	BYTE**					PprgbBuffer,
 	_Inout_	INT32*					PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM2B_MAX_BUFFER));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT16_Unmarshal((UINT16 *) & (PpTarget->size), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_BYTE_Array_Unmarshal((BYTE *) & (PpTarget->buffer), PprgbBuffer, PpnSize, PpTarget->size);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPM2B_MAX_BUFFER, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -1922,36 +2344,7 @@ TSS_TPM2B_MAX_BUFFER_Array_Unmarshal(
 	_Inout_	INT32*					PpnSize,
 	_In_	INT32					PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM2B_MAX_BUFFER));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPM2B_MAX_BUFFER_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_TPM2B_MAX_BUFFER, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -1972,33 +2365,7 @@ TSS_TPM2B_TIMEOUT_Unmarshal(
 	_Inout_	BYTE**				PprgbBuffer,
 	_Inout_	INT32*				PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPM2B_TIMEOUT));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT16_Unmarshal((UINT16 *) & (PpTarget->size), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_BYTE_Array_Unmarshal((BYTE *) & (PpTarget->buffer), PprgbBuffer, PpnSize, PpTarget->size);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPM2B_TIMEOUT, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2019,88 +2386,30 @@ TSS_TPMS_PCR_SELECTION_Unmarshal(
 	_Inout_	BYTE**					PprgbBuffer,
 	_Inout_	INT32*					PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_PCR_SELECTION));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_TPMI_ALG_HASH_Unmarshal((TPMI_ALG_HASH *) & (PpTarget->hash), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT8_Unmarshal((UINT8 *) & (PpTarget->sizeofSelect), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_BYTE_Array_Unmarshal((BYTE *) & (PpTarget->pcrSelect), PprgbBuffer, PpnSize, PpTarget->sizeofSelect);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPMS_PCR_SELECTION, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
- *	@brief		Unmarshals a TPMS_PCR_SELECTION array
- *	@details	Refer to: Table 85 - Definition of TPMS_PCR_SELECTION Structure
- *
- *	@param		PpTarget	Location into which the data from **PprgbBuffer is placed
- *	@param		PprgbBuffer	Location in the output buffer containing the most significant octet (MSO) of *PpTarget
- *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
- *	@param		PnCount		Number of elements
- *
- *	@retval		RC_SUCCESS	The operation completed successfully.
- *	@retval		...			Error codes from called functions.
- */
-_Check_return_
-unsigned int
-TSS_TPMS_PCR_SELECTION_Array_Unmarshal(
-	_Out_	TPMS_PCR_SELECTION*		PpTarget,
-	_Inout_	BYTE**					PprgbBuffer,
-	_Inout_	INT32*					PpnSize,
-	_In_	INT32					PnCount)
-{
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_PCR_SELECTION));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPMS_PCR_SELECTION_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+ *	@brief		Unmarshals a TPMS_PCR_SELECTION array
+ *	@details	Refer to: Table 85 - Definition of TPMS_PCR_SELECTION Structure
+ *
+ *	@param		PpTarget	Location into which the data from **PprgbBuffer is placed
+ *	@param		PprgbBuffer	Location in the output buffer containing the most significant octet (MSO) of *PpTarget
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PnCount		Number of elements
+ *
+ *	@retval		RC_SUCCESS	The operation completed successfully.
+ *	@retval		...			Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_TPMS_PCR_SELECTION_Array_Unmarshal(
+	_Out_	TPMS_PCR_SELECTION*		PpTarget,
+	_Inout_	BYTE**					PprgbBuffer,
+	_Inout_	INT32*					PpnSize,
+	_In_	INT32					PnCount)
+{
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_TPMS_PCR_SELECTION, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -2121,36 +2430,7 @@ TSS_TPMT_TK_AUTH_Unmarshal(
 	_Inout_	BYTE**				PprgbBuffer,
 	_Inout_	INT32*				PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMT_TK_AUTH));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_TPM_ST_Unmarshal((TPM_ST *) & (PpTarget->tag), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMI_RH_HIERARCHY_Unmarshal((TPMI_RH_HIERARCHY *) & (PpTarget->hierarchy), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM2B_DIGEST_Unmarshal((TPM2B_DIGEST *) & (PpTarget->digest), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPMT_TK_AUTH, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2171,33 +2451,7 @@ TSS_TPMS_ALG_PROPERTY_Unmarshal(
 	_Inout_	BYTE**					PprgbBuffer,
 	_Inout_	INT32*					PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_ALG_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_TPM_ALG_ID_Unmarshal((TPM_ALG_ID *) & (PpTarget->alg), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMA_ALGORITHM_Unmarshal((TPMA_ALGORITHM *) & (PpTarget->algProperties), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPMS_ALG_PROPERTY, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2220,36 +2474,7 @@ TSS_TPMS_ALG_PROPERTY_Array_Unmarshal(
 	_Inout_	INT32*					PpnSize,
 	_In_	INT32					PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_ALG_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPMS_ALG_PROPERTY_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_TPMS_ALG_PROPERTY, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -2270,33 +2495,7 @@ TSS_TPMS_TAGGED_PROPERTY_Unmarshal(
 	_Inout_	BYTE**						PprgbBuffer,
 	_Inout_	INT32*						PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_TAGGED_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_TPM_PT_Unmarshal((TPM_PT *) & (PpTarget->property), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->value), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPMS_TAGGED_PROPERTY, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2319,36 +2518,7 @@ TSS_TPMS_TAGGED_PROPERTY_Array_Unmarshal(
 	_Inout_	INT32*						PpnSize,
 	_In_	INT32						PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_TAGGED_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPMS_TAGGED_PROPERTY_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_TPMS_TAGGED_PROPERTY, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -2369,36 +2539,7 @@ TSS_TPMS_TAGGED_PCR_SELECT_Unmarshal(
 	_Inout_	BYTE**						PprgbBuffer,
 	_Inout_	INT32*						PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_TAGGED_PCR_SELECT));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_TPM_PT_Unmarshal((TPM_PT *) & (PpTarget->tag), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_UINT8_Unmarshal((UINT8 *) & (PpTarget->sizeofSelect), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_BYTE_Array_Unmarshal((BYTE *) & (PpTarget->pcrSelect), PprgbBuffer, PpnSize, PpTarget->sizeofSelect);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPMS_TAGGED_PCR_SELECT, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2421,36 +2562,7 @@ TSS_TPMS_TAGGED_PCR_SELECT_Array_Unmarshal(
 	_Inout_	INT32*						PpnSize,
 	_In_	INT32						PnCount)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_TAGGED_PCR_SELECT));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		{
-			INT32 nPos;
-			for (nPos = 0; nPos < PnCount; nPos++)
-			{
-				unReturnValue = TSS_TPMS_TAGGED_PCR_SELECT_Unmarshal(&PpTarget[nPos], PprgbBuffer, PpnSize);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-			}
-		}
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_UnmarshalArray(&s_sElement_TPMS_TAGGED_PCR_SELECT, PpTarget, PprgbBuffer, PpnSize, PnCount);
 }
 
 /**
@@ -2471,33 +2583,7 @@ TSS_TPML_CC_Unmarshal(
 	_Inout_	BYTE**		PprgbBuffer,
 	_Inout_	INT32*		PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_CC));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_CC_Array_Unmarshal((TPM_CC *) & (PpTarget->commandCodes), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_CC, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2507,44 +2593,18 @@ TSS_TPML_CC_Unmarshal(
  *	@param		PpTarget	Location into which the data from **PprgbBuffer is placed
  *	@param		PprgbBuffer	Location in the output buffer containing the most significant octet (MSO) of *PpTarget
  *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
- *
- *	@retval		RC_SUCCESS	The operation completed successfully.
- *	@retval		...			Error codes from called functions.
- */
-_Check_return_
-unsigned int
-TSS_TPML_CCA_Unmarshal(
-	_Out_	TPML_CCA*		PpTarget,
-	_Inout_	BYTE**			PprgbBuffer,
-	_Inout_	INT32*			PpnSize)
-{
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_CCA));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMA_CC_Array_Unmarshal((TPMA_CC *) & (PpTarget->commandAttributes), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+ *
+ *	@retval		RC_SUCCESS	The operation completed successfully.
+ *	@retval		...			Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+TSS_TPML_CCA_Unmarshal(
+	_Out_	TPML_CCA*		PpTarget,
+	_Inout_	BYTE**			PprgbBuffer,
+	_Inout_	INT32*			PpnSize)
+{
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_CCA, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2565,33 +2625,7 @@ TSS_TPML_HANDLE_Unmarshal(
 	_Inout_	BYTE**			PprgbBuffer,
 	_Inout_	INT32*			PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_HANDLE));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_HANDLE_Array_Unmarshal((TPM_HANDLE *) & (PpTarget->handle), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_HANDLE, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2612,33 +2646,7 @@ TSS_TPML_PCR_SELECTION_Unmarshal(
 	_Inout_	BYTE**					PprgbBuffer,
 	_Inout_	INT32*					PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_PCR_SELECTION));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMS_PCR_SELECTION_Array_Unmarshal((TPMS_PCR_SELECTION *) & (PpTarget->pcrSelections), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_PCR_SELECTION, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2659,33 +2667,7 @@ TSS_TPML_ALG_PROPERTY_Unmarshal(
 	_Inout_	BYTE**					PprgbBuffer,
 	_Inout_	INT32*					PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_ALG_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMS_ALG_PROPERTY_Array_Unmarshal((TPMS_ALG_PROPERTY *) & (PpTarget->algProperties), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_ALG_PROPERTY, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2706,33 +2688,7 @@ TSS_TPML_TAGGED_TPM_PROPERTY_Unmarshal(
 	_Inout_	BYTE**							PprgbBuffer,
 	_Inout_	INT32*							PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_TAGGED_TPM_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMS_TAGGED_PROPERTY_Array_Unmarshal((TPMS_TAGGED_PROPERTY *) & (PpTarget->tpmProperty), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_TAGGED_TPM_PROPERTY, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2753,33 +2709,7 @@ TSS_TPML_TAGGED_PCR_PROPERTY_Unmarshal(
 	_Inout_	BYTE**							PprgbBuffer,
 	_Inout_	INT32*							PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_TAGGED_PCR_PROPERTY));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMS_TAGGED_PCR_SELECT_Array_Unmarshal((TPMS_TAGGED_PCR_SELECT *) & (PpTarget->pcrProperty), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_TAGGED_PCR_PROPERTY, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2800,33 +2730,7 @@ TSS_TPML_ECC_CURVE_Unmarshal(
 	_Inout_	BYTE**				PprgbBuffer,
 	_Inout_	INT32*				PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPML_ECC_CURVE));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_UINT32_Unmarshal((UINT32 *) & (PpTarget->count), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM_ECC_CURVE_Array_Unmarshal((TPM_ECC_CURVE *) & (PpTarget->eccCurves), PprgbBuffer, PpnSize, PpTarget->count);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_TPML_ECC_CURVE, PpTarget, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -2871,8 +2775,8 @@ TSS_TPMU_CAPABILITIES_Unmarshal(
 		// Vendor specific capability handling is done in a vendor specific implementation
 		case TPM_CAP_VENDOR_PROPERTY:
 			return TSS_TPMU_VENDOR_CAPABILITY_Unmarshal(PpTarget, PprgbBuffer, PpnSize);
+		// The selector is taken from the TPM response, so an unknown capability is an error and not an assertion
 		default:
-			assert(FALSE);
 			return RC_E_FAIL;
 	}
 }
@@ -2904,9 +2808,7 @@ TSS_TPMS_CAPABILITY_DATA_Unmarshal(
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(TPMS_CAPABILITY_DATA));
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		Platform_MemorySetInline(PpTarget, 0x00, sizeof(TPMS_CAPABILITY_DATA));
 		// Check _Inout_ parameters
 		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
 		{
@@ -3076,38 +2978,7 @@ TSS_TPM2B_ENCRYPTED_SECRET_Marshal(
 	_Inout_	BYTE**								PprgbBuffer,
 	_Inout_	INT32*								PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check parameters
-		if ((NULL == PpSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		// Check size for PpnSize parameter
-		if (*PpnSize < (INT32) sizeof(PpSource->size))
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal size
-		unReturnValue = TSS_UINT16_Marshal((UINT16 *) & (PpSource->size), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check size for array
-		if (*PpnSize < (INT32) PpSource->size)
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal array
-		unReturnValue = TSS_BYTE_Array_Marshal((BYTE *) & (PpSource->secret), PprgbBuffer, PpnSize, PpSource->size);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Marshal(&s_sDescriptor_TPM2B_ENCRYPTED_SECRET, PpSource, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -3128,58 +2999,7 @@ TSS_AuthorizationCommandData_Marshal(
 	_Inout_	BYTE**								PprgbBuffer,
 	_Inout_	INT32*								PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check parameters
-		if ((NULL == PpSource) || (NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		// Check size for PpnSize parameter
-		if (*PpnSize < (INT32) sizeof(PpSource->authHandle))
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal size
-		unReturnValue = TSS_TPMI_SH_AUTH_SESSION_Marshal((TPMI_SH_AUTH_SESSION *) & (PpSource->authHandle), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check size for PpnSize parameter
-		if (*PpnSize < (INT32) sizeof(PpSource->nonceCaller))
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal size
-		unReturnValue = TSS_TPM2B_NONCE_Marshal((TPM2B_NONCE *) & (PpSource->nonceCaller), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check size for PpnSize parameter
-		if (*PpnSize < (INT32) sizeof(PpSource->sessionAttributes))
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal size
-		unReturnValue = TSS_TPMA_SESSION_Marshal((TPMA_SESSION *) & (PpSource->sessionAttributes), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check size for PpnSize parameter
-		if (*PpnSize < (INT32) sizeof(PpSource->hmac))
-		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
-		}
-		// Marshal size
-		unReturnValue = TSS_TPM2B_AUTH_Marshal((TPM2B_AUTH *) & (PpSource->hmac), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Marshal(&s_sDescriptor_AuthorizationCommandData, PpSource, PprgbBuffer, PpnSize);
 }
 
 /**
@@ -3200,34 +3020,5 @@ TSS_AcknowledgmentResponseData_Unmarshal(
 	_Inout_	BYTE**							PprgbBuffer,
 	_Inout_	INT32*							PpnSize)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
-	do
-	{
-		// Check and initialize _Out_ parameters
-		if (NULL == PpTarget)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = Platform_MemorySet(PpTarget, 0x00, sizeof(AcknowledgmentResponseData));
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		// Check _Inout_ parameters
-		if ((NULL == PprgbBuffer) || (NULL == *PprgbBuffer) || (NULL == PpnSize))
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
-		}
-		unReturnValue = TSS_TPM2B_NONCE_Unmarshal((TPM2B_NONCE *) & (PpTarget->nonceTPM), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPMA_SESSION_Unmarshal((TPMA_SESSION *) & (PpTarget->sessionAttributes), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = TSS_TPM2B_AUTH_Unmarshal((TPM2B_AUTH *) & (PpTarget->hmac), PprgbBuffer, PpnSize);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-	}
-	WHILE_FALSE_END;
-	return unReturnValue;
+	return TSS_Descriptor_Unmarshal(&s_sDescriptor_AcknowledgmentResponseData, PpTarget, PprgbBuffer, PpnSize);
 }
\ No newline at end of file
@@ -6,6 +6,287 @@
 #pragma once
 
 #include "TPM2_Types.h"
+#include "swap.h"
+
+/**
+ *	@brief		Wire formats of the fields of a type descriptor
+ *	@details	The numeric values of the integer kinds equal their size on the wire.
+ */
+typedef enum td_ENUM_TSS_FIELD_KINDS
+{
+	/// No count field (the field holds a single element)
+	TSS_FIELD_NONE = 0,
+	/// Big endian one octet integer (byte arrays are copied in one go)
+	TSS_FIELD_UINT8 = 1,
+	/// Big endian two octet integer
+	TSS_FIELD_UINT16 = 2,
+	/// Big endian four octet integer
+	TSS_FIELD_UINT32 = 4,
+	/// Nested structure described by its own type descriptor
+	TSS_FIELD_STRUCT = 0xFF
+} ENUM_TSS_FIELD_KINDS;
+
+struct tdTSS_TYPE_DESCRIPTOR;
+
+/**
+ *	@brief		Field descriptor
+ *	@details	Describes one field of a structure as it appears on the wire. A field is either a single element
+ *				or an array whose number of elements is stored in a preceding count field of the same structure.
+ */
+typedef struct tdTSS_FIELD_DESCRIPTOR
+{
+	/// Offset of the field within the structure
+	UINT16 usOffset;
+	/// Wire format of one element (ENUM_TSS_FIELD_KINDS)
+	BYTE bKind;
+	/// Wire format of the count field (ENUM_TSS_FIELD_KINDS), TSS_FIELD_NONE for a single element
+	BYTE bCountKind;
+	/// Offset of the count field within the structure
+	UINT16 usCountOffset;
+	/// Number of elements the field can hold
+	UINT16 usMaxCount;
+	/// Size of one element within the structure
+	UINT16 usElementSize;
+	/// Type descriptor of one element for TSS_FIELD_STRUCT fields
+	const struct tdTSS_TYPE_DESCRIPTOR* pElementDescriptor;
+} TSS_FIELD_DESCRIPTOR;
+
+/**
+ *	@brief		Type descriptor
+ *	@details	Lists the fields of a structure in wire order.
+ */
+typedef struct tdTSS_TYPE_DESCRIPTOR
+{
+	/// Size of the structure
+	UINT16 usSize;
+	/// Number of entries in rgFields
+	UINT16 usFieldCount;
+	/// Field descriptors in wire order
+	const TSS_FIELD_DESCRIPTOR* rgFields;
+} TSS_TYPE_DESCRIPTOR;
+
+/// Describes a single integer field
+#define TSS_DESCRIBE_FIELD(type, field, kind) \
+	{ (UINT16)offsetof(type, field), (BYTE)(kind), (BYTE)TSS_FIELD_NONE, 0, 1, (UINT16)sizeof(((type*)0)->field), NULL }
+/// Describes an integer array whose element count is stored in countField
+#define TSS_DESCRIBE_ARRAY(type, field, kind, countField, countKind) \
+	{ (UINT16)offsetof(type, field), (BYTE)(kind), (BYTE)(countKind), (UINT16)offsetof(type, countField), \
+	(UINT16)(sizeof(((type*)0)->field) / sizeof(((type*)0)->field[0])), (UINT16)sizeof(((type*)0)->field[0]), NULL }
+/// Describes a single nested structure
+#define TSS_DESCRIBE_STRUCT(type, field, descriptor) \
+	{ (UINT16)offsetof(type, field), (BYTE)TSS_FIELD_STRUCT, (BYTE)TSS_FIELD_NONE, 0, 1, (UINT16)sizeof(((type*)0)->field), &(descriptor) }
+/// Describes an array of nested structures whose element count is stored in countField
+#define TSS_DESCRIBE_STRUCT_ARRAY(type, field, countField, countKind, descriptor) \
+	{ (UINT16)offsetof(type, field), (BYTE)TSS_FIELD_STRUCT, (BYTE)(countKind), (UINT16)offsetof(type, countField), \
+	(UINT16)(sizeof(((type*)0)->field) / sizeof(((type*)0)->field[0])), (UINT16)sizeof(((type*)0)->field[0]), &(descriptor) }
+/// Number of entries of a field descriptor table
+#define TSS_FIELD_COUNT(fields) ((UINT16)(sizeof(fields) / sizeof((fields)[0])))
+
+/**
+ *	@brief		Marshals a structure by interpreting its type descriptor
+ *	@details	Array fields are bounds checked against their capacity and written with a single size check.
+ *
+ *	@param		PpDescriptor	Type descriptor of the structure
+ *	@param		PpvSource		Location containing the structure that is to be marshaled in to the designated buffer
+ *	@param		PprgbBuffer		Location in the output buffer where the first octet of the TYPE is to be placed
+ *	@param		PpnSize			Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small or an array count exceeds the capacity of its field.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_Marshal(
+	_In_	const TSS_TYPE_DESCRIPTOR*	PpDescriptor,
+	_In_	const void*					PpvSource,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize);
+
+/**
+ *	@brief		Unmarshals a structure by interpreting its type descriptor
+ *	@details	Array fields are bounds checked against their capacity and read with a single size check.
+ *
+ *	@param		PpDescriptor	Type descriptor of the structure
+ *	@param		PpvTarget		Location into which the data from **PprgbBuffer is placed
+ *	@param		PprgbBuffer		Location in the output buffer containing the most significant octet (MSO) of *PpvTarget
+ *	@param		PpnSize			Number of octets remaining in **PprgbBuffer
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short or an array count exceeds the capacity of its field.
+ */
+_Check_return_
+unsigned int
+TSS_Descriptor_Unmarshal(
+	_In_	const TSS_TYPE_DESCRIPTOR*	PpDescriptor,
+	_Out_	void*						PpvTarget,
+	_Inout_	BYTE**						PprgbBuffer,
+	_Inout_	INT32*						PpnSize);
+
+/**
+ *	@brief		Reserves room for a fixed-layout block in the marshal buffer
+ *	@details	Validates the buffer pointers and the remaining size once and deducts PnReserve from *PpnSize.
+ *				The block is then written with the TSS_*_MarshalUnchecked helpers, which only advance *PprgbBuffer.
+ *
+ *	@param		PprgbBuffer	Location in the output buffer where the block is to be placed
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PnReserve	Total size of the block in octets
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The output buffer is too small for the block.
+ */
+_Check_return_
+unsigned int
+TSS_Marshal_Reserve(
+	_Inout_	BYTE**	PprgbBuffer,
+	_Inout_	INT32*	PpnSize,
+	_In_	INT32	PnReserve);
+
+/**
+ *	@brief		Unmarshals a BYTE array of known size as a view
+ *	@details	Checks that PunCount octets remain in the buffer and references them instead of copying.
+ *
+ *	@param		PpTarget	View that references the octets in **PprgbBuffer
+ *	@param		PprgbBuffer	Location in the input buffer containing the first octet of the array
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PunCount	Number of octets
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short.
+ */
+_Check_return_
+unsigned int
+TSS_BUFFER_VIEW_Unmarshal(
+	_Out_	TSS_BUFFER_VIEW*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnSize,
+	_In_	UINT32				PunCount);
+
+/**
+ *	@brief		Unmarshals a TPM2B structure as a view
+ *	@details	Reads the UINT16 size field, checks it against PusMaxSize (the capacity of the buffer field of the
+ *				TPM2B type) and against the remaining input and references the buffer area instead of copying it.
+ *
+ *	@param		PpTarget	View that references the buffer area in **PprgbBuffer
+ *	@param		PprgbBuffer	Location in the input buffer containing the size field of the TPM2B
+ *	@param		PpnSize		Number of octets remaining in **PprgbBuffer
+ *	@param		PusMaxSize	Capacity of the buffer field of the TPM2B type
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The input buffer is too short or the size field exceeds PusMaxSize.
+ */
+_Check_return_
+unsigned int
+TSS_TPM2B_VIEW_Unmarshal(
+	_Out_	TSS_BUFFER_VIEW*	PpTarget,
+	_Inout_	BYTE**				PprgbBuffer,
+	_Inout_	INT32*				PpnSize,
+	_In_	UINT16				PusMaxSize);
+
+/**
+ *	@brief		Copies the octets referenced by a view
+ *
+ *	@param		PpSource		View to copy
+ *	@param		PpTarget		Target buffer
+ *	@param		PunTargetSize	Size of the target buffer in octets
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The target buffer is too small for the view.
+ */
+_Check_return_
+unsigned int
+TSS_BUFFER_VIEW_Copy(
+	_In_						const TSS_BUFFER_VIEW*	PpSource,
+	_Out_bytecap_(PunTargetSize)	BYTE*					PpTarget,
+	_In_						UINT32					PunTargetSize);
+
+/**
+ *	@brief		Marshals a UINT8 into room reserved with TSS_Marshal_Reserve
+ *
+ *	@param		PbValue		Value to marshal
+ *	@param		PprgbBuffer	Location in the output buffer, advanced past the value
+ */
+static inline
+void
+TSS_UINT8_MarshalUnchecked(
+	_In_	UINT8	PbValue,
+	_Inout_	BYTE**	PprgbBuffer)
+{
+	**PprgbBuffer = PbValue;
+	*PprgbBuffer += sizeof(UINT8);
+}
+
+/**
+ *	@brief		Marshals a UINT16 into room reserved with TSS_Marshal_Reserve
+ *
+ *	@param		PusValue	Value to marshal
+ *	@param		PprgbBuffer	Location in the output buffer, advanced past the value
+ */
+static inline
+void
+TSS_UINT16_MarshalUnchecked(
+	_In_	UINT16	PusValue,
+	_Inout_	BYTE**	PprgbBuffer)
+{
+#ifdef SWAP_USE_BUILTINS
+	UINT16 usBigEndian = __builtin_bswap16(PusValue);
+	__builtin_memcpy(*PprgbBuffer, &usBigEndian, sizeof(usBigEndian));
+#else
+	UINT16_TO_BYTE_ARRAY(PusValue, *PprgbBuffer);
+#endif
+	*PprgbBuffer += sizeof(UINT16);
+}
+
+/**
+ *	@brief		Marshals a UINT32 into room reserved with TSS_Marshal_Reserve
+ *
+ *	@param		PunValue	Value to marshal
+ *	@param		PprgbBuffer	Location in the output buffer, advanced past the value
+ */
+static inline
+void
+TSS_UINT32_MarshalUnchecked(
+	_In_	UINT32	PunValue,
+	_Inout_	BYTE**	PprgbBuffer)
+{
+#ifdef SWAP_USE_BUILTINS
+	UINT32 unBigEndian = __builtin_bswap32(PunValue);
+	__builtin_memcpy(*PprgbBuffer, &unBigEndian, sizeof(unBigEndian));
+#else
+	UINT32_TO_BYTE_ARRAY(PunValue, *PprgbBuffer);
+#endif
+	*PprgbBuffer += sizeof(UINT32);
+}
+
+/**
+ *	@brief		Marshals a BYTE array into room reserved with TSS_Marshal_Reserve
+ *
+ *	@param		PpSource	Array to marshal
+ *	@param		PunCount	Number of octets
+ *	@param		PprgbBuffer	Location in the output buffer, advanced past the array
+ */
+static inline
+void
+TSS_BYTE_Array_MarshalUnchecked(
+	_In_reads_bytes_(PunCount)	const BYTE*		PpSource,
+	_In_						UINT32			PunCount,
+	_Inout_						BYTE**			PprgbBuffer)
+{
+#ifdef SWAP_USE_BUILTINS
+	__builtin_memcpy(*PprgbBuffer, PpSource, PunCount);
+#else
+	UINT32 unIndex = 0;
+	for (unIndex = 0; unIndex < PunCount; unIndex++)
+		(*PprgbBuffer)[unIndex] = PpSource[unIndex];
+#endif
+	*PprgbBuffer += PunCount;
+}
+
 /**
  *	@brief		Marshals a UINT8 type
  *	@details	Refer to: Table 3 - Definition of Base Types
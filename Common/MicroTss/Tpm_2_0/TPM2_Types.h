@@ -1830,6 +1830,19 @@ typedef struct _TPML_ECC_CURVE {
 	TPM_ECC_CURVE eccCurves[MAX_ECC_CURVES];
 } TPML_ECC_CURVE;
 
+/**
+ *	@brief		TPML_MAX_BUFFER structure
+ *	@details	TPML_MAX_BUFFER structure definition, holds the vendor specific capability data (TPMU_VENDOR_CAPABILITY)
+ */
+typedef struct _TPML_MAX_BUFFER
+{
+	/// Number of properties
+	/// A value of zero is allowed.
+	uint32_t count;
+	/// An array of bytes
+	TPM2B_MAX_BUFFER buffer[1];
+} TPML_MAX_BUFFER;
+
 /**
  * Table 107 - Definition of TPMU_CAPABILITIES Union [OUT]
  */
@@ -1847,6 +1860,8 @@ typedef union _TPMU_CAPABILITIES {
 	TPML_TAGGED_TPM_PROPERTY tpmProperties;
 	TPML_TAGGED_PCR_PROPERTY pcrProperties;
 	TPML_ECC_CURVE eccCurves;
+	/// TPM_CAP_VENDOR_PROPERTY, the capability is selected by the TPM response, so every TPMU_CAPABILITIES must hold it
+	TPML_MAX_BUFFER vendorData;
 } TPMU_CAPABILITIES;
 
 /**
@@ -3304,4 +3319,16 @@ typedef struct _AcknowledgmentResponseData {
 	TPMA_SESSION sessionAttributes;
 	/// The session HMAC digest value
 	TPM2B_AUTH hmac;
-} AcknowledgmentResponseData;
\ No newline at end of file
+} AcknowledgmentResponseData;
+/**
+ *	@brief		TSS_BUFFER_VIEW structure
+ *	@details	References a length-checked slice of a marshaled buffer instead of holding a copy of it.
+ *				A view is only valid as long as the buffer it was unmarshaled from. Views into a response
+ *				are invalidated by the next command sent through the command context.
+ */
+typedef struct _TSS_BUFFER_VIEW {
+	/// First octet of the slice
+	const BYTE* pbData;
+	/// Size of the slice in octets
+	UINT32 unSize;
+} TSS_BUFFER_VIEW;
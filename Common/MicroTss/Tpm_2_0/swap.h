@@ -41,3 +41,8 @@
 										(b)[5] = (BYTE)((i) >> 16), \
 										(b)[6] = (BYTE)((i) >> 8), \
 										(b)[7] = (BYTE) (i))
+
+// Little endian GCC/Clang targets byte swap whole integers with the bswap builtins
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define SWAP_USE_BUILTINS
+#endif
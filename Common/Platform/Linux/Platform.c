@@ -13,46 +13,204 @@
  *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+// sched_setaffinity and the CPU_* macros
+#define _GNU_SOURCE
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
 #include <sys/time.h>
 #include <time.h>
 #include <wctype.h>
 #include <unistd.h>
+#include <errno.h>
+#include <langinfo.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "StdInclude.h"
 #include "Platform.h"
 
+/// Marks the header of a memory block allocated by Platform_MemoryAllocateZeroAt
+#define PLATFORM_MEMORY_MAGIC 0x4D454D21
+/// Size of a scratch arena chunk
+#define PLATFORM_MEMORY_ARENA_CHUNK_SIZE (8 * 1024)
+/// Alignment of memory blocks
+#define PLATFORM_MEMORY_ALIGNMENT 16
+/// Rounds a size up to the memory block alignment
+#define PLATFORM_MEMORY_ALIGN(size) (((size) + PLATFORM_MEMORY_ALIGNMENT - 1) & ~(PLATFORM_MEMORY_ALIGNMENT - 1))
+
+/// Header in front of each memory block, keeps the data aligned to PLATFORM_MEMORY_ALIGNMENT
+typedef struct tdIfxMemoryBlockHeader
+{
+	/// Requested size of the block
+	unsigned int unSize;
+	/// Call site index of the allocation
+	unsigned short usCallSite;
+	/// TRUE if the block belongs to a scratch arena and must not be freed on its own
+	unsigned short usScratch;
+	/// PLATFORM_MEMORY_MAGIC
+	unsigned int unMagic;
+	/// Reserved for alignment
+	unsigned int unReserved;
+} IfxMemoryBlockHeader;
+
+/// Chunk of a scratch arena, the blocks follow the chunk header
+typedef struct tdIfxMemoryArenaChunk
+{
+	/// Previously used chunk of the arena
+	struct tdIfxMemoryArenaChunk* pPrevious;
+	/// Capacity of the chunk in bytes after the chunk header
+	unsigned int unCapacity;
+	/// Bytes used in the chunk
+	unsigned int unUsed;
+} IfxMemoryArenaChunk;
+
+/// Serializes the allocation counters
+static pthread_mutex_t s_sMemoryMutex = PTHREAD_MUTEX_INITIALIZER;
+/// Allocation counters of the process
+static IfxMemoryStatistics s_sMemoryStatistics = {0, 0, 0, 0, 0, 0};
+/// Allocation counters of the call sites, the last entry counts all call sites exceeding the table
+static IfxMemoryCallSite s_rgsMemoryCallSites[PLATFORM_MEMORY_CALL_SITE_COUNT];
+/// Current chunk of the scratch arena of the thread
+static _Thread_local IfxMemoryArenaChunk* s_pMemoryArena = NULL;
+/// Nesting depth of Platform_MemoryScratchBegin on the thread
+static _Thread_local unsigned int s_unMemoryArenaDepth = 0;
+/// Calibrates s_unSleepOvershoot once
+static pthread_once_t s_sSleepCalibration = PTHREAD_ONCE_INIT;
+/// Time in microseconds the system timer oversleeps, busy-waited by Platform_SleepUntil
+static unsigned int s_unSleepOvershoot = 0;
+/// Flag if the process runs in background mode (set once by Platform_BackgroundBegin before threads are started)
+static BOOL s_fBackground = FALSE;
+
+/**
+ *	@brief		Accounts an allocation to its call site
+ *	@details	Must be called with s_sMemoryMutex locked. The call sites are stored in an open addressing table indexed by a
+ *				hash of the source line and file name pointer.
+ *
+ *	@param		PszFile		Source file of the call site
+ *	@param		PunLine		Source line of the call site
+ *	@param		PunSize		Allocated bytes
+ *	@returns	Index of the call site
+ */
+static unsigned short
+Platform_MemoryAccountCallSite(
+	_In_z_	const char*		PszFile,
+	_In_	unsigned int	PunLine,
+	_In_	unsigned int	PunSize)
+{
+	unsigned int unIndex = (unsigned int)((((size_t)PszFile >> 4) ^ PunLine * 2654435761u) % (PLATFORM_MEMORY_CALL_SITE_COUNT - 1));
+	unsigned int unProbe = 0;
+	IfxMemoryCallSite* pCallSite = &s_rgsMemoryCallSites[PLATFORM_MEMORY_CALL_SITE_COUNT - 1];
+
+	for (unProbe = 0; unProbe < PLATFORM_MEMORY_CALL_SITE_COUNT - 1; unProbe++)
+	{
+		IfxMemoryCallSite* pEntry = &s_rgsMemoryCallSites[unIndex];
+		if (NULL == pEntry->szFile || (pEntry->szFile == PszFile && pEntry->unLine == PunLine))
+		{
+			pEntry->szFile = PszFile;
+			pEntry->unLine = PunLine;
+			pCallSite = pEntry;
+			break;
+		}
+		unIndex = (unIndex + 1) % (PLATFORM_MEMORY_CALL_SITE_COUNT - 1);
+	}
+
+	pCallSite->ullAllocations++;
+	pCallSite->ullBytes += PunSize;
+	pCallSite->ullLiveAllocations++;
+	pCallSite->ullLiveBytes += PunSize;
+
+	return (unsigned short)(pCallSite - s_rgsMemoryCallSites);
+}
+
 /**
  *	@brief		Memory allocation initialized with zeros
- *	@details	This function returns a pointer to a zero initialized memory
+ *	@details	This function returns a pointer to a zero initialized memory. The allocation is accounted to the given
+ *				call site. Scratch memory is bump allocated from the scratch arena of the calling thread if one is active.
  *
  *	@param		PunSize		Memory allocation size in bytes
+ *	@param		PfScratch	TRUE for scratch memory which is not used after the current command
+ *	@param		PszFile		Source file of the call site
+ *	@param		PunLine		Source line of the call site
  *	@retval		!= NULL		Pointer to the zero initialized memory
  *	@retval		NULL		If the allocation fails
  */
 _Check_return_
 void*
-Platform_MemoryAllocateZero(
-	_In_ unsigned int PunSize)
+Platform_MemoryAllocateZeroAt(
+	_In_	unsigned int	PunSize,
+	_In_	BOOL			PfScratch,
+	_In_z_	const char*		PszFile,
+	_In_	unsigned int	PunLine)
 {
-	void* pvBuffer = NULL;
+	IfxMemoryBlockHeader* pHeader = NULL;
+	unsigned int unBlockSize = PLATFORM_MEMORY_ALIGN(sizeof(IfxMemoryBlockHeader) + PunSize);
+
+	if (0 == PunSize || PunSize > UINT_MAX - 2 * PLATFORM_MEMORY_ARENA_CHUNK_SIZE)
+		return NULL;
 
-	if (0 != PunSize)
+	if (PfScratch && 0 != s_unMemoryArenaDepth)
 	{
-		// Allocate new memory, check if allocation was successful and initialize it with zeros
-		pvBuffer = malloc(PunSize);
-		if (NULL != pvBuffer)
+		// Start a new chunk if the current one is full, large blocks get a chunk of their own
+		if (NULL == s_pMemoryArena || s_pMemoryArena->unCapacity - s_pMemoryArena->unUsed < unBlockSize)
 		{
-			if (RC_SUCCESS != Platform_MemorySet(pvBuffer, 0, PunSize))
-				Platform_MemoryFree(&pvBuffer);
+			unsigned int unCapacity = unBlockSize > PLATFORM_MEMORY_ARENA_CHUNK_SIZE ? unBlockSize : PLATFORM_MEMORY_ARENA_CHUNK_SIZE;
+			IfxMemoryArenaChunk* pChunk = (IfxMemoryArenaChunk*)Platform_MemoryAllocateZeroAt(
+					PLATFORM_MEMORY_ALIGN(sizeof(IfxMemoryArenaChunk)) + unCapacity, FALSE, __FILE__, __LINE__);
+			if (NULL == pChunk)
+				return NULL;
+			pChunk->unCapacity = unCapacity;
+			pChunk->pPrevious = s_pMemoryArena;
+			s_pMemoryArena = pChunk;
 		}
+
+		// The chunk memory is zero initialized and never reused before the arena is released
+		pHeader = (IfxMemoryBlockHeader*)((BYTE*)s_pMemoryArena + PLATFORM_MEMORY_ALIGN(sizeof(IfxMemoryArenaChunk)) + s_pMemoryArena->unUsed);
+		s_pMemoryArena->unUsed += unBlockSize;
+		pHeader->usScratch = TRUE;
+
+		IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sMemoryMutex));
+		s_sMemoryStatistics.ullScratchAllocations++;
+		s_sMemoryStatistics.ullScratchBytes += PunSize;
+		pHeader->usCallSite = Platform_MemoryAccountCallSite(PszFile, PunLine, PunSize);
+		IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sMemoryMutex));
 	}
+	else
+	{
+		pHeader = (IfxMemoryBlockHeader*)calloc(1, unBlockSize);
+		if (NULL == pHeader)
+			return NULL;
+
+		IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sMemoryMutex));
+		s_sMemoryStatistics.ullAllocations++;
+		s_sMemoryStatistics.ullLiveBytes += PunSize;
+		if (s_sMemoryStatistics.ullLiveBytes > s_sMemoryStatistics.ullPeakBytes)
+			s_sMemoryStatistics.ullPeakBytes = s_sMemoryStatistics.ullLiveBytes;
+		pHeader->usCallSite = Platform_MemoryAccountCallSite(PszFile, PunLine, PunSize);
+		IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sMemoryMutex));
+	}
+
+	pHeader->unSize = PunSize;
+	pHeader->unMagic = PLATFORM_MEMORY_MAGIC;
 
-	return pvBuffer;
+	return (BYTE*)pHeader + sizeof(IfxMemoryBlockHeader);
 }
 
 /**
  *	@brief		Memory deallocation
- *	@details	This function releases the allocated memory and sets its pointer to NULL
+ *	@details	This function releases the allocated memory and sets its pointer to NULL. Scratch arena memory is released
+ *				with the arena.
  *
  *	@param		PppvMemory	Pointer to the pointer to the memory which should be released
  */
@@ -63,11 +221,136 @@ Platform_MemoryFree(
 	// Check if pointer is not null and free than
 	if (NULL != PppvMemory && NULL != *PppvMemory)
 	{
-		free(*PppvMemory);
+		IfxMemoryBlockHeader* pHeader = (IfxMemoryBlockHeader*)((BYTE*)*PppvMemory - sizeof(IfxMemoryBlockHeader));
+		IfxMemoryCallSite* pCallSite = &s_rgsMemoryCallSites[pHeader->usCallSite];
+
+		IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sMemoryMutex));
+		pCallSite->ullLiveAllocations--;
+		pCallSite->ullLiveBytes -= pHeader->unSize;
+		if (!pHeader->usScratch)
+		{
+			s_sMemoryStatistics.ullFrees++;
+			s_sMemoryStatistics.ullLiveBytes -= pHeader->unSize;
+		}
+		IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sMemoryMutex));
+
+		pHeader->unMagic = 0;
+		if (!pHeader->usScratch)
+			free(pHeader);
 		*PppvMemory = NULL;
 	}
 }
 
+/**
+ *	@brief		Starts a scratch arena on the calling thread
+ *	@details	Scratch allocations of the thread are bump allocated from the arena until Platform_MemoryScratchEnd is
+ *				called. Calls can be nested, the arena is released by the outermost Platform_MemoryScratchEnd.
+ */
+void
+Platform_MemoryScratchBegin()
+{
+	s_unMemoryArenaDepth++;
+}
+
+/**
+ *	@brief		Ends a scratch arena on the calling thread
+ *	@details	Releases the arena memory of the thread when the outermost Platform_MemoryScratchBegin is ended. All scratch
+ *				memory allocated from the arena is invalid afterwards.
+ */
+void
+Platform_MemoryScratchEnd()
+{
+	if (0 == s_unMemoryArenaDepth || 0 != --s_unMemoryArenaDepth)
+		return;
+
+	while (NULL != s_pMemoryArena)
+	{
+		IfxMemoryArenaChunk* pChunk = s_pMemoryArena;
+		s_pMemoryArena = pChunk->pPrevious;
+		Platform_MemoryFree((void**)&pChunk);
+	}
+}
+
+/**
+ *	@brief		Gets the allocation counters of the process
+ *	@details
+ *
+ *	@param		PpStatistics	Receives the counters
+ */
+void
+Platform_MemoryGetStatistics(
+	_Out_ IfxMemoryStatistics* PpStatistics)
+{
+	IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sMemoryMutex));
+	*PpStatistics = s_sMemoryStatistics;
+	IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sMemoryMutex));
+}
+
+/**
+ *	@brief		Gets the allocation counters of the call sites
+ *	@details
+ *
+ *	@param		PrgsCallSites		Receives the counters of the call sites
+ *	@param		PpunCallSiteCount	In: Capacity of PrgsCallSites in elements\n
+ *									Out: Number of call sites returned
+ */
+void
+Platform_MemoryGetCallSites(
+	_Out_cap_(*PpunCallSiteCount)	IfxMemoryCallSite*	PrgsCallSites,
+	_Inout_							unsigned int*		PpunCallSiteCount)
+{
+	unsigned int unIndex = 0;
+	unsigned int unCount = 0;
+
+	IGNORE_RETURN_VALUE(pthread_mutex_lock(&s_sMemoryMutex));
+	for (unIndex = 0; unIndex < PLATFORM_MEMORY_CALL_SITE_COUNT && unCount < *PpunCallSiteCount; unIndex++)
+	{
+		if (0 != s_rgsMemoryCallSites[unIndex].ullAllocations)
+			PrgsCallSites[unCount++] = s_rgsMemoryCallSites[unIndex];
+	}
+	IGNORE_RETURN_VALUE(pthread_mutex_unlock(&s_sMemoryMutex));
+
+	*PpunCallSiteCount = unCount;
+}
+
+/**
+ *	@brief		Locks a buffer into physical memory
+ *	@details	The pages of the buffer are faulted in and not paged out until Platform_MemoryUnlock is called. Fails if
+ *				the RLIMIT_MEMLOCK resource limit is exceeded.
+ *
+ *	@param		PpvBuffer			Buffer to lock
+ *	@param		PunSize				Size of the buffer in bytes
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			The buffer could not be locked.
+ */
+_Check_return_
+unsigned int
+Platform_MemoryLock(
+	_In_bytecount_(PunSize)	const void*		PpvBuffer,
+	_In_					unsigned int	PunSize)
+{
+	if (NULL == PpvBuffer)
+		return RC_E_BAD_PARAMETER;
+	return 0 == mlock(PpvBuffer, PunSize) ? RC_SUCCESS : RC_E_FAIL;
+}
+
+/**
+ *	@brief		Unlocks a buffer locked by Platform_MemoryLock
+ *
+ *	@param		PpvBuffer			Buffer to unlock
+ *	@param		PunSize				Size of the buffer in bytes
+ */
+void
+Platform_MemoryUnlock(
+	_In_bytecount_(PunSize)	const void*		PpvBuffer,
+	_In_					unsigned int	PunSize)
+{
+	if (NULL != PpvBuffer)
+		IGNORE_RETURN_VALUE(munlock(PpvBuffer, PunSize));
+}
+
 /**
  *	@brief		Memory compare
  *	@details	This function compares 2 memory buffers
@@ -409,163 +692,717 @@ Platform_StringFormatV(
 	return unReturnValue;
 }
 
+/// Mask of the bits a wide character must not have to be ASCII
+#define PLATFORM_NON_ASCII_MASK (~0x7F)
+
 /**
- *	@brief		Get Unicode string length
- *	@details	This function returns the length of a Unicode string in elements without the terminating 0
+ *	@brief		Checks if the locale encodes multibyte strings in UTF-8
  *
- *	@param		PwszBuffer				Pointer to the Unicode string buffer
- *	@param		PunMaximumCapacity		Maximum capacity of the string buffer in elements (including terminating 0)
- *	@param		PpunStrLen				Length of the Unicode string in elements (without terminating 0)
- *	@returns	RC_SUCCESS	The operation completed successfully. In case of an error, *PpunStrLen is set to 0 if possible and one of the following error codes is being returned:
- *	@retval		RC_E_FAIL				An unexpected error occurred.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PwszBuffer or PpunStrLen is NULL, or PunMaximumCapacity is 0.
- *	@retval		RC_E_BUFFER_TOO_SMALL	String is not null-terminated within given maximum capacity
+ *	@retval		TRUE		The codeset of the locale is UTF-8.
+ *	@retval		FALSE		Any other codeset.
  */
-_Check_return_
-unsigned int
-Platform_StringGetLength(
-	_In_z_	const wchar_t*	PwszBuffer,
-	_In_	unsigned int	PunMaximumCapacity,
-	_Out_	unsigned int*	PpunStrLen)
+static BOOL
+Platform_IsUtf8Locale()
 {
-	unsigned int unReturnValue = RC_E_FAIL;
+	const char* szCodeset = nl_langinfo(CODESET);
+	return NULL != szCodeset && 0 == strcmp(szCodeset, "UTF-8");
+}
 
-	do
+/**
+ *	@brief		Decodes one UTF-8 sequence
+ *	@details	Only well-formed sequences of Unicode code points are decoded, anything else is left to mbrtowc.
+ *
+ *	@param		PrgbSource			Bytes starting with the lead byte of the sequence
+ *	@param		PunAvailable		Number of available bytes
+ *	@param		PpwcCharacter		Receives the decoded character
+ *	@return		Length of the sequence in bytes, 0 if the sequence is not decoded
+ */
+static unsigned int
+Platform_DecodeUtf8(
+	_In_reads_(PunAvailable)	const BYTE*		PrgbSource,
+	_In_						unsigned int	PunAvailable,
+	_Out_						wchar_t*		PpwcCharacter)
+{
+	unsigned int unCharacter = PrgbSource[0];
+	unsigned int unSequenceSize = 1;
+	unsigned int unMinimum = 0;
+	unsigned int unIndex = 0;
+
+	if (0xC2 <= unCharacter && 0xDF >= unCharacter)
 	{
-		// Check parameters
-		if (NULL == PwszBuffer || 0 == PunMaximumCapacity || NULL == PpunStrLen)
-		{
-			unReturnValue = RC_E_BAD_PARAMETER;
+		unSequenceSize = 2;
+		unCharacter &= 0x1F;
+		unMinimum = 0x80;
+	}
+	else if (0xE0 == (unCharacter & 0xF0))
+	{
+		unSequenceSize = 3;
+		unCharacter &= 0x0F;
+		unMinimum = 0x800;
+	}
+	else if (0xF0 <= unCharacter && 0xF4 >= unCharacter)
+	{
+		unSequenceSize = 4;
+		unCharacter &= 0x07;
+		unMinimum = 0x10000;
+	}
+	else if (0x80 <= unCharacter)
+		return 0;
+
+	if (unSequenceSize > PunAvailable)
+		return 0;
+	for (unIndex = 1; unIndex < unSequenceSize; unIndex++)
+	{
+		if (0x80 != (PrgbSource[unIndex] & 0xC0))
+			return 0;
+		unCharacter = (unCharacter << 6) | (PrgbSource[unIndex] & 0x3F);
+	}
+	if (unCharacter < unMinimum || 0x10FFFF < unCharacter || (0xD800 <= unCharacter && 0xDFFF >= unCharacter))
+		return 0;
+
+	*PpwcCharacter = (wchar_t)unCharacter;
+	return unSequenceSize;
+}
+
+/**
+ *	@brief		Encodes one character in UTF-8
+ *
+ *	@param		PwcCharacter		Character to encode
+ *	@param		PrgbDestination		Buffer of at least 4 bytes receiving the sequence
+ *	@return		Length of the sequence in bytes, 0 for a surrogate or a value that is no code point (left to wcrtomb)
+ */
+static unsigned int
+Platform_EncodeUtf8(
+	_In_			wchar_t		PwcCharacter,
+	_Out_bytecap_(4)	BYTE*		PrgbDestination)
+{
+	unsigned int unCharacter = (unsigned int)PwcCharacter;
+
+	if (0x80 > unCharacter)
+	{
+		PrgbDestination[0] = (BYTE)unCharacter;
+		return 1;
+	}
+	if (0x800 > unCharacter)
+	{
+		PrgbDestination[0] = (BYTE)(0xC0 | (unCharacter >> 6));
+		PrgbDestination[1] = (BYTE)(0x80 | (unCharacter & 0x3F));
+		return 2;
+	}
+	if (0x10000 > unCharacter)
+	{
+		if (0xD800 <= unCharacter && 0xDFFF >= unCharacter)
+			return 0;
+		PrgbDestination[0] = (BYTE)(0xE0 | (unCharacter >> 12));
+		PrgbDestination[1] = (BYTE)(0x80 | ((unCharacter >> 6) & 0x3F));
+		PrgbDestination[2] = (BYTE)(0x80 | (unCharacter & 0x3F));
+		return 3;
+	}
+	if (0x10FFFF < unCharacter)
+		return 0;
+	PrgbDestination[0] = (BYTE)(0xF0 | (unCharacter >> 18));
+	PrgbDestination[1] = (BYTE)(0x80 | ((unCharacter >> 12) & 0x3F));
+	PrgbDestination[2] = (BYTE)(0x80 | ((unCharacter >> 6) & 0x3F));
+	PrgbDestination[3] = (BYTE)(0x80 | (unCharacter & 0x3F));
+	return 4;
+}
+
+/**
+ *	@brief		Narrows the leading ASCII characters of a Unicode string
+ *	@details	Converts 16 characters per step with SSE2 where available. Stops at the first character that is not ASCII.
+ *
+ *	@param		PwszSource			Unicode string, does not need to be zero terminated
+ *	@param		PunSourceLength		Length of the string in elements
+ *	@param		PszDestination		Buffer of at least PunSourceLength bytes receiving the characters
+ *	@return		Number of converted characters
+ */
+static unsigned int
+Platform_StringNarrowAscii(
+	_In_reads_(PunSourceLength)		const wchar_t*	PwszSource,
+	_In_							unsigned int	PunSourceLength,
+	_Out_cap_(PunSourceLength)		char*			PszDestination)
+{
+	unsigned int unIndex = 0;
+
+#if defined(__SSE2__) && 4 == __SIZEOF_WCHAR_T__
+	const __m128i sNonAscii = _mm_set1_epi32(PLATFORM_NON_ASCII_MASK);
+	const __m128i sZero = _mm_setzero_si128();
+	for (; unIndex + 16 <= PunSourceLength; unIndex += 16)
+	{
+		__m128i sChars0 = _mm_loadu_si128((const __m128i*)&PwszSource[unIndex]);
+		__m128i sChars1 = _mm_loadu_si128((const __m128i*)&PwszSource[unIndex + 4]);
+		__m128i sChars2 = _mm_loadu_si128((const __m128i*)&PwszSource[unIndex + 8]);
+		__m128i sChars3 = _mm_loadu_si128((const __m128i*)&PwszSource[unIndex + 12]);
+		__m128i sAny = _mm_or_si128(_mm_or_si128(sChars0, sChars1), _mm_or_si128(sChars2, sChars3));
+		if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(sAny, sNonAscii), sZero)))
 			break;
-		}
+		// All values are below 0x80, so the saturating packs keep them unchanged
+		_mm_storeu_si128((__m128i*)&PszDestination[unIndex],
+			_mm_packus_epi16(_mm_packs_epi32(sChars0, sChars1), _mm_packs_epi32(sChars2, sChars3)));
+	}
+#endif
+	for (; unIndex < PunSourceLength; unIndex++)
+	{
+		if (0 != (PwszSource[unIndex] & PLATFORM_NON_ASCII_MASK))
+			break;
+		PszDestination[unIndex] = (char)PwszSource[unIndex];
+	}
 
-		// Get string length
-		*PpunStrLen = (unsigned int)wcsnlen(PwszBuffer, PunMaximumCapacity);
-		if (*PpunStrLen >= PunMaximumCapacity) // In this case the input string is not null-terminated and / or maximum capacity is too small
+	return unIndex;
+}
+
+/**
+ *	@brief		Widens the leading ASCII characters of a multibyte string
+ *	@details	Converts 16 characters per step with SSE2 where available. Stops at the first byte that is not ASCII.
+ *
+ *	@param		PszSource				Multibyte string, does not need to be zero terminated
+ *	@param		PunSourceSize			Size of the multibyte string in bytes
+ *	@param		PwszDestination			Buffer receiving the characters, NULL to count them only
+ *	@return		Number of converted characters
+ */
+unsigned int
+Platform_StringWidenAscii(
+	_In_reads_(PunSourceSize)			const char*		PszSource,
+	_In_								unsigned int	PunSourceSize,
+	_Out_cap_(PunSourceSize)			wchar_t*		PwszDestination)
+{
+	unsigned int unIndex = 0;
+
+	if (NULL == PszSource)
+		return 0;
+
+#if defined(__SSE2__) && 4 == __SIZEOF_WCHAR_T__
+	{
+		const __m128i sZero = _mm_setzero_si128();
+		for (; unIndex + 16 <= PunSourceSize; unIndex += 16)
 		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
+			__m128i sBytes = _mm_loadu_si128((const __m128i*)&PszSource[unIndex]);
+			__m128i sLow = _mm_unpacklo_epi8(sBytes, sZero);
+			__m128i sHigh = _mm_unpackhi_epi8(sBytes, sZero);
+			int nNonAscii = _mm_movemask_epi8(sBytes);
+			if (0 != nNonAscii)
+			{
+				// The scalar loop widens the ASCII bytes in front of the first non-ASCII byte
+				if (NULL == PwszDestination)
+					return unIndex + (unsigned int)__builtin_ctz((unsigned int)nNonAscii);
+				break;
+			}
+			if (NULL == PwszDestination)
+				continue;
+			_mm_storeu_si128((__m128i*)&PwszDestination[unIndex], _mm_unpacklo_epi16(sLow, sZero));
+			_mm_storeu_si128((__m128i*)&PwszDestination[unIndex + 4], _mm_unpackhi_epi16(sLow, sZero));
+			_mm_storeu_si128((__m128i*)&PwszDestination[unIndex + 8], _mm_unpacklo_epi16(sHigh, sZero));
+			_mm_storeu_si128((__m128i*)&PwszDestination[unIndex + 12], _mm_unpackhi_epi16(sHigh, sZero));
 		}
-
-		unReturnValue = RC_SUCCESS;
 	}
-	WHILE_FALSE_END;
-
-	if (RC_SUCCESS != unReturnValue)
+#endif
+	for (; unIndex < PunSourceSize; unIndex++)
 	{
-		// Reset out parameter
-		if (NULL != PpunStrLen)
-			*PpunStrLen = 0;
+		if (0 != (0x80 & (BYTE)PszSource[unIndex]))
+			break;
+		if (NULL != PwszDestination)
+			PwszDestination[unIndex] = (wchar_t)PszSource[unIndex];
 	}
 
-	return unReturnValue;
+	return unIndex;
 }
 
 /**
- *	@brief		Concatenates Unicode strings
- *	@details	This function concatenates destination and source Unicode strings.
+ *	@brief		Converts a multibyte string in the encoding of the locale to a Unicode string
+ *	@details	Runs of ASCII characters are converted with Platform_StringWidenAscii, other characters are decoded
+ *				directly in a UTF-8 locale and with mbrtowc in any other locale or for sequences the direct decoder does not
+ *				handle, so the result matches mbstowcs. The result is zero terminated. If the buffer is too small, it receives
+ *				the converted part.
  *
- *	@param		PwszDestination				In: Pointer to the destination Unicode buffer
- *											Out: Pointer to the concatenated Unicode buffer
- *	@param		PpunDestinationCapacity		In:	Capacity of the destination buffer in elements (include additional space for terminating 0)\n
- *											Out: Number of elements in the destination buffer (without terminating 0)
- *	@param		PwszSource					Pointer to the source Unicode buffer
- *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_FAIL					An unexpected error occurred.
- *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. One parameter is NULL or strings overlap.
- *	@retval		RC_E_BUFFER_TOO_SMALL		Destination buffer is too small
+ *	@param		PszSource				Multibyte string, does not need to be zero terminated
+ *	@param		PunSourceSize			Size of the multibyte string in bytes
+ *	@param		PwszDestination			Buffer receiving the Unicode string, NULL to get the length only
+ *	@param		PpunLength				In: Capacity of the buffer in elements including the zero termination (ignored for NULL)
+ *										Out: Length of the converted string in elements without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The string does not fit into the buffer.
+ *	@retval		RC_E_FAIL				The string contains an invalid or incomplete multibyte sequence.
  */
 _Check_return_
 unsigned int
-Platform_StringConcatenate(
-	_Inout_updates_z_(*PpunDestinationCapacity)	wchar_t*		PwszDestination,
-	_Inout_										unsigned int*	PpunDestinationCapacity,
-	_In_z_										const wchar_t*	PwszSource)
+Platform_StringFromMultiByte(
+	_In_reads_(PunSourceSize)			const char*		PszSource,
+	_In_								unsigned int	PunSourceSize,
+	_Out_z_cap_(*PpunLength)			wchar_t*		PwszDestination,
+	_Inout_								unsigned int*	PpunLength)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unOffset = 0;
+	unsigned int unLength = 0;
+	BOOL fUtf8 = FALSE;
+	mbstate_t sState;
 
-	do
+	if ((NULL == PszSource && 0 != PunSourceSize) || NULL == PpunLength || (NULL != PwszDestination && 0 == *PpunLength))
+		return RC_E_BAD_PARAMETER;
+
+	fUtf8 = Platform_IsUtf8Locale();
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&sState, 0, sizeof(sState)));
+
+	while (unOffset < PunSourceSize)
 	{
-		unsigned int unSourceLength = 0;
-		unsigned int unDestinationLength = 0;
+		wchar_t wcCharacter = 0;
+		unsigned int unDecoded = 0;
 
-		// Check parameters
-		if (NULL == PwszDestination || NULL == PpunDestinationCapacity || NULL == PwszSource)
+		// ASCII needs no conversion, unless a stateful encoding has shifted
+		if (mbsinit(&sState))
 		{
-			unReturnValue = RC_E_BAD_PARAMETER;
-			break;
+			unsigned int unRun = PunSourceSize - unOffset;
+			if (NULL != PwszDestination && unRun > *PpunLength - 1 - unLength)
+				unRun = *PpunLength - 1 - unLength;
+			unRun = Platform_StringWidenAscii(&PszSource[unOffset], unRun, NULL == PwszDestination ? NULL : &PwszDestination[unLength]);
+			unOffset += unRun;
+			unLength += unRun;
+			if (unOffset == PunSourceSize)
+				break;
 		}
 
-		// Check destination buffer capacity; we need at least a size of 1 for null-termination
-		if (0 == *PpunDestinationCapacity)
+		if (NULL != PwszDestination && unLength + 1 >= *PpunLength)
 		{
 			unReturnValue = RC_E_BUFFER_TOO_SMALL;
 			break;
 		}
 
-		// Get original string lengths
-		unReturnValue = Platform_StringGetLength(PwszSource, *PpunDestinationCapacity, &unSourceLength);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-		unReturnValue = Platform_StringGetLength(PwszDestination, *PpunDestinationCapacity, &unDestinationLength);
-		if (RC_SUCCESS != unReturnValue)
-			break;
-
-		// Check destination buffer capacity; we need at least a size of 1 more element for null-termination
-		if (*PpunDestinationCapacity <= unSourceLength + unDestinationLength)
+		if (fUtf8)
+			unDecoded = Platform_DecodeUtf8((const BYTE*)&PszSource[unOffset], PunSourceSize - unOffset, &wcCharacter);
+		// The locale decides on everything the direct decoder does not handle
+		if (0 == unDecoded)
 		{
-			unReturnValue = RC_E_BUFFER_TOO_SMALL;
-			break;
+			size_t sizeDecoded = mbrtowc(&wcCharacter, &PszSource[unOffset], PunSourceSize - unOffset, &sState);
+			if ((size_t) - 1 != sizeDecoded && (size_t) - 2 != sizeDecoded)
+				unDecoded = 0 == sizeDecoded ? 1 : (unsigned int)sizeDecoded;
 		}
-
-		// Check if strings overlap (not supported by concatenation method)
-		if ((PwszSource == PwszDestination) ||
-				(PwszSource < PwszDestination && PwszSource + unSourceLength >= PwszDestination) ||
-				(PwszSource > PwszDestination && PwszDestination + unDestinationLength >= PwszSource))
+		if (0 == unDecoded)
 		{
-			unReturnValue = RC_E_BAD_PARAMETER;
+			unReturnValue = RC_E_FAIL;
 			break;
 		}
 
-		// Concatenate strings
-		wcscat(PwszDestination, PwszSource);
-
-		// Update destination length
-		unReturnValue = Platform_StringGetLength(PwszDestination, *PpunDestinationCapacity, PpunDestinationCapacity);
-	}
-	WHILE_FALSE_END;
-
-	if (RC_SUCCESS != unReturnValue)
-	{
-		// Reset out parameters
 		if (NULL != PwszDestination)
-			PwszDestination[0] = L'\0';
-		if (NULL != PpunDestinationCapacity)
-			*PpunDestinationCapacity = 0;
+			PwszDestination[unLength] = wcCharacter;
+		unOffset += unDecoded;
+		unLength++;
 	}
 
+	if (NULL != PwszDestination)
+		PwszDestination[unLength] = L'\0';
+	*PpunLength = unLength;
+
 	return unReturnValue;
 }
 
- /**
- *	@brief		Concatenates Unicode strings representing two paths
- *	@details	This function concatenates destination and source Unicode strings representing two paths. The function adds if necessary
- *				a '\' or '/' depending on the operating system.
+/**
+ *	@brief		Writes a Unicode string to a stdio stream
+ *	@details	The string is converted to the multibyte encoding of the locale (UTF-8) in chunks and written with fwrite,
+ *				so the stream stays byte oriented and each character is converted exactly once. Streams written with this
+ *				function must not be written with the wide character stdio functions. Runs of ASCII characters are
+ *				narrowed 16 per step with SSE2 where available, a UTF-8 locale is encoded directly.
  *
- *	@param		PwszDestination				In: Pointer to the destination Unicode buffer
- *											Out: Pointer to the concatenated Unicode buffer
- *	@param		PpunDestinationCapacity		In:	Capacity of the destination buffer in elements (include additional space for terminating 0)\n
- *											Out: Number of elements in the destination buffer (without terminating 0)
- *	@param		PwszSource					Pointer to the source Unicode buffer
- *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_FAIL					An unexpected error occurred.
- *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. One parameter is NULL or strings overlap.
- *	@retval		RC_E_BUFFER_TOO_SMALL		Destination buffer is too small
+ *	@param		PpvStream				FILE pointer of the stream
+ *	@param		PwszString				String to write, does not need to be zero terminated
+ *	@param		PunLength				Length of the string in elements
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL				The string contains a character that cannot be converted, or writing failed.
  */
 _Check_return_
 unsigned int
-Platform_StringConcatenatePaths(
-	_Inout_updates_z_(*PpunDestinationCapacity)	wchar_t*		PwszDestination,
+Platform_StringWriteStream(
+	_In_							void*			PpvStream,
+	_In_reads_(PunLength)			const wchar_t*	PwszString,
+	_In_							unsigned int	PunLength)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	char rgchChunk[1024];
+	unsigned int unChunkSize = 0;
+	unsigned int unIndex = 0;
+	BOOL fUtf8 = FALSE;
+	mbstate_t sState;
+
+	if (NULL == PpvStream || (NULL == PwszString && 0 != PunLength))
+		return RC_E_BAD_PARAMETER;
+
+	fUtf8 = Platform_IsUtf8Locale();
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&sState, 0, sizeof(sState)));
+
+	while (unIndex < PunLength)
+	{
+		unsigned int unRun = 0;
+		size_t sizeConverted = 0;
+
+		// Flush the chunk if the next character may not fit
+		if (unChunkSize + MB_LEN_MAX > sizeof(rgchChunk))
+		{
+			if (unChunkSize != fwrite(rgchChunk, 1, unChunkSize, (FILE*)PpvStream))
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+			unChunkSize = 0;
+		}
+
+		// ASCII needs no conversion, unless a stateful encoding has shifted
+		if (mbsinit(&sState))
+		{
+			unRun = PunLength - unIndex;
+			if (unRun > sizeof(rgchChunk) - unChunkSize)
+				unRun = sizeof(rgchChunk) - unChunkSize;
+			unRun = Platform_StringNarrowAscii(&PwszString[unIndex], unRun, &rgchChunk[unChunkSize]);
+			unIndex += unRun;
+			unChunkSize += unRun;
+			if (0 != unRun)
+				continue;
+		}
+
+		if (fUtf8)
+			sizeConverted = Platform_EncodeUtf8(PwszString[unIndex], (BYTE*)&rgchChunk[unChunkSize]);
+		// The locale decides on everything the direct encoder does not handle
+		if (0 == sizeConverted)
+			sizeConverted = wcrtomb(&rgchChunk[unChunkSize], PwszString[unIndex], &sState);
+		if ((size_t) - 1 == sizeConverted)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unChunkSize += (unsigned int)sizeConverted;
+		unIndex++;
+	}
+
+	if (RC_SUCCESS == unReturnValue && 0 != unChunkSize && unChunkSize != fwrite(rgchChunk, 1, unChunkSize, (FILE*)PpvStream))
+		unReturnValue = RC_E_FAIL;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Initializes a string builder with an empty string
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszBuffer				Buffer receiving the string
+ *	@param		PunCapacity				Capacity of the buffer in elements including the zero termination
+ */
+void
+Platform_StringBuilderInitialize(
+	_Out_							IfxStringBuilder*	PpsBuilder,
+	_Out_z_cap_(PunCapacity)		wchar_t*			PwszBuffer,
+	_In_							unsigned int		PunCapacity)
+{
+	if (NULL == PpsBuilder)
+		return;
+
+	PpsBuilder->pwszBuffer = PwszBuffer;
+	PpsBuilder->unCapacity = PunCapacity;
+	PpsBuilder->unLength = 0;
+	PpsBuilder->unReturnValue = RC_SUCCESS;
+	if (NULL == PwszBuffer || 0 == PunCapacity)
+		PpsBuilder->unReturnValue = RC_E_BAD_PARAMETER;
+	else
+		PwszBuffer[0] = L'\0';
+}
+
+/**
+ *	@brief		Appends a string to a string builder
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszString				String to append
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The string does not fit into the buffer.
+ *	@retval		...						Error of a previous append.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppend(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszString)
+{
+	unsigned int unLength = 0;
+	unsigned int unFree = 0;
+
+	if (NULL == PpsBuilder)
+		return RC_E_BAD_PARAMETER;
+	if (RC_SUCCESS != PpsBuilder->unReturnValue)
+		return PpsBuilder->unReturnValue;
+	if (NULL == PwszString)
+		return PpsBuilder->unReturnValue = RC_E_BAD_PARAMETER;
+
+	// Only the appended string is scanned, and not further than the free space
+	unFree = PpsBuilder->unCapacity - PpsBuilder->unLength;
+	unLength = (unsigned int)wcsnlen(PwszString, unFree);
+	if (unLength >= unFree)
+		return PpsBuilder->unReturnValue = RC_E_BUFFER_TOO_SMALL;
+
+	IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PpsBuilder->pwszBuffer[PpsBuilder->unLength], unFree * sizeof(wchar_t), PwszString, unLength * sizeof(wchar_t)));
+	PpsBuilder->unLength += unLength;
+	PpsBuilder->pwszBuffer[PpsBuilder->unLength] = L'\0';
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Appends a path to a string builder
+ *	@details	Inserts a '/' separator unless the string is empty or already ends with one, like
+ *				Platform_StringConcatenatePaths.
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszPath				Path to append
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from Platform_StringBuilderAppend.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppendPath(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszPath)
+{
+	unsigned int unLength = 0;
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (NULL == PpsBuilder)
+		return RC_E_BAD_PARAMETER;
+
+	// Restore the string without the separator if the path does not fit
+	unLength = PpsBuilder->unLength;
+	if (0 != unLength && RC_SUCCESS == PpsBuilder->unReturnValue && L'/' != PpsBuilder->pwszBuffer[unLength - 1])
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(PpsBuilder, L"/"));
+
+	unReturnValue = Platform_StringBuilderAppend(PpsBuilder, PwszPath);
+	if (RC_SUCCESS != unReturnValue && unLength < PpsBuilder->unCapacity)
+	{
+		PpsBuilder->unLength = unLength;
+		PpsBuilder->pwszBuffer[unLength] = L'\0';
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Appends a formatted string to a string builder
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszFormat				Format string
+ *	@param		...						Parameters needed to format the string
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from Platform_StringBuilderAppendFormatV.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppendFormat(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszFormat,
+	...)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	va_list argptr;
+
+	va_start(argptr, PwszFormat);
+	unReturnValue = Platform_StringBuilderAppendFormatV(PpsBuilder, PwszFormat, argptr);
+	va_end(argptr);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Appends a formatted string to a string builder using a va_list
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszFormat				Format string
+ *	@param		PargList				Parameters needed to format the string
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The formatted string does not fit into the buffer.
+ *	@retval		...						Error of a previous append.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppendFormatV(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszFormat,
+	_In_		va_list				PargList)
+{
+	int nWritten = 0;
+
+	if (NULL == PpsBuilder)
+		return RC_E_BAD_PARAMETER;
+	if (RC_SUCCESS != PpsBuilder->unReturnValue)
+		return PpsBuilder->unReturnValue;
+	if (NULL == PwszFormat)
+		return PpsBuilder->unReturnValue = RC_E_BAD_PARAMETER;
+
+	// Format directly behind the string composed so far
+	nWritten = vswprintf(&PpsBuilder->pwszBuffer[PpsBuilder->unLength], PpsBuilder->unCapacity - PpsBuilder->unLength, PwszFormat, PargList);
+	if (0 > nWritten)
+	{
+		PpsBuilder->pwszBuffer[PpsBuilder->unLength] = L'\0';
+		return PpsBuilder->unReturnValue = RC_E_BUFFER_TOO_SMALL;
+	}
+	PpsBuilder->unLength += (unsigned int)nWritten;
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Get Unicode string length
+ *	@details	This function returns the length of a Unicode string in elements without the terminating 0
+ *
+ *	@param		PwszBuffer				Pointer to the Unicode string buffer
+ *	@param		PunMaximumCapacity		Maximum capacity of the string buffer in elements (including terminating 0)
+ *	@param		PpunStrLen				Length of the Unicode string in elements (without terminating 0)
+ *	@returns	RC_SUCCESS	The operation completed successfully. In case of an error, *PpunStrLen is set to 0 if possible and one of the following error codes is being returned:
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PwszBuffer or PpunStrLen is NULL, or PunMaximumCapacity is 0.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	String is not null-terminated within given maximum capacity
+ */
+_Check_return_
+unsigned int
+Platform_StringGetLength(
+	_In_z_	const wchar_t*	PwszBuffer,
+	_In_	unsigned int	PunMaximumCapacity,
+	_Out_	unsigned int*	PpunStrLen)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PwszBuffer || 0 == PunMaximumCapacity || NULL == PpunStrLen)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Get string length
+		*PpunStrLen = (unsigned int)wcsnlen(PwszBuffer, PunMaximumCapacity);
+		if (*PpunStrLen >= PunMaximumCapacity) // In this case the input string is not null-terminated and / or maximum capacity is too small
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		// Reset out parameter
+		if (NULL != PpunStrLen)
+			*PpunStrLen = 0;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Concatenates Unicode strings
+ *	@details	This function concatenates destination and source Unicode strings.
+ *
+ *	@param		PwszDestination				In: Pointer to the destination Unicode buffer
+ *											Out: Pointer to the concatenated Unicode buffer
+ *	@param		PpunDestinationCapacity		In:	Capacity of the destination buffer in elements (include additional space for terminating 0)\n
+ *											Out: Number of elements in the destination buffer (without terminating 0)
+ *	@param		PwszSource					Pointer to the source Unicode buffer
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. One parameter is NULL or strings overlap.
+ *	@retval		RC_E_BUFFER_TOO_SMALL		Destination buffer is too small
+ */
+_Check_return_
+unsigned int
+Platform_StringConcatenate(
+	_Inout_updates_z_(*PpunDestinationCapacity)	wchar_t*		PwszDestination,
+	_Inout_										unsigned int*	PpunDestinationCapacity,
+	_In_z_										const wchar_t*	PwszSource)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unSourceLength = 0;
+		unsigned int unDestinationLength = 0;
+
+		// Check parameters
+		if (NULL == PwszDestination || NULL == PpunDestinationCapacity || NULL == PwszSource)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Check destination buffer capacity; we need at least a size of 1 for null-termination
+		if (0 == *PpunDestinationCapacity)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		// Get original string lengths
+		unReturnValue = Platform_StringGetLength(PwszSource, *PpunDestinationCapacity, &unSourceLength);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Platform_StringGetLength(PwszDestination, *PpunDestinationCapacity, &unDestinationLength);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Check destination buffer capacity; we need at least a size of 1 more element for null-termination
+		if (*PpunDestinationCapacity <= unSourceLength + unDestinationLength)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		// Check if strings overlap (not supported by concatenation method)
+		if ((PwszSource == PwszDestination) ||
+				(PwszSource < PwszDestination && PwszSource + unSourceLength >= PwszDestination) ||
+				(PwszSource > PwszDestination && PwszDestination + unDestinationLength >= PwszSource))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Concatenate strings
+		wcscat(PwszDestination, PwszSource);
+
+		// Update destination length
+		unReturnValue = Platform_StringGetLength(PwszDestination, *PpunDestinationCapacity, PpunDestinationCapacity);
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		// Reset out parameters
+		if (NULL != PwszDestination)
+			PwszDestination[0] = L'\0';
+		if (NULL != PpunDestinationCapacity)
+			*PpunDestinationCapacity = 0;
+	}
+
+	return unReturnValue;
+}
+
+ /**
+ *	@brief		Concatenates Unicode strings representing two paths
+ *	@details	This function concatenates destination and source Unicode strings representing two paths. The function adds if necessary
+ *				a '\' or '/' depending on the operating system.
+ *
+ *	@param		PwszDestination				In: Pointer to the destination Unicode buffer
+ *											Out: Pointer to the concatenated Unicode buffer
+ *	@param		PpunDestinationCapacity		In:	Capacity of the destination buffer in elements (include additional space for terminating 0)\n
+ *											Out: Number of elements in the destination buffer (without terminating 0)
+ *	@param		PwszSource					Pointer to the source Unicode buffer
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. One parameter is NULL or strings overlap.
+ *	@retval		RC_E_BUFFER_TOO_SMALL		Destination buffer is too small
+ */
+_Check_return_
+unsigned int
+Platform_StringConcatenatePaths(
+	_Inout_updates_z_(*PpunDestinationCapacity)	wchar_t*		PwszDestination,
 	_Inout_										unsigned int*	PpunDestinationCapacity,
 	_In_z_										const wchar_t*	PwszSource)
 {
@@ -690,17 +1527,72 @@ Platform_AnsiString2UnicodeString(
 }
 
 /**
- *	@brief		Convert a string to integer
- *	@details	This function returns the int value produced by interpreting the input characters as a decimal number
+ *	@brief		Convert a Unicode string to an ANSI string
+ *	@details	The conversion uses the multibyte encoding of the current locale.
  *
- *	@param		PwszBuffer				Pointer to the Unicode string buffer
- *	@returns	Decimal numerical value of the interpreted string as integer
+ *	@param		PszDestination				Pointer to the destination ANSI string buffer
+ *	@param		PunDestinationCapacity		Size of the destination ANSI string buffer in bytes.
+ *	@param		PwszSource					Pointer to the Unicode string buffer
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred. The string cannot be represented in the current locale.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. One parameter is NULL.
+ *	@retval		RC_E_BUFFER_TOO_SMALL		Destination buffer is too small
  */
 _Check_return_
-int
-Platform_String2Int(
-	_In_z_ const wchar_t* PwszBuffer)
-{
+unsigned int
+Platform_UnicodeString2AnsiString(
+	_Out_writes_z_(PunDestinationCapacity)	char*			PszDestination,
+	_In_									unsigned int	PunDestinationCapacity,
+	_In_z_									const wchar_t*	PwszSource)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		size_t sizeConverted = 0;
+
+		// Check parameters
+		if (NULL == PszDestination || 0 == PunDestinationCapacity || NULL == PwszSource)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Convert from Unicode to ANSI
+		sizeConverted = wcstombs(PszDestination, PwszSource, PunDestinationCapacity);
+		if (((size_t) - 1) == sizeConverted)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		// Check that the terminating null character fitted into the destination
+		if (sizeConverted >= PunDestinationCapacity)
+		{
+			PszDestination[PunDestinationCapacity - 1] = '\0';
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Convert a string to integer
+ *	@details	This function returns the int value produced by interpreting the input characters as a decimal number
+ *
+ *	@param		PwszBuffer				Pointer to the Unicode string buffer
+ *	@returns	Decimal numerical value of the interpreted string as integer
+ */
+_Check_return_
+int
+Platform_String2Int(
+	_In_z_ const wchar_t* PwszBuffer)
+{
 	int nRetVal = 0;
 
 	if (!PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszBuffer))
@@ -755,6 +1647,57 @@ Platform_WCharToUpper(
 	return towupper(PwchToUpper);
 }
 
+/**
+ *	@brief		Converts a wall clock time stamp to the local time
+ *	@details	Converts the given number of microseconds since 1970-01-01 00:00:00 UTC to the local date and time.
+ *
+ *	@param		PullTimeMicroSeconds	Wall clock time stamp in microseconds (see Platform_GetTimeMicroSeconds)
+ *	@param		PpTime					The local time with millisecond accuracy
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. Returned from the system call.
+ */
+_Check_return_
+unsigned int
+Platform_ConvertTime(
+	_In_	unsigned long long	PullTimeMicroSeconds,
+	_Inout_	IfxTime*			PpTime)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		time_t tSeconds = (time_t)(PullTimeMicroSeconds / 1000000);
+		struct tm sTm;
+
+		// Check parameters
+		if (NULL == PpTime)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// Convert it to a tm structure
+		if (NULL == localtime_r(&tSeconds, &sTm))
+			break;
+
+		// Assign values to returned structure
+		PpTime->unYear = sTm.tm_year + 1900;
+		PpTime->unMonth = sTm.tm_mon + 1;
+		PpTime->unDay = sTm.tm_mday;
+		PpTime->unHour = sTm.tm_hour;
+		PpTime->unMinute = sTm.tm_min;
+		PpTime->unSecond = sTm.tm_sec;
+		PpTime->nMillisecond = (int)(PullTimeMicroSeconds % 1000000 / 1000);
+		PpTime->fMillisecondAvailable = TRUE;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Gets the current time
  *	@details	Retrieves the current local date and time. The accuracy is platform and OS dependent.
@@ -773,8 +1716,7 @@ Platform_GetTime(
 
 	do
 	{
-		struct timeval sTimeval;
-		struct tm* psTm;
+		unsigned long long ullTime = 0;
 
 		// Check parameters
 		if (NULL == PpTime)
@@ -784,25 +1726,11 @@ Platform_GetTime(
 		}
 
 		// Get the time of day
-		if (0 != gettimeofday(&sTimeval, NULL))
-			break;
-
-		// Convert it to a tm structure (the return value points to static data, not thread safe)
-		psTm = localtime(&sTimeval.tv_sec);
-		if (NULL == psTm)
+		ullTime = Platform_GetTimeMicroSeconds();
+		if (0 == ullTime)
 			break;
 
-		// Assign values to returned structure
-		PpTime->unYear = psTm->tm_year + 1900;
-		PpTime->unMonth = psTm->tm_mon + 1;
-		PpTime->unDay = psTm->tm_mday;
-		PpTime->unHour = psTm->tm_hour;
-		PpTime->unMinute = psTm->tm_min;
-		PpTime->unSecond = psTm->tm_sec;
-		PpTime->nMillisecond = sTimeval.tv_usec / 1000;
-		PpTime->fMillisecondAvailable = TRUE;
-
-		unReturnValue = RC_SUCCESS;
+		unReturnValue = Platform_ConvertTime(ullTime, PpTime);
 	}
 	WHILE_FALSE_END;
 
@@ -824,7 +1752,8 @@ Platform_Sleep(
 
 /**
  *	@brief		Sleeps the given time in microseconds.
- *	@details
+ *	@details	The time is converted to a monotonic deadline and waited for with Platform_SleepUntil, so the sleep does
+ *				not drift on interruptions and short waits are busy-waited.
  *
  *	@param		PunSleepTime	Time to sleep in microseconds
  */
@@ -832,7 +1761,1190 @@ void
 Platform_SleepMicroSeconds(
 	_In_ unsigned int PunSleepTime)
 {
-	usleep(PunSleepTime);
+	unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+
+	// Without a monotonic clock there is no deadline to wait for
+	if (0 == ullNow)
+	{
+		usleep(PunSleepTime);
+		return;
+	}
+	Platform_SleepUntil(ullNow + PunSleepTime);
+}
+
+/**
+ *	@brief		Measures how much the system timer oversleeps a short absolute sleep
+ *	@details	Takes the median of a few sleeps of PLATFORM_BUSY_WAIT_MAX_TIME microseconds, capped at
+ *				PLATFORM_BUSY_WAIT_MAX_TIME. Called once through pthread_once.
+ */
+static void
+Platform_CalibrateSleep()
+{
+	unsigned long long rgullOvershoot[5] = {0};
+	unsigned int unCount = RG_LEN(rgullOvershoot);
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < unCount; unIndex++)
+	{
+		unsigned long long ullDeadline = Platform_GetMonotonicTimeMicroSeconds() + PLATFORM_BUSY_WAIT_MAX_TIME;
+		struct timespec sDeadline = {(time_t)(ullDeadline / 1000000), (long)(ullDeadline % 1000000) * 1000};
+		unsigned long long ullNow = 0;
+		unsigned int unSorted = unIndex;
+
+		while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sDeadline, NULL));
+		ullNow = Platform_GetMonotonicTimeMicroSeconds();
+
+		// Insertion sort
+		rgullOvershoot[unIndex] = ullNow > ullDeadline ? ullNow - ullDeadline : 0;
+		while (unSorted > 0 && rgullOvershoot[unSorted - 1] > rgullOvershoot[unSorted])
+		{
+			unsigned long long ullSwap = rgullOvershoot[unSorted - 1];
+			rgullOvershoot[unSorted - 1] = rgullOvershoot[unSorted];
+			rgullOvershoot[unSorted] = ullSwap;
+			unSorted--;
+		}
+	}
+
+	s_unSleepOvershoot = rgullOvershoot[unCount / 2] > PLATFORM_BUSY_WAIT_MAX_TIME ? PLATFORM_BUSY_WAIT_MAX_TIME : (unsigned int)rgullOvershoot[unCount / 2];
+}
+
+/**
+ *	@brief		Sleeps until a monotonic deadline
+ *	@details	The thread sleeps on the absolute deadline. The last part of the wait, which the system timer typically
+ *				oversleeps, is busy-waited: its length is calibrated on the first call and capped at
+ *				PLATFORM_BUSY_WAIT_MAX_TIME microseconds. Returns immediately if the deadline has passed.
+ *				In background mode (see Platform_BackgroundBegin) the whole wait is slept.
+ *
+ *	@param		PullDeadline	Monotonic time stamp in microseconds (see Platform_GetDeadline)
+ */
+void
+Platform_SleepUntil(
+	_In_ unsigned long long PullDeadline)
+{
+	unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+
+	if (0 == ullNow || ullNow >= PullDeadline)
+		return;
+
+	// Do not spin in background mode, the wake-up may be late
+	if (TRUE == s_fBackground)
+	{
+		struct timespec sDeadline = {(time_t)(PullDeadline / 1000000), (long)(PullDeadline % 1000000) * 1000};
+		while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sDeadline, NULL));
+		return;
+	}
+	IGNORE_RETURN_VALUE(pthread_once(&s_sSleepCalibration, &Platform_CalibrateSleep));
+
+	// Sleep on the absolute deadline, an interrupted sleep is resumed without drift
+	if (PullDeadline - ullNow > s_unSleepOvershoot)
+	{
+		unsigned long long ullWakeup = PullDeadline - s_unSleepOvershoot;
+		struct timespec sWakeup = {(time_t)(ullWakeup / 1000000), (long)(ullWakeup % 1000000) * 1000};
+		while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sWakeup, NULL));
+	}
+
+	// Busy-wait for the rest
+	while (Platform_GetMonotonicTimeMicroSeconds() < PullDeadline);
+}
+
+/**
+ *	@brief		Returns the monotonic deadline the given time from now
+ *
+ *	@param		PunTimeout		Time from now in microseconds
+ *
+ *	@returns	Monotonic time stamp in microseconds
+ */
+unsigned long long
+Platform_GetDeadline(
+	_In_ unsigned int PunTimeout)
+{
+	return Platform_GetMonotonicTimeMicroSeconds() + PunTimeout;
+}
+
+/**
+ *	@brief		Returns the time remaining until a monotonic deadline
+ *
+ *	@param		PullDeadline	Monotonic time stamp in microseconds (see Platform_GetDeadline)
+ *
+ *	@returns	Remaining time in microseconds, 0 if the deadline has passed
+ */
+unsigned long long
+Platform_GetRemainingTime(
+	_In_ unsigned long long PullDeadline)
+{
+	unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+	return ullNow < PullDeadline ? PullDeadline - ullNow : 0;
+}
+
+/// Scheduling settings of a thread saved by Platform_RealtimeBegin
+typedef struct tdIfxRealtimeState
+{
+	/// Flags of the applied settings (PLATFORM_REALTIME_*)
+	unsigned int unApplied;
+	/// CPU affinity before Platform_RealtimeBegin
+	cpu_set_t sAffinity;
+	/// Scheduling policy before Platform_RealtimeBegin
+	int nPolicy;
+	/// Scheduling parameters before Platform_RealtimeBegin
+	struct sched_param sParam;
+	/// Nice value before Platform_RealtimeBegin
+	int nNice;
+} IfxRealtimeState;
+
+/**
+ *	@brief		Raises the scheduling of the calling thread for a timing sensitive operation
+ *	@details	The thread is pinned to the given CPU and switched to SCHED_FIFO with PLATFORM_REALTIME_PRIORITY. If the
+ *				real-time policy is not permitted, the nice value is lowered to PLATFORM_REALTIME_NICE instead. Each
+ *				setting is applied on a best effort basis, *PpunApplied tells which ones took effect. The previous
+ *				settings are restored by Platform_RealtimeEnd.
+ *
+ *	@param		PnCpu				CPU to pin the thread to, -1 leaves the CPU affinity unchanged
+ *	@param		PppvState			Receives the saved settings to be passed to Platform_RealtimeEnd
+ *	@param		PpunApplied			Receives the flags of the applied settings (PLATFORM_REALTIME_*)
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			Memory allocation failed or the current settings could not be read.
+ */
+_Check_return_
+unsigned int
+Platform_RealtimeBegin(
+	_In_						int				PnCpu,
+	_Outptr_result_maybenull_	void**			PppvState,
+	_Out_						unsigned int*	PpunApplied)
+{
+	IfxRealtimeState* psState = NULL;
+	pid_t nThread = (pid_t)syscall(SYS_gettid);
+
+	if (NULL == PppvState || NULL == PpunApplied)
+		return RC_E_BAD_PARAMETER;
+	*PppvState = NULL;
+	*PpunApplied = 0;
+
+	psState = (IfxRealtimeState*)Platform_MemoryAllocateZero(sizeof(IfxRealtimeState));
+	if (NULL == psState)
+		return RC_E_FAIL;
+
+	// Save the current settings
+	errno = 0;
+	psState->nNice = getpriority(PRIO_PROCESS, (id_t)nThread);
+	psState->nPolicy = sched_getscheduler(0);
+	if (0 != errno || -1 == psState->nPolicy || 0 != sched_getparam(0, &psState->sParam) ||
+			0 != sched_getaffinity(0, sizeof(psState->sAffinity), &psState->sAffinity))
+	{
+		Platform_MemoryFree((void**)&psState);
+		return RC_E_FAIL;
+	}
+
+	if (PnCpu >= 0 && PnCpu < CPU_SETSIZE)
+	{
+		cpu_set_t sAffinity;
+		CPU_ZERO(&sAffinity);
+		CPU_SET(PnCpu, &sAffinity);
+		if (0 == sched_setaffinity(0, sizeof(sAffinity), &sAffinity))
+			psState->unApplied |= PLATFORM_REALTIME_AFFINITY;
+	}
+
+	{
+		struct sched_param sParam;
+		sParam.sched_priority = PLATFORM_REALTIME_PRIORITY;
+		if (0 == sched_setscheduler(0, SCHED_FIFO, &sParam))
+			psState->unApplied |= PLATFORM_REALTIME_FIFO;
+		else if (0 == setpriority(PRIO_PROCESS, (id_t)nThread, PLATFORM_REALTIME_NICE))
+			psState->unApplied |= PLATFORM_REALTIME_NICE_VALUE;
+	}
+
+	*PpunApplied = psState->unApplied;
+	*PppvState = psState;
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Restores the scheduling settings saved by Platform_RealtimeBegin
+ *	@details	Must be called on the thread which called Platform_RealtimeBegin.
+ *
+ *	@param		PppvState			Pointer to the saved settings. Set to NULL on return.
+ */
+void
+Platform_RealtimeEnd(
+	_Inout_ void** PppvState)
+{
+	IfxRealtimeState* psState = NULL;
+
+	if (NULL == PppvState || NULL == *PppvState)
+		return;
+	psState = (IfxRealtimeState*)*PppvState;
+
+	if (0 != (psState->unApplied & PLATFORM_REALTIME_FIFO))
+		IGNORE_RETURN_VALUE(sched_setscheduler(0, psState->nPolicy, &psState->sParam));
+	if (0 != (psState->unApplied & PLATFORM_REALTIME_NICE_VALUE))
+		IGNORE_RETURN_VALUE(setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), psState->nNice));
+	if (0 != (psState->unApplied & PLATFORM_REALTIME_AFFINITY))
+		IGNORE_RETURN_VALUE(sched_setaffinity(0, sizeof(psState->sAffinity), &psState->sAffinity));
+
+	Platform_MemoryFree(PppvState);
+}
+
+/// I/O priority target of ioprio_set for a thread (see ioprio_set(2))
+#define PLATFORM_IOPRIO_WHO_PROCESS 1
+/// Idle I/O scheduling class shifted into an I/O priority value (see ioprio_set(2))
+#define PLATFORM_IOPRIO_IDLE (3 << 13)
+
+/**
+ *	@brief		Lowers the scheduling of the calling thread to run with little impact on other workloads
+ *	@details	The thread is switched to SCHED_IDLE (or the nice value is raised to PLATFORM_BACKGROUND_NICE if that is not
+ *				permitted), gets the idle I/O scheduling class and a timer slack of PLATFORM_BACKGROUND_TIMER_SLACK.
+ *				Threads created afterwards inherit these settings, so it should be called before any thread is started.
+ *				From then on Platform_SleepUntil does not busy-wait and Platform_IsBackground returns TRUE. Each setting
+ *				is applied on a best effort basis, *PpunApplied tells which ones took effect. The settings are kept.
+ *
+ *	@param		PpunApplied			Receives the flags of the applied settings (PLATFORM_BACKGROUND_*)
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+Platform_BackgroundBegin(
+	_Out_	unsigned int*	PpunApplied)
+{
+	struct sched_param sParam;
+
+	if (NULL == PpunApplied)
+		return RC_E_BAD_PARAMETER;
+	*PpunApplied = 0;
+
+	sParam.sched_priority = 0;
+	if (0 == sched_setscheduler(0, SCHED_IDLE, &sParam))
+		*PpunApplied |= PLATFORM_BACKGROUND_IDLE;
+	else if (0 == setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), PLATFORM_BACKGROUND_NICE))
+		*PpunApplied |= PLATFORM_BACKGROUND_NICE_VALUE;
+	if (0 == syscall(SYS_ioprio_set, PLATFORM_IOPRIO_WHO_PROCESS, 0, PLATFORM_IOPRIO_IDLE))
+		*PpunApplied |= PLATFORM_BACKGROUND_IO_IDLE;
+	if (0 == prctl(PR_SET_TIMERSLACK, (unsigned long)PLATFORM_BACKGROUND_TIMER_SLACK, 0, 0, 0))
+		*PpunApplied |= PLATFORM_BACKGROUND_SLACK;
+
+	s_fBackground = TRUE;
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Checks if the process runs in background mode
+ *	@details	Wait loops use longer sleeps of at least PLATFORM_BACKGROUND_MIN_SLEEP microseconds in background mode.
+ *
+ *	@retval		TRUE		Platform_BackgroundBegin has been called.
+ *	@retval		FALSE		The process runs with the normal scheduling.
+ */
+BOOL
+Platform_IsBackground()
+{
+	return s_fBackground;
+}
+
+/**
+ *	@brief		Returns the wall clock time in microseconds
+ *	@details	The time stamp is the number of microseconds since 1970-01-01 00:00:00 UTC.
+ *
+ *	@returns	Wall clock time stamp in microseconds, 0 in case the clock is not available
+ */
+unsigned long long
+Platform_GetTimeMicroSeconds()
+{
+	struct timespec sTimespec;
+
+	if (0 != clock_gettime(CLOCK_REALTIME, &sTimespec))
+		return 0;
+
+	return (unsigned long long)sTimespec.tv_sec * 1000000 + (unsigned long long)sTimespec.tv_nsec / 1000;
+}
+
+/**
+ *	@brief		Returns a monotonic time stamp in microseconds
+ *	@details	The time stamp is not related to the wall clock time and is only meaningful to measure elapsed time.
+ *
+ *	@returns	Monotonic time stamp in microseconds, 0 in case the clock is not available
+ */
+unsigned long long
+Platform_GetMonotonicTimeMicroSeconds()
+{
+	struct timespec sTimespec;
+
+	if (0 != clock_gettime(CLOCK_MONOTONIC, &sTimespec))
+		return 0;
+
+	return (unsigned long long)sTimespec.tv_sec * 1000000 + (unsigned long long)sTimespec.tv_nsec / 1000;
+}
+
+/**
+ *	@brief		Returns the CPU time consumed by the calling thread in microseconds
+ *	@details	Only the time the thread was running on a CPU is counted, time spent sleeping or blocked in a system
+ *				call is not. Work of other threads (e.g. the asynchronous log writer) is not included.
+ *
+ *	@returns	CPU time of the calling thread in microseconds, 0 in case the clock is not available
+ */
+unsigned long long
+Platform_GetThreadCpuTimeMicroSeconds()
+{
+	struct timespec sTimespec;
+
+	if (0 != clock_gettime(CLOCK_THREAD_CPUTIME_ID, &sTimespec))
+		return 0;
+
+	return (unsigned long long)sTimespec.tv_sec * 1000000 + (unsigned long long)sTimespec.tv_nsec / 1000;
+}
+
+/// Thread handle used by Platform_ThreadCreate and Platform_ThreadJoin
+typedef struct tdIfxPlatformThread
+{
+	/// POSIX thread
+	pthread_t sThread;
+	/// Function executed by the thread
+	void (*pfnThreadFunction)(void*);
+	/// Context passed to the thread function
+	void* pvContext;
+} IfxPlatformThread;
+
+/**
+ *	@brief		POSIX thread start routine
+ *	@details	Calls the thread function of the given thread handle.
+ *
+ *	@param		PpvThread		Thread handle
+ *	@returns	NULL
+ */
+static void*
+Platform_ThreadStart(
+	_In_ void* PpvThread)
+{
+	IfxPlatformThread* pThread = (IfxPlatformThread*)PpvThread;
+	pThread->pfnThreadFunction(pThread->pvContext);
+	return NULL;
+}
+
+/**
+ *	@brief		Starts a thread
+ *	@details	The thread executes the given function with the given context. The thread must be released by Platform_ThreadJoin.
+ *				The thread gets a stack of PLATFORM_THREAD_STACK_SIZE bytes.
+ *
+ *	@param		PfnThreadFunction		Function executed by the thread
+ *	@param		PpvContext				Context passed to the thread function (optional, can be NULL)
+ *	@param		PppvThreadHandle		Pointer to store the thread handle to
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The thread could not be started.
+ */
+_Check_return_
+unsigned int
+Platform_ThreadCreate(
+	_In_		void			(*PfnThreadFunction)(void*),
+	_In_opt_	void*			PpvContext,
+	_Outptr_result_maybenull_	void**	PppvThreadHandle)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxPlatformThread* pThread = NULL;
+		pthread_attr_t sAttributes;
+		int nResult = 0;
+
+		// Check parameters
+		if (NULL == PfnThreadFunction || NULL == PppvThreadHandle)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvThreadHandle = NULL;
+
+		pThread = (IfxPlatformThread*)Platform_MemoryAllocateZero(sizeof(IfxPlatformThread));
+		if (NULL == pThread)
+			break;
+
+		pThread->pfnThreadFunction = PfnThreadFunction;
+		pThread->pvContext = PpvContext;
+		if (0 != pthread_attr_init(&sAttributes))
+		{
+			Platform_MemoryFree((void**)&pThread);
+			break;
+		}
+		// The default stack size is used if the C library rejects the size
+		IGNORE_RETURN_VALUE(pthread_attr_setstacksize(&sAttributes, PLATFORM_THREAD_STACK_SIZE));
+		nResult = pthread_create(&pThread->sThread, &sAttributes, Platform_ThreadStart, pThread);
+		IGNORE_RETURN_VALUE(pthread_attr_destroy(&sAttributes));
+		if (0 != nResult)
+		{
+			Platform_MemoryFree((void**)&pThread);
+			break;
+		}
+
+		*PppvThreadHandle = pThread;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Waits for a thread to finish
+ *	@details	Waits until the thread function returned and releases the thread handle.
+ *
+ *	@param		PppvThreadHandle		Pointer to the thread handle. Set to NULL on return.
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_ThreadJoin(
+	_Inout_ void** PppvThreadHandle)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxPlatformThread* pThread = NULL;
+
+		// Check parameter
+		if (NULL == PppvThreadHandle || NULL == *PppvThreadHandle)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		pThread = (IfxPlatformThread*)*PppvThreadHandle;
+		if (0 == pthread_join(pThread->sThread, NULL))
+			unReturnValue = RC_SUCCESS;
+
+		Platform_MemoryFree(PppvThreadHandle);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/// Handler registered by Platform_RegisterTerminationHandler
+static void (*s_pfnTerminationHandler)(void) = NULL;
+
+/**
+ *	@brief		Signal handler for terminating signals
+ *	@details	Calls the registered termination handler and raises the signal again to perform the default action.
+ *
+ *	@param		PnSignal		Signal number
+ */
+static void
+Platform_OnTerminationSignal(
+	_In_ int PnSignal)
+{
+	if (NULL != s_pfnTerminationHandler)
+	{
+		void (*pfnTerminationHandler)(void) = s_pfnTerminationHandler;
+		s_pfnTerminationHandler = NULL;
+		pfnTerminationHandler();
+	}
+
+	// The handler has been reset to the default action by SA_RESETHAND
+	raise(PnSignal);
+}
+
+/**
+ *	@brief		Registers a handler for abnormal process termination
+ *	@details	The handler is called once when the process is terminated by a signal (e.g. crash or interrupt).
+ *				Afterwards the default signal action terminates the process. The handler must be async-signal-safe.
+ *
+ *	@param		PfnTerminationHandler	Handler to call
+ */
+void
+Platform_RegisterTerminationHandler(
+	_In_ void (*PfnTerminationHandler)(void))
+{
+	const int rgnSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM, SIGINT, SIGHUP };
+	struct sigaction sAction;
+	unsigned int unIndex = 0;
+
+	memset(&sAction, 0, sizeof(sAction));
+	sAction.sa_handler = Platform_OnTerminationSignal;
+	sAction.sa_flags = SA_RESETHAND | SA_NODEFER;
+	sigemptyset(&sAction.sa_mask);
+
+	s_pfnTerminationHandler = PfnTerminationHandler;
+	for (unIndex = 0; unIndex < RG_LEN(rgnSignals); unIndex++)
+		IGNORE_RETURN_VALUE(sigaction(rgnSignals[unIndex], &sAction, NULL));
+}
+
+/// Local socket handle used by the Platform_LocalSocket functions
+typedef struct tdIfxPlatformSocket
+{
+	/// Socket file descriptor
+	int nSocket;
+	/// Path of the socket file, only set for a listening socket to remove the file on close
+	char szPath[sizeof(((struct sockaddr_un*)NULL)->sun_path)];
+} IfxPlatformSocket;
+
+/**
+ *	@brief		Creates a listening local socket
+ *	@details	Binds a stream socket in the local (Unix domain) namespace to the given path. An existing socket file at the
+ *				path is replaced. The socket file is only accessible by the owner of the process.
+ *
+ *	@param		PwszPath				Path of the socket file
+ *	@param		PppvSocket				Receives the socket handle, must be closed with Platform_LocalSocketClose
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or the path is too long.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The socket could not be created.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketListen(
+	_In_z_						const wchar_t*	PwszPath,
+	_Outptr_result_maybenull_	void**			PppvSocket)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxPlatformSocket* pSocket = NULL;
+
+	do
+	{
+		struct sockaddr_un sAddress;
+		size_t sizePath = 0;
+		mode_t unMask = 0;
+		int nResult = 0;
+
+		// Check parameters
+		if (NULL == PwszPath || NULL == PppvSocket)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvSocket = NULL;
+
+		memset(&sAddress, 0, sizeof(sAddress));
+		sAddress.sun_family = AF_UNIX;
+		sizePath = wcstombs(sAddress.sun_path, PwszPath, sizeof(sAddress.sun_path));
+		if ((size_t)-1 == sizePath || 0 == sizePath || sizeof(sAddress.sun_path) <= sizePath)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		pSocket = (IfxPlatformSocket*)Platform_MemoryAllocateZero(sizeof(IfxPlatformSocket));
+		if (NULL == pSocket)
+			break;
+		pSocket->nSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (-1 == pSocket->nSocket)
+			break;
+
+		// Replace a socket file left over by a previous instance, create the new one without access for other users
+		IGNORE_RETURN_VALUE(unlink(sAddress.sun_path));
+		unMask = umask(S_IRWXG | S_IRWXO);
+		nResult = bind(pSocket->nSocket, (const struct sockaddr*)&sAddress, sizeof(sAddress));
+		IGNORE_RETURN_VALUE(umask(unMask));
+		if (0 != nResult)
+			break;
+		memcpy(pSocket->szPath, sAddress.sun_path, sizeof(pSocket->szPath));
+
+		if (0 != listen(pSocket->nSocket, SOMAXCONN))
+			break;
+
+		*PppvSocket = pSocket;
+		pSocket = NULL;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pSocket)
+		Platform_LocalSocketClose((void**)&pSocket);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Waits for a connection on a listening local socket
+ *	@details
+ *
+ *	@param		PpvSocket				Socket handle returned by Platform_LocalSocketListen
+ *	@param		PppvConnection			Receives the connection handle, must be closed with Platform_LocalSocketClose
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketAccept(
+	_In_						void*	PpvSocket,
+	_Outptr_result_maybenull_	void**	PppvConnection)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxPlatformSocket* pConnection = NULL;
+		int nConnection = -1;
+
+		// Check parameters
+		if (NULL == PpvSocket || NULL == PppvConnection)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvConnection = NULL;
+
+		do
+		{
+			nConnection = accept(((IfxPlatformSocket*)PpvSocket)->nSocket, NULL, NULL);
+		}
+		while (-1 == nConnection && EINTR == errno);
+		if (-1 == nConnection)
+			break;
+
+		pConnection = (IfxPlatformSocket*)Platform_MemoryAllocateZero(sizeof(IfxPlatformSocket));
+		if (NULL == pConnection)
+		{
+			IGNORE_RETURN_VALUE(close(nConnection));
+			break;
+		}
+		pConnection->nSocket = nConnection;
+
+		*PppvConnection = pConnection;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Checks whether a local socket or connection is ready to be read
+ *	@details	A listening socket is ready if a connection is pending, so Platform_LocalSocketAccept does not block. A
+ *				connection is ready if data has been received or the peer closed it.
+ *
+ *	@param		PpvSocket				Socket handle returned by Platform_LocalSocketListen or Platform_LocalSocketAccept
+ *	@param		PunTimeout				Time to wait in milliseconds, 0 to only check
+ *	@param		PpfReady				Receives TRUE if the socket is ready to be read
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketPoll(
+	_In_	void*			PpvSocket,
+	_In_	unsigned int	PunTimeout,
+	_Out_	BOOL*			PpfReady)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		struct pollfd sPoll;
+		int nResult = 0;
+
+		// Check parameters
+		if (NULL == PpvSocket || NULL == PpfReady)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpfReady = FALSE;
+
+		memset(&sPoll, 0, sizeof(sPoll));
+		sPoll.fd = ((IfxPlatformSocket*)PpvSocket)->nSocket;
+		sPoll.events = POLLIN;
+		do
+		{
+			nResult = poll(&sPoll, 1, PunTimeout > INT_MAX ? INT_MAX : (int)PunTimeout);
+		}
+		while (-1 == nResult && EINTR == errno);
+		if (-1 == nResult)
+			break;
+
+		*PpfReady = (0 < nResult && 0 != (sPoll.revents & (POLLIN | POLLHUP))) ? TRUE : FALSE;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Receives data from a local socket connection
+ *	@details	Waits until the requested number of bytes has been received.
+ *
+ *	@param		PpvConnection			Connection handle returned by Platform_LocalSocketAccept
+ *	@param		PrgbBuffer				Receives the data
+ *	@param		PunSize					Number of bytes to receive
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_END_OF_FILE		The peer closed the connection before all bytes have been received.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketReceive(
+	_In_						void*			PpvConnection,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbBuffer,
+	_In_						unsigned int	PunSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unReceived = 0;
+
+		// Check parameters
+		if (NULL == PpvConnection || NULL == PrgbBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+		while (unReceived < PunSize)
+		{
+			ssize_t sizeResult = recv(((IfxPlatformSocket*)PpvConnection)->nSocket, &PrgbBuffer[unReceived], PunSize - unReceived, 0);
+			if (-1 == sizeResult && EINTR == errno)
+				continue;
+			if (0 >= sizeResult)
+			{
+				unReturnValue = (0 == sizeResult) ? RC_E_END_OF_FILE : RC_E_FAIL;
+				break;
+			}
+			unReceived += (unsigned int)sizeResult;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Sends data over a local socket connection
+ *	@details	Waits until all bytes have been sent. A closed connection does not raise SIGPIPE.
+ *
+ *	@param		PpvConnection			Connection handle returned by Platform_LocalSocketAccept
+ *	@param		PrgbBuffer				Data to send
+ *	@param		PunSize					Number of bytes to send
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred or the peer closed the connection.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketSend(
+	_In_						void*			PpvConnection,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbBuffer,
+	_In_						unsigned int	PunSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unSent = 0;
+
+		// Check parameters
+		if (NULL == PpvConnection || NULL == PrgbBuffer)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+		while (unSent < PunSize)
+		{
+			ssize_t sizeResult = send(((IfxPlatformSocket*)PpvConnection)->nSocket, &PrgbBuffer[unSent], PunSize - unSent, MSG_NOSIGNAL);
+			if (-1 == sizeResult && EINTR == errno)
+				continue;
+			if (0 >= sizeResult)
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+			unSent += (unsigned int)sizeResult;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Closes a local socket or connection
+ *	@details	The socket file of a listening socket is removed.
+ *
+ *	@param		PppvSocket		Pointer to the socket or connection handle. Set to NULL on return.
+ */
+void
+Platform_LocalSocketClose(
+	_Inout_ void** PppvSocket)
+{
+	if (NULL != PppvSocket && NULL != *PppvSocket)
+	{
+		IfxPlatformSocket* pSocket = (IfxPlatformSocket*)*PppvSocket;
+		if (-1 != pSocket->nSocket)
+			IGNORE_RETURN_VALUE(close(pSocket->nSocket));
+		if ('\0' != pSocket->szPath[0])
+			IGNORE_RETURN_VALUE(unlink(pSocket->szPath));
+		Platform_MemoryFree(PppvSocket);
+	}
+}
+
+/// Path of the running executable, used to start worker processes
+#define PLATFORM_PROCESS_SELF	"/proc/self/exe"
+/// Maximum length of an output line read at once from a worker process (in bytes)
+#define PLATFORM_PROCESS_LINE_SIZE	8192
+
+/// Worker process handle used by the Platform_Process functions
+typedef struct tdIfxPlatformProcess
+{
+	/// Process ID of the worker
+	pid_t nProcessId;
+	/// Process ID of the process which started the worker, a forked worker inherits the handles of its siblings
+	pid_t nParentId;
+	/// Temporary file receiving the standard output and standard error of the worker
+	FILE* pOutput;
+	/// Flag if the worker exited
+	BOOL fExited;
+} IfxPlatformProcess;
+
+/**
+ *	@brief		Starts the running executable as worker process
+ *	@details	The worker runs with the given command line. Its standard output and standard error are written to an
+ *				anonymous temporary file which can be read with Platform_ProcessReadOutputLine once the worker exited.
+ *
+ *	@param		PunArgc					Number of command line arguments (including the program name)
+ *	@param		PrgwszArgv				Command line arguments
+ *	@param		PppvProcess				Receives the process handle, must be released with Platform_ProcessClose
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or an argument could not be converted.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The process could not be started.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessStart(
+	_In_						unsigned int			PunArgc,
+	_In_reads_z_(PunArgc)		const wchar_t* const	PrgwszArgv[],
+	_Outptr_result_maybenull_	void**					PppvProcess)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxPlatformProcess* pProcess = NULL;
+	char** rgszArgv = NULL;
+	unsigned int unIndex = 0;
+
+	do
+	{
+		// Check parameters
+		if (0 == PunArgc || NULL == PrgwszArgv || NULL == PppvProcess)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvProcess = NULL;
+
+		// Convert the arguments before forking, the worker must not allocate memory before exec
+		rgszArgv = (char**)Platform_MemoryAllocateZero((PunArgc + 1) * sizeof(char*));
+		if (NULL == rgszArgv)
+			break;
+		unReturnValue = RC_SUCCESS;
+		for (unIndex = 0; unIndex < PunArgc; unIndex++)
+		{
+			size_t sizeArgument = NULL == PrgwszArgv[unIndex] ? (size_t)-1 : wcstombs(NULL, PrgwszArgv[unIndex], 0);
+			if ((size_t)-1 == sizeArgument)
+			{
+				unReturnValue = RC_E_BAD_PARAMETER;
+				break;
+			}
+			rgszArgv[unIndex] = (char*)Platform_MemoryAllocateZero((unsigned int)sizeArgument + 1);
+			if (NULL == rgszArgv[unIndex])
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+			IGNORE_RETURN_VALUE(wcstombs(rgszArgv[unIndex], PrgwszArgv[unIndex], sizeArgument + 1));
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = RC_E_FAIL;
+
+		pProcess = (IfxPlatformProcess*)Platform_MemoryAllocateZero(sizeof(IfxPlatformProcess));
+		if (NULL == pProcess)
+			break;
+		pProcess->nParentId = getpid();
+		pProcess->pOutput = tmpfile();
+		if (NULL == pProcess->pOutput)
+			break;
+
+		// Do not let the worker inherit buffered output
+		IGNORE_RETURN_VALUE(fflush(stdout));
+		IGNORE_RETURN_VALUE(fflush(stderr));
+
+		pProcess->nProcessId = fork();
+		if (-1 == pProcess->nProcessId)
+			break;
+		if (0 == pProcess->nProcessId)
+		{
+			// Worker: redirect the output and run the executable, only async-signal-safe calls are allowed here
+			if (-1 == dup2(fileno(pProcess->pOutput), STDOUT_FILENO) || -1 == dup2(fileno(pProcess->pOutput), STDERR_FILENO))
+				_exit(127);
+			IGNORE_RETURN_VALUE(execv(PLATFORM_PROCESS_SELF, rgszArgv));
+			_exit(127);
+		}
+
+		*PppvProcess = pProcess;
+		pProcess = NULL;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != rgszArgv)
+	{
+		for (unIndex = 0; unIndex < PunArgc; unIndex++)
+			Platform_MemoryFree((void**)&rgszArgv[unIndex]);
+		Platform_MemoryFree((void**)&rgszArgv);
+	}
+	if (NULL != pProcess)
+	{
+		// The worker has not been started
+		pProcess->fExited = TRUE;
+		Platform_ProcessClose((void**)&pProcess);
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Forks the running process as worker process
+ *	@details	The worker continues after this call with a copy-on-write copy of the memory of the calling process, so all
+ *				settings and loaded data are shared without being loaded again. Its standard output and standard error are
+ *				written to an anonymous temporary file which can be read with Platform_ProcessReadOutputLine once the
+ *				worker exited. The calling process must not run other threads, they do not exist in the worker.
+ *
+ *	@param		PppvProcess				Receives the process handle in the calling process, must be released with
+ *										Platform_ProcessClose. Receives NULL in the worker.
+ *	@param		PpfWorker				Receives TRUE in the worker and FALSE in the calling process
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The process could not be forked.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessFork(
+	_Outptr_result_maybenull_	void**	PppvProcess,
+	_Out_						BOOL*	PpfWorker)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxPlatformProcess* pProcess = NULL;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PppvProcess || NULL == PpfWorker)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PppvProcess = NULL;
+		*PpfWorker = FALSE;
+
+		pProcess = (IfxPlatformProcess*)Platform_MemoryAllocateZero(sizeof(IfxPlatformProcess));
+		if (NULL == pProcess)
+			break;
+		pProcess->nParentId = getpid();
+		pProcess->pOutput = tmpfile();
+		if (NULL == pProcess->pOutput)
+			break;
+
+		// Do not let the worker inherit buffered output, neither of the console nor of open files
+		IGNORE_RETURN_VALUE(fflush(NULL));
+
+		pProcess->nProcessId = fork();
+		if (-1 == pProcess->nProcessId)
+			break;
+		if (0 == pProcess->nProcessId)
+		{
+			// Worker: redirect the output and continue, the handle belongs to the calling process
+			if (-1 == dup2(fileno(pProcess->pOutput), STDOUT_FILENO) || -1 == dup2(fileno(pProcess->pOutput), STDERR_FILENO))
+				_exit(127);
+			IGNORE_RETURN_VALUE(fclose(pProcess->pOutput));
+			Platform_MemoryFree((void**)&pProcess);
+			*PpfWorker = TRUE;
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		*PppvProcess = pProcess;
+		pProcess = NULL;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pProcess)
+	{
+		// The worker has not been forked
+		pProcess->fExited = TRUE;
+		Platform_ProcessClose((void**)&pProcess);
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Waits for one of the worker processes to exit
+ *	@details	NULL entries and processes which already exited are skipped.
+ *
+ *	@param		PrgpvProcesses			Process handles returned by Platform_ProcessStart
+ *	@param		PunCount				Number of entries in PrgpvProcesses
+ *	@param		PpunIndex				Receives the index of the exited process
+ *	@param		PpunExitCode			Receives the exit code of the process (0xFF if it was terminated by a signal)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or no process is running.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessWaitAny(
+	_In_reads_(PunCount)	void* const		PrgpvProcesses[],
+	_In_					unsigned int	PunCount,
+	_Out_					unsigned int*	PpunIndex,
+	_Out_					unsigned int*	PpunExitCode)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unIndex = 0;
+		BOOL fRunning = FALSE;
+
+		// Check parameters
+		if (NULL == PrgpvProcesses || NULL == PpunIndex || NULL == PpunExitCode)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		for (unIndex = 0; unIndex < PunCount; unIndex++)
+		{
+			if (NULL != PrgpvProcesses[unIndex] && !((IfxPlatformProcess*)PrgpvProcesses[unIndex])->fExited)
+				fRunning = TRUE;
+		}
+		if (!fRunning)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		while (RC_E_FAIL == unReturnValue)
+		{
+			int nStatus = 0;
+			pid_t nProcessId = waitpid(-1, &nStatus, 0);
+			if (-1 == nProcessId)
+			{
+				if (EINTR == errno)
+					continue;
+				break;
+			}
+
+			for (unIndex = 0; unIndex < PunCount; unIndex++)
+			{
+				IfxPlatformProcess* pProcess = (IfxPlatformProcess*)PrgpvProcesses[unIndex];
+				if (NULL == pProcess || pProcess->fExited || nProcessId != pProcess->nProcessId)
+					continue;
+
+				// Read the output from the beginning
+				pProcess->fExited = TRUE;
+				rewind(pProcess->pOutput);
+				*PpunIndex = unIndex;
+				*PpunExitCode = WIFEXITED(nStatus) ? (unsigned int)WEXITSTATUS(nStatus) : 0xFF;
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Reads the next line written by an exited worker process
+ *	@details	The line is returned without the line break. A line longer than the buffer is returned in several parts.
+ *
+ *	@param		PpvProcess				Process handle returned by Platform_ProcessStart
+ *	@param		PwszLine				Receives the line
+ *	@param		PpunLineSize			IN: Capacity of PwszLine in wide characters
+ *										OUT: Length of the line in wide characters
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or the process is still running.
+ *	@retval		RC_E_END_OF_FILE		All lines have been read.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessReadOutputLine(
+	_In_							void*			PpvProcess,
+	_Out_z_cap_(*PpunLineSize)		wchar_t*		PwszLine,
+	_Inout_							unsigned int*	PpunLineSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxPlatformProcess* pProcess = (IfxPlatformProcess*)PpvProcess;
+
+	do
+	{
+		char szLine[PLATFORM_PROCESS_LINE_SIZE] = {0};
+		size_t sizeLine = 0;
+		size_t sizeConverted = 0;
+
+		// Check parameters
+		if (NULL == pProcess || !pProcess->fExited || NULL == PwszLine || NULL == PpunLineSize || 0 == *PpunLineSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// A multibyte line never converts to more wide characters than it has bytes
+		if (NULL == fgets(szLine, (int)(*PpunLineSize < sizeof(szLine) ? *PpunLineSize : sizeof(szLine)), pProcess->pOutput))
+		{
+			unReturnValue = feof(pProcess->pOutput) ? RC_E_END_OF_FILE : RC_E_FAIL;
+			break;
+		}
+		sizeLine = strlen(szLine);
+		if (0 < sizeLine && '\n' == szLine[sizeLine - 1])
+			szLine[--sizeLine] = '\0';
+
+		sizeConverted = mbstowcs(PwszLine, szLine, *PpunLineSize);
+		if ((size_t)-1 == sizeConverted)
+		{
+			// Keep the bytes of an invalid multibyte sequence
+			for (sizeConverted = 0; sizeConverted <= sizeLine; sizeConverted++)
+				PwszLine[sizeConverted] = (wchar_t)(unsigned char)szLine[sizeConverted];
+			sizeConverted = sizeLine;
+		}
+		*PpunLineSize = (unsigned int)sizeConverted;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Releases a worker process handle
+ *	@details	A worker which is still running is terminated. The temporary output file is removed. A handle inherited by a
+ *				forked worker is only released, the sibling it refers to is left running.
+ *
+ *	@param		PppvProcess		Pointer to the process handle. Set to NULL on return.
+ */
+void
+Platform_ProcessClose(
+	_Inout_ void** PppvProcess)
+{
+	if (NULL != PppvProcess && NULL != *PppvProcess)
+	{
+		IfxPlatformProcess* pProcess = (IfxPlatformProcess*)*PppvProcess;
+		if (!pProcess->fExited && getpid() == pProcess->nParentId)
+		{
+			IGNORE_RETURN_VALUE(kill(pProcess->nProcessId, SIGKILL));
+			IGNORE_RETURN_VALUE(waitpid(pProcess->nProcessId, NULL, 0));
+		}
+		if (NULL != pProcess->pOutput)
+			IGNORE_RETURN_VALUE(fclose(pProcess->pOutput));
+		Platform_MemoryFree(PppvProcess);
+	}
 }
 
 /**
@@ -846,7 +2958,7 @@ unsigned short
 Platform_SwapBytes16(
 	_In_ unsigned short PusValue)
 {
-	return ((PusValue & 0xFF00) >> 8) + ((PusValue & 0x00FF) << 8);
+	return Platform_SwapBytes16Inline(PusValue);
 }
 
 /**
@@ -860,7 +2972,7 @@ unsigned int
 Platform_SwapBytes32(
 	_In_ unsigned int PunValue)
 {
-	return ((PunValue & 0xFF000000) >> 24) + ((PunValue & 0x00FF0000) >> 8) + ((PunValue & 0x0000FF00) << 8) + ((PunValue & 0x000000FF) << 24);
+	return Platform_SwapBytes32Inline(PunValue);
 }
 
 /**
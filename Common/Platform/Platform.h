@@ -61,18 +61,189 @@ typedef struct tdIfxTime
 	unsigned int unYear;
 } IfxTime;
 
+/// Maximum number of allocation call sites tracked separately, further call sites are counted together
+#define PLATFORM_MEMORY_CALL_SITE_COUNT 128
+
+/// Maximum time in microseconds a wait is busy-waited instead of sleeping
+#define PLATFORM_BUSY_WAIT_MAX_TIME 50
+
+/// Stack size of the threads started by Platform_ThreadCreate in bytes (the default of the C library reserves 8 MB)
+#define PLATFORM_THREAD_STACK_SIZE (256 * 1024)
+
+/// SCHED_FIFO priority set by Platform_RealtimeBegin, below the kernel interrupt threads (50)
+#define PLATFORM_REALTIME_PRIORITY 10
+/// Nice value set by Platform_RealtimeBegin if SCHED_FIFO is not permitted
+#define PLATFORM_REALTIME_NICE -20
+/// Platform_RealtimeBegin pinned the thread to a CPU
+#define PLATFORM_REALTIME_AFFINITY 0x1
+/// Platform_RealtimeBegin switched the thread to SCHED_FIFO
+#define PLATFORM_REALTIME_FIFO 0x2
+/// Platform_RealtimeBegin lowered the nice value of the thread
+#define PLATFORM_REALTIME_NICE_VALUE 0x4
+
+/// Nice value set by Platform_BackgroundBegin if SCHED_IDLE is not permitted
+#define PLATFORM_BACKGROUND_NICE 19
+/// Minimum sleep time in microseconds of the TPM wait loops in background mode
+#define PLATFORM_BACKGROUND_MIN_SLEEP 1000
+/// Timer slack in nanoseconds set by Platform_BackgroundBegin, lets the kernel coalesce the wake-ups with other timers
+#define PLATFORM_BACKGROUND_TIMER_SLACK 1000000
+/// Platform_BackgroundBegin switched the thread to SCHED_IDLE
+#define PLATFORM_BACKGROUND_IDLE 0x1
+/// Platform_BackgroundBegin raised the nice value of the thread
+#define PLATFORM_BACKGROUND_NICE_VALUE 0x2
+/// Platform_BackgroundBegin set the idle I/O scheduling class
+#define PLATFORM_BACKGROUND_IO_IDLE 0x4
+/// Platform_BackgroundBegin widened the timer slack
+#define PLATFORM_BACKGROUND_SLACK 0x8
+
+/// Allocation counters of the process
+typedef struct tdIfxMemoryStatistics
+{
+	/// Number of heap allocations
+	unsigned long long ullAllocations;
+	/// Number of heap deallocations
+	unsigned long long ullFrees;
+	/// Heap bytes currently allocated
+	unsigned long long ullLiveBytes;
+	/// Maximum of the heap bytes allocated at the same time
+	unsigned long long ullPeakBytes;
+	/// Number of scratch allocations served by a scratch arena instead of the heap
+	unsigned long long ullScratchAllocations;
+	/// Bytes served by scratch arenas
+	unsigned long long ullScratchBytes;
+} IfxMemoryStatistics;
+
+/// Allocation counters of one call site
+typedef struct tdIfxMemoryCallSite
+{
+	/// Source file of the call site (NULL for the call sites exceeding PLATFORM_MEMORY_CALL_SITE_COUNT)
+	const char* szFile;
+	/// Source line of the call site
+	unsigned int unLine;
+	/// Number of allocations
+	unsigned long long ullAllocations;
+	/// Total bytes allocated
+	unsigned long long ullBytes;
+	/// Number of allocations not freed yet
+	unsigned long long ullLiveAllocations;
+	/// Bytes not freed yet
+	unsigned long long ullLiveBytes;
+} IfxMemoryCallSite;
+
+/**
+ *	@brief		String builder composing a string in a caller provided buffer
+ *	@details	The builder keeps the length of the string, so appending does not scan the string composed so far. The
+ *				first failing append is kept in unReturnValue and all further appends fail with it, so a sequence of
+ *				appends needs only one error check at the end. A failing append leaves the string unchanged.
+ */
+typedef struct tdIfxStringBuilder
+{
+	/// Buffer receiving the zero terminated string
+	wchar_t* pwszBuffer;
+	/// Capacity of the buffer in elements including the zero termination
+	unsigned int unCapacity;
+	/// Length of the string in elements without the zero termination
+	unsigned int unLength;
+	/// RC_SUCCESS or the error of the first failing append
+	unsigned int unReturnValue;
+} IfxStringBuilder;
+
+/// Memory allocation initialized with zeros, accounted to the calling source line
+#define Platform_MemoryAllocateZero(PunSize) Platform_MemoryAllocateZeroAt(PunSize, FALSE, __FILE__, __LINE__)
+
+/// Scratch memory allocation initialized with zeros; served by the scratch arena of the thread if one is active
+#define Platform_MemoryAllocateScratch(PunSize) Platform_MemoryAllocateZeroAt(PunSize, TRUE, __FILE__, __LINE__)
+
 /**
  *	@brief		Memory allocation initialized with zeros
- *	@details	This function returns a pointer to a zero initialized memory
+ *	@details	This function returns a pointer to a zero initialized memory. The allocation is accounted to the given
+ *				call site. Use the Platform_MemoryAllocateZero and Platform_MemoryAllocateScratch macros instead of
+ *				calling this function directly. Scratch memory is served by the scratch arena of the calling thread if
+ *				Platform_MemoryScratchBegin was called, it stays valid until the matching Platform_MemoryScratchEnd.
+ *				Both kinds of memory are released with Platform_MemoryFree.
  *
  *	@param		PunSize		Memory allocation size in bytes
+ *	@param		PfScratch	TRUE for scratch memory which is not used after the current command
+ *	@param		PszFile		Source file of the call site
+ *	@param		PunLine		Source line of the call site
  *	@retval		!= NULL		Pointer to the zero initialized memory
  *	@retval		NULL		If the allocation fails
  */
 _Check_return_
 void*
-Platform_MemoryAllocateZero(
-	_In_ unsigned int PunSize);
+Platform_MemoryAllocateZeroAt(
+	_In_	unsigned int	PunSize,
+	_In_	BOOL			PfScratch,
+	_In_z_	const char*		PszFile,
+	_In_	unsigned int	PunLine);
+
+/**
+ *	@brief		Starts a scratch arena on the calling thread
+ *	@details	Scratch allocations of the thread are bump allocated from the arena until Platform_MemoryScratchEnd is
+ *				called. Calls can be nested, the arena is released by the outermost Platform_MemoryScratchEnd.
+ */
+void
+Platform_MemoryScratchBegin();
+
+/**
+ *	@brief		Ends a scratch arena on the calling thread
+ *	@details	Releases the arena memory of the thread when the outermost Platform_MemoryScratchBegin is ended. All scratch
+ *				memory allocated from the arena is invalid afterwards.
+ */
+void
+Platform_MemoryScratchEnd();
+
+/**
+ *	@brief		Gets the allocation counters of the process
+ *	@details
+ *
+ *	@param		PpStatistics	Receives the counters
+ */
+void
+Platform_MemoryGetStatistics(
+	_Out_ IfxMemoryStatistics* PpStatistics);
+
+/**
+ *	@brief		Gets the allocation counters of the call sites
+ *	@details
+ *
+ *	@param		PrgsCallSites		Receives the counters of the call sites
+ *	@param		PpunCallSiteCount	In: Capacity of PrgsCallSites in elements\n
+ *									Out: Number of call sites returned
+ */
+void
+Platform_MemoryGetCallSites(
+	_Out_cap_(*PpunCallSiteCount)	IfxMemoryCallSite*	PrgsCallSites,
+	_Inout_							unsigned int*		PpunCallSiteCount);
+
+/**
+ *	@brief		Locks a buffer into physical memory
+ *	@details	The pages of the buffer are faulted in and not paged out until Platform_MemoryUnlock is called. Fails if
+ *				the RLIMIT_MEMLOCK resource limit is exceeded.
+ *
+ *	@param		PpvBuffer			Buffer to lock
+ *	@param		PunSize				Size of the buffer in bytes
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			The buffer could not be locked.
+ */
+_Check_return_
+unsigned int
+Platform_MemoryLock(
+	_In_bytecount_(PunSize)	const void*		PpvBuffer,
+	_In_					unsigned int	PunSize);
+
+/**
+ *	@brief		Unlocks a buffer locked by Platform_MemoryLock
+ *
+ *	@param		PpvBuffer			Buffer to unlock
+ *	@param		PunSize				Size of the buffer in bytes
+ */
+void
+Platform_MemoryUnlock(
+	_In_bytecount_(PunSize)	const void*		PpvBuffer,
+	_In_					unsigned int	PunSize);
 
 /**
  *	@brief		Memory deallocation
@@ -141,6 +312,97 @@ Platform_MemoryCopy(
 	_In_reads_bytes_opt_(PunSize)			const void*		PpvSource,
 	_In_									unsigned int	PunSize);
 
+// GCC/Clang expand the memory and byte swap builtins in place
+#if defined(__GNUC__)
+#define PLATFORM_USE_BUILTINS
+#endif
+
+/**
+ *	@brief		Memory set without parameter checks
+ *	@details	Inline variant of Platform_MemorySet for hot paths (e.g. the MicroTss marshalers) which already
+ *				validated the destination. External callers keep using the checked Platform_MemorySet.
+ *
+ *	@param		PpvDestination		Pointer to the buffer, must not be NULL
+ *	@param		PnValue				Value to set
+ *	@param		PunSize				Size of the buffer in bytes
+ */
+static inline
+void
+Platform_MemorySetInline(
+	_Out_writes_bytes_all_(PunSize)	void*			PpvDestination,
+	_In_							int				PnValue,
+	_In_							unsigned int	PunSize)
+{
+#ifdef PLATFORM_USE_BUILTINS
+	__builtin_memset(PpvDestination, PnValue, PunSize);
+#else
+	unsigned int unIndex = 0;
+	for (unIndex = 0; unIndex < PunSize; unIndex++)
+		((unsigned char*)PpvDestination)[unIndex] = (unsigned char)PnValue;
+#endif
+}
+
+/**
+ *	@brief		Memory copy without parameter checks
+ *	@details	Inline variant of Platform_MemoryCopy for hot paths which already checked that the destination can hold
+ *				PunSize bytes. External callers keep using the checked Platform_MemoryCopy.
+ *
+ *	@param		PpvDestination		Pointer to the destination buffer, must hold at least PunSize bytes
+ *	@param		PpvSource			Pointer to the source buffer, must not overlap the destination
+ *	@param		PunSize				Size of the buffer in bytes
+ */
+static inline
+void
+Platform_MemoryCopyInline(
+	_Out_writes_bytes_all_(PunSize)	void*			PpvDestination,
+	_In_reads_bytes_(PunSize)		const void*		PpvSource,
+	_In_							unsigned int	PunSize)
+{
+#ifdef PLATFORM_USE_BUILTINS
+	__builtin_memcpy(PpvDestination, PpvSource, PunSize);
+#else
+	unsigned int unIndex = 0;
+	for (unIndex = 0; unIndex < PunSize; unIndex++)
+		((unsigned char*)PpvDestination)[unIndex] = ((const unsigned char*)PpvSource)[unIndex];
+#endif
+}
+
+/**
+ *	@brief		Swaps a UINT16 (inline variant of Platform_SwapBytes16)
+ *
+ *	@param		PusValue	Value to swap
+ *	@returns	Swapped UINT16 value
+ */
+static inline
+unsigned short
+Platform_SwapBytes16Inline(
+	_In_ unsigned short PusValue)
+{
+#ifdef PLATFORM_USE_BUILTINS
+	return __builtin_bswap16(PusValue);
+#else
+	return (unsigned short)(((PusValue & 0xFF00) >> 8) | ((PusValue & 0x00FF) << 8));
+#endif
+}
+
+/**
+ *	@brief		Swaps a UINT32 (inline variant of Platform_SwapBytes32)
+ *
+ *	@param		PunValue	Value to swap
+ *	@returns	Swapped UINT32 value
+ */
+static inline
+unsigned int
+Platform_SwapBytes32Inline(
+	_In_ unsigned int PunValue)
+{
+#ifdef PLATFORM_USE_BUILTINS
+	return __builtin_bswap32(PunValue);
+#else
+	return ((PunValue & 0xFF000000) >> 24) | ((PunValue & 0x00FF0000) >> 8) | ((PunValue & 0x0000FF00) << 8) | ((PunValue & 0x000000FF) << 24);
+#endif
+}
+
 /**
  *	@brief		Copy Unicode strings
  *	@details	This function copies the source Unicode string to the destination.
@@ -226,6 +488,146 @@ Platform_StringFormatV(
 	_In_z_									const wchar_t*	PwszSource,
 	_In_									va_list			PargList);
 
+/**
+ *	@brief		Widens the leading ASCII characters of a multibyte string
+ *	@details	Converts 16 characters per step with SSE2 where available. Stops at the first byte that is not ASCII.
+ *
+ *	@param		PszSource				Multibyte string, does not need to be zero terminated
+ *	@param		PunSourceSize			Size of the multibyte string in bytes
+ *	@param		PwszDestination			Buffer receiving the characters, NULL to count them only
+ *	@return		Number of converted characters
+ */
+unsigned int
+Platform_StringWidenAscii(
+	_In_reads_(PunSourceSize)			const char*		PszSource,
+	_In_								unsigned int	PunSourceSize,
+	_Out_cap_(PunSourceSize)			wchar_t*		PwszDestination);
+
+/**
+ *	@brief		Converts a multibyte string in the encoding of the locale to a Unicode string
+ *	@details	Runs of ASCII characters are converted with Platform_StringWidenAscii, other characters are decoded
+ *				directly in a UTF-8 locale and with mbrtowc in any other locale or for sequences the direct decoder does not
+ *				handle, so the result matches mbstowcs. The result is zero terminated. If the buffer is too small, it receives
+ *				the converted part.
+ *
+ *	@param		PszSource				Multibyte string, does not need to be zero terminated
+ *	@param		PunSourceSize			Size of the multibyte string in bytes
+ *	@param		PwszDestination			Buffer receiving the Unicode string, NULL to get the length only
+ *	@param		PpunLength				In: Capacity of the buffer in elements including the zero termination (ignored for NULL)
+ *										Out: Length of the converted string in elements without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The string does not fit into the buffer.
+ *	@retval		RC_E_FAIL				The string contains an invalid or incomplete multibyte sequence.
+ */
+_Check_return_
+unsigned int
+Platform_StringFromMultiByte(
+	_In_reads_(PunSourceSize)			const char*		PszSource,
+	_In_								unsigned int	PunSourceSize,
+	_Out_z_cap_(*PpunLength)			wchar_t*		PwszDestination,
+	_Inout_								unsigned int*	PpunLength);
+
+/**
+ *	@brief		Writes a Unicode string to a stdio stream
+ *	@details	The string is converted to the multibyte encoding of the locale (UTF-8) in chunks and written with fwrite,
+ *				so the stream stays byte oriented and each character is converted exactly once. Streams written with this
+ *				function must not be written with the wide character stdio functions. Runs of ASCII characters are
+ *				narrowed 16 per step with SSE2 where available, a UTF-8 locale is encoded directly.
+ *
+ *	@param		PpvStream				FILE pointer of the stream
+ *	@param		PwszString				String to write, does not need to be zero terminated
+ *	@param		PunLength				Length of the string in elements
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL				The string contains a character that cannot be converted, or writing failed.
+ */
+_Check_return_
+unsigned int
+Platform_StringWriteStream(
+	_In_							void*			PpvStream,
+	_In_reads_(PunLength)			const wchar_t*	PwszString,
+	_In_							unsigned int	PunLength);
+
+/**
+ *	@brief		Initializes a string builder with an empty string
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszBuffer				Buffer receiving the string
+ *	@param		PunCapacity				Capacity of the buffer in elements including the zero termination
+ */
+void
+Platform_StringBuilderInitialize(
+	_Out_							IfxStringBuilder*	PpsBuilder,
+	_Out_z_cap_(PunCapacity)		wchar_t*			PwszBuffer,
+	_In_							unsigned int		PunCapacity);
+
+/**
+ *	@brief		Appends a string to a string builder
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszString				String to append
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The string does not fit into the buffer.
+ *	@retval		...						Error of a previous append.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppend(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszString);
+
+/**
+ *	@brief		Appends a path to a string builder
+ *	@details	Inserts a '/' separator unless the string is empty or already ends with one, like
+ *				Platform_StringConcatenatePaths.
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszPath				Path to append
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from Platform_StringBuilderAppend.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppendPath(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszPath);
+
+/**
+ *	@brief		Appends a formatted string to a string builder
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszFormat				Format string
+ *	@param		...						Parameters needed to format the string
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from Platform_StringBuilderAppendFormatV.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppendFormat(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszFormat,
+	...);
+
+/**
+ *	@brief		Appends a formatted string to a string builder using a va_list
+ *
+ *	@param		PpsBuilder				String builder
+ *	@param		PwszFormat				Format string
+ *	@param		PargList				Parameters needed to format the string
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The formatted string does not fit into the buffer.
+ *	@retval		...						Error of a previous append.
+ */
+_Check_return_
+unsigned int
+Platform_StringBuilderAppendFormatV(
+	_Inout_		IfxStringBuilder*	PpsBuilder,
+	_In_z_		const wchar_t*		PwszFormat,
+	_In_		va_list				PargList);
+
 /**
  *	@brief		Get Unicode string length
  *	@details	This function returns the length of a Unicode string in elements without the terminating 0
@@ -307,6 +709,25 @@ Platform_AnsiString2UnicodeString(
 	_In_										unsigned int	PunDestinationCapacity,
 	_In_z_										const char*		PszSource);
 
+/**
+ *	@brief		Convert a Unicode string to an ANSI string
+ *	@details	The conversion uses the multibyte encoding of the current locale.
+ *
+ *	@param		PszDestination				Pointer to the destination ANSI string buffer
+ *	@param		PunDestinationCapacity		Size of the destination ANSI string buffer in bytes.
+ *	@param		PwszSource					Pointer to the Unicode string buffer
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_FAIL					An unexpected error occurred. The string cannot be represented in the current locale.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. One parameter is NULL.
+ *	@retval		RC_E_BUFFER_TOO_SMALL		Destination buffer is too small
+ */
+_Check_return_
+unsigned int
+Platform_UnicodeString2AnsiString(
+	_Out_writes_z_(PunDestinationCapacity)	char*			PszDestination,
+	_In_									unsigned int	PunDestinationCapacity,
+	_In_z_									const wchar_t*	PwszSource);
+
 /**
  *	@brief		Convert a string to integer
  *	@details	This function returns the int value produced by interpreting the input characters as a decimal number
@@ -346,6 +767,22 @@ wchar_t
 Platform_WCharToUpper(
 	_In_ wchar_t PwchToUpper);
 
+/**
+ *	@brief		Converts a wall clock time stamp to the local time
+ *	@details	Converts the given number of microseconds since 1970-01-01 00:00:00 UTC to the local date and time.
+ *
+ *	@param		PullTimeMicroSeconds	Wall clock time stamp in microseconds (see Platform_GetTimeMicroSeconds)
+ *	@param		PpTime					The local time with millisecond accuracy
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. Returned from the system call.
+ */
+_Check_return_
+unsigned int
+Platform_ConvertTime(
+	_In_	unsigned long long	PullTimeMicroSeconds,
+	_Inout_	IfxTime*			PpTime);
+
 /**
  *	@brief		Gets the current time
  *	@details	Retrieves the current local date and time. The accuracy is platform and OS dependent.
@@ -372,7 +809,8 @@ Platform_Sleep(
 
 /**
  *	@brief		Sleeps the given time in microseconds.
- *	@details
+ *	@details	The time is converted to a monotonic deadline and waited for with Platform_SleepUntil, so the sleep does
+ *				not drift on interruptions and short waits are busy-waited.
  *
  *	@param		PunSleepTime	Time to sleep in microseconds
  */
@@ -380,6 +818,362 @@ void
 Platform_SleepMicroSeconds(
 	_In_ unsigned int PunSleepTime);
 
+/**
+ *	@brief		Sleeps until a monotonic deadline
+ *	@details	The thread sleeps on the absolute deadline. The last part of the wait, which the system timer typically
+ *				oversleeps, is busy-waited: its length is calibrated on the first call and capped at
+ *				PLATFORM_BUSY_WAIT_MAX_TIME microseconds. Returns immediately if the deadline has passed.
+ *				In background mode (see Platform_BackgroundBegin) the whole wait is slept.
+ *
+ *	@param		PullDeadline	Monotonic time stamp in microseconds (see Platform_GetDeadline)
+ */
+void
+Platform_SleepUntil(
+	_In_ unsigned long long PullDeadline);
+
+/**
+ *	@brief		Returns the monotonic deadline the given time from now
+ *
+ *	@param		PunTimeout		Time from now in microseconds
+ *
+ *	@returns	Monotonic time stamp in microseconds
+ */
+unsigned long long
+Platform_GetDeadline(
+	_In_ unsigned int PunTimeout);
+
+/**
+ *	@brief		Returns the time remaining until a monotonic deadline
+ *
+ *	@param		PullDeadline	Monotonic time stamp in microseconds (see Platform_GetDeadline)
+ *
+ *	@returns	Remaining time in microseconds, 0 if the deadline has passed
+ */
+unsigned long long
+Platform_GetRemainingTime(
+	_In_ unsigned long long PullDeadline);
+
+/**
+ *	@brief		Raises the scheduling of the calling thread for a timing sensitive operation
+ *	@details	The thread is pinned to the given CPU and switched to SCHED_FIFO with PLATFORM_REALTIME_PRIORITY. If the
+ *				real-time policy is not permitted, the nice value is lowered to PLATFORM_REALTIME_NICE instead. Each
+ *				setting is applied on a best effort basis, *PpunApplied tells which ones took effect. The previous
+ *				settings are restored by Platform_RealtimeEnd.
+ *
+ *	@param		PnCpu				CPU to pin the thread to, -1 leaves the CPU affinity unchanged
+ *	@param		PppvState			Receives the saved settings to be passed to Platform_RealtimeEnd
+ *	@param		PpunApplied			Receives the flags of the applied settings (PLATFORM_REALTIME_*)
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			Memory allocation failed or the current settings could not be read.
+ */
+_Check_return_
+unsigned int
+Platform_RealtimeBegin(
+	_In_						int				PnCpu,
+	_Outptr_result_maybenull_	void**			PppvState,
+	_Out_						unsigned int*	PpunApplied);
+
+/**
+ *	@brief		Restores the scheduling settings saved by Platform_RealtimeBegin
+ *	@details	Must be called on the thread which called Platform_RealtimeBegin.
+ *
+ *	@param		PppvState			Pointer to the saved settings. Set to NULL on return.
+ */
+void
+Platform_RealtimeEnd(
+	_Inout_ void** PppvState);
+
+/**
+ *	@brief		Lowers the scheduling of the calling thread to run with little impact on other workloads
+ *	@details	The thread is switched to SCHED_IDLE (or the nice value is raised to PLATFORM_BACKGROUND_NICE if that is not
+ *				permitted), gets the idle I/O scheduling class and a timer slack of PLATFORM_BACKGROUND_TIMER_SLACK.
+ *				Threads created afterwards inherit these settings, so it should be called before any thread is started.
+ *				From then on Platform_SleepUntil does not busy-wait and Platform_IsBackground returns TRUE. Each setting
+ *				is applied on a best effort basis, *PpunApplied tells which ones took effect. The settings are kept.
+ *
+ *	@param		PpunApplied			Receives the flags of the applied settings (PLATFORM_BACKGROUND_*)
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+Platform_BackgroundBegin(
+	_Out_	unsigned int*	PpunApplied);
+
+/**
+ *	@brief		Checks if the process runs in background mode
+ *	@details	Wait loops use longer sleeps of at least PLATFORM_BACKGROUND_MIN_SLEEP microseconds in background mode.
+ *
+ *	@retval		TRUE		Platform_BackgroundBegin has been called.
+ *	@retval		FALSE		The process runs with the normal scheduling.
+ */
+BOOL
+Platform_IsBackground();
+
+/**
+ *	@brief		Returns the wall clock time in microseconds
+ *	@details	The time stamp is the number of microseconds since 1970-01-01 00:00:00 UTC.
+ *
+ *	@returns	Wall clock time stamp in microseconds, 0 in case the clock is not available
+ */
+unsigned long long
+Platform_GetTimeMicroSeconds();
+
+/**
+ *	@brief		Returns a monotonic time stamp in microseconds
+ *	@details	The time stamp is not related to the wall clock time and is only meaningful to measure elapsed time.
+ *
+ *	@returns	Monotonic time stamp in microseconds, 0 in case the clock is not available
+ */
+unsigned long long
+Platform_GetMonotonicTimeMicroSeconds();
+
+/**
+ *	@brief		Returns the CPU time consumed by the calling thread in microseconds
+ *	@details	Only the time the thread was running on a CPU is counted, time spent sleeping or blocked in a system
+ *				call is not. Work of other threads (e.g. the asynchronous log writer) is not included.
+ *
+ *	@returns	CPU time of the calling thread in microseconds, 0 in case the clock is not available
+ */
+unsigned long long
+Platform_GetThreadCpuTimeMicroSeconds();
+
+/**
+ *	@brief		Starts a thread
+ *	@details	The thread executes the given function with the given context. The thread must be released by Platform_ThreadJoin.
+ *				The thread gets a stack of PLATFORM_THREAD_STACK_SIZE bytes.
+ *
+ *	@param		PfnThreadFunction		Function executed by the thread
+ *	@param		PpvContext				Context passed to the thread function (optional, can be NULL)
+ *	@param		PppvThreadHandle		Pointer to store the thread handle to
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The thread could not be started.
+ */
+_Check_return_
+unsigned int
+Platform_ThreadCreate(
+	_In_		void			(*PfnThreadFunction)(void*),
+	_In_opt_	void*			PpvContext,
+	_Outptr_result_maybenull_	void**	PppvThreadHandle);
+
+/**
+ *	@brief		Waits for a thread to finish
+ *	@details	Waits until the thread function returned and releases the thread handle.
+ *
+ *	@param		PppvThreadHandle		Pointer to the thread handle. Set to NULL on return.
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_ThreadJoin(
+	_Inout_ void** PppvThreadHandle);
+
+/**
+ *	@brief		Registers a handler for abnormal process termination
+ *	@details	The handler is called once when the process is terminated by a signal (e.g. crash or interrupt).
+ *				Afterwards the default signal action terminates the process. The handler must be async-signal-safe.
+ *
+ *	@param		PfnTerminationHandler	Handler to call
+ */
+void
+Platform_RegisterTerminationHandler(
+	_In_ void (*PfnTerminationHandler)(void));
+
+/**
+ *	@brief		Creates a listening local socket
+ *	@details	Binds a stream socket in the local (Unix domain) namespace to the given path. An existing socket file at the
+ *				path is replaced. The socket file is only accessible by the owner of the process.
+ *
+ *	@param		PwszPath				Path of the socket file
+ *	@param		PppvSocket				Receives the socket handle, must be closed with Platform_LocalSocketClose
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or the path is too long.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The socket could not be created.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketListen(
+	_In_z_						const wchar_t*	PwszPath,
+	_Outptr_result_maybenull_	void**			PppvSocket);
+
+/**
+ *	@brief		Waits for a connection on a listening local socket
+ *	@details
+ *
+ *	@param		PpvSocket				Socket handle returned by Platform_LocalSocketListen
+ *	@param		PppvConnection			Receives the connection handle, must be closed with Platform_LocalSocketClose
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketAccept(
+	_In_						void*	PpvSocket,
+	_Outptr_result_maybenull_	void**	PppvConnection);
+
+/**
+ *	@brief		Checks whether a local socket or connection is ready to be read
+ *	@details	A listening socket is ready if a connection is pending, so Platform_LocalSocketAccept does not block. A
+ *				connection is ready if data has been received or the peer closed it.
+ *
+ *	@param		PpvSocket				Socket handle returned by Platform_LocalSocketListen or Platform_LocalSocketAccept
+ *	@param		PunTimeout				Time to wait in milliseconds, 0 to only check
+ *	@param		PpfReady				Receives TRUE if the socket is ready to be read
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketPoll(
+	_In_	void*			PpvSocket,
+	_In_	unsigned int	PunTimeout,
+	_Out_	BOOL*			PpfReady);
+
+/**
+ *	@brief		Receives data from a local socket connection
+ *	@details	Waits until the requested number of bytes has been received.
+ *
+ *	@param		PpvConnection			Connection handle returned by Platform_LocalSocketAccept
+ *	@param		PrgbBuffer				Receives the data
+ *	@param		PunSize					Number of bytes to receive
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_END_OF_FILE		The peer closed the connection before all bytes have been received.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketReceive(
+	_In_						void*			PpvConnection,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbBuffer,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Sends data over a local socket connection
+ *	@details	Waits until all bytes have been sent. A closed connection does not raise SIGPIPE.
+ *
+ *	@param		PpvConnection			Connection handle returned by Platform_LocalSocketAccept
+ *	@param		PrgbBuffer				Data to send
+ *	@param		PunSize					Number of bytes to send
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred or the peer closed the connection.
+ */
+_Check_return_
+unsigned int
+Platform_LocalSocketSend(
+	_In_						void*			PpvConnection,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbBuffer,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Closes a local socket or connection
+ *	@details	The socket file of a listening socket is removed.
+ *
+ *	@param		PppvSocket		Pointer to the socket or connection handle. Set to NULL on return.
+ */
+void
+Platform_LocalSocketClose(
+	_Inout_ void** PppvSocket);
+
+/**
+ *	@brief		Starts the running executable as worker process
+ *	@details	The worker runs with the given command line. Its standard output and standard error are written to an
+ *				anonymous temporary file which can be read with Platform_ProcessReadOutputLine once the worker exited.
+ *
+ *	@param		PunArgc					Number of command line arguments (including the program name)
+ *	@param		PrgwszArgv				Command line arguments
+ *	@param		PppvProcess				Receives the process handle, must be released with Platform_ProcessClose
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or an argument could not be converted.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The process could not be started.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessStart(
+	_In_						unsigned int			PunArgc,
+	_In_reads_z_(PunArgc)		const wchar_t* const	PrgwszArgv[],
+	_Outptr_result_maybenull_	void**					PppvProcess);
+
+/**
+ *	@brief		Forks the running process as worker process
+ *	@details	The worker continues after this call with a copy-on-write copy of the memory of the calling process, so all
+ *				settings and loaded data are shared without being loaded again. Its standard output and standard error are
+ *				written to an anonymous temporary file which can be read with Platform_ProcessReadOutputLine once the
+ *				worker exited. The calling process must not run other threads, they do not exist in the worker.
+ *
+ *	@param		PppvProcess				Receives the process handle in the calling process, must be released with
+ *										Platform_ProcessClose. Receives NULL in the worker.
+ *	@param		PpfWorker				Receives TRUE in the worker and FALSE in the calling process
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL.
+ *	@retval		RC_E_FAIL				An unexpected error occurred. The process could not be forked.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessFork(
+	_Outptr_result_maybenull_	void**	PppvProcess,
+	_Out_						BOOL*	PpfWorker);
+
+/**
+ *	@brief		Waits for one of the worker processes to exit
+ *	@details	NULL entries and processes which already exited are skipped.
+ *
+ *	@param		PrgpvProcesses			Process handles returned by Platform_ProcessStart
+ *	@param		PunCount				Number of entries in PrgpvProcesses
+ *	@param		PpunIndex				Receives the index of the exited process
+ *	@param		PpunExitCode			Receives the exit code of the process (0xFF if it was terminated by a signal)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or no process is running.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessWaitAny(
+	_In_reads_(PunCount)	void* const		PrgpvProcesses[],
+	_In_					unsigned int	PunCount,
+	_Out_					unsigned int*	PpunIndex,
+	_Out_					unsigned int*	PpunExitCode);
+
+/**
+ *	@brief		Reads the next line written by an exited worker process
+ *	@details	The line is returned without the line break. A line longer than the buffer is returned in several parts.
+ *
+ *	@param		PpvProcess				Process handle returned by Platform_ProcessStart
+ *	@param		PwszLine				Receives the line
+ *	@param		PpunLineSize			IN: Capacity of PwszLine in wide characters
+ *										OUT: Length of the line in wide characters
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was NULL or the process is still running.
+ *	@retval		RC_E_END_OF_FILE		All lines have been read.
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Platform_ProcessReadOutputLine(
+	_In_							void*			PpvProcess,
+	_Out_z_cap_(*PpunLineSize)		wchar_t*		PwszLine,
+	_Inout_							unsigned int*	PpunLineSize);
+
+/**
+ *	@brief		Releases a worker process handle
+ *	@details	A worker which is still running is terminated. The temporary output file is removed. A handle inherited by a
+ *				forked worker is only released, the sibling it refers to is left running.
+ *
+ *	@param		PppvProcess		Pointer to the process handle. Set to NULL on return.
+ */
+void
+Platform_ProcessClose(
+	_Inout_ void** PppvProcess);
+
 /**
  *	@brief		Swaps a UINT16
  *	@details
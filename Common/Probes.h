@@ -0,0 +1,59 @@
+﻿/**
+ *	@brief		Declares the USDT probes
+ *	@details	Statically defined user space probes (sys/sdt.h of SystemTap) on the hot paths. A probe is a single nop
+ *				instruction plus a note in the ELF file, the arguments are only evaluated into registers. Tools like
+ *				bpftrace, perf or SystemTap attach to the probes of a running release binary.
+ *
+ *				Probes of the provider "tpmfactoryupd" (arguments in order):
+ *				- transmit__entry (ordinal, request size), transmit__return (ordinal, return code, response size)
+ *				- batch__entry (ordinal, request count), batch__return (ordinal, return code, executed requests)
+ *				- update__block__start (block number, block count, block size), update__block__done (block number, return code)
+ *				- tis__send__entry (segment count), tis__send__return (return code)
+ *				- tis__wait__entry (maximum duration), tis__wait__return (return code, wait loop iterations)
+ *				- tis__read__entry (buffer size), tis__read__return (return code, response size)
+ *				- tis__sleep (sleep time in microseconds), fired by every sleeping TIS wait loop iteration
+ *				- log__write__entry (message level, data size), log__write__return (return code)
+ *				- tpmio__connect (access mode, return code), tpmio__disconnect (return code)
+ *	@file		Probes.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+// The probes are compiled in if sys/sdt.h is available (package systemtap-sdt-dev or systemtap-sdt-devel),
+// "make CPPFLAGS=-DIFX_ENABLE_USDT=0" leaves them out.
+#ifndef IFX_ENABLE_USDT
+#if defined(LINUX) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define IFX_ENABLE_USDT	1
+#endif
+#endif
+#endif
+#ifndef IFX_ENABLE_USDT
+#define IFX_ENABLE_USDT	0
+#endif
+
+#if IFX_ENABLE_USDT
+#include <sys/sdt.h>
+
+/// Fires the probe NAME of the provider tpmfactoryupd
+#define PROBE(NAME)							DTRACE_PROBE(tpmfactoryupd, NAME)
+/// Fires the probe NAME with one argument
+#define PROBE1(NAME, ARG1)					DTRACE_PROBE1(tpmfactoryupd, NAME, ARG1)
+/// Fires the probe NAME with two arguments
+#define PROBE2(NAME, ARG1, ARG2)			DTRACE_PROBE2(tpmfactoryupd, NAME, ARG1, ARG2)
+/// Fires the probe NAME with three arguments
+#define PROBE3(NAME, ARG1, ARG2, ARG3)		DTRACE_PROBE3(tpmfactoryupd, NAME, ARG1, ARG2, ARG3)
+#else
+#define PROBE(NAME)
+#define PROBE1(NAME, ARG1)
+#define PROBE2(NAME, ARG1, ARG2)
+#define PROBE3(NAME, ARG1, ARG2, ARG3)
+#endif
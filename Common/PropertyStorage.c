@@ -16,180 +16,926 @@
 
 #include "PropertyStorage.h"
 #include "Utility.h"
+#include "Logging.h"
+#include "Session.h"
 
-/// Pointer to the first element in the list
-IfxPropertyElement* s_pvHead = NULL;
+/// Keys of the built-in properties indexed by their identifier
+const wchar_t* const s_rgwszPropertyIdKeys[PROPERTY_ID_COUNT] =
+{
+	[PROPERTY_ID_TPM_DEVICE_ACCESS_MODE] = PROPERTY_TPM_DEVICE_ACCESS_MODE,
+	[PROPERTY_ID_TPM_DEVICE_ACCESS_PATH] = PROPERTY_TPM_DEVICE_ACCESS_PATH,
+	[PROPERTY_ID_LOCALITY] = PROPERTY_LOCALITY,
+	[PROPERTY_ID_CALL_SHUTDOWN_ON_EXIT] = PROPERTY_CALL_SHUTDOWN_ON_EXIT,
+	[PROPERTY_ID_STATISTICS] = PROPERTY_STATISTICS,
+	[PROPERTY_ID_TPM_CAPTURE_PATH] = PROPERTY_TPM_CAPTURE_PATH,
+	[PROPERTY_ID_TPM_TROUBLESHOOTING_FRAMES] = PROPERTY_TPM_TROUBLESHOOTING_FRAMES,
+	[PROPERTY_ID_TPM_TROUBLESHOOTING] = PROPERTY_TPM_TROUBLESHOOTING,
+	[PROPERTY_ID_TPM_REPLAY_TIMING_SCALE] = PROPERTY_TPM_REPLAY_TIMING_SCALE,
+	[PROPERTY_ID_TPM_SOCKET_POWER_ON] = PROPERTY_TPM_SOCKET_POWER_ON,
+	[PROPERTY_ID_TPM_DEVICE_LOCK_TIMEOUT] = PROPERTY_TPM_DEVICE_LOCK_TIMEOUT,
+	[PROPERTY_ID_LOGGING_LEVEL] = PROPERTY_LOGGING_LEVEL,
+	[PROPERTY_ID_LOGGING_PATH] = PROPERTY_LOGGING_PATH,
+	[PROPERTY_ID_LOGGING_MAXSIZE] = PROPERTY_LOGGING_MAXSIZE,
+	[PROPERTY_ID_LOGGING_FLUSH_INTERVAL] = PROPERTY_LOGGING_FLUSH_INTERVAL,
+	[PROPERTY_ID_LOGGING_MAX_FILES] = PROPERTY_LOGGING_MAX_FILES,
+	[PROPERTY_ID_LOGGING_COMPRESS] = PROPERTY_LOGGING_COMPRESS,
+	[PROPERTY_ID_LOGGING_ASYNC] = PROPERTY_LOGGING_ASYNC,
+	[PROPERTY_ID_LOGGING_JSON] = PROPERTY_LOGGING_JSON,
+	[PROPERTY_ID_LOGGING_MODULE_LEVELS] = PROPERTY_LOGGING_MODULE_LEVELS,
+	[PROPERTY_ID_CONSOLE_MODE] = PROPERTY_CONSOLE_MODE
+};
+
+/// Offset of the data of an arena block
+#define PROPERTY_STORAGE_ARENA_DATA_OFFSET	((sizeof(IfxPropertyArenaBlock) + PROPERTY_STORAGE_ARENA_ALIGNMENT - 1) & ~(PROPERTY_STORAGE_ARENA_ALIGNMENT - 1))
+
+/**
+ *	@brief		Allocates memory from the property arena
+ *	@details	Local helper method. The memory is zero initialized, aligned to PROPERTY_STORAGE_ARENA_ALIGNMENT and
+ *				released by PropertyStorage_ClearElements only. Requests larger than PROPERTY_STORAGE_ARENA_BLOCK_SIZE
+ *				get a block of their own.
+ *
+ *	@param		PunSize			Size of the memory in bytes
+ *
+ *	@returns	Pointer to the memory, NULL in case of a memory allocation failure
+ */
+_Check_return_
+void*
+PropertyStorage_ArenaAllocate(
+	_In_ unsigned int PunSize)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	void* pvMemory = NULL;
+	unsigned int unSize = (PunSize + PROPERTY_STORAGE_ARENA_ALIGNMENT - 1) & ~(PROPERTY_STORAGE_ARENA_ALIGNMENT - 1);
+
+	do
+	{
+		// Start a new block if the current one is exhausted
+		if (NULL == pSession->pPropertyArena || pSession->pPropertyArena->unSize - pSession->pPropertyArena->unUsed < unSize)
+		{
+			unsigned int unBlockSize = unSize > PROPERTY_STORAGE_ARENA_BLOCK_SIZE ? unSize : PROPERTY_STORAGE_ARENA_BLOCK_SIZE;
+			IfxPropertyArenaBlock* pBlock = (IfxPropertyArenaBlock*)Platform_MemoryAllocateZero(PROPERTY_STORAGE_ARENA_DATA_OFFSET + unBlockSize);
+			if (NULL == pBlock)
+				break;
 
-/// Pointer to the last element in the list
-IfxPropertyElement* s_pvTail = NULL;
+			pBlock->pvPreviousBlock = pSession->pPropertyArena;
+			pBlock->unSize = unBlockSize;
+			pSession->pPropertyArena = pBlock;
+		}
+
+		pvMemory = (BYTE*)pSession->pPropertyArena + PROPERTY_STORAGE_ARENA_DATA_OFFSET + pSession->pPropertyArena->unUsed;
+		pSession->pPropertyArena->unUsed += unSize;
+	}
+	WHILE_FALSE_END;
+
+	return pvMemory;
+}
 
 /**
- *	@brief		Add a key value pair to the PropertyStorage
- *	@details	Operation fails in case an element with same key already exists.
+ *	@brief		Sets the string value of an element
+ *	@details	Local helper method. The value buffer is reused if it is large enough, otherwise a new one is taken from
+ *				the arena. All typed value representations become invalid.
  *
- *	@param		PwszKey			Unique key identifier for the PropertyElement to be added\n
- *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_KEY
- *	@param		PwszValue		Pointer to a wide char array containing the value\n
- *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_VALUE
+ *	@param		PpElement		Element to set the value of
+ *	@param		PwszValue		Null-terminated wide char array; max length PROPERTY_STORAGE_MAX_VALUE
  *
- *	@retval		TRUE		If the element has been added
- *	@retval		FALSE		If the element could not be added, e.g. because element with same key already exists
+ *	@retval		TRUE		If the value has been set
+ *	@retval		FALSE		If the value is too long or the memory allocation failed
  */
 _Check_return_
 BOOL
-PropertyStorage_AddKeyValuePair(
+PropertyStorage_SetStringValue(
+	_Inout_	IfxPropertyElement*	PpElement,
+	_In_z_	const wchar_t*		PwszValue)
+{
+	BOOL fReturnValue = FALSE;
+
+	do
+	{
+		unsigned int unLength = 0;
+
+		if (RC_SUCCESS != Platform_StringGetLength(PwszValue, PROPERTY_STORAGE_MAX_VALUE, &unLength))
+			break;
+
+		if (PpElement->unValueCapacity < unLength + 1)
+		{
+			wchar_t* wszValue = (wchar_t*)PropertyStorage_ArenaAllocate((unLength + 1) * sizeof(wchar_t));
+			if (NULL == wszValue)
+				break;
+			PpElement->wszValue = wszValue;
+			PpElement->unValueCapacity = unLength + 1;
+		}
+
+		unLength = PpElement->unValueCapacity;
+		if (RC_SUCCESS != Platform_StringCopy(PpElement->wszValue, &unLength, PwszValue))
+			break;
+
+		PpElement->unValidFlags = PROPERTY_VALUE_STRING;
+		PpElement->unConvertedFlags = PROPERTY_VALUE_STRING;
+		fReturnValue = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Calculates the hash of a key
+ *	@details	Local helper method using FNV-1a over the wide characters of the key.
+ *
+ *	@param		PwszKey			Key identifier; null-terminated wide char array
+ *
+ *	@returns	The hash of the key
+ */
+_Check_return_
+unsigned int
+PropertyStorage_HashKey(
+	_In_z_ const wchar_t* PwszKey)
+{
+	unsigned int unHash = 2166136261U;
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < PROPERTY_STORAGE_MAX_KEY && L'\0' != PwszKey[unIndex]; unIndex++)
+	{
+		unHash ^= (unsigned int)PwszKey[unIndex];
+		unHash *= 16777619U;
+	}
+
+	return unHash;
+}
+
+/**
+ *	@brief		Finds the slot of a key in the hash table
+ *	@details	Local helper method. Probes linearly from the home slot of the hash until the key or a free
+ *				slot is found.
+ *
+ *	@param		PwszKey			Key identifier; null-terminated wide char array
+ *	@param		PunHash			Hash of the key calculated by PropertyStorage_HashKey
+ *
+ *	@returns	Index of the slot holding the key or of the free slot where it would be added,
+ *				the number of slots in case the hash table has not been allocated yet
+ */
+_Check_return_
+unsigned int
+PropertyStorage_FindSlot(
 	_In_z_	const wchar_t*	PwszKey,
-	_In_z_	const wchar_t*	PwszValue)
+	_In_	unsigned int	PunHash)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unSlot = 0;
+
+	if (0 == pSession->unPropertySlotCount)
+		return pSession->unPropertySlotCount;
+
+	// The load factor is kept below one half, so a free slot always exists
+	for (unSlot = PunHash & (pSession->unPropertySlotCount - 1); NULL != pSession->pPropertySlots[unSlot].pElement; unSlot = (unSlot + 1) & (pSession->unPropertySlotCount - 1))
+	{
+		if (PunHash == pSession->pPropertySlots[unSlot].unHash &&
+				0 == Platform_StringCompare(PwszKey, pSession->pPropertySlots[unSlot].pElement->wszKey, PROPERTY_STORAGE_MAX_KEY, FALSE))
+			break;
+	}
+
+	return unSlot;
+}
+
+/**
+ *	@brief		Grows the hash table
+ *	@details	Local helper method doubling the number of slots (at least PROPERTY_STORAGE_MIN_SLOTS) and
+ *				rehashing all stored elements with their stored hashes.
+ *
+ *	@retval		TRUE		If the hash table has been grown
+ *	@retval		FALSE		If the memory allocation failed
+ */
+_Check_return_
+BOOL
+PropertyStorage_GrowTable()
 {
+	IfxSession* pSession = Session_GetCurrent();
 	BOOL fReturnValue = FALSE;
+
+	do
+	{
+		unsigned int unSlotCount = 0 == pSession->unPropertySlotCount ? PROPERTY_STORAGE_MIN_SLOTS : pSession->unPropertySlotCount * 2;
+		IfxPropertySlot* pSlots = (IfxPropertySlot*)Platform_MemoryAllocateZero(unSlotCount * sizeof(IfxPropertySlot));
+		unsigned int unIndex = 0;
+
+		if (NULL == pSlots)
+			break;
+
+		// Move stored elements to their slots in the new table
+		for (unIndex = 0; unIndex < pSession->unPropertySlotCount; unIndex++)
+		{
+			unsigned int unSlot = 0;
+
+			if (NULL == pSession->pPropertySlots[unIndex].pElement)
+				continue;
+			for (unSlot = pSession->pPropertySlots[unIndex].unHash & (unSlotCount - 1); NULL != pSlots[unSlot].pElement; unSlot = (unSlot + 1) & (unSlotCount - 1));
+			pSlots[unSlot] = pSession->pPropertySlots[unIndex];
+		}
+
+		Platform_MemoryFree((void**)&pSession->pPropertySlots);
+		pSession->pPropertySlots = pSlots;
+		pSession->unPropertySlotCount = unSlotCount;
+		fReturnValue = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Get an element identified by a key
+ *	@details	Local helper method to get the element with the given key.
+ *
+ *	@param		PwszKey			Key identifier for the PropertyElement to be changed\n
+ *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_KEY
+ *
+ *	@returns	The element if found, NULL otherwise
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_GetElementByKey(
+	_In_z_ const wchar_t* PwszKey)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	IfxPropertyElement* pReturnElement = NULL;
+
+	// Check parameter
+	if (NULL != PwszKey)
+	{
+		// Search the hash table for the element
+		unsigned int unSlot = PropertyStorage_FindSlot(PwszKey, PropertyStorage_HashKey(PwszKey));
+		if (unSlot < pSession->unPropertySlotCount)
+			pReturnElement = pSession->pPropertySlots[unSlot].pElement;
+	}
+
+	return pReturnElement;
+}
+
+/**
+ *	@brief		Finds the slot of a key in a frozen table
+ *	@details	Local helper method. Same probing as PropertyStorage_FindSlot, the frozen table is never changed.
+ *
+ *	@param		PpFrozen		Frozen table to search
+ *	@param		PwszKey			Key identifier; null-terminated wide char array
+ *
+ *	@returns	The element if found, NULL otherwise
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_FindFrozenElement(
+	_In_	const IfxPropertyFrozenTable*	PpFrozen,
+	_In_z_	const wchar_t*					PwszKey)
+{
+	unsigned int unHash = PropertyStorage_HashKey(PwszKey);
+	unsigned int unSlot = 0;
+
+	for (unSlot = unHash & (PpFrozen->unSlotCount - 1); NULL != PpFrozen->pSlots[unSlot].pElement; unSlot = (unSlot + 1) & (PpFrozen->unSlotCount - 1))
+	{
+		if (unHash == PpFrozen->pSlots[unSlot].unHash &&
+				0 == Platform_StringCompare(PwszKey, PpFrozen->pSlots[unSlot].pElement->wszKey, PROPERTY_STORAGE_MAX_KEY, FALSE))
+			return PpFrozen->pSlots[unSlot].pElement;
+	}
+
+	return NULL;
+}
+
+/**
+ *	@brief		Starts a read access to the PropertyStorage
+ *	@details	Local helper method. Registers the reader before the frozen table is loaded, so a table replaced in the
+ *				meantime is not released before PropertyStorage_ReadEnd. Must be paired with PropertyStorage_ReadEnd.
+ *
+ *	@param		PpSession		Session of the PropertyStorage
+ *
+ *	@returns	The published frozen table, NULL if the PropertyStorage has not been frozen
+ */
+_Check_return_
+const IfxPropertyFrozenTable*
+PropertyStorage_ReadBegin(
+	_Inout_ IfxSession* PpSession)
+{
+	__atomic_add_fetch(&PpSession->unPropertyReaders, 1, __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&PpSession->pPropertyFrozen, __ATOMIC_SEQ_CST);
+}
+
+/**
+ *	@brief		Ends a read access started by PropertyStorage_ReadBegin
+ *	@details	Local helper method. Elements of the frozen table must not be used afterwards.
+ *
+ *	@param		PpSession		Session of the PropertyStorage
+ */
+void
+PropertyStorage_ReadEnd(
+	_Inout_ IfxSession* PpSession)
+{
+	__atomic_sub_fetch(&PpSession->unPropertyReaders, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ *	@brief		Get an element identified by a key for reading
+ *	@details	Local helper method. Reads from the frozen table if the PropertyStorage has been frozen.
+ *
+ *	@param		PpFrozen		Frozen table returned by PropertyStorage_ReadBegin (NULL if not frozen)
+ *	@param		PwszKey			Key identifier; null-terminated wide char array
+ *
+ *	@returns	The element if found, NULL otherwise
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_ReadElementByKey(
+	_In_opt_	const IfxPropertyFrozenTable*	PpFrozen,
+	_In_z_		const wchar_t*					PwszKey)
+{
+	if (NULL == PwszKey)
+		return NULL;
+	if (NULL != PpFrozen)
+		return PropertyStorage_FindFrozenElement(PpFrozen, PwszKey);
+
+	return PropertyStorage_GetElementByKey(PwszKey);
+}
+
+/**
+ *	@brief		Get a built-in element identified by its identifier for reading
+ *	@details	Local helper method. Reads from the frozen table if the PropertyStorage has been frozen.
+ *
+ *	@param		PpSession		Session of the PropertyStorage
+ *	@param		PpFrozen		Frozen table returned by PropertyStorage_ReadBegin (NULL if not frozen)
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *
+ *	@returns	The element if set, NULL otherwise
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_ReadElementById(
+	_In_		IfxSession*						PpSession,
+	_In_opt_	const IfxPropertyFrozenTable*	PpFrozen,
+	_In_		ENUM_PROPERTY_IDS				PunPropertyId)
+{
+	if (PunPropertyId >= PROPERTY_ID_COUNT)
+		return NULL;
+	if (NULL != PpFrozen)
+		return PpFrozen->rgpIdElements[PunPropertyId];
+
+	return PpSession->rgpPropertyIdElements[PunPropertyId];
+}
+
+/**
+ *	@brief		Adds a new element to the hash table
+ *	@details	Local helper method. The value of the new element must be set by the caller.
+ *
+ *	@param		PwszKey			Unique key identifier for the PropertyElement to be added\n
+ *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_KEY
+ *
+ *	@returns	The added element, NULL if the element could not be added, e.g. because element with same key already exists
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_InsertElement(
+	_In_z_ const wchar_t* PwszKey)
+{
+	IfxSession* pSession = Session_GetCurrent();
 	IfxPropertyElement* pElement = NULL;
+	BOOL fReturnValue = FALSE;
 
 	do
 	{
 		unsigned int unLength = 0;
+		unsigned int unHash = 0;
+		unsigned int unSlot = 0;
 
-		// Check parameters
-		if (NULL == PwszKey ||
-				NULL == PwszValue)
+		// Check length of key
+		if (RC_E_BUFFER_TOO_SMALL == Platform_StringGetLength(PwszKey, PROPERTY_STORAGE_MAX_KEY, &unLength))
 			break;
 
-		// Check length of key and value
-		if (RC_E_BUFFER_TOO_SMALL == Platform_StringGetLength(PwszKey, PROPERTY_STORAGE_MAX_KEY, &unLength) ||
-				RC_E_BUFFER_TOO_SMALL == Platform_StringGetLength(PwszValue, PROPERTY_STORAGE_MAX_VALUE, &unLength))
+		// Keep the load factor of the hash table below one half
+		if (2 * (pSession->unPropertyElementCount + 1) > pSession->unPropertySlotCount && !PropertyStorage_GrowTable())
 			break;
 
 		// Abort if element with same key already exists
-		if (PropertyStorage_ExistsElement(PwszKey))
+		unHash = PropertyStorage_HashKey(PwszKey);
+		unSlot = PropertyStorage_FindSlot(PwszKey, unHash);
+		if (NULL != pSession->pPropertySlots[unSlot].pElement)
 			break;
 
-		// Allocate memory for one property element
-		pElement = (IfxPropertyElement*)Platform_MemoryAllocateZero(sizeof(IfxPropertyElement));
+		// Allocate memory for one property element and its key from the arena
+		pElement = (IfxPropertyElement*)PropertyStorage_ArenaAllocate(sizeof(IfxPropertyElement));
 		if (NULL == pElement)
 			break;
+		pElement->wszKey = (wchar_t*)PropertyStorage_ArenaAllocate((unLength + 1) * sizeof(wchar_t));
+		if (NULL == pElement->wszKey)
+			break;
 
 		// Copy key to element
-		unLength = PROPERTY_STORAGE_MAX_KEY;
+		unLength++;
 		if (RC_SUCCESS != Platform_StringCopy(pElement->wszKey, &unLength, PwszKey))
 			break;
 
-		// Copy value to element
-		unLength = PROPERTY_STORAGE_MAX_VALUE;
-		if (RC_SUCCESS != Platform_StringCopy(pElement->wszValue, &unLength, PwszValue))
+		// Bind a built-in property to its identifier slot
+		for (pElement->unPropertyId = 0; pElement->unPropertyId < PROPERTY_ID_COUNT; pElement->unPropertyId++)
+		{
+			if (0 == Platform_StringCompare(pElement->wszKey, s_rgwszPropertyIdKeys[pElement->unPropertyId], PROPERTY_STORAGE_MAX_KEY, FALSE))
+				break;
+		}
+
+		// Add it to the free slot
+		pSession->pPropertySlots[unSlot].unHash = unHash;
+		pSession->pPropertySlots[unSlot].pElement = pElement;
+		pSession->unPropertyElementCount++;
+		if (pElement->unPropertyId < PROPERTY_ID_COUNT)
+			pSession->rgpPropertyIdElements[pElement->unPropertyId] = pElement;
+		fReturnValue = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	// The arena memory of a failed element is released with the arena
+	if (!fReturnValue)
+		pElement = NULL;
+
+	return pElement;
+}
+
+/**
+ *	@brief		Sets a typed value of an element
+ *	@details	Local helper method. All other value representations become invalid.
+ *
+ *	@param		PpElement		Element to set the value of
+ *	@param		PunType			PROPERTY_VALUE_BOOLEAN, PROPERTY_VALUE_UINTEGER or PROPERTY_VALUE_ULONGLONG
+ *	@param		PullValue		Value to set (converted to the type)
+ */
+void
+PropertyStorage_SetTypedValue(
+	_Inout_	IfxPropertyElement*	PpElement,
+	_In_	unsigned int		PunType,
+	_In_	unsigned long long	PullValue)
+{
+	if (PROPERTY_VALUE_BOOLEAN == PunType)
+		PpElement->fValue = 0 != PullValue ? TRUE : FALSE;
+	else if (PROPERTY_VALUE_UINTEGER == PunType)
+		PpElement->unValue = (unsigned int)PullValue;
+	else
+		PpElement->ullValue = PullValue;
+
+	PpElement->unValidFlags = PunType;
+	PpElement->unConvertedFlags = PunType;
+}
+
+/**
+ *	@brief		Returns the string value of an element
+ *	@details	Local helper method. A typed value is converted to the string value on first request.
+ *
+ *	@param		PpElement		Element to get the string value of
+ *
+ *	@returns	The zero terminated string value, NULL if the typed value could not be converted
+ */
+_Check_return_
+const wchar_t*
+PropertyStorage_GetElementString(
+	_Inout_ IfxPropertyElement* PpElement)
+{
+	if (0 == (PpElement->unValidFlags & PROPERTY_VALUE_STRING))
+	{
+		unsigned int unValueSize = 0;
+		unsigned int unReturnValue = RC_E_FAIL;
+
+		// Take a value buffer from the arena which fits every typed value
+		if (PpElement->unValueCapacity < PROPERTY_STORAGE_TYPED_VALUE_SIZE)
+		{
+			wchar_t* wszValue = (wchar_t*)PropertyStorage_ArenaAllocate(PROPERTY_STORAGE_TYPED_VALUE_SIZE * sizeof(wchar_t));
+			if (NULL == wszValue)
+				return NULL;
+			PpElement->wszValue = wszValue;
+			PpElement->unValueCapacity = PROPERTY_STORAGE_TYPED_VALUE_SIZE;
+		}
+		unValueSize = PpElement->unValueCapacity;
+
+		if (0 != (PpElement->unValidFlags & PROPERTY_VALUE_BOOLEAN))
+			unReturnValue = Platform_StringCopy(PpElement->wszValue, &unValueSize, PpElement->fValue ? L"TRUE" : L"FALSE");
+		else if (0 != (PpElement->unValidFlags & PROPERTY_VALUE_UINTEGER))
+			unReturnValue = Utility_UInteger2String(PpElement->unValue, PpElement->wszValue, &unValueSize);
+		else if (0 != (PpElement->unValidFlags & PROPERTY_VALUE_ULONGLONG))
+			unReturnValue = Utility_ULongLong2String(PpElement->ullValue, PpElement->wszValue, &unValueSize);
+		if (RC_SUCCESS != unReturnValue)
+			return NULL;
+
+		PpElement->unValidFlags |= PROPERTY_VALUE_STRING;
+		PpElement->unConvertedFlags |= PROPERTY_VALUE_STRING;
+	}
+
+	return PpElement->wszValue;
+}
+
+/**
+ *	@brief		Get an element with a valid typed value
+ *	@details	Local helper method. Converts the string value to the requested type on first request and keeps
+ *				the result, a failed conversion is kept as well.
+ *
+ *	@param		PpElement		Element to get the typed value of (NULL if the property is not set)
+ *	@param		PunType			PROPERTY_VALUE_BOOLEAN, PROPERTY_VALUE_UINTEGER or PROPERTY_VALUE_ULONGLONG
+ *
+ *	@returns	The element if the value has the requested type, NULL otherwise
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_GetTypedElement(
+	_Inout_opt_	IfxPropertyElement*	PpElement,
+	_In_		unsigned int		PunType)
+{
+	IfxPropertyElement* pElement = PpElement;
+
+	do
+	{
+		const wchar_t* pwszValue = NULL;
+		unsigned int unValueSize = 0;
+
+		if (NULL == pElement ||
+				0 != (pElement->unValidFlags & PunType))
 			break;
 
-		// If list is empty, add it to the list
-		if (NULL == s_pvHead)
+		// Conversion failed before
+		if (0 != (pElement->unConvertedFlags & PunType))
 		{
-			s_pvHead = pElement;
-			s_pvTail = pElement;
+			pElement = NULL;
+			break;
+		}
+
+		pElement->unConvertedFlags |= PunType;
+		pwszValue = PropertyStorage_GetElementString(pElement);
+		if (NULL == pwszValue || RC_SUCCESS != Platform_StringGetLength(pwszValue, pElement->unValueCapacity, &unValueSize))
+		{
+			pElement = NULL;
+			break;
+		}
+
+		// Size including the zero termination
+		unValueSize++;
+
+		// Convert value to the requested type, if possible
+		if (PROPERTY_VALUE_BOOLEAN == PunType)
+		{
+			if (0 == Platform_StringCompare(L"TRUE", pwszValue, unValueSize, TRUE))
+			{
+				pElement->fValue = TRUE;
+				pElement->unValidFlags |= PunType;
+			}
+			else if (0 == Platform_StringCompare(L"FALSE", pwszValue, unValueSize, TRUE))
+			{
+				pElement->fValue = FALSE;
+				pElement->unValidFlags |= PunType;
+			}
+		}
+		else if (PROPERTY_VALUE_UINTEGER == PunType)
+		{
+			int nIndex = -1;
+			if (RC_SUCCESS == Utility_StringContainsWChar(pwszValue, unValueSize, L'x', &nIndex))
+			{
+				// Convert as decimal or as hex value
+				if ((-1 == nIndex && RC_SUCCESS == Utility_StringParseUInteger(pwszValue, unValueSize, &pElement->unValue)) ||
+						(-1 != nIndex && RC_SUCCESS == Utility_UIntegerParseHexString(pwszValue, &pElement->unValue)))
+					pElement->unValidFlags |= PunType;
+			}
 		}
 		else
 		{
-			// Update link of the last element in the list
-			s_pvTail->pvNextElement = pElement;
+			if (RC_SUCCESS == Utility_StringParseULongLong(pwszValue, unValueSize, &pElement->ullValue))
+				pElement->unValidFlags |= PunType;
+		}
 
-			// Update links in the element to add
-			pElement->pvPreviousElement = s_pvTail;
+		if (0 == (pElement->unValidFlags & PunType))
+			pElement = NULL;
+	}
+	WHILE_FALSE_END;
+
+	return pElement;
+}
+
+/**
+ *	@brief		Get an element with a valid typed value for reading
+ *	@details	Local helper method. Same as PropertyStorage_GetTypedElement, but a frozen element is never changed. Its
+ *				conversion is done on a copy and not kept.
+ *
+ *	@param		PpFrozen		Frozen table returned by PropertyStorage_ReadBegin (NULL if not frozen)
+ *	@param		PpElement		Element to get the typed value of (NULL if the property is not set)
+ *	@param		PunType			PROPERTY_VALUE_BOOLEAN, PROPERTY_VALUE_UINTEGER or PROPERTY_VALUE_ULONGLONG
+ *	@param		PpCopy			Receives the copy of a frozen element to convert
+ *
+ *	@returns	The element or its copy if the value has the requested type, NULL otherwise
+ */
+_Check_return_
+IfxPropertyElement*
+PropertyStorage_ReadTypedElement(
+	_In_opt_	const IfxPropertyFrozenTable*	PpFrozen,
+	_In_opt_	IfxPropertyElement*				PpElement,
+	_In_		unsigned int					PunType,
+	_Out_		IfxPropertyElement*				PpCopy)
+{
+	if (NULL != PpFrozen && NULL != PpElement && 0 == (PpElement->unConvertedFlags & PunType))
+	{
+		*PpCopy = *PpElement;
+		PpElement = PpCopy;
+	}
+
+	return PropertyStorage_GetTypedElement(PpElement, PunType);
+}
+
+/**
+ *	@brief		Copies the string value of an element
+ *	@details	Local helper method. The out parameters are reset if the value could not be copied.
+ *
+ *	@param		PpElement		Element to get the value of (NULL if the property is not set)
+ *	@param		PwszValue		Pointer to a wide char array receiving the value
+ *	@param		PpunValueSize	Size of the PwszValue buffer in elements including the zero termination
+ *
+ *	@retval		TRUE		If the value has been copied
+ *	@retval		FALSE		If the value could not be copied
+ */
+_Check_return_
+BOOL
+PropertyStorage_CopyElementValue(
+	_Inout_opt_					IfxPropertyElement*	PpElement,
+	_Out_z_cap_(*PpunValueSize)	wchar_t*			PwszValue,
+	_Inout_						unsigned int*		PpunValueSize)
+{
+	BOOL fReturnValue = FALSE;
+
+	// Get value, a typed value is converted to a string on first request
+	if (NULL != PpElement &&
+			NULL != PwszValue &&
+			NULL != PpunValueSize &&
+			0 != *PpunValueSize &&
+			NULL != PropertyStorage_GetElementString(PpElement) &&
+			RC_SUCCESS == Platform_StringCopy(PwszValue, PpunValueSize, PpElement->wszValue))
+		fReturnValue = TRUE;
 
-			// Update last list element link
-			s_pvTail = pElement;
+	if (FALSE == fReturnValue)
+	{
+		// Reset out parameters
+		if (NULL != PwszValue && NULL != PpunValueSize && 0 != *PpunValueSize)
+			PwszValue[0] = L'\0';
+		if (NULL != PpunValueSize)
+			*PpunValueSize = 0;
+	}
+
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Releases the retired frozen tables
+ *	@details	Local helper method. Must only be called if no reader can still use a retired table.
+ *
+ *	@param		PpSession		Session of the PropertyStorage
+ */
+void
+PropertyStorage_ReleaseRetiredTables(
+	_Inout_ IfxSession* PpSession)
+{
+	while (NULL != PpSession->pPropertyRetired)
+	{
+		IfxPropertyFrozenTable* pRetired = PpSession->pPropertyRetired;
+		PpSession->pPropertyRetired = pRetired->pRetiredNext;
+		Platform_MemoryFree((void**)&pRetired);
+	}
+}
+
+/**
+ *	@brief		Builds a frozen table from the hash table and publishes it
+ *	@details	Local helper method. The string representation of all elements is converted before copying, so reading
+ *				a frozen element never changes it. Slots, elements, keys and values are copied into one contiguous block.
+ *				The replaced frozen table is retired and released as soon as no reader is registered.
+ *
+ *	@retval		TRUE		If the frozen table has been published
+ *	@retval		FALSE		If a value could not be converted to a string or the memory allocation failed
+ */
+_Check_return_
+BOOL
+PropertyStorage_PublishFrozenTable()
+{
+	IfxSession* pSession = Session_GetCurrent();
+	BOOL fReturnValue = FALSE;
+
+	do
+	{
+		IfxPropertyFrozenTable* pFrozen = NULL;
+		IfxPropertyFrozenTable* pRetired = NULL;
+		IfxPropertyElement* pElements = NULL;
+		wchar_t* pwchStrings = NULL;
+		unsigned int unSlotCount = 0 == pSession->unPropertySlotCount ? 1 : pSession->unPropertySlotCount;
+		unsigned int unHeaderSize = (sizeof(IfxPropertyFrozenTable) + PROPERTY_STORAGE_ARENA_ALIGNMENT - 1) & ~(PROPERTY_STORAGE_ARENA_ALIGNMENT - 1);
+		unsigned int unStringSize = 0;
+		unsigned int unElementCount = 0;
+		unsigned int unSlot = 0;
+		BOOL fConverted = TRUE;
+
+		// Convert typed values to strings in advance and sum up the key and value lengths
+		for (unSlot = 0; unSlot < pSession->unPropertySlotCount; unSlot++)
+		{
+			IfxPropertyElement* pElement = pSession->pPropertySlots[unSlot].pElement;
+			unsigned int unKeyLength = 0, unValueLength = 0;
+
+			if (NULL == pElement)
+				continue;
+			if (NULL == PropertyStorage_GetElementString(pElement))
+			{
+				fConverted = FALSE;
+				break;
+			}
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszKey, PROPERTY_STORAGE_MAX_KEY, &unKeyLength));
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszValue, pElement->unValueCapacity, &unValueLength));
+			unStringSize += unKeyLength + 1 + unValueLength + 1;
 		}
+		if (!fConverted)
+			break;
 
+		pFrozen = (IfxPropertyFrozenTable*)Platform_MemoryAllocateZero(
+			unHeaderSize + unSlotCount * sizeof(IfxPropertySlot) + pSession->unPropertyElementCount * sizeof(IfxPropertyElement) + unStringSize * sizeof(wchar_t));
+		if (NULL == pFrozen)
+			break;
+		pFrozen->pSlots = (IfxPropertySlot*)((BYTE*)pFrozen + unHeaderSize);
+		pFrozen->unSlotCount = unSlotCount;
+		pElements = (IfxPropertyElement*)(pFrozen->pSlots + unSlotCount);
+		pwchStrings = (wchar_t*)(pElements + pSession->unPropertyElementCount);
+
+		// Copy the elements to the same slots, so the probe sequences stay valid
+		for (unSlot = 0; unSlot < pSession->unPropertySlotCount; unSlot++)
+		{
+			const IfxPropertyElement* pElement = pSession->pPropertySlots[unSlot].pElement;
+			IfxPropertyElement* pCopy = &pElements[unElementCount];
+			unsigned int unKeySize = 0, unValueSize = 0;
+
+			if (NULL == pElement)
+				continue;
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszKey, PROPERTY_STORAGE_MAX_KEY, &unKeySize));
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszValue, pElement->unValueCapacity, &unValueSize));
+			*pCopy = *pElement;
+			pCopy->wszKey = pwchStrings;
+			pwchStrings += ++unKeySize;
+			IGNORE_RETURN_VALUE(Platform_StringCopy(pCopy->wszKey, &unKeySize, pElement->wszKey));
+			pCopy->wszValue = pwchStrings;
+			pCopy->unValueCapacity = ++unValueSize;
+			pwchStrings += unValueSize;
+			IGNORE_RETURN_VALUE(Platform_StringCopy(pCopy->wszValue, &unValueSize, pElement->wszValue));
+
+			pFrozen->pSlots[unSlot].unHash = pSession->pPropertySlots[unSlot].unHash;
+			pFrozen->pSlots[unSlot].pElement = pCopy;
+			if (pCopy->unPropertyId < PROPERTY_ID_COUNT)
+				pFrozen->rgpIdElements[pCopy->unPropertyId] = pCopy;
+			unElementCount++;
+		}
+
+		// Swap the table for the readers and retire the replaced one
+		pRetired = __atomic_exchange_n(&pSession->pPropertyFrozen, pFrozen, __ATOMIC_SEQ_CST);
+		if (NULL != pRetired)
+		{
+			pRetired->pRetiredNext = pSession->pPropertyRetired;
+			pSession->pPropertyRetired = pRetired;
+		}
+
+		// A reader registering from now on loads the new table, so the retired ones are unused without readers
+		if (0 == __atomic_load_n(&pSession->unPropertyReaders, __ATOMIC_SEQ_CST))
+			PropertyStorage_ReleaseRetiredTables(pSession);
 		fReturnValue = TRUE;
 	}
 	WHILE_FALSE_END;
 
-	// Cleanup in case of error
-	if (!fReturnValue)
-		Platform_MemoryFree((void**)&pElement);
-
 	return fReturnValue;
 }
 
 /**
- *	@brief		Add a key and a boolean value pair to the PropertyStorage
- *	@details
+ *	@brief		Notifies dependent modules of a changed element
+ *	@details	Local helper method publishing the change to the readers of a frozen PropertyStorage and keeping the
+ *				cached logging levels up to date.
+ *
+ *	@param		PwszKey			Key identifier of the added, changed or removed PropertyElement
+ */
+void
+PropertyStorage_OnElementChanged(
+	_In_z_ const wchar_t* PwszKey)
+{
+	// Copy-on-write: readers keep the previous frozen table until the new one is published. If it cannot be built,
+	// the readers keep reading the previous values, the hash table must not be exposed to them.
+	if (NULL != Session_GetCurrent()->pPropertyFrozen && !PropertyStorage_PublishFrozenTable())
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"The change of property '%ls' could not be published to the frozen property storage.", PwszKey);
+	}
+
+	if (0 == Platform_StringCompare(PwszKey, PROPERTY_LOGGING_LEVEL, PROPERTY_STORAGE_MAX_KEY, FALSE) ||
+			0 == Platform_StringCompare(PwszKey, PROPERTY_LOGGING_MODULE_LEVELS, PROPERTY_STORAGE_MAX_KEY, FALSE))
+		Logging_UpdateLevel();
+}
+
+/**
+ *	@brief		Add a key value pair to the PropertyStorage
+ *	@details	Operation fails in case an element with same key already exists.
  *
  *	@param		PwszKey			Unique key identifier for the PropertyElement to be added\n
  *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_KEY
- *	@param		PfValue			Boolean value to add
+ *	@param		PwszValue		Pointer to a wide char array containing the value\n
+ *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_VALUE
  *
  *	@retval		TRUE		If the element has been added
  *	@retval		FALSE		If the element could not be added, e.g. because element with same key already exists
  */
 _Check_return_
 BOOL
-PropertyStorage_AddKeyBooleanValuePair(
+PropertyStorage_AddKeyValuePair(
 	_In_z_	const wchar_t*	PwszKey,
-	_In_	BOOL			PfValue)
+	_In_z_	const wchar_t*	PwszValue)
 {
-	return PropertyStorage_AddKeyValuePair(PwszKey, PfValue ? L"TRUE" : L"FALSE");
+	BOOL fReturnValue = FALSE;
+
+	do
+	{
+		IfxPropertyElement* pElement = NULL;
+		unsigned int unLength = 0;
+
+		// Check parameters
+		if (NULL == PwszKey ||
+				NULL == PwszValue)
+			break;
+
+		// Check length of value
+		if (RC_E_BUFFER_TOO_SMALL == Platform_StringGetLength(PwszValue, PROPERTY_STORAGE_MAX_VALUE, &unLength))
+			break;
+
+		pElement = PropertyStorage_InsertElement(PwszKey);
+		if (NULL == pElement)
+			break;
+
+		// Copy value to element, on failure the element is removed again
+		if (!PropertyStorage_SetStringValue(pElement, PwszValue))
+		{
+			IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PwszKey));
+			break;
+		}
+
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return fReturnValue;
 }
 
 /**
- *	@brief		Add a key and a unsigned int value pair to the PropertyStorage
+ *	@brief		Add a key and a boolean value pair to the PropertyStorage
  *	@details
  *
  *	@param		PwszKey			Unique key identifier for the PropertyElement to be added\n
  *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_KEY
- *	@param		PunValue		Unsigned integer value to add
+ *	@param		PfValue			Boolean value to add
  *
  *	@retval		TRUE		If the element has been added
  *	@retval		FALSE		If the element could not be added, e.g. because element with same key already exists
  */
 _Check_return_
 BOOL
-PropertyStorage_AddKeyUIntegerValuePair(
-	_In_z_	const wchar_t*		PwszKey,
-	_In_	unsigned int		PunValue)
+PropertyStorage_AddKeyBooleanValuePair(
+	_In_z_	const wchar_t*	PwszKey,
+	_In_	BOOL			PfValue)
 {
 	BOOL fReturnValue = FALSE;
-	wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-	unsigned int unValueSize = RG_LEN(wszValue);
+	IfxPropertyElement* pElement = NULL;
 
-	if (RC_SUCCESS == Utility_UInteger2String(PunValue, wszValue, &unValueSize))
-		fReturnValue = PropertyStorage_AddKeyValuePair(PwszKey, wszValue);
+	if (NULL != PwszKey)
+		pElement = PropertyStorage_InsertElement(PwszKey);
+	if (NULL != pElement)
+	{
+		PropertyStorage_SetTypedValue(pElement, PROPERTY_VALUE_BOOLEAN, PfValue ? 1 : 0);
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
+	}
 
 	return fReturnValue;
 }
 
 /**
- *	@brief		Get an element identified by a key
- *	@details	Local helper method to get the element with the given key.
+ *	@brief		Add a key and a unsigned int value pair to the PropertyStorage
+ *	@details
  *
- *	@param		PwszKey			Key identifier for the PropertyElement to be changed\n
+ *	@param		PwszKey			Unique key identifier for the PropertyElement to be added\n
  *								null-terminated wide char array; max length PROPERTY_STORAGE_MAX_KEY
+ *	@param		PunValue		Unsigned integer value to add
  *
- *	@returns	The element if found, NULL otherwise
+ *	@retval		TRUE		If the element has been added
+ *	@retval		FALSE		If the element could not be added, e.g. because element with same key already exists
  */
 _Check_return_
-IfxPropertyElement*
-PropertyStorage_GetElementByKey(
-	_In_z_ const wchar_t* PwszKey)
+BOOL
+PropertyStorage_AddKeyUIntegerValuePair(
+	_In_z_	const wchar_t*		PwszKey,
+	_In_	unsigned int		PunValue)
 {
-	IfxPropertyElement* pReturnElement = NULL;
+	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
 
-	// Check parameter
 	if (NULL != PwszKey)
+		pElement = PropertyStorage_InsertElement(PwszKey);
+	if (NULL != pElement)
 	{
-		// Search list for element
-		IfxPropertyElement* pIteratorElement = s_pvHead;
-		while (NULL != pIteratorElement)
-		{
-			// Check if current element contains the given key
-			if (0 == Platform_StringCompare(PwszKey, pIteratorElement->wszKey, PROPERTY_STORAGE_MAX_KEY, FALSE))
-			{
-				// If yes, return it
-				pReturnElement = pIteratorElement;
-				break;
-			}
-
-			// Update iterator
-			pIteratorElement = pIteratorElement->pvNextElement;
-		}
+		PropertyStorage_SetTypedValue(pElement, PROPERTY_VALUE_UINTEGER, PunValue);
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
 	}
 
-	return pReturnElement;
+	return fReturnValue;
 }
 
 /**
@@ -227,10 +973,10 @@ PropertyStorage_ChangeValueByKey(
 			break;
 
 		// Change value
+		if (PropertyStorage_SetStringValue(pElement, PwszValue))
 		{
-			unsigned int unValueSize = PROPERTY_STORAGE_MAX_VALUE;
-			if (RC_SUCCESS == Platform_StringCopy(pElement->wszValue, &unValueSize, PwszValue))
-				fReturnValue = TRUE;
+			PropertyStorage_OnElementChanged(PwszKey);
+			fReturnValue = TRUE;
 		}
 	}
 	WHILE_FALSE_END;
@@ -255,7 +1001,19 @@ PropertyStorage_ChangeBooleanValueByKey(
 	_In_z_	const wchar_t*	PwszKey,
 	_In_	BOOL			PfValue)
 {
-	return PropertyStorage_ChangeValueByKey(PwszKey, PfValue ? L"TRUE" : L"FALSE");
+	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
+
+	if (NULL != PwszKey)
+		pElement = PropertyStorage_GetElementByKey(PwszKey);
+	if (NULL != pElement)
+	{
+		PropertyStorage_SetTypedValue(pElement, PROPERTY_VALUE_BOOLEAN, PfValue ? 1 : 0);
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
+	}
+
+	return fReturnValue;
 }
 
 /**
@@ -276,11 +1034,16 @@ PropertyStorage_ChangeUIntegerValueByKey(
 	_In_	unsigned int		PunValue)
 {
 	BOOL fReturnValue = FALSE;
-	wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-	unsigned int unValueSize = RG_LEN(wszValue);
+	IfxPropertyElement* pElement = NULL;
 
-	if (RC_SUCCESS == Utility_UInteger2String(PunValue, wszValue, &unValueSize))
-		fReturnValue = PropertyStorage_ChangeValueByKey(PwszKey, wszValue);
+	if (NULL != PwszKey)
+		pElement = PropertyStorage_GetElementByKey(PwszKey);
+	if (NULL != pElement)
+	{
+		PropertyStorage_SetTypedValue(pElement, PROPERTY_VALUE_UINTEGER, PunValue);
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
+	}
 
 	return fReturnValue;
 }
@@ -305,39 +1068,14 @@ PropertyStorage_GetValueByKey(
 	_Out_z_cap_(*PpunValueSize)	wchar_t*		PwszValue,
 	_Inout_						unsigned int*	PpunValueSize)
 {
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
 	BOOL fReturnValue = FALSE;
 
-	do
-	{
-		IfxPropertyElement* pElement = NULL;
-
-		// Check parameters
-		if (NULL == PwszKey ||
-				NULL == PwszValue ||
-				NULL == PpunValueSize ||
-				0 == *PpunValueSize)
-			break;
-
-		// Get element to be read from, if existing
-		pElement = PropertyStorage_GetElementByKey(PwszKey);
-		if (NULL == pElement)
-			break;
-
-		// Get value
-		if (RC_SUCCESS == Platform_StringCopy(PwszValue, PpunValueSize, pElement->wszValue))
-			fReturnValue = TRUE;
-	}
-	WHILE_FALSE_END;
-
-	if (FALSE == fReturnValue)
-	{
-		// Reset out parameters
-		if (NULL != PwszValue)
-			PwszValue[0] = L'\0';
-		if (NULL != PpunValueSize)
-			*PpunValueSize = 0;
-	}
+	// Get element to be read from, if existing
+	fReturnValue = PropertyStorage_CopyElementValue(PropertyStorage_ReadElementByKey(pFrozen, PwszKey), PwszValue, PpunValueSize);
 
+	PropertyStorage_ReadEnd(pSession);
 	return fReturnValue;
 }
 
@@ -358,41 +1096,21 @@ PropertyStorage_GetBooleanValueByKey(
 	_In_z_	const wchar_t*	PwszKey,
 	_Out_	BOOL*			PpfValue)
 {
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
 	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
+	IfxPropertyElement sCopy;
 
-	do
+	// Check parameters
+	if (NULL != PwszKey && NULL != PpfValue)
 	{
-		wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-		unsigned int unValueSize = RG_LEN(wszValue);
-
-		// Check parameters
-		if (NULL == PwszKey ||
-				NULL == PpfValue)
-			break;
-
-		*PpfValue = FALSE;
-
-		if (FALSE == PropertyStorage_GetValueByKey(PwszKey, wszValue, &unValueSize))
-			break;
-
-		// Increment size by one due to null-termination
-		if (PROPERTY_STORAGE_MAX_VALUE > unValueSize)
-			unValueSize++;
-
-		// Convert value to BOOL, if possible
-		if (0 == Platform_StringCompare(L"TRUE", wszValue, unValueSize, TRUE))
-		{
-			*PpfValue = TRUE;
-			fReturnValue = TRUE;
-		}
-		else if (0 == Platform_StringCompare(L"FALSE", wszValue, unValueSize, TRUE))
-		{
-			*PpfValue = FALSE;
-			fReturnValue = TRUE;
-		}
+		pElement = PropertyStorage_ReadTypedElement(pFrozen, PropertyStorage_ReadElementByKey(pFrozen, PwszKey), PROPERTY_VALUE_BOOLEAN, &sCopy);
+		*PpfValue = NULL != pElement ? pElement->fValue : FALSE;
+		fReturnValue = NULL != pElement;
 	}
-	WHILE_FALSE_END;
 
+	PropertyStorage_ReadEnd(pSession);
 	return fReturnValue;
 }
 
@@ -413,50 +1131,21 @@ PropertyStorage_GetUIntegerValueByKey(
 	_In_z_	const wchar_t*		PwszKey,
 	_Out_	unsigned int*		PpunValue)
 {
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
 	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
+	IfxPropertyElement sCopy;
 
-	do
+	// Check parameters
+	if (NULL != PwszKey && NULL != PpunValue)
 	{
-		wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-		unsigned int unValueSize = RG_LEN(wszValue);
-		int nIndex = -1;
-
-		// Check parameters
-		if (NULL == PwszKey ||
-				NULL == PpunValue)
-			break;
-
-		if (FALSE == PropertyStorage_GetValueByKey(PwszKey, wszValue, &unValueSize))
-			break;
-
-		// Increment size by one due to null-termination
-		if (PROPERTY_STORAGE_MAX_VALUE > unValueSize)
-			unValueSize++;
-
-		// Convert String to Integer
-		if (RC_SUCCESS == Utility_StringContainsWChar(wszValue, unValueSize, L'x', &nIndex))
-		{
-			if (nIndex == -1)
-			{
-				// Convert as decimal value
-				if (RC_SUCCESS == Utility_StringParseUInteger(wszValue, unValueSize, PpunValue))
-					fReturnValue = TRUE;
-			}
-			else
-			{
-				// Convert as hex value
-				if (RC_SUCCESS == Utility_UIntegerParseHexString(wszValue, PpunValue))
-					fReturnValue = TRUE;
-			}
-		}
+		pElement = PropertyStorage_ReadTypedElement(pFrozen, PropertyStorage_ReadElementByKey(pFrozen, PwszKey), PROPERTY_VALUE_UINTEGER, &sCopy);
+		*PpunValue = NULL != pElement ? pElement->unValue : 0;
+		fReturnValue = NULL != pElement;
 	}
-	WHILE_FALSE_END;
-
-	if (FALSE == fReturnValue)
-		// Reset out parameters
-		if (NULL != PpunValue)
-			*PpunValue = 0;
 
+	PropertyStorage_ReadEnd(pSession);
 	return fReturnValue;
 }
 
@@ -474,8 +1163,15 @@ BOOL
 PropertyStorage_ExistsElement(
 	_In_z_ const wchar_t* PwszKey)
 {
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
+	BOOL fReturnValue = FALSE;
+
 	// Try to get the element with the given key
-	return NULL != PropertyStorage_GetElementByKey(PwszKey);
+	fReturnValue = NULL != PropertyStorage_ReadElementByKey(pFrozen, PwszKey);
+
+	PropertyStorage_ReadEnd(pSession);
+	return fReturnValue;
 }
 
 /**
@@ -493,41 +1189,47 @@ BOOL
 PropertyStorage_RemoveElement(
 	_In_z_ const wchar_t* PwszKey)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	BOOL fReturnValue = FALSE;
 
 	do
 	{
-		IfxPropertyElement* pElement = NULL;
+		unsigned int unSlot = 0;
+		unsigned int unNext = 0;
 
 		// Check parameter
 		if (NULL == PwszKey)
 			break;
 
-		// Get element to be removed, if existing
-		pElement = PropertyStorage_GetElementByKey(PwszKey);
-		if (NULL != pElement)
-		{
-			// Get previous and next elements
-			IfxPropertyElement* pPrev = pElement->pvPreviousElement;
-			IfxPropertyElement* pNext = pElement->pvNextElement;
+		// Get slot of the element to be removed, if existing
+		unSlot = PropertyStorage_FindSlot(PwszKey, PropertyStorage_HashKey(PwszKey));
+		if (unSlot >= pSession->unPropertySlotCount || NULL == pSession->pPropertySlots[unSlot].pElement)
+			break;
 
-			// Hang out the element now
-			if (NULL != pPrev)
-				pPrev->pvNextElement = pNext;
-			if (NULL != pNext)
-				pNext->pvPreviousElement = pPrev;
+		// Drop the element, its arena memory is released by PropertyStorage_ClearElements
+		if (pSession->pPropertySlots[unSlot].pElement->unPropertyId < PROPERTY_ID_COUNT)
+			pSession->rgpPropertyIdElements[pSession->pPropertySlots[unSlot].pElement->unPropertyId] = NULL;
+		pSession->pPropertySlots[unSlot].pElement = NULL;
+		pSession->pPropertySlots[unSlot].unHash = 0;
+		pSession->unPropertyElementCount--;
 
-			// Check if element to be removed is the first or last element
-			if (s_pvHead == pElement)
-				s_pvHead = pNext;
-			if (s_pvTail == pElement)
-				s_pvTail = pPrev;
+		// Shift following elements of the probe sequence back, so that no lookup stops at the freed slot
+		for (unNext = (unSlot + 1) & (pSession->unPropertySlotCount - 1); NULL != pSession->pPropertySlots[unNext].pElement; unNext = (unNext + 1) & (pSession->unPropertySlotCount - 1))
+		{
+			unsigned int unHome = pSession->pPropertySlots[unNext].unHash & (pSession->unPropertySlotCount - 1);
 
-			// Free memory of element to be removed
-			Platform_MemoryFree((void**)&pElement);
+			// Keep the element if its home slot lies cyclically in (unSlot, unNext]
+			if (unSlot <= unNext ? (unSlot < unHome && unHome <= unNext) : (unSlot < unHome || unHome <= unNext))
+				continue;
 
-			fReturnValue = TRUE;
+			pSession->pPropertySlots[unSlot] = pSession->pPropertySlots[unNext];
+			pSession->pPropertySlots[unNext].pElement = NULL;
+			pSession->pPropertySlots[unNext].unHash = 0;
+			unSlot = unNext;
 		}
+
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
 	}
 	WHILE_FALSE_END;
 
@@ -541,25 +1243,32 @@ PropertyStorage_RemoveElement(
 void
 PropertyStorage_ClearElements()
 {
-	// Start with the first element
-	IfxPropertyElement* pIteratorElement = s_pvHead;
+	IfxSession* pSession = Session_GetCurrent();
 
-	// Walk along until the end of the list has been reached
-	while (NULL != pIteratorElement)
+	// Free all arena blocks holding the elements
+	while (NULL != pSession->pPropertyArena)
 	{
-		// Remember pointer of current element
-		IfxPropertyElement* pElement = pIteratorElement;
+		IfxPropertyArenaBlock* pBlock = pSession->pPropertyArena;
+		pSession->pPropertyArena = pBlock->pvPreviousBlock;
+		Platform_MemoryFree((void**)&pBlock);
+	}
 
-		// Update iterator
-		pIteratorElement = pIteratorElement->pvNextElement;
+	// Free the hash table
+	Platform_MemoryFree((void**)&pSession->pPropertySlots);
+	pSession->unPropertySlotCount = 0;
+	pSession->unPropertyElementCount = 0;
+	IGNORE_RETURN_VALUE(Platform_MemorySet(pSession->rgpPropertyIdElements, 0, sizeof(pSession->rgpPropertyIdElements)));
 
-		// Free memory of current element
-		Platform_MemoryFree((void**)&pElement);
+	// Free the frozen tables, the storage is writable without copy-on-write again
+	if (NULL != pSession->pPropertyFrozen)
+	{
+		pSession->pPropertyFrozen->pRetiredNext = pSession->pPropertyRetired;
+		pSession->pPropertyRetired = pSession->pPropertyFrozen;
+		pSession->pPropertyFrozen = NULL;
 	}
+	PropertyStorage_ReleaseRetiredTables(pSession);
 
-	// Clear pointers to first and last element
-	s_pvHead = NULL;
-	s_pvTail = NULL;
+	Logging_UpdateLevel();
 }
 
 /**
@@ -580,11 +1289,16 @@ PropertyStorage_AddKeyULongLongValuePair(
 	_In_	unsigned long long	PullValue)
 {
 	BOOL fReturnValue = FALSE;
-	wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-	unsigned int unValueSize = RG_LEN(wszValue);
+	IfxPropertyElement* pElement = NULL;
 
-	if (RC_SUCCESS == Utility_ULongLong2String(PullValue, wszValue, &unValueSize))
-		fReturnValue = PropertyStorage_AddKeyValuePair(PwszKey, wszValue);
+	if (NULL != PwszKey)
+		pElement = PropertyStorage_InsertElement(PwszKey);
+	if (NULL != pElement)
+	{
+		PropertyStorage_SetTypedValue(pElement, PROPERTY_VALUE_ULONGLONG, PullValue);
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
+	}
 
 	return fReturnValue;
 }
@@ -607,11 +1321,16 @@ PropertyStorage_ChangeULongLongValueByKey(
 	_In_	unsigned long long	PullValue)
 {
 	BOOL fReturnValue = FALSE;
-	wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-	unsigned int unValueSize = RG_LEN(wszValue);
+	IfxPropertyElement* pElement = NULL;
 
-	if (RC_SUCCESS == Utility_ULongLong2String(PullValue, wszValue, &unValueSize))
-		fReturnValue = PropertyStorage_ChangeValueByKey(PwszKey, wszValue);
+	if (NULL != PwszKey)
+		pElement = PropertyStorage_GetElementByKey(PwszKey);
+	if (NULL != pElement)
+	{
+		PropertyStorage_SetTypedValue(pElement, PROPERTY_VALUE_ULONGLONG, PullValue);
+		PropertyStorage_OnElementChanged(PwszKey);
+		fReturnValue = TRUE;
+	}
 
 	return fReturnValue;
 }
@@ -633,34 +1352,323 @@ PropertyStorage_GetULongLongValueByKey(
 	_In_z_	const wchar_t*		PwszKey,
 	_Out_	unsigned long long*	PpullValue)
 {
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
+	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
+	IfxPropertyElement sCopy;
+
+	// Check parameters
+	if (NULL != PwszKey && NULL != PpullValue)
+	{
+		pElement = PropertyStorage_ReadTypedElement(pFrozen, PropertyStorage_ReadElementByKey(pFrozen, PwszKey), PROPERTY_VALUE_ULONGLONG, &sCopy);
+		*PpullValue = NULL != pElement ? pElement->ullValue : 0;
+		fReturnValue = NULL != pElement;
+	}
+
+	PropertyStorage_ReadEnd(pSession);
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Get the value of the built-in PropertyElement with the given identifier
+ *	@details	Same as PropertyStorage_GetValueByKey without the key lookup.
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *	@param		PwszValue		Pointer to a wide char array receiving the PropertyElement value
+ *	@param		PpunValueSize	Size of the PwszValue buffer in elements including the zero termination
+ *
+ *	@retval		TRUE		If the operation was successful
+ *	@retval		FALSE		If the value could not be retrieved, e.g. because the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_GetValueById(
+	_In_						ENUM_PROPERTY_IDS	PunPropertyId,
+	_Out_z_cap_(*PpunValueSize)	wchar_t*			PwszValue,
+	_Inout_						unsigned int*		PpunValueSize)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
+	BOOL fReturnValue = FALSE;
+
+	fReturnValue = PropertyStorage_CopyElementValue(PropertyStorage_ReadElementById(pSession, pFrozen, PunPropertyId), PwszValue, PpunValueSize);
+
+	PropertyStorage_ReadEnd(pSession);
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Get the value of the built-in PropertyElement with the given identifier casted to a BOOL
+ *	@details	Same as PropertyStorage_GetBooleanValueByKey without the key lookup.
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *	@param		PpfValue		Pointer to a BOOL containing the PropertyElement value
+ *
+ *	@retval		TRUE		If the operation was successful
+ *	@retval		FALSE		If the value could not be retrieved, e.g. because the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_GetBooleanValueById(
+	_In_	ENUM_PROPERTY_IDS	PunPropertyId,
+	_Out_	BOOL*				PpfValue)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
+	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
+	IfxPropertyElement sCopy;
+
+	// Check parameters
+	if (PunPropertyId < PROPERTY_ID_COUNT && NULL != PpfValue)
+	{
+		pElement = PropertyStorage_ReadTypedElement(pFrozen, PropertyStorage_ReadElementById(pSession, pFrozen, PunPropertyId), PROPERTY_VALUE_BOOLEAN, &sCopy);
+		*PpfValue = NULL != pElement ? pElement->fValue : FALSE;
+		fReturnValue = NULL != pElement;
+	}
+
+	PropertyStorage_ReadEnd(pSession);
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Get the value of the built-in PropertyElement with the given identifier casted to an unsigned integer
+ *	@details	Same as PropertyStorage_GetUIntegerValueByKey without the key lookup.
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *	@param		PpunValue		Pointer to an unsigned integer containing the PropertyElement value
+ *
+ *	@retval		TRUE		If the operation was successful
+ *	@retval		FALSE		If the value could not be retrieved, e.g. because the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_GetUIntegerValueById(
+	_In_	ENUM_PROPERTY_IDS	PunPropertyId,
+	_Out_	unsigned int*		PpunValue)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
+	BOOL fReturnValue = FALSE;
+	IfxPropertyElement* pElement = NULL;
+	IfxPropertyElement sCopy;
+
+	// Check parameters
+	if (PunPropertyId < PROPERTY_ID_COUNT && NULL != PpunValue)
+	{
+		pElement = PropertyStorage_ReadTypedElement(pFrozen, PropertyStorage_ReadElementById(pSession, pFrozen, PunPropertyId), PROPERTY_VALUE_UINTEGER, &sCopy);
+		*PpunValue = NULL != pElement ? pElement->unValue : 0;
+		fReturnValue = NULL != pElement;
+	}
+
+	PropertyStorage_ReadEnd(pSession);
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Checks the existence of the built-in PropertyElement with the given identifier
+ *	@details
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *
+ *	@retval		TRUE		If the property has been set
+ *	@retval		FALSE		If the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_ExistsElementById(
+	_In_ ENUM_PROPERTY_IDS PunPropertyId)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	const IfxPropertyFrozenTable* pFrozen = PropertyStorage_ReadBegin(pSession);
+	BOOL fReturnValue = FALSE;
+
+	fReturnValue = NULL != PropertyStorage_ReadElementById(pSession, pFrozen, PunPropertyId);
+
+	PropertyStorage_ReadEnd(pSession);
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Serializes all elements of the PropertyStorage into a snapshot
+ *	@details	Each element is stored as IfxPropertySnapshotElement followed by its key and string value, so all value
+ *				representations including failed conversions are restored as they are. The caller must free the
+ *				snapshot with Platform_MemoryFree.
+ *
+ *	@param		PprgbSnapshot		Receives the allocated snapshot
+ *	@param		PpunSnapshotSize	Receives the size of the snapshot in bytes
+ *
+ *	@retval		TRUE		If the snapshot has been created
+ *	@retval		FALSE		If the memory allocation failed or a parameter is NULL
+ */
+_Check_return_
+BOOL
+PropertyStorage_Serialize(
+	_Outptr_result_maybenull_	BYTE**			PprgbSnapshot,
+	_Out_						unsigned int*	PpunSnapshotSize)
+{
+	IfxSession* pSession = Session_GetCurrent();
 	BOOL fReturnValue = FALSE;
 
 	do
 	{
-		wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
-		unsigned int unValueSize = RG_LEN(wszValue);
+		unsigned int unSize = 0;
+		unsigned int unOffset = 0;
+		unsigned int unSlot = 0;
 
 		// Check parameters
-		if (NULL == PwszKey || NULL == PpullValue)
+		if (NULL == PprgbSnapshot || NULL == PpunSnapshotSize)
 			break;
+		*PprgbSnapshot = NULL;
+		*PpunSnapshotSize = 0;
+
+		// Calculate the snapshot size, key and value lengths are bounded by the storage limits
+		for (unSlot = 0; unSlot < pSession->unPropertySlotCount; unSlot++)
+		{
+			const IfxPropertyElement* pElement = pSession->pPropertySlots[unSlot].pElement;
+			unsigned int unKeyLength = 0, unValueLength = 0;
+
+			if (NULL == pElement)
+				continue;
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszKey, PROPERTY_STORAGE_MAX_KEY, &unKeyLength));
+			if (0 != (pElement->unValidFlags & PROPERTY_VALUE_STRING))
+				IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszValue, pElement->unValueCapacity, &unValueLength));
+			unSize += sizeof(IfxPropertySnapshotElement) + (unKeyLength + unValueLength) * sizeof(wchar_t);
+		}
 
-		if (FALSE == PropertyStorage_GetValueByKey(PwszKey, wszValue, &unValueSize))
+		// Allocate at least one byte, so an empty storage yields a valid snapshot
+		*PprgbSnapshot = (BYTE*)Platform_MemoryAllocateZero(0 == unSize ? 1 : unSize);
+		if (NULL == *PprgbSnapshot)
 			break;
 
-		// Increment size by one due to null-termination
-		if (PROPERTY_STORAGE_MAX_VALUE > unValueSize)
-			unValueSize++;
+		for (unSlot = 0; unSlot < pSession->unPropertySlotCount; unSlot++)
+		{
+			const IfxPropertyElement* pElement = pSession->pPropertySlots[unSlot].pElement;
+			IfxPropertySnapshotElement sElement;
+
+			if (NULL == pElement)
+				continue;
+			IGNORE_RETURN_VALUE(Platform_MemorySet(&sElement, 0, sizeof(sElement)));
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszKey, PROPERTY_STORAGE_MAX_KEY, &sElement.unKeyLength));
+			if (0 != (pElement->unValidFlags & PROPERTY_VALUE_STRING))
+				IGNORE_RETURN_VALUE(Platform_StringGetLength(pElement->wszValue, pElement->unValueCapacity, &sElement.unValueLength));
+			sElement.unValidFlags = pElement->unValidFlags;
+			sElement.unConvertedFlags = pElement->unConvertedFlags;
+			sElement.fValue = pElement->fValue;
+			sElement.unValue = pElement->unValue;
+			sElement.ullValue = pElement->ullValue;
+
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(*PprgbSnapshot + unOffset, unSize - unOffset, &sElement, sizeof(sElement)));
+			unOffset += sizeof(sElement);
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(*PprgbSnapshot + unOffset, unSize - unOffset, pElement->wszKey, sElement.unKeyLength * sizeof(wchar_t)));
+			unOffset += sElement.unKeyLength * sizeof(wchar_t);
+			if (0 != sElement.unValueLength)
+			{
+				IGNORE_RETURN_VALUE(Platform_MemoryCopy(*PprgbSnapshot + unOffset, unSize - unOffset, pElement->wszValue, sElement.unValueLength * sizeof(wchar_t)));
+				unOffset += sElement.unValueLength * sizeof(wchar_t);
+			}
+		}
 
-		// Convert String to Integer
-		if (RC_SUCCESS == Utility_StringParseULongLong(wszValue, unValueSize, PpullValue))
-			fReturnValue = TRUE;
+		*PpunSnapshotSize = unSize;
+		fReturnValue = TRUE;
 	}
 	WHILE_FALSE_END;
 
-	if (FALSE == fReturnValue)
-		// Reset out parameters
-		if (NULL != PpullValue)
-			*PpullValue = 0;
+	return fReturnValue;
+}
+
+/**
+ *	@brief		Adds the elements of a snapshot to the PropertyStorage
+ *	@details	The snapshot must have been created by PropertyStorage_Serialize of the same build. Operation fails in case
+ *				the snapshot is malformed or an element with the same key already exists, the elements added so far stay.
+ *
+ *	@param		PrgbSnapshot		Snapshot created by PropertyStorage_Serialize
+ *	@param		PunSnapshotSize		Size of the snapshot in bytes
+ *
+ *	@retval		TRUE		If all elements have been added
+ *	@retval		FALSE		If the snapshot could not be restored completely
+ */
+_Check_return_
+BOOL
+PropertyStorage_Deserialize(
+	_In_bytecount_(PunSnapshotSize)	const BYTE*		PrgbSnapshot,
+	_In_							unsigned int	PunSnapshotSize)
+{
+	BOOL fReturnValue = FALSE;
+	unsigned int unOffset = 0;
+
+	// Check parameter
+	if (NULL == PrgbSnapshot)
+		return FALSE;
+
+	while (unOffset < PunSnapshotSize)
+	{
+		IfxPropertySnapshotElement sElement;
+		wchar_t wszKey[PROPERTY_STORAGE_MAX_KEY] = {0};
+		wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
+		IfxPropertyElement* pElement = NULL;
+
+		fReturnValue = FALSE;
+
+		// Read the element header and check the lengths against the storage limits and the remaining snapshot
+		if (PunSnapshotSize - unOffset < sizeof(sElement) ||
+				RC_SUCCESS != Platform_MemoryCopy(&sElement, sizeof(sElement), PrgbSnapshot + unOffset, sizeof(sElement)))
+			break;
+		unOffset += sizeof(sElement);
+		if (0 == sElement.unKeyLength || sElement.unKeyLength >= RG_LEN(wszKey) || sElement.unValueLength >= RG_LEN(wszValue) ||
+				(PunSnapshotSize - unOffset) / sizeof(wchar_t) < sElement.unKeyLength + sElement.unValueLength)
+			break;
+
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(wszKey, sizeof(wszKey), PrgbSnapshot + unOffset, sElement.unKeyLength * sizeof(wchar_t)));
+		unOffset += sElement.unKeyLength * sizeof(wchar_t);
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(wszValue, sizeof(wszValue), PrgbSnapshot + unOffset, sElement.unValueLength * sizeof(wchar_t)));
+		unOffset += sElement.unValueLength * sizeof(wchar_t);
+
+		pElement = PropertyStorage_InsertElement(wszKey);
+		if (NULL == pElement)
+			break;
+		if (0 != (sElement.unValidFlags & PROPERTY_VALUE_STRING) && !PropertyStorage_SetStringValue(pElement, wszValue))
+		{
+			IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(wszKey));
+			break;
+		}
+
+		// Take over all value representations as they have been serialized
+		pElement->fValue = sElement.fValue;
+		pElement->unValue = sElement.unValue;
+		pElement->ullValue = sElement.ullValue;
+		pElement->unValidFlags = sElement.unValidFlags;
+		pElement->unConvertedFlags = sElement.unConvertedFlags;
+
+		PropertyStorage_OnElementChanged(wszKey);
+		fReturnValue = TRUE;
+	}
+
+	// An empty snapshot restores an empty storage
+	if (0 == PunSnapshotSize)
+		fReturnValue = TRUE;
 
 	return fReturnValue;
+}
+
+/**
+ *	@brief		Freezes the PropertyStorage for reading from several threads
+ *	@details	Publishes an immutable copy of all elements in one contiguous block. From now on all reads use the
+ *				published copy without a lock and never change it, so any thread may read the PropertyStorage of the
+ *				session. Writes remain restricted to the thread owning the session. Each write builds a new copy and
+ *				swaps it for the readers (copy-on-write), a replaced copy is released once no read is in progress.
+ *				PropertyStorage_ClearElements ends the frozen state and must not run concurrently to readers.
+ *
+ *	@retval		TRUE		If the PropertyStorage is frozen
+ *	@retval		FALSE		If a value could not be converted to a string or the memory allocation failed
+ */
+_Check_return_
+BOOL
+PropertyStorage_Freeze()
+{
+	if (NULL != Session_GetCurrent()->pPropertyFrozen)
+		return TRUE;
+
+	return PropertyStorage_PublishFrozenTable();
 }
\ No newline at end of file
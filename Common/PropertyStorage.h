@@ -25,23 +25,174 @@ extern "C" {
 #define PROPERTY_STORAGE_MAX_KEY	MAX_NAME + 1
 /// Define property storage max value size
 #define PROPERTY_STORAGE_MAX_VALUE	MAX_PATH + 1
+/// Define initial number of slots of the property hash table (must be a power of two)
+#define PROPERTY_STORAGE_MIN_SLOTS	64
+/// Define size of an arena block for property elements, keys and values in bytes
+#define PROPERTY_STORAGE_ARENA_BLOCK_SIZE	16384
+/// Define arena allocation alignment in bytes (must be a power of two)
+#define PROPERTY_STORAGE_ARENA_ALIGNMENT	8
+/// Define value capacity in elements for the string representation of a typed value
+#define PROPERTY_STORAGE_TYPED_VALUE_SIZE	24
+
+/// Value representation flag for the wide character string value
+#define PROPERTY_VALUE_STRING		0x1
+/// Value representation flag for the boolean value
+#define PROPERTY_VALUE_BOOLEAN		0x2
+/// Value representation flag for the unsigned integer value
+#define PROPERTY_VALUE_UINTEGER		0x4
+/// Value representation flag for the unsigned long long value
+#define PROPERTY_VALUE_ULONGLONG	0x8
+
+/**
+ *	@brief		Enumeration of the built-in properties with a compile-time identifier
+ *	@details	Each identifier is bound to its property key. An element stored under such a key is also
+ *				reachable through a directly indexed slot, so the *ById accessors need no key lookup.
+ */
+typedef enum td_ENUM_PROPERTY_IDS
+{
+	/// PROPERTY_TPM_DEVICE_ACCESS_MODE
+	PROPERTY_ID_TPM_DEVICE_ACCESS_MODE,
+	/// PROPERTY_TPM_DEVICE_ACCESS_PATH
+	PROPERTY_ID_TPM_DEVICE_ACCESS_PATH,
+	/// PROPERTY_LOCALITY
+	PROPERTY_ID_LOCALITY,
+	/// PROPERTY_CALL_SHUTDOWN_ON_EXIT
+	PROPERTY_ID_CALL_SHUTDOWN_ON_EXIT,
+	/// PROPERTY_STATISTICS
+	PROPERTY_ID_STATISTICS,
+	/// PROPERTY_TPM_CAPTURE_PATH
+	PROPERTY_ID_TPM_CAPTURE_PATH,
+	/// PROPERTY_TPM_TROUBLESHOOTING_FRAMES
+	PROPERTY_ID_TPM_TROUBLESHOOTING_FRAMES,
+	/// PROPERTY_TPM_TROUBLESHOOTING
+	PROPERTY_ID_TPM_TROUBLESHOOTING,
+	/// PROPERTY_TPM_REPLAY_TIMING_SCALE
+	PROPERTY_ID_TPM_REPLAY_TIMING_SCALE,
+	/// PROPERTY_TPM_SOCKET_POWER_ON
+	PROPERTY_ID_TPM_SOCKET_POWER_ON,
+	/// PROPERTY_TPM_DEVICE_LOCK_TIMEOUT
+	PROPERTY_ID_TPM_DEVICE_LOCK_TIMEOUT,
+	/// PROPERTY_LOGGING_LEVEL
+	PROPERTY_ID_LOGGING_LEVEL,
+	/// PROPERTY_LOGGING_PATH
+	PROPERTY_ID_LOGGING_PATH,
+	/// PROPERTY_LOGGING_MAXSIZE
+	PROPERTY_ID_LOGGING_MAXSIZE,
+	/// PROPERTY_LOGGING_FLUSH_INTERVAL
+	PROPERTY_ID_LOGGING_FLUSH_INTERVAL,
+	/// PROPERTY_LOGGING_MAX_FILES
+	PROPERTY_ID_LOGGING_MAX_FILES,
+	/// PROPERTY_LOGGING_COMPRESS
+	PROPERTY_ID_LOGGING_COMPRESS,
+	/// PROPERTY_LOGGING_ASYNC
+	PROPERTY_ID_LOGGING_ASYNC,
+	/// PROPERTY_LOGGING_JSON
+	PROPERTY_ID_LOGGING_JSON,
+	/// PROPERTY_LOGGING_MODULE_LEVELS
+	PROPERTY_ID_LOGGING_MODULE_LEVELS,
+	/// PROPERTY_CONSOLE_MODE
+	PROPERTY_ID_CONSOLE_MODE,
+	/// Number of property identifiers, also used for elements without an identifier
+	PROPERTY_ID_COUNT
+} ENUM_PROPERTY_IDS;
 
 /**
- *	@brief		This structure is used to store a property in a double linked list
- *	@details	Each element has a unique key and a value.
+ *	@brief		This structure is used for a block of the property arena
+ *	@details	Elements, keys and values are carved from arena blocks and are released all at once by
+ *				PropertyStorage_ClearElements. The data follows the header aligned to PROPERTY_STORAGE_ARENA_ALIGNMENT.
+ */
+typedef struct tdIfxPropertyArenaBlock
+{
+	/// Pointer to the previously allocated block (NULL if the first block)
+	struct tdIfxPropertyArenaBlock*	pvPreviousBlock;
+	/// Size of the data in bytes
+	unsigned int					unSize;
+	/// Used size of the data in bytes
+	unsigned int					unUsed;
+} IfxPropertyArenaBlock;
+
+/**
+ *	@brief		This structure is used to store a property
+ *	@details	Each element has a unique key and a value. The value is stored in the representation it has been set
+ *				with. Other representations are converted on first request and kept until the value changes, so
+ *				typed reads of a typed value are a plain load. Key and string value are variable length arena strings.
  */
 typedef struct tdIfxPropertyElement
 {
-	/// Pointer to the previous IfxPropertyElement (NULL if the first element)
-	struct tdIfxPropertyElement*	pvPreviousElement;
-	/// Pointer to the next IfxPropertyElement (NULL if the last element)
-	struct tdIfxPropertyElement*	pvNextElement;
 	/// Key to identify the IfxPropertyElement
-	wchar_t							wszKey[PROPERTY_STORAGE_MAX_KEY];
-	/// Value for the IfxPropertyElement
-	wchar_t							wszValue[PROPERTY_STORAGE_MAX_VALUE];
+	wchar_t*						wszKey;
+	/// Value for the IfxPropertyElement (valid if PROPERTY_VALUE_STRING is set in unValidFlags, NULL if not yet allocated)
+	wchar_t*						wszValue;
+	/// Capacity of wszValue in elements including the zero termination
+	unsigned int					unValueCapacity;
+	/// Boolean value (valid if PROPERTY_VALUE_BOOLEAN is set in unValidFlags)
+	BOOL							fValue;
+	/// Unsigned integer value (valid if PROPERTY_VALUE_UINTEGER is set in unValidFlags)
+	unsigned int					unValue;
+	/// Unsigned long long value (valid if PROPERTY_VALUE_ULONGLONG is set in unValidFlags)
+	unsigned long long				ullValue;
+	/// PROPERTY_VALUE_* flags of the valid value representations
+	unsigned int					unValidFlags;
+	/// PROPERTY_VALUE_* flags of the representations which have been set or converted (also if the conversion failed)
+	unsigned int					unConvertedFlags;
+	/// Identifier of a built-in property (PROPERTY_ID_COUNT if the key has none)
+	ENUM_PROPERTY_IDS				unPropertyId;
 } IfxPropertyElement;
 
+/**
+ *	@brief		This structure is used for a slot of the property hash table
+ *	@details	The table uses open addressing with linear probing. The key hash is stored in the slot, so probing
+ *				only dereferences the element in case of a matching hash.
+ */
+typedef struct tdIfxPropertySlot
+{
+	/// Hash of the element key
+	unsigned int					unHash;
+	/// Element stored in the slot (NULL if the slot is free)
+	IfxPropertyElement*				pElement;
+} IfxPropertySlot;
+
+/**
+ *	@brief		This structure is used for a frozen copy of the property hash table
+ *	@details	Slots, elements, keys and values follow the structure in the same memory block. A frozen table is never
+ *				changed after it has been published, so it can be read by several threads without a lock.
+ */
+typedef struct tdIfxPropertyFrozenTable
+{
+	/// Next retired table waiting to be released (NULL if none or the table is published)
+	struct tdIfxPropertyFrozenTable*	pRetiredNext;
+	/// Slots of the table
+	IfxPropertySlot*					pSlots;
+	/// Number of slots (a power of two)
+	unsigned int						unSlotCount;
+	/// Elements of the built-in properties indexed by their identifier
+	IfxPropertyElement*					rgpIdElements[PROPERTY_ID_COUNT];
+} IfxPropertyFrozenTable;
+
+/**
+ *	@brief		This structure is used for an element of a property snapshot
+ *	@details	The key and, if PROPERTY_VALUE_STRING is set in unValidFlags, the string value follow the structure as
+ *				wide char arrays without zero termination. The layout depends on the build, so a snapshot must only be
+ *				restored by the build which has written it.
+ */
+typedef struct tdIfxPropertySnapshotElement
+{
+	/// Length of the key in elements
+	unsigned int					unKeyLength;
+	/// Length of the string value in elements (0 if PROPERTY_VALUE_STRING is not set in unValidFlags)
+	unsigned int					unValueLength;
+	/// PROPERTY_VALUE_* flags of the valid value representations
+	unsigned int					unValidFlags;
+	/// PROPERTY_VALUE_* flags of the representations which have been set or converted
+	unsigned int					unConvertedFlags;
+	/// Boolean value
+	BOOL							fValue;
+	/// Unsigned integer value
+	unsigned int					unValue;
+	/// Unsigned long long value
+	unsigned long long				ullValue;
+} IfxPropertySnapshotElement;
+
 /**
  *	@brief		Add a key value pair to the PropertyStorage
  *	@details	Operation fails in case an element with same key already exists.
@@ -287,6 +438,120 @@ PropertyStorage_GetULongLongValueByKey(
 	_In_z_	const wchar_t*		PwszKey,
 	_Out_	unsigned long long*	PpullValue);
 
+/**
+ *	@brief		Get the value of the built-in PropertyElement with the given identifier
+ *	@details	Same as PropertyStorage_GetValueByKey without the key lookup.
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *	@param		PwszValue		Pointer to a wide char array receiving the PropertyElement value
+ *	@param		PpunValueSize	Size of the PwszValue buffer in elements including the zero termination
+ *
+ *	@retval		TRUE		If the operation was successful
+ *	@retval		FALSE		If the value could not be retrieved, e.g. because the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_GetValueById(
+	_In_						ENUM_PROPERTY_IDS	PunPropertyId,
+	_Out_z_cap_(*PpunValueSize)	wchar_t*			PwszValue,
+	_Inout_						unsigned int*		PpunValueSize);
+
+/**
+ *	@brief		Get the value of the built-in PropertyElement with the given identifier casted to a BOOL
+ *	@details	Same as PropertyStorage_GetBooleanValueByKey without the key lookup.
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *	@param		PpfValue		Pointer to a BOOL containing the PropertyElement value
+ *
+ *	@retval		TRUE		If the operation was successful
+ *	@retval		FALSE		If the value could not be retrieved, e.g. because the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_GetBooleanValueById(
+	_In_	ENUM_PROPERTY_IDS	PunPropertyId,
+	_Out_	BOOL*				PpfValue);
+
+/**
+ *	@brief		Get the value of the built-in PropertyElement with the given identifier casted to an unsigned integer
+ *	@details	Same as PropertyStorage_GetUIntegerValueByKey without the key lookup.
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *	@param		PpunValue		Pointer to an unsigned integer containing the PropertyElement value
+ *
+ *	@retval		TRUE		If the operation was successful
+ *	@retval		FALSE		If the value could not be retrieved, e.g. because the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_GetUIntegerValueById(
+	_In_	ENUM_PROPERTY_IDS	PunPropertyId,
+	_Out_	unsigned int*		PpunValue);
+
+/**
+ *	@brief		Checks the existence of the built-in PropertyElement with the given identifier
+ *	@details
+ *
+ *	@param		PunPropertyId	Identifier of the built-in property
+ *
+ *	@retval		TRUE		If the property has been set
+ *	@retval		FALSE		If the property has not been set
+ */
+_Check_return_
+BOOL
+PropertyStorage_ExistsElementById(
+	_In_ ENUM_PROPERTY_IDS PunPropertyId);
+
+/**
+ *	@brief		Freezes the PropertyStorage for reading from several threads
+ *	@details	Publishes an immutable copy of all elements in one contiguous block. From now on all reads use the
+ *				published copy without a lock and never change it, so any thread may read the PropertyStorage of the
+ *				session. Writes remain restricted to the thread owning the session. Each write builds a new copy and
+ *				swaps it for the readers (copy-on-write), a replaced copy is released once no read is in progress.
+ *				PropertyStorage_ClearElements ends the frozen state and must not run concurrently to readers.
+ *
+ *	@retval		TRUE		If the PropertyStorage is frozen
+ *	@retval		FALSE		If a value could not be converted to a string or the memory allocation failed
+ */
+_Check_return_
+BOOL
+PropertyStorage_Freeze();
+
+/**
+ *	@brief		Serializes all elements of the PropertyStorage into a snapshot
+ *	@details	Each element is stored as IfxPropertySnapshotElement followed by its key and string value, so all value
+ *				representations including failed conversions are restored as they are. The caller must free the
+ *				snapshot with Platform_MemoryFree.
+ *
+ *	@param		PprgbSnapshot		Receives the allocated snapshot
+ *	@param		PpunSnapshotSize	Receives the size of the snapshot in bytes
+ *
+ *	@retval		TRUE		If the snapshot has been created
+ *	@retval		FALSE		If the memory allocation failed or a parameter is NULL
+ */
+_Check_return_
+BOOL
+PropertyStorage_Serialize(
+	_Outptr_result_maybenull_	BYTE**			PprgbSnapshot,
+	_Out_						unsigned int*	PpunSnapshotSize);
+
+/**
+ *	@brief		Adds the elements of a snapshot to the PropertyStorage
+ *	@details	The snapshot must have been created by PropertyStorage_Serialize of the same build. Operation fails in case
+ *				the snapshot is malformed or an element with the same key already exists, the elements added so far stay.
+ *
+ *	@param		PrgbSnapshot		Snapshot created by PropertyStorage_Serialize
+ *	@param		PunSnapshotSize		Size of the snapshot in bytes
+ *
+ *	@retval		TRUE		If all elements have been added
+ *	@retval		FALSE		If the snapshot could not be restored completely
+ */
+_Check_return_
+BOOL
+PropertyStorage_Deserialize(
+	_In_bytecount_(PunSnapshotSize)	const BYTE*		PrgbSnapshot,
+	_In_							unsigned int	PunSnapshotSize);
+
 #ifdef __cplusplus
 }
 #endif
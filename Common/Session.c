@@ -0,0 +1,153 @@
+﻿/**
+ *	@brief		Implements the session context
+ *	@details	The session bound to a thread is kept in a thread local variable.
+ *	@file		Session.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Session.h"
+#include "Logging.h"
+
+/// Default session used by threads without a bound session
+static IfxSession s_sDefaultSession;
+
+/// Scratch area of the default session
+static IfxSessionScratch s_sDefaultScratch;
+
+/// Session bound to the calling thread (NULL for the default session)
+static _Thread_local IfxSession* s_pCurrentSession = NULL;
+
+/**
+ *	@brief		Returns the session of the calling thread
+ *	@details	Returns the default session if no session is bound to the calling thread.
+ *
+ *	@returns	The session of the calling thread, never NULL.
+ */
+IfxSession*
+Session_GetCurrent()
+{
+	return NULL != s_pCurrentSession ? s_pCurrentSession : &s_sDefaultSession;
+}
+
+/**
+ *	@brief		Returns the scratch area of the session of the calling thread
+ *	@details	The buffers of the scratch area must not be used across calls which may use them too, e.g. a log message
+ *				must be handed over to the logging before the next message is formatted.
+ *
+ *	@returns	The scratch area of the session of the calling thread, never NULL.
+ */
+IfxSessionScratch*
+Session_GetScratch()
+{
+	return NULL != s_pCurrentSession ? s_pCurrentSession->pScratch : &s_sDefaultScratch;
+}
+
+/**
+ *	@brief		Binds a session to the calling thread
+ *	@details	The modules called by the thread work on the bound session from now on.
+ *
+ *	@param		PpSession		Session to bind, NULL to bind the default session
+ *	@returns	The session bound before, NULL for the default session.
+ */
+IfxSession*
+Session_SetCurrent(
+	_In_opt_	IfxSession*		PpSession)
+{
+	IfxSession* pPreviousSession = s_pCurrentSession;
+
+	s_pCurrentSession = &s_sDefaultSession == PpSession ? NULL : PpSession;
+
+	return pPreviousSession;
+}
+
+/**
+ *	@brief		Creates an empty session
+ *	@details	Allocates the scratch area of the session.
+ *
+ *	@param		PppSession				Receives the session, must be released with Session_Release
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL				The memory allocation failed.
+ */
+_Check_return_
+unsigned int
+Session_Create(
+	_Outptr_result_maybenull_	IfxSession**	PppSession)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Check parameters
+		if (NULL == PppSession)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter PppSession is NULL.");
+			break;
+		}
+
+		*PppSession = (IfxSession*)Platform_MemoryAllocateZero(sizeof(IfxSession));
+		if (NULL == *PppSession)
+		{
+			ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+			break;
+		}
+
+		// The heap only guarantees PLATFORM_MEMORY_ALIGNMENT, the scratch area is aligned within a larger block
+		(*PppSession)->pvScratchMemory = Platform_MemoryAllocateZero(sizeof(IfxSessionScratch) + SESSION_SCRATCH_ALIGNMENT);
+		if (NULL == (*PppSession)->pvScratchMemory)
+		{
+			Platform_MemoryFree((void**)PppSession);
+			ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+			break;
+		}
+		(*PppSession)->pScratch = (IfxSessionScratch*)(((uintptr_t)(*PppSession)->pvScratchMemory + SESSION_SCRATCH_ALIGNMENT - 1) & ~(uintptr_t)(SESSION_SCRATCH_ALIGNMENT - 1));
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Releases a session created by Session_Create
+ *	@details	Closes the log sink and clears the property storage and the error stack of the session. The TPM must have
+ *				been disconnected before. The session must not be bound to any thread.
+ *
+ *	@param		PppSession		Pointer to the session. Set to NULL on return.
+ */
+void
+Session_Release(
+	_Inout_ IfxSession** PppSession)
+{
+	IfxSession* pPreviousSession = NULL;
+
+	if (NULL == PppSession || NULL == *PppSession)
+		return;
+
+	// Clear the session while it is bound to the calling thread
+	pPreviousSession = Session_SetCurrent(*PppSession);
+	Logging_CloseSessionSink();
+	Error_ClearStack();
+	PropertyStorage_ClearElements();
+	IGNORE_RETURN_VALUE(Session_SetCurrent(pPreviousSession));
+
+	// The cached logging level follows the property storage of the bound session again
+	Logging_UpdateLevel();
+
+	Platform_MemoryFree(&(*PppSession)->pvScratchMemory);
+	Platform_MemoryFree((void**)PppSession);
+}
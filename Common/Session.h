@@ -0,0 +1,187 @@
+﻿/**
+ *	@brief		Declares the session context
+ *	@details	A session holds the state of the property storage, the error stack, the logging recursion guard and sink, the
+ *				TPM connection, the last TPM command and the scratch area of the TPM commands and the logging which used to be
+ *				process-global. The modules work on the session bound to the calling
+ *				thread, a thread without a bound session works on the default session. This keeps the existing module
+ *				APIs unchanged and allows several TPM devices to be processed by threads with a session each.
+ *	@file		Session.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+#include "Error.h"
+#include "PropertyStorage.h"
+#include "Logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Size of the buffers holding the last TPM request and response for error logging
+#define SESSION_LAST_COMMAND_SIZE	4096
+/// Size of the request and response buffers of the TPM command wrappers
+#define SESSION_COMMAND_BUFFER_SIZE	4096
+/// Alignment of the scratch area of a session (one cache line)
+#define SESSION_SCRATCH_ALIGNMENT	64
+
+/**
+ *	@brief		Scratch area of a session
+ *	@details	Holds the large buffers of the TPM command wrappers and of the logging, so they are not placed on the stack
+ *				of the thread processing the session. Each buffer starts on a cache line of its own, so the scratch areas
+ *				of threads processing different sessions do not share cache lines.
+ */
+typedef struct tdIfxSessionScratch
+{
+	/// Request buffer of the TPM command wrappers (see TSS_Command.c)
+	_Alignas(SESSION_SCRATCH_ALIGNMENT) BYTE		rgbCommandRequest[SESSION_COMMAND_BUFFER_SIZE];
+	/// Response buffer of the TPM command wrappers
+	_Alignas(SESSION_SCRATCH_ALIGNMENT) BYTE		rgbCommandResponse[SESSION_COMMAND_BUFFER_SIZE];
+	/// Buffer formatting a log message (see Logging_WriteLog)
+	_Alignas(SESSION_SCRATCH_ALIGNMENT) wchar_t	wszLogMessage[MAX_MESSAGE_SIZE];
+	/// Buffer formatting the messages of a logged error (see Error_LogErrorData)
+	_Alignas(SESSION_SCRATCH_ALIGNMENT) wchar_t	wszErrorMessage[MAX_MESSAGE_SIZE];
+} IfxSessionScratch;
+
+/// Register access functions of a device access backend (declared in DeviceAccess.h)
+struct tdIfxDeviceAccessOps;
+
+/**
+ *	@brief		Session context
+ *	@details	Initialized with zeros. Must only be used by one thread at a time, except for reading a frozen property
+ *				storage (see PropertyStorage_Freeze).
+ */
+typedef struct tdIfxSession
+{
+	/// Hash table of the property elements
+	IfxPropertySlot*		pPropertySlots;
+	/// Number of slots of the hash table (0 or a power of two)
+	unsigned int			unPropertySlotCount;
+	/// Number of elements stored in the hash table
+	unsigned int			unPropertyElementCount;
+	/// Last allocated block of the property arena
+	IfxPropertyArenaBlock*	pPropertyArena;
+	/// Elements of the built-in properties indexed by their identifier
+	IfxPropertyElement*		rgpPropertyIdElements[PROPERTY_ID_COUNT];
+	/// Frozen table read by all threads (NULL if the property storage has not been frozen)
+	IfxPropertyFrozenTable*	pPropertyFrozen;
+	/// Frozen tables replaced by a write and not yet released
+	IfxPropertyFrozenTable*	pPropertyRetired;
+	/// Number of reads of the property storage in progress
+	unsigned int			unPropertyReaders;
+	/// Top of the error stack
+	IfxErrorData*			pErrorData;
+	/// Pre-allocated error records
+	IfxErrorData			rgErrorPool[ERROR_POOL_SIZE];
+	/// Flag to prevent recursive logging
+	BOOL					fInLogging;
+	/// Log sink of the session, NULL for the default sink
+	IfxLoggingSink*			pLogSink;
+	/// Upper limit of the logging level of the messages logged by this session (LOGGING_DISABLED for no limit)
+	unsigned int			unLoggingLevelLimit;
+	/// Flag if the TPM I/O layer is connected
+	BOOL					fTpmIoConnected;
+	/// Lock of the TPM device held while the TPM I/O layer is connected (NULL if not locked)
+	void*					pvDeviceLock;
+	/// File handle of the physical memory device for memory based access, or the socket connected to TPMMemoryHelper
+	UINT32					unMemoryFileHandle;
+	/// Mapped TPM memory for memory based access
+	BYTE*					pbMemory;
+	/// Physical address of the locality 0 registers of the mapped TPM memory (0 if not mapped)
+	unsigned long long		ullMemoryBase;
+	/// Offset of the mapped locality registers from the locality 0 registers
+	unsigned int			unMemoryOffset;
+	/// TPM interface given by the ACPI TPM2 table (DEVICE_ACCESS_INTERFACE_*)
+	BYTE					bMemoryInterface;
+	/// Register access functions of the initialized device access backend (NULL if none is bound)
+	const struct tdIfxDeviceAccessOps*	pRegisterOps;
+	/// Flag if the TPM registers are accessed through an SPI device instead of the mapped TPM memory
+	BOOL					fSpiAccess;
+	/// File handle of the SPI device for the SPI access mode (valid if fSpiAccess is set)
+	int						nSpiFileHandle;
+	/// Flag if the interrupt line of the TPM is opened for memory based access
+	BOOL					fInterruptOpen;
+	/// File handle of the UIO device delivering the TPM interrupts (valid if fInterruptOpen is set)
+	int						nInterruptFileHandle;
+	/// Last TPM request. Only copied in troubleshooting mode, at logging level 3 and above, if it is recorded to a
+	/// capture file or if the transport needs a contiguous request.
+	BYTE					rgbLastRequest[SESSION_LAST_COMMAND_SIZE];
+	/// Size of the last TPM request
+	unsigned int			unLastRequestSize;
+	/// Last TPM response (only in troubleshooting mode and at logging level 3 and above)
+	BYTE					rgbLastResponse[SESSION_LAST_COMMAND_SIZE];
+	/// Size of the last TPM response
+	unsigned int			unLastResponseSize;
+	/// Scratch area, aligned to SESSION_SCRATCH_ALIGNMENT within pvScratchMemory (not used by the default session)
+	IfxSessionScratch*		pScratch;
+	/// Memory block holding the scratch area
+	void*					pvScratchMemory;
+} IfxSession;
+
+/**
+ *	@brief		Returns the session of the calling thread
+ *	@details	Returns the default session if no session is bound to the calling thread.
+ *
+ *	@returns	The session of the calling thread, never NULL.
+ */
+IfxSession*
+Session_GetCurrent();
+
+/**
+ *	@brief		Returns the scratch area of the session of the calling thread
+ *	@details	The buffers of the scratch area must not be used across calls which may use them too, e.g. a log message
+ *				must be handed over to the logging before the next message is formatted.
+ *
+ *	@returns	The scratch area of the session of the calling thread, never NULL.
+ */
+IfxSessionScratch*
+Session_GetScratch();
+
+/**
+ *	@brief		Binds a session to the calling thread
+ *	@details	The modules called by the thread work on the bound session from now on.
+ *
+ *	@param		PpSession		Session to bind, NULL to bind the default session
+ *	@returns	The session bound before, NULL for the default session.
+ */
+IfxSession*
+Session_SetCurrent(
+	_In_opt_	IfxSession*		PpSession);
+
+/**
+ *	@brief		Creates an empty session
+ *	@details	Allocates the scratch area of the session.
+ *
+ *	@param		PppSession				Receives the session, must be released with Session_Release
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL				The memory allocation failed.
+ */
+_Check_return_
+unsigned int
+Session_Create(
+	_Outptr_result_maybenull_	IfxSession**	PppSession);
+
+/**
+ *	@brief		Releases a session created by Session_Create
+ *	@details	Clears the property storage and the error stack of the session. The TPM must have been disconnected
+ *				before. The session must not be bound to any thread.
+ *
+ *	@param		PppSession		Pointer to the session. Set to NULL on return.
+ */
+void
+Session_Release(
+	_Inout_ IfxSession** PppSession);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,9 +15,60 @@
 
 #include "StdInclude.h"
 
+/// Size of the register page of one locality
+#define DEVICE_ACCESS_LOCALITY_SIZE			0x1000U
+/// Highest TPM locality
+#define DEVICE_ACCESS_MAX_LOCALITY			4
+/// The interface of the TPM registers is unknown and is read from the interface identifier register
+#define DEVICE_ACCESS_INTERFACE_UNKNOWN		0
+/// TIS FIFO interface
+#define DEVICE_ACCESS_INTERFACE_FIFO		1
+/// CRB interface
+#define DEVICE_ACCESS_INTERFACE_CRB			2
+/// Interface with a start method that cannot be used for memory based access
+#define DEVICE_ACCESS_INTERFACE_UNSUPPORTED	3
+
+/// Register access functions of a device access backend (mapped memory, SPI device or TIS register file simulator).
+/// The backend binds its table to the session when it is initialized, the register accessors then make a single
+/// indirect call. Register addresses are relative to TPM_DEFAULT_MEM_BASE and lie within the locality registers.
+typedef struct tdIfxDeviceAccessOps
+{
+	/// Reads a register of up to 32 bits, returns FALSE if the access is invalid
+	BOOL (*fpReadRegister)(unsigned int PunMemoryAddress, unsigned int PunSize, unsigned int* PpunValue);
+	/// Writes a register of up to 32 bits, returns FALSE if the access is invalid
+	BOOL (*fpWriteRegister)(unsigned int PunMemoryAddress, unsigned int PunData, unsigned int PunSize);
+	/// Reads or writes consecutive registers (PfFifo FALSE) or one FIFO register with accesses of up to PbAccessSize bytes
+	unsigned int (*fpTransfer)(unsigned int PunMemoryAddress, BYTE* PrgbData, unsigned int PunSize, BYTE PbAccessSize, BOOL PfRead, BOOL PfFifo);
+} IfxDeviceAccessOps;
+
+/**
+ *	@brief		Bind the register access functions of a device access backend to the current session
+ *
+ *	@param		PpOps		Register access functions, NULL when the backend is uninitialized
+ */
+void
+DeviceAccess_BindRegisters(
+	_In_opt_	const IfxDeviceAccessOps*	PpOps);
+
+/**
+ *	@brief		Check whether a register range lies within the locality registers of the bound backend
+ *
+ *	@param		PunMemoryAddress	Start address of the range (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the range in bytes
+ *	@param		PpunOffset			Receives the offset of the range within the locality registers
+ *	@retval		TRUE				The range lies within the locality registers.
+ *	@retval		FALSE				Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccess_GetWindowOffset(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunOffset);
+
 /**
  *	@brief		Initialize the device access
- *	@details
+ *	@details	Maps the register page of the given locality only.
  *
  *	@param		PbLocality		Locality value
  *	@retval		RC_SUCCESS		The operation completed successfully.
@@ -39,6 +90,41 @@ unsigned int
 DeviceAccess_Uninitialize(
 	_In_	BYTE	PbLocality);
 
+/**
+ *	@brief		Get the physical address of the TPM register window
+ *	@details	The TIS and CRB register addresses are relative to TPM_DEFAULT_MEM_BASE and are translated by the device
+ *				access routines. Physical addresses reported by the TPM (e.g. the CRB buffers) must be translated with
+ *				this base.
+ *
+ *	@returns	Physical address of the mapped TPM memory, TPM_DEFAULT_MEM_BASE if no memory is mapped
+ */
+_Check_return_
+unsigned long long
+DeviceAccess_GetMemoryBase();
+
+/**
+ *	@brief		Get the TPM interface given by the ACPI TPM2 table
+ *
+ *	@returns	DEVICE_ACCESS_INTERFACE_FIFO, DEVICE_ACCESS_INTERFACE_CRB or DEVICE_ACCESS_INTERFACE_UNKNOWN
+ */
+_Check_return_
+BYTE
+DeviceAccess_GetInterfaceType();
+
+/**
+ *	@brief		Check whether a memory range is mapped
+ *
+ *	@param		PunMemoryAddress	Start address of the memory range (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the memory range in bytes
+ *	@retval		TRUE				The range lies within the mapped locality registers.
+ *	@retval		FALSE				Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccess_IsMapped(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize);
+
 /**
  *	@brief		Read a Byte from the specified memory address
  *	@details
@@ -86,3 +172,157 @@ void
 DeviceAccess_WriteWord(
 	_In_	unsigned int	PunMemoryAddress,
 	_In_	unsigned short	PusData);
+
+/**
+ *	@brief		Read a Double Word from the specified memory address
+ *	@details	The value is read with a single 32-bit access. The memory address must be 32-bit aligned.
+ *
+ *	@param		PunMemoryAddress	Memory address
+ *	@returns	Data value read from specified memory
+ */
+_Check_return_
+unsigned int
+DeviceAccess_ReadDWord(
+	_In_	unsigned int	PunMemoryAddress);
+
+/**
+ *	@brief		Write a Double Word to the specified memory address
+ *	@details	The value is written with a single 32-bit access. The memory address must be 32-bit aligned.
+ *
+ *	@param		PunMemoryAddress	Memory address
+ *	@param		PunData				Data to be written
+ */
+void
+DeviceAccess_WriteDWord(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData);
+
+/**
+ *	@brief		Copy a block of data to a memory range starting at the specified memory address
+ *	@details	In contrast to DeviceAccess_WriteBlock the data is written to consecutive memory addresses with a
+ *				single memory copy, e.g. into the command buffer of a CRB interface.
+ *
+ *	@param		PunMemoryAddress	Start address of the memory range
+ *	@param		PrgbData			Data to be written
+ *	@param		PunSize				Number of bytes to be written
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from Platform_MemoryCopy function
+ */
+_Check_return_
+unsigned int
+DeviceAccess_CopyToMemory(
+	_In_						unsigned int	PunMemoryAddress,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbData,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Copy a block of data from a memory range starting at the specified memory address
+ *	@details	In contrast to DeviceAccess_ReadBlock the data is read from consecutive memory addresses with a
+ *				single memory copy, e.g. from the response buffer of a CRB interface.
+ *
+ *	@param		PunMemoryAddress	Start address of the memory range
+ *	@param		PrgbData			Buffer for the read data
+ *	@param		PunSize				Number of bytes to be read
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from Platform_MemoryCopy function
+ */
+_Check_return_
+unsigned int
+DeviceAccess_CopyFromMemory(
+	_In_						unsigned int	PunMemoryAddress,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbData,
+	_In_						unsigned int	PunSize);
+
+/**
+ *	@brief		Write a block of data to a FIFO register at the specified memory address
+ *	@details	All bytes are written to the same memory address. If PbAccessSize is sizeof(UINT32) or
+ *				sizeof(UINT16) the data is written with accesses of that width as long as enough bytes are left, the
+ *				remaining bytes are written with single byte accesses.
+ *
+ *	@param		PunMemoryAddress	Memory address of the FIFO register
+ *	@param		PrgbData			Data to be written
+ *	@param		PunSize				Number of bytes to be written
+ *	@param		PbAccessSize		Maximum width of a single register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_WriteBlock(
+	_In_						unsigned int	PunMemoryAddress,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize);
+
+/**
+ *	@brief		Read a block of data from a FIFO register at the specified memory address
+ *	@details	All bytes are read from the same memory address. If PbAccessSize is sizeof(UINT32) or
+ *				sizeof(UINT16) the data is read with accesses of that width as long as enough bytes are left, the
+ *				remaining bytes are read with single byte accesses.
+ *
+ *	@param		PunMemoryAddress	Memory address of the FIFO register
+ *	@param		PrgbData			Buffer for the read data
+ *	@param		PunSize				Number of bytes to be read
+ *	@param		PbAccessSize		Maximum width of a single register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_ReadBlock(
+	_In_						unsigned int	PunMemoryAddress,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize);
+
+/**
+ *	@brief		Open the interrupt line of the TPM
+ *	@details	Opens a UIO device (e.g. /dev/uio0 of the uio_pdrv_genirq driver bound to the TPM interrupt). Each read
+ *				of the device returns the number of interrupts so far, writing 1 unmasks the interrupt again.
+ *
+ *	@param		PwszDevicePath			Path of the UIO device
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_TPM_ACCESS_DENIED	Read-write access to the UIO device was denied.
+ *	@retval		RC_E_INVALID_SETTING	The device path is invalid or the device cannot be opened or unmasked.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_OpenInterrupt(
+	_In_z_	const wchar_t*	PwszDevicePath);
+
+/**
+ *	@brief		Close the interrupt line opened by DeviceAccess_OpenInterrupt
+ */
+void
+DeviceAccess_CloseInterrupt();
+
+/**
+ *	@brief		Check whether the interrupt line of the TPM is opened
+ *
+ *	@retval		TRUE	DeviceAccess_OpenInterrupt opened the interrupt line.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccess_IsInterruptOpen();
+
+/**
+ *	@brief		Wait for an interrupt of the TPM
+ *	@details	Unmasks the interrupt and sleeps until the TPM raises it or the timeout elapses. The TPM keeps a
+ *				level-triggered interrupt asserted until its interrupt status is cleared, which must happen before
+ *				the next wait.
+ *
+ *	@param		PunMicroSeconds		Longest time to wait in microseconds
+ *	@param		PpfSignaled			Receives TRUE if the TPM raised the interrupt, FALSE on a timeout
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_READY		The interrupt line is not opened.
+ *	@retval		RC_E_INTERNAL		Waiting on the interrupt line failed.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_WaitInterrupt(
+	_In_	UINT32	PunMicroSeconds,
+	_Out_	BOOL*	PpfSignaled);
@@ -14,54 +14,1085 @@
  */
 
 #include "StdInclude.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "DeviceAccess.h"
 #include "Logging.h"
 #include "Platform.h"
-
-static UINT32 s_unFileHandle = 0;
-static BYTE *s_bMemPtr = NULL;
+#include "Session.h"
+#include "PropertyStorage.h"
+#include "TPM_CRB.h"
+#include "DeviceAccessSpi.h"
+#include "TpmTisSimulator.h"
 
 #define DEV_TPM_MEM "/dev/mem"
+/// Default Unix socket of TPMMemoryHelper, which accesses the TPM registers for unprivileged processes
+#define DEVICE_ACCESS_MEMORY_HELPER					"/run/TPMMemoryHelper.sock"
+/// TPMMemoryHelper status: the page is mapped or the register access was done
+#define DEVICE_ACCESS_MEMORY_HELPER_GRANTED			0
+/// TPMMemoryHelper request: read a register of 1, 2 or 4 bytes
+#define DEVICE_ACCESS_MEMORY_HELPER_READ_REGISTER	1
+/// TPMMemoryHelper request: write a register of 1, 2 or 4 bytes
+#define DEVICE_ACCESS_MEMORY_HELPER_WRITE_REGISTER	2
+/// TPMMemoryHelper request: read consecutive registers or a FIFO register
+#define DEVICE_ACCESS_MEMORY_HELPER_READ_BLOCK		3
+/// TPMMemoryHelper request: write consecutive registers or a FIFO register
+#define DEVICE_ACCESS_MEMORY_HELPER_WRITE_BLOCK		4
+/// Size of a TPMMemoryHelper register request
+#define DEVICE_ACCESS_MEMORY_HELPER_REQUEST_SIZE	8
+/// Seconds to wait for the answer of TPMMemoryHelper
+#define DEVICE_ACCESS_MEMORY_HELPER_TIMEOUT			5
+/// Physical memory ranges of the platform devices, lists the TPM register window found through ACPI or device tree
+#define PROC_IOMEM "/proc/iomem"
+/// ACPI TPM2 table exported by the kernel
+#define ACPI_TPM2_TABLE "/sys/firmware/acpi/tables/TPM2"
+/// Size of the ACPI TPM2 table up to the start method (ACPI header, platform class, control area address, start method)
+#define ACPI_TPM2_MIN_SIZE				52
+/// Offset of the 64-bit control area address in the ACPI TPM2 table
+#define ACPI_TPM2_CONTROL_AREA_OFFSET	40
+/// Offset of the 32-bit start method in the ACPI TPM2 table
+#define ACPI_TPM2_START_METHOD_OFFSET	48
+/// ACPI TPM2 start method of the TIS FIFO interface ("Memory mapped I/O")
+#define ACPI_TPM2_START_METHOD_TIS		6
+/// ACPI TPM2 start method of the CRB interface
+#define ACPI_TPM2_START_METHOD_CRB		7
+
+// Barriers around the accesses to the TPM registers like the kernel readl/writel: a write is ordered after the preceding
+// accesses to normal memory, a read before the following ones. The registers of one device are mapped as device memory
+// (uncached on x86), so the accesses to them are not reordered among each other.
+#if defined(__aarch64__)
+#define DEVICE_ACCESS_WRITE_BARRIER()	__asm__ __volatile__("dsb st" ::: "memory")
+#define DEVICE_ACCESS_READ_BARRIER()	__asm__ __volatile__("dsb ld" ::: "memory")
+#elif defined(__arm__)
+#define DEVICE_ACCESS_WRITE_BARRIER()	__sync_synchronize()
+#define DEVICE_ACCESS_READ_BARRIER()	__sync_synchronize()
+#else
+#define DEVICE_ACCESS_WRITE_BARRIER()	__asm__ __volatile__("" ::: "memory")
+#define DEVICE_ACCESS_READ_BARRIER()	__asm__ __volatile__("" ::: "memory")
+#endif
+
+// Only x86 supports unaligned accesses to device memory
+#if defined(__x86_64__) || defined(__i386__)
+#define DEVICE_ACCESS_UNALIGNED_SUPPORTED
+#endif
+
+/**
+ *	@brief		Scan the physical memory ranges of the platform devices
+ *	@details	ACPI enumerates the TPM as MSFT0101 (TPM 2.0) or PNP0C31/IFX0102 (TPM 1.2), the device tree as a node
+ *				named tpm (e.g. "fed40000.tpm"). Both end up as a named range in /proc/iomem.
+ *
+ *	@param		PullAddress			Physical address checked against the System RAM ranges
+ *	@param		PpullTpmBase		Receives the start of the first TPM range (0 if none is listed)
+ *	@param		PpfSystemRam		Receives TRUE if PullAddress lies within System RAM
+ *	@retval		TRUE				The ranges were read.
+ *	@retval		FALSE				/proc/iomem is not readable or shows no addresses (without CAP_SYS_ADMIN).
+ */
+_Check_return_
+static BOOL
+DeviceAccess_ScanIomem(
+	_In_	unsigned long long		PullAddress,
+	_Out_	unsigned long long*		PpullTpmBase,
+	_Out_	BOOL*					PpfSystemRam)
+{
+	BOOL fAddresses = FALSE;
+	char szLine[256] = {0};
+	FILE* pFile = fopen(PROC_IOMEM, "r");
+
+	*PpullTpmBase = 0;
+	*PpfSystemRam = FALSE;
+	if (NULL == pFile)
+		return FALSE;
+
+	while (NULL != fgets(szLine, sizeof(szLine), pFile))
+	{
+		unsigned long long ullStart = 0, ullEnd = 0;
+		int nNameOffset = 0;
+		const char* szName = NULL;
+
+		if (2 != sscanf(szLine, " %llx-%llx : %n", &ullStart, &ullEnd, &nNameOffset) || 0 == nNameOffset)
+			continue;
+		szName = &szLine[nNameOffset];
+		// Without CAP_SYS_ADMIN all ranges read as zero
+		if (0 == ullStart)
+			continue;
+		fAddresses = TRUE;
+
+		if (0 == *PpullTpmBase && (NULL != strstr(szName, "MSFT0101") || NULL != strstr(szName, "PNP0C31") ||
+				NULL != strstr(szName, "IFX0102") || NULL != strstr(szName, "tpm")))
+			*PpullTpmBase = ullStart;
+		if (0 == strncmp(szName, "System RAM", sizeof("System RAM") - 1) && PullAddress >= ullStart && PullAddress <= ullEnd)
+			*PpfSystemRam = TRUE;
+	}
+	fclose(pFile);
+
+	return fAddresses;
+}
+
+/**
+ *	@brief		Read the TPM interface and register window from the ACPI TPM2 table
+ *	@details	The table contains the address of the CRB control area (at CRB_CTRL_REQ of the locality 0 registers) and
+ *				the start method: 6 is the TIS FIFO interface, 7 the CRB interface started through CRB_CTRL_START.
+ *				The CRB start methods through ACPI (2, 8) or an ARM SMC (11) cannot be driven from user space.
+ *				FIFO tables usually leave the address 0.
+ *
+ *	@param		PpullMemoryBase		Receives the physical address of the locality 0 registers (0 if not given)
+ *	@param		PpbInterface		Receives the DEVICE_ACCESS_INTERFACE_* value
+ *	@retval		TRUE				The table was read.
+ *	@retval		FALSE				There is no readable TPM2 table (e.g. TPM 1.2 or device tree platforms).
+ */
+_Check_return_
+static BOOL
+DeviceAccess_ReadAcpiTpm2Table(
+	_Out_	unsigned long long*		PpullMemoryBase,
+	_Out_	BYTE*					PpbInterface)
+{
+	BYTE rgbTable[ACPI_TPM2_MIN_SIZE] = {0};
+	unsigned long long ullControlArea = 0;
+	UINT32 unStartMethod = 0;
+	size_t nRead = 0;
+	unsigned int unIndex = 0;
+	FILE* pFile = fopen(ACPI_TPM2_TABLE, "rb");
+
+	*PpullMemoryBase = 0;
+	*PpbInterface = DEVICE_ACCESS_INTERFACE_UNKNOWN;
+	if (NULL == pFile)
+		return FALSE;
+	nRead = fread(rgbTable, 1, sizeof(rgbTable), pFile);
+	fclose(pFile);
+	if (sizeof(rgbTable) != nRead || 0 != memcmp(rgbTable, "TPM2", 4))
+		return FALSE;
+
+	// ACPI tables are little endian
+	for (unIndex = 0; unIndex < sizeof(ullControlArea); unIndex++)
+		ullControlArea |= (unsigned long long)rgbTable[ACPI_TPM2_CONTROL_AREA_OFFSET + unIndex] << (8 * unIndex);
+	for (unIndex = 0; unIndex < sizeof(UINT32); unIndex++)
+		unStartMethod |= (UINT32)rgbTable[ACPI_TPM2_START_METHOD_OFFSET + unIndex] << (8 * unIndex);
+	LOGGING_WRITE_LEVEL4_FMT(L"ACPI TPM2 table: start method %u, control area 0x%llX", unStartMethod, ullControlArea);
+
+	switch (unStartMethod)
+	{
+		case ACPI_TPM2_START_METHOD_TIS:
+			*PpbInterface = DEVICE_ACCESS_INTERFACE_FIFO;
+			*PpullMemoryBase = ullControlArea & ~(unsigned long long)(DEVICE_ACCESS_LOCALITY_SIZE - 1);
+			break;
+		case ACPI_TPM2_START_METHOD_CRB:
+			*PpbInterface = DEVICE_ACCESS_INTERFACE_CRB;
+			if (ullControlArea >= CRB_CTRL_REQ)
+				*PpullMemoryBase = (ullControlArea - CRB_CTRL_REQ) & ~(unsigned long long)(DEVICE_ACCESS_LOCALITY_SIZE - 1);
+			break;
+		default:
+			*PpbInterface = DEVICE_ACCESS_INTERFACE_UNSUPPORTED;
+			break;
+	}
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Get the physical address and interface of the TPM register window
+ *	@details	PROPERTY_TPM_MEMORY_BASE (MEMORY_BASE of the [TPM_DEVICE_ACCESS] section) takes precedence. "auto" or
+ *				an empty value use the ACPI TPM2 table, then the TPM range listed in /proc/iomem. Without either x86
+ *				uses the fixed PC Client address TPM_DEFAULT_MEM_BASE, other architectures have no fixed address.
+ *
+ *	@param		PpullMemoryBase			Receives the physical address of the locality 0 registers
+ *	@param		PpbInterface			Receives the DEVICE_ACCESS_INTERFACE_* value of the ACPI TPM2 table
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	MEMORY_BASE is not a 4 KiB aligned hexadecimal address.
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The TPM register window is unknown or its start method is not supported.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_GetPhysicalMemoryBase(
+	_Out_	unsigned long long*		PpullMemoryBase,
+	_Out_	BYTE*					PpbInterface)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	wchar_t wszValue[MAX_NAME] = {0};
+	unsigned int unValueSize = RG_LEN(wszValue);
+
+	do
+	{
+		BOOL fSystemRam = FALSE;
+		*PpullMemoryBase = 0;
+		*PpbInterface = DEVICE_ACCESS_INTERFACE_UNKNOWN;
+
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_MEMORY_BASE, wszValue, &unValueSize) &&
+				0 != unValueSize && 0 != Platform_StringCompare(wszValue, L"auto", RG_LEN(L"auto"), FALSE))
+		{
+			wchar_t* pwszEnd = NULL;
+			*PpullMemoryBase = wcstoull(wszValue, &pwszEnd, 16);
+			if (NULL == pwszEnd || L'\0' != *pwszEnd || 0 == *PpullMemoryBase ||
+					0 != (*PpullMemoryBase & (DEVICE_ACCESS_LOCALITY_SIZE - 1)))
+			{
+				unReturnValue = RC_E_INVALID_SETTING;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: The TPM memory base '%ls' is not a 4 KiB aligned hexadecimal address.", wszValue);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"Using the configured TPM memory base 0x%llX", *PpullMemoryBase);
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		if (DeviceAccess_ReadAcpiTpm2Table(PpullMemoryBase, PpbInterface))
+		{
+			if (DEVICE_ACCESS_INTERFACE_UNSUPPORTED == *PpbInterface)
+			{
+				unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+				LOGGING_WRITE_LEVEL1(L"Error: The start method of the ACPI TPM2 table does not support memory based access.");
+				break;
+			}
+			if (0 != *PpullMemoryBase)
+			{
+				LOGGING_WRITE_LEVEL4_FMT(L"Using the TPM memory base 0x%llX of the ACPI TPM2 table", *PpullMemoryBase);
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+		}
+
+		if (DeviceAccess_ScanIomem(0, PpullMemoryBase, &fSystemRam) && 0 != *PpullMemoryBase)
+		{
+			LOGGING_WRITE_LEVEL4_FMT(L"Using the TPM memory base 0x%llX listed in %s", *PpullMemoryBase, PROC_IOMEM);
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+#if defined(__x86_64__) || defined(__i386__)
+		*PpullMemoryBase = TPM_DEFAULT_MEM_BASE;
+		LOGGING_WRITE_LEVEL4_FMT(L"Using the default TPM memory base 0x%llX", *PpullMemoryBase);
+		unReturnValue = RC_SUCCESS;
+#else
+		unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: No TPM register window is listed in %s, set MEMORY_BASE in the [TPM_DEVICE_ACCESS] section.", PROC_IOMEM);
+#endif
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Check whether a register range lies within the locality registers of the bound backend
+ *
+ *	@param		PunMemoryAddress	Start address of the range (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the range in bytes
+ *	@param		PpunOffset			Receives the offset of the range within the locality registers
+ *	@retval		TRUE				The range lies within the locality registers.
+ *	@retval		FALSE				Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccess_GetWindowOffset(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunOffset)
+{
+	unsigned int unWindow = TPM_DEFAULT_MEM_BASE + Session_GetCurrent()->unMemoryOffset;
+
+	*PpunOffset = 0;
+	if (PunMemoryAddress < unWindow || PunSize > DEVICE_ACCESS_LOCALITY_SIZE || PunMemoryAddress - unWindow > DEVICE_ACCESS_LOCALITY_SIZE - PunSize)
+		return FALSE;
+
+	*PpunOffset = PunMemoryAddress - unWindow;
+	return TRUE;
+}
+
+/**
+ *	@brief		Get the mapped address of a register
+ *	@details	Only the registers of the locality passed to DeviceAccess_Initialize are mapped.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the access in bytes
+ *	@returns	Mapped register address, NULL if the access is outside the mapped locality
+ */
+_Check_return_
+static volatile BYTE*
+DeviceAccess_GetRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize)
+{
+	BYTE* pbMemory = Session_GetCurrent()->pbMemory;
+	unsigned int unOffset = 0;
+
+	if (NULL == pbMemory || !DeviceAccess_GetWindowOffset(PunMemoryAddress, PunSize, &unOffset))
+		return NULL;
+
+	return &pbMemory[unOffset];
+}
+
+/**
+ *	@brief		Read a 16-bit register
+ *
+ *	@param		PpbRegister		Mapped register address
+ *	@returns	Register value
+ */
+static UINT16
+DeviceAccess_ReadRegister16(
+	_In_	volatile BYTE*	PpbRegister)
+{
+	UINT16 usValue = 0;
+#ifndef DEVICE_ACCESS_UNALIGNED_SUPPORTED
+	if (0 != ((uintptr_t)PpbRegister & (sizeof(UINT16) - 1)))
+		usValue = (UINT16)(PpbRegister[0] | (PpbRegister[1] << 8));
+	else
+#endif
+		usValue = *(volatile UINT16*)PpbRegister;
+	DEVICE_ACCESS_READ_BARRIER();
+	return usValue;
+}
+
+/**
+ *	@brief		Write a 16-bit register
+ *
+ *	@param		PpbRegister		Mapped register address
+ *	@param		PusValue		Register value
+ */
+static void
+DeviceAccess_WriteRegister16(
+	_In_	volatile BYTE*	PpbRegister,
+	_In_	UINT16			PusValue)
+{
+	DEVICE_ACCESS_WRITE_BARRIER();
+#ifndef DEVICE_ACCESS_UNALIGNED_SUPPORTED
+	if (0 != ((uintptr_t)PpbRegister & (sizeof(UINT16) - 1)))
+	{
+		PpbRegister[0] = (BYTE)PusValue;
+		PpbRegister[1] = (BYTE)(PusValue >> 8);
+		return;
+	}
+#endif
+	*(volatile UINT16*)PpbRegister = PusValue;
+}
+
+/**
+ *	@brief		Copy data between device memory and normal memory
+ *	@details	memcpy must not be used on device memory, it may use unaligned or cache maintenance instructions which
+ *				fault on ARM. The device memory is accessed with aligned 32-bit accesses where possible.
+ *
+ *	@param		PpbDevice		Mapped device memory
+ *	@param		PrgbData		Buffer in normal memory
+ *	@param		PunSize			Number of bytes to copy
+ *	@param		PfToDevice		TRUE copies to the device memory, FALSE from it
+ */
+static void
+DeviceAccess_CopyDeviceMemory(
+	_Inout_bytecap_(PunSize)	volatile BYTE*	PpbDevice,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_							unsigned int	PunSize,
+	_In_							BOOL			PfToDevice)
+{
+	unsigned int unPosition = 0;
+
+	if (PfToDevice)
+		DEVICE_ACCESS_WRITE_BARRIER();
+
+	// Leading bytes up to the first aligned address
+	for (; unPosition < PunSize && 0 != ((uintptr_t)&PpbDevice[unPosition] & (sizeof(UINT32) - 1)); unPosition++)
+	{
+		if (PfToDevice)
+			PpbDevice[unPosition] = PrgbData[unPosition];
+		else
+			PrgbData[unPosition] = PpbDevice[unPosition];
+	}
+	for (; PunSize - unPosition >= sizeof(UINT32); unPosition += sizeof(UINT32))
+	{
+		UINT32 unData = 0;
+		if (PfToDevice)
+		{
+			Platform_MemoryCopyInline(&unData, &PrgbData[unPosition], sizeof(UINT32));
+			*(volatile UINT32*)&PpbDevice[unPosition] = unData;
+		}
+		else
+		{
+			unData = *(volatile UINT32*)&PpbDevice[unPosition];
+			Platform_MemoryCopyInline(&PrgbData[unPosition], &unData, sizeof(UINT32));
+		}
+	}
+	for (; unPosition < PunSize; unPosition++)
+	{
+		if (PfToDevice)
+			PpbDevice[unPosition] = PrgbData[unPosition];
+		else
+			PrgbData[unPosition] = PpbDevice[unPosition];
+	}
+
+	if (!PfToDevice)
+		DEVICE_ACCESS_READ_BARRIER();
+}
+
+/**
+ *	@brief		Read a mapped register of up to 32 bits
+ *	@details	A 32-bit register is read with a single aligned access.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the register in bytes
+ *	@param		PpunValue			Receives the register value
+ *	@retval		TRUE				The register was read.
+ *	@retval		FALSE				The register is not mapped or not aligned.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_ReadMappedRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunValue)
+{
+	volatile BYTE* pbRegister = DeviceAccess_GetRegister(PunMemoryAddress, PunSize);
+
+	if (NULL == pbRegister || (sizeof(UINT32) == PunSize && 0 != (PunMemoryAddress & (sizeof(UINT32) - 1))))
+		return FALSE;
+
+	if (sizeof(UINT16) == PunSize)
+	{
+		*PpunValue = DeviceAccess_ReadRegister16(pbRegister);
+	}
+	else
+	{
+		*PpunValue = (sizeof(UINT32) == PunSize) ? *(volatile UINT32*)pbRegister : *pbRegister;
+		DEVICE_ACCESS_READ_BARRIER();
+	}
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Write a mapped register of up to 32 bits
+ *	@details	A 32-bit register is written with a single aligned access.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunData				Register value
+ *	@param		PunSize				Size of the register in bytes
+ *	@retval		TRUE				The register was written.
+ *	@retval		FALSE				The register is not mapped or not aligned.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_WriteMappedRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData,
+	_In_	unsigned int	PunSize)
+{
+	volatile BYTE* pbRegister = DeviceAccess_GetRegister(PunMemoryAddress, PunSize);
+
+	if (NULL == pbRegister || (sizeof(UINT32) == PunSize && 0 != (PunMemoryAddress & (sizeof(UINT32) - 1))))
+		return FALSE;
+
+	if (sizeof(UINT16) == PunSize)
+	{
+		DeviceAccess_WriteRegister16(pbRegister, (UINT16)PunData);
+	}
+	else
+	{
+		DEVICE_ACCESS_WRITE_BARRIER();
+		if (sizeof(UINT32) == PunSize)
+			*(volatile UINT32*)pbRegister = PunData;
+		else
+			*pbRegister = (BYTE)PunData;
+	}
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Read or write mapped registers
+ *	@details	Consecutive registers (e.g. the CRB buffers) are copied with DeviceAccess_CopyDeviceMemory. A FIFO
+ *				register is accessed with 32-bit or 16-bit accesses as long as enough bytes are left if PbAccessSize is
+ *				sizeof(UINT32) or sizeof(UINT16), the remaining bytes with single byte accesses.
+ *
+ *	@param		PunMemoryAddress	Start address of the registers (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of bytes to be transferred
+ *	@param		PbAccessSize		Maximum width of a single FIFO register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@param		PfRead				TRUE to read the registers, FALSE to write them
+ *	@param		PfFifo				TRUE to access the same address with all accesses (FIFO register)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The registers are not mapped or the FIFO register is not aligned.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_TransferMapped(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo)
+{
+	volatile BYTE* pbRegister = DeviceAccess_GetRegister(PunMemoryAddress, PfFifo ? PbAccessSize : PunSize);
+	unsigned int unPosition = 0;
+
+	if (NULL == pbRegister || (PfFifo && 0 != (PunMemoryAddress & (PbAccessSize - 1U))))
+		return RC_E_BAD_PARAMETER;
+
+	if (!PfFifo)
+	{
+		DeviceAccess_CopyDeviceMemory(pbRegister, PrgbData, PunSize, !PfRead);
+		return RC_SUCCESS;
+	}
+
+	if (PfRead)
+	{
+		for (; sizeof(UINT32) == PbAccessSize && PunSize - unPosition >= sizeof(UINT32); unPosition += sizeof(UINT32))
+		{
+			UINT32 unData = *(volatile UINT32*)pbRegister;
+			Platform_MemoryCopyInline(&PrgbData[unPosition], &unData, sizeof(UINT32));
+		}
+		for (; sizeof(UINT16) == PbAccessSize && PunSize - unPosition >= sizeof(UINT16); unPosition += sizeof(UINT16))
+		{
+			UINT16 usData = *(volatile UINT16*)pbRegister;
+			Platform_MemoryCopyInline(&PrgbData[unPosition], &usData, sizeof(UINT16));
+		}
+		for (; unPosition < PunSize; unPosition++)
+			PrgbData[unPosition] = *pbRegister;
+		DEVICE_ACCESS_READ_BARRIER();
+	}
+	else
+	{
+		DEVICE_ACCESS_WRITE_BARRIER();
+		for (; sizeof(UINT32) == PbAccessSize && PunSize - unPosition >= sizeof(UINT32); unPosition += sizeof(UINT32))
+		{
+			UINT32 unData = 0;
+			Platform_MemoryCopyInline(&unData, &PrgbData[unPosition], sizeof(UINT32));
+			*(volatile UINT32*)pbRegister = unData;
+		}
+		for (; sizeof(UINT16) == PbAccessSize && PunSize - unPosition >= sizeof(UINT16); unPosition += sizeof(UINT16))
+		{
+			UINT16 usData = 0;
+			Platform_MemoryCopyInline(&usData, &PrgbData[unPosition], sizeof(UINT16));
+			*(volatile UINT16*)pbRegister = usData;
+		}
+		for (; unPosition < PunSize; unPosition++)
+			*pbRegister = PrgbData[unPosition];
+	}
+
+	return RC_SUCCESS;
+}
+
+/// Register access functions of the mapped TPM memory
+static const IfxDeviceAccessOps s_sMappedRegisterOps = {DeviceAccess_ReadMappedRegister, DeviceAccess_WriteMappedRegister, DeviceAccess_TransferMapped};
+
+/**
+ *	@brief		Reject a register read while no backend is bound
+ *
+ *	@param		PunMemoryAddress	Register address (unused)
+ *	@param		PunSize				Size of the register in bytes (unused)
+ *	@param		PpunValue			Not modified
+ *	@retval		FALSE				Always.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_ReadUnboundRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunValue)
+{
+	UNREFERENCED_PARAMETER(PunMemoryAddress);
+	UNREFERENCED_PARAMETER(PunSize);
+	UNREFERENCED_PARAMETER(PpunValue);
+	return FALSE;
+}
+
+/**
+ *	@brief		Reject a register write while no backend is bound
+ *
+ *	@param		PunMemoryAddress	Register address (unused)
+ *	@param		PunData				Register value (unused)
+ *	@param		PunSize				Size of the register in bytes (unused)
+ *	@retval		FALSE				Always.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_WriteUnboundRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData,
+	_In_	unsigned int	PunSize)
+{
+	UNREFERENCED_PARAMETER(PunMemoryAddress);
+	UNREFERENCED_PARAMETER(PunData);
+	UNREFERENCED_PARAMETER(PunSize);
+	return FALSE;
+}
+
+/**
+ *	@brief		Reject a register transfer while no backend is bound
+ *
+ *	@param		PunMemoryAddress	Start address of the registers (unused)
+ *	@param		PrgbData			Data buffer (unused)
+ *	@param		PunSize				Number of bytes (unused)
+ *	@param		PbAccessSize		Access size (unused)
+ *	@param		PfRead				Direction (unused)
+ *	@param		PfFifo				FIFO flag (unused)
+ *	@retval		RC_E_BAD_PARAMETER	Always.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_TransferUnbound(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo)
+{
+	UNREFERENCED_PARAMETER(PunMemoryAddress);
+	UNREFERENCED_PARAMETER(PrgbData);
+	UNREFERENCED_PARAMETER(PunSize);
+	UNREFERENCED_PARAMETER(PbAccessSize);
+	UNREFERENCED_PARAMETER(PfRead);
+	UNREFERENCED_PARAMETER(PfFifo);
+	return RC_E_BAD_PARAMETER;
+}
+
+/// Register access functions used while no backend is bound, all accesses are invalid
+static const IfxDeviceAccessOps s_sUnboundRegisterOps = {DeviceAccess_ReadUnboundRegister, DeviceAccess_WriteUnboundRegister, DeviceAccess_TransferUnbound};
+
+/**
+ *	@brief		Get the register access functions bound to the current session
+ *
+ *	@returns	Register access functions, never NULL
+ */
+static inline const IfxDeviceAccessOps*
+DeviceAccess_GetRegisterOps()
+{
+	const IfxDeviceAccessOps* pOps = Session_GetCurrent()->pRegisterOps;
+	return (NULL != pOps) ? pOps : &s_sUnboundRegisterOps;
+}
+
+/**
+ *	@brief		Bind the register access functions of a device access backend to the current session
+ *
+ *	@param		PpOps		Register access functions, NULL when the backend is uninitialized
+ */
+void
+DeviceAccess_BindRegisters(
+	_In_opt_	const IfxDeviceAccessOps*	PpOps)
+{
+	Session_GetCurrent()->pRegisterOps = PpOps;
+}
+
+/**
+ *	@brief		Send a request to TPMMemoryHelper
+ *
+ *	@param		PnSocket			Socket connected to the helper
+ *	@param		PrgbRequest			Request
+ *	@param		PunRequestSize		Size of the request
+ *	@param		PrgbPayload			Data following the request, NULL for none
+ *	@param		PunPayloadSize		Size of the data following the request
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_INTERNAL		The request could not be sent.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_SendToHelper(
+	_In_								int				PnSocket,
+	_In_bytecount_(PunRequestSize)		const BYTE*		PrgbRequest,
+	_In_								unsigned int	PunRequestSize,
+	_In_opt_bytecount_(PunPayloadSize)	const BYTE*		PrgbPayload,
+	_In_								unsigned int	PunPayloadSize)
+{
+	struct iovec rgsVector[2] = {{(void*)PrgbRequest, PunRequestSize}, {(void*)PrgbPayload, PunPayloadSize}};
+	struct msghdr sMessage;
+	ssize_t nBytes = 0;
+
+	memset(&sMessage, 0, sizeof(sMessage));
+	sMessage.msg_iov = rgsVector;
+	sMessage.msg_iovlen = (NULL != PrgbPayload && 0 != PunPayloadSize) ? 2 : 1;
+	do
+	{
+		nBytes = sendmsg(PnSocket, &sMessage, MSG_NOSIGNAL);
+	}
+	while (nBytes == -1 && EINTR == errno);
+
+	if (nBytes != (ssize_t)(PunRequestSize + (2 == sMessage.msg_iovlen ? PunPayloadSize : 0)))
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: Sending a request to TPMMemoryHelper failed with errno %d (%s).", errno, strerror(errno));
+		return RC_E_INTERNAL;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Receive (a part of) the answer of TPMMemoryHelper
+ *
+ *	@param		PnSocket			Socket connected to the helper
+ *	@param		PrgbAnswer			Buffer for the answer
+ *	@param		PunAnswerSize		Number of bytes to receive
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_INTERNAL		The helper closed the connection or did not answer in time.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_ReceiveFromHelper(
+	_In_							int				PnSocket,
+	_Out_bytecap_(PunAnswerSize)	BYTE*			PrgbAnswer,
+	_In_							unsigned int	PunAnswerSize)
+{
+	unsigned int unReceived = 0;
+
+	while (unReceived < PunAnswerSize)
+	{
+		ssize_t nBytes = recv(PnSocket, &PrgbAnswer[unReceived], PunAnswerSize - unReceived, 0);
+		if (nBytes == -1 && EINTR == errno)
+			continue;
+		if (nBytes <= 0)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Receiving the answer of TPMMemoryHelper failed with errno %d (%s).", errno, strerror(errno));
+			return RC_E_INTERNAL;
+		}
+		unReceived += (unsigned int)nBytes;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Send a register request to TPMMemoryHelper
+ *	@details	Request: request code, access size, 16-bit offset within the locality page and a 32-bit register value or
+ *				block size, in network byte order. The data of a block write follows the request. Answer: 32-bit status,
+ *				followed by the read data if the access is granted.
+ *
+ *	@param		PbCode				DEVICE_ACCESS_MEMORY_HELPER_* request code
+ *	@param		PbAccessSize		Size of the register, or 0 (consecutive registers), 1, 2 or 4 (FIFO register) for a block
+ *	@param		PunOffset			Offset of the register within the locality page
+ *	@param		PunValue			Register value to write or size of the block
+ *	@param		PrgbPayload			Data of a block write, NULL otherwise
+ *	@param		PrgbData			Buffer for the read data, NULL for a write
+ *	@param		PunDataSize			Size of the read data
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The helper refused the access.
+ *	@retval		RC_E_INTERNAL		The connection to the helper failed.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_RequestHelper(
+	_In_							BYTE			PbCode,
+	_In_							BYTE			PbAccessSize,
+	_In_							unsigned int	PunOffset,
+	_In_							unsigned int	PunValue,
+	_In_opt_						const BYTE*		PrgbPayload,
+	_Out_opt_bytecap_(PunDataSize)	BYTE*			PrgbData,
+	_In_							unsigned int	PunDataSize)
+{
+	BYTE rgbRequest[DEVICE_ACCESS_MEMORY_HELPER_REQUEST_SIZE] = {PbCode, PbAccessSize, (BYTE)(PunOffset >> 8), (BYTE)PunOffset,
+		(BYTE)(PunValue >> 24), (BYTE)(PunValue >> 16), (BYTE)(PunValue >> 8), (BYTE)PunValue};
+	BYTE rgbStatus[sizeof(UINT32)] = {0};
+	int nSocket = (int)Session_GetCurrent()->unMemoryFileHandle;
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unReturnValue = DeviceAccess_SendToHelper(nSocket, rgbRequest, sizeof(rgbRequest), PrgbPayload, NULL != PrgbPayload ? PunValue : 0);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = DeviceAccess_ReceiveFromHelper(nSocket, rgbStatus, sizeof(rgbStatus));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (DEVICE_ACCESS_MEMORY_HELPER_GRANTED != (((unsigned int)rgbStatus[0] << 24) | ((unsigned int)rgbStatus[1] << 16) | ((unsigned int)rgbStatus[2] << 8) | rgbStatus[3]))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		if (NULL != PrgbData)
+			unReturnValue = DeviceAccess_ReceiveFromHelper(nSocket, PrgbData, PunDataSize);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read a register of up to 32 bits through TPMMemoryHelper
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the register in bytes
+ *	@param		PpunValue			Receives the register value, all bits set if the helper is not reachable (like a read
+ *									from a missing device)
+ *	@retval		TRUE				The register address is valid.
+ *	@retval		FALSE				The register lies outside the locality registers or is not aligned.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_ReadHelperRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunValue)
+{
+	BYTE rgbValue[sizeof(UINT32)] = {0xFF, 0xFF, 0xFF, 0xFF};
+	unsigned int unOffset = 0;
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (!DeviceAccess_GetWindowOffset(PunMemoryAddress, PunSize, &unOffset))
+		return FALSE;
+
+	unReturnValue = DeviceAccess_RequestHelper(DEVICE_ACCESS_MEMORY_HELPER_READ_REGISTER, (BYTE)PunSize, unOffset, 0, NULL, rgbValue, sizeof(rgbValue));
+	if (RC_E_BAD_PARAMETER == unReturnValue)
+		return FALSE;
+	if (RC_SUCCESS != unReturnValue)
+		IGNORE_RETURN_VALUE(Platform_MemorySet(rgbValue, 0xFF, sizeof(rgbValue)));
+
+	*PpunValue = ((unsigned int)rgbValue[0] << 24) | ((unsigned int)rgbValue[1] << 16) | ((unsigned int)rgbValue[2] << 8) | (unsigned int)rgbValue[3];
+	return TRUE;
+}
+
+/**
+ *	@brief		Write a register of up to 32 bits through TPMMemoryHelper
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunData				Register value
+ *	@param		PunSize				Size of the register in bytes
+ *	@retval		TRUE				The register address is valid.
+ *	@retval		FALSE				The register lies outside the locality registers or is not aligned.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_WriteHelperRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData,
+	_In_	unsigned int	PunSize)
+{
+	unsigned int unOffset = 0;
+
+	if (!DeviceAccess_GetWindowOffset(PunMemoryAddress, PunSize, &unOffset))
+		return FALSE;
+
+	return RC_E_BAD_PARAMETER != DeviceAccess_RequestHelper(DEVICE_ACCESS_MEMORY_HELPER_WRITE_REGISTER, (BYTE)PunSize, unOffset, PunData, NULL, NULL, 0);
+}
+
+/**
+ *	@brief		Read or write registers through TPMMemoryHelper
+ *	@details	A FIFO transfer is split into requests of up to DEVICE_ACCESS_LOCALITY_SIZE bytes, the helper accesses the
+ *				FIFO register with the requested access width.
+ *
+ *	@param		PunMemoryAddress	Start address of the registers (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of bytes to be transferred
+ *	@param		PbAccessSize		Maximum width of a single FIFO register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@param		PfRead				TRUE to read the registers, FALSE to write them
+ *	@param		PfFifo				TRUE to access the same address with all accesses (FIFO register)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The registers lie outside the locality registers or the FIFO register is not aligned.
+ *	@retval		RC_E_INTERNAL		The connection to the helper failed.
+ */
+_Check_return_
+static unsigned int
+DeviceAccess_TransferHelper(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unOffset = 0;
+	unsigned int unPosition = 0;
+
+	if (!DeviceAccess_GetWindowOffset(PunMemoryAddress, PfFifo ? PbAccessSize : PunSize, &unOffset))
+		return RC_E_BAD_PARAMETER;
+
+	while (RC_SUCCESS == unReturnValue && unPosition < PunSize)
+	{
+		unsigned int unChunk = PunSize - unPosition > DEVICE_ACCESS_LOCALITY_SIZE ? DEVICE_ACCESS_LOCALITY_SIZE : PunSize - unPosition;
+
+		if (PfRead)
+			unReturnValue = DeviceAccess_RequestHelper(DEVICE_ACCESS_MEMORY_HELPER_READ_BLOCK, PfFifo ? PbAccessSize : 0, unOffset, unChunk, NULL, &PrgbData[unPosition], unChunk);
+		else
+			unReturnValue = DeviceAccess_RequestHelper(DEVICE_ACCESS_MEMORY_HELPER_WRITE_BLOCK, PfFifo ? PbAccessSize : 0, unOffset, unChunk, &PrgbData[unPosition], NULL, 0);
+		unPosition += unChunk;
+	}
+
+	return unReturnValue;
+}
+
+/// Register access functions of the TPM registers served by TPMMemoryHelper
+static const IfxDeviceAccessOps s_sHelperRegisterOps = {DeviceAccess_ReadHelperRegister, DeviceAccess_WriteHelperRegister, DeviceAccess_TransferHelper};
+
+/**
+ *	@brief		Connect to TPMMemoryHelper for the locality register page
+ *	@details	Sends the physical address of the locality register page to the helper on its Unix socket
+ *				(PROPERTY_TPM_MEMORY_HELPER or DEVICE_ACCESS_MEMORY_HELPER). The helper checks the page against the TPM
+ *				register window, maps it and answers with a 32-bit status. The register accesses are sent to the helper
+ *				on the same connection from then on.
+ *
+ *	@param		PullPage		Physical address of the locality register page
+ *	@param		PpnSocket		Receives the connected socket
+ *	@retval		TRUE			The helper serves the page.
+ *	@retval		FALSE			No helper is configured or running, or it refused the page.
+ */
+_Check_return_
+static BOOL
+DeviceAccess_ConnectMemoryHelper(
+	_In_	unsigned long long	PullPage,
+	_Out_	int*				PpnSocket)
+{
+	BOOL fConnected = FALSE;
+	int nSocket = -1;
+	wchar_t wszSocketPath[MAX_PATH] = {0};
+	unsigned int unSocketPathSize = RG_LEN(wszSocketPath);
+	struct sockaddr_un sAddress;
+
+	*PpnSocket = -1;
+	memset(&sAddress, 0, sizeof(sAddress));
+	sAddress.sun_family = AF_UNIX;
+
+	do
+	{
+		unsigned char rgbRequest[8] = {0};
+		unsigned char rgbStatus[4] = {0};
+		struct timeval sTimeout = {DEVICE_ACCESS_MEMORY_HELPER_TIMEOUT, 0};
+		unsigned int unStatus = 0, unIndex = 0;
+
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_MEMORY_HELPER, wszSocketPath, &unSocketPathSize) && 0 != wszSocketPath[0])
+		{
+			if ((size_t)-1 == wcstombs(sAddress.sun_path, wszSocketPath, sizeof(sAddress.sun_path) - 1))
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: The TPMMemoryHelper socket path '%ls' cannot be converted.", wszSocketPath);
+				break;
+			}
+		}
+		else
+		{
+			// Without a configured socket the default one is used if the helper runs
+			if (0 != access(DEVICE_ACCESS_MEMORY_HELPER, F_OK))
+				break;
+			strcpy(sAddress.sun_path, DEVICE_ACCESS_MEMORY_HELPER);
+		}
+
+		nSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (-1 == nSocket || 0 != connect(nSocket, (struct sockaddr*)&sAddress, sizeof(sAddress)))
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Connecting to TPMMemoryHelper on %s failed with errno %d (%s).", sAddress.sun_path, errno, strerror(errno));
+			break;
+		}
+		IGNORE_RETURN_VALUE(setsockopt(nSocket, SOL_SOCKET, SO_RCVTIMEO, &sTimeout, sizeof(sTimeout)));
+
+		for (unIndex = 0; unIndex < sizeof(rgbRequest); unIndex++)
+			rgbRequest[unIndex] = (unsigned char)(PullPage >> (8 * (sizeof(rgbRequest) - 1 - unIndex)));
+		if (RC_SUCCESS != DeviceAccess_SendToHelper(nSocket, rgbRequest, sizeof(rgbRequest), NULL, 0) ||
+				RC_SUCCESS != DeviceAccess_ReceiveFromHelper(nSocket, rgbStatus, sizeof(rgbStatus)))
+		{
+			LOGGING_WRITE_LEVEL1(L"Error: TPMMemoryHelper did not answer.");
+			break;
+		}
+
+		unStatus = ((unsigned int)rgbStatus[0] << 24) | ((unsigned int)rgbStatus[1] << 16) | ((unsigned int)rgbStatus[2] << 8) | (unsigned int)rgbStatus[3];
+		if (DEVICE_ACCESS_MEMORY_HELPER_GRANTED != unStatus)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TPMMemoryHelper refused the register page 0x%llX (status %u).", PullPage, unStatus);
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL4_FMT(L"TPMMemoryHelper on %s serves the register page 0x%llX", sAddress.sun_path, PullPage);
+		*PpnSocket = nSocket;
+		nSocket = -1;
+		fConnected = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nSocket)
+		IGNORE_RETURN_VALUE(close(nSocket));
+
+	return fConnected;
+}
 
 /**
  *	@brief		Initialize the device access
- *	@details
+ *	@details	Maps the 4 KiB register page of the given locality only. /dev/mem is opened with O_SYNC so the page is
+ *				mapped uncached: UC- on x86 and Device-nGnRnE on ARM (pgprot_noncached), so every register access
+ *				reaches the TPM in program order. A page inside System RAM is refused, as an uncached mapping
+ *				of cached RAM would create conflicting memory attributes. Without the privilege to open /dev/mem the
+ *				registers are accessed through TPMMemoryHelper, which maps the page itself.
  *
  *	@param		PbLocality		Locality value
- *	@retval		RC_SUCCESS				The operation completed successfully.
- *	@retval		RC_E_INTERNAL			The operation failed.
- *	@retval		RC_E_TPM_ACCESS_DENIED	Read-write access to /dev/mem was denied.
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_INTERNAL				The operation failed.
+ *	@retval		RC_E_TPM_ACCESS_DENIED		Read-write access to /dev/mem was denied.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	The locality is not supported.
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The register page lies within System RAM.
+ *	@retval		...							Error codes from DeviceAccess_GetPhysicalMemoryBase function
  */
 _Check_return_
 unsigned int
 DeviceAccess_Initialize(
 	_In_	BYTE	PbLocality)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unReturnValue = RC_E_FAIL;
-	UNREFERENCED_PARAMETER(PbLocality);
 
-	do
-	{
-		s_unFileHandle = open(DEV_TPM_MEM, O_RDWR);
-		if (s_unFileHandle == (UINT32) - 1)
+	do
+	{
+		unsigned long long ullMemoryBase = 0, ullPage = 0, ullTpmBase = 0;
+		unsigned int unPageOffset = 0;
+		BYTE bInterface = DEVICE_ACCESS_INTERFACE_UNKNOWN;
+		BOOL fSystemRam = FALSE;
+		BYTE* pbMapping = NULL;
+
+		if (PbLocality > DEVICE_ACCESS_MAX_LOCALITY)
+		{
+			unReturnValue = RC_E_LOCALITY_NOT_SUPPORTED;
+			break;
+		}
+
+		unReturnValue = DeviceAccess_GetPhysicalMemoryBase(&ullMemoryBase, &bInterface);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Verify the register page is no RAM before mapping it uncached
+		ullPage = ullMemoryBase + (unsigned long long)PbLocality * DEVICE_ACCESS_LOCALITY_SIZE;
+		if (DeviceAccess_ScanIomem(ullPage, &ullTpmBase, &fSystemRam) && fSystemRam)
+		{
+			unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: The TPM register page 0x%llX lies within System RAM.", ullPage);
+			break;
+		}
+
+		// O_SYNC maps the registers uncached (device memory) on all architectures
+		pSession->unMemoryFileHandle = open(DEV_TPM_MEM, O_RDWR | O_SYNC);
+		if (pSession->unMemoryFileHandle == (UINT32) - 1)
 		{
 			int nErrorNumber = errno;
+			int nSocket = -1;
+			if ((EACCES == nErrorNumber || EPERM == nErrorNumber) && DeviceAccess_ConnectMemoryHelper(ullPage, &nSocket))
+			{
+				// The helper accesses the registers on behalf of this process, nothing is mapped
+				pSession->unMemoryFileHandle = (UINT32)nSocket;
+				pSession->ullMemoryBase = ullMemoryBase;
+				pSession->unMemoryOffset = (unsigned int)PbLocality * DEVICE_ACCESS_LOCALITY_SIZE;
+				pSession->bMemoryInterface = bInterface;
+				DeviceAccess_BindRegisters(&s_sHelperRegisterOps);
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
 			if (EACCES == nErrorNumber)
 				unReturnValue = RC_E_TPM_ACCESS_DENIED;
 			else
 				unReturnValue = RC_E_INTERNAL;
 
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Open device pseudo file %s failed with errno %d (%s).", DEV_TPM_MEM, errno, strerror(errno));
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Open device pseudo file %s failed with errno %d (%s).", DEV_TPM_MEM, nErrorNumber, strerror(nErrorNumber));
 			break;
 		}
 
-		s_bMemPtr = (BYTE *) mmap(0, TPM_DEFAULT_MEM_SIZE, PROT_READ | PROT_WRITE, MAP_FILE | MAP_SHARED, s_unFileHandle, TPM_DEFAULT_MEM_BASE);
-		if (s_bMemPtr == MAP_FAILED)
+		// mmap needs a page aligned offset, the system page may be larger than the register page (e.g. 64 KiB on ARM)
+		unPageOffset = (unsigned int)(ullPage & (unsigned long long)(sysconf(_SC_PAGESIZE) - 1));
+		pbMapping = (BYTE *) mmap(0, unPageOffset + DEVICE_ACCESS_LOCALITY_SIZE, PROT_READ | PROT_WRITE, MAP_FILE | MAP_SHARED, pSession->unMemoryFileHandle, (off_t)(ullPage - unPageOffset));
+		if (pbMapping == MAP_FAILED)
 		{
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Memory mapping failed with errno %d (%s).", errno, strerror(errno));
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Memory mapping of 0x%llX failed with errno %d (%s).", ullPage, errno, strerror(errno));
+			IGNORE_RETURN_VALUE(close(pSession->unMemoryFileHandle));
 			unReturnValue = RC_E_INTERNAL;
 			break;
 		}
+		LOGGING_WRITE_LEVEL4_FMT(L"Mapped the locality %d registers at 0x%llX", PbLocality, ullPage);
+		pSession->pbMemory = pbMapping + unPageOffset;
+		pSession->ullMemoryBase = ullMemoryBase;
+		pSession->unMemoryOffset = (unsigned int)PbLocality * DEVICE_ACCESS_LOCALITY_SIZE;
+		pSession->bMemoryInterface = bInterface;
+		DeviceAccess_BindRegisters(&s_sMappedRegisterOps);
 
 		unReturnValue = RC_SUCCESS;
 	}
@@ -83,12 +1114,20 @@ unsigned int
 DeviceAccess_Uninitialize(
 	_In_	BYTE	PbLocality)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unPageOffset = (unsigned int)((pSession->ullMemoryBase + pSession->unMemoryOffset) & (unsigned long long)(sysconf(_SC_PAGESIZE) - 1));
 	UNREFERENCED_PARAMETER(PbLocality);
 
-	munmap(s_bMemPtr, TPM_DEFAULT_MEM_SIZE);
+	DeviceAccess_BindRegisters(NULL);
+	if (NULL != pSession->pbMemory)
+		munmap(pSession->pbMemory - unPageOffset, unPageOffset + DEVICE_ACCESS_LOCALITY_SIZE);
+	pSession->pbMemory = NULL;
+	pSession->ullMemoryBase = 0;
+	pSession->unMemoryOffset = 0;
+	pSession->bMemoryInterface = DEVICE_ACCESS_INTERFACE_UNKNOWN;
 
-	if (close(s_unFileHandle) == -1)
+	if (close(pSession->unMemoryFileHandle) == -1)
 	{
 		LOGGING_WRITE_LEVEL1_FMT(L"Error: Close device pseudo file %s failed with errno %d (%s).", DEV_TPM_MEM, errno, strerror(errno));
 		unReturnValue = RC_E_INTERNAL;
@@ -100,6 +1139,53 @@ DeviceAccess_Uninitialize(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Get the physical address of the TPM register window
+ *	@details	The TIS and CRB register addresses are relative to TPM_DEFAULT_MEM_BASE and are translated by the device
+ *				access routines. Physical addresses reported by the TPM (e.g. the CRB buffers) must be translated with
+ *				this base.
+ *
+ *	@returns	Physical address of the mapped TPM memory, TPM_DEFAULT_MEM_BASE if no memory is mapped
+ */
+_Check_return_
+unsigned long long
+DeviceAccess_GetMemoryBase()
+{
+	IfxSession* pSession = Session_GetCurrent();
+	return (0 != pSession->ullMemoryBase) ? pSession->ullMemoryBase : TPM_DEFAULT_MEM_BASE;
+}
+
+/**
+ *	@brief		Get the TPM interface given by the ACPI TPM2 table
+ *
+ *	@returns	DEVICE_ACCESS_INTERFACE_FIFO, DEVICE_ACCESS_INTERFACE_CRB or DEVICE_ACCESS_INTERFACE_UNKNOWN
+ */
+_Check_return_
+BYTE
+DeviceAccess_GetInterfaceType()
+{
+	return Session_GetCurrent()->bMemoryInterface;
+}
+
+/**
+ *	@brief		Check whether a memory range is mapped
+ *	@details	A range is accessible if a backend is bound to the session and the range lies within its locality registers.
+ *
+ *	@param		PunMemoryAddress	Start address of the memory range (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the memory range in bytes
+ *	@retval		TRUE				The range lies within the mapped locality registers.
+ *	@retval		FALSE				Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccess_IsMapped(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize)
+{
+	unsigned int unOffset = 0;
+	return NULL != Session_GetCurrent()->pRegisterOps && DeviceAccess_GetWindowOffset(PunMemoryAddress, PunSize, &unOffset);
+}
+
 /**
  *	@brief		Read a Byte from the specified memory address
  *	@details
@@ -112,19 +1198,16 @@ BYTE
 DeviceAccess_ReadByte(
 	_In_	unsigned int PunMemoryAddress)
 {
-	BYTE bPortValue = 0;
+	unsigned int unPortValue = 0;
 
-	if (PunMemoryAddress < TPM_DEFAULT_MEM_BASE || PunMemoryAddress >= (TPM_DEFAULT_MEM_BASE + TPM_DEFAULT_MEM_SIZE))
+	if (!DeviceAccess_GetRegisterOps()->fpReadRegister(PunMemoryAddress, sizeof(BYTE), &unPortValue))
 	{
 		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_ReadByte: Memory address %0.4X is invalid!", PunMemoryAddress);
-	}
-	else
-	{
-		bPortValue = s_bMemPtr[PunMemoryAddress - TPM_DEFAULT_MEM_BASE];
+		unPortValue = 0;
 	}
 
-	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_ReadByte: Address: %0.4X: %0.2X", PunMemoryAddress, bPortValue);
-	return bPortValue;
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_ReadByte: Address: %0.4X: %0.2X", PunMemoryAddress, (BYTE)unPortValue);
+	return (BYTE)unPortValue;
 }
 
 /**
@@ -141,14 +1224,10 @@ DeviceAccess_WriteByte(
 {
 	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_WriteByte: Address: %0.4X = %0.2X", PunMemoryAddress, PbData);
 
-	if (PunMemoryAddress < TPM_DEFAULT_MEM_BASE || PunMemoryAddress >= (TPM_DEFAULT_MEM_BASE + TPM_DEFAULT_MEM_SIZE))
+	if (!DeviceAccess_GetRegisterOps()->fpWriteRegister(PunMemoryAddress, PbData, sizeof(BYTE)))
 	{
 		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_WriteByte: Memory address %0.4X is invalid!", PunMemoryAddress);
 	}
-	else
-	{
-		s_bMemPtr[PunMemoryAddress - TPM_DEFAULT_MEM_BASE] = PbData;
-	}
 }
 
 /**
@@ -163,23 +1242,16 @@ unsigned short
 DeviceAccess_ReadWord(
 	_In_	unsigned int	PunMemoryAddress)
 {
-	UINT16 usPortValue = 0;
-	unsigned int unReturnValue = RC_E_FAIL;
-	if (PunMemoryAddress < TPM_DEFAULT_MEM_BASE || PunMemoryAddress >= (TPM_DEFAULT_MEM_BASE + TPM_DEFAULT_MEM_SIZE))
+	unsigned int unPortValue = 0;
+
+	if (!DeviceAccess_GetRegisterOps()->fpReadRegister(PunMemoryAddress, sizeof(UINT16), &unPortValue))
 	{
 		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_ReadWord: Memory address %0.4X is invalid!", PunMemoryAddress);
-	}
-	else
-	{
-		unReturnValue = Platform_MemoryCopy(&usPortValue, sizeof(UINT16), (const void*) & s_bMemPtr[PunMemoryAddress - TPM_DEFAULT_MEM_BASE], sizeof(UINT16));
-		if (RC_SUCCESS != unReturnValue)
-		{
-			LOGGING_WRITE_LEVEL1_FMT(L"Unexpected returnvalue from function call Platform_MemoryCopy. Return Code: %0.4X", unReturnValue);
-		}
+		unPortValue = 0;
 	}
 
-	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_ReadWord: Address: %0.4X: %0.4X", PunMemoryAddress, usPortValue);
-	return usPortValue;
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_ReadWord: Address: %0.4X: %0.4X", PunMemoryAddress, (UINT16)unPortValue);
+	return (UINT16)unPortValue;
 }
 
 /**
@@ -194,19 +1266,399 @@ DeviceAccess_WriteWord(
 	_In_	unsigned int	PunMemoryAddress,
 	_In_	unsigned short	PusData)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
 	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_WriteWord:  Address: %0.4X = %0.4X", PunMemoryAddress, PusData);
 
-	if (PunMemoryAddress < TPM_DEFAULT_MEM_BASE || PunMemoryAddress >= (TPM_DEFAULT_MEM_BASE + TPM_DEFAULT_MEM_SIZE))
+	if (!DeviceAccess_GetRegisterOps()->fpWriteRegister(PunMemoryAddress, PusData, sizeof(UINT16)))
 	{
 		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_WriteWord: Memory address %0.4X is invalid!", PunMemoryAddress);
 	}
-	else
+}
+
+/**
+ *	@brief		Read a Double Word from the specified memory address
+ *	@details	The value is read with a single 32-bit access. The memory address must be 32-bit aligned.
+ *
+ *	@param		PunMemoryAddress	Memory address
+ *	@returns	Data value read from specified memory
+ */
+_Check_return_
+unsigned int
+DeviceAccess_ReadDWord(
+	_In_	unsigned int	PunMemoryAddress)
+{
+	unsigned int unPortValue = 0xFFFFFFFF;
+
+	if (!DeviceAccess_GetRegisterOps()->fpReadRegister(PunMemoryAddress, sizeof(UINT32), &unPortValue))
 	{
-		unReturnValue = Platform_MemoryCopy(& s_bMemPtr[PunMemoryAddress - TPM_DEFAULT_MEM_BASE], sizeof(UINT16), (const void*) & PusData, sizeof(unsigned short));
-		if (RC_SUCCESS != unReturnValue)
+		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_ReadDWord: Memory address %0.4X is invalid!", PunMemoryAddress);
+		unPortValue = 0xFFFFFFFF;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_ReadDWord: Address: %0.4X: %0.8X", PunMemoryAddress, unPortValue);
+	return unPortValue;
+}
+
+/**
+ *	@brief		Write a Double Word to the specified memory address
+ *	@details	The value is written with a single 32-bit access. The memory address must be 32-bit aligned.
+ *
+ *	@param		PunMemoryAddress	Memory address
+ *	@param		PunData				Data to be written
+ */
+void
+DeviceAccess_WriteDWord(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData)
+{
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_WriteDWord: Address: %0.4X = %0.8X", PunMemoryAddress, PunData);
+
+	if (!DeviceAccess_GetRegisterOps()->fpWriteRegister(PunMemoryAddress, PunData, sizeof(UINT32)))
+	{
+		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_WriteDWord: Memory address %0.4X is invalid!", PunMemoryAddress);
+	}
+}
+
+/**
+ *	@brief		Copy a block of data to a memory range starting at the specified memory address
+ *	@details	In contrast to DeviceAccess_WriteBlock the data is written to consecutive memory addresses with a
+ *				single memory copy, e.g. into the command buffer of a CRB interface.
+ *
+ *	@param		PunMemoryAddress	Start address of the memory range
+ *	@param		PrgbData			Data to be written
+ *	@param		PunSize				Number of bytes to be written
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_CopyToMemory(
+	_In_						unsigned int	PunMemoryAddress,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbData,
+	_In_						unsigned int	PunSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_CopyToMemory: Address: %0.4X, Size: %d", PunMemoryAddress, PunSize);
+
+	do
+	{
+		if (NULL == PrgbData)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = DeviceAccess_GetRegisterOps()->fpTransfer(PunMemoryAddress, (BYTE*)PrgbData, PunSize, 0, FALSE, FALSE);
+		if (RC_E_BAD_PARAMETER == unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_CopyToMemory: Memory range %0.4X (%d bytes) is invalid!", PunMemoryAddress, PunSize);
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Copy a block of data from a memory range starting at the specified memory address
+ *	@details	In contrast to DeviceAccess_ReadBlock the data is read from consecutive memory addresses with a
+ *				single memory copy, e.g. from the response buffer of a CRB interface.
+ *
+ *	@param		PunMemoryAddress	Start address of the memory range
+ *	@param		PrgbData			Buffer for the read data
+ *	@param		PunSize				Number of bytes to be read
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_CopyFromMemory(
+	_In_						unsigned int	PunMemoryAddress,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbData,
+	_In_						unsigned int	PunSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		if (NULL == PrgbData)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = DeviceAccess_GetRegisterOps()->fpTransfer(PunMemoryAddress, PrgbData, PunSize, 0, TRUE, FALSE);
+		if (RC_E_BAD_PARAMETER == unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_CopyFromMemory: Memory range %0.4X (%d bytes) is invalid!", PunMemoryAddress, PunSize);
+		}
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_CopyFromMemory: Address: %0.4X, Size: %d", PunMemoryAddress, PunSize);
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Write a block of data to a FIFO register at the specified memory address
+ *	@details	All bytes are written to the same memory address. If PbAccessSize is sizeof(UINT32) or
+ *				sizeof(UINT16) the data is written with accesses of that width as long as enough bytes are left, the
+ *				remaining bytes are written with single byte accesses.
+ *
+ *	@param		PunMemoryAddress	Memory address of the FIFO register
+ *	@param		PrgbData			Data to be written
+ *	@param		PunSize				Number of bytes to be written
+ *	@param		PbAccessSize		Maximum width of a single register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_WriteBlock(
+	_In_						unsigned int	PunMemoryAddress,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_WriteBlock: Address: %0.4X, Size: %d, Access size: %d", PunMemoryAddress, PunSize, PbAccessSize);
+
+	do
+	{
+		if (NULL == PrgbData || (sizeof(BYTE) != PbAccessSize && sizeof(UINT16) != PbAccessSize && sizeof(UINT32) != PbAccessSize))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = DeviceAccess_GetRegisterOps()->fpTransfer(PunMemoryAddress, (BYTE*)PrgbData, PunSize, PbAccessSize, FALSE, TRUE);
+		if (RC_E_BAD_PARAMETER == unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_WriteBlock: Memory address %0.4X is invalid!", PunMemoryAddress);
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read a block of data from a FIFO register at the specified memory address
+ *	@details	All bytes are read from the same memory address. If PbAccessSize is sizeof(UINT32) or
+ *				sizeof(UINT16) the data is read with accesses of that width as long as enough bytes are left, the
+ *				remaining bytes are read with single byte accesses.
+ *
+ *	@param		PunMemoryAddress	Memory address of the FIFO register
+ *	@param		PrgbData			Buffer for the read data
+ *	@param		PunSize				Number of bytes to be read
+ *	@param		PbAccessSize		Maximum width of a single register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_ReadBlock(
+	_In_						unsigned int	PunMemoryAddress,
+	_Out_bytecap_(PunSize)		BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		if (NULL == PrgbData || (sizeof(BYTE) != PbAccessSize && sizeof(UINT16) != PbAccessSize && sizeof(UINT32) != PbAccessSize))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = DeviceAccess_GetRegisterOps()->fpTransfer(PunMemoryAddress, PrgbData, PunSize, PbAccessSize, TRUE, TRUE);
+		if (RC_E_BAD_PARAMETER == unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccess_ReadBlock: Memory address %0.4X is invalid!", PunMemoryAddress);
+		}
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(L"DeviceAccess_ReadBlock: Address: %0.4X, Size: %d, Access size: %d", PunMemoryAddress, PunSize, PbAccessSize);
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Open the interrupt line of the TPM
+ *	@details	Opens a UIO device (e.g. /dev/uio0 of the uio_pdrv_genirq driver bound to the TPM interrupt). Each read
+ *				of the device returns the number of interrupts so far, writing 1 unmasks the interrupt again.
+ *
+ *	@param		PwszDevicePath			Path of the UIO device
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_TPM_ACCESS_DENIED	Read-write access to the UIO device was denied.
+ *	@retval		RC_E_INVALID_SETTING	The device path is invalid or the device cannot be opened or unmasked.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_OpenInterrupt(
+	_In_z_	const wchar_t*	PwszDevicePath)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+	int nFileHandle = -1;
+
+	do
+	{
+		char szDevicePath[MAX_PATH] = {0};
+		UINT32 unUnmask = 1;
+
+		if ((size_t)-1 == wcstombs(szDevicePath, PwszDevicePath, sizeof(szDevicePath) - 1))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid interrupt device path %ls.", PwszDevicePath);
+			break;
+		}
+
+		nFileHandle = open(szDevicePath, O_RDWR | O_CLOEXEC);
+		if (-1 == nFileHandle)
+		{
+			unReturnValue = EACCES == errno ? RC_E_TPM_ACCESS_DENIED : RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Open interrupt device %s failed with errno %d (%s).", szDevicePath, errno, strerror(errno));
+			break;
+		}
+
+		// Drivers without interrupt control (irqcontrol) cannot be used, the interrupt stays masked after the first one
+		if (sizeof(unUnmask) != write(nFileHandle, &unUnmask, sizeof(unUnmask)))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Unmasking the interrupt of %s failed with errno %d (%s).", szDevicePath, errno, strerror(errno));
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL4_FMT(L"Opened interrupt device %s", szDevicePath);
+		pSession->nInterruptFileHandle = nFileHandle;
+		pSession->fInterruptOpen = TRUE;
+		nFileHandle = -1;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nFileHandle)
+		IGNORE_RETURN_VALUE(close(nFileHandle));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Close the interrupt line opened by DeviceAccess_OpenInterrupt
+ */
+void
+DeviceAccess_CloseInterrupt()
+{
+	IfxSession* pSession = Session_GetCurrent();
+
+	if (pSession->fInterruptOpen && close(pSession->nInterruptFileHandle) == -1)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: Close interrupt device failed with errno %d (%s).", errno, strerror(errno));
+	}
+	pSession->fInterruptOpen = FALSE;
+	pSession->nInterruptFileHandle = -1;
+}
+
+/**
+ *	@brief		Check whether the interrupt line of the TPM is opened
+ *
+ *	@retval		TRUE	DeviceAccess_OpenInterrupt opened the interrupt line.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccess_IsInterruptOpen()
+{
+	return Session_GetCurrent()->fInterruptOpen;
+}
+
+/**
+ *	@brief		Wait for an interrupt of the TPM
+ *	@details	Unmasks the interrupt and sleeps until the TPM raises it or the timeout elapses. The TPM keeps a
+ *				level-triggered interrupt asserted until its interrupt status is cleared, which must happen before
+ *				the next wait.
+ *
+ *	@param		PunMicroSeconds		Longest time to wait in microseconds
+ *	@param		PpfSignaled			Receives TRUE if the TPM raised the interrupt, FALSE on a timeout
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_READY		The interrupt line is not opened.
+ *	@retval		RC_E_INTERNAL		Waiting on the interrupt line failed.
+ */
+_Check_return_
+unsigned int
+DeviceAccess_WaitInterrupt(
+	_In_	UINT32	PunMicroSeconds,
+	_Out_	BOOL*	PpfSignaled)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		struct pollfd sPoll;
+		UINT32 unUnmask = 1;
+		UINT32 unCount = 0;
+		int nResult = 0;
+
+		if (NULL == PpfSignaled)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpfSignaled = FALSE;
+
+		if (!pSession->fInterruptOpen)
+		{
+			unReturnValue = RC_E_NOT_READY;
+			break;
+		}
+
+		if (sizeof(unUnmask) != write(pSession->nInterruptFileHandle, &unUnmask, sizeof(unUnmask)))
+		{
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Unmasking the interrupt failed with errno %d (%s).", errno, strerror(errno));
+			break;
+		}
+
+		// poll has a resolution of milliseconds, round up so the timeout is not shortened
+		sPoll.fd = pSession->nInterruptFileHandle;
+		sPoll.events = POLLIN;
+		sPoll.revents = 0;
+		nResult = poll(&sPoll, 1, (int)((PunMicroSeconds + 999) / 1000));
+		if (nResult < 0 && EINTR != errno)
+		{
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Waiting for the interrupt failed with errno %d (%s).", errno, strerror(errno));
+			break;
+		}
+
+		// Consume the interrupt count, otherwise the next poll returns immediately
+		if (nResult > 0 && 0 != (sPoll.revents & POLLIN))
+		{
+			if (sizeof(unCount) != read(pSession->nInterruptFileHandle, &unCount, sizeof(unCount)))
+			{
+				unReturnValue = RC_E_INTERNAL;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: Reading the interrupt count failed with errno %d (%s).", errno, strerror(errno));
+				break;
+			}
+			*PpfSignaled = TRUE;
+		}
+		else if (nResult > 0)
 		{
-			LOGGING_WRITE_LEVEL1_FMT(L"Unexpected returnvalue from function call Platform_MemoryCopy. Return Code: %0.4X", unReturnValue);
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: The interrupt device reported the events 0x%X.", sPoll.revents);
+			break;
 		}
+
+		unReturnValue = RC_SUCCESS;
 	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
 }
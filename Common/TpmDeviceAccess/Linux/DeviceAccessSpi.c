@@ -0,0 +1,393 @@
+﻿/**
+ *	@brief		Implements the Device access routines via an SPI bus (spidev)
+ *	@details	Implements the register access of the TPM SPI protocol (TCG PC Client Platform TPM Profile, SPI
+ *				hardware protocol) on a Linux spidev device. Every transaction starts with a 4 byte header: read flag and
+ *				transfer size, followed by the 24-bit register address (0xD4xxxx). The TPM can insert wait states
+ *				after the header by driving the last bit low, the controller then clocks single bytes until it reads a 1.
+ *				The chip select is held across the wait states by the cs_change flag of the last transfer of a message.
+ *	@file		Linux/DeviceAccessSpi.c
+ *	@copyright	Copyright 2016 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StdInclude.h"
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include "DeviceAccess.h"
+#include "DeviceAccessSpi.h"
+#include "Logging.h"
+#include "Platform.h"
+#include "Session.h"
+#include "PropertyStorage.h"
+
+/// Read flag of the TPM SPI transaction header
+#define DEVICE_ACCESS_SPI_READ				0x80
+/// Most significant byte of the TPM register addresses on the SPI bus
+#define DEVICE_ACCESS_SPI_ADDRESS_PREFIX	0xD4
+/// Size of the TPM SPI transaction header
+#define DEVICE_ACCESS_SPI_HEADER_SIZE		4
+/// Maximum number of wait state bytes before the transaction is aborted
+#define DEVICE_ACCESS_SPI_MAX_WAIT_STATES	50
+
+/**
+ *	@brief		Run a single SPI transfer
+ *	@details
+ *
+ *	@param		PrgbTransmit		Bytes to be sent (NULL sends zero bytes)
+ *	@param		PrgbReceive			Buffer for the received bytes (NULL ignores them)
+ *	@param		PunSize				Number of bytes to be clocked
+ *	@param		PfKeepSelected		TRUE holds the chip select active after the transfer
+ *	@retval		TRUE				The transfer completed.
+ *	@retval		FALSE				The SPI driver refused the transfer.
+ */
+_Check_return_
+static BOOL
+DeviceAccessSpi_Clock(
+	_In_opt_bytecount_(PunSize)		const BYTE*		PrgbTransmit,
+	_Out_opt_bytecap_(PunSize)		BYTE*			PrgbReceive,
+	_In_							unsigned int	PunSize,
+	_In_							BOOL			PfKeepSelected)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	struct spi_ioc_transfer sTransfer;
+
+	memset(&sTransfer, 0, sizeof(sTransfer));
+	sTransfer.tx_buf = (uintptr_t)PrgbTransmit;
+	sTransfer.rx_buf = (uintptr_t)PrgbReceive;
+	sTransfer.len = PunSize;
+	sTransfer.cs_change = PfKeepSelected ? 1 : 0;
+
+	if (ioctl(pSession->nSpiFileHandle, SPI_IOC_MESSAGE(1), &sTransfer) < 0)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: SPI transfer of %u bytes failed with errno %d (%s).", PunSize, errno, strerror(errno));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Run one TPM SPI transaction
+ *	@details
+ *
+ *	@param		PunSpiAddress		24-bit register address on the SPI bus
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of data bytes (1 to DEVICE_ACCESS_SPI_MAX_TRANSFER)
+ *	@param		PfRead				TRUE to read, FALSE to write
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_NOT_READY		The TPM did not end the wait states.
+ *	@retval		RC_E_INTERNAL		The SPI transfer failed.
+ */
+_Check_return_
+static unsigned int
+DeviceAccessSpi_Transaction(
+	_In_						unsigned int	PunSpiAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BOOL			PfRead)
+{
+	BYTE rgbHeader[DEVICE_ACCESS_SPI_HEADER_SIZE] = {0};
+	BYTE rgbHeaderIn[DEVICE_ACCESS_SPI_HEADER_SIZE] = {0};
+	BYTE bWait = 0;
+	unsigned int unWaitStates = 0;
+
+	rgbHeader[0] = (BYTE)((PfRead ? DEVICE_ACCESS_SPI_READ : 0) | (PunSize - 1));
+	rgbHeader[1] = (BYTE)(PunSpiAddress >> 16);
+	rgbHeader[2] = (BYTE)(PunSpiAddress >> 8);
+	rgbHeader[3] = (BYTE)PunSpiAddress;
+
+	if (!DeviceAccessSpi_Clock(rgbHeader, rgbHeaderIn, sizeof(rgbHeader), TRUE))
+		return RC_E_INTERNAL;
+
+	// The TPM inserts wait states while the last bit it sent is 0
+	bWait = rgbHeaderIn[DEVICE_ACCESS_SPI_HEADER_SIZE - 1];
+	while (0 == (bWait & 0x01))
+	{
+		if (++unWaitStates > DEVICE_ACCESS_SPI_MAX_WAIT_STATES || !DeviceAccessSpi_Clock(NULL, &bWait, sizeof(bWait), TRUE))
+		{
+			// Release the chip select, the TPM discards the transaction
+			IGNORE_RETURN_VALUE(DeviceAccessSpi_Clock(NULL, NULL, 0, FALSE));
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: The TPM did not end the wait states of the SPI transaction at 0x%.6X.", PunSpiAddress);
+			return unWaitStates > DEVICE_ACCESS_SPI_MAX_WAIT_STATES ? RC_E_NOT_READY : RC_E_INTERNAL;
+		}
+	}
+
+	if (!DeviceAccessSpi_Clock(PfRead ? NULL : PrgbData, PfRead ? PrgbData : NULL, PunSize, FALSE))
+		return RC_E_INTERNAL;
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Read a register of up to 32 bits through the SPI device
+ *	@details	The TIS registers are little endian.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the register in bytes
+ *	@param		PpunValue			Receives the register value, all bits set if the transfer failed (like a read from
+ *									a missing device)
+ *	@retval		TRUE				The register address is valid.
+ *	@retval		FALSE				The register lies outside the locality registers.
+ */
+_Check_return_
+static BOOL
+DeviceAccessSpi_ReadRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunValue)
+{
+	BYTE rgbValue[sizeof(UINT32)] = {0xFF, 0xFF, 0xFF, 0xFF};
+	unsigned int unReturnValue = DeviceAccessSpi_Transfer(PunMemoryAddress, rgbValue, PunSize, TRUE, FALSE);
+
+	if (RC_E_BAD_PARAMETER == unReturnValue)
+		return FALSE;
+	if (RC_SUCCESS != unReturnValue)
+		IGNORE_RETURN_VALUE(Platform_MemorySet(rgbValue, 0xFF, sizeof(rgbValue)));
+
+	*PpunValue = (unsigned int)rgbValue[0] | ((unsigned int)rgbValue[1] << 8) | ((unsigned int)rgbValue[2] << 16) | ((unsigned int)rgbValue[3] << 24);
+	return TRUE;
+}
+
+/**
+ *	@brief		Write a register of up to 32 bits through the SPI device
+ *	@details	The TIS registers are little endian.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunData				Register value
+ *	@param		PunSize				Size of the register in bytes
+ *	@retval		TRUE				The register address is valid.
+ *	@retval		FALSE				The register lies outside the locality registers.
+ */
+_Check_return_
+static BOOL
+DeviceAccessSpi_WriteRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData,
+	_In_	unsigned int	PunSize)
+{
+	BYTE rgbValue[sizeof(UINT32)] = {(BYTE)PunData, (BYTE)(PunData >> 8), (BYTE)(PunData >> 16), (BYTE)(PunData >> 24)};
+
+	return RC_E_BAD_PARAMETER != DeviceAccessSpi_Transfer(PunMemoryAddress, rgbValue, PunSize, FALSE, FALSE);
+}
+
+/**
+ *	@brief		Read or write registers through the SPI device
+ *	@details	A TPM SPI transaction transfers up to 64 bytes to or from a FIFO at once, regardless of the access size.
+ *
+ *	@param		PunMemoryAddress	Start address of the registers (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of bytes to be transferred
+ *	@param		PbAccessSize		Maximum width of a single FIFO register access (unused)
+ *	@param		PfRead				TRUE to read the registers, FALSE to write them
+ *	@param		PfFifo				TRUE to access the same address with all transactions (FIFO register)
+ *	@returns	Return code of DeviceAccessSpi_Transfer
+ */
+_Check_return_
+static unsigned int
+DeviceAccessSpi_TransferRegisters(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo)
+{
+	UNREFERENCED_PARAMETER(PbAccessSize);
+	return DeviceAccessSpi_Transfer(PunMemoryAddress, PrgbData, PunSize, PfRead, PfFifo);
+}
+
+/// Register access functions of the SPI device
+static const IfxDeviceAccessOps s_sSpiRegisterOps = {DeviceAccessSpi_ReadRegister, DeviceAccessSpi_WriteRegister, DeviceAccessSpi_TransferRegisters};
+
+/**
+ *	@brief		Initialize the device access via an SPI device
+ *	@details	Opens the spidev device in SPI mode 0. The device is an SPI controller of the host or a USB-SPI bridge
+ *				with a Linux SPI driver. The TIS registers of the given locality are accessed through the TPM SPI protocol
+ *				from then on.
+ *
+ *	@param		PwszDevicePath				Path of the spidev device
+ *	@param		PbLocality					Locality value
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	The locality is not supported.
+ *	@retval		RC_E_TPM_ACCESS_DENIED		Read-write access to the SPI device was denied.
+ *	@retval		RC_E_NO_TPM					The SPI device cannot be opened or configured.
+ *	@retval		RC_E_INVALID_SETTING		The device path or the SPI_SPEED setting is invalid.
+ */
+_Check_return_
+unsigned int
+DeviceAccessSpi_Initialize(
+	_In_z_	const wchar_t*	PwszDevicePath,
+	_In_	BYTE			PbLocality)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+	int nFileHandle = -1;
+
+	do
+	{
+		char szDevicePath[MAX_PATH] = {0};
+		BYTE bMode = SPI_MODE_0;
+		BYTE bBitsPerWord = 8;
+		unsigned int unSpeed = 0;
+
+		if (PbLocality > DEVICE_ACCESS_MAX_LOCALITY)
+		{
+			unReturnValue = RC_E_LOCALITY_NOT_SUPPORTED;
+			break;
+		}
+
+		if ((size_t)-1 == wcstombs(szDevicePath, PwszDevicePath, sizeof(szDevicePath) - 1))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid SPI device path %ls.", PwszDevicePath);
+			break;
+		}
+
+		if (PropertyStorage_ExistsElement(PROPERTY_TPM_SPI_SPEED) &&
+				(!PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_SPI_SPEED, &unSpeed) || 0 == unSpeed))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1(L"Error: Invalid SPI speed setting.");
+			break;
+		}
+
+		nFileHandle = open(szDevicePath, O_RDWR);
+		if (-1 == nFileHandle)
+		{
+			unReturnValue = EACCES == errno ? RC_E_TPM_ACCESS_DENIED : RC_E_NO_TPM;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Open SPI device %s failed with errno %d (%s).", szDevicePath, errno, strerror(errno));
+			break;
+		}
+
+		// The TPM samples on the rising edge with the clock idle low, most significant bit first
+		if (ioctl(nFileHandle, SPI_IOC_WR_MODE, &bMode) < 0 || ioctl(nFileHandle, SPI_IOC_WR_BITS_PER_WORD, &bBitsPerWord) < 0 ||
+				(0 != unSpeed && ioctl(nFileHandle, SPI_IOC_WR_MAX_SPEED_HZ, &unSpeed) < 0))
+		{
+			unReturnValue = RC_E_NO_TPM;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Configuring SPI device %s failed with errno %d (%s).", szDevicePath, errno, strerror(errno));
+			break;
+		}
+		if (ioctl(nFileHandle, SPI_IOC_RD_MAX_SPEED_HZ, &unSpeed) < 0)
+			unSpeed = 0;
+
+		LOGGING_WRITE_LEVEL4_FMT(L"Opened SPI device %s (%u Hz) for the locality %d registers", szDevicePath, unSpeed, PbLocality);
+		pSession->nSpiFileHandle = nFileHandle;
+		pSession->fSpiAccess = TRUE;
+		pSession->unMemoryOffset = (unsigned int)PbLocality * DEVICE_ACCESS_LOCALITY_SIZE;
+		pSession->bMemoryInterface = DEVICE_ACCESS_INTERFACE_UNKNOWN;
+		DeviceAccess_BindRegisters(&s_sSpiRegisterOps);
+		nFileHandle = -1;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nFileHandle)
+		IGNORE_RETURN_VALUE(close(nFileHandle));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		UnInitialize the device access via an SPI device
+ *	@details
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_INTERNAL	The SPI device is not opened.
+ */
+_Check_return_
+unsigned int
+DeviceAccessSpi_Uninitialize()
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_INTERNAL;
+
+	if (pSession->fSpiAccess)
+	{
+		if (close(pSession->nSpiFileHandle) == -1)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Close SPI device failed with errno %d (%s).", errno, strerror(errno));
+		}
+		else
+		{
+			unReturnValue = RC_SUCCESS;
+		}
+	}
+	DeviceAccess_BindRegisters(NULL);
+	pSession->fSpiAccess = FALSE;
+	pSession->nSpiFileHandle = -1;
+	pSession->unMemoryOffset = 0;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Check whether the TIS registers are accessed via an SPI device
+ *
+ *	@retval		TRUE	DeviceAccessSpi_Initialize opened the SPI device.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccessSpi_IsOpen()
+{
+	return Session_GetCurrent()->fSpiAccess;
+}
+
+/**
+ *	@brief		Read or write TIS registers via the SPI device
+ *	@details	The data is split into TPM SPI transactions of up to DEVICE_ACCESS_SPI_MAX_TRANSFER bytes. Wait states
+ *				inserted by the TPM are handled. The accessed range must lie within the registers of the locality
+ *				passed to DeviceAccessSpi_Initialize.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of bytes to be transferred
+ *	@param		PfRead				TRUE to read the registers, FALSE to write them
+ *	@param		PfFifo				TRUE to access the same address with all transactions (FIFO register), FALSE to
+ *									access consecutive addresses
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_READY		The TPM did not end the wait states.
+ *	@retval		RC_E_INTERNAL		The SPI transfer failed.
+ */
+_Check_return_
+unsigned int
+DeviceAccessSpi_Transfer(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unOffset = 0;
+	unsigned int unPosition = 0;
+
+	if (!Session_GetCurrent()->fSpiAccess || NULL == PrgbData ||
+			!DeviceAccess_GetWindowOffset(PunMemoryAddress, PfFifo ? sizeof(BYTE) : PunSize, &unOffset))
+	{
+		LOGGING_WRITE_LEVEL4_FMT(L"Error: DeviceAccessSpi_Transfer: Register range %0.4X (%d bytes) is invalid!", PunMemoryAddress, PunSize);
+		return RC_E_BAD_PARAMETER;
+	}
+
+	while (unPosition < PunSize)
+	{
+		unsigned int unChunk = PunSize - unPosition > DEVICE_ACCESS_SPI_MAX_TRANSFER ? DEVICE_ACCESS_SPI_MAX_TRANSFER : PunSize - unPosition;
+		unsigned int unAddress = PunMemoryAddress - TPM_DEFAULT_MEM_BASE + (PfFifo ? 0 : unPosition);
+
+		unReturnValue = DeviceAccessSpi_Transaction(((unsigned int)DEVICE_ACCESS_SPI_ADDRESS_PREFIX << 16) | unAddress, &PrgbData[unPosition], unChunk, PfRead);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unPosition += unChunk;
+	}
+
+	return unReturnValue;
+}
@@ -0,0 +1,84 @@
+﻿/**
+ *	@brief		Declares the Device access routines via an SPI bus (spidev)
+ *	@details
+ *	@file		Linux/DeviceAccessSpi.h
+ *	@copyright	Copyright 2016 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/// Maximum number of data bytes of one TPM SPI transaction
+#define DEVICE_ACCESS_SPI_MAX_TRANSFER		64U
+
+/**
+ *	@brief		Initialize the device access via an SPI device
+ *	@details	Opens the spidev device in SPI mode 0. The device is an SPI controller of the host or a USB-SPI bridge
+ *				with a Linux SPI driver. The TIS registers of the given locality are accessed through the TPM SPI protocol
+ *				from then on.
+ *
+ *	@param		PwszDevicePath				Path of the spidev device
+ *	@param		PbLocality					Locality value
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	The locality is not supported.
+ *	@retval		RC_E_TPM_ACCESS_DENIED		Read-write access to the SPI device was denied.
+ *	@retval		RC_E_NO_TPM					The SPI device cannot be opened or configured.
+ *	@retval		RC_E_INVALID_SETTING		The device path or the SPI_SPEED setting is invalid.
+ */
+_Check_return_
+unsigned int
+DeviceAccessSpi_Initialize(
+	_In_z_	const wchar_t*	PwszDevicePath,
+	_In_	BYTE			PbLocality);
+
+/**
+ *	@brief		UnInitialize the device access via an SPI device
+ *	@details
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_INTERNAL	The SPI device is not opened.
+ */
+_Check_return_
+unsigned int
+DeviceAccessSpi_Uninitialize();
+
+/**
+ *	@brief		Check whether the TIS registers are accessed via an SPI device
+ *
+ *	@retval		TRUE	DeviceAccessSpi_Initialize opened the SPI device.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+DeviceAccessSpi_IsOpen();
+
+/**
+ *	@brief		Read or write TIS registers via the SPI device
+ *	@details	The data is split into TPM SPI transactions of up to DEVICE_ACCESS_SPI_MAX_TRANSFER bytes. Wait states
+ *				inserted by the TPM are handled. The accessed range must lie within the registers of the locality
+ *				passed to DeviceAccessSpi_Initialize.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of bytes to be transferred
+ *	@param		PfRead				TRUE to read the registers, FALSE to write them
+ *	@param		PfFifo				TRUE to access the same address with all transactions (FIFO register), FALSE to
+ *									access consecutive addresses
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_READY		The TPM did not end the wait states.
+ *	@retval		RC_E_INTERNAL		The SPI transfer failed.
+ */
+_Check_return_
+unsigned int
+DeviceAccessSpi_Transfer(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo);
@@ -14,13 +14,28 @@
  */
 
 #include "StdInclude.h"
+#include <poll.h>
 #include "DeviceAccessTpmDriver.h"
 #include "Logging.h"
 #include "Platform.h"
 #include "PropertyStorage.h"
+#include "TpmIO.h"
 
 #define DEV_TPM "/dev/tpm0"
 
+/// Initial wait time in microseconds before a write that failed with EBUSY is retried
+#define DEV_TPM_BUSY_INITIAL_WAIT_TIME_US 1000
+/// Maximum wait time in microseconds between two write retries
+#define DEV_TPM_BUSY_MAX_WAIT_TIME_US 250000
+/// Maximum accumulated wait time in microseconds for write retries
+#define DEV_TPM_BUSY_TOTAL_WAIT_TIME_US 5000000
+
+/// File descriptor of the opened TPM device, -1 while the device is not opened
+static int s_nFileHandle = -1;
+
+/// Wait statistics accumulated since the start of the application
+static IfxTpmIoStatistics s_sStatistics = {0, 0, 0, 0, 0, 0};
+
 /**
  *	@brief		Initialize the device access via config setting DEVICE_PATH
  *	@details	Default value is /dev/tpm0. If an invalid device path is configured
@@ -44,7 +59,7 @@ DeviceAccessTpmDriver_Initialize()
 		wchar_t wszDevicePath[PROPERTY_STORAGE_MAX_VALUE] = {0};
 		UINT32 unDevicePathSize = RG_LEN(wszDevicePath);
 
-		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize))
+		if (FALSE == PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize))
 		{
 			unReturnValue = RC_E_INTERNAL;
 			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving PROPERTY_TPM_DEVICE_ACCESS_PATH failed (%.8x).", unReturnValue);
@@ -53,7 +68,7 @@ DeviceAccessTpmDriver_Initialize()
 
 		unDevicePathSize = wcstombs(szDevicePath, wszDevicePath, unDevicePathSize + 1 );
 
-		unFileHandle = open(szDevicePath, O_RDWR);
+		unFileHandle = open(szDevicePath, O_RDWR | O_NONBLOCK);
 		if (unFileHandle == (UINT32) - 1)
 		{
 			int nErrorNumber = errno;
@@ -68,12 +83,7 @@ DeviceAccessTpmDriver_Initialize()
 			break;
 		}
 
-		if (!PropertyStorage_AddKeyUIntegerValuePair(PROPERTY_DEV_TPM_HANDLE, unFileHandle))
-		{
-			unReturnValue = RC_E_INTERNAL;
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Storing device handle failed (%.8x).", unReturnValue);
-			break;
-		}
+		s_nFileHandle = (int)unFileHandle;
 
 		unReturnValue = RC_SUCCESS;
 	}
@@ -87,7 +97,7 @@ DeviceAccessTpmDriver_Initialize()
  *	@details
  *
  *	@retval		RC_SUCCESS		The operation completed successfully.
- *	@retval		RC_E_INTERNAL	If the DEV_TPM_HANDLE is not present in the property PropertyStorage
+ *	@retval		RC_E_INTERNAL	If the TPM device is not opened
  *	@retval		RC_E_FAIL		An unexpected error occurred.
  */
 _Check_return_
@@ -97,26 +107,23 @@ DeviceAccessTpmDriver_Uninitialize()
 	unsigned int unReturnValue = RC_E_FAIL;
 	do
 	{
-		UINT32 unFileHandle = 0;
+		int nFileHandle = s_nFileHandle;
 
-		if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_DEV_TPM_HANDLE, &unFileHandle) ||
-				0 == unFileHandle)
+		if (-1 == nFileHandle)
 		{
 			unReturnValue = RC_E_INTERNAL;
 			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving device handle failed (%.8x).", unReturnValue);
 			break;
 		}
 
-		if (close(unFileHandle) == -1)
+		s_nFileHandle = -1;
+		if (close(nFileHandle) == -1)
 		{
 			unReturnValue = RC_E_FAIL;
 			LOGGING_WRITE_LEVEL1_FMT(L"Error: Close device pseudo file failed with errno %d (%s).", errno, strerror(errno));
 			break;
 		}
 
-		if (!PropertyStorage_RemoveElement(PROPERTY_DEV_TPM_HANDLE))
-			LOGGING_WRITE_LEVEL3_FMT(L"Error: Removing device handle (%.8x).", unReturnValue);
-
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
@@ -126,17 +133,21 @@ DeviceAccessTpmDriver_Uninitialize()
 
 /**
  *	@brief		TPM transmit function
- *	@details	This function submits the TPM command to the underlying TPM.
+ *	@details	This function submits the TPM command to the underlying TPM. The device is opened in non-blocking
+ *				mode. A busy device is retried with an exponential backoff and the response is awaited with poll()
+ *				until the maximum duration of the command has elapsed.
  *
  *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
  *	@param		PunRequestBufferSize	Size of command request in bytes
  *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
  *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
  *
- *	@retval		RC_SUCCESS				The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
- *	@retval		RC_E_INTERNAL			If the DEV_TPM_HANDLE is not present in the property PropertyStorage
- *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INTERNAL				If the TPM device is not opened
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	No response was received within the maximum duration of the command.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
  */
 _Check_return_
 unsigned int
@@ -144,15 +155,20 @@ DeviceAccessTpmDriver_Transmit(
 	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
 	_In_										unsigned int	PunRequestBufferSize,
 	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
-	_Inout_										unsigned int*	PpunResponseBufferSize)
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	do
 	{
-		UINT32 unFileHandle = 0;
+		int nFileHandle = s_nFileHandle;
 		int nBytes = 0;
-		int nWriteRetryCounter = 0;
+		int nErrorNumber = 0;
+		unsigned int unWaitTime = DEV_TPM_BUSY_INITIAL_WAIT_TIME_US;
+		unsigned int unTotalWaitTime = 0;
+		unsigned long long ullDeadline = 0;
+		unsigned long long ullWaitStartTime = 0;
 
 		// Check parameters
 		if (NULL == PrgbRequestBuffer || NULL == PrgbResponseBuffer || NULL == PpunResponseBufferSize)
@@ -161,41 +177,109 @@ DeviceAccessTpmDriver_Transmit(
 			break;
 		}
 
-		if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_DEV_TPM_HANDLE, &unFileHandle) ||
-				0 == unFileHandle)
+		if (-1 == nFileHandle)
 		{
 			unReturnValue = RC_E_INTERNAL;
 			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving device handle failed (%.8x).", unReturnValue);
 			break;
 		}
 
-		while (1) {
-			nBytes = write(unFileHandle, PrgbRequestBuffer, PunRequestBufferSize);
-			if (nBytes == -1 && errno == EBUSY && ++nWriteRetryCounter < 5) {
-				LOGGING_WRITE_LEVEL1(L"Error: DeviceAccess_Transmit: Write failed with EBUSY, retrying.");
-				Platform_Sleep(1000);
-			} else {
+		// Submit the command, retry with an exponential backoff while another process is using the device
+		do
+		{
+			nBytes = write(nFileHandle, PrgbRequestBuffer, PunRequestBufferSize);
+			nErrorNumber = errno;
+			if (nBytes != -1 || (EBUSY != nErrorNumber && EAGAIN != nErrorNumber) || unTotalWaitTime >= DEV_TPM_BUSY_TOTAL_WAIT_TIME_US)
 				break;
-			}
+
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: Write failed with errno %d (%s), retrying in %d microseconds.", nErrorNumber, strerror(nErrorNumber), unWaitTime);
+			s_sStatistics.ullWaitIterations++;
+			s_sStatistics.ullWaitTimeMicroSeconds += unWaitTime;
+			Platform_SleepMicroSeconds(unWaitTime);
+			unTotalWaitTime += unWaitTime;
+			unWaitTime *= 2;
+			if (unWaitTime > DEV_TPM_BUSY_MAX_WAIT_TIME_US)
+				unWaitTime = DEV_TPM_BUSY_MAX_WAIT_TIME_US;
 		}
+		while (TRUE);
 
 		if (nBytes == -1 || nBytes != (int)PunRequestBufferSize)
 		{
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: Write failed with errno %d (%s).", errno, strerror(errno));
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: Write failed with errno %d (%s).", nErrorNumber, strerror(nErrorNumber));
 			unReturnValue = RC_E_FAIL;
 			break;
 		}
-		nBytes = read(unFileHandle, PrgbResponseBuffer, *PpunResponseBufferSize);
-		if (nBytes == -1)
+
+		// The TPM executes the command now, give the caller the chance to do host-side work in the meantime
+		TPMIO_CommandPending();
+
+		// Wait for the response until the maximum duration of the command has elapsed
+		ullWaitStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		ullDeadline = ullWaitStartTime + PunMaxDuration;
+		do
 		{
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: Read failed with errno %d (%s).", errno, strerror(errno));
-			unReturnValue = RC_E_FAIL;
-			break;
+			struct pollfd sPollFd;
+			unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+			int nTimeout = 0;
+
+			if (ullNow < ullDeadline)
+				nTimeout = (int)((ullDeadline - ullNow + 999) / 1000);
+
+			sPollFd.fd = nFileHandle;
+			sPollFd.events = POLLIN;
+			sPollFd.revents = 0;
+			s_sStatistics.ullWaitIterations++;
+			nBytes = poll(&sPollFd, 1, nTimeout);
+			if (nBytes == -1 && EINTR == errno)
+				continue;
+			if (nBytes == -1)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: Poll failed with errno %d (%s).", errno, strerror(errno));
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+			if (nBytes == 0)
+			{
+				unReturnValue = RC_E_TPM_NO_DATA_AVAILABLE;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: No response after timeout of %d microseconds (0x%.8x).", PunMaxDuration, unReturnValue);
+				break;
+			}
+
+			nBytes = read(nFileHandle, PrgbResponseBuffer, *PpunResponseBufferSize);
+			if (nBytes == -1 && (EAGAIN == errno || EINTR == errno))
+				continue;
+			if (nBytes == -1)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: DeviceAccess_Transmit: Read failed with errno %d (%s).", errno, strerror(errno));
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+
+			*PpunResponseBufferSize = nBytes;
+			unReturnValue = RC_SUCCESS;
 		}
-		*PpunResponseBufferSize = nBytes;
-		unReturnValue = RC_SUCCESS;
+		while (RC_SUCCESS != unReturnValue);
+
+		// The process is blocked in poll() and read() while the TPM executes the command
+		if (0 != ullWaitStartTime)
+			s_sStatistics.ullWaitTimeMicroSeconds += Platform_GetMonotonicTimeMicroSeconds() - ullWaitStartTime;
 	}
 	WHILE_FALSE_END;
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Returns the TPM driver wait statistics
+ *	@details	Returns the number and the accumulated duration of the waits for the TPM driver since the start of the
+ *				application. Only the wait values of the structure are set, all other values are zero.
+ *
+ *	@param		PpStatistics		Pointer to a structure receiving the statistics
+ */
+void
+DeviceAccessTpmDriver_GetStatistics(
+	_Out_	IfxTpmIoStatistics*	PpStatistics)
+{
+	if (NULL != PpStatistics)
+		*PpStatistics = s_sStatistics;
+}
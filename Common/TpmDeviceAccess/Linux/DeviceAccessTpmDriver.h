@@ -13,8 +13,7 @@
  *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-/// Define for the PropertyStorage key Device TPM Handle
-#define PROPERTY_DEV_TPM_HANDLE L"DevTpmHandle"
+#include "TpmIO.h"
 
 /**
  *	@brief		Initialize the device access via config setting DEVICE_PATH
@@ -34,7 +33,7 @@ DeviceAccessTpmDriver_Initialize();
  *	@details
  *
  *	@retval		RC_SUCCESS		The operation completed successfully.
- *	@retval		RC_E_INTERNAL	If the DEV_TPM_HANDLE is not present in the property PropertyStorage
+ *	@retval		RC_E_INTERNAL	If the TPM device is not opened
  *	@retval		RC_E_FAIL		An unexpected error occurred.
  */
 _Check_return_
@@ -43,17 +42,21 @@ DeviceAccessTpmDriver_Uninitialize();
 
 /**
  *	@brief		TPM transmit function
- *	@details	This function submits the TPM command to the underlying TPM.
+ *	@details	This function submits the TPM command to the underlying TPM. The device is opened in non-blocking
+ *				mode. A busy device is retried with an exponential backoff and the response is awaited with poll()
+ *				until the maximum duration of the command has elapsed.
  *
  *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
  *	@param		PunRequestBufferSize	Size of command request in bytes
  *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
  *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
  *
- *	@retval		RC_SUCCESS				The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
- *	@retval		RC_E_INTERNAL			If the DEV_TPM_HANDLE is not present in the property PropertyStorage
- *	@retval		RC_E_FAIL				An unexpected error occurred.
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INTERNAL				If the TPM device is not opened
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	No response was received within the maximum duration of the command.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
  */
 _Check_return_
 unsigned int
@@ -61,4 +64,16 @@ DeviceAccessTpmDriver_Transmit(
 	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
 	_In_										unsigned int	PunRequestBufferSize,
 	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
-	_Inout_										unsigned int*	PpunResponseBufferSize);
\ No newline at end of file
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration);
+
+/**
+ *	@brief		Returns the TPM driver wait statistics
+ *	@details	Returns the number and the accumulated duration of the waits for the TPM driver since the start of the
+ *				application. Only the wait values of the structure are set, all other values are zero.
+ *
+ *	@param		PpStatistics		Pointer to a structure receiving the statistics
+ */
+void
+DeviceAccessTpmDriver_GetStatistics(
+	_Out_	IfxTpmIoStatistics*	PpStatistics);
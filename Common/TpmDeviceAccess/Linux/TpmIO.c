@@ -18,13 +18,1258 @@
 #include "Logging.h"
 #include "DeviceAccess.h"
 #include "DeviceAccessTpmDriver.h"
+#include "DeviceAccessSpi.h"
 #include "TPM_TIS.h"
+#include "TPM_CRB.h"
+#include "TpmSimulator.h"
+#include "TpmTisSimulator.h"
+#include "TpmReplay.h"
+#include "TpmSocket.h"
 #include "PropertyStorage.h"
+#include "Platform.h"
+#include "FileIO.h"
+#include "Session.h"
+#include "Probes.h"
 
-/// Global flag to signalize if module is connected or disconnected
-BOOL g_fConnected = 0;
-/// Define for locality configuration setting property
-#define PROPERTY_LOCALITY				L"Locality"
+/**
+ *	@brief		Function pointer type for the backend specific transmit function
+ */
+typedef unsigned int (*PFN_TPMIO_BACKEND_TRANSMIT)(const BYTE*, unsigned int, BYTE*, unsigned int*, unsigned int, unsigned int);
+/**
+ *	@brief		Function pointer type for the backend specific transmit function of a request given in several parts
+ */
+typedef unsigned int (*PFN_TPMIO_BACKEND_TRANSMITSEGMENTS)(const IfxTpmIoSegment*, unsigned int, BYTE*, unsigned int*, unsigned int, unsigned int);
+/**
+ *	@brief		Function pointer type for the backend specific transmit function of several requests in one round trip
+ */
+typedef unsigned int (*PFN_TPMIO_BACKEND_TRANSMITBATCH)(const IfxTpmIoSegment*, unsigned int, unsigned int, unsigned int*, unsigned int*, unsigned int);
+/**
+ *	@brief		Function pointer type for the backend specific read register function
+ */
+typedef unsigned int (*PFN_TPMIO_BACKEND_READREGISTER)(unsigned int, BYTE*);
+/**
+ *	@brief		Function pointer type for the backend specific write register function
+ */
+typedef unsigned int (*PFN_TPMIO_BACKEND_WRITEREGISTER)(unsigned int, BYTE);
+
+/**
+ *	@brief		Represents the TPM access backend bound by TPMIO_Connect
+ *	@details	Holds the device access mode, the locality and the backend functions so that the device access mode
+ *				and locality properties do not have to be looked up for each TPM command or register access.
+ */
+typedef struct tdIfxTpmIoBackend
+{
+	/// Device access mode of the connection
+	UINT32 unAccessMode;
+	/// Locality used for memory based access
+	BYTE bLocality;
+	/// Determines whether memory based access uses the CRB interface instead of the TIS FIFO interface
+	BOOL fCrbInterface;
+	/// Backend specific transmit function
+	PFN_TPMIO_BACKEND_TRANSMIT fpTransmit;
+	/// Backend specific transmit function of a request given in several parts, NULL if the backend needs one buffer
+	PFN_TPMIO_BACKEND_TRANSMITSEGMENTS fpTransmitSegments;
+	/// Backend specific transmit function of several requests in one round trip, NULL if the backend has none
+	PFN_TPMIO_BACKEND_TRANSMITBATCH fpTransmitBatch;
+	/// Backend specific read register function
+	PFN_TPMIO_BACKEND_READREGISTER fpReadRegister;
+	/// Backend specific write register function
+	PFN_TPMIO_BACKEND_WRITEREGISTER fpWriteRegister;
+} IfxTpmIoBackend;
+
+/// Backend of the current connection, all function pointers are NULL while not connected
+static IfxTpmIoBackend s_sBackend = {0, 0, FALSE, NULL, NULL, NULL, NULL, NULL};
+
+/// Maximum size of a request which is copied into one buffer for a backend without support for requests in several parts
+#define TPMIO_MAX_REQUEST_SIZE 4096
+
+/// Buffer for requests given in several parts to a backend without support for them
+static BYTE s_rgbGatherBuffer[TPMIO_MAX_REQUEST_SIZE];
+
+/// Callback function invoked while a TPM command is executed by the TPM
+static PFN_TPMIO_CommandPendingCallback s_fpCommandPending = NULL;
+
+/// Prefix of the lock files serializing the access of several instances to a TPM device
+#define TPMIO_DEVICE_LOCK_PREFIX L"/run/lock/TPMFactoryUpd"
+/// Default time in seconds to wait for another instance using the TPM device (covers a firmware update)
+#define TPMIO_DEVICE_LOCK_DEFAULT_TIMEOUT 600
+
+/// Number of round trips measured per backend by the automatic access mode
+#define TPMIO_AUTO_PROBE_COUNT 3
+/// Response buffer size of the automatic access mode probe command
+#define TPMIO_AUTO_PROBE_RESPONSE_SIZE 64
+/// Maximum duration of the automatic access mode probe command in microseconds
+#define TPMIO_AUTO_PROBE_MAX_DURATION 750000
+
+/// Magic value identifying a TIS tuning file
+#define TPMIO_TUNING_MAGIC 0x49465455
+/// Maximum number of TIS tuning profiles in the tuning file
+#define TPMIO_TUNING_MAX_PROFILES 8
+/// Maximum length of the key of a TIS tuning profile in wide characters including zero termination
+#define TPMIO_TUNING_KEY_SIZE 96
+/// DMI product name of the platform, part of the key of a TIS tuning profile
+#define TPMIO_TUNING_PRODUCT_NAME "/sys/class/dmi/id/product_name"
+
+/**
+ *	@brief		Represents the TIS tuning profile of one platform and TPM
+ */
+typedef struct tdIfxTpmIoTuningProfile
+{
+	/// TPM identity and platform the profile was calibrated on (see TPMIO_GetTuningKey)
+	wchar_t wszKey[TPMIO_TUNING_KEY_SIZE];
+	/// Calibrated polling parameters
+	IfxTisTuning sTuning;
+} IfxTpmIoTuningProfile;
+
+/**
+ *	@brief		Layout of the TIS tuning file
+ *	@details	The profiles are ordered from the most to the least recently calibrated one.
+ */
+typedef struct tdIfxTpmIoTuningFile
+{
+	/// Magic value (TPMIO_TUNING_MAGIC)
+	unsigned int unMagic;
+	/// Number of used entries in rgsProfiles
+	unsigned int unCount;
+	/// Profiles per platform and TPM
+	IfxTpmIoTuningProfile rgsProfiles[TPMIO_TUNING_MAX_PROFILES];
+} IfxTpmIoTuningFile;
+
+/**
+ *	@brief		Locks the TPM device against other instances
+ *	@details	Acquires the lock file of the device path in /run/lock. Another instance holding the lock is waited for
+ *				up to PROPERTY_TPM_DEVICE_LOCK_TIMEOUT seconds without polling. The lock is advisory, the connection
+ *				continues without it if the lock file cannot be created (e.g. missing rights).
+ *
+ *	@param		PwszDevicePath					Path of the TPM device
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_DEVICE_ALREADY_IN_USE		Another instance still uses the TPM device when the timeout expired.
+ */
+_Check_return_
+static unsigned int
+TPMIO_LockDevice(
+	_In_z_ const wchar_t* PwszDevicePath)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszLockFile[MAX_PATH] = {0};
+		unsigned int unLockFileSize = RG_LEN(wszLockFile);
+		unsigned int unTimeout = TPMIO_DEVICE_LOCK_DEFAULT_TIMEOUT;
+		unsigned int unIndex = 0;
+
+		if (PropertyStorage_ExistsElementById(PROPERTY_ID_TPM_DEVICE_LOCK_TIMEOUT) &&
+				!PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_LOCK_TIMEOUT, &unTimeout))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1(L"Error: Invalid device lock timeout setting.");
+			break;
+		}
+
+		// The lock file name is the device path with the path separators replaced
+		unReturnValue = Platform_StringFormat(wszLockFile, &unLockFileSize, L"%ls%ls.lock", TPMIO_DEVICE_LOCK_PREFIX, PwszDevicePath);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		for (unIndex = RG_LEN(TPMIO_DEVICE_LOCK_PREFIX) - 1; unIndex < unLockFileSize; unIndex++)
+		{
+			if (L'/' == wszLockFile[unIndex])
+				wszLockFile[unIndex] = L'_';
+		}
+
+		unReturnValue = FileIO_LockFile(wszLockFile, unTimeout, &pSession->pvDeviceLock);
+		if (RC_E_DEVICE_ALREADY_IN_USE == unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: The TPM device %ls is still used by another instance after %u seconds.", PwszDevicePath, unTimeout);
+			break;
+		}
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Warning: The TPM device %ls cannot be locked against other instances (0x%.8X).", PwszDevicePath, unReturnValue);
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL4_FMT(L"Locked TPM device %ls", PwszDevicePath);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		TPM transmit function for memory based access
+ *	@details	This function submits the TPM command through the TIS protocol.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TIS_TransceiveLPC function
+ */
+_Check_return_
+static unsigned int
+TPMIO_TransmitMemoryBased(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
+{
+	unsigned int unReturnValue = TIS_TransceiveLPC(
+									s_sBackend.bLocality,
+									PrgbRequestBuffer,
+									(UINT16)PunRequestBufferSize,
+									PrgbResponseBuffer,
+									(UINT16*)PpunResponseBufferSize,
+									PunMaxDuration,
+									PunExpectedDuration);
+
+	if (RC_SUCCESS != unReturnValue)
+		LOGGING_WRITE_LEVEL1(L"Transmission of data via TIS failed!");
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		TPM transmit function for memory based access of a request given in several parts
+ *	@details	This function writes the parts of the TPM command to the TIS data FIFO one after the other.
+ *
+ *	@param		PrgsRequestSegments		Parts of the TPM command request
+ *	@param		PunSegmentCount			Number of parts
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TIS_TransceiveSegmentsLPC function
+ */
+_Check_return_
+static unsigned int
+TPMIO_TransmitSegmentsMemoryBased(
+	_In_reads_(PunSegmentCount)					const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_										unsigned int			PunSegmentCount,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*					PrgbResponseBuffer,
+	_Inout_										unsigned int*			PpunResponseBufferSize,
+	_In_										unsigned int			PunMaxDuration,
+	_In_										unsigned int			PunExpectedDuration)
+{
+	unsigned int unReturnValue = TIS_TransceiveSegmentsLPC(
+									s_sBackend.bLocality,
+									PrgsRequestSegments,
+									PunSegmentCount,
+									PrgbResponseBuffer,
+									(UINT16*)PpunResponseBufferSize,
+									PunMaxDuration,
+									PunExpectedDuration);
+
+	if (RC_SUCCESS != unReturnValue)
+		LOGGING_WRITE_LEVEL1(L"Transmission of data via TIS failed!");
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		TPM transmit function for memory based access to a CRB interface
+ *	@details	This function submits the TPM command through the CRB command and response buffers.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from CRB_Transceive function
+ */
+_Check_return_
+static unsigned int
+TPMIO_TransmitCrb(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
+{
+	unsigned int unReturnValue = CRB_Transceive(
+									s_sBackend.bLocality,
+									PrgbRequestBuffer,
+									(UINT16)PunRequestBufferSize,
+									PrgbResponseBuffer,
+									(UINT16*)PpunResponseBufferSize,
+									PunMaxDuration,
+									PunExpectedDuration);
+
+	if (RC_SUCCESS != unReturnValue)
+		LOGGING_WRITE_LEVEL1(L"Transmission of data via CRB failed!");
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read a byte from a specific address (register) for memory based access
+ *	@details
+ *
+ *	@param		PunRegisterAddress		Register address
+ *	@param		PpbRegisterValue		Pointer to a byte to store the register value
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ */
+_Check_return_
+static unsigned int
+TPMIO_ReadRegisterMemoryBased(
+	_In_		unsigned int		PunRegisterAddress,
+	_Inout_		BYTE*				PpbRegisterValue)
+{
+	// Read byte from register address
+	*PpbRegisterValue = DeviceAccess_ReadByte(PunRegisterAddress);
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Write a byte to a specific address (register) for memory based access
+ *	@details
+ *
+ *	@param		PunRegisterAddress		Register address
+ *	@param		PbRegisterValue			Byte to write to the register address
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ */
+_Check_return_
+static unsigned int
+TPMIO_WriteRegisterMemoryBased(
+	_In_		unsigned int		PunRegisterAddress,
+	_In_		BYTE				PbRegisterValue)
+{
+	// Write byte to register address
+	DeviceAccess_WriteByte(PunRegisterAddress, PbRegisterValue);
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		TPM transmit function for the TPM driver
+ *	@details	This function submits the TPM command through the TPM driver or resource manager device.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from DeviceAccessTpmDriver_Transmit function
+ */
+_Check_return_
+static unsigned int
+TPMIO_TransmitTpmDriver(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	UNREFERENCED_PARAMETER(PunExpectedDuration);
+
+	unReturnValue = DeviceAccessTpmDriver_Transmit(
+						PrgbRequestBuffer,
+						(UINT16)PunRequestBufferSize,
+						PrgbResponseBuffer,
+						PpunResponseBufferSize,
+						PunMaxDuration);
+
+	if (RC_SUCCESS != unReturnValue)
+		LOGGING_WRITE_LEVEL1(L"Transmission of data via /dev/tpm0 failed!");
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Read a byte from a specific address (register) for the TPM driver
+ *	@details	Register access is not supported through the TPM driver and the simulated, replayed or software TPM backends.
+ *
+ *	@param		PunRegisterAddress			Register address (unused)
+ *	@param		PpbRegisterValue			Pointer to a byte to store the register value
+ *
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	Always
+ */
+_Check_return_
+static unsigned int
+TPMIO_ReadRegisterTpmDriver(
+	_In_		unsigned int		PunRegisterAddress,
+	_Inout_		BYTE*				PpbRegisterValue)
+{
+	unsigned int unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+
+	UNREFERENCED_PARAMETER(PunRegisterAddress);
+
+	*PpbRegisterValue = 0;
+	LOGGING_WRITE_LEVEL1_FMT(L"Error: Read/Write register is not supported while using the /dev/tpm0 driver or a simulated, replayed or software TPM (0x%.8x).", unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Write a byte to a specific address (register) for the TPM driver
+ *	@details	Register access is not supported through the TPM driver and the simulated, replayed or software TPM backends.
+ *
+ *	@param		PunRegisterAddress			Register address (unused)
+ *	@param		PbRegisterValue				Byte to write to the register address (unused)
+ *
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	Always
+ */
+_Check_return_
+static unsigned int
+TPMIO_WriteRegisterTpmDriver(
+	_In_		unsigned int		PunRegisterAddress,
+	_In_		BYTE				PbRegisterValue)
+{
+	unsigned int unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+
+	UNREFERENCED_PARAMETER(PunRegisterAddress);
+	UNREFERENCED_PARAMETER(PbRegisterValue);
+
+	LOGGING_WRITE_LEVEL1_FMT(L"Error: Read/Write register feature is not supported while using the /dev/tpm0 driver or a simulated, replayed or software TPM (0x%.8x).", unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Measures the round trip time of the bound backend
+ *	@details	Sends a TPM2_GetCapability command for one fixed TPM property TPMIO_AUTO_PROBE_COUNT times. The command
+ *				does not change the TPM state. A TPM1.2 answers with an error response, which serves the measurement as well.
+ *
+ *	@param		PpullRoundTrip			Receives the fastest round trip time in microseconds
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				The TPM sent no valid response header.
+ *	@retval		...						Error codes from the backend transmit function
+ */
+_Check_return_
+static unsigned int
+TPMIO_ProbeRoundTrip(
+	_Out_	unsigned long long*	PpullRoundTrip)
+{
+	// TPM2_GetCapability(TPM_CAP_TPM_PROPERTIES, TPM_PT_FAMILY_INDICATOR, 1)
+	static const BYTE rgbProbeCommand[] = {
+		0x80, 0x01, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x01, 0x7A,
+		0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01
+	};
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unIndex = 0;
+
+	*PpullRoundTrip = 0;
+
+	for (unIndex = 0; unIndex < TPMIO_AUTO_PROBE_COUNT; unIndex++)
+	{
+		BYTE rgbResponse[TPMIO_AUTO_PROBE_RESPONSE_SIZE] = {0};
+		unsigned int unResponseSize = sizeof(rgbResponse);
+		unsigned long long ullStart = Platform_GetMonotonicTimeMicroSeconds();
+		unsigned long long ullRoundTrip = 0;
+
+		unReturnValue = s_sBackend.fpTransmit(rgbProbeCommand, sizeof(rgbProbeCommand), rgbResponse, &unResponseSize, TPMIO_AUTO_PROBE_MAX_DURATION, 0);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		ullRoundTrip = Platform_GetMonotonicTimeMicroSeconds() - ullStart;
+
+		// A response starts with a 10 bytes header
+		if (unResponseSize < 10)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		if (0 == unIndex || ullRoundTrip < *PpullRoundTrip)
+			*PpullRoundTrip = ullRoundTrip;
+	}
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Builds the key of the TIS tuning profile of the platform and TPM
+ *	@details	The key combines vendor, device and revision identifier of the TPM with the DMI product name of the
+ *				platform, since the register access latency depends on both.
+ *
+ *	@param		PbLocality				Locality value
+ *	@param		PwszKey					Receives the key
+ *	@param		PpunKeySize				In: Capacity of PwszKey in wide characters, Out: Length of the key
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TIS_ReadRegister and Platform_StringFormat
+ */
+_Check_return_
+static unsigned int
+TPMIO_GetTuningKey(
+	_In_						BYTE			PbLocality,
+	_Out_z_cap_(*PpunKeySize)	wchar_t*		PwszKey,
+	_Inout_						unsigned int*	PpunKeySize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszProduct[TPMIO_TUNING_KEY_SIZE] = L"unknown";
+		char szProduct[TPMIO_TUNING_KEY_SIZE] = {0};
+		UINT16 usVendorId = 0;
+		UINT16 usDeviceId = 0;
+		BYTE bRevisionId = 0;
+		FILE* pFile = NULL;
+
+		unReturnValue = TIS_ReadRegister(PbLocality, TIS_TPM_VID, sizeof(UINT16), &usVendorId);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TIS_ReadRegister(PbLocality, TIS_TPM_DID, sizeof(UINT16), &usDeviceId);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TIS_ReadRegister(PbLocality, TIS_TPM_RID, sizeof(BYTE), &bRevisionId);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// The DMI product name is missing on platforms without SMBIOS, the TPM identity is used alone then
+		pFile = fopen(TPMIO_TUNING_PRODUCT_NAME, "r");
+		if (NULL != pFile)
+		{
+			if (NULL != fgets(szProduct, sizeof(szProduct), pFile))
+			{
+				unsigned int unIndex = 0;
+				for (unIndex = 0; unIndex < RG_LEN(wszProduct) - 1 && '\0' != szProduct[unIndex] && '\n' != szProduct[unIndex]; unIndex++)
+					wszProduct[unIndex] = (wchar_t)(BYTE)szProduct[unIndex];
+				wszProduct[unIndex] = L'\0';
+			}
+			fclose(pFile);
+		}
+
+		unReturnValue = Platform_StringFormat(PwszKey, PpunKeySize, L"%.4X:%.4X:%.2X %ls", usVendorId, usDeviceId, bRevisionId, wszProduct);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Applies or calibrates the TIS polling parameters of the platform and TPM
+ *	@details	PROPERTY_TPM_TUNING (TUNING of the [TPM_DEVICE_ACCESS] section) selects the behavior:
+ *				- auto (default): The profile stored for the platform and TPM in TPM_DEVICE_ACCESS_TUNING_FILE is used if
+ *				  there is one, otherwise the compile-time values.
+ *				- calibrate: The profile is measured with TPMIO_ProbeRoundTrip and TIS_Calibrate, used and stored.
+ *				- off: The compile-time values are used.
+ *				The file holds up to TPMIO_TUNING_MAX_PROFILES profiles, the least recently calibrated one is replaced.
+ *				Errors reading, measuring or storing a profile are logged only, the compile-time values are kept then.
+ *
+ *	@param		PbLocality				Locality value, the backend must be bound
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	PROPERTY_TPM_TUNING has an unknown value.
+ */
+_Check_return_
+static unsigned int
+TPMIO_ApplyTisTuning(
+	_In_	BYTE	PbLocality)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* prgbFile = NULL;
+
+	do
+	{
+		IfxTpmIoTuningFile sFile;
+		wchar_t wszMode[16] = {0};
+		unsigned int unModeSize = RG_LEN(wszMode);
+		wchar_t wszKey[TPMIO_TUNING_KEY_SIZE] = {0};
+		unsigned int unKeySize = RG_LEN(wszKey);
+		unsigned int unFileSize = 0;
+		unsigned int unIndex = 0;
+		BOOL fCalibrate = FALSE;
+		IfxTisTuning sTuning;
+		unsigned long long ullCommandTime = 0;
+		void* pvFile = NULL;
+
+		unReturnValue = RC_SUCCESS;
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_TUNING, wszMode, &unModeSize))
+		{
+			if (0 == Platform_StringCompare(wszMode, L"off", RG_LEN(wszMode), FALSE))
+				break;
+			if (0 == Platform_StringCompare(wszMode, L"calibrate", RG_LEN(wszMode), FALSE))
+				fCalibrate = TRUE;
+			else if (0 != Platform_StringCompare(wszMode, L"auto", RG_LEN(wszMode), FALSE))
+			{
+				unReturnValue = RC_E_INVALID_SETTING;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid TUNING setting '%ls' (0x%.8X).", wszMode, unReturnValue);
+				break;
+			}
+		}
+
+		if (RC_SUCCESS != TPMIO_GetTuningKey(PbLocality, wszKey, &unKeySize))
+		{
+			LOGGING_WRITE_LEVEL1(L"Warning: The TPM identity for the TIS tuning profile cannot be read.");
+			break;
+		}
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sFile, 0, sizeof(sFile)));
+		if (RC_SUCCESS == FileIO_ReadFileToBuffer(TPM_DEVICE_ACCESS_TUNING_FILE, &prgbFile, &unFileSize) && sizeof(sFile) == unFileSize &&
+				TPMIO_TUNING_MAGIC == ((const IfxTpmIoTuningFile*)prgbFile)->unMagic &&
+				((const IfxTpmIoTuningFile*)prgbFile)->unCount <= TPMIO_TUNING_MAX_PROFILES)
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(&sFile, sizeof(sFile), prgbFile, unFileSize));
+		sFile.unMagic = TPMIO_TUNING_MAGIC;
+
+		// Look for the profile of this platform and TPM
+		for (unIndex = 0; unIndex < sFile.unCount; unIndex++)
+		{
+			sFile.rgsProfiles[unIndex].wszKey[TPMIO_TUNING_KEY_SIZE - 1] = L'\0';
+			if (0 == Platform_StringCompare(sFile.rgsProfiles[unIndex].wszKey, wszKey, TPMIO_TUNING_KEY_SIZE, FALSE))
+				break;
+		}
+
+		if (!fCalibrate)
+		{
+			if (unIndex == sFile.unCount)
+			{
+				LOGGING_WRITE_LEVEL3_FMT(L"No TIS tuning profile for '%ls', using the default polling parameters.", wszKey);
+				break;
+			}
+			if (RC_SUCCESS != TIS_SetTuning(&sFile.rgsProfiles[unIndex].sTuning))
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Warning: The TIS tuning profile for '%ls' is invalid and ignored.", wszKey);
+				break;
+			}
+			LOGGING_WRITE_LEVEL3_FMT(L"Using the TIS tuning profile for '%ls'.", wszKey);
+			break;
+		}
+
+		// Calibrate with the default polling parameters
+		IGNORE_RETURN_VALUE(TIS_SetTuning(NULL));
+		if (RC_SUCCESS != TPMIO_ProbeRoundTrip(&ullCommandTime) ||
+				RC_SUCCESS != TIS_Calibrate(PbLocality, ullCommandTime > UINT_MAX ? UINT_MAX : (UINT32)ullCommandTime, &sTuning) ||
+				RC_SUCCESS != TIS_SetTuning(&sTuning))
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Warning: Calibrating the TIS polling parameters for '%ls' failed, using the default ones.", wszKey);
+			break;
+		}
+		LOGGING_WRITE_LEVEL2_FMT(L"TIS tuning profile for '%ls': register read %u ns, burst count %u, command %u us -> sleep %u us, commandReady %u us, burst count %u us, spin %u us",
+			wszKey, sTuning.unRegisterReadTime, sTuning.unBurstCount, sTuning.unCommandTime,
+			sTuning.unSleepTime, sTuning.unSleepTimeCommandReady, sTuning.unSleepTimeBurstCount, sTuning.unMaxSpinTime);
+
+		// Store the profile first, the least recently calibrated one drops out if the file is full
+		if (unIndex == sFile.unCount)
+		{
+			if (sFile.unCount < TPMIO_TUNING_MAX_PROFILES)
+				sFile.unCount++;
+			unIndex = sFile.unCount - 1;
+		}
+		for (; unIndex > 0; unIndex--)
+			sFile.rgsProfiles[unIndex] = sFile.rgsProfiles[unIndex - 1];
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sFile.rgsProfiles[0], 0, sizeof(sFile.rgsProfiles[0])));
+		unKeySize = RG_LEN(sFile.rgsProfiles[0].wszKey);
+		IGNORE_RETURN_VALUE(Platform_StringCopy(sFile.rgsProfiles[0].wszKey, &unKeySize, wszKey));
+		sFile.rgsProfiles[0].sTuning = sTuning;
+
+		unReturnValue = FileIO_Open(TPM_DEVICE_ACCESS_TUNING_FILE, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sFile, sizeof(sFile));
+		if (NULL != pvFile)
+			IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Warning: Could not write the TIS tuning file '%ls' (0x%.8X).", TPM_DEVICE_ACCESS_TUNING_FILE, unReturnValue);
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbFile);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Opens the configured TPM interrupt line and enables the TIS interrupts
+ *	@details	The TIS wait loops keep polling if the interrupt line cannot be used, the connection does not fail.
+ *
+ *	@param		PbLocality		Locality value
+ */
+static void
+TPMIO_ConnectInterrupt(
+	_In_	BYTE	PbLocality)
+{
+	wchar_t wszDevicePath[MAX_PATH] = {0};
+	unsigned int unDevicePathSize = RG_LEN(wszDevicePath);
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		if (!PropertyStorage_GetValueByKey(PROPERTY_TPM_INTERRUPT, wszDevicePath, &unDevicePathSize) || 0 == wszDevicePath[0])
+			break;
+
+		unReturnValue = DeviceAccess_OpenInterrupt(wszDevicePath);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = TIS_EnableInterrupts(PbLocality, TRUE);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			DeviceAccess_CloseInterrupt();
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL4_FMT(L"Waiting for the TPM on interrupt device %ls", wszDevicePath);
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Warning: The TPM interrupt cannot be used, polling instead (0x%.8X).", unReturnValue);
+	}
+}
+
+/**
+ *	@brief		Binds the TIS FIFO or CRB register interface of an initialized device access
+ *	@details	Checks the presence of a TPM, determines the register interface, starts the locality session and sets the
+ *				register based backend functions. The TIS interrupts are enabled if an interrupt line is configured. Used by
+ *				memory based access, the SPI access mode and the TIS register file simulator.
+ *
+ *	@param		PbLocality					Locality value
+ *	@param		PfTuning					TRUE applies the calibrated TIS polling parameters
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_NOT_READY				TPM.ACCESS.VALID is not set.
+ *	@retval		...							Error codes from TIS, CRB and TPMIO_ApplyTisTuning
+ */
+_Check_return_
+static unsigned int
+TPMIO_ConnectRegisters(
+	_In_	BYTE	PbLocality,
+	_In_	BOOL	PfTuning)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BOOL bFlag = FALSE;
+
+	do
+	{
+		// Check the presence of a TPM first
+		// Check whether TPM.ACCESS.VALID
+		unReturnValue = TIS_IsAccessValid(PbLocality, &bFlag);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error TIS access is not valid: 0x%.8X", unReturnValue);
+			break;
+		}
+
+		if (!bFlag)
+		{
+			unReturnValue = RC_E_NOT_READY;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error TIS is not ready: 0x%.8X", unReturnValue);
+			break;
+		}
+
+		// Newer platforms expose a CRB interface instead of the TIS FIFO interface. The ACPI TPM2 table tells
+		// which one, otherwise the interface identifier register is read.
+		if (DEVICE_ACCESS_INTERFACE_UNKNOWN != DeviceAccess_GetInterfaceType())
+			s_sBackend.fCrbInterface = (DEVICE_ACCESS_INTERFACE_CRB == DeviceAccess_GetInterfaceType());
+		else
+		{
+			unReturnValue = CRB_IsCrbInterface(PbLocality, &s_sBackend.fCrbInterface);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error reading the interface identifier: 0x%.8X", unReturnValue);
+				break;
+			}
+		}
+
+		// Hold the locality for the whole connection instead of requesting it for each command
+		if (s_sBackend.fCrbInterface)
+			unReturnValue = CRB_BeginLocalitySession(PbLocality);
+		else
+			unReturnValue = TIS_BeginLocalitySession(PbLocality);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error starting the locality session: 0x%.8X", unReturnValue);
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL4_FMT(L"Using the %ls interface", s_sBackend.fCrbInterface ? L"CRB" : L"TIS FIFO");
+		if (!s_sBackend.fCrbInterface)
+			TIS_SelectEngine(DeviceAccessSpi_IsOpen() ? TIS_ENGINE_SPI : TIS_ENGINE_MEMORY);
+
+		s_sBackend.bLocality = PbLocality;
+		s_sBackend.fpTransmit = s_sBackend.fCrbInterface ? TPMIO_TransmitCrb : TPMIO_TransmitMemoryBased;
+		s_sBackend.fpTransmitSegments = s_sBackend.fCrbInterface ? NULL : TPMIO_TransmitSegmentsMemoryBased;
+		s_sBackend.fpReadRegister = TPMIO_ReadRegisterMemoryBased;
+		s_sBackend.fpWriteRegister = TPMIO_WriteRegisterMemoryBased;
+
+		// The polling parameters only apply to the TIS FIFO interface. They are calibrated for memory based access,
+		// a register access through the SPI device takes a bus transaction (a USB round trip on a bridge) anyway.
+		if (!s_sBackend.fCrbInterface && PfTuning)
+			unReturnValue = TPMIO_ApplyTisTuning(PbLocality);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Sleep on the TPM interrupt instead of polling the status register if an interrupt line is configured
+		if (!s_sBackend.fCrbInterface && PropertyStorage_ExistsElement(PROPERTY_TPM_INTERRUPT))
+			TPMIO_ConnectInterrupt(PbLocality);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Releases the TPM interrupt line opened by TPMIO_ConnectInterrupt
+ *
+ *	@param		PbLocality		Locality value
+ */
+static void
+TPMIO_DisconnectInterrupt(
+	_In_	BYTE	PbLocality)
+{
+	if (DeviceAccess_IsInterruptOpen())
+	{
+		unsigned int unReturnValue = TIS_EnableInterrupts(PbLocality, FALSE);
+		if (RC_SUCCESS != unReturnValue)
+			LOGGING_WRITE_LEVEL1_FMT(L"Error disabling the TPM interrupts: 0x%.8X", unReturnValue);
+		DeviceAccess_CloseInterrupt();
+	}
+}
+
+/**
+ *	@brief		Binds the backend of a device access mode
+ *	@details	Initializes the backend and sets the backend functions.
+ *
+ *	@param		PunAccessMode				Device access mode
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING		An unknown device access mode is given.
+ *	@retval		...							Error codes from DeviceAccess_Initialize, TIS and the backend initialization
+ */
+_Check_return_
+static unsigned int
+TPMIO_ConnectBackend(
+	_In_	UINT32	PunAccessMode)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	switch (PunAccessMode)
+	{
+		case TPM_DEVICE_ACCESS_DRIVER:
+		case TPM_DEVICE_ACCESS_RESOURCE_MANAGER:
+		{
+			if (TPM_DEVICE_ACCESS_RESOURCE_MANAGER == PunAccessMode)
+			{
+				// Switch to the resource manager device if no other device path has been configured
+				wchar_t wszDevicePath[MAX_PATH] = {0};
+				unsigned int unDevicePathSize = RG_LEN(wszDevicePath);
+				if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize) ||
+						0 == Platform_StringCompare(wszDevicePath, TPM_DEVICE_ACCESS_PATH, RG_LEN(TPM_DEVICE_ACCESS_PATH), FALSE))
+				{
+					if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_DEVICE_ACCESS_PATH, TPM_DEVICE_ACCESS_RESOURCE_MANAGER_PATH) &&
+							!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, TPM_DEVICE_ACCESS_RESOURCE_MANAGER_PATH))
+					{
+						unReturnValue = RC_E_FAIL;
+						LOGGING_WRITE_LEVEL1(L"Error: Setting PROPERTY_TPM_DEVICE_ACCESS_PATH failed.");
+						break;
+					}
+				}
+			}
+
+			// The resource manager arbitrates between several users, the device itself is used exclusively
+			if (TPM_DEVICE_ACCESS_DRIVER == PunAccessMode)
+			{
+				wchar_t wszDevicePath[MAX_PATH] = {0};
+				unsigned int unDevicePathSize = RG_LEN(wszDevicePath);
+				if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize))
+				{
+					unDevicePathSize = RG_LEN(wszDevicePath);
+					IGNORE_RETURN_VALUE(Platform_StringCopy(wszDevicePath, &unDevicePathSize, TPM_DEVICE_ACCESS_PATH));
+				}
+				unReturnValue = TPMIO_LockDevice(wszDevicePath);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+
+			unReturnValue = DeviceAccessTpmDriver_Initialize();
+			if (RC_SUCCESS != unReturnValue)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error initializing LowLevelIO: 0x%.8X", unReturnValue);
+				break;
+			}
+
+			LOGGING_WRITE_LEVEL4(TPM_DEVICE_ACCESS_RESOURCE_MANAGER == PunAccessMode ? L"Using TPM resource manager" : L"Using /dev/tpm0 driver");
+
+			s_sBackend.fpTransmit = TPMIO_TransmitTpmDriver;
+			s_sBackend.fpReadRegister = TPMIO_ReadRegisterTpmDriver;
+			s_sBackend.fpWriteRegister = TPMIO_WriteRegisterTpmDriver;
+			break;
+		}
+
+		case TPM_DEVICE_ACCESS_SIMULATED:
+		{
+			unReturnValue = TpmSimulator_Initialize();
+			if (RC_SUCCESS != unReturnValue)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error initializing the TPM simulator: 0x%.8X", unReturnValue);
+				break;
+			}
+
+			// The TIS interface runs the memory based TIS engine on the simulated register file
+			if (TpmTisSimulator_IsSelected())
+			{
+				unsigned int unLocality = 0;
+				if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_LOCALITY, &unLocality))
+				{
+					unReturnValue = RC_E_FAIL;
+					break;
+				}
+
+				unReturnValue = TpmTisSimulator_Initialize((BYTE)unLocality);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					LOGGING_WRITE_LEVEL1_FMT(L"Error initializing the TIS simulator: 0x%.8X", unReturnValue);
+					break;
+				}
+
+				LOGGING_WRITE_LEVEL4(L"Using the TPM simulator with the TIS register interface");
+				LOGGING_WRITE_LEVEL4_FMT(L"Using Locality: %d", unLocality);
+
+				// The default polling parameters keep the register traffic of the TIS engine reproducible
+				unReturnValue = TPMIO_ConnectRegisters((BYTE)unLocality, FALSE);
+				if (RC_SUCCESS != unReturnValue)
+					IGNORE_RETURN_VALUE(TpmTisSimulator_Uninitialize());
+				break;
+			}
+
+			LOGGING_WRITE_LEVEL4(L"Using the TPM simulator");
+
+			s_sBackend.fpTransmit = TpmSimulator_Transmit;
+			s_sBackend.fpReadRegister = TPMIO_ReadRegisterTpmDriver;
+			s_sBackend.fpWriteRegister = TPMIO_WriteRegisterTpmDriver;
+			break;
+		}
+
+		case TPM_DEVICE_ACCESS_REPLAY:
+		{
+			unReturnValue = TpmReplay_Initialize();
+			if (RC_SUCCESS != unReturnValue)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error initializing the capture replay: 0x%.8X", unReturnValue);
+				break;
+			}
+
+			LOGGING_WRITE_LEVEL4(L"Using the capture replay");
+
+			s_sBackend.fpTransmit = TpmReplay_Transmit;
+			s_sBackend.fpReadRegister = TPMIO_ReadRegisterTpmDriver;
+			s_sBackend.fpWriteRegister = TPMIO_WriteRegisterTpmDriver;
+			break;
+		}
+
+		case TPM_DEVICE_ACCESS_SOCKET:
+		case TPM_DEVICE_ACCESS_REMOTE:
+		{
+			unReturnValue = TpmSocket_Initialize(TPM_DEVICE_ACCESS_REMOTE == PunAccessMode);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error initializing the software TPM socket: 0x%.8X", unReturnValue);
+				break;
+			}
+
+			LOGGING_WRITE_LEVEL4(TPM_DEVICE_ACCESS_REMOTE == PunAccessMode ? L"Using the TPM remote agent socket" : L"Using the software TPM socket");
+
+			s_sBackend.fpTransmit = TpmSocket_Transmit;
+			s_sBackend.fpTransmitBatch = TPM_DEVICE_ACCESS_REMOTE == PunAccessMode ? TpmSocket_TransmitBatch : NULL;
+			s_sBackend.fpReadRegister = TPMIO_ReadRegisterTpmDriver;
+			s_sBackend.fpWriteRegister = TPMIO_WriteRegisterTpmDriver;
+			break;
+		}
+
+		case TPM_DEVICE_ACCESS_MEMORY_BASED:
+		case TPM_DEVICE_ACCESS_SPI:
+		{
+			unsigned int unLocality = 0;
+			wchar_t wszDevicePath[MAX_PATH] = {0};
+			unsigned int unDevicePathSize = RG_LEN(wszDevicePath);
+
+			// Check if already connected
+			if (FALSE != pSession->fTpmIoConnected)
+			{
+				unReturnValue = RC_E_ALREADY_CONNECTED;
+				break;
+			}
+
+			// Get the selected locality for TPM access
+			if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_LOCALITY, &unLocality))
+			{
+				unReturnValue = RC_E_FAIL;
+				break;
+			}
+
+			// Memory based access uses the TPM behind the default device path. The SPI access mode uses the configured
+			// spidev device, each SPI bus of a gang programming fixture is given as a device path of its own.
+			if (TPM_DEVICE_ACCESS_SPI == PunAccessMode)
+			{
+				if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize) ||
+						0 == Platform_StringCompare(wszDevicePath, TPM_DEVICE_ACCESS_PATH, RG_LEN(TPM_DEVICE_ACCESS_PATH), FALSE))
+				{
+					unDevicePathSize = RG_LEN(wszDevicePath);
+					IGNORE_RETURN_VALUE(Platform_StringCopy(wszDevicePath, &unDevicePathSize, TPM_DEVICE_ACCESS_SPI_PATH));
+				}
+			}
+			else
+				IGNORE_RETURN_VALUE(Platform_StringCopy(wszDevicePath, &unDevicePathSize, TPM_DEVICE_ACCESS_PATH));
+			unReturnValue = TPMIO_LockDevice(wszDevicePath);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			if (TPM_DEVICE_ACCESS_SPI == PunAccessMode)
+				unReturnValue = DeviceAccessSpi_Initialize(wszDevicePath, (BYTE)unLocality);
+			else
+				unReturnValue = DeviceAccess_Initialize((BYTE)unLocality);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error initializing LowLevelIO: 0x%.8X", unReturnValue);
+				break;
+			}
+
+			LOGGING_WRITE_LEVEL4(TPM_DEVICE_ACCESS_SPI == PunAccessMode ? L"Using SPI access routines" : L"Using memory access routines");
+			LOGGING_WRITE_LEVEL4_FMT(L"Using Locality: %d", unLocality);
+
+			unReturnValue = TPMIO_ConnectRegisters((BYTE)unLocality, TPM_DEVICE_ACCESS_MEMORY_BASED == PunAccessMode);
+			break;
+		}
+		default:
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: An Unknown or unsupported device access routine is configured (0x%.8x).", unReturnValue);
+			break;
+		}
+	}
+
+	if (RC_SUCCESS == unReturnValue)
+		s_sBackend.unAccessMode = PunAccessMode;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Releases the backend bound by TPMIO_ConnectBackend
+ *	@details	Uninitializes the backend, resets the backend functions and releases the device lock.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INTERNAL			No backend is bound.
+ *	@retval		...						Error codes from DeviceAccess_Uninitialize and the backend uninitialization
+ */
+_Check_return_
+static unsigned int
+TPMIO_DisconnectBackend()
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	switch (s_sBackend.unAccessMode)
+	{
+		case TPM_DEVICE_ACCESS_MEMORY_BASED:
+		case TPM_DEVICE_ACCESS_SPI:
+		{
+			// Release the locality held for the connection
+			TPMIO_DisconnectInterrupt(s_sBackend.bLocality);
+			if (s_sBackend.fCrbInterface)
+				unReturnValue = CRB_EndLocalitySession(s_sBackend.bLocality);
+			else
+				unReturnValue = TIS_EndLocalitySession(s_sBackend.bLocality);
+			if (RC_SUCCESS != unReturnValue)
+				LOGGING_WRITE_LEVEL1_FMT(L"Error ending the locality session: 0x%.8X", unReturnValue);
+
+			IGNORE_RETURN_VALUE(TIS_SetTuning(NULL));
+			TIS_SelectEngine(TIS_ENGINE_MEMORY);
+			if (TPM_DEVICE_ACCESS_SPI == s_sBackend.unAccessMode)
+				unReturnValue = DeviceAccessSpi_Uninitialize();
+			else
+				unReturnValue = DeviceAccess_Uninitialize(s_sBackend.bLocality);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			break;
+		}
+		case TPM_DEVICE_ACCESS_DRIVER:
+		case TPM_DEVICE_ACCESS_RESOURCE_MANAGER:
+		{
+			unReturnValue = DeviceAccessTpmDriver_Uninitialize();
+			break;
+		}
+		case TPM_DEVICE_ACCESS_SIMULATED:
+		{
+			if (TpmTisSimulator_IsOpen())
+			{
+				TPMIO_DisconnectInterrupt(s_sBackend.bLocality);
+				unReturnValue = TIS_EndLocalitySession(s_sBackend.bLocality);
+				if (RC_SUCCESS != unReturnValue)
+					LOGGING_WRITE_LEVEL1_FMT(L"Error ending the locality session: 0x%.8X", unReturnValue);
+				IGNORE_RETURN_VALUE(TpmTisSimulator_Uninitialize());
+			}
+			unReturnValue = TpmSimulator_Uninitialize();
+			break;
+		}
+		case TPM_DEVICE_ACCESS_REPLAY:
+		{
+			unReturnValue = TpmReplay_Uninitialize();
+			break;
+		}
+		case TPM_DEVICE_ACCESS_SOCKET:
+		case TPM_DEVICE_ACCESS_REMOTE:
+		{
+			unReturnValue = TpmSocket_Uninitialize();
+			break;
+		}
+		default:
+		{
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Unknown device access mode configured (0x%.8x).", unReturnValue);
+			break;
+		}
+	}
+
+	s_sBackend.unAccessMode = 0;
+	s_sBackend.bLocality = 0;
+	s_sBackend.fCrbInterface = FALSE;
+	s_sBackend.fpTransmit = NULL;
+	s_sBackend.fpTransmitSegments = NULL;
+	s_sBackend.fpTransmitBatch = NULL;
+	s_sBackend.fpReadRegister = NULL;
+	s_sBackend.fpWriteRegister = NULL;
+	FileIO_UnlockFile(&pSession->pvDeviceLock);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Connects through the fastest backend that works on this host
+ *	@details	Tries memory based access, the TPM driver and, if PROPERTY_TPM_DEVICE_ACCESS_AUTO_SHARED is set, the
+ *				resource manager with their default device paths. Memory based access is skipped while a kernel driver
+ *				exposes the TPM since its register accesses would interfere with the driver. Each working backend is
+ *				measured with TPMIO_ProbeRoundTrip and released again, then the fastest one is bound. The selection is
+ *				stored in PROPERTY_TPM_DEVICE_ACCESS_MODE and PROPERTY_TPM_DEVICE_ACCESS_PATH so that further connections of
+ *				this run and the access mode specific handling of the callers use it directly.
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_COMPONENT_NOT_FOUND	No backend works on this host.
+ *	@retval		RC_E_FAIL					Storing the selection failed.
+ *	@retval		...							Error codes from TPMIO_ConnectBackend
+ */
+_Check_return_
+static unsigned int
+TPMIO_ConnectAuto()
+{
+	static const UINT32 rgunCandidates[] = { TPM_DEVICE_ACCESS_MEMORY_BASED, TPM_DEVICE_ACCESS_DRIVER, TPM_DEVICE_ACCESS_RESOURCE_MANAGER };
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unIndex = 0;
+	UINT32 unSelected = 0;
+	unsigned long long ullSelected = 0;
+	BOOL fShared = FALSE;
+
+	if (!PropertyStorage_GetBooleanValueByKey(PROPERTY_TPM_DEVICE_ACCESS_AUTO_SHARED, &fShared))
+		fShared = FALSE;
+
+	for (unIndex = 0; unIndex < RG_LEN(rgunCandidates); unIndex++)
+	{
+		UINT32 unAccessMode = rgunCandidates[unIndex];
+		const wchar_t* wszDevicePath = (TPM_DEVICE_ACCESS_RESOURCE_MANAGER == unAccessMode) ? TPM_DEVICE_ACCESS_RESOURCE_MANAGER_PATH : TPM_DEVICE_ACCESS_PATH;
+		unsigned long long ullRoundTrip = 0;
+
+		if (TPM_DEVICE_ACCESS_MEMORY_BASED == unAccessMode &&
+				(FileIO_Exists(TPM_DEVICE_ACCESS_PATH) || FileIO_Exists(TPM_DEVICE_ACCESS_RESOURCE_MANAGER_PATH)))
+		{
+			LOGGING_WRITE_LEVEL2(L"Automatic access mode: skipping memory based access, a kernel driver owns the TPM");
+			continue;
+		}
+		if (TPM_DEVICE_ACCESS_RESOURCE_MANAGER == unAccessMode && !fShared)
+			continue;
+
+		if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszDevicePath) &&
+				!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszDevicePath))
+		{
+			unReturnValue = RC_E_FAIL;
+			LOGGING_WRITE_LEVEL1(L"Error: Setting PROPERTY_TPM_DEVICE_ACCESS_PATH failed.");
+			break;
+		}
+
+		unReturnValue = TPMIO_ConnectBackend(unAccessMode);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Automatic access mode: mode %u is not available (0x%.8X)", unAccessMode, unReturnValue);
+			if (0 != pSession->ullMemoryBase)
+			{
+				IGNORE_RETURN_VALUE(DeviceAccess_Uninitialize(0));
+			}
+			FileIO_UnlockFile(&pSession->pvDeviceLock);
+			unReturnValue = RC_SUCCESS;
+			continue;
+		}
+
+		unReturnValue = TPMIO_ProbeRoundTrip(&ullRoundTrip);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Automatic access mode: mode %u does not reach the TPM (0x%.8X)", unAccessMode, unReturnValue);
+		}
+		else
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Automatic access mode: mode %u round trip %llu us", unAccessMode, ullRoundTrip);
+			if (0 == unSelected || ullRoundTrip < ullSelected)
+			{
+				unSelected = unAccessMode;
+				ullSelected = ullRoundTrip;
+			}
+		}
+
+		unReturnValue = TPMIO_DisconnectBackend();
+		if (RC_SUCCESS != unReturnValue)
+			LOGGING_WRITE_LEVEL1_FMT(L"Error releasing the probed access mode %u: 0x%.8X", unAccessMode, unReturnValue);
+		unReturnValue = RC_SUCCESS;
+	}
+
+	do
+	{
+		const wchar_t* wszDevicePath = (TPM_DEVICE_ACCESS_RESOURCE_MANAGER == unSelected) ? TPM_DEVICE_ACCESS_RESOURCE_MANAGER_PATH : TPM_DEVICE_ACCESS_PATH;
+
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (0 == unSelected)
+		{
+			unReturnValue = RC_E_COMPONENT_NOT_FOUND;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Automatic access mode found no working TPM access (0x%.8X).", unReturnValue);
+			break;
+		}
+
+		// Further connections of this run use the selection directly
+		if (!PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, unSelected) ||
+				(!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszDevicePath) &&
+				 !PropertyStorage_ChangeValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszDevicePath)))
+		{
+			unReturnValue = RC_E_FAIL;
+			LOGGING_WRITE_LEVEL1(L"Error: Storing the selected access mode failed.");
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL2_FMT(L"Automatic access mode: selected mode %u (%ls, round trip %llu us)", unSelected,
+			(TPM_DEVICE_ACCESS_MEMORY_BASED == unSelected) ? L"memory based access" : wszDevicePath, ullSelected);
+
+		unReturnValue = TPMIO_ConnectBackend(unSelected);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
 
 /**
  *	@brief		TPM connect function
@@ -39,6 +1284,7 @@ _Check_return_
 unsigned int
 TPMIO_Connect()
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
@@ -46,7 +1292,7 @@ TPMIO_Connect()
 	do
 	{
 		UINT32 unTpmDeviceAccessModeCfg = 0;
-		if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessModeCfg))
+		if (FALSE == PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessModeCfg))
 		{
 			unReturnValue = RC_E_INTERNAL;
 			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving PROPERTY_TPM_DEVICE_ACCESS_MODE failed (%.8x).", unReturnValue);
@@ -54,7 +1300,7 @@ TPMIO_Connect()
 		}
 
 		// Check if already connected
-		if (FALSE != g_fConnected)
+		if (FALSE != pSession->fTpmIoConnected)
 		{
 			unReturnValue = RC_E_ALREADY_CONNECTED;
 			break;
@@ -63,77 +1309,11 @@ TPMIO_Connect()
 		// Try to connect to the TPM and check return code
 		LOGGING_WRITE_LEVEL4(L"Connecting to TPM...");
 
-		switch (unTpmDeviceAccessModeCfg)
-		{
-			case TPM_DEVICE_ACCESS_DRIVER:
-			{
-				unReturnValue = DeviceAccessTpmDriver_Initialize();
-				if (RC_SUCCESS != unReturnValue)
-				{
-					LOGGING_WRITE_LEVEL1_FMT(L"Error initializing LowLevelIO: 0x%.8X", unReturnValue);
-					break;
-				}
-
-				LOGGING_WRITE_LEVEL4(L"Using /dev/tpm0 driver");
-
-				break;
-			}
-
-			case TPM_DEVICE_ACCESS_MEMORY_BASED:
-#if !(defined (__aarch64__) || defined (__arm__))
-			{
-				unsigned int unLocality = 0;
-				BOOL bFlag = FALSE;
-
-				// Check if already connected
-				if (FALSE != g_fConnected)
-				{
-					unReturnValue = RC_E_ALREADY_CONNECTED;
-					break;
-				}
-
-				// Get the selected locality for TPM access
-				if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOCALITY, &unLocality))
-				{
-					unReturnValue = RC_E_FAIL;
-					break;
-				}
-
-				unReturnValue = DeviceAccess_Initialize((BYTE)unLocality);
-				if (RC_SUCCESS != unReturnValue)
-				{
-					LOGGING_WRITE_LEVEL1_FMT(L"Error initializing LowLevelIO: 0x%.8X", unReturnValue);
-					break;
-				}
-
-				LOGGING_WRITE_LEVEL4(L"Using memory access routines");
-				LOGGING_WRITE_LEVEL4_FMT(L"Using Locality: %d", unLocality);
-
-				// Check the presence of a TPM first
-				// Check whether TPM.ACCESS.VALID
-				unReturnValue = TIS_IsAccessValid((BYTE)unLocality, &bFlag);
-				if (RC_SUCCESS != unReturnValue)
-				{
-					LOGGING_WRITE_LEVEL1_FMT(L"Error TIS access is not valid: 0x%.8X", unReturnValue);
-					break;
-				}
-
-				if (!bFlag)
-				{
-					unReturnValue = RC_E_NOT_READY;
-					LOGGING_WRITE_LEVEL1_FMT(L"Error TIS is not ready: 0x%.8X", unReturnValue);
-					break;
-				}
-				break;
-			}
-#endif
-			default:
-			{
-				unReturnValue = RC_E_INVALID_SETTING;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: An Unknown or unsupported device access routine is configured (0x%.8x).", unReturnValue);
-				break;
-			}
-		}
+		if (TPM_DEVICE_ACCESS_AUTO == unTpmDeviceAccessModeCfg)
+			unReturnValue = TPMIO_ConnectAuto();
+		else
+			unReturnValue = TPMIO_ConnectBackend(unTpmDeviceAccessModeCfg);
+		PROBE2(tpmio__connect, unTpmDeviceAccessModeCfg, unReturnValue);
 
 		if (RC_SUCCESS != unReturnValue)
 			break;
@@ -154,10 +1334,14 @@ TPMIO_Connect()
 
 		LOGGING_WRITE_LEVEL4(L"Connected to TPM");
 
-		g_fConnected = TRUE;
+		pSession->fTpmIoConnected = TRUE;
 	}
 	WHILE_FALSE_END;
 
+	// Let other instances use the TPM device if the connection failed
+	if (FALSE == pSession->fTpmIoConnected)
+		FileIO_UnlockFile(&pSession->pvDeviceLock);
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
@@ -175,65 +1359,26 @@ _Check_return_
 unsigned int
 TPMIO_Disconnect()
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
 	do
 	{
-		UINT32 unTpmDeviceAccessModeCfg = 0;
-
 		// Check if connected to the TPM
-		if (FALSE == g_fConnected)
+		if (FALSE == pSession->fTpmIoConnected)
 		{
 			unReturnValue = RC_E_NOT_CONNECTED;
 			break;
 		}
 
-		if (!(	PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessModeCfg) &&
-				(TPM_DEVICE_ACCESS_MEMORY_BASED == unTpmDeviceAccessModeCfg ||
-				 TPM_DEVICE_ACCESS_DRIVER == unTpmDeviceAccessModeCfg)))
-		{
-			unReturnValue = RC_E_INTERNAL;
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving device handle failed (%.8x).", unReturnValue);
-			break;
-		}
-
 		// Try to disconnect the TPM and check return code
 		LOGGING_WRITE_LEVEL4(L"Disconnecting from TPM...");
 
-		switch (unTpmDeviceAccessModeCfg)
-		{
-			case TPM_DEVICE_ACCESS_MEMORY_BASED:
-			{
-				unsigned int unLocality = 0;
-
-				// Check if a startup is required
-				if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOCALITY, &unLocality))
-				{
-					unReturnValue = RC_E_FAIL;
-					break;
-				}
-				unReturnValue = DeviceAccess_Uninitialize((BYTE)unLocality);
-				if (RC_SUCCESS != unReturnValue)
-					break;
-
-				break;
-			}
-			case TPM_DEVICE_ACCESS_DRIVER:
-			{
-				unReturnValue = DeviceAccessTpmDriver_Uninitialize();
-				break;
-			}
-			default:
-			{
-				unReturnValue = RC_E_INTERNAL;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: Unknown device access mode configured (0x%.8x).", unReturnValue);
-				break;
-			}
-		}
-
-		g_fConnected = FALSE;
+		unReturnValue = TPMIO_DisconnectBackend();
+		PROBE1(tpmio__disconnect, unReturnValue);
+		pSession->fTpmIoConnected = FALSE;
 	}
 	WHILE_FALSE_END;
 
@@ -250,7 +1395,8 @@ TPMIO_Disconnect()
  *	@param		PunRequestBufferSize	Size of command request in bytes
  *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
  *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
- *	@param		PunMaxDuration			The maximum duration of the command in microseconds (relevant for memory based access / TIS protocol only)
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (relevant for memory based access / TIS protocol only)
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
@@ -264,16 +1410,16 @@ TPMIO_Transmit(
 	_In_										unsigned int	PunRequestBufferSize,
 	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
 	_Inout_										unsigned int*	PpunResponseBufferSize,
-	_In_										unsigned int	PunMaxDuration)
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
 {
+	IfxSession* pSession = Session_GetCurrent();
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
 	do
 	{
-		UINT32 unTpmDeviceAccessModeCfg = 0;
-
 		// Check parameters
 		if (NULL == PrgbRequestBuffer || NULL == PrgbResponseBuffer || NULL == PpunResponseBufferSize)
 		{
@@ -281,66 +1427,190 @@ TPMIO_Transmit(
 			break;
 		}
 		// Check if connected to the TPM
-		if (FALSE == g_fConnected)
+		if (FALSE == pSession->fTpmIoConnected || NULL == s_sBackend.fpTransmit)
+		{
+			unReturnValue = RC_E_NOT_CONNECTED;
+			break;
+		}
+
+		unReturnValue = s_sBackend.fpTransmit(
+							PrgbRequestBuffer,
+							PunRequestBufferSize,
+							PrgbResponseBuffer,
+							PpunResponseBufferSize,
+							PunMaxDuration,
+							PunExpectedDuration);
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		TPM transmit function for a request given in several parts
+ *	@details	The parts are sent to the TPM one after the other as one command. Backends which cannot send a request
+ *				in parts get a copy of the parts in one buffer.
+ *
+ *	@param		PrgsRequestSegments		Parts of the TPM command request in the order of transmission
+ *	@param		PunSegmentCount			Number of parts
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (relevant for memory based access / TIS protocol only)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The request is too large
+ *	@retval		RC_E_NOT_CONNECTED		If the TPM I/O is not connected to the TPM
+ *	@retval		...						Error codes from the backend transmit function
+ */
+_Check_return_
+unsigned int
+TPMIO_TransmitSegments(
+	_In_reads_(PunSegmentCount)					const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_										unsigned int			PunSegmentCount,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*					PrgbResponseBuffer,
+	_Inout_										unsigned int*			PpunResponseBufferSize,
+	_In_										unsigned int			PunMaxDuration,
+	_In_										unsigned int			PunExpectedDuration)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		unsigned int unSegment = 0;
+		unsigned int unRequestSize = 0;
+
+		// Check parameters
+		if (NULL == PrgsRequestSegments || 0 == PunSegmentCount || NULL == PrgbResponseBuffer || NULL == PpunResponseBufferSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		// Check if connected to the TPM
+		if (FALSE == pSession->fTpmIoConnected || NULL == s_sBackend.fpTransmit)
 		{
 			unReturnValue = RC_E_NOT_CONNECTED;
 			break;
 		}
 
-		if (!(	PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessModeCfg) &&
-				(TPM_DEVICE_ACCESS_MEMORY_BASED == unTpmDeviceAccessModeCfg ||
-				 TPM_DEVICE_ACCESS_DRIVER == unTpmDeviceAccessModeCfg)))
+		if (NULL != s_sBackend.fpTransmitSegments)
 		{
-			unReturnValue = RC_E_INTERNAL;
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving device handle failed (%.8x).", unReturnValue);
+			unReturnValue = s_sBackend.fpTransmitSegments(
+								PrgsRequestSegments,
+								PunSegmentCount,
+								PrgbResponseBuffer,
+								PpunResponseBufferSize,
+								PunMaxDuration,
+								PunExpectedDuration);
 			break;
 		}
 
-		switch (unTpmDeviceAccessModeCfg)
+		// The backend needs the request in one buffer
+		unReturnValue = RC_SUCCESS;
+		for (unSegment = 0; unSegment < PunSegmentCount; unSegment++)
 		{
-			case TPM_DEVICE_ACCESS_MEMORY_BASED:
+			if (0 == PrgsRequestSegments[unSegment].unSize)
+				continue;
+			if (PrgsRequestSegments[unSegment].unSize > sizeof(s_rgbGatherBuffer) - unRequestSize)
 			{
-				unsigned int unLocality = 0;
-				// Check if a startup is required
-				if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_LOCALITY, &unLocality))
-				{
-					unReturnValue = RC_E_FAIL;
-					break;
-				}
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				break;
+			}
+			unReturnValue = Platform_MemoryCopy(
+								s_rgbGatherBuffer + unRequestSize,
+								sizeof(s_rgbGatherBuffer) - unRequestSize,
+								PrgsRequestSegments[unSegment].pbData,
+								PrgsRequestSegments[unSegment].unSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unRequestSize += PrgsRequestSegments[unSegment].unSize;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
 
-				unReturnValue = TIS_TransceiveLPC(
-									(BYTE)unLocality,
-									PrgbRequestBuffer,
-									(UINT16)PunRequestBufferSize,
-									PrgbResponseBuffer,
-									(UINT16*)PpunResponseBufferSize,
-									PunMaxDuration);
+		unReturnValue = s_sBackend.fpTransmit(
+							s_rgbGatherBuffer,
+							unRequestSize,
+							PrgbResponseBuffer,
+							PpunResponseBufferSize,
+							PunMaxDuration,
+							PunExpectedDuration);
+	}
+	WHILE_FALSE_END;
 
-				if (RC_SUCCESS != unReturnValue)
-					LOGGING_WRITE_LEVEL1(L"Transmission of data via TIS failed!");
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
-				break;
-			}
-			case TPM_DEVICE_ACCESS_DRIVER:
-			{
-				unReturnValue = DeviceAccessTpmDriver_Transmit(
-									PrgbRequestBuffer,
-									(UINT16)PunRequestBufferSize,
-									PrgbResponseBuffer,
-									PpunResponseBufferSize);
+	return unReturnValue;
+}
 
-				if (RC_SUCCESS != unReturnValue)
-					LOGGING_WRITE_LEVEL1(L"Transmission of data via /dev/tpm0 failed!");
+/**
+ *	@brief		TPM transmit function for several requests in one round trip
+ *	@details	Only backends which forward the TPM commands over a network (see TPM_DEVICE_ACCESS_REMOTE) support this.
+ *				The requests are executed back to back until the first one which does not succeed.
+ *
+ *	@param		PrgsRequestSegments		Parts of the requests, PunSegmentsPerRequest consecutive parts per request
+ *	@param		PunSegmentsPerRequest	Number of parts per request
+ *	@param		PunRequestCount			Number of requests
+ *	@param		PrgunResponseCodes		Receives the TPM response code of each executed request, or
+ *										TPMIO_BATCH_TRANSPORT_ERROR if it could not be transmitted
+ *	@param		PpunExecuted			Receives the number of executed requests
+ *	@param		PunMaxDuration			The maximum duration of one command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully, see PrgunResponseCodes for the result of each request.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_CONNECTED			If the TPM I/O is not connected to the TPM
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The backend cannot transmit several requests in one round trip.
+ *	@retval		...							Error codes from the backend transmit function
+ */
+_Check_return_
+unsigned int
+TPMIO_TransmitBatch(
+	_In_reads_(PunSegmentsPerRequest * PunRequestCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_												unsigned int			PunSegmentsPerRequest,
+	_In_												unsigned int			PunRequestCount,
+	_Out_cap_(PunRequestCount)							unsigned int*			PrgunResponseCodes,
+	_Out_												unsigned int*			PpunExecuted,
+	_In_												unsigned int			PunMaxDuration)
+{
+	IfxSession* pSession = Session_GetCurrent();
+	unsigned int unReturnValue = RC_E_FAIL;
 
-				break;
-			}
-			default:
-			{
-				unReturnValue = RC_E_INTERNAL;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: Unknown device access mode configured (0x%.8x).", unReturnValue);
-				break;
-			}
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Check parameters
+		if (NULL == PrgsRequestSegments || NULL == PrgunResponseCodes || NULL == PpunExecuted)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
 		}
+		*PpunExecuted = 0;
+		// Check if connected to the TPM
+		if (FALSE == pSession->fTpmIoConnected || NULL == s_sBackend.fpTransmit)
+		{
+			unReturnValue = RC_E_NOT_CONNECTED;
+			break;
+		}
+		if (NULL == s_sBackend.fpTransmitBatch)
+		{
+			unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+			break;
+		}
+
+		unReturnValue = s_sBackend.fpTransmitBatch(
+							PrgsRequestSegments,
+							PunSegmentsPerRequest,
+							PunRequestCount,
+							PrgunResponseCodes,
+							PpunExecuted,
+							PunMaxDuration);
 	}
 	WHILE_FALSE_END;
 
@@ -358,6 +1628,7 @@ TPMIO_Transmit(
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_CONNECTED		If the TPM I/O is not connected to the TPM
  *	@retval		...						Error codes from called functions
  */
 _Check_return_
@@ -372,47 +1643,21 @@ TPMIO_ReadRegister(
 
 	do
 	{
-		UINT32 unTpmDeviceAccessModeCfg = 0;
-
 		// Check parameters
 		if (NULL == PpbRegisterValue)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-
-		if (!(	PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessModeCfg) &&
-				(TPM_DEVICE_ACCESS_MEMORY_BASED == unTpmDeviceAccessModeCfg ||
-				 TPM_DEVICE_ACCESS_DRIVER == unTpmDeviceAccessModeCfg)))
+		// Check if connected to the TPM
+		if (NULL == s_sBackend.fpReadRegister)
 		{
-			unReturnValue = RC_E_INTERNAL;
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving device handle failed (%.8x).", unReturnValue);
+			unReturnValue = RC_E_NOT_CONNECTED;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: No TPM access backend bound (0x%.8x).", unReturnValue);
 			break;
 		}
 
-		switch (unTpmDeviceAccessModeCfg)
-		{
-			case TPM_DEVICE_ACCESS_MEMORY_BASED:
-			{
-				// Read byte from register address
-				*PpbRegisterValue = DeviceAccess_ReadByte(PunRegisterAddress);
-				unReturnValue = RC_SUCCESS;
-				break;
-			}
-			case TPM_DEVICE_ACCESS_DRIVER:
-			{
-				*PpbRegisterValue = 0;
-				unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: Read/Write register is not supported while using the /dev/tpm0 driver (0x%.8x).", unReturnValue);
-				break;
-			}
-			default:
-			{
-				unReturnValue = RC_E_INTERNAL;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: Unknown device access routine configured (0x%.8x).", unReturnValue);
-				break;
-			}
-		}
+		unReturnValue = s_sBackend.fpReadRegister(PunRegisterAddress, PpbRegisterValue);
 	}
 	WHILE_FALSE_END;
 
@@ -429,6 +1674,7 @@ TPMIO_ReadRegister(
  *	@param		PbRegisterValue			Byte to write to the register address
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_NOT_CONNECTED		If the TPM I/O is not connected to the TPM
  *	@retval		...						Error codes from called functions
  */
 _Check_return_
@@ -443,39 +1689,15 @@ TPMIO_WriteRegister(
 
 	do
 	{
-		UINT32 unTpmDeviceAccessModeCfg = 0;
-
-		if (!(	PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unTpmDeviceAccessModeCfg) &&
-				(TPM_DEVICE_ACCESS_MEMORY_BASED == unTpmDeviceAccessModeCfg ||
-				 TPM_DEVICE_ACCESS_DRIVER == unTpmDeviceAccessModeCfg)))
+		// Check if connected to the TPM
+		if (NULL == s_sBackend.fpWriteRegister)
 		{
-			unReturnValue = RC_E_INTERNAL;
-			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving device handle failed (%.8x).", unReturnValue);
+			unReturnValue = RC_E_NOT_CONNECTED;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: No TPM access backend bound (0x%.8x).", unReturnValue);
 			break;
 		}
 
-		switch (unTpmDeviceAccessModeCfg)
-		{
-			case TPM_DEVICE_ACCESS_MEMORY_BASED:
-			{
-				// Write byte to register address
-				DeviceAccess_WriteByte(PunRegisterAddress, PbRegisterValue);
-				unReturnValue = RC_SUCCESS;
-				break;
-			}
-			case TPM_DEVICE_ACCESS_DRIVER:
-			{
-				unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: Read/Write register feature is not supported while using the /dev/tpm0 driver (0x%.8x).", unReturnValue);
-				break;
-			}
-			default:
-			{
-				unReturnValue = RC_E_INTERNAL;
-				LOGGING_WRITE_LEVEL1_FMT(L"Error: Unknown device access routine configured (0x%.8x).", unReturnValue);
-				break;
-			}
-		}
+		unReturnValue = s_sBackend.fpWriteRegister(PunRegisterAddress, PbRegisterValue);
 	}
 	WHILE_FALSE_END;
 
@@ -483,3 +1705,60 @@ TPMIO_WriteRegister(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Get the transport statistics
+ *	@details	This function returns the statistics accumulated since the start of the application.
+ *
+ *	@param		PpStatistics			Pointer to a structure receiving the statistics
+ */
+void
+TPMIO_GetStatistics(
+	_Out_		IfxTpmIoStatistics*	PpStatistics)
+{
+	IfxTpmIoStatistics sCrbStatistics = {0, 0, 0, 0, 0, 0};
+	IfxTpmIoStatistics sDriverStatistics = {0, 0, 0, 0, 0, 0};
+
+	if (NULL != PpStatistics)
+	{
+		// Only one of the interfaces is used, the statistics of the others remain zero
+		TIS_GetStatistics(PpStatistics);
+		CRB_GetStatistics(&sCrbStatistics);
+		DeviceAccessTpmDriver_GetStatistics(&sDriverStatistics);
+		PpStatistics->ullRegisterReads += sCrbStatistics.ullRegisterReads;
+		PpStatistics->ullRegisterWrites += sCrbStatistics.ullRegisterWrites;
+		PpStatistics->ullFifoBytesRead += sCrbStatistics.ullFifoBytesRead;
+		PpStatistics->ullFifoBytesWritten += sCrbStatistics.ullFifoBytesWritten;
+		PpStatistics->ullWaitIterations += sCrbStatistics.ullWaitIterations;
+		PpStatistics->ullWaitTimeMicroSeconds += sCrbStatistics.ullWaitTimeMicroSeconds;
+		PpStatistics->ullWaitIterations += sDriverStatistics.ullWaitIterations;
+		PpStatistics->ullWaitTimeMicroSeconds += sDriverStatistics.ullWaitTimeMicroSeconds;
+	}
+}
+
+/**
+ *	@brief		Set the command pending callback
+ *	@details	The callback is invoked once per command after the command has been handed over to the TPM and
+ *				before the response is awaited. This lets the caller do host-side work while the TPM executes the
+ *				command. The callback must not transmit TPM commands itself.
+ *
+ *	@param		PfnCommandPending		Callback function or NULL to remove the callback
+ */
+void
+TPMIO_SetCommandPendingCallback(
+	_In_opt_	PFN_TPMIO_CommandPendingCallback	PfnCommandPending)
+{
+	s_fpCommandPending = PfnCommandPending;
+}
+
+/**
+ *	@brief		Signal that a TPM command is pending
+ *	@details	Called by the TPM access layers after a command has been handed over to the TPM. Invokes the
+ *				callback set with TPMIO_SetCommandPendingCallback, if any.
+ */
+void
+TPMIO_CommandPending()
+{
+	if (NULL != s_fpCommandPending)
+		s_fpCommandPending();
+}
@@ -0,0 +1,631 @@
+﻿/**
+ *	@brief		Implements the Device access routines via the software TPM socket protocol
+ *	@details	Talks the TPM command port protocol of the MS TPM simulator, which swtpm implements as well. Default address is localhost:2321.
+ *	@file		Linux/TpmSocket.c
+ *	@copyright	Copyright 2016 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StdInclude.h"
+#include <poll.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "TpmSocket.h"
+#include "Logging.h"
+#include "Platform.h"
+#include "PropertyStorage.h"
+#include "TpmIO.h"
+
+/// Socket of the connection to the TPM command port, -1 while not connected
+static int s_nSocket = -1;
+
+/// Determines whether the connection is to a TPMRemoteAgent, which also executes batched commands
+static BOOL s_fRemoteAgent = FALSE;
+
+/**
+ *	@brief		Sends all bytes of a buffer through a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PrgbBuffer		Bytes to send
+ *	@param		PunSize			Number of bytes to send
+ *	@param		PnFlags			Flags for send()
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA	The bytes could not be sent.
+ */
+_Check_return_
+static unsigned int
+TpmSocket_Send(
+	_In_						int				PnSocket,
+	_In_bytecount_(PunSize)		const BYTE*		PrgbBuffer,
+	_In_						unsigned int	PunSize,
+	_In_						int				PnFlags)
+{
+	while (PunSize > 0)
+	{
+		ssize_t nBytes = send(PnSocket, PrgbBuffer, PunSize, PnFlags | MSG_NOSIGNAL);
+		if (nBytes == -1 && EINTR == errno)
+			continue;
+		if (nBytes <= 0)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_Send: Send failed with errno %d (%s).", errno, strerror(errno));
+			return RC_E_TPM_TRANSMIT_DATA;
+		}
+		PrgbBuffer += nBytes;
+		PunSize -= (unsigned int)nBytes;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Receives a given number of bytes from a socket
+ *	@details	Waits with poll() until all bytes are received or the deadline has passed.
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PrgbBuffer		Buffer receiving the bytes
+ *	@param		PunSize			Number of bytes to receive
+ *	@param		PullDeadline	Monotonic time stamp in microseconds until the bytes must be received
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The connection failed or was closed by the software TPM.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	The deadline has passed.
+ */
+_Check_return_
+static unsigned int
+TpmSocket_Receive(
+	_In_						int					PnSocket,
+	_Out_bytecap_(PunSize)		BYTE*				PrgbBuffer,
+	_In_						unsigned int		PunSize,
+	_In_						unsigned long long	PullDeadline)
+{
+	while (PunSize > 0)
+	{
+		struct pollfd sPollFd;
+		unsigned long long ullNow = Platform_GetMonotonicTimeMicroSeconds();
+		int nTimeout = 0;
+		ssize_t nBytes = 0;
+
+		if (ullNow < PullDeadline)
+			nTimeout = (int)((PullDeadline - ullNow + 999) / 1000);
+
+		sPollFd.fd = PnSocket;
+		sPollFd.events = POLLIN;
+		sPollFd.revents = 0;
+		nBytes = poll(&sPollFd, 1, nTimeout);
+		if (nBytes == -1 && EINTR == errno)
+			continue;
+		if (nBytes == -1)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_Receive: Poll failed with errno %d (%s).", errno, strerror(errno));
+			return RC_E_TPM_RECEIVE_DATA;
+		}
+		if (nBytes == 0)
+			return RC_E_TPM_NO_DATA_AVAILABLE;
+
+		nBytes = recv(PnSocket, PrgbBuffer, PunSize, 0);
+		if (nBytes == -1 && (EINTR == errno || EAGAIN == errno))
+			continue;
+		if (nBytes <= 0)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_Receive: Receive failed with errno %d (%s).", nBytes == 0 ? 0 : errno, nBytes == 0 ? "connection closed" : strerror(errno));
+			return RC_E_TPM_RECEIVE_DATA;
+		}
+		PrgbBuffer += nBytes;
+		PunSize -= (unsigned int)nBytes;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Sends a UINT32 in network byte order through a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PunValue		Value to send
+ *	@param		PnFlags			Flags for send()
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TpmSocket_Send
+ */
+_Check_return_
+static unsigned int
+TpmSocket_SendUInt32(
+	_In_	int				PnSocket,
+	_In_	UINT32			PunValue,
+	_In_	int				PnFlags)
+{
+	BYTE rgbValue[4] = {(BYTE)(PunValue >> 24), (BYTE)(PunValue >> 16), (BYTE)(PunValue >> 8), (BYTE)PunValue};
+	return TpmSocket_Send(PnSocket, rgbValue, sizeof(rgbValue), PnFlags);
+}
+
+/**
+ *	@brief		Receives a UINT32 in network byte order from a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PpunValue		Receives the value
+ *	@param		PullDeadline	Monotonic time stamp in microseconds until the value must be received
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TpmSocket_Receive
+ */
+_Check_return_
+static unsigned int
+TpmSocket_ReceiveUInt32(
+	_In_	int					PnSocket,
+	_Out_	UINT32*				PpunValue,
+	_In_	unsigned long long	PullDeadline)
+{
+	BYTE rgbValue[4] = {0};
+	unsigned int unReturnValue = TpmSocket_Receive(PnSocket, rgbValue, sizeof(rgbValue), PullDeadline);
+	*PpunValue = ((UINT32)rgbValue[0] << 24) | ((UINT32)rgbValue[1] << 16) | ((UINT32)rgbValue[2] << 8) | (UINT32)rgbValue[3];
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Opens a TCP connection
+ *	@details
+ *
+ *	@param		PszHost			Host name or address
+ *	@param		PunPort			TCP port
+ *	@param		PpnSocket		Receives the connected socket
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_NO_TPM				The host cannot be resolved or reached.
+ */
+_Check_return_
+static unsigned int
+TpmSocket_Connect(
+	_In_z_	const char*		PszHost,
+	_In_	unsigned int	PunPort,
+	_Out_	int*			PpnSocket)
+{
+	unsigned int unReturnValue = RC_E_NO_TPM;
+	struct addrinfo sHints;
+	struct addrinfo* pAddresses = NULL;
+	struct addrinfo* pAddress = NULL;
+	char szPort[16] = {0};
+	int nError = 0;
+
+	*PpnSocket = -1;
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&sHints, 0, sizeof(sHints)));
+	sHints.ai_family = AF_UNSPEC;
+	sHints.ai_socktype = SOCK_STREAM;
+	snprintf(szPort, sizeof(szPort), "%u", PunPort);
+
+	nError = getaddrinfo(PszHost, szPort, &sHints, &pAddresses);
+	if (0 != nError)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: Resolving the software TPM host %s failed (%s).", PszHost, gai_strerror(nError));
+		return unReturnValue;
+	}
+
+	for (pAddress = pAddresses; NULL != pAddress; pAddress = pAddress->ai_next)
+	{
+		int nSocket = socket(pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol);
+		int nNoDelay = 1;
+		if (-1 == nSocket)
+			continue;
+		if (0 == connect(nSocket, pAddress->ai_addr, pAddress->ai_addrlen))
+		{
+			// Each TPM command is a short request/response exchange, do not delay the small frames
+			IGNORE_RETURN_VALUE((unsigned int)setsockopt(nSocket, IPPROTO_TCP, TCP_NODELAY, &nNoDelay, sizeof(nNoDelay)));
+			*PpnSocket = nSocket;
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+		nError = errno;
+		close(nSocket);
+	}
+	freeaddrinfo(pAddresses);
+
+	if (RC_SUCCESS != unReturnValue)
+		LOGGING_WRITE_LEVEL1_FMT(L"Error: Connecting to the software TPM at %s:%u failed with errno %d (%s).", PszHost, PunPort, nError, strerror(nError));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Powers the software TPM on through its platform port
+ *	@details	Sends TPM_SIGNAL_POWER_ON and TPM_SIGNAL_NV_ON and checks their acknowledgements.
+ *
+ *	@param		PszHost			Host name or address
+ *	@param		PunPort			TCP platform port
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_NO_TPM				The software TPM refused a platform command.
+ *	@retval		...						Error codes from TpmSocket_Connect, TpmSocket_SendUInt32 and TpmSocket_ReceiveUInt32
+ */
+_Check_return_
+static unsigned int
+TpmSocket_PowerOn(
+	_In_z_	const char*		PszHost,
+	_In_	unsigned int	PunPort)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	int nSocket = -1;
+
+	do
+	{
+		const UINT32 rgunCommands[] = {TPM_SOCKET_SIGNAL_POWER_ON, TPM_SOCKET_SIGNAL_NV_ON};
+		unsigned int unIndex = 0;
+
+		unReturnValue = TpmSocket_Connect(PszHost, PunPort, &nSocket);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		for (unIndex = 0; unIndex < RG_LEN(rgunCommands) && RC_SUCCESS == unReturnValue; unIndex++)
+		{
+			UINT32 unAcknowledge = 0;
+			unReturnValue = TpmSocket_SendUInt32(nSocket, rgunCommands[unIndex], 0);
+			if (RC_SUCCESS == unReturnValue)
+				unReturnValue = TpmSocket_ReceiveUInt32(nSocket, &unAcknowledge, Platform_GetMonotonicTimeMicroSeconds() + TPM_SOCKET_PLATFORM_TIMEOUT);
+			if (RC_SUCCESS == unReturnValue && 0 != unAcknowledge)
+			{
+				unReturnValue = RC_E_NO_TPM;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: The software TPM refused platform command %d (%d).", rgunCommands[unIndex], unAcknowledge);
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	if (-1 != nSocket)
+		close(nSocket);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Initialize the socket device access
+ *	@details	Connects to the TPM command port "host[:port]" configured in PROPERTY_TPM_DEVICE_ACCESS_PATH
+ *				(default localhost:2321, localhost:2331 for a TPMRemoteAgent). If PROPERTY_TPM_SOCKET_POWER_ON is set
+ *				the software TPM is powered on through its platform port (command port + 1) first.
+ *
+ *	@param		PfRemoteAgent			TRUE to connect to a TPMRemoteAgent, which also executes batched commands
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	The configured address is invalid.
+ *	@retval		RC_E_NO_TPM				The software TPM cannot be reached.
+ */
+_Check_return_
+unsigned int
+TpmSocket_Initialize(
+	_In_	BOOL	PfRemoteAgent)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		char szAddress[PROPERTY_STORAGE_MAX_VALUE] = {0};
+		wchar_t wszAddress[PROPERTY_STORAGE_MAX_VALUE] = {0};
+		unsigned int unAddressSize = RG_LEN(wszAddress);
+		unsigned int unPort = TPM_SOCKET_DEFAULT_PORT;
+		BOOL fPowerOn = FALSE;
+		char* pszPort = NULL;
+
+		if (-1 != s_nSocket)
+		{
+			unReturnValue = RC_E_ALREADY_CONNECTED;
+			break;
+		}
+
+		// Use the default address unless an address has been configured instead of the default device path
+		if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszAddress, &unAddressSize) ||
+				0 == Platform_StringCompare(wszAddress, TPM_DEVICE_ACCESS_PATH, RG_LEN(TPM_DEVICE_ACCESS_PATH), FALSE))
+		{
+			unAddressSize = RG_LEN(wszAddress);
+			unReturnValue = Platform_StringCopy(wszAddress, &unAddressSize, PfRemoteAgent ? TPM_DEVICE_ACCESS_REMOTE_PATH : TPM_DEVICE_ACCESS_SOCKET_PATH);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		if ((size_t)-1 == wcstombs(szAddress, wszAddress, sizeof(szAddress) - 1))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid software TPM address %ls.", wszAddress);
+			break;
+		}
+
+		// Split off the port
+		pszPort = strrchr(szAddress, ':');
+		if (NULL != pszPort)
+		{
+			char* pszEnd = NULL;
+			unsigned long ulPort = strtoul(pszPort + 1, &pszEnd, 10);
+			if ('\0' == pszPort[1] || '\0' != *pszEnd || 0 == ulPort || ulPort >= 0xFFFF)
+			{
+				unReturnValue = RC_E_INVALID_SETTING;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid port in software TPM address %ls.", wszAddress);
+				break;
+			}
+			unPort = (unsigned int)ulPort;
+			*pszPort = '\0';
+		}
+
+		// The TPM behind a TPMRemoteAgent is powered on with its host
+		if (!PfRemoteAgent && PropertyStorage_GetBooleanValueById(PROPERTY_ID_TPM_SOCKET_POWER_ON, &fPowerOn) && fPowerOn)
+		{
+			unReturnValue = TpmSocket_PowerOn(szAddress, unPort + 1);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unReturnValue = TpmSocket_Connect(szAddress, unPort, &s_nSocket);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		s_fRemoteAgent = PfRemoteAgent;
+		LOGGING_WRITE_LEVEL4_FMT(L"Connected to the %ls at %s:%u", PfRemoteAgent ? L"TPM remote agent" : L"software TPM", szAddress, unPort);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		UnInitialize the socket device access
+ *	@details	Ends the session with the software TPM and closes the connection.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_INTERNAL	If the connection is not opened
+ */
+_Check_return_
+unsigned int
+TpmSocket_Uninitialize()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		int nSocket = s_nSocket;
+
+		if (-1 == nSocket)
+		{
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving the socket failed (%.8x).", unReturnValue);
+			break;
+		}
+
+		// The software TPM keeps running for the next client
+		s_nSocket = -1;
+		s_fRemoteAgent = FALSE;
+		IGNORE_RETURN_VALUE(TpmSocket_SendUInt32(nSocket, TPM_SOCKET_SESSION_END, 0));
+		close(nSocket);
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		TPM transmit function
+ *	@details	This function submits the TPM command to the software TPM with the TPM_SEND_COMMAND frame of the
+ *				MS TPM simulator protocol and awaits the response until the maximum duration of the command has elapsed.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INTERNAL				If the connection is not opened
+ *	@retval		RC_E_BUFFER_TOO_SMALL		The response buffer is too small.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The command could not be sent.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The response could not be received.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	No response was received within the maximum duration of the command.
+ */
+_Check_return_
+unsigned int
+TpmSocket_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	UNREFERENCED_PARAMETER(PunExpectedDuration);
+
+	do
+	{
+		// TPM_SEND_COMMAND frame header: command, locality and command size
+		BYTE rgbFrameHeader[9] = {0};
+		UINT32 unResponseSize = 0;
+		UINT32 unAcknowledge = 0;
+		unsigned long long ullDeadline = 0;
+
+		// Check parameters
+		if (NULL == PrgbRequestBuffer || NULL == PrgbResponseBuffer || NULL == PpunResponseBufferSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		if (-1 == s_nSocket)
+		{
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving the socket failed (%.8x).", unReturnValue);
+			break;
+		}
+
+		rgbFrameHeader[3] = TPM_SOCKET_SEND_COMMAND;
+		rgbFrameHeader[5] = (BYTE)(PunRequestBufferSize >> 24);
+		rgbFrameHeader[6] = (BYTE)(PunRequestBufferSize >> 16);
+		rgbFrameHeader[7] = (BYTE)(PunRequestBufferSize >> 8);
+		rgbFrameHeader[8] = (BYTE)PunRequestBufferSize;
+		unReturnValue = TpmSocket_Send(s_nSocket, rgbFrameHeader, sizeof(rgbFrameHeader), MSG_MORE);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = TpmSocket_Send(s_nSocket, PrgbRequestBuffer, PunRequestBufferSize, 0);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// The TPM executes the command now, give the caller the chance to do host-side work in the meantime
+		TPMIO_CommandPending();
+
+		// Receive the response size, the response and the acknowledgement
+		ullDeadline = Platform_GetMonotonicTimeMicroSeconds() + PunMaxDuration;
+		unReturnValue = TpmSocket_ReceiveUInt32(s_nSocket, &unResponseSize, ullDeadline);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_Transmit: No response within %d microseconds (0x%.8x).", PunMaxDuration, unReturnValue);
+			break;
+		}
+		if (unResponseSize > *PpunResponseBufferSize)
+		{
+			// The connection cannot be resynchronized after an oversized response
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_Transmit: Response of %d bytes exceeds the response buffer (0x%.8x).", unResponseSize, unReturnValue);
+			break;
+		}
+		unReturnValue = TpmSocket_Receive(s_nSocket, PrgbResponseBuffer, unResponseSize, ullDeadline);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = TpmSocket_ReceiveUInt32(s_nSocket, &unAcknowledge, ullDeadline);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_Transmit: Receiving the response failed (0x%.8x).", unReturnValue);
+			break;
+		}
+
+		*PpunResponseBufferSize = unResponseSize;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		TPM transmit function for several commands in one network round trip
+ *	@details	Sends the commands in one TPM_SOCKET_SEND_BATCH frame to a TPMRemoteAgent. The agent executes them back
+ *				to back, stops after the first command which does not succeed and returns the response codes of the
+ *				executed commands. The responses themselves are not returned.
+ *
+ *	@param		PrgsRequestSegments		Parts of the requests, PunSegmentsPerRequest consecutive parts per request
+ *	@param		PunSegmentsPerRequest	Number of parts per request
+ *	@param		PunRequestCount			Number of requests (at most TPM_SOCKET_BATCH_MAX_COMMANDS)
+ *	@param		PrgunResponseCodes		Receives the TPM response code of each executed request, or
+ *										TPM_SOCKET_BATCH_TRANSPORT_ERROR if the agent could not transmit it
+ *	@param		PpunExecuted			Receives the number of executed requests
+ *	@param		PunMaxDuration			The maximum duration of one command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The frame was acknowledged, see PrgunResponseCodes for the result of each request.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INTERNAL				If the connection is not opened
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The connection is not to a TPMRemoteAgent.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The frame could not be sent.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The acknowledgements could not be received.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	No acknowledgement was received within the maximum duration of the commands.
+ */
+_Check_return_
+unsigned int
+TpmSocket_TransmitBatch(
+	_In_reads_(PunSegmentsPerRequest * PunRequestCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_												unsigned int			PunSegmentsPerRequest,
+	_In_												unsigned int			PunRequestCount,
+	_Out_cap_(PunRequestCount)							unsigned int*			PrgunResponseCodes,
+	_Out_												unsigned int*			PpunExecuted,
+	_In_												unsigned int			PunMaxDuration)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		UINT32 unExecuted = 0;
+		UINT32 unAcknowledge = 0;
+		unsigned int unRequest = 0;
+		unsigned int unSegment = 0;
+		unsigned long long ullDeadline = 0;
+
+		// Check parameters
+		if (NULL == PrgsRequestSegments || 0 == PunSegmentsPerRequest || 0 == PunRequestCount ||
+				PunRequestCount > TPM_SOCKET_BATCH_MAX_COMMANDS || NULL == PrgunResponseCodes || NULL == PpunExecuted)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpunExecuted = 0;
+
+		if (-1 == s_nSocket)
+		{
+			unReturnValue = RC_E_INTERNAL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Retrieving the socket failed (%.8x).", unReturnValue);
+			break;
+		}
+
+		// A software TPM does not know the frame and would drop the connection
+		if (!s_fRemoteAgent)
+		{
+			unReturnValue = RC_E_NOT_SUPPORTED_FEATURE;
+			break;
+		}
+
+		// TPM_SOCKET_SEND_BATCH frame: command, number of commands, maximum duration of one command and the commands
+		// with their sizes. The frame is handed over to TCP in one piece.
+		unReturnValue = TpmSocket_SendUInt32(s_nSocket, TPM_SOCKET_SEND_BATCH, MSG_MORE);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = TpmSocket_SendUInt32(s_nSocket, PunRequestCount, MSG_MORE);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = TpmSocket_SendUInt32(s_nSocket, PunMaxDuration, MSG_MORE);
+		for (unRequest = 0; unRequest < PunRequestCount && RC_SUCCESS == unReturnValue; unRequest++)
+		{
+			const IfxTpmIoSegment* psSegments = &PrgsRequestSegments[unRequest * PunSegmentsPerRequest];
+			UINT32 unRequestSize = 0;
+			for (unSegment = 0; unSegment < PunSegmentsPerRequest; unSegment++)
+				unRequestSize += psSegments[unSegment].unSize;
+			unReturnValue = TpmSocket_SendUInt32(s_nSocket, unRequestSize, MSG_MORE);
+			for (unSegment = 0; unSegment < PunSegmentsPerRequest && RC_SUCCESS == unReturnValue; unSegment++)
+			{
+				BOOL fLast = (unRequest + 1 == PunRequestCount && unSegment + 1 == PunSegmentsPerRequest);
+				unReturnValue = TpmSocket_Send(s_nSocket, psSegments[unSegment].pbData, psSegments[unSegment].unSize, fLast ? 0 : MSG_MORE);
+			}
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// The TPM executes the commands now, give the caller the chance to do host-side work in the meantime
+		TPMIO_CommandPending();
+
+		// Receive the number of executed commands, their response codes and the acknowledgement
+		ullDeadline = Platform_GetMonotonicTimeMicroSeconds() + (unsigned long long)PunMaxDuration * PunRequestCount;
+		unReturnValue = TpmSocket_ReceiveUInt32(s_nSocket, &unExecuted, ullDeadline);
+		if (RC_SUCCESS == unReturnValue && unExecuted > PunRequestCount)
+		{
+			// The connection cannot be resynchronized after an invalid acknowledgement
+			unReturnValue = RC_E_TPM_RECEIVE_DATA;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_TransmitBatch: %d of %d commands acknowledged (0x%.8x).", unExecuted, PunRequestCount, unReturnValue);
+			break;
+		}
+		for (unRequest = 0; unRequest < unExecuted && RC_SUCCESS == unReturnValue; unRequest++)
+			unReturnValue = TpmSocket_ReceiveUInt32(s_nSocket, &PrgunResponseCodes[unRequest], ullDeadline);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = TpmSocket_ReceiveUInt32(s_nSocket, &unAcknowledge, ullDeadline);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: TpmSocket_TransmitBatch: Receiving the acknowledgements failed (0x%.8x).", unReturnValue);
+			break;
+		}
+
+		*PpunExecuted = unExecuted;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
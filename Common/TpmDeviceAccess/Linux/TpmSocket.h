@@ -0,0 +1,128 @@
+﻿/**
+ *	@brief		Declares the Device access routines via the software TPM socket protocol
+ *	@details
+ *	@file		Linux/TpmSocket.h
+ *	@copyright	Copyright 2016 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "StdInclude.h"
+#include "TpmIO.h"
+
+/// Default TPM command port of the MS TPM simulator and swtpm
+#define TPM_SOCKET_DEFAULT_PORT			2321
+/// MS TPM simulator command: send a TPM command
+#define TPM_SOCKET_SEND_COMMAND			8
+/// MS TPM simulator command: end the session on the TPM command port
+#define TPM_SOCKET_SESSION_END			20
+/// TPMRemoteAgent command: execute several TPM commands back to back and acknowledge them with their response codes
+#define TPM_SOCKET_SEND_BATCH			0x49460001
+/// Maximum number of TPM commands in one TPM_SOCKET_SEND_BATCH frame
+#define TPM_SOCKET_BATCH_MAX_COMMANDS	TPMIO_BATCH_MAX_REQUESTS
+/// Acknowledgement of a batched TPM command the TPMRemoteAgent could not transmit to its TPM
+#define TPM_SOCKET_BATCH_TRANSPORT_ERROR	TPMIO_BATCH_TRANSPORT_ERROR
+/// MS TPM simulator platform command: power on
+#define TPM_SOCKET_SIGNAL_POWER_ON		1
+/// MS TPM simulator platform command: NV on
+#define TPM_SOCKET_SIGNAL_NV_ON			11
+/// Timeout in microseconds for the acknowledgements of the MS TPM simulator platform commands
+#define TPM_SOCKET_PLATFORM_TIMEOUT		5000000
+
+/**
+ *	@brief		Initialize the socket device access
+ *	@details	Connects to the TPM command port "host[:port]" configured in PROPERTY_TPM_DEVICE_ACCESS_PATH
+ *				(default localhost:2321, localhost:2331 for a TPMRemoteAgent). If PROPERTY_TPM_SOCKET_POWER_ON is set
+ *				the software TPM is powered on through its platform port (command port + 1) first.
+ *
+ *	@param		PfRemoteAgent			TRUE to connect to a TPMRemoteAgent, which also executes batched commands
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	The configured address is invalid.
+ *	@retval		RC_E_NO_TPM				The software TPM cannot be reached.
+ */
+_Check_return_
+unsigned int
+TpmSocket_Initialize(
+	_In_	BOOL	PfRemoteAgent);
+
+/**
+ *	@brief		UnInitialize the socket device access
+ *	@details	Ends the session with the software TPM and closes the connection.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_INTERNAL	If the connection is not opened
+ */
+_Check_return_
+unsigned int
+TpmSocket_Uninitialize();
+
+/**
+ *	@brief		TPM transmit function
+ *	@details	This function submits the TPM command to the software TPM with the TPM_SEND_COMMAND frame of the
+ *				MS TPM simulator protocol and awaits the response until the maximum duration of the command has elapsed.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INTERNAL				If the connection is not opened
+ *	@retval		RC_E_BUFFER_TOO_SMALL		The response buffer is too small.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The command could not be sent.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The response could not be received.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	No response was received within the maximum duration of the command.
+ */
+_Check_return_
+unsigned int
+TpmSocket_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration);
+
+/**
+ *	@brief		TPM transmit function for several commands in one network round trip
+ *	@details	Sends the commands in one TPM_SOCKET_SEND_BATCH frame to a TPMRemoteAgent. The agent executes them back
+ *				to back, stops after the first command which does not succeed and returns the response codes of the
+ *				executed commands. The responses themselves are not returned.
+ *
+ *	@param		PrgsRequestSegments		Parts of the requests, PunSegmentsPerRequest consecutive parts per request
+ *	@param		PunSegmentsPerRequest	Number of parts per request
+ *	@param		PunRequestCount			Number of requests (at most TPM_SOCKET_BATCH_MAX_COMMANDS)
+ *	@param		PrgunResponseCodes		Receives the TPM response code of each executed request, or
+ *										TPM_SOCKET_BATCH_TRANSPORT_ERROR if the agent could not transmit it
+ *	@param		PpunExecuted			Receives the number of executed requests
+ *	@param		PunMaxDuration			The maximum duration of one command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The frame was acknowledged, see PrgunResponseCodes for the result of each request.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INTERNAL				If the connection is not opened
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The connection is not to a TPMRemoteAgent.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The frame could not be sent.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The acknowledgements could not be received.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	No acknowledgement was received within the maximum duration of the commands.
+ */
+_Check_return_
+unsigned int
+TpmSocket_TransmitBatch(
+	_In_reads_(PunSegmentsPerRequest * PunRequestCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_												unsigned int			PunSegmentsPerRequest,
+	_In_												unsigned int			PunRequestCount,
+	_Out_cap_(PunRequestCount)							unsigned int*			PrgunResponseCodes,
+	_Out_												unsigned int*			PpunExecuted,
+	_In_												unsigned int			PunMaxDuration);
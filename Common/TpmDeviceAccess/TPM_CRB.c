@@ -0,0 +1,637 @@
+﻿/**
+ *	@brief		Implements the CRB related functions
+ *	@details	Implements the Command Response Buffer interface of the PC Client Platform TPM Profile. In contrast
+ *				to the TIS FIFO protocol the whole command is copied into the command buffer at once and started
+ *				through a single control register.
+ *	@file		TpmDeviceAccess/TPM_CRB.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TPM_CRB.h"
+#include "TPM_TIS.h"
+#include "DeviceAccess.h"
+#include "Platform.h"
+#include "Logging.h"
+
+/**
+ *	@brief		Determines whether a locality session has been started with CRB_BeginLocalitySession.
+ */
+static BOOL s_fLocalitySession = FALSE;
+/**
+ *	@brief		Determines whether the locality was already granted before the current locality session started.
+ */
+static BOOL s_fLocalityWasGranted = FALSE;
+/**
+ *	@brief		Address of the command buffer (device access address space), read once at the start of the locality session.
+ */
+static UINT32 s_unCommandBuffer = 0;
+/**
+ *	@brief		Size of the command buffer in bytes.
+ */
+static UINT32 s_unCommandBufferSize = 0;
+/**
+ *	@brief		Address of the response buffer (device access address space), read once at the start of the locality session.
+ */
+static UINT32 s_unResponseBuffer = 0;
+/**
+ *	@brief		Size of the response buffer in bytes.
+ */
+static UINT32 s_unResponseBufferSize = 0;
+/**
+ *	@brief		Transport statistics accumulated since the start of the application.
+ */
+static IfxTpmIoStatistics s_sStatistics = {0, 0, 0, 0, 0, 0};
+
+/**
+ *	@brief		Sleeps within a CRB wait loop
+ *	@details	Wrapper of Platform_SleepMicroSeconds that updates the wait loop statistics. In background mode the loop
+ *				polls at least every PLATFORM_BACKGROUND_MIN_SLEEP microseconds.
+ *
+ *	@param		PunMicroSeconds		Time to sleep in microseconds
+ */
+static void
+CRB_Sleep(
+	_In_	UINT32	PunMicroSeconds)
+{
+	unsigned long long ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+
+	if (TRUE == Platform_IsBackground() && PunMicroSeconds < PLATFORM_BACKGROUND_MIN_SLEEP)
+		PunMicroSeconds = PLATFORM_BACKGROUND_MIN_SLEEP;
+
+	s_sStatistics.ullWaitIterations++;
+	Platform_SleepMicroSeconds(PunMicroSeconds);
+
+	// Account the time actually slept, the system timer usually oversleeps the requested time
+	if (0 != ullStartTime)
+		s_sStatistics.ullWaitTimeMicroSeconds += Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+	else
+		s_sStatistics.ullWaitTimeMicroSeconds += PunMicroSeconds;
+}
+
+/**
+ *	@brief		Calculates the effective address of a CRB register
+ *	@details
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PusRegOffset	Register offset
+ *	@param		PpunAddress		Pointer to the effective address
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+static UINT32
+CRB_GetRegisterAddress(
+	_In_	BYTE	PbLocality,
+	_In_	UINT16	PusRegOffset,
+	_Out_	UINT32*	PpunAddress)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+
+	switch (PbLocality)
+	{
+		case TIS_LOCALITY_0:
+			*PpunAddress = TIS_LOCALITY0OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_1:
+			*PpunAddress = TIS_LOCALITY1OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_2:
+			*PpunAddress = TIS_LOCALITY2OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_3:
+			*PpunAddress = TIS_LOCALITY3OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_4:
+			*PpunAddress = TIS_LOCALITY4OFFSET | PusRegOffset;
+			break;
+
+		default:
+			*PpunAddress = 0;
+			unReturnCode = RC_E_LOCALITY_NOT_SUPPORTED;
+	}
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Read the value of a 32-bit CRB register
+ *	@details
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PusRegOffset	Register offset
+ *	@param		PpunValue		Pointer to the value
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+static UINT32
+CRB_ReadRegister(
+	_In_	BYTE	PbLocality,
+	_In_	UINT16	PusRegOffset,
+	_Out_	UINT32*	PpunValue)
+{
+	UINT32 unAddress = 0;
+	UINT32 unReturnCode = CRB_GetRegisterAddress(PbLocality, PusRegOffset, &unAddress);
+
+	*PpunValue = 0;
+	if (RC_SUCCESS == unReturnCode)
+	{
+		s_sStatistics.ullRegisterReads++;
+		*PpunValue = DeviceAccess_ReadDWord(unAddress);
+	}
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Write the value into a 32-bit CRB register
+ *	@details
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PusRegOffset	Register offset
+ *	@param		PunValue		Value to write
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+static UINT32
+CRB_WriteRegister(
+	_In_	BYTE	PbLocality,
+	_In_	UINT16	PusRegOffset,
+	_In_	UINT32	PunValue)
+{
+	UINT32 unAddress = 0;
+	UINT32 unReturnCode = CRB_GetRegisterAddress(PbLocality, PusRegOffset, &unAddress);
+
+	if (RC_SUCCESS == unReturnCode)
+	{
+		s_sStatistics.ullRegisterWrites++;
+		DeviceAccess_WriteDWord(unAddress, PunValue);
+	}
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Waits until the masked bits of a CRB register have the expected value
+ *	@details
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PusRegOffset	Register offset
+ *	@param		PunMask			Mask of the bits to check
+ *	@param		PunExpected		Expected value of the masked bits
+ *	@param		PunTimeout		Timeout in milliseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_NOT_READY				The register did not reach the expected value in time.
+ *	@retval		...							Error codes from CRB_ReadRegister function
+ */
+_Check_return_
+static UINT32
+CRB_WaitForRegister(
+	_In_	BYTE	PbLocality,
+	_In_	UINT16	PusRegOffset,
+	_In_	UINT32	PunMask,
+	_In_	UINT32	PunExpected,
+	_In_	UINT32	PunTimeout)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unValue = 0;
+	UINT32 unTimeOut = (PunTimeout * 1000) / SLEEP_TIME_US;
+
+	do
+	{
+		unReturnCode = CRB_ReadRegister(PbLocality, PusRegOffset, &unValue);
+		if (RC_SUCCESS != unReturnCode)
+			break;	// Stop immediately on Error
+		if ((unValue & PunMask) == PunExpected)
+			break;	// Stop immediately if condition is met
+
+		if (0 == unTimeOut)
+		{
+			unReturnCode = RC_E_NOT_READY;
+			break;
+		}
+		CRB_Sleep(SLEEP_TIME_US);
+		unTimeOut--;
+	}
+	while (TRUE);
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Determines whether the TPM exposes a CRB interface
+ *	@details	Evaluates the interface type field of the Interface Identifier register. TPMs with a FIFO or legacy
+ *				TIS interface continue to use the TIS functions.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PpfCrb			Pointer to a flag receiving TRUE for a CRB interface, FALSE otherwise
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+UINT32
+CRB_IsCrbInterface(
+	_In_	BYTE	PbLocality,
+	_Out_	BOOL*	PpfCrb)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unInterfaceId = 0;
+
+	do
+	{
+		if (NULL == PpfCrb)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		*PpfCrb = FALSE;
+
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_INTF_ID, &unInterfaceId);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		LOGGING_WRITE_LEVEL4_FMT(L"Interface type: 0x%.1X", unInterfaceId & CRB_INTF_ID_TYPE_MASK);
+
+		if (CRB_INTF_ID_TYPE_CRB == (unInterfaceId & CRB_INTF_ID_TYPE_MASK))
+			*PpfCrb = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Starts a locality session
+ *	@details	Requests the locality and records the command and response buffer locations. The locality is held
+ *				until CRB_EndLocalitySession is called.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	The locality was not granted in time.
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The command or response buffer is outside the mapped register space.
+ */
+_Check_return_
+UINT32
+CRB_BeginLocalitySession(
+	_In_	BYTE	PbLocality)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unValue = 0;
+	UINT32 unCommandHigh = 0;
+	UINT32 unResponseHigh = 0;
+	unsigned long long ullMemoryBase = DeviceAccess_GetMemoryBase();
+	unsigned long long ullCommandBuffer = 0;
+	unsigned long long ullResponseBuffer = 0;
+
+	do
+	{
+		// Remember whether the locality is already granted so that it is not relinquished at the end of the session
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_LOC_STS, &unValue);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		s_fLocalityWasGranted = (0 != (unValue & CRB_LOC_STS_GRANTED));
+		if (FALSE == s_fLocalityWasGranted)
+		{
+			unReturnCode = CRB_WriteRegister(PbLocality, CRB_LOC_CTRL, CRB_LOC_CTRL_REQUEST_ACCESS);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+
+			unReturnCode = CRB_WaitForRegister(PbLocality, CRB_LOC_STS, CRB_LOC_STS_GRANTED, CRB_LOC_STS_GRANTED, TIMEOUT_A);
+			if (RC_E_NOT_READY == unReturnCode)
+			{
+				unReturnCode = RC_E_LOCALITY_NOT_ACTIVE;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_BeginLocalitySession: Locality %d was not granted (0x%.8x)", PbLocality, unReturnCode);
+			}
+			if (RC_SUCCESS != unReturnCode)
+				break;
+		}
+
+		// The buffer locations are fixed for the session, read them once instead of for each command
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_CMD_LADDR, &s_unCommandBuffer);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_CMD_HADDR, &unCommandHigh);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_CMD_SIZE, &s_unCommandBufferSize);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_RSP_ADDR, &s_unResponseBuffer);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_RSP_HADDR, &unResponseHigh);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_RSP_SIZE, &s_unResponseBufferSize);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		LOGGING_WRITE_LEVEL4_FMT(L"CRB command buffer: 0x%.8X (%d bytes), response buffer: 0x%.8X (%d bytes)", s_unCommandBuffer, s_unCommandBufferSize, s_unResponseBuffer, s_unResponseBufferSize);
+
+		// Only buffers within the register space mapped by the device access layer can be accessed
+		ullCommandBuffer = ((unsigned long long)unCommandHigh << 32) | s_unCommandBuffer;
+		ullResponseBuffer = ((unsigned long long)unResponseHigh << 32) | s_unResponseBuffer;
+		if (ullCommandBuffer < ullMemoryBase || ullCommandBuffer - ullMemoryBase >= TPM_DEFAULT_MEM_SIZE ||
+				!DeviceAccess_IsMapped(TPM_DEFAULT_MEM_BASE + (UINT32)(ullCommandBuffer - ullMemoryBase), s_unCommandBufferSize) ||
+				ullResponseBuffer < ullMemoryBase || ullResponseBuffer - ullMemoryBase >= TPM_DEFAULT_MEM_SIZE ||
+				!DeviceAccess_IsMapped(TPM_DEFAULT_MEM_BASE + (UINT32)(ullResponseBuffer - ullMemoryBase), s_unResponseBufferSize) ||
+				s_unResponseBufferSize < CRB_RESPONSE_HEADER_SIZE)
+		{
+			unReturnCode = RC_E_NOT_SUPPORTED_FEATURE;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_BeginLocalitySession: The CRB buffers are outside the supported memory range (0x%.8x)", unReturnCode);
+			break;
+		}
+
+		// The buffers are physical addresses, the device access routines use addresses relative to TPM_DEFAULT_MEM_BASE
+		s_unCommandBuffer = TPM_DEFAULT_MEM_BASE + (UINT32)(ullCommandBuffer - ullMemoryBase);
+		s_unResponseBuffer = TPM_DEFAULT_MEM_BASE + (UINT32)(ullResponseBuffer - ullMemoryBase);
+		s_fLocalitySession = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS != unReturnCode && FALSE == s_fLocalityWasGranted)
+	{
+		// Give a requested locality back, the error of the session start is the relevant one
+		IGNORE_RETURN_VALUE(CRB_WriteRegister(PbLocality, CRB_LOC_CTRL, CRB_LOC_CTRL_RELINQUISH));
+	}
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Ends a locality session
+ *	@details	Puts the TPM into the idle state and relinquishes the locality if it was not granted before the
+ *				session started.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+UINT32
+CRB_EndLocalitySession(
+	_In_	BYTE	PbLocality)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+
+	do
+	{
+		if (FALSE == s_fLocalitySession)
+			break;
+
+		// The TPM is only put into the idle state once per session instead of after each command
+		unReturnCode = CRB_WriteRegister(PbLocality, CRB_CTRL_REQ, CRB_CTRL_REQ_GO_IDLE);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		if (FALSE == s_fLocalityWasGranted)
+			unReturnCode = CRB_WriteRegister(PbLocality, CRB_LOC_CTRL, CRB_LOC_CTRL_RELINQUISH);
+	}
+	WHILE_FALSE_END;
+
+	s_fLocalitySession = FALSE;
+	s_fLocalityWasGranted = FALSE;
+	s_unCommandBuffer = 0;
+	s_unCommandBufferSize = 0;
+	s_unResponseBuffer = 0;
+	s_unResponseBufferSize = 0;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Sends the Transceive Buffer to the TPM and returns the response
+ *	@details	The command is copied into the command buffer at once and started through the Start register. The
+ *				response is copied from the response buffer once the TPM has cleared the Start register.
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgbTxBuffer		Pointer Transceive buffer
+ *	@param		PusTxLen			Length of the Transceive buffer
+ *	@param		PrgbRxBuffer		Pointer to a Receive buffer
+ *	@param		PpusRxLen			Pointer to the length of the Receive buffer
+ *	@param		PunMaxDuration		The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration	The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	No locality session has been started.
+ *	@retval		RC_E_NOT_READY				The TPM did not become ready or reported a fatal error.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The command does not fit into the command buffer.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	The command did not complete within the maximum duration.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The response header is invalid.
+ *	@retval		RC_E_INSUFFICIENT_BUFFER	The receive buffer is too small for the response.
+ */
+_Check_return_
+UINT32
+CRB_Transceive(
+	_In_						BYTE		PbLocality,
+	_In_bytecount_(PusTxLen)	const BYTE*	PrgbTxBuffer,
+	_In_						UINT16		PusTxLen,
+	_Out_bytecap_(*PpusRxLen)	BYTE*		PrgbRxBuffer,
+	_Inout_						UINT16*		PpusRxLen,
+	_In_						UINT32		PunMaxDuration,
+	_In_						UINT32		PunExpectedDuration)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unValue = 0;
+	UINT32 unResponseSize = 0;
+	UINT32 unSleepTime = SLEEP_TIME_US_CR;
+	UINT32 unSleptTime = 0;
+	unsigned long long ullStartTime = 0;
+	unsigned long long ullElapsedTime = 0;
+
+	do
+	{
+		// Check input parameters
+		if (NULL == PrgbTxBuffer || NULL == PrgbRxBuffer || NULL == PpusRxLen)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		if (FALSE == s_fLocalitySession)
+		{
+			unReturnCode = RC_E_LOCALITY_NOT_ACTIVE;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: No locality session has been started (0x%.8x)", unReturnCode);
+			break;
+		}
+
+		// Basic Buffer size check, must be at least 10 Bytes (TAG, Size, Response Code)
+		if (*PpusRxLen < CRB_RESPONSE_HEADER_SIZE)
+		{
+			unReturnCode = RC_E_INSUFFICIENT_BUFFER;
+			break;
+		}
+
+		if (PusTxLen > s_unCommandBufferSize)
+		{
+			unReturnCode = RC_E_TPM_TRANSMIT_DATA;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: The command does not fit into the command buffer (%d, %d)", PusTxLen, s_unCommandBufferSize);
+			break;
+		}
+
+		// Bring the TPM out of the idle state, it stays ready between the commands of the session
+		unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_STS, &unValue);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		if (unValue & CRB_CTRL_STS_ERROR)
+		{
+			unReturnCode = RC_E_NOT_READY;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: The TPM reports a fatal error (0x%.8x)", unValue);
+			break;
+		}
+		if (unValue & CRB_CTRL_STS_IDLE)
+		{
+			unReturnCode = CRB_WriteRegister(PbLocality, CRB_CTRL_REQ, CRB_CTRL_REQ_CMD_READY);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+
+			unReturnCode = CRB_WaitForRegister(PbLocality, CRB_CTRL_REQ, CRB_CTRL_REQ_CMD_READY, 0, TIMEOUT_C);
+			if (RC_SUCCESS == unReturnCode)
+				unReturnCode = CRB_WaitForRegister(PbLocality, CRB_CTRL_STS, CRB_CTRL_STS_IDLE, 0, TIMEOUT_C);
+			if (RC_SUCCESS != unReturnCode)
+			{
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: The TPM did not become ready (0x%.8x)", unReturnCode);
+				break;
+			}
+		}
+
+		// Copy the whole command and start it
+		unReturnCode = DeviceAccess_CopyToMemory(s_unCommandBuffer, PrgbTxBuffer, PusTxLen);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		s_sStatistics.ullFifoBytesWritten += PusTxLen;
+
+		unReturnCode = CRB_WriteRegister(PbLocality, CRB_CTRL_START, CRB_CTRL_TRIGGER);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		// The TPM executes the command now, give the caller the chance to do host-side work in the meantime
+		TPMIO_CommandPending();
+
+		// Wait until the TPM clears the Start register. Commands that are expected to complete quickly are busy-polled
+		// for their expected duration. Afterwards the TPM is polled with exponentially increasing sleep intervals.
+		ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		do
+		{
+			unReturnCode = CRB_ReadRegister(PbLocality, CRB_CTRL_START, &unValue);
+			if (RC_SUCCESS != unReturnCode)
+				break;	// Stop immediately on Error
+			if (0 == (unValue & CRB_CTRL_TRIGGER))
+				break;	// Stop immediately if the command has completed
+
+			// The accumulated sleep time is a lower bound of the elapsed time in case the monotonic clock is not available
+			ullElapsedTime = Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+			if (ullElapsedTime < unSleptTime)
+				ullElapsedTime = unSleptTime;
+			if (ullElapsedTime >= PunMaxDuration)
+			{
+				unReturnCode = RC_E_TPM_NO_DATA_AVAILABLE;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: No data available after timeout of %d microseconds (0x%.8x)", PunMaxDuration, unReturnCode);
+				break;
+			}
+
+			if (0 != ullStartTime && PunExpectedDuration <= TIS_MAX_SPIN_TIME_US && ullElapsedTime < PunExpectedDuration)
+			{
+				s_sStatistics.ullWaitIterations++;
+				continue;	// Busy-poll within the expected duration
+			}
+
+			// Do not sleep past the timeout, the TPM is checked once more at the deadline
+			if (unSleepTime > PunMaxDuration - ullElapsedTime)
+				unSleepTime = (UINT32)(PunMaxDuration - ullElapsedTime);
+			CRB_Sleep(unSleepTime);
+			unSleptTime += unSleepTime;
+			unSleepTime *= 2;
+			if (unSleepTime > SLEEP_TIME_US)
+				unSleepTime = SLEEP_TIME_US;
+		}
+		while (TRUE);
+
+		if (RC_E_TPM_NO_DATA_AVAILABLE == unReturnCode)
+		{
+			// Cancel the command so that the TPM accepts the next one, the timeout is the relevant error
+			IGNORE_RETURN_VALUE(CRB_WriteRegister(PbLocality, CRB_CTRL_CANCEL, CRB_CTRL_TRIGGER));
+			IGNORE_RETURN_VALUE(CRB_WaitForRegister(PbLocality, CRB_CTRL_START, CRB_CTRL_TRIGGER, 0, TIMEOUT_B));
+			IGNORE_RETURN_VALUE(CRB_WriteRegister(PbLocality, CRB_CTRL_CANCEL, 0));
+		}
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		// Read the response header first to determine the response size
+		unReturnCode = DeviceAccess_CopyFromMemory(s_unResponseBuffer, PrgbRxBuffer, CRB_RESPONSE_HEADER_SIZE);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		unResponseSize = ((UINT32)PrgbRxBuffer[2] << 24) + ((UINT32)PrgbRxBuffer[3] << 16) + ((UINT32)PrgbRxBuffer[4] << 8) + PrgbRxBuffer[5];
+		if (unResponseSize < CRB_RESPONSE_HEADER_SIZE || unResponseSize > s_unResponseBufferSize)
+		{
+			unReturnCode = RC_E_TPM_RECEIVE_DATA;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: Invalid response size in the response header (0x%.8X)", unResponseSize);
+			break;
+		}
+		if (unResponseSize > *PpusRxLen)
+		{
+			unReturnCode = RC_E_INSUFFICIENT_BUFFER;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: CRB_Transceive: Insufficient space in the receive buffer (%d, %d)", *PpusRxLen, unResponseSize);
+			break;
+		}
+
+		unReturnCode = DeviceAccess_CopyFromMemory(
+							s_unResponseBuffer + CRB_RESPONSE_HEADER_SIZE,
+							PrgbRxBuffer + CRB_RESPONSE_HEADER_SIZE,
+							unResponseSize - CRB_RESPONSE_HEADER_SIZE);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		s_sStatistics.ullFifoBytesRead += unResponseSize;
+
+		*PpusRxLen = (UINT16)unResponseSize;
+	}
+	WHILE_FALSE_END;
+
+	// Set received size to 0 in case of an error
+	if (RC_SUCCESS != unReturnCode && NULL != PpusRxLen)
+		*PpusRxLen = 0;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Returns the CRB transport statistics
+ *	@details	Returns the register accesses, buffer bytes and wait loop statistics accumulated since the start of
+ *				the application. The command and response buffer bytes are reported as data FIFO bytes.
+ *
+ *	@param		PpStatistics		Pointer to a structure receiving the statistics
+ */
+void
+CRB_GetStatistics(
+	_Out_	IfxTpmIoStatistics*	PpStatistics)
+{
+	if (NULL != PpStatistics)
+		*PpStatistics = s_sStatistics;
+}
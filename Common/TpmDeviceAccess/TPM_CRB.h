@@ -0,0 +1,188 @@
+﻿/**
+ *	@brief		Declares the CRB related functions
+ *	@details
+ *	@file		TpmDeviceAccess/TPM_CRB.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TPM_CRB_H__
+#define __TPM_CRB_H__
+
+#include "StdInclude.h"
+#include "TpmIO.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CRB Definitions, the CRB register space of each locality shares the base addresses with the TIS register space
+// CRB Interface Registers
+/// Register offset for CRB Locality State register
+#define CRB_LOC_STATE 0x00000000
+/// Register offset for CRB Locality Control register
+#define CRB_LOC_CTRL 0x00000008
+/// Register offset for CRB Locality Status register
+#define CRB_LOC_STS 0x0000000C
+/// Register offset for the Interface Identifier register (shared by FIFO and CRB interfaces)
+#define CRB_INTF_ID 0x00000030
+/// Register offset for CRB Control Area Request register
+#define CRB_CTRL_REQ 0x00000040
+/// Register offset for CRB Control Area Status register
+#define CRB_CTRL_STS 0x00000044
+/// Register offset for CRB Control Area Cancel register
+#define CRB_CTRL_CANCEL 0x00000048
+/// Register offset for CRB Control Area Start register
+#define CRB_CTRL_START 0x0000004C
+/// Register offset for CRB Control Area Command Buffer Size register
+#define CRB_CTRL_CMD_SIZE 0x00000058
+/// Register offset for CRB Control Area Command Buffer Address register (lower 32 bits)
+#define CRB_CTRL_CMD_LADDR 0x0000005C
+/// Register offset for CRB Control Area Command Buffer Address register (upper 32 bits)
+#define CRB_CTRL_CMD_HADDR 0x00000060
+/// Register offset for CRB Control Area Response Buffer Size register
+#define CRB_CTRL_RSP_SIZE 0x00000064
+/// Register offset for CRB Control Area Response Buffer Address register (lower 32 bits)
+#define CRB_CTRL_RSP_ADDR 0x00000068
+/// Register offset for CRB Control Area Response Buffer Address register (upper 32 bits)
+#define CRB_CTRL_RSP_HADDR 0x0000006C
+
+/// Interface Identifier register mask for the interface type (bits 0-3)
+#define CRB_INTF_ID_TYPE_MASK 0x0000000F
+/// Interface type of a FIFO interface according to the PC Client Platform TPM Profile
+#define CRB_INTF_ID_TYPE_FIFO 0x00000000
+/// Interface type of a CRB interface
+#define CRB_INTF_ID_TYPE_CRB 0x00000001
+/// Interface type of a legacy TIS 1.3 FIFO interface
+#define CRB_INTF_ID_TYPE_TIS 0x0000000F
+
+/// CRB Locality State register bit for register valid
+#define CRB_LOC_STATE_VALID 0x00000080
+/// CRB Locality Control register bit for request access
+#define CRB_LOC_CTRL_REQUEST_ACCESS 0x00000001
+/// CRB Locality Control register bit for relinquish
+#define CRB_LOC_CTRL_RELINQUISH 0x00000002
+/// CRB Locality Status register bit for granted
+#define CRB_LOC_STS_GRANTED 0x00000001
+
+/// CRB Control Area Request register bit for command ready
+#define CRB_CTRL_REQ_CMD_READY 0x00000001
+/// CRB Control Area Request register bit for go idle
+#define CRB_CTRL_REQ_GO_IDLE 0x00000002
+/// CRB Control Area Status register bit for a fatal TPM error
+#define CRB_CTRL_STS_ERROR 0x00000001
+/// CRB Control Area Status register bit for TPM idle
+#define CRB_CTRL_STS_IDLE 0x00000002
+/// CRB Control Area Start and Cancel register value to trigger the operation
+#define CRB_CTRL_TRIGGER 0x00000001
+
+/// Size of the TPM response header (tag, response size and response code)
+#define CRB_RESPONSE_HEADER_SIZE 10
+
+/**
+ *	@brief		Determines whether the TPM exposes a CRB interface
+ *	@details	Evaluates the interface type field of the Interface Identifier register. TPMs with a FIFO or legacy
+ *				TIS interface continue to use the TIS functions.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PpfCrb			Pointer to a flag receiving TRUE for a CRB interface, FALSE otherwise
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+UINT32
+CRB_IsCrbInterface(
+	_In_	BYTE	PbLocality,
+	_Out_	BOOL*	PpfCrb);
+
+/**
+ *	@brief		Starts a locality session
+ *	@details	Requests the locality and records the command and response buffer locations. The locality is held
+ *				until CRB_EndLocalitySession is called.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	The locality was not granted in time.
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The command or response buffer is outside the mapped register space.
+ */
+_Check_return_
+UINT32
+CRB_BeginLocalitySession(
+	_In_	BYTE	PbLocality);
+
+/**
+ *	@brief		Ends a locality session
+ *	@details	Puts the TPM into the idle state and relinquishes the locality if it was not granted before the
+ *				session started.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+UINT32
+CRB_EndLocalitySession(
+	_In_	BYTE	PbLocality);
+
+/**
+ *	@brief		Sends the Transceive Buffer to the TPM and returns the response
+ *	@details	The command is copied into the command buffer at once and started through the Start register. The
+ *				response is copied from the response buffer once the TPM has cleared the Start register.
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgbTxBuffer		Pointer Transceive buffer
+ *	@param		PusTxLen			Length of the Transceive buffer
+ *	@param		PrgbRxBuffer		Pointer to a Receive buffer
+ *	@param		PpusRxLen			Pointer to the length of the Receive buffer
+ *	@param		PunMaxDuration		The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration	The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	No locality session has been started.
+ *	@retval		RC_E_NOT_READY				The TPM did not become ready or reported a fatal error.
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		The command does not fit into the command buffer.
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	The command did not complete within the maximum duration.
+ *	@retval		RC_E_TPM_RECEIVE_DATA		The response header is invalid.
+ *	@retval		RC_E_INSUFFICIENT_BUFFER	The receive buffer is too small for the response.
+ */
+_Check_return_
+UINT32
+CRB_Transceive(
+	_In_						BYTE		PbLocality,
+	_In_bytecount_(PusTxLen)	const BYTE*	PrgbTxBuffer,
+	_In_						UINT16		PusTxLen,
+	_Out_bytecap_(*PpusRxLen)	BYTE*		PrgbRxBuffer,
+	_Inout_						UINT16*		PpusRxLen,
+	_In_						UINT32		PunMaxDuration,
+	_In_						UINT32		PunExpectedDuration);
+
+/**
+ *	@brief		Returns the CRB transport statistics
+ *	@details	Returns the register accesses, buffer bytes and wait loop statistics accumulated since the start of
+ *				the application. The command and response buffer bytes are reported as data FIFO bytes.
+ *
+ *	@param		PpStatistics		Pointer to a structure receiving the statistics
+ */
+void
+CRB_GetStatistics(
+	_Out_	IfxTpmIoStatistics*	PpStatistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__TPM_CRB_H__
@@ -17,6 +17,9 @@
 #include "DeviceAccess.h"
 #include "Platform.h"
 #include "Logging.h"
+#include "Trace.h"
+#include "FlightRecorder.h"
+#include "Probes.h"
 
 /**
  *	@brief		Caches the last read value of the access register. The variable is used for logging purposes.
@@ -34,6 +37,42 @@ static BYTE s_bStatusRegister = 0xFF;
  *	@brief		Determines whether the value of s_bStatusRegister could be read.
  */
 static BOOL s_fStatusRegisterValid = FALSE;
+/**
+ *	@brief		Caches the maximum width of a single data FIFO access. 0 means not yet determined.
+ */
+static BYTE s_bFifoAccessSize = 0;
+/**
+ *	@brief		Determines whether the locality is held across commands until TIS_EndLocalitySession is called.
+ */
+static BOOL s_fLocalitySession = FALSE;
+/**
+ *	@brief		Determines whether the locality has been acquired within the current locality session.
+ */
+static BOOL s_fLocalityHeld = FALSE;
+/**
+ *	@brief		Determines whether the locality was already active before it was acquired within the current locality session.
+ */
+static BOOL s_fLocalityWasActive = FALSE;
+/**
+ *	@brief		Determines whether commandReady was written after the last response while the locality stays held.
+ */
+static BOOL s_fCommandReadyArmed = FALSE;
+/**
+ *	@brief		Transport statistics accumulated since the start of the application.
+ */
+static IfxTpmIoStatistics s_sStatistics = {0, 0, 0, 0, 0, 0};
+/**
+ *	@brief		Polling parameters in use, see TIS_SetTuning.
+ */
+static IfxTisTuning s_sTuning = {SLEEP_TIME_US, SLEEP_TIME_US_CR, SLEEP_TIME_US_BURSTCOUNT, TIS_MAX_SPIN_TIME_US, 0, 0, 0};
+/**
+ *	@brief		Determines whether the wait loops sleep on the TPM interrupt line, see TIS_EnableInterrupts.
+ */
+static BOOL s_fInterruptsEnabled = FALSE;
+/**
+ *	@brief		Determines whether the register accesses are TPM SPI transactions, see TIS_SelectEngine.
+ */
+static BOOL s_fSpiEngine = FALSE;
 
 /**
  *	@brief		Represents a TPM register descriptor
@@ -111,6 +150,80 @@ static IfxTpmRegister s_sAccessRegister[] =
 	} \
 } \
 
+/**
+ *	@brief		Sleeps within a TIS wait loop
+ *	@details	Wrapper of Platform_SleepMicroSeconds that updates the wait loop statistics. In background mode the loop
+ *				polls at least every PLATFORM_BACKGROUND_MIN_SLEEP microseconds.
+ *
+ *	@param		PunMicroSeconds		Time to sleep in microseconds
+ */
+static void
+TIS_Sleep(
+	_In_	UINT32	PunMicroSeconds)
+{
+	unsigned long long ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+
+	if (TRUE == Platform_IsBackground() && PunMicroSeconds < PLATFORM_BACKGROUND_MIN_SLEEP)
+		PunMicroSeconds = PLATFORM_BACKGROUND_MIN_SLEEP;
+
+	s_sStatistics.ullWaitIterations++;
+	PROBE1(tis__sleep, PunMicroSeconds);
+	Platform_SleepMicroSeconds(PunMicroSeconds);
+
+	// Account the time actually slept, the system timer usually oversleeps the requested time
+	if (0 != ullStartTime)
+		s_sStatistics.ullWaitTimeMicroSeconds += Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+	else
+		s_sStatistics.ullWaitTimeMicroSeconds += PunMicroSeconds;
+}
+
+/**
+ *	@brief		Sleeps within a TIS wait loop until the TPM raises an interrupt
+ *	@details	Waits on the interrupt line for at most the given time and acknowledges the interrupt in the TPM afterwards.
+ *				Falls back to polling for the rest of the connection if the interrupt line fails.
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PunMicroSeconds		Longest time to wait in microseconds
+ *
+ *	@returns	Time waited in microseconds, at least one polling interval if the monotonic clock is not available
+ */
+static UINT32
+TIS_WaitInterrupt(
+	_In_	BYTE	PbLocality,
+	_In_	UINT32	PunMicroSeconds)
+{
+	unsigned long long ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+	unsigned long long ullWaitTime = 0;
+	UINT32 unStatus = 0;
+	BOOL fSignaled = FALSE;
+
+	if (RC_SUCCESS != DeviceAccess_WaitInterrupt(PunMicroSeconds, &fSignaled))
+	{
+		LOGGING_WRITE_LEVEL1(L"Error: Waiting for the TPM interrupt failed, falling back to polling.");
+		s_fInterruptsEnabled = FALSE;
+		TIS_Sleep(PunMicroSeconds);
+		return PunMicroSeconds;
+	}
+
+	s_sStatistics.ullWaitIterations++;
+	if (0 != ullStartTime)
+		ullWaitTime = Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+	else if (!fSignaled)
+		ullWaitTime = PunMicroSeconds;
+	else
+		ullWaitTime = s_sTuning.unSleepTime < PunMicroSeconds ? s_sTuning.unSleepTime : PunMicroSeconds;
+	// A TPM raising the interrupt without becoming ready must still run into the timeout of the wait loop
+	if (0 == ullWaitTime)
+		ullWaitTime = 1;
+	s_sStatistics.ullWaitTimeMicroSeconds += ullWaitTime;
+
+	// Clear the interrupt status, the TPM keeps the interrupt asserted until then
+	if (fSignaled && RC_SUCCESS == TIS_ReadRegister(PbLocality, TIS_TPM_INT_STATUS, sizeof(UINT32), &unStatus) && 0 != unStatus)
+		IGNORE_RETURN_VALUE(TIS_WriteRegister(PbLocality, TIS_TPM_INT_STATUS, sizeof(UINT32), unStatus));
+
+	return (UINT32)ullWaitTime;
+}
+
 /**
  *	@brief		Read the value of a TIS register
  *	@details
@@ -178,6 +291,7 @@ TIS_ReadRegister(
 		// Calculate effective Address
 		unAddress = unAddress | PusRegOffset;
 
+		s_sStatistics.ullRegisterReads++;
 		switch (PbRegSize)
 		{
 			case sizeof(BYTE):
@@ -188,6 +302,10 @@ TIS_ReadRegister(
 				*(UINT16*)PpValue = DeviceAccess_ReadWord(unAddress);
 				break;
 
+			case sizeof(UINT32):
+				*(UINT32*)PpValue = DeviceAccess_ReadDWord(unAddress);
+				break;
+
 			default:
 				// Invalid Register Size requested
 				unReturnCode = RC_E_BAD_PARAMETER;
@@ -257,6 +375,7 @@ TIS_WriteRegister(
 		// Calculate effective Address
 		unAddress = unAddress | PusRegOffset;
 
+		s_sStatistics.ullRegisterWrites++;
 		switch (PbRegSize)
 		{
 			case sizeof(BYTE):
@@ -267,6 +386,10 @@ TIS_WriteRegister(
 				DeviceAccess_WriteWord(unAddress, (UINT16)PunValue);
 				break;
 
+			case sizeof(UINT32):
+				DeviceAccess_WriteDWord(unAddress, PunValue);
+				break;
+
 			default:
 				// Invalid Register Size requested
 				unReturnCode = RC_E_BAD_PARAMETER;
@@ -331,9 +454,18 @@ TIS_ReadStsRegister(
 {
 	UINT32 unReturnCode = RC_SUCCESS;
 	BOOL bFlag = FALSE;
+	UINT16 usBurstCount = 0;
 
 	do
 	{
+		// The SPI engine reads STS with a single transaction while the locality is held, the ACCESS register is not
+		// read since a locality that is not active reads as all ones
+		if (s_fSpiEngine && s_fLocalityHeld)
+		{
+			unReturnCode = TIS_ReadStatusSnapshot(PbLocality, PpbValue, &usBurstCount);
+			break;
+		}
+
 		// Check whether the requested locality is active.
 		unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
 		if (RC_SUCCESS != unReturnCode)
@@ -385,15 +517,19 @@ TIS_WriteStsRegister(
 
 	do
 	{
-		// Check whether requested Locality is active
-		unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
-		if (RC_SUCCESS != unReturnCode)
-			break;
-
-		if (FALSE == bFlag)
+		// Check whether requested Locality is active. The SPI engine skips the check while the locality is held, the
+		// TPM ignores the write otherwise and the next status read fails.
+		if (!s_fSpiEngine || !s_fLocalityHeld)
 		{
-			unReturnCode = RC_E_LOCALITY_NOT_ACTIVE;
-			break;
+			unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+
+			if (FALSE == bFlag)
+			{
+				unReturnCode = RC_E_LOCALITY_NOT_ACTIVE;
+				break;
+			}
 		}
 
 		unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_STS, sizeof(BYTE), (UINT32)PbValue);
@@ -712,133 +848,583 @@ TIS_Retry(
 }
 
 /**
- *	@brief		Send data block to the TPM
- *	@details	Send a data block to the TPM TIS data FIFO under consideration of the
- *				TIS communication protocol
+ *	@brief		Calculates the address of a TIS register
+ *	@details
  *
  *	@param		PbLocality		Locality value
- *	@param		PrgbByteBuf		Bytes to send
- *	@param		PusLen			Length of bytes
+ *	@param		PusRegOffset	Register offset
+ *	@param		PpunAddress		Pointer to the effective address
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PrgbByteBuf is NULL.
- *	@retval		RC_E_LOCALITY_NOT_ACTIVE	Locality not active
- *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	TPM no data available
- *	@retval		RC_E_NOT_READY				Not ready
- *	@retval		RC_E_TPM_TRANSMIT_DATA		Error during transmit data
- *	@retval		...							Error codes from:
- *												TIS_RequestUse,
- *												TIS_IsActiveLocality,
- *												TIS_IsCommandReady,
- *												TIS_Abort,
- *												TIS_GetBurstCount,
- *												TIS_WriteRegister,
- *												TIS_ReadStsRegister function
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+static UINT32
+TIS_GetRegisterAddress(
+	_In_	BYTE	PbLocality,
+	_In_	UINT16	PusRegOffset,
+	_Out_	UINT32*	PpunAddress)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+
+	switch (PbLocality)
+	{
+		case TIS_LOCALITY_0:
+			*PpunAddress = TIS_LOCALITY0OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_1:
+			*PpunAddress = TIS_LOCALITY1OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_2:
+			*PpunAddress = TIS_LOCALITY2OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_3:
+			*PpunAddress = TIS_LOCALITY3OFFSET | PusRegOffset;
+			break;
+
+		case TIS_LOCALITY_4:
+			*PpunAddress = TIS_LOCALITY4OFFSET | PusRegOffset;
+			break;
+
+		default:
+			unReturnCode = RC_E_LOCALITY_NOT_SUPPORTED;
+	}
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Returns the maximum width of a single data FIFO access
+ *	@details	The value is determined once from the data transfer size support field of the TPM Interface
+ *				Capability register: 11b allows 32-bit, 10b 16-bit accesses. 01b (8-bit) and a legacy TIS 1.2
+ *				interface (00b) allow single byte transfers only.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@returns	sizeof(UINT32) if 32-bit FIFO accesses are supported, sizeof(UINT16) if 16-bit FIFO accesses are
+ *				supported, sizeof(BYTE) otherwise
+ */
+static BYTE
+TIS_GetFifoAccessSize(
+	_In_	BYTE	PbLocality)
+{
+	if (0 == s_bFifoAccessSize)
+	{
+		UINT16 usInterfaceCapability = 0;
+		s_bFifoAccessSize = sizeof(BYTE);
+		if (RC_SUCCESS == TIS_ReadRegister(PbLocality, TIS_TPM_INTF_CAPABILITY, sizeof(UINT16), &usInterfaceCapability) &&
+				0xFFFF != usInterfaceCapability)
+		{
+			if (TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_32BIT == (usInterfaceCapability & TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_MASK))
+				s_bFifoAccessSize = sizeof(UINT32);
+			else if (TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_16BIT == (usInterfaceCapability & TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_MASK))
+				s_bFifoAccessSize = sizeof(UINT16);
+		}
+		LOGGING_WRITE_LEVEL4_FMT(L"TIS data FIFO access size: %d (Interface Capability: 0x%.4X)", s_bFifoAccessSize, usInterfaceCapability);
+	}
+
+	return s_bFifoAccessSize;
+}
+
+/**
+ *	@brief		Reads TPM.STS and TPM.STS.BURSTCOUNT with a single register access
+ *	@details	STS and the burst count are adjacent, so one 32-bit read of the STS register returns both. Unlike
+ *				TIS_ReadStsRegister and TIS_GetBurstCount the ACCESS register is not read. The caller must have checked
+ *				that the locality is active, a locality that is not active reads as all ones.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PpbStatus		Pointer to the STS register value
+ *	@param		PpusBurstCount	Pointer to the Burst Count variable
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	The locality is not active.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
  */
 _Check_return_
 UINT32
-TIS_SendLPC(
+TIS_ReadStatusSnapshot(
+	_In_	BYTE	PbLocality,
+	_Out_	BYTE*	PpbStatus,
+	_Out_	UINT16*	PpusBurstCount)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unAddress = 0;
+	UINT32 unValue = 0;
+
+	do
+	{
+		if (NULL == PpbStatus || NULL == PpusBurstCount)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		*PpbStatus = 0;
+		*PpusBurstCount = 0;
+
+		unReturnCode = TIS_GetRegisterAddress(PbLocality, TIS_TPM_STS, &unAddress);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		s_fStatusRegisterValid = FALSE;
+		s_sStatistics.ullRegisterReads++;
+		unValue = DeviceAccess_ReadDWord(unAddress);
+		if (0xFFFFFFFF == unValue)
+		{
+			unReturnCode = RC_E_LOCALITY_NOT_ACTIVE;
+			break;
+		}
+
+		*PpbStatus = (BYTE)(unValue & 0xFF);
+		*PpusBurstCount = (UINT16)((unValue >> 8) & 0xFFFF);
+
+		// Cache the register value for troubleshooting.
+		s_bStatusRegister = *PpbStatus;
+		s_fStatusRegisterValid = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Write a data block into the TPM data FIFO
+ *	@details	Writes all bytes with as few register accesses as possible. 32-bit FIFO accesses are used if the
+ *				TPM Interface Capability register reports support for data transfers wider than a single byte.
+ *				The caller is responsible for not exceeding the current burst count.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PrgbByteBuf		Bytes to write
+ *	@param		PusLen			Number of bytes to write
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ *	@retval		...							Error codes from DeviceAccess_WriteBlock function
+ */
+_Check_return_
+UINT32
+TIS_WriteFifo(
 	_In_					BYTE		PbLocality,
 	_In_bytecount_(PusLen)	const BYTE*	PrgbByteBuf,
 	_In_					UINT16		PusLen)
 {
 	UINT32 unReturnCode = RC_SUCCESS;
-	BYTE bValue = 0;
-	BYTE i = 0;
-	BOOL bFlag = FALSE;
-	UINT16 usBurstCount = 0;
-	UINT16 usTxSize = 0;
-	UINT32 unTimeOut = 0;
-	UINT32 unPosition = 0;
+	UINT32 unAddress = 0;
+
+	do
+	{
+		if (NULL == PrgbByteBuf)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnCode = TIS_GetRegisterAddress(PbLocality, TIS_TPM_DATA_FIFO, &unAddress);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		unReturnCode = DeviceAccess_WriteBlock(unAddress, PrgbByteBuf, PusLen, TIS_GetFifoAccessSize(PbLocality));
+		if (RC_SUCCESS == unReturnCode)
+			s_sStatistics.ullFifoBytesWritten += PusLen;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Read a data block from the TPM data FIFO
+ *	@details	Reads all bytes with as few register accesses as possible. 32-bit FIFO accesses are used if the
+ *				TPM Interface Capability register reports support for data transfers wider than a single byte.
+ *				The caller is responsible for not exceeding the current burst count.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PrgbByteBuf		Buffer for the read bytes
+ *	@param		PusLen			Number of bytes to read
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ *	@retval		...							Error codes from DeviceAccess_ReadBlock function
+ */
+_Check_return_
+UINT32
+TIS_ReadFifo(
+	_In_					BYTE	PbLocality,
+	_Out_bytecap_(PusLen)	BYTE*	PrgbByteBuf,
+	_In_					UINT16	PusLen)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unAddress = 0;
 
 	do
 	{
-		// Check input parameter
 		if (NULL == PrgbByteBuf)
 		{
 			unReturnCode = RC_E_BAD_PARAMETER;
 			break;
 		}
 
-		usTxSize = PusLen;
+		unReturnCode = TIS_GetRegisterAddress(PbLocality, TIS_TPM_DATA_FIFO, &unAddress);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		unReturnCode = DeviceAccess_ReadBlock(unAddress, PrgbByteBuf, PusLen, TIS_GetFifoAccessSize(PbLocality));
+		if (RC_SUCCESS == unReturnCode)
+			s_sStatistics.ullFifoBytesRead += PusLen;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Requests the locality and waits until it is active
+ *	@details	Requests the use of the TPM for the given locality and polls TPM.ACCESS.ACTIVE.LOCALITY
+ *				until it is set, timeout after TIMEOUT_A.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	Locality not active after TIMEOUT_A
+ *	@retval		...							Error codes from:
+ *												TIS_RequestUse,
+ *												TIS_IsActiveLocality function
+ */
+_Check_return_
+static UINT32
+TIS_AcquireLocality(
+	_In_	BYTE	PbLocality)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	BOOL bFlag = FALSE;
+	UINT32 unTimeOut = 0;
 
+	do
+	{
 		// Request the locality
 		unReturnCode = TIS_RequestUse(PbLocality);
 		if (RC_SUCCESS != unReturnCode)
 			break;
 
 		// Check whether requested Locality is active, timeout after TIMEOUT_A
-		unTimeOut = (TIMEOUT_A * 1000) / SLEEP_TIME_US_CR;
+		unTimeOut = (TIMEOUT_A * 1000) / s_sTuning.unSleepTimeCommandReady;
 		do
 		{
 			unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
 			if (RC_SUCCESS != unReturnCode)
 			{
-				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to test the active locality (0x%.8x)", unReturnCode);
+				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_AcquireLocality: Failed to test the active locality (0x%.8x)", unReturnCode);
 				unTimeOut = 0;	// Stop immediately on error
 			}
 			else if (TRUE == bFlag)
 				unTimeOut = 0;	// Stop immediately if flag is set
 			else
 			{
-				Platform_SleepMicroSeconds(SLEEP_TIME_US_CR);
+				TIS_Sleep(s_sTuning.unSleepTimeCommandReady);
 				unTimeOut = unTimeOut - 1;
 				if (0 == unTimeOut)
 				{
 					unReturnCode = RC_E_LOCALITY_NOT_ACTIVE;
-					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Locality 0x%.2X not active after 750ms (0x%.8x)", PbLocality, unReturnCode);
+					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_AcquireLocality: Locality 0x%.2X not active after 750ms (0x%.8x)", PbLocality, unReturnCode);
 				}
 			}
 		}
 		while (unTimeOut > 0);
-		if (RC_SUCCESS != unReturnCode)
-			break;
+	}
+	WHILE_FALSE_END;
 
-		// Check the commandReady flag first
-		unReturnCode = TIS_IsCommandReady(PbLocality, &bFlag);
-		if (FALSE == bFlag)
-		{
-			unReturnCode = TIS_Abort(PbLocality);
-			if (RC_SUCCESS != unReturnCode)
-				break;
+	return unReturnCode;
+}
 
-			// Check whether the TPM can receive a command, timeout after TIMEOUT_B
-			unTimeOut = (TIMEOUT_B * 1000) / SLEEP_TIME_US;
-			do
-			{
-				unReturnCode = TIS_IsCommandReady(PbLocality, &bFlag);
-				if (RC_SUCCESS != unReturnCode)
-				{
+/**
+ *	@brief		Starts a locality session
+ *	@details	Within a locality session the locality is requested once by the first command and held
+ *				across all following commands instead of being requested and released for each command.
+ *				After a failed command the locality is requested again by the next command.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from TIS_IsActiveLocality function
+ */
+_Check_return_
+UINT32
+TIS_BeginLocalitySession(
+	_In_	BYTE	PbLocality)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	BOOL bFlag = FALSE;
+
+	do
+	{
+		// Remember whether the locality is already active so that it can be left active at the end of the session
+		unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		s_fLocalityWasActive = bFlag;
+		s_fLocalityHeld = FALSE;
+		s_fLocalitySession = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Ends a locality session
+ *	@details	Releases the locality if it has been acquired within the locality session and was not active
+ *				before the session started.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from TIS_ReleaseActiveLocality function
+ */
+_Check_return_
+UINT32
+TIS_EndLocalitySession(
+	_In_	BYTE	PbLocality)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+
+	if (TRUE == s_fLocalityHeld && FALSE == s_fLocalityWasActive)
+		unReturnCode = TIS_ReleaseActiveLocality(PbLocality);
+
+	s_fLocalitySession = FALSE;
+	s_fLocalityHeld = FALSE;
+	s_fLocalityWasActive = FALSE;
+	s_fCommandReadyArmed = FALSE;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Selects the variant of the TIS FIFO engine
+ *	@details	The memory engine follows the TIS protocol for memory mapped registers, where a register access is cheap.
+ *				With TIS_ENGINE_SPI each register access is a TPM SPI transaction and the TPM controls the data flow with
+ *				wait states. While the locality is held, the SPI engine reads STS and the burst count with a single
+ *				transaction instead of checking the ACCESS register first, takes the first burst count of a response from
+ *				the dataAvail check and writes the last command byte with the final burst instead of checking Expect
+ *				before it.
+ *
+ *	@param		PbEngine			TIS_ENGINE_MEMORY or TIS_ENGINE_SPI
+ */
+void
+TIS_SelectEngine(
+	_In_	BYTE	PbEngine)
+{
+	s_fSpiEngine = (TIS_ENGINE_SPI == PbEngine);
+	LOGGING_WRITE_LEVEL4_FMT(L"Using the %ls TIS engine", s_fSpiEngine ? L"SPI" : L"memory");
+}
+
+/**
+ *	@brief		Enables or disables the TPM interrupts
+ *	@details	With interrupts enabled the wait loops for commandReady and dataAvail sleep on the interrupt line opened
+ *				by DeviceAccess_OpenInterrupt until the TPM raises the interrupt instead of polling the status register
+ *				at fixed intervals. The status register is still checked after each wakeup, so a lost interrupt only
+ *				delays the command by up to TIS_INTERRUPT_MAX_WAIT_US.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PfEnable		TRUE enables the commandReady and dataAvail interrupts, FALSE disables all interrupts
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_NOT_READY	The interrupt line is not opened.
+ *	@retval		...				Error codes from TIS_ReadRegister and TIS_WriteRegister functions
+ */
+_Check_return_
+UINT32
+TIS_EnableInterrupts(
+	_In_	BYTE	PbLocality,
+	_In_	BOOL	PfEnable)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	UINT32 unEnable = 0;
+	UINT32 unStatus = 0;
+
+	do
+	{
+		s_fInterruptsEnabled = FALSE;
+		if (PfEnable && !DeviceAccess_IsInterruptOpen())
+		{
+			unReturnCode = RC_E_NOT_READY;
+			break;
+		}
+
+		// Keep the interrupt type and polarity configured by the platform
+		unReturnCode = TIS_ReadRegister(PbLocality, TIS_TPM_INT_ENABLE, sizeof(UINT32), &unEnable);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		unEnable &= ~(TIS_TPM_INT_ENABLE_GLOBAL | TIS_TPM_INT_ENABLE_CMDRDY | TIS_TPM_INT_ENABLE_AVAIL);
+		if (PfEnable)
+			unEnable |= TIS_TPM_INT_ENABLE_GLOBAL | TIS_TPM_INT_ENABLE_CMDRDY | TIS_TPM_INT_ENABLE_AVAIL;
+		unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_INT_ENABLE, sizeof(UINT32), unEnable);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+
+		// Clear pending interrupts
+		unReturnCode = TIS_ReadRegister(PbLocality, TIS_TPM_INT_STATUS, sizeof(UINT32), &unStatus);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		if (0 != unStatus)
+		{
+			unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_INT_STATUS, sizeof(UINT32), unStatus);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+		}
+
+		s_fInterruptsEnabled = PfEnable;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Send a data block given in several parts to the TPM
+ *	@details	Send the parts of a data block to the TPM TIS data FIFO one after the other under consideration of
+ *				the TIS communication protocol. A burst may span several parts.
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgsSegments		Parts of the data block to send
+ *	@param		PunSegmentCount		Number of parts
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PrgsSegments or one of the parts is NULL or the data block exceeds 0xFFFF bytes.
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	Locality not active
+ *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	TPM no data available
+ *	@retval		RC_E_NOT_READY				Not ready
+ *	@retval		RC_E_TPM_TRANSMIT_DATA		Error during transmit data
+ *	@retval		...							Error codes from:
+ *												TIS_AcquireLocality,
+ *												TIS_IsCommandReady,
+ *												TIS_Abort,
+ *												TIS_ReadStatusSnapshot,
+ *												TIS_WriteFifo,
+ *												TIS_WriteRegister function
+ */
+_Check_return_
+UINT32
+TIS_SendSegmentsLPC(
+	_In_						BYTE					PbLocality,
+	_In_reads_(PunSegmentCount)	const IfxTpmIoSegment*	PrgsSegments,
+	_In_						UINT32					PunSegmentCount)
+{
+	UINT32 unReturnCode = RC_SUCCESS;
+	BYTE bValue = 0;
+	BOOL bFlag = FALSE;
+	UINT16 usBurstCount = 0;
+	UINT16 usTxSize = 0;
+	UINT16 usLen = 0;
+	UINT32 unTimeOut = 0;
+	UINT32 unSegment = 0;
+	UINT32 unPosition = 0;
+	UINT32 unTotalSize = 0;
+	BOOL bArmed = FALSE;
+	UINT16 usLastBytes = s_fSpiEngine ? 0 : 1;
+
+	PROBE1(tis__send__entry, PunSegmentCount);
+
+	do
+	{
+		// Check input parameter
+		if (NULL == PrgsSegments)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+		for (unSegment = 0; unSegment < PunSegmentCount; unSegment++)
+		{
+			if (NULL == PrgsSegments[unSegment].pbData)
+				break;
+			unTotalSize += PrgsSegments[unSegment].unSize;
+		}
+		if (unSegment < PunSegmentCount || unTotalSize > 0xFFFF)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		usLen = (UINT16)unTotalSize;
+		usTxSize = usLen;
+		unSegment = 0;
+
+		// Request the locality unless it is still held by the current locality session
+		if (FALSE == s_fLocalityHeld)
+		{
+			unReturnCode = TIS_AcquireLocality(PbLocality);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+			s_fLocalityHeld = s_fLocalitySession;
+		}
+
+		// Check the commandReady flag first. TIS_ReadLPC already wrote commandReady after the last response if the
+		// locality stayed held, so the TPM usually finished the ready transition while the next command was prepared.
+		bArmed = s_fCommandReadyArmed;
+		s_fCommandReadyArmed = FALSE;
+		unReturnCode = TIS_IsCommandReady(PbLocality, &bFlag);
+		if (FALSE == bFlag)
+		{
+			UINT32 unSleepTime = s_sTuning.unSleepTimeCommandReady;
+			UINT32 unSleptTime = 0;
+
+			// Only request the ready state if it was not requested after the last response
+			if (FALSE == bArmed || RC_SUCCESS != unReturnCode)
+			{
+				unReturnCode = TIS_Abort(PbLocality);
+				if (RC_SUCCESS != unReturnCode)
+					break;
+			}
+
+			// Check whether the TPM can receive a command, timeout after TIMEOUT_B. The sleep starts short since the
+			// transition is usually almost done.
+			do
+			{
+				unReturnCode = TIS_IsCommandReady(PbLocality, &bFlag);
+				if (RC_SUCCESS != unReturnCode)
+				{
 					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to read the command ready flag (0x%.8x)", unReturnCode);
-					unTimeOut = 0;	// Stop immediately on error
+					break;	// Stop immediately on error
 				}
-				else if (TRUE == bFlag)
-					unTimeOut = 0;	// Stop immediately if flag is set
-				else
+				if (TRUE == bFlag)
+					break;	// Stop immediately if flag is set
+				if (unSleptTime >= TIMEOUT_B * 1000)
 				{
-					Platform_SleepMicroSeconds(SLEEP_TIME_US);
-					unTimeOut = unTimeOut - 1;
-					if (0 == unTimeOut)
-					{
-						unReturnCode = RC_E_NOT_READY;
-						TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Command ready flag not set after 2000ms (0x%.8x)", unReturnCode);
-					}
+					unReturnCode = RC_E_NOT_READY;
+					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Command ready flag not set after 2000ms (0x%.8x)", unReturnCode);
+					break;
 				}
+				if (s_fInterruptsEnabled)
+				{
+					unSleptTime += TIS_WaitInterrupt(PbLocality, TIS_INTERRUPT_MAX_WAIT_US);
+					continue;
+				}
+				TIS_Sleep(unSleepTime);
+				unSleptTime += unSleepTime;
+				unSleepTime *= 2;
+				if (unSleepTime > s_sTuning.unSleepTime)
+					unSleepTime = s_sTuning.unSleepTime;
 			}
-			while (unTimeOut > 0);
+			while (TRUE);
 		}
 		if (RC_SUCCESS != unReturnCode)
 			break;
 
-		if (PusLen > 9)		// 10 bytes should always be writable
+		if (usLen > 9)		// 10 bytes should always be writable
 		{
 			do
 			{
 				// Read the BurstCount register, timeout after TIMEOUT_C if it remains 0
-				unTimeOut = (TIMEOUT_C * 1000) / SLEEP_TIME_US_BURSTCOUNT;
+				unTimeOut = (TIMEOUT_C * 1000) / s_sTuning.unSleepTimeBurstCount;
 				do
 				{
-					unReturnCode = TIS_GetBurstCount(PbLocality, &usBurstCount);
+					unReturnCode = TIS_ReadStatusSnapshot(PbLocality, &bValue, &usBurstCount);
 					if (RC_SUCCESS != unReturnCode)
 					{
 						TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to read the burst count (0x%.8x)", unReturnCode);
@@ -848,7 +1434,7 @@ TIS_SendLPC(
 						unTimeOut = 0;
 					else
 					{
-						Platform_SleepMicroSeconds(SLEEP_TIME_US_BURSTCOUNT);
+						TIS_Sleep(s_sTuning.unSleepTimeBurstCount);
 						unTimeOut = unTimeOut - 1;
 						if (0 == unTimeOut)
 						{
@@ -861,99 +1447,122 @@ TIS_SendLPC(
 				if (RC_SUCCESS != unReturnCode)
 					break;
 
-				if (usTxSize > usBurstCount)
+				// Write up to burst count bytes but keep the last byte for the Expect check. The SPI engine writes the
+				// last byte with the final burst, the TPM holds off an overrun with wait states and the Expect check after
+				// the last byte detects a size mismatch. A burst spanning several parts of the request is written part by part.
+				if (usBurstCount > (usTxSize - usLastBytes))
+					usBurstCount = usTxSize - usLastBytes;
+
+				while (usBurstCount > 0)
 				{
-					for (i = 0; i < usBurstCount; i++)
+					UINT16 usChunk = usBurstCount;
+
+					if (unPosition == PrgsSegments[unSegment].unSize)
 					{
-						// All OK, now write Byte to the TPM FIFO
-						unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_DATA_FIFO, sizeof(BYTE), (UINT32)*&PrgbByteBuf[unPosition]);
-						if (RC_SUCCESS != unReturnCode)
-							break;
-						unPosition++;
+						unSegment++;
+						unPosition = 0;
+						continue;
 					}
-					usTxSize -= usBurstCount;
-				}
-				else
-				{
-					for (i = 0; i < (usTxSize - 1); i++)
+					if (usChunk > PrgsSegments[unSegment].unSize - unPosition)
+						usChunk = (UINT16)(PrgsSegments[unSegment].unSize - unPosition);
+
+					unReturnCode = TIS_WriteFifo(PbLocality, &PrgsSegments[unSegment].pbData[unPosition], usChunk);
+					if (RC_SUCCESS != unReturnCode)
 					{
-						// All OK, now write Byte(s) to the TPM FIFO
-						unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_DATA_FIFO, sizeof(BYTE), (UINT32)*&PrgbByteBuf[unPosition]);
-						if (RC_SUCCESS != unReturnCode)
-							break;
-						unPosition++;
+						TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to write to the data FIFO (0x%.8x)", unReturnCode);
+						break;
 					}
-					usTxSize = 1;
+					unPosition += usChunk;
+					usBurstCount -= usChunk;
+					usTxSize -= usChunk;
 				}
 				if (RC_SUCCESS != unReturnCode)
 					break;
 			}
-			while (usTxSize > 1);
+			while (usTxSize > usLastBytes);
+			if (RC_SUCCESS != unReturnCode)
+				break;
 
-			// Last Byte, check stsValid and Expect, timeout after TIMEOUT_C
-			unTimeOut = (TIMEOUT_C * 1000) / SLEEP_TIME_US;
-			do
+			// Last Byte with the Expect check unless the SPI engine wrote it with the final burst
+			if (0 != usLastBytes)
 			{
-				unReturnCode = TIS_ReadStsRegister(PbLocality, &bValue);
-				if (RC_SUCCESS != unReturnCode)
+				// Skip to the part holding the last byte
+				while (unPosition == PrgsSegments[unSegment].unSize)
 				{
-					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to read the STS register before last byte (0x%.8x)", unReturnCode);
-					unTimeOut = 0;	// Stop immediately on error
+					unSegment++;
+					unPosition = 0;
 				}
-				else if ((bValue & TIS_TPM_STS_VALID) && (bValue & TIS_TPM_STS_EXPECT))
-					unTimeOut = 0;	// Stop immediately if flag is set
-				else
+
+				// Last Byte, check stsValid and Expect, timeout after TIMEOUT_C
+				unTimeOut = (TIMEOUT_C * 1000) / s_sTuning.unSleepTime;
+				do
 				{
-					Platform_SleepMicroSeconds(SLEEP_TIME_US);
-					unTimeOut = unTimeOut - 1;
-					if (0 == unTimeOut)
+					unReturnCode = TIS_ReadStatusSnapshot(PbLocality, &bValue, &usBurstCount);
+					if (RC_SUCCESS != unReturnCode)
 					{
-						unReturnCode = RC_E_TPM_TRANSMIT_DATA;
-						TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: STS register: TPM did not set stsValid and Expect bits after timeout of 750 ms. Register value: 0x%.2X (0x%.8x)", bValue, unReturnCode);
+						TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to read the STS register before last byte (0x%.8x)", unReturnCode);
+						unTimeOut = 0;	// Stop immediately on error
+					}
+					else if ((bValue & TIS_TPM_STS_VALID) && (bValue & TIS_TPM_STS_EXPECT))
+						unTimeOut = 0;	// Stop immediately if flag is set
+					else
+					{
+						TIS_Sleep(s_sTuning.unSleepTime);
+						unTimeOut = unTimeOut - 1;
+						if (0 == unTimeOut)
+						{
+							unReturnCode = RC_E_TPM_TRANSMIT_DATA;
+							TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: STS register: TPM did not set stsValid and Expect bits after timeout of 750 ms. Register value: 0x%.2X (0x%.8x)", bValue, unReturnCode);
+						}
 					}
 				}
-			}
-			while (unTimeOut > 0);
-			if (RC_SUCCESS != unReturnCode)
-			{
-				// Warning C6031 can be suppressed here, since in case of failure we can't do anything and we
-				// don't want to override the original error; thus, there is no need to check return value.
+				while (unTimeOut > 0);
+				if (RC_SUCCESS != unReturnCode)
+				{
+					// Warning C6031 can be suppressed here, since in case of failure we can't do anything and we
+					// don't want to override the original error; thus, there is no need to check return value.
 #if defined(_MSC_VER)
 #pragma warning(suppress: 6031)
 #endif
-				TIS_Abort(PbLocality);	// Abort TPM in case of an Error
-				break;
-			}
-			// Transmit the last Byte now
-			unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_DATA_FIFO, sizeof(BYTE), (UINT32)*&PrgbByteBuf[unPosition]);
-			if (RC_SUCCESS != unReturnCode)
-			{
-				// Warning C6031 can be suppressed here, since in case of failure we can't do anything and we do not
-				// want to override the original error; thus, there is no need to check return value of TIS_Abort().
+					TIS_Abort(PbLocality);	// Abort TPM in case of an Error
+					break;
+				}
+				// Transmit the last Byte now
+				unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_DATA_FIFO, sizeof(BYTE), (UINT32)PrgsSegments[unSegment].pbData[unPosition]);
+				if (RC_SUCCESS != unReturnCode)
+				{
+					// Warning C6031 can be suppressed here, since in case of failure we can't do anything and we do not
+					// want to override the original error; thus, there is no need to check return value of TIS_Abort().
 #if defined(_MSC_VER)
 #pragma warning(suppress: 6031)
 #endif
-				TIS_Abort(PbLocality);	// Abort TPM in case of an Error
-				break;
+					TIS_Abort(PbLocality);	// Abort TPM in case of an Error
+					break;
+				}
 			}
 		}
 		else // 10 bytes should always be writable.
 		{
-			for (i = 0; i < PusLen; i++)
+			for (unSegment = 0; unSegment < PunSegmentCount; unSegment++)
 			{
-				// All OK, now write Byte to the TPM FIFO
-				unReturnCode = TIS_WriteRegister(PbLocality, TIS_TPM_DATA_FIFO, sizeof(BYTE), (UINT32)*&PrgbByteBuf[unPosition]);
+				if (0 == PrgsSegments[unSegment].unSize)
+					continue;
+				unReturnCode = TIS_WriteFifo(PbLocality, PrgsSegments[unSegment].pbData, (UINT16)PrgsSegments[unSegment].unSize);
 				if (RC_SUCCESS != unReturnCode)
+				{
+					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to write to the data FIFO (0x%.8x)", unReturnCode);
 					break;
-				unPosition++;
+				}
 			}
+			if (RC_SUCCESS != unReturnCode)
+				break;
 		}
 
 		// After the last Byte, check stsValid=TRUE and Expect=FALSE, timeout after TIMEOUT_C
-		unTimeOut = (TIMEOUT_C * 1000) / SLEEP_TIME_US;
+		unTimeOut = (TIMEOUT_C * 1000) / s_sTuning.unSleepTime;
 		do
 		{
-			unReturnCode = TIS_ReadStsRegister(PbLocality, &bValue);
+			unReturnCode = TIS_ReadStatusSnapshot(PbLocality, &bValue, &usBurstCount);
 			if (RC_SUCCESS != unReturnCode)
 			{
 				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_SendLPC: Failed to read the STS register after last byte (0x%.8x)", unReturnCode);
@@ -963,7 +1572,7 @@ TIS_SendLPC(
 				unTimeOut = 0;	// Stop immediately if condition is met
 			else
 			{
-				Platform_SleepMicroSeconds(SLEEP_TIME_US);
+				TIS_Sleep(s_sTuning.unSleepTime);
 				unTimeOut = unTimeOut - 1;
 				if (0 == unTimeOut)
 				{
@@ -988,9 +1597,36 @@ TIS_SendLPC(
 	}
 	WHILE_FALSE_END;
 
+	PROBE1(tis__send__return, unReturnCode);
+
 	return unReturnCode;
 }
 
+/**
+ *	@brief		Send data block to the TPM
+ *	@details	Send a data block to the TPM TIS data FIFO under consideration of the
+ *				TIS communication protocol
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PrgbByteBuf		Bytes to send
+ *	@param		PusLen			Length of bytes
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PrgbByteBuf is NULL.
+ *	@retval		...							Error codes from TIS_SendSegmentsLPC function
+ */
+_Check_return_
+UINT32
+TIS_SendLPC(
+	_In_					BYTE		PbLocality,
+	_In_bytecount_(PusLen)	const BYTE*	PrgbByteBuf,
+	_In_					UINT16		PusLen)
+{
+	IfxTpmIoSegment sSegment = { PrgbByteBuf, PusLen };
+
+	return TIS_SendSegmentsLPC(PbLocality, &sSegment, 1);
+}
+
 /**
  *	@brief		Read a data block from the TPM TIS port
  *	@details
@@ -1009,10 +1645,8 @@ TIS_SendLPC(
  *	@retval		RC_E_TPM_TRANSMIT_DATA		Error during transmit data
  *	@retval		...							Error codes from:
  *												TIS_IsActiveLocality,
- *												TIS_ReadStsRegister,
- *												TIS_GetBurstCount,
- *												TIS_ReadRegister,
- *												TIS_ReadStsRegister,
+ *												TIS_ReadStatusSnapshot,
+ *												TIS_ReadFifo,
  *												TIS_IsCommandReady,
  *												TIS_Abort,
  *												TIS_Retry function
@@ -1035,7 +1669,8 @@ TIS_ReadLPC(
 	UINT16 usBytes2Read = 0;
 	UINT32 unTimeOut = 0;
 	BYTE *pbRxData = NULL;
-	BYTE i = 0;
+
+	PROBE1(tis__read__entry, NULL != PpusLen ? *PpusLen : 0);
 
 	do
 	{
@@ -1062,8 +1697,11 @@ TIS_ReadLPC(
 				break;
 			}
 
-			// Check whether requested Locality is active
-			unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
+			// Check whether requested Locality is active. The SPI engine relies on the status read below while the
+			// locality is held, a locality that is not active reads as all ones.
+			bFlag = TRUE;
+			if (!s_fSpiEngine || !s_fLocalityHeld)
+				unReturnCode = TIS_IsActiveLocality(PbLocality, &bFlag);
 			if (RC_SUCCESS != unReturnCode)
 			{
 				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_ReadLPC: ACCESS register cannot be read (0x%.8x)", unReturnCode);
@@ -1079,7 +1717,7 @@ TIS_ReadLPC(
 			}
 
 			// Check whether there are already data available
-			unReturnCode = TIS_ReadStsRegister(PbLocality, &bValue);
+			unReturnCode = TIS_ReadStatusSnapshot(PbLocality, &bValue, &usBurstCount);
 			if (RC_SUCCESS != unReturnCode)
 			{
 				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_ReadLPC: STS register cannot be read (0x%.8x)", unReturnCode);
@@ -1094,30 +1732,32 @@ TIS_ReadLPC(
 				break;
 			}
 
-			// Set initial sizes
+			// Set initial sizes, read the response header first. The SPI engine takes the burst count of the first
+			// burst from the status read above.
 			usRxSize = 0;
-			usBytes2Read = 10;
+			usBytes2Read = TIS_RESPONSE_HEADER_SIZE;
+			if (!s_fSpiEngine)
+				usBurstCount = 0;
 
 			while ((usBytes2Read - usRxSize) > 0)
 			{
 				// Read the BurstCounter whether there are Bytes in the data FIFO
-				unTimeOut = (TIMEOUT_D * 1000) / SLEEP_TIME_US_BURSTCOUNT;
-				do
+				unTimeOut = 0 == usBurstCount ? (TIMEOUT_D * 1000) / s_sTuning.unSleepTimeBurstCount : 0;
+				while (unTimeOut > 0)
 				{
-					unReturnCode = TIS_GetBurstCount(PbLocality, &usBurstCount);
+					unReturnCode = TIS_ReadStatusSnapshot(PbLocality, &bValue, &usBurstCount);
 					if (RC_SUCCESS != unReturnCode)
 						unTimeOut = 0;	// Stop immediately on Error
 					else if (usBurstCount > 0)
 						unTimeOut = 0;
 					else
 					{
-						Platform_SleepMicroSeconds(SLEEP_TIME_US_BURSTCOUNT);
+						TIS_Sleep(s_sTuning.unSleepTimeBurstCount);
 						unTimeOut = unTimeOut - 1;
 						if (0 == unTimeOut)
 							unReturnCode = RC_E_NOT_READY;
 					}
 				}
-				while (unTimeOut > 0);
 				if (RC_SUCCESS != unReturnCode)
 				{
 					bRxDone = FALSE;	// It could make sense to retry
@@ -1127,28 +1767,30 @@ TIS_ReadLPC(
 				if (usBurstCount > (usBytes2Read - usRxSize))
 					usBurstCount = usBytes2Read - usRxSize;
 
-				for (i = 0; i < usBurstCount; i++)
-				{
-					unReturnCode = TIS_ReadRegister(PbLocality, TIS_TPM_DATA_FIFO, sizeof(BYTE), pbRxData);
-					if (RC_SUCCESS != unReturnCode)
-						break;
-
-					pbRxData++;
-				}
-
+				unReturnCode = TIS_ReadFifo(PbLocality, pbRxData, usBurstCount);
 				if (RC_SUCCESS != unReturnCode)
 				{
 					bRxDone = FALSE;	// It could make sense to retry
 					break;
 				}
 
+				pbRxData += usBurstCount;
 				usRxSize += usBurstCount;
+				usBurstCount = 0;
 
-				// Correct the number of Bytes to be read according to the real parameter size if available
-				if ((usRxSize > 5) && (bUpdateBytes2Read == TRUE))
+				// Once the header is complete read exactly the remaining bytes according to the response size
+				if ((usRxSize >= TIS_RESPONSE_HEADER_SIZE) && (bUpdateBytes2Read == TRUE))
 				{
 					usBytes2Read = (PrgbByteBuf[4] << 8) + PrgbByteBuf[5];
 					bUpdateBytes2Read = FALSE;
+					// The response size is a 32-bit value but can never exceed the 16-bit transfer size
+					if (0 != PrgbByteBuf[2] || 0 != PrgbByteBuf[3] || usBytes2Read < TIS_RESPONSE_HEADER_SIZE)
+					{
+						TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_ReadLPC: Invalid response size in the response header (0x%.2X%.2X%.2X%.2X)", PrgbByteBuf[2], PrgbByteBuf[3], PrgbByteBuf[4], PrgbByteBuf[5]);
+						unReturnCode = RC_E_TPM_RECEIVE_DATA;
+						bRxDone = FALSE;	// It could make sense to retry
+						break;
+					}
 					// Check for sufficient space in the Buffer now
 					if (*PpusLen < usBytes2Read)
 					{
@@ -1164,17 +1806,17 @@ TIS_ReadLPC(
 				break;
 
 			// All Bytes received, check whether this is indicated by the TPM
-			unTimeOut = (TIMEOUT_C * 1000) / SLEEP_TIME_US;
+			unTimeOut = (TIMEOUT_C * 1000) / s_sTuning.unSleepTime;
 			do
 			{
-				unReturnCode = TIS_ReadStsRegister(PbLocality, &bValue);
+				unReturnCode = TIS_ReadStatusSnapshot(PbLocality, &bValue, &usBurstCount);
 				if (RC_SUCCESS != unReturnCode)
 					unTimeOut = 0;	// Stop immediately on Error
 				else if ((bValue & TIS_TPM_STS_VALID) && (!(bValue & TIS_TPM_STS_AVAIL)))
 					unTimeOut = 0;	// Stop immediately if condition is met
 				else
 				{
-					Platform_SleepMicroSeconds(SLEEP_TIME_US);
+					TIS_Sleep(s_sTuning.unSleepTime);
 					unTimeOut = unTimeOut - 1;
 					if (0 == unTimeOut)
 						unReturnCode = RC_E_TPM_RECEIVE_DATA;
@@ -1195,13 +1837,15 @@ TIS_ReadLPC(
 				break;
 			}
 
-			// All OK, write CmdRdy to prepare the TPM for the next command and to release the retry buffer
+			// All OK, write CmdRdy to prepare the TPM for the next command and to release the retry buffer. If the
+			// locality stays held, the next TIS_SendSegmentsLPC relies on this instead of requesting it again.
 			unReturnCode = TIS_Abort(PbLocality);
 			if (RC_SUCCESS != unReturnCode)
 			{
 				bRxDone = FALSE;
 				break;
 			}
+			s_fCommandReadyArmed = s_fLocalityHeld;
 
 			*PpusLen = usRxSize;
 
@@ -1238,84 +1882,133 @@ TIS_ReadLPC(
 	if (RC_SUCCESS != unReturnCode && NULL != PpusLen)
 		*PpusLen = 0;
 
+	PROBE2(tis__read__return, unReturnCode, NULL != PpusLen ? *PpusLen : 0);
+
 	return unReturnCode;
 }
 
 /**
- *	@brief		Sends the Transceive Buffer to the TPM and returns the response
- *	@details
+ *	@brief		Sends a Transceive Buffer given in several parts to the TPM and returns the response
+ *	@details	The parts are written to the data FIFO one after the other, so the caller does not need to assemble
+ *				the command in a contiguous buffer.
  *
- *	@param		PbLocality		Locality value
- *	@param		PrgbTxBuffer	Pointer Transceive buffer
- *	@param		PusTxLen		Length of the Transceive buffer
- *	@param		PrgbRxBuffer	Pointer to a Receive buffer
- *	@param		PpusRxLen		Pointer to the length of the Receive buffer
- *	@param		PunMaxDuration	The maximum duration of the command in microseconds
+ *	@param		PbLocality			Locality value
+ *	@param		PrgsTxSegments		Parts of the Transceive buffer
+ *	@param		PunTxSegmentCount	Number of parts
+ *	@param		PrgbRxBuffer		Pointer to a Receive buffer
+ *	@param		PpusRxLen			Pointer to the length of the Receive buffer
+ *	@param		PunMaxDuration		The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration	The expected duration of the command in microseconds
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
  *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	TPM no data available
  *	@retval		...							Error codes from:
- *												TIS_SendLPC,
+ *												TIS_SendSegmentsLPC,
  *												TIS_IsDataAvailable,
  *												TIS_ReadLPC,
  *												TIS_ReleaseActiveLocality function
  */
 _Check_return_
 UINT32
-TIS_TransceiveLPC(
-	_In_						BYTE		PbLocality,
-	_In_bytecount_(PusTxLen)	const BYTE*	PrgbTxBuffer,
-	_In_						UINT16		PusTxLen,
-	_Out_bytecap_(*PpusRxLen)	BYTE*		PrgbRxBuffer,
-	_Inout_						UINT16*		PpusRxLen,
-	_In_						UINT32		PunMaxDuration)
+TIS_TransceiveSegmentsLPC(
+	_In_							BYTE					PbLocality,
+	_In_reads_(PunTxSegmentCount)	const IfxTpmIoSegment*	PrgsTxSegments,
+	_In_							UINT32					PunTxSegmentCount,
+	_Out_bytecap_(*PpusRxLen)		BYTE*					PrgbRxBuffer,
+	_Inout_							UINT16*					PpusRxLen,
+	_In_							UINT32					PunMaxDuration,
+	_In_							UINT32					PunExpectedDuration)
 {
 	UINT32 unReturnCode = RC_SUCCESS;
 	UINT16 usRxSize = 0;
-	UINT32 unTimeOut = 0;
+	UINT32 unSleepTime = s_sTuning.unSleepTimeCommandReady;
+	UINT32 unSleptTime = 0;
+	unsigned long long ullStartTime = 0;
+	unsigned long long ullElapsedTime = 0;
+	unsigned long long ullWaitIterations = 0;
 	BOOL bFlag = FALSE;
 
 	do
 	{
-		unReturnCode = TIS_SendLPC(PbLocality, PrgbTxBuffer, PusTxLen);
+		ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		unReturnCode = TIS_SendSegmentsLPC(PbLocality, PrgsTxSegments, PunTxSegmentCount);
+		if (TRACE_IS_ENABLED())
+			Trace_WriteSpan(TRACE_CATEGORY_TIS, L"send", ullStartTime, Platform_GetMonotonicTimeMicroSeconds() - ullStartTime, L"\"segments\":%u", PunTxSegmentCount);
 		if (RC_SUCCESS != unReturnCode)
 		{
 			TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_TransceiveLPC: TIS_SendLPC failed with (0x%.8x)", unReturnCode);
 			break;
 		}
 
-		// The actual timeout will be higher than PunMaxDuration due to additional time consumed by multiple invocations of
-		// the TIS_IsDataAvailable function.
-		unTimeOut = PunMaxDuration / SLEEP_TIME_US;
+		// The TPM executes the command now, give the caller the chance to do host-side work in the meantime
+		TPMIO_CommandPending();
+
+		// Wait for the response. Commands that are expected to complete quickly are busy-polled for their expected
+		// duration. Afterwards the TPM is polled with exponentially increasing sleep intervals capped at the tuned sleep interval.
+		ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		ullWaitIterations = s_sStatistics.ullWaitIterations;
+		PROBE1(tis__wait__entry, PunMaxDuration);
 		do
 		{
 			unReturnCode = TIS_IsDataAvailable(PbLocality, &bFlag);
 			if (RC_SUCCESS != unReturnCode)
 			{
 				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_TransceiveLPC: TIS_IsDataAvailable failed with (0x%.8x)", unReturnCode);
-				unTimeOut = 0;	// Stop immediately on Error
+				break;	// Stop immediately on Error
 			}
-			else if (TRUE == bFlag)
+			if (TRUE == bFlag)
+				break;	// Stop immediately if Flag is set
+
+			// The accumulated sleep time is a lower bound of the elapsed time in case the monotonic clock is not available
+			ullElapsedTime = Platform_GetMonotonicTimeMicroSeconds() - ullStartTime;
+			if (ullElapsedTime < unSleptTime)
+				ullElapsedTime = unSleptTime;
+			if (ullElapsedTime >= PunMaxDuration)
 			{
-				unTimeOut = 0;	// Stop immediately if Flag is set
+				unReturnCode = RC_E_TPM_NO_DATA_AVAILABLE;
+				TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_TransceiveLPC: No data available after timeout of %d microseconds (0x%.8x)", PunMaxDuration, unReturnCode);
+				break;
 			}
-			else
+
+			if (0 != ullStartTime && PunExpectedDuration <= s_sTuning.unMaxSpinTime && ullElapsedTime < PunExpectedDuration)
 			{
-				Platform_SleepMicroSeconds(SLEEP_TIME_US);
-				unTimeOut = unTimeOut - 1;
-				if (0 == unTimeOut)
-				{
-					unReturnCode = RC_E_TPM_NO_DATA_AVAILABLE;
-					TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_TransceiveLPC: No data available after timeout of %d microseconds (0x%.8x)", PunMaxDuration, unReturnCode);
-				}
+				s_sStatistics.ullWaitIterations++;
+				continue;	// Busy-poll within the expected duration
+			}
+
+			// Sleep until the TPM signals dataAvail if interrupts are enabled, the status is checked after each wakeup
+			if (s_fInterruptsEnabled)
+			{
+				unSleptTime += TIS_WaitInterrupt(PbLocality, (UINT32)(PunMaxDuration - ullElapsedTime < TIS_INTERRUPT_MAX_WAIT_US ?
+					PunMaxDuration - ullElapsedTime : TIS_INTERRUPT_MAX_WAIT_US));
+				continue;
 			}
+
+			// Do not sleep past the timeout, the TPM is checked once more at the deadline
+			if (unSleepTime > PunMaxDuration - ullElapsedTime)
+				unSleepTime = (UINT32)(PunMaxDuration - ullElapsedTime);
+			TIS_Sleep(unSleepTime);
+			unSleptTime += unSleepTime;
+			unSleepTime *= 2;
+			if (unSleepTime > s_sTuning.unSleepTime)
+				unSleepTime = s_sTuning.unSleepTime;
 		}
-		while (unTimeOut > 0);
+		while (FALSE == bFlag);
+		PROBE2(tis__wait__return, unReturnCode, s_sStatistics.ullWaitIterations - ullWaitIterations);
+		if (FLIGHTRECORDER_IS_ENABLED())
+			FlightRecorder_Record(FLIGHTRECORDER_RECORD_TIS_WAIT, PunMaxDuration, unReturnCode,
+				(unsigned int)(s_sStatistics.ullWaitIterations - ullWaitIterations), unSleptTime, NULL, 0);
+		if (TRACE_IS_ENABLED())
+			Trace_WriteSpan(TRACE_CATEGORY_TIS, L"wait", ullStartTime, Platform_GetMonotonicTimeMicroSeconds() - ullStartTime,
+				L"\"iterations\":%llu,\"slept_us\":%u", s_sStatistics.ullWaitIterations - ullWaitIterations, unSleptTime);
 		if (RC_SUCCESS != unReturnCode)
 			break;
 
 		usRxSize = *PpusRxLen;
+		ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
 		unReturnCode = TIS_ReadLPC(PbLocality, PrgbRxBuffer, &usRxSize);
+		if (TRACE_IS_ENABLED())
+			Trace_WriteSpan(TRACE_CATEGORY_TIS, L"read", ullStartTime, Platform_GetMonotonicTimeMicroSeconds() - ullStartTime, L"\"size\":%u", usRxSize);
 		if (RC_SUCCESS != unReturnCode)
 		{
 			TIS_LOGGING_WRITE_LEVEL1_FMT(L"Error: TIS_TransceiveLPC: TIS_ReadLPC failed with (0x%.8x)", unReturnCode);
@@ -1324,8 +2017,234 @@ TIS_TransceiveLPC(
 
 		*PpusRxLen = usRxSize;
 
-		// Release current Locality
-		unReturnCode = TIS_ReleaseActiveLocality(PbLocality);
+		// Release current Locality unless it is held by the current locality session
+		if (FALSE == s_fLocalitySession)
+			unReturnCode = TIS_ReleaseActiveLocality(PbLocality);
+	}
+	WHILE_FALSE_END;
+
+	// Validate the locality again with the next command after an error
+	if (RC_SUCCESS != unReturnCode)
+	{
+		s_fLocalityHeld = FALSE;
+		s_fCommandReadyArmed = FALSE;
+	}
+
+	return unReturnCode;
+}
+
+/**
+ *	@brief		Sends the Transceive Buffer to the TPM and returns the response
+ *	@details
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgbTxBuffer		Pointer Transceive buffer
+ *	@param		PusTxLen			Length of the Transceive buffer
+ *	@param		PrgbRxBuffer		Pointer to a Receive buffer
+ *	@param		PpusRxLen			Pointer to the length of the Receive buffer
+ *	@param		PunMaxDuration		The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration	The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		...							Error codes from TIS_TransceiveSegmentsLPC function
+ */
+_Check_return_
+UINT32
+TIS_TransceiveLPC(
+	_In_						BYTE		PbLocality,
+	_In_bytecount_(PusTxLen)	const BYTE*	PrgbTxBuffer,
+	_In_						UINT16		PusTxLen,
+	_Out_bytecap_(*PpusRxLen)	BYTE*		PrgbRxBuffer,
+	_Inout_						UINT16*		PpusRxLen,
+	_In_						UINT32		PunMaxDuration,
+	_In_						UINT32		PunExpectedDuration)
+{
+	IfxTpmIoSegment sSegment = { PrgbTxBuffer, PusTxLen };
+
+	return TIS_TransceiveSegmentsLPC(PbLocality, &sSegment, 1, PrgbRxBuffer, PpusRxLen, PunMaxDuration, PunExpectedDuration);
+}
+
+/**
+ *	@brief		Returns the TIS transport statistics
+ *	@details	Returns the register accesses, data FIFO bytes and wait loop statistics accumulated since the start
+ *				of the application.
+ *
+ *	@param		PpStatistics		Pointer to a structure receiving the statistics
+ */
+void
+TIS_GetStatistics(
+	_Out_	IfxTpmIoStatistics*	PpStatistics)
+{
+	if (NULL != PpStatistics)
+		*PpStatistics = s_sStatistics;
+}
+
+/**
+ *	@brief		Returns the polling parameters in use
+ *
+ *	@param		PpTuning			Pointer to a structure receiving the polling parameters
+ */
+void
+TIS_GetTuning(
+	_Out_	IfxTisTuning*	PpTuning)
+{
+	if (NULL != PpTuning)
+		*PpTuning = s_sTuning;
+}
+
+/**
+ *	@brief		Sets the polling parameters
+ *	@details	The parameters are checked against TIS_TUNING_MAX_SLEEP_US and TIS_TUNING_MAX_SPIN_US. NULL restores
+ *				the compile-time values.
+ *
+ *	@param		PpTuning			Polling parameters or NULL
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	A parameter is out of range, the polling parameters are not changed.
+ */
+_Check_return_
+UINT32
+TIS_SetTuning(
+	_In_opt_	const IfxTisTuning*	PpTuning)
+{
+	static const IfxTisTuning sDefaultTuning = {SLEEP_TIME_US, SLEEP_TIME_US_CR, SLEEP_TIME_US_BURSTCOUNT, TIS_MAX_SPIN_TIME_US, 0, 0, 0};
+
+	if (NULL == PpTuning)
+	{
+		s_sTuning = sDefaultTuning;
+		return RC_SUCCESS;
+	}
+
+	// The sleep intervals are divisors of the TIS timeouts
+	if (0 == PpTuning->unSleepTime || PpTuning->unSleepTime > TIS_TUNING_MAX_SLEEP_US ||
+			0 == PpTuning->unSleepTimeCommandReady || PpTuning->unSleepTimeCommandReady > TIS_TUNING_MAX_SLEEP_US ||
+			0 == PpTuning->unSleepTimeBurstCount || PpTuning->unSleepTimeBurstCount > TIS_TUNING_MAX_SLEEP_US ||
+			PpTuning->unMaxSpinTime > TIS_TUNING_MAX_SPIN_US)
+		return RC_E_BAD_PARAMETER;
+
+	s_sTuning = *PpTuning;
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Limits a derived polling parameter to a range
+ *
+ *	@param		PullValue			Derived value
+ *	@param		PunMinimum			Lower bound
+ *	@param		PunMaximum			Upper bound
+ *
+ *	@returns	The value within the range
+ */
+static UINT32
+TIS_ClampTuning(
+	_In_	unsigned long long	PullValue,
+	_In_	UINT32				PunMinimum,
+	_In_	UINT32				PunMaximum)
+{
+	if (PullValue < PunMinimum)
+		return PunMinimum;
+	if (PullValue > PunMaximum)
+		return PunMaximum;
+	return (UINT32)PullValue;
+}
+
+/**
+ *	@brief		Measures the polling parameters of the platform
+ *	@details	Times TIS_TUNING_CALIBRATION_READS status register reads and reads the burst count the TPM offers for a
+ *				command. The sleep intervals are derived from the register read time, polling more often than a few
+ *				register reads only loads the bus. The busy-poll duration is derived from the command completion time
+ *				measured by the caller. The polling parameters in use are not changed.
+ *
+ *	@param		PbLocality			Locality value, the locality must be active
+ *	@param		PunCommandTime		Completion time of a short command in microseconds, 0 keeps TIS_MAX_SPIN_TIME_US
+ *	@param		PpTuning			Pointer to a structure receiving the polling parameters
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			The monotonic clock is not available.
+ *	@retval		...					Error codes from TIS_ReadStsRegister, TIS_Abort and TIS_GetBurstCount
+ */
+_Check_return_
+UINT32
+TIS_Calibrate(
+	_In_	BYTE			PbLocality,
+	_In_	UINT32			PunCommandTime,
+	_Out_	IfxTisTuning*	PpTuning)
+{
+	UINT32 unReturnCode = RC_E_FAIL;
+
+	do
+	{
+		unsigned long long ullStartTime = 0;
+		unsigned long long ullReadTime = 0;
+		UINT32 unReadTimeUs = 0;
+		UINT32 unIndex = 0;
+		UINT32 unSleptTime = 0;
+		UINT16 usBurstCount = 0;
+		BYTE bValue = 0;
+		BOOL bFlag = FALSE;
+
+		if (NULL == PpTuning)
+		{
+			unReturnCode = RC_E_BAD_PARAMETER;
+			break;
+		}
+		*PpTuning = s_sTuning;
+
+		// Register read latency
+		ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		if (0 == ullStartTime)
+		{
+			unReturnCode = RC_E_FAIL;
+			break;
+		}
+		for (unIndex = 0; unIndex < TIS_TUNING_CALIBRATION_READS; unIndex++)
+		{
+			unReturnCode = TIS_ReadStsRegister(PbLocality, &bValue);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+		}
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		ullReadTime = (Platform_GetMonotonicTimeMicroSeconds() - ullStartTime) * 1000 / TIS_TUNING_CALIBRATION_READS;
+		PpTuning->unRegisterReadTime = TIS_ClampTuning(ullReadTime, 1, 0xFFFFFFFFU);
+		unReadTimeUs = (PpTuning->unRegisterReadTime + 999) / 1000;
+
+		// Burst count the TPM offers for a command
+		unReturnCode = TIS_Abort(PbLocality);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		do
+		{
+			unReturnCode = TIS_IsCommandReady(PbLocality, &bFlag);
+			if (RC_SUCCESS != unReturnCode || TRUE == bFlag || unSleptTime >= TIMEOUT_B * 1000)
+				break;
+			TIS_Sleep(s_sTuning.unSleepTimeCommandReady);
+			unSleptTime += s_sTuning.unSleepTimeCommandReady;
+		}
+		while (TRUE);
+		if (RC_SUCCESS != unReturnCode)
+			break;
+		if (TRUE == bFlag)
+		{
+			unReturnCode = TIS_GetBurstCount(PbLocality, &usBurstCount);
+			if (RC_SUCCESS != unReturnCode)
+				break;
+		}
+		PpTuning->unBurstCount = usBurstCount;
+
+		// Poll a few register reads apart at most. The sleep interval of the response wait grows to cover the
+		// register accesses of a burst.
+		PpTuning->unSleepTimeCommandReady = TIS_ClampTuning(4ULL * unReadTimeUs, 2, SLEEP_TIME_US);
+		PpTuning->unSleepTimeBurstCount = PpTuning->unSleepTimeCommandReady;
+		PpTuning->unSleepTime = TIS_ClampTuning(16ULL * unReadTimeUs, SLEEP_TIME_US / 2, TIS_TUNING_MAX_SLEEP_US);
+
+		// Short commands are busy-polled if they usually complete within a few hundred microseconds
+		PpTuning->unCommandTime = PunCommandTime;
+		if (0 != PunCommandTime)
+			PpTuning->unMaxSpinTime = TIS_ClampTuning(2ULL * PunCommandTime, TIS_MAX_SPIN_TIME_US, TIS_TUNING_MAX_SPIN_US);
+		else
+			PpTuning->unMaxSpinTime = TIS_MAX_SPIN_TIME_US;
 	}
 	WHILE_FALSE_END;
 
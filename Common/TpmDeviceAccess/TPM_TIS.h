@@ -17,6 +17,7 @@
 #define __TPM_TIS_H__
 
 #include "StdInclude.h"
+#include "TpmIO.h"
 
 // TIS Definitions
 /// Base address for TIS
@@ -46,6 +47,12 @@
 // TPM Interface Registers
 /// Register offset for TPM Access register
 #define TIS_TPM_ACCESS 0x00000000
+/// Register offset for TPM Interrupt Enable register
+#define TIS_TPM_INT_ENABLE 0x00000008
+/// Register offset for TPM Interrupt Status register
+#define TIS_TPM_INT_STATUS 0x00000010
+/// Register offset for TPM Interface Capability register
+#define TIS_TPM_INTF_CAPABILITY 0x00000014
 /// Register offset for TPM Status register
 #define TIS_TPM_STS 0x00000018
 /// Register offset for TPM Burst Count register
@@ -87,11 +94,23 @@
 /// TPM Status register bit for status retry
 #define TIS_TPM_STS_RETRY 0x02
 
+/// TPM Interface Capability register mask for the supported data transfer size (bits 9-10)
+#define TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_MASK 0x0600
+/// TPM Interface Capability register value for legacy (single byte) data transfers
+#define TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_LEGACY 0x0000
+/// TPM Interface Capability register value for data transfers of up to 16 bits
+#define TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_16BIT 0x0400
+/// TPM Interface Capability register value for data transfers of up to 32 bits
+#define TIS_TPM_INTF_CAPABILITY_TRANSFER_SIZE_32BIT 0x0600
+
 /// TPM Vendor ID
 #define TIS_TPM_VID_IFX 0x15D1
 /// TPM Device ID
 #define TIS_TPM_DID_TPM12 0x000B
 
+/// Size of the TPM response header (tag, response size and response code)
+#define TIS_RESPONSE_HEADER_SIZE 10
+
 // TIS timeouts, use default values only
 /// TIS Timeout A
 #define TIMEOUT_A 750
@@ -102,6 +121,56 @@
 /// TIS Timeout D
 #define TIMEOUT_D 750
 
+// TPM interrupt enable register bits
+/// Global interrupt enable
+#define TIS_TPM_INT_ENABLE_GLOBAL 0x80000000
+/// Command ready interrupt enable
+#define TIS_TPM_INT_ENABLE_CMDRDY 0x00000080
+/// Data available interrupt enable
+#define TIS_TPM_INT_ENABLE_AVAIL 0x00000001
+
+/// TIS FIFO engine for memory mapped registers
+#define TIS_ENGINE_MEMORY 0
+/// TIS FIFO engine for registers accessed through TPM SPI transactions
+#define TIS_ENGINE_SPI 1
+
+/// Longest wait for a TPM interrupt in microseconds before the status is polled again. Bounds the delay caused by a lost interrupt.
+#define TIS_INTERRUPT_MAX_WAIT_US 100000
+
+/// Maximum expected command duration in microseconds for which the TPM is busy-polled instead of sleeping
+#define TIS_MAX_SPIN_TIME_US 500
+
+/// Upper bound of a tuned sleep interval in microseconds
+#define TIS_TUNING_MAX_SLEEP_US 1000
+/// Upper bound of a tuned busy-poll duration in microseconds
+#define TIS_TUNING_MAX_SPIN_US 2000
+/// Number of status register reads timed by TIS_Calibrate
+#define TIS_TUNING_CALIBRATION_READS 256
+
+/**
+ *	@brief		Represents the polling parameters of the TIS protocol
+ *	@details	Without a profile the compile-time values SLEEP_TIME_US, SLEEP_TIME_US_CR, SLEEP_TIME_US_BURSTCOUNT and
+ *				TIS_MAX_SPIN_TIME_US are used. TIS_Calibrate adapts them to the register access latency and command
+ *				completion time of the platform, which differ between LPC and SPI parts and between chipsets.
+ */
+typedef struct tdIfxTisTuning
+{
+	/// Longest sleep interval while waiting for a status change in microseconds
+	UINT32 unSleepTime;
+	/// Sleep interval while waiting for commandReady or the locality in microseconds
+	UINT32 unSleepTimeCommandReady;
+	/// Sleep interval while waiting for a burst count in microseconds
+	UINT32 unSleepTimeBurstCount;
+	/// Longest expected command duration which is busy-polled in microseconds
+	UINT32 unMaxSpinTime;
+	/// Measured duration of a register read in nanoseconds (0 if not calibrated)
+	UINT32 unRegisterReadTime;
+	/// Burst count reported while the TPM is ready for a command (0 if not calibrated)
+	UINT32 unBurstCount;
+	/// Measured completion time of a short command in microseconds (0 if not calibrated)
+	UINT32 unCommandTime;
+} IfxTisTuning;
+
 /**
  *	@brief		Read the value of a TIS register
  *	@details
@@ -348,28 +417,179 @@ TIS_Retry(
 	_In_	BYTE	PbLocality);
 
 /**
- *	@brief		Send data block to the TPM
- *	@details	Send a data block to the TPM TIS data FIFO under consideration of the
- *				TIS communication protocol
+ *	@brief		Reads TPM.STS and TPM.STS.BURSTCOUNT with a single register access
+ *	@details	STS and the burst count are adjacent, so one 32-bit read of the STS register returns both. Unlike
+ *				TIS_ReadStsRegister and TIS_GetBurstCount the ACCESS register is not read. The caller must have checked
+ *				that the locality is active, a locality that is not active reads as all ones.
  *
  *	@param		PbLocality		Locality value
- *	@param		PrgbByteBuf		Bytes to send
- *	@param		PusLen			Length of bytes
+ *	@param		PpbStatus		Pointer to the STS register value
+ *	@param		PpusBurstCount	Pointer to the Burst Count variable
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PrgbByteBuf is NULL.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_ACTIVE	The locality is not active.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ */
+_Check_return_
+UINT32
+TIS_ReadStatusSnapshot(
+	_In_	BYTE	PbLocality,
+	_Out_	BYTE*	PpbStatus,
+	_Out_	UINT16*	PpusBurstCount);
+
+/**
+ *	@brief		Write a data block into the TPM data FIFO
+ *	@details	Writes all bytes with as few register accesses as possible. 32-bit FIFO accesses are used if the
+ *				TPM Interface Capability register reports support for data transfers wider than a single byte.
+ *				The caller is responsible for not exceeding the current burst count.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PrgbByteBuf		Bytes to write
+ *	@param		PusLen			Number of bytes to write
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ *	@retval		...							Error codes from DeviceAccess_WriteBlock function
+ */
+_Check_return_
+UINT32
+TIS_WriteFifo(
+	_In_					BYTE		PbLocality,
+	_In_bytecount_(PusLen)	const BYTE*	PrgbByteBuf,
+	_In_					UINT16		PusLen);
+
+/**
+ *	@brief		Read a data block from the TPM data FIFO
+ *	@details	Reads all bytes with as few register accesses as possible. 32-bit FIFO accesses are used if the
+ *				TPM Interface Capability register reports support for data transfers wider than a single byte.
+ *				The caller is responsible for not exceeding the current burst count.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PrgbByteBuf		Buffer for the read bytes
+ *	@param		PusLen			Number of bytes to read
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	Given locality is not supported
+ *	@retval		...							Error codes from DeviceAccess_ReadBlock function
+ */
+_Check_return_
+UINT32
+TIS_ReadFifo(
+	_In_					BYTE	PbLocality,
+	_Out_bytecap_(PusLen)	BYTE*	PrgbByteBuf,
+	_In_					UINT16	PusLen);
+
+/**
+ *	@brief		Starts a locality session
+ *	@details	Within a locality session the locality is requested once by the first command and held
+ *				across all following commands instead of being requested and released for each command.
+ *				After a failed command the locality is requested again by the next command.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from TIS_IsActiveLocality function
+ */
+_Check_return_
+UINT32
+TIS_BeginLocalitySession(
+	_In_	BYTE	PbLocality);
+
+/**
+ *	@brief		Ends a locality session
+ *	@details	Releases the locality if it has been acquired within the locality session and was not active
+ *				before the session started.
+ *
+ *	@param		PbLocality		Locality value
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from TIS_ReleaseActiveLocality function
+ */
+_Check_return_
+UINT32
+TIS_EndLocalitySession(
+	_In_	BYTE	PbLocality);
+
+/**
+ *	@brief		Selects the variant of the TIS FIFO engine
+ *	@details	The memory engine follows the TIS protocol for memory mapped registers, where a register access is cheap.
+ *				With TIS_ENGINE_SPI each register access is a TPM SPI transaction and the TPM controls the data flow with
+ *				wait states. While the locality is held, the SPI engine reads STS and the burst count with a single
+ *				transaction instead of checking the ACCESS register first, takes the first burst count of a response from
+ *				the dataAvail check and writes the last command byte with the final burst instead of checking Expect
+ *				before it.
+ *
+ *	@param		PbEngine			TIS_ENGINE_MEMORY or TIS_ENGINE_SPI
+ */
+void
+TIS_SelectEngine(
+	_In_	BYTE	PbEngine);
+
+/**
+ *	@brief		Enables or disables the TPM interrupts
+ *	@details	With interrupts enabled the wait loops for commandReady and dataAvail sleep on the interrupt line opened
+ *				by DeviceAccess_OpenInterrupt until the TPM raises the interrupt instead of polling the status register
+ *				at fixed intervals. The status register is still checked after each wakeup, so a lost interrupt only
+ *				delays the command by up to TIS_INTERRUPT_MAX_WAIT_US.
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PfEnable		TRUE enables the commandReady and dataAvail interrupts, FALSE disables all interrupts
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_NOT_READY	The interrupt line is not opened.
+ *	@retval		...				Error codes from TIS_ReadRegister and TIS_WriteRegister functions
+ */
+_Check_return_
+UINT32
+TIS_EnableInterrupts(
+	_In_	BYTE	PbLocality,
+	_In_	BOOL	PfEnable);
+
+/**
+ *	@brief		Send a data block given in several parts to the TPM
+ *	@details	Send the parts of a data block to the TPM TIS data FIFO one after the other under consideration of
+ *				the TIS communication protocol. A burst may span several parts.
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgsSegments		Parts of the data block to send
+ *	@param		PunSegmentCount		Number of parts
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PrgsSegments or one of the parts is NULL or the data block exceeds 0xFFFF bytes.
  *	@retval		RC_E_LOCALITY_NOT_ACTIVE	Locality not active
  *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	TPM no data available
  *	@retval		RC_E_NOT_READY				Not ready
  *	@retval		RC_E_TPM_TRANSMIT_DATA		Error during transmit data
  *	@retval		...							Error codes from:
- *												TIS_RequestUse,
- *												TIS_IsActiveLocality,
+ *												TIS_AcquireLocality,
  *												TIS_IsCommandReady,
  *												TIS_Abort,
- *												TIS_GetBurstCount,
- *												TIS_WriteRegister,
- *												TIS_ReadStsRegister function
+ *												TIS_ReadStatusSnapshot,
+ *												TIS_WriteFifo,
+ *												TIS_WriteRegister function
+ */
+_Check_return_
+UINT32
+TIS_SendSegmentsLPC(
+	_In_						BYTE					PbLocality,
+	_In_reads_(PunSegmentCount)	const IfxTpmIoSegment*	PrgsSegments,
+	_In_						UINT32					PunSegmentCount);
+
+/**
+ *	@brief		Send data block to the TPM
+ *	@details	Send a data block to the TPM TIS data FIFO under consideration of the
+ *				TIS communication protocol
+ *
+ *	@param		PbLocality		Locality value
+ *	@param		PrgbByteBuf		Bytes to send
+ *	@param		PusLen			Length of bytes
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. PrgbByteBuf is NULL.
+ *	@retval		...							Error codes from TIS_SendSegmentsLPC function
  */
 _Check_return_
 UINT32
@@ -396,10 +616,8 @@ TIS_SendLPC(
  *	@retval		RC_E_TPM_TRANSMIT_DATA		Error during transmit data
  *	@retval		...							Error codes from:
  *												TIS_IsActiveLocality,
- *												TIS_ReadStsRegister,
- *												TIS_GetBurstCount,
- *												TIS_ReadRegister,
- *												TIS_ReadStsRegister,
+ *												TIS_ReadStatusSnapshot,
+ *												TIS_ReadFifo,
  *												TIS_IsCommandReady,
  *												TIS_Abort,
  *												TIS_Retry function
@@ -412,32 +630,119 @@ TIS_ReadLPC(
 	_Inout_					UINT16*	PpusLen);
 
 /**
- *	@brief		Sends the Transceive Buffer to the TPM and returns the response
- *	@details
- *
- *	@param		PbLocality		Locality value
- *	@param		PrgbTxBuffer	Pointer Transceive buffer
- *	@param		PusTxLen		Length of the Transceive buffer
- *	@param		PrgbRxBuffer	Pointer to a Receive buffer
- *	@param		PpusRxLen		Pointer to the length of the Receive buffer
- *	@param		PunMaxDuration	The maximum duration of the command in microseconds
+ *	@brief		Sends a Transceive Buffer given in several parts to the TPM and returns the response
+ *	@details	The parts are written to the data FIFO one after the other, so the caller does not need to assemble
+ *				the command in a contiguous buffer.
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgsTxSegments		Parts of the Transceive buffer
+ *	@param		PunTxSegmentCount	Number of parts
+ *	@param		PrgbRxBuffer		Pointer to a Receive buffer
+ *	@param		PpusRxLen			Pointer to the length of the Receive buffer
+ *	@param		PunMaxDuration		The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration	The expected duration of the command in microseconds
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
  *	@retval		RC_E_TPM_NO_DATA_AVAILABLE	TPM no data available
  *	@retval		...							Error codes from:
- *												TIS_SendLPC,
+ *												TIS_SendSegmentsLPC,
  *												TIS_IsDataAvailable,
  *												TIS_ReadLPC,
  *												TIS_ReleaseActiveLocality function
  */
 _Check_return_
 UINT32
+TIS_TransceiveSegmentsLPC(
+	_In_							BYTE					PbLocality,
+	_In_reads_(PunTxSegmentCount)	const IfxTpmIoSegment*	PrgsTxSegments,
+	_In_							UINT32					PunTxSegmentCount,
+	_Out_bytecap_(*PpusRxLen)		BYTE*					PrgbRxBuffer,
+	_Inout_							UINT16*					PpusRxLen,
+	_In_							UINT32					PunMaxDuration,
+	_In_							UINT32					PunExpectedDuration);
+
+/**
+ *	@brief		Sends the Transceive Buffer to the TPM and returns the response
+ *	@details
+ *
+ *	@param		PbLocality			Locality value
+ *	@param		PrgbTxBuffer		Pointer Transceive buffer
+ *	@param		PusTxLen			Length of the Transceive buffer
+ *	@param		PrgbRxBuffer		Pointer to a Receive buffer
+ *	@param		PpusRxLen			Pointer to the length of the Receive buffer
+ *	@param		PunMaxDuration		The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration	The expected duration of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		...							Error codes from TIS_TransceiveSegmentsLPC function
+ */
+_Check_return_
+UINT32
 TIS_TransceiveLPC(
 	_In_						BYTE		PbLocality,
 	_In_bytecount_(PusTxLen)	const BYTE*	PrgbTxBuffer,
 	_In_						UINT16		PusTxLen,
 	_Out_bytecap_(*PpusRxLen)	BYTE*		PrgbRxBuffer,
 	_Inout_						UINT16*		PpusRxLen,
-	_In_						UINT32		PunMaxDuration);
+	_In_						UINT32		PunMaxDuration,
+	_In_						UINT32		PunExpectedDuration);
+
+/**
+ *	@brief		Returns the TIS transport statistics
+ *	@details	Returns the register accesses, data FIFO bytes and wait loop statistics accumulated since the start
+ *				of the application.
+ *
+ *	@param		PpStatistics		Pointer to a structure receiving the statistics
+ */
+void
+TIS_GetStatistics(
+	_Out_	IfxTpmIoStatistics*	PpStatistics);
+
+/**
+ *	@brief		Returns the polling parameters in use
+ *
+ *	@param		PpTuning			Pointer to a structure receiving the polling parameters
+ */
+void
+TIS_GetTuning(
+	_Out_	IfxTisTuning*	PpTuning);
+
+/**
+ *	@brief		Sets the polling parameters
+ *	@details	The parameters are checked against TIS_TUNING_MAX_SLEEP_US and TIS_TUNING_MAX_SPIN_US. NULL restores
+ *				the compile-time values.
+ *
+ *	@param		PpTuning			Polling parameters or NULL
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	A parameter is out of range, the polling parameters are not changed.
+ */
+_Check_return_
+UINT32
+TIS_SetTuning(
+	_In_opt_	const IfxTisTuning*	PpTuning);
+
+/**
+ *	@brief		Measures the polling parameters of the platform
+ *	@details	Times TIS_TUNING_CALIBRATION_READS status register reads and reads the burst count the TPM offers for a
+ *				command. The sleep intervals are derived from the register read time, polling more often than a few
+ *				register reads only loads the bus. The busy-poll duration is derived from the command completion time
+ *				measured by the caller. The polling parameters in use are not changed.
+ *
+ *	@param		PbLocality			Locality value, the locality must be active
+ *	@param		PunCommandTime		Completion time of a short command in microseconds, 0 keeps TIS_MAX_SPIN_TIME_US
+ *	@param		PpTuning			Pointer to a structure receiving the polling parameters
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		RC_E_FAIL			The monotonic clock is not available.
+ *	@retval		...					Error codes from TIS_ReadStsRegister, TIS_Abort and TIS_GetBurstCount
+ */
+_Check_return_
+UINT32
+TIS_Calibrate(
+	_In_	BYTE			PbLocality,
+	_In_	UINT32			PunCommandTime,
+	_Out_	IfxTisTuning*	PpTuning);
 
 #endif //__TPM_TIS_H__
@@ -0,0 +1,271 @@
+﻿/**
+ *	@brief		Implements the TPM capture replay device access
+ *	@details	Serves the TPM responses of a capture file recorded by the device management with the original or scaled timing.
+ *	@file		TpmDeviceAccess/TpmReplay.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TpmReplay.h"
+#include "Logging.h"
+#include "PropertyStorage.h"
+#include "Platform.h"
+#include "FileIO.h"
+
+/// Offset of the command code in a TPM request
+#define TPM_REPLAY_COMMAND_CODE_OFFSET	6
+/// Offset of the TPM_FieldUpgrade sub command in a TPM1.2 request
+#define TPM_REPLAY_SUB_COMMAND_OFFSET	10
+/// TPM1.2 vendor ordinal TPM_FieldUpgrade
+#define TPM_REPLAY_ORD_FIELDUPGRADE		0x000000AA
+
+/**
+ *	@brief		State of the TPM capture replay
+ */
+typedef struct tdIfxTpmReplay
+{
+	/// Content of the capture file
+	BYTE* prgbCapture;
+	/// Size of the capture file in bytes
+	unsigned int unCaptureSize;
+	/// Offset of the next record
+	unsigned int unOffset;
+	/// Index of the next record
+	unsigned int unRecord;
+	/// Timing scale in percent of the recorded command durations
+	unsigned int unTimingScale;
+} IfxTpmReplay;
+
+/// The TPM capture replay
+static IfxTpmReplay s_sReplay = {NULL, 0, 0, 0, 0};
+
+/**
+ *	@brief		Reads a big endian UINT32 from a buffer
+ *	@details	The caller ensures that the buffer holds four bytes.
+ *
+ *	@param		PrgbBuffer		Buffer
+ *
+ *	@returns	The value
+ */
+static UINT32
+TpmReplay_GetUInt32(
+	_In_bytecount_(4)	const BYTE*	PrgbBuffer)
+{
+	return ((UINT32)PrgbBuffer[0] << 24) | ((UINT32)PrgbBuffer[1] << 16) | ((UINT32)PrgbBuffer[2] << 8) | (UINT32)PrgbBuffer[3];
+}
+
+/**
+ *	@brief		Determines the command of a TPM request
+ *	@details	TPM_FieldUpgrade sub commands are identified by 0xAAxx.
+ *
+ *	@param		PrgbRequest		Request bytes
+ *	@param		PunRequestSize	Size of the request in bytes
+ *
+ *	@returns	The command code, ordinal or 0xAAxx for TPM_FieldUpgrade sub commands, 0 for a request without header
+ */
+static UINT32
+TpmReplay_GetCommand(
+	_In_bytecount_(PunRequestSize)	const BYTE*		PrgbRequest,
+	_In_							unsigned int	PunRequestSize)
+{
+	UINT32 unCommand = 0;
+
+	if (PunRequestSize >= TPM_REPLAY_COMMAND_CODE_OFFSET + sizeof(UINT32))
+	{
+		unCommand = TpmReplay_GetUInt32(&PrgbRequest[TPM_REPLAY_COMMAND_CODE_OFFSET]);
+		if (TPM_REPLAY_ORD_FIELDUPGRADE == unCommand && PunRequestSize > TPM_REPLAY_SUB_COMMAND_OFFSET)
+			unCommand = (unCommand << 8) | PrgbRequest[TPM_REPLAY_SUB_COMMAND_OFFSET];
+	}
+
+	return unCommand;
+}
+
+/**
+ *	@brief		Initializes the TPM capture replay
+ *	@details	Loads the capture file configured in PROPERTY_TPM_DEVICE_ACCESS_PATH and the timing scale configured in
+ *				PROPERTY_TPM_REPLAY_TIMING_SCALE.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	No capture file is configured or the capture file is invalid.
+ *	@retval		...						Error codes from FileIO_ReadFileToBuffer
+ */
+_Check_return_
+unsigned int
+TpmReplay_Initialize()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszCapturePath[MAX_PATH] = {0};
+		unsigned int unCapturePathSize = RG_LEN(wszCapturePath);
+
+		IGNORE_RETURN_VALUE(TpmReplay_Uninitialize());
+
+		// The capture file is given as device path of the access mode
+		if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszCapturePath, &unCapturePathSize) ||
+				0 == Platform_StringCompare(wszCapturePath, TPM_DEVICE_ACCESS_PATH, RG_LEN(TPM_DEVICE_ACCESS_PATH), FALSE))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1(L"Error: No capture file is configured for the replay device access mode.");
+			break;
+		}
+
+		if (!PropertyStorage_GetUIntegerValueById(PROPERTY_ID_TPM_REPLAY_TIMING_SCALE, &s_sReplay.unTimingScale))
+			s_sReplay.unTimingScale = TPM_REPLAY_DEFAULT_TIMING_SCALE;
+
+		unReturnValue = FileIO_ReadFileToBuffer(wszCapturePath, &s_sReplay.prgbCapture, &s_sReplay.unCaptureSize);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Reading the capture file '%ls' failed (0x%.8X).", wszCapturePath, unReturnValue);
+			break;
+		}
+
+		if (s_sReplay.unCaptureSize < TPM_CAPTURE_FILE_HEADER_SIZE ||
+				0 != Platform_MemoryCompare(s_sReplay.prgbCapture, TPM_CAPTURE_MAGIC, TPM_CAPTURE_MAGIC_SIZE) ||
+				TPM_CAPTURE_VERSION != TpmReplay_GetUInt32(&s_sReplay.prgbCapture[TPM_CAPTURE_MAGIC_SIZE]))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: '%ls' is not a valid capture file.", wszCapturePath);
+			IGNORE_RETURN_VALUE(TpmReplay_Uninitialize());
+			break;
+		}
+
+		s_sReplay.unOffset = TPM_CAPTURE_FILE_HEADER_SIZE;
+		LOGGING_WRITE_LEVEL2_FMT(L"Replaying capture file '%ls' (%d bytes) at %d%% of the recorded timing", wszCapturePath, s_sReplay.unCaptureSize, s_sReplay.unTimingScale);
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Uninitializes the TPM capture replay
+ *	@details	Releases the loaded capture file.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ */
+_Check_return_
+unsigned int
+TpmReplay_Uninitialize()
+{
+	if (NULL != s_sReplay.prgbCapture)
+		LOGGING_WRITE_LEVEL2_FMT(L"Replay finished after %d recorded commands", s_sReplay.unRecord);
+
+	Platform_MemoryFree((void**)&s_sReplay.prgbCapture);
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sReplay, 0, sizeof(s_sReplay)));
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Serves the next recorded TPM response
+ *	@details	The command code of the request must match the next recorded request. The recorded command duration,
+ *				scaled by the configured timing scale, is spent before the response is returned.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds (unused)
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The response buffer is too small.
+ *	@retval		RC_E_FAIL				The capture is exhausted, corrupt or the request differs from the recorded one.
+ *	@retval		...						The transmit return code recorded for the command
+ */
+_Check_return_
+unsigned int
+TpmReplay_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	UNREFERENCED_PARAMETER(PunMaxDuration);
+	UNREFERENCED_PARAMETER(PunExpectedDuration);
+
+	do
+	{
+		const BYTE* prgbRecord = NULL;
+		unsigned int unRemaining = 0;
+		UINT32 unDuration = 0, unRecordedReturnValue = 0, unRequestSize = 0, unResponseSize = 0;
+		unsigned long long ullDelay = 0;
+
+		if (NULL == PrgbRequestBuffer || NULL == PrgbResponseBuffer || NULL == PpunResponseBufferSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			LOGGING_WRITE_LEVEL1(L"Error: Bad parameter.");
+			break;
+		}
+
+		// Parse the next record
+		unRemaining = s_sReplay.unCaptureSize - s_sReplay.unOffset;
+		if (NULL == s_sReplay.prgbCapture || unRemaining < TPM_CAPTURE_RECORD_HEADER_SIZE)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: The capture is exhausted after %d recorded commands.", s_sReplay.unRecord);
+			break;
+		}
+		prgbRecord = &s_sReplay.prgbCapture[s_sReplay.unOffset];
+		unDuration = TpmReplay_GetUInt32(&prgbRecord[8]);
+		unRecordedReturnValue = TpmReplay_GetUInt32(&prgbRecord[12]);
+		unRequestSize = TpmReplay_GetUInt32(&prgbRecord[16]);
+		unResponseSize = TpmReplay_GetUInt32(&prgbRecord[20]);
+		unRemaining -= TPM_CAPTURE_RECORD_HEADER_SIZE;
+		if (unRequestSize > unRemaining || unResponseSize > unRemaining - unRequestSize)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Record %d of the capture is corrupt.", s_sReplay.unRecord);
+			break;
+		}
+
+		// The flow must send the same command as in the recorded session
+		if (TpmReplay_GetCommand(PrgbRequestBuffer, PunRequestBufferSize) != TpmReplay_GetCommand(&prgbRecord[TPM_CAPTURE_RECORD_HEADER_SIZE], unRequestSize))
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Command 0x%.8X differs from command 0x%.8X of record %d of the capture.",
+				TpmReplay_GetCommand(PrgbRequestBuffer, PunRequestBufferSize), TpmReplay_GetCommand(&prgbRecord[TPM_CAPTURE_RECORD_HEADER_SIZE], unRequestSize), s_sReplay.unRecord);
+			break;
+		}
+		if (unRequestSize != PunRequestBufferSize || 0 != Platform_MemoryCompare(PrgbRequestBuffer, &prgbRecord[TPM_CAPTURE_RECORD_HEADER_SIZE], unRequestSize))
+			LOGGING_WRITE_LEVEL2_FMT(L"Request of record %d differs from the recorded request.", s_sReplay.unRecord);
+
+		if (unResponseSize > *PpunResponseBufferSize)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: The response buffer is too small for record %d.", s_sReplay.unRecord);
+			break;
+		}
+
+		s_sReplay.unOffset += TPM_CAPTURE_RECORD_HEADER_SIZE + unRequestSize + unResponseSize;
+		s_sReplay.unRecord++;
+
+		// Spend the scaled command duration
+		TPMIO_CommandPending();
+		ullDelay = (unsigned long long)unDuration * s_sReplay.unTimingScale / 100;
+		if (0 != ullDelay)
+			Platform_SleepMicroSeconds(ullDelay > 0xFFFFFFFF ? 0xFFFFFFFF : (unsigned int)ullDelay);
+
+		if (0 != unResponseSize)
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(PrgbResponseBuffer, *PpunResponseBufferSize, &prgbRecord[TPM_CAPTURE_RECORD_HEADER_SIZE + unRequestSize], unResponseSize));
+		*PpunResponseBufferSize = unResponseSize;
+
+		unReturnValue = unRecordedReturnValue;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
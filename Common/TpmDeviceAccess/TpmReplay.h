@@ -0,0 +1,98 @@
+﻿/**
+ *	@brief		Declares the TPM capture replay device access functions
+ *	@details
+ *	@file		TpmDeviceAccess/TpmReplay.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TPM_REPLAY_H__
+#define __TPM_REPLAY_H__
+
+#include "StdInclude.h"
+#include "TpmIO.h"
+
+// Capture file format (all values big endian):
+//   File header:	magic TPM_CAPTURE_MAGIC (8 bytes), version (UINT32), reserved (UINT32)
+//   Record:		time stamp since capture start in microseconds (UINT64), command duration in microseconds (UINT32),
+//					transmit return code (UINT32), request size (UINT32), response size (UINT32), request bytes, response bytes
+/// Magic of a TPM capture file
+#define TPM_CAPTURE_MAGIC				"IFXTPMCP"
+/// Size of the magic of a TPM capture file
+#define TPM_CAPTURE_MAGIC_SIZE			8
+/// Version of the TPM capture file format
+#define TPM_CAPTURE_VERSION				1
+/// Size of the TPM capture file header
+#define TPM_CAPTURE_FILE_HEADER_SIZE	16
+/// Size of the header of a TPM capture record
+#define TPM_CAPTURE_RECORD_HEADER_SIZE	24
+/// Default replay timing scale in percent of the recorded command durations
+#define TPM_REPLAY_DEFAULT_TIMING_SCALE	100
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Initializes the TPM capture replay
+ *	@details	Loads the capture file configured in PROPERTY_TPM_DEVICE_ACCESS_PATH and the timing scale configured in
+ *				PROPERTY_TPM_REPLAY_TIMING_SCALE.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	No capture file is configured or the capture file is invalid.
+ *	@retval		...						Error codes from FileIO_ReadFileToBuffer
+ */
+_Check_return_
+unsigned int
+TpmReplay_Initialize();
+
+/**
+ *	@brief		Uninitializes the TPM capture replay
+ *	@details	Releases the loaded capture file.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ */
+_Check_return_
+unsigned int
+TpmReplay_Uninitialize();
+
+/**
+ *	@brief		Serves the next recorded TPM response
+ *	@details	The command code of the request must match the next recorded request. The recorded command duration,
+ *				scaled by the configured timing scale, is spent before the response is returned.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds (unused)
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The response buffer is too small.
+ *	@retval		RC_E_FAIL				The capture is exhausted, corrupt or the request differs from the recorded one.
+ *	@retval		...						The transmit return code recorded for the command
+ */
+_Check_return_
+unsigned int
+TpmReplay_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__TPM_REPLAY_H__
@@ -0,0 +1,1024 @@
+﻿/**
+ *	@brief		Implements a simulated TPM device access
+ *	@details	The simulator answers the TPM1.2, TPM2.0 and boot loader commands used by the tool without TPM hardware.
+ *	@file		TpmDeviceAccess/TpmSimulator.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TpmSimulator.h"
+#include "Logging.h"
+#include "PropertyStorage.h"
+#include "Platform.h"
+
+/// Maximum size of the parameter area of a simulated response
+#define TPMSIM_MAX_PARAMETERS_SIZE			512
+/// Size of a TPM command and response header (tag, size, code)
+#define TPMSIM_HEADER_SIZE					10
+
+/// Response code for successful completion (TPM_SUCCESS / TPM_RC_SUCCESS)
+#define TPMSIM_RC_SUCCESS					0x00000000
+
+// TPM1.2 wire definitions
+/// TPM1.2 request tag without authorization
+#define TPMSIM_TAG_RQU_COMMAND				0x00C1
+/// TPM1.2 request tag with one authorization
+#define TPMSIM_TAG_RQU_AUTH1_COMMAND		0x00C2
+/// TPM1.2 response tag (also used by TPM2.0 for responses to TPM1.2 formatted requests)
+#define TPMSIM_TAG_RSP_COMMAND				0x00C4
+/// TPM1.2 ordinal TPM_Startup
+#define TPMSIM_ORD_STARTUP					0x00000099
+/// TPM1.2 ordinal TPM_GetCapability
+#define TPMSIM_ORD_GETCAPABILITY			0x00000065
+/// TPM1.2 ordinal TPM_SetCapability
+#define TPMSIM_ORD_SETCAPABILITY			0x0000003F
+/// TPM1.2 ordinal TPM_GetTestResult
+#define TPMSIM_ORD_GETTESTRESULT			0x00000054
+/// TPM1.2 ordinal TSC_PhysicalPresence
+#define TPMSIM_ORD_TSC_PHYSICALPRESENCE		0x4000000A
+/// TPM1.2 vendor ordinal TPM_FieldUpgrade
+#define TPMSIM_ORD_FIELDUPGRADE				0x000000AA
+/// TPM_FieldUpgrade sub command InfoRequest
+#define TPMSIM_FU_INFO_REQUEST				0x10
+/// TPM_FieldUpgrade sub command InfoRequest2
+#define TPMSIM_FU_INFO_REQUEST2				0x11
+/// TPM_FieldUpgrade sub command Update
+#define TPMSIM_FU_UPDATE					0x31
+/// TPM_FieldUpgrade sub command Complete
+#define TPMSIM_FU_COMPLETE					0x32
+/// TPM_FieldUpgrade sub command Start
+#define TPMSIM_FU_START						0x34
+/// TPM1.2 capability area TPM_CAP_FLAG
+#define TPMSIM_CAP_FLAG						0x00000004
+/// TPM1.2 capability area TPM_CAP_PROPERTY
+#define TPMSIM_CAP_PROPERTY					0x00000005
+/// TPM1.2 capability area TPM_CAP_VERSION_VAL
+#define TPMSIM_CAP_VERSION_VAL				0x0000001A
+/// TPM1.2 sub capability TPM_CAP_PROP_OWNER
+#define TPMSIM_CAP_PROP_OWNER				0x00000111
+/// TPM1.2 sub capability TPM_CAP_FLAG_PERMANENT
+#define TPMSIM_CAP_FLAG_PERMANENT			0x00000108
+/// TPM1.2 sub capability TPM_CAP_FLAG_VOLATILE
+#define TPMSIM_CAP_FLAG_VOLATILE			0x00000109
+/// TPM1.2 structure tag TPM_TAG_CAP_VERSION_INFO
+#define TPMSIM_TAG_CAP_VERSION_INFO			0x0030
+/// TPM1.2 structure tag TPM_TAG_PERMANENT_FLAGS
+#define TPMSIM_TAG_PERMANENT_FLAGS			0x001F
+/// TPM1.2 structure tag TPM_TAG_STCLEAR_FLAGS
+#define TPMSIM_TAG_STCLEAR_FLAGS			0x0020
+/// TPM1.2 response code TPM_BAD_PARAMETER
+#define TPMSIM_TPM_BAD_PARAMETER			0x00000003
+/// TPM1.2 response code TPM_BAD_ORDINAL
+#define TPMSIM_TPM_BAD_ORDINAL				0x0000000A
+/// TPM1.2 response code TPM_FAILEDSELFTEST
+#define TPMSIM_TPM_FAILEDSELFTEST			0x0000001C
+/// TPM1.2 response code TPM_BADTAG
+#define TPMSIM_TPM_BADTAG					0x0000001E
+/// TPM1.2 response code TPM_INVALID_POSTINIT
+#define TPMSIM_TPM_INVALID_POSTINIT			0x00000026
+/// Size of the IFX_FIELDUPGRADEINFO structure
+#define TPMSIM_FIELDUPGRADEINFO_SIZE		20
+/// Flag in IFX_FIELDUPGRADEINFO.wFlagsFieldUpgrade signaling deferred physical presence support
+#define TPMSIM_FLAGS_DEFERRED_PP			0x0008
+
+// TPM2.0 wire definitions
+/// TPM2.0 tag TPM_ST_NO_SESSIONS
+#define TPMSIM_ST_NO_SESSIONS				0x8001
+/// TPM2.0 tag TPM_ST_SESSIONS
+#define TPMSIM_ST_SESSIONS					0x8002
+/// TPM2.0 tag TPM_ST_AUTH_SECRET
+#define TPMSIM_ST_AUTH_SECRET				0x8023
+/// TPM2.0 command code TPM2_HierarchyChangeAuth
+#define TPMSIM_CC_HIERARCHYCHANGEAUTH		0x00000129
+/// TPM2.0 command code TPM2_SetPrimaryPolicy
+#define TPMSIM_CC_SETPRIMARYPOLICY			0x0000012E
+/// TPM2.0 command code TPM2_Startup
+#define TPMSIM_CC_STARTUP					0x00000144
+/// TPM2.0 command code TPM2_Shutdown
+#define TPMSIM_CC_SHUTDOWN					0x00000145
+/// TPM2.0 command code TPM2_PolicySecret
+#define TPMSIM_CC_POLICYSECRET				0x00000151
+/// TPM2.0 command code TPM2_FlushContext
+#define TPMSIM_CC_FLUSHCONTEXT				0x00000165
+/// TPM2.0 command code TPM2_PolicyCommandCode
+#define TPMSIM_CC_POLICYCOMMANDCODE			0x0000016C
+/// TPM2.0 command code TPM2_StartAuthSession
+#define TPMSIM_CC_STARTAUTHSESSION			0x00000176
+/// TPM2.0 command code TPM2_GetCapability
+#define TPMSIM_CC_GETCAPABILITY				0x0000017A
+/// TPM2.0 command code TPM2_GetTestResult
+#define TPMSIM_CC_GETTESTRESULT				0x0000017C
+/// TPM2.0 vendor command code TPM2_FieldUpgradeStartVendor
+#define TPMSIM_CC_FIELDUPGRADESTARTVENDOR	0x2000012F
+/// TPM2.0 capability TPM_CAP_TPM_PROPERTIES
+#define TPMSIM_CAP_TPM_PROPERTIES			0x00000006
+/// TPM2.0 capability TPM_CAP_VENDOR_PROPERTY
+#define TPMSIM_CAP_VENDOR_PROPERTY			0x00000100
+/// TPM2.0 vendor property TPM_PT_VENDOR_FIX_SMLI2
+#define TPMSIM_PT_VENDOR_FIX_SMLI2			0x80000001
+/// First fixed TPM2.0 property reported by the simulator (TPM_PT_FAMILY_INDICATOR)
+#define TPMSIM_PT_FIXED_FIRST				0x00000100
+/// TPM2.0 property TPM_PT_MANUFACTURER
+#define TPMSIM_PT_MANUFACTURER				0x00000105
+/// TPM2.0 property TPM_PT_FIRMWARE_VERSION_1
+#define TPMSIM_PT_FIRMWARE_VERSION_1		0x0000010B
+/// Last fixed TPM2.0 property reported by the simulator (TPM_PT_FIRMWARE_VERSION_2)
+#define TPMSIM_PT_FIXED_LAST				0x0000010C
+/// TPM2.0 manufacturer ID of Infineon ("IFX")
+#define TPMSIM_MANUFACTURER_IFX				0x49465800
+/// Handle of the simulated authorization session
+#define TPMSIM_SESSION_HANDLE				0x03000000
+/// TPM2.0 handle TPM_RH_NULL
+#define TPMSIM_RH_NULL						0x40000007
+/// TPM2.0 response code TPM_RC_BAD_TAG
+#define TPMSIM_RC_BAD_TAG					0x0000001E
+/// TPM2.0 response code TPM_RC_INITIALIZE
+#define TPMSIM_RC_INITIALIZE				0x00000100
+/// TPM2.0 response code TPM_RC_COMMAND_CODE
+#define TPMSIM_RC_COMMAND_CODE				0x00000143
+/// TPM2.0 response code TPM_RC_VALUE + TPM_RC_P + TPM_RC_2 (unsupported capability)
+#define TPMSIM_RC_VALUE_P2					0x000002C4
+
+// Security module logic info definitions
+/// Maximum data size of a firmware block reported by the simulator
+#define TPMSIM_MAX_DATA_SIZE				1024
+/// Security module status: boot loader active
+#define TPMSIM_SMS_BTLDR_ACTIVE				0x5A3C
+/// Security module status: firmware active
+#define TPMSIM_SMS_FWCONFIG_ACTIVE			0x36A5
+/// Number of entries in the key list of the security module logic info 2 structure
+#define TPMSIM_KEY_LIST_ENTRIES				4
+/// Size of a nonce returned by the simulated authorization session
+#define TPMSIM_NONCE_SIZE					32
+
+/**
+ *	@brief		Buffer used to marshal the parameter area of a simulated response
+ */
+typedef struct tdIfxTpmSimulatorBuffer
+{
+	/// Marshaled bytes
+	BYTE rgbData[TPMSIM_MAX_PARAMETERS_SIZE];
+	/// Number of marshaled bytes
+	unsigned int unSize;
+	/// Flag set if the buffer could not hold all bytes
+	BOOL fOverflow;
+} IfxTpmSimulatorBuffer;
+
+/**
+ *	@brief		State and configuration of the simulated TPM
+ */
+typedef struct tdIfxTpmSimulator
+{
+	/// TRUE if the simulated TPM is (or resumes as) a TPM2.0, FALSE for a TPM1.2
+	BOOL fTpm20;
+	/// TRUE while the simulated TPM is in boot loader mode
+	BOOL fBootLoader;
+	/// Firmware version (major, minor, build, sub version)
+	unsigned int rgunFirmwareVersion[4];
+	/// Decrypt key ID reported in the key list
+	unsigned int unDecryptKeyId;
+	/// Remaining field upgrades
+	unsigned int unFieldUpgradeCounter;
+	/// Default latency per command in microseconds
+	unsigned int unLatency;
+	/// Latency of the field upgrade start commands in microseconds
+	unsigned int unLatencyStart;
+	/// Latency of a field upgrade update command in microseconds
+	unsigned int unLatencyUpdate;
+	/// Latency of the field upgrade complete command in microseconds
+	unsigned int unLatencyComplete;
+	/// Command (ordinal, command code or 0xAAxx for FieldUpgrade sub commands) to fail, 0 for any command
+	unsigned int unFailCommand;
+	/// Occurrence (1-based) of the command to fail, 0 to disable failure injection
+	unsigned int unFailCount;
+	/// Response code returned by the failed command
+	unsigned int unFailCode;
+	/// Number of matching commands seen so far
+	unsigned int unFailMatches;
+	/// Number of commands processed since initialization
+	unsigned int unCommandCount;
+} IfxTpmSimulator;
+
+/// The simulated TPM
+static IfxTpmSimulator s_sSimulator = {0};
+
+/**
+ *	@brief		Appends bytes to a response parameter buffer
+ *	@details	Appends zero bytes if PrgbData is NULL.
+ *
+ *	@param		PpBuffer		Buffer to append to
+ *	@param		PrgbData		Bytes to append or NULL
+ *	@param		PunSize			Number of bytes to append
+ */
+static void
+TpmSimulator_PutBytes(
+	_Inout_						IfxTpmSimulatorBuffer*	PpBuffer,
+	_In_opt_bytecount_(PunSize)	const BYTE*				PrgbData,
+	_In_						unsigned int			PunSize)
+{
+	if (PunSize > RG_LEN(PpBuffer->rgbData) - PpBuffer->unSize)
+	{
+		PpBuffer->fOverflow = TRUE;
+		return;
+	}
+
+	if (NULL == PrgbData)
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&PpBuffer->rgbData[PpBuffer->unSize], 0, PunSize));
+	else
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PpBuffer->rgbData[PpBuffer->unSize], PunSize, PrgbData, PunSize));
+	PpBuffer->unSize += PunSize;
+}
+
+/**
+ *	@brief		Appends a byte to a response parameter buffer
+ *	@details
+ *
+ *	@param		PpBuffer		Buffer to append to
+ *	@param		PbValue			Value to append
+ */
+static void
+TpmSimulator_PutUInt8(
+	_Inout_	IfxTpmSimulatorBuffer*	PpBuffer,
+	_In_	BYTE					PbValue)
+{
+	TpmSimulator_PutBytes(PpBuffer, &PbValue, sizeof(PbValue));
+}
+
+/**
+ *	@brief		Appends a big endian UINT16 to a response parameter buffer
+ *	@details
+ *
+ *	@param		PpBuffer		Buffer to append to
+ *	@param		PusValue		Value to append
+ */
+static void
+TpmSimulator_PutUInt16(
+	_Inout_	IfxTpmSimulatorBuffer*	PpBuffer,
+	_In_	UINT16					PusValue)
+{
+	BYTE rgbValue[2] = {(BYTE)(PusValue >> 8), (BYTE)PusValue};
+	TpmSimulator_PutBytes(PpBuffer, rgbValue, sizeof(rgbValue));
+}
+
+/**
+ *	@brief		Appends a big endian UINT32 to a response parameter buffer
+ *	@details
+ *
+ *	@param		PpBuffer		Buffer to append to
+ *	@param		PunValue		Value to append
+ */
+static void
+TpmSimulator_PutUInt32(
+	_Inout_	IfxTpmSimulatorBuffer*	PpBuffer,
+	_In_	UINT32					PunValue)
+{
+	BYTE rgbValue[4] = {(BYTE)(PunValue >> 24), (BYTE)(PunValue >> 16), (BYTE)(PunValue >> 8), (BYTE)PunValue};
+	TpmSimulator_PutBytes(PpBuffer, rgbValue, sizeof(rgbValue));
+}
+
+/**
+ *	@brief		Reads a big endian UINT32 from a request
+ *	@details
+ *
+ *	@param		PrgbRequest		Request bytes
+ *	@param		PunRequestSize	Size of the request in bytes
+ *	@param		PunOffset		Offset of the value
+ *
+ *	@returns	The value or 0 if the request is too short
+ */
+static UINT32
+TpmSimulator_GetUInt32(
+	_In_bytecount_(PunRequestSize)	const BYTE*		PrgbRequest,
+	_In_							unsigned int	PunRequestSize,
+	_In_							unsigned int	PunOffset)
+{
+	if (PunRequestSize < 4 || PunOffset > PunRequestSize - 4)
+		return 0;
+	return ((UINT32)PrgbRequest[PunOffset] << 24) | ((UINT32)PrgbRequest[PunOffset + 1] << 16) |
+		((UINT32)PrgbRequest[PunOffset + 2] << 8) | (UINT32)PrgbRequest[PunOffset + 3];
+}
+
+/**
+ *	@brief		Parses a firmware version string
+ *	@details	Accepts the format "major.minor.build[.sub]" with decimal numbers.
+ *
+ *	@param		PwszVersion		Version string
+ *	@param		PrgunVersion	Receives major, minor, build and sub version
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	The version string has an invalid format.
+ */
+_Check_return_
+static unsigned int
+TpmSimulator_ParseFirmwareVersion(
+	_In_z_	const wchar_t*	PwszVersion,
+	_Out_	unsigned int	PrgunVersion[4])
+{
+	unsigned int unReturnValue = RC_E_INVALID_SETTING;
+	unsigned int unIndex = 0;
+	BOOL fDigit = FALSE;
+
+	do
+	{
+		IGNORE_RETURN_VALUE(Platform_MemorySet(PrgunVersion, 0, sizeof(unsigned int) * 4));
+
+		for (; L'\0' != *PwszVersion; PwszVersion++)
+		{
+			if (L'.' == *PwszVersion && fDigit && unIndex < 3)
+			{
+				unIndex++;
+				fDigit = FALSE;
+			}
+			else if (*PwszVersion >= L'0' && *PwszVersion <= L'9' && PrgunVersion[unIndex] < 0x10000)
+			{
+				PrgunVersion[unIndex] = PrgunVersion[unIndex] * 10 + (unsigned int)(*PwszVersion - L'0');
+				fDigit = TRUE;
+			}
+			else
+				break;
+		}
+
+		if (L'\0' != *PwszVersion || !fDigit || unIndex < 2 || PrgunVersion[2] > 0xFFFF || PrgunVersion[3] > 0xFF)
+			break;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Reads an optional numeric simulator setting
+ *	@details	The value is left unchanged if the setting is not configured.
+ *
+ *	@param		PwszKey			Property key of the setting
+ *	@param		PpunValue		In: default value, Out: configured value
+ */
+static void
+TpmSimulator_GetSetting(
+	_In_z_	const wchar_t*	PwszKey,
+	_Inout_	unsigned int*	PpunValue)
+{
+	unsigned int unValue = 0;
+	if (PropertyStorage_GetUIntegerValueByKey(PwszKey, &unValue))
+		*PpunValue = unValue;
+}
+
+/**
+ *	@brief		Marshals the security module logic info structure of the simulated TPM
+ *	@details	The structure is returned by TPM_FieldUpgradeInfoRequest2 and, extended with the key list, in the
+ *				TPM2.0 vendor property TPM_PT_VENDOR_FIX_SMLI2.
+ *
+ *	@param		PpBuffer		Buffer to append to
+ *	@param		PfKeyList		TRUE to append the key list (security module logic info 2)
+ */
+static void
+TpmSimulator_PutSecurityModuleLogicInfo(
+	_Inout_	IfxTpmSimulatorBuffer*	PpBuffer,
+	_In_	BOOL					PfKeyList)
+{
+	unsigned int unIndex = 0;
+	// The build number of the configured firmware version identifies the active firmware package
+	UINT32 unPackageVersion = s_sSimulator.rgunFirmwareVersion[2];
+
+	TpmSimulator_PutUInt16(PpBuffer, 0);
+	TpmSimulator_PutUInt16(PpBuffer, TPMSIM_MAX_DATA_SIZE);
+	// sSecurityModuleLogic
+	TpmSimulator_PutUInt16(PpBuffer, 0);
+	TpmSimulator_PutUInt32(PpBuffer, 0);
+	TpmSimulator_PutBytes(PpBuffer, NULL, 34);
+	// sSecurityModuleLogic.sBootloaderFirmwarePackage
+	TpmSimulator_PutBytes(PpBuffer, NULL, 12);
+	// sSecurityModuleLogic.sFirmwareConfiguration with one active firmware package
+	TpmSimulator_PutUInt16(PpBuffer, 1);
+	TpmSimulator_PutUInt32(PpBuffer, 0);
+	TpmSimulator_PutUInt32(PpBuffer, unPackageVersion);
+	TpmSimulator_PutUInt32(PpBuffer, 0);
+	TpmSimulator_PutUInt16(PpBuffer, s_sSimulator.fBootLoader ? TPMSIM_SMS_BTLDR_ACTIVE : TPMSIM_SMS_FWCONFIG_ACTIVE);
+	// sProcessFirmwarePackage
+	TpmSimulator_PutUInt32(PpBuffer, 0);
+	TpmSimulator_PutUInt32(PpBuffer, unPackageVersion);
+	TpmSimulator_PutUInt32(PpBuffer, 0);
+	TpmSimulator_PutUInt16(PpBuffer, 0);
+	TpmSimulator_PutBytes(PpBuffer, NULL, 6);
+	TpmSimulator_PutUInt16(PpBuffer, (UINT16)s_sSimulator.unFieldUpgradeCounter);
+
+	if (PfKeyList)
+	{
+		TpmSimulator_PutUInt16(PpBuffer, TPMSIM_KEY_LIST_ENTRIES);
+		TpmSimulator_PutBytes(PpBuffer, NULL, TPMSIM_KEY_LIST_ENTRIES * sizeof(UINT32));
+		TpmSimulator_PutUInt32(PpBuffer, s_sSimulator.unDecryptKeyId);
+		for (unIndex = 1; unIndex < TPMSIM_KEY_LIST_ENTRIES; unIndex++)
+			TpmSimulator_PutUInt32(PpBuffer, 0);
+	}
+}
+
+/**
+ *	@brief		Marshals the TPM1.2 TPM_CAP_VERSION_INFO structure of the simulated TPM
+ *	@details
+ *
+ *	@param		PpBuffer		Buffer to append to
+ */
+static void
+TpmSimulator_PutVersionInfo(
+	_Inout_	IfxTpmSimulatorBuffer*	PpBuffer)
+{
+	// The boot loader does not report the vendor specific area
+	UINT16 usVendorSpecificSize = s_sSimulator.fBootLoader ? 0 : 5;
+
+	TpmSimulator_PutUInt32(PpBuffer, 15 + (UINT32)usVendorSpecificSize);
+	TpmSimulator_PutUInt16(PpBuffer, TPMSIM_TAG_CAP_VERSION_INFO);
+	TpmSimulator_PutUInt8(PpBuffer, 1);
+	TpmSimulator_PutUInt8(PpBuffer, 2);
+	TpmSimulator_PutUInt8(PpBuffer, (BYTE)s_sSimulator.rgunFirmwareVersion[0]);
+	TpmSimulator_PutUInt8(PpBuffer, (BYTE)s_sSimulator.rgunFirmwareVersion[1]);
+	TpmSimulator_PutUInt16(PpBuffer, 2);
+	TpmSimulator_PutUInt8(PpBuffer, 3);
+	TpmSimulator_PutBytes(PpBuffer, (const BYTE*)"IFX", 4);
+	TpmSimulator_PutUInt16(PpBuffer, usVendorSpecificSize);
+	if (0 != usVendorSpecificSize)
+	{
+		TpmSimulator_PutUInt16(PpBuffer, 0);
+		TpmSimulator_PutUInt16(PpBuffer, (UINT16)s_sSimulator.rgunFirmwareVersion[2]);
+		TpmSimulator_PutUInt8(PpBuffer, (BYTE)s_sSimulator.rgunFirmwareVersion[3]);
+	}
+}
+
+/**
+ *	@brief		Marshals an empty TPM2.0 response authorization area
+ *	@details
+ *
+ *	@param		PpBuffer		Buffer to append to
+ */
+static void
+TpmSimulator_PutAuthResponse(
+	_Inout_	IfxTpmSimulatorBuffer*	PpBuffer)
+{
+	// Empty nonce, continueSession attribute and empty HMAC
+	TpmSimulator_PutUInt16(PpBuffer, 0);
+	TpmSimulator_PutUInt8(PpBuffer, 0x01);
+	TpmSimulator_PutUInt16(PpBuffer, 0);
+}
+
+/**
+ *	@brief		Processes a command on the simulated TPM2.0 in operational mode
+ *	@details
+ *
+ *	@param		PrgbRequest			Request bytes
+ *	@param		PunRequestSize		Size of the request in bytes
+ *	@param		PusRequestTag		Tag of the request
+ *	@param		PunCommandCode		Command code of the request
+ *	@param		PpParameters		Receives the response parameters
+ *	@param		PpusResponseTag		Receives the response tag
+ *
+ *	@returns	The TPM response code
+ */
+static UINT32
+TpmSimulator_ProcessTpm20(
+	_In_bytecount_(PunRequestSize)	const BYTE*				PrgbRequest,
+	_In_							unsigned int			PunRequestSize,
+	_In_							UINT16					PusRequestTag,
+	_In_							UINT32					PunCommandCode,
+	_Inout_							IfxTpmSimulatorBuffer*	PpParameters,
+	_Out_							UINT16*					PpusResponseTag)
+{
+	UINT32 unResponseCode = TPMSIM_RC_SUCCESS;
+
+	*PpusResponseTag = TPMSIM_ST_NO_SESSIONS;
+	if (TPMSIM_ST_NO_SESSIONS != PusRequestTag && TPMSIM_ST_SESSIONS != PusRequestTag)
+	{
+		*PpusResponseTag = TPMSIM_TAG_RSP_COMMAND;
+		return TPMSIM_RC_BAD_TAG;
+	}
+
+	switch (PunCommandCode)
+	{
+		case TPMSIM_CC_STARTUP:
+			// The platform has already started the TPM
+			unResponseCode = TPMSIM_RC_INITIALIZE;
+			break;
+		case TPMSIM_CC_SHUTDOWN:
+		case TPMSIM_CC_POLICYCOMMANDCODE:
+		case TPMSIM_CC_FLUSHCONTEXT:
+			break;
+		case TPMSIM_CC_GETCAPABILITY:
+		{
+			UINT32 unCapability = TpmSimulator_GetUInt32(PrgbRequest, PunRequestSize, TPMSIM_HEADER_SIZE);
+			UINT32 unProperty = TpmSimulator_GetUInt32(PrgbRequest, PunRequestSize, TPMSIM_HEADER_SIZE + 4);
+			UINT32 unPropertyCount = TpmSimulator_GetUInt32(PrgbRequest, PunRequestSize, TPMSIM_HEADER_SIZE + 8);
+
+			if (TPMSIM_CAP_TPM_PROPERTIES == unCapability)
+			{
+				UINT32 unFirst = unProperty < TPMSIM_PT_FIXED_FIRST ? TPMSIM_PT_FIXED_FIRST : unProperty;
+				UINT32 unCount = 0;
+				UINT32 unIndex = 0;
+				if (unFirst <= TPMSIM_PT_FIXED_LAST)
+					unCount = TPMSIM_PT_FIXED_LAST - unFirst + 1;
+				if (unCount > unPropertyCount)
+					unCount = unPropertyCount;
+
+				TpmSimulator_PutUInt8(PpParameters, (unFirst + unCount <= TPMSIM_PT_FIXED_LAST) ? 1 : 0);
+				TpmSimulator_PutUInt32(PpParameters, unCapability);
+				TpmSimulator_PutUInt32(PpParameters, unCount);
+				for (unIndex = unFirst; unIndex < unFirst + unCount; unIndex++)
+				{
+					UINT32 unValue = 0;
+					if (TPMSIM_PT_MANUFACTURER == unIndex)
+						unValue = TPMSIM_MANUFACTURER_IFX;
+					else if (TPMSIM_PT_FIRMWARE_VERSION_1 == unIndex)
+						unValue = (s_sSimulator.rgunFirmwareVersion[0] << 16) | s_sSimulator.rgunFirmwareVersion[1];
+					else if (TPMSIM_PT_FIXED_LAST == unIndex)
+						unValue = (s_sSimulator.rgunFirmwareVersion[2] << 8) | s_sSimulator.rgunFirmwareVersion[3];
+					TpmSimulator_PutUInt32(PpParameters, unIndex);
+					TpmSimulator_PutUInt32(PpParameters, unValue);
+				}
+			}
+			else if (TPMSIM_CAP_VENDOR_PROPERTY == unCapability && TPMSIM_PT_VENDOR_FIX_SMLI2 == unProperty)
+			{
+				IfxTpmSimulatorBuffer sSecurityModuleLogicInfo = {{0}, 0, FALSE};
+				TpmSimulator_PutSecurityModuleLogicInfo(&sSecurityModuleLogicInfo, TRUE);
+				TpmSimulator_PutUInt8(PpParameters, 0);
+				TpmSimulator_PutUInt32(PpParameters, unCapability);
+				TpmSimulator_PutUInt32(PpParameters, 1);
+				TpmSimulator_PutUInt16(PpParameters, (UINT16)sSecurityModuleLogicInfo.unSize);
+				TpmSimulator_PutBytes(PpParameters, sSecurityModuleLogicInfo.rgbData, sSecurityModuleLogicInfo.unSize);
+			}
+			else
+				unResponseCode = TPMSIM_RC_VALUE_P2;
+			break;
+		}
+		case TPMSIM_CC_STARTAUTHSESSION:
+			TpmSimulator_PutUInt32(PpParameters, TPMSIM_SESSION_HANDLE);
+			TpmSimulator_PutUInt16(PpParameters, TPMSIM_NONCE_SIZE);
+			TpmSimulator_PutBytes(PpParameters, NULL, TPMSIM_NONCE_SIZE);
+			break;
+		case TPMSIM_CC_HIERARCHYCHANGEAUTH:
+		case TPMSIM_CC_SETPRIMARYPOLICY:
+			*PpusResponseTag = TPMSIM_ST_SESSIONS;
+			TpmSimulator_PutUInt32(PpParameters, 0);
+			TpmSimulator_PutAuthResponse(PpParameters);
+			break;
+		case TPMSIM_CC_POLICYSECRET:
+			// Empty timeout and a NULL ticket
+			*PpusResponseTag = TPMSIM_ST_SESSIONS;
+			TpmSimulator_PutUInt32(PpParameters, 10);
+			TpmSimulator_PutUInt16(PpParameters, 0);
+			TpmSimulator_PutUInt16(PpParameters, TPMSIM_ST_AUTH_SECRET);
+			TpmSimulator_PutUInt32(PpParameters, TPMSIM_RH_NULL);
+			TpmSimulator_PutUInt16(PpParameters, 0);
+			TpmSimulator_PutAuthResponse(PpParameters);
+			break;
+		case TPMSIM_CC_FIELDUPGRADESTARTVENDOR:
+			*PpusResponseTag = TPMSIM_ST_SESSIONS;
+			TpmSimulator_PutUInt32(PpParameters, 2);
+			TpmSimulator_PutUInt16(PpParameters, 0);
+			TpmSimulator_PutAuthResponse(PpParameters);
+			s_sSimulator.fBootLoader = TRUE;
+			break;
+		case TPMSIM_CC_GETTESTRESULT:
+			TpmSimulator_PutUInt16(PpParameters, 0);
+			TpmSimulator_PutUInt32(PpParameters, TPMSIM_RC_SUCCESS);
+			break;
+		default:
+			unResponseCode = TPMSIM_RC_COMMAND_CODE;
+			break;
+	}
+
+	return unResponseCode;
+}
+
+/**
+ *	@brief		Processes a command on the simulated TPM1.2 in operational mode
+ *	@details	Only an unowned TPM1.2 is simulated, so no authorization sessions are supported.
+ *
+ *	@param		PrgbRequest			Request bytes
+ *	@param		PunRequestSize		Size of the request in bytes
+ *	@param		PunOrdinal			Ordinal of the request
+ *	@param		PpParameters		Receives the response parameters
+ *
+ *	@returns	The TPM response code
+ */
+static UINT32
+TpmSimulator_ProcessTpm12(
+	_In_bytecount_(PunRequestSize)	const BYTE*				PrgbRequest,
+	_In_							unsigned int			PunRequestSize,
+	_In_							UINT32					PunOrdinal,
+	_Inout_							IfxTpmSimulatorBuffer*	PpParameters)
+{
+	UINT32 unResponseCode = TPMSIM_RC_SUCCESS;
+
+	switch (PunOrdinal)
+	{
+		case TPMSIM_ORD_STARTUP:
+			// The platform has already started the TPM
+			unResponseCode = TPMSIM_TPM_INVALID_POSTINIT;
+			break;
+		case TPMSIM_ORD_TSC_PHYSICALPRESENCE:
+		case TPMSIM_ORD_SETCAPABILITY:
+			break;
+		case TPMSIM_ORD_GETTESTRESULT:
+			TpmSimulator_PutUInt32(PpParameters, 0);
+			break;
+		case TPMSIM_ORD_GETCAPABILITY:
+		{
+			UINT32 unCapArea = TpmSimulator_GetUInt32(PrgbRequest, PunRequestSize, TPMSIM_HEADER_SIZE);
+			UINT32 unSubCap = TpmSimulator_GetUInt32(PrgbRequest, PunRequestSize, TPMSIM_HEADER_SIZE + 8);
+
+			if (TPMSIM_CAP_VERSION_VAL == unCapArea)
+				TpmSimulator_PutVersionInfo(PpParameters);
+			else if (TPMSIM_CAP_PROPERTY == unCapArea && TPMSIM_CAP_PROP_OWNER == unSubCap)
+			{
+				TpmSimulator_PutUInt32(PpParameters, 1);
+				TpmSimulator_PutUInt8(PpParameters, 0);
+			}
+			else if (TPMSIM_CAP_FLAG == unCapArea && TPMSIM_CAP_FLAG_PERMANENT == unSubCap)
+			{
+				TpmSimulator_PutUInt32(PpParameters, 22);
+				TpmSimulator_PutUInt16(PpParameters, TPMSIM_TAG_PERMANENT_FLAGS);
+				TpmSimulator_PutBytes(PpParameters, NULL, 20);
+			}
+			else if (TPMSIM_CAP_FLAG == unCapArea && TPMSIM_CAP_FLAG_VOLATILE == unSubCap)
+			{
+				TpmSimulator_PutUInt32(PpParameters, 7);
+				TpmSimulator_PutUInt16(PpParameters, TPMSIM_TAG_STCLEAR_FLAGS);
+				TpmSimulator_PutBytes(PpParameters, NULL, 5);
+			}
+			else
+				unResponseCode = TPMSIM_TPM_BAD_PARAMETER;
+			break;
+		}
+		case TPMSIM_ORD_FIELDUPGRADE:
+		{
+			BYTE bSubCommand = PunRequestSize > TPMSIM_HEADER_SIZE ? PrgbRequest[TPMSIM_HEADER_SIZE] : 0;
+			if (TPMSIM_FU_INFO_REQUEST == bSubCommand)
+			{
+				// IFX_FIELDUPGRADEINFO with wMaxDataSize at offset 12 and wFlagsFieldUpgrade at offset 18
+				TpmSimulator_PutUInt16(PpParameters, TPMSIM_FIELDUPGRADEINFO_SIZE);
+				TpmSimulator_PutBytes(PpParameters, NULL, 12);
+				TpmSimulator_PutUInt16(PpParameters, TPMSIM_MAX_DATA_SIZE);
+				TpmSimulator_PutBytes(PpParameters, NULL, 4);
+				TpmSimulator_PutUInt16(PpParameters, TPMSIM_FLAGS_DEFERRED_PP);
+			}
+			else if (TPMSIM_FU_INFO_REQUEST2 == bSubCommand)
+			{
+				IfxTpmSimulatorBuffer sSecurityModuleLogicInfo = {{0}, 0, FALSE};
+				TpmSimulator_PutSecurityModuleLogicInfo(&sSecurityModuleLogicInfo, FALSE);
+				TpmSimulator_PutUInt16(PpParameters, (UINT16)sSecurityModuleLogicInfo.unSize);
+				TpmSimulator_PutBytes(PpParameters, sSecurityModuleLogicInfo.rgbData, sSecurityModuleLogicInfo.unSize);
+			}
+			else if (TPMSIM_FU_START == bSubCommand)
+				s_sSimulator.fBootLoader = TRUE;
+			else
+				unResponseCode = TPMSIM_TPM_BAD_PARAMETER;
+			break;
+		}
+		default:
+			unResponseCode = TPMSIM_TPM_BAD_ORDINAL;
+			break;
+	}
+
+	return unResponseCode;
+}
+
+/**
+ *	@brief		Processes a command on the simulated TPM in boot loader mode
+ *	@details
+ *
+ *	@param		PrgbRequest			Request bytes
+ *	@param		PunRequestSize		Size of the request in bytes
+ *	@param		PunOrdinal			Ordinal of the request
+ *	@param		PpParameters		Receives the response parameters
+ *
+ *	@returns	The TPM response code
+ */
+static UINT32
+TpmSimulator_ProcessBootLoader(
+	_In_bytecount_(PunRequestSize)	const BYTE*				PrgbRequest,
+	_In_							unsigned int			PunRequestSize,
+	_In_							UINT32					PunOrdinal,
+	_Inout_							IfxTpmSimulatorBuffer*	PpParameters)
+{
+	UINT32 unResponseCode = TPMSIM_RC_SUCCESS;
+
+	switch (PunOrdinal)
+	{
+		case TPMSIM_ORD_STARTUP:
+			unResponseCode = TPMSIM_TPM_FAILEDSELFTEST;
+			break;
+		case TPMSIM_ORD_GETCAPABILITY:
+			if (TPMSIM_CAP_VERSION_VAL == TpmSimulator_GetUInt32(PrgbRequest, PunRequestSize, TPMSIM_HEADER_SIZE))
+				TpmSimulator_PutVersionInfo(PpParameters);
+			else
+				unResponseCode = TPMSIM_TPM_FAILEDSELFTEST;
+			break;
+		case TPMSIM_ORD_FIELDUPGRADE:
+		{
+			BYTE bSubCommand = PunRequestSize > TPMSIM_HEADER_SIZE ? PrgbRequest[TPMSIM_HEADER_SIZE] : 0;
+			if (TPMSIM_FU_INFO_REQUEST2 == bSubCommand)
+			{
+				IfxTpmSimulatorBuffer sSecurityModuleLogicInfo = {{0}, 0, FALSE};
+				TpmSimulator_PutSecurityModuleLogicInfo(&sSecurityModuleLogicInfo, FALSE);
+				TpmSimulator_PutUInt16(PpParameters, (UINT16)sSecurityModuleLogicInfo.unSize);
+				TpmSimulator_PutBytes(PpParameters, sSecurityModuleLogicInfo.rgbData, sSecurityModuleLogicInfo.unSize);
+			}
+			else if (TPMSIM_FU_UPDATE == bSubCommand)
+			{
+				// The firmware block is accepted as is
+			}
+			else if (TPMSIM_FU_COMPLETE == bSubCommand)
+			{
+				TpmSimulator_PutUInt16(PpParameters, 0);
+				s_sSimulator.fBootLoader = FALSE;
+				if (s_sSimulator.unFieldUpgradeCounter > 0)
+					s_sSimulator.unFieldUpgradeCounter--;
+			}
+			else
+				unResponseCode = TPMSIM_TPM_BAD_PARAMETER;
+			break;
+		}
+		default:
+			unResponseCode = TPMSIM_TPM_BAD_ORDINAL;
+			break;
+	}
+
+	return unResponseCode;
+}
+
+/**
+ *	@brief		Initializes the TPM simulator
+ *	@details	Reads the simulator configuration (profile, firmware version, latencies and failure injection) from the
+ *				property storage and resets the simulated TPM state.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	An invalid simulator profile, interface or firmware version is configured.
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Initialize()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
+		unsigned int unValueSize = RG_LEN(wszValue);
+		const wchar_t* wszFirmwareVersion = TPM_SIMULATOR_DEFAULT_VERSION_TPM20;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sSimulator, 0, sizeof(s_sSimulator)));
+		s_sSimulator.fTpm20 = TRUE;
+		s_sSimulator.unFieldUpgradeCounter = TPM_SIMULATOR_FIELD_UPGRADE_COUNTER;
+		s_sSimulator.unFailCode = TPM_SIMULATOR_DEFAULT_FAIL_CODE;
+
+		// Get the profile of the simulated TPM
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_SIMULATOR_PROFILE, wszValue, &unValueSize))
+		{
+			if (0 == Platform_StringCompare(wszValue, TPM_SIMULATOR_PROFILE_TPM12, RG_LEN(TPM_SIMULATOR_PROFILE_TPM12), TRUE))
+			{
+				s_sSimulator.fTpm20 = FALSE;
+				wszFirmwareVersion = TPM_SIMULATOR_DEFAULT_VERSION_TPM12;
+			}
+			else if (0 == Platform_StringCompare(wszValue, TPM_SIMULATOR_PROFILE_BOOT_LOADER, RG_LEN(TPM_SIMULATOR_PROFILE_BOOT_LOADER), TRUE))
+				s_sSimulator.fBootLoader = TRUE;
+			else if (0 != Platform_StringCompare(wszValue, TPM_SIMULATOR_PROFILE_TPM20, RG_LEN(TPM_SIMULATOR_PROFILE_TPM20), TRUE))
+			{
+				unReturnValue = RC_E_INVALID_SETTING;
+				LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid TPM simulator profile '%ls' configured.", wszValue);
+				break;
+			}
+		}
+
+		// Get the firmware version of the simulated TPM
+		unValueSize = RG_LEN(wszValue);
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_SIMULATOR_FIRMWARE_VERSION, wszValue, &unValueSize))
+			wszFirmwareVersion = wszValue;
+		unReturnValue = TpmSimulator_ParseFirmwareVersion(wszFirmwareVersion, s_sSimulator.rgunFirmwareVersion);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid TPM simulator firmware version '%ls' configured.", wszFirmwareVersion);
+			break;
+		}
+
+		// Check the interface of the simulated TPM, the TIS register interface is set up by TpmTisSimulator
+		unValueSize = RG_LEN(wszValue);
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_SIMULATOR_INTERFACE, wszValue, &unValueSize) &&
+				0 != Platform_StringCompare(wszValue, TPM_SIMULATOR_INTERFACE_COMMAND, RG_LEN(TPM_SIMULATOR_INTERFACE_COMMAND), TRUE) &&
+				0 != Platform_StringCompare(wszValue, TPM_SIMULATOR_INTERFACE_TIS, RG_LEN(TPM_SIMULATOR_INTERFACE_TIS), TRUE))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid TPM simulator interface '%ls' configured.", wszValue);
+			break;
+		}
+
+		// Get the optional key ID, latencies and failure injection settings
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_DECRYPT_KEY_ID, &s_sSimulator.unDecryptKeyId);
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_LATENCY, &s_sSimulator.unLatency);
+		s_sSimulator.unLatencyStart = s_sSimulator.unLatency;
+		s_sSimulator.unLatencyUpdate = s_sSimulator.unLatency;
+		s_sSimulator.unLatencyComplete = s_sSimulator.unLatency;
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_LATENCY_START, &s_sSimulator.unLatencyStart);
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_LATENCY_UPDATE, &s_sSimulator.unLatencyUpdate);
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_LATENCY_COMPLETE, &s_sSimulator.unLatencyComplete);
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_FAIL_COMMAND, &s_sSimulator.unFailCommand);
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_FAIL_COUNT, &s_sSimulator.unFailCount);
+		TpmSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_FAIL_CODE, &s_sSimulator.unFailCode);
+
+		LOGGING_WRITE_LEVEL2_FMT(
+			L"TPM simulator: %ls%ls firmware %d.%d.%d.%d, latency %d/%d/%d/%d us, fail command 0x%.8X occurrence %d code 0x%.8X",
+			s_sSimulator.fTpm20 ? L"TPM2.0" : L"TPM1.2", s_sSimulator.fBootLoader ? L" (boot loader)" : L"",
+			s_sSimulator.rgunFirmwareVersion[0], s_sSimulator.rgunFirmwareVersion[1], s_sSimulator.rgunFirmwareVersion[2], s_sSimulator.rgunFirmwareVersion[3],
+			s_sSimulator.unLatency, s_sSimulator.unLatencyStart, s_sSimulator.unLatencyUpdate, s_sSimulator.unLatencyComplete,
+			s_sSimulator.unFailCommand, s_sSimulator.unFailCount, s_sSimulator.unFailCode);
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Uninitializes the TPM simulator
+ *	@details
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Uninitialize()
+{
+	LOGGING_WRITE_LEVEL2_FMT(L"TPM simulator: %d commands processed", s_sSimulator.unCommandCount);
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sSimulator, 0, sizeof(s_sSimulator)));
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Executes a TPM command on the simulated TPM without spending its latency
+ *	@details	Answers the subset of TPM1.2, TPM2.0 and boot loader commands used by the firmware update and
+ *				information flows and injects the configured failure on the matching command. The configured latency
+ *				of the command is returned instead of being spent, so that the TIS register file simulator can keep
+ *				dataAvail cleared for that time.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PpunLatency				Receives the configured latency of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The response buffer is too small.
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Execute(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_Out_										unsigned int*	PpunLatency)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxTpmSimulatorBuffer sParameters = {{0}, 0, FALSE};
+		UINT16 usRequestTag = 0;
+		UINT16 usResponseTag = TPMSIM_TAG_RSP_COMMAND;
+		UINT32 unOrdinal = 0;
+		UINT32 unResponseCode = TPMSIM_RC_SUCCESS;
+		unsigned int unCommand = 0;
+		unsigned int unLatency = s_sSimulator.unLatency;
+		unsigned int unResponseSize = 0;
+		BOOL fTpm20Request = FALSE;
+
+		if (NULL == PrgbRequestBuffer || NULL == PrgbResponseBuffer || NULL == PpunResponseBufferSize || NULL == PpunLatency ||
+			PunRequestBufferSize < TPMSIM_HEADER_SIZE)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			LOGGING_WRITE_LEVEL1(L"Error: Bad parameter.");
+			break;
+		}
+
+		usRequestTag = (UINT16)((PrgbRequestBuffer[0] << 8) | PrgbRequestBuffer[1]);
+		unOrdinal = TpmSimulator_GetUInt32(PrgbRequestBuffer, PunRequestBufferSize, 6);
+		fTpm20Request = TPMSIM_ST_NO_SESSIONS == usRequestTag || TPMSIM_ST_SESSIONS == usRequestTag;
+
+		// FieldUpgrade sub commands are identified by 0xAAxx
+		unCommand = unOrdinal;
+		if (TPMSIM_ORD_FIELDUPGRADE == unOrdinal && PunRequestBufferSize > TPMSIM_HEADER_SIZE)
+			unCommand = (unOrdinal << 8) | PrgbRequestBuffer[TPMSIM_HEADER_SIZE];
+		s_sSimulator.unCommandCount++;
+
+		// Determine the command latency
+		if (TPMSIM_CC_FIELDUPGRADESTARTVENDOR == unCommand || ((TPMSIM_ORD_FIELDUPGRADE << 8) | TPMSIM_FU_START) == unCommand)
+			unLatency = s_sSimulator.unLatencyStart;
+		else if (((TPMSIM_ORD_FIELDUPGRADE << 8) | TPMSIM_FU_UPDATE) == unCommand)
+			unLatency = s_sSimulator.unLatencyUpdate;
+		else if (((TPMSIM_ORD_FIELDUPGRADE << 8) | TPMSIM_FU_COMPLETE) == unCommand)
+			unLatency = s_sSimulator.unLatencyComplete;
+		*PpunLatency = unLatency;
+
+		if (0 != s_sSimulator.unFailCount && (0 == s_sSimulator.unFailCommand || s_sSimulator.unFailCommand == unCommand) &&
+			++s_sSimulator.unFailMatches == s_sSimulator.unFailCount)
+		{
+			// Inject the configured failure
+			LOGGING_WRITE_LEVEL1_FMT(L"TPM simulator: Injecting response code 0x%.8X on command 0x%.8X (occurrence %d).", s_sSimulator.unFailCode, unCommand, s_sSimulator.unFailMatches);
+			unResponseCode = s_sSimulator.unFailCode;
+			if (fTpm20Request && s_sSimulator.fTpm20 && !s_sSimulator.fBootLoader)
+				usResponseTag = TPMSIM_ST_NO_SESSIONS;
+		}
+		else if (fTpm20Request && (s_sSimulator.fBootLoader || !s_sSimulator.fTpm20))
+			unResponseCode = TPMSIM_TPM_BADTAG;
+		else if (s_sSimulator.fBootLoader)
+			unResponseCode = TpmSimulator_ProcessBootLoader(PrgbRequestBuffer, PunRequestBufferSize, unOrdinal, &sParameters);
+		else if (s_sSimulator.fTpm20)
+			unResponseCode = TpmSimulator_ProcessTpm20(PrgbRequestBuffer, PunRequestBufferSize, usRequestTag, unOrdinal, &sParameters, &usResponseTag);
+		else
+			unResponseCode = TpmSimulator_ProcessTpm12(PrgbRequestBuffer, PunRequestBufferSize, unOrdinal, &sParameters);
+
+		if (sParameters.fOverflow)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			LOGGING_WRITE_LEVEL1(L"Error: The simulated response exceeds the parameter buffer.");
+			break;
+		}
+
+		// Error responses do not carry parameters
+		if (TPMSIM_RC_SUCCESS != unResponseCode)
+			sParameters.unSize = 0;
+
+		unResponseSize = TPMSIM_HEADER_SIZE + sParameters.unSize;
+		if (*PpunResponseBufferSize < unResponseSize)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			LOGGING_WRITE_LEVEL1(L"Error: The response buffer is too small.");
+			break;
+		}
+
+		PrgbResponseBuffer[0] = (BYTE)(usResponseTag >> 8);
+		PrgbResponseBuffer[1] = (BYTE)usResponseTag;
+		PrgbResponseBuffer[2] = (BYTE)(unResponseSize >> 24);
+		PrgbResponseBuffer[3] = (BYTE)(unResponseSize >> 16);
+		PrgbResponseBuffer[4] = (BYTE)(unResponseSize >> 8);
+		PrgbResponseBuffer[5] = (BYTE)unResponseSize;
+		PrgbResponseBuffer[6] = (BYTE)(unResponseCode >> 24);
+		PrgbResponseBuffer[7] = (BYTE)(unResponseCode >> 16);
+		PrgbResponseBuffer[8] = (BYTE)(unResponseCode >> 8);
+		PrgbResponseBuffer[9] = (BYTE)unResponseCode;
+		if (0 != sParameters.unSize)
+			IGNORE_RETURN_VALUE(Platform_MemoryCopy(&PrgbResponseBuffer[TPMSIM_HEADER_SIZE], *PpunResponseBufferSize - TPMSIM_HEADER_SIZE, sParameters.rgbData, sParameters.unSize));
+		*PpunResponseBufferSize = unResponseSize;
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Processes a TPM command on the simulated TPM
+ *	@details	Executes the command with TpmSimulator_Execute and spends the configured latency before the response
+ *				is returned.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds (unused)
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TpmSimulator_Execute
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration)
+{
+	unsigned int unLatency = 0;
+	unsigned int unReturnValue = TpmSimulator_Execute(PrgbRequestBuffer, PunRequestBufferSize, PrgbResponseBuffer, PpunResponseBufferSize, &unLatency);
+
+	UNREFERENCED_PARAMETER(PunMaxDuration);
+	UNREFERENCED_PARAMETER(PunExpectedDuration);
+
+	// Spend the command latency
+	TPMIO_CommandPending();
+	if (RC_SUCCESS == unReturnValue && 0 != unLatency)
+		Platform_SleepMicroSeconds(unLatency);
+
+	return unReturnValue;
+}
@@ -0,0 +1,124 @@
+﻿/**
+ *	@brief		Declares the TPM simulator device access functions
+ *	@details
+ *	@file		TpmDeviceAccess/TpmSimulator.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TPM_SIMULATOR_H__
+#define __TPM_SIMULATOR_H__
+
+#include "StdInclude.h"
+#include "TpmIO.h"
+
+/// Simulated TPM profile: TPM2.0 in operational mode
+#define TPM_SIMULATOR_PROFILE_TPM20			L"tpm20"
+/// Simulated TPM profile: TPM1.2 in operational mode
+#define TPM_SIMULATOR_PROFILE_TPM12			L"tpm12"
+/// Simulated TPM profile: TPM in boot loader mode (interrupted firmware update, resumes as TPM2.0)
+#define TPM_SIMULATOR_PROFILE_BOOT_LOADER	L"bootloader"
+
+/// Default firmware version of the simulated TPM2.0
+#define TPM_SIMULATOR_DEFAULT_VERSION_TPM20	L"7.63.3353.0"
+/// Default firmware version of the simulated TPM1.2
+#define TPM_SIMULATOR_DEFAULT_VERSION_TPM12	L"4.43.257.0"
+/// Default response code returned by an injected failure (TPM_FAIL)
+#define TPM_SIMULATOR_DEFAULT_FAIL_CODE		0x00000009
+/// Initial field upgrade counter of the simulated TPM
+#define TPM_SIMULATOR_FIELD_UPGRADE_COUNTER	64
+
+/// Simulated TPM interface: the TPM commands are answered directly
+#define TPM_SIMULATOR_INTERFACE_COMMAND		L"command"
+/// Simulated TPM interface: TIS FIFO register file driven by the memory based TIS engine (see TpmTisSimulator.h)
+#define TPM_SIMULATOR_INTERFACE_TIS			L"tis"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Initializes the TPM simulator
+ *	@details	Reads the simulator configuration (profile, firmware version, latencies and failure injection) from the
+ *				property storage and resets the simulated TPM state.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	An invalid simulator profile, interface or firmware version is configured.
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Initialize();
+
+/**
+ *	@brief		Uninitializes the TPM simulator
+ *	@details
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Uninitialize();
+
+/**
+ *	@brief		Executes a TPM command on the simulated TPM without spending its latency
+ *	@details	Answers the subset of TPM1.2, TPM2.0 and boot loader commands used by the firmware update and
+ *				information flows and injects the configured failure on the matching command. The configured latency
+ *				of the command is returned instead of being spent, so that the TIS register file simulator can keep
+ *				dataAvail cleared for that time.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PpunLatency				Receives the configured latency of the command in microseconds
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The response buffer is too small.
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Execute(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_Out_										unsigned int*	PpunLatency);
+
+/**
+ *	@brief		Processes a TPM command on the simulated TPM
+ *	@details	Executes the command with TpmSimulator_Execute and spends the configured latency before the response
+ *				is returned.
+ *
+ *	@param		PrgbRequestBuffer		Pointer to a byte array containing the TPM command request bytes
+ *	@param		PunRequestBufferSize	Size of command request in bytes
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds (unused)
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (unused)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from TpmSimulator_Execute
+ */
+_Check_return_
+unsigned int
+TpmSimulator_Transmit(
+	_In_bytecount_(PunRequestBufferSize)		const BYTE*		PrgbRequestBuffer,
+	_In_										unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
+	_Inout_										unsigned int*	PpunResponseBufferSize,
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__TPM_SIMULATOR_H__
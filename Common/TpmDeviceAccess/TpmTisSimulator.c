@@ -0,0 +1,833 @@
+﻿/**
+ *	@brief		Implements the TIS register file simulator
+ *	@details	Emulates the TIS FIFO registers of one locality (ACCESS, INT_ENABLE, INT_VECTOR, INT_STATUS,
+ *				INTF_CAPABILITY, STS with burstCount, DATA_FIFO, INTERFACE_ID, DID_VID and RID) in place of the /dev/mem
+ *				mapping, so that the memory based TIS engine in TPM_TIS.c, its register traffic and its wait loops run
+ *				against a deterministic TPM on any machine. The TPM commands are executed by TpmSimulator_Execute. The
+ *				configured command latency keeps dataAvail cleared, the configured ready delay keeps commandReady and a
+ *				requested locality pending, and each register access spends the configured register access cost.
+ *	@file		TpmDeviceAccess/TpmTisSimulator.c
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "TpmTisSimulator.h"
+#include "TpmSimulator.h"
+#include "TPM_TIS.h"
+#include "DeviceAccess.h"
+#include "Logging.h"
+#include "PropertyStorage.h"
+#include "Platform.h"
+#include "Session.h"
+
+/// TIS register offset of TPM_INT_ENABLE
+#define TPM_TIS_SIMULATOR_INT_ENABLE			0x00000008
+/// TIS register offset of TPM_INT_VECTOR
+#define TPM_TIS_SIMULATOR_INT_VECTOR			0x0000000C
+/// TIS register offset of TPM_INT_STATUS
+#define TPM_TIS_SIMULATOR_INT_STATUS			0x00000010
+/// TIS register offset of TPM_INTERFACE_ID
+#define TPM_TIS_SIMULATOR_INTERFACE_ID			0x00000030
+/// Width of the 32-bit TIS registers in bytes, the data FIFO accepts accesses to all four bytes
+#define TPM_TIS_SIMULATOR_REGISTER_SIZE			4
+/// Interrupt status bit dataAvailIntOccured
+#define TPM_TIS_SIMULATOR_INT_DATA_AVAIL		0x00000001
+/// Interrupt status bit stsValidIntOccured
+#define TPM_TIS_SIMULATOR_INT_STS_VALID			0x00000002
+/// Interrupt status bit localityChangeIntOccured
+#define TPM_TIS_SIMULATOR_INT_LOCALITY_CHANGE	0x00000004
+/// Interrupt status bit commandReadyIntOccured
+#define TPM_TIS_SIMULATOR_INT_COMMAND_READY		0x00000080
+/// Interface capability: PTP FIFO interface, 64 byte transfers, level high and all interrupt sources supported. The
+/// data transfer size support field (bits 9-10) is set from the configured transfer size.
+#define TPM_TIS_SIMULATOR_INTF_CAPABILITY		0x3000008F
+/// Shift of the data transfer size support field in TPM_INTF_CAPABILITY
+#define TPM_TIS_SIMULATOR_TRANSFER_SIZE_SHIFT	9
+/// Default data transfer size support: 32-bit transfers
+#define TPM_TIS_SIMULATOR_DEFAULT_TRANSFER_SIZE	3
+/// Interface identifier: FIFO interface type
+#define TPM_TIS_SIMULATOR_INTERFACE_ID_FIFO		0x00000000
+/// Device identifier of the simulated TPM2.0
+#define TPM_TIS_SIMULATOR_DID_TPM20				0x001B
+/// Revision identifier of the simulated TPM
+#define TPM_TIS_SIMULATOR_RID					0x10
+/// TPM1.2 response tag TPM_TAG_RSP_COMMAND of the response to a command the simulator cannot execute
+#define TPM_TIS_SIMULATOR_TAG_RSP_COMMAND		0x00C4
+/// Size of a TPM command and response header (tag, size, code)
+#define TPM_TIS_SIMULATOR_HEADER_SIZE			10
+/// Offset of the size field in the TPM command header
+#define TPM_TIS_SIMULATOR_SIZE_OFFSET			2
+
+/**
+ *	@brief		States of the simulated TIS (TCG PC Client TIS, TPM state machine)
+ */
+typedef enum td_ENUM_TPM_TIS_SIMULATOR_STATE
+{
+	/// No command in progress, commandReady is set after the ready delay once it has been requested
+	TPM_TIS_SIMULATOR_STATE_IDLE,
+	/// commandReady is set, the TPM accepts a command
+	TPM_TIS_SIMULATOR_STATE_READY,
+	/// The command is written to the data FIFO
+	TPM_TIS_SIMULATOR_STATE_RECEPTION,
+	/// The command is executed until the command latency has elapsed
+	TPM_TIS_SIMULATOR_STATE_EXECUTION,
+	/// The response is read from the data FIFO
+	TPM_TIS_SIMULATOR_STATE_COMPLETION
+} ENUM_TPM_TIS_SIMULATOR_STATE;
+
+/**
+ *	@brief		State of the simulated TIS register file
+ */
+typedef struct tdIfxTpmTisSimulator
+{
+	/// TRUE while the register accesses are served by the simulator
+	BOOL fOpen;
+	/// Locality of the simulated registers
+	BYTE bLocality;
+	/// Device identifier reported in DID_VID
+	UINT16 usDeviceId;
+	/// Register access cost in nanoseconds
+	unsigned int unRegisterCost;
+	/// Maximum burst count
+	unsigned int unBurstCount;
+	/// Delay until commandReady and a requested locality are granted in microseconds
+	unsigned int unReadyDelay;
+	/// Data transfer size support reported in TPM_INTF_CAPABILITY (0: legacy, 1: 8-bit, 2: 16-bit, 3: 32-bit)
+	unsigned int unTransferSize;
+	/// Width of the data FIFO accesses for the data transfer size support
+	unsigned int unFifoAccessSize;
+	/// Register access cost not yet spent in nanoseconds
+	unsigned int unCostDebt;
+	/// TRUE while the locality is requested but not yet active
+	BOOL fLocalityRequested;
+	/// TRUE while the locality is active
+	BOOL fLocalityActive;
+	/// TRUE while commandReady has been requested but not yet set
+	BOOL fReadyRequested;
+	/// Monotonic time stamp the pending locality request or commandReady transition completes
+	unsigned long long ullReadyTime;
+	/// Monotonic time stamp the command execution completes
+	unsigned long long ullCompleteTime;
+	/// Current TIS state
+	ENUM_TPM_TIS_SIMULATOR_STATE eState;
+	/// TPM_INT_ENABLE register
+	UINT32 unIntEnable;
+	/// TPM_INT_STATUS register
+	UINT32 unIntStatus;
+	/// TPM_INT_VECTOR register
+	BYTE bIntVector;
+	/// Number of command bytes received
+	unsigned int unCommandSize;
+	/// Command size given in the command header, 0 until the size field is received
+	unsigned int unExpectedSize;
+	/// Size of the response
+	unsigned int unResponseSize;
+	/// Number of response bytes read
+	unsigned int unResponsePosition;
+	/// Number of commands executed
+	unsigned int unCommandCount;
+	/// Number of register read accesses
+	unsigned long long ullRegisterReads;
+	/// Number of register write accesses
+	unsigned long long ullRegisterWrites;
+	/// Number of bytes transferred through the data FIFO
+	unsigned long long ullFifoBytes;
+	/// Number of rejected data FIFO accesses of a width the data transfer size support does not allow
+	unsigned long long ullFifoViolations;
+	/// Total register access cost in nanoseconds
+	unsigned long long ullRegisterCost;
+	/// Command received through the data FIFO
+	BYTE rgbCommand[TPM_TIS_SIMULATOR_BUFFER_SIZE];
+	/// Response read through the data FIFO
+	BYTE rgbResponse[TPM_TIS_SIMULATOR_BUFFER_SIZE];
+} IfxTpmTisSimulator;
+
+/// The simulated TIS register file
+static IfxTpmTisSimulator s_sTisSimulator = {0};
+
+/**
+ *	@brief		Reads an optional numeric simulator setting
+ *	@details	The value is left unchanged if the setting is not configured.
+ *
+ *	@param		PwszKey			Property key of the setting
+ *	@param		PpunValue		In: default value, Out: configured value
+ */
+static void
+TpmTisSimulator_GetSetting(
+	_In_z_	const wchar_t*	PwszKey,
+	_Inout_	unsigned int*	PpunValue)
+{
+	unsigned int unValue = 0;
+	if (PropertyStorage_GetUIntegerValueByKey(PwszKey, &unValue))
+		*PpunValue = unValue;
+}
+
+/**
+ *	@brief		Sets an interrupt status bit if the interrupt is enabled
+ *
+ *	@param		PunInterrupt	Interrupt status bit
+ */
+static void
+TpmTisSimulator_RaiseInterrupt(
+	_In_	UINT32	PunInterrupt)
+{
+	if (0 != (s_sTisSimulator.unIntEnable & PunInterrupt))
+		s_sTisSimulator.unIntStatus |= PunInterrupt;
+}
+
+/**
+ *	@brief		Spends the register access cost of one access
+ *	@details	The cost is accumulated in nanoseconds and spent by spinning on the monotonic clock once a full
+ *				microsecond is due, like a CPU stalled by an uncached register access.
+ */
+static void
+TpmTisSimulator_SpendCost()
+{
+	unsigned long long ullTarget = 0;
+
+	s_sTisSimulator.ullRegisterCost += s_sTisSimulator.unRegisterCost;
+	s_sTisSimulator.unCostDebt += s_sTisSimulator.unRegisterCost;
+	if (s_sTisSimulator.unCostDebt < 1000)
+		return;
+
+	ullTarget = Platform_GetMonotonicTimeMicroSeconds() + s_sTisSimulator.unCostDebt / 1000;
+	s_sTisSimulator.unCostDebt %= 1000;
+	while (Platform_GetMonotonicTimeMicroSeconds() < ullTarget)
+	{
+		// Spin like a stalled register access
+	}
+}
+
+/**
+ *	@brief		Completes the pending locality request, commandReady transition and command execution
+ *	@details	The clock is only read while a transition is pending.
+ */
+static void
+TpmTisSimulator_Advance()
+{
+	unsigned long long ullNow = 0;
+
+	if (!s_sTisSimulator.fLocalityRequested && !s_sTisSimulator.fReadyRequested && TPM_TIS_SIMULATOR_STATE_EXECUTION != s_sTisSimulator.eState)
+		return;
+
+	ullNow = Platform_GetMonotonicTimeMicroSeconds();
+	if (s_sTisSimulator.fLocalityRequested && ullNow >= s_sTisSimulator.ullReadyTime)
+	{
+		s_sTisSimulator.fLocalityRequested = FALSE;
+		s_sTisSimulator.fLocalityActive = TRUE;
+		TpmTisSimulator_RaiseInterrupt(TPM_TIS_SIMULATOR_INT_LOCALITY_CHANGE);
+	}
+	if (s_sTisSimulator.fReadyRequested && ullNow >= s_sTisSimulator.ullReadyTime)
+	{
+		s_sTisSimulator.fReadyRequested = FALSE;
+		s_sTisSimulator.eState = TPM_TIS_SIMULATOR_STATE_READY;
+		TpmTisSimulator_RaiseInterrupt(TPM_TIS_SIMULATOR_INT_COMMAND_READY);
+	}
+	if (TPM_TIS_SIMULATOR_STATE_EXECUTION == s_sTisSimulator.eState && ullNow >= s_sTisSimulator.ullCompleteTime)
+	{
+		s_sTisSimulator.eState = TPM_TIS_SIMULATOR_STATE_COMPLETION;
+		TpmTisSimulator_RaiseInterrupt(TPM_TIS_SIMULATOR_INT_DATA_AVAIL | TPM_TIS_SIMULATOR_INT_STS_VALID);
+	}
+}
+
+/**
+ *	@brief		Returns to the idle state and requests commandReady
+ *	@details	A command in reception, execution or completion is discarded. commandReady is set after the ready delay.
+ */
+static void
+TpmTisSimulator_RequestReady()
+{
+	s_sTisSimulator.unCommandSize = 0;
+	s_sTisSimulator.unExpectedSize = 0;
+	s_sTisSimulator.unResponseSize = 0;
+	s_sTisSimulator.unResponsePosition = 0;
+	s_sTisSimulator.eState = TPM_TIS_SIMULATOR_STATE_IDLE;
+	s_sTisSimulator.fReadyRequested = TRUE;
+	s_sTisSimulator.ullReadyTime = Platform_GetMonotonicTimeMicroSeconds() + s_sTisSimulator.unReadyDelay;
+	TpmTisSimulator_Advance();
+}
+
+/**
+ *	@brief		Executes the received command
+ *	@details	dataAvail is set once the command latency has elapsed. A command the simulated TPM cannot execute is
+ *				answered with the default failure response code.
+ */
+static void
+TpmTisSimulator_Execute()
+{
+	unsigned int unLatency = 0;
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	s_sTisSimulator.unCommandCount++;
+	s_sTisSimulator.unResponseSize = sizeof(s_sTisSimulator.rgbResponse);
+	s_sTisSimulator.unResponsePosition = 0;
+	unReturnValue = TpmSimulator_Execute(s_sTisSimulator.rgbCommand, s_sTisSimulator.unCommandSize, s_sTisSimulator.rgbResponse, &s_sTisSimulator.unResponseSize, &unLatency);
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"TIS simulator: Executing the command failed (0x%.8X).", unReturnValue);
+		s_sTisSimulator.unResponseSize = TPM_TIS_SIMULATOR_HEADER_SIZE;
+		IGNORE_RETURN_VALUE(Platform_MemorySet(s_sTisSimulator.rgbResponse, 0, TPM_TIS_SIMULATOR_HEADER_SIZE));
+		s_sTisSimulator.rgbResponse[0] = (BYTE)(TPM_TIS_SIMULATOR_TAG_RSP_COMMAND >> 8);
+		s_sTisSimulator.rgbResponse[1] = (BYTE)TPM_TIS_SIMULATOR_TAG_RSP_COMMAND;
+		s_sTisSimulator.rgbResponse[5] = TPM_TIS_SIMULATOR_HEADER_SIZE;
+		s_sTisSimulator.rgbResponse[9] = (BYTE)TPM_SIMULATOR_DEFAULT_FAIL_CODE;
+	}
+
+	s_sTisSimulator.eState = TPM_TIS_SIMULATOR_STATE_EXECUTION;
+	s_sTisSimulator.ullCompleteTime = Platform_GetMonotonicTimeMicroSeconds() + unLatency;
+	TpmTisSimulator_Advance();
+}
+
+/**
+ *	@brief		Returns the current burst count
+ *	@details	While a command is received the burst count is the free space of the command buffer, while the
+ *				response is read it is the number of response bytes left. Both are limited to the configured burst
+ *				count.
+ *
+ *	@returns	Burst count
+ */
+static unsigned int
+TpmTisSimulator_GetBurstCount()
+{
+	unsigned int unBurstCount = 0;
+
+	if (TPM_TIS_SIMULATOR_STATE_READY == s_sTisSimulator.eState || TPM_TIS_SIMULATOR_STATE_RECEPTION == s_sTisSimulator.eState)
+		unBurstCount = TPM_TIS_SIMULATOR_BUFFER_SIZE - s_sTisSimulator.unCommandSize;
+	else if (TPM_TIS_SIMULATOR_STATE_COMPLETION == s_sTisSimulator.eState)
+		unBurstCount = s_sTisSimulator.unResponseSize - s_sTisSimulator.unResponsePosition;
+
+	return unBurstCount < s_sTisSimulator.unBurstCount ? unBurstCount : s_sTisSimulator.unBurstCount;
+}
+
+/**
+ *	@brief		Returns the current value of the STS register
+ *
+ *	@returns	STS register value
+ */
+static BYTE
+TpmTisSimulator_GetStatus()
+{
+	BYTE bStatus = TIS_TPM_STS_VALID;
+
+	switch (s_sTisSimulator.eState)
+	{
+		case TPM_TIS_SIMULATOR_STATE_READY:
+			bStatus |= TIS_TPM_STS_CMDRDY;
+			break;
+		case TPM_TIS_SIMULATOR_STATE_RECEPTION:
+			if (0 == s_sTisSimulator.unExpectedSize || s_sTisSimulator.unCommandSize < s_sTisSimulator.unExpectedSize)
+				bStatus |= TIS_TPM_STS_EXPECT;
+			break;
+		case TPM_TIS_SIMULATOR_STATE_COMPLETION:
+			if (s_sTisSimulator.unResponsePosition < s_sTisSimulator.unResponseSize)
+				bStatus |= TIS_TPM_STS_AVAIL;
+			break;
+		default:
+			break;
+	}
+
+	return bStatus;
+}
+
+/**
+ *	@brief		Returns a byte of a 32-bit register value
+ *
+ *	@param		PunValue		Register value
+ *	@param		PunOffset		Offset of the accessed byte
+ *	@param		PunRegister		Offset of the register
+ *	@returns	Byte of the register value
+ */
+static BYTE
+TpmTisSimulator_GetRegisterByte(
+	_In_	UINT32			PunValue,
+	_In_	unsigned int	PunOffset,
+	_In_	unsigned int	PunRegister)
+{
+	return (BYTE)(PunValue >> (8 * (PunOffset - PunRegister)));
+}
+
+/**
+ *	@brief		Checks whether a byte offset lies within a 32-bit register
+ *
+ *	@param		PunOffset		Offset of the accessed byte
+ *	@param		PunRegister		Offset of the register
+ *	@returns	TRUE if the byte belongs to the register, FALSE otherwise
+ */
+static BOOL
+TpmTisSimulator_IsRegister(
+	_In_	unsigned int	PunOffset,
+	_In_	unsigned int	PunRegister)
+{
+	return PunOffset >= PunRegister && PunOffset < PunRegister + TPM_TIS_SIMULATOR_REGISTER_SIZE;
+}
+
+/**
+ *	@brief		Reads one byte of the simulated register file
+ *	@details	STS, burstCount and the data FIFO of a locality that is not active read as all ones.
+ *
+ *	@param		PunOffset		Register offset within the locality
+ *	@returns	Register byte
+ */
+static BYTE
+TpmTisSimulator_ReadByte(
+	_In_	unsigned int	PunOffset)
+{
+	BYTE bValue = 0xFF;
+
+	if (TIS_TPM_ACCESS == PunOffset)
+		bValue = TIS_TPM_ACCESS_VALID | TIS_TPM_ACCESS_ESTABLISHMENT | (s_sTisSimulator.fLocalityActive ? TIS_TPM_ACCESS_ACTIVELOCALITY : 0);
+	else if (TpmTisSimulator_IsRegister(PunOffset, TPM_TIS_SIMULATOR_INT_ENABLE))
+		bValue = TpmTisSimulator_GetRegisterByte(s_sTisSimulator.unIntEnable, PunOffset, TPM_TIS_SIMULATOR_INT_ENABLE);
+	else if (TpmTisSimulator_IsRegister(PunOffset, TPM_TIS_SIMULATOR_INT_VECTOR))
+		bValue = TpmTisSimulator_GetRegisterByte(s_sTisSimulator.bIntVector, PunOffset, TPM_TIS_SIMULATOR_INT_VECTOR);
+	else if (TpmTisSimulator_IsRegister(PunOffset, TPM_TIS_SIMULATOR_INT_STATUS))
+		bValue = TpmTisSimulator_GetRegisterByte(s_sTisSimulator.unIntStatus, PunOffset, TPM_TIS_SIMULATOR_INT_STATUS);
+	else if (TpmTisSimulator_IsRegister(PunOffset, TIS_TPM_INTF_CAPABILITY))
+		bValue = TpmTisSimulator_GetRegisterByte(TPM_TIS_SIMULATOR_INTF_CAPABILITY | (s_sTisSimulator.unTransferSize << TPM_TIS_SIMULATOR_TRANSFER_SIZE_SHIFT), PunOffset, TIS_TPM_INTF_CAPABILITY);
+	else if (TpmTisSimulator_IsRegister(PunOffset, TPM_TIS_SIMULATOR_INTERFACE_ID))
+		bValue = TpmTisSimulator_GetRegisterByte(TPM_TIS_SIMULATOR_INTERFACE_ID_FIFO, PunOffset, TPM_TIS_SIMULATOR_INTERFACE_ID);
+	else if (TpmTisSimulator_IsRegister(PunOffset, TIS_TPM_VID))
+		bValue = TpmTisSimulator_GetRegisterByte(((UINT32)s_sTisSimulator.usDeviceId << 16) | TIS_TPM_VID_IFX, PunOffset, TIS_TPM_VID);
+	else if (TIS_TPM_RID == PunOffset)
+		bValue = TPM_TIS_SIMULATOR_RID;
+	else if (!s_sTisSimulator.fLocalityActive)
+		bValue = 0xFF;
+	else if (TIS_TPM_STS == PunOffset)
+		bValue = TpmTisSimulator_GetStatus();
+	else if (TIS_TPM_BURSTCOUNT == PunOffset || TIS_TPM_BURSTCOUNT + 1 == PunOffset)
+		bValue = TpmTisSimulator_GetRegisterByte(TpmTisSimulator_GetBurstCount(), PunOffset, TIS_TPM_BURSTCOUNT);
+	else if (TIS_TPM_BURSTCOUNT + 2 == PunOffset)
+		bValue = 0;
+	else if (TpmTisSimulator_IsRegister(PunOffset, TIS_TPM_DATA_FIFO))
+	{
+		// The response can be read while dataAvail is set, further reads return all ones
+		if (TPM_TIS_SIMULATOR_STATE_COMPLETION == s_sTisSimulator.eState && s_sTisSimulator.unResponsePosition < s_sTisSimulator.unResponseSize)
+		{
+			bValue = s_sTisSimulator.rgbResponse[s_sTisSimulator.unResponsePosition++];
+			s_sTisSimulator.ullFifoBytes++;
+		}
+	}
+
+	return bValue;
+}
+
+/**
+ *	@brief		Writes one byte of the simulated register file
+ *	@details	STS and the data FIFO of a locality that is not active ignore writes.
+ *
+ *	@param		PunOffset		Register offset within the locality
+ *	@param		PbValue			Register byte
+ */
+static void
+TpmTisSimulator_WriteByte(
+	_In_	unsigned int	PunOffset,
+	_In_	BYTE			PbValue)
+{
+	if (TIS_TPM_ACCESS == PunOffset)
+	{
+		if (0 != (PbValue & TIS_TPM_ACCESS_ACTIVELOCALITY))
+		{
+			// Relinquish the locality, a command in progress is discarded
+			s_sTisSimulator.fLocalityActive = FALSE;
+			s_sTisSimulator.fLocalityRequested = FALSE;
+			s_sTisSimulator.fReadyRequested = FALSE;
+			s_sTisSimulator.eState = TPM_TIS_SIMULATOR_STATE_IDLE;
+		}
+		else if (0 != (PbValue & TIS_TPM_ACCESS_REQUESTUSE) && !s_sTisSimulator.fLocalityActive && !s_sTisSimulator.fLocalityRequested)
+		{
+			s_sTisSimulator.fLocalityRequested = TRUE;
+			s_sTisSimulator.ullReadyTime = Platform_GetMonotonicTimeMicroSeconds() + s_sTisSimulator.unReadyDelay;
+			TpmTisSimulator_Advance();
+		}
+	}
+	else if (TpmTisSimulator_IsRegister(PunOffset, TPM_TIS_SIMULATOR_INT_ENABLE))
+	{
+		s_sTisSimulator.unIntEnable &= ~((UINT32)0xFF << (8 * (PunOffset - TPM_TIS_SIMULATOR_INT_ENABLE)));
+		s_sTisSimulator.unIntEnable |= (UINT32)PbValue << (8 * (PunOffset - TPM_TIS_SIMULATOR_INT_ENABLE));
+	}
+	else if (TPM_TIS_SIMULATOR_INT_VECTOR == PunOffset)
+		s_sTisSimulator.bIntVector = PbValue;
+	else if (TpmTisSimulator_IsRegister(PunOffset, TPM_TIS_SIMULATOR_INT_STATUS))
+	{
+		// Interrupt status bits are cleared by writing 1
+		s_sTisSimulator.unIntStatus &= ~((UINT32)PbValue << (8 * (PunOffset - TPM_TIS_SIMULATOR_INT_STATUS)));
+	}
+	else if (!s_sTisSimulator.fLocalityActive)
+	{
+		// Writes to the STS and data FIFO registers of a locality which is not active are ignored
+	}
+	else if (TIS_TPM_STS == PunOffset)
+	{
+		if (0 != (PbValue & TIS_TPM_STS_CMDRDY))
+		{
+			if (TPM_TIS_SIMULATOR_STATE_READY != s_sTisSimulator.eState && !s_sTisSimulator.fReadyRequested)
+				TpmTisSimulator_RequestReady();
+		}
+		else if (0 != (PbValue & TIS_TPM_STS_GO))
+		{
+			if (TPM_TIS_SIMULATOR_STATE_RECEPTION == s_sTisSimulator.eState && 0 != s_sTisSimulator.unExpectedSize &&
+					s_sTisSimulator.unCommandSize == s_sTisSimulator.unExpectedSize)
+				TpmTisSimulator_Execute();
+		}
+		else if (0 != (PbValue & TIS_TPM_STS_RETRY))
+		{
+			// Let the TPM repeat the response
+			if (TPM_TIS_SIMULATOR_STATE_COMPLETION == s_sTisSimulator.eState)
+				s_sTisSimulator.unResponsePosition = 0;
+		}
+	}
+	else if (TpmTisSimulator_IsRegister(PunOffset, TIS_TPM_DATA_FIFO))
+	{
+		if ((TPM_TIS_SIMULATOR_STATE_READY == s_sTisSimulator.eState || TPM_TIS_SIMULATOR_STATE_RECEPTION == s_sTisSimulator.eState) &&
+				(0 == s_sTisSimulator.unExpectedSize || s_sTisSimulator.unCommandSize < s_sTisSimulator.unExpectedSize) &&
+				s_sTisSimulator.unCommandSize < TPM_TIS_SIMULATOR_BUFFER_SIZE)
+		{
+			s_sTisSimulator.eState = TPM_TIS_SIMULATOR_STATE_RECEPTION;
+			s_sTisSimulator.rgbCommand[s_sTisSimulator.unCommandSize++] = PbValue;
+			s_sTisSimulator.ullFifoBytes++;
+
+			// The command size is known once the size field of the header has been received
+			if (TPM_TIS_SIMULATOR_SIZE_OFFSET + sizeof(UINT32) == s_sTisSimulator.unCommandSize)
+			{
+				const BYTE* pbSize = &s_sTisSimulator.rgbCommand[TPM_TIS_SIMULATOR_SIZE_OFFSET];
+				s_sTisSimulator.unExpectedSize = ((unsigned int)pbSize[0] << 24) | ((unsigned int)pbSize[1] << 16) | ((unsigned int)pbSize[2] << 8) | pbSize[3];
+				if (s_sTisSimulator.unExpectedSize < s_sTisSimulator.unCommandSize || s_sTisSimulator.unExpectedSize > TPM_TIS_SIMULATOR_BUFFER_SIZE)
+					s_sTisSimulator.unExpectedSize = TPM_TIS_SIMULATOR_BUFFER_SIZE;
+			}
+			if (s_sTisSimulator.unCommandSize == s_sTisSimulator.unExpectedSize)
+				TpmTisSimulator_RaiseInterrupt(TPM_TIS_SIMULATOR_INT_STS_VALID);
+		}
+	}
+}
+
+/**
+ *	@brief		Translates a register address to the offset within the simulated locality
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the access in bytes
+ *	@param		PpunOffset			Receives the register offset within the locality
+ *	@retval		TRUE				The access lies within the registers of the simulated locality.
+ *	@retval		FALSE				Otherwise.
+ */
+_Check_return_
+static BOOL
+TpmTisSimulator_GetOffset(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunOffset)
+{
+	*PpunOffset = 0;
+	return s_sTisSimulator.fOpen && DeviceAccess_GetWindowOffset(PunMemoryAddress, PunSize, PpunOffset);
+}
+
+/**
+ *	@brief		Checks the width of a register access against the data transfer size support
+ *	@details	A data FIFO access wider than the reported data transfer size support allows is rejected and counted.
+ *
+ *	@param		PunOffset		Register offset within the locality
+ *	@param		PunSize			Size of the access in bytes
+ *	@retval		TRUE			The access is allowed.
+ *	@retval		FALSE			The access is a data FIFO access of a width the TPM does not support.
+ */
+static BOOL
+TpmTisSimulator_IsAccessWidthAllowed(
+	_In_	unsigned int	PunOffset,
+	_In_	unsigned int	PunSize)
+{
+	if (PunSize <= s_sTisSimulator.unFifoAccessSize || PunOffset >= TIS_TPM_DATA_FIFO + TPM_TIS_SIMULATOR_REGISTER_SIZE ||
+			PunOffset + PunSize <= TIS_TPM_DATA_FIFO)
+		return TRUE;
+
+	s_sTisSimulator.ullFifoViolations++;
+	LOGGING_WRITE_LEVEL1_FMT(L"TIS simulator: Rejected a %u byte data FIFO access, the data transfer size support %u allows %u byte accesses.",
+		PunSize, s_sTisSimulator.unTransferSize, s_sTisSimulator.unFifoAccessSize);
+	return FALSE;
+}
+
+/**
+ *	@brief		Read a simulated TIS register of up to 32 bits
+ *	@details	The TIS registers are little endian. Each call is one register access and costs the configured
+ *				register access time.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunSize				Size of the access in bytes
+ *	@param		PpunValue			Receives the register value
+ *	@retval		TRUE				The register was read.
+ *	@retval		FALSE				The access lies outside the registers of the simulated locality or is too wide.
+ */
+_Check_return_
+static BOOL
+TpmTisSimulator_ReadRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunSize,
+	_Out_	unsigned int*	PpunValue)
+{
+	unsigned int unOffset = 0;
+	unsigned int unIndex = 0;
+
+	if (PunSize > sizeof(UINT32) || !TpmTisSimulator_GetOffset(PunMemoryAddress, PunSize, &unOffset) ||
+			!TpmTisSimulator_IsAccessWidthAllowed(unOffset, PunSize))
+		return FALSE;
+
+	s_sTisSimulator.ullRegisterReads++;
+	TpmTisSimulator_SpendCost();
+	TpmTisSimulator_Advance();
+	*PpunValue = 0;
+	for (unIndex = 0; unIndex < PunSize; unIndex++)
+		*PpunValue |= (unsigned int)TpmTisSimulator_ReadByte(unOffset + unIndex) << (8 * unIndex);
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Write a simulated TIS register of up to 32 bits
+ *	@details	The TIS registers are little endian. Each call is one register access and costs the configured
+ *				register access time.
+ *
+ *	@param		PunMemoryAddress	Register address (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PunData				Register value
+ *	@param		PunSize				Size of the access in bytes
+ *	@retval		TRUE				The register was written.
+ *	@retval		FALSE				The access lies outside the registers of the simulated locality or is too wide.
+ */
+_Check_return_
+static BOOL
+TpmTisSimulator_WriteRegister(
+	_In_	unsigned int	PunMemoryAddress,
+	_In_	unsigned int	PunData,
+	_In_	unsigned int	PunSize)
+{
+	unsigned int unOffset = 0;
+	unsigned int unIndex = 0;
+
+	if (PunSize > sizeof(UINT32) || !TpmTisSimulator_GetOffset(PunMemoryAddress, PunSize, &unOffset) ||
+			!TpmTisSimulator_IsAccessWidthAllowed(unOffset, PunSize))
+		return FALSE;
+
+	s_sTisSimulator.ullRegisterWrites++;
+	TpmTisSimulator_SpendCost();
+	TpmTisSimulator_Advance();
+	for (unIndex = 0; unIndex < PunSize; unIndex++)
+		TpmTisSimulator_WriteByte(unOffset + unIndex, (BYTE)(PunData >> (8 * unIndex)));
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Read or write simulated TIS registers
+ *	@details	The simulated register file is accessed with the same access widths as the mapped registers: a FIFO
+ *				register with accesses of PbAccessSize bytes as long as enough bytes are left, consecutive registers
+ *				with single byte accesses. A FIFO transfer must use the width of the reported data transfer size
+ *				support, so a TIS engine that does not use the widest supported access is detected as well.
+ *
+ *	@param		PunMemoryAddress	Start address of the registers (relative to TPM_DEFAULT_MEM_BASE)
+ *	@param		PrgbData			Data to be written or buffer for the read data
+ *	@param		PunSize				Number of bytes to be transferred
+ *	@param		PbAccessSize		Maximum width of a single FIFO register access (sizeof(BYTE), sizeof(UINT16) or sizeof(UINT32))
+ *	@param		PfRead				TRUE to read the registers, FALSE to write them
+ *	@param		PfFifo				TRUE to access the same address with all accesses (FIFO register)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	The access lies outside the registers of the simulated locality or the FIFO access width
+ *									does not match the data transfer size support.
+ */
+_Check_return_
+static unsigned int
+TpmTisSimulator_TransferRegisters(
+	_In_						unsigned int	PunMemoryAddress,
+	_Inout_bytecap_(PunSize)	BYTE*			PrgbData,
+	_In_						unsigned int	PunSize,
+	_In_						BYTE			PbAccessSize,
+	_In_						BOOL			PfRead,
+	_In_						BOOL			PfFifo)
+{
+	unsigned int unOffset = 0;
+	unsigned int unPosition = 0;
+
+	if (!TpmTisSimulator_GetOffset(PunMemoryAddress, PfFifo ? PbAccessSize : PunSize, &unOffset))
+		return RC_E_BAD_PARAMETER;
+
+	if (PfFifo && TIS_TPM_DATA_FIFO == unOffset && PbAccessSize != s_sTisSimulator.unFifoAccessSize)
+	{
+		s_sTisSimulator.ullFifoViolations++;
+		LOGGING_WRITE_LEVEL1_FMT(L"TIS simulator: Rejected a data FIFO transfer with %u byte accesses, the data transfer size support %u requires %u byte accesses.",
+			PbAccessSize, s_sTisSimulator.unTransferSize, s_sTisSimulator.unFifoAccessSize);
+		return RC_E_BAD_PARAMETER;
+	}
+
+	if (PfFifo && sizeof(BYTE) != PbAccessSize)
+	{
+		for (; PunSize - unPosition >= PbAccessSize; unPosition += PbAccessSize)
+		{
+			unsigned int unData = 0;
+			unsigned int unIndex = 0;
+			if (PfRead)
+			{
+				IGNORE_RETURN_VALUE(TpmTisSimulator_ReadRegister(PunMemoryAddress, PbAccessSize, &unData));
+				for (unIndex = 0; unIndex < PbAccessSize; unIndex++)
+					PrgbData[unPosition + unIndex] = (BYTE)(unData >> (8 * unIndex));
+			}
+			else
+			{
+				for (unIndex = 0; unIndex < PbAccessSize; unIndex++)
+					unData |= (unsigned int)PrgbData[unPosition + unIndex] << (8 * unIndex);
+				IGNORE_RETURN_VALUE(TpmTisSimulator_WriteRegister(PunMemoryAddress, unData, PbAccessSize));
+			}
+		}
+	}
+	for (; unPosition < PunSize; unPosition++)
+	{
+		unsigned int unAddress = PunMemoryAddress + (PfFifo ? 0 : unPosition);
+		unsigned int unData = 0;
+		if (PfRead)
+		{
+			IGNORE_RETURN_VALUE(TpmTisSimulator_ReadRegister(unAddress, sizeof(BYTE), &unData));
+			PrgbData[unPosition] = (BYTE)unData;
+		}
+		else
+		{
+			IGNORE_RETURN_VALUE(TpmTisSimulator_WriteRegister(unAddress, PrgbData[unPosition], sizeof(BYTE)));
+		}
+	}
+
+	return RC_SUCCESS;
+}
+
+/// Register access functions of the TIS register file simulator
+static const IfxDeviceAccessOps s_sTisSimulatorRegisterOps = {TpmTisSimulator_ReadRegister, TpmTisSimulator_WriteRegister, TpmTisSimulator_TransferRegisters};
+
+/**
+ *	@brief		Check whether the simulator is configured with the TIS register interface
+ *
+ *	@retval		TRUE	PROPERTY_TPM_SIMULATOR_INTERFACE is set to TPM_SIMULATOR_INTERFACE_TIS.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+TpmTisSimulator_IsSelected()
+{
+	wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
+	unsigned int unValueSize = RG_LEN(wszValue);
+
+	return PropertyStorage_GetValueByKey(PROPERTY_TPM_SIMULATOR_INTERFACE, wszValue, &unValueSize) &&
+		0 == Platform_StringCompare(wszValue, TPM_SIMULATOR_INTERFACE_TIS, RG_LEN(TPM_SIMULATOR_INTERFACE_TIS), TRUE);
+}
+
+/**
+ *	@brief		Initialize the TIS register file simulator
+ *	@details	Reads the register access cost, burst count, ready delay and data transfer size support from the property
+ *				storage and resets the register file of the given locality. The register accesses of DeviceAccess are
+ *				served by the simulator from then on, the TPM commands are executed by TpmSimulator_Execute.
+ *
+ *	@param		PbLocality					Locality value
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	The locality is not supported.
+ *	@retval		RC_E_INVALID_SETTING		The configured burst count or data transfer size support is invalid.
+ */
+_Check_return_
+unsigned int
+TpmTisSimulator_Initialize(
+	_In_	BYTE	PbLocality)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszValue[PROPERTY_STORAGE_MAX_VALUE] = {0};
+		unsigned int unValueSize = RG_LEN(wszValue);
+
+		if (PbLocality > DEVICE_ACCESS_MAX_LOCALITY)
+		{
+			unReturnValue = RC_E_LOCALITY_NOT_SUPPORTED;
+			break;
+		}
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sTisSimulator, 0, sizeof(s_sTisSimulator)));
+		s_sTisSimulator.bLocality = PbLocality;
+		s_sTisSimulator.unBurstCount = TPM_TIS_SIMULATOR_DEFAULT_BURST_COUNT;
+		s_sTisSimulator.unTransferSize = TPM_TIS_SIMULATOR_DEFAULT_TRANSFER_SIZE;
+		s_sTisSimulator.usDeviceId = TPM_TIS_SIMULATOR_DID_TPM20;
+		if (PropertyStorage_GetValueByKey(PROPERTY_TPM_SIMULATOR_PROFILE, wszValue, &unValueSize) &&
+				0 == Platform_StringCompare(wszValue, TPM_SIMULATOR_PROFILE_TPM12, RG_LEN(TPM_SIMULATOR_PROFILE_TPM12), TRUE))
+			s_sTisSimulator.usDeviceId = TIS_TPM_DID_TPM12;
+
+		TpmTisSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_REGISTER_COST, &s_sTisSimulator.unRegisterCost);
+		TpmTisSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_BURST_COUNT, &s_sTisSimulator.unBurstCount);
+		TpmTisSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_READY_DELAY, &s_sTisSimulator.unReadyDelay);
+		TpmTisSimulator_GetSetting(PROPERTY_TPM_SIMULATOR_TRANSFER_SIZE, &s_sTisSimulator.unTransferSize);
+		if (0 == s_sTisSimulator.unBurstCount || s_sTisSimulator.unBurstCount > 0xFFFF)
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid TIS simulator burst count %u configured.", s_sTisSimulator.unBurstCount);
+			break;
+		}
+		if (s_sTisSimulator.unTransferSize > TPM_TIS_SIMULATOR_DEFAULT_TRANSFER_SIZE)
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			LOGGING_WRITE_LEVEL1_FMT(L"Error: Invalid TIS simulator data transfer size %u configured.", s_sTisSimulator.unTransferSize);
+			break;
+		}
+
+		// 11b allows 32-bit and 10b 16-bit data FIFO accesses, 01b (8-bit) and 00b (legacy) single byte accesses only
+		if (3 == s_sTisSimulator.unTransferSize)
+			s_sTisSimulator.unFifoAccessSize = sizeof(UINT32);
+		else if (2 == s_sTisSimulator.unTransferSize)
+			s_sTisSimulator.unFifoAccessSize = sizeof(UINT16);
+		else
+			s_sTisSimulator.unFifoAccessSize = sizeof(BYTE);
+
+		Session_GetCurrent()->unMemoryOffset = (unsigned int)PbLocality * DEVICE_ACCESS_LOCALITY_SIZE;
+		s_sTisSimulator.fOpen = TRUE;
+		DeviceAccess_BindRegisters(&s_sTisSimulatorRegisterOps);
+
+		LOGGING_WRITE_LEVEL2_FMT(L"TIS simulator: locality %d, register access cost %u ns, burst count %u, ready delay %u us, data transfer size %u",
+			PbLocality, s_sTisSimulator.unRegisterCost, s_sTisSimulator.unBurstCount, s_sTisSimulator.unReadyDelay, s_sTisSimulator.unTransferSize);
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Uninitialize the TIS register file simulator
+ *	@details	Logs the register access statistics.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_INTERNAL	The simulator is not initialized.
+ */
+_Check_return_
+unsigned int
+TpmTisSimulator_Uninitialize()
+{
+	if (!s_sTisSimulator.fOpen)
+		return RC_E_INTERNAL;
+
+	LOGGING_WRITE_LEVEL2_FMT(L"TIS simulator: %u commands, %llu register reads, %llu register writes, %llu FIFO bytes, %llu rejected FIFO accesses, %llu us register access cost",
+		s_sTisSimulator.unCommandCount, s_sTisSimulator.ullRegisterReads, s_sTisSimulator.ullRegisterWrites, s_sTisSimulator.ullFifoBytes,
+		s_sTisSimulator.ullFifoViolations, s_sTisSimulator.ullRegisterCost / 1000);
+	DeviceAccess_BindRegisters(NULL);
+	Session_GetCurrent()->unMemoryOffset = 0;
+	s_sTisSimulator.fOpen = FALSE;
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Check whether the TIS registers are served by the simulator
+ *
+ *	@retval		TRUE	TpmTisSimulator_Initialize initialized the simulator.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+TpmTisSimulator_IsOpen()
+{
+	return s_sTisSimulator.fOpen;
+}
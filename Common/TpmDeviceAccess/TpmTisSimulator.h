@@ -0,0 +1,81 @@
+﻿/**
+ *	@brief		Declares the TIS register file simulator
+ *	@details
+ *	@file		TpmDeviceAccess/TpmTisSimulator.h
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __TPM_TIS_SIMULATOR_H__
+#define __TPM_TIS_SIMULATOR_H__
+
+#include "StdInclude.h"
+
+/// Default maximum burst count reported by the simulated TIS
+#define TPM_TIS_SIMULATOR_DEFAULT_BURST_COUNT	64
+/// Size of the command and response buffers of the simulated TIS (the TIS transfers up to 0xFFFF bytes)
+#define TPM_TIS_SIMULATOR_BUFFER_SIZE			0x10000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Check whether the simulator is configured with the TIS register interface
+ *
+ *	@retval		TRUE	PROPERTY_TPM_SIMULATOR_INTERFACE is set to TPM_SIMULATOR_INTERFACE_TIS.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+TpmTisSimulator_IsSelected();
+
+/**
+ *	@brief		Initialize the TIS register file simulator
+ *	@details	Reads the register access cost, burst count, ready delay and data transfer size support from the property
+ *				storage and resets the register file of the given locality. The register accesses of DeviceAccess are
+ *				served by the simulator from then on, the TPM commands are executed by TpmSimulator_Execute.
+ *
+ *	@param		PbLocality					Locality value
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_LOCALITY_NOT_SUPPORTED	The locality is not supported.
+ *	@retval		RC_E_INVALID_SETTING		The configured burst count or data transfer size support is invalid.
+ */
+_Check_return_
+unsigned int
+TpmTisSimulator_Initialize(
+	_In_	BYTE	PbLocality);
+
+/**
+ *	@brief		Uninitialize the TIS register file simulator
+ *	@details	Logs the register access statistics.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		RC_E_INTERNAL	The simulator is not initialized.
+ */
+_Check_return_
+unsigned int
+TpmTisSimulator_Uninitialize();
+
+/**
+ *	@brief		Check whether the TIS registers are served by the simulator
+ *
+ *	@retval		TRUE	TpmTisSimulator_Initialize initialized the simulator.
+ *	@retval		FALSE	Otherwise.
+ */
+_Check_return_
+BOOL
+TpmTisSimulator_IsOpen();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__TPM_TIS_SIMULATOR_H__
@@ -34,7 +34,47 @@ unsigned int
 	unsigned int	PunRequestBufferSize,
 	BYTE*			PrgbResponseBuffer,
 	unsigned int*	PpunResponseBufferSize,
-	unsigned int	PunMaxDuration);
+	unsigned int	PunMaxDuration,
+	unsigned int	PunExpectedDuration);
+
+/**
+ *	@brief		Part of a TPM command request
+ *	@details	A request can be handed over in several parts, so that large parameters are sent from where they are
+ *				stored instead of being copied into a request buffer first.
+ */
+typedef struct tdIfxTpmIoSegment
+{
+	/// Bytes of the part
+	const BYTE* pbData;
+	/// Number of bytes of the part
+	unsigned int unSize;
+} IfxTpmIoSegment;
+
+/// Function pointer to method for transmitting a request given in several parts to the TPM
+typedef
+unsigned int
+(*PFN_TPMIO_TransmitSegments)(
+	const IfxTpmIoSegment*	PrgsRequestSegments,
+	unsigned int			PunSegmentCount,
+	BYTE*					PrgbResponseBuffer,
+	unsigned int*			PpunResponseBufferSize,
+	unsigned int			PunMaxDuration,
+	unsigned int			PunExpectedDuration);
+/// Maximum number of requests transmitted in one round trip
+#define TPMIO_BATCH_MAX_REQUESTS			64
+/// Response code of a request of a round trip which could not be transmitted to the TPM
+#define TPMIO_BATCH_TRANSPORT_ERROR			0xFFFFFFFF
+
+/// Function pointer to method for transmitting several requests to the TPM in one round trip
+typedef
+unsigned int
+(*PFN_TPMIO_TransmitBatch)(
+	const IfxTpmIoSegment*	PrgsRequestSegments,
+	unsigned int			PunSegmentsPerRequest,
+	unsigned int			PunRequestCount,
+	unsigned int*			PrgunResponseCodes,
+	unsigned int*			PpunExecuted,
+	unsigned int			PunMaxDuration);
 /// Function pointer to read a byte from a register of the TPM
 typedef
 unsigned int
@@ -48,6 +88,45 @@ unsigned int
 	unsigned int	PunRegisterAddress,
 	BYTE			PbRegisterValue);
 
+/**
+ *	@brief		Transport statistics of the TPM I/O layer
+ *	@details	Register accesses and wait loop statistics of the TIS and CRB protocols. When the TPM is accessed
+ *				through the TPM driver only the wait values are set, they cover the time blocked in poll() and read()
+ *				and the retries of a busy device.
+ */
+typedef struct tdIfxTpmIoStatistics
+{
+	/// Number of register read accesses
+	unsigned long long ullRegisterReads;
+	/// Number of register write accesses
+	unsigned long long ullRegisterWrites;
+	/// Number of bytes read from the data FIFO
+	unsigned long long ullFifoBytesRead;
+	/// Number of bytes written to the data FIFO
+	unsigned long long ullFifoBytesWritten;
+	/// Number of wait loop iterations
+	unsigned long long ullWaitIterations;
+	/// Accumulated time slept or blocked waiting for the TPM in microseconds
+	unsigned long long ullWaitTimeMicroSeconds;
+} IfxTpmIoStatistics;
+
+/// Function pointer to get the transport statistics of the TPM I/O layer
+typedef
+void
+(*PFN_TPMIO_GetStatistics)(
+	IfxTpmIoStatistics*	PpStatistics);
+
+/// Callback function invoked while a TPM command is executed by the TPM
+typedef
+void
+(*PFN_TPMIO_CommandPendingCallback)();
+
+/// Function pointer to set the callback function invoked while a TPM command is executed by the TPM
+typedef
+void
+(*PFN_TPMIO_SetCommandPendingCallback)(
+	PFN_TPMIO_CommandPendingCallback	PfnCommandPending);
+
 /**
  *	@brief		TPM connect function
  *	@details	This function handles the connect to the underlying TPM.
@@ -81,7 +160,8 @@ TPMIO_Disconnect();
  *	@param		PunRequestBufferSize	Size of command request in bytes
  *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
  *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
- *	@param		PunMaxDuration			The maximum duration of the command in microseconds (relevant for memory based access / TIS protocol only)
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (relevant for memory based access / TIS protocol only)
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
@@ -95,7 +175,65 @@ TPMIO_Transmit(
 	_In_										unsigned int	PunRequestBufferSize,
 	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*			PrgbResponseBuffer,
 	_Inout_										unsigned int*	PpunResponseBufferSize,
-	_In_										unsigned int	PunMaxDuration);
+	_In_										unsigned int	PunMaxDuration,
+	_In_										unsigned int	PunExpectedDuration);
+
+/**
+ *	@brief		TPM transmit function for a request given in several parts
+ *	@details	The parts are sent to the TPM one after the other as one command. Backends which cannot send a request
+ *				in parts get a copy of the parts in one buffer.
+ *
+ *	@param		PrgsRequestSegments		Parts of the TPM command request in the order of transmission
+ *	@param		PunSegmentCount			Number of parts
+ *	@param		PrgbResponseBuffer		Pointer to a byte array receiving the TPM command response bytes
+ *	@param		PpunResponseBufferSize	Input size of response buffer, output size of TPM command response in bytes
+ *	@param		PunMaxDuration			The maximum duration of the command in microseconds
+ *	@param		PunExpectedDuration		The expected duration of the command in microseconds (relevant for memory based access / TIS protocol only)
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The request is too large
+ *	@retval		RC_E_NOT_CONNECTED		If the TPM I/O is not connected to the TPM
+ *	@retval		...						Error codes from the backend transmit function
+ */
+_Check_return_
+unsigned int
+TPMIO_TransmitSegments(
+	_In_reads_(PunSegmentCount)					const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_										unsigned int			PunSegmentCount,
+	_Out_bytecap_(*PpunResponseBufferSize)		BYTE*					PrgbResponseBuffer,
+	_Inout_										unsigned int*			PpunResponseBufferSize,
+	_In_										unsigned int			PunMaxDuration,
+	_In_										unsigned int			PunExpectedDuration);
+
+/**
+ *	@brief		TPM transmit function for several requests in one round trip
+ *	@details	Only backends which forward the TPM commands over a network (see TPM_DEVICE_ACCESS_REMOTE) support this.
+ *				The requests are executed back to back until the first one which does not succeed.
+ *
+ *	@param		PrgsRequestSegments		Parts of the requests, PunSegmentsPerRequest consecutive parts per request
+ *	@param		PunSegmentsPerRequest	Number of parts per request
+ *	@param		PunRequestCount			Number of requests
+ *	@param		PrgunResponseCodes		Receives the TPM response code of each executed request, or
+ *										TPMIO_BATCH_TRANSPORT_ERROR if it could not be transmitted
+ *	@param		PpunExecuted			Receives the number of executed requests
+ *	@param		PunMaxDuration			The maximum duration of one command in microseconds
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully, see PrgunResponseCodes for the result of each request.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_CONNECTED			If the TPM I/O is not connected to the TPM
+ *	@retval		RC_E_NOT_SUPPORTED_FEATURE	The backend cannot transmit several requests in one round trip.
+ *	@retval		...							Error codes from the backend transmit function
+ */
+_Check_return_
+unsigned int
+TPMIO_TransmitBatch(
+	_In_reads_(PunSegmentsPerRequest * PunRequestCount)	const IfxTpmIoSegment*	PrgsRequestSegments,
+	_In_												unsigned int			PunSegmentsPerRequest,
+	_In_												unsigned int			PunRequestCount,
+	_Out_cap_(PunRequestCount)							unsigned int*			PrgunResponseCodes,
+	_Out_												unsigned int*			PpunExecuted,
+	_In_												unsigned int			PunMaxDuration);
 
 /**
  *	@brief		Read a byte from a specific address (register)
@@ -106,6 +244,7 @@ TPMIO_Transmit(
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_NOT_CONNECTED		If the TPM I/O is not connected to the TPM
  *	@retval		...						Error codes from called functions
  */
 _Check_return_
@@ -122,6 +261,7 @@ TPMIO_ReadRegister(
  *	@param		PbRegisterValue			Byte to write to the register address
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_NOT_CONNECTED		If the TPM I/O is not connected to the TPM
  *	@retval		...						Error codes from called functions
  */
 _Check_return_
@@ -130,6 +270,36 @@ TPMIO_WriteRegister(
 	_In_		unsigned int		PunRegisterAddress,
 	_In_		BYTE				PbRegisterValue);
 
+/**
+ *	@brief		Get the transport statistics
+ *	@details	This function returns the statistics accumulated since the start of the application.
+ *
+ *	@param		PpStatistics			Pointer to a structure receiving the statistics
+ */
+void
+TPMIO_GetStatistics(
+	_Out_		IfxTpmIoStatistics*	PpStatistics);
+
+/**
+ *	@brief		Set the command pending callback
+ *	@details	The callback is invoked once per command after the command has been handed over to the TPM and
+ *				before the response is awaited. This lets the caller do host-side work while the TPM executes the
+ *				command. The callback must not transmit TPM commands itself.
+ *
+ *	@param		PfnCommandPending		Callback function or NULL to remove the callback
+ */
+void
+TPMIO_SetCommandPendingCallback(
+	_In_opt_	PFN_TPMIO_CommandPendingCallback	PfnCommandPending);
+
+/**
+ *	@brief		Signal that a TPM command is pending
+ *	@details	Called by the TPM access layers after a command has been handed over to the TPM. Invokes the
+ *				callback set with TPMIO_SetCommandPendingCallback, if any.
+ */
+void
+TPMIO_CommandPending();
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,297 +17,7 @@
 #include "StdInclude.h"
 #include "Platform.h"
 #include "TpmResponse.h"
-
-/// A list of all TPM2.0 Format-Zero error messages with their response code offset as index
-const wchar_t* s_rgwszFormatZeroErrorMessages[] =	// RC_VER1 (0x100) + offset
-{
-	TPM_RC_INITIALIZE_MESSAGE,			// 0x000
-	TPM_RC_FAILURE_MESSAGE,				// 0x001
-	NULL,								// 0x002
-	TPM_RC_SEQUENCE_MESSAGE,			// 0x003
-	NULL,								// 0x004
-	NULL,								// 0x005
-	NULL,								// 0x006
-	NULL,								// 0x007
-	NULL,								// 0x008
-	NULL,								// 0x009
-	NULL,								// 0x00A
-	TPM_RC_PRIVATE_MESSAGE,				// 0x00B
-	NULL,								// 0x00C
-	NULL,								// 0x00D
-	NULL,								// 0x00E
-	NULL,								// 0x00F
-	NULL,								// 0x010
-	NULL,								// 0x011
-	NULL,								// 0x012
-	NULL,								// 0x013
-	NULL,								// 0x014
-	NULL,								// 0x015
-	NULL,								// 0x016
-	NULL,								// 0x017
-	NULL,								// 0x018
-	TPM_RC_HMAC_MESSAGE,				// 0x019
-	NULL,								// 0x01A
-	NULL,								// 0x01B
-	NULL,								// 0x01C
-	NULL,								// 0x01D
-	NULL,								// 0x01E
-	NULL,								// 0x01F
-	TPM_RC_DISABLED_MESSAGE,			// 0x020
-	TPM_RC_EXCLUSIVE_MESSAGE,			// 0x021
-	NULL,								// 0x022
-	NULL,								// 0x023
-	TPM_RC_AUTH_TYPE_MESSAGE,			// 0x024
-	TPM_RC_AUTH_MISSING_MESSAGE,		// 0x025
-	TPM_RC_POLICY_MESSAGE,				// 0x026
-	TPM_RC_PCR_MESSAGE,					// 0x027
-	TPM_RC_PCR_CHANGED_MESSAGE,			// 0x028
-	NULL,								// 0x029
-	NULL,								// 0x02A
-	NULL,								// 0x02B
-	NULL,								// 0x02C
-	TPM_RC_UPGRADE_MESSAGE,				// 0x02D
-	TPM_RC_TOO_MANY_CONTEXTS_MESSAGE,	// 0x02E
-	TPM_RC_AUTH_UNAVAILABLE_MESSAGE,	// 0x02F
-	TPM_RC_REBOOT_MESSAGE,				// 0x030
-	TPM_RC_UNBALANCED_MESSAGE,			// 0x031
-	NULL,								// 0x032
-	NULL,								// 0x033
-	NULL,								// 0x034
-	NULL,								// 0x035
-	NULL,								// 0x036
-	NULL,								// 0x037
-	NULL,								// 0x038
-	NULL,								// 0x039
-	NULL,								// 0x03A
-	NULL,								// 0x03B
-	NULL,								// 0x03C
-	NULL,								// 0x03D
-	NULL,								// 0x03E
-	NULL,								// 0x03F
-	NULL,								// 0x040
-	NULL,								// 0x041
-	TPM_RC_COMMAND_SIZE_MESSAGE,		// 0x042
-	TPM_RC_COMMAND_CODE_MESSAGE,		// 0x043
-	TPM_RC_AUTHSIZE_MESSAGE,			// 0x044
-	TPM_RC_AUTH_CONTEXT_MESSAGE,		// 0x045
-	TPM_RC_NV_RANGE_MESSAGE,			// 0x046
-	TPM_RC_NV_SIZE_MESSAGE,				// 0x047
-	TPM_RC_NV_LOCKED_MESSAGE,			// 0x048
-	TPM_RC_NV_AUTHORIZATION_MESSAGE,	// 0x049
-	TPM_RC_NV_UNINITIALIZED_MESSAGE,	// 0x04A
-	TPM_RC_NV_SPACE_MESSAGE,			// 0x04B
-	TPM_RC_NV_DEFINED_MESSAGE,			// 0x04C
-	NULL,								// 0x04D
-	NULL,								// 0x04E
-	NULL,								// 0x04F
-	TPM_RC_BAD_CONTEXT_MESSAGE,			// 0x050
-	TPM_RC_CPHASH_MESSAGE,				// 0x051
-	TPM_RC_PARENT_MESSAGE,				// 0x052
-	TPM_RC_NEEDS_TEST_MESSAGE,			// 0x053
-	TPM_RC_NO_RESULT_MESSAGE,			// 0x054
-	TPM_RC_SENSITIVE_MESSAGE			// 0x055
-};
-
-/// A list of all TPM2.0 Format-One error messages with their response code offset as index
-const wchar_t* s_rgwszFormatOneErrorMessages[] =	// RC_FMT1 (0x80) + offset
-{
-	NULL,								// 0x000
-	TPM_RC_ASYMMETRIC_MESSAGE,			// 0x001
-	TPM_RC_ATTRIBUTES_MESSAGE,			// 0x002
-	TPM_RC_HASH_MESSAGE,				// 0x003
-	TPM_RC_VALUE_MESSAGE,				// 0x004
-	TPM_RC_HIERARCHY_MESSAGE,			// 0x005
-	NULL,								// 0x006
-	TPM_RC_KEY_SIZE_MESSAGE,			// 0x007
-	TPM_RC_MGF_MESSAGE,					// 0x008
-	TPM_RC_MODE_MESSAGE,				// 0x009
-	TPM_RC_TYPE_MESSAGE,				// 0x00A
-	TPM_RC_HANDLE_MESSAGE,				// 0x00B
-	TPM_RC_KDF_MESSAGE,					// 0x00C
-	TPM_RC_RANGE_MESSAGE,				// 0x00D
-	TPM_RC_AUTH_FAIL_MESSAGE,			// 0x00E
-	TPM_RC_NONCE_MESSAGE,				// 0x00F
-	TPM_RC_PP_MESSAGE,					// 0x010
-	NULL,								// 0x011
-	TPM_RC_SCHEME_MESSAGE,				// 0x012
-	NULL,								// 0x013
-	NULL,								// 0x014
-	TPM_RC_SIZE_MESSAGE,				// 0x015
-	TPM_RC_SYMMETRIC_MESSAGE,			// 0x016
-	TPM_RC_TAG_MESSAGE,					// 0x017
-	TPM_RC_SELECTOR_MESSAGE,			// 0x018
-	NULL,								// 0x019
-	TPM_RC_INSUFFICIENT_MESSAGE,		// 0x01A
-	TPM_RC_SIGNATURE_MESSAGE,			// 0x01B
-	TPM_RC_KEY_MESSAGE,					// 0x01C
-	TPM_RC_POLICY_FAIL_MESSAGE,			// 0x01D
-	NULL,								// 0x01E
-	TPM_RC_INTEGRITY_MESSAGE,			// 0x01F
-	TPM_RC_TICKET_MESSAGE,				// 0x020
-	TPM_RC_RESERVED_BITS_MESSAGE,		// 0x021
-	TPM_RC_BAD_AUTH_MESSAGE,			// 0x022
-	TPM_RC_EXPIRED_MESSAGE,				// 0x023
-	TPM_RC_POLICY_CC_MESSAGE,			// 0x024
-	TPM_RC_BINDING_MESSAGE,				// 0x025
-	TPM_RC_CURVE_MESSAGE,				// 0x026
-	TPM_RC_ECC_POINT_MESSAGE			// 0x027
-};
-
-/// A list of all TPM2.0 Format-Zero warning messages with their response code offset as index
-const wchar_t* s_rgwszFormatZeroWarningMessages[] =	// RC_WARN (0x900) + offset
-{
-	NULL,								// 0x000
-	TPM_RC_CONTEXT_GAP_MESSAGE,			// 0x001
-	TPM_RC_OBJECT_MEMORY_MESSAGE,		// 0x002
-	TPM_RC_SESSION_MEMORY_MESSAGE,		// 0x003
-	TPM_RC_MEMORY_MESSAGE,				// 0x004
-	TPM_RC_SESSION_HANDLES_MESSAGE,		// 0x005
-	TPM_RC_OBJECT_HANDLES_MESSAGE,		// 0x006
-	TPM_RC_LOCALITY_MESSAGE,			// 0x007
-	TPM_RC_YIELDED_MESSAGE,				// 0x008
-	TPM_RC_CANCELED_MESSAGE,			// 0x009
-	TPM_RC_TESTING_MESSAGE,				// 0x00A
-	NULL,								// 0x00B
-	NULL,								// 0x00C
-	NULL,								// 0x00D
-	NULL,								// 0x00E
-	NULL,								// 0x00F
-	TPM_RC_REFERENCE_H0_MESSAGE,		// 0x010
-	TPM_RC_REFERENCE_H1_MESSAGE,		// 0x011
-	TPM_RC_REFERENCE_H2_MESSAGE,		// 0x012
-	TPM_RC_REFERENCE_H3_MESSAGE,		// 0x013
-	TPM_RC_REFERENCE_H4_MESSAGE,		// 0x014
-	TPM_RC_REFERENCE_H5_MESSAGE,		// 0x015
-	TPM_RC_REFERENCE_H6_MESSAGE,		// 0x016
-	NULL,								// 0x017
-	TPM_RC_REFERENCE_S0_MESSAGE,		// 0x018
-	TPM_RC_REFERENCE_S1_MESSAGE,		// 0x019
-	TPM_RC_REFERENCE_S2_MESSAGE,		// 0x01A
-	TPM_RC_REFERENCE_S3_MESSAGE,		// 0x01B
-	TPM_RC_REFERENCE_S4_MESSAGE,		// 0x01C
-	TPM_RC_REFERENCE_S5_MESSAGE,		// 0x01D
-	TPM_RC_REFERENCE_S6_MESSAGE,		// 0x01E
-	NULL,								// 0x01F
-	TPM_RC_NV_RATE_MESSAGE,				// 0x020
-	TPM_RC_LOCKOUT_MESSAGE,				// 0x021
-	TPM_RC_RETRY_MESSAGE,				// 0x022
-	TPM_RC_NV_UNAVAILABLE_MESSAGE		// 0x023
-};
-
-/// A list of all TPM1.2 error messages with their response code offset as index
-const wchar_t* s_rgwszTpm12ErrorMessages[] =	// TPM_BASE (0x0) + offset
-{
-	TPM_SUCCESS_MESSAGE,				// 0x000
-	TPM_AUTHFAIL_MESSAGE,				// 0x001
-	TPM_BADINDEX_MESSAGE,				// 0x002
-	TPM_BAD_PARAMETER_MESSAGE,			// 0x003
-	TPM_AUDITFAILURE_MESSAGE,			// 0x004
-	TPM_CLEAR_DISABLED_MESSAGE,			// 0x005
-	TPM_DEACTIVATED_MESSAGE,			// 0x006
-	TPM_DISABLED_MESSAGE,				// 0x007
-	TPM_DISABLED_CMD_MESSAGE,			// 0x008
-	TPM_FAIL_MESSAGE,					// 0x009
-	TPM_BAD_ORDINAL_MESSAGE,			// 0x00A
-	TPM_INSTALL_DISABLED_MESSAGE,		// 0x00B
-	TPM_INVALID_KEYHANDLE_MESSAGE,		// 0x00C
-	TPM_KEYNOTFOUND_MESSAGE,			// 0x00D
-	TPM_INAPPROPRIATE_ENC_MESSAGE,		// 0x00E
-	TPM_MIGRATEFAIL_MESSAGE,			// 0x00F
-	TPM_INVALID_PCR_INFO_MESSAGE,		// 0x010
-	TPM_NOSPACE_MESSAGE,				// 0x011
-	TPM_NOSRK_MESSAGE,					// 0x012
-	TPM_NOTSEALED_BLOB_MESSAGE,			// 0x013
-	TPM_OWNER_SET_MESSAGE,				// 0x014
-	TPM_RESOURCES_MESSAGE,				// 0x015
-	TPM_SHORTRANDOM_MESSAGE,			// 0x016
-	TPM_SIZE_MESSAGE,					// 0x017
-	TPM_WRONGPCRVAL_MESSAGE,			// 0x018
-	TPM_BAD_PARAM_SIZE_MESSAGE,			// 0x019
-	TPM_SHA_THREAD_MESSAGE,				// 0x01A
-	TPM_SHA_ERROR_MESSAGE,				// 0x01B
-	TPM_FAILEDSELFTEST_MESSAGE,			// 0x01C
-	TPM_AUTH2FAIL_MESSAGE,				// 0x01D
-	TPM_BADTAG_MESSAGE,					// 0x01E
-	TPM_IOERROR_MESSAGE,				// 0x01F
-	TPM_ENCRYPT_ERROR_MESSAGE,			// 0x020
-	TPM_DECRYPT_ERROR_MESSAGE,			// 0x021
-	TPM_INVALID_AUTHHANDLE_MESSAGE,		// 0x022
-	TPM_NO_ENDORSEMENT_MESSAGE,			// 0x023
-	TPM_INVALID_KEYUSAGE_MESSAGE,		// 0x024
-	TPM_WRONG_ENTITYTYPE_MESSAGE,		// 0x025
-	TPM_INVALID_POSTINIT_MESSAGE,		// 0x026
-	TPM_INAPPROPRIATE_SIG_MESSAGE,		// 0x027
-	TPM_BAD_KEY_PROPERTY_MESSAGE,		// 0x028
-	TPM_BAD_MIGRATION_MESSAGE,			// 0x029
-	TPM_BAD_SCHEME_MESSAGE,				// 0x02A
-	TPM_BAD_DATASIZE_MESSAGE,			// 0x02B
-	TPM_BAD_MODE_MESSAGE,				// 0x02C
-	TPM_BAD_PRESENCE_MESSAGE,			// 0x02D
-	TPM_BAD_VERSION_MESSAGE,			// 0x02E
-	TPM_NO_WRAP_TRANSPORT_MESSAGE,		// 0x02F
-	TPM_AUDITFAIL_UNSUCCESSFUL_MESSAGE,	// 0x030
-	TPM_AUDITFAIL_SUCCESSFUL_MESSAGE,	// 0x031
-	TPM_NOTRESETABLE_MESSAGE,			// 0x032
-	TPM_NOTLOCAL_MESSAGE,				// 0x033
-	TPM_BAD_TYPE_MESSAGE,				// 0x034
-	TPM_INVALID_RESOURCE_MESSAGE,		// 0x035
-	TPM_NOTFIPS_MESSAGE,				// 0x036
-	TPM_INVALID_FAMILY_MESSAGE,			// 0x037
-	TPM_NO_NV_PERMISSION_MESSAGE,		// 0x038
-	TPM_REQUIRES_SIGN_MESSAGE,			// 0x039
-	TPM_KEY_NOTSUPPORTED_MESSAGE,		// 0x03A
-	TPM_AUTH_CONFLICT_MESSAGE,			// 0x03B
-	TPM_AREA_LOCKED_MESSAGE,			// 0x03C
-	TPM_BAD_LOCALITY_MESSAGE,			// 0x03D
-	TPM_READ_ONLY_MESSAGE,				// 0x03E
-	TPM_PER_NOWRITE_MESSAGE,			// 0x03F
-	TPM_FAMILYCOUNT_MESSAGE,			// 0x040
-	TPM_WRITE_LOCKED_MESSAGE,			// 0x041
-	TPM_BAD_ATTRIBUTES_MESSAGE,			// 0x042
-	TPM_INVALID_STRUCTURE_MESSAGE,		// 0x043
-	TPM_KEY_OWNER_CONTROL_MESSAGE,		// 0x044
-	TPM_BAD_COUNTER_MESSAGE,			// 0x045
-	TPM_NOT_FULLWRITE_MESSAGE,			// 0x046
-	TPM_CONTEXT_GAP_MESSAGE,			// 0x047
-	TPM_MAXNVWRITES_MESSAGE,			// 0x048
-	TPM_NOOPERATOR_MESSAGE,				// 0x049
-	TPM_RESOURCEMISSING_MESSAGE,		// 0x04A
-	TPM_DELEGATE_LOCK_MESSAGE,			// 0x04B
-	TPM_DELEGATE_FAMILY_MESSAGE,		// 0x04C
-	TPM_DELEGATE_ADMIN_MESSAGE,			// 0x04D
-	TPM_TRANSPORT_NOTEXCLUSIVE_MESSAGE,	// 0x04E
-	TPM_OWNER_CONTROL_MESSAGE,			// 0x04F
-	TPM_DAA_RESOURCES_MESSAGE,			// 0x050
-	TPM_DAA_INPUT_DATA0_MESSAGE,		// 0x051
-	TPM_DAA_INPUT_DATA1_MESSAGE,		// 0x052
-	TPM_DAA_ISSUER_SETTINGS_MESSAGE,	// 0x053
-	TPM_DAA_TPM_SETTINGS_MESSAGE,		// 0x054
-	TPM_DAA_STAGE_MESSAGE,				// 0x055
-	TPM_DAA_ISSUER_VALIDITY_MESSAGE,	// 0x056
-	TPM_DAA_WRONG_W_MESSAGE,			// 0x057
-	TPM_BAD_HANDLE_MESSAGE,				// 0x058
-	TPM_BAD_DELEGATE_MESSAGE,			// 0x059
-	TPM_BADCONTEXT_MESSAGE,				// 0x05A
-	TPM_TOOMANYCONTEXTS_MESSAGE,		// 0x05B
-	TPM_MA_TICKET_SIGNATURE_MESSAGE,	// 0x05C
-	TPM_MA_DESTINATION_MESSAGE,			// 0x05D
-	TPM_MA_SOURCE_MESSAGE,				// 0x05E
-	TPM_MA_AUTHORITY_MESSAGE,			// 0x05F
-	NULL,								// 0x060
-	TPM_PERMANENTEK_MESSAGE,			// 0x061
-	TPM_BAD_SIGNATURE_MESSAGE,			// 0x062
-	TPM_NOCONTEXTSPACE_MESSAGE			// 0x063
-};
-
-/// A list of all TPM1.2 warning messages with their response code offset as index
-const wchar_t* s_rgwszTpm12WarningMessages[] =	// TPM_BASE (0x0) + TPM_NON_FATAL (0x800) + offset
-{
-	TPM_RETRY_MESSAGE,					// 0x000
-	TPM_NEEDS_SELFTEST_MESSAGE,			// 0x001
-	TPM_DOING_SELFTEST_MESSAGE,			// 0x002
-	TPM_DEFEND_LOCK_RUNNING_MESSAGE		// 0x003
-};
+#include "MessageCatalog.h"
 
 /**
  *	@brief		Parses a TPM2.0 Format-One response code
@@ -502,8 +212,7 @@ TpmResponse_FormatZeroErrorGetMessage(
 
 	do
 	{
-		const wchar_t* wszMessage = NULL;
-		unsigned int unMessagesListSize = sizeof(s_rgwszFormatZeroErrorMessages) / sizeof(wchar_t*);
+		unsigned int unMessageSize = PunResponseBufferSize;
 
 		// Check parameter
 		if (NULL == PwszResponseBuffer || 0 == PunResponseBufferSize)
@@ -512,18 +221,14 @@ TpmResponse_FormatZeroErrorGetMessage(
 			break;
 		}
 
-		// Check for array boundaries and get corresponding message from list
-		if (PunErrorCode < unMessagesListSize)
-			wszMessage = s_rgwszFormatZeroErrorMessages[PunErrorCode];
-		if (NULL == wszMessage)
+		// Write message from the catalog to output buffer
+		unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_TPM20_FORMAT_ZERO_ERRORS, PunErrorCode, PwszResponseBuffer, &unMessageSize);
+		if (RC_E_NOT_FOUND == unReturnValue)
 		{
 			unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, L"Unknown error code: 0x%.08X.", PunErrorCode);
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-
-		// Write message to output buffer
-		unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, wszMessage);
 	}
 	WHILE_FALSE_END;
 
@@ -558,8 +263,7 @@ TpmResponse_FormatOneErrorGetMessage(
 
 	do
 	{
-		const wchar_t* wszMessage = NULL;
-		unsigned int unMessagesListSize = sizeof(s_rgwszFormatOneErrorMessages) / sizeof(wchar_t*);
+		unsigned int unMessageSize = PunResponseBufferSize;
 
 		// Check parameter
 		if (NULL == PwszResponseBuffer || 0 == PunResponseBufferSize)
@@ -568,18 +272,14 @@ TpmResponse_FormatOneErrorGetMessage(
 			break;
 		}
 
-		// Check for array boundaries and get corresponding message from list
-		if (PunErrorCode < unMessagesListSize)
-			wszMessage = s_rgwszFormatOneErrorMessages[PunErrorCode];
-		if (NULL == wszMessage)
+		// Write message from the catalog to output buffer
+		unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_TPM20_FORMAT_ONE_ERRORS, PunErrorCode, PwszResponseBuffer, &unMessageSize);
+		if (RC_E_NOT_FOUND == unReturnValue)
 		{
 			unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, L"Unknown error code: 0x%.08X.", PunErrorCode);
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-
-		// Write message to output buffer
-		unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, wszMessage);
 	}
 	WHILE_FALSE_END;
 
@@ -614,8 +314,7 @@ TpmResponse_FormatZeroWarningGetMessage(
 
 	do
 	{
-		const wchar_t* wszMessage = NULL;
-		unsigned int unMessagesListSize = sizeof(s_rgwszFormatZeroWarningMessages) / sizeof(wchar_t*);
+		unsigned int unMessageSize = PunResponseBufferSize;
 
 		// Check parameter
 		if (NULL == PwszResponseBuffer || 0 == PunResponseBufferSize)
@@ -624,18 +323,14 @@ TpmResponse_FormatZeroWarningGetMessage(
 			break;
 		}
 
-		// Check for array boundaries and get corresponding message from list
-		if (PunErrorCode < unMessagesListSize)
-			wszMessage = s_rgwszFormatZeroWarningMessages[PunErrorCode];
-		if (NULL == wszMessage)
+		// Write message from the catalog to output buffer
+		unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_TPM20_FORMAT_ZERO_WARNINGS, PunErrorCode, PwszResponseBuffer, &unMessageSize);
+		if (RC_E_NOT_FOUND == unReturnValue)
 		{
 			unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, L"Unknown warning code: 0x%.08X.", PunErrorCode);
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-
-		// Write message to output buffer
-		unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, wszMessage);
 	}
 	WHILE_FALSE_END;
 
@@ -670,8 +365,7 @@ TpmResponse_TPM12GetMessage(
 
 	do
 	{
-		const wchar_t* wszMessage = NULL;
-		unsigned int unErrorMessagesListSize = sizeof(s_rgwszTpm12ErrorMessages) / sizeof(wchar_t*);
+		unsigned int unMessageSize = PunResponseBufferSize;
 		unsigned int unUnMaskedErrorCode = PunErrorCode & ~RC_TPM_MASK;
 
 		// Check parameter
@@ -684,29 +378,20 @@ TpmResponse_TPM12GetMessage(
 		// Check if TPM1.2 response code is a warning
 		if (TPM_NON_FATAL & unUnMaskedErrorCode)
 		{
-			unsigned int unWarningMessagesListSize = sizeof(s_rgwszTpm12WarningMessages) / sizeof(wchar_t*);
-
-			// Remove TPM_NON_FATAL to get the actual message index
-			unsigned int unIndex = unUnMaskedErrorCode - TPM_NON_FATAL;
-
-			// Check for array boundaries and get corresponding warning message from list
-			if (unIndex < unWarningMessagesListSize)
-				wszMessage = s_rgwszTpm12WarningMessages[unIndex];
+			// Remove TPM_NON_FATAL to get the actual message index and write warning message from the catalog to output buffer
+			unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_TPM12_WARNINGS, unUnMaskedErrorCode - TPM_NON_FATAL, PwszResponseBuffer, &unMessageSize);
 		}
-		// Check for array boundaries and get corresponding error message from list
-		else if (unUnMaskedErrorCode < unErrorMessagesListSize)
+		else
 		{
-			wszMessage = s_rgwszTpm12ErrorMessages[unUnMaskedErrorCode];
+			// Write error message from the catalog to output buffer
+			unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_TPM12_ERRORS, unUnMaskedErrorCode, PwszResponseBuffer, &unMessageSize);
 		}
-		if (NULL == wszMessage)
+		if (RC_E_NOT_FOUND == unReturnValue)
 		{
 			unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, L"Unknown TPM1.2 response code: 0x%.08X.", PunErrorCode);
 			unReturnValue = RC_E_BAD_PARAMETER;
 			break;
 		}
-
-		// Write message to output buffer
-		unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, wszMessage);
 	}
 	WHILE_FALSE_END;
 
@@ -756,7 +441,7 @@ TpmResponse_GetMessage(
 		// Check for TPM_RC_SUCCESS
 		if (TPM_RC_SUCCESS == PunErrorCode)
 		{
-			unReturnValue = Platform_StringFormat(PwszResponseBuffer, &PunResponseBufferSize, TPM_RC_SUCCESS_MESSAGE);
+			unReturnValue = MessageCatalog_GetMessage(MESSAGECATALOG_TPM20_SUCCESS, 0, PwszResponseBuffer, &PunResponseBufferSize);
 			break;
 		}
 
@@ -0,0 +1,153 @@
+﻿/**
+ *	@brief		Implements the trace event export
+ *	@details	Each span is written as a complete event ("ph":"X") with one formatted write, so the spans of several
+ *				threads do not interleave. The JSON array format is used because the trace viewers accept it without the
+ *				closing bracket, a trace of an aborted run stays readable.
+ *	@file		Trace.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdatomic.h>
+#include "Trace.h"
+#include "FileIO.h"
+#include "Platform.h"
+
+/// Maximum length of the formatted span arguments
+#define TRACE_MAX_ARGS_SIZE		256
+
+BOOL g_fTraceEnabled = FALSE;
+
+/// Trace file opened by Trace_Open
+static void* s_pvTraceFile = NULL;
+
+/// TRUE until the first span is written (no separator is needed before it)
+static BOOL s_fFirstSpan = TRUE;
+
+/// Number of threads which wrote a span so far
+static atomic_uint s_unThreadCount;
+
+/// Thread number of the calling thread in the trace (0 before its first span)
+static _Thread_local unsigned int s_unThreadId = 0;
+
+/**
+ *	@brief		Opens the trace file
+ *	@details	An existing file is overwritten. The spans are written until Trace_Close is called.
+ *
+ *	@param		PwszTracePath		Path of the trace file
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PwszTracePath is NULL or empty
+ *	@retval		...					Error codes from FileIO_Open and FileIO_WriteStringf
+ */
+_Check_return_
+unsigned int
+Trace_Open(
+	_In_z_	const wchar_t*	PwszTracePath)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		if (PLATFORM_STRING_IS_NULL_OR_EMPTY(PwszTracePath))
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = FileIO_Open(PwszTracePath, &s_pvTraceFile, FILE_WRITE);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_WriteString(s_pvTraceFile, L"[");
+		if (RC_SUCCESS != unReturnValue)
+		{
+			IGNORE_RETURN_VALUE(FileIO_Close(&s_pvTraceFile));
+			s_pvTraceFile = NULL;
+			break;
+		}
+
+		s_fFirstSpan = TRUE;
+		g_fTraceEnabled = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Writes a span to the trace file
+ *	@details	Does nothing if no trace file is open. A span which cannot be written stops the trace.
+ *
+ *	@param		PwszCategory		Category of the span (TRACE_CATEGORY_*)
+ *	@param		PwszName			Name of the span, must not contain characters which need escaping in JSON
+ *	@param		PullStartTime		Start of the span (Platform_GetMonotonicTimeMicroSeconds)
+ *	@param		PullDuration		Duration of the span in microseconds
+ *	@param		PwszArgsFormat		Format of the JSON members of the span arguments (e.g. L"\"size\":%u"), NULL for none
+ *	@param		...					Values for PwszArgsFormat
+ */
+void
+Trace_WriteSpan(
+	_In_z_		const wchar_t*		PwszCategory,
+	_In_z_		const wchar_t*		PwszName,
+	_In_		unsigned long long	PullStartTime,
+	_In_		unsigned long long	PullDuration,
+	_In_opt_	const wchar_t*		PwszArgsFormat,
+	...)
+{
+	wchar_t wszArgs[TRACE_MAX_ARGS_SIZE] = {0};
+	unsigned int unArgsSize = RG_LEN(wszArgs);
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (FALSE == g_fTraceEnabled)
+		return;
+
+	// The threads are numbered in the order of their first span, the trace viewers show a track per thread
+	if (0 == s_unThreadId)
+		s_unThreadId = atomic_fetch_add(&s_unThreadCount, 1) + 1;
+
+	if (NULL != PwszArgsFormat)
+	{
+		va_list argList;
+		va_start(argList, PwszArgsFormat);
+		// Arguments which do not fit are left out, the span itself is still written
+		if (RC_SUCCESS != Platform_StringFormatV(wszArgs, &unArgsSize, PwszArgsFormat, argList))
+			wszArgs[0] = L'\0';
+		va_end(argList);
+	}
+
+	unReturnValue = FileIO_WriteStringf(s_pvTraceFile,
+		L"%ls{\"ph\":\"X\",\"cat\":\"%ls\",\"name\":\"%ls\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u,\"args\":{%ls}}",
+		TRUE == s_fFirstSpan ? L"\n" : L",\n", PwszCategory, PwszName, PullStartTime, PullDuration, s_unThreadId, wszArgs);
+	s_fFirstSpan = FALSE;
+
+	// Do not retry with every following span
+	if (RC_SUCCESS != unReturnValue)
+	{
+		g_fTraceEnabled = FALSE;
+		IGNORE_RETURN_VALUE(FileIO_Close(&s_pvTraceFile));
+		s_pvTraceFile = NULL;
+	}
+}
+
+/**
+ *	@brief		Closes the trace file
+ *	@details	Terminates the JSON array. Does nothing if no trace file is open.
+ */
+void
+Trace_Close()
+{
+	if (FALSE == g_fTraceEnabled)
+		return;
+
+	g_fTraceEnabled = FALSE;
+	IGNORE_RETURN_VALUE(FileIO_WriteString(s_pvTraceFile, L"\n]\n"));
+	IGNORE_RETURN_VALUE(FileIO_Close(&s_pvTraceFile));
+	s_pvTraceFile = NULL;
+}
@@ -0,0 +1,83 @@
+﻿/**
+ *	@brief		Declares the trace event export
+ *	@details	This module writes timed spans of the update phases, the TPM commands, the TPM wait loops and the log
+ *				writes to a file in the Chrome trace event format (JSON array format). The file can be opened with
+ *				chrome://tracing or the Perfetto UI.
+ *	@file		Trace.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// TRUE while a trace file is open, checked by the callers before they collect the span arguments
+extern BOOL g_fTraceEnabled;
+
+/// Checks whether spans are written to a trace file
+#define TRACE_IS_ENABLED()	(TRUE == g_fTraceEnabled)
+
+/// Span category of the tool phases
+#define TRACE_CATEGORY_PHASE	L"phase"
+/// Span category of the TPM commands
+#define TRACE_CATEGORY_TPM		L"tpm"
+/// Span category of the TPM interface stages (send, wait, read)
+#define TRACE_CATEGORY_TIS		L"tis"
+/// Span category of the log writes
+#define TRACE_CATEGORY_LOG		L"log"
+
+/**
+ *	@brief		Opens the trace file
+ *	@details	An existing file is overwritten. The spans are written until Trace_Close is called.
+ *
+ *	@param		PwszTracePath		Path of the trace file
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PwszTracePath is NULL or empty
+ *	@retval		...					Error codes from FileIO_Open and FileIO_WriteStringf
+ */
+_Check_return_
+unsigned int
+Trace_Open(
+	_In_z_	const wchar_t*	PwszTracePath);
+
+/**
+ *	@brief		Writes a span to the trace file
+ *	@details	Does nothing if no trace file is open. A span which cannot be written stops the trace.
+ *
+ *	@param		PwszCategory		Category of the span (TRACE_CATEGORY_*)
+ *	@param		PwszName			Name of the span, must not contain characters which need escaping in JSON
+ *	@param		PullStartTime		Start of the span (Platform_GetMonotonicTimeMicroSeconds)
+ *	@param		PullDuration		Duration of the span in microseconds
+ *	@param		PwszArgsFormat		Format of the JSON members of the span arguments (e.g. L"\"size\":%u"), NULL for none
+ *	@param		...					Values for PwszArgsFormat
+ */
+void
+Trace_WriteSpan(
+	_In_z_		const wchar_t*		PwszCategory,
+	_In_z_		const wchar_t*		PwszName,
+	_In_		unsigned long long	PullStartTime,
+	_In_		unsigned long long	PullDuration,
+	_In_opt_	const wchar_t*		PwszArgsFormat,
+	...);
+
+/**
+ *	@brief		Closes the trace file
+ *	@details	Terminates the JSON array. Does nothing if no trace file is open.
+ */
+void
+Trace_Close();
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,27 @@
 
 #include "Utility.h"
 
+/// Lookup table of the hex digits used by the hex formatting functions
+static const wchar_t s_wszHexDigits[] = L"0123456789ABCDEF";
+
+/// Number of digits of the milliseconds in the time-stamp of Utility_GetLogTimestamp
+#define UTILITY_TIMESTAMP_MILLISECOND_DIGITS 3
+
+/// Cached time-stamp prefix [hh:mm:ss. of Utility_GetLogTimestamp
+static wchar_t s_wszTimestampCache[TIMESTAMP_LENGTH] = {0};
+
+/// Length of the cached time-stamp prefix in elements, 0 if the cache is empty
+static unsigned int s_unTimestampCacheLength = 0;
+
+/// Second (since 1970-01-01 00:00:00 UTC) of the cached time-stamp prefix
+static unsigned long long s_ullTimestampCacheSecond = 0;
+
+/// Wall clock time in microseconds at the last synchronization of the time-stamp cache
+static unsigned long long s_ullTimestampSyncTime = 0;
+
+/// Monotonic time in microseconds at the last synchronization of the time-stamp cache
+static unsigned long long s_ullTimestampSyncMonotonicTime = 0;
+
 //--------------------------------------------------------------------------------------------->
 // String Functions
 //----------------------------------------------------------------------------------------------
@@ -30,6 +51,7 @@
  *	@param		PpwszLine				Pointer to a string buffer. The function allocates memory for a
  *										line string buffer and sets this pointer to the address of the
  *										allocated memory. The caller must free the allocated line buffer!
+ *										The line is scratch memory and must not be used after the current command.
  *	@param		PpunLineSize			The length of the line in elements including the zero termination.
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
@@ -49,6 +71,9 @@ Utility_StringGetLine(
 
 	do
 	{
+		const wchar_t* pwszLine = NULL;
+		unsigned int unLineLength = 0;
+
 		// Check out parameters
 		if (NULL == PpunLineSize)
 		{
@@ -60,78 +85,38 @@ Utility_StringGetLine(
 		*PpunLineSize = 0;
 
 		// Check in parameters
-		if (NULL == PwszBuffer ||
-				NULL == PpwszLine ||
-				NULL != *PpwszLine ||
-				NULL == PpunIndex ||
-				0 == PunSize)
+		if (NULL == PpwszLine ||
+				NULL != *PpwszLine)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
 			ERROR_STORE(unReturnValue, L"One of the input parameters is NULL or empty.");
 			break;
 		}
 
-		// Check if end of string has been reached
-		if (*PpunIndex >= PunSize)
+		// Find the line
+		unReturnValue = Utility_StringGetLineView(PwszBuffer, PunSize, PpunIndex, &pwszLine, &unLineLength);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Allocate memory for a line buffer with that size including terminating zero
+		*PpunLineSize = unLineLength + 1;
+		*PpwszLine = (wchar_t*)Platform_MemoryAllocateScratch((*PpunLineSize) * sizeof(wchar_t));
+		if (NULL == *PpwszLine)
 		{
-			unReturnValue = RC_E_END_OF_STRING;
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Unexpected error occurred during memory allocation.");
 			break;
 		}
 
-		// Get the line size
+		// Copy line to buffer
+		if (0 < unLineLength)
 		{
-			// Find index of line break or string end
-			unsigned int unIndex = *PpunIndex;
-			for (; unIndex < PunSize; unIndex++)
-			{
-				// Check if end of string or \n reached
-				if (PwszBuffer[unIndex] == L'\0' ||
-						PwszBuffer[unIndex] == L'\n')
-					break;
-
-				// Check if \r \n is reached
-				if (unIndex + 1 < PunSize &&
-						PwszBuffer[unIndex] == L'\r' &&
-						PwszBuffer[unIndex + 1] == L'\n')
-				{
-					unIndex++;
-					break;
-				}
-
-				// Increment output size
-				(*PpunLineSize)++;
-			}
-
-			// Add terminating zero
-			(*PpunLineSize)++;
-
-			// Allocate memory for a line buffer with that size
-			*PpwszLine = (wchar_t*)Platform_MemoryAllocateZero((*PpunLineSize) * sizeof(wchar_t));
-			if (NULL == *PpwszLine)
+			unReturnValue = Platform_MemoryCopy((void*)*PpwszLine, (*PpunLineSize) * sizeof(wchar_t), (const void*)pwszLine, unLineLength * sizeof(wchar_t));
+			if (RC_SUCCESS != unReturnValue)
 			{
-				unReturnValue = RC_E_FAIL;
-				ERROR_STORE(unReturnValue, L"Unexpected error occurred during memory allocation.");
+				ERROR_STORE(unReturnValue, L"Unexpected error occurred during memory copy.");
 				break;
 			}
-			// Copy line to buffer
-			{
-				unsigned int unByteCapacity = (*PpunLineSize) * sizeof((*PpwszLine)[0]);
-				unsigned int unByteCount = ((*PpunLineSize) - 1) * sizeof((*PpwszLine)[0]);
-				if (0 < unByteCount)
-				{
-					unReturnValue = Platform_MemoryCopy((void*)*PpwszLine, unByteCapacity, (void*)&PwszBuffer[*PpunIndex], unByteCount);
-					if (RC_SUCCESS != unReturnValue)
-					{
-						ERROR_STORE(unReturnValue, L"Unexpected error occurred during memory copy.");
-						break;
-					}
-				}
-				else
-					unReturnValue = RC_SUCCESS;
-			}
-
-			// Set index
-			*PpunIndex = unIndex + 1;
 		}
 	}
 	WHILE_FALSE_END;
@@ -149,6 +134,99 @@ Utility_StringGetLine(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Gets a line from a buffer without copying it.
+ *	@details	This function searches for a line end ('\n', '\r\n' or '\0') and returns a view into the buffer.
+ *				The line is not zero terminated, so it must be used with its length.
+ *
+ *	@param		PwszBuffer				String buffer to get the line from
+ *	@param		PunSize					Length of the string buffer in elements (incl. zero termination)
+ *	@param		PpunIndex				In: Position to start searching in the string buffer\n
+ *										Out: Position in the string for the next search
+ *	@param		PppwszLine				Receives the start of the line in the string buffer
+ *	@param		PpunLineLength			Receives the length of the line in elements without line end
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_END_OF_STRING		In case the end of the string was reached
+ */
+_Check_return_
+unsigned int
+Utility_StringGetLineView(
+	_In_z_count_(PunSize)			const wchar_t*	PwszBuffer,
+	_In_							unsigned int	PunSize,
+	_Inout_							unsigned int*	PpunIndex,
+	_Out_							const wchar_t**	PppwszLine,
+	_Out_							unsigned int*	PpunLineLength)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unIndex = 0;
+		unsigned int unLineEnd = 0;
+
+		// Check out parameters
+		if (NULL == PppwszLine || NULL == PpunLineLength)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"One of the out parameters is NULL.");
+			break;
+		}
+		// Initialize out parameters
+		*PppwszLine = NULL;
+		*PpunLineLength = 0;
+
+		// Check in parameters
+		if (NULL == PwszBuffer ||
+				NULL == PpunIndex ||
+				0 == PunSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"One of the input parameters is NULL or empty.");
+			break;
+		}
+
+		// Check if end of string has been reached
+		if (*PpunIndex >= PunSize)
+		{
+			unReturnValue = RC_E_END_OF_STRING;
+			break;
+		}
+
+		// Find index of line break or string end
+		for (unIndex = *PpunIndex; unIndex < PunSize; unIndex++)
+		{
+			unLineEnd = unIndex;
+
+			// Check if end of string or \n reached
+			if (PwszBuffer[unIndex] == L'\0' ||
+					PwszBuffer[unIndex] == L'\n')
+				break;
+
+			// Check if \r \n is reached
+			if (unIndex + 1 < PunSize &&
+					PwszBuffer[unIndex] == L'\r' &&
+					PwszBuffer[unIndex + 1] == L'\n')
+			{
+				unIndex++;
+				break;
+			}
+
+			unLineEnd = unIndex + 1;
+		}
+
+		*PppwszLine = &PwszBuffer[*PpunIndex];
+		*PpunLineLength = unLineEnd - *PpunIndex;
+
+		// Set index
+		*PpunIndex = unIndex + 1;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Returns the index of the first occurrence of the searched character
  *	@details
@@ -695,9 +773,7 @@ Utility_StringScanByteToHex(
 	do
 	{
 		unsigned int unIndex = 0;
-		wchar_t wszHelper[HEX_STRING_OUT_LENGTH] = {0};
-		unsigned int unHelperSize = RG_LEN(wszHelper);
-		unsigned int unDestinationSize = 0;
+		unsigned int unLength = 0;
 
 		// Check parameters
 		if (NULL == PrgbSource || NULL == PwszDestination || NULL == PpunDestinationSize)
@@ -715,39 +791,33 @@ Utility_StringScanByteToHex(
 			break;
 		}
 
-		// Initialize string for loop start
-		PwszDestination[0] = L'\0';
+		// Every byte needs two hex digits and a space
+		if ((*PpunDestinationSize - 1) / 3 < PunSourceSize)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			ERROR_STORE(unReturnValue, L"Output buffer is too small.");
+			break;
+		}
 
 		// Process input buffer
 		for (unIndex = 0; unIndex < PunSourceSize; unIndex++)
 		{
-			// Convert current byte to string
-			unHelperSize = HEX_STRING_OUT_LENGTH;
-			unReturnValue = Platform_StringFormat(wszHelper, &unHelperSize, L"%.2X ", PrgbSource[unIndex]);
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Platform_StringFormat returned an unexpected value.");
-				break;
-			}
-			// Concatenate string for current byte with string for previous bytes
-			unDestinationSize = *PpunDestinationSize;
-			unReturnValue = Platform_StringConcatenate(PwszDestination, &unDestinationSize, wszHelper);
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Platform_StringConcatenate returned an unexpected value.");
-				break;
-			}
+			PwszDestination[unLength++] = s_wszHexDigits[PrgbSource[unIndex] >> 4];
+			PwszDestination[unLength++] = s_wszHexDigits[PrgbSource[unIndex] & 0x0F];
+			PwszDestination[unLength++] = L' ';
 		}
+		PwszDestination[unLength] = L'\0';
 
 		// Update destination size
-		*PpunDestinationSize = unDestinationSize;
+		*PpunDestinationSize = unLength;
+		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
 	if (RC_SUCCESS != unReturnValue)
 	{
 		// Reset out parameters
-		if (NULL != PwszDestination)
+		if (NULL != PwszDestination && NULL != PpunDestinationSize && 0 != *PpunDestinationSize)
 			PwszDestination[0] = L'\0';
 		if (NULL != PpunDestinationSize)
 			*PpunDestinationSize = 0;
@@ -849,10 +919,8 @@ Utility_StringWriteHex(
 
 	do
 	{
-		unsigned int unDestinationSize = 0;
+		unsigned int unLength = 0;
 		unsigned int unIndex = 0;
-		wchar_t wszHelper[HEX_STRING_OUT_LENGTH * 2] = {0};
-		unsigned int unHelperSize = RG_LEN(wszHelper);
 
 		if (NULL == PrgbHexData || NULL == PwszFormattedHexData || NULL == PpunFormattedHexDataSize || *PpunFormattedHexDataSize == 0)
 		{
@@ -862,87 +930,38 @@ Utility_StringWriteHex(
 		}
 
 		PwszFormattedHexData[0] = '\0';
+		unReturnValue = RC_SUCCESS;
 
-		// Log buffer content
-		for (unIndex = 0; unIndex < PunSize; unIndex++)
+		// Format the buffer content line by line, lines are separated by \n
+		for (unIndex = 0; unIndex < PunSize; unIndex += LOGGING_HEX_CHARS_PER_LINE)
 		{
-			// Line header
-			if (unIndex % LOGGING_HEX_CHARS_PER_LINE == 0)
-			{
-				// Add a new line to the beginning of each hex line written except the first one
-				unDestinationSize = *PpunFormattedHexDataSize;
-				if (unIndex != 0)
-				{
-					unsigned int unLength = 0;
-					unsigned int unSize = 0;
-					unReturnValue = Platform_StringGetLength(PwszFormattedHexData, unDestinationSize, &unLength);
-					if (RC_SUCCESS != unReturnValue)
-					{
-						ERROR_STORE(unReturnValue, L"Platform_StringGetLength returned an unexpected value.");
-						break;
-					}
-					unSize = *PpunFormattedHexDataSize - unLength;
-					unReturnValue = Platform_StringFormat(&PwszFormattedHexData[unLength], &unSize, L"\n");
-					if (RC_SUCCESS != unReturnValue)
-					{
-						ERROR_STORE(unReturnValue, L"Platform_StringFormat returned an unexpected value.");
-						break;
-					}
-				}
-
-				// Convert current byte to string
-				unHelperSize = HEX_STRING_OUT_LENGTH * 2;
-				unReturnValue = Platform_StringFormat(wszHelper, &unHelperSize, L"%.4X: ", unIndex);
-				if (RC_SUCCESS != unReturnValue)
-				{
-					ERROR_STORE(unReturnValue, L"Platform_StringFormat returned an unexpected value.");
-					break;
-				}
+			wchar_t wszLine[LOGGING_HEX_LINE_LENGTH];
+			unsigned int unLineLength = Utility_StringWriteHexLine(PrgbHexData, PunSize, unIndex, wszLine);
+			unsigned int unSeparatorLength = (0 != unIndex) ? 1 : 0;
 
-				// Add header to output
-				unDestinationSize = *PpunFormattedHexDataSize;
-				unReturnValue = Platform_StringConcatenate(PwszFormattedHexData, &unDestinationSize, wszHelper);
-				if (RC_SUCCESS != unReturnValue)
-				{
-					ERROR_STORE(unReturnValue, L"Platform_StringConcatenate returned an unexpected value.");
-					break;
-				}
-			}
-
-			// Hex characters
-			unHelperSize = HEX_STRING_OUT_LENGTH;
-			unReturnValue = Platform_StringFormat(wszHelper, &unHelperSize, L"%.2X ", PrgbHexData[unIndex]);
-			if (RC_SUCCESS != unReturnValue)
+			if (*PpunFormattedHexDataSize - unLength <= unSeparatorLength + unLineLength)
 			{
-				ERROR_STORE(unReturnValue, L"Platform_StringFormat returned an unexpected value.");
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				ERROR_STORE(unReturnValue, L"Output buffer is too small.");
 				break;
 			}
 
-			// Concatenate string for current byte with string for previous bytes
-			unDestinationSize = *PpunFormattedHexDataSize;
-			unReturnValue = Platform_StringConcatenate(PwszFormattedHexData, &unDestinationSize, wszHelper);
+			if (0 != unSeparatorLength)
+				PwszFormattedHexData[unLength++] = L'\n';
+			unReturnValue = Platform_MemoryCopy(&PwszFormattedHexData[unLength], (*PpunFormattedHexDataSize - unLength) * sizeof(wchar_t), wszLine, unLineLength * sizeof(wchar_t));
 			if (RC_SUCCESS != unReturnValue)
 			{
-				ERROR_STORE(unReturnValue, L"Platform_StringConcatenate returned an unexpected value.");
+				ERROR_STORE(unReturnValue, L"Platform_MemoryCopy returned an unexpected value.");
 				break;
 			}
-
-			// Additional space after 8th character
-			if ((int)unIndex % LOGGING_HEX_CHARS_PER_LINE == LOGGING_HEX_CHARS_PER_LINE / 2 - 1)
-			{
-				// Concatenate string for current byte with string for previous bytes
-				unDestinationSize = *PpunFormattedHexDataSize;
-				unReturnValue = Platform_StringConcatenate(PwszFormattedHexData, &unDestinationSize, L" ");
-				if (RC_SUCCESS != unReturnValue)
-				{
-					ERROR_STORE(unReturnValue, L"Platform_StringConcatenate returned an unexpected value.");
-					break;
-				}
-			}
+			unLength += unLineLength;
 		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
 
 		// Update output size
-		unReturnValue = Platform_StringGetLength(PwszFormattedHexData, *PpunFormattedHexDataSize, PpunFormattedHexDataSize);
+		PwszFormattedHexData[unLength] = L'\0';
+		*PpunFormattedHexDataSize = unLength;
 	}
 	WHILE_FALSE_END;
 
@@ -958,6 +977,148 @@ Utility_StringWriteHex(
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Escapes a string for use as JSON string value
+ *	@details	Quotation marks, backslashes and control characters are escaped. The enclosing quotation marks are not
+ *				added. In case the destination buffer is too small, as many characters as fit are escaped completely and
+ *				RC_E_BUFFER_TOO_SMALL is returned. The destination is zero terminated in any case.
+ *
+ *	@param		PwszSource					Pointer to the string to escape, does not need to be zero terminated
+ *	@param		PunSourceLength				Length of the string in elements (the string ends earlier at a zero termination)
+ *	@param		PwszDestination				Pointer to the buffer receiving the escaped string
+ *	@param		PpunDestinationSize			In:		Capacity of the destination buffer in elements including the zero termination\n
+ *											Out:	Length of the escaped string in elements without zero termination
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. It was either NULL or invalid.
+ *	@retval		RC_E_BUFFER_TOO_SMALL		In case the destination buffer is too small, the escaped string is truncated
+ */
+_Check_return_
+unsigned int
+Utility_StringEscapeJson(
+	_In_reads_or_z_(PunSourceLength)			const wchar_t*	PwszSource,
+	_In_										unsigned int	PunSourceLength,
+	_Out_z_cap_(*PpunDestinationSize)			wchar_t*		PwszDestination,
+	_Inout_										unsigned int*	PpunDestinationSize)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unIndex = 0;
+	unsigned int unLength = 0;
+
+	do
+	{
+		// Check parameters
+		if (NULL == PwszSource || NULL == PwszDestination || NULL == PpunDestinationSize || 0 == *PpunDestinationSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		for (unIndex = 0; unIndex < PunSourceLength && L'\0' != PwszSource[unIndex]; unIndex++)
+		{
+			wchar_t wcCharacter = PwszSource[unIndex];
+			wchar_t wcEscape = L'\0';
+			unsigned int unNeeded = 1;
+
+			// Determine the escape sequence of the character
+			switch (wcCharacter)
+			{
+				case L'"':	wcEscape = L'"'; break;
+				case L'\\':	wcEscape = L'\\'; break;
+				case L'\b':	wcEscape = L'b'; break;
+				case L'\f':	wcEscape = L'f'; break;
+				case L'\n':	wcEscape = L'n'; break;
+				case L'\r':	wcEscape = L'r'; break;
+				case L'\t':	wcEscape = L't'; break;
+				default:		break;
+			}
+			if (L'\0' != wcEscape)
+				unNeeded = 2;
+			else if (wcCharacter < 0x20)
+				unNeeded = 6;
+
+			// Keep space for the zero termination
+			if (unLength + unNeeded >= *PpunDestinationSize)
+			{
+				unReturnValue = RC_E_BUFFER_TOO_SMALL;
+				break;
+			}
+
+			if (1 == unNeeded)
+				PwszDestination[unLength++] = wcCharacter;
+			else
+			{
+				PwszDestination[unLength++] = L'\\';
+				if (L'\0' != wcEscape)
+					PwszDestination[unLength++] = wcEscape;
+				else
+				{
+					// Other control characters as \u00XX
+					PwszDestination[unLength++] = L'u';
+					PwszDestination[unLength++] = L'0';
+					PwszDestination[unLength++] = L'0';
+					PwszDestination[unLength++] = s_wszHexDigits[(wcCharacter >> 4) & 0x0F];
+					PwszDestination[unLength++] = s_wszHexDigits[wcCharacter & 0x0F];
+				}
+			}
+		}
+
+		PwszDestination[unLength] = L'\0';
+		*PpunDestinationSize = unLength;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Formats one line of a hex dump
+ *	@details	The line has the format used by Utility_StringWriteHex: the offset with at least four hex digits, a colon and
+ *				up to LOGGING_HEX_CHARS_PER_LINE bytes separated by spaces with an additional space after the 8th byte.
+ *				The digits are taken from a lookup table, no format string is parsed.
+ *
+ *	@param		PrgbHexData					Pointer to a buffer with the data
+ *	@param		PunSize						Count of byte in the input buffer in elements
+ *	@param		PunOffset					Offset of the first byte of the line in the buffer
+ *	@param		PwszLine					Pointer to a buffer of at least LOGGING_HEX_LINE_LENGTH elements receiving the
+ *											line. The line is not zero terminated.
+ *	@returns	Length of the line in elements
+ */
+unsigned int
+Utility_StringWriteHexLine(
+	_In_bytecount_(PunSize)						const BYTE*		PrgbHexData,
+	_In_										unsigned int	PunSize,
+	_In_										unsigned int	PunOffset,
+	_Out_cap_(LOGGING_HEX_LINE_LENGTH)			wchar_t*		PwszLine)
+{
+	unsigned int unLength = 0;
+	unsigned int unDigits = 4;
+	unsigned int unByte = 0;
+
+	// Line header
+	while (unDigits < 8 && 0 != (PunOffset >> (4 * unDigits)))
+		unDigits++;
+	while (0 != unDigits)
+	{
+		unDigits--;
+		PwszLine[unLength++] = s_wszHexDigits[(PunOffset >> (4 * unDigits)) & 0x0F];
+	}
+	PwszLine[unLength++] = L':';
+	PwszLine[unLength++] = L' ';
+
+	for (unByte = PunOffset; unByte < PunSize && unByte - PunOffset < LOGGING_HEX_CHARS_PER_LINE; unByte++)
+	{
+		PwszLine[unLength++] = s_wszHexDigits[PrgbHexData[unByte] >> 4];
+		PwszLine[unLength++] = s_wszHexDigits[PrgbHexData[unByte] & 0x0F];
+		PwszLine[unLength++] = L' ';
+
+		// Additional space after 8th character
+		if (unByte % LOGGING_HEX_CHARS_PER_LINE == LOGGING_HEX_CHARS_PER_LINE / 2 - 1)
+			PwszLine[unLength++] = L' ';
+	}
+
+	return unLength;
+}
+
 /**
  *	@brief		Splits the given wide character Line
  *	@details	The function splits up large lines regarding the maximum line character count and
@@ -1343,8 +1504,10 @@ Utility_StringRemoveComment(
 					continue;
 				}
 			}
+			// "//" after a colon is part of a URL (e.g. https://) and no comment
 			else if ((L'/' == PwszLineBuffer[unIndex]) &&
-					 (L'/' == PwszLineBuffer[unIndex + 1]))
+					 (L'/' == PwszLineBuffer[unIndex + 1]) &&
+					 !(0 < unIndex && L':' == PwszLineBuffer[unIndex - 1]))
 			{
 				unIndex++;
 				break;
@@ -1507,6 +1670,115 @@ Utility_GetTimestamp(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Gets a time-stamp without date and with milliseconds for log lines as string.
+ *	@details	The time-stamp has the format [hh:mm:ss.mmm] of Utility_GetTimestamp. The wall clock time is only read and
+ *				converted to the local time when the second changes. In between the time is advanced by the monotonic clock
+ *				and only the milliseconds are formatted. Falls back to Utility_GetTimestamp in case no monotonic clock is available.
+ *				Not thread safe, like the logging functions using it.
+ *
+ *	@param		PwszValue				Pointer to a wide character buffer to fill in the value.
+ *	@param		PpunValueSize			In:		Size of the value buffer in elements including the zero termination.\n
+ *										Out:	Length of the filled in value in elements without zero termination.
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	In case of any output buffer size is too small
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Utility_GetLogTimestamp(
+	_Out_z_cap_(*PpunValueSize)	wchar_t*		PwszValue,
+	_Inout_						unsigned int*	PpunValueSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned long long ullMonotonicTime = 0;
+		unsigned long long ullTime = 0;
+		unsigned int unMilliSeconds = 0;
+		unsigned int unIndex = 0;
+
+		// Parameter check
+		if (NULL == PwszValue || NULL == PpunValueSize || 0 == *PpunValueSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"One or more parameters are invalid");
+			break;
+		}
+
+		// Use the uncached time-stamp if no monotonic clock is available
+		ullMonotonicTime = Platform_GetMonotonicTimeMicroSeconds();
+		if (0 == ullMonotonicTime)
+		{
+			unReturnValue = Utility_GetTimestamp(FALSE, PwszValue, PpunValueSize);
+			break;
+		}
+
+		// Advance the wall clock time of the last synchronization by the monotonic clock
+		ullTime = s_ullTimestampSyncTime + (ullMonotonicTime - s_ullTimestampSyncMonotonicTime);
+
+		// Reformat the cached time-stamp prefix if the second has changed (also resynchronizes with the wall clock)
+		if (0 == s_unTimestampCacheLength || ullTime / 1000000 != s_ullTimestampCacheSecond)
+		{
+			IfxTime sTime = {0};
+			unsigned int unCacheSize = RG_LEN(s_wszTimestampCache);
+
+			s_unTimestampCacheLength = 0;
+			ullTime = Platform_GetTimeMicroSeconds();
+			unReturnValue = Platform_ConvertTime(ullTime, &sTime);
+			if (0 == ullTime || RC_SUCCESS != unReturnValue)
+			{
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Platform_ConvertTime failed");
+				break;
+			}
+
+			unReturnValue = Platform_StringFormat(s_wszTimestampCache, &unCacheSize, L"[%02d:%02d:%02d.", sTime.unHour, sTime.unMinute, sTime.unSecond);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Platform_StringFormat failed");
+				break;
+			}
+
+			s_unTimestampCacheLength = unCacheSize;
+			s_ullTimestampCacheSecond = ullTime / 1000000;
+			s_ullTimestampSyncTime = ullTime;
+			s_ullTimestampSyncMonotonicTime = ullMonotonicTime;
+		}
+
+		// Check output buffer size for prefix, milliseconds, closing bracket and zero termination
+		if (*PpunValueSize < s_unTimestampCacheLength + UTILITY_TIMESTAMP_MILLISECOND_DIGITS + 2)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			ERROR_STORE(unReturnValue, L"Output buffer is too small");
+			break;
+		}
+
+		// Copy the cached prefix and append the milliseconds
+		unReturnValue = Platform_MemoryCopy(PwszValue, *PpunValueSize * sizeof(wchar_t), s_wszTimestampCache, s_unTimestampCacheLength * sizeof(wchar_t));
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Platform_MemoryCopy failed");
+			break;
+		}
+
+		unMilliSeconds = (unsigned int)(ullTime % 1000000 / 1000);
+		for (unIndex = UTILITY_TIMESTAMP_MILLISECOND_DIGITS; unIndex > 0; unIndex--)
+		{
+			PwszValue[s_unTimestampCacheLength + unIndex - 1] = (wchar_t)(L'0' + unMilliSeconds % 10);
+			unMilliSeconds /= 10;
+		}
+		*PpunValueSize = s_unTimestampCacheLength + UTILITY_TIMESTAMP_MILLISECOND_DIGITS;
+		PwszValue[(*PpunValueSize)++] = L']';
+		PwszValue[*PpunValueSize] = L'\0';
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
 #ifndef NO_INI_FILES
 
 //<---------------------------------------------------------------------------------------------
@@ -2087,10 +2359,8 @@ Utility_StringParseULongLong(
 
 /**
  *	@brief		Check if the configured log path is accessible and writable
- *	@details
- *
- *	@param		PfRemoveFileIfNotExistsBefore	TRUE: Remove file after check if it does not exist before
- *												FALSE: Do not remove the file anyway
+ *	@details	Only the access rights of the log file or, if it does not exist yet, of its directory are checked. The log
+ *				file itself is created by the first log message and kept open, so a successful run opens it only once.
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_FAIL				An unexpected error occurred.
@@ -2100,8 +2370,7 @@ Utility_StringParseULongLong(
  */
 _Check_return_
 unsigned int
-Utility_CheckIfLogPathWritable(
-	BOOL PfRemoveFileIfNotExistsBefore)
+Utility_CheckIfLogPathWritable()
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
@@ -2110,47 +2379,21 @@ Utility_CheckIfLogPathWritable(
 		// Check if we can open the log file for writing...
 		wchar_t wszLogFilePath[MAX_STRING_1024] = {0};
 		unsigned int unLogFilePathSize = RG_LEN(wszLogFilePath);
-		unsigned int unFileAccessMode = 0;
-		void* pvFileHandle = NULL;
 
-		if (!PropertyStorage_GetValueByKey(PROPERTY_LOGGING_PATH, wszLogFilePath, &unLogFilePathSize))
+		if (!PropertyStorage_GetValueById(PROPERTY_ID_LOGGING_PATH, wszLogFilePath, &unLogFilePathSize))
 		{
 			unReturnValue = RC_E_FAIL;
 			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", PROPERTY_LOGGING_PATH);
 			break;
 		}
 
-		unFileAccessMode = FileIO_Exists(wszLogFilePath) ? FILE_APPEND : FILE_WRITE;
-		// Verify that logging to given path is possible
-		unReturnValue = FileIO_Open(wszLogFilePath, &pvFileHandle, unFileAccessMode);
+		// Verify that logging to given path is possible without creating the log file
+		unReturnValue = FileIO_CheckWritable(wszLogFilePath);
 		if (RC_SUCCESS != unReturnValue)
 		{
-			ERROR_STORE(unReturnValue, L"FileIO_Open returned an unexpected value.");
+			ERROR_STORE(unReturnValue, L"FileIO_CheckWritable returned an unexpected value.");
 			break;
 		}
-
-		// Close file handle
-		if (NULL != pvFileHandle)
-		{
-			unReturnValue = FileIO_Close(&pvFileHandle);
-			if (RC_SUCCESS != unReturnValue)
-				ERROR_STORE(unReturnValue, L"Closing log file failed.");
-
-			// No break because removing of file should be tried
-		}
-
-		if (TRUE == PfRemoveFileIfNotExistsBefore &&
-				FILE_WRITE == unFileAccessMode)
-		{
-			unsigned int unRemoveReturnValue = RC_E_FAIL;
-			unRemoveReturnValue = FileIO_Remove(wszLogFilePath);
-			if (RC_SUCCESS != unRemoveReturnValue &&
-					RC_SUCCESS == unReturnValue)
-			{
-				unReturnValue = unRemoveReturnValue;
-				ERROR_STORE(unReturnValue, L"Removing created log file while path testing failed.");
-			}
-		}
 	}
 	WHILE_FALSE_END;
 
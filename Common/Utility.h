@@ -63,6 +63,30 @@ Utility_StringGetLine(
 	_Inout_							wchar_t**		PpwszLine,
 	_Out_							unsigned int*	PpunLineSize);
 
+/**
+ *	@brief		Gets a line from a buffer without copying it.
+ *	@details	This function searches for a line end ('\n', '\r\n' or '\0') and returns a view into the buffer.
+ *				The line is not zero terminated, so it must be used with its length.
+ *
+ *	@param		PwszBuffer				String buffer to get the line from
+ *	@param		PunSize					Length of the string buffer in elements (incl. zero termination)
+ *	@param		PpunIndex				In: Position to start searching in the string buffer\n
+ *										Out: Position in the string for the next search
+ *	@param		PppwszLine				Receives the start of the line in the string buffer
+ *	@param		PpunLineLength			Receives the length of the line in elements without line end
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_END_OF_STRING		In case the end of the string was reached
+ */
+_Check_return_
+unsigned int
+Utility_StringGetLineView(
+	_In_z_count_(PunSize)			const wchar_t*	PwszBuffer,
+	_In_							unsigned int	PunSize,
+	_Inout_							unsigned int*	PpunIndex,
+	_Out_							const wchar_t**	PppwszLine,
+	_Out_							unsigned int*	PpunLineLength);
+
 /**
  *	@brief		Returns the index of the first occurrence of the searched character
  *	@details
@@ -243,6 +267,26 @@ Utility_StringRemoveWhiteChars(
 	_Inout_z_	wchar_t*		PwszBuffer,
 	_In_		unsigned int*	PpunBufferCapacity);
 
+/**
+ *	@brief		Formats one line of a hex dump
+ *	@details	The line has the format used by Utility_StringWriteHex: the offset with at least four hex digits, a colon and
+ *				up to LOGGING_HEX_CHARS_PER_LINE bytes separated by spaces with an additional space after the 8th byte.
+ *				The digits are taken from a lookup table, no format string is parsed.
+ *
+ *	@param		PrgbHexData					Pointer to a buffer with the data
+ *	@param		PunSize						Count of byte in the input buffer in elements
+ *	@param		PunOffset					Offset of the first byte of the line in the buffer
+ *	@param		PwszLine					Pointer to a buffer of at least LOGGING_HEX_LINE_LENGTH elements receiving the
+ *											line. The line is not zero terminated.
+ *	@returns	Length of the line in elements
+ */
+unsigned int
+Utility_StringWriteHexLine(
+	_In_bytecount_(PunSize)						const BYTE*		PrgbHexData,
+	_In_										unsigned int	PunSize,
+	_In_										unsigned int	PunOffset,
+	_Out_cap_(LOGGING_HEX_LINE_LENGTH)			wchar_t*		PwszLine);
+
 /**
  *	@brief		Prints data from a byte array to a string in formatted HEX style
  *	@details
@@ -265,6 +309,29 @@ Utility_StringWriteHex(
 	_Out_z_cap_(*PpunFormattedHexDataSize)		wchar_t*		PwszFormattedHexData,
 	_Inout_										unsigned int*	PpunFormattedHexDataSize);
 
+/**
+ *	@brief		Escapes a string for use as JSON string value
+ *	@details	Quotation marks, backslashes and control characters are escaped. The enclosing quotation marks are not
+ *				added. In case the destination buffer is too small, as many characters as fit are escaped completely and
+ *				RC_E_BUFFER_TOO_SMALL is returned. The destination is zero terminated in any case.
+ *
+ *	@param		PwszSource					Pointer to the string to escape, does not need to be zero terminated
+ *	@param		PunSourceLength				Length of the string in elements (the string ends earlier at a zero termination)
+ *	@param		PwszDestination				Pointer to the buffer receiving the escaped string
+ *	@param		PpunDestinationSize			In:		Capacity of the destination buffer in elements including the zero termination\n
+ *											Out:	Length of the escaped string in elements without zero termination
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function. It was either NULL or invalid.
+ *	@retval		RC_E_BUFFER_TOO_SMALL		In case the destination buffer is too small, the escaped string is truncated
+ */
+_Check_return_
+unsigned int
+Utility_StringEscapeJson(
+	_In_reads_or_z_(PunSourceLength)			const wchar_t*	PwszSource,
+	_In_										unsigned int	PunSourceLength,
+	_Out_z_cap_(*PpunDestinationSize)			wchar_t*		PwszDestination,
+	_Inout_										unsigned int*	PpunDestinationSize);
+
 /**
  *	@brief		Splits the given wide character Line
  *	@details	The function splits up large lines regarding the maximum line character count and
@@ -386,6 +453,27 @@ Utility_GetTimestamp(
 	_In_						BOOL			PfDate,
 	_Out_z_cap_(*PpunValueSize)	wchar_t*		PwszValue,
 	_Inout_						unsigned int*	PpunValueSize);
+
+/**
+ *	@brief		Gets a time-stamp without date and with milliseconds for log lines as string.
+ *	@details	The time-stamp has the format [hh:mm:ss.mmm] of Utility_GetTimestamp. The wall clock time is only read and
+ *				converted to the local time when the second changes. In between the time is advanced by the monotonic clock
+ *				and only the milliseconds are formatted. Falls back to Utility_GetTimestamp in case no monotonic clock is available.
+ *				Not thread safe, like the logging functions using it.
+ *
+ *	@param		PwszValue				Pointer to a wide character buffer to fill in the value.
+ *	@param		PpunValueSize			In:		Size of the value buffer in elements including the zero termination.\n
+ *										Out:	Length of the filled in value in elements without zero termination.
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. It was either NULL or not initialized correctly.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	In case of any output buffer size is too small
+ *	@retval		RC_E_FAIL				An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+Utility_GetLogTimestamp(
+	_Out_z_cap_(*PpunValueSize)	wchar_t*		PwszValue,
+	_Inout_						unsigned int*	PpunValueSize);
 #ifndef NO_INI_FILES
 
 //<---------------------------------------------------------------------------------------------
@@ -528,10 +616,8 @@ Utility_StringParseULongLong(
 
 /**
  *	@brief		Check if the configured log path is accessible and writable
- *	@details
- *
- *	@param		PfRemoveFileIfNotExistsBefore	TRUE: Remove file after check if it does not exist before
- *												FALSE: Do not remove the file anyway
+ *	@details	Only the access rights of the log file or, if it does not exist yet, of its directory are checked. The log
+ *				file itself is created by the first log message and kept open, so a successful run opens it only once.
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_FAIL				An unexpected error occurred.
@@ -541,8 +627,7 @@ Utility_StringParseULongLong(
  */
 _Check_return_
 unsigned int
-Utility_CheckIfLogPathWritable(
-	BOOL PfRemoveFileIfNotExistsBefore);
+Utility_CheckIfLogPathWritable();
 #endif
 
 //<---------------------------------------------------------------------------------------------
@@ -0,0 +1,792 @@
+﻿/**
+ *	@brief		Implements the command flow to benchmark the host side of a firmware update.
+ *	@details	This module runs the firmware update command flow against an in-process simulation of a TPM1.2 in
+ *				boot loader mode. The simulation answers each command immediately, so the measured times are spent
+ *				on the host: image parsing, request marshalling, logging and progress output.
+ *	@file		CommandFlow_Benchmark.c
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CommandFlow_Benchmark.h"
+#include "DeviceManagement.h"
+#include "FirmwareUpdate.h"
+#include "Response.h"
+#include "TPM2_Marshal.h"
+#include "TPM2_FieldUpgradeMarshal.h"
+#include "TPM_Types.h"
+#include "TPM_GetCapability.h"
+#include "TPM_FieldUpgradeInfoRequest2.h"
+#include "Crypt.h"
+
+/// Size of a TPM command or response header (tag, size and ordinal or return code)
+#define BENCHMARK_HEADER_SIZE					10
+/// Offset of the sub command in a TPM_FieldUpgrade request
+#define BENCHMARK_SUB_COMMAND_OFFSET			10
+/// Offset of the capability area in a TPM_GetCapability request
+#define BENCHMARK_CAP_AREA_OFFSET				10
+/// Size of the marshalled sSecurityModuleLogicInfo_d structure without firmware packages
+#define BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE	82
+/// Offset of wMaxDataSize in the marshalled sSecurityModuleLogicInfo_d structure
+#define BENCHMARK_MAX_DATA_SIZE_OFFSET			2
+/// Offset of SecurityModuleStatus in the marshalled sSecurityModuleLogicInfo_d structure
+#define BENCHMARK_SECURITY_MODULE_STATUS_OFFSET	58
+/// Maximum firmware block size reported by the simulated TPM
+#define BENCHMARK_MAX_DATA_SIZE					1024
+/// Number of iterations of each microbenchmark
+#define BENCHMARK_MICRO_ITERATIONS				10000
+/// Size of the string buffer of the string microbenchmarks in elements
+#define BENCHMARK_MICRO_STRING_SIZE				256
+/// Size of the input data of the checksum and hex dump microbenchmarks
+#define BENCHMARK_MICRO_DATA_SIZE				1024
+/// Number of bytes written by the hex dump microbenchmark
+#define BENCHMARK_MICRO_HEX_SIZE				32
+/// Property read and changed by the PropertyStorage microbenchmarks
+#define BENCHMARK_MICRO_PROPERTY				L"BenchmarkMicro"
+
+/// Input text of the string microbenchmarks
+static const wchar_t s_wszMicroText[] = L"[LOGGING]\nLEVEL=1\nPATH=TPMFactoryUpd.log\n";
+/// Input line of the INI microbenchmark
+static const wchar_t s_wszMicroIniLine[] = L"PATH=TPMFactoryUpd.log";
+/// Input number of the Utility_StringParseUInteger microbenchmark
+static const wchar_t s_wszMicroUInteger[] = L"4294967295";
+/// Input number of the Utility_StringParseULongLong microbenchmark
+static const wchar_t s_wszMicroULongLong[] = L"18446744073709551615";
+
+/// TPM_GetCapability(TPM_CAP_VERSION_VAL) response parameters of the simulated TPM: TPM1.2 manufactured by Infineon
+static const BYTE s_rgbVersionInfo[] = {
+	0x00, 0x00, 0x00, 0x0F,		// Size of TPM_CAP_VERSION_INFO
+	0x00, 0x30,					// TPM_TAG_CAP_VERSION_INFO
+	0x01, 0x02, 0x04, 0x28,		// TPM_VERSION
+	0x00, 0x02,					// specLevel
+	0x03,						// errataRev
+	'I', 'F', 'X', 0x00,		// tpmVendorID
+	0x00, 0x00					// vendorSpecificSize
+};
+
+/**
+ *	@brief		State of the simulated TPM
+ */
+typedef struct tdIfxBenchmarkTransport
+{
+	/// Number of TPM commands answered
+	unsigned int			unCommandCount;
+	/// Number of TPM_FieldUpgradeUpdate commands answered
+	unsigned int			unBlockCount;
+	/// Monotonic time stamp in microseconds when the first TPM_FieldUpgradeUpdate command was received
+	unsigned long long		ullFirstBlockTime;
+	/// Monotonic time stamp in microseconds when the last TPM_FieldUpgradeUpdate command was answered
+	unsigned long long		ullLastBlockTime;
+} IfxBenchmarkTransport;
+
+/// State of the simulated TPM
+static IfxBenchmarkTransport s_sTransport = {0};
+
+/**
+ *	@brief		Input data of the microbenchmarks
+ */
+typedef struct tdIfxBenchmarkMicroData
+{
+	/// Firmware image
+	BYTE*					rgbFirmwareImage;
+	/// Size of the firmware image
+	unsigned int			unFirmwareImageSize;
+	/// Unmarshalled firmware image; its buffers point into rgbFirmwareImage
+	const IfxFirmwareImage*	psFirmwareImage;
+	/// Marshalled sSecurityModuleLogicInfo_d structure as reported by the simulated TPM
+	BYTE					rgbSecurityModuleLogicInfo[BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE];
+	/// Marshal buffer
+	BYTE					rgbBuffer[sizeof(TPM2B_DIGEST)];
+	/// Input data of the checksum and hex dump microbenchmarks
+	BYTE					rgbData[BENCHMARK_MICRO_DATA_SIZE];
+	/// Output buffer of the string microbenchmarks
+	wchar_t					wszBuffer[BENCHMARK_MICRO_STRING_SIZE];
+} IfxBenchmarkMicroData;
+
+/**
+ *	@brief		A single operation of a microbenchmark
+ *
+ *	@param		PpData		Input data of the microbenchmarks
+ *	@retval		RC_SUCCESS	The operation completed successfully.
+ *	@retval		...			Error codes from the measured function.
+ */
+typedef unsigned int (*PFN_BENCHMARK_MICRO_OPERATION)(
+	_Inout_	IfxBenchmarkMicroData*	PpData);
+
+/**
+ *	@brief		Fills a marshalled sSecurityModuleLogicInfo_d structure reporting the active boot loader
+ *
+ *	@param		PrgbInfo	Zero initialized buffer for the structure
+ */
+static void
+CommandFlow_Benchmark_FillSecurityModuleLogicInfo(
+	_Inout_bytecap_(BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE)	BYTE	PrgbInfo[BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE])
+{
+	PrgbInfo[BENCHMARK_MAX_DATA_SIZE_OFFSET] = (BYTE)(BENCHMARK_MAX_DATA_SIZE >> 8);
+	PrgbInfo[BENCHMARK_MAX_DATA_SIZE_OFFSET + 1] = (BYTE)BENCHMARK_MAX_DATA_SIZE;
+	PrgbInfo[BENCHMARK_SECURITY_MODULE_STATUS_OFFSET] = (BYTE)(SMS_BTLDR_ACTIVE >> 8);
+	PrgbInfo[BENCHMARK_SECURITY_MODULE_STATUS_OFFSET + 1] = (BYTE)SMS_BTLDR_ACTIVE;
+}
+
+/**
+ *	@brief		Writes a response of the simulated TPM
+ *
+ *	@param		PunResponseCode			TPM1.2 return code
+ *	@param		PrgbParameters			Response parameters, may be NULL if PunParametersSize is 0
+ *	@param		PunParametersSize		Size of the response parameters
+ *	@param		PrgbResponseBuffer		Response buffer
+ *	@param		PpunResponseBufferSize	IN: Response buffer size
+ *										OUT: Response size
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BUFFER_TOO_SMALL	The response buffer is too small.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_Benchmark_WriteResponse(
+	_In_									TPM_RESULT		PunResponseCode,
+	_In_opt_bytecount_(PunParametersSize)	const BYTE*		PrgbParameters,
+	_In_									unsigned int	PunParametersSize,
+	_Out_bytecap_(*PpunResponseBufferSize)	BYTE*			PrgbResponseBuffer,
+	_Inout_									unsigned int*	PpunResponseBufferSize)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		BYTE* pbBuffer = PrgbResponseBuffer;
+		INT32 nSizeRemaining = (INT32)*PpunResponseBufferSize;
+		UINT16 usTag = TPM_TAG_RSP_COMMAND;
+		UINT32 unResponseSize = BENCHMARK_HEADER_SIZE + PunParametersSize;
+
+		if (*PpunResponseBufferSize < unResponseSize)
+		{
+			unReturnValue = RC_E_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		unReturnValue = TSS_UINT16_Marshal(&usTag, &pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT32_Marshal(&unResponseSize, &pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT32_Marshal(&PunResponseCode, &pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (0 != PunParametersSize)
+		{
+			unReturnValue = Platform_MemoryCopy(pbBuffer, (unsigned int)nSizeRemaining, PrgbParameters, PunParametersSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		*PpunResponseBufferSize = unResponseSize;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Transmit function of the simulated TPM
+ *	@details	Emulates a TPM1.2 in boot loader mode: TPM2.0 commands fail with TPM_BADTAG, TPM_Startup fails with
+ *				TPM_FAILEDSELFTEST and the field upgrade commands needed to continue a firmware update succeed.
+ *
+ *	@param		PrgbRequestBuffer		Request buffer
+ *	@param		PunRequestBufferSize	Request buffer size
+ *	@param		PrgbResponseBuffer		Response buffer
+ *	@param		PpunResponseBufferSize	IN: Response buffer size
+ *										OUT: Response size
+ *	@param		PunMaxDuration			Ignored
+ *	@param		PunExpectedDuration		Ignored
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		The request is too short.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_Benchmark_Transmit(
+	_In_bytecount_(PunRequestBufferSize)	const BYTE*		PrgbRequestBuffer,
+	_In_									unsigned int	PunRequestBufferSize,
+	_Out_bytecap_(*PpunResponseBufferSize)	BYTE*			PrgbResponseBuffer,
+	_Inout_									unsigned int*	PpunResponseBufferSize,
+	_In_									unsigned int	PunMaxDuration,
+	_In_									unsigned int	PunExpectedDuration)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	UNREFERENCED_PARAMETER(PunMaxDuration);
+	UNREFERENCED_PARAMETER(PunExpectedDuration);
+
+	do
+	{
+		BYTE* pbBuffer = (BYTE*)PrgbRequestBuffer;
+		INT32 nSizeRemaining = (INT32)PunRequestBufferSize;
+		UINT16 usTag = 0;
+		UINT32 unCommandSize = 0;
+		UINT32 unOrdinal = 0;
+
+		if (NULL == PrgbRequestBuffer || PunRequestBufferSize < BENCHMARK_HEADER_SIZE)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		unReturnValue = TSS_UINT16_Unmarshal(&usTag, &pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT32_Unmarshal(&unCommandSize, &pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = TSS_UINT32_Unmarshal(&unOrdinal, &pbBuffer, &nSizeRemaining);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		s_sTransport.unCommandCount++;
+
+		// A TPM1.2 does not understand TPM2.0 commands
+		if (TPM_ST_NO_SESSIONS == usTag || TPM_ST_SESSIONS == usTag)
+		{
+			unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_BADTAG, NULL, 0, PrgbResponseBuffer, PpunResponseBufferSize);
+			break;
+		}
+
+		// The boot loader fails the self test and reports its version
+		if (TPM_ORD_Startup == unOrdinal)
+		{
+			unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_FAILEDSELFTEST, NULL, 0, PrgbResponseBuffer, PpunResponseBufferSize);
+			break;
+		}
+		if (TPM_ORD_GetCapability == unOrdinal)
+		{
+			UINT32 unCapArea = 0;
+			unReturnValue = TSS_UINT32_Unmarshal(&unCapArea, &pbBuffer, &nSizeRemaining);
+			if (RC_SUCCESS == unReturnValue && TPM_CAP_VERSION_VAL == unCapArea)
+				unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_RC_SUCCESS, s_rgbVersionInfo, sizeof(s_rgbVersionInfo), PrgbResponseBuffer, PpunResponseBufferSize);
+			else
+				unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_FAILEDSELFTEST, NULL, 0, PrgbResponseBuffer, PpunResponseBufferSize);
+			break;
+		}
+
+		if (TPM_CC_FieldUpgradeCommand != unOrdinal || PunRequestBufferSize <= BENCHMARK_SUB_COMMAND_OFFSET)
+		{
+			unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_BAD_ORDINAL, NULL, 0, PrgbResponseBuffer, PpunResponseBufferSize);
+			break;
+		}
+
+		switch (PrgbRequestBuffer[BENCHMARK_SUB_COMMAND_OFFSET])
+		{
+			case TPM_FieldUpgradeInfoRequest2:
+			{
+				// Size followed by a sSecurityModuleLogicInfo_d structure reporting the active boot loader
+				BYTE rgbParameters[sizeof(UINT16) + BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE] = {0};
+				rgbParameters[0] = (BYTE)(BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE >> 8);
+				rgbParameters[1] = (BYTE)BENCHMARK_SECURITY_MODULE_LOGIC_INFO_SIZE;
+				CommandFlow_Benchmark_FillSecurityModuleLogicInfo(rgbParameters + sizeof(UINT16));
+				unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_RC_SUCCESS, rgbParameters, sizeof(rgbParameters), PrgbResponseBuffer, PpunResponseBufferSize);
+				break;
+			}
+			case TPM_FieldUpgradeUpdate:
+			{
+				if (0 == s_sTransport.unBlockCount)
+					s_sTransport.ullFirstBlockTime = Platform_GetMonotonicTimeMicroSeconds();
+				s_sTransport.unBlockCount++;
+				unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_RC_SUCCESS, NULL, 0, PrgbResponseBuffer, PpunResponseBufferSize);
+				s_sTransport.ullLastBlockTime = Platform_GetMonotonicTimeMicroSeconds();
+				break;
+			}
+			case TPM_FieldUpgradeComplete:
+			{
+				// Out complete size (zero)
+				BYTE rgbParameters[sizeof(UINT16)] = {0};
+				unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_RC_SUCCESS, rgbParameters, sizeof(rgbParameters), PrgbResponseBuffer, PpunResponseBufferSize);
+				break;
+			}
+			default:
+			{
+				unReturnValue = CommandFlow_Benchmark_WriteResponse(TPM_BAD_PARAMETER, NULL, 0, PrgbResponseBuffer, PpunResponseBufferSize);
+				break;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/// Microbenchmark: unmarshal the firmware image
+static unsigned int
+CommandFlow_Benchmark_MicroFirmwareImage(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	IfxFirmwareImage sFirmwareImage = {{0}};
+	BYTE* pbBuffer = PpData->rgbFirmwareImage;
+	INT32 nBufferSize = (INT32)PpData->unFirmwareImageSize;
+	return FirmwareImage_Unmarshal(&sFirmwareImage, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: unmarshal the firmware image as a view
+static unsigned int
+CommandFlow_Benchmark_MicroFirmwareImageView(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	IfxFirmwareImageView sFirmwareImageView = {0};
+	BYTE* pbBuffer = PpData->rgbFirmwareImage;
+	INT32 nBufferSize = (INT32)PpData->unFirmwareImageSize;
+	return FirmwareImage_UnmarshalView(&sFirmwareImageView, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: unmarshal the policy parameter block
+static unsigned int
+CommandFlow_Benchmark_MicroSignedData(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	sSignedData_d sSignedData = {0};
+	BYTE* pbBuffer = PpData->psFirmwareImage->rgbPolicyParameterBlock;
+	INT32 nBufferSize = PpData->psFirmwareImage->usPolicyParameterBlockSize;
+	return TSS_sSignedData_d_Unmarshal(&sSignedData, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: unmarshal the policy parameter block as a view
+static unsigned int
+CommandFlow_Benchmark_MicroSignedDataView(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	sSignedDataView_d sSignedData = {0};
+	BYTE* pbBuffer = PpData->psFirmwareImage->rgbPolicyParameterBlock;
+	INT32 nBufferSize = PpData->psFirmwareImage->usPolicyParameterBlockSize;
+	return TSS_sSignedData_d_UnmarshalView(&sSignedData, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: unmarshal the sSecurityModuleLogicInfo_d structure of the simulated TPM
+static unsigned int
+CommandFlow_Benchmark_MicroSecurityModuleLogicInfo(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	sSecurityModuleLogicInfo_d sInfo = {0};
+	BYTE* pbBuffer = PpData->rgbSecurityModuleLogicInfo;
+	INT32 nBufferSize = sizeof(PpData->rgbSecurityModuleLogicInfo);
+	return TSS_sSecurityModuleLogicInfo_d_Unmarshal(&sInfo, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: marshal a SHA-256 TPM2B_DIGEST
+static unsigned int
+CommandFlow_Benchmark_MicroDigestMarshal(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	TPM2B_DIGEST sDigest = {0};
+	BYTE* pbBuffer = PpData->rgbBuffer;
+	INT32 nBufferSize = sizeof(PpData->rgbBuffer);
+	sDigest.size = SHA256_DIGEST_SIZE;
+	return TSS_TPM2B_DIGEST_Marshal(&sDigest, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: unmarshal the TPM2B_DIGEST written by CommandFlow_Benchmark_MicroDigestMarshal
+static unsigned int
+CommandFlow_Benchmark_MicroDigestUnmarshal(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	TPM2B_DIGEST sDigest = {0};
+	BYTE* pbBuffer = PpData->rgbBuffer;
+	INT32 nBufferSize = sizeof(PpData->rgbBuffer);
+	return TSS_TPM2B_DIGEST_Unmarshal(&sDigest, &pbBuffer, &nBufferSize);
+}
+
+/// Microbenchmark: TPM_GetCapability(TPM_CAP_VERSION_VAL) against the simulated TPM
+static unsigned int
+CommandFlow_Benchmark_MicroGetCapability(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	BYTE rgbResponse[sizeof(s_rgbVersionInfo)] = {0};
+	UINT32 unResponseSize = sizeof(rgbResponse);
+	UNREFERENCED_PARAMETER(PpData);
+	return TSS_TPM_GetCapability(TPM_CAP_VERSION_VAL, 0, NULL, &unResponseSize, rgbResponse);
+}
+
+/// Microbenchmark: TPM_FieldUpgradeInfoRequest2 against the simulated TPM
+static unsigned int
+CommandFlow_Benchmark_MicroFieldUpgradeInfoRequest2(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	sSecurityModuleLogicInfo_d sInfo = {0};
+	UNREFERENCED_PARAMETER(PpData);
+	return TSS_TPM_FieldUpgradeInfoRequest2(&sInfo);
+}
+
+/// Microbenchmark: case-insensitive comparison of two equal strings
+static unsigned int
+CommandFlow_Benchmark_MicroStringCompare(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	UNREFERENCED_PARAMETER(PpData);
+	return 0 == Platform_StringCompare(L"TPMFactoryUpd_Benchmark_Compare", L"tpmfactoryupd_benchmark_compare", BENCHMARK_MICRO_STRING_SIZE, TRUE) ? RC_SUCCESS : RC_E_FAIL;
+}
+
+/// Microbenchmark: copy a multi-line string
+static unsigned int
+CommandFlow_Benchmark_MicroStringCopy(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unSize = RG_LEN(PpData->wszBuffer);
+	return Platform_StringCopy(PpData->wszBuffer, &unSize, s_wszMicroText);
+}
+
+/// Microbenchmark: concatenate a multi-line string to an empty string
+static unsigned int
+CommandFlow_Benchmark_MicroStringConcatenate(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unSize = RG_LEN(PpData->wszBuffer);
+	PpData->wszBuffer[0] = L'\0';
+	return Platform_StringConcatenate(PpData->wszBuffer, &unSize, s_wszMicroText);
+}
+
+/// Microbenchmark: format a string with a string, a hex and a decimal argument
+static unsigned int
+CommandFlow_Benchmark_MicroStringFormat(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unSize = RG_LEN(PpData->wszBuffer);
+	return Platform_StringFormat(PpData->wszBuffer, &unSize, L"%ls: 0x%.8X (%u)", L"Benchmark", RC_E_FAIL, BENCHMARK_MICRO_ITERATIONS);
+}
+
+/// Microbenchmark: get the first line of a multi-line string
+static unsigned int
+CommandFlow_Benchmark_MicroStringGetLine(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unIndex = 0;
+	unsigned int unLineSize = 0;
+	wchar_t* wszLine = NULL;
+	UNREFERENCED_PARAMETER(PpData);
+	unReturnValue = Utility_StringGetLine(s_wszMicroText, RG_LEN(s_wszMicroText), &unIndex, &wszLine, &unLineSize);
+	Platform_MemoryFree((void**)&wszLine);
+	return unReturnValue;
+}
+
+/// Microbenchmark: write BENCHMARK_MICRO_HEX_SIZE bytes as hex string
+static unsigned int
+CommandFlow_Benchmark_MicroStringWriteHex(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unSize = RG_LEN(PpData->wszBuffer);
+	return Utility_StringWriteHex(PpData->rgbData, BENCHMARK_MICRO_HEX_SIZE, PpData->wszBuffer, &unSize);
+}
+
+/// Microbenchmark: parse the largest unsigned int
+static unsigned int
+CommandFlow_Benchmark_MicroStringParseUInteger(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unNumber = 0;
+	UNREFERENCED_PARAMETER(PpData);
+	return Utility_StringParseUInteger(s_wszMicroUInteger, RG_LEN(s_wszMicroUInteger), &unNumber);
+}
+
+/// Microbenchmark: parse the largest unsigned long long
+static unsigned int
+CommandFlow_Benchmark_MicroStringParseULongLong(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned long long ullNumber = 0;
+	UNREFERENCED_PARAMETER(PpData);
+	return Utility_StringParseULongLong(s_wszMicroULongLong, RG_LEN(s_wszMicroULongLong), &ullNumber);
+}
+
+/// Microbenchmark: split an INI line into key and value
+static unsigned int
+CommandFlow_Benchmark_MicroIniGetKeyValue(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	wchar_t wszKey[MAX_NAME] = {0};
+	unsigned int unKeySize = RG_LEN(wszKey);
+	unsigned int unValueSize = RG_LEN(PpData->wszBuffer);
+	return Utility_IniGetKeyValue(s_wszMicroIniLine, RG_LEN(s_wszMicroIniLine), wszKey, &unKeySize, PpData->wszBuffer, &unValueSize);
+}
+
+/// Microbenchmark: read an unsigned int property
+static unsigned int
+CommandFlow_Benchmark_MicroPropertyGet(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unValue = 0;
+	UNREFERENCED_PARAMETER(PpData);
+	return PropertyStorage_GetUIntegerValueByKey(BENCHMARK_MICRO_PROPERTY, &unValue) ? RC_SUCCESS : RC_E_FAIL;
+}
+
+/// Microbenchmark: change an unsigned int property
+static unsigned int
+CommandFlow_Benchmark_MicroPropertyChange(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	UNREFERENCED_PARAMETER(PpData);
+	return PropertyStorage_ChangeUIntegerValueByKey(BENCHMARK_MICRO_PROPERTY, BENCHMARK_MICRO_ITERATIONS) ? RC_SUCCESS : RC_E_FAIL;
+}
+
+/// Microbenchmark: CRC of BENCHMARK_MICRO_DATA_SIZE bytes
+static unsigned int
+CommandFlow_Benchmark_MicroCRC(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	unsigned int unCRC = 0;
+	return Crypt_CRC(PpData->rgbData, sizeof(PpData->rgbData), &unCRC);
+}
+
+/// Microbenchmark: SHA-256 of BENCHMARK_MICRO_DATA_SIZE bytes
+static unsigned int
+CommandFlow_Benchmark_MicroSHA256(
+	_Inout_	IfxBenchmarkMicroData*	PpData)
+{
+	BYTE rgbDigest[SHA256_DIGEST_SIZE] = {0};
+	return Crypt_SHA256(PpData->rgbData, sizeof(PpData->rgbData), rgbDigest);
+}
+
+/**
+ *	@brief		Microbenchmark
+ */
+typedef struct tdIfxBenchmarkMicro
+{
+	/// Name of the measured type, command or function
+	const wchar_t*					wszName;
+	/// Operation to measure
+	PFN_BENCHMARK_MICRO_OPERATION	fnOperation;
+} IfxBenchmarkMicro;
+
+/// Microbenchmarks of the marshalling and of the primitives every command flow uses, in the order of the output
+static const IfxBenchmarkMicro s_rgsMicro[] = {
+	{ L"FirmwareImage_Unmarshal", &CommandFlow_Benchmark_MicroFirmwareImage },
+	{ L"FirmwareImage_UnmarshalView", &CommandFlow_Benchmark_MicroFirmwareImageView },
+	{ L"sSignedData_d_Unmarshal", &CommandFlow_Benchmark_MicroSignedData },
+	{ L"sSignedData_d_UnmarshalView", &CommandFlow_Benchmark_MicroSignedDataView },
+	{ L"sSecurityModuleLogicInfo_d_Unmarshal", &CommandFlow_Benchmark_MicroSecurityModuleLogicInfo },
+	{ L"TPM2B_DIGEST_Marshal", &CommandFlow_Benchmark_MicroDigestMarshal },
+	{ L"TPM2B_DIGEST_Unmarshal", &CommandFlow_Benchmark_MicroDigestUnmarshal },
+	{ L"TPM_GetCapability", &CommandFlow_Benchmark_MicroGetCapability },
+	{ L"TPM_FieldUpgradeInfoRequest2", &CommandFlow_Benchmark_MicroFieldUpgradeInfoRequest2 },
+	{ L"Platform_StringCompare", &CommandFlow_Benchmark_MicroStringCompare },
+	{ L"Platform_StringCopy", &CommandFlow_Benchmark_MicroStringCopy },
+	{ L"Platform_StringConcatenate", &CommandFlow_Benchmark_MicroStringConcatenate },
+	{ L"Platform_StringFormat", &CommandFlow_Benchmark_MicroStringFormat },
+	{ L"Utility_StringGetLine", &CommandFlow_Benchmark_MicroStringGetLine },
+	{ L"Utility_StringWriteHex", &CommandFlow_Benchmark_MicroStringWriteHex },
+	{ L"Utility_StringParseUInteger", &CommandFlow_Benchmark_MicroStringParseUInteger },
+	{ L"Utility_StringParseULongLong", &CommandFlow_Benchmark_MicroStringParseULongLong },
+	{ L"Utility_IniGetKeyValue", &CommandFlow_Benchmark_MicroIniGetKeyValue },
+	{ L"PropertyStorage_GetUInteger", &CommandFlow_Benchmark_MicroPropertyGet },
+	{ L"PropertyStorage_ChangeUInteger", &CommandFlow_Benchmark_MicroPropertyChange },
+	{ L"Crypt_CRC", &CommandFlow_Benchmark_MicroCRC },
+	{ L"Crypt_SHA256", &CommandFlow_Benchmark_MicroSHA256 }
+};
+
+/**
+ *	@brief		Runs the microbenchmarks
+ *	@details	Each operation is repeated BENCHMARK_MICRO_ITERATIONS times, its average time and the number of heap
+ *				allocations are stored in PpBenchmark->rgsMicro. A failing operation is stopped at the first error and
+ *				reported with its return code. Commands are answered by the simulated TPM.
+ *
+ *	@param		PpBenchmark			IfxBenchmark structure to be filled in
+ *	@param		PrgbFirmwareImage	Firmware image
+ *	@param		PpsFirmwareImage	Firmware image unmarshalled from PrgbFirmwareImage
+ */
+static void
+CommandFlow_Benchmark_RunMicro(
+	_Inout_					IfxBenchmark*			PpBenchmark,
+	_In_					BYTE*					PrgbFirmwareImage,
+	_In_					const IfxFirmwareImage*	PpsFirmwareImage)
+{
+	IfxBenchmarkMicroData sData = {0};
+	unsigned int unIndex = 0;
+
+	sData.rgbFirmwareImage = PrgbFirmwareImage;
+	sData.unFirmwareImageSize = PpBenchmark->unFirmwareImageSize;
+	sData.psFirmwareImage = PpsFirmwareImage;
+	CommandFlow_Benchmark_FillSecurityModuleLogicInfo(sData.rgbSecurityModuleLogicInfo);
+	for (unIndex = 0; unIndex < sizeof(sData.rgbData); unIndex++)
+		sData.rgbData[unIndex] = (BYTE)unIndex;
+	IGNORE_RETURN_VALUE(PropertyStorage_AddKeyUIntegerValuePair(BENCHMARK_MICRO_PROPERTY, 0));
+
+	PpBenchmark->unMicroIterations = BENCHMARK_MICRO_ITERATIONS;
+	for (unIndex = 0; unIndex < RG_LEN(s_rgsMicro) && unIndex < BENCHMARK_MAX_MICRO_ENTRIES; unIndex++)
+	{
+		IfxBenchmarkMicroEntry* pEntry = &PpBenchmark->rgsMicro[unIndex];
+		unsigned int unIteration = 0;
+		unsigned long long ullTime = 0;
+		IfxMemoryStatistics sMemoryStatistics;
+
+		Platform_MemoryGetStatistics(&sMemoryStatistics);
+		pEntry->ullAllocations = sMemoryStatistics.ullAllocations;
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+
+		pEntry->wszName = s_rgsMicro[unIndex].wszName;
+		pEntry->unReturnCode = RC_SUCCESS;
+		for (unIteration = 0; unIteration < BENCHMARK_MICRO_ITERATIONS && RC_SUCCESS == pEntry->unReturnCode; unIteration++)
+			pEntry->unReturnCode = s_rgsMicro[unIndex].fnOperation(&sData);
+		pEntry->ullNanoSecondsPerOperation = (Platform_GetMonotonicTimeMicroSeconds() - ullTime) * 1000 / BENCHMARK_MICRO_ITERATIONS;
+
+		Platform_MemoryGetStatistics(&sMemoryStatistics);
+		pEntry->ullAllocations = sMemoryStatistics.ullAllocations - pEntry->ullAllocations;
+		PpBenchmark->unMicroCount++;
+	}
+	IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(BENCHMARK_MICRO_PROPERTY));
+	Error_ClearStack();
+}
+
+/**
+ *	@brief		Benchmarks the firmware update command flow.
+ *	@details	Replaces the TPM I/O layer with an in-process simulation of a TPM1.2 in boot loader mode and runs
+ *				FirmwareUpdate_UpdateImage with the firmware image given with the -benchmark command line option.
+ *				The TPM is not accessed.
+ *
+ *	@param		PpBenchmark					Pointer to an initialized IfxBenchmark structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully. PpBenchmark->unReturnCode holds the
+ *											result of the firmware update.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INVALID_FW_OPTION		The firmware image cannot be read.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE		The firmware image cannot be parsed.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_Benchmark_Execute(
+	_Inout_ IfxBenchmark* PpBenchmark)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* rgbFirmwareImage = NULL;
+	BOOL fFirmwareImageMapped = FALSE;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
+		unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+		IfxFirmwareImage sFirmwareImage = {{0}};
+		IfxFirmwareUpdateData sFirmwareUpdateData = {0};
+		TPM_STATE sTpmState = {{0}};
+		BOOL fValid = FALSE;
+		BITFIELD_NEW_TPM_FIRMWARE_INFO bfNewTpmFirmwareInfo = {0};
+		UINT32 unErrorDetails = 0;
+		unsigned long long ullTime = 0;
+		unsigned long long ullUpdateStartTime = 0;
+
+		// Check parameters
+		if (NULL == PpBenchmark || STRUCT_TYPE_Benchmark != PpBenchmark->unType || sizeof(IfxBenchmark) != PpBenchmark->unSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected. Benchmark structure is not in the correct state.");
+			break;
+		}
+		PpBenchmark->unReturnCode = RC_E_FAIL;
+
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_BENCHMARK, wszFirmwareImagePath, &unFirmwareImagePathSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", PROPERTY_BENCHMARK);
+			break;
+		}
+
+		// Plug the simulated TPM into the device management
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sTransport, 0, sizeof(s_sTransport)));
+		DeviceManagement_SetTransmitFunction(&CommandFlow_Benchmark_Transmit);
+		unReturnValue = DeviceManagement_Connect();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Load the firmware image
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		unReturnValue = FileIO_MapFileToBuffer(wszFirmwareImagePath, &rgbFirmwareImage, &PpBenchmark->unFirmwareImageSize, &fFirmwareImageMapped);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(RC_E_INVALID_FW_OPTION, L"Failed to load the firmware image (%ls). (0x%.8X)", wszFirmwareImagePath, unReturnValue);
+			unReturnValue = RC_E_INVALID_FW_OPTION;
+			break;
+		}
+		{
+			BOOL fDecompressed = FALSE;
+			unReturnValue = FileIO_DecompressFileBuffer(&rgbFirmwareImage, &PpBenchmark->unFirmwareImageSize, &fFirmwareImageMapped, &fDecompressed);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"Failed to decompress the firmware image (%ls). (0x%.8X)", wszFirmwareImagePath, unReturnValue);
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+		}
+		PpBenchmark->ullLoadTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+
+		// Unmarshal the firmware image
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		{
+			BYTE* rgbIfxFirmwareImageStream = rgbFirmwareImage;
+			INT32 nIfxFirmwareImageSize = (INT32)PpBenchmark->unFirmwareImageSize;
+			unReturnValue = FirmwareImage_Unmarshal(&sFirmwareImage, &rgbIfxFirmwareImageStream, &nIfxFirmwareImageSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"Firmware image cannot be parsed. (0x%.8X)", unReturnValue);
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				break;
+			}
+		}
+		PpBenchmark->ullUnmarshalTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+
+		// Probe the TPM state
+		FirmwareUpdate_InvalidateState();
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		unReturnValue = FirmwareUpdate_CalculateState(&sTpmState);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		PpBenchmark->ullProbeTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+
+		// Check the firmware image. A TPM in boot loader mode accepts any firmware image, so the result is only logged.
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		unReturnValue = FirmwareUpdate_CheckImage(rgbFirmwareImage, PpBenchmark->unFirmwareImageSize, &sFirmwareImage, &fValid, &bfNewTpmFirmwareInfo, &unErrorDetails);
+		PpBenchmark->ullCheckTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		LOGGING_WRITE_LEVEL2_FMT(L"FirmwareUpdate_CheckImage returned 0x%.8X (valid: %d, details: 0x%.8X).", unReturnValue, fValid, unErrorDetails);
+		Error_ClearStack();
+
+		// Run the firmware update
+		sFirmwareUpdateData.fnProgressCallback = &Response_ProgressCallback;
+		sFirmwareUpdateData.fnProgressDetailsCallback = &Response_ProgressDetailsCallback;
+		sFirmwareUpdateData.rgbFirmwareImage = rgbFirmwareImage;
+		sFirmwareUpdateData.unFirmwareImageSize = PpBenchmark->unFirmwareImageSize;
+		sFirmwareUpdateData.psFirmwareImage = &sFirmwareImage;
+		ullUpdateStartTime = Platform_GetMonotonicTimeMicroSeconds();
+		PpBenchmark->unReturnCode = FirmwareUpdate_UpdateImage(&sFirmwareUpdateData);
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		FirmwareUpdate_InvalidateState();
+
+		// Split the update into the stages before, during and after the firmware block transfer
+		PpBenchmark->unCommandCount = s_sTransport.unCommandCount;
+		PpBenchmark->unBlockCount = s_sTransport.unBlockCount;
+		if (0 != s_sTransport.unBlockCount)
+		{
+			PpBenchmark->ullStartTime = s_sTransport.ullFirstBlockTime - ullUpdateStartTime;
+			PpBenchmark->ullTransferTime = s_sTransport.ullLastBlockTime - s_sTransport.ullFirstBlockTime;
+			PpBenchmark->ullCompleteTime = ullTime - s_sTransport.ullLastBlockTime;
+		}
+		else
+			PpBenchmark->ullStartTime = ullTime - ullUpdateStartTime;
+
+		// Measure the marshalling layer on its own
+		CommandFlow_Benchmark_RunMicro(PpBenchmark, rgbFirmwareImage, &sFirmwareImage);
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	FileIO_ReleaseFileBuffer(&rgbFirmwareImage, PpBenchmark->unFirmwareImageSize, fFirmwareImageMapped);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
@@ -0,0 +1,48 @@
+﻿/**
+ *	@brief		Declares the command flow to benchmark the host side of a firmware update.
+ *	@details	This module runs the firmware update command flow against a simulated TPM and measures the time spent
+ *				in each stage.
+ *	@file		CommandFlow_Benchmark.h
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+#include "TPMFactoryUpdStruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Benchmarks the firmware update command flow.
+ *	@details	Replaces the TPM I/O layer with an in-process simulation of a TPM1.2 in boot loader mode and runs
+ *				FirmwareUpdate_UpdateImage with the firmware image given with the -benchmark command line option.
+ *				The TPM is not accessed.
+ *
+ *	@param		PpBenchmark					Pointer to an initialized IfxBenchmark structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully. PpBenchmark->unReturnCode holds the
+ *											result of the firmware update.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INVALID_FW_OPTION		The firmware image cannot be read.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE		The firmware image cannot be parsed.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_Benchmark_Execute(
+	_Inout_ IfxBenchmark* PpBenchmark);
+
+#ifdef __cplusplus
+}
+#endif
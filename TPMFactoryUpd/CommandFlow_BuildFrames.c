@@ -0,0 +1,150 @@
+﻿/**
+ *	@brief		Implements the command flow to build a frame file.
+ *	@details	This module writes the TPM_FieldUpgradeUpdate command frames of a verified firmware image to a frame file.
+ *				The format is described in FirmwareUpdate.h.
+ *	@file		CommandFlow_BuildFrames.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CommandFlow_BuildFrames.h"
+#include "FirmwareUpdate.h"
+#include "FirmwareImage.h"
+#include "FileIO.h"
+
+/**
+ *	@brief		Builds a frame file.
+ *	@details	Loads the firmware image given with the -firmware command line option, verifies it and writes the frames for
+ *				the maximum data size given with the -build-frames command line option to the file given with the
+ *				-frame-file command line option. The TPM is not accessed.
+ *
+ *	@param		PpBuildFrames				Pointer to an initialized IfxBuildFrames structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE		The firmware image is corrupt or did not pass the integrity checks.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_BuildFrames_Execute(
+	_Inout_ IfxBuildFrames* PpBuildFrames)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* rgbFirmwareFile = NULL;
+	unsigned int unFirmwareFileSize = 0;
+	BOOL fFirmwareFileMapped = FALSE;
+	BYTE* rgbFrameFile = NULL;
+	void* pvFile = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszFirmwarePath[MAX_PATH] = {0};
+		unsigned int unFirmwarePathSize = RG_LEN(wszFirmwarePath);
+		unsigned int unFrameFileSize = RG_LEN(PpBuildFrames->wszFrameFile);
+		IfxFirmwareImage sFirmwareImage = {{0}};
+		BYTE* pbStream = NULL;
+		INT32 nStreamSize = 0;
+		BOOL fDecompressed = FALSE;
+		BOOL fValid = FALSE;
+		UINT32 unFrameFileBytes = 0;
+		UINT32 unFrameCount = 0;
+
+		// Check parameters
+		if (NULL == PpBuildFrames || STRUCT_TYPE_BuildFrames != PpBuildFrames->unType || sizeof(IfxBuildFrames) != PpBuildFrames->unSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected. BuildFrames structure is not in the correct state.");
+			break;
+		}
+		PpBuildFrames->unReturnCode = RC_E_FAIL;
+
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwarePath, &unFirmwarePathSize) ||
+				FALSE == PropertyStorage_GetValueByKey(PROPERTY_FRAME_FILE, PpBuildFrames->wszFrameFile, &unFrameFileSize) ||
+				FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_BUILD_FRAMES, &PpBuildFrames->unMaxDataSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"PropertyStorage_GetValueByKey failed to get the build-frames properties.");
+			break;
+		}
+
+		// Load and verify the firmware image, the frame file is built from the image content like an update does
+		unReturnValue = FileIO_MapFileToBuffer(wszFirmwarePath, &rgbFirmwareFile, &unFirmwareFileSize, &fFirmwareFileMapped);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = FileIO_DecompressFileBuffer(&rgbFirmwareFile, &unFirmwareFileSize, &fFirmwareFileMapped, &fDecompressed);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Failed to load the firmware image (%ls). (0x%.8X)", wszFirmwarePath, unReturnValue);
+			break;
+		}
+		if (FirmwareImage_IsBundle(rgbFirmwareFile, unFirmwareFileSize))
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			ERROR_STORE_FMT(unReturnValue, L"'%ls' is a firmware image bundle. Frame files are built from single firmware images.", wszFirmwarePath);
+			break;
+		}
+		pbStream = rgbFirmwareFile;
+		nStreamSize = (INT32)unFirmwareFileSize;
+		if (RC_SUCCESS != FirmwareImage_Unmarshal(&sFirmwareImage, &pbStream, &nStreamSize))
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			ERROR_STORE_FMT(unReturnValue, L"Firmware image (%ls) cannot be parsed.", wszFirmwarePath);
+			break;
+		}
+		unReturnValue = FirmwareUpdate_CheckImageIntegrity(rgbFirmwareFile, unFirmwareFileSize, &sFirmwareImage, &fValid);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"FirmwareUpdate_CheckImageIntegrity returned an unexpected value.");
+			break;
+		}
+		if (FALSE == fValid)
+		{
+			unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+			ERROR_STORE_FMT(unReturnValue, L"Firmware image (%ls) did not pass the integrity and signature checks.", wszFirmwarePath);
+			break;
+		}
+
+		unReturnValue = FirmwareUpdate_BuildFrameFile(rgbFirmwareFile, unFirmwareFileSize, &sFirmwareImage, (UINT16)PpBuildFrames->unMaxDataSize, &rgbFrameFile, &unFrameFileBytes, &unFrameCount);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Write the frame file
+		unReturnValue = FileIO_Open(PpBuildFrames->wszFrameFile, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = FileIO_WriteBuffer(pvFile, rgbFrameFile, unFrameFileBytes);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = FileIO_Close(&pvFile);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Failed to write the frame file (%ls). (0x%.8X)", PpBuildFrames->wszFrameFile, unReturnValue);
+			break;
+		}
+		LOGGING_WRITE_LEVEL1_FMT(L"Frame file '%ls' written: %d frames for a maximum data size of %d bytes.", PpBuildFrames->wszFrameFile, unFrameCount, PpBuildFrames->unMaxDataSize);
+
+		PpBuildFrames->bSourceTpmFamily = sFirmwareImage.bSourceTpmFamily;
+		PpBuildFrames->unFrameCount = unFrameCount;
+		PpBuildFrames->unFrameFileSize = unFrameFileBytes;
+		PpBuildFrames->unReturnCode = RC_SUCCESS;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+	Platform_MemoryFree((void**)&rgbFrameFile);
+	FileIO_ReleaseFileBuffer(&rgbFirmwareFile, unFirmwareFileSize, fFirmwareFileMapped);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
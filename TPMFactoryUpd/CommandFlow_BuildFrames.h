@@ -0,0 +1,45 @@
+﻿/**
+ *	@brief		Declares the command flow to build a frame file.
+ *	@details	This module writes the TPM_FieldUpgradeUpdate command frames of a verified firmware image to a frame file.
+ *	@file		CommandFlow_BuildFrames.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+#include "TPMFactoryUpdStruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Builds a frame file.
+ *	@details	Loads the firmware image given with the -firmware command line option, verifies it and writes the frames for
+ *				the maximum data size given with the -build-frames command line option to the file given with the
+ *				-frame-file command line option. The TPM is not accessed.
+ *
+ *	@param		PpBuildFrames				Pointer to an initialized IfxBuildFrames structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE		The firmware image is corrupt or did not pass the integrity checks.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_BuildFrames_Execute(
+	_Inout_ IfxBuildFrames* PpBuildFrames);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,506 @@
+﻿/**
+ *	@brief		Implements the command flow to check which firmware images can be used to update the TPM.
+ *	@details	This module probes the TPM once. FirmwareUpdate_CheckImage answers the TPM dependent checks of all
+ *				firmware images from the cached state, so the number of TPM commands does not grow with the number of
+ *				firmware images. The integrity of the firmware images is verified concurrently in batches bounded by
+ *				CHECK_IMAGES_MEMORY_BUDGET, the results keep the order of the input.
+ *	@file		CommandFlow_CheckImages.c
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CommandFlow_CheckImages.h"
+#include "FirmwareImage.h"
+#include "FirmwareUpdate.h"
+#include "FileIO.h"
+
+/// Capacity in wide characters of the buffer receiving the file names of the folder
+#define CHECK_IMAGES_FILE_NAMES_SIZE (CHECK_IMAGES_MAX_ENTRIES * MAX_NAME)
+/// Memory in bytes the files and reassembled firmware images waiting for their verification may occupy. A single larger
+/// file is checked on its own.
+#define CHECK_IMAGES_MEMORY_BUDGET (64 * 1024 * 1024)
+
+/// File whose firmware images wait for their checks
+typedef struct tdIfxCheckImagesFile
+{
+	/// File content (mapped, read or decompressed)
+	BYTE*						rgbFile;
+	/// Size of rgbFile
+	unsigned int				unFileSize;
+	/// Whether rgbFile is mapped
+	BOOL						fMapped;
+} IfxCheckImagesFile;
+
+/// Firmware image waiting for its checks
+typedef struct tdIfxCheckImagesPending
+{
+	/// Result entry of the firmware image
+	IfxCheckImagesEntry*		pEntry;
+	/// Unmarshalled firmware image
+	IfxFirmwareImage			sFirmwareImage;
+	/// Firmware image byte stream
+	BYTE*						rgbImage;
+	/// Size of rgbImage
+	UINT32						unImageSize;
+	/// Index of the file the firmware image belongs to
+	unsigned int				unFile;
+	/// Whether rgbImage has been returned by FirmwareImage_GetBundleImage and must be released
+	BOOL						fBundleImage;
+} IfxCheckImagesPending;
+
+/// Firmware images whose integrity is verified concurrently before their TPM dependent checks run in input order
+typedef struct tdIfxCheckImagesBatch
+{
+	/// Loaded files, the last one may still be read by CommandFlow_CheckImages_CheckFile
+	IfxCheckImagesFile			rgsFiles[CHECK_IMAGES_MAX_ENTRIES + 1];
+	/// Number of entries in rgsFiles
+	unsigned int				unFileCount;
+	/// Firmware images in input order
+	IfxCheckImagesPending		rgsImages[CHECK_IMAGES_MAX_ENTRIES];
+	/// Integrity verification of rgsImages
+	IfxImageIntegrityCheck		rgsChecks[CHECK_IMAGES_MAX_ENTRIES];
+	/// Number of entries in rgsImages and rgsChecks
+	unsigned int				unImageCount;
+	/// Memory occupied by the files and reassembled firmware images
+	unsigned long long			ullMemorySize;
+	/// Whether at least one firmware image is applicable to the TPM
+	BOOL						fApplicable;
+} IfxCheckImagesBatch;
+
+/**
+ *	@brief		Adds a result entry for a firmware image
+ *
+ *	@param		PpCheckImages			Pointer to the IfxCheckImages structure receiving the result
+ *	@param		PwszName				Name to display for the firmware image
+ *	@returns	Pointer to the new entry or NULL if the result table is full. In that case the firmware image is
+ *				counted as skipped.
+ */
+_Check_return_
+static IfxCheckImagesEntry*
+CommandFlow_CheckImages_AddEntry(
+	_Inout_	IfxCheckImages*	PpCheckImages,
+	_In_z_	const wchar_t*	PwszName)
+{
+	IfxCheckImagesEntry* pEntry = NULL;
+	unsigned int unSize = 0;
+
+	if (CHECK_IMAGES_MAX_ENTRIES <= PpCheckImages->unEntryCount)
+	{
+		PpCheckImages->unSkippedCount++;
+		return NULL;
+	}
+
+	pEntry = &PpCheckImages->rgsEntries[PpCheckImages->unEntryCount++];
+	unSize = RG_LEN(pEntry->wszName);
+	IGNORE_RETURN_VALUE(Platform_StringCopy(pEntry->wszName, &unSize, PwszName));
+
+	return pEntry;
+}
+
+/**
+ *	@brief		Checks a firmware image against the TPM state and fills in its result
+ *	@details	The integrity checks are skipped for a firmware image which passed them in FirmwareUpdate_CheckImagesIntegrity.
+ *				All other firmware images are verified by FirmwareUpdate_CheckImage again, so a corrupt firmware image is
+ *				reported with the same details as before.
+ *
+ *	@param		PpsPending				Firmware image, receives the result in its entry
+ *	@param		PpsCheck				Result of the integrity verification of the firmware image
+ *	@retval		TRUE					The firmware image is applicable to the TPM.
+ *	@retval		FALSE					Otherwise
+ */
+_Check_return_
+static BOOL
+CommandFlow_CheckImages_CheckImage(
+	_Inout_	IfxCheckImagesPending*			PpsPending,
+	_In_	const IfxImageIntegrityCheck*	PpsCheck)
+{
+	IfxCheckImagesEntry* pEntry = PpsPending->pEntry;
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (RC_SUCCESS == PpsCheck->unReturnValue && TRUE == PpsCheck->fValid)
+		FirmwareUpdate_SetImageIntegrityVerified(PpsPending->rgbImage, PpsPending->unImageSize);
+
+	// The TPM dependent checks are answered from the state probed by CommandFlow_CheckImages_Execute
+	unReturnValue = FirmwareUpdate_CheckImage(PpsPending->rgbImage, PpsPending->unImageSize, &PpsPending->sFirmwareImage, &pEntry->fValid, &pEntry->bfNewTpmFirmwareInfo, &pEntry->unErrorDetails);
+	FirmwareUpdate_SetImageIntegrityVerified(NULL, 0);
+	LOGGING_WRITE_LEVEL2_FMT(L"FirmwareUpdate_CheckImage returned 0x%.8X for %ls (valid: %d, details: 0x%.8X).", unReturnValue, pEntry->wszName, pEntry->fValid, pEntry->unErrorDetails);
+	if (RC_SUCCESS != unReturnValue)
+	{
+		pEntry->fValid = FALSE;
+		pEntry->unErrorDetails = unReturnValue;
+	}
+	else if (TRUE == pEntry->fValid)
+		pEntry->unErrorDetails = RC_SUCCESS;
+	Error_ClearStack();
+
+	return pEntry->fValid;
+}
+
+/**
+ *	@brief		Checks the waiting firmware images and releases their files
+ *	@details	The integrity of all waiting firmware images is verified concurrently by FirmwareUpdate_CheckImagesIntegrity.
+ *				Afterwards the TPM dependent checks run in input order on the calling thread.
+ *
+ *	@param		PpsBatch				Waiting firmware images
+ *	@param		PfKeepLastFile			TRUE to keep the last file, because CommandFlow_CheckImages_CheckFile still reads it
+ */
+static void
+CommandFlow_CheckImages_Flush(
+	_Inout_	IfxCheckImagesBatch*	PpsBatch,
+	_In_	BOOL					PfKeepLastFile)
+{
+	unsigned int unIndex = 0;
+	unsigned int unReleasedCount = PpsBatch->unFileCount;
+
+	if (0 != PpsBatch->unImageCount)
+	{
+		LOGGING_WRITE_LEVEL3_FMT(L"Verifying the integrity of %u firmware images.", PpsBatch->unImageCount);
+		IGNORE_RETURN_VALUE(FirmwareUpdate_CheckImagesIntegrity(PpsBatch->rgsChecks, PpsBatch->unImageCount));
+	}
+
+	for (unIndex = 0; unIndex < PpsBatch->unImageCount; unIndex++)
+	{
+		IfxCheckImagesPending* psPending = &PpsBatch->rgsImages[unIndex];
+		const IfxCheckImagesFile* psFile = &PpsBatch->rgsFiles[psPending->unFile];
+
+		if (TRUE == CommandFlow_CheckImages_CheckImage(psPending, &PpsBatch->rgsChecks[unIndex]))
+			PpsBatch->fApplicable = TRUE;
+		if (TRUE == psPending->fBundleImage)
+			FirmwareImage_ReleaseBundleImage(psFile->rgbFile, psFile->unFileSize, &psPending->rgbImage);
+	}
+	PpsBatch->unImageCount = 0;
+	PpsBatch->ullMemorySize = 0;
+
+	if (TRUE == PfKeepLastFile && 0 != unReleasedCount)
+		unReleasedCount--;
+	for (unIndex = 0; unIndex < unReleasedCount; unIndex++)
+		FileIO_ReleaseFileBuffer(&PpsBatch->rgsFiles[unIndex].rgbFile, PpsBatch->rgsFiles[unIndex].unFileSize, PpsBatch->rgsFiles[unIndex].fMapped);
+	PpsBatch->unFileCount -= unReleasedCount;
+	if (0 != PpsBatch->unFileCount)
+	{
+		PpsBatch->rgsFiles[0] = PpsBatch->rgsFiles[unReleasedCount];
+		PpsBatch->ullMemorySize = PpsBatch->rgsFiles[0].unFileSize;
+	}
+}
+
+/**
+ *	@brief		Adds a firmware image of the last file to the waiting firmware images
+ *	@details	The firmware image is parsed and its result entry is added at once, so the results keep the order of the
+ *				input. The checks run in CommandFlow_CheckImages_Flush, which is called first if the firmware image would
+ *				exceed CHECK_IMAGES_MEMORY_BUDGET. The firmware image is released at once if it is not added.
+ *
+ *	@param		PpCheckImages			Pointer to the IfxCheckImages structure receiving the result
+ *	@param		PpsBatch				Waiting firmware images
+ *	@param		PwszName				Name to display for the firmware image
+ *	@param		PrgbImage				Firmware image byte stream (within the last file or returned by FirmwareImage_GetBundleImage)
+ *	@param		PunImageSize			Size of the firmware image byte stream
+ *	@param		PfBundleImage			TRUE if PrgbImage has been returned by FirmwareImage_GetBundleImage
+ */
+static void
+CommandFlow_CheckImages_AddImage(
+	_Inout_							IfxCheckImages*			PpCheckImages,
+	_Inout_							IfxCheckImagesBatch*	PpsBatch,
+	_In_z_							const wchar_t*			PwszName,
+	_In_bytecount_(PunImageSize)	BYTE*					PrgbImage,
+	_In_							UINT32					PunImageSize,
+	_In_							BOOL					PfBundleImage)
+{
+	const IfxCheckImagesFile* psFile = &PpsBatch->rgsFiles[PpsBatch->unFileCount - 1];
+	IfxCheckImagesEntry* pEntry = NULL;
+	IfxCheckImagesPending* psPending = NULL;
+	BYTE* rgbIfxFirmwareImageStream = PrgbImage;
+	INT32 nIfxFirmwareImageSize = (INT32)PunImageSize;
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unSize = 0;
+	// A firmware image outside of the file has been reassembled into memory of its own
+	BOOL fAllocated = PrgbImage < psFile->rgbFile || PrgbImage >= psFile->rgbFile + psFile->unFileSize;
+
+	do
+	{
+		pEntry = CommandFlow_CheckImages_AddEntry(PpCheckImages, PwszName);
+		if (NULL == pEntry)
+			break;
+
+		if (TRUE == fAllocated && 0 != PpsBatch->unImageCount && PunImageSize + PpsBatch->ullMemorySize > CHECK_IMAGES_MEMORY_BUDGET)
+			CommandFlow_CheckImages_Flush(PpsBatch, TRUE);
+
+		psPending = &PpsBatch->rgsImages[PpsBatch->unImageCount];
+		IGNORE_RETURN_VALUE(Platform_MemorySet(psPending, 0, sizeof(*psPending)));
+		unReturnValue = FirmwareImage_Unmarshal(&psPending->sFirmwareImage, &rgbIfxFirmwareImageStream, &nIfxFirmwareImageSize);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Firmware image %ls cannot be parsed. (0x%.8X)", PwszName, unReturnValue);
+			pEntry->unErrorDetails = RC_E_CORRUPT_FW_IMAGE;
+			Error_ClearStack();
+			break;
+		}
+		pEntry->bTargetFamily = psPending->sFirmwareImage.bTargetTpmFamily;
+		unSize = RG_LEN(pEntry->wszTargetVersion);
+		IGNORE_RETURN_VALUE(Platform_StringCopy(pEntry->wszTargetVersion, &unSize, psPending->sFirmwareImage.wszTargetVersion));
+
+		// Wait for the checks
+		psPending->pEntry = pEntry;
+		psPending->rgbImage = PrgbImage;
+		psPending->unImageSize = PunImageSize;
+		psPending->unFile = PpsBatch->unFileCount - 1;
+		psPending->fBundleImage = PfBundleImage;
+		PpsBatch->rgsChecks[PpsBatch->unImageCount].pbImage = PrgbImage;
+		PpsBatch->rgsChecks[PpsBatch->unImageCount].unImageSize = PunImageSize;
+		PpsBatch->rgsChecks[PpsBatch->unImageCount].psFirmwareImage = &psPending->sFirmwareImage;
+		PpsBatch->unImageCount++;
+		if (TRUE == fAllocated)
+			PpsBatch->ullMemorySize += PunImageSize;
+		PrgbImage = NULL;
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != PrgbImage && TRUE == PfBundleImage)
+	{
+		psFile = &PpsBatch->rgsFiles[PpsBatch->unFileCount - 1];
+		FirmwareImage_ReleaseBundleImage(psFile->rgbFile, psFile->unFileSize, &PrgbImage);
+	}
+}
+
+/**
+ *	@brief		Adds a firmware image file or all firmware images of a firmware image bundle file to the waiting firmware images
+ *
+ *	@param		PpCheckImages			Pointer to the IfxCheckImages structure receiving the results
+ *	@param		PpsBatch				Waiting firmware images
+ *	@param		PwszPath				Path of the file
+ *	@param		PwszName				Name to display for the file
+ */
+static void
+CommandFlow_CheckImages_CheckFile(
+	_Inout_	IfxCheckImages*			PpCheckImages,
+	_Inout_	IfxCheckImagesBatch*	PpsBatch,
+	_In_z_	const wchar_t*			PwszPath,
+	_In_z_	const wchar_t*			PwszName)
+{
+	IfxCheckImagesFile sFile = {0};
+
+	do
+	{
+		unsigned int unReturnValue = RC_E_FAIL;
+		IfxCheckImagesEntry* pEntry = NULL;
+		IfxCheckImagesFile* psFile = NULL;
+		BOOL fDecompressed = FALSE;
+		UINT16 usIndex = 0;
+
+		unReturnValue = FileIO_MapFileToBuffer(PwszPath, &sFile.rgbFile, &sFile.unFileSize, &sFile.fMapped);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = FileIO_DecompressFileBuffer(&sFile.rgbFile, &sFile.unFileSize, &sFile.fMapped, &fDecompressed);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Failed to load the firmware image (%ls). (0x%.8X)", PwszPath, unReturnValue);
+			Error_ClearStack();
+			pEntry = CommandFlow_CheckImages_AddEntry(PpCheckImages, PwszName);
+			if (NULL != pEntry)
+				pEntry->unErrorDetails = RC_E_INVALID_FW_OPTION;
+			break;
+		}
+
+		// The file is released with the other files of the batch
+		if (0 != PpsBatch->unImageCount && sFile.unFileSize + PpsBatch->ullMemorySize > CHECK_IMAGES_MEMORY_BUDGET)
+			CommandFlow_CheckImages_Flush(PpsBatch, FALSE);
+		psFile = &PpsBatch->rgsFiles[PpsBatch->unFileCount++];
+		*psFile = sFile;
+		PpsBatch->ullMemorySize += sFile.unFileSize;
+		sFile.rgbFile = NULL;
+
+		if (FALSE == FirmwareImage_IsBundle(psFile->rgbFile, psFile->unFileSize))
+		{
+			CommandFlow_CheckImages_AddImage(PpCheckImages, PpsBatch, PwszName, psFile->rgbFile, psFile->unFileSize, FALSE);
+			break;
+		}
+
+		// Add each firmware image of the bundle
+		for (usIndex = 0; ; usIndex++)
+		{
+			wchar_t wszName[MAX_NAME] = {0};
+			unsigned int unNameSize = RG_LEN(wszName);
+			BYTE* rgbImage = NULL;
+			UINT32 unImageSize = 0;
+
+			// A flush while adding a firmware image keeps the file, but moves it to the first entry
+			psFile = &PpsBatch->rgsFiles[PpsBatch->unFileCount - 1];
+			unReturnValue = FirmwareImage_GetBundleImage(psFile->rgbFile, psFile->unFileSize, usIndex, &rgbImage, &unImageSize);
+			if (RC_E_FIRMWARE_UPDATE_NOT_FOUND == unReturnValue)
+				break;
+
+			IGNORE_RETURN_VALUE(Platform_StringFormat(wszName, &unNameSize, L"%ls#%u", PwszName, usIndex));
+			if (RC_SUCCESS != unReturnValue)
+			{
+				// The table of contents cannot be read, so the remaining firmware images are unreachable
+				LOGGING_WRITE_LEVEL2_FMT(L"Firmware image bundle %ls is corrupt. (0x%.8X)", PwszPath, unReturnValue);
+				pEntry = CommandFlow_CheckImages_AddEntry(PpCheckImages, wszName);
+				if (NULL != pEntry)
+					pEntry->unErrorDetails = unReturnValue;
+				break;
+			}
+
+			CommandFlow_CheckImages_AddImage(PpCheckImages, PpsBatch, wszName, rgbImage, unImageSize, TRUE);
+		}
+	}
+	WHILE_FALSE_END;
+
+	// Release a file at once if none of its firmware images waits for the checks
+	if (0 != PpsBatch->unFileCount &&
+			(0 == PpsBatch->unImageCount || PpsBatch->unFileCount - 1 != PpsBatch->rgsImages[PpsBatch->unImageCount - 1].unFile))
+	{
+		IfxCheckImagesFile* psFile = &PpsBatch->rgsFiles[PpsBatch->unFileCount - 1];
+		if (NULL != psFile->rgbFile)
+		{
+			PpsBatch->ullMemorySize -= psFile->unFileSize;
+			FileIO_ReleaseFileBuffer(&psFile->rgbFile, psFile->unFileSize, psFile->fMapped);
+			PpsBatch->unFileCount--;
+		}
+	}
+	FileIO_ReleaseFileBuffer(&sFile.rgbFile, sFile.unFileSize, sFile.fMapped);
+}
+
+/**
+ *	@brief		Checks which firmware images can be used to update the TPM.
+ *	@details	Probes the TPM once and runs the checks of FirmwareUpdate_CheckImage for each firmware image in the folder,
+ *				firmware image or firmware image bundle given with the -check-images command line option. The integrity
+ *				checks of the firmware images run concurrently, the results keep the order of the input. The TPM state
+ *				is not changed.
+ *
+ *	@param		PpCheckImages				Pointer to an initialized IfxCheckImages structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully. PpCheckImages->unReturnCode is RC_SUCCESS
+ *											if at least one firmware image is applicable, RC_E_FIRMWARE_UPDATE_NOT_FOUND otherwise.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INVALID_FW_OPTION		The folder cannot be read.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_CheckImages_Execute(
+	_Inout_ IfxCheckImages* PpCheckImages)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	wchar_t* wszFileNames = NULL;
+	IfxCheckImagesBatch* psBatch = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszPath[MAX_PATH] = {0};
+		unsigned int unPathSize = RG_LEN(wszPath);
+		unsigned int unVersionSize = 0;
+
+		// Check parameters
+		if (NULL == PpCheckImages || STRUCT_TYPE_CheckImages != PpCheckImages->unType || sizeof(IfxCheckImages) != PpCheckImages->unSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected. CheckImages structure is not in the correct state.");
+			break;
+		}
+		PpCheckImages->unReturnCode = RC_E_FAIL;
+
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_CHECK_IMAGES, wszPath, &unPathSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", PROPERTY_CHECK_IMAGES);
+			break;
+		}
+
+		// Probe the TPM once, the checks below are answered from the cached state
+		FirmwareUpdate_InvalidateState();
+		unVersionSize = RG_LEN(PpCheckImages->wszFirmwareVersion);
+		unReturnValue = FirmwareUpdate_GetImageInfo(PpCheckImages->wszFirmwareVersion, &unVersionSize, &PpCheckImages->sTpmState, &PpCheckImages->unRemainingUpdates, TPM_INFO_FIELDS_ALL);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		psBatch = (IfxCheckImagesBatch*)Platform_MemoryAllocateZero(sizeof(IfxCheckImagesBatch));
+		if (NULL == psBatch)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+			break;
+		}
+
+		if (FALSE == FileIO_IsDirectory(wszPath))
+		{
+			// A single firmware image or firmware image bundle, display its file name
+			const wchar_t* wszName = wszPath;
+			unsigned int unIndex = 0;
+			for (unIndex = 0; unIndex < unPathSize && L'\0' != wszPath[unIndex]; unIndex++)
+			{
+				if (L'/' == wszPath[unIndex] && L'\0' != wszPath[unIndex + 1])
+					wszName = &wszPath[unIndex + 1];
+			}
+			CommandFlow_CheckImages_CheckFile(PpCheckImages, psBatch, wszPath, wszName);
+		}
+		else
+		{
+			unsigned int unFileNamesSize = CHECK_IMAGES_FILE_NAMES_SIZE;
+			unsigned int unFileCount = 0;
+			unsigned int unOffset = 0;
+			unsigned int unFile = 0;
+
+			wszFileNames = (wchar_t*)Platform_MemoryAllocateZero(CHECK_IMAGES_FILE_NAMES_SIZE * sizeof(wchar_t));
+			if (NULL == wszFileNames)
+			{
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+				break;
+			}
+
+			unReturnValue = FileIO_ListDirectory(wszPath, wszFileNames, &unFileNamesSize, &unFileCount);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE_FMT(RC_E_INVALID_FW_OPTION, L"Failed to read the folder (%ls). (0x%.8X)", wszPath, unReturnValue);
+				unReturnValue = RC_E_INVALID_FW_OPTION;
+				break;
+			}
+
+			for (unFile = 0; unFile < unFileCount; unFile++)
+			{
+				const wchar_t* wszName = wszFileNames + unOffset;
+				wchar_t wszFilePath[MAX_PATH] = {0};
+				unsigned int unFilePathSize = RG_LEN(wszFilePath);
+				unsigned int unNameLength = 0;
+
+				IGNORE_RETURN_VALUE(Platform_StringGetLength(wszName, unFileNamesSize - unOffset, &unNameLength));
+				unOffset += unNameLength + 1;
+
+				IGNORE_RETURN_VALUE(Platform_StringCopy(wszFilePath, &unFilePathSize, wszPath));
+				unFilePathSize = RG_LEN(wszFilePath);
+				unReturnValue = Platform_StringConcatenatePaths(wszFilePath, &unFilePathSize, wszName);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					// The path is too long to be opened
+					IfxCheckImagesEntry* pEntry = CommandFlow_CheckImages_AddEntry(PpCheckImages, wszName);
+					if (NULL != pEntry)
+						pEntry->unErrorDetails = RC_E_INVALID_FW_OPTION;
+					Error_ClearStack();
+					continue;
+				}
+
+				CommandFlow_CheckImages_CheckFile(PpCheckImages, psBatch, wszFilePath, wszName);
+			}
+		}
+		CommandFlow_CheckImages_Flush(psBatch, FALSE);
+
+		PpCheckImages->unReturnCode = (TRUE == psBatch->fApplicable) ? RC_SUCCESS : RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&wszFileNames);
+	Platform_MemoryFree((void**)&psBatch);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
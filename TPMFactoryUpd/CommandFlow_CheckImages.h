@@ -0,0 +1,48 @@
+﻿/**
+ *	@brief		Declares the command flow to check which firmware images can be used to update the TPM.
+ *	@details	This module probes the TPM once and checks the firmware images of a folder or a firmware image bundle
+ *				against this state.
+ *	@file		CommandFlow_CheckImages.h
+ *	@copyright	Copyright 2014 - 2017 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "StdInclude.h"
+#include "TPMFactoryUpdStruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Checks which firmware images can be used to update the TPM.
+ *	@details	Probes the TPM once and runs the checks of FirmwareUpdate_CheckImage for each firmware image in the folder,
+ *				firmware image or firmware image bundle given with the -check-images command line option. The integrity
+ *				checks of the firmware images run concurrently, the results keep the order of the input. The TPM state
+ *				is not changed.
+ *
+ *	@param		PpCheckImages				Pointer to an initialized IfxCheckImages structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully. PpCheckImages->unReturnCode is RC_SUCCESS
+ *											if at least one firmware image is applicable, RC_E_FIRMWARE_UPDATE_NOT_FOUND otherwise.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INVALID_FW_OPTION		The folder cannot be read.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_CheckImages_Execute(
+	_Inout_ IfxCheckImages* PpCheckImages);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,156 @@
+﻿/**
+ *	@brief		Implements the command flow to decode a TPM capture file.
+ *	@details	This module parses a capture file recorded with the RECORD setting of the [TPM_DEVICE_ACCESS] section.
+ *				The format is described in TpmReplay.h.
+ *	@file		CommandFlow_DecodeCapture.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CommandFlow_DecodeCapture.h"
+#include "DeviceManagement.h"
+#include "FileIO.h"
+#include "TpmReplay.h"
+#include "TPM2_Types.h"
+
+/**
+ *	@brief		Reads a big endian UINT32 from a byte stream
+ *
+ *	@param		PrgbBuffer		Pointer to the first of four bytes
+ *	@returns	The value
+ */
+static UINT32
+CommandFlow_DecodeCapture_GetUInt32(
+	_In_bytecount_(4)	const BYTE*	PrgbBuffer)
+{
+	return ((UINT32)PrgbBuffer[0] << 24) | ((UINT32)PrgbBuffer[1] << 16) | ((UINT32)PrgbBuffer[2] << 8) | PrgbBuffer[3];
+}
+
+/**
+ *	@brief		Decodes a TPM capture file.
+ *	@details	Loads the capture file given with the -decode-capture command line option and decodes the recorded
+ *				TPM commands into PpDecodeCapture->rgsRecords. The TPM is not accessed.
+ *
+ *	@param		PpDecodeCapture				Pointer to an initialized IfxDecodeCapture structure to be filled in
+ *
+ *	@retval		RC_SUCCESS					The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER			An invalid parameter was passed to the function.
+ *	@retval		RC_E_INVALID_SETTING		The file is not a TPM capture file.
+ *	@retval		RC_E_FAIL					An unexpected error occurred.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_DecodeCapture_Execute(
+	_Inout_ IfxDecodeCapture* PpDecodeCapture)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszCapturePath[MAX_PATH] = {0};
+		unsigned int unCapturePathSize = RG_LEN(wszCapturePath);
+		unsigned int unOffset = TPM_CAPTURE_FILE_HEADER_SIZE;
+		unsigned int unMaxRecordCount = 0;
+
+		// Check parameters
+		if (NULL == PpDecodeCapture || STRUCT_TYPE_DecodeCapture != PpDecodeCapture->unType || sizeof(IfxDecodeCapture) != PpDecodeCapture->unSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected. DecodeCapture structure is not in the correct state.");
+			break;
+		}
+		PpDecodeCapture->unReturnCode = RC_E_FAIL;
+
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_DECODE_CAPTURE, wszCapturePath, &unCapturePathSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", PROPERTY_DECODE_CAPTURE);
+			break;
+		}
+
+		unReturnValue = FileIO_ReadFileToBuffer(wszCapturePath, &PpDecodeCapture->rgbCaptureFile, &PpDecodeCapture->unCaptureFileSize);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Failed to read the capture file (%ls). (0x%.8X)", wszCapturePath, unReturnValue);
+			break;
+		}
+
+		if (PpDecodeCapture->unCaptureFileSize < TPM_CAPTURE_FILE_HEADER_SIZE ||
+				0 != Platform_MemoryCompare(PpDecodeCapture->rgbCaptureFile, TPM_CAPTURE_MAGIC, TPM_CAPTURE_MAGIC_SIZE) ||
+				TPM_CAPTURE_VERSION != CommandFlow_DecodeCapture_GetUInt32(&PpDecodeCapture->rgbCaptureFile[TPM_CAPTURE_MAGIC_SIZE]))
+		{
+			unReturnValue = RC_E_INVALID_SETTING;
+			ERROR_STORE_FMT(unReturnValue, L"'%ls' is not a valid TPM capture file.", wszCapturePath);
+			break;
+		}
+
+		// Every record holds at least its header, this bounds the size of the record table
+		unMaxRecordCount = (PpDecodeCapture->unCaptureFileSize - TPM_CAPTURE_FILE_HEADER_SIZE) / TPM_CAPTURE_RECORD_HEADER_SIZE;
+		if (0 != unMaxRecordCount)
+		{
+			PpDecodeCapture->rgsRecords = (IfxCaptureRecord*)Platform_MemoryAllocateZero(unMaxRecordCount * sizeof(IfxCaptureRecord));
+			if (NULL == PpDecodeCapture->rgsRecords)
+			{
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+				break;
+			}
+		}
+
+		while (PpDecodeCapture->unCaptureFileSize - unOffset >= TPM_CAPTURE_RECORD_HEADER_SIZE)
+		{
+			const BYTE* rgbHeader = &PpDecodeCapture->rgbCaptureFile[unOffset];
+			IfxCaptureRecord* pRecord = &PpDecodeCapture->rgsRecords[PpDecodeCapture->unRecordCount];
+			unsigned int unRemainingSize = PpDecodeCapture->unCaptureFileSize - unOffset - TPM_CAPTURE_RECORD_HEADER_SIZE;
+
+			pRecord->ullTimeStamp = ((unsigned long long)CommandFlow_DecodeCapture_GetUInt32(rgbHeader) << 32) | CommandFlow_DecodeCapture_GetUInt32(&rgbHeader[4]);
+			pRecord->unDuration = CommandFlow_DecodeCapture_GetUInt32(&rgbHeader[8]);
+			pRecord->unTransmitReturnCode = CommandFlow_DecodeCapture_GetUInt32(&rgbHeader[12]);
+			pRecord->unRequestSize = CommandFlow_DecodeCapture_GetUInt32(&rgbHeader[16]);
+			pRecord->unResponseSize = CommandFlow_DecodeCapture_GetUInt32(&rgbHeader[20]);
+			if (pRecord->unRequestSize > unRemainingSize || pRecord->unResponseSize > unRemainingSize - pRecord->unRequestSize)
+				break;
+
+			pRecord->rgbRequest = rgbHeader + TPM_CAPTURE_RECORD_HEADER_SIZE;
+			pRecord->rgbResponse = pRecord->rgbRequest + pRecord->unRequestSize;
+			if (pRecord->unRequestSize >= 10)
+			{
+				UINT16 usTag = (UINT16)((pRecord->rgbRequest[0] << 8) | pRecord->rgbRequest[1]);
+				pRecord->unCommandCode = CommandFlow_DecodeCapture_GetUInt32(&pRecord->rgbRequest[6]);
+				pRecord->fTpm12 = (TPM_ST_NO_SESSIONS != usTag && TPM_ST_SESSIONS != usTag);
+			}
+			pRecord->pwszCommandName = DeviceManagement_GetRequestCommandName(pRecord->rgbRequest, pRecord->unRequestSize);
+			if (RC_SUCCESS == pRecord->unTransmitReturnCode && pRecord->unResponseSize >= 10)
+			{
+				pRecord->fResponseCode = TRUE;
+				pRecord->unResponseCode = CommandFlow_DecodeCapture_GetUInt32(&pRecord->rgbResponse[6]);
+			}
+
+			unOffset += TPM_CAPTURE_RECORD_HEADER_SIZE + pRecord->unRequestSize + pRecord->unResponseSize;
+			PpDecodeCapture->unRecordCount++;
+		}
+
+		// A capture of an interrupted run may end with an incomplete record
+		PpDecodeCapture->unTruncatedSize = PpDecodeCapture->unCaptureFileSize - unOffset;
+		if (0 != PpDecodeCapture->unTruncatedSize)
+			LOGGING_WRITE_LEVEL1_FMT(L"The capture file '%ls' is truncated after %d records (%d bytes left).", wszCapturePath, PpDecodeCapture->unRecordCount, PpDecodeCapture->unTruncatedSize);
+
+		PpDecodeCapture->unReturnCode = RC_SUCCESS;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
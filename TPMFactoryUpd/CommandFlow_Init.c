@@ -14,15 +14,15 @@
  */
 
 #include "CommandFlow_Init.h"
-#include "Crypt.h"
+#include "CommandFlow_TpmInfo.h"
+#include "Controller.h"
 
 /**
  *	@brief		Initializes the business logic of TPMFactoryUpd.
- *	@details	This method seeds the random number generator.
+ *	@details	The random number generator is seeded by Crypt_GetRandom on first use, so that
+ *				operations without cryptography (e.g. -info) do not load libcrypto.
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_FAIL					An unexpected error occurred.
- *	@retval		...							Error codes from Crypt_SeedRandom().
  */
 _Check_return_
 unsigned int
@@ -34,10 +34,7 @@ CommandFlow_Init_Execute()
 
 	do
 	{
-		// Seed the random number generator
-		unReturnValue = Crypt_SeedRandom(NULL, 0);
-		if (RC_SUCCESS != unReturnValue)
-			break;
+		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
@@ -45,3 +42,27 @@ CommandFlow_Init_Execute()
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Checks whether the requested operation needs access to the TPM.
+ *	@details	The -info command line option can be answered from the TPM information cache without connecting to the TPM.
+ *				The -benchmark command line option connects to a simulated TPM instead, -decode-capture and -build-frames do not access a TPM.
+ *				With several TPM device paths each device is connected by its own worker process, the factory loop connects
+ *				the TPM of each unit.
+ *
+ *	@retval		TRUE	The TPM must be connected.
+ *	@retval		FALSE	The operation can be processed without TPM access.
+ */
+_Check_return_
+BOOL
+CommandFlow_Init_IsTpmAccessRequired()
+{
+	if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BENCHMARK) ||
+			TRUE == PropertyStorage_ExistsElement(PROPERTY_DECODE_CAPTURE) ||
+			TRUE == PropertyStorage_ExistsElement(PROPERTY_BUILD_FRAMES) ||
+			TRUE == PropertyStorage_ExistsElement(PROPERTY_FACTORY_LOOP) ||
+			TRUE == Controller_DevicesIsSet())
+		return FALSE;
+
+	return !CommandFlow_TpmInfo_LoadCache();
+}
@@ -22,16 +22,26 @@ extern "C" {
 
 /**
  *	@brief		Initializes the business logic of TPMFactoryUpd.
- *	@details	This method seeds the random number generator.
+ *	@details	The random number generator is seeded by Crypt_GetRandom on first use.
  *
  *	@retval		RC_SUCCESS					The operation completed successfully.
- *	@retval		RC_E_FAIL					An unexpected error occurred.
- *	@retval		...							Error codes from Crypt_SeedRandom().
  */
 _Check_return_
 unsigned int
 CommandFlow_Init_Execute();
 
+/**
+ *	@brief		Checks whether the requested operation needs access to the TPM.
+ *	@details	The -info command line option can be answered from the TPM information cache without connecting to the TPM.
+ *				The -benchmark command line option connects to a simulated TPM instead, -decode-capture and -build-frames do not access a TPM.
+ *
+ *	@retval		TRUE	The TPM must be connected.
+ *	@retval		FALSE	The operation can be processed without TPM access.
+ */
+_Check_return_
+BOOL
+CommandFlow_Init_IsTpmAccessRequired();
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
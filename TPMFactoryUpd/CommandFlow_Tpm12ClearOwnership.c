@@ -16,7 +16,6 @@
 #include "CommandFlow_Tpm12ClearOwnership.h"
 #include "FirmwareUpdate.h"
 #include "Crypt.h"
-#include "TPM_OIAP.h"
 #include "TPM_OSAP.h"
 #include "TPM_OwnerClear.h"
 
@@ -26,10 +25,12 @@
  *				The function utilizes the MicroTss library.
  *
  *	@param		PpTpmClearOwnership		Pointer to an initialized IfxTpm12ClearOwnership structure to be filled in
+ *	@param		PfOwnerAuthKnown		TRUE if the owner authorization has just been used by the update of the same run,
+ *										the owner authorization check is skipped then.
  *
  *	@retval		RC_SUCCESS						The operation completed successfully.
  *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function. PpTpmClearOwnership was invalid.
- *	@retval		RC_E_NOT_SUPPORTED_FEATURE		In case of the TPM is a TPM2.0
+ *	@retval		RC_E_TPM_NOT_SUPPORTED_FEATURE	In case of the TPM is a TPM2.0 or TPM1.2 support is not compiled into the binary
  *	@retval		RC_E_TPM12_NO_OWNER				The TPM1.2 does not have an owner.
  *	@retval		RC_E_NO_IFX_TPM					The underlying TPM is not an Infineon TPM.
  *	@retval		RC_E_UNSUPPORTED_CHIP			In case of the underlying TPM does not support that functionality
@@ -38,14 +39,16 @@
  *	@retval		...								Error codes from called functions.
  */
 _Check_return_
-unsigned int
-CommandFlow_Tpm12ClearOwnership_Execute(
-	_Inout_ IfxTpm12ClearOwnership* PpTpmClearOwnership)
+static unsigned int
+CommandFlow_Tpm12ClearOwnership_ClearOwner(
+	_Inout_ IfxTpm12ClearOwnership* PpTpmClearOwnership,
+	_In_ BOOL PfOwnerAuthKnown)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 
 	do
 	{
+#if IFX_ENABLE_TPM12
 		// TPM operation mode
 		TPM_STATE sTpmState = {{0}};
 		// SHA1 Hash of the default owner password
@@ -56,6 +59,7 @@ CommandFlow_Tpm12ClearOwnership_Execute(
 				0x6d, 0x79, 0x81, 0x8f, 0x8f
 			}
 		};
+#endif
 
 		// Parameter check
 		if (NULL == PpTpmClearOwnership)
@@ -65,6 +69,12 @@ CommandFlow_Tpm12ClearOwnership_Execute(
 			break;
 		}
 
+#if !IFX_ENABLE_TPM12
+		// TPM1.2 support is not compiled into the binary, the TPM is not probed at all
+		UNREFERENCED_PARAMETER(PfOwnerAuthKnown);
+		unReturnValue = RC_E_TPM_NOT_SUPPORTED_FEATURE;
+		ERROR_STORE(unReturnValue, L"TPM1.2 support is not compiled into this build.");
+#else
 		// Calculate TPM operational mode
 		unReturnValue = FirmwareUpdate_CalculateState(&sTpmState);
 		if (RC_SUCCESS != unReturnValue)
@@ -114,7 +124,10 @@ CommandFlow_Tpm12ClearOwnership_Execute(
 		}
 
 		// Check if owner authorization password is the default value as expected
-		unReturnValue = FirmwareUpdate_CheckOwnerAuthorization(ownerAuthData.authdata);
+		if (PfOwnerAuthKnown)
+			unReturnValue = RC_SUCCESS;
+		else
+			unReturnValue = FirmwareUpdate_CheckOwnerAuthorization(ownerAuthData.authdata);
 		if (RC_SUCCESS != unReturnValue)
 		{
 			ERROR_STORE(unReturnValue, L"FirmwareUpdate_CheckOwnerAuthorization returned an unexpected value.");
@@ -131,22 +144,21 @@ CommandFlow_Tpm12ClearOwnership_Execute(
 			TPM_AUTHHANDLE unAuthHandle = 0;
 			TPM_NONCE sNonceEven = {{0}};
 
-			// Create OIAP Session
-			unReturnValue = TSS_TPM_OIAP(&unAuthHandle, &sNonceEven);
+			// Reuse the OIAP session of the owner authorization check, otherwise a new one is started
+			unReturnValue = FirmwareUpdate_Tpm12_AcquireAuthSession(&unAuthHandle, &sNonceEven);
 			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"TPM_OIAP command returned an unexpected value");
 				break;
-			}
 
 			// Clear TPM1.2 Ownership
 			unReturnValue = TSS_TPM_OwnerClear(unAuthHandle, &sNonceEven, FALSE, &ownerAuthData);
+			FirmwareUpdate_InvalidateState();
 			if (RC_SUCCESS != unReturnValue)
 			{
 				ERROR_STORE(unReturnValue, L"TPMOwnerClear returned an unexpected value");
 				break;
 			}
 		}
+#endif // IFX_ENABLE_TPM12
 	}
 	WHILE_FALSE_END;
 
@@ -155,3 +167,42 @@ CommandFlow_Tpm12ClearOwnership_Execute(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Processes a sequence of TPM commands to clear the TPM1.2 ownership.
+ *	@details	This function removes the TPM owner that was temporarily created during an update from TPM1.2 to TPM1.2.
+ *				The function utilizes the MicroTss library.
+ *
+ *	@param		PpTpmClearOwnership		Pointer to an initialized IfxTpm12ClearOwnership structure to be filled in
+ *
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function. PpTpmClearOwnership was invalid.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_Tpm12ClearOwnership_Execute(
+	_Inout_ IfxTpm12ClearOwnership* PpTpmClearOwnership)
+{
+	return CommandFlow_Tpm12ClearOwnership_ClearOwner(PpTpmClearOwnership, FALSE);
+}
+
+/**
+ *	@brief		Clears the TPM1.2 ownership taken by the update of the same run.
+ *	@details	The update with the tpm12-takeownership type has just authorized the firmware update with the known owner
+ *				authorization, so the owner authorization check is skipped. The OIAP session does not survive the TPM
+ *				restart into the new firmware, a new one is started for TPM_OwnerClear.
+ *
+ *	@param		PpTpmClearOwnership		Pointer to an initialized IfxTpm12ClearOwnership structure to be filled in
+ *
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function. PpTpmClearOwnership was invalid.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_Tpm12ClearOwnership_ExecuteAfterUpdate(
+	_Inout_ IfxTpm12ClearOwnership* PpTpmClearOwnership)
+{
+	return CommandFlow_Tpm12ClearOwnership_ClearOwner(PpTpmClearOwnership, TRUE);
+}
@@ -43,6 +43,21 @@ unsigned int
 CommandFlow_Tpm12ClearOwnership_Execute(
 	_Inout_ IfxTpm12ClearOwnership* PpTpmClearOwnership);
 
+/**
+ *	@brief		Clears the TPM1.2 ownership taken by the update of the same run.
+ *	@details	The owner authorization check is skipped because the update has just used the known owner authorization.
+ *
+ *	@param		PpTpmClearOwnership		Pointer to an initialized IfxTpm12ClearOwnership structure to be filled in
+ *
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER				An invalid parameter was passed to the function. PpTpmClearOwnership was invalid.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_Tpm12ClearOwnership_ExecuteAfterUpdate(
+	_Inout_ IfxTpm12ClearOwnership* PpTpmClearOwnership);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,13 +15,223 @@
  */
 
 #include "CommandFlow_TpmInfo.h"
+#include "CommandFlow_TpmUpdate.h"
 #include "FirmwareUpdate.h"
+#include "FileIO.h"
+#include "DeviceManagement.h"
+#include "PropertyDefines.h"
+#include "Trace.h"
+
+/// Magic value identifying a TPM information cache file
+#define INFO_CACHE_MAGIC	0x49465843
+
+/// Layout of the TPM information cache file
+typedef struct tdIfxInfoCache
+{
+	/// Magic value (INFO_CACHE_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the cached IfxInfo structure, protects against a cache file written by another build
+	unsigned int			unInfoSize;
+	/// Monotonic time stamp in microseconds when the information was retrieved from the TPM
+	unsigned long long		ullTimestamp;
+	/// Cached TPM information (version name, TPM state and field upgrade counter)
+	IfxInfo					sInfo;
+} IfxInfoCache;
+
+/// Flag indicating that s_sCachedInfo holds a fresh copy of the TPM information cache file
+BOOL s_fCachedInfoValid = FALSE;
+/// TPM information read from the cache file
+IfxInfo s_sCachedInfo;
+/// Flag indicating that the TPM information queried from the TPM is kept in s_sCachedInfo
+static BOOL s_fKeepCacheInMemory = FALSE;
+
+/**
+ *	@brief		Stores the TPM information in the cache file.
+ *	@details	Errors are logged only, because a missing cache file just causes the next call to query the TPM again.
+ *
+ *	@param		PpTpmInfo				Pointer to the IfxInfo structure retrieved from the TPM
+ */
+void
+CommandFlow_TpmInfo_StoreCache(
+	_In_ const IfxInfo* PpTpmInfo)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		IfxInfoCache sCache;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sCache, 0, sizeof(sCache)));
+		sCache.unMagic = INFO_CACHE_MAGIC;
+		sCache.unInfoSize = sizeof(IfxInfo);
+		sCache.ullTimestamp = Platform_GetMonotonicTimeMicroSeconds();
+		if (0 == sCache.ullTimestamp)
+			break;
+		unReturnValue = Platform_MemoryCopy(&sCache.sInfo, sizeof(sCache.sInfo), PpTpmInfo, sizeof(IfxInfo));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_Open(TPM_FACTORY_UPD_INFO_CACHE_FILE, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sCache, sizeof(sCache));
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not write the TPM information cache file '%ls' (0x%.8X).", TPM_FACTORY_UPD_INFO_CACHE_FILE, unReturnValue);
+	}
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
+
+/**
+ *	@brief		Loads the TPM information cache file.
+ *	@details	The cache is only consulted for the -info command line option combined with -info-cache <seconds>.
+ *				The cache file is accepted if it has been written by this build within the configured time to live.
+ *				Independent of the command line, the TPM family of a cache file written by this build is passed to
+ *				FirmwareUpdate_SetTpm12Hint(), so the state detection starts with the family seen last time.
+ *				The time stamp is taken from the monotonic clock, so the cache file must live on a file system
+ *				which is cleared on reboot (like /run).
+ *
+ *	@retval		TRUE	The cached TPM information is valid and will be returned by CommandFlow_TpmInfo_Execute().
+ *	@retval		FALSE	The TPM must be queried.
+ */
+_Check_return_
+BOOL
+CommandFlow_TpmInfo_LoadCache()
+{
+	BYTE* prgbCache = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		BOOL fInfo = FALSE;
+		unsigned int unTimeToLive = 0;
+		unsigned int unCacheSize = 0;
+		unsigned long long ullNow = 0;
+		const IfxInfoCache* pCache = NULL;
+
+		if (TRUE == s_fCachedInfoValid)
+			break;
+
+		if (FALSE == FileIO_Exists(TPM_FACTORY_UPD_INFO_CACHE_FILE))
+			break;
+
+		if (RC_SUCCESS != FileIO_ReadFileToBuffer(TPM_FACTORY_UPD_INFO_CACHE_FILE, &prgbCache, &unCacheSize) ||
+				sizeof(IfxInfoCache) != unCacheSize)
+			break;
+
+		pCache = (const IfxInfoCache*)prgbCache;
+		if (INFO_CACHE_MAGIC != pCache->unMagic ||
+				sizeof(IfxInfo) != pCache->unInfoSize ||
+				STRUCT_TYPE_TpmInfo != pCache->sInfo.unType ||
+				sizeof(IfxInfo) != pCache->sInfo.unSize ||
+				RC_SUCCESS != pCache->sInfo.unReturnCode)
+		{
+			LOGGING_WRITE_LEVEL3(L"TPM information cache file is invalid.");
+			break;
+		}
+
+		// A stale entry is still good enough as a hint, a wrong hint only costs one TPM command
+		FirmwareUpdate_SetTpm12Hint(pCache->sInfo.sTpmState.attribs.tpm12 || pCache->sInfo.sTpmState.attribs.bootLoader);
+
+		if (FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fInfo) || FALSE == fInfo ||
+				FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_INFO_CACHE_TTL, &unTimeToLive))
+			break;
+
+		ullNow = Platform_GetMonotonicTimeMicroSeconds();
+		if (ullNow < pCache->ullTimestamp ||
+				ullNow - pCache->ullTimestamp > (unsigned long long)unTimeToLive * 1000000)
+		{
+			LOGGING_WRITE_LEVEL3(L"TPM information cache file is stale or invalid.");
+			break;
+		}
+
+		if (RC_SUCCESS != Platform_MemoryCopy(&s_sCachedInfo, sizeof(s_sCachedInfo), &pCache->sInfo, sizeof(IfxInfo)))
+			break;
+		s_sCachedInfo.wszVersionName[RG_LEN(s_sCachedInfo.wszVersionName) - 1] = L'\0';
+		s_fCachedInfoValid = TRUE;
+
+		LOGGING_WRITE_LEVEL3_FMT(L"Using cached TPM information (version: %ls, remaining updates: %d, age: %llu ms).",
+								 s_sCachedInfo.wszVersionName, s_sCachedInfo.unRemainingUpdates, (ullNow - pCache->ullTimestamp) / 1000);
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbCache);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, s_fCachedInfoValid);
+
+	return s_fCachedInfoValid;
+}
+
+/**
+ *	@brief		Invalidates the TPM information cache.
+ *	@details	Must be called before any operation which changes the firmware version, the field upgrade counter or the TPM state.
+ */
+void
+CommandFlow_TpmInfo_InvalidateCache()
+{
+	s_fCachedInfoValid = FALSE;
+	if (TRUE == FileIO_Exists(TPM_FACTORY_UPD_INFO_CACHE_FILE))
+	{
+		unsigned int unReturnValue = FileIO_Remove(TPM_FACTORY_UPD_INFO_CACHE_FILE);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Could not remove the TPM information cache file '%ls' (0x%.8X).", TPM_FACTORY_UPD_INFO_CACHE_FILE, unReturnValue);
+		}
+	}
+}
+
+/**
+ *	@brief		Keeps the TPM information in memory.
+ *	@details	Used by the service, batch and library modes: the TPM information queried by CommandFlow_TpmInfo_Execute() is
+ *				returned by the following calls until CommandFlow_TpmInfo_InvalidateCache() is called. Switching it off drops
+ *				the information kept in memory, e.g. before another TPM is connected.
+ *
+ *	@param		PfKeep		TRUE to keep the TPM information in memory, FALSE to stop keeping it
+ */
+void
+CommandFlow_TpmInfo_KeepCacheInMemory(
+	_In_ BOOL PfKeep)
+{
+	s_fKeepCacheInMemory = PfKeep;
+	if (!PfKeep)
+		s_fCachedInfoValid = FALSE;
+}
+
+/**
+ *	@brief		Gets the TPM information kept in memory.
+ *	@details	Does not access the TPM, so the service can answer info requests while a request changing the TPM state is
+ *				processed.
+ *
+ *	@param		PpTpmInfo		Receives a copy of the TPM information kept in memory
+ *	@retval		TRUE			The TPM information has been copied.
+ *	@retval		FALSE			No TPM information is kept in memory.
+ */
+BOOL
+CommandFlow_TpmInfo_GetCachedInfo(
+	_Out_ IfxInfo* PpTpmInfo)
+{
+	if (TRUE != s_fCachedInfoValid || RC_SUCCESS != Platform_MemoryCopy(PpTpmInfo, sizeof(IfxInfo), &s_sCachedInfo, sizeof(IfxInfo)))
+		return FALSE;
+
+	return TRUE;
+}
 
 /**
  *	@brief		Processes a sequence of TPM info related commands.
  *	@details	This function collects TPM Firmware Update related information via specific TPM commands.
  *				Afterwards the TPM related information is returned to the calling module.
- *				The function utilizes the MicroTss library.
+ *				The function utilizes the MicroTss library. Only the fields selected with -info <fields> are queried.
  *
  *	@param		PpTpmInfo				Pointer to an initialized IfxInfo structure to be filled in
  *	@retval		RC_SUCCESS				The operation completed successfully.
@@ -41,6 +251,9 @@ CommandFlow_TpmInfo_Execute(
 	do
 	{
 		unsigned int unVersionNameSize = 0;
+		unsigned int unFields = TPM_INFO_FIELDS_ALL;
+		unsigned long long ullTime = 0;
+		IfxPhaseLoad sLoad;
 
 		// Check parameters
 		if (NULL == PpTpmInfo ||
@@ -55,13 +268,63 @@ CommandFlow_TpmInfo_Execute(
 		PpTpmInfo->unReturnCode = RC_E_FAIL;
 		PpTpmInfo->unRemainingUpdates = REMAINING_UPDATES_UNAVAILABLE; // -1
 		unVersionNameSize = RG_LEN(PpTpmInfo->wszVersionName);
+		if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_INFO_FIELDS, &unFields))
+			unFields = TPM_INFO_FIELDS_ALL;
+
+		// Answer from the cache file if CommandFlow_TpmInfo_LoadCache() accepted it, the timings belong to this run
+		if (TRUE == s_fCachedInfoValid)
+		{
+			IfxPhaseTimings sTimings = PpTpmInfo->sTimings;
+			IfxPhaseTimings sCpuTimings = PpTpmInfo->sCpuTimings;
+			IfxPhaseTimings sWaitTimings = PpTpmInfo->sWaitTimings;
+			unReturnValue = Platform_MemoryCopy(PpTpmInfo, sizeof(IfxInfo), &s_sCachedInfo, sizeof(IfxInfo));
+			PpTpmInfo->sTimings = sTimings;
+			PpTpmInfo->sCpuTimings = sCpuTimings;
+			PpTpmInfo->sWaitTimings = sWaitTimings;
+			PpTpmInfo->unFields = unFields;
+			break;
+		}
 
 		// Get the actual image info
-		unReturnValue = FirmwareUpdate_GetImageInfo(PpTpmInfo->wszVersionName, &unVersionNameSize, &PpTpmInfo->sTpmState, &PpTpmInfo->unRemainingUpdates);
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
+		unReturnValue = FirmwareUpdate_GetImageInfo(PpTpmInfo->wszVersionName, &unVersionNameSize, &PpTpmInfo->sTpmState, &PpTpmInfo->unRemainingUpdates, unFields);
+		PpTpmInfo->sTimings.ullStateTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		PpTpmInfo->sCpuTimings.ullStateTime = sLoad.ullCpuTime;
+		PpTpmInfo->sWaitTimings.ullStateTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"state", ullTime, PpTpmInfo->sTimings.ullStateTime, NULL);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
 		PpTpmInfo->unReturnCode = RC_SUCCESS;
+		PpTpmInfo->unFields = unFields;
+
+		// The learned command timeouts are only valid for the TPM device and firmware version they were observed with
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_LEARN_TIMEOUTS))
+		{
+			wchar_t wszTimeoutsFile[MAX_PATH] = {0};
+			unsigned int unTimeoutsFileSize = RG_LEN(wszTimeoutsFile);
+			wchar_t wszTimeoutsKey[MAX_PATH] = {0};
+			unsigned int unTimeoutsKeySize = RG_LEN(wszTimeoutsKey);
+
+			// The file name contains the device path, the key repeats it so a file copied to another device starts over
+			if (RC_SUCCESS == CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_TIMEOUTS_FILE_PREFIX, wszTimeoutsFile, &unTimeoutsFileSize) &&
+					RC_SUCCESS == Platform_StringFormat(wszTimeoutsKey, &unTimeoutsKeySize, L"%ls %ls", wszTimeoutsFile, PpTpmInfo->wszVersionName))
+				DeviceManagement_LoadLearnedTimeouts(wszTimeoutsFile, wszTimeoutsKey);
+		}
+
+		// Only complete TPM information is cached
+		if (TPM_INFO_FIELDS_ALL != unFields)
+			break;
+
+		// Refresh the cache file if requested
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_INFO_CACHE_TTL))
+			CommandFlow_TpmInfo_StoreCache(PpTpmInfo);
+
+		// Answer the next calls from memory
+		if (TRUE == s_fKeepCacheInMemory && RC_SUCCESS == Platform_MemoryCopy(&s_sCachedInfo, sizeof(s_sCachedInfo), PpTpmInfo, sizeof(IfxInfo)))
+			s_fCachedInfoValid = TRUE;
 	}
 	WHILE_FALSE_END;
 
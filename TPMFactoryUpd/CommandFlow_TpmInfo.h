@@ -22,6 +22,58 @@
 extern "C" {
 #endif
 
+/// TPM information cache file used by the -info-cache command line option
+#define TPM_FACTORY_UPD_INFO_CACHE_FILE L"/run/TPMFactoryUpd_InfoCache.bin"
+
+/// Prefix of the files the TPM command timeouts learned with the -learn-timeouts command line option are stored in (followed by the TPM device path)
+#define TPM_FACTORY_UPD_TIMEOUTS_FILE_PREFIX L"/var/cache/TPMFactoryUpd_Timeouts"
+
+/**
+ *	@brief		Loads the TPM information cache file.
+ *	@details	The cache is only consulted for the -info command line option combined with -info-cache <seconds>.
+ *				The cache file is accepted if it has been written by this build within the configured time to live.
+ *				The time stamp is taken from the monotonic clock, so the cache file must live on a file system
+ *				which is cleared on reboot (like /run).
+ *
+ *	@retval		TRUE	The cached TPM information is valid and will be returned by CommandFlow_TpmInfo_Execute().
+ *	@retval		FALSE	The TPM must be queried.
+ */
+_Check_return_
+BOOL
+CommandFlow_TpmInfo_LoadCache();
+
+/**
+ *	@brief		Invalidates the TPM information cache.
+ *	@details	Must be called before any operation which changes the firmware version, the field upgrade counter or the TPM state.
+ */
+void
+CommandFlow_TpmInfo_InvalidateCache();
+
+/**
+ *	@brief		Keeps the TPM information in memory.
+ *	@details	Used by the service, batch and library modes: the TPM information queried by CommandFlow_TpmInfo_Execute() is
+ *				returned by the following calls until CommandFlow_TpmInfo_InvalidateCache() is called. Switching it off drops
+ *				the information kept in memory, e.g. before another TPM is connected.
+ *
+ *	@param		PfKeep		TRUE to keep the TPM information in memory, FALSE to stop keeping it
+ */
+void
+CommandFlow_TpmInfo_KeepCacheInMemory(
+	_In_ BOOL PfKeep);
+
+/**
+ *	@brief		Gets the TPM information kept in memory.
+ *	@details	Does not access the TPM, so the service can answer info requests while a request changing the TPM state is
+ *				processed.
+ *
+ *	@param		PpTpmInfo		Receives a copy of the TPM information kept in memory
+ *	@retval		TRUE			The TPM information has been copied.
+ *	@retval		FALSE			No TPM information is kept in memory.
+ */
+BOOL
+CommandFlow_TpmInfo_GetCachedInfo(
+	_Out_ IfxInfo* PpTpmInfo);
+
 /**
  *	@brief		Processes a sequence of TPM info related commands.
  *	@details	This function collects TPM Firmware Update related information via specific TPM commands.
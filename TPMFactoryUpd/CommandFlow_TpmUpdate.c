@@ -24,6 +24,8 @@
 #include "TPMFactoryUpdStruct.h"
 #include "Resource.h"
 #include "FileIO.h"
+#include "DeviceManagement.h"
+#include "Trace.h"
 
 #include <TPM2_FlushContext.h>
 #include <TPM2_StartAuthSession.h>
@@ -43,18 +45,2118 @@
 
 #define TPM_FACTORY_UPD_RUNDATA_FILE L"TPMFactoryUpd_RunData.txt"
 
+/// Firmware image bundle file used in the firmware folder if the firmware image file of the update path does not exist
+#define TPM_FIRMWARE_BUNDLE_FILE_NAME L"TPM_Firmware_Bundle.BIN"
+
 // Exemplary SHA-1 hash value of 20 zero bytes (assumes that TPM Ownership has been taken with this string as TPM Owner authentication)
 
-TPM_AUTHDATA s_ownerAuthData = {{
-		0x67, 0x68, 0x03, 0x3e, 0x21,
-		0x64, 0x68, 0x24, 0x7b, 0xd0,
-		0x31, 0xa0, 0xa2, 0xd9, 0x87,
-		0x6d, 0x79, 0x81, 0x8f, 0x8f
+TPM_AUTHDATA s_ownerAuthData = {{
+		0x67, 0x68, 0x03, 0x3e, 0x21,
+		0x64, 0x68, 0x24, 0x7b, 0xd0,
+		0x31, 0xa0, 0xa2, 0xd9, 0x87,
+		0x6d, 0x79, 0x81, 0x8f, 0x8f
+	}
+};
+
+// Flag to remember that firmware update is done through config file option
+BOOL s_fUpdateThroughConfigFile = FALSE;
+
+// Source version of the update path to select from a firmware image bundle, empty for the running TPM firmware version
+wchar_t s_wszBundleSourceVersion[MAX_NAME] = {0};
+// Target version of the update path to select from a firmware image bundle, empty for any target version
+wchar_t s_wszBundleTargetVersion[MAX_NAME] = {0};
+// Flag to remember that the firmware image has been selected from a firmware image bundle
+BOOL s_fUpdateThroughBundle = FALSE;
+
+/// Maximum number of firmware images chained to reach the target firmware of a config file
+#define UPDATE_CHAIN_MAX_HOPS	4
+/// Maximum number of firmware images of the firmware folder considered for an update chain
+#define UPDATE_CHAIN_MAX_IMAGES	64
+/// Capacity of the buffer receiving the file names of the firmware folder in characters
+#define UPDATE_CHAIN_FILE_NAMES_SIZE	(UPDATE_CHAIN_MAX_IMAGES * MAX_NAME)
+/// Marks the first firmware image of an update chain
+#define UPDATE_CHAIN_NONE	((unsigned int)-1)
+
+/// Firmware image of the firmware folder considered for an update chain
+typedef struct tdIfxUpdateChainImage
+{
+	/// File name
+	const wchar_t*			pwszFileName;
+	/// Source family and version taken from the file name (e.g. TPM20_7.63.3353.0)
+	wchar_t					wszSource[MAX_NAME];
+	/// Target family and version taken from the file name
+	wchar_t					wszTarget[MAX_NAME];
+	/// Index of the preceding firmware image of the chain or UPDATE_CHAIN_NONE
+	unsigned int			unPrevious;
+	/// Number of firmware images up to and including this one, zero if the image is not reached yet
+	unsigned int			unHops;
+} IfxUpdateChainImage;
+
+// Flag to remember that the config file has been parsed, the updates of a chain and the requests of the service parse it
+// only once and then reload the sections changed
+BOOL s_fConfigFileParsed = FALSE;
+/// Path of the parsed config file
+static wchar_t s_wszParsedConfigFile[MAX_STRING_1024] = {0};
+/// Section digests of the parsed config file
+static IfxConfigDigest s_sParsedConfigDigest;
+/// Watch of the parsed config file
+static void* s_pvParsedConfigWatch = NULL;
+// Number of firmware updates planned after the current one to reach the target firmware of the config file
+unsigned int s_unUpdateChainRemaining = 0;
+// TPM firmware version before the previous firmware update of the chain, empty for the first update
+wchar_t s_wszUpdateChainPreviousVersion[MAX_NAME] = {0};
+// Path of the firmware image of the next update of the chain, empty for the last update
+wchar_t s_wszUpdateChainNextImage[MAX_PATH] = {0};
+
+/// Maximum number of rules in the TargetFirmwareRules section of a config file
+#define TARGET_FIRMWARE_RULES_MAX	64
+
+/// Rule of the TargetFirmwareRules section mapping a range of TPM firmware versions to a target firmware
+typedef struct tdIfxTargetFirmwareRule
+{
+	/// Lowest TPM firmware version covered, as sortable integer (see CommandFlow_TpmUpdate_ParseRuleVersion)
+	unsigned long long		ullFirst;
+	/// Highest TPM firmware version covered, as sortable integer
+	unsigned long long		ullLast;
+	/// Target firmware version
+	wchar_t					wszTargetVersion[MAX_NAME];
+	/// File name of the firmware image, empty to compose it by the naming convention of update images
+	wchar_t					wszFirmwareImage[MAX_NAME];
+} IfxTargetFirmwareRule;
+
+// Rules of the TargetFirmwareRules section sorted by their lowest version, the version ranges do not overlap
+IfxTargetFirmwareRule s_rgsTargetFirmwareRules[TARGET_FIRMWARE_RULES_MAX];
+// Number of rules in s_rgsTargetFirmwareRules
+unsigned int s_unTargetFirmwareRules = 0;
+
+/// Magic value identifying a firmware image verification cache file
+#define VERIFY_CACHE_MAGIC	0x49465643
+/// Maximum number of firmware images remembered in the verification cache file
+#define VERIFY_CACHE_MAX_ENTRIES	8
+
+/// Key of a firmware image which passed the integrity and signature checks
+typedef struct tdIfxVerifyCacheEntry
+{
+	/// Size of the firmware image file (or firmware image bundle file) in bytes
+	unsigned long long		ullImageSize;
+	/// Modification time of the firmware image file in nanoseconds since the epoch
+	unsigned long long		ullModificationTime;
+	/// SHA-256 digest of the firmware image
+	BYTE					rgbImageDigest[SHA256_DIGEST_SIZE];
+} IfxVerifyCacheEntry;
+
+/// Layout of the firmware image verification cache file
+typedef struct tdIfxVerifyCache
+{
+	/// Magic value (VERIFY_CACHE_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the IfxVerifyCache structure, protects against a cache file written by another build
+	unsigned int			unCacheSize;
+	/// Number of valid entries, the most recently verified image comes first
+	unsigned int			unEntries;
+	/// Verified firmware images
+	IfxVerifyCacheEntry		rgsEntries[VERIFY_CACHE_MAX_ENTRIES];
+	/// SHA-256 digest of all preceding members and the code signing public key, detects corrupt or foreign cache files
+	BYTE					rgbCacheDigest[SHA256_DIGEST_SIZE];
+} IfxVerifyCache;
+
+/// Index file of the image cache folder used by the -verify-cache command line option for downloaded firmware images
+#define IMAGE_CACHE_INDEX_FILE_NAME	L"Index.bin"
+/// Magic value identifying an image cache index file
+#define IMAGE_CACHE_MAGIC	0x49464943
+/// Maximum number of downloaded firmware images kept in the image cache folder
+#define IMAGE_CACHE_MAX_ENTRIES	8
+/// Maximum total size of the firmware images kept in the image cache folder in bytes
+#define IMAGE_CACHE_MAX_SIZE	(64ULL * 1024 * 1024)
+
+/// Downloaded firmware image kept in the image cache folder
+typedef struct tdIfxImageCacheEntry
+{
+	/// URL the firmware image (or firmware image bundle) was downloaded from
+	wchar_t					wszUrl[MAX_PATH];
+	/// SHA-256 digest of the downloaded (and decompressed) content, names the file in the image cache folder
+	BYTE					rgbContentDigest[SHA256_DIGEST_SIZE];
+	/// Key of the cached file and the firmware image selected from it, also remembered in the verification cache file
+	IfxVerifyCacheEntry		sImage;
+} IfxImageCacheEntry;
+
+/// Layout of the image cache index file
+typedef struct tdIfxImageCache
+{
+	/// Magic value (IMAGE_CACHE_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the IfxImageCache structure, protects against an index file written by another build
+	unsigned int			unCacheSize;
+	/// Number of valid entries, the most recently used image comes first
+	unsigned int			unEntries;
+	/// Cached firmware images
+	IfxImageCacheEntry		rgsEntries[IMAGE_CACHE_MAX_ENTRIES];
+	/// SHA-256 digest of all preceding members and the code signing public key, detects corrupt or foreign index files
+	BYTE					rgbCacheDigest[SHA256_DIGEST_SIZE];
+} IfxImageCache;
+
+// URL of a downloaded firmware image to store in the image cache folder, empty for a local or cached firmware image
+wchar_t s_wszImageCacheUrl[MAX_PATH] = {0};
+
+/// Magic value identifying an update plan file
+#define UPDATE_PLAN_MAGIC	0x49465550
+
+/// Layout of the update plan file recorded by the -prepare command line option
+typedef struct tdIfxUpdatePlan
+{
+	/// Magic value (UPDATE_PLAN_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the IfxUpdatePlan structure, protects against a plan file written by another build
+	unsigned int			unPlanSize;
+	/// Key of the checked firmware image
+	IfxVerifyCacheEntry		sImage;
+	/// Firmware image path
+	wchar_t					wszFirmwarePath[MAX_PATH];
+	/// Update type (ENUM_UPDATE_TYPES)
+	unsigned int			unUpdateType;
+	/// TPM firmware version when the update was prepared
+	wchar_t					wszVersionName[MAX_NAME];
+	/// TPM family and mode when the update was prepared
+	BOOL					fTpm12;
+	BOOL					fTpm20;
+	BOOL					fBootLoader;
+	/// Number of remaining updates when the update was prepared
+	unsigned int			unRemainingUpdates;
+	/// Update path selected from a firmware image bundle (empty if no bundle is used)
+	wchar_t					wszBundleSourceVersion[MAX_NAME];
+	wchar_t					wszBundleTargetVersion[MAX_NAME];
+	/// SHA-256 digest of all preceding members and the code signing public key, detects corrupt or foreign plan files
+	BYTE					rgbPlanDigest[SHA256_DIGEST_SIZE];
+} IfxUpdatePlan;
+
+// Update plan loaded by the -commit command line option
+IfxUpdatePlan s_sUpdatePlan;
+
+/// Magic value identifying an update journal file
+#define UPDATE_JOURNAL_MAGIC	0x4946554A
+
+/// Layout of the update journal file written right before a firmware update is started
+typedef struct tdIfxUpdateJournal
+{
+	/// Magic value (UPDATE_JOURNAL_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the IfxUpdateJournal structure, protects against a journal file written by another build
+	unsigned int			unJournalSize;
+	/// Key of the firmware image which passed all checks before the update was started
+	IfxVerifyCacheEntry		sImage;
+	/// Firmware image path
+	wchar_t					wszFirmwarePath[MAX_PATH];
+	/// Update type (ENUM_UPDATE_TYPES)
+	unsigned int			unUpdateType;
+	/// TPM firmware version before the update and firmware version of the firmware image
+	wchar_t					wszSourceVersion[MAX_NAME];
+	wchar_t					wszTargetVersion[MAX_NAME];
+	/// Update path selected from a firmware image bundle (empty if no bundle is used)
+	wchar_t					wszBundleSourceVersion[MAX_NAME];
+	wchar_t					wszBundleTargetVersion[MAX_NAME];
+	/// SHA-256 digest of all preceding members and the code signing public key, detects corrupt or foreign journal files
+	BYTE					rgbJournalDigest[SHA256_DIGEST_SIZE];
+} IfxUpdateJournal;
+
+// Update journal of an interrupted firmware update, loaded by CommandFlow_TpmUpdate_LoadUpdateJournal()
+IfxUpdateJournal s_sUpdateJournal;
+// Flag indicating s_sUpdateJournal holds a valid update journal
+BOOL s_fUpdateJournalValid = FALSE;
+
+/// Flag indicating the firmware images which passed the integrity and signature checks are remembered in memory
+static BOOL s_fKeepVerifiedImages = FALSE;
+/// Firmware images which passed the integrity and signature checks in this process, the most recently verified first
+static IfxVerifyCacheEntry s_rgsVerifiedImages[VERIFY_CACHE_MAX_ENTRIES];
+/// Number of valid entries in s_rgsVerifiedImages
+static unsigned int s_unVerifiedImages = 0;
+
+/// Magic value identifying a shared image region
+#define SHARED_IMAGE_MAGIC	0x49465349
+/// Offset of the firmware image file content in a shared image region, a multiple of all supported page sizes
+#define SHARED_IMAGE_CONTENT_OFFSET	0x10000
+/// Maximum time to wait for a concurrent process loading and checking the same firmware image file in milliseconds
+#define SHARED_IMAGE_WAIT_TIME	60000
+
+/// Header of a shared image region, a POSIX shared memory object holding a loaded firmware image file which passed the
+/// integrity and signature checks. The loaded (decompressed) file content follows at SHARED_IMAGE_CONTENT_OFFSET.
+typedef struct tdIfxSharedImageHeader
+{
+	/// Magic value (SHARED_IMAGE_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the IfxSharedImageHeader structure, protects against a region written by another build
+	unsigned int			unHeaderSize;
+	/// Size of the firmware image file in bytes
+	unsigned long long		ullFileSize;
+	/// Modification time of the firmware image file in nanoseconds since the epoch
+	unsigned long long		ullModificationTime;
+	/// Size of the loaded file content in bytes
+	unsigned int			unContentSize;
+	/// Offset of the checked firmware image in the loaded file content (non-zero for a firmware image bundle)
+	unsigned int			unImageOffset;
+	/// Size of the checked firmware image in bytes
+	unsigned int			unImageSize;
+	/// SHA-256 digest of the checked firmware image
+	BYTE					rgbImageDigest[SHA256_DIGEST_SIZE];
+	/// Seal: SHA-256 digest of all preceding members and the code signing public key, only written after the checks passed
+	BYTE					rgbSealDigest[SHA256_DIGEST_SIZE];
+} IfxSharedImageHeader;
+
+/// Shared image region created by this process, filled by CommandFlow_TpmUpdate_PublishSharedImage()
+static void* s_pvSharedImage = NULL;
+/// Name of the shared image region of the loaded firmware image file
+static wchar_t s_wszSharedImageName[MAX_NAME] = {0};
+/// Header of the shared image region the loaded firmware image file was taken from, or of the region to be published
+static IfxSharedImageHeader s_sSharedImage;
+
+/// Firmware image file content loaded by CommandFlow_TpmUpdate_PreloadFirmwareImage(), until a forked worker takes it over
+static BYTE* s_rgbPreloadedFile = NULL;
+/// Size of the loaded firmware image file content in bytes
+static unsigned int s_unPreloadedFileSize = 0;
+/// Flag indicating the loaded firmware image file content is mapped from the file
+static BOOL s_fPreloadedFileMapped = FALSE;
+/// Path of the loaded firmware image file
+static wchar_t s_wszPreloadedPath[MAX_PATH] = {0};
+/// Loaded firmware image which passed the integrity and signature checks, NULL once the mark has been used
+static const BYTE* s_pbPreverifiedImage = NULL;
+
+/// Firmware image file of the next update of a chain, loaded and checked on a worker thread during the transfer
+typedef struct tdIfxNextImagePrefetch
+{
+	/// Worker thread, NULL if no prefetch is running
+	void*			pvThread;
+	/// Path of the firmware image file
+	wchar_t			wszPath[MAX_PATH];
+	/// Loaded (decompressed) file content, NULL if the file could not be loaded
+	BYTE*			rgbFile;
+	/// Size of the loaded file content in bytes
+	unsigned int	unFileSize;
+	/// Flag indicating the loaded file content is mapped from the file
+	BOOL			fMapped;
+	/// RC_SUCCESS or the error of loading the file (the worker must not use the error stack)
+	unsigned int	unReturnValue;
+	/// TRUE if the firmware image passed the integrity and signature checks
+	BOOL			fVerified;
+} IfxNextImagePrefetch;
+
+/// Prefetch of the firmware image file of the next update of a chain
+static IfxNextImagePrefetch s_sNextImagePrefetch;
+
+/// Magic value identifying an update duration file
+#define UPDATE_DURATION_MAGIC	0x49465544
+/// Index of the TPM1.2 and the TPM2.0 entry in the update duration file
+#define UPDATE_DURATION_TPM12	0
+#define UPDATE_DURATION_TPM20	1
+/// Weight of a new measurement in percent, the remainder is kept from the previous value
+#define UPDATE_DURATION_WEIGHT_PERCENT	25
+/// Safety margin in percent added to the predicted duration
+#define UPDATE_DURATION_MARGIN_PERCENT	10
+
+/// Durations of the firmware update steps of one TPM family in microseconds
+typedef struct tdIfxUpdateDuration
+{
+	/// Time to prepare the policy session or the TPM Ownership
+	unsigned long long		ullPrepareTime;
+	/// Time of FieldUpgradeStart including the switch to boot loader mode
+	unsigned long long		ullBootLoaderTime;
+	/// Time to send one firmware block of unBlockSize bytes
+	unsigned long long		ullBlockTime;
+	/// Maximum firmware block size reported by the TPM in boot loader mode
+	unsigned int			unBlockSize;
+	/// Time of FieldUpgradeComplete
+	unsigned long long		ullCompleteTime;
+	/// Number of measured updates, zero for the built-in defaults
+	unsigned int			unUpdates;
+} IfxUpdateDuration;
+
+/// Layout of the update duration file
+typedef struct tdIfxUpdateDurations
+{
+	/// Magic value (UPDATE_DURATION_MAGIC)
+	unsigned int			unMagic;
+	/// Size of the IfxUpdateDurations structure, protects against a file written by another build
+	unsigned int			unDurationsSize;
+	/// Durations of TPM1.2 and TPM2.0 updates
+	IfxUpdateDuration		rgsFamilies[2];
+} IfxUpdateDurations;
+
+/// Durations used until an update of the TPM family has been measured. They are deliberately pessimistic: TPM1.2
+/// Ownership takes several seconds, and the boot loader switch is assumed to use the full FieldUpgradeStart timeout.
+static const IfxUpdateDuration s_rgsDefaultDurations[2] = {
+	{ 15000000ULL, 16000000ULL, 60000ULL, 1024, 3000000ULL, 0 },
+	{ 1000000ULL, 16000000ULL, 50000ULL, 1024, 3000000ULL, 0 }
+};
+
+/// Size of a leaf of the firmware block checked on its own while the transfer streams it from the file
+#define FIRMWARE_STREAM_LEAF_SIZE	0x1000
+/// Marks that no leaf has been read from the firmware image file
+#define FIRMWARE_STREAM_LEAF_NONE	((unsigned int)-1)
+
+/// Firmware image file streamed during the transfer
+typedef struct tdIfxFirmwareStream
+{
+	/// Stream handle of the firmware image file
+	void*					pvStream;
+	/// Offset of the firmware block in the firmware image file
+	unsigned int			unFirmwareOffset;
+	/// Size of the firmware block
+	unsigned int			unFirmwareSize;
+	/// Digests of the leaves of the verified firmware block (IfxUpdate::rgbStreamLeafDigests), NULL to skip the leaf checks
+	const BYTE*				rgbLeafDigests;
+	/// Number of digests in rgbLeafDigests
+	unsigned int			unLeafCount;
+	/// Index of the leaf held in rgbLeaf or FIRMWARE_STREAM_LEAF_NONE
+	unsigned int			unLeaf;
+	/// Checked leaf the firmware blocks are served from
+	BYTE					rgbLeaf[FIRMWARE_STREAM_LEAF_SIZE];
+} IfxFirmwareStream;
+
+/**
+ *	@brief		Calculates the digest protecting a firmware image verification cache file or an update plan file.
+ *	@details	The code signing public key is included, so entries verified with another key are not accepted.
+ *
+ *	@param		PrgbContent				Pointer to the file content
+ *	@param		PunContentSize			Size of the file content in front of the digest
+ *	@param		PrgbDigest				Receives the SHA-256 digest
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_CalculateFileDigest(
+	_In_bytecount_(PunContentSize)	const void*		PrgbContent,
+	_In_							unsigned int	PunContentSize,
+	_Out_							BYTE			PrgbDigest[SHA256_DIGEST_SIZE])
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvContext = NULL;
+
+	do
+	{
+		unReturnValue = Crypt_SHA256_Start(&pvContext);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Crypt_SHA256_Update(pvContext, (const BYTE*)PrgbContent, PunContentSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Crypt_SHA256_Update(pvContext, RSA_PUB_MODULUS_KEY_ID_0, sizeof(RSA_PUB_MODULUS_KEY_ID_0));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Crypt_SHA256_Finish(&pvContext, PrgbDigest);
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvContext)
+		IGNORE_RETURN_VALUE(Crypt_SHA256_Finish(&pvContext, NULL));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Loads the firmware image verification cache file.
+ *	@details	The cache file is only accepted if it is private to the effective user (so nobody else can plant entries)
+ *				and its digest matches. In all other cases an empty cache is returned.
+ *
+ *	@param		PpsCache				Receives the cache file content
+ *
+ *	@retval		TRUE	PpsCache holds a valid cache file.
+ *	@retval		FALSE	PpsCache holds an empty cache.
+ */
+_Check_return_
+BOOL
+CommandFlow_TpmUpdate_LoadVerifyCache(
+	_Out_ IfxVerifyCache* PpsCache)
+{
+	BOOL fValid = FALSE;
+	BYTE* prgbCache = NULL;
+
+	do
+	{
+		unsigned long long ullCacheSize = 0;
+		unsigned long long ullModificationTime = 0;
+		unsigned int unCacheSize = 0;
+		BOOL fPrivate = FALSE;
+		BYTE rgbCacheDigest[SHA256_DIGEST_SIZE] = {0};
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(PpsCache, 0, sizeof(IfxVerifyCache)));
+
+		if (RC_SUCCESS != FileIO_GetFileStatus(TPM_FACTORY_UPD_VERIFY_CACHE_FILE, &ullCacheSize, &ullModificationTime, &fPrivate))
+			break;
+		if (FALSE == fPrivate)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the firmware image verification cache file '%ls' because it is not private to the current user.", TPM_FACTORY_UPD_VERIFY_CACHE_FILE);
+			break;
+		}
+
+		if (RC_SUCCESS != FileIO_ReadFileToBuffer(TPM_FACTORY_UPD_VERIFY_CACHE_FILE, &prgbCache, &unCacheSize) ||
+				sizeof(IfxVerifyCache) != unCacheSize)
+			break;
+		if (RC_SUCCESS != Platform_MemoryCopy(PpsCache, sizeof(IfxVerifyCache), prgbCache, unCacheSize))
+			break;
+
+		if (VERIFY_CACHE_MAGIC != PpsCache->unMagic ||
+				sizeof(IfxVerifyCache) != PpsCache->unCacheSize ||
+				VERIFY_CACHE_MAX_ENTRIES < PpsCache->unEntries ||
+				RC_SUCCESS != CommandFlow_TpmUpdate_CalculateFileDigest(PpsCache, offsetof(IfxVerifyCache, rgbCacheDigest), rgbCacheDigest) ||
+				0 != Platform_MemoryCompare(rgbCacheDigest, PpsCache->rgbCacheDigest, SHA256_DIGEST_SIZE))
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the corrupt firmware image verification cache file '%ls'.", TPM_FACTORY_UPD_VERIFY_CACHE_FILE);
+			IGNORE_RETURN_VALUE(Platform_MemorySet(PpsCache, 0, sizeof(IfxVerifyCache)));
+			break;
+		}
+
+		fValid = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbCache);
+
+	return fValid;
+}
+
+/**
+ *	@brief		Stores a firmware image in the verification cache file.
+ *	@details	The image is put in front of the already cached images, the oldest image is dropped if the cache is full.
+ *				Errors are logged only, because a missing cache entry just causes the next run to verify the image again.
+ *
+ *	@param		PpsEntry				Key of the firmware image which passed the integrity and signature checks
+ */
+void
+CommandFlow_TpmUpdate_StoreVerifyCache(
+	_In_ const IfxVerifyCacheEntry* PpsEntry)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		IfxVerifyCache sCache;
+		unsigned int unIndex = 0;
+
+		IGNORE_RETURN_VALUE(CommandFlow_TpmUpdate_LoadVerifyCache(&sCache));
+
+		// Drop an entry of the same image and make room for the new entry
+		for (unIndex = 0; unIndex < sCache.unEntries; unIndex++)
+		{
+			if (0 == Platform_MemoryCompare(&sCache.rgsEntries[unIndex], PpsEntry, sizeof(IfxVerifyCacheEntry)))
+				break;
+		}
+		if (unIndex == sCache.unEntries && VERIFY_CACHE_MAX_ENTRIES > sCache.unEntries)
+			sCache.unEntries++;
+		if (unIndex == VERIFY_CACHE_MAX_ENTRIES)
+			unIndex--;
+		for (; unIndex > 0; unIndex--)
+			sCache.rgsEntries[unIndex] = sCache.rgsEntries[unIndex - 1];
+		sCache.rgsEntries[0] = *PpsEntry;
+
+		sCache.unMagic = VERIFY_CACHE_MAGIC;
+		sCache.unCacheSize = sizeof(IfxVerifyCache);
+		unReturnValue = CommandFlow_TpmUpdate_CalculateFileDigest(&sCache, offsetof(IfxVerifyCache, rgbCacheDigest), sCache.rgbCacheDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_Open(TPM_FACTORY_UPD_VERIFY_CACHE_FILE, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sCache, sizeof(sCache));
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not write the firmware image verification cache file '%ls' (0x%.8X).", TPM_FACTORY_UPD_VERIFY_CACHE_FILE, unReturnValue);
+	}
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
+
+/**
+ *	@brief		Identifies the loaded firmware image.
+ *	@details	The image is identified by size and modification time of the firmware image file and the SHA-256 digest of
+ *				the loaded content. The digest is always calculated, so a modified image is never mistaken for a checked one.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ *	@param		PpsEntry				Receives the key of the loaded firmware image
+ *
+ *	@retval		RC_SUCCESS				PpsEntry holds the key of the loaded firmware image.
+ *	@retval		RC_E_FAIL				The firmware image cannot be identified.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_GetImageKey(
+	_In_	const IfxUpdate*		PpTpmUpdate,
+	_Out_	IfxVerifyCacheEntry*	PpsEntry)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
+		unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+		BOOL fPrivate = FALSE;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(PpsEntry, 0, sizeof(IfxVerifyCacheEntry)));
+
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwareImagePath, &unFirmwareImagePathSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = FileIO_GetFileStatus(wszFirmwareImagePath, &PpsEntry->ullImageSize, &PpsEntry->ullModificationTime, &fPrivate);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (PpsEntry->ullImageSize != PpTpmUpdate->unFirmwareFileSize)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unReturnValue = Crypt_SHA256(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize, PpsEntry->rgbImageDigest);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Looks up the loaded firmware image in the verification cache file.
+ *	@details	The image is identified by CommandFlow_TpmUpdate_GetImageKey().
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ *	@param		PpsEntry				Receives the key of the loaded firmware image
+ *	@param		PpfCached				Receives TRUE if the firmware image passed the integrity and signature checks before
+ *
+ *	@retval		RC_SUCCESS				PpsEntry holds the key of the loaded firmware image.
+ *	@retval		RC_E_FAIL				The firmware image cannot be identified.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_LookupVerifyCache(
+	_In_	const IfxUpdate*		PpTpmUpdate,
+	_Out_	IfxVerifyCacheEntry*	PpsEntry,
+	_Out_	BOOL*					PpfCached)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		IfxVerifyCache sCache;
+		unsigned int unIndex = 0;
+
+		*PpfCached = FALSE;
+
+		unReturnValue = CommandFlow_TpmUpdate_GetImageKey(PpTpmUpdate, PpsEntry);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (FALSE == CommandFlow_TpmUpdate_LoadVerifyCache(&sCache))
+			break;
+		for (unIndex = 0; unIndex < sCache.unEntries; unIndex++)
+		{
+			if (0 == Platform_MemoryCompare(&sCache.rgsEntries[unIndex], PpsEntry, sizeof(IfxVerifyCacheEntry)))
+			{
+				*PpfCached = TRUE;
+				break;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Remembers the firmware images which passed the integrity and signature checks in memory.
+ *	@details	Used by the factory loop: an image checked for one unit is not checked again for the following units as
+ *				long as size, modification time and SHA-256 digest of the image are unchanged.
+ */
+void
+CommandFlow_TpmUpdate_KeepVerifiedImagesInMemory()
+{
+	s_fKeepVerifiedImages = TRUE;
+}
+
+/**
+ *	@brief		Looks up the loaded firmware image in the firmware images verified in this process.
+ *	@details	The image is identified by CommandFlow_TpmUpdate_GetImageKey().
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ *	@param		PpsEntry				Receives the key of the loaded firmware image
+ *	@param		PpfIdentified			Receives TRUE if PpsEntry holds the key of the loaded firmware image
+ *
+ *	@retval		TRUE					The firmware image passed the integrity and signature checks before.
+ *	@retval		FALSE					The firmware image has not been checked before or is not remembered in memory.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_LookupVerifiedImages(
+	_In_	const IfxUpdate*		PpTpmUpdate,
+	_Out_	IfxVerifyCacheEntry*	PpsEntry,
+	_Out_	BOOL*					PpfIdentified)
+{
+	unsigned int unIndex = 0;
+
+	*PpfIdentified = FALSE;
+	if (!s_fKeepVerifiedImages || RC_SUCCESS != CommandFlow_TpmUpdate_GetImageKey(PpTpmUpdate, PpsEntry))
+		return FALSE;
+
+	*PpfIdentified = TRUE;
+	for (unIndex = 0; unIndex < s_unVerifiedImages; unIndex++)
+	{
+		if (0 == Platform_MemoryCompare(&s_rgsVerifiedImages[unIndex], PpsEntry, sizeof(IfxVerifyCacheEntry)))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ *	@brief		Remembers a firmware image which passed the integrity and signature checks in memory.
+ *	@details	The least recently verified image is dropped if all entries are used.
+ *
+ *	@param		PpsEntry				Key of the firmware image
+ */
+static void
+CommandFlow_TpmUpdate_RememberVerifiedImage(
+	_In_ const IfxVerifyCacheEntry* PpsEntry)
+{
+	unsigned int unIndex = s_unVerifiedImages < VERIFY_CACHE_MAX_ENTRIES ? s_unVerifiedImages++ : VERIFY_CACHE_MAX_ENTRIES - 1;
+
+	for (; unIndex > 0; unIndex--)
+		s_rgsVerifiedImages[unIndex] = s_rgsVerifiedImages[unIndex - 1];
+	s_rgsVerifiedImages[0] = *PpsEntry;
+}
+
+/**
+ *	@brief		Gets the name of the shared image region of a firmware image file.
+ *	@details	The region is named by the SHA-256 digest of the firmware image file path, so all processes which update
+ *				with the same file find the same region.
+ *
+ *	@param		PwszFirmwareImagePath	Path of the firmware image file
+ *	@param		PwszName				Receives the name
+ *	@param		PunNameSize				Capacity of PwszName in characters
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_TpmUpdate_GetSharedImageName(
+	_In_z_						const wchar_t*	PwszFirmwareImagePath,
+	_Out_z_cap_(PunNameSize)	wchar_t*		PwszName,
+	_In_						unsigned int	PunNameSize)
+{
+	IfxStringBuilder sName;
+	BYTE rgbPathDigest[SHA256_DIGEST_SIZE] = {0};
+	unsigned int unIndex = 0;
+
+	Platform_StringBuilderInitialize(&sName, PwszName, PunNameSize);
+	sName.unReturnValue = Crypt_SHA256((const BYTE*)PwszFirmwareImagePath, (unsigned int)(wcslen(PwszFirmwareImagePath) * sizeof(wchar_t)), rgbPathDigest);
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sName, L"/TPMFactoryUpd_Image_"));
+	for (unIndex = 0; unIndex < SHA256_DIGEST_SIZE / 2; unIndex++)
+	{
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sName, L"%.2x", rgbPathDigest[unIndex]));
+	}
+
+	return sName.unReturnValue;
+}
+
+/**
+ *	@brief		Maps the loaded firmware image file from the shared image region of a concurrent process.
+ *	@details	Used with -verify-cache. If another process of the effective user is loading and checking the same firmware
+ *				image file, the function waits until that process has sealed its shared image region and maps the region
+ *				read-only instead of loading (and decompressing) the file again. If no usable region exists, a new one is
+ *				created and the caller loads the file. CommandFlow_TpmUpdate_PublishSharedImage() fills and seals it once
+ *				the firmware image passed the checks, CommandFlow_TpmUpdate_CloseSharedImage() removes it otherwise.
+ *				All errors just cause the file to be loaded as usual.
+ *
+ *	@param		PwszFirmwareImagePath	Path of the firmware image file
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure which receives the mapped file content
+ *
+ *	@retval		TRUE	The loaded file content is mapped from a sealed shared image region.
+ *	@retval		FALSE	The firmware image file must be loaded by the caller.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_MapSharedImage(
+	_In_z_	const wchar_t*	PwszFirmwareImagePath,
+	_Inout_	IfxUpdate*		PpTpmUpdate)
+{
+	BOOL fMapped = FALSE;
+	void* pvSharedImage = NULL;
+
+	do
+	{
+		BOOL fVerifyCache = FALSE;
+		BOOL fPrivate = FALSE;
+		IfxSharedImageHeader sHeader;
+		BYTE rgbSealDigest[SHA256_DIGEST_SIZE] = {0};
+		unsigned int unReturnValue = RC_E_FAIL;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sSharedImage, 0, sizeof(s_sSharedImage)));
+		if (FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_VERIFY_CACHE, &fVerifyCache) || FALSE == fVerifyCache)
+			break;
+
+		// Downloaded images are not shared, FileIO_GetFileStatus fails for a URL
+		if (RC_SUCCESS != FileIO_GetFileStatus(PwszFirmwareImagePath, &s_sSharedImage.ullFileSize, &s_sSharedImage.ullModificationTime, &fPrivate) ||
+				RC_SUCCESS != CommandFlow_TpmUpdate_GetSharedImageName(PwszFirmwareImagePath, s_wszSharedImageName, RG_LEN(s_wszSharedImageName)))
+			break;
+
+		unReturnValue = FileIO_OpenSharedMemory(s_wszSharedImageName, FALSE, &pvSharedImage);
+		if (RC_E_FILE_NOT_FOUND == unReturnValue)
+		{
+			// The first process creates the region, a concurrent process which was faster is waited for on the next run
+			if (RC_SUCCESS == FileIO_OpenSharedMemory(s_wszSharedImageName, TRUE, &s_pvSharedImage))
+			{
+				LOGGING_WRITE_LEVEL3_FMT(L"Created the shared image region '%ls'.", s_wszSharedImageName);
+			}
+			break;
+		}
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the shared image region '%ls' (0x%.8X).", s_wszSharedImageName, unReturnValue);
+			break;
+		}
+
+		// Wait for a concurrent process which loads and checks the firmware image
+		unReturnValue = FileIO_WaitSharedMemory(pvSharedImage, SHARED_IMAGE_WAIT_TIME);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"The shared image region '%ls' was not filled by the concurrent process (0x%.8X).", s_wszSharedImageName, unReturnValue);
+			break;
+		}
+
+		// A region left unsealed by a crashed process or holding an older version of the file is replaced
+		if (RC_SUCCESS != FileIO_ReadSharedMemory(pvSharedImage, 0, (BYTE*)&sHeader, sizeof(sHeader)) ||
+				SHARED_IMAGE_MAGIC != sHeader.unMagic ||
+				sizeof(IfxSharedImageHeader) != sHeader.unHeaderSize ||
+				RC_SUCCESS != CommandFlow_TpmUpdate_CalculateFileDigest(&sHeader, offsetof(IfxSharedImageHeader, rgbSealDigest), rgbSealDigest) ||
+				0 != Platform_MemoryCompare(rgbSealDigest, sHeader.rgbSealDigest, SHA256_DIGEST_SIZE) ||
+				0 == sHeader.unContentSize ||
+				sHeader.unImageOffset > sHeader.unContentSize ||
+				sHeader.unImageSize > sHeader.unContentSize - sHeader.unImageOffset ||
+				sHeader.ullFileSize != s_sSharedImage.ullFileSize ||
+				sHeader.ullModificationTime != s_sSharedImage.ullModificationTime)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Replacing the unsealed or outdated shared image region '%ls'.", s_wszSharedImageName);
+			FileIO_CloseSharedMemory(&pvSharedImage);
+			FileIO_RemoveSharedMemory(s_wszSharedImageName);
+			IGNORE_RETURN_VALUE(FileIO_OpenSharedMemory(s_wszSharedImageName, TRUE, &s_pvSharedImage));
+			break;
+		}
+
+		if (RC_SUCCESS != FileIO_MapSharedMemory(pvSharedImage, SHARED_IMAGE_CONTENT_OFFSET, sHeader.unContentSize, &PpTpmUpdate->rgbFirmwareFile))
+			break;
+		PpTpmUpdate->unFirmwareFileSize = sHeader.unContentSize;
+		PpTpmUpdate->fFirmwareImageMapped = TRUE;
+		s_sSharedImage = sHeader;
+		fMapped = TRUE;
+		LOGGING_WRITE_LEVEL3_FMT(L"Firmware image file mapped from the shared image region '%ls'.", s_wszSharedImageName);
+	}
+	WHILE_FALSE_END;
+
+	FileIO_CloseSharedMemory(&pvSharedImage);
+
+	return fMapped;
+}
+
+/**
+ *	@brief		Checks if the firmware image lies within the loaded file content.
+ *	@details	Only a firmware image reassembled from the chunks of a firmware image bundle lies outside of it.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the firmware image
+ *
+ *	@retval		TRUE					The firmware image is a part of the loaded file content.
+ *	@retval		FALSE					The firmware image has been reassembled into memory of its own.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_IsImageInFile(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	return PpTpmUpdate->rgbFirmwareImage >= PpTpmUpdate->rgbFirmwareFile &&
+		   PpTpmUpdate->rgbFirmwareImage + PpTpmUpdate->unFirmwareImageSize <= PpTpmUpdate->rgbFirmwareFile + PpTpmUpdate->unFirmwareFileSize;
+}
+
+/**
+ *	@brief		Checks whether the firmware image passed the checks in the process which sealed the shared image region.
+ *	@details	The SHA-256 digest of the firmware image is always calculated, so a modified region is never mistaken for a
+ *				checked one.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ *
+ *	@retval		TRUE	The firmware image passed the integrity and signature checks in the sealing process.
+ *	@retval		FALSE	The firmware image has not been checked yet.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_IsSharedImageSealed(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	BYTE rgbImageDigest[SHA256_DIGEST_SIZE] = {0};
+
+	if (!PpTpmUpdate->fFirmwareImageShared || !CommandFlow_TpmUpdate_IsImageInFile(PpTpmUpdate) ||
+			(unsigned int)(PpTpmUpdate->rgbFirmwareImage - PpTpmUpdate->rgbFirmwareFile) != s_sSharedImage.unImageOffset ||
+			PpTpmUpdate->unFirmwareImageSize != s_sSharedImage.unImageSize)
+		return FALSE;
+
+	return RC_SUCCESS == Crypt_SHA256(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize, rgbImageDigest) &&
+		   0 == Platform_MemoryCompare(rgbImageDigest, s_sSharedImage.rgbImageDigest, SHA256_DIGEST_SIZE);
+}
+
+/**
+ *	@brief		Fills and seals the shared image region created by CommandFlow_TpmUpdate_MapSharedImage().
+ *	@details	The loaded file content is written first and the sealed header last, so a process never maps a partly
+ *				written region. Closing the region lets the waiting processes map it. Errors are logged only, because
+ *				the other processes then just load and check the firmware image themselves.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the firmware image which passed the checks
+ */
+static void
+CommandFlow_TpmUpdate_PublishSharedImage(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		s_sSharedImage.unMagic = SHARED_IMAGE_MAGIC;
+		s_sSharedImage.unHeaderSize = sizeof(IfxSharedImageHeader);
+		s_sSharedImage.unContentSize = PpTpmUpdate->unFirmwareFileSize;
+		// A firmware image reassembled from bundle chunks is not a part of the shared content, the other processes
+		// reassemble and check it themselves
+		if (CommandFlow_TpmUpdate_IsImageInFile(PpTpmUpdate))
+		{
+			s_sSharedImage.unImageOffset = (unsigned int)(PpTpmUpdate->rgbFirmwareImage - PpTpmUpdate->rgbFirmwareFile);
+			s_sSharedImage.unImageSize = PpTpmUpdate->unFirmwareImageSize;
+			unReturnValue = Crypt_SHA256(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize, s_sSharedImage.rgbImageDigest);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+		else
+		{
+			s_sSharedImage.unImageOffset = 0;
+			s_sSharedImage.unImageSize = 0;
+			IGNORE_RETURN_VALUE(Platform_MemorySet(s_sSharedImage.rgbImageDigest, 0, sizeof(s_sSharedImage.rgbImageDigest)));
+		}
+		unReturnValue = CommandFlow_TpmUpdate_CalculateFileDigest(&s_sSharedImage, offsetof(IfxSharedImageHeader, rgbSealDigest), s_sSharedImage.rgbSealDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = FileIO_WriteSharedMemory(s_pvSharedImage, SHARED_IMAGE_CONTENT_OFFSET, PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteSharedMemory(s_pvSharedImage, 0, (const BYTE*)&s_sSharedImage, sizeof(s_sSharedImage));
+	}
+	WHILE_FALSE_END;
+
+	if (RC_SUCCESS == unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL3_FMT(L"Sealed the shared image region '%ls'.", s_wszSharedImageName);
+		FileIO_CloseSharedMemory(&s_pvSharedImage);
+	}
+	else
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not fill the shared image region '%ls' (0x%.8X).", s_wszSharedImageName, unReturnValue);
+	}
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
+
+/**
+ *	@brief		Removes the shared image region created by this process if it has not been sealed.
+ *	@details	Called once the firmware image has been checked, so processes waiting for the region load the firmware
+ *				image themselves instead of waiting until this process exits.
+ */
+static void
+CommandFlow_TpmUpdate_CloseSharedImage()
+{
+	if (NULL == s_pvSharedImage)
+		return;
+
+	FileIO_RemoveSharedMemory(s_wszSharedImageName);
+	FileIO_CloseSharedMemory(&s_pvSharedImage);
+}
+
+/**
+ *	@brief		Loads the firmware image file once for the forked workers of several TPM devices.
+ *	@details	The workers take the loaded (decompressed) file content over copy-on-write instead of loading it again. A
+ *				single firmware image also passes the integrity and signature checks here, so the workers only run the TPM
+ *				dependent checks. The image of a bundle depends on the TPM firmware version and is checked by the worker.
+ *				Nothing is loaded for a downloaded image, and a file which cannot be loaded or checked is left to the
+ *				workers, which report the error for their TPM device.
+ */
+void
+CommandFlow_TpmUpdate_PreloadFirmwareImage()
+{
+	do
+	{
+		wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
+		unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+		unsigned int unPreloadedPathSize = RG_LEN(s_wszPreloadedPath);
+		unsigned long long ullFileSize = 0;
+		unsigned long long ullModificationTime = 0;
+		BOOL fPrivate = FALSE;
+		BOOL fDecompressed = FALSE;
+		BOOL fVerified = FALSE;
+		IfxFirmwareImage sFirmwareImage;
+		BYTE* pbStream = NULL;
+		INT32 nStreamSize = 0;
+		unsigned int unReturnValue = RC_E_FAIL;
+
+		if (NULL != s_rgbPreloadedFile ||
+				FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwareImagePath, &unFirmwareImagePathSize))
+			break;
+
+		// Downloaded images are loaded by each worker, FileIO_GetFileStatus fails for a URL
+		if (RC_SUCCESS != FileIO_GetFileStatus(wszFirmwareImagePath, &ullFileSize, &ullModificationTime, &fPrivate))
+			break;
+
+		unReturnValue = FileIO_MapFileToBuffer(wszFirmwareImagePath, &s_rgbPreloadedFile, &s_unPreloadedFileSize, &s_fPreloadedFileMapped);
+		if (RC_SUCCESS == unReturnValue)
+			unReturnValue = FileIO_DecompressFileBuffer(&s_rgbPreloadedFile, &s_unPreloadedFileSize, &s_fPreloadedFileMapped, &fDecompressed);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"The firmware image file '%ls' is loaded by each worker (0x%.8X).", wszFirmwareImagePath, unReturnValue);
+			FileIO_ReleaseFileBuffer(&s_rgbPreloadedFile, s_unPreloadedFileSize, s_fPreloadedFileMapped);
+			Error_ClearStack();
+			break;
+		}
+		IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszPreloadedPath, &unPreloadedPathSize, wszFirmwareImagePath));
+		LOGGING_WRITE_LEVEL2_FMT(L"Firmware image file '%ls' loaded for the workers.", wszFirmwareImagePath);
+
+		if (FirmwareImage_IsBundle(s_rgbPreloadedFile, s_unPreloadedFileSize))
+			break;
+
+		pbStream = s_rgbPreloadedFile;
+		nStreamSize = (INT32)s_unPreloadedFileSize;
+		if (RC_SUCCESS != FirmwareImage_Unmarshal(&sFirmwareImage, &pbStream, &nStreamSize) ||
+				RC_SUCCESS != FirmwareUpdate_CheckImageIntegrity(s_rgbPreloadedFile, s_unPreloadedFileSize, &sFirmwareImage, &fVerified) ||
+				FALSE == fVerified)
+		{
+			LOGGING_WRITE_LEVEL2(L"The firmware image is checked by each worker.");
+			Error_ClearStack();
+			break;
+		}
+		s_pbPreverifiedImage = s_rgbPreloadedFile;
+		LOGGING_WRITE_LEVEL2(L"Firmware image passed the integrity and signature checks for all workers.");
+	}
+	WHILE_FALSE_END;
+}
+
+/**
+ *	@brief		Releases the firmware image file loaded by CommandFlow_TpmUpdate_PreloadFirmwareImage().
+ *	@details	Called by the parent process once all workers have been forked. Does nothing in a worker which took the
+ *				loaded file content over.
+ */
+void
+CommandFlow_TpmUpdate_ReleasePreloadedImage()
+{
+	s_pbPreverifiedImage = NULL;
+	FileIO_ReleaseFileBuffer(&s_rgbPreloadedFile, s_unPreloadedFileSize, s_fPreloadedFileMapped);
+}
+
+/**
+ *	@brief		Takes the firmware image file loaded by the parent process over.
+ *	@details	Called by a forked worker instead of loading the file. The loaded file content is released with the
+ *				IfxUpdate structure.
+ *
+ *	@param		PwszFirmwareImagePath	Path of the firmware image file
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure which receives the loaded file content
+ *
+ *	@retval		TRUE	PpTpmUpdate holds the loaded file content.
+ *	@retval		FALSE	The firmware image file must be loaded by the caller.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_TakePreloadedImage(
+	_In_z_	const wchar_t*	PwszFirmwareImagePath,
+	_Inout_	IfxUpdate*		PpTpmUpdate)
+{
+	if (NULL == s_rgbPreloadedFile || 0 != Platform_StringCompare(PwszFirmwareImagePath, s_wszPreloadedPath, RG_LEN(s_wszPreloadedPath), FALSE))
+		return FALSE;
+
+	PpTpmUpdate->rgbFirmwareFile = s_rgbPreloadedFile;
+	PpTpmUpdate->unFirmwareFileSize = s_unPreloadedFileSize;
+	PpTpmUpdate->fFirmwareImageMapped = s_fPreloadedFileMapped;
+	s_rgbPreloadedFile = NULL;
+	LOGGING_WRITE_LEVEL3(L"Preloaded firmware image file taken over.");
+
+	return TRUE;
+}
+
+/**
+ *	@brief		Checks whether the firmware image passed the checks in the parent process of a forked worker.
+ *	@details	The mark is used once, a later update of the process checks the image again.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ *
+ *	@retval		TRUE	The firmware image passed the integrity and signature checks in the parent process.
+ *	@retval		FALSE	The firmware image has not been checked yet.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_IsImagePreverified(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	BOOL fPreverified = (NULL != s_pbPreverifiedImage && PpTpmUpdate->rgbFirmwareImage == s_pbPreverifiedImage && PpTpmUpdate->unFirmwareImageSize == s_unPreloadedFileSize);
+
+	s_pbPreverifiedImage = NULL;
+
+	return fPreverified;
+}
+
+/**
+ *	@brief		Thread function loading and checking the firmware image file of the next update of a chain
+ *	@details	Runs like CommandFlow_TpmUpdate_PreloadFirmwareImage() but on a worker thread, so neither the error stack nor
+ *				the log is used. The result is collected by CommandFlow_TpmUpdate_FinishNextImagePrefetch().
+ *
+ *	@param		PpvContext				Pointer to s_sNextImagePrefetch
+ */
+static void
+CommandFlow_TpmUpdate_NextImagePrefetchThread(
+	_Inout_ void* PpvContext)
+{
+	IfxNextImagePrefetch* psPrefetch = (IfxNextImagePrefetch*)PpvContext;
+	BOOL fDecompressed = FALSE;
+	IfxFirmwareImage sFirmwareImage;
+	BYTE* pbStream = NULL;
+	INT32 nStreamSize = 0;
+
+	psPrefetch->unReturnValue = FileIO_MapFileToBuffer(psPrefetch->wszPath, &psPrefetch->rgbFile, &psPrefetch->unFileSize, &psPrefetch->fMapped);
+	if (RC_SUCCESS == psPrefetch->unReturnValue)
+		psPrefetch->unReturnValue = FileIO_DecompressFileBuffer(&psPrefetch->rgbFile, &psPrefetch->unFileSize, &psPrefetch->fMapped, &fDecompressed);
+	if (RC_SUCCESS != psPrefetch->unReturnValue)
+	{
+		FileIO_ReleaseFileBuffer(&psPrefetch->rgbFile, psPrefetch->unFileSize, psPrefetch->fMapped);
+		return;
+	}
+
+	// The image of a bundle is selected and checked when the update loads it
+	if (FirmwareImage_IsBundle(psPrefetch->rgbFile, psPrefetch->unFileSize))
+		return;
+
+	pbStream = psPrefetch->rgbFile;
+	nStreamSize = (INT32)psPrefetch->unFileSize;
+	if (RC_SUCCESS == FirmwareImage_Unmarshal(&sFirmwareImage, &pbStream, &nStreamSize) &&
+			RC_SUCCESS != FirmwareUpdate_CheckImageIntegrity(psPrefetch->rgbFile, psPrefetch->unFileSize, &sFirmwareImage, &psPrefetch->fVerified))
+		psPrefetch->fVerified = FALSE;
+}
+
+/**
+ *	@brief		Starts loading and checking the firmware image file of the next update of a chain.
+ *	@details	Called right before the firmware block of the current update is transferred, so the next firmware image
+ *				is loaded, decompressed and verified while the TPM receives the blocks. Nothing is done for the last
+ *				update of a chain or if the thread cannot be started; the next update then loads the file itself.
+ */
+static void
+CommandFlow_TpmUpdate_StartNextImagePrefetch()
+{
+	unsigned int unPathSize = RG_LEN(s_sNextImagePrefetch.wszPath);
+
+	if (L'\0' == s_wszUpdateChainNextImage[0] || NULL != s_sNextImagePrefetch.pvThread || NULL != s_sNextImagePrefetch.rgbFile)
+		return;
+
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sNextImagePrefetch, 0, sizeof(s_sNextImagePrefetch)));
+	if (RC_SUCCESS != Platform_StringCopy(s_sNextImagePrefetch.wszPath, &unPathSize, s_wszUpdateChainNextImage))
+		return;
+	if (RC_SUCCESS != Platform_ThreadCreate(CommandFlow_TpmUpdate_NextImagePrefetchThread, &s_sNextImagePrefetch, &s_sNextImagePrefetch.pvThread))
+	{
+		s_sNextImagePrefetch.pvThread = NULL;
+		return;
+	}
+	LOGGING_WRITE_LEVEL2_FMT(L"Loading the next firmware image of the chain '%ls' during the transfer.", s_sNextImagePrefetch.wszPath);
+}
+
+/**
+ *	@brief		Hands the firmware image file loaded by CommandFlow_TpmUpdate_StartNextImagePrefetch() over to the update.
+ *	@details	Waits for the worker thread. The loaded file content is taken over like a file loaded by
+ *				CommandFlow_TpmUpdate_PreloadFirmwareImage(), including the mark of a firmware image which passed the
+ *				integrity and signature checks. A file which could not be loaded is left to the update, which reports the
+ *				error.
+ */
+static void
+CommandFlow_TpmUpdate_FinishNextImagePrefetch()
+{
+	unsigned int unPreloadedPathSize = RG_LEN(s_wszPreloadedPath);
+
+	if (NULL != s_sNextImagePrefetch.pvThread)
+		IGNORE_RETURN_VALUE(Platform_ThreadJoin(&s_sNextImagePrefetch.pvThread));
+	if (NULL == s_sNextImagePrefetch.rgbFile)
+	{
+		if (L'\0' != s_sNextImagePrefetch.wszPath[0])
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"The next firmware image of the chain could not be loaded in advance (0x%.8X).", s_sNextImagePrefetch.unReturnValue);
+		}
+		s_sNextImagePrefetch.wszPath[0] = L'\0';
+		return;
+	}
+
+	CommandFlow_TpmUpdate_ReleasePreloadedImage();
+	s_rgbPreloadedFile = s_sNextImagePrefetch.rgbFile;
+	s_unPreloadedFileSize = s_sNextImagePrefetch.unFileSize;
+	s_fPreloadedFileMapped = s_sNextImagePrefetch.fMapped;
+	IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszPreloadedPath, &unPreloadedPathSize, s_sNextImagePrefetch.wszPath));
+	if (s_sNextImagePrefetch.fVerified)
+		s_pbPreverifiedImage = s_rgbPreloadedFile;
+	LOGGING_WRITE_LEVEL2_FMT(L"Next firmware image of the chain '%ls' loaded during the transfer%ls.",
+							 s_sNextImagePrefetch.wszPath, s_sNextImagePrefetch.fVerified ? L", integrity and signature checks passed" : L"");
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sNextImagePrefetch, 0, sizeof(s_sNextImagePrefetch)));
+}
+
+/**
+ *	@brief		Releases the firmware image file of the next update of a chain if the chain ends early.
+ *	@details	Waits for a running worker thread and releases the loaded file content.
+ */
+void
+CommandFlow_TpmUpdate_ReleaseNextImagePrefetch()
+{
+	if (NULL != s_sNextImagePrefetch.pvThread)
+		IGNORE_RETURN_VALUE(Platform_ThreadJoin(&s_sNextImagePrefetch.pvThread));
+	FileIO_ReleaseFileBuffer(&s_sNextImagePrefetch.rgbFile, s_sNextImagePrefetch.unFileSize, s_sNextImagePrefetch.fMapped);
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sNextImagePrefetch, 0, sizeof(s_sNextImagePrefetch)));
+}
+
+/**
+ *	@brief		Gets the path of a file in the image cache folder.
+ *	@details	Firmware images are named by the hexadecimal SHA-256 digest of their content.
+ *
+ *	@param		PrgbContentDigest		SHA-256 digest of the file content or NULL for the index file
+ *	@param		PwszExtension			File name extension appended to the digest
+ *	@param		PwszPath				Receives the path
+ *	@param		PunPathSize				Capacity of PwszPath in characters
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_GetImageCachePath(
+	_In_opt_bytecount_(SHA256_DIGEST_SIZE)	const BYTE		PrgbContentDigest[SHA256_DIGEST_SIZE],
+	_In_z_									const wchar_t*	PwszExtension,
+	_Out_z_cap_(PunPathSize)				wchar_t*		PwszPath,
+	_In_									unsigned int	PunPathSize)
+{
+	IfxStringBuilder sPath;
+	unsigned int unIndex = 0;
+
+	Platform_StringBuilderInitialize(&sPath, PwszPath, PunPathSize);
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sPath, TPM_FACTORY_UPD_IMAGE_CACHE_FOLDER L"/"));
+	if (NULL == PrgbContentDigest)
+	{
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sPath, IMAGE_CACHE_INDEX_FILE_NAME));
+	}
+	else
+	{
+		for (unIndex = 0; unIndex < SHA256_DIGEST_SIZE; unIndex++)
+		{
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sPath, L"%.2x", PrgbContentDigest[unIndex]));
+		}
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sPath, PwszExtension));
+	}
+
+	return sPath.unReturnValue;
+}
+
+/**
+ *	@brief		Loads the image cache index file.
+ *	@details	The index file is only accepted if it is private to the effective user and its digest matches. In all other
+ *				cases an empty index is returned.
+ *
+ *	@param		PpsCache				Receives the index file content
+ *
+ *	@retval		TRUE	PpsCache holds a valid index file.
+ *	@retval		FALSE	PpsCache holds an empty index.
+ */
+_Check_return_
+BOOL
+CommandFlow_TpmUpdate_LoadImageCache(
+	_Out_ IfxImageCache* PpsCache)
+{
+	BOOL fValid = FALSE;
+	BYTE* prgbCache = NULL;
+
+	do
+	{
+		wchar_t wszIndexFile[MAX_PATH] = {0};
+		unsigned long long ullCacheSize = 0;
+		unsigned long long ullModificationTime = 0;
+		unsigned int unCacheSize = 0;
+		BOOL fPrivate = FALSE;
+		BYTE rgbCacheDigest[SHA256_DIGEST_SIZE] = {0};
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(PpsCache, 0, sizeof(IfxImageCache)));
+
+		if (RC_SUCCESS != CommandFlow_TpmUpdate_GetImageCachePath(NULL, L"", wszIndexFile, RG_LEN(wszIndexFile)) ||
+				RC_SUCCESS != FileIO_GetFileStatus(wszIndexFile, &ullCacheSize, &ullModificationTime, &fPrivate))
+			break;
+		if (FALSE == fPrivate)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the image cache index file '%ls' because it is not private to the current user.", wszIndexFile);
+			break;
+		}
+
+		if (RC_SUCCESS != FileIO_ReadFileToBuffer(wszIndexFile, &prgbCache, &unCacheSize) ||
+				sizeof(IfxImageCache) != unCacheSize)
+			break;
+		if (RC_SUCCESS != Platform_MemoryCopy(PpsCache, sizeof(IfxImageCache), prgbCache, unCacheSize))
+			break;
+
+		if (IMAGE_CACHE_MAGIC != PpsCache->unMagic ||
+				sizeof(IfxImageCache) != PpsCache->unCacheSize ||
+				IMAGE_CACHE_MAX_ENTRIES < PpsCache->unEntries ||
+				RC_SUCCESS != CommandFlow_TpmUpdate_CalculateFileDigest(PpsCache, offsetof(IfxImageCache, rgbCacheDigest), rgbCacheDigest) ||
+				0 != Platform_MemoryCompare(rgbCacheDigest, PpsCache->rgbCacheDigest, SHA256_DIGEST_SIZE))
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the corrupt image cache index file '%ls'.", wszIndexFile);
+			IGNORE_RETURN_VALUE(Platform_MemorySet(PpsCache, 0, sizeof(IfxImageCache)));
+			break;
+		}
+
+		fValid = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbCache);
+
+	return fValid;
+}
+
+/**
+ *	@brief		Writes the image cache index file.
+ *	@details
+ *
+ *	@param		PpsCache				Index to write, magic, size and digest are set by the function
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_WriteImageCache(
+	_Inout_ IfxImageCache* PpsCache)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+
+	do
+	{
+		wchar_t wszIndexFile[MAX_PATH] = {0};
+
+		PpsCache->unMagic = IMAGE_CACHE_MAGIC;
+		PpsCache->unCacheSize = sizeof(IfxImageCache);
+		unReturnValue = CommandFlow_TpmUpdate_CalculateFileDigest(PpsCache, offsetof(IfxImageCache, rgbCacheDigest), PpsCache->rgbCacheDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = CommandFlow_TpmUpdate_GetImageCachePath(NULL, L"", wszIndexFile, RG_LEN(wszIndexFile));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Open(wszIndexFile, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)PpsCache, sizeof(IfxImageCache));
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Replaces a firmware image URL with the file of the image cache folder downloaded from it before.
+ *	@details	Only used with the -verify-cache command line option. A URL is expected to always serve the same content,
+ *				so a cached image is used without contacting the server. The cached file must be unchanged since it was
+ *				stored, its verification cache entry then skips the integrity and signature checks. The entry becomes the
+ *				most recently used one. A URL which is not cached is remembered for CommandFlow_TpmUpdate_StoreImageCache().
+ */
+void
+CommandFlow_TpmUpdate_ResolveImageCache()
+{
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	s_wszImageCacheUrl[0] = L'\0';
+
+	do
+	{
+		wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
+		unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+		wchar_t wszCachedFile[MAX_PATH] = {0};
+		unsigned int unUrlSize = RG_LEN(s_wszImageCacheUrl);
+		unsigned long long ullSize = 0;
+		unsigned long long ullModificationTime = 0;
+		BOOL fVerifyCache = FALSE;
+		BOOL fPrivate = FALSE;
+		IfxImageCache sCache;
+		IfxImageCacheEntry sEntry;
+		unsigned int unIndex = 0;
+
+		if (FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_VERIFY_CACHE, &fVerifyCache) || FALSE == fVerifyCache)
+			break;
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwareImagePath, &unFirmwareImagePathSize) ||
+				!FileIO_IsUrl(wszFirmwareImagePath))
+			break;
+
+		if (FALSE == CommandFlow_TpmUpdate_LoadImageCache(&sCache))
+			unIndex = sCache.unEntries;
+		for (; unIndex < sCache.unEntries; unIndex++)
+		{
+			if (0 == Platform_StringCompare(sCache.rgsEntries[unIndex].wszUrl, wszFirmwareImagePath, RG_LEN(wszFirmwareImagePath), FALSE))
+				break;
+		}
+
+		// Use the cached file if it is still the stored one, otherwise download the image again
+		if (unIndex < sCache.unEntries &&
+				RC_SUCCESS == CommandFlow_TpmUpdate_GetImageCachePath(sCache.rgsEntries[unIndex].rgbContentDigest, L".bin", wszCachedFile, RG_LEN(wszCachedFile)) &&
+				RC_SUCCESS == FileIO_GetFileStatus(wszCachedFile, &ullSize, &ullModificationTime, &fPrivate) &&
+				TRUE == fPrivate &&
+				ullSize == sCache.rgsEntries[unIndex].sImage.ullImageSize &&
+				ullModificationTime == sCache.rgsEntries[unIndex].sImage.ullModificationTime &&
+				PropertyStorage_ChangeValueByKey(PROPERTY_FIRMWARE_PATH, wszCachedFile))
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Using the image cache file '%ls' for '%ls'.", wszCachedFile, wszFirmwareImagePath);
+
+			// Make the entry the most recently used one
+			sEntry = sCache.rgsEntries[unIndex];
+			for (; unIndex > 0; unIndex--)
+				sCache.rgsEntries[unIndex] = sCache.rgsEntries[unIndex - 1];
+			sCache.rgsEntries[0] = sEntry;
+			IGNORE_RETURN_VALUE(CommandFlow_TpmUpdate_WriteImageCache(&sCache));
+			break;
+		}
+
+		if (RC_SUCCESS != Platform_StringCopy(s_wszImageCacheUrl, &unUrlSize, wszFirmwareImagePath))
+			s_wszImageCacheUrl[0] = L'\0';
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
+
+/**
+ *	@brief		Stores a downloaded firmware image which passed the integrity and signature checks in the image cache folder.
+ *	@details	The loaded content is stored under its SHA-256 digest and becomes the most recently used entry, the key of the
+ *				stored file goes to the verification cache file. Least recently used entries are dropped while the cache
+ *				holds more than IMAGE_CACHE_MAX_ENTRIES images or more than IMAGE_CACHE_MAX_SIZE bytes, their files are
+ *				removed unless another URL still refers to them. Errors are logged only, because a missing entry just
+ *				causes the image to be downloaded again.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ */
+void
+CommandFlow_TpmUpdate_StoreImageCache(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+	wchar_t wszTemporaryFile[MAX_PATH] = {0};
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszCachedFile[MAX_PATH] = {0};
+		unsigned int unUrlSize = 0;
+		unsigned long long ullTotalSize = 0;
+		BOOL fPrivate = FALSE;
+		IfxImageCache sCache;
+		IfxImageCache sNewCache;
+		BYTE rgbDropped[IMAGE_CACHE_MAX_ENTRIES][SHA256_DIGEST_SIZE];
+		unsigned int unDropped = 0;
+		unsigned int unIndex = 0;
+		unsigned int unKept = 0;
+		IfxImageCacheEntry* psEntry = &sNewCache.rgsEntries[0];
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sNewCache, 0, sizeof(sNewCache)));
+		unUrlSize = RG_LEN(psEntry->wszUrl);
+		unReturnValue = Platform_StringCopy(psEntry->wszUrl, &unUrlSize, s_wszImageCacheUrl);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Write the content under its digest, the rename makes the complete file appear at once
+		unReturnValue = Crypt_SHA256(PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize, psEntry->rgbContentDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_CreateDirectory(TPM_FACTORY_UPD_IMAGE_CACHE_FOLDER);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = CommandFlow_TpmUpdate_GetImageCachePath(psEntry->rgbContentDigest, L".bin", wszCachedFile, RG_LEN(wszCachedFile));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = CommandFlow_TpmUpdate_GetImageCachePath(psEntry->rgbContentDigest, L".tmp", wszTemporaryFile, RG_LEN(wszTemporaryFile));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Open(wszTemporaryFile, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Close(&pvFile);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Rename(wszTemporaryFile, wszCachedFile);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		wszTemporaryFile[0] = L'\0';
+
+		// The verdict is kept in the verification cache file under the key of the stored file
+		unReturnValue = FileIO_GetFileStatus(wszCachedFile, &psEntry->sImage.ullImageSize, &psEntry->sImage.ullModificationTime, &fPrivate);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Crypt_SHA256(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize, psEntry->sImage.rgbImageDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		CommandFlow_TpmUpdate_StoreVerifyCache(&psEntry->sImage);
+
+		// Keep the older entries in least recently used order as long as they fit, the new image always stays
+		IGNORE_RETURN_VALUE(CommandFlow_TpmUpdate_LoadImageCache(&sCache));
+		sNewCache.unEntries = 1;
+		ullTotalSize = psEntry->sImage.ullImageSize;
+		for (unIndex = 0; unIndex < sCache.unEntries; unIndex++)
+		{
+			const IfxImageCacheEntry* psOldEntry = &sCache.rgsEntries[unIndex];
+			if (0 != Platform_StringCompare(psOldEntry->wszUrl, psEntry->wszUrl, RG_LEN(psEntry->wszUrl), FALSE) &&
+					IMAGE_CACHE_MAX_ENTRIES > sNewCache.unEntries &&
+					IMAGE_CACHE_MAX_SIZE >= ullTotalSize + psOldEntry->sImage.ullImageSize)
+			{
+				sNewCache.rgsEntries[sNewCache.unEntries++] = *psOldEntry;
+				ullTotalSize += psOldEntry->sImage.ullImageSize;
+			}
+			else
+				IGNORE_RETURN_VALUE(Platform_MemoryCopy(rgbDropped[unDropped++], SHA256_DIGEST_SIZE, psOldEntry->rgbContentDigest, SHA256_DIGEST_SIZE));
+		}
+
+		unReturnValue = CommandFlow_TpmUpdate_WriteImageCache(&sNewCache);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Remove the files no remaining entry refers to
+		for (unIndex = 0; unIndex < unDropped; unIndex++)
+		{
+			for (unKept = 0; unKept < sNewCache.unEntries; unKept++)
+			{
+				if (0 == Platform_MemoryCompare(rgbDropped[unIndex], sNewCache.rgsEntries[unKept].rgbContentDigest, SHA256_DIGEST_SIZE))
+					break;
+			}
+			if (unKept == sNewCache.unEntries &&
+					RC_SUCCESS == CommandFlow_TpmUpdate_GetImageCachePath(rgbDropped[unIndex], L".bin", wszCachedFile, RG_LEN(wszCachedFile)))
+			{
+				LOGGING_WRITE_LEVEL2_FMT(L"Removing the image cache file '%ls'.", wszCachedFile);
+				IGNORE_RETURN_VALUE(FileIO_Remove(wszCachedFile));
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+	if (L'\0' != wszTemporaryFile[0])
+		IGNORE_RETURN_VALUE(FileIO_Remove(wszTemporaryFile));
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not store '%ls' in the image cache folder '%ls' (0x%.8X).", s_wszImageCacheUrl, TPM_FACTORY_UPD_IMAGE_CACHE_FOLDER, unReturnValue);
+	}
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
+
+/**
+ *	@brief		Gets the path of a state file of the TPM device.
+ *	@details	The file name is the given prefix followed by the device path with the path separators replaced, so the
+ *				update plans, update journals and learned timeouts of several TPM devices do not overwrite each other.
+ *
+ *	@param		PwszPrefix				File name prefix (e.g. TPM_FACTORY_UPD_PLAN_FILE_PREFIX)
+ *	@param		PwszFile				Receives the path of the state file
+ *	@param		PpunFileSize			In: Capacity of PwszFile in characters, Out: Length of the path
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_GetDeviceFile(
+	_In_z_							const wchar_t*	PwszPrefix,
+	_Out_z_cap_(*PpunFileSize)		wchar_t*		PwszFile,
+	_Inout_							unsigned int*	PpunFileSize)
+{
+	wchar_t wszDevicePath[MAX_PATH] = {0};
+	unsigned int unDevicePathSize = RG_LEN(wszDevicePath);
+	unsigned int unIndex = 0;
+
+	if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize))
+	{
+		unDevicePathSize = RG_LEN(wszDevicePath);
+		IGNORE_RETURN_VALUE(Platform_StringCopy(wszDevicePath, &unDevicePathSize, TPM_DEVICE_ACCESS_PATH));
+	}
+	for (unIndex = 0; L'\0' != wszDevicePath[unIndex]; unIndex++)
+	{
+		if (L'/' == wszDevicePath[unIndex])
+			wszDevicePath[unIndex] = L'_';
+	}
+
+	return Platform_StringFormat(PwszFile, PpunFileSize, L"%ls%ls.bin", PwszPrefix, wszDevicePath);
+}
+
+/**
+ *	@brief		Fills an update plan with the TPM state and the update options.
+ *	@details	The plan is cleared first, so unused characters and padding bytes are zero and plans can be compared bytewise.
+ *				The key of the firmware image and the digest are not set.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the TPM state
+ *	@param		PpsPlan					Receives the update plan
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_FAIL				An update option cannot be read.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_FillUpdatePlan(
+	_In_	const IfxUpdate*	PpTpmUpdate,
+	_Out_	IfxUpdatePlan*		PpsPlan)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unSize = 0;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(PpsPlan, 0, sizeof(IfxUpdatePlan)));
+		PpsPlan->unMagic = UPDATE_PLAN_MAGIC;
+		PpsPlan->unPlanSize = sizeof(IfxUpdatePlan);
+
+		unSize = RG_LEN(PpsPlan->wszFirmwarePath);
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, PpsPlan->wszFirmwarePath, &unSize) ||
+				FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_UPDATE_TYPE, &PpsPlan->unUpdateType))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Failed to get the firmware path or the update type for the update plan.");
+			break;
+		}
+
+		unSize = RG_LEN(PpsPlan->wszVersionName);
+		unReturnValue = Platform_StringCopy(PpsPlan->wszVersionName, &unSize, PpTpmUpdate->wszVersionName);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		PpsPlan->fTpm12 = PpTpmUpdate->sTpmState.attribs.tpm12 ? TRUE : FALSE;
+		PpsPlan->fTpm20 = PpTpmUpdate->sTpmState.attribs.tpm20 ? TRUE : FALSE;
+		PpsPlan->fBootLoader = PpTpmUpdate->sTpmState.attribs.bootLoader ? TRUE : FALSE;
+		PpsPlan->unRemainingUpdates = PpTpmUpdate->unRemainingUpdates;
+
+		unSize = RG_LEN(PpsPlan->wszBundleSourceVersion);
+		unReturnValue = Platform_StringCopy(PpsPlan->wszBundleSourceVersion, &unSize, s_wszBundleSourceVersion);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unSize = RG_LEN(PpsPlan->wszBundleTargetVersion);
+		unReturnValue = Platform_StringCopy(PpsPlan->wszBundleTargetVersion, &unSize, s_wszBundleTargetVersion);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Records the checked and prepared update in the update plan file.
+ *	@details	Called for the -prepare command line option instead of the firmware update. The TPM2.0 policy session is
+ *				closed, the -commit run starts a new one.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure which passed the checks and the preparation
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_StoreUpdatePlan(
+	_Inout_ IfxUpdate* PpTpmUpdate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		IfxUpdatePlan sPlan;
+		wchar_t wszPlanFile[MAX_PATH] = {0};
+		unsigned int unPlanFileSize = RG_LEN(wszPlanFile);
+
+		// Check parameters
+		if (NULL == PpTpmUpdate ||
+				STRUCT_TYPE_TpmUpdate != PpTpmUpdate->unType ||
+				PpTpmUpdate->unSize != sizeof(IfxUpdate) ||
+				STRUCT_SUBTYPE_PREPARE != PpTpmUpdate->unSubType)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter detected. TpmUpdate structure is not in the correct state.");
+			break;
+		}
+
+		unReturnValue = CommandFlow_TpmUpdate_FillUpdatePlan(PpTpmUpdate, &sPlan);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = CommandFlow_TpmUpdate_GetImageKey(PpTpmUpdate, &sPlan.sImage);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The firmware image cannot be identified for the update plan. (0x%.8X)", unReturnValue);
+			break;
+		}
+		unReturnValue = CommandFlow_TpmUpdate_CalculateFileDigest(&sPlan, offsetof(IfxUpdatePlan, rgbPlanDigest), sPlan.rgbPlanDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_PLAN_FILE_PREFIX, wszPlanFile, &unPlanFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Open(wszPlanFile, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Could not create the update plan file '%ls'. (0x%.8X)", wszPlanFile, unReturnValue);
+			break;
+		}
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sPlan, sizeof(sPlan));
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Could not write the update plan file '%ls'. (0x%.8X)", wszPlanFile, unReturnValue);
+			break;
+		}
+		LOGGING_WRITE_LEVEL2_FMT(L"Update plan recorded in '%ls'.", wszPlanFile);
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+
+#if IFX_ENABLE_TPM20
+	// No update follows, the -commit run starts its own policy session
+	if (NULL != PpTpmUpdate && 0 != PpTpmUpdate->hPolicySession)
+	{
+		IGNORE_RETURN_VALUE(TSS_TPM2_FlushContext(PpTpmUpdate->hPolicySession));
+		PpTpmUpdate->hPolicySession = 0;
+	}
+#endif
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Loads the update plan file and compares it with the current TPM state and update options.
+ *	@details	Called for the -commit command line option before the firmware image is loaded. Like the verification
+ *				cache file, the plan file is only accepted if it is private to the effective user and its digest matches.
+ *				The firmware image is compared later by CommandFlow_TpmUpdate_IsTpmUpdatableWithFirmware().
+ *
+ *	@param		PpTpmUpdate					Pointer to a IfxUpdate structure holding the TPM state
+ *
+ *	@retval		RC_SUCCESS					The plan matches and is loaded to s_sUpdatePlan.
+ *	@retval		RC_E_UPDATE_PLAN_MISMATCH	The plan file is missing, invalid or does not match.
+ *	@retval		...							Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_CheckUpdatePlan(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BYTE* prgbPlan = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszPlanFile[MAX_PATH] = {0};
+		unsigned int unPlanFileSize = RG_LEN(wszPlanFile);
+		unsigned long long ullPlanSize = 0;
+		unsigned long long ullModificationTime = 0;
+		unsigned int unPlanSize = 0;
+		BOOL fPrivate = FALSE;
+		BYTE rgbPlanDigest[SHA256_DIGEST_SIZE] = {0};
+		IfxUpdatePlan sCurrent;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sUpdatePlan, 0, sizeof(s_sUpdatePlan)));
+
+		unReturnValue = CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_PLAN_FILE_PREFIX, wszPlanFile, &unPlanFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = RC_E_UPDATE_PLAN_MISMATCH;
+		if (RC_SUCCESS != FileIO_GetFileStatus(wszPlanFile, &ullPlanSize, &ullModificationTime, &fPrivate))
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The update plan file '%ls' does not exist.", wszPlanFile);
+			break;
+		}
+		if (FALSE == fPrivate)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The update plan file '%ls' is not private to the current user.", wszPlanFile);
+			break;
+		}
+		if (RC_SUCCESS != FileIO_ReadFileToBuffer(wszPlanFile, &prgbPlan, &unPlanSize) ||
+				sizeof(IfxUpdatePlan) != unPlanSize ||
+				RC_SUCCESS != Platform_MemoryCopy(&s_sUpdatePlan, sizeof(s_sUpdatePlan), prgbPlan, unPlanSize) ||
+				UPDATE_PLAN_MAGIC != s_sUpdatePlan.unMagic ||
+				sizeof(IfxUpdatePlan) != s_sUpdatePlan.unPlanSize ||
+				RC_SUCCESS != CommandFlow_TpmUpdate_CalculateFileDigest(&s_sUpdatePlan, offsetof(IfxUpdatePlan, rgbPlanDigest), rgbPlanDigest) ||
+				0 != Platform_MemoryCompare(rgbPlanDigest, s_sUpdatePlan.rgbPlanDigest, SHA256_DIGEST_SIZE))
+		{
+			IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sUpdatePlan, 0, sizeof(s_sUpdatePlan)));
+			ERROR_STORE_FMT(unReturnValue, L"The update plan file '%ls' is corrupt.", wszPlanFile);
+			break;
+		}
+
+		// Compare the options and the TPM state from the firmware path up to the number of remaining updates. The
+		// bundle update path is selected while the image is loaded and compared with the image.
+		if (RC_SUCCESS != CommandFlow_TpmUpdate_FillUpdatePlan(PpTpmUpdate, &sCurrent))
+			break;
+		if (0 != Platform_MemoryCompare(
+					&sCurrent.wszFirmwarePath,
+					&s_sUpdatePlan.wszFirmwarePath,
+					offsetof(IfxUpdatePlan, wszBundleSourceVersion) - offsetof(IfxUpdatePlan, wszFirmwarePath)))
+		{
+			IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sUpdatePlan, 0, sizeof(s_sUpdatePlan)));
+			ERROR_STORE_FMT(unReturnValue, L"The TPM state or the update options do not match the update plan file '%ls'.", wszPlanFile);
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL2_FMT(L"Update plan '%ls' matches the TPM state.", wszPlanFile);
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbPlan);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Records the firmware update which is about to be started in the update journal file.
+ *	@details	Written before the TPM is switched to boot loader mode. If the update is interrupted, the next run finds
+ *				the TPM in boot loader mode and resumes the update with the journaled firmware image without checking it
+ *				again. Errors are only logged, the update does not depend on the journal.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure which passed the checks and the preparation
+ */
+void
+CommandFlow_TpmUpdate_StoreUpdateJournal(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+	wchar_t wszJournalFile[MAX_PATH] = {0};
+
+	do
+	{
+		IfxUpdateJournal sJournal;
+		unsigned int unSize = 0;
+		unsigned int unJournalFileSize = RG_LEN(wszJournalFile);
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sJournal, 0, sizeof(sJournal)));
+		sJournal.unMagic = UPDATE_JOURNAL_MAGIC;
+		sJournal.unJournalSize = sizeof(IfxUpdateJournal);
+
+		unSize = RG_LEN(sJournal.wszFirmwarePath);
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, sJournal.wszFirmwarePath, &unSize) ||
+				FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_UPDATE_TYPE, &sJournal.unUpdateType))
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+		unSize = RG_LEN(sJournal.wszSourceVersion);
+		unReturnValue = Platform_StringCopy(sJournal.wszSourceVersion, &unSize, PpTpmUpdate->wszVersionName);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unSize = RG_LEN(sJournal.wszTargetVersion);
+		unReturnValue = Platform_StringCopy(sJournal.wszTargetVersion, &unSize, PpTpmUpdate->wszNewFirmwareVersion);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unSize = RG_LEN(sJournal.wszBundleSourceVersion);
+		unReturnValue = Platform_StringCopy(sJournal.wszBundleSourceVersion, &unSize, s_wszBundleSourceVersion);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unSize = RG_LEN(sJournal.wszBundleTargetVersion);
+		unReturnValue = Platform_StringCopy(sJournal.wszBundleTargetVersion, &unSize, s_wszBundleTargetVersion);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = CommandFlow_TpmUpdate_GetImageKey(PpTpmUpdate, &sJournal.sImage);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = CommandFlow_TpmUpdate_CalculateFileDigest(&sJournal, offsetof(IfxUpdateJournal, rgbJournalDigest), sJournal.rgbJournalDigest);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_JOURNAL_FILE_PREFIX, wszJournalFile, &unJournalFileSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_Open(wszJournalFile, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sJournal, sizeof(sJournal));
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not write the update journal file '%ls' (0x%.8X).", wszJournalFile, unReturnValue);
+	}
+}
+
+/**
+ *	@brief		Loads the update journal file of an interrupted firmware update.
+ *	@details	Like the update plan file, the journal file is only accepted if it is private to the effective user and its
+ *				digest matches. A valid journal means the TPM is most likely in boot loader mode, so the TPM detection starts
+ *				with the TPM1.2 command set spoken by the boot loader.
+ */
+void
+CommandFlow_TpmUpdate_LoadUpdateJournal()
+{
+	BYTE* prgbJournal = NULL;
+
+	do
+	{
+		wchar_t wszJournalFile[MAX_PATH] = {0};
+		unsigned int unJournalFileSize = RG_LEN(wszJournalFile);
+		unsigned long long ullJournalSize = 0;
+		unsigned long long ullModificationTime = 0;
+		unsigned int unJournalSize = 0;
+		BOOL fPrivate = FALSE;
+		BYTE rgbJournalDigest[SHA256_DIGEST_SIZE] = {0};
+
+		s_fUpdateJournalValid = FALSE;
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sUpdateJournal, 0, sizeof(s_sUpdateJournal)));
+
+		if (RC_SUCCESS != CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_JOURNAL_FILE_PREFIX, wszJournalFile, &unJournalFileSize) ||
+				RC_SUCCESS != FileIO_GetFileStatus(wszJournalFile, &ullJournalSize, &ullModificationTime, &fPrivate))
+			break;
+		if (FALSE == fPrivate ||
+				RC_SUCCESS != FileIO_ReadFileToBuffer(wszJournalFile, &prgbJournal, &unJournalSize) ||
+				sizeof(IfxUpdateJournal) != unJournalSize ||
+				RC_SUCCESS != Platform_MemoryCopy(&s_sUpdateJournal, sizeof(s_sUpdateJournal), prgbJournal, unJournalSize) ||
+				UPDATE_JOURNAL_MAGIC != s_sUpdateJournal.unMagic ||
+				sizeof(IfxUpdateJournal) != s_sUpdateJournal.unJournalSize ||
+				RC_SUCCESS != CommandFlow_TpmUpdate_CalculateFileDigest(&s_sUpdateJournal, offsetof(IfxUpdateJournal, rgbJournalDigest), rgbJournalDigest) ||
+				0 != Platform_MemoryCompare(rgbJournalDigest, s_sUpdateJournal.rgbJournalDigest, SHA256_DIGEST_SIZE))
+		{
+			IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sUpdateJournal, 0, sizeof(s_sUpdateJournal)));
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the update journal file '%ls', it is not private to the current user or corrupt.", wszJournalFile);
+			break;
+		}
+
+		s_fUpdateJournalValid = TRUE;
+		FirmwareUpdate_SetTpm12Hint(TRUE);
+		LOGGING_WRITE_LEVEL2_FMT(L"Update journal '%ls': interrupted update from %ls to %ls with '%ls'.",
+			wszJournalFile, s_sUpdateJournal.wszSourceVersion, s_sUpdateJournal.wszTargetVersion, s_sUpdateJournal.wszFirmwarePath);
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgbJournal);
+}
+
+/**
+ *	@brief		Checks whether the loaded firmware image is the one of the interrupted firmware update.
+ *	@details	The image is identified by CommandFlow_TpmUpdate_GetImageKey() and must have been loaded with the update
+ *				path of the journal.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the loaded firmware image
+ *
+ *	@retval		TRUE					The firmware image passed all checks before the interrupted update was started.
+ *	@retval		FALSE					No update journal was loaded or the firmware image differs.
+ */
+BOOL
+CommandFlow_TpmUpdate_MatchesUpdateJournal(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	IfxVerifyCacheEntry sImage;
+
+	return TRUE == s_fUpdateJournalValid &&
+		RC_SUCCESS == CommandFlow_TpmUpdate_GetImageKey(PpTpmUpdate, &sImage) &&
+		0 == Platform_MemoryCompare(&sImage, &s_sUpdateJournal.sImage, sizeof(sImage)) &&
+		0 == Platform_MemoryCompare(s_wszBundleSourceVersion, s_sUpdateJournal.wszBundleSourceVersion, sizeof(s_wszBundleSourceVersion)) &&
+		0 == Platform_MemoryCompare(s_wszBundleTargetVersion, s_sUpdateJournal.wszBundleTargetVersion, sizeof(s_wszBundleTargetVersion));
+}
+
+/**
+ *	@brief		Loads the update duration file.
+ *	@details	Returns the durations measured by earlier updates. A TPM family without a measurement gets the built-in
+ *				defaults, also if the file does not exist or is corrupt.
+ *
+ *	@param		PpsDurations			Receives the content of the update duration file
+ */
+void
+CommandFlow_TpmUpdate_LoadUpdateDurations(
+	_Out_ IfxUpdateDurations* PpsDurations)
+{
+	BYTE* prgbFile = NULL;
+	unsigned int unFileSize = 0;
+	unsigned int unIndex = 0;
+
+	IGNORE_RETURN_VALUE(Platform_MemorySet(PpsDurations, 0, sizeof(IfxUpdateDurations)));
+	if (RC_SUCCESS == FileIO_ReadFileToBuffer(TPM_FACTORY_UPD_DURATION_FILE, &prgbFile, &unFileSize) &&
+			sizeof(IfxUpdateDurations) == unFileSize)
+	{
+		IGNORE_RETURN_VALUE(Platform_MemoryCopy(PpsDurations, sizeof(IfxUpdateDurations), prgbFile, unFileSize));
+		if (UPDATE_DURATION_MAGIC != PpsDurations->unMagic || sizeof(IfxUpdateDurations) != PpsDurations->unDurationsSize)
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"Ignoring the corrupt update duration file '%ls'.", TPM_FACTORY_UPD_DURATION_FILE);
+			IGNORE_RETURN_VALUE(Platform_MemorySet(PpsDurations, 0, sizeof(IfxUpdateDurations)));
+		}
 	}
-};
+	Platform_MemoryFree((void**)&prgbFile);
 
-// Flag to remember that firmware update is done through config file option
-BOOL s_fUpdateThroughConfigFile = FALSE;
+	PpsDurations->unMagic = UPDATE_DURATION_MAGIC;
+	PpsDurations->unDurationsSize = sizeof(IfxUpdateDurations);
+	for (unIndex = 0; unIndex < RG_LEN(PpsDurations->rgsFamilies); unIndex++)
+	{
+		if (0 == PpsDurations->rgsFamilies[unIndex].unUpdates || 0 == PpsDurations->rgsFamilies[unIndex].unBlockSize)
+			PpsDurations->rgsFamilies[unIndex] = s_rgsDefaultDurations[unIndex];
+	}
+}
+
+/**
+ *	@brief		Returns the index of the TPM family in the update duration file.
+ *	@details	A TPM in boot loader mode is updated with the family of the new firmware image.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure
+ *
+ *	@retval		UPDATE_DURATION_TPM12 or UPDATE_DURATION_TPM20
+ */
+unsigned int
+CommandFlow_TpmUpdate_GetUpdateDurationFamily(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	if (PpTpmUpdate->sTpmState.attribs.tpm12)
+		return UPDATE_DURATION_TPM12;
+	if (PpTpmUpdate->sTpmState.attribs.tpm20)
+		return UPDATE_DURATION_TPM20;
+	return DEVICE_TYPE_TPM_12 == PpTpmUpdate->bTargetFamily ? UPDATE_DURATION_TPM12 : UPDATE_DURATION_TPM20;
+}
+
+/**
+ *	@brief		Predicts the duration of the preparation and the firmware update.
+ *	@details	Sums up the preparation, the boot loader switch, one block time per firmware block and the completion
+ *				of the TPM family and adds a safety margin. The number of firmware blocks is derived from the size of the
+ *				firmware block in the image and the block size the TPM reported in the last measured update.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the checked firmware image
+ *
+ *	@retval		Predicted duration in microseconds
+ */
+unsigned long long
+CommandFlow_TpmUpdate_PredictUpdateDuration(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	IfxUpdateDurations sDurations;
+	const IfxUpdateDuration* psDuration = NULL;
+	unsigned int unFamily = CommandFlow_TpmUpdate_GetUpdateDurationFamily(PpTpmUpdate);
+	unsigned long long ullFirmwareSize = PpTpmUpdate->fFirmwareImageParsed ? PpTpmUpdate->sFirmwareImage.unFirmwareSize : PpTpmUpdate->unFirmwareImageSize;
+	unsigned long long ullBlocks = 0;
+	unsigned long long ullDuration = 0;
+
+	CommandFlow_TpmUpdate_LoadUpdateDurations(&sDurations);
+	psDuration = &sDurations.rgsFamilies[unFamily];
+
+	ullBlocks = (ullFirmwareSize + psDuration->unBlockSize - 1) / psDuration->unBlockSize;
+	ullDuration = psDuration->ullPrepareTime + psDuration->ullBootLoaderTime + ullBlocks * psDuration->ullBlockTime + psDuration->ullCompleteTime;
+	ullDuration += ullDuration * UPDATE_DURATION_MARGIN_PERCENT / 100;
+
+	LOGGING_WRITE_LEVEL2_FMT(
+		L"Predicted update duration: %llu ms (%ls, %llu blocks, %u measured updates)",
+		ullDuration / 1000, UPDATE_DURATION_TPM12 == unFamily ? TPM12_FAMILY_STRING : TPM20_FAMILY_STRING, ullBlocks, psDuration->unUpdates);
+
+	return ullDuration;
+}
+
+/**
+ *	@brief		Adds the measured durations of a successful firmware update to the update duration file.
+ *	@details	The durations of the TPM family are averaged exponentially, so a single slow or fast update does not
+ *				dominate the next prediction. Errors are logged only, a missing measurement just keeps the previous values.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure of the completed update
+ *	@param		PpsTimings				Durations measured by FirmwareUpdate_UpdateImage
+ */
+void
+CommandFlow_TpmUpdate_StoreUpdateDuration(
+	_In_ const IfxUpdate*					PpTpmUpdate,
+	_In_ const IfxFirmwareUpdateTimings*	PpsTimings)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	void* pvFile = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		IfxUpdateDurations sDurations;
+		IfxUpdateDuration sMeasured;
+		IfxUpdateDuration* psDuration = NULL;
+		unsigned int unFamily = CommandFlow_TpmUpdate_GetUpdateDurationFamily(PpTpmUpdate);
+
+		if (0 == PpsTimings->unBlockCount || 0 == PpsTimings->unBlockSize)
+		{
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		sMeasured.ullPrepareTime = PpTpmUpdate->sTimings.ullPrepareTime;
+		sMeasured.ullBootLoaderTime = PpsTimings->ullStartTime;
+		sMeasured.ullBlockTime = PpsTimings->ullTransferTime / PpsTimings->unBlockCount;
+		sMeasured.unBlockSize = PpsTimings->unBlockSize;
+		sMeasured.ullCompleteTime = PpsTimings->ullCompleteTime;
+
+		CommandFlow_TpmUpdate_LoadUpdateDurations(&sDurations);
+		psDuration = &sDurations.rgsFamilies[unFamily];
+		if (0 == psDuration->unUpdates)
+		{
+			sMeasured.unUpdates = 1;
+			*psDuration = sMeasured;
+		}
+		else
+		{
+#define UPDATE_DURATION_AVERAGE(OLD, NEW) ((OLD) * (100 - UPDATE_DURATION_WEIGHT_PERCENT) / 100 + (NEW) * UPDATE_DURATION_WEIGHT_PERCENT / 100)
+			psDuration->ullPrepareTime = UPDATE_DURATION_AVERAGE(psDuration->ullPrepareTime, sMeasured.ullPrepareTime);
+			psDuration->ullBootLoaderTime = UPDATE_DURATION_AVERAGE(psDuration->ullBootLoaderTime, sMeasured.ullBootLoaderTime);
+			// The block time is scaled to the block size of the latest update
+			psDuration->ullBlockTime = UPDATE_DURATION_AVERAGE(psDuration->ullBlockTime * sMeasured.unBlockSize / psDuration->unBlockSize, sMeasured.ullBlockTime);
+			psDuration->unBlockSize = sMeasured.unBlockSize;
+			psDuration->ullCompleteTime = UPDATE_DURATION_AVERAGE(psDuration->ullCompleteTime, sMeasured.ullCompleteTime);
+#undef UPDATE_DURATION_AVERAGE
+			psDuration->unUpdates++;
+		}
+
+		unReturnValue = FileIO_Open(TPM_FACTORY_UPD_DURATION_FILE, &pvFile, FILE_WRITE_BINARY);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = FileIO_WriteBuffer(pvFile, (const BYTE*)&sDurations, sizeof(sDurations));
+	}
+	WHILE_FALSE_END;
+
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+
+	if (RC_SUCCESS != unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"Could not write the update duration file '%ls' (0x%.8X).", TPM_FACTORY_UPD_DURATION_FILE, unReturnValue);
+	}
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
 
 /**
  *	@brief		Callback function to save the used firmware image path to TPM_FACTORY_UPD_RUNDATA_FILE (once an update has been started successfully)
@@ -82,6 +2184,15 @@ CommandFlow_TpmUpdate_UpdateStartedCallback()
 			else
 			{
 				IGNORE_RETURN_VALUE(FileIO_WriteString(pFile, wszFirmwareImagePath));
+
+				// Remember the update path selected from a firmware image bundle, the boot loader cannot report it
+				if (s_fUpdateThroughBundle)
+				{
+					IGNORE_RETURN_VALUE(FileIO_WriteString(pFile, L"\n"));
+					IGNORE_RETURN_VALUE(FileIO_WriteString(pFile, s_wszBundleSourceVersion));
+					IGNORE_RETURN_VALUE(FileIO_WriteString(pFile, L"\n"));
+					IGNORE_RETURN_VALUE(FileIO_WriteString(pFile, s_wszBundleTargetVersion));
+				}
 			}
 			IGNORE_RETURN_VALUE(FileIO_Close(&pFile));
 		}
@@ -90,6 +2201,204 @@ CommandFlow_TpmUpdate_UpdateStartedCallback()
 	return;
 }
 
+/**
+ *	@brief		Calculates the digests of the leaves of the verified firmware block for the streamed transfer.
+ *	@details	Called right after the checks while the verified image is still resident. The transfer reads each leaf from
+ *				the file and compares it with its digest before any byte of it is sent, so a corrupt or modified file stops
+ *				the transfer at the first bad leaf instead of after the last block. The digest of all streamed blocks is
+ *				still compared with the signed digest before the update completes. Nothing is calculated for a firmware
+ *				block which is not streamed; without leaf digests the streamed blocks are checked at the end only.
+ *
+ *	@param		PpTpmUpdate				Pointer to a IfxUpdate structure holding the verified firmware image
+ */
+static void
+CommandFlow_TpmUpdate_HashStreamLeaves(
+	_Inout_ IfxUpdate* PpTpmUpdate)
+{
+	BYTE* rgbLeafDigests = NULL;
+	unsigned int unLeafCount = 0;
+	unsigned int unLeaf = 0;
+
+	Platform_MemoryFree((void**)&PpTpmUpdate->rgbStreamLeafDigests);
+	PpTpmUpdate->unStreamLeafCount = 0;
+
+	// Only an image mapped from its file is streamed
+	if (!PpTpmUpdate->fFirmwareImageMapped || PpTpmUpdate->fFirmwareImageShared || !PpTpmUpdate->fFirmwareImageParsed ||
+			!CommandFlow_TpmUpdate_IsImageInFile(PpTpmUpdate) || 0 == PpTpmUpdate->sFirmwareImage.unFirmwareSize)
+		return;
+
+	unLeafCount = (PpTpmUpdate->sFirmwareImage.unFirmwareSize + FIRMWARE_STREAM_LEAF_SIZE - 1) / FIRMWARE_STREAM_LEAF_SIZE;
+	rgbLeafDigests = (BYTE*)Platform_MemoryAllocateZero(unLeafCount * SHA256_DIGEST_SIZE);
+	if (NULL == rgbLeafDigests)
+		return;
+
+	for (unLeaf = 0; unLeaf < unLeafCount; unLeaf++)
+	{
+		unsigned int unLeafOffset = unLeaf * FIRMWARE_STREAM_LEAF_SIZE;
+		unsigned int unLeafSize = PpTpmUpdate->sFirmwareImage.unFirmwareSize - unLeafOffset < FIRMWARE_STREAM_LEAF_SIZE ?
+								  PpTpmUpdate->sFirmwareImage.unFirmwareSize - unLeafOffset : FIRMWARE_STREAM_LEAF_SIZE;
+
+		if (RC_SUCCESS != Crypt_SHA256(PpTpmUpdate->sFirmwareImage.rgbFirmware + unLeafOffset, unLeafSize, rgbLeafDigests + unLeaf * SHA256_DIGEST_SIZE))
+		{
+			Platform_MemoryFree((void**)&rgbLeafDigests);
+			return;
+		}
+	}
+
+	PpTpmUpdate->rgbStreamLeafDigests = rgbLeafDigests;
+	PpTpmUpdate->unStreamLeafCount = unLeafCount;
+}
+
+/**
+ *	@brief		Callback function to read the firmware block from the firmware image file during the transfer
+ *	@details	The function is called by FirmwareUpdate_UpdateImage() for each block sent to the TPM. With leaf digests the
+ *				blocks are served from the current leaf, which is read and checked as a whole when the first of its bytes
+ *				is requested.
+ *
+ *	@param		PpvContext			Pointer to the IfxFirmwareStream of the firmware image file
+ *	@param		PunOffset			Offset in the firmware block
+ *	@param		PrgbBuffer			Receives the data
+ *	@param		PunSize				Number of bytes to read
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		The requested bytes lie beyond the firmware block.
+ *	@retval		RC_E_CORRUPT_FW_IMAGE	A leaf read from the firmware image file does not match the verified firmware block.
+ *	@retval		...						Error codes from FileIO_ReadStream.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_TpmUpdate_ReadFirmwareCallback(
+	_In_						void*	PpvContext,
+	_In_						UINT32	PunOffset,
+	_Out_bytecap_(PunSize)		BYTE*	PrgbBuffer,
+	_In_						UINT32	PunSize)
+{
+	IfxFirmwareStream* psFirmwareStream = (IfxFirmwareStream*)PpvContext;
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	if (NULL == psFirmwareStream->rgbLeafDigests)
+		return FileIO_ReadStream(psFirmwareStream->pvStream, psFirmwareStream->unFirmwareOffset + PunOffset, PrgbBuffer, PunSize);
+
+	if ((UINT64)PunOffset + PunSize > psFirmwareStream->unFirmwareSize)
+		return RC_E_BAD_PARAMETER;
+
+	while (PunSize > 0)
+	{
+		unsigned int unLeaf = PunOffset / FIRMWARE_STREAM_LEAF_SIZE;
+		unsigned int unLeafOffset = PunOffset % FIRMWARE_STREAM_LEAF_SIZE;
+		unsigned int unChunkSize = PunSize < FIRMWARE_STREAM_LEAF_SIZE - unLeafOffset ? PunSize : FIRMWARE_STREAM_LEAF_SIZE - unLeafOffset;
+
+		// Read and check the whole leaf before any of its bytes is handed out
+		if (unLeaf != psFirmwareStream->unLeaf)
+		{
+			unsigned int unLeafSize = psFirmwareStream->unFirmwareSize - unLeaf * FIRMWARE_STREAM_LEAF_SIZE;
+			BYTE rgbLeafDigest[SHA256_DIGEST_SIZE] = {0};
+
+			if (unLeafSize > FIRMWARE_STREAM_LEAF_SIZE)
+				unLeafSize = FIRMWARE_STREAM_LEAF_SIZE;
+			psFirmwareStream->unLeaf = FIRMWARE_STREAM_LEAF_NONE;
+			if (unLeaf >= psFirmwareStream->unLeafCount)
+				return RC_E_BAD_PARAMETER;
+
+			unReturnValue = FileIO_ReadStream(psFirmwareStream->pvStream, psFirmwareStream->unFirmwareOffset + unLeaf * FIRMWARE_STREAM_LEAF_SIZE, psFirmwareStream->rgbLeaf, unLeafSize);
+			if (RC_SUCCESS != unReturnValue)
+				return unReturnValue;
+			unReturnValue = Crypt_SHA256(psFirmwareStream->rgbLeaf, unLeafSize, rgbLeafDigest);
+			if (RC_SUCCESS != unReturnValue)
+				return unReturnValue;
+			if (0 != Platform_MemoryCompare(rgbLeafDigest, psFirmwareStream->rgbLeafDigests + unLeaf * SHA256_DIGEST_SIZE, SHA256_DIGEST_SIZE))
+			{
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				ERROR_STORE_FMT(unReturnValue, L"Leaf %u of the firmware streamed from the firmware image does not match the verified firmware.", unLeaf);
+				return unReturnValue;
+			}
+			psFirmwareStream->unLeaf = unLeaf;
+		}
+
+		unReturnValue = Platform_MemoryCopy(PrgbBuffer, PunSize, psFirmwareStream->rgbLeaf + unLeafOffset, unChunkSize);
+		if (RC_SUCCESS != unReturnValue)
+			return unReturnValue;
+		PrgbBuffer += unChunkSize;
+		PunOffset += unChunkSize;
+		PunSize -= unChunkSize;
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Decides from the firmware image header alone whether the image applies to the TPM.
+ *	@details	Only the source and target fields of the unmarshalled IfxFirmwareImage header are compared with the cached TPM
+ *				state, so the payload of the loaded image is not hashed. An image which does not list the current
+ *				TPM firmware version as source version is either already installed or not meant for the TPM. Both cases are
+ *				decided before the integrity and signature checks run over the whole image.
+ *
+ *	@param		PpTpmUpdate					Pointer to a IfxUpdate structure holding the parsed firmware image header
+ *
+ *	@retval		RC_SUCCESS					The image may apply to the TPM, run the full checks.
+ *	@retval		RC_E_ALREADY_UP_TO_DATE		The TPM already runs the target firmware version of the image.
+ *	@retval		RC_E_WRONG_FW_IMAGE			The image cannot be applied to the TPM firmware version.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_CheckImageHeader(
+	_In_ const IfxUpdate* PpTpmUpdate)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		const IfxFirmwareImage* pFirmwareImage = &PpTpmUpdate->sFirmwareImage;
+		BYTE bTpmFamily = PpTpmUpdate->sTpmState.attribs.tpm12 ? DEVICE_TYPE_TPM_12 : DEVICE_TYPE_TPM_20;
+		wchar_t wszVersionShort[MAX_NAME] = {0};
+		unsigned int unVersionShortSize = RG_LEN(wszVersionShort);
+		unsigned int unIndex = 0;
+
+		// A TPM in boot loader mode has no firmware version to compare, its images are checked against the policy parameter block
+		if (PpTpmUpdate->sTpmState.attribs.bootLoader || !PpTpmUpdate->fFirmwareImageParsed || L'\0' == PpTpmUpdate->wszVersionName[0])
+			break;
+
+		// Source versions are listed with (e.g. 7.63.3353.0) or without (e.g. 7.63.3353) subversion.minor
+		if (RC_SUCCESS == Platform_StringCopy(wszVersionShort, &unVersionShortSize, PpTpmUpdate->wszVersionName))
+		{
+			while (unVersionShortSize > 0 && L'.' != wszVersionShort[unVersionShortSize - 1])
+				unVersionShortSize--;
+			if (unVersionShortSize > 0)
+				wszVersionShort[unVersionShortSize - 1] = L'\0';
+		}
+
+		if (bTpmFamily == pFirmwareImage->bSourceTpmFamily)
+		{
+			for (; unIndex < pFirmwareImage->usSourceVersionsCount; unIndex++)
+			{
+				if (0 == Platform_StringCompare(PpTpmUpdate->wszVersionName, pFirmwareImage->rgwszSourceVersions[unIndex], RG_LEN(pFirmwareImage->rgwszSourceVersions[unIndex]), FALSE) ||
+						(L'\0' != wszVersionShort[0] && 0 == Platform_StringCompare(wszVersionShort, pFirmwareImage->rgwszSourceVersions[unIndex], RG_LEN(pFirmwareImage->rgwszSourceVersions[unIndex]), FALSE)))
+					break;
+			}
+			if (unIndex < pFirmwareImage->usSourceVersionsCount)
+				break;
+		}
+
+		if (bTpmFamily == pFirmwareImage->bTargetTpmFamily &&
+				0 == Platform_StringCompare(PpTpmUpdate->wszVersionName, pFirmwareImage->wszTargetVersion, RG_LEN(pFirmwareImage->wszTargetVersion), FALSE))
+		{
+			unReturnValue = RC_E_ALREADY_UP_TO_DATE;
+			LOGGING_WRITE_LEVEL2_FMT(L"The TPM already runs the target firmware version %ls of the firmware image.", pFirmwareImage->wszTargetVersion);
+			break;
+		}
+
+		unReturnValue = RC_E_WRONG_FW_IMAGE;
+		ERROR_STORE_FMT(unReturnValue, L"The provided firmware image does not list the TPM firmware version %ls as source version. (0x%.8X)", PpTpmUpdate->wszVersionName, unReturnValue);
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Checks if the given firmware package can be used to update the TPM.
  *	@details	The function calls FirmwareUpdate_CheckImage() to check whether the TPM can be updated with the given firmware package.
@@ -116,6 +2425,13 @@ CommandFlow_TpmUpdate_IsTpmUpdatableWithFirmware(
 
 	do
 	{
+		BOOL fVerifyCache = FALSE;
+		BOOL fVerifyCacheHit = FALSE;
+		IfxVerifyCacheEntry sVerifyCacheEntry;
+		BOOL fVerifiedImageKey = FALSE;
+		BOOL fVerifiedImageHit = FALSE;
+		IfxVerifyCacheEntry sVerifiedImage;
+
 		// Check input parameters
 		if (NULL == PpTpmUpdate ||
 				STRUCT_TYPE_TpmUpdate != PpTpmUpdate->unType ||
@@ -126,74 +2442,246 @@ CommandFlow_TpmUpdate_IsTpmUpdatableWithFirmware(
 			break;
 		}
 
+		// The firmware image of an update plan passed the checks when the update was prepared
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT))
+		{
+			IfxVerifyCacheEntry sImage;
+			unReturnValue = CommandFlow_TpmUpdate_GetImageKey(PpTpmUpdate, &sImage);
+			if (RC_SUCCESS != unReturnValue ||
+					0 != Platform_MemoryCompare(&sImage, &s_sUpdatePlan.sImage, sizeof(sImage)) ||
+					0 != Platform_MemoryCompare(s_wszBundleSourceVersion, s_sUpdatePlan.wszBundleSourceVersion, sizeof(s_wszBundleSourceVersion)) ||
+					0 != Platform_MemoryCompare(s_wszBundleTargetVersion, s_sUpdatePlan.wszBundleTargetVersion, sizeof(s_wszBundleTargetVersion)))
+			{
+				unReturnValue = RC_E_UPDATE_PLAN_MISMATCH;
+				ERROR_STORE(unReturnValue, L"The firmware image does not match the update plan.");
+				break;
+			}
+			LOGGING_WRITE_LEVEL3(L"Firmware image matches the update plan.");
+			FirmwareUpdate_SetImageIntegrityVerified(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize);
+		}
+		// The firmware image of an interrupted update passed the checks before the update was started
+		else if (PpTpmUpdate->sTpmState.attribs.bootLoader && TRUE == CommandFlow_TpmUpdate_MatchesUpdateJournal(PpTpmUpdate))
+		{
+			LOGGING_WRITE_LEVEL2(L"Firmware image matches the update journal, resuming the interrupted update.");
+			FirmwareUpdate_SetImageIntegrityVerified(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize);
+		}
+		// Skip the integrity and signature checks for a firmware image which passed them in the parent process of a forked worker
+		else if (TRUE == CommandFlow_TpmUpdate_IsImagePreverified(PpTpmUpdate))
+		{
+			LOGGING_WRITE_LEVEL3(L"Firmware image passed the checks in the parent process.");
+			FirmwareUpdate_SetImageIntegrityVerified(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize);
+		}
+		// Skip the integrity and signature checks for a firmware image which passed them for an earlier unit of the factory loop
+		else if (TRUE == CommandFlow_TpmUpdate_LookupVerifiedImages(PpTpmUpdate, &sVerifiedImage, &fVerifiedImageKey))
+		{
+			fVerifiedImageHit = TRUE;
+			LOGGING_WRITE_LEVEL3(L"Firmware image passed the checks for an earlier unit.");
+			FirmwareUpdate_SetImageIntegrityVerified(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize);
+		}
+		// Skip the integrity and signature checks for a firmware image which passed them in a concurrent process
+		else if (TRUE == CommandFlow_TpmUpdate_IsSharedImageSealed(PpTpmUpdate))
+		{
+			LOGGING_WRITE_LEVEL3(L"Firmware image passed the checks in the process which sealed the shared image region.");
+			FirmwareUpdate_SetImageIntegrityVerified(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize);
+		}
+		// Skip the integrity and signature checks for a firmware image which passed them before
+		else if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_VERIFY_CACHE, &fVerifyCache) && TRUE == fVerifyCache)
+		{
+			if (RC_SUCCESS != CommandFlow_TpmUpdate_LookupVerifyCache(PpTpmUpdate, &sVerifyCacheEntry, &fVerifyCacheHit))
+				fVerifyCache = FALSE;
+			else if (TRUE == fVerifyCacheHit)
+			{
+				LOGGING_WRITE_LEVEL3(L"Firmware image found in the verification cache.");
+				FirmwareUpdate_SetImageIntegrityVerified(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize);
+			}
+		}
+
 		// Call CheckImage
-		unReturnValue = FirmwareUpdate_CheckImage(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize, &PpTpmUpdate->fValid, &PpTpmUpdate->bfNewTpmFirmwareInfo, &PpTpmUpdate->unErrorDetails);
+		unReturnValue = FirmwareUpdate_CheckImage(PpTpmUpdate->rgbFirmwareImage, PpTpmUpdate->unFirmwareImageSize, PpTpmUpdate->fFirmwareImageParsed ? &PpTpmUpdate->sFirmwareImage : NULL, &PpTpmUpdate->fValid, &PpTpmUpdate->bfNewTpmFirmwareInfo, &PpTpmUpdate->unErrorDetails);
+		FirmwareUpdate_SetImageIntegrityVerified(NULL, 0);
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
+		// Only images which passed all checks are remembered
+		if (TRUE == fVerifyCache && FALSE == fVerifyCacheHit && TRUE == PpTpmUpdate->fValid)
+			CommandFlow_TpmUpdate_StoreVerifyCache(&sVerifyCacheEntry);
+		if (TRUE == fVerifiedImageKey && FALSE == fVerifiedImageHit && TRUE == PpTpmUpdate->fValid)
+			CommandFlow_TpmUpdate_RememberVerifiedImage(&sVerifiedImage);
+		if (L'\0' != s_wszImageCacheUrl[0] && TRUE == PpTpmUpdate->fValid)
+			CommandFlow_TpmUpdate_StoreImageCache(PpTpmUpdate);
+		if (NULL != s_pvSharedImage && TRUE == PpTpmUpdate->fValid)
+			CommandFlow_TpmUpdate_PublishSharedImage(PpTpmUpdate);
+
 		if (!PpTpmUpdate->fValid)
 		{
 			switch (PpTpmUpdate->unErrorDetails)
 			{
-				case RC_E_CORRUPT_FW_IMAGE:
-					unReturnValue = PpTpmUpdate->unErrorDetails;
-					ERROR_STORE_FMT(unReturnValue, L"The provided firmware image is corrupt. (0x%.8X)", PpTpmUpdate->unErrorDetails);
-					break;
-				case RC_E_WRONG_FW_IMAGE:
-					unReturnValue = PpTpmUpdate->unErrorDetails;
-					ERROR_STORE_FMT(unReturnValue, L"The provided firmware image is not valid for the TPM. (0x%.8X)", PpTpmUpdate->unErrorDetails);
-					break;
-				case RC_E_NEWER_TOOL_REQUIRED:
-					unReturnValue = PpTpmUpdate->unErrorDetails;
-					ERROR_STORE_FMT(unReturnValue, L"A newer version of the tool is required to process the provided firmware image. (0x%.8X)", PpTpmUpdate->unErrorDetails);
-					break;
-				case RC_E_WRONG_DECRYPT_KEYS:
-					unReturnValue = PpTpmUpdate->unErrorDetails;
-					ERROR_STORE_FMT(unReturnValue, L"The provided firmware image is not valid for the TPM. (0x%.8X)", PpTpmUpdate->unErrorDetails);
-					break;
-				default:
-					unReturnValue = RC_E_TPM_FIRMWARE_UPDATE;
-					ERROR_STORE_FMT(unReturnValue, L"The firmware image check returned an unexpected value. (0x%.8X)", PpTpmUpdate->unErrorDetails);
-					break;
+				case RC_E_CORRUPT_FW_IMAGE:
+					unReturnValue = PpTpmUpdate->unErrorDetails;
+					ERROR_STORE_FMT(unReturnValue, L"The provided firmware image is corrupt. (0x%.8X)", PpTpmUpdate->unErrorDetails);
+					break;
+				case RC_E_WRONG_FW_IMAGE:
+					unReturnValue = PpTpmUpdate->unErrorDetails;
+					ERROR_STORE_FMT(unReturnValue, L"The provided firmware image is not valid for the TPM. (0x%.8X)", PpTpmUpdate->unErrorDetails);
+					break;
+				case RC_E_NEWER_TOOL_REQUIRED:
+					unReturnValue = PpTpmUpdate->unErrorDetails;
+					ERROR_STORE_FMT(unReturnValue, L"A newer version of the tool is required to process the provided firmware image. (0x%.8X)", PpTpmUpdate->unErrorDetails);
+					break;
+				case RC_E_WRONG_DECRYPT_KEYS:
+					unReturnValue = PpTpmUpdate->unErrorDetails;
+					ERROR_STORE_FMT(unReturnValue, L"The provided firmware image is not valid for the TPM. (0x%.8X)", PpTpmUpdate->unErrorDetails);
+					break;
+				default:
+					unReturnValue = RC_E_TPM_FIRMWARE_UPDATE;
+					ERROR_STORE_FMT(unReturnValue, L"The firmware image check returned an unexpected value. (0x%.8X)", PpTpmUpdate->unErrorDetails);
+					break;
+			}
+			break;
+		}
+
+		// Get the target version and the target family from the parsed image
+		{
+			unsigned int unNewFirmwareVersionSize = RG_LEN(PpTpmUpdate->wszNewFirmwareVersion);
+
+			if (!PpTpmUpdate->fFirmwareImageParsed)
+			{
+				unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+				ERROR_STORE(unReturnValue, L"Firmware image cannot be parsed.");
+				break;
+			}
+
+			unReturnValue = Platform_StringCopy(PpTpmUpdate->wszNewFirmwareVersion, &unNewFirmwareVersionSize, PpTpmUpdate->sFirmwareImage.wszTargetVersion);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Platform_StringCopy returned an unexpected value while copying the target firmware version.");
+				break;
+			}
+
+			PpTpmUpdate->bTargetFamily = PpTpmUpdate->sFirmwareImage.bTargetTpmFamily;
+		}
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+#if IFX_ENABLE_TPM12
+/// Physical presence step: enable the physical presence command
+#define TPM12_PP_STEP_CMD_ENABLE	0x1
+/// Physical presence step: assert physical presence
+#define TPM12_PP_STEP_PRESENT		0x2
+/// Physical presence step: set the deferred physical presence bit
+#define TPM12_PP_STEP_DEFERRED		0x4
+
+/**
+ *	@brief		Plans the commands setting Deferred Physical Presence on a TPM1.2
+ *	@details	Uses the permanent and volatile physical presence flags of the TPM state, so only the transitions actually
+ *				needed are sent. Flags the TPM did not report are zero, which plans the complete sequence.
+ *
+ *	@param		PpsTpmState			TPM state read by FirmwareUpdate_CalculateState
+ *	@param		PpunSteps			Receives the TPM12_PP_STEP_* steps to execute
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_TPM12_DEFERREDPP_REQUIRED	Physical Presence cannot be asserted in this boot cycle.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_TpmUpdate_PlanTPM12PhysicalPresence(
+	_In_	const TPM_STATE*	PpsTpmState,
+	_Out_	unsigned int*		PpunSteps)
+{
+	*PpunSteps = TPM12_PP_STEP_DEFERRED;
+
+	// Physical Presence is already asserted, e.g. by the platform
+	if (PpsTpmState->attribs.tpm12PhysicalPresence)
+		return RC_SUCCESS;
+
+	// Physical Presence is locked for the boot cycle, or the command is disabled for the lifetime of the TPM
+	if (PpsTpmState->attribs.tpm12PhysicalPresenceLock ||
+			(PpsTpmState->attribs.tpm12PhysicalPresenceLifetimeLock && !PpsTpmState->attribs.tpm12PhysicalPresenceCMDEnable))
+		return RC_E_TPM12_DEFERREDPP_REQUIRED;
+
+	*PpunSteps |= TPM12_PP_STEP_PRESENT;
+	if (!PpsTpmState->attribs.tpm12PhysicalPresenceCMDEnable)
+		*PpunSteps |= TPM12_PP_STEP_CMD_ENABLE;
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Executes the planned commands setting Deferred Physical Presence on a TPM1.2
+ *	@details
+ *
+ *	@param		PunSteps			TPM12_PP_STEP_* steps to execute
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_TPM12_DEFERREDPP_REQUIRED	Physical Presence is locked and Deferred Physical Presence is not set
+ *	@retval		...								Error codes from Micro TSS functions
+ */
+_Check_return_
+static unsigned int
+CommandFlow_TpmUpdate_ExecuteTPM12PhysicalPresence(
+	_In_ unsigned int PunSteps)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	do
+	{
+		if (0 != (PunSteps & TPM12_PP_STEP_CMD_ENABLE))
+		{
+			unReturnValue = TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_CMD_ENABLE);
+			// In case this has already been done and lifetime was locked in TPM factory, the command above will fail with TPM_BAD_PARAMETER.
+			// But in case Physical Presence is not locked yet, we can still perform all required actions, therefore this is not necessarily an error and we
+			// should continue.
+			if (RC_SUCCESS != unReturnValue && TPM_BAD_PARAMETER != (unReturnValue ^ RC_TPM_MASK))
+			{
+				ERROR_STORE(unReturnValue, L"Error calling TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_CMD_ENABLE)");
+				break;
 			}
-			break;
 		}
 
-		// Parse the new image and get the target version and the target family
+		if (0 != (PunSteps & TPM12_PP_STEP_PRESENT))
 		{
-			BYTE* rgbIfxFirmwareImageStream = PpTpmUpdate->rgbFirmwareImage;
-			IfxFirmwareImage sIfxFirmwareImage = {{0}};
-			INT32 nIfxFirmwareImageSize = (INT32)PpTpmUpdate->unFirmwareImageSize;
-			unsigned int unNewFirmwareVersionSize = RG_LEN(PpTpmUpdate->wszNewFirmwareVersion);
-
-			unReturnValue = FirmwareImage_Unmarshal(&sIfxFirmwareImage, &rgbIfxFirmwareImageStream, &nIfxFirmwareImageSize);
+			unReturnValue = TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_PRESENT);
+			// In case Physical Presence is locked, the command above will fail with TPM_BAD_PARAMETER.
+			// Since Deferred Physical Presence is also not set we must stop the update execution and return to the caller
 			if (RC_SUCCESS != unReturnValue)
 			{
-				ERROR_STORE(unReturnValue, L"Firmware image cannot be parsed.");
+				if (TPM_BAD_PARAMETER == (unReturnValue ^ RC_TPM_MASK))
+					unReturnValue = RC_E_TPM12_DEFERREDPP_REQUIRED;
+
+				ERROR_STORE(unReturnValue, L"Error calling TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_PRESENT)");
 				break;
 			}
+		}
 
-			unReturnValue = Platform_StringCopy(PpTpmUpdate->wszNewFirmwareVersion, &unNewFirmwareVersionSize, sIfxFirmwareImage.wszTargetVersion);
-			if (RC_SUCCESS != unReturnValue)
+		{
+			// Set Deferred Physical Presence bit
+			UINT32 unSubCapSwapped = Platform_SwapBytes32(TPM_SD_DEFERREDPHYSICALPRESENCE);
+			BYTE setValue[] = { 0x00, 0x00, 0x00, 0x01}; // TRUE
+			unReturnValue = TSS_TPM_SetCapability(TPM_SET_STCLEAR_DATA, sizeof(unSubCapSwapped), (BYTE*)&unSubCapSwapped, sizeof(setValue), setValue);
+			// A skipped step is reported with TPM_BAD_PRESENCE, the caller retries with the complete sequence
+			if (RC_SUCCESS != unReturnValue && !(TPM_BAD_PRESENCE == (unReturnValue ^ RC_TPM_MASK) && 0 == (PunSteps & TPM12_PP_STEP_PRESENT)))
 			{
-				ERROR_STORE(unReturnValue, L"Platform_StringCopy returned an unexpected value while copying the target firmware version.");
+				ERROR_STORE(unReturnValue, L"Error calling TSS_TPM_SetCapability(TPM_SET_STCLEAR_DATA)");
 				break;
 			}
-
-			PpTpmUpdate->bTargetFamily = sIfxFirmwareImage.bTargetTpmFamily;
 		}
 	}
 	WHILE_FALSE_END;
 
-	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
-
 	return unReturnValue;
 }
 
 /**
  *	@brief		Prepare a firmware update for a TPM1.2 with (Deferred) Physical Presence.
- *	@details	This function will prepare the TPM1.2 to do a firmware update.
+ *	@details	This function will prepare the TPM1.2 to do a firmware update. The physical presence flags of the TPM state
+ *				decide which commands are needed: none if Physical Presence is locked, only setting the Deferred Physical
+ *				Presence bit if Physical Presence is asserted already, and enabling the physical presence command only if
+ *				it is disabled. If the flags turn out to be outdated, the complete sequence is sent.
  *
+ *	@param		PpsTpmState			TPM state read by FirmwareUpdate_CalculateState
  *	@retval		RC_SUCCESS				The operation completed successfully.
  *	@retval		RC_E_TPM12_DEFERREDPP_REQUIRED	Physical Presence is locked and Deferred Physical Presence is not set
  *	@retval		RC_E_FAIL						An unexpected error occurred.
@@ -201,59 +2689,45 @@ CommandFlow_TpmUpdate_IsTpmUpdatableWithFirmware(
  */
 _Check_return_
 unsigned int
-CommandFlow_TpmUpdate_PrepareTPM12PhysicalPresence()
+CommandFlow_TpmUpdate_PrepareTPM12PhysicalPresence(
+	_In_ const TPM_STATE* PpsTpmState)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unSteps = 0;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
 	do
 	{
-		// Deferred Physical Presence is not set so try to enable Physical Presence and set Deferred Physical Presence with following command sequence.
-		// First try to enable the Physical Presence command, it may already be enabled
-		unReturnValue = TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_CMD_ENABLE);
-		// In case this has already been done and lifetime was locked in TPM factory, the command above will fail with TPM_BAD_PARAMETER.
-		// But in case Physical Presence is not locked yet, we can still perform all required actions, therefore this is not necessarily an error and we
-		// should continue.
-		if (RC_SUCCESS != unReturnValue && TPM_BAD_PARAMETER != (unReturnValue ^ RC_TPM_MASK))
-		{
-			ERROR_STORE(unReturnValue, L"Error calling TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_CMD_ENABLE)");
-			break;
-		}
-
-		// Try to set Physical Presence, may be locked
-		unReturnValue = TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_PRESENT);
-		// In case Physical Presence is locked, the command above will fail with TPM_BAD_PARAMETER.
-		// Since Deferred Physical Presence is also not set we must stop the update execution and return to the caller
+		unReturnValue = CommandFlow_TpmUpdate_PlanTPM12PhysicalPresence(PpsTpmState, &unSteps);
 		if (RC_SUCCESS != unReturnValue)
 		{
-			if (TPM_BAD_PARAMETER == (unReturnValue ^ RC_TPM_MASK))
-				unReturnValue = RC_E_TPM12_DEFERREDPP_REQUIRED;
-
-			ERROR_STORE(unReturnValue, L"Error calling TSS_TSC_PhysicalPresence(TPM_PHYSICAL_PRESENCE_PRESENT)");
+			ERROR_STORE(unReturnValue, L"Physical Presence is locked and Deferred Physical Presence is not set.");
 			break;
 		}
+		LOGGING_WRITE_LEVEL2_FMT(L"TPM1.2 physical presence steps: 0x%X", unSteps);
 
+		unReturnValue = CommandFlow_TpmUpdate_ExecuteTPM12PhysicalPresence(unSteps);
+		if (TPM_BAD_PRESENCE == (unReturnValue ^ RC_TPM_MASK))
 		{
-			// Set Deferred Physical Presence bit
-			UINT32 unSubCapSwapped = Platform_SwapBytes32(TPM_SD_DEFERREDPHYSICALPRESENCE);
-			BYTE setValue[] = { 0x00, 0x00, 0x00, 0x01}; // TRUE
-			unReturnValue = TSS_TPM_SetCapability(TPM_SET_STCLEAR_DATA, sizeof(unSubCapSwapped), (BYTE*)&unSubCapSwapped, sizeof(setValue), setValue);
-			// If we manage to come to this call, the command should succeed. Therefore any error is really an error and should be logged and handled properly.
-			if (RC_SUCCESS != unReturnValue)
-			{
-				ERROR_STORE(unReturnValue, L"Error calling TSS_TPM_SetCapability(TPM_SET_STCLEAR_DATA)");
-				break;
-			}
+			LOGGING_WRITE_LEVEL2(L"Physical Presence is not asserted as expected, sending the complete command sequence.");
+			unSteps = TPM12_PP_STEP_CMD_ENABLE | TPM12_PP_STEP_PRESENT | TPM12_PP_STEP_DEFERRED;
+			unReturnValue = CommandFlow_TpmUpdate_ExecuteTPM12PhysicalPresence(unSteps);
 		}
-		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
+	// Only the physical presence flags have changed, the other parts of the TPM state stay valid
+	if (RC_SUCCESS == unReturnValue)
+		FirmwareUpdate_SetTpm12DeferredPhysicalPresence(0 != (unSteps & TPM12_PP_STEP_CMD_ENABLE));
+	else if (0 != unSteps)
+		FirmwareUpdate_InvalidateState();
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
 }
+#endif // IFX_ENABLE_TPM12
 
 /**
  *	@brief		Processes a sequence of TPM update related commands to update the firmware.
@@ -281,6 +2755,7 @@ CommandFlow_TpmUpdate_UpdateFirmware(
 	{
 		ENUM_UPDATE_TYPES unUpdateType = UPDATE_TYPE_NONE;
 		IfxFirmwareUpdateData sFirmwareUpdateData = {0};
+		IfxFirmwareStream sFirmwareStream = {NULL, 0};
 
 		// Check parameters
 		if (NULL == PpTpmUpdate ||
@@ -326,9 +2801,11 @@ CommandFlow_TpmUpdate_UpdateFirmware(
 
 		// Update firmware
 		sFirmwareUpdateData.fnProgressCallback = &Response_ProgressCallback;
+		sFirmwareUpdateData.fnProgressDetailsCallback = &Response_ProgressDetailsCallback;
 		sFirmwareUpdateData.fnUpdateStartedCallback = &CommandFlow_TpmUpdate_UpdateStartedCallback;
 		sFirmwareUpdateData.rgbFirmwareImage = PpTpmUpdate->rgbFirmwareImage;
 		sFirmwareUpdateData.unFirmwareImageSize = PpTpmUpdate->unFirmwareImageSize;
+		sFirmwareUpdateData.psFirmwareImage = PpTpmUpdate->fFirmwareImageParsed ? &PpTpmUpdate->sFirmwareImage : NULL;
 		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_DRY_RUN, &fValue) && TRUE == fValue)
 		{
 			PpTpmUpdate->unReturnCode = RC_SUCCESS;
@@ -339,7 +2816,83 @@ CommandFlow_TpmUpdate_UpdateFirmware(
 			}
 		}
 		else
+		{
+			IfxFirmwareUpdateTimings sTimings = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+			unsigned int unAccessMode = 0;
+			wchar_t wszFrameFile[MAX_PATH] = {0};
+			unsigned int unFrameFileSize = RG_LEN(wszFrameFile);
+			BYTE* rgbFrameFile = NULL;
+			unsigned int unFrameFileBufferSize = 0;
+			BOOL fFrameFileMapped = FALSE;
+			sFirmwareUpdateData.psTimings = &sTimings;
+
+			// A frame file built with -build-frames provides the update requests, FirmwareUpdate_UpdateImage checks that it
+			// belongs to the firmware image
+			if (TRUE == PropertyStorage_GetValueByKey(PROPERTY_FRAME_FILE, wszFrameFile, &unFrameFileSize))
+			{
+				unReturnValue = FileIO_MapFileToBuffer(wszFrameFile, &rgbFrameFile, &unFrameFileBufferSize, &fFrameFileMapped);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE_FMT(unReturnValue, L"Failed to load the frame file (%ls). (0x%.8X)", wszFrameFile, unReturnValue);
+					break;
+				}
+				sFirmwareUpdateData.rgbFrameFile = rgbFrameFile;
+				sFirmwareUpdateData.unFrameFileSize = unFrameFileBufferSize;
+			}
+
+			// Journal the update before the TPM is switched to boot loader mode, a resumed update keeps the journal
+			if (!PpTpmUpdate->sTpmState.attribs.bootLoader)
+				CommandFlow_TpmUpdate_StoreUpdateJournal(PpTpmUpdate);
+
+			// Stream the firmware block of an uncompressed image file during the transfer instead of keeping the whole
+			// image resident. A decompressed or reassembled image only exists in memory, and a shared image region stays
+			// resident for the other processes anyway. A TPMRemoteAgent receives the prepared blocks of the mapped image in windows
+			// instead, which needs all of them at once.
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unAccessMode))
+				unAccessMode = 0;
+			if (NULL == rgbFrameFile && PpTpmUpdate->fFirmwareImageMapped && !PpTpmUpdate->fFirmwareImageShared && PpTpmUpdate->fFirmwareImageParsed &&
+					CommandFlow_TpmUpdate_IsImageInFile(PpTpmUpdate) && TPM_DEVICE_ACCESS_REMOTE != unAccessMode)
+			{
+				wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
+				unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+
+				if (TRUE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwareImagePath, &unFirmwareImagePathSize) &&
+						RC_SUCCESS == FileIO_OpenStream(wszFirmwareImagePath, &sFirmwareStream.pvStream))
+				{
+					sFirmwareStream.unFirmwareOffset = (unsigned int)(PpTpmUpdate->sFirmwareImage.rgbFirmware - PpTpmUpdate->rgbFirmwareFile);
+					sFirmwareStream.unFirmwareSize = PpTpmUpdate->sFirmwareImage.unFirmwareSize;
+					sFirmwareStream.rgbLeafDigests = PpTpmUpdate->rgbStreamLeafDigests;
+					sFirmwareStream.unLeafCount = PpTpmUpdate->unStreamLeafCount;
+					sFirmwareStream.unLeaf = FIRMWARE_STREAM_LEAF_NONE;
+					sFirmwareUpdateData.fnReadFirmwareCallback = &CommandFlow_TpmUpdate_ReadFirmwareCallback;
+					sFirmwareUpdateData.pvReadFirmwareContext = &sFirmwareStream;
+				}
+			}
+			CommandFlow_TpmUpdate_StartNextImagePrefetch();
 			PpTpmUpdate->unReturnCode = FirmwareUpdate_UpdateImage(&sFirmwareUpdateData);
+			FileIO_CloseStream(&sFirmwareStream.pvStream);
+			FileIO_ReleaseFileBuffer(&rgbFrameFile, unFrameFileBufferSize, fFrameFileMapped);
+
+			// The TPM state is probed again right before the update
+			PpTpmUpdate->sTimings.ullStateTime += sTimings.ullStateTime;
+			PpTpmUpdate->sTimings.ullStartTime = sTimings.ullStartTime;
+			PpTpmUpdate->sTimings.ullTransferTime = sTimings.ullTransferTime;
+			PpTpmUpdate->sTimings.ullCompleteTime = sTimings.ullCompleteTime;
+			PpTpmUpdate->sCpuTimings.ullStateTime += sTimings.ullStateCpuTime;
+			PpTpmUpdate->sCpuTimings.ullStartTime = sTimings.ullStartCpuTime;
+			PpTpmUpdate->sCpuTimings.ullTransferTime = sTimings.ullTransferCpuTime;
+			PpTpmUpdate->sCpuTimings.ullCompleteTime = sTimings.ullCompleteCpuTime;
+			PpTpmUpdate->sWaitTimings.ullStateTime += sTimings.ullStateWaitTime;
+			PpTpmUpdate->sWaitTimings.ullStartTime = sTimings.ullStartWaitTime;
+			PpTpmUpdate->sWaitTimings.ullTransferTime = sTimings.ullTransferWaitTime;
+			PpTpmUpdate->sWaitTimings.ullCompleteTime = sTimings.ullCompleteWaitTime;
+			PpTpmUpdate->unBlockCount = sTimings.unBlockCount;
+			PpTpmUpdate->unResentBlockCount = sTimings.unResentBlockCount;
+
+			// Improve the duration prediction of the next update
+			if (RC_SUCCESS == PpTpmUpdate->unReturnCode)
+				CommandFlow_TpmUpdate_StoreUpdateDuration(PpTpmUpdate, &sTimings);
+		}
 		unReturnValue = RC_SUCCESS;
 		if (RC_SUCCESS != PpTpmUpdate->unReturnCode)
 			break;
@@ -350,15 +2903,37 @@ CommandFlow_TpmUpdate_UpdateFirmware(
 		{
 			IGNORE_RETURN_VALUE(FileIO_Remove(TPM_FACTORY_UPD_RUNDATA_FILE));
 		}
+		if (FALSE == fValue)
+		{
+			wchar_t wszJournalFile[MAX_PATH] = {0};
+			unsigned int unJournalFileSize = RG_LEN(wszJournalFile);
+			if (RC_SUCCESS == CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_JOURNAL_FILE_PREFIX, wszJournalFile, &unJournalFileSize) &&
+					FileIO_Exists(wszJournalFile))
+			{
+				IGNORE_RETURN_VALUE(FileIO_Remove(wszJournalFile));
+			}
+			s_fUpdateJournalValid = FALSE;
+		}
+
+		// The update plan is used up, a dry run keeps it
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT) && FALSE == fValue)
+		{
+			wchar_t wszPlanFile[MAX_PATH] = {0};
+			unsigned int unPlanFileSize = RG_LEN(wszPlanFile);
+			if (RC_SUCCESS == CommandFlow_TpmUpdate_GetDeviceFile(TPM_FACTORY_UPD_PLAN_FILE_PREFIX, wszPlanFile, &unPlanFileSize))
+				IGNORE_RETURN_VALUE(FileIO_Remove(wszPlanFile));
+		}
 	}
 	WHILE_FALSE_END;
 
+#if IFX_ENABLE_TPM20
 	// Try to close policy session in case of errors (only if session has already been started)
 	if ((RC_SUCCESS != unReturnValue || RC_SUCCESS != PpTpmUpdate->unReturnCode) && 0 != PpTpmUpdate->hPolicySession)
 	{
 		IGNORE_RETURN_VALUE(TSS_TPM2_FlushContext(PpTpmUpdate->hPolicySession));
 		PpTpmUpdate->hPolicySession = 0;
 	}
+#endif
 
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
@@ -382,6 +2957,8 @@ CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 	_Inout_ IfxUpdate* PpTpmUpdate)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned long long ullTime = 0;
+	IfxPhaseLoad sLoad = {0, 0};
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
@@ -401,6 +2978,8 @@ CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 		// Set TpmUpdate structure sub type and return value
 		PpTpmUpdate->unSubType = STRUCT_SUBTYPE_PREPARE;
 		PpTpmUpdate->unReturnCode = RC_E_FAIL;
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
 
 		// Check which type of TPM is present or in which state
 		if (PpTpmUpdate->sTpmState.attribs.bootLoader)
@@ -409,12 +2988,15 @@ CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 			PpTpmUpdate->unReturnCode = RC_SUCCESS;
 			unReturnValue = RC_SUCCESS;
 		}
+#if IFX_ENABLE_TPM20
 		else if (PpTpmUpdate->sTpmState.attribs.tpm20)
 		{
 			// Prepare TPM2.0 update
 			PpTpmUpdate->unReturnCode = FirmwareUpdate_PrepareTPM20Policy(&PpTpmUpdate->hPolicySession);
 			unReturnValue = RC_SUCCESS;
 		}
+#endif
+#if IFX_ENABLE_TPM12
 		else if (PpTpmUpdate->sTpmState.attribs.tpm12)
 		{
 			unsigned int unUpdateType = UPDATE_TYPE_NONE;
@@ -433,14 +3015,19 @@ CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 					else
 					{
 						// Prepare (deferred) physical presence based TPM1.2 update
-						PpTpmUpdate->unReturnCode = CommandFlow_TpmUpdate_PrepareTPM12PhysicalPresence();
+						PpTpmUpdate->unReturnCode = CommandFlow_TpmUpdate_PrepareTPM12PhysicalPresence(&PpTpmUpdate->sTpmState);
 						unReturnValue = RC_SUCCESS;
 					}
 				}
 				else if (UPDATE_TYPE_TPM12_TAKEOWNERSHIP == unUpdateType)
 				{
-					// Prepare owner based TPM1.2 update
-					PpTpmUpdate->unReturnCode = CommandFlow_TpmUpdate_PrepareTPM12Ownership();
+					// Prepare owner based TPM1.2 update. The -prepare run already took TPM Ownership for a -commit run, an
+					// existing TPM Ownership was verified by CommandFlow_TpmUpdate_IsFirmwareUpdatable to use the TPM Owner
+					// authentication of the tool.
+					if (TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT) || PpTpmUpdate->sTpmState.attribs.tpm12owner)
+						PpTpmUpdate->unReturnCode = RC_SUCCESS;
+					else
+						PpTpmUpdate->unReturnCode = CommandFlow_TpmUpdate_PrepareTPM12Ownership();
 					unReturnValue = RC_SUCCESS;
 				}
 				else
@@ -455,6 +3042,7 @@ CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 				ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetUIntegerValueByKey failed to get property '%ls'.", PROPERTY_UPDATE_TYPE);
 			}
 		}
+#endif
 		else
 		{
 			unReturnValue = RC_E_FAIL;
@@ -463,6 +3051,16 @@ CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 	}
 	WHILE_FALSE_END;
 
+	// Record the time to prepare the policy session or the TPM Ownership
+	if (0 != ullTime)
+	{
+		PpTpmUpdate->sTimings.ullPrepareTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		PpTpmUpdate->sCpuTimings.ullPrepareTime = sLoad.ullCpuTime;
+		PpTpmUpdate->sWaitTimings.ullPrepareTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"prepare", ullTime, PpTpmUpdate->sTimings.ullPrepareTime, NULL);
+	}
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
@@ -486,6 +3084,8 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 	_Inout_ IfxUpdate* PpTpmUpdate)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned long long ullTime = 0;
+	IfxPhaseLoad sLoad = {0, 0};
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
@@ -503,6 +3103,8 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 		PpTpmUpdate->unSubType = STRUCT_SUBTYPE_IS_UPDATABLE;
 		PpTpmUpdate->unNewFirmwareValid = GENERIC_TRISTATE_STATE_NA;
 		PpTpmUpdate->unReturnCode = RC_E_FAIL;
+		ullTime = Platform_GetMonotonicTimeMicroSeconds();
+		DeviceManagement_StartPhaseLoad(&sLoad);
 
 		// Check if TPM is updatable regarding the count
 		{
@@ -515,6 +3117,16 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 				break;
 			}
 
+			// Check if the TPM family is compiled into the binary (see IFX_ENABLE_TPM12 and IFX_ENABLE_TPM20)
+			if ((!IFX_ENABLE_TPM12 && PpTpmUpdate->sTpmState.attribs.tpm12) ||
+					(!IFX_ENABLE_TPM20 && PpTpmUpdate->sTpmState.attribs.tpm20))
+			{
+				PpTpmUpdate->unReturnCode = RC_E_TPM_NOT_SUPPORTED_FEATURE;
+				ERROR_STORE_FMT(PpTpmUpdate->unReturnCode, L"The TPM family is not supported by this build. (0x%.8lX)", PpTpmUpdate->sTpmState.attribs);
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
 			// Check if TPM1.2 is detected
 			if (PpTpmUpdate->sTpmState.attribs.tpm12)
 			{
@@ -527,13 +3139,26 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 					break;
 				}
 
-				// Check if TPM already has an owner
-				if (PpTpmUpdate->sTpmState.attribs.tpm12owner)
+				// Check if TPM already has an owner (-prepare took TPM Ownership for the -commit run)
+				if (PpTpmUpdate->sTpmState.attribs.tpm12owner &&
+						!(UPDATE_TYPE_TPM12_TAKEOWNERSHIP == unUpdateType && TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT)))
 				{
-					PpTpmUpdate->unReturnCode = RC_E_TPM12_OWNED;
-					ERROR_STORE(PpTpmUpdate->unReturnCode, L"TPM1.2 Owner detected. Update cannot be done.");
-					unReturnValue = RC_SUCCESS;
-					break;
+#if IFX_ENABLE_TPM12
+					// A failed or aborted earlier run may have left the TPM owned with the TPM Owner authentication of the
+					// tool. Reuse that TPM Ownership instead of requiring TPM_OwnerClear and a new TPM_TakeOwnership.
+					if (UPDATE_TYPE_TPM12_TAKEOWNERSHIP == unUpdateType &&
+							RC_SUCCESS == FirmwareUpdate_CheckOwnerAuthorization(s_ownerAuthData.authdata))
+					{
+						LOGGING_WRITE_LEVEL2(L"TPM1.2 Owner authentication of TPMFactoryUpd detected, reusing the TPM Ownership.");
+					}
+					else
+#endif
+					{
+						PpTpmUpdate->unReturnCode = RC_E_TPM12_OWNED;
+						ERROR_STORE(PpTpmUpdate->unReturnCode, L"TPM1.2 Owner detected. Update cannot be done.");
+						unReturnValue = RC_SUCCESS;
+						break;
+					}
 				}
 			}
 
@@ -574,10 +3199,24 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 			}
 		}
 
+		// Check that the TPM state did not change since the update was prepared
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT))
+		{
+			PpTpmUpdate->unReturnCode = CommandFlow_TpmUpdate_CheckUpdatePlan(PpTpmUpdate);
+			if (RC_SUCCESS != PpTpmUpdate->unReturnCode)
+			{
+				PpTpmUpdate->unNewFirmwareValid = GENERIC_TRISTATE_STATE_NO;
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			PpTpmUpdate->unReturnCode = RC_E_FAIL;
+		}
+
 		// Get firmware path from property storage and load file
 		{
 			wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
 			unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+			BOOL fPreloaded = FALSE;
 
 			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwareImagePath, &unFirmwareImagePathSize))
 			{
@@ -586,15 +3225,97 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 				break;
 			}
 
-			unReturnValue = FileIO_ReadFileToBuffer(wszFirmwareImagePath, &PpTpmUpdate->rgbFirmwareImage, &PpTpmUpdate->unFirmwareImageSize);
-			if (RC_SUCCESS != unReturnValue)
+			// A forked worker uses the file loaded by the parent process, the next update of a chain the file loaded during
+			// the previous transfer, concurrent processes updating with the same file share one loaded and checked copy of it
+			CommandFlow_TpmUpdate_FinishNextImagePrefetch();
+			fPreloaded = CommandFlow_TpmUpdate_TakePreloadedImage(wszFirmwareImagePath, PpTpmUpdate);
+			if (!fPreloaded)
+				PpTpmUpdate->fFirmwareImageShared = CommandFlow_TpmUpdate_MapSharedImage(wszFirmwareImagePath, PpTpmUpdate);
+			if (!fPreloaded && !PpTpmUpdate->fFirmwareImageShared)
 			{
-				ERROR_STORE_FMT(RC_E_INVALID_FW_OPTION, L"Failed to load the firmware image (%ls). (0x%.8X)", wszFirmwareImagePath, unReturnValue);
-				unReturnValue = RC_E_INVALID_FW_OPTION;
-				break;
+				unReturnValue = FileIO_MapFileToBuffer(wszFirmwareImagePath, &PpTpmUpdate->rgbFirmwareFile, &PpTpmUpdate->unFirmwareFileSize, &PpTpmUpdate->fFirmwareImageMapped);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE_FMT(RC_E_INVALID_FW_OPTION, L"Failed to load the firmware image (%ls). (0x%.8X)", wszFirmwareImagePath, unReturnValue);
+					unReturnValue = RC_E_INVALID_FW_OPTION;
+					break;
+				}
+			}
+
+			// Decompress gzip compressed firmware images and bundles (the checks below run over the decompressed data)
+			if (!fPreloaded && !PpTpmUpdate->fFirmwareImageShared)
+			{
+				BOOL fDecompressed = FALSE;
+				unReturnValue = FileIO_DecompressFileBuffer(&PpTpmUpdate->rgbFirmwareFile, &PpTpmUpdate->unFirmwareFileSize, &PpTpmUpdate->fFirmwareImageMapped, &fDecompressed);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE_FMT(RC_E_CORRUPT_FW_IMAGE, L"Failed to decompress the firmware image (%ls). (0x%.8X)", wszFirmwareImagePath, unReturnValue);
+					unReturnValue = RC_E_CORRUPT_FW_IMAGE;
+					break;
+				}
+			}
+			PpTpmUpdate->rgbFirmwareImage = PpTpmUpdate->rgbFirmwareFile;
+			PpTpmUpdate->unFirmwareImageSize = PpTpmUpdate->unFirmwareFileSize;
+
+			// Select the firmware image of the update path from a firmware image bundle, the other images are not accessed
+			if (FirmwareImage_IsBundle(PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize))
+			{
+				const wchar_t* pwszSourceVersion = (L'\0' != s_wszBundleSourceVersion[0]) ? s_wszBundleSourceVersion : PpTpmUpdate->wszVersionName;
+				const wchar_t* pwszTargetVersion = (L'\0' != s_wszBundleTargetVersion[0]) ? s_wszBundleTargetVersion : NULL;
+				unsigned int unSourceVersionSize = RG_LEN(s_wszBundleSourceVersion);
+
+				if (PpTpmUpdate->sTpmState.attribs.bootLoader && L'\0' == s_wszBundleSourceVersion[0])
+					unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+				else
+					unReturnValue = FirmwareImage_FindInBundle(
+										PpTpmUpdate->rgbFirmwareFile,
+										PpTpmUpdate->unFirmwareFileSize,
+										PpTpmUpdate->sTpmState.attribs.tpm12 ? DEVICE_TYPE_TPM_12 : DEVICE_TYPE_TPM_20,
+										pwszSourceVersion,
+										pwszTargetVersion,
+										&PpTpmUpdate->rgbFirmwareImage,
+										&PpTpmUpdate->unFirmwareImageSize);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE_FMT(unReturnValue, L"The firmware image bundle (%ls) does not contain a usable firmware image for the TPM firmware version %ls. (0x%.8X)", wszFirmwareImagePath, pwszSourceVersion, unReturnValue);
+					PpTpmUpdate->rgbFirmwareImage = NULL;
+					PpTpmUpdate->unFirmwareImageSize = 0;
+					PpTpmUpdate->unNewFirmwareValid = GENERIC_TRISTATE_STATE_NO;
+					PpTpmUpdate->unReturnCode = unReturnValue;
+					unReturnValue = RC_SUCCESS;
+					break;
+				}
+
+				// Remember the selected update path for TPM_FACTORY_UPD_RUNDATA_FILE
+				if (pwszSourceVersion != s_wszBundleSourceVersion)
+					IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszBundleSourceVersion, &unSourceVersionSize, pwszSourceVersion));
+				s_fUpdateThroughBundle = TRUE;
+			}
+
+			// Unmarshal the image once, all later stages of the update reuse the result
+			{
+				BYTE* rgbIfxFirmwareImageStream = PpTpmUpdate->rgbFirmwareImage;
+				INT32 nIfxFirmwareImageSize = (INT32)PpTpmUpdate->unFirmwareImageSize;
+				PpTpmUpdate->fFirmwareImageParsed = (RC_SUCCESS == FirmwareImage_Unmarshal(&PpTpmUpdate->sFirmwareImage, &rgbIfxFirmwareImageStream, &nIfxFirmwareImageSize));
+			}
+
+			if (s_fUpdateThroughBundle && PpTpmUpdate->fFirmwareImageParsed)
+			{
+				unsigned int unTargetVersionSize = RG_LEN(s_wszBundleTargetVersion);
+				IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszBundleTargetVersion, &unTargetVersionSize, PpTpmUpdate->sFirmwareImage.wszTargetVersion));
 			}
 		}
 
+		// Most runs find the TPM up to date, decide that from the image header before the whole image is verified
+		unReturnValue = CommandFlow_TpmUpdate_CheckImageHeader(PpTpmUpdate);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			PpTpmUpdate->unNewFirmwareValid = GENERIC_TRISTATE_STATE_NO;
+			PpTpmUpdate->unReturnCode = unReturnValue;
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
 		unReturnValue = CommandFlow_TpmUpdate_IsTpmUpdatableWithFirmware(PpTpmUpdate);
 		if (RC_SUCCESS != unReturnValue)
 		{
@@ -604,17 +3325,55 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 			break;
 		}
 
+		// The verified image is not read again before the transfer streams it from the file, only its leaf digests are kept
+		CommandFlow_TpmUpdate_HashStreamLeaves(PpTpmUpdate);
+		FileIO_DiscardFileBuffer(PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize, PpTpmUpdate->fFirmwareImageMapped);
+
 		PpTpmUpdate->unNewFirmwareValid = GENERIC_TRISTATE_STATE_YES;
 		PpTpmUpdate->unReturnCode = RC_SUCCESS;
 		unReturnValue = RC_SUCCESS;
+
+		// Do not start an update which is predicted to overrun the deadline. The deadline counts from the tool start.
+		PpTpmUpdate->ullPredictedDuration = CommandFlow_TpmUpdate_PredictUpdateDuration(PpTpmUpdate);
+		{
+			unsigned int unDeadline = 0;
+			if (TRUE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_DEADLINE, &unDeadline))
+			{
+				const IfxPhaseTimings* pTimings = &PpTpmUpdate->sTimings;
+				unsigned long long ullElapsed =
+					pTimings->ullCommandLineTime + pTimings->ullConfigTime + pTimings->ullConnectTime + pTimings->ullStateTime +
+					Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+				if (ullElapsed + PpTpmUpdate->ullPredictedDuration > unDeadline * 1000000ULL)
+				{
+					PpTpmUpdate->unReturnCode = RC_E_UPDATE_DEADLINE;
+					ERROR_STORE_FMT(
+						PpTpmUpdate->unReturnCode, L"The update is predicted to take %llu s, but only %llu s of the %u s deadline are left.",
+						PpTpmUpdate->ullPredictedDuration / 1000000, ullElapsed >= unDeadline * 1000000ULL ? 0 : (unDeadline * 1000000ULL - ullElapsed) / 1000000, unDeadline);
+				}
+			}
+		}
 	}
 	WHILE_FALSE_END;
 
+	// Processes waiting for a shared image region which is not going to be sealed load the firmware image themselves
+	CommandFlow_TpmUpdate_CloseSharedImage();
+
+	// Record the time to load the firmware image and to check it against the TPM
+	if (0 != ullTime)
+	{
+		PpTpmUpdate->sTimings.ullImageTime = Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+		DeviceManagement_StopPhaseLoad(&sLoad);
+		PpTpmUpdate->sCpuTimings.ullImageTime = sLoad.ullCpuTime;
+		PpTpmUpdate->sWaitTimings.ullImageTime = sLoad.ullWaitTime;
+		Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"image", ullTime, PpTpmUpdate->sTimings.ullImageTime, NULL);
+	}
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
 }
 
+#if IFX_ENABLE_TPM12
 /**
  *	@brief		Take TPM Ownership with hard coded hash value.
  *	@details	The corresponding TPM Owner authentication is described in the user manual.
@@ -695,50 +3454,253 @@ CommandFlow_TpmUpdate_PrepareTPM12Ownership()
 			break;
 		}
 
-		// Initialize SRK parameters
-		sSrkParams.ver.major = 1;
-		sSrkParams.ver.minor = 1;
-		sSrkParams.ver.revMajor = 0;
-		sSrkParams.ver.revMinor = 0;
-		sSrkParams.keyUsage = TPM_KEY_STORAGE;
-		sSrkParams.keyFlags = 0;
-		sSrkParams.authDataUsage = TPM_AUTH_ALWAYS;
-		sSrkParams.algorithmParms.algorithmID = 0x00000001;
-		sSrkParams.algorithmParms.encScheme = CRYPT_ES_RSAESOAEP_SHA1_MGF1;
-		sSrkParams.algorithmParms.sigScheme = TPM_SS_NONE;
-		sSrkParams.algorithmParms.parmSize = sizeof(TPM_RSA_KEY_PARMS);
-		sSrkParams.algorithmParms.parms.keyLength = 0x800;
-		sSrkParams.algorithmParms.parms.numPrimes = 2;
-		sSrkParams.algorithmParms.parms.exponentSize = 0;
-		sSrkParams.PCRInfoSize = 0;
-		sSrkParams.pubKey.keyLength = 0;
-		sSrkParams.encSize = 0;
-
-		unReturnValue = TSS_TPM_TakeOwnership(
-							rgbEncryptedOwnerAuthHash, unEncryptedSrkHashSize, // Encrypted TPM Owner authentication hash
-							rgbEncryptedSrkHash, unEncryptedSrkHashSize, // Encrypted SRK authentication hash
-							&sSrkParams, unAuthHandle, &s_ownerAuthData,
-							&sAuthLastNonceEven, &sSrkKey);
-
-		if (RC_SUCCESS != unReturnValue || 0 == sSrkKey.pubKey.keyLength)
+		// Initialize SRK parameters
+		sSrkParams.ver.major = 1;
+		sSrkParams.ver.minor = 1;
+		sSrkParams.ver.revMajor = 0;
+		sSrkParams.ver.revMinor = 0;
+		sSrkParams.keyUsage = TPM_KEY_STORAGE;
+		sSrkParams.keyFlags = 0;
+		sSrkParams.authDataUsage = TPM_AUTH_ALWAYS;
+		sSrkParams.algorithmParms.algorithmID = 0x00000001;
+		sSrkParams.algorithmParms.encScheme = CRYPT_ES_RSAESOAEP_SHA1_MGF1;
+		sSrkParams.algorithmParms.sigScheme = TPM_SS_NONE;
+		sSrkParams.algorithmParms.parmSize = sizeof(TPM_RSA_KEY_PARMS);
+		sSrkParams.algorithmParms.parms.keyLength = 0x800;
+		sSrkParams.algorithmParms.parms.numPrimes = 2;
+		sSrkParams.algorithmParms.parms.exponentSize = 0;
+		sSrkParams.PCRInfoSize = 0;
+		sSrkParams.pubKey.keyLength = 0;
+		sSrkParams.encSize = 0;
+
+		unReturnValue = TSS_TPM_TakeOwnership(
+							rgbEncryptedOwnerAuthHash, unEncryptedSrkHashSize, // Encrypted TPM Owner authentication hash
+							rgbEncryptedSrkHash, unEncryptedSrkHashSize, // Encrypted SRK authentication hash
+							&sSrkParams, unAuthHandle, &s_ownerAuthData,
+							&sAuthLastNonceEven, &sSrkKey);
+		FirmwareUpdate_InvalidateState();
+
+		if (RC_SUCCESS != unReturnValue || 0 == sSrkKey.pubKey.keyLength)
+		{
+			ERROR_STORE(unReturnValue, L"Take Ownership failed!");
+			break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	// Map return value in case TPM is disabled or deactivated to corresponding tool exit code
+	if ((TPM_DEACTIVATED == (unReturnValue ^ RC_TPM_MASK)) ||
+			(TPM_DISABLED == (unReturnValue ^ RC_TPM_MASK)))
+	{
+		unReturnValue = RC_E_TPM12_DISABLED_DEACTIVATED;
+		ERROR_STORE(unReturnValue, L"Take Ownership failed!");
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+#endif // IFX_ENABLE_TPM12
+
+/**
+ *	@brief		Parses a TPM firmware version of a target firmware rule into a sortable integer.
+ *	@details	The four fields of the version (e.g. 7.63.3353.0) must fit into 16 bits each and are packed into one integer,
+ *				so versions compare like integers. A version pattern ends with '*' after one to three fields (e.g. 7.63.*)
+ *				and covers all versions starting with these fields.
+ *
+ *	@param		PwszVersion				Version, ended by any character which cannot continue it
+ *	@param		PfPattern				TRUE if a version pattern is allowed
+ *	@param		PpullFirst				Receives the lowest version covered
+ *	@param		PpullLast				Receives the highest version covered (equal to PpullFirst for a version)
+ *	@param		PppwszEnd				Receives the position behind the version
+ *
+ *	@retval		TRUE					The version has been parsed.
+ *	@retval		FALSE					The version is invalid.
+ */
+_Check_return_
+static BOOL
+CommandFlow_TpmUpdate_ParseRuleVersion(
+	_In_z_	const wchar_t*			PwszVersion,
+	_In_	BOOL					PfPattern,
+	_Out_	unsigned long long*		PpullFirst,
+	_Out_	unsigned long long*		PpullLast,
+	_Out_	const wchar_t**			PppwszEnd)
+{
+	unsigned long long ullVersion = 0;
+	unsigned int unFields = 0;
+	const wchar_t* pwszChar = PwszVersion;
+
+	while (unFields < 4)
+	{
+		unsigned int unField = 0, unDigits = 0;
+
+		// A version pattern covers all values of the remaining fields
+		if (PfPattern && unFields > 0 && L'*' == *pwszChar)
+		{
+			unsigned int unRemainingBits = (4 - unFields) * 16;
+			*PpullFirst = ullVersion << unRemainingBits;
+			*PpullLast = *PpullFirst | ((1ULL << unRemainingBits) - 1);
+			*PppwszEnd = pwszChar + 1;
+			return TRUE;
+		}
+
+		for (; *pwszChar >= L'0' && *pwszChar <= L'9' && unDigits < 5; pwszChar++, unDigits++)
+			unField = unField * 10 + (unsigned int)(*pwszChar - L'0');
+		if (0 == unDigits || unField > 0xFFFF)
+			return FALSE;
+		ullVersion = (ullVersion << 16) | unField;
+
+		if (++unFields < 4)
+		{
+			if (L'.' != *pwszChar)
+				return FALSE;
+			pwszChar++;
+		}
+	}
+
+	*PpullFirst = ullVersion;
+	*PpullLast = ullVersion;
+	*PppwszEnd = pwszChar;
+	return TRUE;
+}
+
+/**
+ *	@brief		Compiles a setting of the TargetFirmwareRules section into the sorted rule table.
+ *	@details	The value has the format <versions>,<target version>[,<firmware image file name>]. <versions> is a version
+ *				(7.63.3353.0), a version pattern (7.63.*) or a range of versions (7.62.0.0-7.63.65535.0). Without a file
+ *				name the firmware image is composed by the naming convention of update images. The rule is inserted at the
+ *				position of its lowest version, so CommandFlow_TpmUpdate_FindTargetFirmwareRule() needs no sorting.
+ *
+ *	@param		PwszKey					Name of the setting, only used in error messages
+ *	@param		PwszValue				Value of the setting
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_INVALID_SETTING	The rule is invalid, overlaps another rule or there are too many rules.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_TpmUpdate_AddTargetFirmwareRule(
+	_In_z_	const wchar_t*	PwszKey,
+	_In_z_	const wchar_t*	PwszValue)
+{
+	unsigned int unReturnValue = RC_E_INVALID_SETTING;
+
+	do
+	{
+		IfxTargetFirmwareRule sRule;
+		const wchar_t* pwszChar = NULL;
+		const wchar_t* pwszTarget = NULL;
+		unsigned long long ullFirst = 0, ullLast = 0;
+		unsigned int unSize = 0, unIndex = 0;
+
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&sRule, 0, sizeof(sRule)));
+
+		// Covered TPM firmware versions
+		if (!CommandFlow_TpmUpdate_ParseRuleVersion(PwszValue, TRUE, &sRule.ullFirst, &sRule.ullLast, &pwszChar))
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The target firmware rule '%ls' has an invalid version (%ls).", PwszKey, PwszValue);
+			break;
+		}
+		if (L'-' == *pwszChar)
+		{
+			if (sRule.ullFirst != sRule.ullLast ||
+				!CommandFlow_TpmUpdate_ParseRuleVersion(pwszChar + 1, FALSE, &ullFirst, &ullLast, &pwszChar) ||
+				ullLast < sRule.ullFirst)
+			{
+				ERROR_STORE_FMT(unReturnValue, L"The target firmware rule '%ls' has an invalid version range (%ls).", PwszKey, PwszValue);
+				break;
+			}
+			sRule.ullLast = ullLast;
+		}
+
+		// Target firmware version
+		pwszTarget = pwszChar + 1;
+		if (L',' != *pwszChar ||
+			!CommandFlow_TpmUpdate_ParseRuleVersion(pwszTarget, FALSE, &ullFirst, &ullLast, &pwszChar) ||
+			(L'\0' != *pwszChar && L',' != *pwszChar))
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The target firmware rule '%ls' has an invalid target firmware version (%ls).", PwszKey, PwszValue);
+			break;
+		}
+		unSize = RG_LEN(sRule.wszTargetVersion);
+		if (RC_SUCCESS != Platform_StringFormat(sRule.wszTargetVersion, &unSize, L"%.*ls", (int)(pwszChar - pwszTarget), pwszTarget))
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The target firmware rule '%ls' has an invalid target firmware version (%ls).", PwszKey, PwszValue);
+			break;
+		}
+
+		// Optional firmware image file name
+		if (L',' == *pwszChar)
+		{
+			unSize = RG_LEN(sRule.wszFirmwareImage);
+			if (L'\0' == pwszChar[1] || RC_SUCCESS != Platform_StringCopy(sRule.wszFirmwareImage, &unSize, pwszChar + 1))
+			{
+				ERROR_STORE_FMT(unReturnValue, L"The target firmware rule '%ls' has an invalid firmware image file name (%ls).", PwszKey, PwszValue);
+				break;
+			}
+		}
+
+		if (s_unTargetFirmwareRules >= TARGET_FIRMWARE_RULES_MAX)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The config file has more than %u target firmware rules.", TARGET_FIRMWARE_RULES_MAX);
+			break;
+		}
+
+		// Find the position by the lowest version, the neighbouring rules must not cover any of the versions
+		for (unIndex = s_unTargetFirmwareRules; unIndex > 0 && s_rgsTargetFirmwareRules[unIndex - 1].ullFirst > sRule.ullFirst; unIndex--);
+		if ((unIndex > 0 && s_rgsTargetFirmwareRules[unIndex - 1].ullLast >= sRule.ullFirst) ||
+			(unIndex < s_unTargetFirmwareRules && s_rgsTargetFirmwareRules[unIndex].ullFirst <= sRule.ullLast))
 		{
-			ERROR_STORE(unReturnValue, L"Take Ownership failed!");
+			ERROR_STORE_FMT(unReturnValue, L"The target firmware rule '%ls' overlaps another rule (%ls).", PwszKey, PwszValue);
 			break;
 		}
+
+		for (unSize = s_unTargetFirmwareRules++; unSize > unIndex; unSize--)
+			s_rgsTargetFirmwareRules[unSize] = s_rgsTargetFirmwareRules[unSize - 1];
+		s_rgsTargetFirmwareRules[unIndex] = sRule;
+		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
 
-	// Map return value in case TPM is disabled or deactivated to corresponding tool exit code
-	if ((TPM_DEACTIVATED == (unReturnValue ^ RC_TPM_MASK)) ||
-			(TPM_DISABLED == (unReturnValue ^ RC_TPM_MASK)))
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Finds the target firmware rule covering a TPM firmware version.
+ *	@details	Binary search in the rule table sorted by CommandFlow_TpmUpdate_AddTargetFirmwareRule().
+ *
+ *	@param		PwszVersion				TPM firmware version
+ *
+ *	@returns	The rule covering the version or NULL if no rule covers it.
+ */
+_Check_return_
+static const IfxTargetFirmwareRule*
+CommandFlow_TpmUpdate_FindTargetFirmwareRule(
+	_In_z_ const wchar_t* PwszVersion)
+{
+	unsigned long long ullVersion = 0, ullLast = 0;
+	const wchar_t* pwszEnd = NULL;
+	unsigned int unLow = 0, unHigh = s_unTargetFirmwareRules;
+
+	if (0 == s_unTargetFirmwareRules ||
+		!CommandFlow_TpmUpdate_ParseRuleVersion(PwszVersion, FALSE, &ullVersion, &ullLast, &pwszEnd) ||
+		L'\0' != *pwszEnd)
+		return NULL;
+
+	// Find the first rule starting above the version, the rule before it is the only candidate
+	while (unLow < unHigh)
 	{
-		unReturnValue = RC_E_TPM12_DISABLED_DEACTIVATED;
-		ERROR_STORE(unReturnValue, L"Take Ownership failed!");
+		unsigned int unMiddle = unLow + (unHigh - unLow) / 2;
+		if (s_rgsTargetFirmwareRules[unMiddle].ullFirst <= ullVersion)
+			unLow = unMiddle + 1;
+		else
+			unHigh = unMiddle;
 	}
 
-	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+	if (unLow > 0 && ullVersion <= s_rgsTargetFirmwareRules[unLow - 1].ullLast)
+		return &s_rgsTargetFirmwareRules[unLow - 1];
 
-	return unReturnValue;
+	return NULL;
 }
 
 /**
@@ -840,6 +3802,13 @@ CommandFlow_TpmUpdate_Parse(
 			break;
 		}
 
+		// Section Target Firmware Rules, every setting is a rule whatever its name
+		if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_TARGET_FIRMWARE_RULES, PunSectionSize, TRUE))
+		{
+			unReturnValue = CommandFlow_TpmUpdate_AddTargetFirmwareRule(PwszKey, PwszValue);
+			break;
+		}
+
 		// Section Target Firmware
 		if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_TARGET_FIRMWARE, PunSectionSize, TRUE))
 		{
@@ -908,7 +3877,7 @@ CommandFlow_TpmUpdate_InitializeParsing()
 	unsigned int unReturnValue = RC_SUCCESS;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
-	// Nothing to initialize here
+	s_unTargetFirmwareRules = 0;
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
@@ -946,6 +3915,15 @@ CommandFlow_TpmUpdate_FinalizeParsing(
 
 		while (0 != Platform_StringCompare(prgwszMandatoryProperties[unIndex], L"", RG_LEN(L""), FALSE))
 		{
+			// The target firmware versions are optional if the config file has target firmware rules
+			if (s_unTargetFirmwareRules > 0 &&
+				(0 == Platform_StringCompare(prgwszMandatoryProperties[unIndex], PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC, RG_LEN(PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC), FALSE) ||
+				0 == Platform_StringCompare(prgwszMandatoryProperties[unIndex], PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI, RG_LEN(PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI), FALSE)))
+			{
+				unIndex++;
+				continue;
+			}
+
 			// Check if all mandatory settings were parsed
 			if (!PropertyStorage_ExistsElement(prgwszMandatoryProperties[unIndex]))
 			{
@@ -955,6 +3933,9 @@ CommandFlow_TpmUpdate_FinalizeParsing(
 			}
 			unIndex++;
 		}
+
+		if (RC_SUCCESS == PunReturnValue && s_unTargetFirmwareRules > 0)
+			LOGGING_WRITE_LEVEL2_FMT(L"TPM update config file: %u target firmware rules compiled", s_unTargetFirmwareRules);
 	}
 	WHILE_FALSE_END;
 
@@ -963,6 +3944,242 @@ CommandFlow_TpmUpdate_FinalizeParsing(
 	return PunReturnValue;
 }
 
+/**
+ *	@brief		Prepares the reload of a changed update config section
+ *	@details	Called by Config_Reload for every section changed, added or removed since the config file has been parsed.
+ *				Removes the properties of the section and drops the target firmware rules if their section has changed,
+ *				the settings of the unchanged sections are kept.
+ *
+ *	@param		PwszSection			Pointer to a wide character array containing the section
+ *	@param		PunSectionSize		Size of the section buffer in elements including the zero termination
+ *	@param		PfRemoved			TRUE if the section has been removed from the file
+ *	@param		PpfApply			Receives TRUE if the section is re-ingested
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ */
+_Check_return_
+static unsigned int
+CommandFlow_TpmUpdate_ReloadSection(
+	_In_z_count_(PunSectionSize)	const wchar_t*	PwszSection,
+	_In_							unsigned int	PunSectionSize,
+	_In_							BOOL			PfRemoved,
+	_Out_							BOOL*			PpfApply)
+{
+	const wchar_t* rgwszProperties[2] = {NULL, NULL};
+	unsigned int unIndex = 0;
+
+	*PpfApply = !PfRemoved;
+	if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_UPDATE_TYPE, PunSectionSize, TRUE))
+	{
+		rgwszProperties[0] = PROPERTY_CONFIG_FILE_UPDATE_TYPE12;
+		rgwszProperties[1] = PROPERTY_CONFIG_FILE_UPDATE_TYPE20;
+	}
+	else if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_TARGET_FIRMWARE_RULES, PunSectionSize, TRUE))
+		s_unTargetFirmwareRules = 0;
+	else if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_TARGET_FIRMWARE, PunSectionSize, TRUE))
+	{
+		rgwszProperties[0] = PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC;
+		rgwszProperties[1] = PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI;
+	}
+	else if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_FIRMWARE_FOLDER, PunSectionSize, TRUE))
+		rgwszProperties[0] = PROPERTY_CONFIG_FIRMWARE_FOLDER_PATH;
+	else
+		*PpfApply = FALSE;
+
+	for (unIndex = 0; unIndex < RG_LEN(rgwszProperties) && NULL != rgwszProperties[unIndex]; unIndex++)
+	{
+		if (PropertyStorage_ExistsElement(rgwszProperties[unIndex]))
+			IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(rgwszProperties[unIndex]));
+	}
+	if (*PpfApply || PfRemoved)
+	{
+		LOGGING_WRITE_LEVEL2_FMT(L"TPM update config file: section [%ls] %ls", PwszSection, PfRemoved ? L"removed" : L"reloaded");
+	}
+
+	return RC_SUCCESS;
+}
+
+/**
+ *	@brief		Drops the settings of the parsed update config file
+ *	@details	Used before a config file is parsed from scratch.
+ */
+static void
+CommandFlow_TpmUpdate_ResetConfig()
+{
+	const wchar_t* const rgwszProperties[] =
+	{
+		PROPERTY_CONFIG_FILE_UPDATE_TYPE12,
+		PROPERTY_CONFIG_FILE_UPDATE_TYPE20,
+		PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC,
+		PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI,
+		PROPERTY_CONFIG_FIRMWARE_FOLDER_PATH
+	};
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < RG_LEN(rgwszProperties); unIndex++)
+	{
+		if (PropertyStorage_ExistsElement(rgwszProperties[unIndex]))
+			IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(rgwszProperties[unIndex]));
+	}
+	FileIO_WatchClose(&s_pvParsedConfigWatch);
+	IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sParsedConfigDigest, 0, sizeof(s_sParsedConfigDigest)));
+	s_wszParsedConfigFile[0] = L'\0';
+	s_unTargetFirmwareRules = 0;
+	s_fConfigFileParsed = FALSE;
+}
+
+/**
+ *	@brief		Finds a chain of firmware images in the firmware folder leading from the running to the target firmware.
+ *	@details	Used if the firmware folder holds neither the firmware image of the direct update path nor a firmware image
+ *				bundle. The file names follow TPM_FIRMWARE_FILE_NAME_PATTERN, so the folder listing tells the update paths
+ *				without loading any image. The chain with the fewest firmware images (at most UPDATE_CHAIN_MAX_HOPS) is
+ *				selected. Only a local firmware folder can be listed.
+ *
+ *	@param		PwszFolder				Firmware folder
+ *	@param		PwszSource				Family and version of the running firmware (e.g. TPM20_7.63.3353.0)
+ *	@param		PwszTarget				Family and version of the target firmware
+ *	@param		PwszFirstImage			Receives the file name of the first firmware image of the chain
+ *	@param		PunFirstImageSize		Capacity of PwszFirstImage in characters
+ *	@param		PwszSecondImage			Receives the file name of the second firmware image of the chain, empty for a single image
+ *	@param		PunSecondImageSize		Capacity of PwszSecondImage in characters
+ *	@param		PpunHops				Receives the number of firmware images of the chain
+ *
+ *	@retval		RC_SUCCESS						The operation completed successfully.
+ *	@retval		RC_E_FIRMWARE_UPDATE_NOT_FOUND	No chain of firmware images leads to the target firmware.
+ *	@retval		...								Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_FindUpdateChain(
+	_In_z_							const wchar_t*	PwszFolder,
+	_In_z_							const wchar_t*	PwszSource,
+	_In_z_							const wchar_t*	PwszTarget,
+	_Out_z_cap_(PunFirstImageSize)	wchar_t*		PwszFirstImage,
+	_In_							unsigned int	PunFirstImageSize,
+	_Out_z_cap_(PunSecondImageSize)	wchar_t*		PwszSecondImage,
+	_In_							unsigned int	PunSecondImageSize,
+	_Out_							unsigned int*	PpunHops)
+{
+	unsigned int unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+	wchar_t* wszFileNames = NULL;
+	IfxUpdateChainImage* rgsImages = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		unsigned int unFileNamesSize = UPDATE_CHAIN_FILE_NAMES_SIZE;
+		unsigned int unFileCount = 0;
+		unsigned int unOffset = 0;
+		unsigned int unFile = 0;
+		unsigned int unImages = 0;
+		unsigned int unIndex = 0;
+		unsigned int rgunQueue[UPDATE_CHAIN_MAX_IMAGES];
+		unsigned int unQueueHead = 0;
+		unsigned int unQueueLength = 0;
+
+		*PpunHops = 0;
+		PwszSecondImage[0] = L'\0';
+
+		if (FileIO_IsUrl(PwszFolder) || FALSE == FileIO_IsDirectory(PwszFolder))
+			break;
+
+		wszFileNames = (wchar_t*)Platform_MemoryAllocateZero(UPDATE_CHAIN_FILE_NAMES_SIZE * sizeof(wchar_t));
+		rgsImages = (IfxUpdateChainImage*)Platform_MemoryAllocateZero(UPDATE_CHAIN_MAX_IMAGES * sizeof(IfxUpdateChainImage));
+		if (NULL == wszFileNames || NULL == rgsImages)
+		{
+			unReturnValue = RC_E_FAIL;
+			break;
+		}
+
+		unReturnValue = FileIO_ListDirectory(PwszFolder, wszFileNames, &unFileNamesSize, &unFileCount);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+
+		// Take source and target of each firmware image from its file name
+		for (unFile = 0; unFile < unFileCount && unImages < UPDATE_CHAIN_MAX_IMAGES; unFile++)
+		{
+			const wchar_t* wszName = wszFileNames + unOffset;
+			const wchar_t* pwszSeparator = NULL;
+			const wchar_t* pwszExtension = NULL;
+			IfxUpdateChainImage* psImage = &rgsImages[unImages];
+			unsigned int unSourceSize = RG_LEN(psImage->wszSource);
+			unsigned int unTargetSize = RG_LEN(psImage->wszTarget);
+			unsigned int unNameLength = 0;
+
+			IGNORE_RETURN_VALUE(Platform_StringGetLength(wszName, unFileNamesSize - unOffset, &unNameLength));
+			unOffset += unNameLength + 1;
+
+			// <source family>_<source version>_to_<target family>_<target version>.BIN
+			pwszSeparator = wcsstr(wszName, L"_to_");
+			if (NULL == pwszSeparator || unNameLength < RG_LEN(L".BIN"))
+				continue;
+			pwszExtension = &wszName[unNameLength - (RG_LEN(L".BIN") - 1)];
+			if (0 != Platform_StringCompare(pwszExtension, L".BIN", RG_LEN(L".BIN"), TRUE) ||
+					RC_SUCCESS != Platform_StringFormat(psImage->wszSource, &unSourceSize, L"%.*ls", (int)(pwszSeparator - wszName), wszName))
+				continue;
+			pwszSeparator += RG_LEN(L"_to_") - 1;
+			if (pwszExtension <= pwszSeparator ||
+					RC_SUCCESS != Platform_StringFormat(psImage->wszTarget, &unTargetSize, L"%.*ls", (int)(pwszExtension - pwszSeparator), pwszSeparator))
+				continue;
+			psImage->pwszFileName = wszName;
+			psImage->unPrevious = UPDATE_CHAIN_NONE;
+			unImages++;
+		}
+
+		// Breadth first search from the running firmware, so the first chain reaching the target is a shortest one
+		for (unIndex = 0; unIndex < unImages; unIndex++)
+		{
+			if (0 == Platform_StringCompare(rgsImages[unIndex].wszSource, PwszSource, MAX_NAME, FALSE))
+			{
+				rgsImages[unIndex].unHops = 1;
+				rgunQueue[unQueueLength++] = unIndex;
+			}
+		}
+		while (unQueueHead < unQueueLength)
+		{
+			const IfxUpdateChainImage* psImage = &rgsImages[rgunQueue[unQueueHead++]];
+
+			if (0 == Platform_StringCompare(psImage->wszTarget, PwszTarget, MAX_NAME, FALSE))
+			{
+				const IfxUpdateChainImage* psSecondImage = NULL;
+
+				*PpunHops = psImage->unHops;
+				while (UPDATE_CHAIN_NONE != psImage->unPrevious)
+				{
+					psSecondImage = psImage;
+					psImage = &rgsImages[psImage->unPrevious];
+				}
+				unReturnValue = Platform_StringCopy(PwszFirstImage, &PunFirstImageSize, psImage->pwszFileName);
+				if (RC_SUCCESS == unReturnValue && NULL != psSecondImage)
+					unReturnValue = Platform_StringCopy(PwszSecondImage, &PunSecondImageSize, psSecondImage->pwszFileName);
+				break;
+			}
+			if (UPDATE_CHAIN_MAX_HOPS <= psImage->unHops)
+				continue;
+
+			for (unIndex = 0; unIndex < unImages; unIndex++)
+			{
+				if (0 == rgsImages[unIndex].unHops &&
+						0 == Platform_StringCompare(rgsImages[unIndex].wszSource, psImage->wszTarget, MAX_NAME, FALSE))
+				{
+					rgsImages[unIndex].unHops = psImage->unHops + 1;
+					rgsImages[unIndex].unPrevious = (unsigned int)(psImage - rgsImages);
+					rgunQueue[unQueueLength++] = unIndex;
+				}
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&rgsImages);
+	Platform_MemoryFree((void**)&wszFileNames);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Parse the update config settings file
  *	@details
@@ -988,6 +4205,8 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 	{
 		wchar_t wszConfigFilePath[MAX_STRING_1024] = {0};
 		unsigned int unConfigFileNamePathSize = RG_LEN(wszConfigFilePath);
+		unsigned long long ullTime = 0;
+		IfxPhaseLoad sLoad;
 
 		// Check parameters
 		if (NULL == PpTpmUpdate || PpTpmUpdate->unType != STRUCT_TYPE_TpmUpdate || PpTpmUpdate->unSize != sizeof(IfxUpdate))
@@ -1001,6 +4220,17 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 		PpTpmUpdate->unSubType = STRUCT_SUBTYPE_IS_UPDATABLE;
 		PpTpmUpdate->unNewFirmwareValid = GENERIC_TRISTATE_STATE_NA;
 		PpTpmUpdate->unReturnCode = RC_E_FAIL;
+		s_unUpdateChainRemaining = 0;
+		s_wszUpdateChainNextImage[0] = L'\0';
+
+		// The previous firmware update of a chain must have changed the firmware version
+		if (L'\0' != s_wszUpdateChainPreviousVersion[0] &&
+				0 == Platform_StringCompare(s_wszUpdateChainPreviousVersion, PpTpmUpdate->wszVersionName, RG_LEN(s_wszUpdateChainPreviousVersion), FALSE))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"The TPM firmware version (%ls) did not change with the previous firmware update of the chain.", PpTpmUpdate->wszVersionName);
+			break;
+		}
 
 		// Get config file path from property storage
 		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_CONFIG_FILE_PATH, wszConfigFilePath, &unConfigFileNamePathSize))
@@ -1018,16 +4248,79 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 			break;
 		}
 
+		// Another config file than the parsed one is parsed from scratch
+		if (s_fConfigFileParsed && 0 != Platform_StringCompare(s_wszParsedConfigFile, wszConfigFilePath, RG_LEN(s_wszParsedConfigFile), FALSE))
+			CommandFlow_TpmUpdate_ResetConfig();
+
+		// The further updates of a chain and the further requests of the service keep the parsed settings, only the
+		// sections changed since then are reloaded
+		if (s_fConfigFileParsed && FileIO_WatchChanged(s_pvParsedConfigWatch))
+		{
+			unsigned int unReloaded = 0;
+
+			if (!s_sParsedConfigDigest.fValid)
+				CommandFlow_TpmUpdate_ResetConfig();
+			else
+			{
+				ullTime = Platform_GetMonotonicTimeMicroSeconds();
+				DeviceManagement_StartPhaseLoad(&sLoad);
+				unReturnValue = Config_Reload(wszConfigFilePath, &s_sParsedConfigDigest, &CommandFlow_TpmUpdate_ReloadSection, &CommandFlow_TpmUpdate_Parse, &unReloaded);
+				unReturnValue = CommandFlow_TpmUpdate_FinalizeParsing(unReturnValue);
+				PpTpmUpdate->sTimings.ullConfigTime += Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+				DeviceManagement_StopPhaseLoad(&sLoad);
+				PpTpmUpdate->sCpuTimings.ullConfigTime += sLoad.ullCpuTime;
+				PpTpmUpdate->sWaitTimings.ullConfigTime += sLoad.ullWaitTime;
+				Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"config file reload", ullTime, Platform_GetMonotonicTimeMicroSeconds() - ullTime, NULL);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					CommandFlow_TpmUpdate_ResetConfig();
+					ERROR_STORE(unReturnValue, L"Error while reloading the config file of the config option.");
+					break;
+				}
+				LOGGING_WRITE_LEVEL1_FMT(L"The config file '%ls' has changed, %u sections reloaded.", wszConfigFilePath, unReloaded);
+			}
+		}
+
 		// Parse config file using the config module
-		unReturnValue = Config_ParseCustom(
-							wszConfigFilePath,
-							&CommandFlow_TpmUpdate_InitializeParsing,
-							&CommandFlow_TpmUpdate_FinalizeParsing,
-							&CommandFlow_TpmUpdate_Parse);
-		if (RC_SUCCESS != unReturnValue)
+		if (!s_fConfigFileParsed)
 		{
-			ERROR_STORE(unReturnValue, L"Error while parsing the config file of the config option.");
-			break;
+			unsigned int unParsedConfigFileSize = RG_LEN(s_wszParsedConfigFile);
+			unsigned int unReloaded = 0;
+
+			// Watch the file before parsing it, so that no change gets lost
+			CommandFlow_TpmUpdate_ResetConfig();
+			if (RC_SUCCESS != FileIO_WatchOpen(wszConfigFilePath, &s_pvParsedConfigWatch))
+			{
+				LOGGING_WRITE_LEVEL2_FMT(L"The config file '%ls' cannot be watched for changes.", wszConfigFilePath);
+			}
+
+			ullTime = Platform_GetMonotonicTimeMicroSeconds();
+			DeviceManagement_StartPhaseLoad(&sLoad);
+			unReturnValue = Config_ParseCustom(
+								wszConfigFilePath,
+								&CommandFlow_TpmUpdate_InitializeParsing,
+								&CommandFlow_TpmUpdate_FinalizeParsing,
+								&CommandFlow_TpmUpdate_Parse);
+			PpTpmUpdate->sTimings.ullConfigTime += Platform_GetMonotonicTimeMicroSeconds() - ullTime;
+			DeviceManagement_StopPhaseLoad(&sLoad);
+			PpTpmUpdate->sCpuTimings.ullConfigTime += sLoad.ullCpuTime;
+			PpTpmUpdate->sWaitTimings.ullConfigTime += sLoad.ullWaitTime;
+			Trace_WriteSpan(TRACE_CATEGORY_PHASE, L"config file", ullTime, Platform_GetMonotonicTimeMicroSeconds() - ullTime, NULL);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				CommandFlow_TpmUpdate_ResetConfig();
+				ERROR_STORE(unReturnValue, L"Error while parsing the config file of the config option.");
+				break;
+			}
+
+			// Take the section digests for the reload, without them a change is parsed from scratch again
+			if (RC_SUCCESS != Config_Reload(wszConfigFilePath, &s_sParsedConfigDigest, NULL, NULL, &unReloaded))
+			{
+				LOGGING_WRITE_LEVEL2_FMT(L"The sections of the config file '%ls' cannot be reloaded separately.", wszConfigFilePath);
+				Error_ClearStack();
+			}
+			IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszParsedConfigFile, &unParsedConfigFileSize, wszConfigFilePath));
+			s_fConfigFileParsed = TRUE;
 		}
 
 		{
@@ -1041,38 +4334,53 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 			wchar_t wszTargetFamily[MAX_NAME] = {0};
 			unsigned int unTargetFamilySize = RG_LEN(wszTargetFamily);
 			ENUM_UPDATE_TYPES unUpdateType = UPDATE_TYPE_NONE;
+			const IfxTargetFirmwareRule* pTargetFirmwareRule = NULL;
+			const wchar_t* pwszTargetVersionProperty = NULL;
 
 			#define TPM_FIRMWARE_FILE_NAME_PATTERN L"%ls_%ls_to_%ls_%ls.BIN"
 
 			if (!PpTpmUpdate->sTpmState.attribs.bootLoader)
 			{
-				// Check if TPM is SPI or LPC
-				if ((PpTpmUpdate->wszVersionName[0] == L'6' || PpTpmUpdate->wszVersionName[0] == L'7') && PpTpmUpdate->wszVersionName[1] == L'.')
+				// A target firmware rule covering the TPM firmware version takes precedence
+				pTargetFirmwareRule = CommandFlow_TpmUpdate_FindTargetFirmwareRule(PpTpmUpdate->wszVersionName);
+				if (NULL != pTargetFirmwareRule)
 				{
-					// Get Target Version String
-					if (!PropertyStorage_GetValueByKey(PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI, wszTargetVersion, &unTargetVersionSize))
+					unReturnValue = Platform_StringCopy(wszTargetVersion, &unTargetVersionSize, pTargetFirmwareRule->wszTargetVersion);
+					if (RC_SUCCESS != unReturnValue)
 					{
-						unReturnValue = RC_E_FAIL;
-						ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI);
+						ERROR_STORE(unReturnValue, L"Platform_StringCopy failed while copying the target version of the target firmware rule.");
 						break;
 					}
+					LOGGING_WRITE_LEVEL2_FMT(L"Target firmware rule selects version %ls for TPM firmware version %ls", wszTargetVersion, PpTpmUpdate->wszVersionName);
 				}
-				else if ((PpTpmUpdate->wszVersionName[0] == L'4' || PpTpmUpdate->wszVersionName[0] == L'5') && PpTpmUpdate->wszVersionName[1] == L'.')
+				else
 				{
-					// Get Target Version String
-					if (!PropertyStorage_GetValueByKey(PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC, wszTargetVersion, &unTargetVersionSize))
+					// Check if TPM is SPI or LPC
+					if ((PpTpmUpdate->wszVersionName[0] == L'6' || PpTpmUpdate->wszVersionName[0] == L'7') && PpTpmUpdate->wszVersionName[1] == L'.')
+						pwszTargetVersionProperty = PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_SPI;
+					else if ((PpTpmUpdate->wszVersionName[0] == L'4' || PpTpmUpdate->wszVersionName[0] == L'5') && PpTpmUpdate->wszVersionName[1] == L'.')
+						pwszTargetVersionProperty = PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC;
+					else
 					{
+						unReturnValue = RC_E_UNSUPPORTED_CHIP;
+						ERROR_STORE_FMT(unReturnValue, L"The detected TPM version (%ls) is not supported.", PpTpmUpdate->wszVersionName);
+						break;
+					}
+
+					// Get Target Version String, it is optional if the config file has target firmware rules
+					if (!PropertyStorage_GetValueByKey(pwszTargetVersionProperty, wszTargetVersion, &unTargetVersionSize))
+					{
+						if (s_unTargetFirmwareRules > 0 && !PropertyStorage_ExistsElement(pwszTargetVersionProperty))
+						{
+							unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+							ERROR_STORE_FMT(unReturnValue, L"No target firmware rule of the config file covers the TPM firmware version (%ls).", PpTpmUpdate->wszVersionName);
+							break;
+						}
 						unReturnValue = RC_E_FAIL;
-						ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", PROPERTY_CONFIG_TARGET_FIRMWARE_VERSION_LPC);
+						ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetValueByKey failed to get property '%ls'.", pwszTargetVersionProperty);
 						break;
 					}
 				}
-				else
-				{
-					unReturnValue = RC_E_UNSUPPORTED_CHIP;
-					ERROR_STORE_FMT(unReturnValue, L"The detected TPM version (%ls) is not supported.", PpTpmUpdate->wszVersionName);
-					break;
-				}
 
 				// Check if firmware is already up to date
 				if (0 == Platform_StringCompare(wszTargetVersion, PpTpmUpdate->wszVersionName, unTargetFamilySize, FALSE))
@@ -1141,71 +4449,146 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 					break;
 				}
 
-				// Compose firmware folder
+				// The firmware image file name of a target firmware rule replaces the naming convention
+				if (NULL != pTargetFirmwareRule && L'\0' != pTargetFirmwareRule->wszFirmwareImage[0])
 				{
-					wchar_t wszFirmwareFilePath[MAX_STRING_1024] = {0};
-					unsigned int unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
-					unsigned int unIndex = 0, unLastFolderIndex = 0;
-
-					// Copy config file path to destination buffer
-					unReturnValue = Platform_StringCopy(wszFirmwareFilePath, &unFirmwareFilePathSize, wszConfigFilePath);
+					unUsedFirmwareImageSize = RG_LEN(PpTpmUpdate->wszUsedFirmwareImage);
+					unReturnValue = Platform_StringCopy(PpTpmUpdate->wszUsedFirmwareImage, &unUsedFirmwareImageSize, pTargetFirmwareRule->wszFirmwareImage);
 					if (RC_SUCCESS != unReturnValue)
 					{
-						ERROR_STORE(unReturnValue, L"Platform_StringCopy returned an unexpected value.");
+						ERROR_STORE(unReturnValue, L"Platform_StringCopy failed while copying the firmware image file name of the target firmware rule.");
 						break;
 					}
+				}
 
-					// Cut off file part
-					for (unIndex = 0; unIndex < unFirmwareFilePathSize; unIndex++)
-					{
-						if (wszFirmwareFilePath[unIndex] == L'\\' ||
-							wszFirmwareFilePath[unIndex] == L'/')
-							unLastFolderIndex = unIndex;
-					}
+				// Compose firmware folder
+				{
+					wchar_t wszFirmwareFilePath[MAX_STRING_1024] = {0};
+					unsigned int unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
+					wchar_t wszFirmwareBundlePath[MAX_STRING_1024] = {0};
+					wchar_t wszFirmwareFolder[MAX_STRING_1024] = {0};
+					unsigned int unFirmwareFolderSize = RG_LEN(wszFirmwareFolder);
+					unsigned int unIndex = 0, unLastFolderIndex = 0;
+					IfxStringBuilder sFirmwareFilePath, sFirmwareBundlePath;
 
-					// Check if index is zero means only cfg file name given or config file name in Linux root
-					if (unLastFolderIndex == 0)
+					// Find the file part of the config file path
+					for (unIndex = 0; L'\0' != wszConfigFilePath[unIndex]; unIndex++)
 					{
-						// If cfg file is placed in Linux root only remove the name not the root slash otherwize add a relative folder "." at the beginning
-						if (wszFirmwareFilePath[unLastFolderIndex] == L'/')
-							unLastFolderIndex++;
-						else
-							wszFirmwareFilePath[unLastFolderIndex++] = L'.';
+						if (wszConfigFilePath[unIndex] == L'\\' ||
+							wszConfigFilePath[unIndex] == L'/')
+							unLastFolderIndex = unIndex;
 					}
 
-					// Set string zero termination
-					wszFirmwareFilePath[unLastFolderIndex] = L'\0';
+					// Start with the folder of the config file, a firmware folder URL is used as is
+					Platform_StringBuilderInitialize(&sFirmwareFilePath, wszFirmwareFilePath, RG_LEN(wszFirmwareFilePath));
+					if (FileIO_IsUrl(wszConfigSettingFirmwarePath))
+						IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sFirmwareFilePath, wszConfigSettingFirmwarePath));
+					else if (0 != unLastFolderIndex)
+						IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sFirmwareFilePath, L"%.*ls", (int)unLastFolderIndex, wszConfigFilePath));
+					// Only cfg file name given or config file name in Linux root: keep the root slash, otherwise use the relative folder "."
+					else
+						IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sFirmwareFilePath, L'/' == wszConfigFilePath[0] ? L"/" : L"."));
 
 					// Check if config setting firmware path is not the actual folder
-					if (0 != Platform_StringCompare(wszConfigSettingFirmwarePath, L".", RG_LEN(L"."), FALSE) &&
+					if (!FileIO_IsUrl(wszConfigSettingFirmwarePath) &&
+						0 != Platform_StringCompare(wszConfigSettingFirmwarePath, L".", RG_LEN(L"."), FALSE) &&
 						0 != Platform_StringCompare(wszConfigSettingFirmwarePath, L"./", RG_LEN(L"./"), FALSE) &&
 						0 != Platform_StringCompare(wszConfigSettingFirmwarePath, L".\\", RG_LEN(L".\\"), FALSE))
 					{
 						// If so add the config setting firmware folder path to the cfg file folder part
-						unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
-						unReturnValue = Platform_StringConcatenatePaths(wszFirmwareFilePath, &unFirmwareFilePathSize, wszConfigSettingFirmwarePath);
-						if (RC_SUCCESS != unReturnValue)
-						{
-							ERROR_STORE(unReturnValue, L"Platform_StringConcatenate returned an unexpected value while composing the firmware image file path.");
-							break;
-						}
+						IGNORE_RETURN_VALUE(Platform_StringBuilderAppendPath(&sFirmwareFilePath, wszConfigSettingFirmwarePath));
 					}
 
+					// Keep the composed folder for the firmware image bundle file and an update chain
+					Platform_StringBuilderInitialize(&sFirmwareBundlePath, wszFirmwareBundlePath, RG_LEN(wszFirmwareBundlePath));
+					IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(&sFirmwareBundlePath, wszFirmwareFilePath));
+					IGNORE_RETURN_VALUE(Platform_StringCopy(wszFirmwareFolder, &unFirmwareFolderSize, wszFirmwareFilePath));
+
 					// Add the filled firmware file name template to the composed folder
-					unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
-					unReturnValue = Platform_StringConcatenatePaths(wszFirmwareFilePath, &unFirmwareFilePathSize, PpTpmUpdate->wszUsedFirmwareImage);
+					unReturnValue = Platform_StringBuilderAppendPath(&sFirmwareFilePath, PpTpmUpdate->wszUsedFirmwareImage);
 					if (RC_SUCCESS != unReturnValue)
 					{
-						ERROR_STORE(unReturnValue, L"Platform_StringConcatenate returned an unexpected value while composing the firmware image file path.");
+						ERROR_STORE(unReturnValue, L"Platform_StringBuilderAppendPath returned an unexpected value while composing the firmware image file path.");
 						break;
 					}
 
-					// Check if firmware image exists
+					// Check if firmware image exists, otherwise look for the update path in the firmware image bundle file
 					if (!FileIO_Exists(wszFirmwareFilePath))
 					{
-						unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
-						ERROR_STORE_FMT(unReturnValue, L"No firmware image found to update the current TPM firmware. (%ls)", wszFirmwareFilePath);
-						break;
+						unsigned int unBundleTargetVersionSize = RG_LEN(s_wszBundleTargetVersion);
+
+						unReturnValue = Platform_StringBuilderAppendPath(&sFirmwareBundlePath, TPM_FIRMWARE_BUNDLE_FILE_NAME);
+						if (RC_SUCCESS != unReturnValue)
+						{
+							ERROR_STORE(unReturnValue, L"Platform_StringBuilderAppendPath returned an unexpected value while composing the firmware image bundle file path.");
+							break;
+						}
+						if (!FileIO_Exists(wszFirmwareBundlePath))
+						{
+							wchar_t wszSource[MAX_NAME] = {0};
+							unsigned int unSourceSize = RG_LEN(wszSource);
+							wchar_t wszTarget[MAX_NAME] = {0};
+							unsigned int unTargetSize = RG_LEN(wszTarget);
+							wchar_t wszFirstImage[MAX_NAME] = {0};
+							wchar_t wszSecondImage[MAX_NAME] = {0};
+							unsigned int unHops = 0;
+
+							// Several firmware images of the folder may lead to the target firmware one after the other
+							if (RC_SUCCESS != Platform_StringFormat(wszSource, &unSourceSize, L"%ls_%ls", wszSourceFamily, PpTpmUpdate->wszVersionName) ||
+									RC_SUCCESS != Platform_StringFormat(wszTarget, &unTargetSize, L"%ls_%ls", wszTargetFamily, wszTargetVersion) ||
+									RC_SUCCESS != CommandFlow_TpmUpdate_FindUpdateChain(wszFirmwareFolder, wszSource, wszTarget, wszFirstImage, RG_LEN(wszFirstImage), wszSecondImage, RG_LEN(wszSecondImage), &unHops))
+							{
+								unReturnValue = RC_E_FIRMWARE_UPDATE_NOT_FOUND;
+								ERROR_STORE_FMT(unReturnValue, L"No firmware image found to update the current TPM firmware. (%ls)", wszFirmwareFilePath);
+								break;
+							}
+							LOGGING_WRITE_LEVEL2_FMT(L"Updating to %ls through %u firmware images, starting with '%ls'.", wszTarget, unHops, wszFirstImage);
+
+							unUsedFirmwareImageSize = RG_LEN(PpTpmUpdate->wszUsedFirmwareImage);
+							unReturnValue = Platform_StringCopy(PpTpmUpdate->wszUsedFirmwareImage, &unUsedFirmwareImageSize, wszFirstImage);
+							if (RC_SUCCESS == unReturnValue)
+							{
+								unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
+								unReturnValue = Platform_StringCopy(wszFirmwareFilePath, &unFirmwareFilePathSize, wszFirmwareFolder);
+							}
+							if (RC_SUCCESS == unReturnValue)
+							{
+								unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
+								unReturnValue = Platform_StringConcatenatePaths(wszFirmwareFilePath, &unFirmwareFilePathSize, wszFirstImage);
+							}
+							if (RC_SUCCESS != unReturnValue)
+							{
+								ERROR_STORE(unReturnValue, L"Composing the path of the first firmware image of the update chain failed.");
+								break;
+							}
+							s_unUpdateChainRemaining = unHops - 1;
+
+							// The next firmware image is loaded while the firmware block of this one is transferred
+							if (L'\0' != wszSecondImage[0])
+							{
+								unsigned int unNextImageSize = RG_LEN(s_wszUpdateChainNextImage);
+								if (RC_SUCCESS != Platform_StringCopy(s_wszUpdateChainNextImage, &unNextImageSize, wszFirmwareFolder) ||
+										RC_SUCCESS != Platform_StringConcatenatePaths(s_wszUpdateChainNextImage, &unNextImageSize, wszSecondImage))
+									s_wszUpdateChainNextImage[0] = L'\0';
+							}
+						}
+						else
+						{
+							// The firmware image of the update path is selected from the bundle when the image is loaded
+							unReturnValue = Platform_StringCopy(s_wszBundleTargetVersion, &unBundleTargetVersionSize, wszTargetVersion);
+							if (RC_SUCCESS != unReturnValue)
+							{
+								ERROR_STORE(unReturnValue, L"Platform_StringCopy returned an unexpected value.");
+								break;
+							}
+							unFirmwareFilePathSize = RG_LEN(wszFirmwareFilePath);
+							unReturnValue = Platform_StringCopy(wszFirmwareFilePath, &unFirmwareFilePathSize, wszFirmwareBundlePath);
+							if (RC_SUCCESS != unReturnValue)
+							{
+								ERROR_STORE(unReturnValue, L"Platform_StringCopy returned an unexpected value.");
+								break;
+							}
+						}
 					}
 
 					// Set property storage attributes
@@ -1252,8 +4635,23 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 			else
 			{
 				// Config-file properties will not be evaluated if TPM is in boot loader mode
-				// Instead the firmware image from TPM_FACTORY_UPD_RUNDATA_FILE will be used.
-				if (FileIO_Exists(TPM_FACTORY_UPD_RUNDATA_FILE))
+				// Instead the firmware image from the update journal or TPM_FACTORY_UPD_RUNDATA_FILE will be used.
+				if (TRUE == s_fUpdateJournalValid)
+				{
+					unsigned int unBundleVersionSize = RG_LEN(s_wszBundleSourceVersion);
+					IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszBundleSourceVersion, &unBundleVersionSize, s_sUpdateJournal.wszBundleSourceVersion));
+					unBundleVersionSize = RG_LEN(s_wszBundleTargetVersion);
+					IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszBundleTargetVersion, &unBundleVersionSize, s_sUpdateJournal.wszBundleTargetVersion));
+
+					// Set the firmware file path
+					if (!PropertyStorage_AddKeyValuePair(PROPERTY_FIRMWARE_PATH, s_sUpdateJournal.wszFirmwarePath))
+					{
+						unReturnValue = RC_E_FAIL;
+						ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_AddKeyValuePair failed to add property '%ls'.", PROPERTY_FIRMWARE_PATH);
+						break;
+					}
+				}
+				else if (FileIO_Exists(TPM_FACTORY_UPD_RUNDATA_FILE))
 				{
 					wchar_t* pwszFirmwareImage = NULL;
 					unsigned int unFirmwareImageSize = 0;
@@ -1281,6 +4679,21 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 						Platform_MemoryFree((void**)&pwszLine);
 						break;
 					}
+
+					// A firmware image bundle is followed by the source and target version of the interrupted update path
+					{
+						wchar_t* pwszVersion = NULL;
+						unsigned int unVersionSize = 0;
+						unsigned int unBundleVersionSize = RG_LEN(s_wszBundleSourceVersion);
+
+						if (RC_SUCCESS == Utility_StringGetLine(pwszFirmwareImage, unFirmwareImageSize, &unIndex, &pwszVersion, &unVersionSize))
+							IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszBundleSourceVersion, &unBundleVersionSize, pwszVersion));
+						Platform_MemoryFree((void**)&pwszVersion);
+						unBundleVersionSize = RG_LEN(s_wszBundleTargetVersion);
+						if (RC_SUCCESS == Utility_StringGetLine(pwszFirmwareImage, unFirmwareImageSize, &unIndex, &pwszVersion, &unVersionSize))
+							IGNORE_RETURN_VALUE(Platform_StringCopy(s_wszBundleTargetVersion, &unBundleVersionSize, pwszVersion));
+						Platform_MemoryFree((void**)&pwszVersion);
+					}
 					Platform_MemoryFree((void**)&pwszFirmwareImage);
 
 					// Set the firmware file path
@@ -1297,11 +4710,14 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 				{
 					// Cannot resume the firmware update without TPM_FACTORY_UPD_RUNDATA_FILE
 					unReturnValue = RC_E_RESUME_RUNDATA_NOT_FOUND;
-					ERROR_STORE_FMT(unReturnValue, L"File '%s' is missing. This file is required to resume firmware update in interrupted firmware mode.", TPM_FACTORY_UPD_RUNDATA_FILE);
+					ERROR_STORE_FMT(unReturnValue, L"File '%ls' is missing. This file is required to resume firmware update in interrupted firmware mode.", TPM_FACTORY_UPD_RUNDATA_FILE);
 					break;
 				}
 			}
 
+			// Use a downloaded firmware image from the image cache folder
+			CommandFlow_TpmUpdate_ResolveImageCache();
+
 			PpTpmUpdate->unReturnCode = RC_SUCCESS;
 			unReturnValue = RC_SUCCESS;
 		}
@@ -1312,3 +4728,63 @@ CommandFlow_TpmUpdate_ProceedUpdateConfig(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Prepares the next firmware update of a chain planned by CommandFlow_TpmUpdate_ProceedUpdateConfig().
+ *	@details	Called after a successful firmware update. If the config file needs further firmware updates to reach the
+ *				target firmware, the loaded firmware image and the state of the completed update are released, so the
+ *				caller can read the TPM state again and continue with CommandFlow_TpmUpdate_ProceedUpdateConfig(). The
+ *				device connection, the parsed config file and the caches are kept. A dry run does not change the firmware
+ *				and therefore ends after the first update.
+ *
+ *	@param		PpTpmUpdate				Pointer to the IfxUpdate structure of the completed firmware update
+ *	@param		PpfNextUpdate			Receives TRUE if another firmware update follows
+ */
+void
+CommandFlow_TpmUpdate_PrepareNextUpdate(
+	_Inout_	IfxUpdate*	PpTpmUpdate,
+	_Out_	BOOL*		PpfNextUpdate)
+{
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		BOOL fDryRun = FALSE;
+		unsigned int unVersionSize = RG_LEN(s_wszUpdateChainPreviousVersion);
+
+		*PpfNextUpdate = FALSE;
+
+		if (0 == s_unUpdateChainRemaining ||
+				RC_SUCCESS != PpTpmUpdate->unReturnCode ||
+				TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT))
+			break;
+		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_DRY_RUN, &fDryRun) && TRUE == fDryRun)
+		{
+			LOGGING_WRITE_LEVEL2_FMT(L"Dry run: skipping the remaining %u firmware updates of the chain.", s_unUpdateChainRemaining);
+			break;
+		}
+
+		// Only the state of the completed update is dropped
+		if (RC_SUCCESS != Platform_StringCopy(s_wszUpdateChainPreviousVersion, &unVersionSize, PpTpmUpdate->wszVersionName) ||
+				!PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_UPDATE_TYPE, UPDATE_TYPE_CONFIG_FILE))
+			break;
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_FIRMWARE_PATH));
+		FirmwareImage_ReleaseBundleImage(PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize, &PpTpmUpdate->rgbFirmwareImage);
+		Platform_MemoryFree((void**)&PpTpmUpdate->rgbStreamLeafDigests);
+		FileIO_ReleaseFileBuffer(&PpTpmUpdate->rgbFirmwareFile, PpTpmUpdate->unFirmwareFileSize, PpTpmUpdate->fFirmwareImageMapped);
+		IGNORE_RETURN_VALUE(Platform_MemorySet(PpTpmUpdate, 0, sizeof(IfxUpdate)));
+		s_wszBundleSourceVersion[0] = L'\0';
+		s_wszBundleTargetVersion[0] = L'\0';
+		s_fUpdateThroughBundle = FALSE;
+
+		// The firmware version, the field upgrade counter and the TPM mode changed
+		FirmwareUpdate_InvalidateState();
+		CommandFlow_TpmInfo_InvalidateCache();
+
+		LOGGING_WRITE_LEVEL2_FMT(L"Continuing with the next of %u remaining firmware updates of the chain.", s_unUpdateChainRemaining);
+		*PpfNextUpdate = TRUE;
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_EXIT_STRING);
+}
@@ -21,6 +21,36 @@
 extern "C" {
 #endif
 
+/// Firmware image verification cache file used by the -verify-cache command line option
+#define TPM_FACTORY_UPD_VERIFY_CACHE_FILE L"/var/cache/TPMFactoryUpd_VerifyCache.bin"
+/// Folder keeping downloaded firmware images for the -verify-cache command line option, named by their SHA-256 digest
+#define TPM_FACTORY_UPD_IMAGE_CACHE_FOLDER L"/var/cache/TPMFactoryUpd_Images"
+/// Prefix of the update plan files written by the -prepare command line option (followed by the TPM device path)
+#define TPM_FACTORY_UPD_PLAN_FILE_PREFIX L"/var/cache/TPMFactoryUpd_Plan"
+/// Prefix of the update journal files written before a firmware update is started (followed by the TPM device path)
+#define TPM_FACTORY_UPD_JOURNAL_FILE_PREFIX L"/var/cache/TPMFactoryUpd_Journal"
+/// Durations measured by successful firmware updates, used to predict the duration of the next update
+#define TPM_FACTORY_UPD_DURATION_FILE L"/var/cache/TPMFactoryUpd_Durations.bin"
+
+/**
+ *	@brief		Gets the path of a state file of the TPM device.
+ *	@details	The file name is the given prefix followed by the device path with the path separators replaced, so the
+ *				update plans, update journals and learned timeouts of several TPM devices do not overwrite each other.
+ *
+ *	@param		PwszPrefix				File name prefix (e.g. TPM_FACTORY_UPD_PLAN_FILE_PREFIX)
+ *	@param		PwszFile				Receives the path of the state file
+ *	@param		PpunFileSize			In: Capacity of PwszFile in characters, Out: Length of the path
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_GetDeviceFile(
+	_In_z_							const wchar_t*	PwszPrefix,
+	_Out_z_cap_(*PpunFileSize)		wchar_t*		PwszFile,
+	_Inout_							unsigned int*	PpunFileSize);
+
 /**
  *	@brief		Processes a sequence of TPM update related commands to update the firmware.
  *	@details	This module processes the firmware update. Afterwards the result is returned to the calling module.
@@ -54,6 +84,22 @@ unsigned int
 CommandFlow_TpmUpdate_PrepareFirmwareUpdate(
 	_Inout_ IfxUpdate* PpTpmUpdate);
 
+/**
+ *	@brief		Records the checked and prepared update in the update plan file.
+ *	@details	Called for the -prepare command line option instead of the firmware update. A later run with the -commit
+ *				command line option only checks that the TPM state and the firmware image did not change.
+ *
+ *	@param		PpTpmUpdate			Pointer to a IfxUpdate structure which passed the checks and the preparation
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+CommandFlow_TpmUpdate_StoreUpdatePlan(
+	_Inout_ IfxUpdate* PpTpmUpdate);
+
 /**
  *	@brief		Check if a firmware update is possible.
  *	@details	This function will check if the firmware is updatable with the given firmware image
@@ -71,6 +117,7 @@ unsigned int
 CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 	_Inout_ IfxUpdate* PpTpmUpdate);
 
+#if IFX_ENABLE_TPM12
 /**
  *	@brief		Take TPM Ownership with hard coded hash value.
  *	@details	The corresponding TPM Owner authentication is described in the user manual.
@@ -83,6 +130,50 @@ CommandFlow_TpmUpdate_IsFirmwareUpdatable(
 _Check_return_
 unsigned int
 CommandFlow_TpmUpdate_PrepareTPM12Ownership();
+#endif
+
+/**
+ *	@brief		Replaces a firmware image URL with the file of the image cache folder downloaded from it before.
+ *	@details	Only used with the -verify-cache command line option. A URL which is not cached is remembered, so that the
+ *				downloaded image is stored in the image cache folder after it passed the integrity and signature checks.
+ */
+void
+CommandFlow_TpmUpdate_ResolveImageCache();
+
+/**
+ *	@brief		Remembers the firmware images which passed the integrity and signature checks in memory.
+ *	@details	Used by the factory loop: an image checked for one unit is not checked again for the following units as
+ *				long as size, modification time and SHA-256 digest of the image are unchanged.
+ */
+void
+CommandFlow_TpmUpdate_KeepVerifiedImagesInMemory();
+
+/**
+ *	@brief		Loads the firmware image file once for the forked workers of several TPM devices.
+ *	@details	The workers take the loaded (decompressed) file content over copy-on-write instead of loading it again. A
+ *				single firmware image also passes the integrity and signature checks here, so the workers only run the TPM
+ *				dependent checks. The image of a bundle depends on the TPM firmware version and is checked by the worker.
+ *				Nothing is loaded for a downloaded image, and a file which cannot be loaded or checked is left to the
+ *				workers, which report the error for their TPM device.
+ */
+void
+CommandFlow_TpmUpdate_PreloadFirmwareImage();
+
+/**
+ *	@brief		Releases the firmware image file loaded by CommandFlow_TpmUpdate_PreloadFirmwareImage().
+ *	@details	Called by the parent process once all workers have been forked. Does nothing in a worker which took the
+ *				loaded file content over.
+ */
+void
+CommandFlow_TpmUpdate_ReleasePreloadedImage();
+
+/**
+ *	@brief		Loads the update journal file of an interrupted firmware update.
+ *	@details	If the TPM is found in boot loader mode, the journaled firmware image is used for the update without being
+ *				checked again. The TPM detection starts with the TPM1.2 command set spoken by the boot loader.
+ */
+void
+CommandFlow_TpmUpdate_LoadUpdateJournal();
 
 /**
  *	@brief		Parse the update config settings file
@@ -101,6 +192,27 @@ unsigned int
 CommandFlow_TpmUpdate_ProceedUpdateConfig(
 	_Inout_ IfxUpdate* PpTpmUpdate);
 
+/**
+ *	@brief		Releases the firmware image file of the next update of a chain if the chain ends early.
+ *	@details	Waits for a running worker thread and releases the loaded file content.
+ */
+void
+CommandFlow_TpmUpdate_ReleaseNextImagePrefetch();
+
+/**
+ *	@brief		Prepares the next firmware update of a chain planned by CommandFlow_TpmUpdate_ProceedUpdateConfig().
+ *	@details	Called after a successful firmware update. If the config file needs further firmware updates to reach the
+ *				target firmware, the state of the completed update is released, so the caller can read the TPM state again
+ *				and continue with CommandFlow_TpmUpdate_ProceedUpdateConfig().
+ *
+ *	@param		PpTpmUpdate				Pointer to the IfxUpdate structure of the completed firmware update
+ *	@param		PpfNextUpdate			Receives TRUE if another firmware update follows
+ */
+void
+CommandFlow_TpmUpdate_PrepareNextUpdate(
+	_Inout_	IfxUpdate*	PpTpmUpdate,
+	_Out_	BOOL*		PpfNextUpdate);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,7 @@
 #include "CommandLineParser.h"
 #include "TPMFactoryUpdStruct.h"
 #include "Resource.h"
+#include "Controller.h"
 
 /**
  *	@brief		Parses the command line option. Implements interface ICommandLineParser
@@ -83,6 +84,22 @@ CommandLineParser_Parse(
 			// Add info property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
 			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_INFO, TRUE));
 
+			// Read parameter fields (optional)
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS == unReturnValue)
+			{
+				unsigned int unFields = 0;
+				unReturnValue = CommandLineParser_ParseInfoFields(wszValue, &unFields);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+				if (!PropertyStorage_AddKeyUIntegerValuePair(PROPERTY_INFO_FIELDS, unFields))
+				{
+					unReturnValue = RC_E_FAIL;
+					ERROR_STORE(unReturnValue, L"Setting PROPERTY_INFO_FIELDS failed.");
+					break;
+				}
+			}
+
 			unReturnValue = CommandLineParser_IncrementOptionCount();
 			break;
 		}
@@ -260,9 +277,12 @@ CommandLineParser_Parse(
 				break;
 			}
 
-			// Check if value is 1 or 3 for the TPM device access mode
+			// Check if value is 0, 1, 3, 4, 5, 6, 7, 8 or 9 for the TPM device access mode
 			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unAccessMode) ||
-					(TPM_DEVICE_ACCESS_DRIVER != unAccessMode && TPM_DEVICE_ACCESS_MEMORY_BASED != unAccessMode))
+					(TPM_DEVICE_ACCESS_AUTO != unAccessMode && TPM_DEVICE_ACCESS_DRIVER != unAccessMode && TPM_DEVICE_ACCESS_MEMORY_BASED != unAccessMode &&
+					 TPM_DEVICE_ACCESS_RESOURCE_MANAGER != unAccessMode && TPM_DEVICE_ACCESS_SIMULATED != unAccessMode &&
+					 TPM_DEVICE_ACCESS_REPLAY != unAccessMode && TPM_DEVICE_ACCESS_SOCKET != unAccessMode &&
+					 TPM_DEVICE_ACCESS_REMOTE != unAccessMode && TPM_DEVICE_ACCESS_SPI != unAccessMode))
 			{
 				unReturnValue = RC_E_INVALID_ACCESS_MODE;
 				ERROR_STORE_FMT(unReturnValue, L"An invalid value (%ls) was passed in the <access-mode> command line option.", wszValue);
@@ -274,6 +294,14 @@ CommandLineParser_Parse(
 			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
 			if (RC_SUCCESS == unReturnValue)
 			{
+				// The automatic access mode probes the default device paths
+				if (TPM_DEVICE_ACCESS_AUTO == unAccessMode)
+				{
+					unReturnValue = RC_E_BAD_COMMANDLINE;
+					ERROR_STORE(unReturnValue, L"The automatic access mode does not accept a device path.");
+					break;
+				}
+
 				// Store setting value
 				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszValue) &&
 						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszValue))
@@ -344,6 +372,525 @@ CommandLineParser_Parse(
 			break;
 		}
 
+		// **** -stats
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_STATISTICS, RG_LEN(CMD_STATISTICS), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add Statistics property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_STATISTICS, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -verify-cache
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_VERIFY_CACHE, RG_LEN(CMD_VERIFY_CACHE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add VerifyCache property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_VERIFY_CACHE, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -learn-timeouts
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_LEARN_TIMEOUTS, RG_LEN(CMD_LEARN_TIMEOUTS), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add LearnTimeouts property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_LEARN_TIMEOUTS, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -prepare
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_PREPARE, RG_LEN(CMD_PREPARE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add Prepare property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_PREPARE, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -commit
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_COMMIT, RG_LEN(CMD_COMMIT), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add Commit property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_COMMIT, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -deadline
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_DEADLINE, RG_LEN(CMD_DEADLINE), TRUE))
+		{
+			unsigned int unDeadline = 0;
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter seconds
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing seconds for command line parameter <deadline>.");
+				break;
+			}
+
+			// Add Deadline property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_DEADLINE, wszValue));
+
+			// Check if value is a positive number
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_DEADLINE, &unDeadline) || 0 == unDeadline)
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"An invalid value (%ls) was passed in the <deadline> command line option.", wszValue);
+				break;
+			}
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -progress-file
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_PROGRESS_FILE, RG_LEN(CMD_PROGRESS_FILE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter progress file path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing progress file path for command line parameter <progress-file>.");
+				break;
+			}
+
+			// Add ProgressFile property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_PROGRESS_FILE, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -clearownership-after
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_CLEAROWNERSHIP_AFTER, RG_LEN(CMD_CLEAROWNERSHIP_AFTER), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add ClearOwnershipAfter property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_CLEAROWNERSHIP_AFTER, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -factory-loop
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_FACTORY_LOOP, RG_LEN(CMD_FACTORY_LOOP), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter trigger
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing trigger for command line parameter <factory-loop>.");
+				break;
+			}
+			if (0 != Platform_StringCompare(wszValue, FACTORY_LOOP_TRIGGER_OPERATOR, RG_LEN(FACTORY_LOOP_TRIGGER_OPERATOR), TRUE) &&
+					0 != Platform_StringCompare(wszValue, FACTORY_LOOP_TRIGGER_DEVICE, RG_LEN(FACTORY_LOOP_TRIGGER_DEVICE), TRUE))
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"Unknown trigger for command line parameter <factory-loop> (%ls).", wszValue);
+				break;
+			}
+
+			// Add FactoryLoop property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_FACTORY_LOOP, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -trace
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_TRACE, RG_LEN(CMD_TRACE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter trace file path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing trace file path for command line parameter <trace>.");
+				break;
+			}
+
+			// Add Trace property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_TRACE, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -metrics
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_METRICS, RG_LEN(CMD_METRICS), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter metrics file path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing metrics file path for command line parameter <metrics>.");
+				break;
+			}
+
+			// Add Metrics property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_METRICS, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -info-cache
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_INFO_CACHE, RG_LEN(CMD_INFO_CACHE), TRUE))
+		{
+			unsigned int unTimeToLive = 0;
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter seconds
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing seconds for command line parameter <info-cache>.");
+				break;
+			}
+
+			// Add InfoCacheTtl property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_INFO_CACHE_TTL, wszValue));
+
+			// Check if value is a number
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_INFO_CACHE_TTL, &unTimeToLive))
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"An invalid value (%ls) was passed in the <info-cache> command line option.", wszValue);
+				break;
+			}
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -benchmark
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_BENCHMARK, RG_LEN(CMD_BENCHMARK), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter Firmware path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing firmware file path for command line parameter <benchmark>.");
+				break;
+			}
+
+			// Add Benchmark property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_BENCHMARK, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -check-images
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_CHECK_IMAGES, RG_LEN(CMD_CHECK_IMAGES), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter folder or firmware path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing folder or firmware file path for command line parameter <check-images>.");
+				break;
+			}
+
+			// Add CheckImages property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_CHECK_IMAGES, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -decode-capture
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_DECODE_CAPTURE, RG_LEN(CMD_DECODE_CAPTURE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter capture file path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing capture file path for command line parameter <decode-capture>.");
+				break;
+			}
+
+			// Add DecodeCapture property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_DECODE_CAPTURE, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -json
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_JSON, RG_LEN(CMD_JSON), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add JsonOutput property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_JSON_OUTPUT, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -timing
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_TIMING, RG_LEN(CMD_TIMING), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add Timing property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_TIMING, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -jobs
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_JOBS, RG_LEN(CMD_JOBS), TRUE))
+		{
+			unsigned int unJobs = 0;
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter count
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing count for command line parameter <jobs>.");
+				break;
+			}
+
+			// Add DeviceJobs property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_DEVICE_JOBS, wszValue));
+
+			// Check if value is a positive number
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_DEVICE_JOBS, &unJobs) || 0 == unJobs)
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"An invalid value (%ls) was passed in the <jobs> command line option.", wszValue);
+				break;
+			}
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -fork
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_FORK, RG_LEN(CMD_FORK), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add DeviceFork property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_DEVICE_FORK, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -device-log
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_DEVICE_LOG, RG_LEN(CMD_DEVICE_LOG), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add DeviceLog property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_DEVICE_LOG, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -background
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_BACKGROUND, RG_LEN(CMD_BACKGROUND), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add Background property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_BACKGROUND, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -quiet
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_QUIET, RG_LEN(CMD_QUIET), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add QuietOutput property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyBooleanValuePair(PROPERTY_QUIET_OUTPUT, TRUE));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -service
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_SERVICE, RG_LEN(CMD_SERVICE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter socket path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing socket path for command line parameter <service>.");
+				break;
+			}
+
+			// Add Service property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_SERVICE, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -batch
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_BATCH, RG_LEN(CMD_BATCH), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter operation file path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing file path for command line parameter <batch>.");
+				break;
+			}
+
+			// Add Batch property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_BATCH, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -build-frames
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_BUILD_FRAMES, RG_LEN(CMD_BUILD_FRAMES), TRUE))
+		{
+			unsigned int unMaxDataSize = 0;
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter maximum data size
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing maximum data size for command line parameter <build-frames>.");
+				break;
+			}
+
+			// Add BuildFrames property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_BUILD_FRAMES, wszValue));
+
+			// Check if value is a positive 16 bit number, the range is checked when the frames are built
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_BUILD_FRAMES, &unMaxDataSize) || 0 == unMaxDataSize || unMaxDataSize > 0xFFFF)
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"An invalid value (%ls) was passed in the <build-frames> command line option.", wszValue);
+				break;
+			}
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
+		// **** -frame-file
+		if (0 == Platform_StringCompare(PwszCommandLineOption, CMD_FRAME_FILE, RG_LEN(CMD_FRAME_FILE), TRUE))
+		{
+			unReturnValue = CommandLineParser_CheckCommandLineOptions(PwszCommandLineOption);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Read parameter frame file path
+			unReturnValue = CommandLineParser_ReadParameter(PrgwszArgv, PnMaxArg, PpunCurrentArgIndex, wszValue, &unValueSize);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Missing frame file path for command line parameter <frame-file>.");
+				break;
+			}
+
+			// Add FrameFile property, ignore return value because CommandLineParser_CheckCommandLineOptions takes care of doubled given options
+			IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_FRAME_FILE, wszValue));
+
+			unReturnValue = CommandLineParser_IncrementOptionCount();
+			break;
+		}
+
 		unReturnValue = RC_E_BAD_COMMANDLINE;
 		ERROR_STORE_FMT(unReturnValue, L"Unknown command line parameter (%ls).", PwszCommandLineOption);
 	}
@@ -387,47 +934,311 @@ CommandLineParser_FinalizeParsing(
 	{
 		BOOL fValue = FALSE;
 
-		if (RC_SUCCESS != PunReturnValue)
+		if (RC_SUCCESS != PunReturnValue)
+		{
+			if (RC_E_BAD_COMMANDLINE != PunReturnValue &&
+					RC_E_INVALID_ACCESS_MODE != PunReturnValue &&
+					RC_E_INVALID_LOG_OPTION != PunReturnValue)
+			{
+				// Map error code to RC_E_BAD_PARAMETER
+				unsigned int unReturnValue = PunReturnValue;
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(PunReturnValue, L"Mapped error code: 0x%.8x", unReturnValue);
+			}
+			// In case of an error skip final checks
+			break;
+		}
+
+		// Check if log option is given...
+		if (PropertyStorage_GetBooleanValueByKey(PROPERTY_LOGGING, &fValue) &&
+				fValue == TRUE)
+		{
+			PunReturnValue = Utility_CheckIfLogPathWritable();
+			if (RC_SUCCESS != PunReturnValue)
+			{
+				// Set default path
+				// Ignore return value we are already in error handling
+				IGNORE_RETURN_VALUE(PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_PATH, LOGGING_FILE_PATH));
+
+				ERROR_STORE_FMT(RC_E_INVALID_LOG_OPTION, L"The log file could not be opened or created. The path may be invalid, too long or not accessible. (0x%.8X)", PunReturnValue);
+				PunReturnValue = RC_E_INVALID_LOG_OPTION;
+				break;
+			}
+		}
+
+		// Check if at least one mandatory option is set
+		if ((FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_HELP, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_TPM12_CLEAROWNERSHIP, &fValue) || FALSE == fValue) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_BENCHMARK) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_CHECK_IMAGES) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_DECODE_CAPTURE) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_SERVICE) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_BATCH) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_BUILD_FRAMES))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"No mandatory command line option found.");
+			break;
+		}
+
+		// Check that the service and the batch are only combined with the log and access-mode options, the requests carry the command
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_SERVICE) || TRUE == PropertyStorage_ExistsElement(PROPERTY_BATCH))
+		{
+			unsigned int unOptionCount = 0;
+			unsigned int unAllowedCount = 1;
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_LOGGING))
+				unAllowedCount++;
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_ACCESS_MODE))
+				unAllowedCount++;
+			if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_CMDLINE_COUNT, &unOptionCount) || unAllowedCount != unOptionCount)
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"The service and batch options can only be used with the log or access-mode option.");
+				break;
+			}
+		}
+
+		// Check that the JSON output is only used with info, update or tpm12-clearownership option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_JSON_OUTPUT) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_TPM12_CLEAROWNERSHIP, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The json option can only be used with the info, update or tpm12-clearownership option.");
+			break;
+		}
+
+		// Check that the timing output is only used with info or update option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_TIMING) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The timing option can only be used with the info or update option.");
+			break;
+		}
+
+		// Check that the quiet output is only used with info or update option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_QUIET_OUTPUT) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The quiet option can only be used with the info or update option.");
+			break;
+		}
+
+		// Check that the prepare and commit options are only used with the update option
+		if ((TRUE == PropertyStorage_ExistsElement(PROPERTY_PREPARE) || TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT)) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The prepare and commit options can only be used with the update option.");
+			break;
+		}
+
+		// Check that the deadline option is only used with the update option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEADLINE) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The deadline option can only be used with the update option.");
+			break;
+		}
+
+		// Check that the progress file option is only used with the update option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_PROGRESS_FILE) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The progress-file option can only be used with the update option.");
+			break;
+		}
+
+		// Check that the frames are built from a firmware image into a frame file
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BUILD_FRAMES) &&
+				(FALSE == PropertyStorage_ExistsElement(PROPERTY_FIRMWARE_PATH) || FALSE == PropertyStorage_ExistsElement(PROPERTY_FRAME_FILE)))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The build-frames option requires the firmware and the frame-file option.");
+			break;
+		}
+
+		// Check that the frame file option is only used with the update or build-frames option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_FRAME_FILE) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+				FALSE == PropertyStorage_ExistsElement(PROPERTY_BUILD_FRAMES))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The frame-file option can only be used with the update or build-frames option.");
+			break;
+		}
+
+		// Check that the metrics option is only used with the info or update option
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_METRICS) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The metrics option can only be used with the info or update option.");
+			break;
+		}
+
+		// Check that the clearownership-after option is only used with an update which changes the TPM firmware
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_CLEAROWNERSHIP_AFTER) &&
+				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue ||
+				 TRUE == PropertyStorage_ExistsElement(PROPERTY_PREPARE) ||
+				 TRUE == PropertyStorage_ExistsElement(PROPERTY_SERVICE_CHECK)))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The clearownership-after option can only be used with the update option and without the prepare option.");
+			break;
+		}
+
+		// Check that the factory loop is only used with an update of a single TPM device which runs to its end
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_FACTORY_LOOP))
+		{
+			wchar_t wszTrigger[MAX_NAME] = {0};
+			unsigned int unTriggerSize = RG_LEN(wszTrigger);
+			unsigned int unAccessMode = 0;
+			if (FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue ||
+					TRUE == PropertyStorage_ExistsElement(PROPERTY_PREPARE) ||
+					TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT) ||
+					TRUE == PropertyStorage_ExistsElement(PROPERTY_DEADLINE) ||
+					TRUE == PropertyStorage_ExistsElement(PROPERTY_PROGRESS_FILE) ||
+					TRUE == Controller_DevicesIsSet())
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"The factory-loop option can only be used with the update option of a single TPM device and without the prepare, commit, deadline or progress-file option.");
+				break;
+			}
+			// The device trigger watches the device path of the TPM driver
+			if (PropertyStorage_GetValueByKey(PROPERTY_FACTORY_LOOP, wszTrigger, &unTriggerSize) &&
+					0 == Platform_StringCompare(wszTrigger, FACTORY_LOOP_TRIGGER_DEVICE, RG_LEN(FACTORY_LOOP_TRIGGER_DEVICE), TRUE) &&
+					(!PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unAccessMode) || TPM_DEVICE_ACCESS_DRIVER != unAccessMode))
+			{
+				PunReturnValue = RC_E_INVALID_ACCESS_MODE;
+				ERROR_STORE(PunReturnValue, L"The factory-loop device trigger can only be used with the access mode 3.");
+				break;
+			}
+		}
+
+		// Check that several TPM devices are only used with info or update option and an access mode using the device path
+		if (TRUE == Controller_DevicesIsSet())
 		{
-			if (RC_E_BAD_COMMANDLINE != PunReturnValue &&
-					RC_E_INVALID_ACCESS_MODE != PunReturnValue &&
-					RC_E_INVALID_LOG_OPTION != PunReturnValue)
+			unsigned int unAccessMode = 0;
+			if ((FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
+					(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue))
 			{
-				// Map error code to RC_E_BAD_PARAMETER
-				unsigned int unReturnValue = PunReturnValue;
 				PunReturnValue = RC_E_BAD_COMMANDLINE;
-				ERROR_STORE_FMT(PunReturnValue, L"Mapped error code: 0x%.8x", unReturnValue);
+				ERROR_STORE(PunReturnValue, L"Several TPM device paths can only be used with the info or update option.");
+				break;
 			}
-			// In case of an error skip final checks
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_INFO_CACHE_TTL))
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"Several TPM device paths cannot be used with the info-cache option.");
+				break;
+			}
+			// The worker processes would share the single progress record
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_PROGRESS_FILE))
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"Several TPM device paths cannot be used with the progress-file option.");
+				break;
+			}
+			// The worker processes would overwrite each other's trace file
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_TRACE))
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"Several TPM device paths cannot be used with the trace option.");
+				break;
+			}
+			// The worker processes would overwrite each other's metrics file
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_METRICS))
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"Several TPM device paths cannot be used with the metrics option.");
+				break;
+			}
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unAccessMode) ||
+					(TPM_DEVICE_ACCESS_DRIVER != unAccessMode && TPM_DEVICE_ACCESS_RESOURCE_MANAGER != unAccessMode &&
+					 TPM_DEVICE_ACCESS_REPLAY != unAccessMode && TPM_DEVICE_ACCESS_SOCKET != unAccessMode &&
+					 TPM_DEVICE_ACCESS_REMOTE != unAccessMode && TPM_DEVICE_ACCESS_SPI != unAccessMode))
+			{
+				PunReturnValue = RC_E_INVALID_ACCESS_MODE;
+				ERROR_STORE(PunReturnValue, L"Several TPM device paths can only be used with the access modes 3, 4, 6, 7, 8 and 9.");
+				break;
+			}
+		}
+		else if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEVICE_JOBS))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The jobs option can only be used with several TPM device paths.");
+			break;
+		}
+		else if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEVICE_FORK))
+		{
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The fork option can only be used with several TPM device paths.");
 			break;
 		}
 
-		// Check if log option is given...
-		if (PropertyStorage_GetBooleanValueByKey(PROPERTY_LOGGING, &fValue) &&
-				fValue == TRUE)
+		// The device log file is named after the TPM device path
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEVICE_LOG) && FALSE == PropertyStorage_ExistsElement(PROPERTY_ACCESS_MODE))
 		{
-			PunReturnValue = Utility_CheckIfLogPathWritable(TRUE);
-			if (RC_SUCCESS != PunReturnValue)
-			{
-				// Set default path
-				// Ignore return value we are already in error handling
-				IGNORE_RETURN_VALUE(PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_PATH, LOGGING_FILE_PATH));
+			PunReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE(PunReturnValue, L"The device-log option can only be used with the access-mode option.");
+			break;
+		}
 
-				ERROR_STORE_FMT(RC_E_INVALID_LOG_OPTION, L"The log file could not be opened or created. The path may be invalid, too long or not accessible. (0x%.8X)", PunReturnValue);
-				PunReturnValue = RC_E_INVALID_LOG_OPTION;
+		// The background mode is meant for periodic read-only queries
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BACKGROUND))
+		{
+			BOOL fInfo = PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) && TRUE == fValue;
+			if (FALSE == fInfo && FALSE == PropertyStorage_ExistsElement(PROPERTY_CHECK_IMAGES))
+			{
+				PunReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(PunReturnValue, L"The background option can only be used with the info or check-images option.");
 				break;
 			}
+			// Prefer a recent cached answer over waking up the TPM, the cache file does not tell the TPM devices apart
+			if (TRUE == fInfo && FALSE == PropertyStorage_ExistsElement(PROPERTY_INFO_CACHE_TTL) && FALSE == PropertyStorage_ExistsElement(PROPERTY_ACCESS_MODE))
+				IGNORE_RETURN_VALUE(PropertyStorage_AddKeyValuePair(PROPERTY_INFO_CACHE_TTL, BACKGROUND_INFO_CACHE_TTL));
 		}
 
-		// Check if at least one mandatory option is set
-		if ((FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) || FALSE == fValue) &&
-				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue) &&
-				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_HELP, &fValue) || FALSE == fValue) &&
-				(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_TPM12_CLEAROWNERSHIP, &fValue) || FALSE == fValue))
+		// Check that the resource manager access mode is only used for read-only operations
 		{
-			PunReturnValue = RC_E_BAD_COMMANDLINE;
-			ERROR_STORE(PunReturnValue, L"No mandatory command line option found.");
-			break;
+			unsigned int unAccessMode = 0;
+			if (PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unAccessMode) &&
+					TPM_DEVICE_ACCESS_RESOURCE_MANAGER == unAccessMode &&
+					(FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) || FALSE == fValue) &&
+					FALSE == PropertyStorage_ExistsElement(PROPERTY_CHECK_IMAGES) &&
+					FALSE == PropertyStorage_ExistsElement(PROPERTY_SERVICE) &&
+					FALSE == PropertyStorage_ExistsElement(PROPERTY_SERVICE_CHECK))
+			{
+				PunReturnValue = RC_E_INVALID_ACCESS_MODE;
+				ERROR_STORE(PunReturnValue, L"The resource manager access mode can only be used with the info, check-images or service option.");
+				break;
+			}
+
+			// The automatic access mode may select the resource manager for the same operations only
+			if (PropertyStorage_GetUIntegerValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, &unAccessMode) &&
+					TPM_DEVICE_ACCESS_AUTO == unAccessMode &&
+					((TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) && TRUE == fValue) ||
+					 TRUE == PropertyStorage_ExistsElement(PROPERTY_CHECK_IMAGES) ||
+					 TRUE == PropertyStorage_ExistsElement(PROPERTY_SERVICE) ||
+					 TRUE == PropertyStorage_ExistsElement(PROPERTY_SERVICE_CHECK)) &&
+					!PropertyStorage_AddKeyBooleanValuePair(PROPERTY_TPM_DEVICE_ACCESS_AUTO_SHARED, TRUE) &&
+					!PropertyStorage_ChangeBooleanValueByKey(PROPERTY_TPM_DEVICE_ACCESS_AUTO_SHARED, TRUE))
+			{
+				PunReturnValue = RC_E_FAIL;
+				ERROR_STORE_FMT(PunReturnValue, L"Unexpected error occurred while adding the %ls property.", PROPERTY_TPM_DEVICE_ACCESS_AUTO_SHARED);
+				break;
+			}
 		}
 
 		// Check that when update option is set ...
@@ -642,6 +1453,59 @@ CommandLineParser_IsValue(
 	return fIsValue;
 }
 
+/**
+ *	@brief		Parses the field list of the -info command line option
+ *	@details	The list is separated by commas, e.g. "version,counter". The TPM family is always part of the result.
+ *
+ *	@param		PwszValue				Field list
+ *	@param		PpunFields				Receives the fields as combination of TPM_INFO_FIELD_* values
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_COMMANDLINE	The list contains an unknown or empty field.
+ */
+_Check_return_
+unsigned int
+CommandLineParser_ParseInfoFields(
+	_In_z_		const wchar_t*	PwszValue,
+	_Out_		unsigned int*	PpunFields)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unPosition = 0;
+
+	*PpunFields = TPM_INFO_FIELD_FAMILY;
+
+	while (RC_SUCCESS == unReturnValue)
+	{
+		wchar_t wszField[MAX_NAME] = {0};
+		unsigned int unLength = 0;
+
+		// Copy the next field
+		while (L'\0' != PwszValue[unPosition] && L',' != PwszValue[unPosition] && unLength < RG_LEN(wszField) - 1)
+			wszField[unLength++] = PwszValue[unPosition++];
+
+		if (0 == Platform_StringCompare(wszField, CMD_INFO_FIELD_FAMILY, RG_LEN(CMD_INFO_FIELD_FAMILY), TRUE))
+			*PpunFields |= TPM_INFO_FIELD_FAMILY;
+		else if (0 == Platform_StringCompare(wszField, CMD_INFO_FIELD_VERSION, RG_LEN(CMD_INFO_FIELD_VERSION), TRUE))
+			*PpunFields |= TPM_INFO_FIELD_VERSION;
+		else if (0 == Platform_StringCompare(wszField, CMD_INFO_FIELD_COUNTER, RG_LEN(CMD_INFO_FIELD_COUNTER), TRUE))
+			*PpunFields |= TPM_INFO_FIELD_COUNTER;
+		else if (0 == Platform_StringCompare(wszField, CMD_INFO_FIELD_STATE, RG_LEN(CMD_INFO_FIELD_STATE), TRUE))
+			*PpunFields |= TPM_INFO_FIELD_STATE;
+		else
+		{
+			unReturnValue = RC_E_BAD_COMMANDLINE;
+			ERROR_STORE_FMT(unReturnValue, L"Unknown field for command line parameter <info> (%ls).", PwszValue);
+			break;
+		}
+
+		// Skip the separator
+		if (L'\0' == PwszValue[unPosition])
+			break;
+		unPosition++;
+	}
+
+	return unReturnValue;
+}
+
 /**
  *	@brief		Checks whether the parameter can be combined with any previously set
  *	@details
@@ -672,6 +1536,32 @@ CommandLineParser_CheckCommandLineOptions(
 		BOOL fConfigFileOption = FALSE;
 		BOOL fDryRunOption = FALSE;
 		BOOL fIgnoreErrorOnComplete = FALSE;
+		BOOL fStatisticsOption = FALSE;
+		BOOL fInfoCacheOption = FALSE;
+		BOOL fVerifyCacheOption = FALSE;
+		BOOL fLearnTimeoutsOption = FALSE;
+		BOOL fBenchmarkOption = FALSE;
+		BOOL fCheckImagesOption = FALSE;
+		BOOL fDecodeCaptureOption = FALSE;
+		BOOL fJsonOption = FALSE;
+		BOOL fTimingOption = FALSE;
+		BOOL fServiceOption = FALSE;
+		BOOL fQuietOption = FALSE;
+		BOOL fJobsOption = FALSE;
+		BOOL fForkOption = FALSE;
+		BOOL fDeviceLogOption = FALSE;
+		BOOL fBackgroundOption = FALSE;
+		BOOL fPrepareOption = FALSE;
+		BOOL fCommitOption = FALSE;
+		BOOL fDeadlineOption = FALSE;
+		BOOL fProgressFileOption = FALSE;
+		BOOL fClearOwnershipAfterOption = FALSE;
+		BOOL fFactoryLoopOption = FALSE;
+		BOOL fTraceOption = FALSE;
+		BOOL fMetricsOption = FALSE;
+		BOOL fBatchOption = FALSE;
+		BOOL fBuildFramesOption = FALSE;
+		BOOL fFrameFileOption = FALSE;
 
 		// Read Property storage
 		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_HELP))
@@ -694,6 +1584,58 @@ CommandLineParser_CheckCommandLineOptions(
 			fDryRunOption = TRUE;
 		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_IGNORE_ERROR_ON_COMPLETE))
 			fIgnoreErrorOnComplete = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_STATISTICS))
+			fStatisticsOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_INFO_CACHE_TTL))
+			fInfoCacheOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_VERIFY_CACHE))
+			fVerifyCacheOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_LEARN_TIMEOUTS))
+			fLearnTimeoutsOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BENCHMARK))
+			fBenchmarkOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_CHECK_IMAGES))
+			fCheckImagesOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DECODE_CAPTURE))
+			fDecodeCaptureOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_JSON_OUTPUT))
+			fJsonOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_TIMING))
+			fTimingOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_SERVICE))
+			fServiceOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_QUIET_OUTPUT))
+			fQuietOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEVICE_JOBS))
+			fJobsOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEVICE_FORK))
+			fForkOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEVICE_LOG))
+			fDeviceLogOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BACKGROUND))
+			fBackgroundOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_PREPARE))
+			fPrepareOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_COMMIT))
+			fCommitOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DEADLINE))
+			fDeadlineOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_PROGRESS_FILE))
+			fProgressFileOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_CLEAROWNERSHIP_AFTER))
+			fClearOwnershipAfterOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_FACTORY_LOOP))
+			fFactoryLoopOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_TRACE))
+			fTraceOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_METRICS))
+			fMetricsOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BATCH))
+			fBatchOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BUILD_FRAMES))
+			fBuildFramesOption = TRUE;
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_FRAME_FILE))
+			fFrameFileOption = TRUE;
 
 		// **** -help [Help]
 		if (0 == Platform_StringCompare(PwszCommand, CMD_HELP, RG_LEN(CMD_HELP), TRUE) ||
@@ -701,6 +1643,14 @@ CommandLineParser_CheckCommandLineOptions(
 		{
 			// Command line parameter 'help' combined with parameters 'info', 'update', 'firmware', 'log', 'tpm12-clearownership', 'access-mode' or 'config' is a bad command line
 			if (TRUE == fHelpOption || // Parameter should not be given twice
+					TRUE == fServiceOption ||
+					TRUE == fBatchOption ||
+					TRUE == fFactoryLoopOption ||
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption ||
 					TRUE == fInfoOption ||
 					TRUE == fUpdateOption ||
 					TRUE == fFwPathUpdateOption ||
@@ -717,6 +1667,10 @@ CommandLineParser_CheckCommandLineOptions(
 		{
 			// Command line parameter 'info' combined with parameters 'help', 'update', 'firmware', 'tpm12-clearownership' or 'config' is a bad command line
 			if (TRUE == fInfoOption || // And parameter 'info' should not be given twice
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption ||
 					TRUE == fHelpOption ||
 					TRUE == fUpdateOption ||
 					TRUE == fFwPathUpdateOption ||
@@ -731,6 +1685,11 @@ CommandLineParser_CheckCommandLineOptions(
 		{
 			// Command line parameter 'update' combined with parameters 'help', 'info', 'tpm12-clearownership', or 'config' is a bad command line
 			if (TRUE == fUpdateOption || // And parameter 'update' should not be given twice
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption ||
 					TRUE == fHelpOption ||
 					TRUE == fInfoOption ||
 					TRUE == fClearOwnership ||
@@ -754,6 +1713,10 @@ CommandLineParser_CheckCommandLineOptions(
 		{
 			// Command line parameter 'firmware' combined with parameters 'help', 'info', 'tpm12-clearownership' or 'config' is a bad command line
 			if (TRUE == fFwPathUpdateOption || // And parameter 'firmware' should not be given twice
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
 					TRUE == fHelpOption ||
 					TRUE == fInfoOption ||
 					TRUE == fClearOwnership ||
@@ -767,6 +1730,11 @@ CommandLineParser_CheckCommandLineOptions(
 		{
 			// Command line parameter 'tpm12-clearownership' combined with parameters 'help', 'info', 'update', 'firmware' or 'config' is a bad command line
 			if (TRUE == fClearOwnership || // And parameter 'tpm12-clearownership' should not be given twice
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption ||
 					TRUE == fHelpOption ||
 					TRUE == fInfoOption ||
 					TRUE == fUpdateOption ||
@@ -791,6 +1759,11 @@ CommandLineParser_CheckCommandLineOptions(
 		{
 			// Command line parameter 'config' combined with parameters 'help', 'info', 'tpm12-clearownership' or 'firmware' is a bad command line
 			if (TRUE == fConfigFileOption || // And parameter 'config' should not be given twice
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption ||
 					TRUE == fHelpOption ||
 					TRUE == fInfoOption ||
 					TRUE == fClearOwnership ||
@@ -817,6 +1790,296 @@ CommandLineParser_CheckCommandLineOptions(
 			break;
 		}
 
+		// **** -stats [Statistics]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_STATISTICS, RG_LEN(CMD_STATISTICS), TRUE))
+		{
+			// Command line parameter 'stats' can be combined with any parameters
+			if (TRUE == fStatisticsOption) // And parameter 'stats' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -verify-cache [VerifyCache]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_VERIFY_CACHE, RG_LEN(CMD_VERIFY_CACHE), TRUE))
+		{
+			// Command line parameter 'verify-cache' can be combined with any parameters, though has meaning only for 'update'
+			if (TRUE == fVerifyCacheOption) // And parameter 'verify-cache' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -learn-timeouts [LearnTimeouts]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_LEARN_TIMEOUTS, RG_LEN(CMD_LEARN_TIMEOUTS), TRUE))
+		{
+			// Command line parameter 'learn-timeouts' can be combined with any parameters
+			if (TRUE == fLearnTimeoutsOption) // And parameter 'learn-timeouts' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -prepare [Prepare]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_PREPARE, RG_LEN(CMD_PREPARE), TRUE))
+		{
+			// Command line parameter 'prepare' can only be used with 'update' which is checked after parsing
+			if (TRUE == fPrepareOption || // And parameter 'prepare' should not be given twice
+					TRUE == fCommitOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -commit [Commit]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_COMMIT, RG_LEN(CMD_COMMIT), TRUE))
+		{
+			// Command line parameter 'commit' can only be used with 'update' which is checked after parsing
+			if (TRUE == fCommitOption || // And parameter 'commit' should not be given twice
+					TRUE == fPrepareOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -deadline [Deadline]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_DEADLINE, RG_LEN(CMD_DEADLINE), TRUE))
+		{
+			// Command line parameter 'deadline' can only be used with 'update' which is checked after parsing
+			if (TRUE == fDeadlineOption) // And parameter 'deadline' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -progress-file [ProgressFile]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_PROGRESS_FILE, RG_LEN(CMD_PROGRESS_FILE), TRUE))
+		{
+			// Command line parameter 'progress-file' can only be used with 'update' which is checked after parsing
+			if (TRUE == fProgressFileOption) // And parameter 'progress-file' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -clearownership-after [ClearOwnershipAfter]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_CLEAROWNERSHIP_AFTER, RG_LEN(CMD_CLEAROWNERSHIP_AFTER), TRUE))
+		{
+			// Command line parameter 'clearownership-after' can only be used with 'update' which is checked after parsing
+			if (TRUE == fClearOwnershipAfterOption) // And parameter 'clearownership-after' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -factory-loop [FactoryLoop]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_FACTORY_LOOP, RG_LEN(CMD_FACTORY_LOOP), TRUE))
+		{
+			// Command line parameter 'factory-loop' can only be used with 'update' which is checked after parsing
+			if (TRUE == fFactoryLoopOption || // And parameter 'factory-loop' should not be given twice
+					TRUE == fHelpOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -trace [Trace]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_TRACE, RG_LEN(CMD_TRACE), TRUE))
+		{
+			// Command line parameter 'trace' combined with parameter 'help' is a bad command line
+			if (TRUE == fTraceOption || // And parameter 'trace' should not be given twice
+					TRUE == fHelpOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -metrics [Metrics]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_METRICS, RG_LEN(CMD_METRICS), TRUE))
+		{
+			// Command line parameter 'metrics' can only be used with 'info' or 'update' which is checked after parsing
+			if (TRUE == fMetricsOption || // And parameter 'metrics' should not be given twice
+					TRUE == fHelpOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -info-cache [InfoCache]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_INFO_CACHE, RG_LEN(CMD_INFO_CACHE), TRUE))
+		{
+			// Command line parameter 'info-cache' combined with parameters 'help', 'update', 'firmware', 'tpm12-clearownership' or 'config' is a bad command line
+			if (TRUE == fInfoCacheOption || // And parameter 'info-cache' should not be given twice
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption ||
+					TRUE == fHelpOption ||
+					TRUE == fUpdateOption ||
+					TRUE == fFwPathUpdateOption ||
+					TRUE == fClearOwnership ||
+					TRUE == fConfigFileOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -benchmark [Benchmark]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_BENCHMARK, RG_LEN(CMD_BENCHMARK), TRUE))
+		{
+			// Command line parameter 'benchmark' combined with parameters 'help', 'info', 'update', 'firmware', 'tpm12-clearownership', 'config', 'info-cache', 'check-images', 'decode-capture' or 'build-frames' is a bad command line
+			if (TRUE == fBenchmarkOption || // And parameter 'benchmark' should not be given twice
+					TRUE == fHelpOption ||
+					TRUE == fInfoOption ||
+					TRUE == fUpdateOption ||
+					TRUE == fFwPathUpdateOption ||
+					TRUE == fClearOwnership ||
+					TRUE == fConfigFileOption ||
+					TRUE == fInfoCacheOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -check-images [CheckImages]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_CHECK_IMAGES, RG_LEN(CMD_CHECK_IMAGES), TRUE))
+		{
+			// Command line parameter 'check-images' combined with parameters 'help', 'info', 'update', 'firmware', 'tpm12-clearownership', 'config', 'info-cache', 'benchmark', 'decode-capture' or 'build-frames' is a bad command line
+			if (TRUE == fCheckImagesOption || // And parameter 'check-images' should not be given twice
+					TRUE == fHelpOption ||
+					TRUE == fInfoOption ||
+					TRUE == fUpdateOption ||
+					TRUE == fFwPathUpdateOption ||
+					TRUE == fClearOwnership ||
+					TRUE == fConfigFileOption ||
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fDecodeCaptureOption ||
+					TRUE == fBuildFramesOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -decode-capture [DecodeCapture]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_DECODE_CAPTURE, RG_LEN(CMD_DECODE_CAPTURE), TRUE))
+		{
+			// Command line parameter 'decode-capture' combined with parameters 'help', 'info', 'update', 'firmware', 'tpm12-clearownership', 'config', 'info-cache', 'benchmark', 'check-images' or 'build-frames' is a bad command line
+			if (TRUE == fDecodeCaptureOption || // And parameter 'decode-capture' should not be given twice
+					TRUE == fHelpOption ||
+					TRUE == fInfoOption ||
+					TRUE == fUpdateOption ||
+					TRUE == fFwPathUpdateOption ||
+					TRUE == fClearOwnership ||
+					TRUE == fConfigFileOption ||
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fBuildFramesOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -json [JsonOutput]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_JSON, RG_LEN(CMD_JSON), TRUE))
+		{
+			// Command line parameter 'json' can only be used with 'info' or 'update' which is checked after parsing
+			if (TRUE == fJsonOption) // And parameter 'json' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -timing [Timing]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_TIMING, RG_LEN(CMD_TIMING), TRUE))
+		{
+			// Command line parameter 'timing' can only be used with 'info' or 'update' which is checked after parsing
+			if (TRUE == fTimingOption) // And parameter 'timing' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -quiet [QuietOutput]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_QUIET, RG_LEN(CMD_QUIET), TRUE))
+		{
+			// Command line parameter 'quiet' can only be used with 'info' or 'update' which is checked after parsing
+			if (TRUE == fQuietOption) // And parameter 'quiet' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -jobs [DeviceJobs]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_JOBS, RG_LEN(CMD_JOBS), TRUE))
+		{
+			// Command line parameter 'jobs' can only be used with several device paths which is checked after parsing
+			if (TRUE == fJobsOption) // And parameter 'jobs' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -fork [DeviceFork]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_FORK, RG_LEN(CMD_FORK), TRUE))
+		{
+			// Command line parameter 'fork' can only be used with several device paths which is checked after parsing
+			if (TRUE == fForkOption) // And parameter 'fork' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -device-log [DeviceLog]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_DEVICE_LOG, RG_LEN(CMD_DEVICE_LOG), TRUE))
+		{
+			// Command line parameter 'device-log' can only be used with 'access-mode' which is checked after parsing
+			if (TRUE == fDeviceLogOption) // And parameter 'device-log' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -background [Background]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_BACKGROUND, RG_LEN(CMD_BACKGROUND), TRUE))
+		{
+			// Command line parameter 'background' can only be used with 'info' or 'check-images' which is checked after parsing
+			if (TRUE == fBackgroundOption) // And parameter 'background' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -service [Service]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_SERVICE, RG_LEN(CMD_SERVICE), TRUE))
+		{
+			// Command line parameter 'service' can only be used with 'log' or 'access-mode' which is checked after parsing
+			if (TRUE == fServiceOption || // And parameter 'service' should not be given twice
+					TRUE == fHelpOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -batch [Batch]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_BATCH, RG_LEN(CMD_BATCH), TRUE))
+		{
+			// Command line parameter 'batch' can only be used with 'log' or 'access-mode' which is checked after parsing
+			if (TRUE == fBatchOption || // And parameter 'batch' should not be given twice
+					TRUE == fServiceOption ||
+					TRUE == fHelpOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -build-frames [BuildFrames]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_BUILD_FRAMES, RG_LEN(CMD_BUILD_FRAMES), TRUE))
+		{
+			// Command line parameter 'build-frames' combined with parameters 'help', 'info', 'update', 'tpm12-clearownership', 'config', 'info-cache', 'benchmark', 'check-images' or 'decode-capture' is a bad command line
+			if (TRUE == fBuildFramesOption || // And parameter 'build-frames' should not be given twice
+					TRUE == fHelpOption ||
+					TRUE == fInfoOption ||
+					TRUE == fUpdateOption ||
+					TRUE == fClearOwnership ||
+					TRUE == fConfigFileOption ||
+					TRUE == fInfoCacheOption ||
+					TRUE == fBenchmarkOption ||
+					TRUE == fCheckImagesOption ||
+					TRUE == fDecodeCaptureOption)
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
+		// **** -frame-file [FrameFile]
+		if (0 == Platform_StringCompare(PwszCommand, CMD_FRAME_FILE, RG_LEN(CMD_FRAME_FILE), TRUE))
+		{
+			// Command line parameter 'frame-file' can only be used with 'update' or 'build-frames' which is checked after parsing
+			if (TRUE == fFrameFileOption) // And parameter 'frame-file' should not be given twice
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+			break;
+		}
+
 		unReturnValue = RC_E_BAD_COMMANDLINE;
 	}
 	WHILE_FALSE_END;
@@ -67,6 +67,21 @@ BOOL
 CommandLineParser_IsValue(
 	_In_z_		const wchar_t*	PwszCommand);
 
+/**
+ *	@brief		Parses the field list of the -info command line option
+ *	@details	The list is separated by commas, e.g. "version,counter". The TPM family is always part of the result.
+ *
+ *	@param		PwszValue				Field list
+ *	@param		PpunFields				Receives the fields as combination of TPM_INFO_FIELD_* values
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_COMMANDLINE	The list contains an unknown or empty field.
+ */
+_Check_return_
+unsigned int
+CommandLineParser_ParseInfoFields(
+	_In_z_		const wchar_t*	PwszValue,
+	_Out_		unsigned int*	PpunFields);
+
 /**
  *	@brief		Checks whether the parameter can be combined with any previously set
  *	@details
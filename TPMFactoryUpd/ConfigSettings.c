@@ -67,6 +67,72 @@ ConfigSettings_InitializeParsing()
 			break;
 		}
 
+		// Set default LogFileMaxFiles
+		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_MAX_FILES))
+			fReturnValue = PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_LOGGING_MAX_FILES, LOGGING_FILE_MAX_FILES);
+		else
+			fReturnValue = PropertyStorage_AddKeyUIntegerValuePair(PROPERTY_LOGGING_MAX_FILES, LOGGING_FILE_MAX_FILES);
+		if (!fReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_MAX_FILES);
+			break;
+		}
+
+		// Set default LogFileFlushInterval
+		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_FLUSH_INTERVAL))
+			fReturnValue = PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_LOGGING_FLUSH_INTERVAL, LOGGING_FILE_FLUSH_INTERVAL);
+		else
+			fReturnValue = PropertyStorage_AddKeyUIntegerValuePair(PROPERTY_LOGGING_FLUSH_INTERVAL, LOGGING_FILE_FLUSH_INTERVAL);
+		if (!fReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_FLUSH_INTERVAL);
+			break;
+		}
+
+		// Set default LogFileAsync
+		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_ASYNC))
+			fReturnValue = PropertyStorage_ChangeBooleanValueByKey(PROPERTY_LOGGING_ASYNC, LOGGING_FILE_ASYNC);
+		else
+			fReturnValue = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_LOGGING_ASYNC, LOGGING_FILE_ASYNC);
+		if (!fReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_ASYNC);
+			break;
+		}
+
+		// Set default LogFileCompress
+		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_COMPRESS))
+			fReturnValue = PropertyStorage_ChangeBooleanValueByKey(PROPERTY_LOGGING_COMPRESS, LOGGING_FILE_COMPRESS);
+		else
+			fReturnValue = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_LOGGING_COMPRESS, LOGGING_FILE_COMPRESS);
+		if (!fReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_COMPRESS);
+			break;
+		}
+
+		// Set default LogFileJson
+		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_JSON))
+			fReturnValue = PropertyStorage_ChangeBooleanValueByKey(PROPERTY_LOGGING_JSON, LOGGING_FILE_JSON);
+		else
+			fReturnValue = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_LOGGING_JSON, LOGGING_FILE_JSON);
+		if (!fReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_JSON);
+			break;
+		}
+
+		// Set default LogBlockSample
+		if (PropertyStorage_ExistsElement(PROPERTY_LOGGING_BLOCK_SAMPLE))
+			fReturnValue = PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_LOGGING_BLOCK_SAMPLE, LOGGING_BLOCK_SAMPLE);
+		else
+			fReturnValue = PropertyStorage_AddKeyUIntegerValuePair(PROPERTY_LOGGING_BLOCK_SAMPLE, LOGGING_BLOCK_SAMPLE);
+		if (!fReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_BLOCK_SAMPLE);
+			break;
+		}
+
 		// Set default console mode: CONSOLE_BUFFER_NONE
 		if (PropertyStorage_ExistsElement(PROPERTY_CONSOLE_MODE))
 			fReturnValue = PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_CONSOLE_MODE, CONSOLE_BUFFER_NONE);
@@ -203,6 +269,105 @@ ConfigSettings_Parse(
 				break;
 			}
 
+			// Check logging file max files
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_MAX_FILES, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_MAX_FILES, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_MAX_FILES);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Check logging file flush interval
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_FLUSH_INTERVAL, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_FLUSH_INTERVAL, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_FLUSH_INTERVAL);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Check asynchronous logging
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_ASYNC, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_ASYNC, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_ASYNC);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Check rotated log file compression
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_COMPRESS, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_COMPRESS, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_COMPRESS);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Check JSON log records
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_JSON, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_JSON, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_JSON);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Check per-module logging levels
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_MODULE_LEVELS, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_LOGGING_MODULE_LEVELS, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_MODULE_LEVELS, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_MODULE_LEVELS);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
+			// Check firmware block logging sample
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_LOGGING_BLOCK_SAMPLE, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_LOGGING_BLOCK_SAMPLE, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_BLOCK_SAMPLE);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+
 			// Unknown setting in current section
 			unReturnValue = RC_SUCCESS;
 			break;
@@ -268,10 +433,232 @@ ConfigSettings_Parse(
 				unReturnValue = RC_SUCCESS;
 				break;
 			}
+			// Check RECORD option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_RECORD, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_CAPTURE_PATH, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_CAPTURE_PATH, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_CAPTURE_PATH);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check REPLAY_TIMING_SCALE option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_REPLAY_TIMING_SCALE, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_REPLAY_TIMING_SCALE, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_REPLAY_TIMING_SCALE, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_REPLAY_TIMING_SCALE);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check SOCKET_POWER_ON option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_SOCKET_POWER_ON, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_SOCKET_POWER_ON, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_SOCKET_POWER_ON, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_SOCKET_POWER_ON);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check TROUBLESHOOTING_FRAMES option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_TROUBLESHOOTING_FRAMES, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_TROUBLESHOOTING_FRAMES, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_TROUBLESHOOTING_FRAMES, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_TROUBLESHOOTING_FRAMES);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check TROUBLESHOOTING option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_TROUBLESHOOTING, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_TROUBLESHOOTING, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_TROUBLESHOOTING, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_TROUBLESHOOTING);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check LOCK_TIMEOUT option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_LOCK_TIMEOUT, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_DEVICE_LOCK_TIMEOUT, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_DEVICE_LOCK_TIMEOUT, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_DEVICE_LOCK_TIMEOUT);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check REALTIME_UPDATE option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_REALTIME_UPDATE, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_REALTIME_UPDATE, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_REALTIME_UPDATE, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_REALTIME_UPDATE);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check REALTIME_UPDATE_CPU option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_REALTIME_UPDATE_CPU, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_REALTIME_UPDATE_CPU, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_REALTIME_UPDATE_CPU, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_REALTIME_UPDATE_CPU);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check MEMORY_BASE option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_MEMORY_BASE, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_MEMORY_BASE, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_MEMORY_BASE, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_MEMORY_BASE);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check MEMORY_HELPER option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_MEMORY_HELPER, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_MEMORY_HELPER, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_MEMORY_HELPER, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_MEMORY_HELPER);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check TUNING option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_TUNING, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_TUNING, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_TUNING, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_TUNING);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check SPI_SPEED option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_SPI_SPEED, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_SPI_SPEED, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_SPI_SPEED, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_SPI_SPEED);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			// Check INTERRUPT option
+			if (0 == Platform_StringCompare(PwszKey, CONFIG_KEY_TPM_DEVICE_ACCESS_INTERRUPT, PunKeySize, FALSE))
+			{
+				// Store setting value
+				if (!PropertyStorage_AddKeyValuePair(PROPERTY_TPM_INTERRUPT, PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(PROPERTY_TPM_INTERRUPT, PwszValue))
+				{
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_TPM_INTERRUPT);
+					break;
+				}
+
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
 			// Unknown setting in current section
 			unReturnValue = RC_SUCCESS;
 			break;
 		}
+
+		// Check section TPM_SIMULATOR options
+		if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_TPM_SIMULATOR, PunSectionSize, FALSE))
+		{
+			const wchar_t* rgwszSimulatorSettings[][2] = {
+				{CONFIG_KEY_TPM_SIMULATOR_PROFILE, PROPERTY_TPM_SIMULATOR_PROFILE},
+				{CONFIG_KEY_TPM_SIMULATOR_FIRMWARE_VERSION, PROPERTY_TPM_SIMULATOR_FIRMWARE_VERSION},
+				{CONFIG_KEY_TPM_SIMULATOR_DECRYPT_KEY_ID, PROPERTY_TPM_SIMULATOR_DECRYPT_KEY_ID},
+				{CONFIG_KEY_TPM_SIMULATOR_LATENCY, PROPERTY_TPM_SIMULATOR_LATENCY},
+				{CONFIG_KEY_TPM_SIMULATOR_LATENCY_START, PROPERTY_TPM_SIMULATOR_LATENCY_START},
+				{CONFIG_KEY_TPM_SIMULATOR_LATENCY_UPDATE, PROPERTY_TPM_SIMULATOR_LATENCY_UPDATE},
+				{CONFIG_KEY_TPM_SIMULATOR_LATENCY_COMPLETE, PROPERTY_TPM_SIMULATOR_LATENCY_COMPLETE},
+				{CONFIG_KEY_TPM_SIMULATOR_FAIL_COMMAND, PROPERTY_TPM_SIMULATOR_FAIL_COMMAND},
+				{CONFIG_KEY_TPM_SIMULATOR_FAIL_COUNT, PROPERTY_TPM_SIMULATOR_FAIL_COUNT},
+				{CONFIG_KEY_TPM_SIMULATOR_FAIL_CODE, PROPERTY_TPM_SIMULATOR_FAIL_CODE},
+				{CONFIG_KEY_TPM_SIMULATOR_INTERFACE, PROPERTY_TPM_SIMULATOR_INTERFACE},
+				{CONFIG_KEY_TPM_SIMULATOR_REGISTER_COST, PROPERTY_TPM_SIMULATOR_REGISTER_COST},
+				{CONFIG_KEY_TPM_SIMULATOR_BURST_COUNT, PROPERTY_TPM_SIMULATOR_BURST_COUNT},
+				{CONFIG_KEY_TPM_SIMULATOR_READY_DELAY, PROPERTY_TPM_SIMULATOR_READY_DELAY},
+				{CONFIG_KEY_TPM_SIMULATOR_TRANSFER_SIZE, PROPERTY_TPM_SIMULATOR_TRANSFER_SIZE}};
+			unsigned int unIndex = 0;
+
+			// Unknown settings in the current section are ignored
+			unReturnValue = RC_SUCCESS;
+			for (unIndex = 0; unIndex < RG_LEN(rgwszSimulatorSettings); unIndex++)
+			{
+				if (0 != Platform_StringCompare(PwszKey, rgwszSimulatorSettings[unIndex][0], PunKeySize, FALSE))
+					continue;
+
+				// Store setting value, the simulator settings have no defaults in the property storage
+				if (!PropertyStorage_AddKeyValuePair(rgwszSimulatorSettings[unIndex][1], PwszValue) &&
+						!PropertyStorage_ChangeValueByKey(rgwszSimulatorSettings[unIndex][1], PwszValue))
+				{
+					unReturnValue = RC_E_FAIL;
+					ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, rgwszSimulatorSettings[unIndex][1]);
+				}
+				break;
+			}
+			break;
+		}
 		// Unknown section
 		unReturnValue = RC_SUCCESS;
 	}
@@ -337,6 +724,60 @@ ConfigSettings_FinalizeParsing(
 			}
 			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_MAXSIZE, wszValue);
 
+			unValueSize = RG_LEN(wszValue);
+			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_MAX_FILES, wszValue, &unValueSize))
+			{
+				ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_MAX_FILES);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_MAX_FILES, wszValue);
+
+			unValueSize = RG_LEN(wszValue);
+			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_FLUSH_INTERVAL, wszValue, &unValueSize))
+			{
+				ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_FLUSH_INTERVAL);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_FLUSH_INTERVAL, wszValue);
+
+			unValueSize = RG_LEN(wszValue);
+			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_ASYNC, wszValue, &unValueSize))
+			{
+				ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_ASYNC);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_ASYNC, wszValue);
+
+			unValueSize = RG_LEN(wszValue);
+			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_COMPRESS, wszValue, &unValueSize))
+			{
+				ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_COMPRESS);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_COMPRESS, wszValue);
+
+			unValueSize = RG_LEN(wszValue);
+			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_JSON, wszValue, &unValueSize))
+			{
+				ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_JSON);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_JSON, wszValue);
+
+			unValueSize = RG_LEN(wszValue);
+			if (TRUE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_MODULE_LEVELS, wszValue, &unValueSize))
+			{
+				LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_MODULE_LEVELS, wszValue);
+			}
+
+			unValueSize = RG_LEN(wszValue);
+			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOGGING_BLOCK_SAMPLE, wszValue, &unValueSize))
+			{
+				ERROR_STORE_FMT(unReturnValue, wszErrorMsgFormat, PROPERTY_LOGGING_BLOCK_SAMPLE);
+				break;
+			}
+			LOGGING_WRITE_LEVEL4_FMT(L"%ls: %ls", PROPERTY_LOGGING_BLOCK_SAMPLE, wszValue);
+
 			unValueSize = RG_LEN(wszValue);
 			if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_LOCALITY, wszValue, &unValueSize))
 			{
@@ -370,3 +811,37 @@ ConfigSettings_FinalizeParsing(
 
 	return unReturnValue;
 }
+
+/**
+ *	@brief		Prepares the reload of a changed configuration section
+ *	@details	Called by Config_Reload for every section changed, added or removed since the last reload. Only the LOGGING
+ *				section is re-ingested, the logging levels follow their properties at once. The other sections configure the
+ *				TPM connection and the console at start, they take effect after a restart so that the warm connection is
+ *				kept. Keys removed from a section keep their value until the restart.
+ *
+ *	@param		PwszSection			Pointer to a wide character array containing the section
+ *	@param		PunSectionSize		Size of the section buffer in elements including the zero termination
+ *	@param		PfRemoved			TRUE if the section has been removed from the file
+ *	@param		PpfApply			Receives TRUE if the section is re-ingested
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_FAIL			An unexpected error occurred.
+ */
+_Check_return_
+unsigned int
+ConfigSettings_ReloadSection(
+	_In_z_count_(PunSectionSize)	const wchar_t*	PwszSection,
+	_In_							unsigned int	PunSectionSize,
+	_In_							BOOL			PfRemoved,
+	_Out_							BOOL*			PpfApply)
+{
+	*PpfApply = FALSE;
+
+	if (0 == Platform_StringCompare(PwszSection, CONFIG_SECTION_LOGGING, PunSectionSize, FALSE))
+		*PpfApply = !PfRemoved;
+	else
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"The changed config section [%ls] takes effect after a restart, the TPM connection is kept.", PwszSection);
+	}
+
+	return RC_SUCCESS;
+}
@@ -28,6 +28,20 @@ extern "C" {
 #define CONFIG_KEY_LOGGING_PATH			L"PATH"
 /// Define for LOGGING section setting MAXSIZE
 #define CONFIG_KEY_LOGGING_MAXSIZE		L"MAXSIZE"
+/// Define for LOGGING section setting MAXFILES
+#define CONFIG_KEY_LOGGING_MAX_FILES	L"MAXFILES"
+/// Define for LOGGING section setting COMPRESS (gzip the rotated log files)
+#define CONFIG_KEY_LOGGING_COMPRESS		L"COMPRESS"
+/// Define for LOGGING section setting FLUSHINTERVAL
+#define CONFIG_KEY_LOGGING_FLUSH_INTERVAL	L"FLUSHINTERVAL"
+/// Define for LOGGING section setting ASYNC
+#define CONFIG_KEY_LOGGING_ASYNC		L"ASYNC"
+/// Define for LOGGING section setting JSON
+#define CONFIG_KEY_LOGGING_JSON			L"JSON"
+/// Define for LOGGING section setting MODULE_LEVELS (comma separated <module>:<level> entries)
+#define CONFIG_KEY_LOGGING_MODULE_LEVELS	L"MODULE_LEVELS"
+/// Define for LOGGING section setting BLOCK_SAMPLE (every Nth firmware block is logged in full)
+#define CONFIG_KEY_LOGGING_BLOCK_SAMPLE	L"BLOCK_SAMPLE"
 
 /// Define for configuration section ACCESS_MODE
 #define CONFIG_SECTION_ACCESS_MODE		L"ACCESS_MODE"
@@ -42,6 +56,65 @@ extern "C" {
 #define CONFIG_SECTION_TPM_DEVICE_ACCESS	L"TPM_DEVICE_ACCESS"
 /// Define for TPM_DEVICE_ACCESS section setting MODE
 #define CONFIG_KEY_TPM_DEVICE_ACCESS_MODE	L"MODE"
+/// Define for TPM_DEVICE_ACCESS section setting RECORD (capture file recording all TPM commands)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_RECORD	L"RECORD"
+/// Define for TPM_DEVICE_ACCESS section setting REPLAY_TIMING_SCALE (percent of the recorded command durations)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_REPLAY_TIMING_SCALE	L"REPLAY_TIMING_SCALE"
+/// Define for TPM_DEVICE_ACCESS section setting SOCKET_POWER_ON (TRUE powers a software TPM on before use)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_SOCKET_POWER_ON	L"SOCKET_POWER_ON"
+/// Define for TPM_DEVICE_ACCESS section setting TROUBLESHOOTING_FRAMES (number of recent TPM commands logged after an error)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_TROUBLESHOOTING_FRAMES	L"TROUBLESHOOTING_FRAMES"
+/// Define for TPM_DEVICE_ACCESS section setting TROUBLESHOOTING (TRUE logs the full last TPM command and response after an error)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_TROUBLESHOOTING	L"TROUBLESHOOTING"
+/// Define for TPM_DEVICE_ACCESS section setting LOCK_TIMEOUT (seconds to wait for another instance using the TPM device)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_LOCK_TIMEOUT	L"LOCK_TIMEOUT"
+/// Define for TPM_DEVICE_ACCESS section setting REALTIME_UPDATE (TRUE raises the scheduling of the firmware transfer)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_REALTIME_UPDATE	L"REALTIME_UPDATE"
+/// Define for TPM_DEVICE_ACCESS section setting REALTIME_UPDATE_CPU (CPU the firmware transfer is pinned to)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_REALTIME_UPDATE_CPU	L"REALTIME_UPDATE_CPU"
+/// Define for TPM_DEVICE_ACCESS section setting MEMORY_BASE (physical address of the TPM registers for memory based access)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_MEMORY_BASE	L"MEMORY_BASE"
+/// Define for TPM_DEVICE_ACCESS section setting MEMORY_HELPER (Unix socket of TPMMemoryHelper accessing the TPM registers)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_MEMORY_HELPER	L"MEMORY_HELPER"
+/// Define for TPM_DEVICE_ACCESS section setting TUNING (auto, calibrate or off, TIS polling parameters of memory based access)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_TUNING	L"TUNING"
+/// Define for TPM_DEVICE_ACCESS section setting SPI_SPEED (SPI clock in Hz for the SPI access mode)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_SPI_SPEED	L"SPI_SPEED"
+/// Define for TPM_DEVICE_ACCESS section setting INTERRUPT (UIO device of the TPM interrupt for memory based access)
+#define CONFIG_KEY_TPM_DEVICE_ACCESS_INTERRUPT	L"INTERRUPT"
+
+/// Define for configuration section TPM_SIMULATOR
+#define CONFIG_SECTION_TPM_SIMULATOR					L"TPM_SIMULATOR"
+/// Define for TPM_SIMULATOR section setting PROFILE (tpm12, tpm20 or bootloader)
+#define CONFIG_KEY_TPM_SIMULATOR_PROFILE				L"PROFILE"
+/// Define for TPM_SIMULATOR section setting FIRMWARE_VERSION
+#define CONFIG_KEY_TPM_SIMULATOR_FIRMWARE_VERSION		L"FIRMWARE_VERSION"
+/// Define for TPM_SIMULATOR section setting DECRYPT_KEY_ID
+#define CONFIG_KEY_TPM_SIMULATOR_DECRYPT_KEY_ID			L"DECRYPT_KEY_ID"
+/// Define for TPM_SIMULATOR section setting LATENCY (microseconds per command)
+#define CONFIG_KEY_TPM_SIMULATOR_LATENCY				L"LATENCY"
+/// Define for TPM_SIMULATOR section setting LATENCY_START (microseconds)
+#define CONFIG_KEY_TPM_SIMULATOR_LATENCY_START			L"LATENCY_START"
+/// Define for TPM_SIMULATOR section setting LATENCY_UPDATE (microseconds per firmware block)
+#define CONFIG_KEY_TPM_SIMULATOR_LATENCY_UPDATE			L"LATENCY_UPDATE"
+/// Define for TPM_SIMULATOR section setting LATENCY_COMPLETE (microseconds)
+#define CONFIG_KEY_TPM_SIMULATOR_LATENCY_COMPLETE		L"LATENCY_COMPLETE"
+/// Define for TPM_SIMULATOR section setting FAIL_COMMAND (command code, ordinal or 0xAAxx for FieldUpgrade sub commands)
+#define CONFIG_KEY_TPM_SIMULATOR_FAIL_COMMAND			L"FAIL_COMMAND"
+/// Define for TPM_SIMULATOR section setting FAIL_COUNT (occurrence of FAIL_COMMAND to fail, 0 disables)
+#define CONFIG_KEY_TPM_SIMULATOR_FAIL_COUNT				L"FAIL_COUNT"
+/// Define for TPM_SIMULATOR section setting FAIL_CODE (TPM response code of the failed command)
+#define CONFIG_KEY_TPM_SIMULATOR_FAIL_CODE				L"FAIL_CODE"
+/// Define for TPM_SIMULATOR section setting INTERFACE (command or tis)
+#define CONFIG_KEY_TPM_SIMULATOR_INTERFACE				L"INTERFACE"
+/// Define for TPM_SIMULATOR section setting REGISTER_COST (nanoseconds per TIS register access)
+#define CONFIG_KEY_TPM_SIMULATOR_REGISTER_COST			L"REGISTER_COST"
+/// Define for TPM_SIMULATOR section setting BURST_COUNT (maximum TIS burst count)
+#define CONFIG_KEY_TPM_SIMULATOR_BURST_COUNT			L"BURST_COUNT"
+/// Define for TPM_SIMULATOR section setting READY_DELAY (microseconds until commandReady and a locality are granted)
+#define CONFIG_KEY_TPM_SIMULATOR_READY_DELAY			L"READY_DELAY"
+/// Define for TPM_SIMULATOR section setting TRANSFER_SIZE (DataTransferSizeSupport field of the TIS interface capability, 0-3)
+#define CONFIG_KEY_TPM_SIMULATOR_TRANSFER_SIZE			L"TRANSFER_SIZE"
 
 /// Define for update-file config section UpdateType
 #define CONFIG_SECTION_UPDATE_TYPE		L"UpdateType"
@@ -55,6 +128,8 @@ extern "C" {
 #define CONFIG_TARGET_FIRMWARE_VERSION_LPC	L"version_SLB966x"
 /// Define for target firmware section setting versionSPI
 #define CONFIG_TARGET_FIRMWARE_VERSION_SPI	L"version_SLB9670"
+/// Define for update-file config section TargetFirmwareRules, each setting maps TPM firmware versions to a target firmware
+#define CONFIG_SECTION_TARGET_FIRMWARE_RULES	L"TargetFirmwareRules"
 /// Define for update-file config section FirmwareFolder
 #define CONFIG_SECTION_FIRMWARE_FOLDER	L"FirmwareFolder"
 /// Define for firmware folder section setting path
@@ -64,6 +139,27 @@ extern "C" {
 /// Set to 0 to disable and ensure log file is opened in O_APPEND mode.
 #define LOGGING_FILE_MAX_SIZE			0
 
+/// Default number of rotated log files (<log-file>.1 ... <log-file>.N) kept when the max log file size is reached
+/// Set to 0 to overwrite the log file instead.
+#define LOGGING_FILE_MAX_FILES			0
+
+/// Default for compressing the rotated log files to <log-file>.N.gz in the background (TRUE or FALSE)
+#define LOGGING_FILE_COMPRESS			FALSE
+
+/// Default interval in milliseconds after which buffered log messages are written to the log file
+/// Set to 0 to write every message to the log file immediately.
+#define LOGGING_FILE_FLUSH_INTERVAL		1000
+
+/// Default for writing the log file from a background thread (TRUE or FALSE)
+#define LOGGING_FILE_ASYNC				TRUE
+
+/// Default for writing log lines as JSON records, one per line (TRUE or FALSE)
+#define LOGGING_FILE_JSON				FALSE
+
+/// Default sample interval of the firmware blocks logged in full during the firmware transfer
+/// Set to 1 to log every block in full.
+#define LOGGING_BLOCK_SAMPLE			1
+
 /// Definition of Locality 0 for accessing TPM
 #define LOCALITY_0						0
 
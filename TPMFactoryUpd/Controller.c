@@ -19,6 +19,70 @@
 #include "CommandFlow_TpmInfo.h"
 #include "CommandFlow_TpmUpdate.h"
 #include "CommandFlow_Tpm12ClearOwnership.h"
+#include "CommandFlow_Benchmark.h"
+#include "CommandFlow_CheckImages.h"
+#include "CommandFlow_DecodeCapture.h"
+#include "CommandFlow_BuildFrames.h"
+#include "Metrics.h"
+#include "FlightRecorder.h"
+
+/// Number of call sites with the most allocated bytes written by Controller_LogMemoryStatistics
+#define CONTROLLER_MEMORY_TOP_CALL_SITES 10
+
+/**
+ *	@brief		Logs the allocation counters
+ *	@details	Writes the heap and scratch arena counters, the call sites with the most allocated bytes and the call sites
+ *				with allocations not freed at exit to the log file if the -stats command line option is set.
+ */
+static void
+Controller_LogMemoryStatistics()
+{
+	IfxMemoryStatistics sStatistics;
+	IfxMemoryCallSite rgsCallSites[PLATFORM_MEMORY_CALL_SITE_COUNT];
+	unsigned int unCallSiteCount = RG_LEN(rgsCallSites);
+	unsigned int unIndex = 0;
+	BOOL fStatistics = FALSE;
+
+	if (FALSE == PropertyStorage_GetBooleanValueById(PROPERTY_ID_STATISTICS, &fStatistics) || FALSE == fStatistics)
+		return;
+
+	Platform_MemoryGetStatistics(&sStatistics);
+	Platform_MemoryGetCallSites(rgsCallSites, &unCallSiteCount);
+
+	LOGGING_WRITE_LEVEL1(L"Memory statistics:");
+	LOGGING_WRITE_LEVEL1_FMT(L"  Heap allocations / frees : %llu / %llu", sStatistics.ullAllocations, sStatistics.ullFrees);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Heap bytes peak          : %llu", sStatistics.ullPeakBytes);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Heap bytes at exit       : %llu", sStatistics.ullLiveBytes);
+	LOGGING_WRITE_LEVEL1_FMT(L"  Scratch allocations      : %llu (%llu bytes)", sStatistics.ullScratchAllocations, sStatistics.ullScratchBytes);
+
+	// Selection of the call sites with the most allocated bytes
+	LOGGING_WRITE_LEVEL1(L"Allocation call sites (bytes / allocations):");
+	for (unIndex = 0; unIndex < unCallSiteCount && unIndex < CONTROLLER_MEMORY_TOP_CALL_SITES; unIndex++)
+	{
+		unsigned int unMax = unIndex;
+		unsigned int unOther = 0;
+		IfxMemoryCallSite sCallSite;
+
+		for (unOther = unIndex + 1; unOther < unCallSiteCount; unOther++)
+		{
+			if (rgsCallSites[unOther].ullBytes > rgsCallSites[unMax].ullBytes)
+				unMax = unOther;
+		}
+		sCallSite = rgsCallSites[unMax];
+		rgsCallSites[unMax] = rgsCallSites[unIndex];
+		rgsCallSites[unIndex] = sCallSite;
+
+		LOGGING_WRITE_LEVEL1_FMT(L"  %s:%u : %llu / %llu", NULL == sCallSite.szFile ? "(other)" : sCallSite.szFile, sCallSite.unLine, sCallSite.ullBytes, sCallSite.ullAllocations);
+	}
+
+	// Allocations living until exit are either process lifetime data or leaks
+	LOGGING_WRITE_LEVEL1(L"Allocations not freed at exit (bytes / allocations):");
+	for (unIndex = 0; unIndex < unCallSiteCount; unIndex++)
+	{
+		if (0 != rgsCallSites[unIndex].ullLiveAllocations)
+			LOGGING_WRITE_LEVEL1_FMT(L"  %s:%u : %llu / %llu", NULL == rgsCallSites[unIndex].szFile ? "(other)" : rgsCallSites[unIndex].szFile, rgsCallSites[unIndex].unLine, rgsCallSites[unIndex].ullLiveBytes, rgsCallSites[unIndex].ullLiveAllocations);
+	}
+}
 
 /**
  *	@brief		This function shows the response output
@@ -69,23 +133,49 @@ Controller_Proceed(
 	unsigned int		unReturnValue = RC_E_FAIL;
 	unsigned int		unReturnValueError = RC_E_FAIL;
 	IfxToolHeader*	pResponseData = NULL;
+	BOOL				fDevices = FALSE;
 
 	// Logging not initialized yet
 
 	do
 	{
 		// Initialize controller and device
+		Platform_MemoryScratchBegin();
 		unReturnValue = Controller_Initialize(PnArgc, PrgwszArgv);
+		Platform_MemoryScratchEnd();
 		if (RC_SUCCESS != unReturnValue)
 			break;
 
 		// Now we can log
 		LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
+		// Several TPM devices are processed by worker processes
+		if (Controller_DevicesIsSet())
+		{
+			BOOL fWorker = FALSE;
+			unReturnValue = Controller_DevicesExecute(PnArgc, PrgwszArgv, &fWorker);
+			if (FALSE == fWorker)
+			{
+				fDevices = TRUE;
+				break;
+			}
+
+			// A forked worker connects its single TPM device and continues like a run with a single device path
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Controller_Connect();
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
 		unReturnValue = Controller_ProceedWork(&pResponseData);
 	}
 	WHILE_FALSE_END;
 
+	// Add the detail of the failed run to the log file
+	if (RC_SUCCESS != unReturnValue && RC_E_BAD_COMMANDLINE != unReturnValue)
+		FlightRecorder_Render(L"Flight recorder: The run failed. Its last records:");
+
 	// Call uninitialize also in an error case because some parts of the
 	// Initialize method could have been executed successfully e.g. DeviceManagement_Connect
 	unReturnValueError = Controller_Uninitialize();
@@ -103,12 +193,41 @@ Controller_Proceed(
 		}
 	}
 
-	// Check if structure type is TpmUpdate to free allocated file buffer memory
-	if (NULL != pResponseData && STRUCT_TYPE_TpmUpdate == pResponseData->unType)
-		Platform_MemoryFree((void**) & (((IfxUpdate*)pResponseData)->rgbFirmwareImage));
+	// Leave the final result in the progress file
+	Response_CloseProgressFile(NULL != Error_GetStack() ? Error_GetFinalCode() : unReturnValue);
+
+	// Show the JSON result document before the response data is released, a bad command line shows the help instead
+	// The JSON result documents of several TPM devices have already been shown
+	if (Response_IsJsonOutput() && !fDevices)
+	{
+		unsigned int unFinalCode = NULL != Error_GetStack() ? Error_GetFinalCode() : unReturnValue;
+		if (RC_E_BAD_COMMANDLINE != unFinalCode)
+		{
+			unReturnValueError = Response_ShowJsonResult(pResponseData, unFinalCode);
+			if (RC_SUCCESS != unReturnValueError)
+				LOGGING_WRITE_LEVEL1_FMT(L"An error occurred while showing the JSON result. Response_ShowJsonResult() failed. (0x%.8X)", unReturnValueError);
+		}
+	}
+
+	// Export the result as metrics, the worker processes of several TPM devices do not write them
+	if (!fDevices)
+	{
+		unsigned int unFinalCode = NULL != Error_GetStack() ? Error_GetFinalCode() : unReturnValue;
+		if (RC_E_BAD_COMMANDLINE != unFinalCode)
+		{
+			unReturnValueError = Metrics_Write(pResponseData, unFinalCode);
+			if (RC_SUCCESS != unReturnValueError)
+				LOGGING_WRITE_LEVEL1_FMT(L"An error occurred while writing the metrics. Metrics_Write() failed. (0x%.8X)", unReturnValueError);
+		}
+	}
+
+	// Show the phase timings before the response data is released
+	unReturnValueError = Response_ShowTimings(pResponseData);
+	if (RC_SUCCESS != unReturnValueError)
+		LOGGING_WRITE_LEVEL1_FMT(L"An error occurred while showing the phase timings. Response_ShowTimings() failed. (0x%.8X)", unReturnValueError);
 
 	// Free allocated memory
-	Platform_MemoryFree((void**)&pResponseData);
+	Controller_ReleaseResponse(&pResponseData);
 
 	// Do error handling now
 	if (NULL != Error_GetStack())
@@ -117,6 +236,12 @@ Controller_Proceed(
 		unReturnValue = Error_GetFinalCode();
 		if (RC_E_BAD_COMMANDLINE == unReturnValue)
 		{
+			// The help is always shown as text
+			if (Response_IsJsonOutput())
+				IGNORE_RETURN_VALUE(PropertyStorage_ChangeBooleanValueByKey(PROPERTY_JSON_OUTPUT, FALSE));
+			if (TRUE == PropertyStorage_ExistsElement(PROPERTY_QUIET_OUTPUT))
+				IGNORE_RETURN_VALUE(PropertyStorage_ChangeBooleanValueByKey(PROPERTY_QUIET_OUTPUT, FALSE));
+
 			// Show header
 			unReturnValueError = Response_ShowHeader();
 
@@ -142,8 +267,96 @@ Controller_Proceed(
 		Error_ClearStack();
 	}
 
+	Controller_LogMemoryStatistics();
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
+	// Write all buffered log messages and close the log files
+	Logging_CloseSessionSink();
+	Logging_Close();
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Releases the response structure returned by Controller_ProceedWork
+ *	@details	Releases the firmware image buffer of an update and the capture file buffer of a decoded capture as well.
+ *				A firmware image download which has not been used by the update is aborted.
+ *
+ *	@param		PppResponseData		Pointer to the response structure. Set to NULL on return.
+ */
+void
+Controller_ReleaseResponse(
+	_Inout_ IfxToolHeader** PppResponseData)
+{
+	IfxToolHeader* pResponseData = *PppResponseData;
+
+	// An update which ended before loading the image leaves its download pending
+	FileIO_CancelDownload();
+
+	// Check if structure type is TpmUpdate to release the firmware image buffer
+	if (NULL != pResponseData && STRUCT_TYPE_TpmUpdate == pResponseData->unType)
+	{
+		IfxUpdate* pTpmUpdate = (IfxUpdate*)pResponseData;
+		FirmwareImage_ReleaseBundleImage(pTpmUpdate->rgbFirmwareFile, pTpmUpdate->unFirmwareFileSize, &pTpmUpdate->rgbFirmwareImage);
+		Platform_MemoryFree((void**)&pTpmUpdate->rgbStreamLeafDigests);
+		FileIO_ReleaseFileBuffer(&pTpmUpdate->rgbFirmwareFile, pTpmUpdate->unFirmwareFileSize, pTpmUpdate->fFirmwareImageMapped);
+	}
+
+	// Check if structure type is DecodeCapture to release the capture file buffer and the record table
+	if (NULL != pResponseData && STRUCT_TYPE_DecodeCapture == pResponseData->unType)
+	{
+		IfxDecodeCapture* pDecodeCapture = (IfxDecodeCapture*)pResponseData;
+		Platform_MemoryFree((void**)&pDecodeCapture->rgsRecords);
+		Platform_MemoryFree((void**)&pDecodeCapture->rgbCaptureFile);
+	}
+
+	Platform_MemoryFree((void**)PppResponseData);
+}
+
+/**
+ *	@brief		Clears the TPM1.2 Ownership taken by the update of the same run
+ *	@details	Replaces the update response by a TPM1.2 clear ownership response and shows it.
+ *
+ *	@param		PppResponseData		Pointer to the response structure of the update
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_FAIL			Memory allocation failed.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+Controller_ClearOwnershipAfterUpdate(
+	_Inout_ IfxToolHeader** PppResponseData)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		Controller_ReleaseResponse(PppResponseData);
+		*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxTpm12ClearOwnership));
+		if (NULL == *PppResponseData)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Error detected in Controller_ClearOwnershipAfterUpdate: Memory allocation failed.");
+			break;
+		}
+		(*PppResponseData)->unSize = sizeof(IfxTpm12ClearOwnership);
+		(*PppResponseData)->unType = STRUCT_TYPE_Tpm12ClearOwnership;
+
+		unReturnValue = CommandFlow_Tpm12ClearOwnership_ExecuteAfterUpdate((IfxTpm12ClearOwnership*)*PppResponseData);
+		CommandFlow_TpmInfo_InvalidateCache();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Show command response
+		unReturnValue = Controller_ShowResponse(*PppResponseData);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = (*PppResponseData)->unReturnCode;
+	}
+	WHILE_FALSE_END;
+
 	return unReturnValue;
 }
 
@@ -166,6 +379,9 @@ Controller_ProceedWork(
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
+	// Line buffers and string conversions of the command are bump allocated and released together
+	Platform_MemoryScratchBegin();
+
 	do
 	{
 		unsigned int unCmdLineOptionCount = 0;
@@ -200,6 +416,27 @@ Controller_ProceedWork(
 			break;
 		}
 
+		// Check if Service is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_SERVICE))
+		{
+			unReturnValue = Controller_ServiceExecute();
+			break;
+		}
+
+		// Check if Batch is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BATCH))
+		{
+			unReturnValue = Controller_BatchExecute();
+			break;
+		}
+
+		// Check if the factory loop is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_FACTORY_LOOP))
+		{
+			unReturnValue = Controller_FactoryLoopExecute();
+			break;
+		}
+
 		// Check if Info is set
 		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_INFO, &fValue) && TRUE == fValue)
 		{
@@ -215,6 +452,8 @@ Controller_ProceedWork(
 			// Execute command
 			(*PppResponseData)->unSize = sizeof(IfxInfo);
 			(*PppResponseData)->unType = STRUCT_TYPE_TpmInfo;
+			Controller_GetInitializeTimings(
+				&((IfxInfo*)*PppResponseData)->sTimings, &((IfxInfo*)*PppResponseData)->sCpuTimings, &((IfxInfo*)*PppResponseData)->sWaitTimings);
 
 			unReturnValue = CommandFlow_TpmInfo_Execute((IfxInfo*)*PppResponseData);
 			if (RC_SUCCESS != unReturnValue &&
@@ -230,6 +469,22 @@ Controller_ProceedWork(
 		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_UPDATE, &fValue) && TRUE == fValue)
 		{
 			unsigned int unUpdateType = UPDATE_TYPE_NONE;
+			BOOL fCheckOnly = PropertyStorage_ExistsElement(PROPERTY_SERVICE_CHECK);
+			BOOL fPrepareOnly = PropertyStorage_ExistsElement(PROPERTY_PREPARE);
+			BOOL fNextUpdate = FALSE;
+			BOOL fClearOwnership = FALSE;
+
+			// The update changes the firmware version and the field upgrade counter, a service check request does not
+			if (!fCheckOnly)
+			{
+				CommandFlow_TpmInfo_InvalidateCache();
+				CommandFlow_TpmUpdate_LoadUpdateJournal();
+			}
+
+			// Orchestrators poll the progress file instead of parsing the console output
+			unReturnValue = Response_OpenProgressFile();
+			if (RC_SUCCESS != unReturnValue)
+				break;
 
 			// Allocate memory
 			Platform_MemoryFree((void**)PppResponseData);
@@ -241,58 +496,243 @@ Controller_ProceedWork(
 				break;
 			}
 
-			// Get the TPM information and use the update structure to store the data
-			(*PppResponseData)->unType = STRUCT_TYPE_TpmInfo;
-			(*PppResponseData)->unSize = sizeof(IfxInfo);
-			unReturnValue = CommandFlow_TpmInfo_Execute((IfxInfo*)*PppResponseData);
-			if (RC_SUCCESS != unReturnValue)
-				break;
+			// Download a firmware image URL while the TPM is probed unless it is cached
+			CommandFlow_TpmUpdate_ResolveImageCache();
+			{
+				wchar_t wszFirmwareImagePath[MAX_PATH] = {0};
+				unsigned int unFirmwareImagePathSize = RG_LEN(wszFirmwareImagePath);
+				if (TRUE == PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, wszFirmwareImagePath, &unFirmwareImagePathSize) &&
+						FileIO_IsUrl(wszFirmwareImagePath))
+				{
+					IGNORE_RETURN_VALUE(FileIO_StartDownload(wszFirmwareImagePath));
+				}
+			}
 
-			// Execute command
-			(*PppResponseData)->unSize = sizeof(IfxUpdate);
-			(*PppResponseData)->unType = STRUCT_TYPE_TpmUpdate;
+			// A config file may need several firmware updates, each one starts with a refresh of the TPM state
+			do
+			{
+				// Get the TPM information and use the update structure to store the data
+				(*PppResponseData)->unType = STRUCT_TYPE_TpmInfo;
+				(*PppResponseData)->unSize = sizeof(IfxInfo);
+				Controller_GetInitializeTimings(
+					&((IfxInfo*)*PppResponseData)->sTimings, &((IfxInfo*)*PppResponseData)->sCpuTimings, &((IfxInfo*)*PppResponseData)->sWaitTimings);
+				unReturnValue = CommandFlow_TpmInfo_Execute((IfxInfo*)*PppResponseData);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				// Execute command
+				(*PppResponseData)->unSize = sizeof(IfxUpdate);
+				(*PppResponseData)->unType = STRUCT_TYPE_TpmUpdate;
+
+				// Get property "update type"
+				if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_UPDATE_TYPE, &unUpdateType))
+				{
+					unReturnValue = RC_E_FAIL;
+					ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetUIntegerValueByKey failed to get property '%ls'.", PROPERTY_UPDATE_TYPE);
+					break;
+				}
+
+				// If update type is config file parse configuration file
+				if (UPDATE_TYPE_CONFIG_FILE == unUpdateType)
+				{
+					unReturnValue = CommandFlow_TpmUpdate_ProceedUpdateConfig((IfxUpdate*)*PppResponseData);
+					if (RC_SUCCESS != unReturnValue)
+						break;
+				}
+
+				// Check if firmware is updatable with the given image
+				if(RC_E_ALREADY_UP_TO_DATE != (*PppResponseData)->unReturnCode)
+				{
+					unReturnValue = CommandFlow_TpmUpdate_IsFirmwareUpdatable((IfxUpdate*)*PppResponseData);
+					if (RC_SUCCESS != unReturnValue)
+						break;
+				}
+
+				unReturnValue = Controller_ShowResponse(*PppResponseData);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				if (RC_SUCCESS != (*PppResponseData)->unReturnCode)
+				{
+					if (RC_E_ALREADY_UP_TO_DATE == (*PppResponseData)->unReturnCode)
+						unReturnValue = RC_SUCCESS;
+					else
+						unReturnValue = (*PppResponseData)->unReturnCode;
+					break;
+				}
+
+				// A service check request ends after the image checks
+				if (fCheckOnly)
+					break;
+
+				// Do preparation steps
+				unReturnValue = CommandFlow_TpmUpdate_PrepareFirmwareUpdate((IfxUpdate*)*PppResponseData);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				// Record the update plan for a later run with the commit option instead of updating now
+				if (fPrepareOnly && RC_SUCCESS == (*PppResponseData)->unReturnCode)
+				{
+					unReturnValue = CommandFlow_TpmUpdate_StoreUpdatePlan((IfxUpdate*)*PppResponseData);
+					if (RC_SUCCESS != unReturnValue)
+						break;
+				}
+
+				unReturnValue = Controller_ShowResponse(*PppResponseData);
+				if (RC_SUCCESS != unReturnValue)
+					break;
 
-			// Get property "update type"
-			if (FALSE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_UPDATE_TYPE, &unUpdateType))
+				if (RC_SUCCESS != (*PppResponseData)->unReturnCode)
+				{
+					unReturnValue = (*PppResponseData)->unReturnCode;
+					break;
+				}
+
+				if (fPrepareOnly)
+					break;
+
+				// Do a firmware update
+				unReturnValue = CommandFlow_TpmUpdate_UpdateFirmware((IfxUpdate*)*PppResponseData);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				unReturnValue = Controller_ShowResponse(*PppResponseData);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				if (RC_SUCCESS != (*PppResponseData)->unReturnCode)
+				{
+					unReturnValue = (*PppResponseData)->unReturnCode;
+					break;
+				}
+
+				// The Ownership is only left behind by a tpm12-takeownership update which stays on TPM1.2
+				fClearOwnership = FALSE;
+				if (TRUE == PropertyStorage_ExistsElement(PROPERTY_CLEAROWNERSHIP_AFTER) &&
+						TRUE == PropertyStorage_GetUIntegerValueByKey(PROPERTY_UPDATE_TYPE, &unUpdateType) &&
+						UPDATE_TYPE_TPM12_TAKEOWNERSHIP == unUpdateType &&
+						DEVICE_TYPE_TPM_12 == ((IfxUpdate*)*PppResponseData)->bTargetFamily)
+				{
+					fClearOwnership = TRUE;
+				}
+
+				// Continue with the next firmware image of an update chain
+				CommandFlow_TpmUpdate_PrepareNextUpdate((IfxUpdate*)*PppResponseData, &fNextUpdate);
+			}
+			while (fNextUpdate);
+			CommandFlow_TpmUpdate_ReleaseNextImagePrefetch();
+
+			if (RC_SUCCESS == unReturnValue && fClearOwnership)
+			{
+				if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_DRY_RUN, &fValue) && TRUE == fValue)
+				{
+					LOGGING_WRITE_LEVEL2(L"Dry run: skipping the TPM1.2 clear ownership after the update.");
+				}
+				else
+				{
+					unReturnValue = Controller_ClearOwnershipAfterUpdate(PppResponseData);
+				}
+			}
+			else if (RC_SUCCESS == unReturnValue && TRUE == PropertyStorage_ExistsElement(PROPERTY_CLEAROWNERSHIP_AFTER))
+			{
+				LOGGING_WRITE_LEVEL2(L"No TPM1.2 Ownership was taken by the update, clear ownership is skipped.");
+			}
+
+			break;
+		}
+
+		// Check if TPM12-ClearOwnership is set
+		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_TPM12_CLEAROWNERSHIP, &fValue) && TRUE == fValue)
+		{
+			// Clearing the ownership changes the TPM state
+			CommandFlow_TpmInfo_InvalidateCache();
+
+			// Allocate memory
+			Platform_MemoryFree((void**)PppResponseData);
+			*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxTpm12ClearOwnership));
+			if (NULL == *PppResponseData)
 			{
 				unReturnValue = RC_E_FAIL;
-				ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetUIntegerValueByKey failed to get property '%ls'.", PROPERTY_UPDATE_TYPE);
+				ERROR_STORE(unReturnValue, L"Error detected in Controller_ProceedWork: Memory allocation failed.");
 				break;
 			}
+			// Execute command
+			(*PppResponseData)->unSize = sizeof(IfxTpm12ClearOwnership);
+			(*PppResponseData)->unType = STRUCT_TYPE_Tpm12ClearOwnership;
+
+			unReturnValue = CommandFlow_Tpm12ClearOwnership_Execute((IfxToolHeader*)*PppResponseData);
+			if (RC_SUCCESS != unReturnValue)
+				break;
 
-			// If update type is config file parse configuration file
-			if (UPDATE_TYPE_CONFIG_FILE == unUpdateType)
+			// Show command response
+			unReturnValue = Controller_ShowResponse(*PppResponseData);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			if (RC_SUCCESS != (*PppResponseData)->unReturnCode)
 			{
-				unReturnValue = CommandFlow_TpmUpdate_ProceedUpdateConfig((IfxUpdate*)*PppResponseData);
-				if (RC_SUCCESS != unReturnValue)
-					break;
+				unReturnValue = (*PppResponseData)->unReturnCode;
+				break;
 			}
 
-			// Check if firmware is updatable with the given image
-			if(RC_E_ALREADY_UP_TO_DATE != (*PppResponseData)->unReturnCode)
+			break;
+		}
+
+		// Check if Benchmark is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BENCHMARK))
+		{
+			// Allocate memory
+			Platform_MemoryFree((void**)PppResponseData);
+			*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxBenchmark));
+			if (NULL == *PppResponseData)
 			{
-				unReturnValue = CommandFlow_TpmUpdate_IsFirmwareUpdatable((IfxUpdate*)*PppResponseData);
-				if (RC_SUCCESS != unReturnValue)
-					break;
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Error detected in Controller_ProceedWork: Memory allocation failed.");
+				break;
 			}
+			// Execute command
+			(*PppResponseData)->unSize = sizeof(IfxBenchmark);
+			(*PppResponseData)->unType = STRUCT_TYPE_Benchmark;
 
+			unReturnValue = CommandFlow_Benchmark_Execute((IfxBenchmark*)*PppResponseData);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Show command response
 			unReturnValue = Controller_ShowResponse(*PppResponseData);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
 			if (RC_SUCCESS != (*PppResponseData)->unReturnCode)
 			{
-				if (RC_E_ALREADY_UP_TO_DATE == (*PppResponseData)->unReturnCode)
-					unReturnValue = RC_SUCCESS;
-				else
-					unReturnValue = (*PppResponseData)->unReturnCode;
+				unReturnValue = (*PppResponseData)->unReturnCode;
 				break;
 			}
 
-			// Do preparation steps
-			unReturnValue = CommandFlow_TpmUpdate_PrepareFirmwareUpdate((IfxUpdate*)*PppResponseData);
+			break;
+		}
+
+		// Check if CheckImages is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_CHECK_IMAGES))
+		{
+			// Allocate memory
+			Platform_MemoryFree((void**)PppResponseData);
+			*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxCheckImages));
+			if (NULL == *PppResponseData)
+			{
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Error detected in Controller_ProceedWork: Memory allocation failed.");
+				break;
+			}
+			// Execute command
+			(*PppResponseData)->unSize = sizeof(IfxCheckImages);
+			(*PppResponseData)->unType = STRUCT_TYPE_CheckImages;
+
+			unReturnValue = CommandFlow_CheckImages_Execute((IfxCheckImages*)*PppResponseData);
 			if (RC_SUCCESS != unReturnValue)
 				break;
+
+			// Show command response
 			unReturnValue = Controller_ShowResponse(*PppResponseData);
 			if (RC_SUCCESS != unReturnValue)
 				break;
@@ -303,11 +743,30 @@ Controller_ProceedWork(
 				break;
 			}
 
-			// Do a firmware update
-			unReturnValue = CommandFlow_TpmUpdate_UpdateFirmware((IfxUpdate*)*PppResponseData);
+			break;
+		}
+
+		// Check if DecodeCapture is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_DECODE_CAPTURE))
+		{
+			// Allocate memory
+			Platform_MemoryFree((void**)PppResponseData);
+			*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxDecodeCapture));
+			if (NULL == *PppResponseData)
+			{
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Error detected in Controller_ProceedWork: Memory allocation failed.");
+				break;
+			}
+			// Execute command
+			(*PppResponseData)->unSize = sizeof(IfxDecodeCapture);
+			(*PppResponseData)->unType = STRUCT_TYPE_DecodeCapture;
+
+			unReturnValue = CommandFlow_DecodeCapture_Execute((IfxDecodeCapture*)*PppResponseData);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
+			// Show command response
 			unReturnValue = Controller_ShowResponse(*PppResponseData);
 			if (RC_SUCCESS != unReturnValue)
 				break;
@@ -321,12 +780,12 @@ Controller_ProceedWork(
 			break;
 		}
 
-		// Check if TPM12-ClearOwnership is set
-		if (TRUE == PropertyStorage_GetBooleanValueByKey(PROPERTY_TPM12_CLEAROWNERSHIP, &fValue) && TRUE == fValue)
+		// Check if BuildFrames is set
+		if (TRUE == PropertyStorage_ExistsElement(PROPERTY_BUILD_FRAMES))
 		{
 			// Allocate memory
 			Platform_MemoryFree((void**)PppResponseData);
-			*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxTpm12ClearOwnership));
+			*PppResponseData = (IfxToolHeader*)Platform_MemoryAllocateZero(sizeof(IfxBuildFrames));
 			if (NULL == *PppResponseData)
 			{
 				unReturnValue = RC_E_FAIL;
@@ -334,10 +793,10 @@ Controller_ProceedWork(
 				break;
 			}
 			// Execute command
-			(*PppResponseData)->unSize = sizeof(IfxTpm12ClearOwnership);
-			(*PppResponseData)->unType = STRUCT_TYPE_Tpm12ClearOwnership;
+			(*PppResponseData)->unSize = sizeof(IfxBuildFrames);
+			(*PppResponseData)->unType = STRUCT_TYPE_BuildFrames;
 
-			unReturnValue = CommandFlow_Tpm12ClearOwnership_Execute((IfxToolHeader*)*PppResponseData);
+			unReturnValue = CommandFlow_BuildFrames_Execute((IfxBuildFrames*)*PppResponseData);
 			if (RC_SUCCESS != unReturnValue)
 				break;
 
@@ -361,6 +820,8 @@ Controller_ProceedWork(
 	}
 	WHILE_FALSE_END;
 
+	Platform_MemoryScratchEnd();
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
@@ -37,6 +37,18 @@ Controller_Initialize(
 	_In_					int						PnArgc,
 	_In_reads_z_(PnArgc)	const wchar_t* const	PrgwszArgv[]);
 
+/**
+ *	@brief		Connects the TPM device and runs the product specific initialization tasks
+ *	@details	The TPM is not connected if the product can process the request without TPM access. Called by
+ *				Controller_Initialize and by a forked worker once its single TPM device path is set.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_Connect();
+
 /**
  *	@brief		This function shows the response output
  *	@details
@@ -76,6 +88,31 @@ _Check_return_
 unsigned int
 Controller_Uninitialize();
 
+/**
+ *	@brief		Disconnects the TPM device
+ *	@details	A TPM2.0 started up by this tool is shut down orderly before. Does nothing if the TPM is not connected.
+ *
+ *	@retval		RC_SUCCESS		The operation completed successfully.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_Disconnect();
+
+/**
+ *	@brief		Returns the duration of the phases run by Controller_Initialize
+ *	@details	Sets the command line, configuration file and TPM connection times, the other members are set to zero.
+ *
+ *	@param		PpsTimings		Receives the phase timings
+ *	@param		PpsCpuTimings	Receives the host CPU time of the phases
+ *	@param		PpsWaitTimings	Receives the time of the phases spent waiting for the TPM
+ */
+void
+Controller_GetInitializeTimings(
+	_Out_	IfxPhaseTimings*	PpsTimings,
+	_Out_	IfxPhaseTimings*	PpsCpuTimings,
+	_Out_	IfxPhaseTimings*	PpsWaitTimings);
+
 /**
  *	@brief		This function controls the TPMFactoryUpd view and business layers regarding the provided command line.
  *	@details	This function handles the program flow between UI and business modules.
@@ -91,6 +128,107 @@ unsigned int
 Controller_ProceedWork(
 	_Inout_ IfxToolHeader** PppResponseData);
 
+/**
+ *	@brief		Releases the response structure returned by Controller_ProceedWork
+ *	@details	Releases the firmware image buffer of an update and the capture file buffer of a decoded capture as well.
+ *
+ *	@param		PppResponseData		Pointer to the response structure. Set to NULL on return.
+ */
+void
+Controller_ReleaseResponse(
+	_Inout_ IfxToolHeader** PppResponseData);
+
+/**
+ *	@brief		Serves info, check and update requests on a local socket
+ *	@details	Runs for the -service command line option with the TPM connected by Controller_Initialize. Each request is
+ *				processed by Controller_ProceedWork like the command line of a separate process and answered with the JSON
+ *				result document. The TPM state is kept in memory between the requests until a request changes it.
+ *
+ *	@retval		RC_SUCCESS		The service has been stopped by a stop request.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_ServiceExecute();
+
+/**
+ *	@brief		Removes the properties set by the command line of a request
+ *	@details	Used between the requests of the service, batch and library modes, so the next request is parsed like the
+ *				command line of a separate process.
+ */
+void
+Controller_ClearRequestProperties();
+
+/**
+ *	@brief		Processes the info, check, update and clearownership operations of a batch file
+ *	@details	Runs for the -batch command line option with the TPM connected by Controller_Initialize. Each line of the
+ *				file (or stdin) is processed like a service request and its JSON result document is shown as one line.
+ *				Stops at the first failed operation.
+ *
+ *	@retval		RC_SUCCESS		All operations completed successfully.
+ *	@retval		...				Final error code of the failed operation or error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_BatchExecute();
+
+/**
+ *	@brief		Processes the update for one unit after the other
+ *	@details	Runs for the -factory-loop command line option without a TPM connected by Controller_Initialize. Each unit is
+ *				started by the operator or by the appearance of the TPM device, processed by Controller_ProceedWork with its
+ *				own TPM connection and reported by a JSON record line. The firmware images are checked for the first unit only.
+ *
+ *	@retval		RC_SUCCESS		The factory loop has been stopped.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_FactoryLoopExecute();
+
+/**
+ *	@brief		Checks if several TPM devices are given
+ *	@details	The path of the -access-mode command line option is a comma separated list or contains a path pattern.
+ *
+ *	@retval		TRUE		Several TPM devices are given.
+ *	@retval		FALSE		A single or no TPM device is given.
+ */
+BOOL
+Controller_DevicesIsSet();
+
+/**
+ *	@brief		Opens the log file of a single TPM device
+ *	@details	With -device-log the messages of a single TPM device are written to a log file of its own, named after
+ *				the log file and the device path. Nothing is done without -device-log, with several TPM devices or if
+ *				logging is disabled.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_DevicesOpenLog();
+
+/**
+ *	@brief		Processes the command line for each of several TPM devices
+ *	@details	Each device is processed by a worker process running the command line with the single device path. Up to
+ *				-jobs workers run at the same time, the output of each worker is shown when it has finished. With -fork
+ *				the workers are forked instead. A forked worker returns with PpfWorker set and its single device path in
+ *				the settings, the caller processes the device like a single TPM device.
+ *
+ *	@param		PnArgc					Parameter as provided in main()
+ *	@param		PrgwszArgv				Parameter as provided in main()
+ *	@param		PpfWorker				Receives TRUE in a forked worker and FALSE in the parent process
+ *	@retval		RC_SUCCESS				All TPM devices were processed successfully, or the forked worker is set up.
+ *	@retval		RC_E_DEVICE_FAILED		The processing of at least one TPM device failed.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_DevicesExecute(
+	_In_					int						PnArgc,
+	_In_reads_z_(PnArgc)	const wchar_t* const	PrgwszArgv[],
+	_Out_					BOOL*					PpfWorker);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,503 @@
+﻿/**
+ *	@brief		Implements the processing of several TPM devices by the controller.
+ *	@details	The path of the -access-mode command line option can be a comma separated list of device paths and path
+ *				patterns. Each device is processed by a worker process running the command line with a single device path.
+ *				Up to -jobs worker processes run at the same time. The output of a worker is shown when it has finished.
+ *				With -fork the workers are forked from the parent process, which parsed the settings and loaded and checked
+ *				the firmware image once, instead of running the command line again.
+ *	@file		ControllerDevices.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Controller.h"
+#include "CommandLineParser.h"
+#include "Response.h"
+#include "Resource.h"
+#include "FileIO.h"
+#include "CommandFlow_TpmUpdate.h"
+
+/// Default number of worker processes running at the same time
+#define DEVICES_DEFAULT_JOBS	4
+/// Maximum number of TPM devices processed by one command line
+#define DEVICES_MAX_COUNT		64
+/// Size of the buffer holding the expanded device paths (in wide characters)
+#define DEVICES_PATHS_SIZE		(DEVICES_MAX_COUNT * MAX_PATH)
+/// Size of the buffer holding the output of a worker process (in wide characters)
+#define DEVICES_OUTPUT_SIZE		65536
+
+/// Characters separating the device paths in the list
+#define DEVICES_SEPARATOR		L','
+/// Wildcard characters of a device path pattern
+#define DEVICES_WILDCARDS		L"*?["
+
+/**
+ *	@brief		Checks if a command line argument is the given command line option
+ *
+ *	@param		PwszArgument	Command line argument
+ *	@param		PwszOption		Command line option without leading dashes
+ *	@retval		TRUE			The argument is the option.
+ *	@retval		FALSE			The argument is not the option.
+ */
+static BOOL
+Controller_DevicesIsOption(
+	_In_z_	const wchar_t*	PwszArgument,
+	_In_z_	const wchar_t*	PwszOption)
+{
+	if (L'-' != PwszArgument[0])
+		return FALSE;
+	PwszArgument++;
+	if (L'-' == PwszArgument[0])
+		PwszArgument++;
+
+	return 0 == Platform_StringCompare(PwszArgument, PwszOption, MAX_STRING_1024, TRUE);
+}
+
+/**
+ *	@brief		Expands the device path list
+ *	@details	Splits the list at the separators and expands each path pattern to the matching paths.
+ *
+ *	@param		PwszList				Comma separated list of device paths and path patterns
+ *	@param		PwszPaths				Buffer receiving the device paths, each one zero terminated
+ *	@param		PunPathsSize			Capacity of PwszPaths in wide characters
+ *	@param		PpunPathCount			Receives the number of device paths
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		RC_E_FILE_NOT_FOUND		No device path matches a pattern.
+ *	@retval		RC_E_BAD_COMMANDLINE	The list contains an empty or too long device path or too many devices.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+Controller_DevicesExpand(
+	_In_z_						const wchar_t*	PwszList,
+	_Out_z_cap_(PunPathsSize)	wchar_t*		PwszPaths,
+	_In_						unsigned int	PunPathsSize,
+	_Out_						unsigned int*	PpunPathCount)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		const wchar_t* pwszItem = PwszList;
+		unsigned int unWritten = 0;
+
+		// Check parameters
+		if (NULL == PwszList || NULL == PwszPaths || NULL == PpunPathCount)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter (PwszList, PwszPaths or PpunPathCount)");
+			break;
+		}
+		*PpunPathCount = 0;
+
+		unReturnValue = RC_SUCCESS;
+		while (RC_SUCCESS == unReturnValue)
+		{
+			wchar_t wszItem[MAX_PATH] = {0};
+			const wchar_t* pwszEnd = wcschr(pwszItem, DEVICES_SEPARATOR);
+			unsigned int unItemLength = NULL == pwszEnd ? (unsigned int)wcslen(pwszItem) : (unsigned int)(pwszEnd - pwszItem);
+			unsigned int unSize = PunPathsSize - unWritten;
+			unsigned int unCount = 1;
+
+			if (0 == unItemLength || unItemLength >= RG_LEN(wszItem))
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"The device path list '%ls' contains an empty or too long device path.", PwszList);
+				break;
+			}
+			IGNORE_RETURN_VALUE(wmemcpy(wszItem, pwszItem, unItemLength));
+
+			if (NULL != wcspbrk(wszItem, DEVICES_WILDCARDS))
+			{
+				unReturnValue = FileIO_ListMatchingPaths(wszItem, &PwszPaths[unWritten], &unSize, &unCount);
+				if (RC_E_FILE_NOT_FOUND == unReturnValue)
+				{
+					ERROR_STORE_FMT(unReturnValue, L"No TPM device matches the device path pattern '%ls'.", wszItem);
+					break;
+				}
+			}
+			else
+			{
+				unReturnValue = Platform_StringCopy(&PwszPaths[unWritten], &unSize, wszItem);
+				unSize++;
+			}
+			if (RC_SUCCESS != unReturnValue || *PpunPathCount + unCount > DEVICES_MAX_COUNT)
+			{
+				if (RC_SUCCESS == unReturnValue || RC_E_BUFFER_TOO_SMALL == unReturnValue)
+					unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE_FMT(unReturnValue, L"The device path list '%ls' contains more than %u TPM devices.", PwszList, DEVICES_MAX_COUNT);
+				break;
+			}
+			unWritten += unSize;
+			*PpunPathCount += unCount;
+
+			if (NULL == pwszEnd)
+				break;
+			pwszItem = pwszEnd + 1;
+		}
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Reads the output of an exited worker process
+ *	@details	The lines are separated by line breaks. Output exceeding the buffer is cut off.
+ *
+ *	@param		PpvProcess				Process handle of the exited worker
+ *	@param		PwszOutput				Buffer receiving the output
+ *	@param		PunOutputSize			Capacity of PwszOutput in wide characters
+ *	@param		PpunOutputLength		Receives the length of the output
+ */
+static void
+Controller_DevicesReadOutput(
+	_In_						void*			PpvProcess,
+	_Out_z_cap_(PunOutputSize)	wchar_t*		PwszOutput,
+	_In_						unsigned int	PunOutputSize,
+	_Out_						unsigned int*	PpunOutputLength)
+{
+	unsigned int unLength = 0;
+	BOOL fFirstLine = TRUE;
+
+	PwszOutput[0] = L'\0';
+	for (;;)
+	{
+		// Reserve the line break in front of the line
+		unsigned int unOffset = fFirstLine ? 0 : 1;
+		unsigned int unLineSize = PunOutputSize - unLength - unOffset;
+		if (unLineSize < 2 || RC_SUCCESS != Platform_ProcessReadOutputLine(PpvProcess, &PwszOutput[unLength + unOffset], &unLineSize))
+			break;
+		if (!fFirstLine)
+			PwszOutput[unLength] = L'\n';
+		unLength += unOffset + unLineSize;
+		fFirstLine = FALSE;
+	}
+	PwszOutput[unLength] = L'\0';
+	*PpunOutputLength = unLength;
+}
+
+/**
+ *	@brief		Checks if several TPM devices are given
+ *	@details	The path of the -access-mode command line option is a list of device paths or contains a path pattern.
+ *
+ *	@retval		TRUE		Several TPM devices are given.
+ *	@retval		FALSE		A single or no TPM device is given.
+ */
+BOOL
+Controller_DevicesIsSet()
+{
+	wchar_t wszPath[MAX_STRING_1024] = {0};
+	unsigned int unPathSize = RG_LEN(wszPath);
+
+	if (!PropertyStorage_ExistsElement(PROPERTY_ACCESS_MODE) ||
+			!PropertyStorage_GetValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszPath, &unPathSize))
+		return FALSE;
+
+	return NULL != wcschr(wszPath, DEVICES_SEPARATOR) || NULL != wcspbrk(wszPath, DEVICES_WILDCARDS);
+}
+
+/**
+ *	@brief		Opens the log file of a single TPM device
+ *	@details	With -device-log the messages of a single TPM device are written to a log file of its own, named after
+ *				the log file and the device path (e.g. TPMFactoryUpd_dev_tpm0.log for /dev/tpm0). The name of the device
+ *				log file is written to the log file before. Nothing is done without -device-log, with several TPM devices
+ *				or if logging is disabled. Called before the TPM device is connected.
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_DevicesOpenLog()
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	do
+	{
+		wchar_t wszDevice[MAX_PATH] = {0};
+		unsigned int unDeviceSize = RG_LEN(wszDevice);
+		wchar_t wszDeviceName[MAX_PATH] = {0};
+		wchar_t wszLogPath[MAX_STRING_1024] = {0};
+		unsigned int unLogPathSize = RG_LEN(wszLogPath);
+		wchar_t wszDeviceLogPath[MAX_STRING_1024] = {0};
+		unsigned int unDeviceLogPathSize = RG_LEN(wszDeviceLogPath);
+		const wchar_t* pwszExtension = L"";
+		unsigned int unIndex = 0;
+		unsigned int unBaseLength = 0;
+
+		if (!PropertyStorage_ExistsElement(PROPERTY_DEVICE_LOG) || LOGGING_DISABLED == g_unLoggingLevel || Controller_DevicesIsSet())
+			break;
+		if (!PropertyStorage_GetValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszDevice, &unDeviceSize) ||
+				!PropertyStorage_GetValueById(PROPERTY_ID_LOGGING_PATH, wszLogPath, &unLogPathSize))
+			break;
+
+		// The device path becomes part of the file name
+		for (unIndex = 0; unIndex < unDeviceSize; unIndex++)
+		{
+			BOOL fSeparator = L'/' == wszDevice[unIndex] || L'\\' == wszDevice[unIndex] || L':' == wszDevice[unIndex];
+			wszDeviceName[unIndex] = fSeparator ? L'_' : wszDevice[unIndex];
+		}
+
+		// Insert it in front of the extension of the log file name
+		unBaseLength = unLogPathSize;
+		for (unIndex = unLogPathSize; unIndex > 0; unIndex--)
+		{
+			if (L'/' == wszLogPath[unIndex - 1] || L'\\' == wszLogPath[unIndex - 1])
+				break;
+			if (L'.' == wszLogPath[unIndex - 1])
+			{
+				unBaseLength = unIndex - 1;
+				pwszExtension = &wszLogPath[unBaseLength];
+				break;
+			}
+		}
+		unReturnValue = Platform_StringFormat(wszDeviceLogPath, &unDeviceLogPathSize, L"%.*ls%ls%ls%ls",
+							(int)unBaseLength, wszLogPath, L'_' == wszDeviceName[0] ? L"" : L"_", wszDeviceName, pwszExtension);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"Failed to compose the device log file path.");
+			break;
+		}
+
+		LOGGING_WRITE_LEVEL2_FMT(L"The log of TPM device '%ls' is written to '%ls'.", wszDevice, wszDeviceLogPath);
+
+		unReturnValue = Logging_OpenSessionSink(wszDeviceLogPath);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The device log file '%ls' cannot be written.", wszDeviceLogPath);
+			break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Processes the command line for each of several TPM devices
+ *	@details	Expands the device path list and runs the command line for each device in a worker process with the
+ *				single device path in the -access-mode command line option. The output of each worker is shown by
+ *				Response_ShowDeviceResult when it has finished, followed by Response_ShowDevicesSummary.
+ *				With -fork the workers are forked instead. A forked worker returns from this function with PpfWorker set
+ *				and its single device path in the settings, the caller processes the device like a single TPM device.
+ *
+ *	@param		PnArgc					Parameter as provided in main()
+ *	@param		PrgwszArgv				Parameter as provided in main()
+ *	@param		PpfWorker				Receives TRUE in a forked worker and FALSE in the parent process
+ *	@retval		RC_SUCCESS				All TPM devices were processed successfully, or the forked worker is set up.
+ *	@retval		RC_E_DEVICE_FAILED		The processing of at least one TPM device failed.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_DevicesExecute(
+	_In_					int						PnArgc,
+	_In_reads_z_(PnArgc)	const wchar_t* const	PrgwszArgv[],
+	_Out_					BOOL*					PpfWorker)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	wchar_t* wszPaths = NULL;
+	wchar_t* wszOutput = NULL;
+	const wchar_t** rgwszArgv = NULL;
+	void* rgpvProcesses[DEVICES_MAX_COUNT] = {0};
+	unsigned int unIndex = 0;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszList[MAX_STRING_1024] = {0};
+		unsigned int unListSize = RG_LEN(wszList);
+		wchar_t wszMode[MAX_NAME] = {0};
+		unsigned int unModeSize = RG_LEN(wszMode);
+		const wchar_t* rgwszPaths[DEVICES_MAX_COUNT] = {0};
+		unsigned int unPathCount = 0;
+		unsigned int unJobs = DEVICES_DEFAULT_JOBS;
+		unsigned int unArgc = 0;
+		unsigned int unStarted = 0;
+		unsigned int unRunning = 0;
+		unsigned int unFinished = 0;
+		unsigned int unFailed = 0;
+		BOOL fFork = FALSE;
+		int nArg = 0;
+
+		// Check parameters
+		if (PnArgc < 1 || NULL == PrgwszArgv || NULL == PpfWorker)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Bad parameter (PnArgc, PrgwszArgv or PpfWorker)");
+			break;
+		}
+		*PpfWorker = FALSE;
+
+		if (!PropertyStorage_GetValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, wszList, &unListSize) ||
+				!PropertyStorage_GetValueByKey(PROPERTY_TPM_DEVICE_ACCESS_MODE, wszMode, &unModeSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Failed to get the TPM device access mode and path.");
+			break;
+		}
+		if (PropertyStorage_ExistsElement(PROPERTY_DEVICE_JOBS))
+			IGNORE_RETURN_VALUE(PropertyStorage_GetUIntegerValueByKey(PROPERTY_DEVICE_JOBS, &unJobs));
+		if (PropertyStorage_ExistsElement(PROPERTY_DEVICE_FORK))
+			IGNORE_RETURN_VALUE(PropertyStorage_GetBooleanValueByKey(PROPERTY_DEVICE_FORK, &fFork));
+
+		wszPaths = (wchar_t*)Platform_MemoryAllocateZero(DEVICES_PATHS_SIZE * sizeof(wchar_t));
+		wszOutput = (wchar_t*)Platform_MemoryAllocateZero(DEVICES_OUTPUT_SIZE * sizeof(wchar_t));
+		// The worker command line gets the -access-mode option with the single device path appended
+		rgwszArgv = (const wchar_t**)Platform_MemoryAllocateZero(((unsigned int)PnArgc + 3) * sizeof(wchar_t*));
+		if (NULL == wszPaths || NULL == wszOutput || NULL == rgwszArgv)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+			break;
+		}
+
+		unReturnValue = Controller_DevicesExpand(wszList, wszPaths, DEVICES_PATHS_SIZE, &unPathCount);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		rgwszPaths[0] = wszPaths;
+		for (unIndex = 1; unIndex < unPathCount; unIndex++)
+			rgwszPaths[unIndex] = rgwszPaths[unIndex - 1] + wcslen(rgwszPaths[unIndex - 1]) + 1;
+
+		// Build the worker command line without the -access-mode and -jobs options
+		rgwszArgv[unArgc++] = PrgwszArgv[0];
+		for (nArg = 1; nArg < PnArgc; nArg++)
+		{
+			if (Controller_DevicesIsOption(PrgwszArgv[nArg], CMD_ACCESS_MODE))
+			{
+				// Skip the mode and the optional device path
+				nArg++;
+				if (nArg + 1 < PnArgc && CommandLineParser_IsValue(PrgwszArgv[nArg + 1]))
+					nArg++;
+				continue;
+			}
+			if (Controller_DevicesIsOption(PrgwszArgv[nArg], CMD_JOBS))
+			{
+				nArg++;
+				continue;
+			}
+			rgwszArgv[unArgc++] = PrgwszArgv[nArg];
+		}
+		rgwszArgv[unArgc++] = L"-" CMD_ACCESS_MODE;
+		rgwszArgv[unArgc++] = wszMode;
+		unArgc++;
+
+		// Show the header once in front of the outputs of the workers
+		unReturnValue = Response_ShowHeader();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		LOGGING_WRITE_LEVEL2_FMT(L"Processing %u TPM devices with up to %u %ls worker processes.", unPathCount, unJobs, fFork ? L"forked" : L"started");
+
+		// Load and check the firmware image once, the forked workers share it copy-on-write
+		if (fFork)
+			CommandFlow_TpmUpdate_PreloadFirmwareImage();
+
+		// Do not let the workers write the buffered log messages again. A forked worker does not inherit the thread of
+		// the asynchronous log writer, so the parent process and the forked workers log synchronously.
+		if (fFork)
+			Logging_Close();
+		else
+			Logging_Flush();
+
+		unReturnValue = RC_SUCCESS;
+		while (unFinished < unPathCount)
+		{
+			unsigned int unExitCode = 0;
+			unsigned int unOutputLength = 0;
+
+			// Keep up to unJobs workers running
+			while (unStarted < unPathCount && unRunning < unJobs)
+			{
+				rgwszArgv[unArgc - 1] = rgwszPaths[unStarted];
+				if (fFork)
+					unReturnValue = Platform_ProcessFork(&rgpvProcesses[unStarted], PpfWorker);
+				else
+					unReturnValue = Platform_ProcessStart(unArgc, rgwszArgv, &rgpvProcesses[unStarted]);
+				if (RC_SUCCESS != unReturnValue)
+				{
+					ERROR_STORE_FMT(unReturnValue, L"Failed to start the worker process for TPM device '%ls'.", rgwszPaths[unStarted]);
+					break;
+				}
+				if (TRUE == *PpfWorker)
+				{
+					// The forked worker processes its single TPM device with the settings of the parent process
+					if (FALSE == PropertyStorage_ChangeValueByKey(PROPERTY_TPM_DEVICE_ACCESS_PATH, rgwszPaths[unStarted]))
+					{
+						unReturnValue = RC_E_FAIL;
+						ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_ChangeValueByKey failed to change property '%ls'.", PROPERTY_TPM_DEVICE_ACCESS_PATH);
+					}
+					break;
+				}
+				LOGGING_WRITE_LEVEL2_FMT(L"Started worker process for TPM device '%ls'.", rgwszPaths[unStarted]);
+				unStarted++;
+				unRunning++;
+			}
+			if (RC_SUCCESS != unReturnValue || TRUE == *PpfWorker)
+				break;
+
+			unReturnValue = Platform_ProcessWaitAny(rgpvProcesses, unStarted, &unIndex, &unExitCode);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Failed to wait for the worker processes.");
+				break;
+			}
+			LOGGING_WRITE_LEVEL2_FMT(L"Worker process for TPM device '%ls' exited with code %u.", rgwszPaths[unIndex], unExitCode);
+
+			Controller_DevicesReadOutput(rgpvProcesses[unIndex], wszOutput, DEVICES_OUTPUT_SIZE, &unOutputLength);
+			Platform_ProcessClose(&rgpvProcesses[unIndex]);
+			unReturnValue = Response_ShowDeviceResult(rgwszPaths[unIndex], unFinished, unExitCode, wszOutput, unOutputLength);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			if (0 != unExitCode)
+				unFailed++;
+			unFinished++;
+			unRunning--;
+		}
+		if (RC_SUCCESS != unReturnValue || TRUE == *PpfWorker)
+			break;
+
+		unReturnValue = Response_ShowDevicesSummary(unPathCount - unFailed, unPathCount);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		if (0 != unFailed)
+		{
+			unReturnValue = RC_E_DEVICE_FAILED;
+			ERROR_STORE_FMT(unReturnValue, L"%u of %u TPM devices failed.", unFailed, unPathCount);
+			break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	// Terminate the workers still running in an error case, a forked worker only releases the handles of its siblings
+	for (unIndex = 0; unIndex < RG_LEN(rgpvProcesses); unIndex++)
+		Platform_ProcessClose(&rgpvProcesses[unIndex]);
+
+	// The forked worker takes the loaded firmware image over
+	if (NULL != PpfWorker && FALSE == *PpfWorker)
+		CommandFlow_TpmUpdate_ReleasePreloadedImage();
+
+	Platform_MemoryFree((void**)&rgwszArgv);
+	Platform_MemoryFree((void**)&wszOutput);
+	Platform_MemoryFree((void**)&wszPaths);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
@@ -0,0 +1,325 @@
+﻿/**
+ *	@brief		Implements the factory loop of the controller.
+ *	@details	The factory loop processes the -update command line option for one unit (board) after the other without
+ *				starting the tool again. The configuration, the command line and the firmware image checks are done once,
+ *				the TPM is connected for each unit. Each unit is started by the operator or by the appearance of the TPM
+ *				device, and its result is written as one JSON record line.
+ *	@file		ControllerFactoryLoop.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Controller.h"
+#include "CommandFlow_TpmUpdate.h"
+#include "DeviceManagement.h"
+#include "Response.h"
+#include "Resource.h"
+#include "ConsoleIO.h"
+#include "FileIO.h"
+
+/// Interval in milliseconds in which the TPM device path is checked while waiting for a unit
+#define FACTORY_LOOP_POLL_TIME		200
+/// Wait time in milliseconds after the TPM device appeared, gives the device node time to become accessible
+#define FACTORY_LOOP_SETTLE_TIME	500
+
+/// Properties changed by the update of a unit, restored before the next unit
+typedef struct tdIfxFactoryLoopProperties
+{
+	/// Update type of the command line, a config file update replaces it with the update type of the TPM
+	unsigned int	unUpdateType;
+	/// TRUE if the command line sets the firmware image path
+	BOOL			fFirmwarePath;
+	/// Firmware image path of the command line, set or replaced by config file updates and the image cache
+	wchar_t			wszFirmwarePath[MAX_PATH];
+} IfxFactoryLoopProperties;
+
+/**
+ *	@brief		Reads an operator input line from the console
+ *	@details
+ *
+ *	@retval		TRUE	The operator requested to stop the loop with q or the console input has ended.
+ *	@retval		FALSE	The operator requested the next unit.
+ */
+_Check_return_
+static BOOL
+ControllerFactoryLoop_ReadOperatorInput()
+{
+	wchar_t wchFirst = L'\0';
+
+	for (;;)
+	{
+		wchar_t wchRead = ConsoleIO_ReadWChar();
+		if ((wchar_t)WEOF == wchRead)
+			return TRUE;
+		if (L'\n' == wchRead)
+			break;
+		if (L'\0' == wchFirst && L' ' != wchRead)
+			wchFirst = wchRead;
+	}
+
+	return L'q' == wchFirst || L'Q' == wchFirst;
+}
+
+/**
+ *	@brief		Waits until the TPM device path appears or disappears
+ *	@details	The operator can stop the loop meanwhile with q.
+ *
+ *	@param		PwszDevicePath		TPM device path
+ *	@param		PfPresent			TRUE to wait for the device to appear, FALSE to wait for it to disappear
+ *
+ *	@retval		TRUE				The operator requested to stop the loop.
+ *	@retval		FALSE				The device appeared or disappeared.
+ */
+_Check_return_
+static BOOL
+ControllerFactoryLoop_WaitForDevice(
+	_In_z_	const wchar_t*	PwszDevicePath,
+	_In_	BOOL			PfPresent)
+{
+	while (PfPresent != FileIO_Exists(PwszDevicePath))
+	{
+		if (0 != ConsoleIO_KeyboardHit() && TRUE == ControllerFactoryLoop_ReadOperatorInput())
+			return TRUE;
+		Platform_Sleep(FACTORY_LOOP_POLL_TIME);
+	}
+
+	return FALSE;
+}
+
+/**
+ *	@brief		Saves or restores the properties changed by the update of a unit
+ *	@details
+ *
+ *	@param		PpsProperties		Saved properties
+ *	@param		PfRestore			FALSE to save the properties, TRUE to restore them
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_FAIL			A property could not be read or written.
+ */
+_Check_return_
+static unsigned int
+ControllerFactoryLoop_SaveProperties(
+	_Inout_	IfxFactoryLoopProperties*	PpsProperties,
+	_In_	BOOL						PfRestore)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		if (!PfRestore)
+		{
+			unsigned int unFirmwarePathSize = RG_LEN(PpsProperties->wszFirmwarePath);
+			if (!PropertyStorage_GetUIntegerValueByKey(PROPERTY_UPDATE_TYPE, &PpsProperties->unUpdateType))
+			{
+				ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_GetUIntegerValueByKey failed to get property '%ls'.", PROPERTY_UPDATE_TYPE);
+				break;
+			}
+			PpsProperties->fFirmwarePath = PropertyStorage_GetValueByKey(PROPERTY_FIRMWARE_PATH, PpsProperties->wszFirmwarePath, &unFirmwarePathSize);
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		if (!PropertyStorage_ChangeUIntegerValueByKey(PROPERTY_UPDATE_TYPE, PpsProperties->unUpdateType))
+		{
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_ChangeUIntegerValueByKey failed to change property '%ls'.", PROPERTY_UPDATE_TYPE);
+			break;
+		}
+		if (PropertyStorage_ExistsElement(PROPERTY_FIRMWARE_PATH))
+			IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_FIRMWARE_PATH));
+		if (PpsProperties->fFirmwarePath && !PropertyStorage_AddKeyValuePair(PROPERTY_FIRMWARE_PATH, PpsProperties->wszFirmwarePath))
+		{
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage_AddKeyValuePair failed to add property '%ls'.", PROPERTY_FIRMWARE_PATH);
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Processes one unit
+ *	@details	Connects the TPM, processes the update by Controller_ProceedWork and writes the result record of the unit.
+ *				The TPM is disconnected and the error stack of the unit is cleared afterwards.
+ *
+ *	@param		PunUnit				Number of the unit
+ *	@param		PwszDocument		Buffer for the JSON result document
+ *
+ *	@retval		RC_SUCCESS			The unit was updated successfully or is up to date.
+ *	@retval		...					Final error code of the unit.
+ */
+_Check_return_
+static unsigned int
+ControllerFactoryLoop_ProcessUnit(
+	_In_										unsigned int	PunUnit,
+	_Out_z_cap_(RESPONSE_JSON_DOCUMENT_SIZE)	wchar_t*		PwszDocument)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unFinalCode = RC_E_FAIL;
+	unsigned int unLength = 0;
+	unsigned long long ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+	unsigned long long ullDuration = 0;
+	IfxToolHeader* pResponseData = NULL;
+
+	// Each unit is a different TPM
+	unReturnValue = DeviceManagement_Connect();
+	if (RC_SUCCESS == unReturnValue)
+		unReturnValue = Controller_ProceedWork(&pResponseData);
+	if (RC_SUCCESS != Controller_Disconnect())
+		LOGGING_WRITE_LEVEL1_FMT(L"Disconnecting the TPM of unit %u failed.", PunUnit);
+	if (PropertyStorage_ExistsElement(PROPERTY_CALL_SHUTDOWN_ON_EXIT))
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_CALL_SHUTDOWN_ON_EXIT));
+	ullDuration = (Platform_GetMonotonicTimeMicroSeconds() - ullStartTime) / 1000;
+
+	// Write the result record of the unit
+	unFinalCode = NULL != Error_GetStack() ? Error_GetFinalCode() : unReturnValue;
+	if (RC_SUCCESS == Response_GetJsonResult(pResponseData, unFinalCode, PwszDocument, &unLength))
+	{
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, RES_FACTORY_LOOP_RECORD, PunUnit, ullDuration));
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, L"%ls", PwszDocument));
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, L"}"));
+	}
+	LOGGING_WRITE_LEVEL1_FMT(L"Factory loop unit %u processed in %llu ms (0x%.8X).", PunUnit, ullDuration, unFinalCode);
+
+	Controller_ReleaseResponse(&pResponseData);
+	if (NULL != Error_GetStack())
+	{
+		Error_LogStack();
+		Error_ClearStack();
+	}
+
+	return unFinalCode;
+}
+
+/**
+ *	@brief		Processes the update for one unit after the other
+ *	@details	Runs for the -factory-loop command line option. The TPM is not connected by Controller_Initialize. Each unit
+ *				is started by the operator (Enter) or by the appearance of the TPM device path, processed by
+ *				Controller_ProceedWork with its own TPM connection and reported by a JSON record line. With the device
+ *				trigger the next unit is awaited after the device has disappeared. The loop ends with q or at the end of
+ *				the console input.
+ *
+ *	@retval		RC_SUCCESS		The factory loop has been stopped.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_FactoryLoopExecute()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unUnit = 0;
+	unsigned int unFailed = 0;
+	wchar_t* pwszDocument = NULL;
+	BOOL fJsonOutput = FALSE;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszTrigger[MAX_NAME] = {0};
+		unsigned int unTriggerSize = RG_LEN(wszTrigger);
+		wchar_t wszDevicePath[MAX_PATH] = {0};
+		unsigned int unDevicePathSize = RG_LEN(wszDevicePath);
+		IfxFactoryLoopProperties sProperties;
+		BOOL fDeviceTrigger = FALSE;
+
+		if (!PropertyStorage_GetValueByKey(PROPERTY_FACTORY_LOOP, wszTrigger, &unTriggerSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while getting a value. (%ls)", PROPERTY_FACTORY_LOOP);
+			break;
+		}
+		fDeviceTrigger = 0 == Platform_StringCompare(wszTrigger, FACTORY_LOOP_TRIGGER_DEVICE, RG_LEN(FACTORY_LOOP_TRIGGER_DEVICE), TRUE);
+		if (!PropertyStorage_GetValueById(PROPERTY_ID_TPM_DEVICE_ACCESS_PATH, wszDevicePath, &unDevicePathSize))
+		{
+			unDevicePathSize = RG_LEN(wszDevicePath);
+			IGNORE_RETURN_VALUE(Platform_StringCopy(wszDevicePath, &unDevicePathSize, TPM_DEVICE_ACCESS_PATH));
+		}
+
+		// Each unit is processed like the command line without the factory loop option
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_FACTORY_LOOP));
+		CommandFlow_TpmUpdate_KeepVerifiedImagesInMemory();
+		unReturnValue = ControllerFactoryLoop_SaveProperties(&sProperties, FALSE);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		pwszDocument = (wchar_t*)Platform_MemoryAllocateZero(sizeof(wchar_t) * RESPONSE_JSON_DOCUMENT_SIZE);
+		if (NULL == pwszDocument)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation for the result records failed.");
+			break;
+		}
+
+		// The units are reported by their result records only
+		fJsonOutput = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_JSON_OUTPUT, TRUE) || PropertyStorage_ChangeBooleanValueByKey(PROPERTY_JSON_OUTPUT, TRUE);
+		if (!fJsonOutput)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while adding a key value pair. (%ls)", PROPERTY_JSON_OUTPUT);
+			break;
+		}
+
+		for (;;)
+		{
+			BOOL fStop = FALSE;
+
+			// Wait for the next unit
+			if (fDeviceTrigger)
+			{
+				IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_FACTORY_LOOP_WAIT_DEVICE, unUnit + 1, wszDevicePath));
+				fStop = ControllerFactoryLoop_WaitForDevice(wszDevicePath, TRUE);
+				if (!fStop)
+					Platform_Sleep(FACTORY_LOOP_SETTLE_TIME);
+			}
+			else
+			{
+				IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_FACTORY_LOOP_WAIT_OPERATOR, unUnit + 1));
+				fStop = ControllerFactoryLoop_ReadOperatorInput();
+			}
+			if (fStop)
+				break;
+
+			unUnit++;
+			if (RC_SUCCESS != ControllerFactoryLoop_ProcessUnit(unUnit, pwszDocument))
+				unFailed++;
+
+			unReturnValue = ControllerFactoryLoop_SaveProperties(&sProperties, TRUE);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// The same unit must not be processed twice
+			if (fDeviceTrigger)
+			{
+				IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_FACTORY_LOOP_REMOVE_DEVICE, unUnit));
+				if (ControllerFactoryLoop_WaitForDevice(wszDevicePath, FALSE))
+					break;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&pwszDocument);
+
+	// The result of the factory loop itself is shown as text
+	if (fJsonOutput)
+		IGNORE_RETURN_VALUE(PropertyStorage_ChangeBooleanValueByKey(PROPERTY_JSON_OUTPUT, FALSE));
+	if (RC_SUCCESS == unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(RES_FACTORY_LOOP_STOPPED, unUnit, unFailed);
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_FACTORY_LOOP_STOPPED, unUnit, unFailed));
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
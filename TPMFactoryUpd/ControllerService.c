@@ -0,0 +1,941 @@
+﻿/**
+ *	@brief		Implements the service and the batch mode of the controller.
+ *	@details	The service keeps the TPM connected and serves requests on a local socket. Each request and each reply is
+ *				a frame consisting of a four byte big endian payload length followed by the payload. The request payload
+ *				holds the NUL separated arguments in the encoding of the current locale. The first argument is the request
+ *				type (info, check, update, clearownership or stop), the remaining arguments are the field list of the -info
+ *				command line option or the options of the -update command line option. The reply payload is the JSON result
+ *				document of the -json command line option. Connections arriving during a firmware update are answered between
+ *				the firmware blocks from the TPM state kept in memory. The batch mode reads the same requests from a file, one
+ *				per line with blank separated arguments.
+ *	@file		ControllerService.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Controller.h"
+#include "CommandLine.h"
+#include "CommandLineParser.h"
+#include "Response.h"
+#include "CommandFlow_TpmInfo.h"
+#include "FirmwareUpdate.h"
+#include "DeviceManagement.h"
+#include "Resource.h"
+#include "ConsoleIO.h"
+#include "FileIO.h"
+#include "Config.h"
+
+/// Size of the payload length in front of a request or reply frame
+#define SERVICE_FRAME_LENGTH_SIZE	4
+/// Maximum size of a request payload
+#define SERVICE_MAX_REQUEST_SIZE	4096
+/// Maximum number of arguments passed to the command line parser for a request
+#define SERVICE_MAX_ARGUMENTS		16
+/// Path read for the batch file name -
+#define SERVICE_BATCH_STDIN_PATH	L"/dev/stdin"
+/// Maximum number of connections answered per progress step of a firmware update
+#define SERVICE_BUSY_MAX_CONNECTIONS	4
+/// Time in milliseconds to wait for the request of a connection accepted during a firmware update
+#define SERVICE_BUSY_RECEIVE_TIMEOUT	100
+
+/// Request types
+#define SERVICE_REQUEST_INFO		L"info"
+#define SERVICE_REQUEST_CHECK		L"check"
+#define SERVICE_REQUEST_UPDATE		L"update"
+#define SERVICE_REQUEST_CLEAR_OWNERSHIP	L"clearownership"
+#define SERVICE_REQUEST_STOP		L"stop"
+
+/// Command line options allowed in check and update requests
+static const wchar_t* const s_rgwszRequestOptions[] =
+{
+	CMD_FIRMWARE,
+	CMD_CONFIG,
+	CMD_DRY_RUN,
+	CMD_IGNORE_ERROR_ON_COMPLETE
+};
+
+/// Properties set by the command line of a request, removed before the next request is parsed. The settings of the update
+/// config file are kept by CommandFlow_TpmUpdate_ProceedUpdateConfig, which reloads them when the file changes.
+static const wchar_t* const s_rgwszRequestProperties[] =
+{
+	PROPERTY_INFO,
+	PROPERTY_INFO_FIELDS,
+	PROPERTY_UPDATE,
+	PROPERTY_UPDATE_TYPE,
+	PROPERTY_TPM12_CLEAROWNERSHIP,
+	PROPERTY_FIRMWARE_PATH,
+	PROPERTY_CONFIG_FILE_PATH,
+	PROPERTY_DRY_RUN,
+	PROPERTY_IGNORE_ERROR_ON_COMPLETE,
+	PROPERTY_CMDLINE_COUNT,
+	PROPERTY_SERVICE_CHECK
+};
+
+/// Listening socket of the service, NULL in batch mode
+static void* s_pvServiceSocket = NULL;
+
+/// Watch of the tool configuration file while the service runs
+static void* s_pvConfigWatch = NULL;
+/// Section digests of the tool configuration file
+static IfxConfigDigest s_sConfigDigest;
+/// TRUE if a reload of the tool configuration file failed and is retried with the next request
+static BOOL s_fConfigReloadPending = FALSE;
+
+/// State of the service while a request changing the TPM is processed
+typedef struct tdIfxServiceBusy
+{
+	/// TPM state taken before the request started
+	IfxInfo sTpmInfo;
+	/// TRUE if sTpmInfo holds the TPM state
+	BOOL fTpmInfoValid;
+	/// Last progress completion value between 0 and 100
+	unsigned int unProgress;
+} IfxServiceBusy;
+
+/**
+ *	@brief		Builds the command line of a request
+ *	@details	Splits the request payload into its arguments and maps the request type to the corresponding command line
+ *				option. The arguments are stored one after another in PwszArguments.
+ *
+ *	@param		PrgbRequest				Request payload
+ *	@param		PunRequestSize			Size of the request payload
+ *	@param		PwszArguments			Receives the converted arguments
+ *	@param		PunArgumentsCapacity	Capacity of PwszArguments in elements
+ *	@param		PrgwszArgv				Receives the command line
+ *	@param		PpnArgc					Receives the number of elements in PrgwszArgv
+ *	@param		PpfStop					Set to TRUE for a stop request
+ *	@param		PpfCheck				Set to TRUE for a check request
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_COMMANDLINE	The request type or an option is not supported.
+ */
+_Check_return_
+static unsigned int
+ControllerService_GetCommandLine(
+	_In_bytecount_(PunRequestSize)					const BYTE*		PrgbRequest,
+	_In_											unsigned int	PunRequestSize,
+	_Out_z_cap_(PunArgumentsCapacity)				wchar_t*		PwszArguments,
+	_In_											unsigned int	PunArgumentsCapacity,
+	_Out_cap_(SERVICE_MAX_ARGUMENTS)				const wchar_t*	PrgwszArgv[],
+	_Out_											int*			PpnArgc,
+	_Out_											BOOL*			PpfStop,
+	_Out_											BOOL*			PpfCheck)
+{
+	unsigned int unReturnValue = RC_E_BAD_COMMANDLINE;
+
+	do
+	{
+		char szRequest[SERVICE_MAX_REQUEST_SIZE + 1] = {0};
+		unsigned int unOffset = 0;
+		unsigned int unUsed = 0;
+		int nArgc = 1;
+
+		*PpnArgc = 0;
+		*PpfStop = FALSE;
+		*PpfCheck = FALSE;
+		PrgwszArgv[0] = TOOL_NAME;
+
+		// The payload may omit the NUL after the last argument
+		if (RC_SUCCESS != Platform_MemoryCopy(szRequest, sizeof(szRequest) - 1, PrgbRequest, PunRequestSize))
+		{
+			ERROR_STORE(unReturnValue, L"The request is too long.");
+			break;
+		}
+
+		unReturnValue = RC_SUCCESS;
+		while (unOffset < PunRequestSize)
+		{
+			const char* szArgument = &szRequest[unOffset];
+			unsigned int unLength = (unsigned int)strlen(szArgument);
+			unOffset += unLength + 1;
+
+			// Leave space for the mapped request type
+			if (SERVICE_MAX_ARGUMENTS <= nArgc)
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(unReturnValue, L"The request has too many arguments.");
+				break;
+			}
+
+			unReturnValue = Platform_AnsiString2UnicodeString(&PwszArguments[unUsed], PunArgumentsCapacity - unUsed, szArgument);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				ERROR_STORE(unReturnValue, L"A request argument could not be converted.");
+				break;
+			}
+			PrgwszArgv[nArgc++] = &PwszArguments[unUsed];
+			unUsed += (unsigned int)wcslen(&PwszArguments[unUsed]) + 1;
+		}
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Map the request type to the command line option
+		unReturnValue = RC_E_BAD_COMMANDLINE;
+		if (1 == nArgc)
+		{
+			ERROR_STORE(unReturnValue, L"The request is empty.");
+			break;
+		}
+		if (0 == Platform_StringCompare(PrgwszArgv[1], SERVICE_REQUEST_STOP, RG_LEN(SERVICE_REQUEST_STOP), TRUE) && 2 == nArgc)
+		{
+			*PpfStop = TRUE;
+		}
+		else if (0 == Platform_StringCompare(PrgwszArgv[1], SERVICE_REQUEST_INFO, RG_LEN(SERVICE_REQUEST_INFO), TRUE) &&
+				(2 == nArgc || (3 == nArgc && CommandLineParser_IsValue(PrgwszArgv[2]))))
+		{
+			PrgwszArgv[1] = L"-" CMD_INFO;
+		}
+		else if (0 == Platform_StringCompare(PrgwszArgv[1], SERVICE_REQUEST_CLEAR_OWNERSHIP, RG_LEN(SERVICE_REQUEST_CLEAR_OWNERSHIP), TRUE) && 2 == nArgc)
+		{
+			PrgwszArgv[1] = L"-" CMD_TPM12_CLEAROWNERSHIP;
+		}
+		else if (0 == Platform_StringCompare(PrgwszArgv[1], SERVICE_REQUEST_CHECK, RG_LEN(SERVICE_REQUEST_CHECK), TRUE) ||
+				0 == Platform_StringCompare(PrgwszArgv[1], SERVICE_REQUEST_UPDATE, RG_LEN(SERVICE_REQUEST_UPDATE), TRUE))
+		{
+			int nArgument = 0;
+
+			*PpfCheck = 0 == Platform_StringCompare(PrgwszArgv[1], SERVICE_REQUEST_CHECK, RG_LEN(SERVICE_REQUEST_CHECK), TRUE);
+			PrgwszArgv[1] = L"-" CMD_UPDATE;
+
+			// Only the options of the update itself are accepted, the service settings stay as they are
+			unReturnValue = RC_SUCCESS;
+			for (nArgument = 3; nArgument < nArgc && RC_SUCCESS == unReturnValue; nArgument++)
+			{
+				wchar_t wszOption[MAX_STRING_1024] = {0};
+				unsigned int unOptionSize = RG_LEN(wszOption);
+				unsigned int unIndex = 0;
+				BOOL fIsOption = FALSE;
+
+				if (RC_SUCCESS != CommandLine_IsCommandLineOption(PrgwszArgv[nArgument], &fIsOption) || !fIsOption)
+					continue;
+
+				unReturnValue = CommandLine_GetTrimmedCommand(PrgwszArgv[nArgument], wszOption, &unOptionSize);
+				if (RC_SUCCESS != unReturnValue)
+					wszOption[0] = L'\0';
+				unReturnValue = RC_E_BAD_COMMANDLINE;
+				for (unIndex = 0; unIndex < RG_LEN(s_rgwszRequestOptions); unIndex++)
+				{
+					if (0 == Platform_StringCompare(wszOption, s_rgwszRequestOptions[unIndex], RG_LEN(wszOption), TRUE))
+					{
+						unReturnValue = RC_SUCCESS;
+						break;
+					}
+				}
+				if (RC_SUCCESS != unReturnValue)
+					ERROR_STORE_FMT(unReturnValue, L"The option '%ls' is not supported in a service request.", PrgwszArgv[nArgument]);
+			}
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+		else
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The request '%ls' is not supported.", PrgwszArgv[1]);
+			break;
+		}
+
+		*PpnArgc = nArgc;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Removes the properties set by the command line of a request
+ *	@details	Used between the requests of the service, batch and library modes, so the next request is parsed like the
+ *				command line of a separate process.
+ */
+void
+Controller_ClearRequestProperties()
+{
+	unsigned int unIndex = 0;
+
+	for (unIndex = 0; unIndex < RG_LEN(s_rgwszRequestProperties); unIndex++)
+	{
+		if (PropertyStorage_ExistsElement(s_rgwszRequestProperties[unIndex]))
+			IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(s_rgwszRequestProperties[unIndex]));
+	}
+}
+
+/**
+ *	@brief		Reloads the changed sections of the tool configuration file
+ *	@details	Called before each request of the service. Does not block, the file is only read if its watch reports a
+ *				change. A failed reload is logged and retried with the next request, the request itself is processed with
+ *				the settings in effect.
+ */
+static void
+ControllerService_ReloadConfig()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReloaded = 0;
+
+	if (!FileIO_WatchChanged(s_pvConfigWatch) && !s_fConfigReloadPending)
+		return;
+
+	unReturnValue = Config_Reload(CONFIG_FILE, &s_sConfigDigest, NULL, NULL, &unReloaded);
+	s_fConfigReloadPending = RC_SUCCESS != unReturnValue;
+	if (RC_SUCCESS == unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"The config file '%ls' has changed, %u sections reloaded.", CONFIG_FILE, unReloaded);
+	}
+	else
+	{
+		LOGGING_WRITE_LEVEL1_FMT(L"The config file '%ls' could not be reloaded (0x%.8X), retrying with the next request.", CONFIG_FILE, unReturnValue);
+		Error_LogStack();
+		Error_ClearStack();
+	}
+}
+
+/**
+ *	@brief		Sends a reply frame
+ *
+ *	@param		PpvConnection			Connection handle
+ *	@param		PwszDocument			JSON result document
+ *	@param		PpszReply				Buffer for the reply frame, SERVICE_FRAME_LENGTH_SIZE + RESPONSE_JSON_DOCUMENT_SIZE *
+ *										MB_LEN_MAX bytes
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+ControllerService_SendReply(
+	_In_	void*			PpvConnection,
+	_In_z_	const wchar_t*	PwszDocument,
+	_Inout_	char*			PpszReply)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unsigned int unReplySize = 0;
+
+		unReturnValue = Platform_UnicodeString2AnsiString(&PpszReply[SERVICE_FRAME_LENGTH_SIZE], RESPONSE_JSON_DOCUMENT_SIZE * MB_LEN_MAX, PwszDocument);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReplySize = (unsigned int)strlen(&PpszReply[SERVICE_FRAME_LENGTH_SIZE]);
+		PpszReply[0] = (char)(unReplySize >> 24);
+		PpszReply[1] = (char)(unReplySize >> 16);
+		PpszReply[2] = (char)(unReplySize >> 8);
+		PpszReply[3] = (char)unReplySize;
+		unReturnValue = Platform_LocalSocketSend(PpvConnection, (const BYTE*)PpszReply, SERVICE_FRAME_LENGTH_SIZE + unReplySize);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Answers one connection waiting while a request changing the TPM is processed
+ *	@details	The TPM cannot process other commands during a firmware update, so an info request is answered with the TPM
+ *				state taken before the update started and every other request with RC_E_SERVICE_BUSY. Neither the TPM nor
+ *				the error stack of the running request are used. The connection is closed afterwards.
+ *
+ *	@param		PpvConnection			Connection handle
+ *	@param		PpBusy					State of the service
+ *	@param		PpwszDocument			Buffer for the JSON result document, RESPONSE_JSON_DOCUMENT_SIZE elements
+ *	@param		PpszReply				Buffer for the reply frame
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		The peer sent no or an invalid frame in time.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+ControllerService_AnswerBusy(
+	_In_	void*					PpvConnection,
+	_In_	const IfxServiceBusy*	PpBusy,
+	_Out_	wchar_t*				PpwszDocument,
+	_Inout_	char*					PpszReply)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		BYTE rgbRequest[SERVICE_MAX_REQUEST_SIZE + 1] = {0};
+		BYTE rgbLength[SERVICE_FRAME_LENGTH_SIZE] = {0};
+		wchar_t wszRequestType[MAX_NAME] = {0};
+		unsigned int unRequestSize = 0;
+		unsigned int unLength = 0;
+		BOOL fReady = FALSE;
+		BOOL fInfo = FALSE;
+
+		// A peer which connected but does not send its request must not delay the firmware update
+		unReturnValue = Platform_LocalSocketPoll(PpvConnection, SERVICE_BUSY_RECEIVE_TIMEOUT, &fReady);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = RC_E_BAD_PARAMETER;
+		if (!fReady)
+			break;
+
+		unReturnValue = Platform_LocalSocketReceive(PpvConnection, rgbLength, sizeof(rgbLength));
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unRequestSize = ((unsigned int)rgbLength[0] << 24) | ((unsigned int)rgbLength[1] << 16) | ((unsigned int)rgbLength[2] << 8) | rgbLength[3];
+		if (0 == unRequestSize || SERVICE_MAX_REQUEST_SIZE < unRequestSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+		unReturnValue = Platform_LocalSocketReceive(PpvConnection, rgbRequest, unRequestSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Only the request type is evaluated, an info request is answered with all fields available
+		if (RC_SUCCESS == Platform_AnsiString2UnicodeString(wszRequestType, RG_LEN(wszRequestType), (const char*)rgbRequest))
+			fInfo = 0 == Platform_StringCompare(wszRequestType, SERVICE_REQUEST_INFO, RG_LEN(SERVICE_REQUEST_INFO), TRUE);
+
+		unReturnValue = Response_GetJsonBusyResult(
+							fInfo && PpBusy->fTpmInfoValid ? &PpBusy->sTpmInfo : NULL, fInfo ? CMD_INFO : wszRequestType,
+							fInfo && PpBusy->fTpmInfoValid ? RC_SUCCESS : RC_E_SERVICE_BUSY, PpBusy->unProgress, PpwszDocument, &unLength);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = ControllerService_SendReply(PpvConnection, PpwszDocument, PpszReply);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Progress hook of the service while a request changing the TPM is processed
+ *	@details	Called between the firmware blocks whenever the completion value changes. Answers up to
+ *				SERVICE_BUSY_MAX_CONNECTIONS connections waiting on the listening socket by ControllerService_AnswerBusy, so
+ *				info requests do not have to wait for the whole firmware update.
+ *
+ *	@param		PpvContext		State of the service
+ *	@param		PunCompletion	Progress completion value between 1 and 100
+ */
+static void
+ControllerService_OnProgress(
+	_In_	void*			PpvContext,
+	_In_	unsigned int	PunCompletion)
+{
+	IfxServiceBusy* pBusy = (IfxServiceBusy*)PpvContext;
+	wchar_t* pwszDocument = NULL;
+	char* pszReply = NULL;
+	unsigned int unConnection = 0;
+
+	pBusy->unProgress = PunCompletion;
+
+	for (unConnection = 0; unConnection < SERVICE_BUSY_MAX_CONNECTIONS; unConnection++)
+	{
+		void* pvConnection = NULL;
+		unsigned int unReturnValue = RC_E_FAIL;
+		BOOL fReady = FALSE;
+
+		if (RC_SUCCESS != Platform_LocalSocketPoll(s_pvServiceSocket, 0, &fReady) || !fReady)
+			break;
+		if (RC_SUCCESS != Platform_LocalSocketAccept(s_pvServiceSocket, &pvConnection))
+			break;
+
+		if (NULL == pwszDocument)
+		{
+			pwszDocument = (wchar_t*)Platform_MemoryAllocateZero(sizeof(wchar_t) * RESPONSE_JSON_DOCUMENT_SIZE);
+			pszReply = (char*)Platform_MemoryAllocateZero(SERVICE_FRAME_LENGTH_SIZE + RESPONSE_JSON_DOCUMENT_SIZE * MB_LEN_MAX);
+		}
+		if (NULL != pwszDocument && NULL != pszReply)
+			unReturnValue = ControllerService_AnswerBusy(pvConnection, pBusy, pwszDocument, pszReply);
+		Platform_LocalSocketClose(&pvConnection);
+		LOGGING_WRITE_LEVEL2_FMT(L"Service request answered during the firmware update at %u%% (0x%.8X).", PunCompletion, unReturnValue);
+	}
+
+	Platform_MemoryFree((void**)&pszReply);
+	Platform_MemoryFree((void**)&pwszDocument);
+}
+
+/**
+ *	@brief		Processes one request
+ *	@details	Parses the command line of the request, processes it by Controller_ProceedWork and builds the JSON result
+ *				document. The properties and the error stack of the request are cleared afterwards. In the service, other
+ *				connections are answered by ControllerService_OnProgress while a request other than info is processed.
+ *				If the TPM device is not locked against other processes, the TPM state of the previous request is discarded.
+ *
+ *	@param		PrgbRequest				Request payload
+ *	@param		PunRequestSize			Size of the request payload
+ *	@param		PwszDocument			Receives the JSON result document
+ *	@param		PpunLength				Receives the length of the document without the zero termination
+ *	@param		PpfStop					Set to TRUE for a stop request
+ *	@param		PpunFinalCode			Receives the final return code of the request
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from Response_GetJsonResult.
+ */
+_Check_return_
+static unsigned int
+ControllerService_ProcessRequest(
+	_In_bytecount_(PunRequestSize)				const BYTE*		PrgbRequest,
+	_In_										unsigned int	PunRequestSize,
+	_Out_z_cap_(RESPONSE_JSON_DOCUMENT_SIZE)	wchar_t*		PwszDocument,
+	_Out_										unsigned int*	PpunLength,
+	_Out_										BOOL*			PpfStop,
+	_Out_										unsigned int*	PpunFinalCode)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxToolHeader* pResponseData = NULL;
+	wchar_t wszArguments[SERVICE_MAX_REQUEST_SIZE + 1] = {0};
+	const wchar_t* rgwszArgv[SERVICE_MAX_ARGUMENTS] = {NULL};
+	int nArgc = 0;
+	BOOL fCheck = FALSE;
+	BOOL fProgressHook = FALSE;
+	IfxServiceBusy sBusy;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		ControllerService_ReloadConfig();
+
+		unReturnValue = ControllerService_GetCommandLine(PrgbRequest, PunRequestSize, wszArguments, RG_LEN(wszArguments), rgwszArgv, &nArgc, PpfStop, &fCheck);
+		if (RC_SUCCESS != unReturnValue || *PpfStop)
+			break;
+
+		if (fCheck && !PropertyStorage_AddKeyBooleanValuePair(PROPERTY_SERVICE_CHECK, TRUE))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while adding a key value pair. (%ls)", PROPERTY_SERVICE_CHECK);
+			break;
+		}
+
+		unReturnValue = CommandLine_Parse(nArgc, rgwszArgv);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Requests arriving while the TPM is updated are answered between the firmware blocks, the TPM state is taken
+		// now because the update invalidates it
+		if (NULL != s_pvServiceSocket && !PropertyStorage_ExistsElement(PROPERTY_INFO))
+		{
+			IGNORE_RETURN_VALUE(Platform_MemorySet(&sBusy, 0, sizeof(sBusy)));
+			sBusy.fTpmInfoValid = CommandFlow_TpmInfo_GetCachedInfo(&sBusy.sTpmInfo);
+			Response_SetProgressHook(ControllerService_OnProgress, &sBusy);
+			fProgressHook = TRUE;
+		}
+
+		// Without the device lock another process may have changed the TPM since the last request, so the state is
+		// probed again. Requests answered during an update still get the state of the previous request.
+		if (!DeviceManagement_IsLocked())
+		{
+			FirmwareUpdate_InvalidateState();
+			CommandFlow_TpmInfo_InvalidateCache();
+		}
+
+		unReturnValue = Controller_ProceedWork(&pResponseData);
+	}
+	WHILE_FALSE_END;
+
+	if (fProgressHook)
+		Response_SetProgressHook(NULL, NULL);
+
+	// The reply carries the final return code of the request
+	*PpunFinalCode = NULL != Error_GetStack() ? Error_GetFinalCode() : unReturnValue;
+	unReturnValue = Response_GetJsonResult(pResponseData, *PpunFinalCode, PwszDocument, PpunLength);
+	LOGGING_WRITE_LEVEL1_FMT(L"Service request processed (0x%.8X).", *PpunFinalCode);
+
+	Controller_ReleaseResponse(&pResponseData);
+	if (NULL != Error_GetStack())
+	{
+		Error_LogStack();
+		Error_ClearStack();
+	}
+
+	// Prepare for the next request
+	Controller_ClearRequestProperties();
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Serves the requests of one connection
+ *	@details	Returns when the peer closes the connection, a frame is invalid or a stop request has been answered.
+ *
+ *	@param		PpvConnection			Connection handle
+ *	@param		PpunRequestCount		Incremented for each processed request
+ *	@param		PpfStop					Set to TRUE when a stop request has been answered
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_END_OF_FILE		The peer closed the connection.
+ *	@retval		RC_E_BAD_PARAMETER		The peer sent an invalid frame.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+ControllerService_ServeConnection(
+	_In_	void*			PpvConnection,
+	_Inout_	unsigned int*	PpunRequestCount,
+	_Out_	BOOL*			PpfStop)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	wchar_t* pwszDocument = NULL;
+	char* pszReply = NULL;
+
+	*PpfStop = FALSE;
+
+	do
+	{
+		BYTE rgbRequest[SERVICE_MAX_REQUEST_SIZE] = {0};
+		BYTE rgbLength[SERVICE_FRAME_LENGTH_SIZE] = {0};
+		unsigned int unRequestSize = 0;
+		unsigned int unLength = 0;
+		unsigned int unFinalCode = RC_E_FAIL;
+
+		pwszDocument = (wchar_t*)Platform_MemoryAllocateZero(sizeof(wchar_t) * RESPONSE_JSON_DOCUMENT_SIZE);
+		// Every wide character of the document takes at most MB_LEN_MAX bytes in the encoding of the current locale
+		pszReply = (char*)Platform_MemoryAllocateZero(SERVICE_FRAME_LENGTH_SIZE + RESPONSE_JSON_DOCUMENT_SIZE * MB_LEN_MAX);
+		if (NULL == pwszDocument || NULL == pszReply)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation for the service reply failed.");
+			break;
+		}
+
+		while (!*PpfStop)
+		{
+			// Receive the request frame
+			unReturnValue = Platform_LocalSocketReceive(PpvConnection, rgbLength, sizeof(rgbLength));
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unRequestSize = ((unsigned int)rgbLength[0] << 24) | ((unsigned int)rgbLength[1] << 16) | ((unsigned int)rgbLength[2] << 8) | rgbLength[3];
+			if (0 == unRequestSize || sizeof(rgbRequest) < unRequestSize)
+			{
+				unReturnValue = RC_E_BAD_PARAMETER;
+				LOGGING_WRITE_LEVEL1_FMT(L"Service request with invalid size %u rejected.", unRequestSize);
+				break;
+			}
+			unReturnValue = Platform_LocalSocketReceive(PpvConnection, rgbRequest, unRequestSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			unReturnValue = ControllerService_ProcessRequest(rgbRequest, unRequestSize, pwszDocument, &unLength, PpfStop, &unFinalCode);
+			(*PpunRequestCount)++;
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			unReturnValue = ControllerService_SendReply(PpvConnection, pwszDocument, pszReply);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&pszReply);
+	Platform_MemoryFree((void**)&pwszDocument);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Serves info, check and update requests on a local socket
+ *	@details	Runs for the -service command line option with the TPM connected by Controller_Initialize. Each request is
+ *				processed by Controller_ProceedWork like the command line of a separate process and answered with the JSON
+ *				result document. The TPM state is kept in memory between the requests until a request changes it, unless the
+ *				TPM device is not locked against other processes (see ControllerService_ProcessRequest).
+ *
+ *	@retval		RC_SUCCESS		The service has been stopped by a stop request.
+ *	@retval		...				Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_ServiceExecute()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unRequestCount = 0;
+	unsigned int unReloaded = 0;
+	void* pvSocket = NULL;
+	BOOL fJsonOutput = FALSE;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszPath[MAX_PATH] = {0};
+		unsigned int unPathSize = RG_LEN(wszPath);
+		BOOL fStop = FALSE;
+
+		if (!PropertyStorage_GetValueByKey(PROPERTY_SERVICE, wszPath, &unPathSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while getting a value. (%ls)", PROPERTY_SERVICE);
+			break;
+		}
+
+		// The requests are parsed like the command line of a separate process
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_SERVICE));
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_CMDLINE_COUNT));
+		CommandFlow_TpmInfo_KeepCacheInMemory(TRUE);
+
+		// Watch the tool configuration file, its changed sections are reloaded before the next request without a restart
+		IGNORE_RETURN_VALUE(Platform_MemorySet(&s_sConfigDigest, 0, sizeof(s_sConfigDigest)));
+		if (RC_SUCCESS != FileIO_WatchOpen(CONFIG_FILE, &s_pvConfigWatch) ||
+				RC_SUCCESS != Config_Reload(CONFIG_FILE, &s_sConfigDigest, NULL, NULL, &unReloaded))
+		{
+			LOGGING_WRITE_LEVEL1_FMT(L"The config file '%ls' is not reloaded on changes.", CONFIG_FILE);
+			FileIO_WatchClose(&s_pvConfigWatch);
+			Error_ClearStack();
+		}
+
+		unReturnValue = Platform_LocalSocketListen(wszPath, &pvSocket);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Could not listen on the local socket '%ls'.", wszPath);
+			break;
+		}
+		s_pvServiceSocket = pvSocket;
+		LOGGING_WRITE_LEVEL1_FMT(RES_SERVICE_LISTENING, wszPath);
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_SERVICE_LISTENING, wszPath));
+
+		// The requests are answered with the JSON result document only
+		fJsonOutput = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_JSON_OUTPUT, TRUE);
+		if (!fJsonOutput)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while adding a key value pair. (%ls)", PROPERTY_JSON_OUTPUT);
+			break;
+		}
+
+		while (!fStop)
+		{
+			void* pvConnection = NULL;
+
+			unReturnValue = Platform_LocalSocketAccept(pvSocket, &pvConnection);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				ERROR_STORE(unReturnValue, L"Could not accept a connection on the local socket.");
+				break;
+			}
+
+			// A broken connection only ends the connection, not the service
+			unReturnValue = ControllerService_ServeConnection(pvConnection, &unRequestCount, &fStop);
+			Platform_LocalSocketClose(&pvConnection);
+			if (RC_SUCCESS != unReturnValue && NULL != Error_GetStack())
+				break;
+			unReturnValue = RC_SUCCESS;
+		}
+	}
+	WHILE_FALSE_END;
+
+	s_pvServiceSocket = NULL;
+	Platform_LocalSocketClose(&pvSocket);
+	FileIO_WatchClose(&s_pvConfigWatch);
+
+	// The result of the service itself is shown as text
+	if (fJsonOutput)
+		IGNORE_RETURN_VALUE(PropertyStorage_ChangeBooleanValueByKey(PROPERTY_JSON_OUTPUT, FALSE));
+	if (RC_SUCCESS == unReturnValue)
+	{
+		LOGGING_WRITE_LEVEL1_FMT(RES_SERVICE_STOPPED, unRequestCount);
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_SERVICE_STOPPED, unRequestCount));
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Builds the request payload of a batch line
+ *	@details	Splits the line at blanks into NUL separated arguments in the encoding of the current locale. Double quotes
+ *				enclose an argument containing blanks. Empty lines and lines starting with # are skipped.
+ *
+ *	@param		PwszLine				Line of the batch file
+ *	@param		PrgbRequest				Receives the request payload
+ *	@param		PpunRequestSize			Receives the size of the request payload, 0 for a skipped line
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		The line is too long or cannot be converted.
+ */
+_Check_return_
+static unsigned int
+ControllerService_GetBatchRequest(
+	_In_z_										const wchar_t*	PwszLine,
+	_Out_bytecap_(SERVICE_MAX_REQUEST_SIZE)		BYTE*			PrgbRequest,
+	_Out_										unsigned int*	PpunRequestSize)
+{
+	unsigned int unReturnValue = RC_E_BAD_PARAMETER;
+
+	do
+	{
+		char szLine[SERVICE_MAX_REQUEST_SIZE] = {0};
+		unsigned int unIndex = 0;
+		unsigned int unSize = 0;
+		BOOL fQuoted = FALSE;
+		BOOL fArgument = FALSE;
+
+		*PpunRequestSize = 0;
+
+		if (RC_SUCCESS != Platform_UnicodeString2AnsiString(szLine, sizeof(szLine), PwszLine))
+		{
+			ERROR_STORE(unReturnValue, L"The batch line is too long or cannot be converted.");
+			break;
+		}
+
+		// The payload is at most one byte longer than the line, so it fits into PrgbRequest
+		for (unIndex = 0; '\0' != szLine[unIndex]; unIndex++)
+		{
+			char cCharacter = szLine[unIndex];
+
+			if ('"' == cCharacter)
+			{
+				fQuoted = !fQuoted;
+				fArgument = TRUE;
+				continue;
+			}
+			if (!fQuoted && (' ' == cCharacter || '\t' == cCharacter || '\r' == cCharacter || '\n' == cCharacter))
+			{
+				if (fArgument)
+					PrgbRequest[unSize++] = '\0';
+				fArgument = FALSE;
+				continue;
+			}
+			if ('#' == cCharacter && 0 == unSize && !fArgument)
+				break;
+
+			PrgbRequest[unSize++] = (BYTE)cCharacter;
+			fArgument = TRUE;
+		}
+		if (fArgument)
+			PrgbRequest[unSize++] = '\0';
+
+		*PpunRequestSize = unSize;
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Processes the info, check, update and clearownership operations of a batch file
+ *	@details	Runs for the -batch command line option with the TPM connected by Controller_Initialize. Each line of the
+ *				file (or stdin) is processed like a service request and its JSON result document is shown as one line.
+ *				The TPM state is kept in memory between the operations until an operation changes it. Stops at the first
+ *				failed operation since the following operations usually depend on it.
+ *
+ *	@retval		RC_SUCCESS		All operations completed successfully.
+ *	@retval		...				Final error code of the failed operation or error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Controller_BatchExecute()
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unOperationCount = 0;
+	void* pvReader = NULL;
+	wchar_t* pwszDocument = NULL;
+	BOOL fJsonOutput = FALSE;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszPath[MAX_PATH] = {0};
+		unsigned int unPathSize = RG_LEN(wszPath);
+		unsigned int unLineNumber = 0;
+		BOOL fStop = FALSE;
+
+		if (!PropertyStorage_GetValueByKey(PROPERTY_BATCH, wszPath, &unPathSize))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while getting a value. (%ls)", PROPERTY_BATCH);
+			break;
+		}
+
+		// The operations are parsed like the command line of a separate process
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_BATCH));
+		IGNORE_RETURN_VALUE(PropertyStorage_RemoveElement(PROPERTY_CMDLINE_COUNT));
+		CommandFlow_TpmInfo_KeepCacheInMemory(TRUE);
+
+		unReturnValue = FileIO_OpenLineReader(0 == Platform_StringCompare(wszPath, L"-", RG_LEN(wszPath), FALSE) ? SERVICE_BATCH_STDIN_PATH : wszPath, &pvReader);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"Could not open the batch file '%ls'.", wszPath);
+			break;
+		}
+
+		pwszDocument = (wchar_t*)Platform_MemoryAllocateZero(sizeof(wchar_t) * RESPONSE_JSON_DOCUMENT_SIZE);
+		if (NULL == pwszDocument)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation for the batch result failed.");
+			break;
+		}
+
+		// The operations are answered with the JSON result document only
+		fJsonOutput = PropertyStorage_AddKeyBooleanValuePair(PROPERTY_JSON_OUTPUT, TRUE);
+		if (!fJsonOutput)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while adding a key value pair. (%ls)", PROPERTY_JSON_OUTPUT);
+			break;
+		}
+
+		while (!fStop)
+		{
+			wchar_t wszLine[SERVICE_MAX_REQUEST_SIZE] = {0};
+			unsigned int unLineSize = RG_LEN(wszLine);
+			BYTE rgbRequest[SERVICE_MAX_REQUEST_SIZE] = {0};
+			unsigned int unRequestSize = 0;
+			unsigned int unLength = 0;
+			unsigned int unFinalCode = RC_E_FAIL;
+			unsigned long long ullStartTime = 0;
+
+			unReturnValue = FileIO_ReadLineFromReader(pvReader, wszLine, &unLineSize);
+			if (RC_E_END_OF_FILE == unReturnValue)
+			{
+				unReturnValue = RC_SUCCESS;
+				break;
+			}
+			unLineNumber++;
+			if (RC_SUCCESS != unReturnValue || (RG_LEN(wszLine) - 1 == unLineSize && L'\n' != wszLine[unLineSize - 1]))
+			{
+				unReturnValue = RC_E_BAD_PARAMETER;
+				ERROR_STORE_FMT(unReturnValue, L"Line %u of the batch file could not be read or is too long.", unLineNumber);
+				break;
+			}
+
+			unReturnValue = ControllerService_GetBatchRequest(wszLine, rgbRequest, &unRequestSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (0 == unRequestSize)
+				continue;
+
+			ullStartTime = Platform_GetMonotonicTimeMicroSeconds();
+			unReturnValue = ControllerService_ProcessRequest(rgbRequest, unRequestSize, pwszDocument, &unLength, &fStop, &unFinalCode);
+			if (RC_SUCCESS != unReturnValue || fStop)
+				break;
+			unOperationCount++;
+
+			IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, RES_BATCH_RECORD, unLineNumber, (Platform_GetMonotonicTimeMicroSeconds() - ullStartTime) / 1000));
+			IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, L"%ls", pwszDocument));
+			IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, L"}"));
+
+			// The following operations usually depend on the failed one. An invalid operation must not show the help.
+			if (RC_SUCCESS != unFinalCode)
+			{
+				unReturnValue = RC_E_BAD_COMMANDLINE == unFinalCode ? RC_E_BAD_PARAMETER : unFinalCode;
+				ERROR_STORE_FMT(unReturnValue, L"The batch operation in line %u failed.", unLineNumber);
+				break;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	FileIO_CloseLineReader(&pvReader);
+	Platform_MemoryFree((void**)&pwszDocument);
+
+	// The result of the batch itself is shown as text
+	if (fJsonOutput)
+		IGNORE_RETURN_VALUE(PropertyStorage_ChangeBooleanValueByKey(PROPERTY_JSON_OUTPUT, FALSE));
+	LOGGING_WRITE_LEVEL1_FMT(RES_BATCH_FINISHED, unOperationCount);
+	if (RC_SUCCESS == unReturnValue)
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, TRUE, RES_BATCH_FINISHED, unOperationCount));
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
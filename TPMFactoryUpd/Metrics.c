@@ -0,0 +1,305 @@
+﻿/**
+ *	@brief		Implements the Prometheus metrics export
+ *	@details	All metrics are gauges describing the last run. Times are given in seconds, the phases of the command are
+ *				distinguished by the phase label.
+ *	@file		Metrics.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+
+#include "Metrics.h"
+#include "FileIO.h"
+#include "Platform.h"
+#include "PropertyDefines.h"
+#include "PropertyStorage.h"
+#include "Resource.h"
+#include "Logging.h"
+
+/// Prefix of all metric names
+#define METRICS_PREFIX	L"tpmfactoryupd_"
+
+/**
+ *	@brief		Appends the HELP and TYPE lines of a gauge
+ *
+ *	@param		PpsDocument			Metrics document
+ *	@param		PwszName			Metric name without prefix
+ *	@param		PwszHelp			Help text
+ */
+static void
+Metrics_AppendHeader(
+	_Inout_		IfxStringBuilder*	PpsDocument,
+	_In_z_		const wchar_t*		PwszName,
+	_In_z_		const wchar_t*		PwszHelp)
+{
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(
+		PpsDocument, L"# HELP " METRICS_PREFIX L"%ls %ls\n# TYPE " METRICS_PREFIX L"%ls gauge\n", PwszName, PwszHelp, PwszName));
+}
+
+/**
+ *	@brief		Appends a label with an escaped value
+ *	@details	Backslash, double quote and line feed are escaped as required by the text exposition format.
+ *
+ *	@param		PpsDocument			Metrics document
+ *	@param		PwszName			Label name
+ *	@param		PwszValue			Label value
+ */
+static void
+Metrics_AppendLabel(
+	_Inout_		IfxStringBuilder*	PpsDocument,
+	_In_z_		const wchar_t*		PwszName,
+	_In_z_		const wchar_t*		PwszValue)
+{
+	const wchar_t* pwszCharacter = PwszValue;
+
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, L",%ls=\"", PwszName));
+	for (; L'\0' != *pwszCharacter; pwszCharacter++)
+	{
+		if (L'\\' == *pwszCharacter || L'"' == *pwszCharacter)
+		{
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, L"\\%lc", (wint_t)*pwszCharacter));
+		}
+		else if (L'\n' == *pwszCharacter)
+		{
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(PpsDocument, L"\\n"));
+		}
+		else
+		{
+			IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, L"%lc", (wint_t)*pwszCharacter));
+		}
+	}
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(PpsDocument, L"\""));
+}
+
+/**
+ *	@brief		Appends a duration of each phase in seconds
+ *
+ *	@param		PpsDocument			Metrics document
+ *	@param		PwszName			Metric name without prefix
+ *	@param		PwszHelp			Help text
+ *	@param		PpTimings			Phase durations in microseconds
+ *	@param		PfUpdate			TRUE to add the phases of the firmware update
+ */
+static void
+Metrics_AppendPhases(
+	_Inout_		IfxStringBuilder*		PpsDocument,
+	_In_z_		const wchar_t*			PwszName,
+	_In_z_		const wchar_t*			PwszHelp,
+	_In_		const IfxPhaseTimings*	PpTimings,
+	_In_		BOOL					PfUpdate)
+{
+	const wchar_t* rgwszPhases[] = {L"command_line", L"config", L"connect", L"state", L"image", L"prepare", L"start", L"transfer", L"complete"};
+	unsigned long long rgullTimes[RG_LEN(rgwszPhases)];
+	unsigned int unCount = PfUpdate ? RG_LEN(rgwszPhases) : 4;
+	unsigned int unIndex = 0;
+
+	rgullTimes[0] = PpTimings->ullCommandLineTime;
+	rgullTimes[1] = PpTimings->ullConfigTime;
+	rgullTimes[2] = PpTimings->ullConnectTime;
+	rgullTimes[3] = PpTimings->ullStateTime;
+	rgullTimes[4] = PpTimings->ullImageTime;
+	rgullTimes[5] = PpTimings->ullPrepareTime;
+	rgullTimes[6] = PpTimings->ullStartTime;
+	rgullTimes[7] = PpTimings->ullTransferTime;
+	rgullTimes[8] = PpTimings->ullCompleteTime;
+
+	Metrics_AppendHeader(PpsDocument, PwszName, PwszHelp);
+	for (unIndex = 0; unIndex < unCount; unIndex++)
+	{
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(
+			PpsDocument, METRICS_PREFIX L"%ls{phase=\"%ls\"} %llu.%.6llu\n",
+			PwszName, rgwszPhases[unIndex], rgullTimes[unIndex] / 1000000, rgullTimes[unIndex] % 1000000));
+	}
+}
+
+/**
+ *	@brief		Composes the metrics document
+ *
+ *	@param		PpsDocument			Metrics document
+ *	@param		PpResponseData		Response structure of the command (can be NULL)
+ *	@param		PunReturnCode		Final return code of the tool
+ */
+static void
+Metrics_Compose(
+	_Inout_		IfxStringBuilder*		PpsDocument,
+	_In_opt_	const IfxToolHeader*	PpResponseData,
+	_In_		unsigned int			PunReturnCode)
+{
+	const IfxInfo* pTpmInfo = NULL;
+	const IfxUpdate* pTpmUpdate = NULL;
+	const wchar_t* pwszCommand = L"";
+	BOOL fValid = FALSE;
+
+	// The beginning of IfxUpdate has the same layout as IfxInfo
+	if (NULL != PpResponseData && STRUCT_TYPE_TpmInfo == PpResponseData->unType)
+	{
+		pTpmInfo = (const IfxInfo*)PpResponseData;
+		pwszCommand = CMD_INFO;
+	}
+	else if (NULL != PpResponseData && STRUCT_TYPE_TpmUpdate == PpResponseData->unType)
+	{
+		pTpmInfo = (const IfxInfo*)PpResponseData;
+		pTpmUpdate = (const IfxUpdate*)PpResponseData;
+		pwszCommand = CMD_UPDATE;
+	}
+
+	// The TPM state is only valid if the command has read it from the TPM
+	if (NULL != pTpmInfo)
+	{
+		BITFIELD_TPM_ATTRIBUTES sAttributes = pTpmInfo->sTpmState.attribs;
+		fValid = !sAttributes.bootLoader && (sAttributes.tpm12 || sAttributes.tpm20);
+	}
+
+	Metrics_AppendHeader(PpsDocument, L"info", L"Command, tool version and TPM firmware version of the last run.");
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(PpsDocument, METRICS_PREFIX L"info{"));
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, L"command=\"%ls\",tool_version=\"%ls\"", pwszCommand, APP_VERSION));
+	if (fValid && (pTpmInfo->unFields & TPM_INFO_FIELD_VERSION))
+		Metrics_AppendLabel(PpsDocument, L"firmware_version", pTpmInfo->wszVersionName);
+	if (NULL != pTpmUpdate && L'\0' != pTpmUpdate->wszNewFirmwareVersion[0])
+		Metrics_AppendLabel(PpsDocument, L"new_firmware_version", pTpmUpdate->wszNewFirmwareVersion);
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppend(PpsDocument, L"} 1\n"));
+
+	Metrics_AppendHeader(PpsDocument, L"last_run_timestamp_seconds", L"Time of the last run.");
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(
+		PpsDocument, METRICS_PREFIX L"last_run_timestamp_seconds %llu\n", Platform_GetTimeMicroSeconds() / 1000000));
+	Metrics_AppendHeader(PpsDocument, L"success", L"1 if the last run succeeded, 0 otherwise.");
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, METRICS_PREFIX L"success %u\n", RC_SUCCESS == PunReturnCode ? 1 : 0));
+	Metrics_AppendHeader(PpsDocument, L"return_code", L"Final return code of the last run.");
+	IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, METRICS_PREFIX L"return_code %u\n", PunReturnCode));
+
+	if (NULL == pTpmInfo)
+		return;
+
+	if (fValid && (pTpmInfo->unFields & TPM_INFO_FIELD_COUNTER) && REMAINING_UPDATES_UNAVAILABLE != pTpmInfo->unRemainingUpdates)
+	{
+		Metrics_AppendHeader(PpsDocument, L"remaining_updates", L"Remaining firmware updates of the TPM as read before the update.");
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, METRICS_PREFIX L"remaining_updates %u\n", pTpmInfo->unRemainingUpdates));
+	}
+
+	Metrics_AppendPhases(PpsDocument, L"phase_duration_seconds", L"Duration of each phase.", &pTpmInfo->sTimings, NULL != pTpmUpdate);
+	Metrics_AppendPhases(PpsDocument, L"phase_cpu_seconds", L"Host CPU time of each phase.", &pTpmInfo->sCpuTimings, NULL != pTpmUpdate);
+	Metrics_AppendPhases(PpsDocument, L"phase_wait_seconds", L"Time of each phase spent waiting for the TPM.", &pTpmInfo->sWaitTimings, NULL != pTpmUpdate);
+
+	if (NULL != pTpmUpdate)
+	{
+		const IfxPhaseTimings* pTimings = &pTpmUpdate->sTimings;
+		unsigned long long ullUpdateTime = pTimings->ullStartTime + pTimings->ullTransferTime + pTimings->ullCompleteTime;
+		unsigned long long ullBlockRate = 0 == pTimings->ullTransferTime ? 0 : pTpmUpdate->unBlockCount * 1000000000ULL / pTimings->ullTransferTime;
+
+		Metrics_AppendHeader(PpsDocument, L"update_duration_seconds", L"Duration of the firmware update from FieldUpgradeStart to FieldUpgradeComplete.");
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(
+			PpsDocument, METRICS_PREFIX L"update_duration_seconds %llu.%.6llu\n", ullUpdateTime / 1000000, ullUpdateTime % 1000000));
+		Metrics_AppendHeader(PpsDocument, L"update_blocks", L"Number of firmware blocks of the transfer.");
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, METRICS_PREFIX L"update_blocks %u\n", pTpmUpdate->unBlockCount));
+		Metrics_AppendHeader(PpsDocument, L"update_blocks_per_second", L"Firmware blocks transferred per second.");
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(
+			PpsDocument, METRICS_PREFIX L"update_blocks_per_second %llu.%.3llu\n", ullBlockRate / 1000, ullBlockRate % 1000));
+		Metrics_AppendHeader(PpsDocument, L"update_resent_blocks", L"Number of firmware blocks resent after a transient transport error.");
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(PpsDocument, METRICS_PREFIX L"update_resent_blocks %u\n", pTpmUpdate->unResentBlockCount));
+	}
+}
+
+/**
+ *	@brief		Writes the metrics file given with the -metrics command line option
+ *	@details	The metrics are written to a temporary file which is renamed to the metrics file, so the collector never
+ *				reads a partially written file. Nothing is done if the option is not set.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@param		PunReturnCode			Final return code of the tool
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Metrics_Write(
+	_In_opt_	const IfxToolHeader*	PpResponseData,
+	_In_		unsigned int			PunReturnCode)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	wchar_t* wszDocument = NULL;
+	void* pvFile = NULL;
+	wchar_t wszTemporaryFile[MAX_PATH] = {0};
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszMetricsFile[MAX_PATH] = {0};
+		unsigned int unMetricsFileSize = RG_LEN(wszMetricsFile);
+		IfxStringBuilder sDocument;
+		IfxStringBuilder sTemporaryFile;
+
+		if (FALSE == PropertyStorage_GetValueByKey(PROPERTY_METRICS, wszMetricsFile, &unMetricsFileSize))
+			break;
+
+		wszDocument = (wchar_t*)Platform_MemoryAllocateZero(METRICS_DOCUMENT_SIZE * sizeof(wchar_t));
+		if (NULL == wszDocument)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+			break;
+		}
+		Platform_StringBuilderInitialize(&sDocument, wszDocument, METRICS_DOCUMENT_SIZE);
+		Metrics_Compose(&sDocument, PpResponseData, PunReturnCode);
+		unReturnValue = sDocument.unReturnValue;
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE(unReturnValue, L"The metrics do not fit into the metrics document.");
+			break;
+		}
+
+		// The textfile collector only reads files ending with .prom, the temporary file is ignored until the rename
+		Platform_StringBuilderInitialize(&sTemporaryFile, wszTemporaryFile, RG_LEN(wszTemporaryFile));
+		IGNORE_RETURN_VALUE(Platform_StringBuilderAppendFormat(&sTemporaryFile, L"%ls.tmp", wszMetricsFile));
+		unReturnValue = sTemporaryFile.unReturnValue;
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The metrics file path '%ls' is too long.", wszMetricsFile);
+			break;
+		}
+		unReturnValue = FileIO_Open(wszTemporaryFile, &pvFile, FILE_WRITE);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The metrics file '%ls' cannot be written.", wszTemporaryFile);
+			wszTemporaryFile[0] = L'\0';
+			break;
+		}
+		unReturnValue = FileIO_WriteString(pvFile, wszDocument);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The metrics file '%ls' cannot be written.", wszTemporaryFile);
+			break;
+		}
+		unReturnValue = FileIO_Close(&pvFile);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The metrics file '%ls' cannot be written.", wszTemporaryFile);
+			break;
+		}
+		unReturnValue = FileIO_Rename(wszTemporaryFile, wszMetricsFile);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The metrics file '%ls' cannot be replaced.", wszMetricsFile);
+			break;
+		}
+		wszTemporaryFile[0] = L'\0';
+	}
+	WHILE_FALSE_END;
+
+	// Do not leave a partially written temporary file behind
+	if (NULL != pvFile)
+		IGNORE_RETURN_VALUE(FileIO_Close(&pvFile));
+	if (L'\0' != wszTemporaryFile[0])
+		IGNORE_RETURN_VALUE(FileIO_Remove(wszTemporaryFile));
+	Platform_MemoryFree((void**)&wszDocument);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
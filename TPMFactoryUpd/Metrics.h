@@ -0,0 +1,46 @@
+﻿/**
+ *	@brief		Declares the Prometheus metrics export
+ *	@details	This module writes the outcome of an -info or -update command as metrics in the Prometheus text
+ *				exposition format, to be picked up by the textfile collector of the node exporter.
+ *	@file		Metrics.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+#pragma once
+
+#include "StdInclude.h"
+#include "TPMFactoryUpdStruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Maximum length of the metrics document in characters
+#define METRICS_DOCUMENT_SIZE	8192
+
+/**
+ *	@brief		Writes the metrics file given with the -metrics command line option
+ *	@details	The metrics are written to a temporary file which is renamed to the metrics file, so the collector never
+ *				reads a partially written file. Nothing is done if the option is not set.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@param		PunReturnCode			Final return code of the tool
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Metrics_Write(
+	_In_opt_	const IfxToolHeader*	PpResponseData,
+	_In_		unsigned int			PunReturnCode);
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,6 +31,20 @@ extern "C" {
 #define PROPERTY_LOGGING_PATH			L"LoggingPath"
 /// Define for logging max file size configuration setting property
 #define PROPERTY_LOGGING_MAXSIZE		L"LoggingMaxSize"
+/// Define for logging flush interval configuration setting property
+#define PROPERTY_LOGGING_FLUSH_INTERVAL	L"LoggingFlushInterval"
+/// Define for Logging max files setting property
+#define PROPERTY_LOGGING_MAX_FILES		L"LoggingMaxFiles"
+/// Define for rotated log file compression configuration setting property
+#define PROPERTY_LOGGING_COMPRESS		L"LoggingCompress"
+/// Define for asynchronous logging configuration setting property
+#define PROPERTY_LOGGING_ASYNC			L"LoggingAsync"
+/// Define for JSON log record configuration setting property
+#define PROPERTY_LOGGING_JSON			L"LoggingJson"
+/// Define for per-module logging level configuration setting property
+#define PROPERTY_LOGGING_MODULE_LEVELS	L"LoggingModuleLevels"
+/// Define for firmware block logging sample configuration setting property
+#define PROPERTY_LOGGING_BLOCK_SAMPLE	L"LoggingBlockSample"
 /// Define for console mode configuration setting property
 #define PROPERTY_CONSOLE_MODE			L"ConsoleMode"
 /// Define for locality configuration setting property
@@ -41,6 +55,7 @@ extern "C" {
 #define PROPERTY_HELP_ALT				L"?"
 /// Define for info property
 #define PROPERTY_INFO					L"Info"
+#define PROPERTY_INFO_FIELDS			L"InfoFields"
 /// Define for update property
 #define PROPERTY_UPDATE					L"Update"
 /// Define for update type property
@@ -49,8 +64,6 @@ extern "C" {
 #define PROPERTY_FIRMWARE_PATH			L"Firmware"
 /// Define for configuration file path configuration setting property
 #define PROPERTY_CONFIG_FILE_PATH		L"Config"
-/// Define for Logging size check flag
-#define PROPERTY_LOGGING_CHECK_SIZE		L"LoggingCheckFileSize"
 /// Define for TPM12-ClearOwnership property
 #define PROPERTY_TPM12_CLEAROWNERSHIP	L"TPM12-ClearOwnership"
 // PROPERTY_CALL_SHUTDOWN_ON_EXIT, PROPERTY_TPM_DEVICE_ACCESS_MODE and PROPERTY_TPM_DEVICE_ACCESS_PATH are defined in Globals.h
@@ -70,6 +83,58 @@ extern "C" {
 #define PROPERTY_DRY_RUN				L"DryRun"
 /// Define for IgnoreErrorOnComplete property
 #define PROPERTY_IGNORE_ERROR_ON_COMPLETE		L"IgnoreErrorOnComplete"
+/// Define for TPM information cache time to live property
+#define PROPERTY_INFO_CACHE_TTL			L"InfoCacheTtl"
+/// Define for firmware image verification cache property
+#define PROPERTY_VERIFY_CACHE			L"VerifyCache"
+/// Define for learned TPM command timeouts property
+#define PROPERTY_LEARN_TIMEOUTS			L"LearnTimeouts"
+/// Define for benchmark firmware path property
+#define PROPERTY_BENCHMARK				L"Benchmark"
+/// Define for check images property (path to a directory, firmware image or firmware image bundle)
+#define PROPERTY_CHECK_IMAGES			L"CheckImages"
+/// Define for decode capture property (path to a TPM capture file)
+#define PROPERTY_DECODE_CAPTURE			L"DecodeCapture"
+/// Define for JSON output property
+#define PROPERTY_JSON_OUTPUT			L"JsonOutput"
+/// Define for phase timing output property
+#define PROPERTY_TIMING					L"Timing"
+/// Define for quiet output property
+#define PROPERTY_QUIET_OUTPUT			L"QuietOutput"
+/// Define for the number of TPM devices processed at the same time
+#define PROPERTY_DEVICE_JOBS			L"DeviceJobs"
+/// Define for the fork property, the workers of several TPM devices are forked instead of started again
+#define PROPERTY_DEVICE_FORK			L"DeviceFork"
+/// Define for the device log property, each TPM device is logged to a log file of its own
+#define PROPERTY_DEVICE_LOG				L"DeviceLog"
+/// Time to live in seconds of the TPM information cache used by the background option if info-cache is not given
+#define BACKGROUND_INFO_CACHE_TTL		L"300"
+/// Define for service property (path of the local socket)
+#define PROPERTY_SERVICE				L"Service"
+/// Define for the service check property, set by the service for a check request to stop the update flow after the image checks
+#define PROPERTY_SERVICE_CHECK			L"ServiceCheck"
+/// Define for the prepare property, the update stops after the preparation and records an update plan
+#define PROPERTY_PREPARE				L"Prepare"
+/// Define for the commit property, the update uses the update plan recorded by a run with PROPERTY_PREPARE
+#define PROPERTY_COMMIT					L"Commit"
+/// Define for the deadline property, the time in seconds an update must complete in
+#define PROPERTY_DEADLINE				L"Deadline"
+/// Define for the progress file property, the path of the file the update progress record is written to
+#define PROPERTY_PROGRESS_FILE			L"ProgressFile"
+/// Define for the clear ownership after update property, the TPM1.2 Ownership taken for the update is cleared in the same run
+#define PROPERTY_CLEAROWNERSHIP_AFTER	L"ClearOwnershipAfter"
+/// Define for the factory loop property, the trigger starting the update of the next unit
+#define PROPERTY_FACTORY_LOOP			L"FactoryLoop"
+/// Define for the trace property, the path of the file the trace event spans are written to
+#define PROPERTY_TRACE					L"Trace"
+/// Define for the metrics property, the path of the file the Prometheus metrics are written to
+#define PROPERTY_METRICS				L"Metrics"
+/// Define for the batch property, the path of the file the operations are read from
+#define PROPERTY_BATCH					L"Batch"
+/// Define for the build frames property, the maximum data size the frame file is built for
+#define PROPERTY_BUILD_FRAMES			L"BuildFrames"
+/// Define for the frame file property, the path of the frame file written by -build-frames or sent by -update
+#define PROPERTY_FRAME_FILE				L"FrameFile"
 
 #ifdef __cplusplus
 }
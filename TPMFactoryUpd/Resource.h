@@ -74,6 +74,7 @@
 #define RES_TPM_UPDATE_TPM_FAMILY_AFTER				L"       TPM family after update           :    %ls"
 #define RES_TPM_UPDATE_TPM_VERSION_AFTER			L"       TPM firmware version after update :    %ls"
 #define RES_TPM_UPDATE_UPDATABLE					L"       New firmware valid for TPM        :    %ls"
+#define RES_TPM_UPDATE_DURATION						L"       Estimated update duration         :    %llu s" /* use with format predicted duration in seconds */
 #define RES_TPM_UPDATE_PREPARE						L"       Preparation steps:"
 #define RES_TPM_UPDATE_PREPARE_POLICY				L"       TPM2.0 policy session created to authorize the update."
 #define RES_TPM_UPDATE_PREPARE_POLICY_FAIL			L"       TPM2.0 policy session creation failed."
@@ -83,11 +84,13 @@
 #define RES_TPM_UPDATE_PREPARE_PP_FAIL				L"       TPM1.2 Physical Presence is locked and Deferred Physical\n       Presence is not set. The firmware cannot be updated."
 #define RES_TPM_UPDATE_PREPARE_TAKEOWNERSHIP		L"       TPM1.2 Ownership preparation was successful."
 #define	RES_TPM_UPDATE_PREPARE_TAKEOWNERSHIP_FAIL	L"       TPM1.2 Ownership preparation failed."
+#define RES_TPM_UPDATE_PLAN_RECORDED				L"       Update plan recorded. Run the update with -%ls to update the TPM firmware." /* use with format CMD_COMMIT */
 #define RES_TPM_UPDATE_DO_NOT_TURN_OFF				L"    DO NOT TURN OFF OR SHUT DOWN THE SYSTEM DURING THE UPDATE PROCESS!"
 #define RES_TPM_UPDATE_UPDATE						L"       Updating the TPM firmware ..."
 #define RES_TPM_UPDATE_SUCCESS						L"       TPM Firmware Update completed successfully."
 #define RES_TPM_UPDATE_FAIL							L"       TPM Firmware Update failed."
-#define RES_TPM_UPDATE_PROGRESS						L"       Completion: %d %%\r"
+#define RES_TPM_UPDATE_PROGRESS						L"       Completion: %d %%                              \r" /* Padded to overwrite RES_TPM_UPDATE_PROGRESS_DETAILS */
+#define RES_TPM_UPDATE_PROGRESS_DETAILS				L"       Completion: %d %% (%d KB/s, %d s remaining)    \r"
 #define RES_TPM_UPDATE_FACTORYDEFAULT				L"       TPM chip state after update       :    reset to factory defaults"
 
 //---------------- Tpm12_ClearOwnership response ------------
@@ -96,10 +99,106 @@
 #define RES_TPM12_CLEAR_OWNER_SUCCESS				L"       Clear TPM1.2 Ownership operation completed successfully."
 #define RES_TPM12_CLEAR_OWNER_FAILED				L"       Clear TPM1.2 Ownership operation failed. (0x%.8X)"
 
+//---------------- Service response ------------
+#define RES_SERVICE_LISTENING						L"       Serving requests on '%ls'."
+#define RES_SERVICE_STOPPED							L"       Service stopped after %u requests."
+
+//---------------- Batch response ------------
+#define RES_BATCH_RECORD							L"{\"line\":%u,\"duration_ms\":%llu,\"result\":"
+#define RES_BATCH_FINISHED							L"       Batch finished after %u operations."
+
+//---------------- Factory loop response ------------
+#define RES_FACTORY_LOOP_WAIT_OPERATOR				L"       Connect unit %u and press Enter (q and Enter to stop)."
+#define RES_FACTORY_LOOP_WAIT_DEVICE				L"       Waiting for unit %u at '%ls' (q and Enter to stop)."
+#define RES_FACTORY_LOOP_REMOVE_DEVICE				L"       Unit %u done, remove it."
+#define RES_FACTORY_LOOP_RECORD						L"{\"unit\":%u,\"duration_ms\":%llu,\"result\":"
+#define RES_FACTORY_LOOP_STOPPED					L"       Factory loop stopped after %u units (%u failed)."
+
+//---------------- Multiple devices response ------------
+#define RES_DEVICE_OUTPUT							L"\n  ----- TPM device %ls (exit code %u) -----"
+#define RES_DEVICE_SUMMARY							L"\n       %u of %u TPM devices completed successfully."
+
+//---------------- Timing response ------------
+#define RES_TIMING_INFORMATION						L"       Phase timing:"
+#define RES_TIMING_DASHED_LINE						L"       -------------"
+#define RES_TIMING_COLUMNS							L"       %-34ls     %13ls  %13ls  %13ls"
+#define RES_TIMING_COLUMN_TOTAL						L"Total"
+#define RES_TIMING_COLUMN_CPU						L"Host CPU"
+#define RES_TIMING_COLUMN_WAIT						L"TPM wait"
+#define RES_TIMING_PHASE							L"       %-34ls:    %6llu.%.3llu ms  %6llu.%.3llu ms  %6llu.%.3llu ms"
+#define RES_TIMING_PHASE_COMMAND_LINE				L"Parse command line"
+#define RES_TIMING_PHASE_CONFIG						L"Parse configuration files"
+#define RES_TIMING_PHASE_CONNECT					L"Connect to TPM"
+#define RES_TIMING_PHASE_STATE						L"Probe TPM state"
+#define RES_TIMING_PHASE_IMAGE						L"Load and check firmware image"
+#define RES_TIMING_PHASE_PREPARE					L"Prepare update"
+#define RES_TIMING_PHASE_START						L"Start update"
+#define RES_TIMING_PHASE_TRANSFER					L"Transfer firmware blocks"
+#define RES_TIMING_PHASE_COMPLETE					L"Complete update"
+#define RES_TIMING_MEMORY_PEAK						L"       %-34ls:    %llu bytes (%llu allocations)"
+#define RES_TIMING_MEMORY_PEAK_HEAP					L"Peak heap memory"
+
+//---------------- Benchmark response ------------
+#define RES_BENCHMARK_INFORMATION					L"       Benchmark against a simulated TPM1.2 in boot loader mode:"
+#define RES_BENCHMARK_DASHED_LINE					L"       ---------------------------------------------------------"
+#define RES_BENCHMARK_IMAGE							L"       Firmware image                    :    %u bytes, %u blocks"
+#define RES_BENCHMARK_COMMANDS						L"       TPM commands                      :    %u"
+#define RES_BENCHMARK_STAGE							L"       %-34ls:    %llu.%.3llu ms"
+#define RES_BENCHMARK_STAGE_LOAD					L"Load firmware image"
+#define RES_BENCHMARK_STAGE_UNMARSHAL				L"Unmarshal firmware image"
+#define RES_BENCHMARK_STAGE_PROBE					L"Probe TPM state"
+#define RES_BENCHMARK_STAGE_CHECK					L"Check firmware image"
+#define RES_BENCHMARK_STAGE_START					L"Start update"
+#define RES_BENCHMARK_STAGE_TRANSFER				L"Transfer firmware blocks"
+#define RES_BENCHMARK_STAGE_COMPLETE				L"Complete update (incl. fixed wait)"
+#define RES_BENCHMARK_THROUGHPUT					L"       Throughput                        :    %llu blocks/s, %llu us per block"
+#define RES_BENCHMARK_FAILED						L"       Benchmark failed. (0x%.8X)"
+#define RES_BENCHMARK_MICRO_INFORMATION				L"       Microbenchmarks (%u iterations each):"
+#define RES_BENCHMARK_MICRO_ENTRY					L"       %-34ls:    %llu ns/op, %llu.%.2llu allocations/op"
+#define RES_BENCHMARK_MICRO_FAILED					L"       %-34ls:    failed (0x%.8X)"
+
+//---------------- CheckImages response ------------
+#define RES_CHECK_IMAGES_INFORMATION				L"       Firmware image applicability:"
+#define RES_CHECK_IMAGES_DASHED_LINE				L"       -----------------------------"
+#define RES_CHECK_IMAGES_ENTRY						L"       %-34ls:    %ls%ls"
+#define RES_CHECK_IMAGES_APPLICABLE					L"Applicable"
+#define RES_CHECK_IMAGES_NOT_APPLICABLE				L"Not applicable"
+#define RES_CHECK_IMAGES_TARGET						L" (TPM%ls %ls)"
+#define RES_CHECK_IMAGES_REASON						L"       %-34ls     %ls (0x%.8X)"
+#define RES_CHECK_IMAGES_NONE						L"       No firmware image found."
+#define RES_CHECK_IMAGES_SKIPPED					L"       %u more firmware images were not checked."
+
+//---------------- DecodeCapture response ------------
+#define RES_DECODE_CAPTURE_INFORMATION				L"       TPM capture:"
+#define RES_DECODE_CAPTURE_DASHED_LINE				L"       ------------"
+#define RES_DECODE_CAPTURE_RECORD					L"       #%-5u %8llu.%03llu ms  %-40ls %10u us  %5u / %5u bytes"
+#define RES_DECODE_CAPTURE_UNKNOWN_COMMAND			L"Unknown command 0x%.8X"
+#define RES_DECODE_CAPTURE_RESPONSE_CODE			L"              Response code 0x%.8X: %ls"
+#define RES_DECODE_CAPTURE_NO_RESPONSE_CODE			L"              No response code."
+#define RES_DECODE_CAPTURE_TRANSMIT_FAILED			L"              Transmission failed. (0x%.8X)"
+#define RES_DECODE_CAPTURE_REQUEST					L"              > %ls"
+#define RES_DECODE_CAPTURE_RESPONSE					L"              < %ls"
+#define RES_DECODE_CAPTURE_CONTINUATION				L"                %ls"
+#define RES_DECODE_CAPTURE_BYTES_PER_LINE			16
+#define RES_DECODE_CAPTURE_SUMMARY					L"       %u TPM commands, %u failed transmissions, %llu.%03llu ms in TPM commands"
+#define RES_DECODE_CAPTURE_TRUNCATED				L"       The capture file is truncated, %u bytes were not decoded."
+
+//---------------- BuildFrames response ------------
+#define RES_BUILD_FRAMES_INFORMATION				L"       Frame file:"
+#define RES_BUILD_FRAMES_DASHED_LINE				L"       -----------"
+#define RES_BUILD_FRAMES_FILE						L"       File:              %ls"
+#define RES_BUILD_FRAMES_FAMILY						L"       Source TPM family: %ls"
+#define RES_BUILD_FRAMES_FRAMES						L"       Frames:            %u of up to %u bytes firmware data"
+#define RES_BUILD_FRAMES_SIZE						L"       Size:              %u bytes"
+
 // --------------- Command line options ---------------------
 #define CMD_HELP									L"help"
 #define CMD_HELP_ALT								L"?"
 #define CMD_INFO									L"info"
+#define CMD_INFO_FIELD_FAMILY						L"family"
+#define CMD_INFO_FIELD_VERSION						L"version"
+#define CMD_INFO_FIELD_COUNTER						L"counter"
+#define CMD_INFO_FIELD_STATE						L"state"
 #define CMD_UPDATE									L"update"
 #define CMD_UPDATE_OPTION_TPM12_DEFERREDPP			L"tpm12-PP"
 #define CMD_UPDATE_OPTION_TPM12_TAKEOWNERSHIP		L"tpm12-takeownership"
@@ -112,6 +211,34 @@
 #define CMD_CONFIG									L"config"
 #define CMD_DRY_RUN									L"dry-run"
 #define CMD_IGNORE_ERROR_ON_COMPLETE				L"ignore-error-on-complete"
+#define CMD_STATISTICS								L"stats"
+#define CMD_INFO_CACHE								L"info-cache"
+#define CMD_VERIFY_CACHE							L"verify-cache"
+#define CMD_LEARN_TIMEOUTS							L"learn-timeouts"
+#define CMD_BENCHMARK								L"benchmark"
+#define CMD_CHECK_IMAGES							L"check-images"
+#define CMD_DECODE_CAPTURE							L"decode-capture"
+#define CMD_JSON									L"json"
+#define CMD_TIMING									L"timing"
+#define CMD_SERVICE									L"service"
+#define CMD_QUIET									L"quiet"
+#define CMD_JOBS									L"jobs"
+#define CMD_FORK									L"fork"
+#define CMD_DEVICE_LOG								L"device-log"
+#define CMD_BACKGROUND								L"background"
+#define CMD_PREPARE									L"prepare"
+#define CMD_COMMIT									L"commit"
+#define CMD_DEADLINE								L"deadline"
+#define CMD_PROGRESS_FILE							L"progress-file"
+#define CMD_CLEAROWNERSHIP_AFTER					L"clearownership-after"
+#define CMD_FACTORY_LOOP							L"factory-loop"
+#define CMD_TRACE									L"trace"
+#define CMD_METRICS									L"metrics"
+#define CMD_BATCH									L"batch"
+#define CMD_BUILD_FRAMES							L"build-frames"
+#define CMD_FRAME_FILE								L"frame-file"
+#define FACTORY_LOOP_TRIGGER_OPERATOR				L"operator"
+#define FACTORY_LOOP_TRIGGER_DEVICE					L"device"
 
 // --------------- Help Output ---------------------
 #define HELP_LINE1		L"Call: TPMFactoryUpd [parameter] [parameter] ..."
@@ -120,7 +247,7 @@
 #define HELP_LINE4		L"\n-%ls or -%ls" /* Use with format CMD_HELP_ALT and CMD_HELP */
 #define HELP_LINE5		L"  Displays a short help page for the operation of TPMFactoryUpd (this screen)."
 #define HELP_LINE6		L"  Cannot be used with any other parameter."
-#define HELP_LINE7		L"\n-%ls" /* Use with format CMD_INFO */
+#define HELP_LINE7		L"\n-%ls [<fields>]" /* Use with format CMD_INFO */
 #define HELP_LINE8		L"  Displays TPM information related to TPM Firmware Update."
 #define HELP_LINE9		L"  Cannot be used with -%ls, -%ls, -%ls or -%ls parameter." /* Use with format CMD_FIRMWARE, CMD_UPDATE, CMD_CONFIG and CMD_TPM12_CLEAROWNERSHIP */
 #define HELP_LINE10		L"\n-%ls <update-type>" /* Use with format CMD_UPDATE */
@@ -152,14 +279,123 @@
 #define HELP_LINE36		L"  Optional parameter. Sets the mode the tool should use to connect to"
 #define HELP_LINE37		L"  the TPM device."
 #define HELP_LINE38		L"  Possible values for <mode> are:"
-#define HELP_LINE39		L"  1 - Memory based access (default value, only supported on x86 based systems"
-#define HELP_LINE40		L"      with PCH TPM support)"
+#define HELP_LINE39		L"  1 - Memory based access (default value). Maps the TPM registers at their"
+#define HELP_LINE40		L"      ACPI/device tree address or at MEMORY_BASE of TPMFactoryUpd.cfg"
 #define HELP_LINE41		L"  3 - Linux TPM driver. The <path> option can be set to define a device path"
 #define HELP_LINE42		L"      (default value: /dev/tpm0)"
-#define HELP_LINE43		L"\n-%ls" /* use with format CMD_DRY_RUN */
-#define HELP_LINE44		L"  Optional parameter. Do everything except actually updating the image."
-#define HELP_LINE45		L"\n-%ls" /* use with format CMD_IGNORE_ERROR_ON_COMPLETE */
-#define HELP_LINE46		L"  Optional parameter. Ignores TPM_FAIL errors from FieldUpgradeComplete."
+#define HELP_LINE43		L"  4 - Linux TPM resource manager. Allows other applications to use the TPM"
+#define HELP_LINE44		L"      concurrently. Can only be used with -%ls or -%ls. The <path> option" /* Use with format CMD_INFO and CMD_CHECK_IMAGES */
+#define HELP_LINE45		L"      can be set to define a device path (default value: /dev/tpmrm0)"
+#define HELP_LINE46		L"\n-%ls" /* use with format CMD_DRY_RUN */
+#define HELP_LINE47		L"  Optional parameter. Do everything except actually updating the image."
+#define HELP_LINE48		L"\n-%ls" /* use with format CMD_IGNORE_ERROR_ON_COMPLETE */
+#define HELP_LINE49		L"  Optional parameter. Ignores TPM_FAIL errors from FieldUpgradeComplete."
+#define HELP_LINE50		L"\n-%ls" /* use with format CMD_STATISTICS */
+#define HELP_LINE51		L"  Optional parameter. Writes TPM transport and memory statistics to the log file."
+#define HELP_LINE52		L"\n-%ls <seconds>" /* use with format CMD_INFO_CACHE */
+#define HELP_LINE53		L"  Optional parameter for -info. Answers from the TPM information cache in"
+#define HELP_LINE54		L"  /run if it is younger than <seconds>, otherwise queries the TPM and"
+#define HELP_LINE55		L"  refreshes the cache. -update and -tpm12-clearownership invalidate the cache."
+#define HELP_LINE56		L"\n-%ls <firmware-file>" /* use with format CMD_BENCHMARK */
+#define HELP_LINE57		L"  Runs the firmware update with <firmware-file> against a simulated TPM and"
+#define HELP_LINE58		L"  shows the time spent in each stage. Does not access the TPM."
+#define HELP_LINE59		L"  5 - TPM simulator. Runs the command flows against a simulated TPM configured"
+#define HELP_LINE60		L"      in the [TPM_SIMULATOR] section of TPMFactoryUpd.cfg (no TPM is accessed)"
+#define HELP_LINE61		L"  6 - Capture replay. Serves the TPM responses of the capture file <path>"
+#define HELP_LINE62		L"      recorded with the RECORD setting of the [TPM_DEVICE_ACCESS] section"
+#define HELP_LINE63		L"      of TPMFactoryUpd.cfg (no TPM is accessed)"
+#define HELP_LINE64		L"  7 - Software TPM (swtpm or MS TPM simulator) socket. The <path> option"
+#define HELP_LINE65		L"      can be set to define host and command port (default: localhost:2321)"
+#define HELP_LINE66		L"\n-%ls" /* use with format CMD_VERIFY_CACHE */
+#define HELP_LINE67		L"  Optional parameter for -update. Remembers firmware images which passed the"
+#define HELP_LINE68		L"  integrity and signature checks in /var/cache and skips these checks for an"
+#define HELP_LINE69		L"  unchanged image. The TPM dependent checks are always performed."
+#define HELP_LINE70		L"\n-%ls <folder|firmware-file>" /* use with format CMD_CHECK_IMAGES */
+#define HELP_LINE71		L"  Checks which firmware images in <folder> or in the firmware image bundle"
+#define HELP_LINE72		L"  <firmware-file> can be used to update the TPM and why the others cannot."
+#define HELP_LINE73		L"  The TPM is not updated. Cannot be used with -%ls or -%ls parameter." /* use with format CMD_UPDATE and CMD_FIRMWARE */
+#define HELP_LINE74		L"\n-%ls <capture-file>" /* use with format CMD_DECODE_CAPTURE */
+#define HELP_LINE75		L"  Displays the TPM commands of a capture file recorded with the RECORD setting"
+#define HELP_LINE76		L"  of the [TPM_DEVICE_ACCESS] section. Does not access the TPM."
+#define HELP_LINE77		L"\n-%ls" /* use with format CMD_JSON */
+#define HELP_LINE78		L"  Optional parameter for -%ls, -%ls and -%ls. Writes the result" /* use with format CMD_INFO, CMD_UPDATE and CMD_TPM12_CLEAROWNERSHIP */
+#define HELP_LINE79		L"  as a single JSON document to the console instead of the text output."
+#define HELP_LINE80		L"\n-%ls" /* use with format CMD_TIMING */
+#define HELP_LINE81		L"  Optional parameter for -%ls and -%ls. Shows the time spent in each phase" /* use with format CMD_INFO and CMD_UPDATE */
+#define HELP_LINE82		L"  (connect, TPM state, image checks, preparation, update). Always part of -%ls." /* use with format CMD_JSON */
+#define HELP_LINE83		L"\n-%ls <socket-path>" /* use with format CMD_SERVICE */
+#define HELP_LINE84		L"  Keeps the TPM connected and serves info, check and update requests on the"
+#define HELP_LINE85		L"  local socket <socket-path> until a stop request is received."
+#define HELP_LINE86		L"  Can only be used with -%ls and -%ls parameter." /* use with format CMD_LOG and CMD_ACCESS_MODE */
+#define HELP_LINE87		L"  <fields> is a comma separated list of %ls, %ls, %ls and %ls (default: all)." /* use with format CMD_INFO_FIELD_FAMILY, CMD_INFO_FIELD_VERSION, CMD_INFO_FIELD_COUNTER and CMD_INFO_FIELD_STATE */
+#define HELP_LINE88		L"  TPM commands for fields which are not listed are skipped."
+#define HELP_LINE89		L"\n-%ls" /* use with format CMD_QUIET */
+#define HELP_LINE90		L"  Optional parameter for -%ls and -%ls. Suppresses the header, progress and" /* use with format CMD_INFO and CMD_UPDATE */
+#define HELP_LINE91		L"  result text output. Only errors are shown, the result is the exit code."
+#define HELP_LINE92		L"  For the modes 3, 4 and 6 to 9 <path> can be a comma separated list of paths"
+#define HELP_LINE93		L"  or a pattern like /dev/tpm[0-9] to run -%ls or -%ls on each device concurrently." /* use with format CMD_INFO and CMD_UPDATE */
+#define HELP_LINE94		L"\n-%ls <count>" /* use with format CMD_JOBS */
+#define HELP_LINE95		L"  Optional parameter for several -%ls device paths. Sets the number of TPM" /* use with format CMD_ACCESS_MODE */
+#define HELP_LINE96		L"  devices processed at the same time (default: 4)."
+#define HELP_LINE97		L"\n-%ls" /* use with format CMD_PREPARE */
+#define HELP_LINE98		L"  Optional parameter for -%ls. Runs all checks and preparation steps and" /* use with format CMD_UPDATE */
+#define HELP_LINE99		L"  records them in an update plan without updating the TPM firmware."
+#define HELP_LINE100	L"\n-%ls" /* use with format CMD_COMMIT */
+#define HELP_LINE101	L"  Optional parameter for -%ls. Updates the TPM firmware with the update plan of" /* use with format CMD_UPDATE */
+#define HELP_LINE102	L"  -%ls if the TPM and the firmware image did not change since then." /* use with format CMD_PREPARE */
+#define HELP_LINE103	L"\n-%ls <seconds>" /* use with format CMD_DEADLINE */
+#define HELP_LINE104	L"  Optional parameter for -%ls. The update is not started if its estimated" /* use with format CMD_UPDATE */
+#define HELP_LINE105	L"  duration exceeds the time left of <seconds> since the tool was started."
+#define HELP_LINE106	L"\n-%ls <file>" /* use with format CMD_PROGRESS_FILE */
+#define HELP_LINE107	L"  Optional parameter for -%ls. Writes the update phase, transfer progress and" /* use with format CMD_UPDATE */
+#define HELP_LINE108	L"  result to a fixed size binary record in <file> which is updated in place."
+#define HELP_LINE109	L"  0 - Automatic. Measures memory based access, the Linux TPM driver and"
+#define HELP_LINE110	L"      (for -%ls or -%ls) the resource manager at their default paths and" /* Use with format CMD_INFO and CMD_CHECK_IMAGES */
+#define HELP_LINE111	L"      uses the fastest one that works. The selection is logged."
+#define HELP_LINE112	L"  An https:// URL is downloaded while the TPM is probed."
+#define HELP_LINE113	L"\n-%ls" /* use with format CMD_CLEAROWNERSHIP_AFTER */
+#define HELP_LINE114	L"  Optional parameter for -%ls. Clears the TPM1.2 Ownership taken for the" /* use with format CMD_UPDATE */
+#define HELP_LINE115	L"  update in the same run, no separate -%ls run is needed." /* use with format CMD_TPM12_CLEAROWNERSHIP */
+#define HELP_LINE116	L"  8 - TPMRemoteAgent socket. The <path> option can be set to define host and"
+#define HELP_LINE117	L"      port of the agent (default: localhost:2331)"
+#define HELP_LINE118	L"\n-%ls <operator|device>" /* use with format CMD_FACTORY_LOOP */
+#define HELP_LINE119	L"  Optional parameter for -%ls. Updates one unit after another with the images" /* use with format CMD_UPDATE */
+#define HELP_LINE120	L"  checked once. Each unit is started with Enter (operator) or when the TPM"
+#define HELP_LINE121	L"  device path appears (device, access mode 3 only) and reported by a JSON line."
+#define HELP_LINE122	L"  9 - TPM SPI protocol on a spidev device (SPI controller or USB-SPI bridge)."
+#define HELP_LINE123	L"      The <path> option can be set to define a device path (default value:"
+#define HELP_LINE124	L"      /dev/spidev0.0), SPI_SPEED of TPMFactoryUpd.cfg sets the clock in Hz"
+#define HELP_LINE125	L"\n-%ls <file>" /* use with format CMD_TRACE */
+#define HELP_LINE126	L"  Writes the phases, TPM commands, TPM wait loops and log writes as timed spans"
+#define HELP_LINE127	L"  to <file> in the Chrome trace event format (chrome://tracing, Perfetto UI)."
+#define HELP_LINE128	L"\n-%ls <file>" /* use with format CMD_METRICS */
+#define HELP_LINE129	L"  Optional parameter for -%ls and -%ls. Writes the result, the phase" /* use with format CMD_INFO and CMD_UPDATE */
+#define HELP_LINE130	L"  timings and the transfer rate to <file> as Prometheus textfile metrics."
+#define HELP_LINE131	L"\n-%ls <file>" /* use with format CMD_BATCH */
+#define HELP_LINE132	L"  Keeps the TPM connected and processes the info, check, update and"
+#define HELP_LINE133	L"  clearownership operations in <file> (- for stdin), one per line. Stops at"
+#define HELP_LINE134	L"  the first failed operation."
+#define HELP_LINE135	L"\n-%ls" /* use with format CMD_FORK */
+#define HELP_LINE136	L"  Optional parameter for several -%ls device paths. Forks the workers" /* use with format CMD_ACCESS_MODE */
+#define HELP_LINE137	L"  after the settings are parsed and the firmware image is loaded and checked"
+#define HELP_LINE138	L"  once, instead of starting the tool again for each TPM device."
+#define HELP_LINE139	L"\n-%ls <max-data-size>" /* use with format CMD_BUILD_FRAMES */
+#define HELP_LINE140	L"  Writes the TPM commands transferring the firmware image given with -%ls" /* use with format CMD_FIRMWARE */
+#define HELP_LINE141	L"  to the frame file given with -%ls, for a TPM reporting <max-data-size> as" /* use with format CMD_FRAME_FILE */
+#define HELP_LINE142	L"  maximum firmware block size in boot loader mode. Does not access the TPM."
+#define HELP_LINE143	L"\n-%ls <file>" /* use with format CMD_FRAME_FILE */
+#define HELP_LINE144	L"  Optional parameter for -%ls. Sends the firmware from the frame file <file>" /* use with format CMD_UPDATE */
+#define HELP_LINE145	L"  built with -%ls if it matches the firmware image and the TPM." /* use with format CMD_BUILD_FRAMES */
+#define HELP_LINE146	L"\n-%ls" /* use with format CMD_DEVICE_LOG */
+#define HELP_LINE147	L"  Optional parameter for -%ls. Writes the log of each TPM device to a log" /* use with format CMD_ACCESS_MODE */
+#define HELP_LINE148	L"  file of its own, named after the log file and the device path."
+#define HELP_LINE149	L"\n-%ls" /* use with format CMD_BACKGROUND */
+#define HELP_LINE150	L"  Optional parameter for -%ls or -%ls. Runs with idle CPU and I/O" /* use with format CMD_INFO, CMD_CHECK_IMAGES */
+#define HELP_LINE151	L"  priority and polls the TPM less often. Answers -%ls from a cache of %ls" /* use with format CMD_INFO, BACKGROUND_INFO_CACHE_TTL */
+#define HELP_LINE152	L"  seconds unless -%ls or -%ls is given." /* use with format CMD_INFO_CACHE, CMD_ACCESS_MODE */
+#define HELP_LINE153	L"\n-%ls" /* use with format CMD_LEARN_TIMEOUTS */
+#define HELP_LINE154	L"  Optional parameter. Learns how long each TPM command takes on the TPM device"
+#define HELP_LINE155	L"  and firmware version in /var/cache and detects a stuck TPM early."
 
 //{{NO_DEPENDENCIES}}
 // Microsoft Visual C++ generated include file.
@@ -13,6 +13,7 @@
  *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdatomic.h>
 #include "Response.h"
 #include "Utility.h"
 #include "Resource.h"
@@ -21,10 +22,50 @@
 #include "FirmwareImage.h"
 #include "FirmwareUpdate.h"
 #include "ConfigSettings.h"
+#include "FileIO.h"
 
 /// Static flag indicating that header has already been shown once since this application has been started
 BOOL s_fHeaderShown = FALSE;
 
+/// Minimum time in milliseconds between two progress outputs on the console
+#define RESPONSE_PROGRESS_CONSOLE_INTERVAL 500
+/// Minimum time in milliseconds between two progress entries in the log file
+#define RESPONSE_PROGRESS_LOG_INTERVAL 5000
+
+/// Elapsed transfer time of the last progress output on the console
+unsigned long long s_ullLastProgressConsoleTime = 0;
+/// Elapsed transfer time of the last progress entry in the log file
+unsigned long long s_ullLastProgressLogTime = 0;
+
+/// Progress record mapped from the progress file, NULL if no progress file is written
+static volatile IfxProgressRecord* s_psProgressRecord = NULL;
+/// Monotonic time stamp in microseconds when the progress file was opened
+static unsigned long long s_ullProgressStartTime = 0;
+
+/// Progress hook of an application embedding the tool, NULL if not set
+static PFN_RESPONSE_PROGRESSHOOK s_fnProgressHook = NULL;
+/// Context handed over to the progress hook
+static void* s_pvProgressHookContext = NULL;
+/// Completion value last reported to the progress hook
+static unsigned int s_unProgressHookCompletion = 0;
+
+/**
+ *	@brief		Reports the progress to the progress hook
+ *	@details	The hook is only called if the completion value has changed.
+ *
+ *	@param		PunCompletion	Progress completion value between 1 and 100
+ */
+static void
+Response_CallProgressHook(
+	_In_ unsigned int PunCompletion)
+{
+	if (NULL != s_fnProgressHook && PunCompletion != s_unProgressHookCompletion)
+	{
+		s_unProgressHookCompletion = PunCompletion;
+		s_fnProgressHook(s_pvProgressHookContext, PunCompletion);
+	}
+}
+
 /**
  *	@brief		Gets display text for platformAuth
  *	@details
@@ -140,72 +181,930 @@ Response_ShowTpm12Info(
  *
  *	@param		PpHeader			Header to show in response
  *
- *	@retval		RC_SUCCESS			The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpHeader is NULL.
- *	@retval		RC_E_INTERNAL		PpHeader->unType is invalid
- *	@retval		...					Error codes from called functions.
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER	An invalid parameter was passed to the function. PpHeader is NULL.
+ *	@retval		RC_E_INTERNAL		PpHeader->unType is invalid
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_Show(
+	_In_ const IfxToolHeader* PpHeader)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Parameter check
+		if (NULL == PpHeader)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			break;
+		}
+
+		// The info, update and clear ownership results are shown as JSON document by Response_ShowJsonResult or not at all in quiet mode
+		if (Response_IsQuietOutput() && (STRUCT_TYPE_TpmInfo == PpHeader->unType || STRUCT_TYPE_TpmUpdate == PpHeader->unType ||
+				STRUCT_TYPE_Tpm12ClearOwnership == PpHeader->unType))
+		{
+			unReturnValue = RC_SUCCESS;
+			break;
+		}
+
+		// Render the whole response before writing it to the console
+		ConsoleIO_BeginOutput();
+
+		switch (PpHeader->unType)
+		{
+			case STRUCT_TYPE_TpmInfo:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing TpmInfo command output.");
+				// Show the info response
+				unReturnValue = Response_ShowInfo((IfxInfo*)PpHeader);
+				break;
+			}
+			case STRUCT_TYPE_TpmUpdate:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing TpmUpdate command output.");
+				// Show the update response
+				unReturnValue = Response_ShowUpdate((IfxUpdate*)PpHeader);
+				break;
+			}
+			case STRUCT_TYPE_Tpm12ClearOwnership:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing Tpm12ClearOwnership command output.");
+				// Show the clear ownership response
+				unReturnValue = Response_ShowClearOwnership((IfxTpm12ClearOwnership*)PpHeader);
+				break;
+			}
+			case STRUCT_TYPE_Benchmark:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing Benchmark command output.");
+				// Show the benchmark response
+				unReturnValue = Response_ShowBenchmark((IfxBenchmark*)PpHeader);
+				break;
+			}
+			case STRUCT_TYPE_CheckImages:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing CheckImages command output.");
+				// Show the check images response
+				unReturnValue = Response_ShowCheckImages((IfxCheckImages*)PpHeader);
+				break;
+			}
+			case STRUCT_TYPE_DecodeCapture:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing DecodeCapture command output.");
+				// Show the decode capture response
+				unReturnValue = Response_ShowDecodeCapture((IfxDecodeCapture*)PpHeader);
+				break;
+			}
+			case STRUCT_TYPE_BuildFrames:
+			{
+				LOGGING_WRITE_LEVEL4(L"Showing BuildFrames command output.");
+				// Show the build frames response
+				unReturnValue = Response_ShowBuildFrames((IfxBuildFrames*)PpHeader);
+				break;
+			}
+			default:
+			{
+				LOGGING_WRITE_LEVEL1(L"Skipped display of an unrecognized command.");
+				unReturnValue = Response_ShowUnknownAction();
+				if (RC_SUCCESS != unReturnValue)
+					break;
+
+				// Set return value to RC_E_INTERNAL
+				unReturnValue = RC_E_INTERNAL;
+				break;
+			}
+		}
+
+		// Write the rendered response, also the part rendered before an error occurred
+		unReturnValueWrite = ConsoleIO_FlushOutput();
+		if (RC_SUCCESS != unReturnValueWrite && RC_SUCCESS == unReturnValue)
+		{
+			unReturnValue = unReturnValueWrite;
+			ERROR_STORE(unReturnValue, L"ConsoleIO_FlushOutput returned an error");
+		}
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Returns whether the result is shown as JSON document
+ *	@details	The JSON output is selected with the -json command line option (PROPERTY_JSON_OUTPUT).
+ *
+ *	@retval		TRUE		The result is shown as JSON document by Response_ShowJsonResult.
+ *	@retval		FALSE		The result is shown as text.
+ */
+_Check_return_
+BOOL
+Response_IsJsonOutput()
+{
+	BOOL fJsonOutput = FALSE;
+
+	if (FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_JSON_OUTPUT, &fJsonOutput))
+		fJsonOutput = FALSE;
+
+	return fJsonOutput;
+}
+
+/**
+ *	@brief		Returns whether the text output of the result is suppressed
+ *	@details	The text output is suppressed with the -quiet command line option (PROPERTY_QUIET_OUTPUT) and in JSON mode.
+ *				Only the exit code, error messages and the JSON document are written then.
+ *
+ *	@retval		TRUE		The header, progress and result text are not rendered.
+ *	@retval		FALSE		The result is shown as text.
+ */
+_Check_return_
+BOOL
+Response_IsQuietOutput()
+{
+	BOOL fQuietOutput = FALSE;
+
+	if (FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_QUIET_OUTPUT, &fQuietOutput))
+		fQuietOutput = FALSE;
+
+	return fQuietOutput || Response_IsJsonOutput();
+}
+
+/**
+ *	@brief		Appends formatted text to the JSON result document
+ *	@details
+ *
+ *	@param		PpsDocument			JSON result document
+ *	@param		PwszFormat			Format string
+ *	@param		...					Parameters needed to format the text
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from Platform_StringBuilderAppendFormatV
+ */
+static unsigned int
+Response_JsonAppend(
+	_Inout_		IfxStringBuilder*	PpsDocument,
+	_In_z_		const wchar_t*		PwszFormat,
+	...)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	va_list argptr;
+
+	va_start(argptr, PwszFormat);
+	unReturnValue = Platform_StringBuilderAppendFormatV(PpsDocument, PwszFormat, argptr);
+	va_end(argptr);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Appends a string member to the JSON result document
+ *	@details	The value is escaped. A NULL value is written as null.
+ *
+ *	@param		PpsDocument			JSON result document
+ *	@param		PwszName			Name of the member
+ *	@param		PwszValue			Value of the member (can be NULL)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from called functions
+ */
+static unsigned int
+Response_JsonAppendString(
+	_Inout_		IfxStringBuilder*	PpsDocument,
+	_In_z_		const wchar_t*		PwszName,
+	_In_opt_	const wchar_t*		PwszValue)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		wchar_t wszValue[MAX_MESSAGE_SIZE] = {0};
+		unsigned int unValueSize = RG_LEN(wszValue);
+
+		if (NULL == PwszValue)
+		{
+			unReturnValue = Response_JsonAppend(PpsDocument, L",\"%ls\":null", PwszName);
+			break;
+		}
+
+		unReturnValue = Utility_StringEscapeJson(PwszValue, RG_LEN(wszValue), wszValue, &unValueSize);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = Response_JsonAppend(PpsDocument, L",\"%ls\":\"%ls\"", PwszName, wszValue);
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Appends a phase timings member to the JSON result document
+ *	@details	The phases of the firmware update are only added for an -update command. The startup time sums up the phases
+ *				up to the established TPM connection.
+ *
+ *	@param		PpsDocument			JSON result document
+ *	@param		PwszName			Name of the member
+ *	@param		PpTimings			Phase timings
+ *	@param		PfUpdate			TRUE to add the phases of the firmware update
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from called functions
+ */
+static unsigned int
+Response_JsonAppendTimings(
+	_Inout_		IfxStringBuilder*		PpsDocument,
+	_In_z_		const wchar_t*			PwszName,
+	_In_		const IfxPhaseTimings*	PpTimings,
+	_In_		BOOL					PfUpdate)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	do
+	{
+		unReturnValue = Response_JsonAppend(
+							PpsDocument,
+							L",\"%ls\":{\"commandLineUs\":%llu,\"configUs\":%llu,\"connectUs\":%llu,\"startupUs\":%llu,\"stateUs\":%llu",
+							PwszName, PpTimings->ullCommandLineTime, PpTimings->ullConfigTime, PpTimings->ullConnectTime,
+							PpTimings->ullCommandLineTime + PpTimings->ullConfigTime + PpTimings->ullConnectTime, PpTimings->ullStateTime);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (PfUpdate)
+		{
+			unReturnValue = Response_JsonAppend(
+								PpsDocument,
+								L",\"imageUs\":%llu,\"prepareUs\":%llu,\"startUs\":%llu,\"transferUs\":%llu,\"completeUs\":%llu",
+								PpTimings->ullImageTime, PpTimings->ullPrepareTime, PpTimings->ullStartTime, PpTimings->ullTransferTime,
+								PpTimings->ullCompleteTime);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+		unReturnValue = Response_JsonAppend(PpsDocument, L"}");
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Appends the TPM state object to the JSON result document
+ *	@details	Contains the same information as the text output of Response_ShowInfo. Fields which have not been queried
+ *				are omitted.
+ *
+ *	@param		PpsDocument			JSON result document
+ *	@param		PpTpmInfo			TPM information (the beginning of IfxUpdate has the same layout)
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from called functions
+ */
+static unsigned int
+Response_JsonAppendTpmState(
+	_Inout_		IfxStringBuilder*	PpsDocument,
+	_In_		const IfxInfo*		PpTpmInfo)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	BITFIELD_TPM_ATTRIBUTES sAttributes = PpTpmInfo->sTpmState.attribs;
+
+	do
+	{
+		BOOL fValid = sAttributes.bootLoader ? FALSE : TRUE;
+		const wchar_t* pwszFamily = NULL;
+
+		if (fValid && sAttributes.tpm20)
+			pwszFamily = RES_TPM_INFO_2_0;
+		else if (fValid && sAttributes.tpm12)
+			pwszFamily = RES_TPM_INFO_1_2;
+
+		unReturnValue = Response_JsonAppend(PpsDocument, L",\"tpm\":{\"firmwareValid\":%ls", fValid ? L"true" : L"false");
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Response_JsonAppendString(PpsDocument, L"family", pwszFamily);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (PpTpmInfo->unFields & TPM_INFO_FIELD_VERSION)
+		{
+			unReturnValue = Response_JsonAppendString(PpsDocument, L"version", fValid ? PpTpmInfo->wszVersionName : NULL);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		if (fValid && sAttributes.tpm20 && (PpTpmInfo->unFields & TPM_INFO_FIELD_STATE))
+		{
+			unReturnValue = Response_JsonAppendString(PpsDocument, L"platformAuth", Response_GetPlatformAuthText(sAttributes));
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		if (fValid && sAttributes.tpm12 && !sAttributes.tpm12FailedSelfTest && (PpTpmInfo->unFields & TPM_INFO_FIELD_STATE))
+		{
+			unReturnValue = Response_JsonAppend(
+								PpsDocument, L",\"enabled\":%ls,\"activated\":%ls,\"owned\":%ls,\"deferredPhysicalPresence\":%ls",
+								sAttributes.tpm12enabled ? L"true" : L"false", sAttributes.tpm12activated ? L"true" : L"false",
+								sAttributes.tpm12owner ? L"true" : L"false", sAttributes.tpm12DeferredPhysicalPresence ? L"true" : L"false");
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		if (PpTpmInfo->unFields & TPM_INFO_FIELD_COUNTER)
+		{
+			if (REMAINING_UPDATES_UNAVAILABLE != PpTpmInfo->unRemainingUpdates)
+				unReturnValue = Response_JsonAppend(PpsDocument, L",\"remainingUpdates\":%u", PpTpmInfo->unRemainingUpdates);
+			else
+				unReturnValue = Response_JsonAppend(PpsDocument, L",\"remainingUpdates\":null");
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unReturnValue = Response_JsonAppend(
+							PpsDocument, L",\"restartRequired\":%ls,\"failureMode\":%ls,\"selfTestFailed\":%ls",
+							sAttributes.tpm20restartRequired ? L"true" : L"false", sAttributes.tpm20InFailureMode ? L"true" : L"false",
+							sAttributes.tpm12FailedSelfTest ? L"true" : L"false");
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Add the test result in failure mode or in self-test failed mode
+		if ((sAttributes.tpm20InFailureMode || sAttributes.tpm12FailedSelfTest) && PpTpmInfo->sTpmState.unTestResultLen > 0)
+		{
+			wchar_t wszTestResult[256] = {0};
+			unsigned int unTestResultLen = RG_LEN(wszTestResult);
+
+			unReturnValue = Utility_StringScanByteToHex(PpTpmInfo->sTpmState.testResult, PpTpmInfo->sTpmState.unTestResultLen, wszTestResult, &unTestResultLen);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppendString(PpsDocument, L"testResult", wszTestResult);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unReturnValue = Response_JsonAppend(PpsDocument, L"}");
+	}
+	WHILE_FALSE_END;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Builds the JSON result document
+ *	@details	The document contains the tool version, the command, the final return code and error message and for -info
+ *				and -update the TPM state and the update result.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@param		PunReturnCode			Final return code of the command
+ *	@param		PwszDocument			Receives the JSON result document
+ *	@param		PpunLength				Receives the length of the document without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_GetJsonResult(
+	_In_opt_									const IfxToolHeader*	PpResponseData,
+	_In_										unsigned int			PunReturnCode,
+	_Out_z_cap_(RESPONSE_JSON_DOCUMENT_SIZE)	wchar_t*				PwszDocument,
+	_Out_										unsigned int*			PpunLength)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxStringBuilder sDocument;
+
+	Platform_StringBuilderInitialize(&sDocument, PwszDocument, RESPONSE_JSON_DOCUMENT_SIZE);
+
+	do
+	{
+		const wchar_t* pwszCommand = NULL;
+
+		if (NULL != PpResponseData && STRUCT_TYPE_TpmInfo == PpResponseData->unType)
+			pwszCommand = CMD_INFO;
+		else if (NULL != PpResponseData && STRUCT_TYPE_TpmUpdate == PpResponseData->unType)
+			pwszCommand = CMD_UPDATE;
+		else if (NULL != PpResponseData && STRUCT_TYPE_Tpm12ClearOwnership == PpResponseData->unType)
+			pwszCommand = CMD_TPM12_CLEAROWNERSHIP;
+
+		unReturnValue = Response_JsonAppend(&sDocument, L"{\"tool\":\"%ls\",\"version\":\"%ls\"", TOOL_NAME, APP_VERSION);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Response_JsonAppendString(&sDocument, L"command", pwszCommand);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Response_JsonAppend(&sDocument, L",\"rc\":\"0x%.8X\"", PunReturnCode);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Add the final error message
+		if (NULL != Error_GetStack())
+		{
+			wchar_t wszMessage[MAX_MESSAGE_SIZE] = {0};
+			unsigned int unMessageSize = RG_LEN(wszMessage);
+
+			unReturnValue = Error_GetFinalMessage(wszMessage, &unMessageSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppendString(&sDocument, L"error", wszMessage);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		// Add the TPM state, it is only valid if the command has read it from the TPM
+		if (NULL != pwszCommand)
+		{
+			const IfxInfo* pTpmInfo = (const IfxInfo*)PpResponseData;
+			BITFIELD_TPM_ATTRIBUTES sAttributes = pTpmInfo->sTpmState.attribs;
+			if (sAttributes.bootLoader || sAttributes.tpm12 || sAttributes.tpm20)
+			{
+				unReturnValue = Response_JsonAppendTpmState(&sDocument, pTpmInfo);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+		}
+
+		// Add the phase timings and their split into host CPU and TPM wait time (the beginning of IfxUpdate has the same
+		// layout as IfxInfo)
+		if (NULL != pwszCommand)
+		{
+			const IfxInfo* pTpmInfo = (const IfxInfo*)PpResponseData;
+			BOOL fUpdate = STRUCT_TYPE_TpmUpdate == PpResponseData->unType;
+			IfxMemoryStatistics sMemoryStatistics;
+			unReturnValue = Response_JsonAppendTimings(&sDocument, L"timings", &pTpmInfo->sTimings, fUpdate);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppendTimings(&sDocument, L"cpuTimings", &pTpmInfo->sCpuTimings, fUpdate);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppendTimings(&sDocument, L"waitTimings", &pTpmInfo->sWaitTimings, fUpdate);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			// Add the peak heap memory, e.g. for comparing runs against a memory budget
+			Platform_MemoryGetStatistics(&sMemoryStatistics);
+			unReturnValue = Response_JsonAppend(
+								&sDocument, L",\"memory\":{\"peakHeapBytes\":%llu,\"allocations\":%llu}",
+								sMemoryStatistics.ullPeakBytes, sMemoryStatistics.ullAllocations);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		// Add the update result
+		if (NULL != pwszCommand && STRUCT_TYPE_TpmUpdate == PpResponseData->unType)
+		{
+			const IfxUpdate* pTpmUpdate = (const IfxUpdate*)PpResponseData;
+			const wchar_t* pwszStage = NULL;
+			const wchar_t* pwszUpdatable = L"null";
+
+			if (STRUCT_SUBTYPE_IS_UPDATABLE == pTpmUpdate->unSubType)
+				pwszStage = L"isUpdatable";
+			else if (STRUCT_SUBTYPE_PREPARE == pTpmUpdate->unSubType)
+				pwszStage = L"prepare";
+			else if (STRUCT_SUBTYPE_UPDATE == pTpmUpdate->unSubType)
+				pwszStage = L"update";
+
+			if (GENERIC_TRISTATE_STATE_YES == pTpmUpdate->unNewFirmwareValid)
+				pwszUpdatable = L"true";
+			else if (GENERIC_TRISTATE_STATE_NO == pTpmUpdate->unNewFirmwareValid)
+				pwszUpdatable = L"false";
+
+			unReturnValue = Response_JsonAppend(&sDocument, L",\"update\":{\"stage\":");
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppend(&sDocument, NULL == pwszStage ? L"null" : L"\"%ls\"", pwszStage);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppend(&sDocument, L",\"updatable\":%ls", pwszUpdatable);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+
+			if (GENERIC_TRISTATE_STATE_YES == pTpmUpdate->unNewFirmwareValid)
+			{
+				unReturnValue = Response_JsonAppendString(
+									&sDocument, L"newFamily",
+									pTpmUpdate->bTargetFamily == DEVICE_TYPE_TPM_12 ? RES_TPM_INFO_1_2 : RES_TPM_INFO_2_0);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+				unReturnValue = Response_JsonAppendString(&sDocument, L"newVersion", pTpmUpdate->wszNewFirmwareVersion);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+				unReturnValue = Response_JsonAppend(
+									&sDocument, L",\"factoryDefaults\":%ls",
+									pTpmUpdate->bfNewTpmFirmwareInfo.factoryDefaults ? L"true" : L"false");
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+
+			unReturnValue = Response_JsonAppendString(
+								&sDocument, L"firmwareFile",
+								PLATFORM_STRING_IS_NULL_OR_EMPTY(pTpmUpdate->wszUsedFirmwareImage) ? NULL : pTpmUpdate->wszUsedFirmwareImage);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			if (0 != pTpmUpdate->ullPredictedDuration)
+			{
+				unReturnValue = Response_JsonAppend(&sDocument, L",\"predictedDurationUs\":%llu", pTpmUpdate->ullPredictedDuration);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+			// Add the transfer rate of the firmware blocks if a transfer was started
+			if (0 != pTpmUpdate->unBlockCount && 0 != pTpmUpdate->sTimings.ullTransferTime)
+			{
+				unReturnValue = Response_JsonAppend(
+									&sDocument, L",\"blockCount\":%u,\"blocksPerSecond\":%llu",
+									pTpmUpdate->unBlockCount, pTpmUpdate->unBlockCount * 1000000ULL / pTpmUpdate->sTimings.ullTransferTime);
+				if (RC_SUCCESS != unReturnValue)
+					break;
+			}
+			unReturnValue = Response_JsonAppend(
+								&sDocument, L",\"alreadyUpToDate\":%ls,\"updated\":%ls}",
+								RC_E_ALREADY_UP_TO_DATE == pTpmUpdate->unReturnCode ? L"true" : L"false",
+								(STRUCT_SUBTYPE_UPDATE == pTpmUpdate->unSubType && RC_SUCCESS == PunReturnCode) ? L"true" : L"false");
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unReturnValue = Response_JsonAppend(&sDocument, L"}");
+	}
+	WHILE_FALSE_END;
+
+	*PpunLength = sDocument.unLength;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Builds the JSON result document of a request answered during a firmware update
+ *	@details	Contains the tool version, the command, the return code and its message, the TPM state taken before the
+ *				update started and the progress of the update. The error stack is not used, so the error stack of the
+ *				update is not disturbed.
+ *
+ *	@param		PpTpmInfo				TPM state taken before the update started (can be NULL)
+ *	@param		PwszCommand				Command of the request
+ *	@param		PunReturnCode			Return code of the request
+ *	@param		PunProgress				Progress completion value of the update between 0 and 100
+ *	@param		PwszDocument			Receives the JSON result document
+ *	@param		PpunLength				Receives the length of the document without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_GetJsonBusyResult(
+	_In_opt_									const IfxInfo*	PpTpmInfo,
+	_In_z_										const wchar_t*	PwszCommand,
+	_In_										unsigned int	PunReturnCode,
+	_In_										unsigned int	PunProgress,
+	_Out_z_cap_(RESPONSE_JSON_DOCUMENT_SIZE)	wchar_t*		PwszDocument,
+	_Out_										unsigned int*	PpunLength)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxStringBuilder sDocument;
+
+	Platform_StringBuilderInitialize(&sDocument, PwszDocument, RESPONSE_JSON_DOCUMENT_SIZE);
+
+	do
+	{
+		unReturnValue = Response_JsonAppend(&sDocument, L"{\"tool\":\"%ls\",\"version\":\"%ls\"", TOOL_NAME, APP_VERSION);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Response_JsonAppendString(&sDocument, L"command", PwszCommand);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		unReturnValue = Response_JsonAppend(&sDocument, L",\"rc\":\"0x%.8X\"", PunReturnCode);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Add the message of the return code
+		if (RC_SUCCESS != PunReturnCode)
+		{
+			wchar_t wszMessage[MAX_MESSAGE_SIZE] = {0};
+			unsigned int unMessageSize = RG_LEN(wszMessage);
+
+			unReturnValue = Error_GetFinalMessageFromErrorCode(PunReturnCode, wszMessage, &unMessageSize);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			unReturnValue = Response_JsonAppendString(&sDocument, L"error", wszMessage);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		// Add the TPM state taken before the update started
+		if (NULL != PpTpmInfo)
+		{
+			unReturnValue = Response_JsonAppendTpmState(&sDocument, PpTpmInfo);
+			if (RC_SUCCESS != unReturnValue)
+				break;
+		}
+
+		unReturnValue = Response_JsonAppend(&sDocument, L",\"busy\":{\"progress\":%u}}", PunProgress);
+	}
+	WHILE_FALSE_END;
+
+	*PpunLength = sDocument.unLength;
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Show the result as JSON document
+ *	@details	Writes the JSON result document built by Response_GetJsonResult to the console. Nothing is done if the -json
+ *				command line option is not set. Response_Show, Response_ShowHeader and Response_ShowError do not write any
+ *				text in that case.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@param		PunReturnCode			Final return code of the command
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowJsonResult(
+	_In_opt_	const IfxToolHeader*	PpResponseData,
+	_In_		unsigned int			PunReturnCode)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+	wchar_t* wszDocument = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		unsigned int unLength = 0;
+
+		if (FALSE == Response_IsJsonOutput())
+			break;
+
+		wszDocument = (wchar_t*)Platform_MemoryAllocateZero(RESPONSE_JSON_DOCUMENT_SIZE * sizeof(wchar_t));
+		if (NULL == wszDocument)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Memory allocation failed.");
+			break;
+		}
+
+		unReturnValue = Response_GetJsonResult(PpResponseData, PunReturnCode, wszDocument, &unLength);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, L"%ls", wszDocument);
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&wszDocument);
+
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/// Writes the duration, the host CPU time and the TPM wait time of a phase in milliseconds (used by Response_ShowTimings)
+#define RESPONSE_SHOW_TIMING_PHASE(PHASE, MEMBER) \
+	CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TIMING_PHASE, PHASE, \
+		pTimings->MEMBER / 1000, pTimings->MEMBER % 1000, \
+		pCpuTimings->MEMBER / 1000, pCpuTimings->MEMBER % 1000, \
+		pWaitTimings->MEMBER / 1000, pWaitTimings->MEMBER % 1000)
+
+/**
+ *	@brief		Show the duration of the command phases
+ *	@details	Writes the phase timings and the peak heap memory of an -info or -update command to the console if the -timing
+ *				command line option is set. Each phase is split into host CPU time and time spent sleeping or blocked while
+ *				waiting for the TPM, the rest of the duration is spent in other processes or in transports without wait
+ *				statistics. Nothing is done for other commands or in JSON mode, the JSON document always contains the timings.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowTimings(
+	_In_opt_	const IfxToolHeader*	PpResponseData)
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+	BOOL fTiming = FALSE;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		const IfxPhaseTimings* pTimings = NULL;
+		const IfxPhaseTimings* pCpuTimings = NULL;
+		const IfxPhaseTimings* pWaitTimings = NULL;
+		IfxMemoryStatistics sMemoryStatistics;
+
+		if (NULL == PpResponseData ||
+				(STRUCT_TYPE_TpmInfo != PpResponseData->unType && STRUCT_TYPE_TpmUpdate != PpResponseData->unType) ||
+				FALSE == PropertyStorage_GetBooleanValueByKey(PROPERTY_TIMING, &fTiming) || FALSE == fTiming ||
+				Response_IsJsonOutput())
+			break;
+
+		// The beginning of IfxUpdate has the same layout as IfxInfo
+		pTimings = &((const IfxInfo*)PpResponseData)->sTimings;
+		pCpuTimings = &((const IfxInfo*)PpResponseData)->sCpuTimings;
+		pWaitTimings = &((const IfxInfo*)PpResponseData)->sWaitTimings;
+
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_TIMING_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_TIMING_DASHED_LINE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TIMING_COLUMNS, L"", RES_TIMING_COLUMN_TOTAL, RES_TIMING_COLUMN_CPU, RES_TIMING_COLUMN_WAIT);
+		RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_COMMAND_LINE, ullCommandLineTime);
+		RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_CONFIG, ullConfigTime);
+		RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_CONNECT, ullConnectTime);
+		RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_STATE, ullStateTime);
+		if (STRUCT_TYPE_TpmUpdate == PpResponseData->unType)
+		{
+			RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_IMAGE, ullImageTime);
+			RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_PREPARE, ullPrepareTime);
+			RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_START, ullStartTime);
+			RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_TRANSFER, ullTransferTime);
+			RESPONSE_SHOW_TIMING_PHASE(RES_TIMING_PHASE_COMPLETE, ullCompleteTime);
+		}
+
+		// The peak shows whether the tool fits the memory budget of the target environment
+		Platform_MemoryGetStatistics(&sMemoryStatistics);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TIMING_MEMORY_PEAK, RES_TIMING_MEMORY_PEAK_HEAP, sMemoryStatistics.ullPeakBytes, sMemoryStatistics.ullAllocations);
+	}
+	WHILE_FALSE_END;
+
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Show the result of one of several TPM devices
+ *	@details	Writes the output of the worker process which processed the device. In JSON mode the JSON result documents of
+ *				the devices are combined to one document {"devices":[{"exitCode":...,"path":...,"result":...},...]} which is
+ *				completed by Response_ShowDevicesSummary. In quiet mode only the output of failed devices is shown.
+ *
+ *	@param		PwszDevicePath			Path of the TPM device
+ *	@param		PunIndex				Number of device results shown before
+ *	@param		PunExitCode				Exit code of the worker process
+ *	@param		PwszOutput				Output of the worker process, the lines are separated by line breaks
+ *	@param		PunOutputLength			Length of the output without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		...						Error codes from called functions.
  */
 _Check_return_
 unsigned int
-Response_Show(
-	_In_ const IfxToolHeader* PpHeader)
+Response_ShowDeviceResult(
+	_In_z_							const wchar_t*	PwszDevicePath,
+	_In_							unsigned int	PunIndex,
+	_In_							unsigned int	PunExitCode,
+	_In_z_count_(PunOutputLength)	const wchar_t*	PwszOutput,
+	_In_							unsigned int	PunOutputLength)
 {
-	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValue = RC_SUCCESS;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+	wchar_t* wszDocument = NULL;
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
+	// Render the whole device result before writing it to the console
+	ConsoleIO_BeginOutput();
+
 	do
 	{
-		// Parameter check
-		if (NULL == PpHeader)
+		unsigned int unIndex = 0;
+
+		// Check parameters
+		if (NULL == PwszDevicePath || NULL == PwszOutput)
 		{
 			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized (PwszDevicePath or PwszOutput)");
 			break;
 		}
 
-		switch (PpHeader->unType)
+		if (Response_IsJsonOutput())
 		{
-			case STRUCT_TYPE_TpmInfo:
+			IfxStringBuilder sDocument;
+
+			wszDocument = (wchar_t*)Platform_MemoryAllocateZero(RESPONSE_JSON_DOCUMENT_SIZE * sizeof(wchar_t));
+			if (NULL == wszDocument)
 			{
-				LOGGING_WRITE_LEVEL4(L"Showing TpmInfo command output.");
-				// Show the info response
-				unReturnValue = Response_ShowInfo((IfxInfo*)PpHeader);
+				unReturnValue = RC_E_FAIL;
+				ERROR_STORE(unReturnValue, L"Memory allocation failed.");
 				break;
 			}
-			case STRUCT_TYPE_TpmUpdate:
-			{
-				LOGGING_WRITE_LEVEL4(L"Showing TpmUpdate command output.");
-				// Show the update response
-				unReturnValue = Response_ShowUpdate((IfxUpdate*)PpHeader);
+			Platform_StringBuilderInitialize(&sDocument, wszDocument, RESPONSE_JSON_DOCUMENT_SIZE);
+
+			unReturnValue = Response_JsonAppend(&sDocument, L"%ls{\"exitCode\":%u", 0 == PunIndex ? L"{\"devices\":[" : L",", PunExitCode);
+			if (RC_SUCCESS != unReturnValue)
 				break;
-			}
-			case STRUCT_TYPE_Tpm12ClearOwnership:
-			{
-				LOGGING_WRITE_LEVEL4(L"Showing Tpm12ClearOwnership command output.");
-				// Show the clear ownership response
-				unReturnValue = Response_ShowClearOwnership((IfxTpm12ClearOwnership*)PpHeader);
+			unReturnValue = Response_JsonAppendString(&sDocument, L"path", PwszDevicePath);
+			if (RC_SUCCESS != unReturnValue)
 				break;
-			}
-			default:
-			{
-				LOGGING_WRITE_LEVEL1(L"Skipped display of an unrecognized command.");
-				unReturnValue = Response_ShowUnknownAction();
-				if (RC_SUCCESS != unReturnValue)
-					break;
+			unReturnValue = Response_JsonAppend(&sDocument, L",\"result\":%ls", 0 == PunOutputLength ? L"null" : L"");
+			if (RC_SUCCESS != unReturnValue)
+				break;
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, L"%ls", wszDocument);
+		}
+		else
+		{
+			if (Response_IsQuietOutput() && 0 == PunExitCode)
+				break;
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DEVICE_OUTPUT, PwszDevicePath, PunExitCode);
+		}
 
-				// Set return value to RC_E_INTERNAL
-				unReturnValue = RC_E_INTERNAL;
+		// Write the output line by line
+		while (0 != PunOutputLength)
+		{
+			const wchar_t* pwszLine = NULL;
+			unsigned int unLineLength = 0;
+
+			unReturnValue = Utility_StringGetLineView(PwszOutput, PunOutputLength + 1, &unIndex, &pwszLine, &unLineLength);
+			if (RC_SUCCESS != unReturnValue)
+			{
+				if (RC_E_END_OF_STRING == unReturnValue)
+					unReturnValue = RC_SUCCESS;
 				break;
 			}
+			unReturnValueWrite = ConsoleIO_Write(FALSE, TRUE, L"%.*ls", (int)unLineLength, pwszLine);
+			if (RC_SUCCESS != unReturnValueWrite)
+				break;
+		}
+		if (RC_SUCCESS != unReturnValue || RC_SUCCESS != unReturnValueWrite)
+			break;
+
+		if (Response_IsJsonOutput())
+		{
+			CONSOLEIO_WRITE_BREAK(FALSE, L"}");
 		}
 	}
 	WHILE_FALSE_END;
 
+	// Write the rendered result, also the part rendered before an error occurred
+	if (RC_SUCCESS == unReturnValueWrite)
+		unReturnValueWrite = ConsoleIO_FlushOutput();
+	else
+		IGNORE_RETURN_VALUE(ConsoleIO_FlushOutput());
+
+	Platform_MemoryFree((void**)&wszDocument);
+
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
 	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
 }
 
+/**
+ *	@brief		Show the summary of several TPM devices
+ *	@details	Completes the combined JSON result document in JSON mode. Nothing is shown in quiet mode.
+ *
+ *	@param		PunSucceeded			Number of devices processed successfully
+ *	@param		PunTotal				Number of devices
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowDevicesSummary(
+	_In_	unsigned int	PunSucceeded,
+	_In_	unsigned int	PunTotal)
+{
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		if (Response_IsJsonOutput())
+		{
+			CONSOLEIO_WRITE_BREAK(FALSE, L"]}");
+			break;
+		}
+		if (Response_IsQuietOutput())
+			break;
+
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DEVICE_SUMMARY, PunSucceeded, PunTotal);
+	}
+	WHILE_FALSE_END;
+
+	// Check if a ConsoleIO_Write error occurred and store it
+	if (RC_SUCCESS != unReturnValueWrite)
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValueWrite);
+
+	return unReturnValueWrite;
+}
+
 /**
  *	@brief		Show TPM Info output
  *	@details	Format TPM Info output and display
@@ -247,7 +1146,10 @@ Response_ShowInfo(
 			// Display information for invalid firmware mode
 			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_FIRMWARE_VALID, RES_TPM_INFO_NO);
 			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_FAMILY, RES_TPM_INFO_N_A);
-			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_VERSION, RES_TPM_INFO_N_A);
+			if (PpTpmInfo->unFields & TPM_INFO_FIELD_VERSION)
+			{
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_VERSION, RES_TPM_INFO_N_A);
+			}
 		}
 		else
 		{
@@ -261,8 +1163,11 @@ Response_ShowInfo(
 			{
 				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_FAMILY, RES_TPM_INFO_1_2);
 			}
-			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_VERSION, PpTpmInfo->wszVersionName);
-			if (PpTpmInfo->sTpmState.attribs.tpm12)
+			if (PpTpmInfo->unFields & TPM_INFO_FIELD_VERSION)
+			{
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_VERSION, PpTpmInfo->wszVersionName);
+			}
+			if (PpTpmInfo->sTpmState.attribs.tpm12 && (PpTpmInfo->unFields & TPM_INFO_FIELD_STATE))
 			{
 				if (!PpTpmInfo->sTpmState.attribs.tpm12FailedSelfTest)
 				{
@@ -272,24 +1177,27 @@ Response_ShowInfo(
 						break;
 				}
 			}
-			if (PpTpmInfo->sTpmState.attribs.tpm20)
+			if (PpTpmInfo->sTpmState.attribs.tpm20 && (PpTpmInfo->unFields & TPM_INFO_FIELD_STATE))
 			{
 				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_PLATFORM_AUTH, Response_GetPlatformAuthText(PpTpmInfo->sTpmState.attribs));
 			}
 		}
 
 		// Display number of remaining updates
-		if (PpTpmInfo->unRemainingUpdates != REMAINING_UPDATES_UNAVAILABLE) // -1
-		{
-			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_NUMBER, PpTpmInfo->unRemainingUpdates);
-		}
-		else if (PpTpmInfo->sTpmState.attribs.tpm20restartRequired)
+		if (PpTpmInfo->unFields & TPM_INFO_FIELD_COUNTER)
 		{
-			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_STRING, RES_TPM_INFO_N_A_RESTART);
-		}
-		else
-		{
-			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_STRING, RES_TPM_INFO_N_A);
+			if (PpTpmInfo->unRemainingUpdates != REMAINING_UPDATES_UNAVAILABLE) // -1
+			{
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_NUMBER, PpTpmInfo->unRemainingUpdates);
+			}
+			else if (PpTpmInfo->sTpmState.attribs.tpm20restartRequired)
+			{
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_STRING, RES_TPM_INFO_N_A_RESTART);
+			}
+			else
+			{
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_STRING, RES_TPM_INFO_N_A);
+			}
 		}
 
 		// Display information if TPM2.0 is in failure mode
@@ -434,6 +1342,10 @@ Response_ShowUpdate(
 				{
 					CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_UPDATE_UPDATABLE, RES_TPM_INFO_N_A);
 				}
+				if (0 != PpTpmUpdate->ullPredictedDuration)
+				{
+					CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_UPDATE_DURATION, (PpTpmUpdate->ullPredictedDuration + 999999) / 1000000);
+				}
 
 				if (RC_E_TPM20_FAILURE_MODE == PpTpmUpdate->unReturnCode)
 					break;
@@ -461,6 +1373,8 @@ Response_ShowUpdate(
 			}
 			case STRUCT_SUBTYPE_PREPARE:
 			{
+				BOOL fPrepared = FALSE;
+
 				CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
 				CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_PREPARE);
 
@@ -470,10 +1384,7 @@ Response_ShowUpdate(
 					if (RC_SUCCESS == PpTpmUpdate->unReturnCode)
 					{
 						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_PREPARE_SKIP);
-						CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_DO_NOT_TURN_OFF);
-						CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_UPDATE);
+						fPrepared = TRUE;
 					}
 					else
 					{
@@ -486,10 +1397,7 @@ Response_ShowUpdate(
 					if (RC_SUCCESS == PpTpmUpdate->unReturnCode)
 					{
 						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_PREPARE_POLICY);
-						CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_DO_NOT_TURN_OFF);
-						CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_UPDATE);
+						fPrepared = TRUE;
 					}
 					else
 					{
@@ -525,10 +1433,7 @@ Response_ShowUpdate(
 							CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_PREPARE_TAKEOWNERSHIP);
 						}
 
-						CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_DO_NOT_TURN_OFF);
-						CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-						CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_UPDATE);
+						fPrepared = TRUE;
 					}
 					else
 					{
@@ -543,24 +1448,193 @@ Response_ShowUpdate(
 					}
 				}
 
+				// The -prepare run stops here, otherwise the update follows
+				if (fPrepared && TRUE == PropertyStorage_ExistsElement(PROPERTY_PREPARE))
+				{
+					CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+					CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_UPDATE_PLAN_RECORDED, CMD_COMMIT);
+				}
+				else if (fPrepared)
+				{
+					CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+					CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_DO_NOT_TURN_OFF);
+					CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+					CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_UPDATE);
+				}
+
 				break;
 			}
 			case STRUCT_SUBTYPE_UPDATE:
 			{
-				CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
-				if (RC_SUCCESS == PpTpmUpdate->unReturnCode)
+				CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+				if (RC_SUCCESS == PpTpmUpdate->unReturnCode)
+				{
+					CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_SUCCESS);
+				}
+				else
+				{
+					CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_FAIL);
+				}
+				break;
+			}
+			default:
+				break;
+		}
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, RC_SUCCESS);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Show TPM1.2 ClearOwnership output
+ *	@details	Format TPM1.2 ClearOwnership output and display
+ *
+ *	@param		PpTpm12ClearOwnership	Pointer to a IfxTpm12ClearOwnership response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpTpm12ClearOwnership was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowClearOwnership(
+	_In_	const IfxTpm12ClearOwnership* PpTpm12ClearOwnership)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpTpm12ClearOwnership || PpTpm12ClearOwnership->unType != STRUCT_TYPE_Tpm12ClearOwnership)
+		{
+			LOGGING_WRITE_LEVEL1(L"Error while checking object PpTpmInfo: was invalid or NULL.");
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized (PpTpm12ClearOwnership)");
+			break;
+		}
+
+		if (RC_SUCCESS != unReturnValueWrite)
+			break;
+
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM12_CLEAR_OWNER_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM12_CLEAR_OWNER_DASHED_LINE);
+
+		if (RC_SUCCESS == PpTpm12ClearOwnership->unReturnCode)
+		{
+			CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM12_CLEAR_OWNER_SUCCESS);
+		}
+		else
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM12_CLEAR_OWNER_FAILED, PpTpm12ClearOwnership->unReturnCode);
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Show benchmark output
+ *	@details	Format the benchmark results and display
+ *
+ *	@param		PpBenchmark				Pointer to a IfxBenchmark response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpBenchmark was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowBenchmark(
+	_In_	const IfxBenchmark* PpBenchmark)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpBenchmark || PpBenchmark->unType != STRUCT_TYPE_Benchmark)
+		{
+			LOGGING_WRITE_LEVEL1(L"Error while checking object PpBenchmark: was invalid or NULL.");
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized (PpBenchmark)");
+			break;
+		}
+
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_BENCHMARK_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_BENCHMARK_DASHED_LINE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_IMAGE, PpBenchmark->unFirmwareImageSize, PpBenchmark->unBlockCount);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_COMMANDS, PpBenchmark->unCommandCount);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_LOAD, PpBenchmark->ullLoadTime / 1000, PpBenchmark->ullLoadTime % 1000);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_UNMARSHAL, PpBenchmark->ullUnmarshalTime / 1000, PpBenchmark->ullUnmarshalTime % 1000);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_PROBE, PpBenchmark->ullProbeTime / 1000, PpBenchmark->ullProbeTime % 1000);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_CHECK, PpBenchmark->ullCheckTime / 1000, PpBenchmark->ullCheckTime % 1000);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_START, PpBenchmark->ullStartTime / 1000, PpBenchmark->ullStartTime % 1000);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_TRANSFER, PpBenchmark->ullTransferTime / 1000, PpBenchmark->ullTransferTime % 1000);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_STAGE, RES_BENCHMARK_STAGE_COMPLETE, PpBenchmark->ullCompleteTime / 1000, PpBenchmark->ullCompleteTime % 1000);
+		if (0 != PpBenchmark->unBlockCount && 0 != PpBenchmark->ullTransferTime)
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_THROUGHPUT,
+				PpBenchmark->unBlockCount * 1000000ULL / PpBenchmark->ullTransferTime,
+				PpBenchmark->ullTransferTime / PpBenchmark->unBlockCount);
+		}
+		if (RC_SUCCESS != PpBenchmark->unReturnCode)
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_FAILED, PpBenchmark->unReturnCode);
+		}
+		if (0 != PpBenchmark->unMicroCount)
+		{
+			unsigned int unIndex = 0;
+			CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_MICRO_INFORMATION, PpBenchmark->unMicroIterations);
+			CONSOLEIO_WRITE_BREAK(FALSE, RES_BENCHMARK_DASHED_LINE);
+			for (unIndex = 0; unIndex < PpBenchmark->unMicroCount && unIndex < BENCHMARK_MAX_MICRO_ENTRIES; unIndex++)
+			{
+				const IfxBenchmarkMicroEntry* pEntry = &PpBenchmark->rgsMicro[unIndex];
+				if (RC_SUCCESS == pEntry->unReturnCode)
 				{
-					CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_SUCCESS);
+					unsigned long long ullAllocations = pEntry->ullAllocations * 100 / PpBenchmark->unMicroIterations;
+					CONSOLEIO_WRITE_BREAK_FMT(
+						FALSE, RES_BENCHMARK_MICRO_ENTRY, pEntry->wszName, pEntry->ullNanoSecondsPerOperation, ullAllocations / 100, ullAllocations % 100);
 				}
 				else
 				{
-					CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_UPDATE_FAIL);
+					CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BENCHMARK_MICRO_FAILED, pEntry->wszName, pEntry->unReturnCode);
 				}
-				break;
 			}
-			default:
+			if (RC_SUCCESS != unReturnValueWrite)
 				break;
 		}
+
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
@@ -572,25 +1646,25 @@ Response_ShowUpdate(
 		unReturnValue = unReturnValueWrite;
 	}
 
-	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, RC_SUCCESS);
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
 
 	return unReturnValue;
 }
 
 /**
- *	@brief		Show TPM1.2 ClearOwnership output
- *	@details	Format TPM1.2 ClearOwnership output and display
+ *	@brief		Show check images output
+ *	@details	Format the applicability of the checked firmware images and display
  *
- *	@param		PpTpm12ClearOwnership	Pointer to a IfxTpm12ClearOwnership response structure
+ *	@param		PpCheckImages			Pointer to a IfxCheckImages response structure
  *
  *	@retval		RC_SUCCESS				The operation completed successfully.
- *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpTpm12ClearOwnership was invalid.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpCheckImages was invalid.
  *	@retval		...						Error codes from called functions.
  */
 _Check_return_
 unsigned int
-Response_ShowClearOwnership(
-	_In_	const IfxTpm12ClearOwnership* PpTpm12ClearOwnership)
+Response_ShowCheckImages(
+	_In_	const IfxCheckImages* PpCheckImages)
 {
 	unsigned int unReturnValue = RC_E_FAIL;
 	unsigned int unReturnValueWrite = RC_SUCCESS;
@@ -599,30 +1673,270 @@ Response_ShowClearOwnership(
 
 	do
 	{
+		unsigned int unIndex = 0;
+
 		// Check parameters
-		if (NULL == PpTpm12ClearOwnership || PpTpm12ClearOwnership->unType != STRUCT_TYPE_Tpm12ClearOwnership)
+		if (NULL == PpCheckImages || PpCheckImages->unType != STRUCT_TYPE_CheckImages)
 		{
-			LOGGING_WRITE_LEVEL1(L"Error while checking object PpTpmInfo: was invalid or NULL.");
+			LOGGING_WRITE_LEVEL1(L"Error while checking object PpCheckImages: was invalid or NULL.");
 			unReturnValue = RC_E_BAD_PARAMETER;
-			ERROR_STORE(unReturnValue, L"Parameter not initialized (PpTpm12ClearOwnership)");
+			ERROR_STORE(unReturnValue, L"Parameter not initialized (PpCheckImages)");
 			break;
 		}
 
+		// Display the probed TPM state
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_INFO_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM_INFO_DASHED_LINE);
+		if (PpCheckImages->sTpmState.attribs.bootLoader)
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_FIRMWARE_VALID, RES_TPM_INFO_NO);
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_FAMILY, RES_TPM_INFO_N_A);
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_VERSION, RES_TPM_INFO_N_A);
+		}
+		else
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_FIRMWARE_VALID, RES_TPM_INFO_YES);
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_FAMILY, PpCheckImages->sTpmState.attribs.tpm20 ? RES_TPM_INFO_2_0 : RES_TPM_INFO_1_2);
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_TPM_VERSION, PpCheckImages->wszFirmwareVersion);
+		}
+		if (PpCheckImages->unRemainingUpdates != REMAINING_UPDATES_UNAVAILABLE) // -1
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_NUMBER, PpCheckImages->unRemainingUpdates);
+		}
+		else
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM_INFO_REMAINING_UPDATES_STRING, RES_TPM_INFO_N_A);
+		}
+
+		// Display one line per firmware image and the reason if it is not applicable
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_CHECK_IMAGES_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_CHECK_IMAGES_DASHED_LINE);
+		if (0 == PpCheckImages->unEntryCount)
+		{
+			CONSOLEIO_WRITE_BREAK(FALSE, RES_CHECK_IMAGES_NONE);
+		}
+		for (unIndex = 0; unIndex < PpCheckImages->unEntryCount && unIndex < CHECK_IMAGES_MAX_ENTRIES; unIndex++)
+		{
+			const IfxCheckImagesEntry* pEntry = &PpCheckImages->rgsEntries[unIndex];
+			wchar_t wszTarget[MAX_NAME] = {0};
+			unsigned int unTargetSize = RG_LEN(wszTarget);
+
+			if (L'\0' != pEntry->wszTargetVersion[0])
+				IGNORE_RETURN_VALUE(Platform_StringFormat(wszTarget, &unTargetSize, RES_CHECK_IMAGES_TARGET, pEntry->bTargetFamily == DEVICE_TYPE_TPM_12 ? RES_TPM_INFO_1_2 : RES_TPM_INFO_2_0, pEntry->wszTargetVersion));
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_CHECK_IMAGES_ENTRY, pEntry->wszName, pEntry->fValid ? RES_CHECK_IMAGES_APPLICABLE : RES_CHECK_IMAGES_NOT_APPLICABLE, wszTarget);
+			if (!pEntry->fValid)
+			{
+				wchar_t wszMessage[MAX_MESSAGE_SIZE] = {0};
+				unsigned int unMessageSize = RG_LEN(wszMessage);
+				IGNORE_RETURN_VALUE(Error_GetFinalMessageFromErrorCode(pEntry->unErrorDetails, wszMessage, &unMessageSize));
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_CHECK_IMAGES_REASON, L"", wszMessage, pEntry->unErrorDetails);
+			}
+		}
 		if (RC_SUCCESS != unReturnValueWrite)
 			break;
+		if (0 != PpCheckImages->unSkippedCount)
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_CHECK_IMAGES_SKIPPED, PpCheckImages->unSkippedCount);
+		}
 
-		CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM12_CLEAR_OWNER_INFORMATION);
-		CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM12_CLEAR_OWNER_DASHED_LINE);
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
 
-		if (RC_SUCCESS == PpTpm12ClearOwnership->unReturnCode)
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Show the bytes of a recorded TPM command
+ *	@details	Displays the bytes as hex dump with RES_DECODE_CAPTURE_BYTES_PER_LINE bytes per line.
+ *
+ *	@param		PwszFirstLineFormat		Format string of the first line
+ *	@param		PrgbBuffer				Bytes to display
+ *	@param		PunBufferSize			Number of bytes to display
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from ConsoleIO_Write.
+ */
+_Check_return_
+static unsigned int
+Response_ShowCaptureBytes(
+	_In_z_							const wchar_t*	PwszFirstLineFormat,
+	_In_bytecount_(PunBufferSize)	const BYTE*		PrgbBuffer,
+	_In_							unsigned int	PunBufferSize)
+{
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+	unsigned int unOffset = 0;
+
+	for (unOffset = 0; unOffset < PunBufferSize; unOffset += RES_DECODE_CAPTURE_BYTES_PER_LINE)
+	{
+		wchar_t wszHex[RES_DECODE_CAPTURE_BYTES_PER_LINE * 3 + 1] = {0};
+		unsigned int unHexSize = RG_LEN(wszHex);
+		unsigned int unLineSize = PunBufferSize - unOffset < RES_DECODE_CAPTURE_BYTES_PER_LINE ? PunBufferSize - unOffset : RES_DECODE_CAPTURE_BYTES_PER_LINE;
+
+		IGNORE_RETURN_VALUE(Utility_StringScanByteToHex(&PrgbBuffer[unOffset], unLineSize, wszHex, &unHexSize));
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, 0 == unOffset ? PwszFirstLineFormat : RES_DECODE_CAPTURE_CONTINUATION, wszHex);
+	}
+
+	return unReturnValueWrite;
+}
+
+/**
+ *	@brief		Show decode capture output
+ *	@details	Format the TPM commands of a TPM capture file and display
+ *
+ *	@param		PpDecodeCapture			Pointer to a IfxDecodeCapture response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpDecodeCapture was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowDecodeCapture(
+	_In_	const IfxDecodeCapture* PpDecodeCapture)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		unsigned int unIndex = 0;
+		unsigned int unFailedCount = 0;
+		unsigned long long ullTotalDuration = 0;
+
+		// Check parameters
+		if (NULL == PpDecodeCapture || PpDecodeCapture->unType != STRUCT_TYPE_DecodeCapture)
 		{
-			CONSOLEIO_WRITE_BREAK(FALSE, RES_TPM12_CLEAR_OWNER_SUCCESS);
+			LOGGING_WRITE_LEVEL1(L"Error while checking object PpDecodeCapture: was invalid or NULL.");
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized (PpDecodeCapture)");
+			break;
 		}
-		else
+
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_DECODE_CAPTURE_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_DECODE_CAPTURE_DASHED_LINE);
+
+		// Display one block per TPM command: summary, response code and the request and response bytes
+		for (unIndex = 0; unIndex < PpDecodeCapture->unRecordCount; unIndex++)
 		{
-			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_TPM12_CLEAR_OWNER_FAILED, PpTpm12ClearOwnership->unReturnCode);
+			const IfxCaptureRecord* pRecord = &PpDecodeCapture->rgsRecords[unIndex];
+			wchar_t wszCommandName[MAX_NAME] = {0};
+			unsigned int unCommandNameSize = RG_LEN(wszCommandName);
+
+			if (NULL != pRecord->pwszCommandName)
+				IGNORE_RETURN_VALUE(Platform_StringCopy(wszCommandName, &unCommandNameSize, pRecord->pwszCommandName));
+			else
+				IGNORE_RETURN_VALUE(Platform_StringFormat(wszCommandName, &unCommandNameSize, RES_DECODE_CAPTURE_UNKNOWN_COMMAND, pRecord->unCommandCode));
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DECODE_CAPTURE_RECORD, unIndex + 1,
+				pRecord->ullTimeStamp / 1000, pRecord->ullTimeStamp % 1000, wszCommandName, pRecord->unDuration,
+				pRecord->unRequestSize, pRecord->unResponseSize);
+			ullTotalDuration += pRecord->unDuration;
+
+			if (RC_SUCCESS != pRecord->unTransmitReturnCode)
+			{
+				unFailedCount++;
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DECODE_CAPTURE_TRANSMIT_FAILED, pRecord->unTransmitReturnCode);
+			}
+			else if (pRecord->fResponseCode)
+			{
+				wchar_t wszMessage[MAX_MESSAGE_SIZE] = {0};
+				if (pRecord->fTpm12)
+					IGNORE_RETURN_VALUE(TpmResponse_TPM12GetMessage(pRecord->unResponseCode, wszMessage, RG_LEN(wszMessage)));
+				else
+					IGNORE_RETURN_VALUE(TpmResponse_GetMessage(pRecord->unResponseCode, wszMessage, RG_LEN(wszMessage)));
+				CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DECODE_CAPTURE_RESPONSE_CODE, pRecord->unResponseCode, wszMessage);
+			}
+			else
+			{
+				CONSOLEIO_WRITE_BREAK(FALSE, RES_DECODE_CAPTURE_NO_RESPONSE_CODE);
+			}
+
+			unReturnValueWrite = Response_ShowCaptureBytes(RES_DECODE_CAPTURE_REQUEST, pRecord->rgbRequest, pRecord->unRequestSize);
+			if (RC_SUCCESS != unReturnValueWrite)
+				break;
+			unReturnValueWrite = Response_ShowCaptureBytes(RES_DECODE_CAPTURE_RESPONSE, pRecord->rgbResponse, pRecord->unResponseSize);
+			if (RC_SUCCESS != unReturnValueWrite)
+				break;
+		}
+		if (RC_SUCCESS != unReturnValueWrite)
+			break;
+
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DECODE_CAPTURE_SUMMARY, PpDecodeCapture->unRecordCount, unFailedCount, ullTotalDuration / 1000, ullTotalDuration % 1000);
+		if (0 != PpDecodeCapture->unTruncatedSize)
+		{
+			CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_DECODE_CAPTURE_TRUNCATED, PpDecodeCapture->unTruncatedSize);
+		}
+
+		unReturnValue = RC_SUCCESS;
+	}
+	WHILE_FALSE_END;
+
+	// Check if a ConsoleIO_Write error occurred and no other error has occurred then store it
+	if (RC_SUCCESS == unReturnValue && RC_SUCCESS != unReturnValueWrite)
+	{
+		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
+		unReturnValue = unReturnValueWrite;
+	}
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Show build frames output
+ *	@details	Display the frame file written by the build-frames command
+ *
+ *	@param		PpBuildFrames			Pointer to a IfxBuildFrames response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpBuildFrames was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowBuildFrames(
+	_In_	const IfxBuildFrames* PpBuildFrames)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	unsigned int unReturnValueWrite = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		// Check parameters
+		if (NULL == PpBuildFrames || PpBuildFrames->unType != STRUCT_TYPE_BuildFrames)
+		{
+			LOGGING_WRITE_LEVEL1(L"Error while checking object PpBuildFrames: was invalid or NULL.");
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter not initialized (PpBuildFrames)");
+			break;
 		}
 
+		CONSOLEIO_WRITE_BREAK(FALSE, MENU_NEWLINE);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_BUILD_FRAMES_INFORMATION);
+		CONSOLEIO_WRITE_BREAK(FALSE, RES_BUILD_FRAMES_DASHED_LINE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BUILD_FRAMES_FILE, PpBuildFrames->wszFrameFile);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BUILD_FRAMES_FAMILY, PpBuildFrames->bSourceTpmFamily == DEVICE_TYPE_TPM_12 ? RES_TPM_INFO_1_2 : RES_TPM_INFO_2_0);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BUILD_FRAMES_FRAMES, PpBuildFrames->unFrameCount, PpBuildFrames->unMaxDataSize);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, RES_BUILD_FRAMES_SIZE, PpBuildFrames->unFrameFileSize);
+
 		unReturnValue = RC_SUCCESS;
 	}
 	WHILE_FALSE_END;
@@ -715,9 +2029,9 @@ Response_ShowError()
 		unsigned int unFinalCode = RC_E_FAIL;
 		unsigned int unInternalCode = RC_E_FAIL;
 
-		// Check if an error exists
+		// Check if an error exists, in JSON mode it is part of the JSON document
 		pErrorData = Error_GetStack();
-		if (NULL == pErrorData)
+		if (NULL == pErrorData || Response_IsJsonOutput())
 		{
 			// If not do nothing
 			unReturnValue = RC_SUCCESS;
@@ -725,7 +2039,7 @@ Response_ShowError()
 		}
 
 		// Check if LogPath is available
-		unReturnValue = Utility_CheckIfLogPathWritable(TRUE);
+		unReturnValue = Utility_CheckIfLogPathWritable();
 		if (RC_SUCCESS != unReturnValue && (
 					RC_E_FILE_NOT_FOUND == unReturnValue ||
 					RC_E_ACCESS_DENIED == unReturnValue))
@@ -782,13 +2096,15 @@ Response_ShowError()
 			// Cleanup allocated buffer before reuse the variable
 			Platform_MemoryFree((void**)&wszFormatedMessage);
 
-			unReturnValue = Platform_StringGetLength(pErrorData->wszInternalErrorMessage, RG_LEN(pErrorData->wszInternalErrorMessage), &unSize);
-			if (RC_SUCCESS != unReturnValue)
+			// Format the internal error message, a truncated message is shown as is
+			unSize = RG_LEN(wszBuffer);
+			unReturnValue = Error_FormatMessage(pErrorData, wszBuffer, &unSize);
+			if (RC_SUCCESS != unReturnValue && RC_E_BUFFER_TOO_SMALL != unReturnValue)
 				break;
 
 			// Format error message
 			unReturnValue = Utility_StringFormatOutput(
-								pErrorData->wszInternalErrorMessage, unSize + 1,
+								wszBuffer, unSize + 1,
 								RES_TPM_ERROR_EXPLANATION_PRESET, RG_LEN(RES_TPM_ERROR_EXPLANATION_PRESET), RES_MAX_LINE_SIZE,
 								&wszFormatedMessage, &unFormatedMessageSize);
 			if (RC_SUCCESS != unReturnValue)
@@ -1000,6 +2316,9 @@ Response_ShowHelp()
 
 	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
 
+	// Render the whole help before writing it to the console
+	ConsoleIO_BeginOutput();
+
 	do
 	{
 		// Show the help
@@ -1011,6 +2330,8 @@ Response_ShowHelp()
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE6);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE7, CMD_INFO);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE8);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE87, CMD_INFO_FIELD_FAMILY, CMD_INFO_FIELD_VERSION, CMD_INFO_FIELD_COUNTER, CMD_INFO_FIELD_STATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE88);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE9, CMD_UPDATE, CMD_FIRMWARE, CMD_CONFIG, CMD_TPM12_CLEAROWNERSHIP);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE10, CMD_UPDATE);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE11);
@@ -1023,6 +2344,7 @@ Response_ShowHelp()
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE18, CMD_INFO, CMD_TPM12_CLEAROWNERSHIP);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE19, CMD_FIRMWARE);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE20);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE112);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE21, CMD_UPDATE);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE22, CMD_INFO, CMD_CONFIG, CMD_TPM12_CLEAROWNERSHIP);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE23, CMD_CONFIG);
@@ -1042,18 +2364,133 @@ Response_ShowHelp()
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE36);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE37);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE38);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE109);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE110, CMD_INFO, CMD_CHECK_IMAGES);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE111);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE39);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE40);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE41);
 		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE42);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE43);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE44, CMD_INFO, CMD_CHECK_IMAGES);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE45);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE59);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE60);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE61);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE62);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE63);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE64);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE65);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE116);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE117);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE122);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE123);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE124);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE92);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE93, CMD_INFO, CMD_UPDATE);
+#endif
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE46, CMD_DRY_RUN);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE47);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE48, CMD_IGNORE_ERROR_ON_COMPLETE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE49);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE50, CMD_STATISTICS);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE51);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE52, CMD_INFO_CACHE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE53);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE54);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE55);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE66, CMD_VERIFY_CACHE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE67);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE68);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE69);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE153, CMD_LEARN_TIMEOUTS);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE154);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE155);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE56, CMD_BENCHMARK);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE57);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE58);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE70, CMD_CHECK_IMAGES);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE71);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE72);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE73, CMD_UPDATE, CMD_FIRMWARE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE74, CMD_DECODE_CAPTURE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE75);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE76);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE139, CMD_BUILD_FRAMES);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE140, CMD_FIRMWARE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE141, CMD_FRAME_FILE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE142);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE77, CMD_JSON);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE78, CMD_INFO, CMD_UPDATE, CMD_TPM12_CLEAROWNERSHIP);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE79);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE80, CMD_TIMING);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE81, CMD_INFO, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE82, CMD_JSON);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE83, CMD_SERVICE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE84);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE85);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE86, CMD_LOG, CMD_ACCESS_MODE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE89, CMD_QUIET);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE90, CMD_INFO, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE91);
+#ifdef LINUX
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE94, CMD_JOBS);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE95, CMD_ACCESS_MODE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE96);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE135, CMD_FORK);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE136, CMD_ACCESS_MODE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE137);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE138);
 #endif
-		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE43, CMD_DRY_RUN);
-		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE44);
-		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE45, CMD_IGNORE_ERROR_ON_COMPLETE);
-		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE46);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE146, CMD_DEVICE_LOG);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE147, CMD_ACCESS_MODE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE148);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE149, CMD_BACKGROUND);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE150, CMD_INFO, CMD_CHECK_IMAGES);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE151, CMD_INFO, BACKGROUND_INFO_CACHE_TTL);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE152, CMD_INFO_CACHE, CMD_ACCESS_MODE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE97, CMD_PREPARE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE98, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE99);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE100, CMD_COMMIT);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE101, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE102, CMD_PREPARE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE103, CMD_DEADLINE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE104, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE105);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE106, CMD_PROGRESS_FILE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE107, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE108);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE143, CMD_FRAME_FILE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE144, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE145, CMD_BUILD_FRAMES);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE113, CMD_CLEAROWNERSHIP_AFTER);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE114, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE115, CMD_TPM12_CLEAROWNERSHIP);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE118, CMD_FACTORY_LOOP);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE119, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE120);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE121);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE125, CMD_TRACE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE126);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE127);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE128, CMD_METRICS);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE129, CMD_INFO, CMD_UPDATE);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE130);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE131, CMD_BATCH);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE132);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE133);
+		CONSOLEIO_WRITE_BREAK(FALSE, HELP_LINE134);
+		CONSOLEIO_WRITE_BREAK_FMT(FALSE, HELP_LINE86, CMD_LOG, CMD_ACCESS_MODE);
 	}
 	WHILE_FALSE_END;
 
+	// Write the rendered help, also the part rendered before an error occurred
+	if (RC_SUCCESS == unReturnValueWrite)
+		unReturnValueWrite = ConsoleIO_FlushOutput();
+	else
+		IGNORE_RETURN_VALUE(ConsoleIO_FlushOutput());
+
 	// Check if a ConsoleIO_Write error occurred and store it
 	if (RC_SUCCESS != unReturnValueWrite)
 		ERROR_STORE(unReturnValueWrite, L"ConsoleIO_Write returned an error");
@@ -1079,6 +2516,14 @@ Response_ShowHeader()
 
 	do
 	{
+		// The JSON document must be the only console output, the quiet mode shows nothing but errors
+		if (Response_IsQuietOutput())
+		{
+			unReturnValueWrite = RC_SUCCESS;
+			s_fHeaderShown = TRUE;
+			break;
+		}
+
 		// Print Header to the screen
 		CONSOLEIO_WRITE_BREAK(FALSE, MENU_SEPARATOR);
 		CONSOLEIO_WRITE_BREAK_FMT(FALSE, MENU_HEADLINE, IFX_BRAND, TOOL_NAME, MENU_VERSION, APP_VERSION);
@@ -1112,6 +2557,137 @@ Response_HeaderShown()
 	return s_fHeaderShown;
 }
 
+/**
+ *	@brief		Updates the progress record in the progress file
+ *	@details	The record is written between two increments of its sequence number, so a reader polling the file can detect
+ *				a torn copy. Nothing is done if no progress file is written.
+ *
+ *	@param		PunPhase		Update phase (PROGRESS_PHASE_*)
+ *	@param		PunCompletion	Progress completion value between 0 and 100
+ *	@param		PpsProgress		Transfer progress or NULL to keep the transfer fields
+ *	@param		PunReturnCode	Final return code, only used with PROGRESS_PHASE_FINISHED
+ */
+static void
+Response_WriteProgressRecord(
+	_In_		unsigned int						PunPhase,
+	_In_		unsigned int						PunCompletion,
+	_In_opt_	const IfxFirmwareUpdateProgress*	PpsProgress,
+	_In_		unsigned int						PunReturnCode)
+{
+	volatile IfxProgressRecord* psRecord = s_psProgressRecord;
+	unsigned long long ullNow = 0;
+
+	if (NULL == psRecord)
+		return;
+
+	ullNow = Platform_GetMonotonicTimeMicroSeconds();
+	psRecord->unSequence++;
+	atomic_thread_fence(memory_order_release);
+
+	psRecord->unPhase = PunPhase;
+	psRecord->unCompletion = PunCompletion;
+	if (NULL != PpsProgress)
+	{
+		psRecord->unBlocksSent = PpsProgress->unBlocksSent;
+		psRecord->unBlocksTotal = PpsProgress->unBlocksTotal;
+		psRecord->unBytesSent = PpsProgress->unBytesSent;
+		psRecord->unBytesTotal = PpsProgress->unBytesTotal;
+		psRecord->unBytesPerSecond = PpsProgress->unBytesPerSecond;
+		psRecord->ullEstimatedTimeRemaining = PpsProgress->ullEstimatedTimeRemaining;
+	}
+	psRecord->unReturnCode = PunReturnCode;
+	if (0 != s_ullProgressStartTime && ullNow >= s_ullProgressStartTime)
+		psRecord->ullElapsedTime = (ullNow - s_ullProgressStartTime) / 1000;
+
+	atomic_thread_fence(memory_order_release);
+	psRecord->unSequence++;
+}
+
+/**
+ *	@brief		Opens the progress file given with the -progress-file command line option
+ *	@details	The file is mapped into memory, so the progress callbacks update the record without a system call. The record
+ *				starts in PROGRESS_PHASE_PREPARE. The sequence number of an existing progress file is continued. Nothing is done
+ *				if the option is not given.
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from FileIO_MapSharedFile.
+ */
+_Check_return_
+unsigned int
+Response_OpenProgressFile()
+{
+	unsigned int unReturnValue = RC_SUCCESS;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		wchar_t wszProgressFile[MAX_PATH] = {0};
+		unsigned int unProgressFileSize = RG_LEN(wszProgressFile);
+		BYTE* pbRecord = NULL;
+		volatile IfxProgressRecord* psRecord = NULL;
+
+		if (NULL != s_psProgressRecord ||
+				FALSE == PropertyStorage_GetValueByKey(PROPERTY_PROGRESS_FILE, wszProgressFile, &unProgressFileSize))
+			break;
+
+		unReturnValue = FileIO_MapSharedFile(wszProgressFile, sizeof(IfxProgressRecord), &pbRecord);
+		if (RC_SUCCESS != unReturnValue)
+		{
+			ERROR_STORE_FMT(unReturnValue, L"The progress file '%ls' could not be created.", wszProgressFile);
+			break;
+		}
+
+		// Make the sequence number odd while the record is initialized, a new file starts with zero bytes
+		psRecord = (volatile IfxProgressRecord*)pbRecord;
+		psRecord->unSequence |= 1;
+		atomic_thread_fence(memory_order_release);
+		psRecord->unMagic = PROGRESS_FILE_MAGIC;
+		psRecord->unVersion = PROGRESS_FILE_VERSION;
+		psRecord->unSize = sizeof(IfxProgressRecord);
+		psRecord->unPhase = PROGRESS_PHASE_PREPARE;
+		psRecord->unCompletion = 0;
+		psRecord->unBlocksSent = 0;
+		psRecord->unBlocksTotal = 0;
+		psRecord->unBytesSent = 0;
+		psRecord->unBytesTotal = 0;
+		psRecord->unBytesPerSecond = 0;
+		psRecord->unReturnCode = 0;
+		psRecord->ullElapsedTime = 0;
+		psRecord->ullEstimatedTimeRemaining = 0;
+		atomic_thread_fence(memory_order_release);
+		psRecord->unSequence++;
+
+		s_psProgressRecord = psRecord;
+		s_ullProgressStartTime = Platform_GetMonotonicTimeMicroSeconds();
+	}
+	WHILE_FALSE_END;
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Writes the final return code to the progress file and closes it
+ *	@details	The record is left in PROGRESS_PHASE_FINISHED. Nothing is done if no progress file is open.
+ *
+ *	@param		PunReturnCode	Final return code of the tool
+ */
+void
+Response_CloseProgressFile(
+	_In_ unsigned int PunReturnCode)
+{
+	BYTE* pbRecord = (BYTE*)s_psProgressRecord;
+
+	if (NULL == pbRecord)
+		return;
+
+	Response_WriteProgressRecord(PROGRESS_PHASE_FINISHED, RC_SUCCESS == PunReturnCode ? 100 : s_psProgressRecord->unCompletion, NULL, PunReturnCode);
+	s_psProgressRecord = NULL;
+	FileIO_ReleaseFileBuffer(&pbRecord, sizeof(IfxProgressRecord), TRUE);
+}
+
 /**
  *	@brief		Callback function for progress report of EFI_FIRMWARE_MANAGEMENT_PROTOCOL.SetImage().
  *	@details	The function is called by EFI_FIRMWARE_MANAGEMENT_PROTOCOL.SetImage() to update the progress (1 - 100). It prints the
@@ -1127,7 +2703,85 @@ Response_ProgressCallback(
 	_In_ unsigned long long PullCompletion)
 {
 	unsigned int unProgress = (unsigned int) PullCompletion;
-	IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, RES_TPM_UPDATE_PROGRESS, unProgress));
+	if (!Response_IsQuietOutput())
+		IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, RES_TPM_UPDATE_PROGRESS, unProgress));
+
+	// Progress outside of the block transfer belongs to the preparation or, once blocks were sent, to the completion
+	if (NULL != s_psProgressRecord)
+		Response_WriteProgressRecord(s_psProgressRecord->unPhase >= PROGRESS_PHASE_TRANSFER ? PROGRESS_PHASE_COMPLETE : PROGRESS_PHASE_PREPARE,
+									 unProgress, NULL, 0);
+	Response_CallProgressHook(unProgress);
 
 	return 0;
 }
+
+/**
+ *	@brief		Callback function for the detailed progress report of the firmware block transfer.
+ *	@details	The function is called after each firmware block sent to the TPM. To keep console and log I/O out of the
+ *				transfer loop, the progress is printed to the console at most every RESPONSE_PROGRESS_CONSOLE_INTERVAL
+ *				milliseconds and written to the log file at most every RESPONSE_PROGRESS_LOG_INTERVAL milliseconds.
+ *				The last block is always reported.
+ *
+ *	@param		PpsProgress		Transfer progress
+ */
+void
+Response_ProgressDetailsCallback(
+	_In_ const IfxFirmwareUpdateProgress* PpsProgress)
+{
+	BOOL fLastBlock = FALSE;
+
+	if (NULL == PpsProgress)
+		return;
+
+	fLastBlock = PpsProgress->unBlocksSent == PpsProgress->unBlocksTotal;
+	Response_WriteProgressRecord(PROGRESS_PHASE_TRANSFER, PpsProgress->unCompletion, PpsProgress, 0);
+	Response_CallProgressHook(PpsProgress->unCompletion);
+
+	// A new transfer restarts the elapsed time
+	if (PpsProgress->unBlocksSent <= 1)
+	{
+		s_ullLastProgressConsoleTime = 0;
+		s_ullLastProgressLogTime = 0;
+	}
+
+	if (!Response_IsQuietOutput() && (fLastBlock || PpsProgress->unBlocksSent <= 1 ||
+			PpsProgress->ullElapsedTime - s_ullLastProgressConsoleTime >= RESPONSE_PROGRESS_CONSOLE_INTERVAL))
+	{
+		s_ullLastProgressConsoleTime = PpsProgress->ullElapsedTime;
+		if (0 == PpsProgress->unBytesPerSecond)
+		{
+			IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, RES_TPM_UPDATE_PROGRESS, PpsProgress->unCompletion));
+		}
+		else
+		{
+			IGNORE_RETURN_VALUE(ConsoleIO_Write(FALSE, FALSE, RES_TPM_UPDATE_PROGRESS_DETAILS, PpsProgress->unCompletion,
+												PpsProgress->unBytesPerSecond / 1024, (unsigned int)((PpsProgress->ullEstimatedTimeRemaining + 999) / 1000)));
+		}
+	}
+
+	if (fLastBlock || PpsProgress->ullElapsedTime - s_ullLastProgressLogTime >= RESPONSE_PROGRESS_LOG_INTERVAL)
+	{
+		s_ullLastProgressLogTime = PpsProgress->ullElapsedTime;
+		LOGGING_WRITE_LEVEL2_FMT(L"Firmware transfer: block %d of %d, %d of %d bytes, %llu ms elapsed, %d bytes/s, %llu ms remaining",
+								 PpsProgress->unBlocksSent, PpsProgress->unBlocksTotal, PpsProgress->unBytesSent, PpsProgress->unBytesTotal,
+								 PpsProgress->ullElapsedTime, PpsProgress->unBytesPerSecond, PpsProgress->ullEstimatedTimeRemaining);
+	}
+}
+
+/**
+ *	@brief		Sets the progress hook of an application embedding the tool
+ *	@details	The hook is called by Response_ProgressCallback and Response_ProgressDetailsCallback whenever the completion
+ *				value changes, in addition to the console output and the progress file.
+ *
+ *	@param		PfnHook			Progress hook, NULL to remove it
+ *	@param		PpvContext		Context handed over to the progress hook
+ */
+void
+Response_SetProgressHook(
+	_In_opt_	PFN_RESPONSE_PROGRESSHOOK	PfnHook,
+	_In_opt_	void*						PpvContext)
+{
+	s_fnProgressHook = PfnHook;
+	s_pvProgressHookContext = PpvContext;
+	s_unProgressHookCompletion = 0;
+}
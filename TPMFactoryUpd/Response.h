@@ -21,6 +21,9 @@ extern "C" {
 #include "TPMFactoryUpdStruct.h"
 #include "ConsoleIO.h"
 
+/// Maximum size of the JSON result document in elements including the zero termination
+#define RESPONSE_JSON_DOCUMENT_SIZE MAX_MESSAGE_SIZE
+
 /**
  *	@brief		Show output
  *	@details	Takes the response information, formats and displays the output
@@ -66,6 +69,66 @@ unsigned int
 Response_ShowUpdate(
 	_In_ const IfxUpdate* PpTpmUpdate);
 
+/**
+ *	@brief		Show benchmark output
+ *	@details	Format the benchmark results and display
+ *
+ *	@param		PpBenchmark				Pointer to a IfxBenchmark response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpBenchmark was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowBenchmark(
+	_In_	const IfxBenchmark* PpBenchmark);
+
+/**
+ *	@brief		Show check images output
+ *	@details	Format the applicability of the checked firmware images and display
+ *
+ *	@param		PpCheckImages			Pointer to a IfxCheckImages response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpCheckImages was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowCheckImages(
+	_In_	const IfxCheckImages* PpCheckImages);
+
+/**
+ *	@brief		Show decode capture output
+ *	@details	Format the TPM commands of a TPM capture file and display
+ *
+ *	@param		PpDecodeCapture			Pointer to a IfxDecodeCapture response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpDecodeCapture was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowDecodeCapture(
+	_In_	const IfxDecodeCapture* PpDecodeCapture);
+
+/**
+ *	@brief		Show build frames output
+ *	@details	Display the frame file written by the build-frames command
+ *
+ *	@param		PpBuildFrames			Pointer to a IfxBuildFrames response structure
+ *
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function. PpBuildFrames was invalid.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowBuildFrames(
+	_In_	const IfxBuildFrames* PpBuildFrames);
+
 /**
  *	@brief		Show TPM1.2 ClearOwnership output
  *	@details	Format TPM1.2 ClearOwnership output and display
@@ -151,6 +214,167 @@ _Check_return_
 BOOL
 Response_HeaderShown();
 
+/**
+ *	@brief		Returns whether the result is shown as JSON document
+ *	@details	The JSON output is selected with the -json command line option (PROPERTY_JSON_OUTPUT).
+ *
+ *	@retval		TRUE		The result is shown as JSON document by Response_ShowJsonResult.
+ *	@retval		FALSE		The result is shown as text.
+ */
+_Check_return_
+BOOL
+Response_IsJsonOutput();
+
+/**
+ *	@brief		Returns whether the text output of the result is suppressed
+ *	@details	The text output is suppressed with the -quiet command line option (PROPERTY_QUIET_OUTPUT) and in JSON mode.
+ *				Only the exit code, error messages and the JSON document are written then.
+ *
+ *	@retval		TRUE		The header, progress and result text are not rendered.
+ *	@retval		FALSE		The result is shown as text.
+ */
+_Check_return_
+BOOL
+Response_IsQuietOutput();
+
+/**
+ *	@brief		Builds the JSON result document
+ *	@details	The document contains the tool version, the command, the final return code and error message and for -info
+ *				and -update the TPM state and the update result.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@param		PunReturnCode			Final return code of the command
+ *	@param		PwszDocument			Receives the JSON result document
+ *	@param		PpunLength				Receives the length of the document without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_GetJsonResult(
+	_In_opt_									const IfxToolHeader*	PpResponseData,
+	_In_										unsigned int			PunReturnCode,
+	_Out_z_cap_(RESPONSE_JSON_DOCUMENT_SIZE)	wchar_t*				PwszDocument,
+	_Out_										unsigned int*			PpunLength);
+
+/**
+ *	@brief		Builds the JSON result document of a request answered during a firmware update
+ *	@details	Contains the tool version, the command, the return code and its message, the TPM state taken before the
+ *				update started and the progress of the update. The error stack is not used, so the error stack of the
+ *				update is not disturbed.
+ *
+ *	@param		PpTpmInfo				TPM state taken before the update started (can be NULL)
+ *	@param		PwszCommand				Command of the request
+ *	@param		PunReturnCode			Return code of the request
+ *	@param		PunProgress				Progress completion value of the update between 0 and 100
+ *	@param		PwszDocument			Receives the JSON result document
+ *	@param		PpunLength				Receives the length of the document without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_GetJsonBusyResult(
+	_In_opt_									const IfxInfo*	PpTpmInfo,
+	_In_z_										const wchar_t*	PwszCommand,
+	_In_										unsigned int	PunReturnCode,
+	_In_										unsigned int	PunProgress,
+	_Out_z_cap_(RESPONSE_JSON_DOCUMENT_SIZE)	wchar_t*		PwszDocument,
+	_Out_										unsigned int*	PpunLength);
+
+/**
+ *	@brief		Show the result as JSON document
+ *	@details	Writes the JSON result document built by Response_GetJsonResult to the console. Nothing is done if the -json
+ *				command line option is not set. Response_Show, Response_ShowHeader and Response_ShowError do not write any
+ *				text in that case.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@param		PunReturnCode			Final return code of the command
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowJsonResult(
+	_In_opt_	const IfxToolHeader*	PpResponseData,
+	_In_		unsigned int			PunReturnCode);
+
+/**
+ *	@brief		Show the duration of the command phases
+ *	@details	Writes the phase timings of an -info or -update command to the console if the -timing command line option
+ *				is set. Nothing is done for other commands or in JSON mode, the JSON document always contains the timings.
+ *
+ *	@param		PpResponseData			Response structure of the command (can be NULL)
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowTimings(
+	_In_opt_	const IfxToolHeader*	PpResponseData);
+
+/**
+ *	@brief		Show the result of one of several TPM devices
+ *	@details	Writes the output of the worker process which processed the device. In JSON mode the JSON result documents of
+ *				the devices are combined to one document {"devices":[{"exitCode":...,"path":...,"result":...},...]} which is
+ *				completed by Response_ShowDevicesSummary. In quiet mode only the output of failed devices is shown.
+ *
+ *	@param		PwszDevicePath			Path of the TPM device
+ *	@param		PunIndex				Number of device results shown before
+ *	@param		PunExitCode				Exit code of the worker process
+ *	@param		PwszOutput				Output of the worker process, the lines are separated by line breaks
+ *	@param		PunOutputLength			Length of the output without the zero termination
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		RC_E_BAD_PARAMETER		An invalid parameter was passed to the function.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowDeviceResult(
+	_In_z_							const wchar_t*	PwszDevicePath,
+	_In_							unsigned int	PunIndex,
+	_In_							unsigned int	PunExitCode,
+	_In_z_count_(PunOutputLength)	const wchar_t*	PwszOutput,
+	_In_							unsigned int	PunOutputLength);
+
+/**
+ *	@brief		Show the summary of several TPM devices
+ *	@details	Completes the combined JSON result document in JSON mode. Nothing is shown in quiet mode.
+ *
+ *	@param		PunSucceeded			Number of devices processed successfully
+ *	@param		PunTotal				Number of devices
+ *	@retval		RC_SUCCESS				The operation completed successfully.
+ *	@retval		...						Error codes from called functions.
+ */
+_Check_return_
+unsigned int
+Response_ShowDevicesSummary(
+	_In_	unsigned int	PunSucceeded,
+	_In_	unsigned int	PunTotal);
+
+/**
+ *	@brief		Opens the progress file given with the -progress-file command line option
+ *	@details	The file is mapped into memory, so the progress callbacks update the record without a system call. The record
+ *				starts in PROGRESS_PHASE_PREPARE. The sequence number of an existing progress file is continued. Nothing is done
+ *				if the option is not given.
+ *
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from FileIO_MapSharedFile.
+ */
+_Check_return_
+unsigned int
+Response_OpenProgressFile();
+
+/**
+ *	@brief		Writes the final return code to the progress file and closes it
+ *	@details	The record is left in PROGRESS_PHASE_FINISHED. Nothing is done if no progress file is open.
+ *
+ *	@param		PunReturnCode	Final return code of the tool
+ */
+void
+Response_CloseProgressFile(
+	_In_ unsigned int PunReturnCode);
+
 /**
  *	@brief		Callback function for progress report of EFI_FIRMWARE_MANAGEMENT_PROTOCOL.SetImage().
  *	@details	The function is called by EFI_FIRMWARE_MANAGEMENT_PROTOCOL.SetImage() to update the progress (1 - 100). It prints the
@@ -169,6 +393,37 @@ Response_ProgressCallback(
 typedef unsigned long long (*PFN_RESPONSE_PROGRESSCALLBACK)(
 	unsigned long long PullCompletion);
 
+/**
+ *	@brief		Callback function for the detailed progress report of the firmware block transfer.
+ *	@details	The function is called after each firmware block sent to the TPM. To keep console and log I/O out of the
+ *				transfer loop, the progress is printed to the console at most every RESPONSE_PROGRESS_CONSOLE_INTERVAL
+ *				milliseconds and written to the log file at most every RESPONSE_PROGRESS_LOG_INTERVAL milliseconds.
+ *				The last block is always reported.
+ *
+ *	@param		PpsProgress		Transfer progress
+ */
+void
+Response_ProgressDetailsCallback(
+	_In_ const IfxFirmwareUpdateProgress* PpsProgress);
+
+/// Function pointer type definition for the progress hook of an application embedding the tool
+typedef void (*PFN_RESPONSE_PROGRESSHOOK)(
+	void* PpvContext,
+	unsigned int PunCompletion);
+
+/**
+ *	@brief		Sets the progress hook of an application embedding the tool
+ *	@details	The hook is called by Response_ProgressCallback and Response_ProgressDetailsCallback whenever the completion
+ *				value changes, in addition to the console output and the progress file.
+ *
+ *	@param		PfnHook			Progress hook, NULL to remove it
+ *	@param		PpvContext		Context handed over to the progress hook
+ */
+void
+Response_SetProgressHook(
+	_In_opt_	PFN_RESPONSE_PROGRESSHOOK	PfnHook,
+	_In_opt_	void*						PpvContext);
+
 #ifdef __cplusplus
 }
 #endif
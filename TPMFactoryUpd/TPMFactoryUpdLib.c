@@ -0,0 +1,482 @@
+﻿/**
+ *	@brief		Implements the C API of the TPMFactoryUpd library
+ *	@details	Each connection works on a session context of its own, so the property storage and the error stack of the
+ *				application thread stay untouched. The calls are processed like the requests of the service mode by
+ *				Controller_ProceedWork with the console output suppressed.
+ *	@file		TPMFactoryUpdLib.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TPMFactoryUpdLib.h"
+#include "Controller.h"
+#include "CommandLine.h"
+#include "CommandFlow_TpmInfo.h"
+#include "DeviceManagement.h"
+#include "Session.h"
+#include "Response.h"
+#include "Resource.h"
+#include "PropertyDefines.h"
+
+/**
+ *	@brief		Connection to a TPM
+ *	@details
+ */
+struct tdIfxLibConnection
+{
+	/// Session context of the connection
+	IfxSession* pSession;
+};
+
+/// The open connection, NULL if none
+static IfxLibConnection* s_pConnection = NULL;
+
+/**
+ *	@brief		Binds the session of a connection to the calling thread
+ *	@details
+ *
+ *	@param		PpConnection	Connection
+ *	@returns	The session bound before, to be handed over to TPMFactoryUpdLib_Unbind.
+ */
+static IfxSession*
+TPMFactoryUpdLib_Bind(
+	_In_ IfxLibConnection* PpConnection)
+{
+	IfxSession* pPreviousSession = Session_SetCurrent(PpConnection->pSession);
+
+	// The cached logging level follows the property storage of the bound session
+	Logging_UpdateLevel();
+
+	return pPreviousSession;
+}
+
+/**
+ *	@brief		Binds the session of the application again
+ *	@details	Logs and clears the error stack of the connection before.
+ *
+ *	@param		PpPreviousSession	Session returned by TPMFactoryUpdLib_Bind
+ *	@param		PunReturnValue		Return value of the call
+ *	@returns	The final return code of the call.
+ */
+static unsigned int
+TPMFactoryUpdLib_Unbind(
+	_In_opt_	IfxSession*		PpPreviousSession,
+	_In_		unsigned int	PunReturnValue)
+{
+	unsigned int unFinalCode = PunReturnValue;
+
+	if (NULL != Error_GetStack())
+	{
+		unFinalCode = Error_GetFinalCode();
+		Error_LogStack();
+		Error_ClearStack();
+	}
+
+	IGNORE_RETURN_VALUE(Session_SetCurrent(PpPreviousSession));
+	Logging_UpdateLevel();
+
+	return unFinalCode;
+}
+
+/**
+ *	@brief		Processes the command line of a call
+ *	@details	The properties set by the command line are removed afterwards.
+ *
+ *	@param		PnArgc				Number of elements in PrgwszArgv
+ *	@param		PrgwszArgv			Command line
+ *	@param		PfCheck				TRUE to end an update after the firmware image checks
+ *	@param		PppResponseData		Receives the response structure, must be released with Controller_ReleaseResponse
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Error codes from called functions.
+ */
+_Check_return_
+static unsigned int
+TPMFactoryUpdLib_ProceedWork(
+	_In_					int						PnArgc,
+	_In_reads_z_(PnArgc)	const wchar_t* const	PrgwszArgv[],
+	_In_					BOOL					PfCheck,
+	_Inout_					IfxToolHeader**			PppResponseData)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		if (PfCheck && !PropertyStorage_AddKeyBooleanValuePair(PROPERTY_SERVICE_CHECK, TRUE))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while adding a key value pair. (%ls)", PROPERTY_SERVICE_CHECK);
+			break;
+		}
+
+		unReturnValue = CommandLine_Parse(PnArgc, PrgwszArgv);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		unReturnValue = Controller_ProceedWork(PppResponseData);
+	}
+	WHILE_FALSE_END;
+
+	Controller_ClearRequestProperties();
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Processes a check or an update
+ *	@details
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PwszUpdateType		Update type of the -update command line option
+ *	@param		PwszPath			Firmware image path, the configuration file path for the config-file update type
+ *	@param		PfCheck				TRUE to end the update after the firmware image checks
+ *	@param		PpsCheck			Receives the result of the firmware image check, may be NULL
+ *	@retval		RC_SUCCESS			The operation completed successfully.
+ *	@retval		...					Final error code of the call.
+ */
+_Check_return_
+static unsigned int
+TPMFactoryUpdLib_ProceedUpdate(
+	_In_		IfxLibConnection*	PpConnection,
+	_In_z_		const wchar_t*		PwszUpdateType,
+	_In_z_		const wchar_t*		PwszPath,
+	_In_		BOOL				PfCheck,
+	_Inout_opt_	IfxLibImageCheck*	PpsCheck)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxSession* pPreviousSession = TPMFactoryUpdLib_Bind(PpConnection);
+	IfxToolHeader* pResponseData = NULL;
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		const wchar_t* rgwszArgv[] = {TOOL_NAME, L"-" CMD_UPDATE, PwszUpdateType, L"-" CMD_FIRMWARE, PwszPath};
+		unsigned int unSize = 0;
+
+		if (NULL != PpsCheck && sizeof(IfxLibImageCheck) > PpsCheck->unSize)
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"Parameter PpsCheck is invalid.");
+			break;
+		}
+
+		// A configuration file names the firmware images itself
+		if (0 == Platform_StringCompare(PwszUpdateType, CMD_UPDATE_OPTION_CONFIG_FILE, RG_LEN(CMD_UPDATE_OPTION_CONFIG_FILE), TRUE))
+			rgwszArgv[3] = L"-" CMD_CONFIG;
+
+		unReturnValue = TPMFactoryUpdLib_ProceedWork(RG_LEN(rgwszArgv), rgwszArgv, PfCheck, &pResponseData);
+		Response_CloseProgressFile(NULL != Error_GetStack() ? Error_GetFinalCode() : unReturnValue);
+
+		if (NULL != PpsCheck && NULL != pResponseData && STRUCT_TYPE_TpmUpdate == pResponseData->unType)
+		{
+			const IfxUpdate* pTpmUpdate = (const IfxUpdate*)pResponseData;
+
+			PpsCheck->fUpdatable = GENERIC_TRISTATE_STATE_YES == pTpmUpdate->unNewFirmwareValid;
+			PpsCheck->fUpToDate = RC_E_ALREADY_UP_TO_DATE == pTpmUpdate->unReturnCode;
+			PpsCheck->unErrorDetails = pTpmUpdate->unErrorDetails;
+			PpsCheck->unNewFamily = 0;
+			PpsCheck->wszNewVersion[0] = L'\0';
+			PpsCheck->fFactoryDefaults = 0;
+			PpsCheck->ullPredictedDuration = pTpmUpdate->ullPredictedDuration;
+			if (PpsCheck->fUpdatable)
+			{
+				PpsCheck->unNewFamily = DEVICE_TYPE_TPM_12 == pTpmUpdate->bTargetFamily ? 12 : 20;
+				unSize = RG_LEN(PpsCheck->wszNewVersion);
+				IGNORE_RETURN_VALUE(Platform_StringCopy(PpsCheck->wszNewVersion, &unSize, pTpmUpdate->wszNewFirmwareVersion));
+				PpsCheck->fFactoryDefaults = pTpmUpdate->bfNewTpmFirmwareInfo.factoryDefaults;
+			}
+		}
+	}
+	WHILE_FALSE_END;
+
+	Controller_ReleaseResponse(&pResponseData);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return TPMFactoryUpdLib_Unbind(pPreviousSession, unReturnValue);
+}
+
+/**
+ *	@brief		Connects to the TPM
+ *	@details	Reads the configuration file TPMFactoryUpd.cfg of the working directory, parses the options like the
+ *				command line of the tool and connects to the TPM.
+ *
+ *	@param		PnOptionCount		Number of options
+ *	@param		PrgwszOptions		Command line options of the connection and logging, e.g. -access-mode 3 /dev/tpm0 -log.
+ *									May be NULL if PnOptionCount is 0.
+ *	@param		PppConnection		Receives the connection, must be closed with TPMFactoryUpdLib_Disconnect
+ *	@retval		0					The TPM has been connected.
+ *	@retval		...					Error code of the tool, e.g. RC_E_ALREADY_CONNECTED if a connection is open already.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_Connect(
+	_In_							int						PnOptionCount,
+	_In_reads_z_(PnOptionCount)		const wchar_t* const	PrgwszOptions[],
+	_Out_							IfxLibConnection**		PppConnection)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxLibConnection* pConnection = NULL;
+	IfxSession* pPreviousSession = NULL;
+	const wchar_t** prgwszArgv = NULL;
+	int nIndex = 0;
+
+	if (NULL == PppConnection || 0 > PnOptionCount || (0 < PnOptionCount && NULL == PrgwszOptions))
+		return RC_E_BAD_PARAMETER;
+	*PppConnection = NULL;
+	if (NULL != s_pConnection)
+		return RC_E_ALREADY_CONNECTED;
+
+	pConnection = (IfxLibConnection*)Platform_MemoryAllocateZero(sizeof(IfxLibConnection));
+	prgwszArgv = (const wchar_t**)Platform_MemoryAllocateZero(sizeof(wchar_t*) * (PnOptionCount + 2));
+	if (NULL == pConnection || NULL == prgwszArgv || RC_SUCCESS != Session_Create(&pConnection->pSession))
+	{
+		Platform_MemoryFree((void**)&prgwszArgv);
+		Platform_MemoryFree((void**)&pConnection);
+		return RC_E_FAIL;
+	}
+	pPreviousSession = Session_SetCurrent(pConnection->pSession);
+
+	// Logging not initialized yet
+
+	do
+	{
+		// The options are parsed together with the info command line option, which needs the TPM connected
+		prgwszArgv[0] = TOOL_NAME;
+		prgwszArgv[1] = L"-" CMD_INFO;
+		for (nIndex = 0; nIndex < PnOptionCount; nIndex++)
+			prgwszArgv[nIndex + 2] = PrgwszOptions[nIndex];
+
+		Platform_MemoryScratchBegin();
+		unReturnValue = Controller_Initialize(PnOptionCount + 2, prgwszArgv);
+		Platform_MemoryScratchEnd();
+		if (RC_SUCCESS != unReturnValue)
+			break;
+
+		// Now we can log
+		LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+		if (FALSE == DeviceManagement_IsConnected())
+		{
+			unReturnValue = RC_E_BAD_PARAMETER;
+			ERROR_STORE(unReturnValue, L"The options of the connection did not connect the TPM.");
+			break;
+		}
+		Controller_ClearRequestProperties();
+
+		// The calls are answered by the result structures only and keep the TPM information in memory
+		if (!PropertyStorage_AddKeyBooleanValuePair(PROPERTY_QUIET_OUTPUT, TRUE) &&
+			!PropertyStorage_ChangeBooleanValueByKey(PROPERTY_QUIET_OUTPUT, TRUE))
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE_FMT(unReturnValue, L"PropertyStorage returned an unexpected value while adding a key value pair. (%ls)", PROPERTY_QUIET_OUTPUT);
+			break;
+		}
+		CommandFlow_TpmInfo_KeepCacheInMemory(TRUE);
+
+		LOGGING_WRITE_LEVEL1(L"Library connection opened.");
+	}
+	WHILE_FALSE_END;
+
+	Platform_MemoryFree((void**)&prgwszArgv);
+
+	// Some parts of the initialization could have been executed successfully e.g. DeviceManagement_Connect
+	if (RC_SUCCESS != unReturnValue)
+		IGNORE_RETURN_VALUE(Controller_Uninitialize());
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	if (RC_SUCCESS == unReturnValue)
+	{
+		s_pConnection = pConnection;
+		*PppConnection = pConnection;
+		return TPMFactoryUpdLib_Unbind(pPreviousSession, unReturnValue);
+	}
+
+	unReturnValue = TPMFactoryUpdLib_Unbind(pPreviousSession, unReturnValue);
+	Logging_Close();
+	Session_Release(&pConnection->pSession);
+	Platform_MemoryFree((void**)&pConnection);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Returns the TPM information
+ *	@details	Like the -info command line option. The information is cached until an update changes it.
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PpsInfo				Receives the TPM information
+ *	@retval		0					The operation completed successfully.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_GetInfo(
+	_In_	IfxLibConnection*	PpConnection,
+	_Inout_	IfxLibTpmInfo*		PpsInfo)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxSession* pPreviousSession = NULL;
+	IfxToolHeader* pResponseData = NULL;
+
+	if (NULL == PpConnection || PpConnection != s_pConnection || NULL == PpsInfo || sizeof(IfxLibTpmInfo) > PpsInfo->unSize)
+		return RC_E_BAD_PARAMETER;
+	pPreviousSession = TPMFactoryUpdLib_Bind(PpConnection);
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	do
+	{
+		const wchar_t* rgwszArgv[] = {TOOL_NAME, L"-" CMD_INFO};
+		const IfxInfo* pTpmInfo = NULL;
+		BITFIELD_TPM_ATTRIBUTES sAttributes;
+		unsigned int unSize = RG_LEN(PpsInfo->wszVersion);
+
+		unReturnValue = TPMFactoryUpdLib_ProceedWork(RG_LEN(rgwszArgv), rgwszArgv, FALSE, &pResponseData);
+		if (RC_SUCCESS != unReturnValue)
+			break;
+		if (NULL == pResponseData || STRUCT_TYPE_TpmInfo != pResponseData->unType)
+		{
+			unReturnValue = RC_E_FAIL;
+			ERROR_STORE(unReturnValue, L"Controller_ProceedWork returned no TPM information.");
+			break;
+		}
+
+		pTpmInfo = (const IfxInfo*)pResponseData;
+		sAttributes = pTpmInfo->sTpmState.attribs;
+		PpsInfo->unFamily = sAttributes.tpm12 ? 12 : sAttributes.tpm20 ? 20 : 0;
+		IGNORE_RETURN_VALUE(Platform_StringCopy(PpsInfo->wszVersion, &unSize, pTpmInfo->wszVersionName));
+		PpsInfo->unRemainingUpdates = pTpmInfo->unRemainingUpdates;
+		PpsInfo->unAttributes =
+			(sAttributes.bootLoader ? TPMFACTORYUPDLIB_ATTRIBUTE_BOOT_LOADER : 0) |
+			(sAttributes.unsupportedChip ? TPMFACTORYUPDLIB_ATTRIBUTE_UNSUPPORTED_CHIP : 0) |
+			(sAttributes.tpm12owner ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_OWNER : 0) |
+			(sAttributes.tpm12enabled ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_ENABLED : 0) |
+			(sAttributes.tpm12activated ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_ACTIVATED : 0) |
+			(sAttributes.tpm12FailedSelfTest ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_FAILED_SELFTEST : 0) |
+			(sAttributes.tpm20restartRequired ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_RESTART_REQUIRED : 0) |
+			(sAttributes.tpm20phDisabled ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_PH_DISABLED : 0) |
+			(sAttributes.tpm20emptyPlatformAuth ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_EMPTY_PLATFORMAUTH : 0) |
+			(sAttributes.tpm20InFailureMode ? TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_FAILURE_MODE : 0);
+	}
+	WHILE_FALSE_END;
+
+	Controller_ReleaseResponse(&pResponseData);
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	return TPMFactoryUpdLib_Unbind(pPreviousSession, unReturnValue);
+}
+
+/**
+ *	@brief		Checks if the TPM can be updated with a firmware image
+ *	@details	Like the check request of the service mode. Nothing is changed on the TPM.
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PwszUpdateType		Update type of the -update command line option, e.g. tpm20-emptyplatformauth
+ *	@param		PwszPath			Firmware image path, the configuration file path for the config-file update type
+ *	@param		PpsCheck			Receives the result of the check
+ *	@retval		0					The operation completed successfully. PpsCheck->fUpdatable tells the result.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_CheckImage(
+	_In_	IfxLibConnection*	PpConnection,
+	_In_z_	const wchar_t*		PwszUpdateType,
+	_In_z_	const wchar_t*		PwszPath,
+	_Inout_	IfxLibImageCheck*	PpsCheck)
+{
+	if (NULL == PpConnection || PpConnection != s_pConnection || NULL == PwszUpdateType || NULL == PwszPath || NULL == PpsCheck)
+		return RC_E_BAD_PARAMETER;
+
+	return TPMFactoryUpdLib_ProceedUpdate(PpConnection, PwszUpdateType, PwszPath, TRUE, PpsCheck);
+}
+
+/**
+ *	@brief		Updates the TPM firmware
+ *	@details	Like the -update command line option. The TPM stays connected, but a TPM updated to another family or with
+ *				a restart required must be rebooted before further updates.
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PwszUpdateType		Update type of the -update command line option, e.g. tpm20-emptyplatformauth
+ *	@param		PwszPath			Firmware image path, the configuration file path for the config-file update type
+ *	@param		PfnProgress			Progress callback, may be NULL
+ *	@param		PpvContext			Context handed over to the progress callback
+ *	@param		PpsCheck			Receives the result of the firmware image check, may be NULL
+ *	@retval		0					The TPM has been updated or already runs the firmware of the image.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_Update(
+	_In_		IfxLibConnection*						PpConnection,
+	_In_z_		const wchar_t*							PwszUpdateType,
+	_In_z_		const wchar_t*							PwszPath,
+	_In_opt_	PFN_TPMFACTORYUPDLIB_PROGRESSCALLBACK	PfnProgress,
+	_In_opt_	void*									PpvContext,
+	_Inout_opt_	IfxLibImageCheck*						PpsCheck)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+
+	if (NULL == PpConnection || PpConnection != s_pConnection || NULL == PwszUpdateType || NULL == PwszPath)
+		return RC_E_BAD_PARAMETER;
+
+	Response_SetProgressHook(PfnProgress, PpvContext);
+	unReturnValue = TPMFactoryUpdLib_ProceedUpdate(PpConnection, PwszUpdateType, PwszPath, FALSE, PpsCheck);
+	Response_SetProgressHook(NULL, NULL);
+
+	return unReturnValue;
+}
+
+/**
+ *	@brief		Disconnects from the TPM and closes the connection
+ *	@details	A TPM2.0 started up by the library is shut down orderly before. The log file is closed.
+ *
+ *	@param		PppConnection		Pointer to the connection. Set to NULL on return.
+ *	@retval		0					The operation completed successfully.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_Disconnect(
+	_Inout_ IfxLibConnection** PppConnection)
+{
+	unsigned int unReturnValue = RC_E_FAIL;
+	IfxSession* pPreviousSession = NULL;
+
+	if (NULL == PppConnection || NULL == *PppConnection || *PppConnection != s_pConnection)
+		return RC_E_BAD_PARAMETER;
+	pPreviousSession = TPMFactoryUpdLib_Bind(*PppConnection);
+
+	LOGGING_WRITE_LEVEL4(LOGGING_METHOD_ENTRY_STRING);
+
+	// The next connection may be a different TPM
+	CommandFlow_TpmInfo_KeepCacheInMemory(FALSE);
+	unReturnValue = Controller_Uninitialize();
+	LOGGING_WRITE_LEVEL1(L"Library connection closed.");
+
+	LOGGING_WRITE_LEVEL4_FMT(LOGGING_METHOD_EXIT_STRING_RET_VAL, unReturnValue);
+
+	// Write all buffered log messages and close the log file
+	unReturnValue = TPMFactoryUpdLib_Unbind(pPreviousSession, unReturnValue);
+	Logging_Close();
+
+	Session_Release(&(*PppConnection)->pSession);
+	Platform_MemoryFree((void**)PppConnection);
+	s_pConnection = NULL;
+
+	return unReturnValue;
+}
@@ -0,0 +1,212 @@
+﻿/**
+ *	@brief		Declares the C API of the TPMFactoryUpd library
+ *	@details	The library libtpmfactoryupd.so ("make lib") runs the info, check and update commands of TPMFactoryUpd in the
+ *				process of an application. A connection keeps the TPM connected and the TPM information cached between the
+ *				calls, like the service mode. The header is self-contained, the return codes are the error codes of the tool
+ *				(0 for success, see the returnCode of the -json result document).
+ *
+ *				The library keeps process-wide state besides the session context of a connection, so only one connection
+ *				can be open at a time and the functions must not be called concurrently.
+ *	@file		TPMFactoryUpdLib.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <wchar.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Version of the C API, incremented for incompatible changes
+#define TPMFACTORYUPDLIB_API_VERSION	1
+
+/// Marks the functions exported by the shared library
+#if defined(__GNUC__)
+#define TPMFACTORYUPDLIB_API __attribute__((visibility("default")))
+#else
+#define TPMFACTORYUPDLIB_API
+#endif
+
+/// Maximum length of the version strings including the zero termination
+#define TPMFACTORYUPDLIB_MAX_VERSION	256
+
+/// TPM attributes of IfxLibTpmInfo
+/// The TPM is in invalid firmware mode because a previous update was interrupted
+#define TPMFACTORYUPDLIB_ATTRIBUTE_BOOT_LOADER				0x00000001
+/// The TPM is manufactured by Infineon but not supported by the tool
+#define TPMFACTORYUPDLIB_ATTRIBUTE_UNSUPPORTED_CHIP			0x00000002
+/// The TPM1.2 has an owner
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_OWNER				0x00000004
+/// The TPM1.2 is enabled
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_ENABLED			0x00000008
+/// The TPM1.2 is activated
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_ACTIVATED			0x00000010
+/// The TPM1.2 is in self-test failed mode
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM12_FAILED_SELFTEST	0x00000020
+/// A reboot is required so that the TPM2.0 reaches functional state
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_RESTART_REQUIRED	0x00000040
+/// The platform hierarchy of the TPM2.0 is disabled
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_PH_DISABLED		0x00000080
+/// The platformAuth of the TPM2.0 is the empty buffer
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_EMPTY_PLATFORMAUTH	0x00000100
+/// The TPM2.0 is in failure mode
+#define TPMFACTORYUPDLIB_ATTRIBUTE_TPM20_FAILURE_MODE		0x00000200
+
+/// Connection to a TPM, opaque to the application
+typedef struct tdIfxLibConnection IfxLibConnection;
+
+/**
+ *	@brief		TPM information returned by TPMFactoryUpdLib_GetInfo
+ *	@details	unSize must be set to sizeof(IfxLibTpmInfo) by the application.
+ */
+typedef struct tdIfxLibTpmInfo
+{
+	/// Size of the structure
+	unsigned int	unSize;
+	/// TPM family: 12 for TPM1.2, 20 for TPM2.0, 0 if unknown
+	unsigned int	unFamily;
+	/// Firmware version, e.g. "7.85.4555.0"
+	wchar_t			wszVersion[TPMFACTORYUPDLIB_MAX_VERSION];
+	/// Number of remaining firmware updates
+	unsigned int	unRemainingUpdates;
+	/// TPM attributes (TPMFACTORYUPDLIB_ATTRIBUTE_*)
+	unsigned int	unAttributes;
+} IfxLibTpmInfo;
+
+/**
+ *	@brief		Result of the firmware image check returned by TPMFactoryUpdLib_CheckImage and TPMFactoryUpdLib_Update
+ *	@details	unSize must be set to sizeof(IfxLibImageCheck) by the application.
+ */
+typedef struct tdIfxLibImageCheck
+{
+	/// Size of the structure
+	unsigned int		unSize;
+	/// Nonzero if the TPM can be updated with the firmware image
+	int					fUpdatable;
+	/// Nonzero if the TPM already runs the firmware of the image
+	int					fUpToDate;
+	/// Error code why the TPM cannot be updated with the firmware image, 0 if it can
+	unsigned int		unErrorDetails;
+	/// TPM family of the firmware image: 12 for TPM1.2, 20 for TPM2.0, 0 if unknown
+	unsigned int		unNewFamily;
+	/// Firmware version of the image
+	wchar_t				wszNewVersion[TPMFACTORYUPDLIB_MAX_VERSION];
+	/// Nonzero if the update resets the TPM to factory defaults
+	int					fFactoryDefaults;
+	/// Predicted duration of the update in microseconds, 0 if not predicted
+	unsigned long long	ullPredictedDuration;
+} IfxLibImageCheck;
+
+/**
+ *	@brief		Progress callback of TPMFactoryUpdLib_Update
+ *	@details	Called whenever the completion of the update changes.
+ *
+ *	@param		PpvContext		Context given to TPMFactoryUpdLib_Update
+ *	@param		PunCompletion	Progress completion value between 1 and 100
+ */
+typedef void (*PFN_TPMFACTORYUPDLIB_PROGRESSCALLBACK)(
+	void* PpvContext,
+	unsigned int PunCompletion);
+
+/**
+ *	@brief		Connects to the TPM
+ *	@details	Reads the configuration file TPMFactoryUpd.cfg of the working directory, parses the options like the
+ *				command line of the tool and connects to the TPM.
+ *
+ *	@param		PnOptionCount		Number of options
+ *	@param		PrgwszOptions		Command line options of the connection and logging, e.g. -access-mode 3 /dev/tpm0 -log.
+ *									May be NULL if PnOptionCount is 0.
+ *	@param		PppConnection		Receives the connection, must be closed with TPMFactoryUpdLib_Disconnect
+ *	@retval		0					The TPM has been connected.
+ *	@retval		...					Error code of the tool, e.g. RC_E_ALREADY_CONNECTED if a connection is open already.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_Connect(
+	int PnOptionCount,
+	const wchar_t* const PrgwszOptions[],
+	IfxLibConnection** PppConnection);
+
+/**
+ *	@brief		Returns the TPM information
+ *	@details	Like the -info command line option. The information is cached until an update changes it.
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PpsInfo				Receives the TPM information
+ *	@retval		0					The operation completed successfully.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_GetInfo(
+	IfxLibConnection* PpConnection,
+	IfxLibTpmInfo* PpsInfo);
+
+/**
+ *	@brief		Checks if the TPM can be updated with a firmware image
+ *	@details	Like the check request of the service mode. Nothing is changed on the TPM.
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PwszUpdateType		Update type of the -update command line option, e.g. tpm20-emptyplatformauth
+ *	@param		PwszPath			Firmware image path, the configuration file path for the config-file update type
+ *	@param		PpsCheck			Receives the result of the check
+ *	@retval		0					The operation completed successfully. PpsCheck->fUpdatable tells the result.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_CheckImage(
+	IfxLibConnection* PpConnection,
+	const wchar_t* PwszUpdateType,
+	const wchar_t* PwszPath,
+	IfxLibImageCheck* PpsCheck);
+
+/**
+ *	@brief		Updates the TPM firmware
+ *	@details	Like the -update command line option. The TPM stays connected, but a TPM updated to another family or with
+ *				a restart required must be rebooted before further updates.
+ *
+ *	@param		PpConnection		Connection
+ *	@param		PwszUpdateType		Update type of the -update command line option, e.g. tpm20-emptyplatformauth
+ *	@param		PwszPath			Firmware image path, the configuration file path for the config-file update type
+ *	@param		PfnProgress			Progress callback, may be NULL
+ *	@param		PpvContext			Context handed over to the progress callback
+ *	@param		PpsCheck			Receives the result of the firmware image check, may be NULL
+ *	@retval		0					The TPM has been updated or already runs the firmware of the image.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_Update(
+	IfxLibConnection* PpConnection,
+	const wchar_t* PwszUpdateType,
+	const wchar_t* PwszPath,
+	PFN_TPMFACTORYUPDLIB_PROGRESSCALLBACK PfnProgress,
+	void* PpvContext,
+	IfxLibImageCheck* PpsCheck);
+
+/**
+ *	@brief		Disconnects from the TPM and closes the connection
+ *	@details	A TPM2.0 started up by the library is shut down orderly before. The log file is closed.
+ *
+ *	@param		PppConnection		Pointer to the connection. Set to NULL on return.
+ *	@retval		0					The operation completed successfully.
+ *	@retval		...					Error code of the tool.
+ */
+TPMFACTORYUPDLIB_API
+unsigned int
+TPMFactoryUpdLib_Disconnect(
+	IfxLibConnection** PppConnection);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,252 @@
+﻿/**
+ *	@brief		Declares the header-only C++ API of the TPMFactoryUpd library
+ *	@details	Inline wrappers over the C API of TPMFactoryUpdLib.h: a move-only connection which is closed by its
+ *				destructor, typed results of the info, check and update commands and a progress callback taking any
+ *				callable. The wrappers only forward to the C API, the paths and options are handed over without being
+ *				copied or converted. Requires C++11 and linking with libtpmfactoryupd.so.
+ *
+ *				The rules of the C API apply: only one connection can be open at a time and the functions must not be
+ *				called concurrently. The wrappers throw no exceptions, each call returns the error code of the tool.
+ *	@file		TPMFactoryUpdLib.hpp
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "TPMFactoryUpdLib.h"
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace TPMFactoryUpd
+{
+
+/**
+ *	@brief		Result of a library call
+ *	@details	Holds the error code of the tool (0 for success) and the typed value, which is only valid on success.
+ */
+template <typename T>
+class Result
+{
+public:
+	Result(unsigned int PunReturnCode, T&& PValue) : m_unReturnCode(PunReturnCode), m_value(std::move(PValue)) {}
+
+	/// Error code of the tool, 0 for success
+	unsigned int ReturnCode() const { return m_unReturnCode; }
+	/// True if the call succeeded
+	explicit operator bool() const { return 0 == m_unReturnCode; }
+
+	/// Typed value of the call
+	T& Value() & { return m_value; }
+	const T& Value() const & { return m_value; }
+	T&& Value() && { return std::move(m_value); }
+	T* operator->() { return &m_value; }
+	const T* operator->() const { return &m_value; }
+
+private:
+	/// Error code of the tool
+	unsigned int m_unReturnCode;
+	/// Typed value of the call
+	T m_value;
+};
+
+/**
+ *	@brief		TPM information returned by Connection::GetInfo
+ */
+class TpmInfo
+{
+public:
+	TpmInfo() : m_sInfo() { m_sInfo.unSize = sizeof(m_sInfo); }
+
+	/// TPM family: 12 for TPM1.2, 20 for TPM2.0, 0 if unknown
+	unsigned int Family() const { return m_sInfo.unFamily; }
+	/// Firmware version, e.g. "7.85.4555.0"
+	const wchar_t* Version() const { return m_sInfo.wszVersion; }
+	/// Number of remaining firmware updates
+	unsigned int RemainingUpdates() const { return m_sInfo.unRemainingUpdates; }
+	/// TPM attributes (TPMFACTORYUPDLIB_ATTRIBUTE_*)
+	unsigned int Attributes() const { return m_sInfo.unAttributes; }
+	/// True if all given TPM attributes (TPMFACTORYUPDLIB_ATTRIBUTE_*) are set
+	bool HasAttributes(unsigned int PunAttributes) const { return PunAttributes == (m_sInfo.unAttributes & PunAttributes); }
+	/// True if the TPM is in invalid firmware mode because a previous update was interrupted
+	bool IsBootLoader() const { return HasAttributes(TPMFACTORYUPDLIB_ATTRIBUTE_BOOT_LOADER); }
+
+	/// Structure of the C API
+	const IfxLibTpmInfo& Native() const { return m_sInfo; }
+	IfxLibTpmInfo* Native() { return &m_sInfo; }
+
+private:
+	/// Structure filled by TPMFactoryUpdLib_GetInfo
+	IfxLibTpmInfo m_sInfo;
+};
+
+/**
+ *	@brief		Result of the firmware image check returned by Connection::CheckImage and Connection::Update
+ */
+class ImageCheck
+{
+public:
+	ImageCheck() : m_sCheck() { m_sCheck.unSize = sizeof(m_sCheck); }
+
+	/// True if the TPM can be updated with the firmware image
+	bool IsUpdatable() const { return 0 != m_sCheck.fUpdatable; }
+	/// True if the TPM already runs the firmware of the image
+	bool IsUpToDate() const { return 0 != m_sCheck.fUpToDate; }
+	/// Error code why the TPM cannot be updated with the firmware image, 0 if it can
+	unsigned int ErrorDetails() const { return m_sCheck.unErrorDetails; }
+	/// TPM family of the firmware image: 12 for TPM1.2, 20 for TPM2.0, 0 if unknown
+	unsigned int NewFamily() const { return m_sCheck.unNewFamily; }
+	/// Firmware version of the image
+	const wchar_t* NewVersion() const { return m_sCheck.wszNewVersion; }
+	/// True if the update resets the TPM to factory defaults
+	bool IsFactoryDefaults() const { return 0 != m_sCheck.fFactoryDefaults; }
+	/// Predicted duration of the update, 0 if not predicted
+	std::chrono::microseconds PredictedDuration() const { return std::chrono::microseconds(m_sCheck.ullPredictedDuration); }
+
+	/// Structure of the C API
+	const IfxLibImageCheck& Native() const { return m_sCheck; }
+	IfxLibImageCheck* Native() { return &m_sCheck; }
+
+private:
+	/// Structure filled by TPMFactoryUpdLib_CheckImage and TPMFactoryUpdLib_Update
+	IfxLibImageCheck m_sCheck;
+};
+
+/**
+ *	@brief		Connection to a TPM
+ *	@details	Move-only, the destructor disconnects from the TPM. A default constructed or moved-from connection is not
+ *				connected.
+ */
+class Connection
+{
+public:
+	Connection() : m_pConnection(nullptr) {}
+	Connection(Connection&& PConnection) noexcept : m_pConnection(PConnection.m_pConnection) { PConnection.m_pConnection = nullptr; }
+	Connection& operator=(Connection&& PConnection) noexcept
+	{
+		if (this != &PConnection)
+		{
+			Disconnect();
+			m_pConnection = PConnection.m_pConnection;
+			PConnection.m_pConnection = nullptr;
+		}
+		return *this;
+	}
+	Connection(const Connection&) = delete;
+	Connection& operator=(const Connection&) = delete;
+	~Connection() { Disconnect(); }
+
+	/**
+	 *	@brief		Connects to the TPM, see TPMFactoryUpdLib_Connect
+	 *
+	 *	@param		PnOptionCount		Number of options
+	 *	@param		PrgwszOptions		Command line options of the connection and logging, e.g. -access-mode 3 /dev/tpm0 -log
+	 *	@returns	The connection, connected if the error code is 0
+	 */
+	static Result<Connection> Connect(int PnOptionCount, const wchar_t* const PrgwszOptions[])
+	{
+		IfxLibConnection* pConnection = nullptr;
+		unsigned int unReturnCode = TPMFactoryUpdLib_Connect(PnOptionCount, PrgwszOptions, &pConnection);
+		return Result<Connection>(unReturnCode, Connection(pConnection));
+	}
+	static Result<Connection> Connect(std::initializer_list<const wchar_t*> PlistOptions)
+	{
+		return Connect(static_cast<int>(PlistOptions.size()), PlistOptions.begin());
+	}
+
+	/// True if the TPM is connected
+	bool IsConnected() const { return nullptr != m_pConnection; }
+
+	/// Returns the TPM information, see TPMFactoryUpdLib_GetInfo
+	Result<TpmInfo> GetInfo()
+	{
+		TpmInfo info;
+		unsigned int unReturnCode = TPMFactoryUpdLib_GetInfo(m_pConnection, info.Native());
+		return Result<TpmInfo>(unReturnCode, std::move(info));
+	}
+
+	/// Checks if the TPM can be updated with a firmware image, see TPMFactoryUpdLib_CheckImage
+	Result<ImageCheck> CheckImage(const wchar_t* PwszUpdateType, const wchar_t* PwszPath)
+	{
+		ImageCheck check;
+		unsigned int unReturnCode = TPMFactoryUpdLib_CheckImage(m_pConnection, PwszUpdateType, PwszPath, check.Native());
+		return Result<ImageCheck>(unReturnCode, std::move(check));
+	}
+	Result<ImageCheck> CheckImage(const std::wstring& PwstrUpdateType, const std::wstring& PwstrPath)
+	{
+		return CheckImage(PwstrUpdateType.c_str(), PwstrPath.c_str());
+	}
+
+	/// Updates the TPM firmware without progress callback, see TPMFactoryUpdLib_Update
+	Result<ImageCheck> Update(const wchar_t* PwszUpdateType, const wchar_t* PwszPath)
+	{
+		ImageCheck check;
+		unsigned int unReturnCode = TPMFactoryUpdLib_Update(m_pConnection, PwszUpdateType, PwszPath, nullptr, nullptr, check.Native());
+		return Result<ImageCheck>(unReturnCode, std::move(check));
+	}
+	Result<ImageCheck> Update(const std::wstring& PwstrUpdateType, const std::wstring& PwstrPath)
+	{
+		return Update(PwstrUpdateType.c_str(), PwstrPath.c_str());
+	}
+
+	/**
+	 *	@brief		Updates the TPM firmware, see TPMFactoryUpdLib_Update
+	 *	@details	The progress callback is any callable taking the completion value between 1 and 100, e.g. a lambda with
+	 *				captures. It is called on the calling thread and must not throw, an exception terminates the program.
+	 *
+	 *	@param		PwszUpdateType		Update type of the -update command line option, e.g. tpm20-emptyplatformauth
+	 *	@param		PwszPath			Firmware image path, the configuration file path for the config-file update type
+	 *	@param		PfnProgress			Progress callback
+	 *	@returns	The result of the firmware image check, the error code is 0 if the TPM has been updated or already
+	 *				runs the firmware of the image
+	 */
+	template <typename TProgress>
+	Result<ImageCheck> Update(const wchar_t* PwszUpdateType, const wchar_t* PwszPath, TProgress&& PfnProgress)
+	{
+		typedef typename std::remove_reference<TProgress>::type TCallable;
+		ImageCheck check;
+		unsigned int unReturnCode = TPMFactoryUpdLib_Update(
+										m_pConnection, PwszUpdateType, PwszPath, &Connection::OnProgress<TCallable>,
+										const_cast<void*>(static_cast<const volatile void*>(&PfnProgress)), check.Native());
+		return Result<ImageCheck>(unReturnCode, std::move(check));
+	}
+	template <typename TProgress>
+	Result<ImageCheck> Update(const std::wstring& PwstrUpdateType, const std::wstring& PwstrPath, TProgress&& PfnProgress)
+	{
+		return Update(PwstrUpdateType.c_str(), PwstrPath.c_str(), std::forward<TProgress>(PfnProgress));
+	}
+
+	/// Disconnects from the TPM, see TPMFactoryUpdLib_Disconnect. Returns 0 if the TPM is not connected.
+	unsigned int Disconnect() noexcept
+	{
+		return nullptr != m_pConnection ? TPMFactoryUpdLib_Disconnect(&m_pConnection) : 0;
+	}
+
+	/// Connection of the C API
+	IfxLibConnection* Native() const { return m_pConnection; }
+
+private:
+	explicit Connection(IfxLibConnection* PpConnection) : m_pConnection(PpConnection) {}
+
+	/// Progress callback of the C API, forwards to the callable given to Update
+	template <typename TCallable>
+	static void OnProgress(void* PpvContext, unsigned int PunCompletion) noexcept
+	{
+		(*static_cast<TCallable*>(PpvContext))(PunCompletion);
+	}
+
+	/// Connection of the C API, nullptr if not connected
+	IfxLibConnection* m_pConnection;
+};
+
+} // namespace TPMFactoryUpd
@@ -24,6 +24,8 @@ extern "C" {
 
 /// Default configuration file name
 #define CONFIG_FILE L"TPMFactoryUpd.cfg"
+/// Snapshot of the settings parsed from the configuration file and the command line (cleared on reboot)
+#define CONFIG_SNAPSHOT_FILE L"/run/TPMFactoryUpd_Settings.bin"
 
 /**
  *	@brief		Enum for generic structure types used by Infineon TPM2 tools
@@ -38,7 +40,15 @@ typedef enum td_ENUM_STRUCT_TYPES
 	/// Structure tdTpmUpdate
 	STRUCT_TYPE_TpmUpdate,
 	/// Structure tdTpm12ClearOwnership
-	STRUCT_TYPE_Tpm12ClearOwnership
+	STRUCT_TYPE_Tpm12ClearOwnership,
+	/// Structure tdIfxBenchmark
+	STRUCT_TYPE_Benchmark,
+	/// Structure tdIfxCheckImages
+	STRUCT_TYPE_CheckImages,
+	/// Structure tdIfxDecodeCapture
+	STRUCT_TYPE_DecodeCapture,
+	/// Structure tdIfxBuildFrames
+	STRUCT_TYPE_BuildFrames
 } ENUM_STRUCT_TYPES;
 
 /**
@@ -105,6 +115,33 @@ typedef struct tdIfxToolHeader
 
 #define IfxTpm12ClearOwnership IfxToolHeader
 
+/**
+ *	@brief		Structure for the duration of each phase of a command
+ *	@details	All times are given in microseconds and are measured with the monotonic clock. A phase which was not
+ *				executed has the duration zero.
+ */
+typedef struct tdIfxPhaseTimings
+{
+	/// Time to parse the command line
+	unsigned long long		ullCommandLineTime;
+	/// Time to parse the configuration file and the update configuration file
+	unsigned long long		ullConfigTime;
+	/// Time to connect to the TPM
+	unsigned long long		ullConnectTime;
+	/// Time to probe the TPM state
+	unsigned long long		ullStateTime;
+	/// Time to load the firmware image and to check it against the TPM
+	unsigned long long		ullImageTime;
+	/// Time to prepare the policy session or the TPM Ownership
+	unsigned long long		ullPrepareTime;
+	/// Time of FieldUpgradeStart
+	unsigned long long		ullStartTime;
+	/// Time to transfer the firmware blocks
+	unsigned long long		ullTransferTime;
+	/// Time of FieldUpgradeComplete
+	unsigned long long		ullCompleteTime;
+} IfxPhaseTimings;
+
 /**
  *	@brief		Structure for TPM Info utilizing generic structure IfxToolHeader
  *	@details
@@ -123,6 +160,14 @@ typedef struct tdIfxInfo
 	TPM_STATE				sTpmState;
 	/// Number of remaining updates
 	unsigned int			unRemainingUpdates;
+	/// Queried fields of the TPM information (TPM_INFO_FIELD_*)
+	unsigned int			unFields;
+	/// Duration of the command phases
+	IfxPhaseTimings			sTimings;
+	/// Host CPU time of the command phases
+	IfxPhaseTimings			sCpuTimings;
+	/// Time of the command phases spent sleeping or blocked while waiting for the TPM
+	IfxPhaseTimings			sWaitTimings;
 } IfxInfo;
 
 /**
@@ -143,6 +188,14 @@ typedef struct tdIfxUpdate
 	TPM_STATE						sTpmState;
 	/// Number of remaining updates
 	unsigned int					unRemainingUpdates;
+	/// Queried fields of the TPM information (TPM_INFO_FIELD_*)
+	unsigned int					unFields;
+	/// Duration of the command phases
+	IfxPhaseTimings					sTimings;
+	/// Host CPU time of the command phases
+	IfxPhaseTimings					sCpuTimings;
+	/// Time of the command phases spent sleeping or blocked while waiting for the TPM
+	IfxPhaseTimings					sWaitTimings;
 	/// SubType of the structure
 	ENUM_STRUCT_SUBTYPES			unSubType;
 	/// Whether the new firmware image is valid
@@ -157,16 +210,276 @@ typedef struct tdIfxUpdate
 	BYTE							bTargetFamily;
 	/// FirmwareImage size
 	unsigned int					unFirmwareImageSize;
-	/// FirmwareImage pointer. The allocated memory must be freed after usage.
+	/// FirmwareImage pointer. Points to rgbFirmwareFile or into it in case of a firmware image bundle, or to the image
+	/// reassembled from a chunked bundle (see FirmwareImage_ReleaseBundleImage).
 	BYTE*							rgbFirmwareImage;
+	/// Size of the loaded firmware image file or firmware image bundle file
+	unsigned int					unFirmwareFileSize;
+	/// Loaded firmware image file or firmware image bundle file. The buffer must be released with FileIO_ReleaseFileBuffer after usage.
+	BYTE*							rgbFirmwareFile;
+	/// Whether rgbFirmwareFile is a read-only file mapping instead of an allocated buffer
+	BOOL							fFirmwareImageMapped;
+	/// Whether rgbFirmwareFile is mapped from the shared image region of a concurrent process (see -verify-cache)
+	BOOL							fFirmwareImageShared;
+	/// Whether sFirmwareImage holds the unmarshalled rgbFirmwareImage
+	BOOL							fFirmwareImageParsed;
+	/// FirmwareImage unmarshalled once after loading; its buffers point into rgbFirmwareImage
+	IfxFirmwareImage				sFirmwareImage;
+	/// SHA-256 digests of the leaves of the verified firmware block, each leaf is checked while the transfer streams it
+	/// from the file. Allocated, must be released with Platform_MemoryFree. NULL if the firmware block is not streamed.
+	BYTE*							rgbStreamLeafDigests;
+	/// Number of digests in rgbStreamLeafDigests
+	unsigned int					unStreamLeafCount;
 	/// TPM2.0 Policy session handle
 	TPMI_SH_AUTH_SESSION			hPolicySession;
 	/// New firmware valid state
 	ENUM_GENERIC_TRISTATE			unNewFirmwareValid;
 	/// Used firmware image
 	wchar_t							wszUsedFirmwareImage[MAX_NAME];
+	/// Predicted duration of the preparation and the firmware update in microseconds, zero if not predicted
+	unsigned long long				ullPredictedDuration;
+	/// Number of firmware blocks of the transfer, zero if no transfer was started
+	unsigned int					unBlockCount;
+	/// Number of firmware blocks resent after a transient transport error
+	unsigned int					unResentBlockCount;
 } IfxUpdate;
 
+/// Maximum number of microbenchmarks run by the -benchmark command line option
+#define BENCHMARK_MAX_MICRO_ENTRIES 32
+
+/**
+ *	@brief		Structure for the result of a single microbenchmark
+ *	@details
+ */
+typedef struct tdIfxBenchmarkMicroEntry
+{
+	/// Name of the measured type, command or function
+	const wchar_t*			wszName;
+	/// Return code of the last iteration
+	unsigned int			unReturnCode;
+	/// Average time of one operation in nanoseconds
+	unsigned long long		ullNanoSecondsPerOperation;
+	/// Number of heap allocations of all iterations
+	unsigned long long		ullAllocations;
+} IfxBenchmarkMicroEntry;
+
+/**
+ *	@brief		Structure for the benchmark results utilizing generic structure IfxToolHeader
+ *	@details	All times are given in microseconds.
+ */
+typedef struct tdIfxBenchmark
+{
+	/// Type of structure according to ENUM_STRUCT_TYPES
+	ENUM_STRUCT_TYPES		unType;
+	/// Size of complete structure
+	unsigned int			unSize;
+	/// Return code of the firmware update
+	unsigned int			unReturnCode;
+	/// Size of the firmware image file
+	unsigned int			unFirmwareImageSize;
+	/// Number of firmware blocks sent to the simulated TPM
+	unsigned int			unBlockCount;
+	/// Number of TPM commands answered by the simulated TPM
+	unsigned int			unCommandCount;
+	/// Time to read the firmware image file
+	unsigned long long		ullLoadTime;
+	/// Time to unmarshal the firmware image
+	unsigned long long		ullUnmarshalTime;
+	/// Time to probe the TPM state
+	unsigned long long		ullProbeTime;
+	/// Time to check the firmware image against the TPM
+	unsigned long long		ullCheckTime;
+	/// Time from the start of the update until the first firmware block was sent (includes the per-block request marshalling)
+	unsigned long long		ullStartTime;
+	/// Time from the first until the last firmware block was answered
+	unsigned long long		ullTransferTime;
+	/// Time after the last firmware block until the update completed
+	unsigned long long		ullCompleteTime;
+	/// Number of iterations of each microbenchmark
+	unsigned int			unMicroIterations;
+	/// Number of valid entries in rgsMicro
+	unsigned int			unMicroCount;
+	/// Results of the microbenchmarks
+	IfxBenchmarkMicroEntry	rgsMicro[BENCHMARK_MAX_MICRO_ENTRIES];
+} IfxBenchmark;
+
+/// Maximum number of firmware images evaluated by the -check-images command line option
+#define CHECK_IMAGES_MAX_ENTRIES 64
+
+/**
+ *	@brief		Structure for the result of a single firmware image of the -check-images command line option
+ *	@details
+ */
+typedef struct tdIfxCheckImagesEntry
+{
+	/// File name of the firmware image, for firmware image bundles followed by the index of the firmware image in the bundle
+	wchar_t							wszName[MAX_NAME];
+	/// Firmware version of the firmware image or an empty string if the firmware image cannot be parsed
+	wchar_t							wszTargetVersion[MAX_NAME];
+	/// TPM family of the firmware image
+	BYTE							bTargetFamily;
+	/// Whether the firmware image is applicable to the TPM
+	BOOL							fValid;
+	/// Info about the firmware image
+	BITFIELD_NEW_TPM_FIRMWARE_INFO	bfNewTpmFirmwareInfo;
+	/// Reason why the firmware image is not applicable (error details or return code of FirmwareUpdate_CheckImage) or RC_SUCCESS
+	unsigned int					unErrorDetails;
+} IfxCheckImagesEntry;
+
+/**
+ *	@brief		Structure for the -check-images command line option utilizing generic structure IfxToolHeader
+ *	@details	The TPM is probed once, all firmware images are checked against this state.
+ */
+typedef struct tdIfxCheckImages
+{
+	/// Type of structure according to ENUM_STRUCT_TYPES
+	ENUM_STRUCT_TYPES		unType;
+	/// Size of complete structure
+	unsigned int			unSize;
+	/// RC_SUCCESS if at least one firmware image is applicable to the TPM
+	unsigned int			unReturnCode;
+	/// TPM state
+	TPM_STATE				sTpmState;
+	/// TPM firmware version
+	wchar_t					wszFirmwareVersion[MAX_NAME];
+	/// Number of remaining updates or REMAINING_UPDATES_UNAVAILABLE
+	unsigned int			unRemainingUpdates;
+	/// Number of valid entries in rgsEntries
+	unsigned int			unEntryCount;
+	/// Number of firmware images skipped because rgsEntries is full
+	unsigned int			unSkippedCount;
+	/// Results of the firmware images
+	IfxCheckImagesEntry		rgsEntries[CHECK_IMAGES_MAX_ENTRIES];
+} IfxCheckImages;
+
+/**
+ *	@brief		Structure for a single TPM command of a TPM capture file
+ *	@details	The request and response pointers point into the capture file buffer.
+ */
+typedef struct tdIfxCaptureRecord
+{
+	/// Time stamp of the start of the command since the start of the capture in microseconds
+	unsigned long long		ullTimeStamp;
+	/// Duration of the command in microseconds
+	unsigned int			unDuration;
+	/// Return code of the transmission
+	unsigned int			unTransmitReturnCode;
+	/// TPM command ordinal or 0 if the request is too short
+	unsigned int			unCommandCode;
+	/// TPM command name or NULL if the command is unknown
+	const wchar_t*			pwszCommandName;
+	/// TRUE if the request is a TPM1.2 command, FALSE for TPM2.0
+	BOOL					fTpm12;
+	/// TRUE if the response is long enough to hold a response code
+	BOOL					fResponseCode;
+	/// TPM response code
+	unsigned int			unResponseCode;
+	/// Size of the request in bytes
+	unsigned int			unRequestSize;
+	/// Request bytes
+	const BYTE*				rgbRequest;
+	/// Size of the response in bytes, 0 if the transmission failed
+	unsigned int			unResponseSize;
+	/// Response bytes
+	const BYTE*				rgbResponse;
+} IfxCaptureRecord;
+
+/**
+ *	@brief		Structure for the -decode-capture command line option utilizing generic structure IfxToolHeader
+ *	@details	The capture file buffer and the record table are released in Controller_Proceed.
+ */
+typedef struct tdIfxDecodeCapture
+{
+	/// Type of structure according to ENUM_STRUCT_TYPES
+	ENUM_STRUCT_TYPES		unType;
+	/// Size of complete structure
+	unsigned int			unSize;
+	/// Return code of the decoding
+	unsigned int			unReturnCode;
+	/// Capture file buffer
+	BYTE*					rgbCaptureFile;
+	/// Size of the capture file buffer
+	unsigned int			unCaptureFileSize;
+	/// Decoded TPM commands
+	IfxCaptureRecord*		rgsRecords;
+	/// Number of valid entries in rgsRecords
+	unsigned int			unRecordCount;
+	/// Number of bytes at the end of the capture file which do not form a complete record
+	unsigned int			unTruncatedSize;
+} IfxDecodeCapture;
+
+/**
+ *	@brief		Structure for the -build-frames command line option utilizing generic structure IfxToolHeader
+ *	@details
+ */
+typedef struct tdIfxBuildFrames
+{
+	/// Type of structure according to ENUM_STRUCT_TYPES
+	ENUM_STRUCT_TYPES		unType;
+	/// Size of complete structure
+	unsigned int			unSize;
+	/// Return code of the build
+	unsigned int			unReturnCode;
+	/// Path of the written frame file
+	wchar_t					wszFrameFile[MAX_PATH];
+	/// Source TPM family of the firmware image, DEVICE_TYPE_TPM_12 or DEVICE_TYPE_TPM_20
+	BYTE					bSourceTpmFamily;
+	/// Maximum data size of a firmware block the frames were built for
+	unsigned int			unMaxDataSize;
+	/// Number of frames
+	unsigned int			unFrameCount;
+	/// Size of the frame file
+	unsigned int			unFrameFileSize;
+} IfxBuildFrames;
+
+/// Magic value identifying a progress file ("IFXP")
+#define PROGRESS_FILE_MAGIC			0x50584649
+/// Layout version of IfxProgressRecord
+#define PROGRESS_FILE_VERSION		1
+
+/// Phases reported in the progress file
+#define PROGRESS_PHASE_PREPARE		1
+#define PROGRESS_PHASE_TRANSFER		2
+#define PROGRESS_PHASE_COMPLETE		3
+#define PROGRESS_PHASE_FINISHED		4
+
+/**
+ *	@brief		Record of the progress file written for the -progress-file command line option
+ *	@details	The record is updated in place during the update and uses the byte order of the host. unSequence is odd while
+ *				the record is written: a reader copies the record and retries if unSequence was odd or changed meanwhile.
+ */
+typedef struct tdIfxProgressRecord
+{
+	/// Magic value (PROGRESS_FILE_MAGIC)
+	unsigned int			unMagic;
+	/// Layout version (PROGRESS_FILE_VERSION)
+	unsigned int			unVersion;
+	/// Size of the record in bytes
+	unsigned int			unSize;
+	/// Sequence number, incremented before and after each update of the record
+	unsigned int			unSequence;
+	/// Update phase (PROGRESS_PHASE_*)
+	unsigned int			unPhase;
+	/// Progress completion value between 0 and 100
+	unsigned int			unCompletion;
+	/// Number of firmware blocks sent to the TPM
+	unsigned int			unBlocksSent;
+	/// Total number of firmware blocks, 0 before the transfer
+	unsigned int			unBlocksTotal;
+	/// Number of firmware bytes sent to the TPM
+	unsigned int			unBytesSent;
+	/// Total number of firmware bytes, 0 before the transfer
+	unsigned int			unBytesTotal;
+	/// Current transfer rate in bytes per second, 0 if unknown
+	unsigned int			unBytesPerSecond;
+	/// Final return code of the tool, only valid in PROGRESS_PHASE_FINISHED
+	unsigned int			unReturnCode;
+	/// Time in milliseconds since the update started
+	unsigned long long		ullElapsedTime;
+	/// Estimated time in milliseconds until all firmware blocks are sent, 0 if unknown
+	unsigned long long		ullEstimatedTimeRemaining;
+} IfxProgressRecord;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,62 @@
+﻿/**
+ *	@brief		Declares the entry point and the helpers of the libFuzzer harnesses
+ *	@details	Each harness feeds the fuzzer input to the unmarshal functions of one module. The first input byte selects the
+ *				function, the remaining bytes are the byte stream (the firmware image harness takes the whole input). The harnesses are built by "make fuzz".
+ *	@file		Fuzz.h
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+#pragma once
+
+#include "StdInclude.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	@brief		Runs the unmarshal function selected by the first input byte on the remaining bytes
+ *
+ *	@param		PrgbData			Fuzzer input
+ *	@param		PunSize				Size of the fuzzer input
+ *	@retval		0					Always, the input is processed completely.
+ */
+int
+LLVMFuzzerTestOneInput(
+	_In_bytecount_(PunSize)	const uint8_t*	PrgbData,
+	_In_					size_t			PunSize);
+
+/**
+ *	@brief		Copies the byte stream of the fuzzer input to a heap block of its exact size
+ *	@details	AddressSanitizer reports every read beyond the end of the returned block.
+ *
+ *	@param		PrgbData			Byte stream of the fuzzer input
+ *	@param		PunSize				Size of the byte stream
+ *	@retval		NULL				The byte stream is empty or too large for an INT32 size, or the allocation failed.
+ *	@retval		...					Copy of the byte stream, must be released with Fuzz_ReleaseInput.
+ */
+_Check_return_
+BYTE*
+Fuzz_CopyInput(
+	_In_bytecount_(PunSize)	const uint8_t*	PrgbData,
+	_In_					size_t			PunSize);
+
+/**
+ *	@brief		Releases a copy of the fuzzer input
+ *
+ *	@param		PpbCopy				Copy returned by Fuzz_CopyInput, may be NULL
+ */
+void
+Fuzz_ReleaseInput(
+	_In_opt_	BYTE*	PpbCopy);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,100 @@
+﻿/**
+ *	@brief		Implements the libFuzzer harness of the firmware image parser
+ *	@details	Parses the input as firmware image with FirmwareImage_Unmarshal and FirmwareImage_UnmarshalView including the
+ *				version strings, or as firmware image bundle with the table of contents and the images it references.
+ *	@file		Fuzz_FirmwareImage.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+
+#include "Fuzz.h"
+#include "FirmwareImage.h"
+
+/// Maximum number of bundle images parsed per input
+#define FUZZ_MAX_BUNDLE_IMAGES	16
+
+/**
+ *	@brief		Parses a firmware image byte stream with both unmarshal functions
+ *
+ *	@param		PrgbImage			Firmware image byte stream
+ *	@param		PunImageSize		Size of the firmware image byte stream
+ */
+static void
+Fuzz_ParseImage(
+	_In_bytecount_(PunImageSize)	BYTE*	PrgbImage,
+	_In_							UINT32	PunImageSize)
+{
+	static IfxFirmwareImage s_sImage;
+	static IfxFirmwareImageView s_sView;
+	BYTE* pbBuffer = PrgbImage;
+	INT32 nBufferSize = (INT32)PunImageSize;
+
+	IGNORE_RETURN_VALUE(FirmwareImage_Unmarshal(&s_sImage, &pbBuffer, &nBufferSize));
+
+	pbBuffer = PrgbImage;
+	nBufferSize = (INT32)PunImageSize;
+	if (RC_SUCCESS == FirmwareImage_UnmarshalView(&s_sView, &pbBuffer, &nBufferSize))
+	{
+		wchar_t wszVersion[64] = {0};
+		unsigned int unVersionSize = RG_LEN(wszVersion);
+		UINT16 usIndex = 0;
+
+		for (usIndex = 0; usIndex < s_sView.usSourceVersionsCount; usIndex++)
+		{
+			unVersionSize = RG_LEN(wszVersion);
+			IGNORE_RETURN_VALUE(FirmwareImage_GetSourceVersion(&s_sView, usIndex, wszVersion, &unVersionSize));
+		}
+		unVersionSize = RG_LEN(wszVersion);
+		IGNORE_RETURN_VALUE(FirmwareImage_GetTargetVersion(&s_sView, wszVersion, &unVersionSize));
+	}
+}
+
+/**
+ *	@brief		Parses the fuzzer input as firmware image or firmware image bundle
+ *	@details	Unlike the other harnesses the whole input is the byte stream, so firmware image files can be used as corpus.
+ *
+ *	@param		PrgbData			Fuzzer input
+ *	@param		PunSize				Size of the fuzzer input
+ *	@retval		0					Always, the input is processed completely.
+ */
+int
+LLVMFuzzerTestOneInput(
+	_In_bytecount_(PunSize)	const uint8_t*	PrgbData,
+	_In_					size_t			PunSize)
+{
+	BYTE* pbCopy = NULL;
+	UINT32 unSize = 0;
+
+	pbCopy = Fuzz_CopyInput(PrgbData, PunSize);
+	if (NULL == pbCopy)
+		return 0;
+	unSize = (UINT32)PunSize;
+
+	if (TRUE == FirmwareImage_IsBundle(pbCopy, unSize))
+	{
+		UINT16 usIndex = 0;
+		for (usIndex = 0; usIndex < FUZZ_MAX_BUNDLE_IMAGES; usIndex++)
+		{
+			BYTE* pbImage = NULL;
+			UINT32 unImageSize = 0;
+			if (RC_SUCCESS != FirmwareImage_GetBundleImage(pbCopy, unSize, usIndex, &pbImage, &unImageSize))
+				break;
+			Fuzz_ParseImage(pbImage, unImageSize);
+			FirmwareImage_ReleaseBundleImage(pbCopy, unSize, &pbImage);
+		}
+	}
+	else
+	{
+		Fuzz_ParseImage(pbCopy, unSize);
+	}
+
+	Fuzz_ReleaseInput(pbCopy);
+	return 0;
+}
@@ -0,0 +1,78 @@
+﻿/**
+ *	@brief		Implements the libFuzzer harness of the TPM2.0 field upgrade unmarshal functions
+ *	@details	Covers the vendor capabilities of the TPM and the policy parameter block of the firmware image
+ *				(TPM2_FieldUpgradeMarshal.c).
+ *	@file		Fuzz_TPM2_FieldUpgradeMarshal.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+
+#include "Fuzz.h"
+#include "TPM2_FieldUpgradeMarshal.h"
+
+/**
+ *	@brief		Runs the unmarshal function selected by the first input byte on the remaining bytes
+ *
+ *	@param		PrgbData			Fuzzer input
+ *	@param		PunSize				Size of the fuzzer input
+ *	@retval		0					Always, the input is processed completely.
+ */
+int
+LLVMFuzzerTestOneInput(
+	_In_bytecount_(PunSize)	const uint8_t*	PrgbData,
+	_In_					size_t			PunSize)
+{
+	static union
+	{
+		sSignedData_d sSignedData;
+		sSignedDataView_d sSignedDataView;
+		sSecurityModuleLogicInfo_d sSecurityModuleLogicInfo;
+		sSecurityModuleLogicInfo2_d sSecurityModuleLogicInfo2;
+		sFirmwarePackages_d sFirmwarePackages;
+		TPMS_VENDOR_CAPABILITY_DATA sVendorCapabilityData;
+	} s_uTarget;
+	BYTE* pbCopy = NULL;
+	BYTE* pbBuffer = NULL;
+	INT32 nBufferSize = 0;
+
+	if (PunSize < 1)
+		return 0;
+	pbCopy = Fuzz_CopyInput(PrgbData + 1, PunSize - 1);
+	if (NULL == pbCopy)
+		return 0;
+	pbBuffer = pbCopy;
+	nBufferSize = (INT32)(PunSize - 1);
+
+	switch (PrgbData[0] % 6)
+	{
+		case 0:
+			IGNORE_RETURN_VALUE(TSS_sSignedData_d_Unmarshal(&s_uTarget.sSignedData, &pbBuffer, &nBufferSize));
+			break;
+		case 1:
+			IGNORE_RETURN_VALUE(TSS_sSignedData_d_UnmarshalView(&s_uTarget.sSignedDataView, &pbBuffer, &nBufferSize));
+			break;
+		case 2:
+			IGNORE_RETURN_VALUE(TSS_sSecurityModuleLogicInfo_d_Unmarshal(&s_uTarget.sSecurityModuleLogicInfo, &pbBuffer, &nBufferSize));
+			break;
+		case 3:
+			IGNORE_RETURN_VALUE(TSS_sSecurityModuleLogicInfo2_d_Unmarshal(&s_uTarget.sSecurityModuleLogicInfo2, &pbBuffer, &nBufferSize));
+			break;
+		case 4:
+			IGNORE_RETURN_VALUE(TSS_sFirmwarePackages_d_Unmarshal(&s_uTarget.sFirmwarePackages, &pbBuffer, &nBufferSize));
+			break;
+		default:
+			// Like FirmwareUpdate_GetTpm20SecurityModuleLogicInfo2, the vendor data is held by a TPMS_VENDOR_CAPABILITY_DATA
+			IGNORE_RETURN_VALUE(TSS_TPMU_VENDOR_CAPABILITY_Unmarshal((TPMU_CAPABILITIES*)&s_uTarget.sVendorCapabilityData.data, &pbBuffer, &nBufferSize));
+			break;
+	}
+
+	Fuzz_ReleaseInput(pbCopy);
+	return 0;
+}
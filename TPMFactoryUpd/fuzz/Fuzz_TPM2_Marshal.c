@@ -0,0 +1,85 @@
+﻿/**
+ *	@brief		Implements the libFuzzer harness of the TPM2.0 unmarshal functions
+ *	@details	Covers the structures of the TPM2.0 responses parsed by the tool (TPM2_Marshal.c). The nested structures are
+ *				reached through the structures containing them.
+ *	@file		Fuzz_TPM2_Marshal.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+
+#include "Fuzz.h"
+#include "TPM2_Marshal.h"
+
+/**
+ *	@brief		Runs the unmarshal function selected by the first input byte on the remaining bytes
+ *
+ *	@param		PrgbData			Fuzzer input
+ *	@param		PunSize				Size of the fuzzer input
+ *	@retval		0					Always, the input is processed completely.
+ */
+int
+LLVMFuzzerTestOneInput(
+	_In_bytecount_(PunSize)	const uint8_t*	PrgbData,
+	_In_					size_t			PunSize)
+{
+	static union
+	{
+		TPM_RC responseCode;
+		TPMS_CAPABILITY_DATA sCapabilityData;
+		TPM2B_MAX_BUFFER sMaxBuffer;
+		TPM2B_DIGEST sDigest;
+		TPM2B_NONCE sNonce;
+		TPMT_TK_AUTH sTicket;
+		TPML_PCR_SELECTION sPcrSelection;
+		AcknowledgmentResponseData sAcknowledgment;
+	} s_uTarget;
+	BYTE* pbCopy = NULL;
+	BYTE* pbBuffer = NULL;
+	INT32 nBufferSize = 0;
+
+	if (PunSize < 1)
+		return 0;
+	pbCopy = Fuzz_CopyInput(PrgbData + 1, PunSize - 1);
+	if (NULL == pbCopy)
+		return 0;
+	pbBuffer = pbCopy;
+	nBufferSize = (INT32)(PunSize - 1);
+
+	switch (PrgbData[0] % 8)
+	{
+		case 0:
+			IGNORE_RETURN_VALUE(TSS_TPM_RC_Unmarshal(&s_uTarget.responseCode, &pbBuffer, &nBufferSize));
+			break;
+		case 1:
+			IGNORE_RETURN_VALUE(TSS_TPMS_CAPABILITY_DATA_Unmarshal(&s_uTarget.sCapabilityData, &pbBuffer, &nBufferSize));
+			break;
+		case 2:
+			IGNORE_RETURN_VALUE(TSS_TPM2B_MAX_BUFFER_Unmarshal(&s_uTarget.sMaxBuffer, &pbBuffer, &nBufferSize));
+			break;
+		case 3:
+			IGNORE_RETURN_VALUE(TSS_TPM2B_DIGEST_Unmarshal(&s_uTarget.sDigest, &pbBuffer, &nBufferSize));
+			break;
+		case 4:
+			IGNORE_RETURN_VALUE(TSS_TPM2B_NONCE_Unmarshal(&s_uTarget.sNonce, &pbBuffer, &nBufferSize));
+			break;
+		case 5:
+			IGNORE_RETURN_VALUE(TSS_TPMT_TK_AUTH_Unmarshal(&s_uTarget.sTicket, &pbBuffer, &nBufferSize));
+			break;
+		case 6:
+			IGNORE_RETURN_VALUE(TSS_TPML_PCR_SELECTION_Unmarshal(&s_uTarget.sPcrSelection, &pbBuffer, &nBufferSize));
+			break;
+		default:
+			IGNORE_RETURN_VALUE(TSS_AcknowledgmentResponseData_Unmarshal(&s_uTarget.sAcknowledgment, &pbBuffer, &nBufferSize));
+			break;
+	}
+
+	Fuzz_ReleaseInput(pbCopy);
+	return 0;
+}
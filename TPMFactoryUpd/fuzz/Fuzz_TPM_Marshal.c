@@ -0,0 +1,93 @@
+﻿/**
+ *	@brief		Implements the libFuzzer harness of the TPM1.2 unmarshal functions
+ *	@details	Covers the structures of the TPM1.2 responses parsed by the tool (TPM_Marshal.c). The nested structures are
+ *				reached through the structures containing them.
+ *	@file		Fuzz_TPM_Marshal.c
+ *	@copyright	Copyright 2014 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ */
+
+#include "Fuzz.h"
+#include "TPM_Marshal.h"
+
+/**
+ *	@brief		Runs the unmarshal function selected by the first input byte on the remaining bytes
+ *
+ *	@param		PrgbData			Fuzzer input
+ *	@param		PunSize				Size of the fuzzer input
+ *	@retval		0					Always, the input is processed completely.
+ */
+int
+LLVMFuzzerTestOneInput(
+	_In_bytecount_(PunSize)	const uint8_t*	PrgbData,
+	_In_					size_t			PunSize)
+{
+	static union
+	{
+		TPM_RESULT result;
+		TPM_CAP_VERSION_INFO sVersionInfo;
+		TPM_PERMANENT_FLAGS sPermanentFlags;
+		TPM_STCLEAR_FLAGS sStClearFlags;
+		TPM_PUBKEY sPubKey;
+		TPM_PUBKEY_VIEW sPubKeyView;
+		TPM_KEY sKey;
+		TPM_DA_INFO sDaInfo;
+		IFX_FIELDUPGRADEINFO sFieldUpgradeInfo;
+		TPM_NONCE sNonce;
+	} s_uTarget;
+	BYTE* pbCopy = NULL;
+	BYTE* pbBuffer = NULL;
+	INT32 nBufferSize = 0;
+
+	if (PunSize < 1)
+		return 0;
+	pbCopy = Fuzz_CopyInput(PrgbData + 1, PunSize - 1);
+	if (NULL == pbCopy)
+		return 0;
+	pbBuffer = pbCopy;
+	nBufferSize = (INT32)(PunSize - 1);
+
+	switch (PrgbData[0] % 10)
+	{
+		case 0:
+			IGNORE_RETURN_VALUE(TSS_TPM_RESULT_Unmarshal(&s_uTarget.result, &pbBuffer, &nBufferSize));
+			break;
+		case 1:
+			IGNORE_RETURN_VALUE(TSS_TPM_CAP_VERSION_INFO_Unmarshal(&s_uTarget.sVersionInfo, &pbBuffer, &nBufferSize));
+			break;
+		case 2:
+			IGNORE_RETURN_VALUE(TSS_TPM_PERMANENT_FLAGS_Unmarshal(&s_uTarget.sPermanentFlags, &pbBuffer, &nBufferSize));
+			break;
+		case 3:
+			IGNORE_RETURN_VALUE(TSS_TPM_STCLEAR_FLAGS_Unmarshal(&s_uTarget.sStClearFlags, &pbBuffer, &nBufferSize));
+			break;
+		case 4:
+			IGNORE_RETURN_VALUE(TSS_TPM_PUBKEY_Unmarshal(&s_uTarget.sPubKey, &pbBuffer, &nBufferSize));
+			break;
+		case 5:
+			IGNORE_RETURN_VALUE(TSS_TPM_PUBKEY_UnmarshalView(&s_uTarget.sPubKeyView, &pbBuffer, &nBufferSize));
+			break;
+		case 6:
+			IGNORE_RETURN_VALUE(TSS_TPM_KEY_Unmarshal(&s_uTarget.sKey, &pbBuffer, &nBufferSize));
+			break;
+		case 7:
+			IGNORE_RETURN_VALUE(TSS_TPM_DA_INFO_Unmarshal(&s_uTarget.sDaInfo, &pbBuffer, &nBufferSize));
+			break;
+		case 8:
+			IGNORE_RETURN_VALUE(TSS_IFX_FIELDUPGRADEINFO_Unmarshal(&s_uTarget.sFieldUpgradeInfo, &pbBuffer, &nBufferSize));
+			break;
+		default:
+			IGNORE_RETURN_VALUE(TSS_TPM_NONCE_Unmarshal(&s_uTarget.sNonce, &pbBuffer, &nBufferSize));
+			break;
+	}
+
+	Fuzz_ReleaseInput(pbCopy);
+	return 0;
+}
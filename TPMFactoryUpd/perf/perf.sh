@@ -0,0 +1,164 @@
+#!/bin/sh
+#
+# Copyright 2015 - 2017 Infineon Technologies AG ( www.infineon.com )
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+# 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Runs the performance scenarios against the TPM simulator (-access-mode 5) and a capture replay (-access-mode 6) and
+# compares the fields of the -json output with the thresholds.
+#
+# Usage: perf.sh <TPMFactoryUpd binary> <work directory>
+#
+# scenarios:	<scenario> <expected exit code> <command line options>
+#				Runs in the work directory with <scenario>.cfg as TPMFactoryUpd.cfg, in the order of the file.
+# thresholds:	<scenario> <object>.<field> <maximum>
+#				<scenario> <object>.<field> min <minimum>
+#				The best value of PERF_RUNS runs (default 3) must not exceed the maximum or fall below the minimum.
+#
+# The update scenarios need openssl and gzip to build firmware images signed with the test key of the TPM simulator.
+#
+
+PERF_DIR=$(cd "$(dirname "$0")" && pwd)
+BINARY=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+WORK_DIR=$2
+RUNS=${PERF_RUNS:-3}
+
+if [ ! -x "$BINARY" ] || [ -z "$WORK_DIR" ]; then
+	echo "Usage: perf.sh <TPMFactoryUpd binary> <work directory>"
+	exit 2
+fi
+
+rm -rf "$WORK_DIR"
+mkdir -p "$WORK_DIR/fw" "$WORK_DIR/bundle" || exit 2
+cp "$PERF_DIR"/update/*.cfg "$WORK_DIR" || exit 2
+cd "$WORK_DIR" || exit 2
+
+# Writes bytes given as decimal numbers
+put_bytes() {
+	for BYTE in "$@"; do
+		# shellcheck disable=SC2059
+		printf "\\$(printf '%03o' "$BYTE")"
+	done
+}
+
+# Writes big endian UINT16 and UINT32 values
+put_uint16() {
+	put_bytes $(($1 >> 8 & 255)) $(($1 & 255))
+}
+put_uint32() {
+	put_bytes $(($1 >> 24 & 255)) $(($1 >> 16 & 255)) $(($1 >> 8 & 255)) $(($1 & 255))
+}
+
+# Writes zero bytes
+put_zeros() {
+	[ "$1" -gt 0 ] && dd if=/dev/zero bs="$1" count=1 2>/dev/null
+}
+
+# Writes a null-terminated UTF-16LE version string
+put_version() {
+	VERSION=$1
+	while [ -n "$VERSION" ]; do
+		printf '%s\000' "${VERSION%"${VERSION#?}"}"
+		VERSION=${VERSION#?}
+	done
+	put_bytes 0 0
+}
+
+# Builds a firmware image for the TPM simulator with a firmware of <size> KB of zero bytes. The image is signed with
+# perf/simulator-key.pem, which TPMFactoryUpd only accepts with -access-mode 5.
+# Usage: make_image <image file> <source family> <source version> <target family> <target version> <size>
+make_image() {
+	IMAGE=$1
+	LENGTH=$(printf '%s' "$3" | wc -c)
+	TARGET_LENGTH=$(printf '%s' "$5" | wc -c)
+	put_zeros $(($6 * 1024)) > firmware.tmp
+	{
+		# EFI_IFXTPM_FIRMWARE_IMAGE_GUID {1A53667A-FB12-479E-AC58-EC9958861093}
+		put_uint32 441673338; put_uint16 64274; put_uint16 18334; put_bytes 172 88 236 153 88 134 16 147
+		# Source and target version
+		put_bytes "$2"; put_uint16 $((LENGTH * 2 + 4)); put_version "$3"; put_bytes 0 0
+		put_bytes "$4"; put_uint16 $((TARGET_LENGTH * 2 + 2)); put_version "$5"
+		# Policy parameter block with the firmware digest and decrypt key ID 0
+		put_uint16 586; put_zeros 28; put_uint16 32; openssl dgst -sha256 -binary firmware.tmp
+		put_zeros 266; put_uint16 256; put_zeros 256
+		# Firmware
+		put_uint32 $(($6 * 1024)); cat firmware.tmp
+		# Additional data: image structure version 2, no target state, signature key ID 1
+		put_uint16 264; put_uint16 2; put_uint32 0; put_uint16 1
+	} > signed.tmp
+	openssl dgst -sha256 -sign "$PERF_DIR/simulator-key.pem" -sigopt rsa_padding_mode:pss -sigopt rsa_pss_saltlen:32 \
+		-out signature.tmp signed.tmp || return 1
+	cat signed.tmp signature.tmp > "$IMAGE"
+	# The CRC-32 of the image is the one of gzip, which stores it in little endian order
+	# shellcheck disable=SC2046
+	set -- $(gzip -c "$IMAGE" | tail -c 8 | head -c 4 | od -An -tu1)
+	put_bytes "$4" "$3" "$2" "$1" >> "$IMAGE"
+	rm -f firmware.tmp signed.tmp signature.tmp
+}
+
+make_image tpm20.BIN 2 7.63.3353.0 2 7.85.4555.0 1024 || exit 2
+make_image tpm12.BIN 1 4.43.257.0 1 4.43.258.0 1024 || exit 2
+
+# The rejected update scenarios use images of the same size that are loaded, parsed and rejected by the image check.
+dd if=/dev/zero of=image.BIN bs=1024 count=1024 2>/dev/null
+cp image.BIN fw/TPM20_7.63.3353.0_to_TPM20_7.85.4555.0.BIN
+cp image.BIN bundle/TPM_Firmware_Bundle.BIN
+
+FAILED=0
+
+# Run the scenarios
+while read -r SCENARIO EXPECTED OPTIONS; do
+	case "$SCENARIO" in
+		''|'#'*) continue ;;
+	esac
+	RUN=1
+	while [ "$RUN" -le "$RUNS" ]; do
+		cp "$PERF_DIR/$SCENARIO.cfg" TPMFactoryUpd.cfg
+		# shellcheck disable=SC2086
+		"$BINARY" $OPTIONS > "$SCENARIO.$RUN.json" < /dev/null
+		RESULT=$?
+		if [ "$RESULT" -ne "$EXPECTED" ] || ! grep -q '"rc":' "$SCENARIO.$RUN.json"; then
+			echo "FAILED    $SCENARIO: exit code $RESULT (expected $EXPECTED), see $WORK_DIR/$SCENARIO.$RUN.json"
+			FAILED=1
+			break
+		fi
+		mv TPMFactoryUpd.log "$SCENARIO.$RUN.log" 2>/dev/null
+		RUN=$((RUN + 1))
+	done
+done < "$PERF_DIR/scenarios"
+
+# Compare the best value of the runs with the thresholds, the best value of a minimum is the highest one
+while read -r SCENARIO FIELD MAXIMUM MINIMUM; do
+	case "$SCENARIO" in
+		''|'#'*) continue ;;
+	esac
+	OBJECT=${FIELD%%.*}
+	NAME=${FIELD#*.}
+	BEST=$(for FILE in "$SCENARIO".*.json; do
+			sed -n "s/.*\"$OBJECT\":{\([^}]*\)}.*/\1/p" "$FILE" | sed -n "s/.*\"$NAME\":\([0-9][0-9]*\).*/\1/p"
+		done | sort -n | if [ "$MAXIMUM" = min ]; then tail -n 1; else head -n 1; fi)
+	if [ -z "$BEST" ]; then
+		echo "FAILED    $SCENARIO $FIELD: not found in the JSON output"
+		FAILED=1
+	elif [ "$MAXIMUM" = min ]; then
+		if [ "$BEST" -lt "$MINIMUM" ]; then
+			echo "FAILED    $SCENARIO $FIELD: $BEST < $MINIMUM"
+			FAILED=1
+		else
+			echo "OK        $SCENARIO $FIELD: $BEST >= $MINIMUM"
+		fi
+	elif [ "$BEST" -gt "$MAXIMUM" ]; then
+		echo "FAILED    $SCENARIO $FIELD: $BEST > $MAXIMUM"
+		FAILED=1
+	else
+		echo "OK        $SCENARIO $FIELD: $BEST <= $MAXIMUM"
+	fi
+done < "$PERF_DIR/thresholds"
+
+exit $FAILED
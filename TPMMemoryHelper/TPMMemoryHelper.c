@@ -0,0 +1,474 @@
+﻿/**
+ *	@brief		Implements the TPMMemoryHelper application.
+ *	@details	The helper runs with the privilege to open /dev/mem and accesses the TPM registers on behalf of
+ *				unprivileged TPMFactoryUpd processes (-access-mode 1) connected through a Unix socket. A client names the
+ *				physical address of the locality register page it is going to use. The helper maps only this page, and
+ *				only if it is part of the TPM register window. The client then sends register read and write requests,
+ *				which the helper checks against the page. No descriptor leaves the helper, so a client cannot reach
+ *				other physical memory.
+ *	@file		TPMMemoryHelper.c
+ *	@copyright	Copyright 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+// struct ucred and accept4
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <grp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/// Default Unix socket of the helper
+#define HELPER_DEFAULT_SOCKET		"/run/TPMMemoryHelper.sock"
+/// Default physical address of the TPM register window (PC Client TIS/CRB)
+#define HELPER_DEFAULT_MEMORY_BASE	0xFED40000ULL
+/// Physical memory device
+#define HELPER_DEVICE				"/dev/mem"
+/// Size of the registers of one locality
+#define HELPER_LOCALITY_SIZE		0x1000ULL
+/// Number of localities in the TPM register window
+#define HELPER_LOCALITY_COUNT		5
+/// Answer: the page is mapped or the register access was done
+#define HELPER_GRANTED				0
+/// Answer: the page is not part of the TPM register window or the access lies outside the page
+#define HELPER_REFUSED				1
+/// Answer: the helper cannot map the page
+#define HELPER_UNAVAILABLE			2
+/// Request: read a register of 1, 2 or 4 bytes
+#define HELPER_READ_REGISTER		1
+/// Request: write a register of 1, 2 or 4 bytes
+#define HELPER_WRITE_REGISTER		2
+/// Request: read consecutive registers (access size 0) or a FIFO register (access size 1, 2 or 4)
+#define HELPER_READ_BLOCK			3
+/// Request: write consecutive registers (access size 0) or a FIFO register (access size 1, 2 or 4)
+#define HELPER_WRITE_BLOCK			4
+/// Size of a register request
+#define HELPER_REQUEST_SIZE			8
+/// Maximum number of bytes of a block request
+#define HELPER_MAX_TRANSFER			((unsigned int)HELPER_LOCALITY_SIZE)
+/// Seconds a client may take to send its page
+#define HELPER_REQUEST_TIMEOUT		5
+/// Seconds a client may stay idle between register requests
+#define HELPER_IDLE_TIMEOUT			60
+/// Orders the register accesses against the surrounding memory accesses
+#define HELPER_BARRIER()			__sync_synchronize()
+
+/**
+ *	@brief		Receives a number of bytes from a client
+ *
+ *	@param		PnSocket		Socket of the client connection
+ *	@param		PrgbData		Buffer for the data
+ *	@param		PunSize			Number of bytes to receive
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The connection was closed, timed out or failed.
+ */
+static int
+Helper_Receive(
+	int				PnSocket,
+	unsigned char*	PrgbData,
+	unsigned int	PunSize)
+{
+	unsigned int unReceived = 0;
+
+	while (unReceived < PunSize)
+	{
+		ssize_t nBytes = recv(PnSocket, PrgbData + unReceived, PunSize - unReceived, 0);
+		if (nBytes == -1 && EINTR == errno)
+			continue;
+		if (nBytes <= 0)
+			return -1;
+		unReceived += (unsigned int)nBytes;
+	}
+
+	return 0;
+}
+
+/**
+ *	@brief		Sends an answer to a client
+ *	@details	Answer: 32 bit status in network byte order, followed by the data of a read request if it was granted.
+ *
+ *	@param		PnSocket		Socket of the client connection
+ *	@param		PunStatus		HELPER_* status
+ *	@param		PrgbData		Data following the status, NULL for none
+ *	@param		PunSize			Size of the data
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The answer could not be sent.
+ */
+static int
+Helper_SendAnswer(
+	int						PnSocket,
+	unsigned int			PunStatus,
+	const unsigned char*	PrgbData,
+	unsigned int			PunSize)
+{
+	unsigned char rgbStatus[4] = {(unsigned char)(PunStatus >> 24), (unsigned char)(PunStatus >> 16), (unsigned char)(PunStatus >> 8), (unsigned char)PunStatus};
+	struct iovec rgsVector[2] = {{rgbStatus, sizeof(rgbStatus)}, {(void*)PrgbData, PunSize}};
+	struct msghdr sMessage;
+	ssize_t nBytes = 0;
+
+	memset(&sMessage, 0, sizeof(sMessage));
+	sMessage.msg_iov = rgsVector;
+	sMessage.msg_iovlen = (NULL != PrgbData && 0 != PunSize) ? 2 : 1;
+
+	do
+	{
+		nBytes = sendmsg(PnSocket, &sMessage, MSG_NOSIGNAL);
+	}
+	while (nBytes == -1 && EINTR == errno);
+
+	return nBytes == (ssize_t)(sizeof(rgbStatus) + (2 == sMessage.msg_iovlen ? PunSize : 0)) ? 0 : -1;
+}
+
+/**
+ *	@brief		Reads or writes a register of 1, 2 or 4 bytes
+ *	@details	The TIS registers are little endian. A 32-bit register is accessed with a single aligned access, a
+ *				16-bit register at an odd offset byte by byte.
+ *
+ *	@param		PpbRegister		Mapped register
+ *	@param		PunSize			Size of the register in bytes
+ *	@param		PpunValue		Value to write, receives the read value
+ *	@param		PfRead			1 to read the register, 0 to write it
+ */
+static void
+Helper_AccessRegister(
+	volatile unsigned char*	PpbRegister,
+	unsigned int			PunSize,
+	unsigned int*			PpunValue,
+	int						PfRead)
+{
+	HELPER_BARRIER();
+	if (4 == PunSize)
+	{
+		if (PfRead)
+			*PpunValue = *(volatile uint32_t*)PpbRegister;
+		else
+			*(volatile uint32_t*)PpbRegister = *PpunValue;
+	}
+	else if (2 == PunSize && 0 == ((uintptr_t)PpbRegister & 1))
+	{
+		if (PfRead)
+			*PpunValue = *(volatile uint16_t*)PpbRegister;
+		else
+			*(volatile uint16_t*)PpbRegister = (uint16_t)*PpunValue;
+	}
+	else
+	{
+		unsigned int unIndex = 0;
+		if (PfRead)
+			*PpunValue = 0;
+		for (unIndex = 0; unIndex < PunSize; unIndex++)
+		{
+			if (PfRead)
+				*PpunValue |= (unsigned int)PpbRegister[unIndex] << (8 * unIndex);
+			else
+				PpbRegister[unIndex] = (unsigned char)(*PpunValue >> (8 * unIndex));
+		}
+	}
+	HELPER_BARRIER();
+}
+
+/**
+ *	@brief		Reads or writes a block of registers
+ *	@details	Consecutive registers (access size 0) are accessed with aligned 32-bit accesses where possible. A FIFO
+ *				register is accessed with accesses of the access size (2 or 4) as long as enough bytes are left, the
+ *				remaining bytes with single byte accesses.
+ *
+ *	@param		PpbRegister		Mapped start register
+ *	@param		PrgbData		Data to write or buffer for the read data
+ *	@param		PunSize			Number of bytes
+ *	@param		PunAccessSize	0 for consecutive registers, 1, 2 or 4 for a FIFO register
+ *	@param		PfRead			1 to read the registers, 0 to write them
+ */
+static void
+Helper_AccessBlock(
+	volatile unsigned char*	PpbRegister,
+	unsigned char*			PrgbData,
+	unsigned int			PunSize,
+	unsigned int			PunAccessSize,
+	int						PfRead)
+{
+	unsigned int unPosition = 0;
+
+	HELPER_BARRIER();
+	while (unPosition < PunSize)
+	{
+		volatile unsigned char* pbRegister = 0 == PunAccessSize ? PpbRegister + unPosition : PpbRegister;
+		unsigned int unWidth = 1;
+		unsigned int unValue = 0;
+
+		if (PunSize - unPosition >= 4 && (4 == PunAccessSize || (0 == PunAccessSize && 0 == ((uintptr_t)pbRegister & 3))))
+			unWidth = 4;
+		else if (PunSize - unPosition >= 2 && 2 == PunAccessSize)
+			unWidth = 2;
+		if (!PfRead)
+			memcpy(&unValue, PrgbData + unPosition, unWidth);
+		if (4 == unWidth && PfRead)
+			unValue = *(volatile uint32_t*)pbRegister;
+		else if (4 == unWidth)
+			*(volatile uint32_t*)pbRegister = unValue;
+		else if (2 == unWidth && PfRead)
+			unValue = *(volatile uint16_t*)pbRegister;
+		else if (2 == unWidth)
+			*(volatile uint16_t*)pbRegister = (uint16_t)unValue;
+		else if (PfRead)
+			unValue = *pbRegister;
+		else
+			*pbRegister = (unsigned char)unValue;
+		if (PfRead)
+			memcpy(PrgbData + unPosition, &unValue, unWidth);
+		unPosition += unWidth;
+	}
+	HELPER_BARRIER();
+}
+
+/**
+ *	@brief		Serves the register requests of a client
+ *	@details	Request: 8 bytes, the request code, the access size, the 16 bit offset within the locality page and a
+ *				32 bit register value or block size, all in network byte order. The data of a block write follows the
+ *				request. Every request is answered, the connection is closed on a malformed request.
+ *
+ *	@param		PnSocket		Socket of the client connection
+ *	@param		PpbPage			Mapped locality register page
+ */
+static void
+Helper_ServeRegisters(
+	int						PnSocket,
+	volatile unsigned char*	PpbPage)
+{
+	static unsigned char s_rgbData[HELPER_MAX_TRANSFER];
+	unsigned char rgbRequest[HELPER_REQUEST_SIZE] = {0};
+
+	while (0 == Helper_Receive(PnSocket, rgbRequest, sizeof(rgbRequest)))
+	{
+		unsigned int unCode = rgbRequest[0];
+		unsigned int unAccessSize = rgbRequest[1];
+		unsigned int unOffset = ((unsigned int)rgbRequest[2] << 8) | rgbRequest[3];
+		unsigned int unValue = ((unsigned int)rgbRequest[4] << 24) | ((unsigned int)rgbRequest[5] << 16) | ((unsigned int)rgbRequest[6] << 8) | rgbRequest[7];
+		int nResult = 0;
+
+		if (HELPER_READ_REGISTER == unCode || HELPER_WRITE_REGISTER == unCode)
+		{
+			unsigned char rgbValue[4] = {0};
+			if ((1 != unAccessSize && 2 != unAccessSize && 4 != unAccessSize) || unOffset + unAccessSize > HELPER_LOCALITY_SIZE ||
+					(4 == unAccessSize && 0 != (unOffset & 3)))
+			{
+				nResult = Helper_SendAnswer(PnSocket, HELPER_REFUSED, NULL, 0);
+			}
+			else if (HELPER_WRITE_REGISTER == unCode)
+			{
+				Helper_AccessRegister(PpbPage + unOffset, unAccessSize, &unValue, 0);
+				nResult = Helper_SendAnswer(PnSocket, HELPER_GRANTED, NULL, 0);
+			}
+			else
+			{
+				Helper_AccessRegister(PpbPage + unOffset, unAccessSize, &unValue, 1);
+				rgbValue[0] = (unsigned char)(unValue >> 24);
+				rgbValue[1] = (unsigned char)(unValue >> 16);
+				rgbValue[2] = (unsigned char)(unValue >> 8);
+				rgbValue[3] = (unsigned char)unValue;
+				nResult = Helper_SendAnswer(PnSocket, HELPER_GRANTED, rgbValue, sizeof(rgbValue));
+			}
+		}
+		else if ((HELPER_READ_BLOCK == unCode || HELPER_WRITE_BLOCK == unCode) && unValue <= HELPER_MAX_TRANSFER)
+		{
+			// The data of a refused write is received as well to stay in step with the client
+			if (HELPER_WRITE_BLOCK == unCode && 0 != Helper_Receive(PnSocket, s_rgbData, unValue))
+				break;
+			if ((0 != unAccessSize && 1 != unAccessSize && 2 != unAccessSize && 4 != unAccessSize) ||
+					unOffset + (0 == unAccessSize ? unValue : unAccessSize) > HELPER_LOCALITY_SIZE ||
+					(0 != unAccessSize && 0 != (unOffset & (unAccessSize - 1))))
+			{
+				nResult = Helper_SendAnswer(PnSocket, HELPER_REFUSED, NULL, 0);
+			}
+			else
+			{
+				Helper_AccessBlock(PpbPage + unOffset, s_rgbData, unValue, unAccessSize, HELPER_READ_BLOCK == unCode);
+				nResult = Helper_SendAnswer(PnSocket, HELPER_GRANTED, HELPER_READ_BLOCK == unCode ? s_rgbData : NULL, unValue);
+			}
+		}
+		else
+		{
+			(void)Helper_SendAnswer(PnSocket, HELPER_REFUSED, NULL, 0);
+			break;
+		}
+
+		if (0 != nResult)
+			break;
+	}
+}
+
+/**
+ *	@brief		Serves one client connection
+ *	@details	Request: 64 bit physical address of a locality register page in network byte order. /dev/mem is opened
+ *				with O_SYNC, so the page is mapped uncached like in a privileged run. The descriptor is closed right
+ *				after mapping the page.
+ *
+ *	@param		PnSocket			Socket of the client connection
+ *	@param		PullMemoryBase		Physical address of the TPM register window
+ */
+static void
+Helper_ServeConnection(
+	int					PnSocket,
+	unsigned long long	PullMemoryBase)
+{
+	unsigned char rgbRequest[8] = {0};
+	unsigned long long ullPage = 0;
+	unsigned long long ullPageOffset = 0;
+	struct ucred sPeer;
+	socklen_t nPeerSize = sizeof(sPeer);
+	struct timeval sTimeout = {HELPER_REQUEST_TIMEOUT, 0};
+	unsigned int unIndex = 0;
+	unsigned char* pbMapping = MAP_FAILED;
+	int nDevice = -1;
+
+	memset(&sPeer, 0, sizeof(sPeer));
+	if (0 != getsockopt(PnSocket, SOL_SOCKET, SO_PEERCRED, &sPeer, &nPeerSize))
+	{
+		fprintf(stderr, "Reading the peer credentials failed (%s).\n", strerror(errno));
+		return;
+	}
+
+	// A client which does not send its request must not block the others
+	(void)setsockopt(PnSocket, SOL_SOCKET, SO_RCVTIMEO, &sTimeout, sizeof(sTimeout));
+	if (0 != Helper_Receive(PnSocket, rgbRequest, sizeof(rgbRequest)))
+		return;
+	for (unIndex = 0; unIndex < sizeof(rgbRequest); unIndex++)
+		ullPage = (ullPage << 8) | rgbRequest[unIndex];
+
+	if (ullPage < PullMemoryBase || 0 != ((ullPage - PullMemoryBase) % HELPER_LOCALITY_SIZE) ||
+			(ullPage - PullMemoryBase) / HELPER_LOCALITY_SIZE >= HELPER_LOCALITY_COUNT)
+	{
+		fprintf(stderr, "Refused page 0x%llX to pid %d uid %u, it is not a locality of the TPM register window at 0x%llX.\n",
+			ullPage, (int)sPeer.pid, (unsigned int)sPeer.uid, PullMemoryBase);
+		(void)Helper_SendAnswer(PnSocket, HELPER_REFUSED, NULL, 0);
+		return;
+	}
+
+	// mmap needs a page aligned offset, the system page may be larger than the register page (e.g. 64 KiB on ARM)
+	ullPageOffset = ullPage & (unsigned long long)(sysconf(_SC_PAGESIZE) - 1);
+	nDevice = open(HELPER_DEVICE, O_RDWR | O_SYNC | O_CLOEXEC);
+	if (-1 != nDevice)
+	{
+		pbMapping = (unsigned char*)mmap(NULL, ullPageOffset + HELPER_LOCALITY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, nDevice, (off_t)(ullPage - ullPageOffset));
+		close(nDevice);
+	}
+	if (MAP_FAILED == pbMapping)
+	{
+		fprintf(stderr, "Mapping page 0x%llX of %s failed (%s).\n", ullPage, HELPER_DEVICE, strerror(errno));
+		(void)Helper_SendAnswer(PnSocket, HELPER_UNAVAILABLE, NULL, 0);
+		return;
+	}
+
+	if (0 == Helper_SendAnswer(PnSocket, HELPER_GRANTED, NULL, 0))
+	{
+		printf("Serving page 0x%llX to pid %d uid %u\n", ullPage, (int)sPeer.pid, (unsigned int)sPeer.uid);
+		(void)fflush(stdout);
+		sTimeout.tv_sec = HELPER_IDLE_TIMEOUT;
+		(void)setsockopt(PnSocket, SOL_SOCKET, SO_RCVTIMEO, &sTimeout, sizeof(sTimeout));
+		Helper_ServeRegisters(PnSocket, pbMapping + ullPageOffset);
+		printf("Released page 0x%llX of pid %d\n", ullPage, (int)sPeer.pid);
+	}
+	munmap(pbMapping, ullPageOffset + HELPER_LOCALITY_SIZE);
+}
+
+/**
+ *	@brief		Main entry point of the application
+ *	@details	Usage: TPMMemoryHelper [socket [group [memory-base]]]
+ *				The socket is created with mode 0660. With a group, its group is changed so the members of the group
+ *				can connect.
+ *
+ *	@param		argc	Number of command line parameters
+ *	@param		argv	Command line parameters
+ *
+ *	@retval		0		The helper was stopped.
+ *	@retval		1		The listening socket could not be set up.
+ */
+int
+main(
+	int		argc,
+	char**	argv)
+{
+	const char* szSocket = argc > 1 ? argv[1] : HELPER_DEFAULT_SOCKET;
+	const char* szGroup = argc > 2 && 0 != argv[2][0] ? argv[2] : NULL;
+	unsigned long long ullMemoryBase = HELPER_DEFAULT_MEMORY_BASE;
+	struct sockaddr_un sAddress;
+	int nListenSocket = -1;
+
+	if (argc > 3)
+	{
+		char* szEnd = NULL;
+		ullMemoryBase = strtoull(argv[3], &szEnd, 16);
+		if (NULL == szEnd || '\0' != *szEnd || 0 == ullMemoryBase || 0 != (ullMemoryBase & (HELPER_LOCALITY_SIZE - 1)))
+			ullMemoryBase = 0;
+	}
+	if (argc > 4 || 0 == ullMemoryBase || strlen(szSocket) >= sizeof(sAddress.sun_path))
+	{
+		fprintf(stderr, "Usage: %s [socket [group [memory-base]]]\n", argv[0]);
+		return 1;
+	}
+
+	memset(&sAddress, 0, sizeof(sAddress));
+	sAddress.sun_family = AF_UNIX;
+	strcpy(sAddress.sun_path, szSocket);
+	// Remove the socket of a previous run
+	(void)unlink(szSocket);
+	(void)umask(S_IRWXO);
+	nListenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (-1 == nListenSocket ||
+			0 != bind(nListenSocket, (struct sockaddr*)&sAddress, sizeof(sAddress)) ||
+			0 != chmod(szSocket, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP) ||
+			0 != listen(nListenSocket, 4))
+	{
+		fprintf(stderr, "Listening on %s failed (%s).\n", szSocket, strerror(errno));
+		return 1;
+	}
+	if (NULL != szGroup)
+	{
+		struct group* pGroup = getgrnam(szGroup);
+		if (NULL == pGroup || 0 != chown(szSocket, (uid_t)-1, pGroup->gr_gid))
+		{
+			fprintf(stderr, "Granting the group %s access to %s failed.\n", szGroup, szSocket);
+			(void)unlink(szSocket);
+			return 1;
+		}
+	}
+	printf("TPMMemoryHelper: serving the TPM register window at 0x%llX on %s\n", ullMemoryBase, szSocket);
+	(void)fflush(stdout);
+
+	// Serve one client at a time, an idle client is disconnected after HELPER_IDLE_TIMEOUT
+	for (;;)
+	{
+		int nSocket = accept4(nListenSocket, NULL, NULL, SOCK_CLOEXEC);
+		if (-1 == nSocket)
+		{
+			if (EINTR == errno)
+				continue;
+			fprintf(stderr, "Accepting a connection failed (%s).\n", strerror(errno));
+			break;
+		}
+		Helper_ServeConnection(nSocket, ullMemoryBase);
+		(void)fflush(stdout);
+		close(nSocket);
+	}
+
+	close(nListenSocket);
+	(void)unlink(szSocket);
+	return 0;
+}
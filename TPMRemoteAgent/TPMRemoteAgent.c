@@ -0,0 +1,422 @@
+﻿/**
+ *	@brief		Implements the TPMRemoteAgent application.
+ *	@details	The agent exposes the TPM of its host on a TCP port for TPMFactoryUpd running with -access-mode 8.
+ *				It understands the TPM_SEND_COMMAND and TPM_SESSION_END frames of the MS TPM simulator protocol and the
+ *				batch frame of TPMFactoryUpd, which carries several prepared commands (e.g. TPM_FieldUpgradeUpdate blocks)
+ *				in one network round trip and is acknowledged with their response codes only.
+ *				The agent does not authenticate its clients and executes any TPM command it receives. It listens on the
+ *				loopback interface unless another address is given and is meant to be reached through a tunnel (e.g. SSH
+ *				port forwarding) or an authenticating proxy.
+ *	@file		TPMRemoteAgent.c
+ *	@copyright	Copyright 2016 - 2026 Infineon Technologies AG ( www.infineon.com )
+ *
+ *	@copyright	All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+/// Default TCP port of the agent
+#define AGENT_DEFAULT_PORT			2331
+/// Default TPM device
+#define AGENT_DEFAULT_DEVICE		"/dev/tpm0"
+/// Default listening address, the loopback interface only
+#define AGENT_DEFAULT_ADDRESS		"127.0.0.1"
+/// Seconds a client may stay idle before its connection is closed, so it cannot block the agent
+#define AGENT_RECEIVE_TIMEOUT		60
+/// MS TPM simulator command: send a TPM command
+#define AGENT_SEND_COMMAND			8
+/// MS TPM simulator command: end the session on the TPM command port
+#define AGENT_SESSION_END			20
+/// TPMFactoryUpd command: execute several TPM commands back to back and acknowledge them with their response codes
+#define AGENT_SEND_BATCH			0x49460001
+/// Maximum number of TPM commands in one batch frame
+#define AGENT_BATCH_MAX_COMMANDS	64
+/// Acknowledgement of a batched TPM command which could not be transmitted to the TPM
+#define AGENT_BATCH_TRANSPORT_ERROR	0xFFFFFFFF
+/// Maximum size of a TPM command or response
+#define AGENT_MAX_COMMAND_SIZE		4096
+/// Size of a TPM response header: tag, size and response code
+#define AGENT_RESPONSE_HEADER_SIZE	10
+
+/**
+ *	@brief		Sends all bytes of a buffer through a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PrgbBuffer		Bytes to send
+ *	@param		PunSize			Number of bytes to send
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The bytes could not be sent.
+ */
+static int
+Agent_Send(
+	int						PnSocket,
+	const unsigned char*	PrgbBuffer,
+	unsigned int			PunSize)
+{
+	while (PunSize > 0)
+	{
+		ssize_t nBytes = send(PnSocket, PrgbBuffer, PunSize, MSG_NOSIGNAL);
+		if (nBytes == -1 && EINTR == errno)
+			continue;
+		if (nBytes <= 0)
+			return -1;
+		PrgbBuffer += nBytes;
+		PunSize -= (unsigned int)nBytes;
+	}
+
+	return 0;
+}
+
+/**
+ *	@brief		Receives a given number of bytes from a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PrgbBuffer		Buffer receiving the bytes
+ *	@param		PunSize			Number of bytes to receive
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The connection failed or was closed by the client.
+ */
+static int
+Agent_Receive(
+	int				PnSocket,
+	unsigned char*	PrgbBuffer,
+	unsigned int	PunSize)
+{
+	while (PunSize > 0)
+	{
+		ssize_t nBytes = recv(PnSocket, PrgbBuffer, PunSize, 0);
+		if (nBytes == -1 && EINTR == errno)
+			continue;
+		if (nBytes <= 0)
+			return -1;
+		PrgbBuffer += nBytes;
+		PunSize -= (unsigned int)nBytes;
+	}
+
+	return 0;
+}
+
+/**
+ *	@brief		Sends a 32 bit value in network byte order through a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PunValue		Value to send
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The value could not be sent.
+ */
+static int
+Agent_SendUInt32(
+	int				PnSocket,
+	unsigned int	PunValue)
+{
+	unsigned char rgbValue[4] = {(unsigned char)(PunValue >> 24), (unsigned char)(PunValue >> 16), (unsigned char)(PunValue >> 8), (unsigned char)PunValue};
+	return Agent_Send(PnSocket, rgbValue, sizeof(rgbValue));
+}
+
+/**
+ *	@brief		Receives a 32 bit value in network byte order from a socket
+ *	@details
+ *
+ *	@param		PnSocket		Socket
+ *	@param		PpunValue		Receives the value
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The value could not be received.
+ */
+static int
+Agent_ReceiveUInt32(
+	int				PnSocket,
+	unsigned int*	PpunValue)
+{
+	unsigned char rgbValue[4] = {0};
+	if (0 != Agent_Receive(PnSocket, rgbValue, sizeof(rgbValue)))
+		return -1;
+	*PpunValue = ((unsigned int)rgbValue[0] << 24) | ((unsigned int)rgbValue[1] << 16) | ((unsigned int)rgbValue[2] << 8) | (unsigned int)rgbValue[3];
+	return 0;
+}
+
+/**
+ *	@brief		Transmits one TPM command to the TPM device
+ *	@details	The TPM driver executes one command per write() and returns its response with the following read().
+ *
+ *	@param		PnDevice				File descriptor of the TPM device
+ *	@param		PrgbRequest				TPM command bytes
+ *	@param		PunRequestSize			Size of the TPM command
+ *	@param		PrgbResponse			Buffer receiving the TPM response (AGENT_MAX_COMMAND_SIZE bytes)
+ *	@param		PpunResponseSize		Receives the size of the TPM response
+ *
+ *	@retval		0		The operation completed successfully.
+ *	@retval		-1		The command could not be transmitted or the response is invalid.
+ */
+static int
+Agent_TpmTransmit(
+	int						PnDevice,
+	const unsigned char*	PrgbRequest,
+	unsigned int			PunRequestSize,
+	unsigned char*			PrgbResponse,
+	unsigned int*			PpunResponseSize)
+{
+	ssize_t nBytes = 0;
+
+	do
+	{
+		nBytes = write(PnDevice, PrgbRequest, PunRequestSize);
+	}
+	while (nBytes == -1 && EINTR == errno);
+	if (nBytes != (ssize_t)PunRequestSize)
+	{
+		fprintf(stderr, "Writing the TPM command failed (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	do
+	{
+		nBytes = read(PnDevice, PrgbResponse, AGENT_MAX_COMMAND_SIZE);
+	}
+	while (nBytes == -1 && EINTR == errno);
+	if (nBytes < AGENT_RESPONSE_HEADER_SIZE)
+	{
+		fprintf(stderr, "Reading the TPM response failed (%s).\n", nBytes < 0 ? strerror(errno) : "too short");
+		return -1;
+	}
+
+	*PpunResponseSize = (unsigned int)nBytes;
+	return 0;
+}
+
+/**
+ *	@brief		Handles a TPM_SEND_COMMAND frame
+ *	@details	Frame: locality (1 byte), command size and command. Answer: response size, response and acknowledgement 0.
+ *
+ *	@param		PnSocket		Socket of the client connection
+ *	@param		PnDevice		File descriptor of the TPM device
+ *
+ *	@retval		0		The frame was handled.
+ *	@retval		-1		The connection must be closed.
+ */
+static int
+Agent_HandleSendCommand(
+	int		PnSocket,
+	int		PnDevice)
+{
+	static unsigned char s_rgbRequest[AGENT_MAX_COMMAND_SIZE];
+	static unsigned char s_rgbResponse[AGENT_MAX_COMMAND_SIZE];
+	unsigned char bLocality = 0;
+	unsigned int unRequestSize = 0;
+	unsigned int unResponseSize = 0;
+
+	if (0 != Agent_Receive(PnSocket, &bLocality, sizeof(bLocality)) || 0 != Agent_ReceiveUInt32(PnSocket, &unRequestSize) ||
+			unRequestSize > sizeof(s_rgbRequest) || 0 != Agent_Receive(PnSocket, s_rgbRequest, unRequestSize))
+		return -1;
+
+	// The client cannot tell a lost command from a lost connection
+	if (0 != Agent_TpmTransmit(PnDevice, s_rgbRequest, unRequestSize, s_rgbResponse, &unResponseSize))
+		return -1;
+
+	if (0 != Agent_SendUInt32(PnSocket, unResponseSize) || 0 != Agent_Send(PnSocket, s_rgbResponse, unResponseSize) ||
+			0 != Agent_SendUInt32(PnSocket, 0))
+		return -1;
+
+	return 0;
+}
+
+/**
+ *	@brief		Handles a batch frame
+ *	@details	Frame: number of commands, maximum duration of one command (unused, the TPM driver blocks) and the
+ *				commands with their sizes. The whole frame is received before the first command is executed. The commands
+ *				are executed back to back until the first one which does not succeed. Answer: number of executed commands,
+ *				their response codes (AGENT_BATCH_TRANSPORT_ERROR if a command could not be transmitted) and
+ *				acknowledgement 0.
+ *
+ *	@param		PnSocket		Socket of the client connection
+ *	@param		PnDevice		File descriptor of the TPM device
+ *
+ *	@retval		0		The frame was handled.
+ *	@retval		-1		The connection must be closed.
+ */
+static int
+Agent_HandleSendBatch(
+	int		PnSocket,
+	int		PnDevice)
+{
+	static unsigned char s_rgbRequests[AGENT_BATCH_MAX_COMMANDS][AGENT_MAX_COMMAND_SIZE];
+	static unsigned char s_rgbResponse[AGENT_MAX_COMMAND_SIZE];
+	unsigned int rgunRequestSizes[AGENT_BATCH_MAX_COMMANDS] = {0};
+	unsigned int rgunResponseCodes[AGENT_BATCH_MAX_COMMANDS] = {0};
+	unsigned int unCount = 0;
+	unsigned int unMaxDuration = 0;
+	unsigned int unExecuted = 0;
+	unsigned int unRequest = 0;
+
+	if (0 != Agent_ReceiveUInt32(PnSocket, &unCount) || 0 == unCount || unCount > AGENT_BATCH_MAX_COMMANDS ||
+			0 != Agent_ReceiveUInt32(PnSocket, &unMaxDuration))
+		return -1;
+	for (unRequest = 0; unRequest < unCount; unRequest++)
+	{
+		if (0 != Agent_ReceiveUInt32(PnSocket, &rgunRequestSizes[unRequest]) || rgunRequestSizes[unRequest] > AGENT_MAX_COMMAND_SIZE ||
+				0 != Agent_Receive(PnSocket, s_rgbRequests[unRequest], rgunRequestSizes[unRequest]))
+			return -1;
+	}
+
+	// Execute the commands, the TPM state after a failed command is up to the client
+	while (unExecuted < unCount)
+	{
+		unsigned int unResponseSize = 0;
+		if (0 != Agent_TpmTransmit(PnDevice, s_rgbRequests[unExecuted], rgunRequestSizes[unExecuted], s_rgbResponse, &unResponseSize))
+			rgunResponseCodes[unExecuted] = AGENT_BATCH_TRANSPORT_ERROR;
+		else
+			rgunResponseCodes[unExecuted] = ((unsigned int)s_rgbResponse[6] << 24) | ((unsigned int)s_rgbResponse[7] << 16) |
+				((unsigned int)s_rgbResponse[8] << 8) | (unsigned int)s_rgbResponse[9];
+		if (0 != rgunResponseCodes[unExecuted++])
+			break;
+	}
+
+	if (0 != Agent_SendUInt32(PnSocket, unExecuted))
+		return -1;
+	for (unRequest = 0; unRequest < unExecuted; unRequest++)
+	{
+		if (0 != Agent_SendUInt32(PnSocket, rgunResponseCodes[unRequest]))
+			return -1;
+	}
+	if (0 != Agent_SendUInt32(PnSocket, 0))
+		return -1;
+
+	return 0;
+}
+
+/**
+ *	@brief		Serves one client connection
+ *	@details	The TPM device is opened for the duration of the connection only, so a local TPM stack can use it
+ *				in between.
+ *
+ *	@param		PnSocket		Socket of the client connection
+ *	@param		PszDevice		TPM device path
+ */
+static void
+Agent_ServeConnection(
+	int				PnSocket,
+	const char*		PszDevice)
+{
+	int nDevice = open(PszDevice, O_RDWR);
+	if (-1 == nDevice)
+	{
+		fprintf(stderr, "Opening %s failed (%s).\n", PszDevice, strerror(errno));
+		return;
+	}
+
+	for (;;)
+	{
+		unsigned int unCommand = 0;
+		if (0 != Agent_ReceiveUInt32(PnSocket, &unCommand))
+			break;
+		if (AGENT_SEND_COMMAND == unCommand)
+		{
+			if (0 != Agent_HandleSendCommand(PnSocket, nDevice))
+				break;
+		}
+		else if (AGENT_SEND_BATCH == unCommand)
+		{
+			if (0 != Agent_HandleSendBatch(PnSocket, nDevice))
+				break;
+		}
+		else
+		{
+			if (AGENT_SESSION_END != unCommand)
+				fprintf(stderr, "Unknown command 0x%.8x, closing the connection.\n", unCommand);
+			break;
+		}
+	}
+
+	close(nDevice);
+}
+
+/**
+ *	@brief		Main entry point of the application
+ *	@details	Usage: TPMRemoteAgent [port [device [address]]]
+ *				Without an address the agent listens on the loopback interface only, 0.0.0.0 listens on all interfaces.
+ *
+ *	@param		argc	Number of command line parameters
+ *	@param		argv	Command line parameters
+ *
+ *	@retval		0		The agent was stopped.
+ *	@retval		1		The listening socket could not be set up.
+ */
+int
+main(
+	int		argc,
+	char**	argv)
+{
+	unsigned int unPort = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : AGENT_DEFAULT_PORT;
+	const char* szDevice = argc > 2 ? argv[2] : AGENT_DEFAULT_DEVICE;
+	const char* szAddress = argc > 3 ? argv[3] : AGENT_DEFAULT_ADDRESS;
+	struct sockaddr_in sAddress;
+	struct timeval sTimeout = {AGENT_RECEIVE_TIMEOUT, 0};
+	int nListenSocket = -1;
+	int nOption = 1;
+
+	memset(&sAddress, 0, sizeof(sAddress));
+	sAddress.sin_family = AF_INET;
+	sAddress.sin_port = htons((unsigned short)unPort);
+	if (0 == unPort || unPort > 0xFFFF || argc > 4 || 1 != inet_pton(AF_INET, szAddress, &sAddress.sin_addr))
+	{
+		fprintf(stderr, "Usage: %s [port [device [address]]]\n", argv[0]);
+		return 1;
+	}
+
+	nListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (-1 == nListenSocket ||
+			0 != setsockopt(nListenSocket, SOL_SOCKET, SO_REUSEADDR, &nOption, sizeof(nOption)) ||
+			0 != bind(nListenSocket, (struct sockaddr*)&sAddress, sizeof(sAddress)) ||
+			0 != listen(nListenSocket, 1))
+	{
+		fprintf(stderr, "Listening on %s:%u failed (%s).\n", szAddress, unPort, strerror(errno));
+		return 1;
+	}
+	printf("TPMRemoteAgent: forwarding %s:%u to %s\n", szAddress, unPort, szDevice);
+	if (INADDR_LOOPBACK != ntohl(sAddress.sin_addr.s_addr))
+		fprintf(stderr, "Warning: The agent does not authenticate its clients, restrict the access to %s:%u.\n", szAddress, unPort);
+
+	// Serve one client at a time, the TPM executes one command at a time anyway
+	for (;;)
+	{
+		int nSocket = accept(nListenSocket, NULL, NULL);
+		if (-1 == nSocket)
+		{
+			if (EINTR == errno)
+				continue;
+			fprintf(stderr, "Accepting a connection failed (%s).\n", strerror(errno));
+			break;
+		}
+		nOption = 1;
+		(void)setsockopt(nSocket, IPPROTO_TCP, TCP_NODELAY, &nOption, sizeof(nOption));
+		// An idle client must not block the agent, the next client is served after the timeout
+		(void)setsockopt(nSocket, SOL_SOCKET, SO_RCVTIMEO, &sTimeout, sizeof(sTimeout));
+		(void)setsockopt(nSocket, SOL_SOCKET, SO_SNDTIMEO, &sTimeout, sizeof(sTimeout));
+		Agent_ServeConnection(nSocket, szDevice);
+		close(nSocket);
+	}
+
+	close(nListenSocket);
+	return 0;
+}